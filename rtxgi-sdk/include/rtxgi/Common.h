@@ -65,6 +65,12 @@ namespace rtxgi
         ERROR_DDGI_MAP_FAILURE_RESOURCE_INDICES_UPLOAD_BUFFER,
         ERROR_DDGI_MAP_FAILURE_CONSTANTS_UPLOAD_BUFFER,
         ERROR_DDGI_MAP_FAILURE_VARIABILITY_READBACK_BUFFER,
+        ERROR_DDGI_MAP_FAILURE_PROBE_DATA_READBACK_BUFFER,
+        ERROR_DDGI_INVALID_BUFFERING_INDEX,
+        ERROR_DDGI_SPARSE_TEXTURES_UNSUPPORTED,
+        ERROR_DDGI_INVALID_CLIPMAP_DESC,
+        ERROR_DDGI_INVALID_CLIPMAP_LEVEL,
+        ERROR_DDGI_INVALID_PROBE_NUM_RAYS,
 
         ERROR_DDGI_D3D12_INVALID_RESOURCE_DESCRIPTOR_HEAP,
 
@@ -82,6 +88,8 @@ namespace rtxgi
         ERROR_DDGI_INVALID_BYTECODE_PROBE_CLASSIFICATION_RESET,
         ERROR_DDGI_INVALID_BYTECODE_PROBE_VARIABILITY_REDUCTION,
         ERROR_DDGI_INVALID_BYTECODE_PROBE_VARIABILITY_EXTRA_REDUCTION,
+        ERROR_DDGI_INVALID_BYTECODE_PROBE_SCHEDULING,
+        ERROR_DDGI_INVALID_BYTECODE_PROBE_SCHEDULING_ARGS,
 
         ERROR_DDGI_ALLOCATE_FAILURE_TEXTURE_PROBE_RAY_DATA,
         ERROR_DDGI_ALLOCATE_FAILURE_TEXTURE_PROBE_IRRADIANCE,
@@ -89,11 +97,17 @@ namespace rtxgi
         ERROR_DDGI_ALLOCATE_FAILURE_TEXTURE_PROBE_DATA,
         ERROR_DDGI_ALLOCATE_FAILURE_TEXTURE_PROBE_VARIABILITY,
         ERROR_DDGI_ALLOCATE_FAILURE_TEXTURE_PROBE_VARIABILITY_AVERAGE,
+        ERROR_DDGI_ALLOCATE_FAILURE_BUFFER_PROBE_SCHEDULE,
+        ERROR_DDGI_ALLOCATE_FAILURE_BUFFER_PROBE_SH,
+        ERROR_DDGI_ALLOCATE_FAILURE_BUFFER_PROBE_IRRADIANCE_MIPS,
+        ERROR_DDGI_ALLOCATE_FAILURE_SPARSE_RESIDENCY,
+        ERROR_DDGI_ALLOCATE_FAILURE_RESOURCE_POOL,
 
         ERROR_DDGI_D3D12_INVALID_DEVICE,
         ERROR_DDGI_D3D12_CREATE_FAILURE_PSO,
         ERROR_DDGI_D3D12_CREATE_FAILURE_ROOT_SIGNATURE,
         ERROR_DDGI_D3D12_CREATE_FAILURE_DESCRIPTORS,
+        ERROR_DDGI_D3D12_CREATE_FAILURE_COMMAND_SIGNATURE,
 
         ERROR_DDGI_VK_INVALID_DEVICE,
         ERROR_DDGI_VK_INVALID_PHYSICAL_DEVICE,
@@ -101,6 +115,7 @@ namespace rtxgi
         ERROR_DDGI_VK_CREATE_FAILURE_LAYOUTS,
         ERROR_DDGI_VK_CREATE_FAILURE_PIPELINE,
         ERROR_DDGI_VK_CREATE_FAILURE_DESCRIPTOR_SET,
+        ERROR_DDGI_VK_ALLOCATE_FAILURE_MEMORY,
 
         // Unmanaged Resource Mode (Application manages volume resources)
         ERROR_DDGI_INVALID_TEXTURE_PROBE_RAY_DATA,
@@ -110,6 +125,9 @@ namespace rtxgi
         ERROR_DDGI_INVALID_TEXTURE_PROBE_VARIABILITY,
         ERROR_DDGI_INVALID_TEXTURE_PROBE_VARIABILITY_AVERAGE,
         ERROR_DDGI_INVALID_TEXTURE_PROBE_VARIABILITY_READBACK,
+        ERROR_DDGI_INVALID_BUFFER_PROBE_SCHEDULE,
+        ERROR_DDGI_INVALID_BUFFER_PROBE_SH,
+        ERROR_DDGI_INVALID_BUFFER_PROBE_IRRADIANCE_MIPS,
 
         ERROR_DDGI_D3D12_INVALID_ROOT_SIGNATURE,
         ERROR_DDGI_D3D12_INVALID_DESCRIPTOR,
@@ -121,6 +139,10 @@ namespace rtxgi
         ERROR_DDGI_D3D12_INVALID_PSO_PROBE_CLASSIFICATION_RESET,
         ERROR_DDGI_D3D12_INVALID_PSO_PROBE_REDUCTION,
         ERROR_DDGI_D3D12_INVALID_PSO_PROBE_EXTRA_REDUCTION,
+        ERROR_DDGI_D3D12_INVALID_PSO_PROBE_SCHEDULING,
+        ERROR_DDGI_D3D12_INVALID_PSO_PROBE_SCHEDULING_ARGS,
+        ERROR_DDGI_D3D12_INVALID_PSO_PROBE_DERIVATION,
+        ERROR_DDGI_D3D12_INVALID_COMMAND_SIGNATURE_PROBE_SCHEDULE,
 
         ERROR_DDGI_VK_INVALID_DESCRIPTOR_SET,
         ERROR_DDGI_VK_INVALID_PIPELINE_LAYOUT,
@@ -51,6 +51,10 @@ namespace rtxgi
 
     RTXGI_API float3x3 EulerAnglesToRotationMatrix(const float3& eulerAngles);
 
+    // Writes origin + (spacing * coords) - shift for count grid points, starting at startCoords and stepping along axis (0 = x, 1 = y, 2 = z).
+    // Matches the scalar float3 operators bit for bit. Uses SSE2 or NEON when available.
+    RTXGI_API void GetGridRowPositions(float3* positions, int count, const float3& origin, const float3& spacing, const int3& startCoords, int axis, const float3& shift);
+
     // --- Addition ------------------------------------------------------------
 
     RTXGI_API int2 operator+(const int2& lhs, const int2& rhs);
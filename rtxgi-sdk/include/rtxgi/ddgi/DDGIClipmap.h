@@ -0,0 +1,104 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#pragma once
+
+#include "rtxgi/ddgi/DDGIVolume.h"
+
+// The maximum number of nested volumes (levels) in a DDGIClipmap
+#ifndef RTXGI_DDGI_CLIPMAP_MAX_LEVELS
+#define RTXGI_DDGI_CLIPMAP_MAX_LEVELS 8
+#endif
+
+namespace rtxgi
+{
+    /**
+     * Describes a DDGIClipmap.
+     *
+     * A clipmap is a stack of nested scrolling DDGIVolumes that follow a shared anchor (usually the camera).
+     * Level 0 is the finest level, each following level doubles the probe spacing (and so the extent) of the
+     * level inside it with the same probe counts. The levels must use consecutive volume indices, starting
+     * with level 0, so shaders can walk the levels in the DDGIVolume constants structured buffer
+     * (see DDGIGetClipmapLevel() in Irradiance.hlsl).
+     */
+    struct DDGIClipmapDesc
+    {
+        uint32_t numLevels = 0;                 // Number of levels, [1, RTXGI_DDGI_CLIPMAP_MAX_LEVELS]
+
+        // Staggered level updates: level 0 updates every frame and level L (L > 0) updates once every 2^L frames,
+        // offset so that no two outer levels update in the same frame (the coarsest level also takes the frames
+        // of the levels past it). At most two levels update per frame, except the first frame that updates every level.
+        // When disabled, every level updates every frame.
+        bool     staggeredUpdatesEnabled = true;
+    };
+
+    /**
+     * Populates the DDGIVolumeDesc of a clipmap level from the desc of the clipmap's finest level (level 0).
+     * The level keeps the probe counts and settings of level 0, scrolls, and doubles the probe spacing (and ray distance)
+     * once per level. The level's volume index is the index of level 0 plus the level.
+     * Note: the name pointer is copied, the application owns the name of each level.
+     */
+    RTXGI_API void GetDDGIClipmapLevelDesc(const DDGIVolumeDesc& baseDesc, uint32_t level, DDGIVolumeDesc& levelDesc);
+
+    /**
+     * DDGIClipmap. Groups the application's nested scrolling DDGIVolumes (see GetDDGIClipmapLevelDesc()),
+     * moves them with a shared anchor, and schedules their updates. The clipmap does not own the volumes,
+     * create and destroy them as usual.
+     */
+    class RTXGI_API DDGIClipmap
+    {
+    public:
+
+        // Validates and registers the levels, ordered from finest to coarsest
+        ERTXGIStatus Create(const DDGIClipmapDesc& desc, DDGIVolumeBase** levels);
+
+        // Unregisters the levels
+        void Destroy();
+
+        // Advances the clipmap's frame counter (that staggers the level updates), call once per frame
+        void Update();
+
+        //------------------------------------------------------------------------
+        // Setters
+        //------------------------------------------------------------------------
+
+        // Sets the scroll anchor of every level
+        void SetAnchor(const float3& value);
+
+        //------------------------------------------------------------------------
+        // Getters
+        //------------------------------------------------------------------------
+
+        DDGIClipmapDesc GetDesc() const { return m_desc; }
+
+        uint32_t GetNumLevels() const { return m_desc.numLevels; }
+
+        DDGIVolumeBase* GetLevel(uint32_t level) const { return (level < m_desc.numLevels) ? m_levels[level] : nullptr; }
+
+        // The volume index of level 0, levels use consecutive volume indices
+        uint32_t GetFirstVolumeIndex() const { return (m_desc.numLevels > 0) ? m_levels[0]->GetIndex() : 0; }
+
+        float3 GetAnchor() const { return m_anchor; }
+
+        // Whether the level's probes should be updated this frame
+        bool GetLevelUpdateNeeded(uint32_t level) const;
+
+        // Writes the levels to update this frame (finest first) to levels, returns the number of levels written
+        uint32_t GetLevelsToUpdate(DDGIVolumeBase** levels) const;
+
+    private:
+
+        DDGIClipmapDesc  m_desc = {};
+        DDGIVolumeBase*  m_levels[RTXGI_DDGI_CLIPMAP_MAX_LEVELS] = {};
+        float3           m_anchor = { 0.f, 0.f, 0.f };
+        uint32_t         m_clipmapFrame = 0;
+    };
+
+} // namespace rtxgi
@@ -26,10 +26,11 @@ struct DDGIRootConstants
     uint  reductionInputSizeX;
     uint  reductionInputSizeY;
     uint  reductionInputSizeZ;
+    uint  probeDerivationVolumeIndex;   // RTXGI_DDGI_PROBE_DERIVATION_NONE when the volume doesn't derive probes
 
 #ifndef HLSL
-    uint32_t data[6] = {};
-    static uint32_t GetNum32BitValues() { return 6; }
+    uint32_t data[7] = {};
+    static uint32_t GetNum32BitValues() { return 7; }
     static uint32_t GetSizeInBytes() { return GetNum32BitValues() * 4; }
     static uint32_t GetAlignedNum32BitValues() { return 8; }
     static uint32_t GetAlignedSizeInBytes() { return GetAlignedNum32BitValues() * 4; }
@@ -41,7 +42,8 @@ struct DDGIRootConstants
         data[3] = reductionInputSizeX;
         data[4] = reductionInputSizeY;
         data[5] = reductionInputSizeZ;
-        //data[6/7] = 0; // empty, alignment padding
+        data[6] = probeDerivationVolumeIndex;
+        //data[7] = 0; // empty, alignment padding
 
         return data;
     }
@@ -43,6 +43,7 @@ namespace rtxgi
     enum class EDDGIVolumeTextureFormat
     {
         U32   = 0,  // 32-bits per texel unsigned normalized integer format. 4 channels, 10-bits per RGB and 2 bits for alpha. Used with Irradiance.
+                    // With RayData: 32-bits per texel float format, 1 channel holding packed R5G5B5 radiance and a half precision hit distance.
         F16   = 1,  // 16-bits per texel half precision float format. 1 channel,  16-bits per channel. Used with Variability.
         F16x2 = 2,  // 32-bits per texel half precision float format. 2 channels, 16-bits per channel. Used with Distance.
         F16x4 = 3,  // 64-bits per texel half precision float format. 4 channels, 16-bits per channel. Used with Irradiance, Distance, and Data.
@@ -52,6 +53,21 @@ namespace rtxgi
         Count = 7
     };
 
+    enum class EDDGIVolumeProbeIrradianceEncoding
+    {
+        Octahedral = 0, // Irradiance is blended into the octahedral texels of the probe irradiance texture array
+        SH_L1,          // Irradiance is projected to 4 spherical harmonics coefficients per probe, stored in the probe SH buffer
+        SH_L2,          // Irradiance is projected to 9 spherical harmonics coefficients per probe, stored in the probe SH buffer
+        Count
+    };
+
+    enum class EDDGIVolumeProbeRayRotationType
+    {
+        Random = 0,         // Probe rays are rotated by a uniformly random rotation each update (generated with the volume's RNG)
+        LowDiscrepancy,     // Probe rays are rotated by consecutive points of the R3 low-discrepancy sequence, mapped to uniform rotations
+        Count
+    };
+
     enum class EDDGIVolumeMovementType
     {
         Default = 0,
@@ -85,6 +101,10 @@ namespace rtxgi
         uint32_t        index = 0;                              // Index of the volume in the constants structured buffer
         uint32_t        rngSeed = 0;                            // A seed for the random number generator (optional). A non-zero value manually initializes the seed used for rotation generation. Leave as zero to use the default (based on system time).
 
+        // How the probe ray directions are rotated each update. Low-discrepancy rotations cover the sphere more evenly over consecutive updates
+        // than random rotations, so probes converge with fewer rays. The sequence is randomly offset once per volume, a non-zero rngSeed makes it reproducible.
+        EDDGIVolumeProbeRayRotationType probeRayRotationType = EDDGIVolumeProbeRayRotationType::Random;
+
         bool            showProbes = false;                     // A flag for toggling probe visualizations for this volume
         bool            insertPerfMarkers = false;              // A flag for toggling volume-specific perf markers in the graphics command list (for debugging and tools)
 
@@ -94,7 +114,7 @@ namespace rtxgi
 
         int3            probeCounts = { -1, -1, -1 };           // Number of probes on each axis
 
-        int             probeNumRays = 256;                     // Number of rays cast per probe per frame. When using RTXGI_DDGI_BLEND_SHARED_MEMORY, make this a multiple of the irradiance/distance probe texel resolution for best behavior.
+        int             probeNumRays = 256;                     // Number of rays cast per probe per frame [1, 8191], Create() returns ERROR_DDGI_INVALID_PROBE_NUM_RAYS otherwise. When using RTXGI_DDGI_BLEND_SHARED_MEMORY, make this a multiple of the irradiance/distance probe texel resolution for best behavior.
         int             probeNumIrradianceTexels = -1;          // Number of texels used in one dimension of the irradiance texture, *including* the 1-pixel border
         int             probeNumIrradianceInteriorTexels = -1;  // Number of texels used in one dimension of the irradiance texture, *excluding* the 1-pixel border
         int             probeNumDistanceTexels = -1;            // Number of texels used in one dimension of the distance texture, *including* the 1-pixel border
@@ -141,9 +161,19 @@ namespace rtxgi
         EDDGIVolumeTextureFormat probeDataFormat;               // Texel format for the probe data texture, used with GetDDGIVolumeTextureFormat()
         EDDGIVolumeTextureFormat probeVariabilityFormat;        // Texel format index for the probe variability texture, used with GetDDGIVolumeTextureFormat()
 
+        // Probe irradiance representation. The spherical harmonics encodings skip the octahedral irradiance blending and store
+        // numProbes * RTXGI_DDGI_PROBE_SH_MAX_COEFFICIENTS float3 coefficients in the probe SH buffer instead. Cheaper to blend,
+        // store, and sample, at the cost of directional detail. Suited to far cascades and low frequency lighting.
+        // D3D12 only, requires the irradiance blending shader compiled with RTXGI_DDGI_BLEND_SH set to 1.
+        EDDGIVolumeProbeIrradianceEncoding probeIrradianceEncoding = EDDGIVolumeProbeIrradianceEncoding::Octahedral;
+
         // Using shared memory for scroll tests in probe blending can be a performance win on some hardware by reducing the compute workload
         bool            probeBlendingUseScrollSharedMemory = false;
 
+        // Probes scrolled into the volume are seeded with the irradiance and distance of the previous edge probes (one plane inward)
+        // and blend the rays traced at their new position, instead of being cleared to black. Avoids flickering scrolled edges under fast motion.
+        bool            probeScrollSeedEnabled = false;
+
         // Probe relocation moves probes to more useful positions
         bool            probeRelocationEnabled = false;
         bool            probeRelocationNeedsReset = false;
@@ -155,9 +185,109 @@ namespace rtxgi
         bool            probeClassificationEnabled = false;
         bool            probeClassificationNeedsReset = false;
 
+        // Probe relocation and classification process each probe with one wave (a lane per fixed ray) instead of one thread.
+        // Requires a wave lane count of at least 32 and shaders compiled with RTXGI_DDGI_FIXED_RAYS_WAVE_OPS set to 1.
+        bool            probeFixedRaysUseWaveOps = false;
+
         // Probe variability tracks the change in probes between updates as a proxy for convergence
         bool            probeVariabilityEnabled = false;
 
+        // Probe variability is averaged in a single dispatch: the last thread group to finish reduces the results of the others.
+        // D3D12 only, the thread group counter lives in the probe schedule buffer. Requires shaders compiled with RTXGI_DDGI_REDUCTION_SINGLE_PASS set to 1.
+        bool            probeVariabilityUseSinglePassReduction = false;
+
+        // Probe classification compacts the active probes into the probe list and probe blending dispatches over only those probes
+        // Requires probe classification and the probe scheduling resources, and has no effect while probe scheduling is enabled
+        bool            probeBlendingActiveOnly = false;
+
+        // Probe classification also writes one bit per probe (set when inactive) to the probe schedule buffer, so irradiance sampling
+        // rejects inactive probes with a single uint load. D3D12 only, requires the probe schedule buffer and sampling shaders compiled
+        // with RTXGI_DDGI_PROBE_STATE_BITS set to 1 (see Irradiance.hlsl).
+        bool            probeStateBitsEnabled = false;
+
+        // Probe scheduling traces and blends only a subset of the probes each frame (see ScheduleDDGIVolumeProbes())
+        // Inactive and converged probes update once every (1 << probeSchedulingMaxIntervalLog2) frames, other probes update every frame
+        // within probeSchedulingFullRateDistance probe spacings of the view origin and half as often each time that distance doubles
+        // The scheduling resources are validated (and allocated in Managed Resource Mode) when the volume is created with scheduling enabled
+        bool            probeSchedulingEnabled = false;
+        int             probeSchedulingMaxIntervalLog2 = 3;        // [0, RTXGI_DDGI_PROBE_SCHEDULE_MAX_INTERVAL_LOG2]
+        int             probeSchedulingFullRateDistance = 4;       // [1, 255] probe spacings
+        float           probeSchedulingVariabilityThreshold = 0.02f; // Probes with variability below this value are considered converged (requires probe variability)
+
+        // Probe relocation and classification time slicing processes 1 of every (1 << probeTimeSliceStrideLog2) groups of
+        // RTXGI_DDGI_PROBE_TIME_SLICE_GROUP_SIZE probes per frame, rotating through the groups. OnLargeObjectChange() runs
+        // relocation and classification at full rate for the next (1 << probeTimeSliceStrideLog2) updates to catch up.
+        int             probeTimeSliceStrideLog2 = 0;              // [0, RTXGI_DDGI_PROBE_TIME_SLICE_MAX_STRIDE_LOG2]
+
+        // Event driven updates (see OnGlobalLightChange(), OnLargeObjectChange(), OnSmallLightChange(), and PollUpdateNeeded())
+        // A global light change blends with probeEventHysteresis, recovering to probeHysteresis over probeEventRecoveryFrames updates,
+        // and traces every probe each frame while recovering (probe scheduling intervals are ignored).
+        // A small light change traces the probes whose cell overlaps the light's radius every frame for probeEventRecoveryFrames updates.
+        // Without events, a volume whose average variability is below probeEventIdleVariabilityThreshold idles and only needs
+        // an update once every (1 << probeEventIdleIntervalLog2) frames. Idling requires probe variability.
+        bool            probeEventUpdatesEnabled = false;
+        float           probeEventHysteresis = 0.5f;
+        int             probeEventRecoveryFrames = 32;             // [1, ...] updates
+        int             probeEventIdleIntervalLog2 = 4;            // [0, RTXGI_DDGI_PROBE_EVENT_MAX_IDLE_INTERVAL_LOG2]
+        float           probeEventIdleVariabilityThreshold = 0.01f;
+
+        // Convergence tracking (see GetProbeConverged() and SetVolumeAverageVariability()). A volume is converged once
+        // probeConvergenceFrames consecutive variability readbacks are below probeConvergenceVariabilityThreshold.
+        // With probeConvergencePauseUpdates, PollUpdateNeeded() pauses converged volumes until an event arrives or
+        // ResetProbeConvergence() is called. Convergence requires probe variability.
+        float           probeConvergenceVariabilityThreshold = 0.f;  // 0 disables convergence tracking
+        int             probeConvergenceFrames = 16;               // [1, ...] readbacks
+        bool            probeConvergencePauseUpdates = false;
+
+        // GPU convergence tracking (D3D12 only, requires probe scheduling and probe variability). Probe scheduling counts the
+        // consecutive updates whose volume average variability is below probeConvergenceVariabilityThreshold, and once
+        // probeConvergenceFrames updates are, writes empty trace and blend dispatch arguments: the volume freezes without a
+        // CPU readback. Update events (and WakeProbeConvergence()) restart the count.
+        bool            probeConvergenceFreezeOnGPU = false;
+
+        // Adaptive rays let probe scheduling pick each scheduled probe's ray count from its variability. Probes at or above
+        // probeAdaptiveRaysVariabilityThreshold (or with unknown variability, or near a small light change) trace probeNumRays rays,
+        // the count falls off linearly to probeAdaptiveRaysMin blended rays as the probe converges. The fixed rays of relocation
+        // and classification are traced on top of the minimum. The ray data is still allocated for probeNumRays rays.
+        // Requires probe scheduling and probe variability, every probe traces probeNumRays rays without them.
+        bool            probeAdaptiveRaysEnabled = false;
+        int             probeAdaptiveRaysMin = 32;                 // [1, probeNumRays] rays
+        float           probeAdaptiveRaysVariabilityThreshold = 0.1f;
+
+        // Adaptive hysteresis picks each probe texel's hysteresis from its variability in the previous update (stored in the variability texture),
+        // replacing probeHysteresis in irradiance blending. Texels at or above probeAdaptiveHysteresisVariabilityThreshold (or with unknown variability)
+        // blend with probeAdaptiveHysteresisMin, the hysteresis rises linearly to probeAdaptiveHysteresisMax as the texel stabilizes.
+        // Requires probe variability, irradiance blending uses probeHysteresis without it.
+        bool            probeAdaptiveHysteresisEnabled = false;
+        float           probeAdaptiveHysteresisMin = 0.8f;          // [0, 1]
+        float           probeAdaptiveHysteresisMax = 0.99f;         // [0, 1]
+        float           probeAdaptiveHysteresisVariabilityThreshold = 0.1f; // [0, 1]
+
+        // Irradiance mips pre-filter each probe's octahedral irradiance to 2x2 texels and a single average texel in the irradiance blending pass
+        // (stored in the probe irradiance mips buffer). Irradiance sampling given a view distance blends towards the mips beyond
+        // probeIrradianceMipDistance (mip 1 at 2x the distance, mip 2 at 4x), trading directional detail for far less texture traffic.
+        // D3D12 only, octahedral irradiance encoding only, requires the irradiance blending shader compiled with RTXGI_DDGI_BLEND_IRRADIANCE_MIPS set to 1.
+        bool            probeIrradianceMipsEnabled = false;
+        float           probeIrradianceMipDistance = 30.f;          // world-space units
+
+        // Probe visibility masks let irradiance sampling skip the distance texture fetch and Chebyshev test of probes that see the whole
+        // probe cage cell around the shading point. Distance blending writes one byte per cell to the probe schedule buffer, with a bit
+        // set when the probe's filtered mean distance toward the cell exceeds the farthest point of the cell (the visibility weight is 1).
+        // The masks are refreshed whenever a probe's distance is blended. D3D12 only, requires the probe schedule buffer and sampling
+        // shaders compiled with RTXGI_DDGI_PROBE_VISIBILITY_MASK set to 1 (see Irradiance.hlsl).
+        bool            probeVisibilityMaskEnabled = false;
+
+        // Sparse probe textures back the irradiance, distance, and variability texture arrays with memory only for the tiles
+        // that hold active probes (see UpdateDDGIVolumeSparseTiles()). Pair with probe classification, without it every probe is active.
+        // D3D12 Managed Resource Mode only, requires tiled resources tier 2 and resource heap tier 2
+        bool            probeSparseTexturesEnabled = false;
+
+        // Double buffered probe atlases give the irradiance, distance, and probe data texture arrays a published copy that the
+        // volume's SRVs point at. Probe updates write the working copy (UAVs), PublishDDGIVolumeProbes() copies it over the published
+        // copy at the start of the next frame, so sampling reads the previous frame's probes and doesn't wait on this frame's blending.
+        // Costs a second copy of the three texture arrays. D3D12 only.
+        bool            probeAtlasDoubleBuffered = false;
+
         // The type of movement the volume supports
         EDDGIVolumeMovementType movementType = EDDGIVolumeMovementType::Default;
 
@@ -170,6 +300,10 @@ namespace rtxgi
             // Probes haven't been allocated or number of probes has changed
             if (desc.probeCounts.x == -1 && desc.probeCounts.y == -1 && desc.probeCounts.z == -1) return true;
             if (probeCounts != desc.probeCounts) return true;
+            // Probe textures switch between committed and sparse (reserved) resources
+            if (probeSparseTexturesEnabled != desc.probeSparseTexturesEnabled) return true;
+            // The published copies of the probe textures are added or removed
+            if (probeAtlasDoubleBuffered != desc.probeAtlasDoubleBuffered) return true;
             return false;
         }
 
@@ -212,6 +346,21 @@ namespace rtxgi
      */
     RTXGI_API void GetDDGIVolumeTextureDimensions(const DDGIVolumeDesc& desc, EDDGIVolumeTextureType type, uint32_t& width, uint32_t& height, uint32_t& arraySize);
 
+    /**
+     * Get the GPU memory (in bytes) of the textures of a volume created with the given description.
+     */
+    RTXGI_API uint64_t GetDDGIVolumeGPUMemoryUsedInBytes(const DDGIVolumeDesc& desc);
+
+    /**
+     * Fit volumes into a GPU memory budget (in bytes) shared by all of them.
+     * While the volumes are over budget, the volume with the lowest priority (the largest, on ties) that can still be
+     * degraded takes its next step: smaller texel formats (ray data, irradiance, distance, probe data, variability),
+     * then half the rays per probe (down to 64), then fewer interior irradiance and distance texels (down to 4 and 6).
+     * The descs are modified in place. Returns false when the volumes don't fit once fully degraded.
+     * When usedInBytes is not null, it receives the memory used by the fitted volumes.
+     */
+    RTXGI_API bool FitDDGIVolumesToMemoryBudget(DDGIVolumeDesc* descs, const int* priorities, uint32_t numVolumes, uint64_t budgetInBytes, uint64_t* usedInBytes = nullptr);
+
     /**
      * DDGIVolume abstract base class. Instantiate the API-specific subclass.
      */
@@ -220,16 +369,27 @@ namespace rtxgi
     public:
 
         // Update the volume's rotation matrices and scrolling
+        // Only reads and writes the volume's own state (including its random number generator), different volumes can be updated on different threads
         virtual void Update();
 
-        // Random numbers
+        // Random numbers (a generator per volume)
         void  SeedRNG(const int seed);
         float GetRandomFloat();
 
-        // Event Handlers
-        virtual void OnGlobalLightChange() {}
-        virtual void OnLargeObjectChange() {}
-        virtual void OnSmallLightChange() {}
+        // Event Handlers (see DDGIVolumeDesc::probeEventUpdatesEnabled)
+        virtual void OnGlobalLightChange();
+        virtual void OnLargeObjectChange();
+        virtual void OnSmallLightChange();
+        virtual void OnSmallLightChange(const float3& position, float radius);
+
+        // Whether the volume's probes need an update this frame, idle volumes update at a reduced rate and paused (converged) volumes don't update. Call once per frame.
+        bool PollUpdateNeeded();
+
+        // Restarts convergence tracking, the volume needs probeConvergenceFrames new readbacks to converge again
+        void ResetProbeConvergence() { m_probeConvergenceSamples = 0; m_probeConverged = false; }
+
+        // Restarts GPU convergence tracking (see DDGIVolumeDesc::probeConvergenceFreezeOnGPU), a frozen volume updates again
+        void WakeProbeConvergence() { m_probeConvergenceWakeGeneration = (m_probeConvergenceWakeGeneration + 1) & 0xFF; }
 
         // Releases resources owned by the volume
         virtual void Destroy() = 0;
@@ -239,6 +399,11 @@ namespace rtxgi
         void ValidatePackedData(const DDGIVolumeDescGPUPacked packed) const;
     #endif
 
+        // Constants upload tracking, lets UploadDDGIVolumeConstants() skip volumes whose packed constants are unchanged
+        bool GetConstantsUploadNeeded(const DDGIVolumeDescGPUPacked& packed, const void* constantsBuffer) const;
+        void SetConstantsUploaded(const DDGIVolumeDescGPUPacked& packed, const void* constantsBuffer);
+        void ResetConstantsUploaded() { m_uploadedConstantsBuffer = nullptr; }
+
         //------------------------------------------------------------------------
         // Setters
         //------------------------------------------------------------------------
@@ -295,10 +460,76 @@ namespace rtxgi
 
         void SetProbeClassificationNeedsReset(bool value) { m_desc.probeClassificationNeedsReset = value; }
 
+        void SetProbeBlendingActiveOnly(bool value) { m_desc.probeBlendingActiveOnly = value; }
+
+        // Probe Visibility Mask Setters
+        void SetProbeVisibilityMaskEnabled(bool value) { m_desc.probeVisibilityMaskEnabled = value; }
+
         // Probe Variability Setters
         void SetProbeVariabilityEnabled(bool value) { m_desc.probeVariabilityEnabled = value; }
 
-        void SetVolumeAverageVariability(float value) { m_averageVariability = value; };
+        // Stores a new average variability readback and advances convergence tracking
+        void SetVolumeAverageVariability(float value);
+
+        // Probe Scheduling Setters
+        void SetProbeSchedulingEnabled(bool value) { m_desc.probeSchedulingEnabled = value; }
+
+        void SetProbeSchedulingMaxIntervalLog2(int value) { m_desc.probeSchedulingMaxIntervalLog2 = value; }
+
+        void SetProbeSchedulingFullRateDistance(int value) { m_desc.probeSchedulingFullRateDistance = value; }
+
+        void SetProbeSchedulingVariabilityThreshold(float value) { m_desc.probeSchedulingVariabilityThreshold = value; }
+
+        void SetProbeSchedulingViewOrigin(const float3& value) { m_probeSchedulingViewOrigin = value; }
+
+        // Probe Derivation Setters
+        // Probes of this volume that lie more than one probe spacing inside the derivation volume (usually a finer, nested volume)
+        // are derived: DeriveDDGIVolumeProbes() writes their irradiance from the derivation volume's probes, and probe scheduling
+        // traces them at the slowest rate to keep their distance, relocation, and classification current.
+        // Set the index of the derivation volume in the volume constants structured buffer, or RTXGI_DDGI_PROBE_DERIVATION_NONE.
+        void SetProbeDerivationVolumeIndex(uint32_t value) { m_probeDerivationVolumeIndex = value; }
+
+        // Probe Time Slicing Setters
+        void SetProbeTimeSliceStrideLog2(int value) { m_desc.probeTimeSliceStrideLog2 = value; }
+
+        // Event Driven Update Setters
+        void SetProbeEventUpdatesEnabled(bool value) { m_desc.probeEventUpdatesEnabled = value; }
+
+        void SetProbeEventHysteresis(float value) { m_desc.probeEventHysteresis = value; }
+
+        void SetProbeEventRecoveryFrames(int value) { m_desc.probeEventRecoveryFrames = value; }
+
+        void SetProbeEventIdleIntervalLog2(int value) { m_desc.probeEventIdleIntervalLog2 = value; }
+
+        void SetProbeEventIdleVariabilityThreshold(float value) { m_desc.probeEventIdleVariabilityThreshold = value; }
+
+        // Convergence Setters
+        void SetProbeConvergenceVariabilityThreshold(float value) { m_desc.probeConvergenceVariabilityThreshold = value; }
+
+        void SetProbeConvergenceFrames(int value) { m_desc.probeConvergenceFrames = value; }
+
+        void SetProbeConvergencePauseUpdates(bool value) { m_desc.probeConvergencePauseUpdates = value; }
+
+        void SetProbeConvergenceFreezeOnGPU(bool value) { m_desc.probeConvergenceFreezeOnGPU = value; }
+
+        // Adaptive Ray Setters
+        void SetProbeAdaptiveRaysEnabled(bool value) { m_desc.probeAdaptiveRaysEnabled = value; }
+
+        void SetProbeAdaptiveRaysMin(int value) { m_desc.probeAdaptiveRaysMin = value; }
+
+        void SetProbeAdaptiveRaysVariabilityThreshold(float value) { m_desc.probeAdaptiveRaysVariabilityThreshold = value; }
+
+        // Adaptive Hysteresis Setters
+        void SetProbeAdaptiveHysteresisEnabled(bool value) { m_desc.probeAdaptiveHysteresisEnabled = value; }
+
+        void SetProbeAdaptiveHysteresisMin(float value) { m_desc.probeAdaptiveHysteresisMin = value; }
+
+        void SetProbeAdaptiveHysteresisMax(float value) { m_desc.probeAdaptiveHysteresisMax = value; }
+
+        void SetProbeAdaptiveHysteresisVariabilityThreshold(float value) { m_desc.probeAdaptiveHysteresisVariabilityThreshold = value; }
+
+        // Irradiance Mips Setters
+        void SetProbeIrradianceMipDistance(float value) { m_desc.probeIrradianceMipDistance = value; }
 
         //------------------------------------------------------------------------
         // Getters
@@ -354,6 +585,15 @@ namespace rtxgi
 
         float GetProbeIrradianceEncodingGamma() const { return m_desc.probeIrradianceEncodingGamma; }
 
+        EDDGIVolumeProbeRayRotationType GetProbeRayRotationType() const { return m_desc.probeRayRotationType; }
+
+        bool GetProbeScrollSeedEnabled() const { return m_desc.probeScrollSeedEnabled; }
+
+        EDDGIVolumeProbeIrradianceEncoding GetProbeIrradianceEncoding() const { return m_desc.probeIrradianceEncoding; }
+
+        // Whether probe irradiance is stored as spherical harmonics coefficients (in the probe SH buffer)
+        bool GetProbeIrradianceSHEnabled() const { return m_desc.probeIrradianceEncoding != EDDGIVolumeProbeIrradianceEncoding::Octahedral; }
+
         float GetProbeIrradianceThreshold() const { return m_desc.probeIrradianceThreshold; }
 
         float GetProbeBrightnessThreshold() const { return m_desc.probeBrightnessThreshold; }
@@ -366,6 +606,11 @@ namespace rtxgi
 
         float3 GetProbeWorldPosition(int probeIndex) const;
 
+        // Writes the world position of every probe, in probe index order, to positions (numPositions must be at least GetNumProbes()).
+        // Same values as GetProbeWorldPosition(), without the per-probe index to grid coordinate conversion.
+        // Returns false if positions is too small.
+        bool GetProbeWorldPositions(float3* positions, int numPositions) const;
+
         AABB GetAxisAlignedBoundingBox() const;
 
         OBB GetOrientedBoundingBox() const;
@@ -382,13 +627,107 @@ namespace rtxgi
 
         bool GetProbeClassificationNeedsReset() const { return m_desc.probeClassificationNeedsReset; }
 
+        bool GetProbeBlendingActiveOnly() const { return m_desc.probeBlendingActiveOnly; }
+
+        bool GetProbeStateBitsEnabled() const { return m_desc.probeStateBitsEnabled; }
+
+        // Whether probe relocation and classification dispatch one thread group (wave) per probe
+        bool GetProbeFixedRaysUseWaveOps() const { return m_desc.probeFixedRaysUseWaveOps; }
+
+        // Whether probe classification is currently building the active probe list that probe blending dispatches over
+        bool GetProbeBlendingActiveListEnabled() const { return m_desc.probeBlendingActiveOnly && m_desc.probeClassificationEnabled && !m_desc.probeSchedulingEnabled; }
+
         // Probe Variability Getters
         bool GetProbeVariabilityEnabled() const { return m_desc.probeVariabilityEnabled; }
 
+        bool GetProbeVariabilityUseSinglePassReduction() const { return m_desc.probeVariabilityUseSinglePassReduction; }
+
         float GetVolumeAverageVariability() const { return m_averageVariability; };
 
+        // Probe Scheduling Getters
+        bool GetProbeSchedulingEnabled() const { return m_desc.probeSchedulingEnabled; }
+
+        int GetProbeSchedulingMaxIntervalLog2() const { return m_desc.probeSchedulingMaxIntervalLog2; }
+
+        int GetProbeSchedulingFullRateDistance() const { return m_desc.probeSchedulingFullRateDistance; }
+
+        float GetProbeSchedulingVariabilityThreshold() const { return m_desc.probeSchedulingVariabilityThreshold; }
+
+        float3 GetProbeSchedulingViewOrigin() const { return m_probeSchedulingViewOrigin; }
+
+        // Probe Derivation Getters
+        uint32_t GetProbeDerivationVolumeIndex() const { return m_probeDerivationVolumeIndex; }
+
+        bool GetProbeDerivationEnabled() const { return (m_probeDerivationVolumeIndex != RTXGI_DDGI_PROBE_DERIVATION_NONE); }
+
+        // Probe Time Slicing Getters
+        uint32_t GetProbeTimeSliceStrideLog2() const;
+
+        // Whether relocation and classification process every probe in this update (time slicing is off or catching up)
+        bool GetProbeTimeSliceFullRate() const { return (m_probeTimeSliceFullRate || GetProbeTimeSliceStrideLog2() == 0); }
+
+        // Event Driven Update Getters
+        bool GetProbeEventUpdatesEnabled() const { return m_desc.probeEventUpdatesEnabled; }
+
+        float GetProbeEventHysteresis() const { return m_desc.probeEventHysteresis; }
+
+        int GetProbeEventRecoveryFrames() const { return m_desc.probeEventRecoveryFrames; }
+
+        int GetProbeEventIdleIntervalLog2() const { return m_desc.probeEventIdleIntervalLog2; }
+
+        float GetProbeEventIdleVariabilityThreshold() const { return m_desc.probeEventIdleVariabilityThreshold; }
+
+        // Whether the volume is idle (no events and low variability), see PollUpdateNeeded()
+        bool GetProbeEventIdle() const { return m_eventIdle; }
+
+        // Convergence Getters
+        float GetProbeConvergenceVariabilityThreshold() const { return m_desc.probeConvergenceVariabilityThreshold; }
+
+        int GetProbeConvergenceFrames() const { return m_desc.probeConvergenceFrames; }
+
+        bool GetProbeConvergencePauseUpdates() const { return m_desc.probeConvergencePauseUpdates; }
+
+        bool GetProbeConvergenceFreezeOnGPU() const { return m_desc.probeConvergenceFreezeOnGPU; }
+
+        // Whether the last probeConvergenceFrames variability readbacks were below the convergence threshold
+        bool GetProbeConverged() const { return m_probeConverged; }
+
+        // Consecutive variability readbacks below the convergence threshold
+        uint32_t GetProbeConvergenceSamples() const { return m_probeConvergenceSamples; }
+
+        // Adaptive Ray Getters
+        bool GetProbeAdaptiveRaysEnabled() const { return m_desc.probeAdaptiveRaysEnabled; }
+
+        int GetProbeAdaptiveRaysMin() const { return m_desc.probeAdaptiveRaysMin; }
+
+        float GetProbeAdaptiveRaysVariabilityThreshold() const { return m_desc.probeAdaptiveRaysVariabilityThreshold; }
+
+        // Adaptive Hysteresis Getters
+        bool GetProbeAdaptiveHysteresisEnabled() const { return m_desc.probeAdaptiveHysteresisEnabled; }
+
+        float GetProbeAdaptiveHysteresisMin() const { return m_desc.probeAdaptiveHysteresisMin; }
+
+        float GetProbeAdaptiveHysteresisMax() const { return m_desc.probeAdaptiveHysteresisMax; }
+
+        float GetProbeAdaptiveHysteresisVariabilityThreshold() const { return m_desc.probeAdaptiveHysteresisVariabilityThreshold; }
+
+        // Irradiance Mips Getters
+        bool GetProbeIrradianceMipsEnabled() const { return m_desc.probeIrradianceMipsEnabled; }
+
+        float GetProbeIrradianceMipDistance() const { return m_desc.probeIrradianceMipDistance; }
+
+        // Probe Visibility Mask Getters
+        bool GetProbeVisibilityMaskEnabled() const { return m_desc.probeVisibilityMaskEnabled; }
+
+        // Sparse Probe Textures Getters
+        bool GetProbeSparseTexturesEnabled() const { return m_desc.probeSparseTexturesEnabled; }
+
+        // Double Buffered Probe Atlas Getters
+        bool GetProbeAtlasDoubleBuffered() const { return m_desc.probeAtlasDoubleBuffered; }
+
     protected:
 
+        float3 GetLowDiscrepancyRotationSample();
         void ComputeRandomRotation();
         void ComputeScrolling();
         int3 GetProbeGridCoords(int probeIndex) const;
@@ -410,6 +749,9 @@ namespace rtxgi
                         { 0.f, 1.f, 0.f },
                         { 0.f, 0.f, 1.f },
         };
+        uint32_t       m_probeRayRotationIndex = 0;                            // Index of the next low-discrepancy probe ray rotation
+        float3         m_probeRayRotationOffset = { 0.f, 0.f, 0.f };           // Random offset (Cranley-Patterson rotation) applied to the low-discrepancy rotation sequence
+        uint64_t       m_rngState = 0;                                         // State of the volume's random number generator (PCG32), see SeedRNG()
 
         float3         m_probeScrollAnchor = { 0.f, 0.f, 0.f };                // The anchor position for a scrolling volume to target for it's effective origin
         int3           m_probeScrollOffsets = { 0, 0, 0 };                     // Grid-space space offsets for scrolling movement
@@ -417,6 +759,28 @@ namespace rtxgi
         bool           m_probeScrollClear[3] = { 0, 0, 0 };                    // If probes of a plane need to be cleared due to scrolling movement
 
         float          m_averageVariability = 0;                               // Average variability for last update's probe irradiance values
+        uint32_t       m_probeConvergenceSamples = 0;                          // Consecutive variability readbacks below the convergence threshold
+        bool           m_probeConverged = false;                               // Whether the volume has converged (see GetProbeConverged())
+        uint32_t       m_probeConvergenceWakeGeneration = 0;                   // Bumped to restart GPU convergence tracking (see WakeProbeConvergence())
+
+        float3         m_probeSchedulingViewOrigin = { 0.f, 0.f, 0.f };        // World-space position the probe update rate falls off from (usually the camera)
+        uint32_t       m_probeSchedulingFrame = 0;                             // Frame counter used to stagger scheduled probe updates
+        uint32_t       m_probeDerivationVolumeIndex = RTXGI_DDGI_PROBE_DERIVATION_NONE; // Volume the derived probes take their irradiance from
+
+        uint32_t       m_probeTimeSliceCatchUpFrames = 0;                      // Remaining updates that relocate and classify every probe (see OnLargeObjectChange())
+        bool           m_probeTimeSliceFullRate = false;                       // Whether the current update relocates and classifies every probe
+
+        bool           m_eventPending = false;                                 // Whether an event arrived since the last PollUpdateNeeded() call
+        bool           m_eventIdle = false;                                    // Whether the volume is idling (no events and low variability)
+        uint32_t       m_eventIdleFrames = 0;                                  // Frames polled while idling, staggers the idle updates
+        uint32_t       m_eventGlobalLightFrames = 0;                           // Remaining updates recovering from a global light change
+        float          m_eventGlobalLightWeight = 0.f;                         // Global light change recovery weight of the current update, [0, 1]
+        uint32_t       m_eventSmallLightFrames = 0;                            // Remaining updates tracing the probes near small light changes
+        float3         m_eventSmallLightOrigin = { 0.f, 0.f, 0.f };            // World-space bounding sphere of the small light changes
+        float          m_eventSmallLightRadius = 0.f;                          // (0 when the current update has none)
+
+        DDGIVolumeDescGPUPacked m_uploadedDescGPUPacked = {};                  // Packed constants last copied to the device constants buffer
+        const void*    m_uploadedConstantsBuffer = nullptr;                    // Device constants buffer the packed constants were copied to (nullptr forces an upload)
 
         bool           m_insertPerfMarkers = false;                            // Toggles whether the volume will insert performance markers in the graphics command list.
 
@@ -424,5 +788,8 @@ namespace rtxgi
 
         void ScrollReset();
 
+        // Flags an event for PollUpdateNeeded() and restarts convergence tracking, every event handler calls this
+        void OnUpdateEvent() { m_eventPending = true; WakeProbeConvergence(); }
+
     };
 }
@@ -38,11 +38,16 @@ struct DDGIVolumeResourceIndices
     uint     probeVariabilityAverageUAVIndex;    // Index of the probe variability average UAV on the descriptor heap or in a RWTexture2DArray resource Array
     uint     probeVariabilityAverageSRVIndex;    // Index of the probe variability average SRV on the descriptor heap or in a Texture2DArray resource array
     //------------------------------------------------- 48B
+    uint     probeScheduleUAVIndex;              // Index of the probe schedule UAV on the descriptor heap (RWByteAddressBuffer)
+    uint     probeSHUAVIndex;                    // Index of the probe spherical harmonics UAV on the descriptor heap (RWStructuredBuffer<float3>)
+    uint     probeIrradianceMipsUAVIndex;        // Index of the probe irradiance mips UAV on the descriptor heap (RWStructuredBuffer<float3>)
+    uint     reserved2;
+    //------------------------------------------------- 64B
 };
 
 /**
  * Describes the properties of a DDGIVolume, with values packed to compact formats.
- * This version of the struct uses 128B to store some values at full precision.
+ * This version of the struct uses 176B to store some values at full precision.
  */
 struct DDGIVolumeDescGPUPacked
 {
@@ -64,10 +69,10 @@ struct DDGIVolumeDescGPUPacked
     float    probeMinFrontfaceDistance;
     //------------------------------------------------- 80B
     float3   probeSpacing;
-    uint     packed0;       // probeCounts.x (10), probeCounts.y (10), probeCounts.z (10), unused (2)
+    uint     packed0;       // probeCounts.x (10), probeCounts.y (10), probeCounts.z (10), probeBlendingActiveOnly (1), probeStateBitsEnabled (1)
     //------------------------------------------------- 96B
     uint     packed1;       // probeRandomRayBackfaceThreshold (16), probeFixedRayBackfaceThreshold (16)
-    uint     packed2;       // probeNumRays (16), probeNumIrradianceInteriorTexels (8), probeNumDistanceInteriorTexels (8)
+    uint     packed2;       // probeNumRays (13), probeTimeSliceStrideLog2 (3), probeNumIrradianceInteriorTexels (8), probeNumDistanceInteriorTexels (8)
     uint     packed3;       // probeScrollOffsets.x (15) sign bit (1), probeScrollOffsets.y (15) sign bit (1)
     uint     packed4;       // probeScrollOffsets.z (15) sign bit (1)
                             // movementType (1), probeRayDataFormat (3), probeIrradianceFormat (3), probeRelocationEnabled (1)
@@ -75,8 +80,45 @@ struct DDGIVolumeDescGPUPacked
                             // probeScrollClear Y-Z plane (1), probeScrollClear X-Z plane (1), probeScrollClear X-Y plane (1)
                             // probeScrollDirection Y-Z plane (1), probeScrollDirection X-Z plane (1), probeScrollDirection X-Y plane (1)
     //------------------------------------------------- 112B
-    uint4    reserved;      // 16B reserved for future use
+    float3   probeSchedulingViewOrigin;
+    uint     packed5;       // probeSchedulingEnabled (1), probeSchedulingMaxIntervalLog2 (3), probeSchedulingFullRateDistance (8), probeSchedulingFrame (8)
+                            // probeSchedulingVariabilityThreshold (12)
     //------------------------------------------------- 128B
+    float3   probeEventOrigin;
+    float    probeEventRadius;
+    //------------------------------------------------- 144B
+    uint     packed6;       // probeAdaptiveRaysEnabled (1), probeAdaptiveRaysMin (13), probeIrradianceEncoding (2), probeScrollSeedEnabled (1), probeAdaptiveHysteresisEnabled (1)
+                            // probeAdaptiveHysteresisVariabilityThreshold (12), probeIrradianceMipsEnabled (1), probeVisibilityMaskEnabled (1)
+    float    probeAdaptiveRaysVariabilityThreshold;
+    uint     packed7;       // probeAdaptiveHysteresisMin (16), probeAdaptiveHysteresisMax (16)
+    float    probeIrradianceMipDistance;
+    //------------------------------------------------- 160B
+    uint     packed8;       // probeConvergenceFreezeEnabled (1), probeConvergenceFrames (15), probeConvergenceWakeGeneration (8)
+    float    probeConvergenceVariabilityThreshold;
+    uint     reserved0;
+    uint     reserved1;
+    //------------------------------------------------- 176B
+};
+
+/**
+ * The properties of a DDGIVolume that sampling shaders read for every volume to find the volumes that cover a point,
+ * stored unpacked and 64B aligned so a volume's bounds are four 16B loads with nothing to decode.
+ * Shaders only unpack the DDGIVolumeDescGPUPacked of the volumes that cover the point.
+ * Created on the CPU with GetDDGIVolumeBoundsGPU(...).
+ */
+struct DDGIVolumeBoundsGPU
+{
+    float3   center;        // world-space center of the probe grid (the volume's origin moved by its scroll offsets)
+    uint     blendOrder;    // index of the volume blended at this position of the blend order, written by the application (0 from GetDDGIVolumeBoundsGPU)
+    //------------------------------------------------- 16B
+    float4   rotation;      // rotation quaternion for the volume
+    //------------------------------------------------- 32B
+    float3   probeSpacing;  // world-space distance between probes
+    uint     reserved1;
+    //------------------------------------------------- 48B
+    int3     probeCounts;   // number of probes on each axis of the volume
+    uint     reserved2;
+    //------------------------------------------------- 64B
 };
 
 /**
@@ -117,15 +159,116 @@ struct DDGIVolumeDescGPU
     int3     probeScrollOffsets;                 // grid-space offsets used for scrolling movement
     bool     probeScrollClear[3];                // whether probes of a plane need to be cleared due to scrolling movement
     bool     probeScrollDirections[3];           // direction of scrolling movement (0: negative, 1: positive)
+    bool     probeScrollSeedEnabled;             // whether scrolled probes are seeded from the previous edge probes instead of cleared
 
     // Feature Options
     uint     probeRayDataFormat;                 // texture format of the ray data texture (EDDGIVolumeTextureFormat)
     uint     probeIrradianceFormat;              // texture format of the irradiance texture (EDDGIVolumeTextureFormat)
+    uint     probeIrradianceEncoding;            // representation of probe irradiance (EDDGIVolumeProbeIrradianceEncoding)
     bool     probeRelocationEnabled;             // whether probe relocation is enabled for this volume
     bool     probeClassificationEnabled;         // whether probe classification is enabled for this volume
     bool     probeVariabilityEnabled;            // whether probe variability is enabled for this volume
+    bool     probeBlendingActiveOnly;            // whether probe classification compacts the active probes into the probe list that probe blending dispatches over
+    bool     probeStateBitsEnabled;              // whether probe classification mirrors the probe states to the state bits of the probe schedule buffer
+
+    // Probe Scheduling
+    bool     probeSchedulingEnabled;             // whether probe scheduling is enabled for this volume
+    uint     probeSchedulingMaxIntervalLog2;     // inactive, converged, and distant probes update at most once every (1 << probeSchedulingMaxIntervalLog2) frames
+    uint     probeSchedulingFullRateDistance;    // distance from the view origin (in probe spacings) within which probes update every frame
+    uint     probeSchedulingFrame;               // frame counter used to stagger probe updates (and rotate time slices) across frames (wraps at 256)
+    float    probeSchedulingVariabilityThreshold; // variability below which a probe is considered converged
+    float3   probeSchedulingViewOrigin;          // world-space position the probe update rate falls off from
+
+    // Probe Relocation and Classification Time Slicing
+    uint     probeTimeSliceStrideLog2;           // relocation and classification process 1 of every (1 << probeTimeSliceStrideLog2) groups of probes per frame (0 while catching up)
+
+    // Update Events
+    float3   probeEventOrigin;                   // world-space center of the (merged) small light changes, probes near it update every frame
+    float    probeEventRadius;                   // world-space radius of the (merged) small light changes, 0 when there are none
+
+    // Adaptive Rays
+    bool     probeAdaptiveRaysEnabled;           // whether probe scheduling picks each probe's ray count from its variability (requires probe scheduling)
+    uint     probeAdaptiveRaysMin;               // number of blended (non-fixed) rays traced for converged probes
+    float    probeAdaptiveRaysVariabilityThreshold; // variability at and above which probes trace probeNumRays rays
+
+    // Adaptive Hysteresis
+    bool     probeAdaptiveHysteresisEnabled;     // whether irradiance blending picks each texel's hysteresis from its previous variability (requires probe variability)
+    float    probeAdaptiveHysteresisMin;         // hysteresis of texels at or above the variability threshold
+    float    probeAdaptiveHysteresisMax;         // hysteresis of fully stable texels
+    float    probeAdaptiveHysteresisVariabilityThreshold; // variability at and above which texels blend with probeAdaptiveHysteresisMin
+
+    // Irradiance Mips
+    bool     probeIrradianceMipsEnabled;         // whether irradiance blending writes the pre-filtered probe irradiance mips
+    float    probeIrradianceMipDistance;         // world-space view distance at which irradiance sampling starts to use the probe irradiance mips
+
+    // Probe Visibility Masks
+    bool     probeVisibilityMaskEnabled;         // whether distance blending writes the probe cage cells' clear visibility masks to the probe schedule buffer
+
+    // GPU Convergence Tracking
+    bool     probeConvergenceFreezeEnabled;      // whether probe scheduling stops tracing and blending the volume once it has converged (requires probe scheduling and variability)
+    uint     probeConvergenceFrames;             // consecutive updates below the convergence threshold after which the volume freezes
+    uint     probeConvergenceWakeGeneration;     // changes when an update event wakes the volume, restarting the count (wraps at 256)
+    float    probeConvergenceVariabilityThreshold; // volume average variability below which an update counts towards convergence
 };
 
+// Probe schedule buffer layout (RWByteAddressBuffer, see ProbeSchedulingCS.hlsl)
+// Probe classification fills the list with the active probes instead when probeBlendingActiveOnly is set
+//   0: probe ray trace dispatch arguments (ray groups per probe, scheduled probe count, 1)
+//  12: probe blending dispatch arguments (scheduled probe count, 1, 1)
+//  24: scheduled probe counter
+//  28: single pass variability reduction thread group counter (see ReductionCS.hlsl)
+//  32: GPU convergence tracking, consecutive converged updates (see DDGIUpdateProbeConvergence())
+//  36: GPU convergence tracking, wake generation of the count
+//  48: scheduled probe indices
+//  48 + (4 * numProbes): per-probe ray counts, indexed by probe index (written for the scheduled probes with adaptive rays)
+//  48 + (8 * numProbes): probe state bits, one bit per probe indexed by probe index, set when the probe is inactive (written by probe classification when probeStateBitsEnabled is set)
+//  48 + (8 * numProbes) + (4 * ceil(numProbes / 32)): probe visibility masks, one byte per probe cage cell indexed by the (storage) index of the cell's base probe.
+//      Bit n is set when the distance moments of the cell's probe at adjacent offset (n & 1, (n >> 1) & 1, (n >> 2) & 1) show the whole cell is visible
+//      (written by distance blending when probeVisibilityMaskEnabled is set, see DDGIStoreProbeVisibilityBit())
+#define RTXGI_DDGI_PROBE_SCHEDULE_TRACE_ARGS_OFFSET 0
+#define RTXGI_DDGI_PROBE_SCHEDULE_BLEND_ARGS_OFFSET 12
+#define RTXGI_DDGI_PROBE_SCHEDULE_COUNT_OFFSET 24
+#define RTXGI_DDGI_PROBE_SCHEDULE_REDUCTION_COUNT_OFFSET 28
+#define RTXGI_DDGI_PROBE_SCHEDULE_CONVERGENCE_OFFSET 32
+#define RTXGI_DDGI_PROBE_SCHEDULE_LIST_OFFSET 48
+#define RTXGI_DDGI_PROBE_SCHEDULE_MAX_INTERVAL_LOG2 7
+#define RTXGI_DDGI_PROBE_SCHEDULE_STATE_BITS_OFFSET(numProbes) (RTXGI_DDGI_PROBE_SCHEDULE_LIST_OFFSET + (8 * (numProbes)))
+#define RTXGI_DDGI_PROBE_SCHEDULE_VISIBILITY_MASKS_OFFSET(numProbes) (RTXGI_DDGI_PROBE_SCHEDULE_STATE_BITS_OFFSET(numProbes) + (4 * (((numProbes) + 31) / 32)))
+#define RTXGI_DDGI_PROBE_SCHEDULE_SIZE(numProbes) (RTXGI_DDGI_PROBE_SCHEDULE_VISIBILITY_MASKS_OFFSET(numProbes) + (4 * (((numProbes) + 3) / 4)))
+
+// Probe spherical harmonics buffer layout (RWStructuredBuffer<float3>, see ProbeSphericalHarmonics.hlsl)
+// Each probe owns RTXGI_DDGI_PROBE_SH_MAX_COEFFICIENTS consecutive elements, indexed by probe index. L1 uses the first 4.
+// The coefficients are pre-convolved with the clamped cosine lobe and scaled so their evaluation gives irradiance / 2pi,
+// the (linear) value stored in the octahedral irradiance texels.
+#define RTXGI_DDGI_PROBE_IRRADIANCE_ENCODING_OCTAHEDRAL 0
+#define RTXGI_DDGI_PROBE_IRRADIANCE_ENCODING_SH_L1 1
+#define RTXGI_DDGI_PROBE_IRRADIANCE_ENCODING_SH_L2 2
+#define RTXGI_DDGI_PROBE_SH_MAX_COEFFICIENTS 9
+#define RTXGI_DDGI_PROBE_SH_SIZE(numProbes) (12 * RTXGI_DDGI_PROBE_SH_MAX_COEFFICIENTS * (numProbes))
+
+// Probe irradiance mips buffer layout (RWStructuredBuffer<float3>, see DDGISampleProbeIrradianceMips())
+// Each probe owns RTXGI_DDGI_PROBE_IRRADIANCE_MIP_TEXELS consecutive elements, indexed by probe index:
+//   0-3: mip 1, the probe's interior octahedral texels averaged down to 2x2 (row major)
+//     4: mip 2, the average of the probe's interior texels
+// Values are linear (the probe irradiance texels with the irradiance encoding gamma removed).
+#define RTXGI_DDGI_PROBE_IRRADIANCE_MIP_TEXELS 5
+#define RTXGI_DDGI_PROBE_IRRADIANCE_MIP_COUNT 3
+#define RTXGI_DDGI_PROBE_IRRADIANCE_MIPS_SIZE(numProbes) (12 * RTXGI_DDGI_PROBE_IRRADIANCE_MIP_TEXELS * (numProbes))
+
+// Adaptive probe ray counts are rounded up to a multiple of the granularity (see DDGIGetProbeAdaptiveNumRays())
+#define RTXGI_DDGI_PROBE_ADAPTIVE_RAYS_GRANULARITY 32
+
+// Probe relocation and classification time slicing (see DDGIIsProbeInTimeSlice())
+// Probes are sliced in groups that match the relocation and classification thread groups, so skipped groups exit together
+#define RTXGI_DDGI_PROBE_TIME_SLICE_GROUP_SIZE 32
+#define RTXGI_DDGI_PROBE_TIME_SLICE_MAX_STRIDE_LOG2 7
+
+// Event driven updates (see DDGIVolumeBase::PollUpdateNeeded())
+#define RTXGI_DDGI_PROBE_EVENT_MAX_IDLE_INTERVAL_LOG2 8
+
+// Probe derivation (see DDGIVolumeBase::SetProbeDerivationVolumeIndex()), the derivation volume index of volumes without one
+#define RTXGI_DDGI_PROBE_DERIVATION_NONE 0xFFFFFFFF
+
 #ifndef HLSL // CPU only
 static inline rtxgi::DDGIVolumeDescGPUPacked PackDDGIVolumeDescGPU(const rtxgi::DDGIVolumeDescGPU input)
 {
@@ -148,11 +291,14 @@ static inline rtxgi::DDGIVolumeDescGPUPacked PackDDGIVolumeDescGPU(const rtxgi::
     output.packed0  = (uint32_t)input.probeCounts.x;
     output.packed0 |= (uint32_t)input.probeCounts.y << 10;
     output.packed0 |= (uint32_t)input.probeCounts.z << 20;
+    output.packed0 |= (uint32_t)input.probeBlendingActiveOnly << 30;
+    output.packed0 |= (uint32_t)input.probeStateBitsEnabled << 31;
 
     output.packed1  = (uint32_t)(input.probeRandomRayBackfaceThreshold * 65535);
     output.packed1 |= (uint32_t)(input.probeFixedRayBackfaceThreshold * 65535) << 16;
 
-    output.packed2  = (uint32_t)input.probeNumRays;
+    output.packed2  = (uint32_t)input.probeNumRays & 0x1FFF;
+    output.packed2 |= (input.probeTimeSliceStrideLog2 & 0x7) << 13;
     output.packed2 |= (uint32_t)input.probeNumIrradianceInteriorTexels << 16;
     output.packed2 |= (uint32_t)input.probeNumDistanceInteriorTexels << 24;
 
@@ -178,6 +324,44 @@ static inline rtxgi::DDGIVolumeDescGPUPacked PackDDGIVolumeDescGPU(const rtxgi::
     output.packed4 = (output.packed4 & ~0x40000000) | (input.probeScrollDirections[1] << 30);
     output.packed4 = (output.packed4 & ~0x80000000) | (input.probeScrollDirections[2] << 31);
 
+    // Probe Scheduling
+    output.probeSchedulingViewOrigin = input.probeSchedulingViewOrigin;
+    output.packed5  = (uint32_t)input.probeSchedulingEnabled;
+    output.packed5 |= (input.probeSchedulingMaxIntervalLog2 & 0x7) << 1;
+    output.packed5 |= (input.probeSchedulingFullRateDistance & 0xFF) << 4;
+    output.packed5 |= (input.probeSchedulingFrame & 0xFF) << 12;
+    output.packed5 |= (uint32_t)(input.probeSchedulingVariabilityThreshold * 4095) << 20;
+
+    // Update Events
+    output.probeEventOrigin = input.probeEventOrigin;
+    output.probeEventRadius = input.probeEventRadius;
+
+    // Adaptive Rays
+    output.packed6  = (uint32_t)input.probeAdaptiveRaysEnabled;
+    output.packed6 |= (input.probeAdaptiveRaysMin < 0x1FFF ? input.probeAdaptiveRaysMin : 0x1FFF) << 1;  // 13 bits, clamped (not wrapped) to 8191
+    output.packed6 |= (input.probeIrradianceEncoding & 0x3) << 14;
+    output.packed6 |= (uint32_t)input.probeScrollSeedEnabled << 16;
+    output.probeAdaptiveRaysVariabilityThreshold = input.probeAdaptiveRaysVariabilityThreshold;
+
+    // Adaptive Hysteresis
+    output.packed6 |= (uint32_t)input.probeAdaptiveHysteresisEnabled << 17;
+    output.packed6 |= (uint32_t)(input.probeAdaptiveHysteresisVariabilityThreshold * 4095) << 18;
+    output.packed7  = (uint32_t)(input.probeAdaptiveHysteresisMin * 65535);
+    output.packed7 |= (uint32_t)(input.probeAdaptiveHysteresisMax * 65535) << 16;
+
+    // Irradiance Mips
+    output.packed6 |= (uint32_t)input.probeIrradianceMipsEnabled << 30;
+    output.probeIrradianceMipDistance = input.probeIrradianceMipDistance;
+
+    // Probe Visibility Masks
+    output.packed6 |= (uint32_t)input.probeVisibilityMaskEnabled << 31;
+
+    // GPU Convergence Tracking
+    output.packed8  = (uint32_t)input.probeConvergenceFreezeEnabled;
+    output.packed8 |= (input.probeConvergenceFrames & 0x7FFF) << 1;
+    output.packed8 |= (input.probeConvergenceWakeGeneration & 0xFF) << 16;
+    output.probeConvergenceVariabilityThreshold = input.probeConvergenceVariabilityThreshold;
+
     return output;
 }
 #endif // ifndef HLSL
@@ -209,13 +393,16 @@ DDGIVolumeDescGPU UnpackDDGIVolumeDescGPU(DDGIVolumeDescGPUPacked input)
     output.probeCounts.x = input.packed0 & 0x000003FF;
     output.probeCounts.y = (input.packed0 >> 10) & 0x000003FF;
     output.probeCounts.z = (input.packed0 >> 20) & 0x000003FF;
+    output.probeBlendingActiveOnly = (bool)((input.packed0 >> 30) & 0x00000001);
+    output.probeStateBitsEnabled = (bool)((input.packed0 >> 31) & 0x00000001);
 
     // Thresholds
     output.probeRandomRayBackfaceThreshold = (float)(input.packed1 & 0x0000FFFF) / 65535.f;
     output.probeFixedRayBackfaceThreshold = (float)((input.packed1 >> 16) & 0x0000FFFF) / 65535.f;
 
     // Counts
-    output.probeNumRays = input.packed2 & 0x0000FFFF;
+    output.probeNumRays = input.packed2 & 0x00001FFF;
+    output.probeTimeSliceStrideLog2 = (input.packed2 >> 13) & 0x00000007;
     output.probeNumIrradianceInteriorTexels = (input.packed2 >> 16) & 0x000000FF;
     output.probeNumDistanceInteriorTexels = (input.packed2 >> 24) & 0x000000FF;
 
@@ -241,6 +428,106 @@ DDGIVolumeDescGPU UnpackDDGIVolumeDescGPU(DDGIVolumeDescGPUPacked input)
     output.probeScrollDirections[1] = (bool)((input.packed4 >> 30) & 0x00000001);
     output.probeScrollDirections[2] = (bool)((input.packed4 >> 31) & 0x00000001);
 
+    // Probe Scheduling
+    output.probeSchedulingViewOrigin = input.probeSchedulingViewOrigin;
+    output.probeSchedulingEnabled = (bool)(input.packed5 & 0x00000001);
+    output.probeSchedulingMaxIntervalLog2 = (input.packed5 >> 1) & 0x00000007;
+    output.probeSchedulingFullRateDistance = (input.packed5 >> 4) & 0x000000FF;
+    output.probeSchedulingFrame = (input.packed5 >> 12) & 0x000000FF;
+    output.probeSchedulingVariabilityThreshold = (float)((input.packed5 >> 20) & 0x00000FFF) / 4095.f;
+
+    // Update Events
+    output.probeEventOrigin = input.probeEventOrigin;
+    output.probeEventRadius = input.probeEventRadius;
+
+    // Adaptive Rays
+    output.probeAdaptiveRaysEnabled = (bool)(input.packed6 & 0x00000001);
+    output.probeAdaptiveRaysMin = (input.packed6 >> 1) & 0x00001FFF;
+    output.probeAdaptiveRaysVariabilityThreshold = input.probeAdaptiveRaysVariabilityThreshold;
+
+    // Irradiance Encoding
+    output.probeIrradianceEncoding = (input.packed6 >> 14) & 0x00000003;
+
+    // Scroll Seeding
+    output.probeScrollSeedEnabled = (bool)((input.packed6 >> 16) & 0x00000001);
+
+    // Adaptive Hysteresis
+    output.probeAdaptiveHysteresisEnabled = (bool)((input.packed6 >> 17) & 0x00000001);
+    output.probeAdaptiveHysteresisVariabilityThreshold = (float)((input.packed6 >> 18) & 0x00000FFF) / 4095.f;
+    output.probeAdaptiveHysteresisMin = (float)(input.packed7 & 0x0000FFFF) / 65535.f;
+    output.probeAdaptiveHysteresisMax = (float)((input.packed7 >> 16) & 0x0000FFFF) / 65535.f;
+
+    // Irradiance Mips
+    output.probeIrradianceMipsEnabled = (bool)((input.packed6 >> 30) & 0x00000001);
+    output.probeIrradianceMipDistance = input.probeIrradianceMipDistance;
+
+    // Probe Visibility Masks
+    output.probeVisibilityMaskEnabled = (bool)((input.packed6 >> 31) & 0x00000001);
+
+    // GPU Convergence Tracking
+    output.probeConvergenceFreezeEnabled = (bool)(input.packed8 & 0x00000001);
+    output.probeConvergenceFrames = (input.packed8 >> 1) & 0x00007FFF;
+    output.probeConvergenceWakeGeneration = (input.packed8 >> 16) & 0x000000FF;
+    output.probeConvergenceVariabilityThreshold = input.probeConvergenceVariabilityThreshold;
+
+    // Specialization
+    // When every volume a shader samples shares an option, the application may pass the option's value in as a define.
+    // The unpacked value is replaced with the literal, so the compiler folds the option's branches out of the sampling code.
+#ifdef RTXGI_DDGI_SPECIALIZED_MOVEMENT_TYPE
+    output.movementType = RTXGI_DDGI_SPECIALIZED_MOVEMENT_TYPE;
+    #if RTXGI_DDGI_SPECIALIZED_MOVEMENT_TYPE == 0
+    output.probeScrollOffsets = int3(0, 0, 0);
+    output.probeScrollClear[0] = output.probeScrollClear[1] = output.probeScrollClear[2] = false;
+    output.probeScrollDirections[0] = output.probeScrollDirections[1] = output.probeScrollDirections[2] = false;
+    #endif
+#endif
+#ifdef RTXGI_DDGI_SPECIALIZED_RELOCATION
+    output.probeRelocationEnabled = (bool)RTXGI_DDGI_SPECIALIZED_RELOCATION;
+#endif
+#ifdef RTXGI_DDGI_SPECIALIZED_CLASSIFICATION
+    output.probeClassificationEnabled = (bool)RTXGI_DDGI_SPECIALIZED_CLASSIFICATION;
+#endif
+#ifdef RTXGI_DDGI_SPECIALIZED_STATE_BITS
+    output.probeStateBitsEnabled = (bool)RTXGI_DDGI_SPECIALIZED_STATE_BITS;
+#endif
+#ifdef RTXGI_DDGI_SPECIALIZED_VISIBILITY_MASK
+    output.probeVisibilityMaskEnabled = (bool)RTXGI_DDGI_SPECIALIZED_VISIBILITY_MASK;
+#endif
+#ifdef RTXGI_DDGI_SPECIALIZED_IRRADIANCE_FORMAT
+    output.probeIrradianceFormat = RTXGI_DDGI_SPECIALIZED_IRRADIANCE_FORMAT;
+#endif
+#ifdef RTXGI_DDGI_SPECIALIZED_IRRADIANCE_ENCODING
+    output.probeIrradianceEncoding = RTXGI_DDGI_SPECIALIZED_IRRADIANCE_ENCODING;
+#endif
+#ifdef RTXGI_DDGI_SPECIALIZED_IRRADIANCE_MIPS
+    output.probeIrradianceMipsEnabled = (bool)RTXGI_DDGI_SPECIALIZED_IRRADIANCE_MIPS;
+#endif
+#ifdef RTXGI_DDGI_SPECIALIZED_IRRADIANCE_TEXELS
+    output.probeNumIrradianceInteriorTexels = RTXGI_DDGI_SPECIALIZED_IRRADIANCE_TEXELS;
+#endif
+#ifdef RTXGI_DDGI_SPECIALIZED_DISTANCE_TEXELS
+    output.probeNumDistanceInteriorTexels = RTXGI_DDGI_SPECIALIZED_DISTANCE_TEXELS;
+#endif
+
+    return output;
+}
+
+#ifndef HLSL // CPU
+static inline rtxgi::DDGIVolumeBoundsGPU GetDDGIVolumeBoundsGPU(const rtxgi::DDGIVolumeDescGPU input)
+{
+    rtxgi::DDGIVolumeBoundsGPU output = {};
+#else // GPU
+DDGIVolumeBoundsGPU GetDDGIVolumeBoundsGPU(DDGIVolumeDescGPU input)
+{
+    DDGIVolumeBoundsGPU output = (DDGIVolumeBoundsGPU)0;
+#endif
+    output.center.x = input.origin.x + ((float)input.probeScrollOffsets.x * input.probeSpacing.x);
+    output.center.y = input.origin.y + ((float)input.probeScrollOffsets.y * input.probeSpacing.y);
+    output.center.z = input.origin.z + ((float)input.probeScrollOffsets.z * input.probeSpacing.z);
+    output.rotation = input.rotation;
+    output.probeSpacing = input.probeSpacing;
+    output.probeCounts = input.probeCounts;
+
     return output;
 }
 
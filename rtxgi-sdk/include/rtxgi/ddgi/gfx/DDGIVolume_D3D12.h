@@ -13,11 +13,39 @@
 #include "../DDGIVolume.h"
 
 #include <d3d12.h>
+#include <vector>
+
+// Number of probe data readback copies kept for sparse probe textures (see UpdateDDGIVolumeSparseTiles()), one per frame in flight
+#ifndef RTXGI_DDGI_SPARSE_READBACK_BUFFERS
+#define RTXGI_DDGI_SPARSE_READBACK_BUFFERS 2
+#endif
+
+// Number of average variability readback slots (see ReadbackDDGIVolumeVariability()), one per frame in flight
+#ifndef RTXGI_DDGI_VARIABILITY_READBACK_BUFFERS
+#define RTXGI_DDGI_VARIABILITY_READBACK_BUFFERS 2
+#endif
+
+// Size (in bytes) of the probe variability readback buffer, a D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT aligned slot per buffering index
+#define RTXGI_DDGI_VARIABILITY_READBACK_SIZE (D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT * RTXGI_DDGI_VARIABILITY_READBACK_BUFFERS)
+
+// Number of 64KB tiles in each heap backing sparse probe textures
+#ifndef RTXGI_DDGI_SPARSE_TILES_PER_HEAP
+#define RTXGI_DDGI_SPARSE_TILES_PER_HEAP 64
+#endif
+
+// Size (in bytes) of the heaps a DDGIVolumeResourcePool places probe textures in (larger textures get a heap of their own)
+#ifndef RTXGI_DDGI_RESOURCE_POOL_HEAP_SIZE
+#define RTXGI_DDGI_RESOURCE_POOL_HEAP_SIZE (64 * 1024 * 1024)
+#endif
 
 namespace rtxgi
 {
     namespace d3d12
     {
+        struct DDGIVolumeResourcePool;
+    #if RTXGI_DDGI_RESOURCE_MANAGEMENT
+        struct DDGIVolumeSparseResidency;
+    #endif
 
         enum class EBindlessType
         {
@@ -63,11 +91,26 @@ namespace rtxgi
             ShaderBytecode               extraReductionCS;                                  // Probe variability reduction extra passes compute shader bytecode
         };
 
+        struct ProbeSchedulingBytecode
+        {
+            ShaderBytecode               scheduleCS;                                        // Probe scheduling compute shader bytecode
+            ShaderBytecode               argsCS;                                            // Probe scheduling dispatch arguments compute shader bytecode
+            ShaderBytecode               derivationCS;                                      // [Optional] Probe derivation compute shader bytecode (required by DeriveDDGIVolumeProbes())
+        };
+
+        struct DDGIVolumeResourcePoolDesc
+        {
+            UINT64                       heapSizeInBytes = RTXGI_DDGI_RESOURCE_POOL_HEAP_SIZE; // Size of the heaps the probe textures are placed in
+            bool                         aliasProbeRayData = false;                          // Place the probe ray data of all the pool's volumes in the same memory, see DDGIVolume::AliasProbeRayData()
+            UINT                         maxRecycledVolumes = 0;                             // Streamed out volumes the pool keeps for reuse (oldest are destroyed first), see RecycleDDGIVolume()
+        };
+
         struct DDGIVolumeManagedResourcesDesc
         {
             bool                         enabled = false;                                    // Enable or disable managed resources mode
 
             ID3D12Device*                device = nullptr;                                   // D3D12 device pointer
+            DDGIVolumeResourcePool*      pool = nullptr;                                     // [Optional] Pool to place the probe textures in (committed resources when nullptr), see CreateDDGIVolumeResourcePool()
 
             // Shader bytecode
             ShaderBytecode               probeBlendingIrradianceCS;                          // Probe blending (irradiance) compute shader bytecode
@@ -76,6 +119,7 @@ namespace rtxgi
             ProbeRelocationBytecode      probeRelocation;                                    // Probe Relocation bytecode
             ProbeClassificationBytecode  probeClassification;                                // Probe Classification bytecode
             ProbeVariabilityByteCode     probeVariability;                                   // Probe Classification bytecode
+            ProbeSchedulingBytecode      probeScheduling;                                    // [Optional] Probe Scheduling bytecode (required when probe scheduling or probeBlendingActiveOnly is enabled)
         };
 
         //------------------------------------------------------------------------
@@ -100,6 +144,13 @@ namespace rtxgi
             ID3D12PipelineState*        extraReductionPSO = nullptr;                        // Probe variability extra reduction PSO
         };
 
+        struct ProbeSchedulingPSO
+        {
+            ID3D12PipelineState*        schedulePSO = nullptr;                              // Probe scheduling compute PSO
+            ID3D12PipelineState*        argsPSO = nullptr;                                  // Probe scheduling dispatch arguments compute PSO
+            ID3D12PipelineState*        derivationPSO = nullptr;                            // [Optional] Probe derivation compute PSO (required by DeriveDDGIVolumeProbes())
+        };
+
         struct DDGIVolumeUnmanagedResourcesDesc
         {
             bool                        enabled = false;                                    // Enable or disable unmanaged resources mode
@@ -120,7 +171,24 @@ namespace rtxgi
             ID3D12Resource*             probeData = nullptr;                                // Probe data texture array - XYZ: world-space relocation offsets | W: classification state
             ID3D12Resource*             probeVariability = nullptr;                         // Probe variability texture array
             ID3D12Resource*             probeVariabilityAverage = nullptr;                  // Average of Probe variability for whole volume
-            ID3D12Resource*             probeVariabilityReadback = nullptr;                 // CPU-readable resource containing final Probe variability average
+            ID3D12Resource*             probeVariabilityReadback = nullptr;                 // CPU-readable buffer of RTXGI_DDGI_VARIABILITY_READBACK_SIZE bytes containing final Probe variability averages
+
+            // Probe Scheduling Resources (required when probe scheduling or probeBlendingActiveOnly is enabled)
+            ID3D12Resource*             probeSchedule = nullptr;                            // Probe schedule buffer (UAV) - dispatch arguments, append counter, and scheduled probe indices
+            ID3D12Resource*             probeScheduleArgs = nullptr;                        // Indirect argument buffer the scheduled dispatch arguments are copied to
+            ID3D12CommandSignature*     probeScheduleCommandSignature = nullptr;            // Command signature with a single D3D12_INDIRECT_ARGUMENT_TYPE_DISPATCH argument
+
+            // Probe Spherical Harmonics Resources (required when probeIrradianceEncoding is a spherical harmonics encoding)
+            ID3D12Resource*             probeSH = nullptr;                                  // Probe spherical harmonics buffer (UAV) - RTXGI_DDGI_PROBE_SH_SIZE(numProbes) bytes of float3 coefficients
+
+            // Probe Irradiance Mips Resources (required when probeIrradianceMipsEnabled is set)
+            ID3D12Resource*             probeIrradianceMips = nullptr;                      // Probe irradiance mips buffer (UAV) - RTXGI_DDGI_PROBE_IRRADIANCE_MIPS_SIZE(numProbes) bytes of float3 texels
+
+            // Published Probe Texture Arrays (required when probeAtlasDoubleBuffered is set), same dimensions and formats as the probe textures.
+            // The SRVs of the probe irradiance, distance, and data (probe*SRVIndex) describe these textures.
+            ID3D12Resource*             probeIrradiancePublished = nullptr;                 // Published copy of the probe irradiance texture array
+            ID3D12Resource*             probeDistancePublished = nullptr;                   // Published copy of the probe distance texture array
+            ID3D12Resource*             probeDataPublished = nullptr;                       // Published copy of the probe data texture array
 
             // Pipeline State Objects
             ID3D12PipelineState*        probeBlendingIrradiancePSO = nullptr;               // Probe blending (irradiance) compute PSO
@@ -129,6 +197,7 @@ namespace rtxgi
             ProbeRelocationPSO          probeRelocation;                                    // Probe Relocation PSOs
             ProbeClassificationPSO      probeClassification;                                // Probe Classification PSOs
             ProbeVariabilityPSO         probeVariabilityPSOs;                               // Probe Variability PSOs
+            ProbeSchedulingPSO          probeScheduling;                                    // [Optional] Probe Scheduling PSOs (required when probe scheduling or probeBlendingActiveOnly is enabled)
         };
 
         //------------------------------------------------------------------------
@@ -220,11 +289,31 @@ namespace rtxgi
              */
             ERTXGIStatus ClearProbes(ID3D12GraphicsCommandList* cmdList);
 
+        #if RTXGI_DDGI_RESOURCE_MANAGEMENT
+            /**
+             * Maps and unmaps the tiles of the volume's sparse probe textures, see UpdateDDGIVolumeSparseTiles()
+             */
+            ERTXGIStatus UpdateSparseTiles(ID3D12CommandQueue* queue, ID3D12GraphicsCommandList* cmdList, UINT bufferingIndex);
+        #endif
+
             /**
              * Transitions volume resources to the appropriate state(s) for the given execution stage
              */
             void TransitionResources(ID3D12GraphicsCommandList* cmdList, EDDGIExecutionStage stage) const;
 
+        #if RTXGI_DDGI_RESOURCE_MANAGEMENT
+            /**
+             * Makes the volume's probe ray data the active resource of memory it shares with the ray data of other volumes
+             * (a pool with aliasProbeRayData). Record before tracing the volume's probe rays. Does nothing when the ray data isn't aliased.
+             */
+            void AliasProbeRayData(ID3D12GraphicsCommandList* cmdList) const;
+
+            /**
+             * Gets the pool the volume's probe textures are placed in (nullptr for committed textures)
+             */
+            DDGIVolumeResourcePool* GetResourcePool() const { return m_pool; }
+        #endif
+
             /**
              * Releases resources owned by the volume
              */
@@ -242,7 +331,7 @@ namespace rtxgi
             UINT GetRootParamSlotRootConstants() const { return m_rootParamSlotRootConstants; };
             UINT GetRootParamSlotResourceDescriptorTable() const { return m_rootParamSlotResourceDescriptorTable; }
             UINT GetRootParamSlotSamplerDescriptorTable() const { return m_rootParamSlotSamplerDescriptorTable; }
-            DDGIRootConstants GetRootConstants() const { return { m_desc.index, m_descriptorHeapDesc.constantsIndex, m_descriptorHeapDesc.resourceIndicesIndex, 0, 0, 0, 0 }; };
+            DDGIRootConstants GetRootConstants() const { return { m_desc.index, m_descriptorHeapDesc.constantsIndex, m_descriptorHeapDesc.resourceIndicesIndex, 0, 0, 0, m_probeDerivationVolumeIndex }; };
             bool GetBindlessEnabled() const { return m_bindlessResources.enabled; }
             EBindlessType GetBindlessType() const { return m_bindlessResources.type; }
 
@@ -280,6 +369,30 @@ namespace rtxgi
             ID3D12Resource* GetProbeVariabilityAverage() const { return m_probeVariabilityAverage; }
             ID3D12Resource* GetProbeVariabilityReadback() const { return m_probeVariabilityReadback; }
 
+            // Published Texture Arrays (the textures the volume's SRVs describe, the probe textures unless probeAtlasDoubleBuffered is set)
+            ID3D12Resource* GetProbeIrradianceSRV() const { return m_probeIrradiancePublished ? m_probeIrradiancePublished : m_probeIrradiance; }
+            ID3D12Resource* GetProbeDistanceSRV() const { return m_probeDistancePublished ? m_probeDistancePublished : m_probeDistance; }
+            ID3D12Resource* GetProbeDataSRV() const { return m_probeDataPublished ? m_probeDataPublished : m_probeData; }
+            bool GetProbesPublishPending() const { return m_probesPublishPending; }
+
+            // Marks the probe textures as written since they were last published, see PublishDDGIVolumeProbes()
+            void SetProbesPublishPending(bool value) { m_probesPublishPending = value; }
+
+            // Variability Readback Slots
+            bool GetProbeVariabilityReadbackValid(UINT bufferingIndex) const { return m_probeVariabilityReadbackValid[bufferingIndex]; }
+            void SetProbeVariabilityReadbackValid(UINT bufferingIndex, bool value) { m_probeVariabilityReadbackValid[bufferingIndex] = value; }
+
+            // Probe Scheduling
+            ID3D12Resource* GetProbeSchedule() const { return m_probeSchedule; }
+            ID3D12Resource* GetProbeScheduleArgs() const { return m_probeScheduleArgs; }
+            ID3D12CommandSignature* GetProbeScheduleCommandSignature() const { return m_probeScheduleCommandSignature; }
+
+            // Probe Spherical Harmonics
+            ID3D12Resource* GetProbeSH() const { return m_probeSH; }
+
+            // Probe Irradiance Mips
+            ID3D12Resource* GetProbeIrradianceMips() const { return m_probeIrradianceMips; }
+
             // Pipeline State Objects
             ID3D12PipelineState* GetProbeBlendingIrradiancePSO() const { return m_probeBlendingIrradiancePSO; }
             ID3D12PipelineState* GetProbeBlendingDistancePSO() const { return m_probeBlendingDistancePSO; }
@@ -289,6 +402,9 @@ namespace rtxgi
             ID3D12PipelineState* GetProbeClassificationResetPSO() const { return m_probeClassificationResetPSO; }
             ID3D12PipelineState* GetProbeVariabilityReductionPSO() const { return m_probeVariabilityReductionPSO; }
             ID3D12PipelineState* GetProbeVariabilityExtraReductionPSO() const { return m_probeVariabilityExtraReductionPSO; }
+            ID3D12PipelineState* GetProbeSchedulingPSO() const { return m_probeSchedulingPSO; }
+            ID3D12PipelineState* GetProbeSchedulingArgsPSO() const { return m_probeSchedulingArgsPSO; }
+            ID3D12PipelineState* GetProbeDerivationPSO() const { return m_probeDerivationPSO; }
 
             //------------------------------------------------------------------------
             // Resource Setters
@@ -333,6 +449,11 @@ namespace rtxgi
             void SetProbeData(ID3D12Resource* ptr) { m_probeData = ptr; }
             void SetProbeVariability(ID3D12Resource* ptr) { m_probeVariability = ptr; }
             void SetProbeVariabilityAverage(ID3D12Resource* ptr) { m_probeVariabilityAverage = ptr; }
+            void SetProbeSchedule(ID3D12Resource* ptr) { m_probeSchedule = ptr; }
+            void SetProbeScheduleArgs(ID3D12Resource* ptr) { m_probeScheduleArgs = ptr; }
+            void SetProbeScheduleCommandSignature(ID3D12CommandSignature* ptr) { m_probeScheduleCommandSignature = ptr; }
+            void SetProbeSH(ID3D12Resource* ptr) { m_probeSH = ptr; }
+            void SetProbeIrradianceMips(ID3D12Resource* ptr) { m_probeIrradianceMips = ptr; }
         #endif
 
         private:
@@ -353,7 +474,25 @@ namespace rtxgi
             ID3D12Resource*                 m_probeData = nullptr;                              // Probe data texture array - XYZ: world-space relocation offsets | W: classification state
             ID3D12Resource*                 m_probeVariability = nullptr;                       // Probe luminance difference from previous update
             ID3D12Resource*                 m_probeVariabilityAverage = nullptr;                // Average Probe variability for whole volume
-            ID3D12Resource*                 m_probeVariabilityReadback = nullptr;               // CPU-readable buffer with average Probe variability
+            ID3D12Resource*                 m_probeVariabilityReadback = nullptr;               // CPU-readable buffer with average Probe variability, one slot per buffering index
+            bool                            m_probeVariabilityReadbackValid[RTXGI_DDGI_VARIABILITY_READBACK_BUFFERS] = {}; // Whether a slot holds a copy not yet read back
+
+            // Probe Scheduling
+            ID3D12Resource*                 m_probeSchedule = nullptr;                          // Dispatch arguments, append counter, and list of probes scheduled this frame
+            ID3D12Resource*                 m_probeScheduleArgs = nullptr;                      // Copy of the scheduled dispatch arguments, in the indirect argument state
+            ID3D12CommandSignature*         m_probeScheduleCommandSignature = nullptr;          // Indirect dispatch command signature for scheduled passes
+
+            // Probe Spherical Harmonics
+            ID3D12Resource*                 m_probeSH = nullptr;                                // Spherical harmonics irradiance coefficients of each probe
+
+            // Probe Irradiance Mips
+            ID3D12Resource*                 m_probeIrradianceMips = nullptr;                    // Pre-filtered (2x2 and average) irradiance of each probe
+
+            // Published Texture Arrays (probeAtlasDoubleBuffered)
+            ID3D12Resource*                 m_probeIrradiancePublished = nullptr;               // Copy of the probe irradiance read by the irradiance SRV, see PublishDDGIVolumeProbes()
+            ID3D12Resource*                 m_probeDistancePublished = nullptr;                 // Copy of the probe distance read by the distance SRV
+            ID3D12Resource*                 m_probeDataPublished = nullptr;                     // Copy of the probe data read by the probe data SRV
+            bool                            m_probesPublishPending = false;                     // The probe textures were written since they were last published
 
             // Render Target Views
             D3D12_CPU_DESCRIPTOR_HANDLE     m_probeIrradianceRTV = { 0 };                       // Probe irradiance render target view
@@ -380,9 +519,16 @@ namespace rtxgi
             ID3D12PipelineState*            m_probeClassificationResetPSO = nullptr;            // Probe classification reset compute shader pipeline state object
             ID3D12PipelineState*            m_probeVariabilityReductionPSO = nullptr;           // Probe variability reduction
             ID3D12PipelineState*            m_probeVariabilityExtraReductionPSO = nullptr;      // Probe variability extra reduction pass
+            ID3D12PipelineState*            m_probeSchedulingPSO = nullptr;                     // Probe scheduling compute shader pipeline state object
+            ID3D12PipelineState*            m_probeSchedulingArgsPSO = nullptr;                 // Probe scheduling dispatch arguments compute shader pipeline state object
+            ID3D12PipelineState*            m_probeDerivationPSO = nullptr;                     // Probe derivation compute shader pipeline state object
 
         #if RTXGI_DDGI_RESOURCE_MANAGEMENT
             ID3D12DescriptorHeap*           m_rtvDescriptorHeap = nullptr;                      // Descriptor heap for render target views
+            DDGIVolumeSparseResidency*      m_sparseResidency = nullptr;                        // Tile mappings of the sparse probe textures (when enabled)
+            DDGIVolumeResourcePool*         m_pool = nullptr;                                   // Pool the probe textures are placed in (when provided)
+            bool                            m_probeRayDataAliased = false;                      // The probe ray data shares memory with other volumes' ray data
+            UINT64                          m_shaderHash = 0;                                   // Hash of the shader bytecode the pipeline state objects were created from
 
             ERTXGIStatus CreateManagedResources(const DDGIVolumeDesc& desc, const DDGIVolumeManagedResourcesDesc& managed);
             void ReleaseManagedResources();
@@ -390,13 +536,22 @@ namespace rtxgi
             bool CreateDescriptors();
             bool CreateRootSignature();
             bool CreateComputePSO(ShaderBytecode shader, ID3D12PipelineState** pipeline, const char* debugName = nullptr);
-            bool CreateTexture(UINT64 width, UINT height, UINT arraySize, DXGI_FORMAT format, D3D12_RESOURCE_STATES state, D3D12_RESOURCE_FLAGS flags, ID3D12Resource** resource);
+            bool CreateTexture(UINT64 width, UINT height, UINT arraySize, DXGI_FORMAT format, D3D12_RESOURCE_STATES state, D3D12_RESOURCE_FLAGS flags, ID3D12Resource** resource, bool reserved = false, bool transient = false);
+            void ReleaseTexture(ID3D12Resource*& resource);
+            void ReleaseTextures();
             bool CreateProbeRayData(const DDGIVolumeDesc& desc);
             bool CreateProbeIrradiance(const DDGIVolumeDesc& desc);
             bool CreateProbeDistance(const DDGIVolumeDesc& desc);
             bool CreateProbeData(const DDGIVolumeDesc& desc);
             bool CreateProbeVariability(const DDGIVolumeDesc& desc);
             bool CreateProbeVariabilityAverage(const DDGIVolumeDesc& desc);
+            bool CreateProbeSchedule(const DDGIVolumeDesc& desc);
+            bool CreateProbeScheduleCommandSignature();
+            bool CreateProbeSH(const DDGIVolumeDesc& desc);
+            bool CreateProbeIrradianceMips(const DDGIVolumeDesc& desc);
+            bool CreateProbesPublished(const DDGIVolumeDesc& desc);
+            bool CreateSparseResidency(const DDGIVolumeDesc& desc);
+            void ReleaseSparseResidency();
 
             bool IsDeviceChanged(const DDGIVolumeManagedResourcesDesc& desc)
             {
@@ -421,39 +576,136 @@ namespace rtxgi
 
         /**
          * Uploads constants for one or more volumes to the GPU.
+         * Only volumes whose constants changed since their last upload are copied, and copies of adjacent volumes are merged.
+         * Call DDGIVolume::ResetConstantsUploaded() if the device constants buffer is written by other means.
+         * The volumes' packed constants can be passed in gpuDescs (one per volume, e.g. packed on worker threads with
+         * DDGIVolume::GetDescGPUPacked() after the volumes' Update()), otherwise they are packed here.
          * This function is for convenience and isn't necessary if you upload volume constants yourself.
          */
-        RTXGI_API ERTXGIStatus UploadDDGIVolumeConstants(ID3D12GraphicsCommandList* cmdList, UINT bufferingIndex, UINT numVolumes, DDGIVolume** volumes);
+        RTXGI_API ERTXGIStatus UploadDDGIVolumeConstants(ID3D12GraphicsCommandList* cmdList, UINT bufferingIndex, UINT numVolumes, DDGIVolume** volumes, const DDGIVolumeDescGPUPacked* gpuDescs = nullptr);
 
         /**
          * Updates one or more volume's probes using data in the volume's radiance texture.
          * Probe blending and border update workloads are batched together for better performance.
+         * With probe scheduling enabled, only the probes selected by ScheduleDDGIVolumeProbes() are blended.
+         * With probeBlendingActiveOnly set, only the probes the last ClassifyDDGIVolumeProbes() found active are blended.
+         * Both require the blending shaders to be compiled with RTXGI_DDGI_PROBE_SCHEDULING=1.
+         * Volume resources are expected to be in the D3D12_RESOURCE_STATE_UNORDERED_ACCESS state.
+         * With deferredBarriers set, the barriers that end the pass are appended to it instead of recorded, so the caller can
+         * flush the barriers of several volumes at once (barriers between passes of the same volume are still recorded).
+         */
+        RTXGI_API ERTXGIStatus UpdateDDGIVolumeProbes(ID3D12GraphicsCommandList* cmdList, UINT numVolumes, DDGIVolume* volumes, std::vector<D3D12_RESOURCE_BARRIER>* deferredBarriers = nullptr);
+
+        /**
+         * Copies the probe irradiance, distance, and data textures of one or more volumes with probeAtlasDoubleBuffered over their
+         * published copies (the textures the volumes' SRVs describe), for the volumes whose probes were updated since they were last published.
+         * Record at the start of the frame, before the probe updates and any pass that samples the volumes: sampling then reads the
+         * previous frame's probes and doesn't wait on this frame's probe updates, which can run alongside it (e.g. on another queue).
+         * Does nothing for other volumes. The textures are expected to be in the D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE state (like ClearProbes()).
+         */
+        RTXGI_API ERTXGIStatus PublishDDGIVolumeProbes(ID3D12GraphicsCommandList* cmdList, UINT numVolumes, DDGIVolume** volumes);
+
+        /**
+         * Selects the probes of one or more volumes to trace and blend this frame, from the probe classification states,
+         * probe variability, and distance to the volume's probe scheduling view origin. Writes the list of scheduled probes and
+         * the indirect dispatch arguments of the probe trace (ray groups x scheduled probes) and blending (one group per probe) passes.
+         * Does nothing for volumes with probe scheduling disabled. Call before tracing probe rays.
          * Volume resources are expected to be in the D3D12_RESOURCE_STATE_UNORDERED_ACCESS state.
          */
-        RTXGI_API ERTXGIStatus UpdateDDGIVolumeProbes(ID3D12GraphicsCommandList* cmdList, UINT numVolumes, DDGIVolume* volumes);
+        RTXGI_API ERTXGIStatus ScheduleDDGIVolumeProbes(ID3D12GraphicsCommandList* cmdList, UINT numVolumes, DDGIVolume* volumes);
+
+        /**
+         * Writes the irradiance of one or more volume's derived probes (see DDGIVolumeBase::SetProbeDerivationVolumeIndex()) from the
+         * probes of their derivation volume, instead of blending traced rays. Each derived texel trilinearly interpolates the texels of the
+         * derivation volume's eight surrounding probes in the texel's direction. Octahedral irradiance only (the irradiance mips of derived
+         * probes are left to their traced updates). Does nothing for volumes without a derivation volume. Requires bindless resources and
+         * the volume's probe derivation PSO. Call after both volumes' UpdateDDGIVolumeProbes().
+         * Volume resources are expected to be in the D3D12_RESOURCE_STATE_UNORDERED_ACCESS state.
+         */
+        RTXGI_API ERTXGIStatus DeriveDDGIVolumeProbes(ID3D12GraphicsCommandList* cmdList, UINT numVolumes, DDGIVolume* volumes);
 
         /**
          * Adjusts one or more volume's world-space probe positions to avoid them being too close to or inside of geometry.
          * If a volume has the reset flag set, all probe relocation offsets are set to zero before relocation occurs.
          * Volume resources are expected to be in the D3D12_RESOURCE_STATE_UNORDERED_ACCESS state.
+         * Barriers can be deferred as with UpdateDDGIVolumeProbes().
          */
-        RTXGI_API ERTXGIStatus RelocateDDGIVolumeProbes(ID3D12GraphicsCommandList* cmdList, UINT numVolumes, DDGIVolume* volumes);
+        RTXGI_API ERTXGIStatus RelocateDDGIVolumeProbes(ID3D12GraphicsCommandList* cmdList, UINT numVolumes, DDGIVolume* volumes, std::vector<D3D12_RESOURCE_BARRIER>* deferredBarriers = nullptr);
 
         /**
          * Classifies one or more volume's probes as active or inactive based on the hit distance data in the ray data texture.
          * If a volume has the reset flag set, all probes are set to active before classification occurs.
+         * With probeBlendingActiveOnly set, the active probes are also compacted into the volume's probe list for the next
+         * UpdateDDGIVolumeProbes(), which requires the classification shader to be compiled with RTXGI_DDGI_PROBE_SCHEDULING=1.
          * Volume resources are expected to be in the D3D12_RESOURCE_STATE_UNORDERED_ACCESS state.
+         * Barriers can be deferred as with UpdateDDGIVolumeProbes().
+         */
+        RTXGI_API ERTXGIStatus ClassifyDDGIVolumeProbes(ID3D12GraphicsCommandList* cmdList, UINT numVolumes, DDGIVolume* volumes, std::vector<D3D12_RESOURCE_BARRIER>* deferredBarriers = nullptr);
+
+        /**
+         * Calculates average variability for all probes in each provided volume.
+         * The average is copied to the readback slot of bufferingIndex (usually the frame index), see ReadbackDDGIVolumeVariability().
+         * Barriers can be deferred as with UpdateDDGIVolumeProbes().
+         */
+        RTXGI_API ERTXGIStatus CalculateDDGIVolumeVariability(ID3D12GraphicsCommandList* cmdList, UINT bufferingIndex, UINT numVolumes, DDGIVolume* volumes, std::vector<D3D12_RESOURCE_BARRIER>* deferredBarriers = nullptr);
+
+        /**
+         * Reads back average variability for each provided volume from the readback slot of bufferingIndex, without waiting on the GPU.
+         * The slot holds the average that CalculateDDGIVolumeVariability() copied with the same bufferingIndex, so the frame that
+         * recorded it must have completed on the GPU (call after waiting on that frame's fence, before recording this frame's copy).
+         * Each copy is read once, volumes whose slot holds no new copy keep their variability and convergence state.
+         */
+        RTXGI_API ERTXGIStatus ReadbackDDGIVolumeVariability(UINT bufferingIndex, UINT numVolumes, DDGIVolume* volumes);
+
+    #if RTXGI_DDGI_RESOURCE_MANAGEMENT
+        /**
+         * Updates the resident tiles of one or more volume's sparse probe textures (volumes with probeSparseTexturesEnabled).
+         * Maps memory to the irradiance, distance, and variability tiles that hold active probes, clears the newly mapped
+         * irradiance and distance tiles, and returns the memory of tiles without active probes to the volume's tile heaps.
+         * Probe states are read from a copy of the probe data this function records, RTXGI_DDGI_SPARSE_READBACK_BUFFERS calls
+         * earlier with the same bufferingIndex, so the frame that recorded it must have completed on the GPU.
+         * Tile mappings are updated on the queue immediately, submit cmdList to the same queue and call before tracing probe rays.
+         * The probe irradiance, distance, and data textures are expected to be in the D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE state (like ClearProbes()).
+         */
+        RTXGI_API ERTXGIStatus UpdateDDGIVolumeSparseTiles(ID3D12CommandQueue* queue, ID3D12GraphicsCommandList* cmdList, UINT bufferingIndex, UINT numVolumes, DDGIVolume** volumes);
+
+        /**
+         * Creates a pool that places the probe texture arrays of managed volumes in shared heaps instead of a committed resource each.
+         * Volumes created with the pool (DDGIVolumeManagedResourcesDesc::pool) reuse the memory of destroyed or reallocated volume
+         * textures, so creating and destroying volumes (e.g. while streaming) rarely allocates memory. Heaps are kept until the pool is destroyed.
+         * Placed probe textures are not zero initialized, clear them with DDGIVolume::ClearProbes() before the volume's first update.
+         *
+         * With aliasProbeRayData, the ray data of every volume in the pool aliases the same memory, which lowers peak memory to one
+         * ray data texture array. Ray data is read from the probe trace until the volume's RelocateDDGIVolumeProbes() and ClassifyDDGIVolumeProbes(),
+         * so the application must trace and update one volume at a time and record DDGIVolume::AliasProbeRayData() before each volume's probe trace.
+         */
+        RTXGI_API ERTXGIStatus CreateDDGIVolumeResourcePool(ID3D12Device* device, const DDGIVolumeResourcePoolDesc& desc, DDGIVolumeResourcePool** pool);
+
+        /**
+         * Releases the heaps of a pool and destroys the volumes recycled in it. Destroy the other volumes created with the pool first.
+         */
+        RTXGI_API void DestroyDDGIVolumeResourcePool(DDGIVolumeResourcePool*& pool);
+
+        /**
+         * Gets the GPU memory (in bytes) of the pool's heaps
          */
-        RTXGI_API ERTXGIStatus ClassifyDDGIVolumeProbes(ID3D12GraphicsCommandList* cmdList, UINT numVolumes, DDGIVolume* volumes);
+        RTXGI_API UINT64 GetDDGIVolumeResourcePoolSizeInBytes(const DDGIVolumeResourcePool* pool);
 
         /**
-         * Calculates average variability for all probes in each provided volume
+         * Keeps a streamed out volume created with the pool for reuse instead of destroying it. The volume keeps its probe textures,
+         * RTV descriptor heap, root signature, and pipeline state objects, and the pool takes ownership of it (volume is set to nullptr).
+         * When the pool holds more than maxRecycledVolumes volumes, the oldest is destroyed. The GPU must be done with the volume.
+         * Returns false (and leaves the volume to the application) when the pool keeps no volumes or the volume wasn't created with the pool.
          */
-        RTXGI_API ERTXGIStatus CalculateDDGIVolumeVariability(ID3D12GraphicsCommandList* cmdList, UINT numVolumes, DDGIVolume* volumes);
+        RTXGI_API bool RecycleDDGIVolume(DDGIVolumeResourcePool* pool, DDGIVolume*& volume);
 
         /**
-         * Reads back average variability for each provided volume, at the time of the call
+         * Takes a recycled volume of the size class of desc out of the pool: the same probe counts, ray and texel counts, texture formats,
+         * and optional probe buffers. Returns nullptr when the pool has none. The application owns the returned volume, call Create() with
+         * desc (which keeps the textures, and the pipeline state objects when the shader bytecode is the same), then clear its
+         * previous probes with DDGIVolume::ClearProbes() before the volume's first update.
          */
-        RTXGI_API ERTXGIStatus ReadbackDDGIVolumeVariability(UINT numVolumes, DDGIVolume* volumes);
+        RTXGI_API DDGIVolume* AcquireDDGIVolume(DDGIVolumeResourcePool* pool, const DDGIVolumeDesc& desc);
+    #endif
     } // namespace d3d12
 } // namespace rtxgi
@@ -14,10 +14,16 @@
 
 #include <vulkan/vulkan.h>
 
+// Size (in bytes) of the device memory blocks a DDGIMemoryPool suballocates from
+#ifndef RTXGI_DDGI_MEMORY_POOL_BLOCK_SIZE
+#define RTXGI_DDGI_MEMORY_POOL_BLOCK_SIZE (64 * 1024 * 1024)
+#endif
+
 namespace rtxgi
 {
     namespace vulkan
     {
+        struct DDGIMemoryPool;
 
         enum class EResourceViewType
         {
@@ -37,6 +43,44 @@ namespace rtxgi
             ProbeVariabilityAverage
         };
 
+        //------------------------------------------------------------------------
+        // Device Memory Pool (shared by the SDK and the application)
+        //------------------------------------------------------------------------
+
+        struct DDGIMemoryPoolDesc
+        {
+            VkDeviceSize                 blockSizeInBytes = RTXGI_DDGI_MEMORY_POOL_BLOCK_SIZE;        // Size of the device memory blocks allocations are placed in
+            VkDeviceSize                 dedicatedSizeInBytes = RTXGI_DDGI_MEMORY_POOL_BLOCK_SIZE / 2; // Allocations of at least this size get a device memory allocation of their own
+        };
+
+        struct DDGIMemoryAllocationDesc
+        {
+            VkMemoryRequirements         requirements = {};                                  // Size, alignment, and memory types of the resource
+            VkMemoryPropertyFlags        properties = 0;                                     // Required memory properties
+            VkMemoryAllocateFlags        flags = 0;                                          // Memory allocation flags (e.g. VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT)
+            bool                         linear = true;                                      // Buffers and linear images, optimal tiling images are kept in separate blocks (bufferImageGranularity)
+            bool                         dedicated = false;                                  // Request a device memory allocation of its own (e.g. render targets, VkMemoryDedicatedRequirements)
+            void*                        userData = nullptr;                                 // [Optional] Application data, passed to the defragmentation callback
+        };
+
+        struct DDGIMemoryAllocation
+        {
+            VkDeviceMemory               memory = nullptr;                                   // Device memory the allocation is in (shared with other allocations unless dedicated)
+            VkDeviceSize                 offset = 0;                                         // Offset (in bytes) of the allocation in memory
+            VkDeviceSize                 size = 0;                                           // Size (in bytes) of the allocation
+            VkDeviceSize                 alignment = 0;                                      // Alignment (in bytes) of the allocation's offset
+            void*                        mappedData = nullptr;                               // Host pointer to the allocation, host visible memory is persistently mapped (nullptr otherwise)
+            void*                        userData = nullptr;                                 // Application data, see DDGIMemoryAllocationDesc
+            uint32_t                     blockIndex = UINT32_MAX;                            // Pool block the allocation is in (UINT32_MAX for dedicated allocations)
+        };
+
+        /**
+         * Called by DefragmentDDGIMemoryPool() for each allocation it moves.
+         * Create the allocation's resource again bound at the destination memory and offset, record a copy from the current resource,
+         * and return true. Return false to leave the allocation in place. The pool updates the allocation once the callback returns true.
+         */
+        typedef bool (*DDGIMemoryMoveCallback)(DDGIMemoryAllocation* allocation, VkDeviceMemory dstMemory, VkDeviceSize dstOffset, void* userData);
+
         //------------------------------------------------------------------------
         // Managed Resource Mode (SDK manages volume resources)
         //------------------------------------------------------------------------
@@ -66,6 +110,7 @@ namespace rtxgi
             VkDevice                     device = nullptr;                                   // Vulkan device handle
             VkPhysicalDevice             physicalDevice = nullptr;                           // Vulkan physical device handle
             VkDescriptorPool             descriptorPool = nullptr;                           // Vulkan descriptor pool
+            DDGIMemoryPool*              memoryPool = nullptr;                               // [Optional] Pool to suballocate the probe texture memory from (an allocation per texture when nullptr), see CreateDDGIMemoryPool()
 
             // Shader bytecode
             ShaderBytecode               probeBlendingIrradianceCS;                          // Probe blending (irradiance) compute shader bytecode
@@ -267,7 +312,7 @@ namespace rtxgi
 
             // Push Constants
             uint32_t GetPushConstantsOffset() const { return m_pushConstantsOffset; }
-            DDGIRootConstants GetPushConstants() const { return { m_desc.index, 0, 0, 0, 0, 0 }; }
+            DDGIRootConstants GetPushConstants() const { return { m_desc.index, 0, 0, 0, 0, 0, RTXGI_DDGI_PROBE_DERIVATION_NONE }; }
 
             // Resource Indices (Bindless)
             DDGIVolumeResourceIndices GetResourceIndices() const { return m_bindlessResources.resourceIndices; }
@@ -378,6 +423,7 @@ namespace rtxgi
             VkDevice                        m_device = nullptr;                                 // Vulkan device handle
             VkPhysicalDevice                m_physicalDevice = nullptr;                         // Vulkan physical device handle
             VkDescriptorPool                m_descriptorPool = nullptr;                         // Vulkan descriptor pool handle
+            DDGIMemoryPool*                 m_memoryPool = nullptr;                             // Pool the probe texture memory is suballocated from (when provided)
         #endif
 
             // Volume Constants (if you use UploadDDGIVolumeConstants() to transfer constants to the GPU)
@@ -404,6 +450,16 @@ namespace rtxgi
             VkDeviceMemory                  m_probeVariabilityAverageMemory = nullptr;          // Probe variability average memory
             VkDeviceMemory                  m_probeVariabilityReadbackMemory = nullptr;         // Probe variability readback memory
 
+        #if RTXGI_DDGI_RESOURCE_MANAGEMENT
+            // Texture Array Memory Pool Allocations (Managed Resources)
+            DDGIMemoryAllocation*           m_probeRayDataAllocation = nullptr;                 // Probe ray data memory pool allocation
+            DDGIMemoryAllocation*           m_probeIrradianceAllocation = nullptr;              // Probe irradiance memory pool allocation
+            DDGIMemoryAllocation*           m_probeDistanceAllocation = nullptr;                // Probe distance memory pool allocation
+            DDGIMemoryAllocation*           m_probeDataAllocation = nullptr;                    // Probe data memory pool allocation
+            DDGIMemoryAllocation*           m_probeVariabilityAllocation = nullptr;             // Probe variability memory pool allocation
+            DDGIMemoryAllocation*           m_probeVariabilityAverageAllocation = nullptr;      // Probe variability average memory pool allocation
+        #endif
+
             // Texture Array Views
             VkImageView                     m_probeRayDataView = nullptr;                       // Probe ray data view
             VkImageView                     m_probeIrradianceView = nullptr;                    // Probe irradiance view
@@ -451,11 +507,12 @@ namespace rtxgi
 
             void Transition(VkCommandBuffer cmdBuffer);
             bool AllocateMemory(VkMemoryRequirements reqs, VkMemoryPropertyFlags props, VkMemoryAllocateFlags flags, VkDeviceMemory* memory);
+            void ReleaseMemory(VkDeviceMemory& memory, DDGIMemoryAllocation*& allocation);
 
             bool CreateDescriptorSet();
             bool CreateLayouts();
             bool CreateComputePipeline(ShaderBytecode shader, const char* entryPoint, VkShaderModule* module, VkPipeline* pipeline, const char* debugName);
-            bool CreateTexture(uint32_t width, uint32_t height, uint32_t arraySize, VkFormat format, VkImageUsageFlags usage, VkImage* image, VkDeviceMemory* imageMemory, VkImageView* imageView);
+            bool CreateTexture(uint32_t width, uint32_t height, uint32_t arraySize, VkFormat format, VkImageUsageFlags usage, VkImage* image, VkDeviceMemory* imageMemory, DDGIMemoryAllocation** allocation, VkImageView* imageView);
             bool CreateProbeRayData(const DDGIVolumeDesc& desc);
             bool CreateProbeIrradiance(const DDGIVolumeDesc& desc);
             bool CreateProbeDistance(const DDGIVolumeDesc& desc);
@@ -486,9 +543,13 @@ namespace rtxgi
 
         /**
          * Uploads constants for one or more volumes to the GPU.
+         * Only volumes whose constants changed since their last upload are copied, and copies of adjacent volumes are merged.
+         * Call DDGIVolume::ResetConstantsUploaded() if the device constants buffer is written by other means.
+         * The volumes' packed constants can be passed in gpuDescs (one per volume, e.g. packed on worker threads with
+         * DDGIVolume::GetDescGPUPacked() after the volumes' Update()), otherwise they are packed here.
          * This function is for convenience and isn't necessary if you upload volume constants yourself.
          */
-        RTXGI_API ERTXGIStatus UploadDDGIVolumeConstants(VkDevice device, VkCommandBuffer cmdBuffer, uint32_t bufferingIndex, uint32_t numVolumes, DDGIVolume** volumes);
+        RTXGI_API ERTXGIStatus UploadDDGIVolumeConstants(VkDevice device, VkCommandBuffer cmdBuffer, uint32_t bufferingIndex, uint32_t numVolumes, DDGIVolume** volumes, const DDGIVolumeDescGPUPacked* gpuDescs = nullptr);
 
         /**
          * Updates one or more volume's probes using data in the volume's radiance texture.
@@ -517,5 +578,69 @@ namespace rtxgi
          * Reads back average variability for each provided volume, at the time of the call
          */
         RTXGI_API ERTXGIStatus ReadbackDDGIVolumeVariability(VkDevice device, uint32_t numVolumes, DDGIVolume** volumes);
+
+        //------------------------------------------------------------------------
+        // Public RTXGI Vulkan namespace Device Memory Pool Functions
+        //------------------------------------------------------------------------
+
+        /**
+         * Creates a pool that suballocates buffer and image memory from large device memory blocks instead of a device memory allocation each.
+         * Keeps the number of device memory allocations far below maxMemoryAllocationCount on large scenes and makes resource creation cheaper.
+         * Blocks are created per memory type, allocation flags, and linear / optimal tiling, and are kept until released with
+         * ReleaseDDGIMemoryPoolEmptyBlocks() or the pool is destroyed. Host visible blocks are persistently mapped.
+         * The pool can be shared by the application and managed volumes (DDGIVolumeManagedResourcesDesc::memoryPool). It is not thread safe.
+         */
+        RTXGI_API ERTXGIStatus CreateDDGIMemoryPool(VkDevice device, VkPhysicalDevice physicalDevice, const DDGIMemoryPoolDesc& desc, DDGIMemoryPool** pool);
+
+        /**
+         * Releases the device memory of a pool. Free the pool's allocations (and destroy the volumes that use the pool) first.
+         */
+        RTXGI_API void DestroyDDGIMemoryPool(DDGIMemoryPool*& pool);
+
+        /**
+         * Allocates memory from the pool. Allocations with desc.dedicated set, or at least DDGIMemoryPoolDesc::dedicatedSizeInBytes large,
+         * get a device memory allocation of their own. The allocation is owned by the pool, release it with FreeDDGIMemory().
+         */
+        RTXGI_API ERTXGIStatus AllocateDDGIMemory(DDGIMemoryPool* pool, const DDGIMemoryAllocationDesc& desc, DDGIMemoryAllocation** allocation);
+
+        /**
+         * Allocates memory for a buffer from the pool and binds it to the buffer.
+         * Buffers that prefer or require a dedicated allocation (VkMemoryDedicatedRequirements) get one.
+         */
+        RTXGI_API ERTXGIStatus AllocateDDGIBufferMemory(DDGIMemoryPool* pool, VkBuffer buffer, VkMemoryPropertyFlags properties, VkMemoryAllocateFlags flags, DDGIMemoryAllocation** allocation);
+
+        /**
+         * Allocates memory for an optimal tiling image from the pool and binds it to the image.
+         * Images that prefer or require a dedicated allocation (VkMemoryDedicatedRequirements) get one.
+         */
+        RTXGI_API ERTXGIStatus AllocateDDGIImageMemory(DDGIMemoryPool* pool, VkImage image, VkMemoryPropertyFlags properties, DDGIMemoryAllocation** allocation);
+
+        /**
+         * Returns an allocation's memory to the pool (dedicated allocations are released). The resource bound to it must no longer be in use.
+         */
+        RTXGI_API void FreeDDGIMemory(DDGIMemoryPool* pool, DDGIMemoryAllocation*& allocation);
+
+        /**
+         * Moves allocations out of the most sparsely used blocks into the free ranges of the other blocks of the same kind, at most maxMoves of them.
+         * The callback is called for each move (see DDGIMemoryMoveCallback), dedicated allocations are not moved. Returns the number of moved allocations.
+         * The ranges moved from are still read by the recorded copies: wait for the copies to complete before allocating from the pool again,
+         * then call ReleaseDDGIMemoryPoolEmptyBlocks() to release the blocks that were emptied.
+         */
+        RTXGI_API uint32_t DefragmentDDGIMemoryPool(DDGIMemoryPool* pool, DDGIMemoryMoveCallback callback, void* userData, uint32_t maxMoves);
+
+        /**
+         * Releases the pool's blocks that have no allocations. Returns the number of released blocks.
+         */
+        RTXGI_API uint32_t ReleaseDDGIMemoryPoolEmptyBlocks(DDGIMemoryPool* pool);
+
+        /**
+         * Gets the device memory (in bytes) allocated by the pool, blocks and dedicated allocations
+         */
+        RTXGI_API VkDeviceSize GetDDGIMemoryPoolSizeInBytes(const DDGIMemoryPool* pool);
+
+        /**
+         * Gets the number of device memory allocations made by the pool, blocks and dedicated allocations
+         */
+        RTXGI_API uint32_t GetDDGIMemoryPoolDeviceAllocationCount(const DDGIMemoryPool* pool);
     } // namespace vulkan
 } // namespace rtxgi
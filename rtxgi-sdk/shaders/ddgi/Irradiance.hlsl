@@ -13,14 +13,168 @@
 
 #include "include/ProbeCommon.hlsl"
 
+// Probe visibility tests available to DDGIGetVolumeIrradianceFast()
+#define RTXGI_DDGI_IRRADIANCE_VISIBILITY_CHEBYSHEV 0    // Chebyshev test with the mean and variance of the probe distance (same as DDGIGetVolumeIrradiance())
+#define RTXGI_DDGI_IRRADIANCE_VISIBILITY_MEAN 1         // Compares the mean probe distance only, skips the variance and contrast math
+#define RTXGI_DDGI_IRRADIANCE_VISIBILITY_NONE 2         // No distance texture fetch, probes are weighted by wrap shading and trilinear weights only
+
+// Define RTXGI_DDGI_IRRADIANCE_VISIBILITY before including this file to select a cheaper visibility test
+#ifndef RTXGI_DDGI_IRRADIANCE_VISIBILITY
+#define RTXGI_DDGI_IRRADIANCE_VISIBILITY RTXGI_DDGI_IRRADIANCE_VISIBILITY_CHEBYSHEV
+#endif
+
+// Define RTXGI_DDGI_PROBE_STATE_BITS to 1 before including this file to read probe states from the probe state bits
+// of the volume's probe schedule buffer (when the volume's probeStateBitsEnabled is set) instead of the probe data texture.
+// DDGIVolumeResources::probeSchedule must then be set. D3D12 only.
+#ifndef RTXGI_DDGI_PROBE_STATE_BITS
+#define RTXGI_DDGI_PROBE_STATE_BITS 0
+#endif
+
+// Define RTXGI_DDGI_PROBE_VISIBILITY_MASK to 1 before including this file to skip the distance texture fetch and visibility test of
+// probes whose bit is set in the probe visibility mask of the shading point's probe cage cell (when the volume's probeVisibilityMaskEnabled is set).
+// DDGIVolumeResources::probeSchedule must then be set. D3D12 only.
+#ifndef RTXGI_DDGI_PROBE_VISIBILITY_MASK
+#define RTXGI_DDGI_PROBE_VISIBILITY_MASK 0
+#endif
+
+// Define RTXGI_DDGI_PROBE_IRRADIANCE_SH to 1 before including this file to evaluate the probe spherical harmonics
+// coefficients (when the volume's probeIrradianceEncoding is not octahedral) instead of sampling the irradiance texture.
+// DDGIVolumeResources::probeSH must then be set. D3D12 only.
+#ifndef RTXGI_DDGI_PROBE_IRRADIANCE_SH
+#define RTXGI_DDGI_PROBE_IRRADIANCE_SH 0
+#endif
+
+// Define RTXGI_DDGI_PROBE_IRRADIANCE_MIPS to 1 before including this file to sample the pre-filtered probe irradiance mips
+// (when the volume's probeIrradianceMipsEnabled is set) for distant shading points, see DDGIGetProbeIrradianceLOD().
+// DDGIVolumeResources::probeIrradianceMips must then be set. D3D12 only.
+#ifndef RTXGI_DDGI_PROBE_IRRADIANCE_MIPS
+#define RTXGI_DDGI_PROBE_IRRADIANCE_MIPS 0
+#endif
+
 struct DDGIVolumeResources
 {
     Texture2DArray<float4> probeIrradiance;
     Texture2DArray<float4> probeDistance;
     Texture2DArray<float4> probeData;
     SamplerState bilinearSampler;
+#if RTXGI_DDGI_PROBE_STATE_BITS || RTXGI_DDGI_PROBE_VISIBILITY_MASK
+    RWByteAddressBuffer probeSchedule;
+#endif
+#if RTXGI_DDGI_PROBE_IRRADIANCE_SH
+    RWStructuredBuffer<float3> probeSH;
+#endif
+#if RTXGI_DDGI_PROBE_IRRADIANCE_MIPS
+    RWStructuredBuffer<float3> probeIrradianceMips;
+#endif
 };
 
+/**
+ * Returns true when the probe is inactive and should not contribute to irradiance.
+ */
+bool DDGIIsProbeInactive(int probeIndex, DDGIVolumeDescGPU volume, DDGIVolumeResources resources)
+{
+    if (!volume.probeClassificationEnabled) return false;
+#if RTXGI_DDGI_PROBE_STATE_BITS
+    if (volume.probeStateBitsEnabled) return DDGILoadProbeStateBit(probeIndex, resources.probeSchedule, volume);
+#endif
+    return (DDGILoadProbeState(probeIndex, resources.probeData, volume) == RTXGI_DDGI_PROBE_STATE_INACTIVE);
+}
+
+/**
+ * Returns the visibility mask of the probe cage cell with the given base probe (see DDGILoadProbeVisibilityMask()).
+ * Takes the grid-space distance from the base probe to the biased shading point, the mask only holds inside the cell.
+ * Returns 0 (every probe runs its visibility test) outside of the cell or when the volume has no visibility masks.
+ */
+uint DDGIGetProbeCellVisibilityMask(int3 baseProbeCoords, float3 gridSpaceDistance, DDGIVolumeDescGPU volume, DDGIVolumeResources resources)
+{
+#if RTXGI_DDGI_PROBE_VISIBILITY_MASK
+    if (!volume.probeVisibilityMaskEnabled) return 0;
+
+    // Points beyond the volume's outer probes are outside of every cell
+    float3 cellPosition = (gridSpaceDistance / volume.probeSpacing);
+    if (any(cellPosition < 0.f) || any(cellPosition > 1.f)) return 0;
+    if (any((baseProbeCoords + int3(1, 1, 1)) >= volume.probeCounts)) return 0;
+
+    return DDGILoadProbeVisibilityMask(DDGIGetScrollingProbeIndex(baseProbeCoords, volume), resources.probeSchedule, volume);
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Returns the probe irradiance level of detail in [0, 2] for a shading point at the given distance from the view.
+ * Level 0 samples the full resolution irradiance texels, level 1 the 2x2 texel irradiance mip, and level 2 the probe's
+ * average irradiance. The level rises from 0 at the volume's probeIrradianceMipDistance to 1 at twice and 2 at four times that distance.
+ * Always 0 when the volume's probeIrradianceMipsEnabled is not set.
+ */
+float DDGIGetProbeIrradianceLOD(float viewDistance, DDGIVolumeDescGPU volume)
+{
+    if (!volume.probeIrradianceMipsEnabled || viewDistance <= volume.probeIrradianceMipDistance) return 0.f;
+    return min(log2(viewDistance / volume.probeIrradianceMipDistance), 2.f);
+}
+
+#if RTXGI_DDGI_PROBE_IRRADIANCE_MIPS
+/**
+ * Samples the probe's irradiance mips (see RTXGI_DDGI_PROBE_IRRADIANCE_MIP_TEXELS) at the given level of detail in [1, 2].
+ * The 2x2 mip is filtered bilinearly (clamped to the probe) and flattened towards the probe's average irradiance above level 1.
+ * Returns linear irradiance.
+ */
+float3 DDGISampleProbeIrradianceMips(int probeIndex, float2 octantCoords, float irradianceLOD, DDGIVolumeResources resources)
+{
+    uint baseIndex = (probeIndex * RTXGI_DDGI_PROBE_IRRADIANCE_MIP_TEXELS);
+    if (irradianceLOD >= 2.f) return resources.probeIrradianceMips[baseIndex + 4];
+
+    // Bilinear weights between the 2x2 mip texel centers (at octahedral coordinates -0.5 and 0.5)
+    float2 weights = saturate(octantCoords + 0.5f);
+    float3 irradiance = lerp(
+        lerp(resources.probeIrradianceMips[baseIndex + 0], resources.probeIrradianceMips[baseIndex + 1], weights.x),
+        lerp(resources.probeIrradianceMips[baseIndex + 2], resources.probeIrradianceMips[baseIndex + 3], weights.x),
+        weights.y);
+
+    if (irradianceLOD > 1.f) irradiance = lerp(irradiance, resources.probeIrradianceMips[baseIndex + 4], irradianceLOD - 1.f);
+    return irradiance;
+}
+#endif
+
+/**
+ * Samples the probe's irradiance in the given direction (octantCoords are the direction's octahedral coordinates).
+ * Decodes the tone curve, but leaves a gamma = 2 curve to approximate sRGB blending.
+ * irradianceLOD is the level of detail from DDGIGetProbeIrradianceLOD(), used with RTXGI_DDGI_PROBE_IRRADIANCE_MIPS.
+ */
+float3 DDGISampleProbeIrradiance(int probeIndex, float3 direction, float2 octantCoords, DDGIVolumeDescGPU volume, DDGIVolumeResources resources, float irradianceLOD = 0.f)
+{
+#if RTXGI_DDGI_PROBE_IRRADIANCE_SH
+    if (volume.probeIrradianceEncoding != RTXGI_DDGI_PROBE_IRRADIANCE_ENCODING_OCTAHEDRAL)
+    {
+        // Spherical harmonics coefficients are stored in linear space
+        return sqrt(DDGIEvaluateProbeSH(probeIndex, direction, resources.probeSH, volume));
+    }
+#endif
+
+#if RTXGI_DDGI_PROBE_IRRADIANCE_MIPS
+    // Distant shading points read the pre-filtered mips (stored in linear space) instead of the full resolution texels
+    float3 mipIrradiance = float3(0.f, 0.f, 0.f);
+    if (volume.probeIrradianceMipsEnabled && irradianceLOD > 0.f)
+    {
+        mipIrradiance = DDGISampleProbeIrradianceMips(probeIndex, octantCoords, max(irradianceLOD, 1.f), resources);
+        if (irradianceLOD >= 1.f) return sqrt(mipIrradiance);
+    }
+#endif
+
+    float3 probeTextureUV = DDGIGetProbeUV(probeIndex, octantCoords, volume.probeNumIrradianceInteriorTexels, volume);
+    float3 probeIrradiance = resources.probeIrradiance.SampleLevel(resources.bilinearSampler, probeTextureUV, 0).rgb;
+
+    float3 exponent = volume.probeIrradianceEncodingGamma * 0.5f;
+    probeIrradiance = pow(probeIrradiance, exponent);
+
+#if RTXGI_DDGI_PROBE_IRRADIANCE_MIPS
+    // Blend across the transition from the full resolution texels to the first mip
+    if (volume.probeIrradianceMipsEnabled && irradianceLOD > 0.f) probeIrradiance = lerp(probeIrradiance, sqrt(mipIrradiance), irradianceLOD);
+#endif
+
+    return probeIrradiance;
+}
+
 /**
  * Computes the surfaceBias parameter used by DDGIGetVolumeIrradiance().
  * The surfaceNormal and cameraDirection arguments are expected to be normalized.
@@ -36,38 +190,129 @@ float3 DDGIGetSurfaceBias(float3 surfaceNormal, float3 cameraDirection, DDGIVolu
  * Positions outside the volume receive a weight in [0, 1] that
  * decreases as the position moves away from the volume.
  */ 
-float DDGIGetVolumeBlendWeight(float3 worldPosition, DDGIVolumeDescGPU volume)
+float DDGIGetVolumeBlendWeight(float3 worldPosition, DDGIVolumeBoundsGPU bounds)
 {
-    // Get the volume's origin and extent
-    float3 origin = volume.origin + (volume.probeScrollOffsets * volume.probeSpacing);
-    float3 extent = (volume.probeSpacing * (volume.probeCounts - 1)) * 0.5f;
+    // Get the volume's extent
+    float3 extent = (bounds.probeSpacing * (bounds.probeCounts - 1)) * 0.5f;
 
     // Get the delta between the (rotated volume) and the world-space position
-    float3 position = (worldPosition - origin);
-    position = abs(RTXGIQuaternionRotate(position, RTXGIQuaternionConjugate(volume.rotation)));
+    float3 position = (worldPosition - bounds.center);
+    position = abs(RTXGIQuaternionRotate(position, RTXGIQuaternionConjugate(bounds.rotation)));
 
     float3 delta = position - extent;
     if(all(delta < 0)) return 1.f;
 
     // Adjust the blend weight for each axis
     float volumeBlendWeight = 1.f;
-    volumeBlendWeight *= (1.f - saturate(delta.x / volume.probeSpacing.x));
-    volumeBlendWeight *= (1.f - saturate(delta.y / volume.probeSpacing.y));
-    volumeBlendWeight *= (1.f - saturate(delta.z / volume.probeSpacing.z));
+    volumeBlendWeight *= (1.f - saturate(delta.x / bounds.probeSpacing.x));
+    volumeBlendWeight *= (1.f - saturate(delta.y / bounds.probeSpacing.y));
+    volumeBlendWeight *= (1.f - saturate(delta.z / bounds.probeSpacing.z));
 
     return volumeBlendWeight;
 }
 
+float DDGIGetVolumeBlendWeight(float3 worldPosition, DDGIVolumeDescGPU volume)
+{
+    return DDGIGetVolumeBlendWeight(worldPosition, GetDDGIVolumeBoundsGPU(volume));
+}
+
+/**
+ * Computes a weight value in the range [0, 1] for a world position and volume pair
+ * that fades out across the outermost probe cell of the volume.
+ * Positions more than one probe spacing inside the volume receive a weight of 1.
+ * Positions on or outside the volume's boundary receive a weight of 0.
+ */
+float DDGIGetVolumeInteriorWeight(float3 worldPosition, DDGIVolumeBoundsGPU bounds)
+{
+    // Get the volume's extent
+    float3 extent = (bounds.probeSpacing * (bounds.probeCounts - 1)) * 0.5f;
+
+    // Get the delta between the (rotated volume) and the world-space position
+    float3 position = (worldPosition - bounds.center);
+    position = abs(RTXGIQuaternionRotate(position, RTXGIQuaternionConjugate(bounds.rotation)));
+
+    // Distance to the volume's boundary, in probe cells
+    float3 delta = (extent - position) / bounds.probeSpacing;
+    return saturate(min(delta.x, min(delta.y, delta.z)));
+}
+
+float DDGIGetVolumeInteriorWeight(float3 worldPosition, DDGIVolumeDescGPU volume)
+{
+    return DDGIGetVolumeInteriorWeight(worldPosition, GetDDGIVolumeBoundsGPU(volume));
+}
+
+/**
+ * Finds the finest level of a DDGIClipmap that covers the given world position.
+ * The clipmap's levels are consecutive volumes in the DDGIVolume constants structured buffer,
+ * starting at firstVolumeIndex and ordered from finest to coarsest (see DDGIClipmap.h).
+ * Returns the level. nextLevelWeight is the weight in [0, 1] of the next (coarser) level, nonzero
+ * across the outermost probe cell of the returned level, to hide the transition between levels.
+ * Positions outside of every level return the coarsest level, weight it with DDGIGetVolumeBlendWeight().
+ */
+uint DDGIGetClipmapLevel(
+    float3 worldPosition,
+    StructuredBuffer<DDGIVolumeDescGPUPacked> volumes,
+    uint firstVolumeIndex,
+    uint numLevels,
+    out float nextLevelWeight)
+{
+    nextLevelWeight = 0.f;
+
+    uint level = 0;
+    for (; level < (numLevels - 1); level++)
+    {
+        DDGIVolumeDescGPU volume = UnpackDDGIVolumeDescGPU(volumes[firstVolumeIndex + level]);
+
+        float weight = DDGIGetVolumeInteriorWeight(worldPosition, volume);
+        if (weight > 0.f)
+        {
+            nextLevelWeight = (1.f - weight);
+            break;
+        }
+    }
+
+    return level;
+}
+
+/**
+ * Finds the finest level of a DDGIClipmap that covers the given world position, reading the levels' DDGIVolumeBoundsGPU
+ * instead of unpacking their DDGIVolumeDescGPUPacked. See DDGIGetClipmapLevel() above.
+ */
+uint DDGIGetClipmapLevel(
+    float3 worldPosition,
+    StructuredBuffer<DDGIVolumeBoundsGPU> volumeBounds,
+    uint firstVolumeIndex,
+    uint numLevels,
+    out float nextLevelWeight)
+{
+    nextLevelWeight = 0.f;
+
+    uint level = 0;
+    for (; level < (numLevels - 1); level++)
+    {
+        float weight = DDGIGetVolumeInteriorWeight(worldPosition, volumeBounds[firstVolumeIndex + level]);
+        if (weight > 0.f)
+        {
+            nextLevelWeight = (1.f - weight);
+            break;
+        }
+    }
+
+    return level;
+}
+
 /**
  * Computes irradiance for the given world-position using the given volume, surface bias, 
  * sampling direction, and volume resources.
+ * Pass an irradianceLOD from DDGIGetProbeIrradianceLOD() to sample the probe irradiance mips for distant shading points.
  */
 float3 DDGIGetVolumeIrradiance(
     float3 worldPosition,
     float3 surfaceBias,
     float3 direction,
     DDGIVolumeDescGPU volume,
-    DDGIVolumeResources resources)
+    DDGIVolumeResources resources,
+    float irradianceLOD = 0.f)
 {
     float3 irradiance = float3(0.f, 0.f, 0.f);
     float  accumulatedWeights = 0.f;
@@ -86,6 +331,9 @@ float3 DDGIGetVolumeIrradiance(
     if(!IsVolumeMovementScrolling(volume)) gridSpaceDistance = RTXGIQuaternionRotate(gridSpaceDistance, RTXGIQuaternionConjugate(volume.rotation));
     float3 alpha = clamp((gridSpaceDistance / volume.probeSpacing), float3(0.f, 0.f, 0.f), float3(1.f, 1.f, 1.f));
 
+    // Get the probes that see the whole cell, their visibility test always passes
+    uint visibleProbeMask = DDGIGetProbeCellVisibilityMask(baseProbeCoords, gridSpaceDistance, volume, resources);
+
     // Iterate over the 8 closest probes and accumulate their contributions
     for(int probeIndex = 0; probeIndex < 8; probeIndex++)
     {
@@ -101,8 +349,7 @@ float3 DDGIGetVolumeIrradiance(
         int adjacentProbeIndex = DDGIGetScrollingProbeIndex(adjacentProbeCoords, volume);
 
         // Early Out: don't allow inactive probes to contribute to irradiance
-        int probeState = DDGILoadProbeState(adjacentProbeIndex, resources.probeData, volume);
-        if (probeState == RTXGI_DDGI_PROBE_STATE_INACTIVE) continue;
+        if (DDGIIsProbeInactive(adjacentProbeIndex, volume, resources)) continue;
 
         // Get the adjacent probe's world position
         float3 adjacentProbeWorldPosition = DDGIGetProbeWorldPosition(adjacentProbeCoords, volume, resources.probeData);
@@ -128,28 +375,31 @@ float3 DDGIGetVolumeIrradiance(
         float wrapShading = (dot(worldPosToAdjProbe, direction) + 1.f) * 0.5f;
         weight *= (wrapShading * wrapShading) + 0.2f;
 
-        // Compute the octahedral coordinates of the adjacent probe
-        float2 octantCoords = DDGIGetOctahedralCoordinates(-biasedPosToAdjProbe);
+        float chebyshevWeight = 1.f;
+        if (((visibleProbeMask >> probeIndex) & 1) == 0)
+        {
+            // Compute the octahedral coordinates of the adjacent probe
+            float2 octantCoords = DDGIGetOctahedralCoordinates(-biasedPosToAdjProbe);
 
-        // Get the texture array coordinates for the octant of the probe
-        float3 probeTextureUV = DDGIGetProbeUV(adjacentProbeIndex, octantCoords, volume.probeNumDistanceInteriorTexels, volume);
+            // Get the texture array coordinates for the octant of the probe
+            float3 probeTextureUV = DDGIGetProbeUV(adjacentProbeIndex, octantCoords, volume.probeNumDistanceInteriorTexels, volume);
 
-        // Sample the probe's distance texture to get the mean distance to nearby surfaces
-        float2 filteredDistance = 2.f * resources.probeDistance.SampleLevel(resources.bilinearSampler, probeTextureUV, 0).rg;
+            // Sample the probe's distance texture to get the mean distance to nearby surfaces
+            float2 filteredDistance = 2.f * resources.probeDistance.SampleLevel(resources.bilinearSampler, probeTextureUV, 0).rg;
 
-        // Find the variance of the mean distance
-        float variance = abs((filteredDistance.x * filteredDistance.x) - filteredDistance.y);
+            // Find the variance of the mean distance
+            float variance = abs((filteredDistance.x * filteredDistance.x) - filteredDistance.y);
 
-        // Occlusion test
-        float chebyshevWeight = 1.f;
-        if(biasedPosToAdjProbeDist > filteredDistance.x) // occluded
-        {
-            // v must be greater than 0, which is guaranteed by the if condition above.
-            float v = biasedPosToAdjProbeDist - filteredDistance.x;
-            chebyshevWeight = variance / (variance + (v * v));
+            // Occlusion test
+            if(biasedPosToAdjProbeDist > filteredDistance.x) // occluded
+            {
+                // v must be greater than 0, which is guaranteed by the if condition above.
+                float v = biasedPosToAdjProbeDist - filteredDistance.x;
+                chebyshevWeight = variance / (variance + (v * v));
 
-            // Increase the contrast in the weight
-            chebyshevWeight = max((chebyshevWeight * chebyshevWeight * chebyshevWeight), 0.f);
+                // Increase the contrast in the weight
+                chebyshevWeight = max((chebyshevWeight * chebyshevWeight * chebyshevWeight), 0.f);
+            }
         }
 
         // Avoid visibility weights ever going all the way to zero because
@@ -171,17 +421,10 @@ float3 DDGIGetVolumeIrradiance(
         weight *= trilinearWeight;
 
         // Get the octahedral coordinates for the sample direction
-        octantCoords = DDGIGetOctahedralCoordinates(direction);
-
-        // Get the probe's texture coordinates
-        probeTextureUV = DDGIGetProbeUV(adjacentProbeIndex, octantCoords, volume.probeNumIrradianceInteriorTexels, volume);
+        float2 octantCoords = DDGIGetOctahedralCoordinates(direction);
 
-        // Sample the probe's irradiance
-        float3 probeIrradiance = resources.probeIrradiance.SampleLevel(resources.bilinearSampler, probeTextureUV, 0).rgb;
-
-        // Decode the tone curve, but leave a gamma = 2 curve to approximate sRGB blending
-        float3 exponent = volume.probeIrradianceEncodingGamma * 0.5f;
-        probeIrradiance = pow(probeIrradiance, exponent);
+        // Sample the probe's irradiance (gamma = 2)
+        float3 probeIrradiance = DDGISampleProbeIrradiance(adjacentProbeIndex, direction, octantCoords, volume, resources, irradianceLOD);
 
         // Accumulate the weighted irradiance
         irradiance += (weight * probeIrradiance);
@@ -195,7 +438,207 @@ float3 DDGIGetVolumeIrradiance(
     irradiance *= RTXGI_2PI;                    // Multiply by the area of the integration domain (hemisphere) to complete the Monte Carlo Estimator equation
 
     // Adjust for energy loss due to reduced precision in the R10G10B10A2 irradiance texture format
-    if (volume.probeIrradianceFormat == RTXGI_DDGI_VOLUME_TEXTURE_FORMAT_U32)
+    if (volume.probeIrradianceFormat == RTXGI_DDGI_VOLUME_TEXTURE_FORMAT_U32 && volume.probeIrradianceEncoding == RTXGI_DDGI_PROBE_IRRADIANCE_ENCODING_OCTAHEDRAL)
+    {
+        irradiance *= 1.0989f;
+    }
+
+    return irradiance;
+}
+
+/**
+ * Computes irradiance for the given world-position using the given volume, surface bias,
+ * sampling direction, and volume resources. Same result as DDGIGetVolumeIrradiance() with
+ * the default RTXGI_DDGI_IRRADIANCE_VISIBILITY, but cheaper:
+ * - the probe data of the 8 probes of the cell is loaded once up front (offset and state in one fetch, or the
+ *   probe state bits with RTXGI_DDGI_PROBE_STATE_BITS) and packed into an 8-bit mask of the active probes,
+ *   so inactive probes are skipped without further work
+ * - the trilinear weights, the probe grid positions, and the sample direction's octahedral coordinates
+ *   are computed once per cell instead of once per probe
+ * - with RTXGI_DDGI_PROBE_VISIBILITY_MASK, probes that see the whole cell skip the distance fetch (as in DDGIGetVolumeIrradiance())
+ * Pass an irradianceLOD from DDGIGetProbeIrradianceLOD() to sample the probe irradiance mips for distant shading points.
+ */
+float3 DDGIGetVolumeIrradianceFast(
+    float3 worldPosition,
+    float3 surfaceBias,
+    float3 direction,
+    DDGIVolumeDescGPU volume,
+    DDGIVolumeResources resources,
+    float irradianceLOD = 0.f)
+{
+    // Bias the world space position
+    float3 biasedWorldPosition = (worldPosition + surfaceBias);
+
+    // Get the 3D grid coordinates of the probe nearest the biased world position (i.e. the "base" probe)
+    int3   baseProbeCoords = DDGIGetBaseProbeGridCoords(biasedWorldPosition, volume);
+
+    // Get the world-space position of the base probe (ignore relocation)
+    float3 baseProbeWorldPosition = DDGIGetProbeWorldPosition(baseProbeCoords, volume);
+
+    // Clamp the distance (in grid space) between the given point and the base probe's world position (on each axis) to [0, 1]
+    float3 gridSpaceDistance = (biasedWorldPosition - baseProbeWorldPosition);
+    if(!IsVolumeMovementScrolling(volume)) gridSpaceDistance = RTXGIQuaternionRotate(gridSpaceDistance, RTXGIQuaternionConjugate(volume.rotation));
+    float3 alpha = clamp((gridSpaceDistance / volume.probeSpacing), float3(0.f, 0.f, 0.f), float3(1.f, 1.f, 1.f));
+
+    // Trilinear weights for an adjacent probe offset of 0 and 1 on each axis
+    float3 trilinear0 = max(0.001f, 1.f - alpha);
+    float3 trilinear1 = max(0.001f, alpha);
+
+    // World-space steps between adjacent probes on each grid axis (ignore relocation)
+    float3 probeStepX = float3(volume.probeSpacing.x, 0.f, 0.f);
+    float3 probeStepY = float3(0.f, volume.probeSpacing.y, 0.f);
+    float3 probeStepZ = float3(0.f, 0.f, volume.probeSpacing.z);
+    if (!IsVolumeMovementScrolling(volume))
+    {
+        probeStepX = RTXGIQuaternionRotate(probeStepX, volume.rotation);
+        probeStepY = RTXGIQuaternionRotate(probeStepY, volume.rotation);
+        probeStepZ = RTXGIQuaternionRotate(probeStepZ, volume.rotation);
+    }
+
+    // Load the probe data of the 8 closest probes and pack the active probes into a mask:
+    // bit n is set when the probe at adjacent offset (n & 1, (n >> 1) & 1, (n >> 2) & 1) contributes
+    int    adjacentProbeIndices[8];
+    float3 adjacentProbeWorldPositions[8];
+    uint   activeProbeMask = 0;
+    for(int probeIndex = 0; probeIndex < 8; probeIndex++)
+    {
+        int3 adjacentProbeOffset = int3(probeIndex, probeIndex >> 1, probeIndex >> 2) & int3(1, 1, 1);
+
+        // Get the 3D grid coordinates of the adjacent probe by adding the offset to
+        // the base probe and clamping to the grid boundaries
+        int3 adjacentProbeCoords = clamp(baseProbeCoords + adjacentProbeOffset, int3(0, 0, 0), volume.probeCounts - int3(1, 1, 1));
+        int3 adjacentProbeDelta = (adjacentProbeCoords - baseProbeCoords);
+
+        // Get the adjacent probe's index, adjusting the adjacent probe index for scrolling offsets (if present)
+        adjacentProbeIndices[probeIndex] = DDGIGetScrollingProbeIndex(adjacentProbeCoords, volume);
+
+        // Get the adjacent probe's world position from the base probe
+        adjacentProbeWorldPositions[probeIndex] = baseProbeWorldPosition + (adjacentProbeDelta.x * probeStepX) + (adjacentProbeDelta.y * probeStepY) + (adjacentProbeDelta.z * probeStepZ);
+
+    #if RTXGI_DDGI_PROBE_STATE_BITS
+        // The state bits reject inactive probes without a probe data fetch, only active probes load their offset
+        if (volume.probeStateBitsEnabled)
+        {
+            if (DDGIIsProbeInactive(adjacentProbeIndices[probeIndex], volume, resources)) continue;
+            if (volume.probeRelocationEnabled)
+            {
+                adjacentProbeWorldPositions[probeIndex] += DDGILoadProbeDataOffset(resources.probeData, DDGIGetProbeTexelCoords(adjacentProbeIndices[probeIndex], volume), volume);
+            }
+            activeProbeMask |= (1u << probeIndex);
+            continue;
+        }
+    #endif
+
+        // The probe's offset and state share one probe data texel
+        bool active = true;
+        if (volume.probeRelocationEnabled || volume.probeClassificationEnabled)
+        {
+            float4 probeData = resources.probeData.Load(int4(DDGIGetProbeTexelCoords(adjacentProbeIndices[probeIndex], volume), 0));
+            if (volume.probeRelocationEnabled) adjacentProbeWorldPositions[probeIndex] += (probeData.xyz * volume.probeSpacing);
+            if (volume.probeClassificationEnabled) active = (probeData.w != RTXGI_DDGI_PROBE_STATE_INACTIVE);
+        }
+        activeProbeMask |= (active ? (1u << probeIndex) : 0u);
+    }
+
+    // Early Out: no probe of the cell is active
+    if (activeProbeMask == 0) return float3(0.f, 0.f, 0.f);
+
+    // Get the probes that see the whole cell, their visibility test always passes
+    uint visibleProbeMask = DDGIGetProbeCellVisibilityMask(baseProbeCoords, gridSpaceDistance, volume, resources);
+
+    // Get the octahedral coordinates for the sample direction (shared by all probes)
+    float2 irradianceOctantCoords = DDGIGetOctahedralCoordinates(direction);
+
+    float3 irradiance = float3(0.f, 0.f, 0.f);
+    float  accumulatedWeights = 0.f;
+
+    // Iterate over the active probes and accumulate their contributions
+    while (activeProbeMask != 0)
+    {
+        int probeIndex = (int)firstbitlow(activeProbeMask);
+        activeProbeMask &= (activeProbeMask - 1);
+
+        int3   adjacentProbeOffset = int3(probeIndex, probeIndex >> 1, probeIndex >> 2) & int3(1, 1, 1);
+        int    adjacentProbeIndex = adjacentProbeIndices[probeIndex];
+        float3 adjacentProbeWorldPosition = adjacentProbeWorldPositions[probeIndex];
+
+        // Compute the distance and direction from the (biased and non-biased) shading point and the adjacent probe
+        float3 worldPosToAdjProbe = normalize(adjacentProbeWorldPosition - worldPosition);
+        float3 biasedPosToAdjProbe = normalize(adjacentProbeWorldPosition - biasedWorldPosition);
+        float  biasedPosToAdjProbeDist = length(adjacentProbeWorldPosition - biasedWorldPosition);
+
+        // Select the precomputed trilinear weights
+        float3 trilinear = (adjacentProbeOffset != 0) ? trilinear1 : trilinear0;
+        float  trilinearWeight = (trilinear.x * trilinear.y * trilinear.z);
+        float  weight = 1.f;
+
+        // Wrap shading (see DDGIGetVolumeIrradiance())
+        float wrapShading = (dot(worldPosToAdjProbe, direction) + 1.f) * 0.5f;
+        weight *= (wrapShading * wrapShading) + 0.2f;
+
+    #if RTXGI_DDGI_IRRADIANCE_VISIBILITY != RTXGI_DDGI_IRRADIANCE_VISIBILITY_NONE
+        float visibilityWeight = 1.f;
+        if (((visibleProbeMask >> probeIndex) & 1) == 0)
+        {
+            // Sample the probe's distance texture to get the mean distance to nearby surfaces
+            float2 octantCoords = DDGIGetOctahedralCoordinates(-biasedPosToAdjProbe);
+            float3 probeTextureUV = DDGIGetProbeUV(adjacentProbeIndex, octantCoords, volume.probeNumDistanceInteriorTexels, volume);
+            float2 filteredDistance = 2.f * resources.probeDistance.SampleLevel(resources.bilinearSampler, probeTextureUV, 0).rg;
+
+            // Occlusion test
+            if(biasedPosToAdjProbeDist > filteredDistance.x) // occluded
+            {
+            #if RTXGI_DDGI_IRRADIANCE_VISIBILITY == RTXGI_DDGI_IRRADIANCE_VISIBILITY_MEAN
+                // Fall off with the ratio of the mean distance to the distance of the shading point
+                visibilityWeight = filteredDistance.x / biasedPosToAdjProbeDist;
+                visibilityWeight = (visibilityWeight * visibilityWeight * visibilityWeight);
+            #else
+                // Find the variance of the mean distance
+                float variance = abs((filteredDistance.x * filteredDistance.x) - filteredDistance.y);
+
+                // v must be greater than 0, which is guaranteed by the if condition above.
+                float v = biasedPosToAdjProbeDist - filteredDistance.x;
+                visibilityWeight = variance / (variance + (v * v));
+
+                // Increase the contrast in the weight
+                visibilityWeight = max((visibilityWeight * visibilityWeight * visibilityWeight), 0.f);
+            #endif
+            }
+        }
+
+        // Avoid visibility weights ever going all the way to zero because
+        // when *no* probe has visibility we need a fallback value
+        weight *= max(0.05f, visibilityWeight);
+    #endif
+
+        // Avoid a weight of zero
+        weight = max(0.000001f, weight);
+
+        // A small amount of light is visible due to logarithmic perception, so
+        // crush tiny weights but keep the curve continuous
+        const float crushThreshold = 0.2f;
+        if (weight < crushThreshold)
+        {
+            weight *= (weight * weight) * (1.f / (crushThreshold * crushThreshold));
+        }
+
+        // Apply the trilinear weights
+        weight *= trilinearWeight;
+
+        // Sample the probe's irradiance (gamma = 2)
+        float3 probeIrradiance = DDGISampleProbeIrradiance(adjacentProbeIndex, direction, irradianceOctantCoords, volume, resources, irradianceLOD);
+
+        // Accumulate the weighted irradiance
+        irradiance += (weight * probeIrradiance);
+        accumulatedWeights += weight;
+    }
+
+    irradiance *= (1.f / accumulatedWeights);   // Normalize by the accumulated weights
+    irradiance *= irradiance;                   // Go back to linear irradiance
+    irradiance *= RTXGI_2PI;                    // Multiply by the area of the integration domain (hemisphere) to complete the Monte Carlo Estimator equation
+
+    // Adjust for energy loss due to reduced precision in the R10G10B10A2 irradiance texture format
+    if (volume.probeIrradianceFormat == RTXGI_DDGI_VOLUME_TEXTURE_FORMAT_U32 && volume.probeIrradianceEncoding == RTXGI_DDGI_PROBE_IRRADIANCE_ENCODING_OCTAHEDRAL)
     {
         irradiance *= 1.0989f;
     }
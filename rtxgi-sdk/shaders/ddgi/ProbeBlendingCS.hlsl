@@ -37,6 +37,9 @@
         #define PROBE_VARIABILITY_REG_DECL
         #endif
     #endif
+    #define PROBE_SCHEDULE_REG_DECL
+    #define PROBE_SH_REG_DECL
+    #define PROBE_IRRADIANCE_MIPS_REG_DECL
 
 #else
 
@@ -55,6 +58,15 @@
         #define PROBE_VARIABILITY_REG_DECL : register(PROBE_VARIABILITY_REGISTER, PROBE_VARIABILITY_SPACE)
         #endif
     #endif // RTXGI_DDGI_BINDLESS_RESOURCES
+    #if RTXGI_DDGI_PROBE_SCHEDULING && (!RTXGI_DDGI_BINDLESS_RESOURCES || (RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS))
+        #define PROBE_SCHEDULE_REG_DECL : register(PROBE_SCHEDULE_REGISTER, PROBE_SCHEDULE_SPACE)
+    #endif
+    #if RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_BLEND_SH && (!RTXGI_DDGI_BINDLESS_RESOURCES || (RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS))
+        #define PROBE_SH_REG_DECL : register(PROBE_SH_REGISTER, PROBE_SH_SPACE)
+    #endif
+    #if RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_BLEND_IRRADIANCE_MIPS && (!RTXGI_DDGI_BINDLESS_RESOURCES || (RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS))
+        #define PROBE_IRRADIANCE_MIPS_REG_DECL : register(PROBE_IRRADIANCE_MIPS_REGISTER, PROBE_IRRADIANCE_MIPS_SPACE)
+    #endif
 
 #endif // RTXGI_DDGI_SHADER_REFLECTION || SPIRV
 
@@ -81,6 +93,24 @@
         RTXGI_VK_BINDING(RWTEX2DARRAY_REGISTER, RWTEX2DARRAY_SPACE)
         RWTexture2DArray<float4> RWTex2DArray[] RWTEX2DARRAY_REG_DECL;
 
+    #if RTXGI_DDGI_PROBE_SCHEDULING
+        // DDGIVolume probe schedules
+        RTXGI_VK_BINDING(PROBE_SCHEDULE_REGISTER, PROBE_SCHEDULE_SPACE)
+        RWByteAddressBuffer ProbeSchedules[] PROBE_SCHEDULE_REG_DECL;
+    #endif
+
+    #if RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_BLEND_SH
+        // DDGIVolume probe spherical harmonics coefficients
+        RTXGI_VK_BINDING(PROBE_SH_REGISTER, PROBE_SH_SPACE)
+        RWStructuredBuffer<float3> ProbeSHs[] PROBE_SH_REG_DECL;
+    #endif
+
+    #if RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_BLEND_IRRADIANCE_MIPS
+        // DDGIVolume probe irradiance mips
+        RTXGI_VK_BINDING(PROBE_IRRADIANCE_MIPS_REGISTER, PROBE_IRRADIANCE_MIPS_SPACE)
+        RWStructuredBuffer<float3> ProbeIrradianceMipsArray[] PROBE_IRRADIANCE_MIPS_REG_DECL;
+    #endif
+
     #endif
 
 #else
@@ -107,6 +137,24 @@
     RWTexture2DArray<float4> ProbeVariability PROBE_VARIABILITY_REG_DECL;
 #endif
 
+#if RTXGI_DDGI_PROBE_SCHEDULING
+    // Probe schedule (list of probes to blend this frame)
+    RTXGI_VK_BINDING(PROBE_SCHEDULE_REGISTER, PROBE_SCHEDULE_SPACE)
+    RWByteAddressBuffer ProbeSchedule PROBE_SCHEDULE_REG_DECL;
+#endif
+
+#if RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_BLEND_SH
+    // Probe spherical harmonics coefficients
+    RTXGI_VK_BINDING(PROBE_SH_REGISTER, PROBE_SH_SPACE)
+    RWStructuredBuffer<float3> ProbeSH PROBE_SH_REG_DECL;
+#endif
+
+#if RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_BLEND_IRRADIANCE_MIPS
+    // Probe irradiance mips (pre-filtered probe irradiance)
+    RTXGI_VK_BINDING(PROBE_IRRADIANCE_MIPS_REGISTER, PROBE_IRRADIANCE_MIPS_SPACE)
+    RWStructuredBuffer<float3> ProbeIrradianceMips PROBE_IRRADIANCE_MIPS_REG_DECL;
+#endif
+
 #endif // RTXGI_DDGI_BINDLESS_RESOURCES
 
 // -------- SHARED MEMORY DECLARATIONS ------------------------------------------------------------
@@ -134,10 +182,48 @@
     groupshared float3 RayDirection[RTXGI_DDGI_BLEND_RAYS_PER_PROBE];
 #endif // RTXGI_DDGI_BLEND_SHARED_MEMORY
 
+#if RTXGI_DDGI_BLEND_SHARED_MEMORY_TILED
+// Shared Memory (example with default settings):
+// Radiance (half3) and backface flag x 64 rays/tile = 128 uints (512 B)
+// Distance (float) x 64 rays/tile = 64 floats (256 B)
+//
+// Rays are streamed through the tile, so the footprint is independent of the number of rays per probe.
+// Ray directions are recomputed from the ray index by the texel threads.
+
+#if RTXGI_DDGI_BLEND_RADIANCE
+    groupshared uint2  TileRayRadiance[RTXGI_DDGI_BLEND_RAYS_PER_TILE];     // x: radiance.rg (f16), y: radiance.b (f16), backface hit (bit 31)
+#else
+    groupshared float  TileRayDistance[RTXGI_DDGI_BLEND_RAYS_PER_TILE];
+#endif
+#endif // RTXGI_DDGI_BLEND_SHARED_MEMORY_TILED
+
 #if RTXGI_DDGI_BLEND_SCROLL_SHARED_MEMORY
     groupshared bool scrollClear;
 #endif // RTXGI_DDGI_BLEND_SCROLL_SHARED_MEMORY
 
+#if RTXGI_DDGI_BLEND_BORDER_SHARED_MEMORY
+// Shared Memory (example with default settings):
+// Irradiance (float4) x 6 x 6 interior texels = 576 B
+// Distance (float4) x 14 x 14 interior texels = ~3 KB
+    groupshared float4 ProbeTexels[RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS * RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS];
+#endif // RTXGI_DDGI_BLEND_BORDER_SHARED_MEMORY
+
+#if RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_BLEND_SH
+// Shared Memory (example with default settings):
+// Partial coefficient sums (float3) x 9 coefficients x 64 threads = ~7 KB
+    #define RTXGI_DDGI_BLEND_SH_THREADS (RTXGI_DDGI_PROBE_NUM_TEXELS * RTXGI_DDGI_PROBE_NUM_TEXELS)
+    groupshared float3 SHPartialSums[RTXGI_DDGI_BLEND_SH_THREADS][RTXGI_DDGI_PROBE_SH_MAX_COEFFICIENTS];
+    groupshared uint   SHValidRays;
+    groupshared uint   SHBackfaces;
+    groupshared float  SHHysteresis;
+    groupshared float  SHVariability;
+#endif // RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_BLEND_SH
+
+#if !RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_PROBE_SCHEDULING
+// Minimum filtered distance (float bits) of the probe's texels in each octant of directions, for the probe visibility masks
+    groupshared uint ProbeOctantMinDistance[8];
+#endif
+
 // -------- VISUALIZATION FUNCTIONS ---------------------------------------------------------------
 
 #if RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_DEBUG_PROBE_INDEXING
@@ -171,30 +257,43 @@
 
 // -------- HELPER FUNCTIONS ----------------------------------------------------------------------
 
+#if !RTXGI_DDGI_BLEND_RAY_LOADER
+    // Load a probe ray's radiance and hit distance from the ray data texture array.
+    // With RTXGI_DDGI_BLEND_RAY_LOADER, the application defines this function before including this file.
+    void DDGIBlendLoadProbeRay(RWTexture2DArray<float4> RayData, int rayIndex, int probeIndex, DDGIVolumeDescGPU volume, out float3 radiance, out float distance)
+    {
+        uint3 rayDataTexCoords = DDGIGetRayDataTexelCoords(rayIndex, probeIndex, volume);
+        radiance = DDGILoadProbeRayRadiance(RayData, rayDataTexCoords, volume);
+        distance = DDGILoadProbeRayDistance(RayData, rayDataTexCoords, volume);
+    }
+#endif // !RTXGI_DDGI_BLEND_RAY_LOADER
+
 #if RTXGI_DDGI_BLEND_SHARED_MEMORY
     // Cooperatively load the ray radiance and hit distance values into shared memory
     // Cooperatively compute probe ray directions
-    void LoadSharedMemory(int probeIndex, uint GroupIndex, RWTexture2DArray<float4> RayData, DDGIVolumeDescGPU volume)
+    void LoadSharedMemory(int probeIndex, int numRays, uint GroupIndex, RWTexture2DArray<float4> RayData, DDGIVolumeDescGPU volume)
     {
         int totalIterations = int(ceil(float(RTXGI_DDGI_BLEND_RAYS_PER_PROBE) / float(RTXGI_DDGI_PROBE_NUM_TEXELS * RTXGI_DDGI_PROBE_NUM_TEXELS)));
         for (int iteration = 0; iteration < totalIterations; iteration++)
         {
             int rayIndex = (GroupIndex * totalIterations) + iteration;
-            if (rayIndex >= RTXGI_DDGI_BLEND_RAYS_PER_PROBE) break;
+            if (rayIndex >= min(numRays, RTXGI_DDGI_BLEND_RAYS_PER_PROBE)) break;
 
-            // Get the coordinates for the probe ray in the RayData texture array
-            uint3 rayDataTexCoords = DDGIGetRayDataTexelCoords(rayIndex, probeIndex, volume);
+            // Load the ray radiance and hit distance
+            float3 radiance;
+            float  distance;
+            DDGIBlendLoadProbeRay(RayData, rayIndex, probeIndex, volume, radiance, distance);
 
         #if RTXGI_DDGI_BLEND_RADIANCE
-            // Load the ray radiance and store it in shared memory
-            RayRadiance[rayIndex] = DDGILoadProbeRayRadiance(RayData, rayDataTexCoords, volume);
+            // Store the ray radiance in shared memory
+            RayRadiance[rayIndex] = radiance;
         #endif
 
-            // Load the ray hit distance and store it in shared memory
-            RayDistance[rayIndex] = DDGILoadProbeRayDistance(RayData, rayDataTexCoords, volume);
+            // Store the ray hit distance in shared memory
+            RayDistance[rayIndex] = distance;
 
             // Get a random normalized probe ray direction and store it in shared memory
-            RayDirection[rayIndex] = DDGIGetProbeRayDirection(rayIndex, volume);
+            RayDirection[rayIndex] = DDGIGetProbeRayDirection(rayIndex, numRays, volume);
         }
 
         // Wait for all threads in the group to finish their shared memory operations
@@ -202,6 +301,114 @@
     }
 #endif // RTXGI_DDGI_BLEND_SHARED_MEMORY
 
+#if RTXGI_DDGI_BLEND_SHARED_MEMORY_TILED
+    // Blend the probe's rays into this thread's texel, streaming the rays through shared memory one tile at a time.
+    // All threads of the group (including the border texel threads) cooperatively load each tile, so this must be called
+    // in uniform control flow. Only interior texel threads (blendTexel) accumulate.
+    // Returns false when the probe's backface threshold is exceeded, the texel should not be blended.
+    bool BlendTiledRays(
+        int probeIndex,
+        int numRays,
+        uint GroupIndex,
+        int2 threadCoords,
+        bool blendTexel,
+        RWTexture2DArray<float4> RayData,
+        DDGIVolumeDescGPU volume,
+        out float4 result)
+    {
+        result = float4(0.f, 0.f, 0.f, 0.f);
+
+        // Get the probe ray direction associated with this thread
+        float2 probeOctantUV = DDGIGetNormalizedOctahedralCoordinates(threadCoords, RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS);
+        float3 probeRayDirection = DDGIGetOctahedralDirection(probeOctantUV);
+
+        // If relocation or classification are enabled, don't blend the fixed rays since they will bias the result
+        int firstRayIndex = 0;
+        if (volume.probeRelocationEnabled || volume.probeClassificationEnabled)
+        {
+            firstRayIndex = RTXGI_DDGI_NUM_FIXED_RAYS;
+        }
+
+    #if RTXGI_DDGI_BLEND_RADIANCE
+        // Backface hits are ignored when blending radiance
+        // If more than the backface threshold of the rays hit backfaces, the probe is probably inside geometry
+        uint backfaces = 0;
+        uint maxBackfaces = uint((numRays - firstRayIndex) * volume.probeRandomRayBackfaceThreshold);
+    #else
+        // Initialize the max probe hit distance to 50% larger the maximum distance between probe grid cells
+        float probeMaxRayDistance = length(volume.probeSpacing) * 1.5f;
+    #endif
+
+        for (int tileRayIndex = firstRayIndex; tileRayIndex < numRays; tileRayIndex += RTXGI_DDGI_BLEND_RAYS_PER_TILE)
+        {
+            // Cooperatively load the tile's rays
+            for (int tileIndex = int(GroupIndex); tileIndex < RTXGI_DDGI_BLEND_RAYS_PER_TILE; tileIndex += (RTXGI_DDGI_PROBE_NUM_TEXELS * RTXGI_DDGI_PROBE_NUM_TEXELS))
+            {
+                int rayIndex = tileRayIndex + tileIndex;
+                if (rayIndex >= numRays) break;
+
+                float3 radiance;
+                float  distance;
+                DDGIBlendLoadProbeRay(RayData, rayIndex, probeIndex, volume, radiance, distance);
+            #if RTXGI_DDGI_BLEND_RADIANCE
+                bool backface = (distance < 0.f);
+                TileRayRadiance[tileIndex] = uint2(f32tof16(radiance.r) | (f32tof16(radiance.g) << 16), f32tof16(radiance.b) | (uint(backface) << 31));
+            #else
+                // Hit distance is negative on backface hits (for probe relocation), so take the absolute value of the loaded data
+                TileRayDistance[tileIndex] = min(abs(distance), probeMaxRayDistance);
+            #endif
+            }
+
+            // Wait for the tile to be loaded
+            GroupMemoryBarrierWithGroupSync();
+
+            if (blendTexel)
+            {
+                int tileNumRays = min(RTXGI_DDGI_BLEND_RAYS_PER_TILE, numRays - tileRayIndex);
+                for (int tileIndex = 0; tileIndex < tileNumRays; tileIndex++)
+                {
+                    // Find the weight of the contribution for this ray
+                    // Weight is based on the cosine of the angle between the ray direction and the direction of the probe octant's texel
+                    float3 rayDirection = DDGIGetProbeRayDirection(tileRayIndex + tileIndex, numRays, volume);
+                    float weight = max(0.f, dot(probeRayDirection, rayDirection));
+
+                #if RTXGI_DDGI_BLEND_RADIANCE
+                    uint2 packedRadiance = TileRayRadiance[tileIndex];
+
+                    // Backface hit, don't blend this sample
+                    if (packedRadiance.y >> 31)
+                    {
+                        backfaces++;
+                        continue;
+                    }
+
+                    // Blend the ray's radiance
+                    float3 probeRayRadiance = float3(f16tof32(packedRadiance.x), f16tof32(packedRadiance.x >> 16), f16tof32(packedRadiance.y));
+                    result += float4(probeRayRadiance * weight, weight);
+                #else
+                    // Increase or decrease the filtered distance value's "sharpness"
+                    weight = pow(weight, volume.probeDistanceExponent);
+
+                    // Filter the ray hit distance
+                    float probeRayDistance = TileRayDistance[tileIndex];
+                    result += float4(probeRayDistance * weight, (probeRayDistance * probeRayDistance) * weight, 0.f, weight);
+                #endif
+                }
+            }
+
+            // Wait for all threads to finish reading the tile before it is overwritten
+            GroupMemoryBarrierWithGroupSync();
+        }
+
+    #if RTXGI_DDGI_BLEND_RADIANCE
+        // Only blend ray radiance into the probe if the backface threshold hasn't been exceeded
+        return (backfaces == 0 || backfaces < maxBackfaces);
+    #else
+        return true;
+    #endif
+    }
+#endif // RTXGI_DDGI_BLEND_SHARED_MEMORY_TILED
+
 #if RTXGI_DDGI_BLEND_SCROLL_SHARED_MEMORY
     // The first thread in a thread group determines if the probe has been scrolled
     // If scrolled, the texels of the probe should be cleared and blending can be skipped
@@ -228,30 +435,243 @@
     }
 #endif // RTXGI_DDGI_BLEND_SCROLL_SHARED_MEMORY
 
+#if RTXGI_DDGI_BLEND_BORDER_SHARED_MEMORY
+    // Get the shared memory index of a probe interior texel (group thread coordinates, including the border)
+    uint GetProbeTexelSharedMemoryIndex(uint2 probeTexel)
+    {
+        return ((probeTexel.y - 1) * RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS) + (probeTexel.x - 1);
+    }
+#endif // RTXGI_DDGI_BLEND_BORDER_SHARED_MEMORY
+
+#if RTXGI_DDGI_BLEND_RADIANCE
+    // Compute the hysteresis of a probe texel from its variability in the previous update (adaptive hysteresis).
+    // Texels at or above the variability threshold, or with unknown (zero) variability, blend with probeAdaptiveHysteresisMin,
+    // the hysteresis rises linearly to probeAdaptiveHysteresisMax as the texel stabilizes.
+    float GetProbeAdaptiveHysteresis(float variability, DDGIVolumeDescGPU volume)
+    {
+        if (variability <= 0.f) return volume.probeAdaptiveHysteresisMin;
+
+        float t = saturate(variability / volume.probeAdaptiveHysteresisVariabilityThreshold);
+        return lerp(volume.probeAdaptiveHysteresisMax, volume.probeAdaptiveHysteresisMin, t);
+    }
+#endif // RTXGI_DDGI_BLEND_RADIANCE
+
+#if RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_BLEND_SH
+    // Project the probe's ray radiance onto the spherical harmonics basis, blend the result with the probe's
+    // previous coefficients, and store it in the probe SH buffer. All threads of the group cooperate on the probe:
+    // the rays are strided over the threads and one thread per coefficient reduces the partial sums.
+    void BlendProbeSH(
+        int probeIndex,
+        int numRays,
+        uint GroupIndex,
+        int3 threadCoords,
+        bool isBorderTexel,
+        RWTexture2DArray<float4> RayData,
+        RWTexture2DArray<float4> ProbeData,
+        RWTexture2DArray<float4> ProbeVariability,
+        RWStructuredBuffer<float3> ProbeSH,
+        DDGIVolumeDescGPU volume)
+    {
+        uint baseIndex = DDGIGetProbeSHIndex(probeIndex);
+        uint numCoefficients = DDGIGetProbeSHNumCoefficients(volume);
+
+        // Clear the coefficients of probes that have been scrolled
+        if (IsVolumeMovementScrolling(volume))
+        {
+            int3 probeCoords = DDGIGetProbeCoords(probeIndex, volume);
+
+            bool scrollClear = false;
+            scrollClear |= DDGIClearScrolledPlane(probeCoords, 0, volume);
+            scrollClear |= DDGIClearScrolledPlane(probeCoords, 1, volume);
+            scrollClear |= DDGIClearScrolledPlane(probeCoords, 2, volume);
+            if (scrollClear)
+            {
+                int seedProbeIndex = volume.probeScrollSeedEnabled ? DDGIGetScrolledProbeSeedIndex(probeCoords, volume) : -1;
+                if (seedProbeIndex < 0)
+                {
+                    if (GroupIndex < numCoefficients) ProbeSH[baseIndex + GroupIndex] = float3(0.f, 0.f, 0.f);
+                    return; // Early out: this probe has been scrolled and cleared, don't blend
+                }
+
+                // Seed the scrolled probe with the previous edge probe's coefficients, then blend this frame's rays
+                if (GroupIndex < numCoefficients) ProbeSH[baseIndex + GroupIndex] = ProbeSH[DDGIGetProbeSHIndex(seedProbeIndex) + GroupIndex];
+            }
+        }
+
+        // Early out: don't blend rays for probes that are inactive
+        int probeState = DDGILoadProbeState(probeIndex, ProbeData, volume);
+        if (probeState == RTXGI_DDGI_PROBE_STATE_INACTIVE)
+        {
+            if (!isBorderTexel) ProbeVariability[threadCoords].r = 0.f;
+            return;
+        }
+
+        if (GroupIndex == 0)
+        {
+            SHValidRays = 0;
+            SHBackfaces = 0;
+
+            // All of the probe's interior texels store the same variability, read it from the first one (thread 0 maps to the corner border texel)
+            SHHysteresis = volume.probeHysteresis;
+            if (volume.probeAdaptiveHysteresisEnabled) SHHysteresis = GetProbeAdaptiveHysteresis(ProbeVariability[threadCoords + int3(1, 1, 0)].r, volume);
+
+            // If the probe was previously cleared to completely black, set the hysteresis to zero
+            float3 previousL0 = ProbeSH[baseIndex];
+            if (dot(previousL0, previousL0) == 0.f) SHHysteresis = 0.f;
+        }
+        GroupMemoryBarrierWithGroupSync();
+
+        // If relocation or classification are enabled, don't blend the fixed rays since they will bias the result
+        int firstRayIndex = 0;
+        if (volume.probeRelocationEnabled || volume.probeClassificationEnabled)
+        {
+            firstRayIndex = RTXGI_DDGI_NUM_FIXED_RAYS;
+        }
+
+        // Project this thread's rays onto the basis
+        float3 partialSums[RTXGI_DDGI_PROBE_SH_MAX_COEFFICIENTS];
+        uint coefficientIndex;
+        for (coefficientIndex = 0; coefficientIndex < RTXGI_DDGI_PROBE_SH_MAX_COEFFICIENTS; coefficientIndex++)
+        {
+            partialSums[coefficientIndex] = float3(0.f, 0.f, 0.f);
+        }
+
+        uint validRays = 0;
+        uint backfaces = 0;
+        for (int rayIndex = firstRayIndex + int(GroupIndex); rayIndex < numRays; rayIndex += RTXGI_DDGI_BLEND_SH_THREADS)
+        {
+        #if RTXGI_DDGI_BLEND_SHARED_MEMORY
+            float3 rayDirection = RayDirection[rayIndex];
+            float3 probeRayRadiance = RayRadiance[rayIndex];
+            float  probeRayDistance = RayDistance[rayIndex];
+        #else
+            float3 rayDirection = DDGIGetProbeRayDirection(rayIndex, numRays, volume);
+            float3 probeRayRadiance;
+            float  probeRayDistance;
+            DDGIBlendLoadProbeRay(RayData, rayIndex, probeIndex, volume, probeRayRadiance, probeRayDistance);
+        #endif // RTXGI_DDGI_BLEND_SHARED_MEMORY
+
+            // Backface hits are ignored when blending radiance
+            if (probeRayDistance < 0.f)
+            {
+                backfaces++;
+                continue;
+            }
+
+            float basis[RTXGI_DDGI_PROBE_SH_MAX_COEFFICIENTS];
+            DDGIGetSHBasis(rayDirection, basis);
+            for (coefficientIndex = 0; coefficientIndex < numCoefficients; coefficientIndex++)
+            {
+                partialSums[coefficientIndex] += probeRayRadiance * basis[coefficientIndex];
+            }
+            validRays++;
+        }
+
+        InterlockedAdd(SHValidRays, validRays);
+        InterlockedAdd(SHBackfaces, backfaces);
+        for (coefficientIndex = 0; coefficientIndex < RTXGI_DDGI_PROBE_SH_MAX_COEFFICIENTS; coefficientIndex++)
+        {
+            SHPartialSums[GroupIndex][coefficientIndex] = partialSums[coefficientIndex];
+        }
+        GroupMemoryBarrierWithGroupSync();
+
+        // Early out: if more than the backface threshold of the rays hit backfaces, the probe is probably inside geometry
+        // In this case, don't blend anything into the probe
+        uint maxBackfaces = uint((numRays - firstRayIndex) * volume.probeRandomRayBackfaceThreshold);
+        if (SHBackfaces >= maxBackfaces || SHValidRays == 0) return;
+
+        if (GroupIndex < numCoefficients)
+        {
+            float3 coefficient = float3(0.f, 0.f, 0.f);
+            for (uint threadIndex = 0; threadIndex < RTXGI_DDGI_BLEND_SH_THREADS; threadIndex++)
+            {
+                coefficient += SHPartialSums[threadIndex][GroupIndex];
+            }
+
+            // Monte Carlo projection over the sphere (4pi / N), convolved with the clamped cosine lobe
+            coefficient *= (4.f * RTXGI_PI / float(SHValidRays)) * DDGIGetSHConvolution(GroupIndex);
+
+            // Interpolate the new coefficient with the existing coefficient in the probe.
+            // A high hysteresis value emphasizes the existing probe irradiance.
+            float3 previousCoefficient = ProbeSH[baseIndex + GroupIndex];
+            float3 blendedCoefficient = lerp(coefficient, previousCoefficient, SHHysteresis);
+            ProbeSH[baseIndex + GroupIndex] = blendedCoefficient;
+
+            if (GroupIndex == 0)
+            {
+                // Compute the coefficient of variation of the probe's mean (band 0) irradiance
+                static const float c_threshold = 1.f / 1024.f;
+                float  irradianceSample = RTXGILinearRGBToLuminance(coefficient) * 0.282095f;
+                float  irradiancePrevious = RTXGILinearRGBToLuminance(previousCoefficient) * 0.282095f;
+                float  irradianceMean = RTXGILinearRGBToLuminance(blendedCoefficient) * 0.282095f;
+                float  irradianceSigma2 = abs((irradianceSample - irradiancePrevious) * (irradianceSample - irradianceMean));
+                SHVariability = (irradianceMean <= c_threshold) ? 0.f : sqrt(irradianceSigma2) / irradianceMean;
+            }
+        }
+
+        if (volume.probeVariabilityEnabled)
+        {
+            GroupMemoryBarrierWithGroupSync();
+            if (!isBorderTexel) ProbeVariability[threadCoords].r = SHVariability;
+        }
+    }
+#endif // RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_BLEND_SH
+
+// Store the blended value of a probe interior texel (and keep it in shared memory for the border texel updates)
+void StoreProbeTexel(uint3 DispatchThreadID, uint3 GroupThreadID, float4 value, RWTexture2DArray<float4> Output)
+{
+#if RTXGI_DDGI_BLEND_BORDER_SHARED_MEMORY
+    ProbeTexels[GetProbeTexelSharedMemoryIndex(GroupThreadID.xy)] = value;
+#endif
+    Output[DispatchThreadID] = value;
+}
+
+// Handle a probe texel that has been scrolled into the volume. The texel is cleared, or seeded with the texel of the previous
+// edge probe when probeScrollSeedEnabled is set (the seed is then blended with this frame's rays as the probe's history).
+// The seed probe may be blended by another thread group in the same dispatch, either its previous or its new value is a valid seed.
+// Returns true when the texel was cleared and blending should be skipped.
+bool ClearScrolledProbeTexel(int probeIndex, uint3 DispatchThreadID, uint3 GroupThreadID, RWTexture2DArray<float4> Output, DDGIVolumeDescGPU volume)
+{
+    int seedProbeIndex = volume.probeScrollSeedEnabled ? DDGIGetScrolledProbeSeedIndex(DDGIGetProbeCoords(probeIndex, volume), volume) : -1;
+    if (seedProbeIndex < 0)
+    {
+        StoreProbeTexel(DispatchThreadID, GroupThreadID, float4(0.f, 0.f, 0.f, 1.f), Output);
+        return true;
+    }
+
+    uint3 seedTexelCoords = DDGIGetProbeTexelCoords(seedProbeIndex, volume);
+    seedTexelCoords = uint3(seedTexelCoords.xy * RTXGI_DDGI_PROBE_NUM_TEXELS + GroupThreadID.xy, seedTexelCoords.z);
+    StoreProbeTexel(DispatchThreadID, GroupThreadID, Output[seedTexelCoords], Output);
+    return false;
+}
+
 // When the thread maps to a border texel, update it with the latest blended information for later use in bilinear filtering
 void UpdateBorderTexel(uint3 DispatchThreadID, uint3 GroupThreadID, uint3 GroupID, RWTexture2DArray<float4> Output, DDGIVolumeDescGPU volume)
 {
     bool isCornerTexel = (GroupThreadID.x == 0 || GroupThreadID.x == (RTXGI_DDGI_PROBE_NUM_TEXELS - 1)) && (GroupThreadID.y == 0 || GroupThreadID.y == (RTXGI_DDGI_PROBE_NUM_TEXELS - 1));
     bool isRowTexel = (GroupThreadID.x > 0 && GroupThreadID.x < (RTXGI_DDGI_PROBE_NUM_TEXELS - 1));
 
-    uint3 copyCoordinates = uint3(GroupID.x * RTXGI_DDGI_PROBE_NUM_TEXELS, GroupID.y * RTXGI_DDGI_PROBE_NUM_TEXELS, DispatchThreadID.z);
+    // The probe interior texel to copy (group thread coordinates, including the border)
+    uint2 copyTexel = uint2(0, 0);
 
     if(isCornerTexel)
     {
-        copyCoordinates.x += GroupThreadID.x > 0 ? 1 : RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS;
-        copyCoordinates.y += GroupThreadID.y > 0 ? 1 : RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS;
+        copyTexel.x = GroupThreadID.x > 0 ? 1 : RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS;
+        copyTexel.y = GroupThreadID.y > 0 ? 1 : RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS;
     }
     else if(isRowTexel)
     {
-        copyCoordinates.x += (RTXGI_DDGI_PROBE_NUM_TEXELS - 1) - GroupThreadID.x;
-        copyCoordinates.y += GroupThreadID.y + ((GroupThreadID.y > 0) ? -1 : 1);
+        copyTexel.x = (RTXGI_DDGI_PROBE_NUM_TEXELS - 1) - GroupThreadID.x;
+        copyTexel.y = GroupThreadID.y + ((GroupThreadID.y > 0) ? -1 : 1);
     }
     else // Column Texel
     {
-        copyCoordinates.x += GroupThreadID.x + ((GroupThreadID.x > 0) ? -1 : 1);
-        copyCoordinates.y += (RTXGI_DDGI_PROBE_NUM_TEXELS - 1) - GroupThreadID.y;
+        copyTexel.x = GroupThreadID.x + ((GroupThreadID.x > 0) ? -1 : 1);
+        copyTexel.y = (RTXGI_DDGI_PROBE_NUM_TEXELS - 1) - GroupThreadID.y;
     }
 
+    uint3 copyCoordinates = uint3((GroupID.xy * RTXGI_DDGI_PROBE_NUM_TEXELS) + copyTexel, DispatchThreadID.z);
+
     // Visualize border copy indexing and exit early
 #if RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_DEBUG_BORDER_COPY_INDEXING
     if(volume.probeIrradianceFormat == RTXGI_DDGI_VOLUME_TEXTURE_FORMAT_F32x4)
@@ -261,8 +681,110 @@ void UpdateBorderTexel(uint3 DispatchThreadID, uint3 GroupThreadID, uint3 GroupI
     return;
 #endif
 
+#if RTXGI_DDGI_BLEND_BORDER_SHARED_MEMORY
+    Output[DispatchThreadID] = ProbeTexels[GetProbeTexelSharedMemoryIndex(copyTexel)];
+#else
     Output[DispatchThreadID] = Output[copyCoordinates];
+#endif
+}
+
+// Reduce an interior texel's filtered distance into the minimum distance of each octant of (grid-space) directions it can be sampled from.
+// Octant n holds the directions that are negative on the grid axes set in n, i.e. the directions from the probe into the probe cage cell
+// where it sits at adjacent offset (n & 1, (n >> 1) & 1, (n >> 2) & 1). Texels near an octant's boundary count toward both sides, since
+// bilinear sampling reaches across it. Does nothing unless distance blending writes the probe visibility masks.
+void UpdateProbeOctantMinDistance(int2 threadCoords, float distance, DDGIVolumeDescGPU volume)
+{
+#if !RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_PROBE_SCHEDULING
+    if (!volume.probeVisibilityMaskEnabled) return;
+
+    float2 probeOctantUV = DDGIGetNormalizedOctahedralCoordinates(threadCoords, RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS);
+    float3 direction = DDGIGetOctahedralDirection(probeOctantUV);
+    if (!IsVolumeMovementScrolling(volume)) direction = RTXGIQuaternionRotate(direction, RTXGIQuaternionConjugate(volume.rotation));
+
+    // About a texel and a half of (angular) margin
+    const float margin = 6.f / RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS;
+    uint negativeAxes = (direction.x < margin ? 1 : 0) | (direction.y < margin ? 2 : 0) | (direction.z < margin ? 4 : 0);
+    uint positiveAxes = (direction.x > -margin ? 1 : 0) | (direction.y > -margin ? 2 : 0) | (direction.z > -margin ? 4 : 0);
+    for (uint octant = 0; octant < 8; octant++)
+    {
+        if ((octant & ~negativeAxes) != 0 || (~octant & ~positiveAxes & 7) != 0) continue;
+        InterlockedMin(ProbeOctantMinDistance[octant], asuint(max(distance, 0.f)));
+    }
+#endif
+}
+
+#if !RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_PROBE_SCHEDULING
+// Write the probe's bit of the visibility mask of each of the 8 probe cage cells around it (see DDGIStoreProbeVisibilityBit()).
+// The probe sees a cell when its filtered mean distance toward the cell is beyond the cell's farthest point, where the
+// Chebyshev visibility test of every shading point in the cell passes.
+void UpdateProbeVisibilityMasks(int probeIndex, RWByteAddressBuffer ProbeSchedule, DDGIVolumeDescGPU volume)
+{
+    // The farthest point of a cell from its probes is across the cell's diagonal, plus the relocation offset (less than 0.45 probe spacings, see ProbeRelocationCS.hlsl)
+    float cellDistance = length(volume.probeSpacing);
+    if (volume.probeRelocationEnabled) cellDistance += 0.45f * RTXGIMaxComponent(volume.probeSpacing);
+
+    // Leave headroom for the precision of the distance texture format
+    cellDistance *= 1.01f;
+
+    int3 probeCoords = DDGIGetProbeCoords(probeIndex, volume);
+    for (int adjacentProbeIndex = 0; adjacentProbeIndex < 8; adjacentProbeIndex++)
+    {
+        int3 adjacentProbeOffset = int3(adjacentProbeIndex, adjacentProbeIndex >> 1, adjacentProbeIndex >> 2) & int3(1, 1, 1);
+
+        // The cell whose base probe is at this offset from the probe (storage coordinates wrap with the scroll offsets)
+        int3 cellCoords = (probeCoords - adjacentProbeOffset + volume.probeCounts) % volume.probeCounts;
+
+        // Filtered distances are stored halved (see the normalization in DDGIProbeBlendingCS())
+        bool visible = ((2.f * asfloat(ProbeOctantMinDistance[adjacentProbeIndex])) >= cellDistance);
+        DDGIStoreProbeVisibilityBit(DDGIGetProbeIndex(cellCoords, volume), adjacentProbeIndex, visible, ProbeSchedule, volume);
+    }
+}
+#endif // !RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_PROBE_SCHEDULING
+
+#if RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_BLEND_IRRADIANCE_MIPS
+// Write one texel of the probe's irradiance mips (see RTXGI_DDGI_PROBE_IRRADIANCE_MIP_TEXELS) from the probe's blended interior texels.
+// Mip texels 0-3 average one quadrant of the interior texels each, mip texel 4 averages all of them. The mips are stored in linear space.
+void UpdateProbeIrradianceMip(
+    int probeIndex,
+    uint mipTexel,
+    uint3 GroupID,
+    uint slice,
+    RWTexture2DArray<float4> Output,
+    RWStructuredBuffer<float3> ProbeIrradianceMips,
+    DDGIVolumeDescGPU volume)
+{
+    // Interior texel range covered by the mip texel
+    uint2 quadrant = uint2(mipTexel & 1, mipTexel >> 1);
+    uint2 start = (quadrant * RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS) / 2;
+    uint2 end = ((quadrant + 1) * RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS) / 2;
+    if (mipTexel == 4)
+    {
+        start = uint2(0, 0);
+        end = uint2(RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS, RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS);
+    }
+
+    float3 sum = float3(0.f, 0.f, 0.f);
+    for (uint y = start.y; y < end.y; y++)
+    {
+        for (uint x = start.x; x < end.x; x++)
+        {
+            // Group thread coordinates of the interior texel (including the border)
+            uint2 texel = uint2(x, y) + uint2(1, 1);
+        #if RTXGI_DDGI_BLEND_BORDER_SHARED_MEMORY
+            float3 irradiance = ProbeTexels[GetProbeTexelSharedMemoryIndex(texel)].rgb;
+        #else
+            float3 irradiance = Output[uint3((GroupID.xy * RTXGI_DDGI_PROBE_NUM_TEXELS) + texel, slice)].rgb;
+        #endif
+
+            // Remove the tone curve, the texels are averaged in linear space
+            sum += pow(irradiance, volume.probeIrradianceEncodingGamma);
+        }
+    }
+
+    uint numTexels = (end.x - start.x) * (end.y - start.y);
+    ProbeIrradianceMips[(probeIndex * RTXGI_DDGI_PROBE_IRRADIANCE_MIP_TEXELS) + mipTexel] = sum / float(max(numTexels, 1));
 }
+#endif // RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_BLEND_IRRADIANCE_MIPS
 
 
 // -------- ENTRY POINT ---------------------------------------------------------------------------
@@ -308,6 +830,15 @@ void DDGIProbeBlendingCS(
             RWTexture2DArray<float4> Output = ResourceDescriptorHeap[resourceIndices.probeDistanceUAVIndex];
         #endif
         RWTexture2DArray<float4> ProbeData = ResourceDescriptorHeap[resourceIndices.probeDataUAVIndex];
+        #if RTXGI_DDGI_PROBE_SCHEDULING
+            RWByteAddressBuffer ProbeSchedule = ResourceDescriptorHeap[resourceIndices.probeScheduleUAVIndex];
+        #endif
+        #if RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_BLEND_SH
+            RWStructuredBuffer<float3> ProbeSH = ResourceDescriptorHeap[resourceIndices.probeSHUAVIndex];
+        #endif
+        #if RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_BLEND_IRRADIANCE_MIPS
+            RWStructuredBuffer<float3> ProbeIrradianceMips = ResourceDescriptorHeap[resourceIndices.probeIrradianceMipsUAVIndex];
+        #endif
 
     #elif RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
 
@@ -323,10 +854,29 @@ void DDGIProbeBlendingCS(
             RWTexture2DArray<float4> Output = RWTex2DArray[resourceIndices.probeDistanceUAVIndex];
         #endif
         RWTexture2DArray<float4> ProbeData = RWTex2DArray[resourceIndices.probeDataUAVIndex];
+        #if RTXGI_DDGI_PROBE_SCHEDULING
+            RWByteAddressBuffer ProbeSchedule = ProbeSchedules[resourceIndices.probeScheduleUAVIndex];
+        #endif
+        #if RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_BLEND_SH
+            RWStructuredBuffer<float3> ProbeSH = ProbeSHs[resourceIndices.probeSHUAVIndex];
+        #endif
+        #if RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_BLEND_IRRADIANCE_MIPS
+            RWStructuredBuffer<float3> ProbeIrradianceMips = ProbeIrradianceMipsArray[resourceIndices.probeIrradianceMipsUAVIndex];
+        #endif
 
     #endif
 #endif
 
+#if RTXGI_DDGI_PROBE_SCHEDULING
+    // Scheduled (or active only) blending dispatches one thread group per listed probe, remap the group to the probe's texels
+    if (volume.probeSchedulingEnabled || volume.probeBlendingActiveOnly)
+    {
+        uint scheduledProbeIndex = ProbeSchedule.Load(RTXGI_DDGI_PROBE_SCHEDULE_LIST_OFFSET + (GroupID.x * 4));
+        GroupID = DDGIGetProbeTexelCoords(scheduledProbeIndex, volume);
+        DispatchThreadID = uint3(GroupID.xy * RTXGI_DDGI_PROBE_NUM_TEXELS + GroupThreadID.xy, GroupID.z);
+    }
+#endif
+
     // Find the probe index for this thread
     int probeIndex = DDGIGetProbeIndex(DispatchThreadID, RTXGI_DDGI_PROBE_NUM_TEXELS, volume);
 
@@ -342,16 +892,57 @@ void DDGIProbeBlendingCS(
     // Early out: no probe maps to this thread
     if (probeIndex >= numProbes || probeIndex < 0) return;
 
+    // Get the number of rays traced for the probe this frame (fewer than probeNumRays with adaptive rays)
+    int numRays = volume.probeNumRays;
+#if RTXGI_DDGI_PROBE_SCHEDULING
+    numRays = DDGIGetProbeNumRays(probeIndex, volume, ProbeSchedule);
+#endif
+
 #if RTXGI_DDGI_BLEND_SHARED_MEMORY
     // Cooperatively load the ray radiance and hit distance values into shared memory and cooperatively compute probe ray directions
-    LoadSharedMemory(probeIndex, GroupIndex, RayData, volume);
+    LoadSharedMemory(probeIndex, numRays, GroupIndex, RayData, volume);
 #endif // RTXGI_DDGI_BLEND_SHARED_MEMORY
 
+#if RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_BLEND_SH
+    // Spherical harmonics encoding: project the probe's rays onto the SH basis instead of blending the octahedral texels
+    if (volume.probeIrradianceEncoding != RTXGI_DDGI_PROBE_IRRADIANCE_ENCODING_OCTAHEDRAL)
+    {
+        int3 threadCoords = int3(GroupID.x * RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS, GroupID.y * RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS, DispatchThreadID.z) + GroupThreadID - int3(1, 1, 0);
+        BlendProbeSH(probeIndex, numRays, GroupIndex, threadCoords, isBorderTexel, RayData, ProbeData, ProbeVariability, ProbeSH, volume);
+        return;
+    }
+#endif
+
+#if !RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_PROBE_SCHEDULING
+    // Reset the octant minimum distances of the probe visibility masks (FLT_MAX)
+    if (volume.probeVisibilityMaskEnabled)
+    {
+        if (GroupIndex < 8) ProbeOctantMinDistance[GroupIndex] = 0x7F7FFFFF;
+        GroupMemoryBarrierWithGroupSync();
+    }
+#endif
+
+#if RTXGI_DDGI_BLEND_SHARED_MEMORY_TILED
+    // Stream the probe's rays through shared memory and blend them into the interior texels (all group threads load the tiles)
+    float4 tiledResult = float4(0.f, 0.f, 0.f, 0.f);
+    bool   tiledBlend = false;
+    if (DDGILoadProbeState(probeIndex, ProbeData, volume) != RTXGI_DDGI_PROBE_STATE_INACTIVE)
+    {
+        int2 tiledThreadCoords = int2(GroupThreadID.xy) - int2(1, 1);
+        tiledBlend = BlendTiledRays(probeIndex, numRays, GroupIndex, tiledThreadCoords, !isBorderTexel, RayData, volume, tiledResult);
+    }
+#endif // RTXGI_DDGI_BLEND_SHARED_MEMORY_TILED
+
     if(!isBorderTexel)
     {
         // Remap thread coordinates to not include the border texels
         int3 threadCoords = int3(GroupID.x * RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS, GroupID.y * RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS, DispatchThreadID.z) + GroupThreadID - int3(1, 1, 0);
 
+    #if RTXGI_DDGI_BLEND_BORDER_SHARED_MEMORY
+        // Start from the texel's current value, the border texel updates copy it when the texel is not blended (early outs below)
+        ProbeTexels[GetProbeTexelSharedMemoryIndex(GroupThreadID.xy)] = Output[DispatchThreadID];
+    #endif
+
         // Visualize the probe's octahedral indexing
     #if RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_DEBUG_OCTAHEDRAL_INDEXING
         DebugOctahedralIndexing(int2(threadCoords.xy), DispatchThreadID, Output, volume);
@@ -362,9 +953,9 @@ void DDGIProbeBlendingCS(
         // Using shared memory may or may not be worth it depending on the target HW
     #if RTXGI_DDGI_BLEND_SCROLL_SHARED_MEMORY
         LoadScrollSharedMemory(probeIndex, DispatchThreadID, GroupThreadID, Output, volume);
-        if(scrollClear)
+        if(scrollClear && ClearScrolledProbeTexel(probeIndex, DispatchThreadID, GroupThreadID, Output, volume))
         {
-            Output[DispatchThreadID] = float4(0.f, 0.f, 0.f, 1.f);
+            UpdateProbeOctantMinDistance(threadCoords.xy, 0.f, volume);
             return; // Early out: this probe has been scrolled and cleared, don't blend
         }
     #else
@@ -378,9 +969,9 @@ void DDGIProbeBlendingCS(
             scrollClear |= DDGIClearScrolledPlane(probeCoords, 0, volume);
             scrollClear |= DDGIClearScrolledPlane(probeCoords, 1, volume);
             scrollClear |= DDGIClearScrolledPlane(probeCoords, 2, volume);
-            if(scrollClear)
+            if(scrollClear && ClearScrolledProbeTexel(probeIndex, DispatchThreadID, GroupThreadID, Output, volume))
             {
-                Output[DispatchThreadID] = float4(0.f, 0.f, 0.f, 1.f);
+                UpdateProbeOctantMinDistance(threadCoords.xy, 0.f, volume);
                 return; // Early out: this probe has been scrolled and cleared, don't blend
             }
         }
@@ -393,9 +984,16 @@ void DDGIProbeBlendingCS(
         #if RTXGI_DDGI_BLEND_RADIANCE
             ProbeVariability[DispatchThreadID].r = 0.f;
         #endif
+            UpdateProbeOctantMinDistance(threadCoords.xy, 0.f, volume);
             return;
         }
 
+    #if RTXGI_DDGI_BLEND_SHARED_MEMORY_TILED
+        // The rays were blended tile by tile above
+        // Early out: don't blend anything into the probe if the backface threshold was exceeded
+        if (!tiledBlend) return;
+        float4 result = tiledResult;
+    #else
         // Get the probe ray direction associated with this thread
         float2 probeOctantUV = DDGIGetNormalizedOctahedralCoordinates(int2(threadCoords.xy), RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS);
         float3 probeRayDirection = DDGIGetOctahedralDirection(probeOctantUV);
@@ -413,27 +1011,24 @@ void DDGIProbeBlendingCS(
         // If more than the backface threshold of the rays hit backfaces, the probe is probably inside geometry
         // In this case, don't blend anything into the probe
         uint backfaces = 0;
-        uint maxBackfaces = uint((volume.probeNumRays - rayIndex) * volume.probeRandomRayBackfaceThreshold);
+        uint maxBackfaces = uint((numRays - rayIndex) * volume.probeRandomRayBackfaceThreshold);
     #endif
 
         // Blend each ray's radiance or distance values to compute irradiance or fitered distance
         float4 result = float4(0.f, 0.f, 0.f, 0.f);
-        for ( ; rayIndex < volume.probeNumRays; rayIndex++)
+        for ( ; rayIndex < numRays; rayIndex++)
         {
             // Get the direction for this probe ray
         #if RTXGI_DDGI_BLEND_SHARED_MEMORY
             float3 rayDirection = RayDirection[rayIndex];
         #else
-            float3 rayDirection = DDGIGetProbeRayDirection(rayIndex, volume);
+            float3 rayDirection = DDGIGetProbeRayDirection(rayIndex, numRays, volume);
         #endif
 
             // Find the weight of the contribution for this ray
             // Weight is based on the cosine of the angle between the ray direction and the direction of the probe octant's texel
             float weight = max(0.f, dot(probeRayDirection, rayDirection));
 
-            // Get the coordinates for the probe ray in the RayData texture array
-            uint3 rayDataTexCoords = DDGIGetRayDataTexelCoords(rayIndex, probeIndex, volume);
-
         #if RTXGI_DDGI_BLEND_RADIANCE
             // Load the ray traced radiance and hit distance
             float3 probeRayRadiance = 0.f;
@@ -443,8 +1038,7 @@ void DDGIProbeBlendingCS(
                 probeRayRadiance = RayRadiance[rayIndex];
                 probeRayDistance = RayDistance[rayIndex];
             #else
-                probeRayRadiance = DDGILoadProbeRayRadiance(RayData, rayDataTexCoords, volume);
-                probeRayDistance = DDGILoadProbeRayDistance(RayData, rayDataTexCoords, volume);
+                DDGIBlendLoadProbeRay(RayData, rayIndex, probeIndex, volume, probeRayRadiance, probeRayDistance);
             #endif // RTXGI_DDGI_BLEND_SHARED_MEMORY
 
             // Backface hit, don't blend this sample
@@ -475,7 +1069,9 @@ void DDGIProbeBlendingCS(
         #if RTXGI_DDGI_BLEND_SHARED_MEMORY
             probeRayDistance = min(abs(RayDistance[rayIndex]), probeMaxRayDistance);
         #else
-            probeRayDistance = min(abs(DDGILoadProbeRayDistance(RayData, rayDataTexCoords, volume)), probeMaxRayDistance);
+            float3 probeRayRadiance;
+            DDGIBlendLoadProbeRay(RayData, rayIndex, probeIndex, volume, probeRayRadiance, probeRayDistance);
+            probeRayDistance = min(abs(probeRayDistance), probeMaxRayDistance);
         #endif // RTXGI_DDGI_BLEND_SHARED_MEMORY
 
             // Filter the ray hit distance
@@ -483,8 +1079,9 @@ void DDGIProbeBlendingCS(
 
         #endif // RTXGI_DDGI_BLEND_RADIANCE
         }
+    #endif // RTXGI_DDGI_BLEND_SHARED_MEMORY_TILED
 
-        float epsilon = float(volume.probeNumRays);
+        float epsilon = float(numRays);
         if (volume.probeRelocationEnabled || volume.probeClassificationEnabled)
         {
             // If relocation or classification are enabled, fixed rays aren't blended since they will bias the result
@@ -506,8 +1103,12 @@ void DDGIProbeBlendingCS(
         float3 probeIrradianceMean = Output[DispatchThreadID].rgb;
 
         // Get the history weight (hysteresis) to use for the probe texel's previous value
-        // If the probe was previously cleared to completely black, set the hysteresis to zero
         float  hysteresis = volume.probeHysteresis;
+    #if RTXGI_DDGI_BLEND_RADIANCE
+        if (volume.probeAdaptiveHysteresisEnabled) hysteresis = GetProbeAdaptiveHysteresis(ProbeVariability[threadCoords].r, volume);
+    #endif
+
+        // If the probe was previously cleared to completely black, set the hysteresis to zero
         if (dot(probeIrradianceMean, probeIrradianceMean) == 0) hysteresis = 0.f;
 
     #if RTXGI_DDGI_BLEND_RADIANCE
@@ -565,15 +1166,37 @@ void DDGIProbeBlendingCS(
         // Interpolate the new filtered distance with the existing filtered distance in the probe.
         // A high hysteresis value emphasizes the existing probe filtered distance.
         result = float4(lerp(result.rg, probeIrradianceMean.rg, hysteresis), 0.f, 1.f);
+        UpdateProbeOctantMinDistance(threadCoords.xy, result.r, volume);
     #endif
 
-        Output[DispatchThreadID] = result;
+        StoreProbeTexel(DispatchThreadID, GroupThreadID, result, Output);
         return;
     }
 
+#if RTXGI_DDGI_BLEND_BORDER_SHARED_MEMORY
+    // Wait for all threads in the group to finish their shared memory operations
+    GroupMemoryBarrierWithGroupSync();
+#else
     // Wait for all threads in the group to finish all memory operations
     AllMemoryBarrierWithGroupSync();
+#endif
 
     // Update the texel with the latest blended data
     UpdateBorderTexel(DispatchThreadID, GroupThreadID, GroupID, Output, volume);
+
+#if !RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_PROBE_SCHEDULING
+    // The first border thread writes the probe's bits of the visibility masks from the blended interior texels
+    if (volume.probeVisibilityMaskEnabled && GroupIndex == 0)
+    {
+        UpdateProbeVisibilityMasks(probeIndex, ProbeSchedule, volume);
+    }
+#endif
+
+#if RTXGI_DDGI_BLEND_RADIANCE && RTXGI_DDGI_BLEND_IRRADIANCE_MIPS
+    // The first border threads pre-filter the probe's irradiance mips from the blended interior texels
+    if (volume.probeIrradianceMipsEnabled && GroupThreadID.y == 0 && GroupThreadID.x < RTXGI_DDGI_PROBE_IRRADIANCE_MIP_TEXELS)
+    {
+        UpdateProbeIrradianceMip(probeIndex, GroupThreadID.x, GroupID, DispatchThreadID.z, Output, ProbeIrradianceMips, volume);
+    }
+#endif
 }
@@ -33,6 +33,7 @@
         #define RAY_DATA_REG_DECL 
         #define PROBE_DATA_REG_DECL 
     #endif
+    #define PROBE_SCHEDULE_REG_DECL
 
 #else
 
@@ -47,6 +48,9 @@
         #define RAY_DATA_REG_DECL : register(RAY_DATA_REGISTER, RAY_DATA_SPACE)
         #define PROBE_DATA_REG_DECL : register(PROBE_DATA_REGISTER, PROBE_DATA_SPACE)
     #endif
+    #if RTXGI_DDGI_PROBE_SCHEDULING && (!RTXGI_DDGI_BINDLESS_RESOURCES || (RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS))
+        #define PROBE_SCHEDULE_REG_DECL : register(PROBE_SCHEDULE_REGISTER, PROBE_SCHEDULE_SPACE)
+    #endif
 
 #endif // RTXGI_DDGI_SHADER_REFLECTION || SPIRV
 
@@ -72,6 +76,12 @@
         RTXGI_VK_BINDING(RWTEX2DARRAY_REGISTER, RWTEX2DARRAY_SPACE)
         RWTexture2DArray<float4> RWTex2DArray[] RWTEX2DARRAY_REG_DECL;
 
+    #if RTXGI_DDGI_PROBE_SCHEDULING
+        // DDGIVolume probe lists
+        RTXGI_VK_BINDING(PROBE_SCHEDULE_REGISTER, PROBE_SCHEDULE_SPACE)
+        RWByteAddressBuffer ProbeSchedules[] PROBE_SCHEDULE_REG_DECL;
+    #endif
+
     #endif
 #else
 
@@ -87,17 +97,68 @@
     RTXGI_VK_BINDING(PROBE_DATA_REGISTER, PROBE_DATA_SPACE)
     RWTexture2DArray<float4> ProbeData PROBE_DATA_REG_DECL;
 
+#if RTXGI_DDGI_PROBE_SCHEDULING
+    // Probe list (active probes appended for probe blending)
+    RTXGI_VK_BINDING(PROBE_SCHEDULE_REGISTER, PROBE_SCHEDULE_SPACE)
+    RWByteAddressBuffer ProbeSchedule PROBE_SCHEDULE_REG_DECL;
+#endif
+
 #endif // RTXGI_DDGI_BINDLESS_RESOURCES
 
+/**
+ * Returns true when a fixed ray's frontface hit is inside the probe's voxel,
+ * i.e. closer than the ray's intersection with the voxel planes around the probe.
+ */
+bool DDGIIsFixedRayHitInProbeVoxel(int rayIndex, float hitDistance, float3 probeWorldPosition, DDGIVolumeDescGPU volume)
+{
+    // Skip backface hits
+    if (hitDistance < 0) return false;
+
+    // Get the direction of the "fixed" ray
+    float3 direction = DDGIGetProbeRayDirection(rayIndex, volume);
+
+    // Get the plane normals
+    float3 xNormal = float3(direction.x / max(abs(direction.x), 0.000001f), 0.f, 0.f);
+    float3 yNormal = float3(0.f, direction.y / max(abs(direction.y), 0.000001f), 0.f);
+    float3 zNormal = float3(0.f, 0.f, direction.z / max(abs(direction.z), 0.000001f));
+
+    // Get the relevant planes to intersect
+    float3 p0x = probeWorldPosition + (volume.probeSpacing.x * xNormal);
+    float3 p0y = probeWorldPosition + (volume.probeSpacing.y * yNormal);
+    float3 p0z = probeWorldPosition + (volume.probeSpacing.z * zNormal);
+
+    // Get the ray's intersection distance with each plane
+    float3 distances = 
+    {
+        dot((p0x - probeWorldPosition), xNormal) / max(dot(direction, xNormal), 0.000001f),
+        dot((p0y - probeWorldPosition), yNormal) / max(dot(direction, yNormal), 0.000001f),
+        dot((p0z - probeWorldPosition), zNormal) / max(dot(direction, zNormal), 0.000001f)
+    };
+
+    // If the ray is parallel to the plane, it will never intersect
+    // Set the distance to a very large number for those planes
+    if (distances.x == 0.f) distances.x = 1e27f;
+    if (distances.y == 0.f) distances.y = 1e27f;
+    if (distances.z == 0.f) distances.z = 1e27f;
+
+    // Get the distance to the closest plane intersection
+    float maxDistance = min(distances.x, min(distances.y, distances.z));
+
+    // If the hit distance is less than the closest plane intersection, the probe should be active
+    return (hitDistance <= maxDistance);
+}
+
+#if RTXGI_DDGI_FIXED_RAYS_WAVE_OPS
+[numthreads(RTXGI_DDGI_NUM_FIXED_RAYS, 1, 1)]
+void DDGIProbeClassificationCS(uint3 GroupID : SV_GroupID, uint GroupIndex : SV_GroupIndex)
+#else
 [numthreads(32, 1, 1)]
 void DDGIProbeClassificationCS(uint3 DispatchThreadID : SV_DispatchThreadID)
+#endif
 {
     // Get the volume's index
     uint volumeIndex = GetDDGIVolumeIndex();
 
-    // Compute the probe index for this thread
-    uint probeIndex = DispatchThreadID.x;
-
 #if RTXGI_DDGI_BINDLESS_RESOURCES
     #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_DESCRIPTOR_HEAP
         // Get the DDGIVolume constants structured buffer from the descriptor heap (SM6.6+ only)
@@ -108,6 +169,18 @@ void DDGIProbeClassificationCS(uint3 DispatchThreadID : SV_DispatchThreadID)
     // Get the volume's constants
     DDGIVolumeDescGPU volume = UnpackDDGIVolumeDescGPU(DDGIVolumes[volumeIndex]);
 
+#if RTXGI_DDGI_FIXED_RAYS_WAVE_OPS
+    // Compute the probe index for this wave (one thread group per probe) and the fixed ray for this lane.
+    // Only the wave's first lane writes the probe's state.
+    uint probeIndex = DDGIGetProbeIndex(GroupID, 1, volume);
+    int rayIndex = (int)GroupIndex;
+    bool isWriter = WaveIsFirstLane();
+#else
+    // Compute the probe index for this thread
+    uint probeIndex = DispatchThreadID.x;
+    bool isWriter = true;
+#endif
+
     // Early out: if this thread maps past the number of probes in the volume
     int numProbes = (volume.probeCounts.x * volume.probeCounts.y * volume.probeCounts.z);
     if (probeIndex >= numProbes) return;
@@ -121,6 +194,9 @@ void DDGIProbeClassificationCS(uint3 DispatchThreadID : SV_DispatchThreadID)
         // Get the volume's ray data and probe data UAVs from the descriptor heap (SM6.6+ only)
         RWTexture2DArray<float4> RayData = ResourceDescriptorHeap[resourceIndices.rayDataUAVIndex];
         RWTexture2DArray<float4> ProbeData = ResourceDescriptorHeap[resourceIndices.probeDataUAVIndex];
+        #if RTXGI_DDGI_PROBE_SCHEDULING
+            RWByteAddressBuffer ProbeSchedule = ResourceDescriptorHeap[resourceIndices.probeScheduleUAVIndex];
+        #endif
     #elif RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
         // Get the volume's resource indices
         DDGIVolumeResourceIndices resourceIndices = DDGIVolumeBindless[volumeIndex];
@@ -128,12 +204,35 @@ void DDGIProbeClassificationCS(uint3 DispatchThreadID : SV_DispatchThreadID)
         // Get the volume's ray data and probe data UAVs
         RWTexture2DArray<float4> RayData = RWTex2DArray[resourceIndices.rayDataUAVIndex];
         RWTexture2DArray<float4> ProbeData = RWTex2DArray[resourceIndices.probeDataUAVIndex];
+        #if RTXGI_DDGI_PROBE_SCHEDULING
+            RWByteAddressBuffer ProbeSchedule = ProbeSchedules[resourceIndices.probeScheduleUAVIndex];
+        #endif
     #endif
 #endif
 
+    // Early out: time slicing, the probe's group is classified on another frame and keeps its state
+    if (!DDGIIsProbeInTimeSlice(probeIndex, volume))
+    {
+    #if RTXGI_DDGI_PROBE_SCHEDULING
+        // The list of probes to blend is rebuilt every frame, append the probe if its (previous) state is active
+        if (isWriter && volume.probeBlendingActiveOnly && ProbeData[DDGIGetProbeTexelCoords(probeIndex, volume)].w == RTXGI_DDGI_PROBE_STATE_ACTIVE)
+        {
+            uint slot;
+            ProbeSchedule.InterlockedAdd(RTXGI_DDGI_PROBE_SCHEDULE_COUNT_OFFSET, 1, slot);
+            ProbeSchedule.Store(RTXGI_DDGI_PROBE_SCHEDULE_LIST_OFFSET + (slot * 4), probeIndex);
+        }
+    #endif
+        return;
+    }
+
     // Get the number of ray samples to inspect
     int numRays = min(volume.probeNumRays, RTXGI_DDGI_NUM_FIXED_RAYS);
 
+#if RTXGI_DDGI_FIXED_RAYS_WAVE_OPS
+    // Load the hit distance for this lane's ray and count the number of backface hits across the wave
+    float hitDistance = DDGILoadProbeRayDistance(RayData, DDGIGetRayDataTexelCoords(rayIndex, probeIndex, volume), volume);
+    int backfaceCount = (int)WaveActiveCountBits(hitDistance < 0.f);
+#else
     int rayIndex;
     int backfaceCount = 0;
     float hitDistances[RTXGI_DDGI_NUM_FIXED_RAYS];
@@ -150,6 +249,7 @@ void DDGIProbeClassificationCS(uint3 DispatchThreadID : SV_DispatchThreadID)
         // Increment the count if a backface is hit
         backfaceCount += (hitDistances[rayIndex] < 0.f);
     }
+#endif
 
     // Get the probe's texel coordinates in the Probe Data texture array
     uint3 outputCoords = DDGIGetProbeTexelCoords(probeIndex, volume);
@@ -157,7 +257,13 @@ void DDGIProbeClassificationCS(uint3 DispatchThreadID : SV_DispatchThreadID)
     // Early out: number of backface hits has been exceeded. The probe is probably inside geometry.
     if(((float)backfaceCount / (float)RTXGI_DDGI_NUM_FIXED_RAYS) > volume.probeFixedRayBackfaceThreshold)
     {
-        ProbeData[outputCoords].w = RTXGI_DDGI_PROBE_STATE_INACTIVE;
+        if (isWriter)
+        {
+            ProbeData[outputCoords].w = RTXGI_DDGI_PROBE_STATE_INACTIVE;
+        #if RTXGI_DDGI_PROBE_SCHEDULING
+            if (volume.probeStateBitsEnabled) DDGIStoreProbeStateBit(probeIndex, true, ProbeSchedule, volume);
+        #endif
+        }
         return;
     }
 
@@ -166,52 +272,45 @@ void DDGIProbeClassificationCS(uint3 DispatchThreadID : SV_DispatchThreadID)
     float3 probeWorldPosition = DDGIGetProbeWorldPosition(probeCoords, volume, ProbeData);
 
     // Determine if there is nearby geometry in the probe's voxel.
-    // Iterate over the probe rays and compare ray hit distances with
-    // the distance(s) to the probe's voxel planes.
+    // Compare the probe ray hit distances with the distance(s) to the probe's voxel planes.
+    bool nearGeometry = false;
+#if RTXGI_DDGI_FIXED_RAYS_WAVE_OPS
+    nearGeometry = WaveActiveAnyTrue(DDGIIsFixedRayHitInProbeVoxel(rayIndex, hitDistance, probeWorldPosition, volume));
+#else
     for (rayIndex = 0; rayIndex < RTXGI_DDGI_NUM_FIXED_RAYS; rayIndex++)
     {
-        // Skip backface hits
-        if(hitDistances[rayIndex] < 0) continue;
+        if (DDGIIsFixedRayHitInProbeVoxel(rayIndex, hitDistances[rayIndex], probeWorldPosition, volume))
+        {
+            nearGeometry = true;
+            break;
+        }
+    }
+#endif
 
-        // Get the direction of the "fixed" ray
-        float3 direction = DDGIGetProbeRayDirection(rayIndex, volume);
+    if (!isWriter) return;
 
-        // Get the plane normals
-        float3 xNormal = float3(direction.x / max(abs(direction.x), 0.000001f), 0.f, 0.f);
-        float3 yNormal = float3(0.f, direction.y / max(abs(direction.y), 0.000001f), 0.f);
-        float3 zNormal = float3(0.f, 0.f, direction.z / max(abs(direction.z), 0.000001f));
+    if (nearGeometry)
+    {
+        ProbeData[outputCoords].w = RTXGI_DDGI_PROBE_STATE_ACTIVE;
 
-        // Get the relevant planes to intersect
-        float3 p0x = probeWorldPosition + (volume.probeSpacing.x * xNormal);
-        float3 p0y = probeWorldPosition + (volume.probeSpacing.y * yNormal);
-        float3 p0z = probeWorldPosition + (volume.probeSpacing.z * zNormal);
+    #if RTXGI_DDGI_PROBE_SCHEDULING
+        if (volume.probeStateBitsEnabled) DDGIStoreProbeStateBit(probeIndex, false, ProbeSchedule, volume);
 
-        // Get the ray's intersection distance with each plane
-        float3 distances = 
+        // Append the probe to the list of probes to blend
+        if (volume.probeBlendingActiveOnly)
         {
-            dot((p0x - probeWorldPosition), xNormal) / max(dot(direction, xNormal), 0.000001f),
-            dot((p0y - probeWorldPosition), yNormal) / max(dot(direction, yNormal), 0.000001f),
-            dot((p0z - probeWorldPosition), zNormal) / max(dot(direction, zNormal), 0.000001f)
-        };
-
-        // If the ray is parallel to the plane, it will never intersect
-        // Set the distance to a very large number for those planes
-        if (distances.x == 0.f) distances.x = 1e27f;
-        if (distances.y == 0.f) distances.y = 1e27f;
-        if (distances.z == 0.f) distances.z = 1e27f;
-
-        // Get the distance to the closest plane intersection
-        float maxDistance = min(distances.x, min(distances.y, distances.z));
-
-        // If the hit distance is less than the closest plane intersection, the probe should be active
-        if(hitDistances[rayIndex] <= maxDistance)
-        {
-            ProbeData[outputCoords].w = RTXGI_DDGI_PROBE_STATE_ACTIVE;
-            return;
+            uint slot;
+            ProbeSchedule.InterlockedAdd(RTXGI_DDGI_PROBE_SCHEDULE_COUNT_OFFSET, 1, slot);
+            ProbeSchedule.Store(RTXGI_DDGI_PROBE_SCHEDULE_LIST_OFFSET + (slot * 4), probeIndex);
         }
+    #endif
+        return;
     }
 
     ProbeData[outputCoords].w = RTXGI_DDGI_PROBE_STATE_INACTIVE;
+#if RTXGI_DDGI_PROBE_SCHEDULING
+    if (volume.probeStateBitsEnabled) DDGIStoreProbeStateBit(probeIndex, true, ProbeSchedule, volume);
+#endif
 }
 
 
@@ -239,6 +338,9 @@ void DDGIProbeClassificationResetCS(uint3 DispatchThreadID : SV_DispatchThreadID
 
         // Get the volume's probe data texture array UAV
         RWTexture2DArray<float4> ProbeData = ResourceDescriptorHeap[resourceIndices.probeDataUAVIndex];
+        #if RTXGI_DDGI_PROBE_SCHEDULING
+            RWByteAddressBuffer ProbeSchedule = ResourceDescriptorHeap[resourceIndices.probeScheduleUAVIndex];
+        #endif
     #elif RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
 
         // Get the volume's resource indices
@@ -246,6 +348,9 @@ void DDGIProbeClassificationResetCS(uint3 DispatchThreadID : SV_DispatchThreadID
 
         // Get the volume's probe data texture array UAV
         RWTexture2DArray<float4> ProbeData = RWTex2DArray[resourceIndices.probeDataUAVIndex];
+        #if RTXGI_DDGI_PROBE_SCHEDULING
+            RWByteAddressBuffer ProbeSchedule = ProbeSchedules[resourceIndices.probeScheduleUAVIndex];
+        #endif
     #endif
 #endif
 
@@ -254,4 +359,13 @@ void DDGIProbeClassificationResetCS(uint3 DispatchThreadID : SV_DispatchThreadID
 
     // Set all probes to active
     ProbeData[outputCoords].w = RTXGI_DDGI_PROBE_STATE_ACTIVE;
+
+#if RTXGI_DDGI_PROBE_SCHEDULING
+    // Clear the probe state bits, one thread per 32 probes
+    int numProbes = (volume.probeCounts.x * volume.probeCounts.y * volume.probeCounts.z);
+    if (volume.probeStateBitsEnabled && ((DispatchThreadID.x & 31) == 0) && (DispatchThreadID.x < (uint)numProbes))
+    {
+        ProbeSchedule.Store(RTXGI_DDGI_PROBE_SCHEDULE_STATE_BITS_OFFSET(numProbes) + ((DispatchThreadID.x >> 5) * 4), 0);
+    }
+#endif
 }
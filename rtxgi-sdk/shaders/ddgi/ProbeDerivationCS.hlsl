@@ -0,0 +1,219 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+// For example usage, see DDGI_[D3D12|VK].cpp::CompileDDGIVolumeShaders() function.
+
+// -------- CONFIG FILE ---------------------------------------------------------------------------
+
+#if RTXGI_DDGI_USE_SHADER_CONFIG_FILE
+#include <DDGIShaderConfig.h>
+#endif
+
+// -------- DEFINE VALIDATION ---------------------------------------------------------------------
+
+#include "include/validation/ProbeDerivationDefines.hlsl"
+
+// -------- REGISTER DECLARATIONS -----------------------------------------------------------------
+
+#if RTXGI_DDGI_SHADER_REFLECTION
+
+    // Don't declare registers when using reflection
+    #define VOLUME_CONSTS_REG_DECL
+    #define VOLUME_RESOURCES_REG_DECL
+    #define RWTEX2DARRAY_REG_DECL
+
+#else
+
+    // Declare registers and spaces when using D3D *without* reflection
+    #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
+        #define VOLUME_CONSTS_REG_DECL : register(VOLUME_CONSTS_REGISTER, VOLUME_CONSTS_SPACE)
+        #define VOLUME_RESOURCES_REG_DECL : register(VOLUME_RESOURCES_REGISTER, VOLUME_RESOURCES_SPACE)
+        #define RWTEX2DARRAY_REG_DECL : register(RWTEX2DARRAY_REGISTER, RWTEX2DARRAY_SPACE)
+    #endif
+
+#endif // RTXGI_DDGI_SHADER_REFLECTION
+
+// -------- ROOT / PUSH CONSTANT DECLARATIONS -----------------------------------------------------
+
+#include "include/ProbeCommon.hlsl"
+#include "include/DDGIRootConstants.hlsl"
+
+// -------- RESOURCE DECLARATIONS -----------------------------------------------------------------
+
+#if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
+
+    // DDGIVolume constants structured buffer
+    StructuredBuffer<DDGIVolumeDescGPUPacked> DDGIVolumes VOLUME_CONSTS_REG_DECL;
+
+    // DDGIVolume resource indices structured buffer
+    StructuredBuffer<DDGIVolumeResourceIndices> DDGIVolumeBindless VOLUME_RESOURCES_REG_DECL;
+
+    // DDGIVolume probe irradiance and probe data
+    RWTexture2DArray<float4> RWTex2DArray[] RWTEX2DARRAY_REG_DECL;
+
+#endif
+
+// -------- HELPER FUNCTIONS ----------------------------------------------------------------------
+
+/**
+ * Computes the (linear) irradiance texel value of the derivation volume at a world-space position in the given direction.
+ * Trilinearly interpolates the nearest interior texel of the eight probes around the position, skipping inactive probes.
+ * The derived probe is in free space like the probes around it, so the distance based visibility of irradiance sampling is left out.
+ */
+float3 DDGIGetDerivedProbeIrradiance(
+    float3 worldPosition,
+    float3 direction,
+    DDGIVolumeDescGPU volume,
+    RWTexture2DArray<float4> ProbeIrradiance,
+    RWTexture2DArray<float4> ProbeData)
+{
+    // Get the base probe of the cell around the position and the position's trilinear weights in the cell
+    int3   baseProbeCoords = DDGIGetBaseProbeGridCoords(worldPosition, volume);
+    float3 gridSpaceDistance = (worldPosition - DDGIGetProbeWorldPosition(baseProbeCoords, volume));
+    if (!IsVolumeMovementScrolling(volume)) gridSpaceDistance = RTXGIQuaternionRotate(gridSpaceDistance, RTXGIQuaternionConjugate(volume.rotation));
+    float3 alpha = saturate(gridSpaceDistance / volume.probeSpacing);
+
+    // Get the interior texel of the direction (the same in every probe)
+    int    numInteriorTexels = volume.probeNumIrradianceInteriorTexels;
+    float2 octantCoords = DDGIGetOctahedralCoordinates(direction);
+    int2   octantTexel = clamp(int2(((octantCoords * 0.5f) + 0.5f) * numInteriorTexels), int2(0, 0), int2(numInteriorTexels - 1, numInteriorTexels - 1));
+
+    float3 irradiance = float3(0.f, 0.f, 0.f);
+    float  accumulatedWeights = 0.f;
+    for (int probeIndex = 0; probeIndex < 8; probeIndex++)
+    {
+        int3 adjacentProbeOffset = int3(probeIndex, probeIndex >> 1, probeIndex >> 2) & int3(1, 1, 1);
+        int3 adjacentProbeCoords = clamp(baseProbeCoords + adjacentProbeOffset, int3(0, 0, 0), volume.probeCounts - int3(1, 1, 1));
+        int  adjacentProbeIndex = DDGIGetScrollingProbeIndex(adjacentProbeCoords, volume);
+
+        if (volume.probeClassificationEnabled)
+        {
+            if (DDGILoadProbeState(adjacentProbeIndex, ProbeData, volume) == RTXGI_DDGI_PROBE_STATE_INACTIVE) continue;
+        }
+
+        float3 trilinear = max(0.001f, lerp(1.f - alpha, alpha, adjacentProbeOffset));
+        float  weight = (trilinear.x * trilinear.y * trilinear.z);
+
+        // Load the texel (skipping the probe's border) and remove the irradiance encoding gamma
+        uint3 probeTexelCoords = DDGIGetProbeTexelCoords(adjacentProbeIndex, volume);
+        uint3 texelCoords = uint3((probeTexelCoords.xy * (numInteriorTexels + 2)) + 1 + octantTexel, probeTexelCoords.z);
+        irradiance += weight * pow(ProbeIrradiance[texelCoords].rgb, volume.probeIrradianceEncodingGamma);
+        accumulatedWeights += weight;
+    }
+
+    if (accumulatedWeights == 0.f) return float3(0.f, 0.f, 0.f);
+    return irradiance / accumulatedWeights;
+}
+
+// When the thread maps to a border texel, copy the derived interior texel it mirrors (see UpdateBorderTexel() in ProbeBlendingCS.hlsl)
+void UpdateDerivedBorderTexel(uint3 DispatchThreadID, uint3 GroupThreadID, uint3 GroupID, RWTexture2DArray<float4> Output)
+{
+    bool isCornerTexel = (GroupThreadID.x == 0 || GroupThreadID.x == (RTXGI_DDGI_PROBE_NUM_TEXELS - 1)) && (GroupThreadID.y == 0 || GroupThreadID.y == (RTXGI_DDGI_PROBE_NUM_TEXELS - 1));
+    bool isRowTexel = (GroupThreadID.x > 0 && GroupThreadID.x < (RTXGI_DDGI_PROBE_NUM_TEXELS - 1));
+
+    uint2 copyTexel = uint2(0, 0);
+    if (isCornerTexel)
+    {
+        copyTexel.x = GroupThreadID.x > 0 ? 1 : RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS;
+        copyTexel.y = GroupThreadID.y > 0 ? 1 : RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS;
+    }
+    else if (isRowTexel)
+    {
+        copyTexel.x = (RTXGI_DDGI_PROBE_NUM_TEXELS - 1) - GroupThreadID.x;
+        copyTexel.y = GroupThreadID.y + ((GroupThreadID.y > 0) ? -1 : 1);
+    }
+    else // Column Texel
+    {
+        copyTexel.x = GroupThreadID.x + ((GroupThreadID.x > 0) ? -1 : 1);
+        copyTexel.y = (RTXGI_DDGI_PROBE_NUM_TEXELS - 1) - GroupThreadID.y;
+    }
+
+    Output[DispatchThreadID] = Output[uint3((GroupID.xy * RTXGI_DDGI_PROBE_NUM_TEXELS) + copyTexel, DispatchThreadID.z)];
+}
+
+// -------- ENTRY POINT ---------------------------------------------------------------------------
+
+/**
+ * Writes the irradiance of the volume's derived probes (see DDGIIsProbeDerived()) from the probes of its derivation volume.
+ * One thread group per probe, dispatched like irradiance blending. Runs after both volumes' irradiance blending, so the
+ * derived texels replace any traced update of the probe this frame.
+ */
+[numthreads(RTXGI_DDGI_PROBE_NUM_TEXELS, RTXGI_DDGI_PROBE_NUM_TEXELS, 1)]
+void DDGIProbeDerivationCS(
+    uint3 DispatchThreadID : SV_DispatchThreadID,
+    uint3 GroupThreadID    : SV_GroupThreadID,
+    uint3 GroupID          : SV_GroupID)
+{
+    // Get the volume's index and the derivation volume's index
+    uint volumeIndex = GetDDGIVolumeIndex();
+    uint derivationVolumeIndex = GetDDGIProbeDerivationVolumeIndex();
+    if (derivationVolumeIndex == RTXGI_DDGI_PROBE_DERIVATION_NONE) return;
+
+#if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_DESCRIPTOR_HEAP
+    // Get the DDGIVolume constants and resource indices structured buffers from the descriptor heap (SM6.6+ only)
+    StructuredBuffer<DDGIVolumeDescGPUPacked> DDGIVolumes = ResourceDescriptorHeap[GetDDGIVolumeConstantsIndex()];
+    StructuredBuffer<DDGIVolumeResourceIndices> DDGIVolumeBindless = ResourceDescriptorHeap[GetDDGIVolumeResourceIndicesIndex()];
+#endif
+
+    // Get the volumes' constants and resource indices
+    DDGIVolumeDescGPU volume = UnpackDDGIVolumeDescGPU(DDGIVolumes[volumeIndex]);
+    DDGIVolumeDescGPU derivationVolume = UnpackDDGIVolumeDescGPU(DDGIVolumes[derivationVolumeIndex]);
+    DDGIVolumeResourceIndices resourceIndices = DDGIVolumeBindless[volumeIndex];
+    DDGIVolumeResourceIndices derivationResourceIndices = DDGIVolumeBindless[derivationVolumeIndex];
+
+    // Early out: spherical harmonics encoded irradiance isn't sampled from the irradiance texture
+    if (volume.probeIrradianceEncoding != RTXGI_DDGI_PROBE_IRRADIANCE_ENCODING_OCTAHEDRAL) return;
+    if (derivationVolume.probeIrradianceEncoding != RTXGI_DDGI_PROBE_IRRADIANCE_ENCODING_OCTAHEDRAL) return;
+
+#if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_DESCRIPTOR_HEAP
+    // Get the volumes' texture array UAVs from the descriptor heap (SM6.6+ only)
+    RWTexture2DArray<float4> Output = ResourceDescriptorHeap[resourceIndices.probeIrradianceUAVIndex];
+    RWTexture2DArray<float4> ProbeData = ResourceDescriptorHeap[resourceIndices.probeDataUAVIndex];
+    RWTexture2DArray<float4> DerivationProbeIrradiance = ResourceDescriptorHeap[derivationResourceIndices.probeIrradianceUAVIndex];
+    RWTexture2DArray<float4> DerivationProbeData = ResourceDescriptorHeap[derivationResourceIndices.probeDataUAVIndex];
+#elif RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
+    // Get the volumes' texture array UAVs
+    RWTexture2DArray<float4> Output = RWTex2DArray[resourceIndices.probeIrradianceUAVIndex];
+    RWTexture2DArray<float4> ProbeData = RWTex2DArray[resourceIndices.probeDataUAVIndex];
+    RWTexture2DArray<float4> DerivationProbeIrradiance = RWTex2DArray[derivationResourceIndices.probeIrradianceUAVIndex];
+    RWTexture2DArray<float4> DerivationProbeData = RWTex2DArray[derivationResourceIndices.probeDataUAVIndex];
+#endif
+
+    // Find the probe index for this thread
+    int probeIndex = DDGIGetProbeIndex(DispatchThreadID, RTXGI_DDGI_PROBE_NUM_TEXELS, volume);
+
+    // Early out: no probe maps to this thread
+    int numProbes = (volume.probeCounts.x * volume.probeCounts.y * volume.probeCounts.z);
+    if (probeIndex >= numProbes || probeIndex < 0) return;
+
+    // Early out: the probe isn't derived (the whole thread group exits)
+    float3 probeWorldPosition = DDGIGetProbeWorldPosition(DDGIGetProbeCoords(probeIndex, volume), volume, ProbeData);
+    if (!DDGIIsProbeDerived(probeWorldPosition, derivationVolume)) return;
+
+    // Determine if this thread maps to a probe border texel
+    bool isBorderTexel = (GroupThreadID.x == 0 || GroupThreadID.x == (RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS + 1));
+    isBorderTexel |= (GroupThreadID.y == 0 || GroupThreadID.y == (RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS + 1));
+
+    if (!isBorderTexel)
+    {
+        // Get the direction of the interior texel
+        float2 probeOctantUV = DDGIGetNormalizedOctahedralCoordinates(int2(GroupThreadID.xy) - int2(1, 1), RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS);
+        float3 direction = DDGIGetOctahedralDirection(probeOctantUV);
+
+        // Encode the derivation volume's irradiance with this volume's irradiance encoding gamma
+        float3 irradiance = DDGIGetDerivedProbeIrradiance(probeWorldPosition, direction, derivationVolume, DerivationProbeIrradiance, DerivationProbeData);
+        Output[DispatchThreadID] = float4(pow(irradiance, (1.f / volume.probeIrradianceEncodingGamma)), 1.f);
+    }
+
+    // Wait for the interior texels to be written
+    AllMemoryBarrierWithGroupSync();
+
+    if (isBorderTexel) UpdateDerivedBorderTexel(DispatchThreadID, GroupThreadID, GroupID, Output);
+}
@@ -89,15 +89,17 @@
 
 #endif // RTXGI_DDGI_BINDLESS_RESOURCES
 
+#if RTXGI_DDGI_FIXED_RAYS_WAVE_OPS
+[numthreads(RTXGI_DDGI_NUM_FIXED_RAYS, 1, 1)]
+void DDGIProbeRelocationCS(uint3 GroupID : SV_GroupID, uint GroupIndex : SV_GroupIndex)
+#else
 [numthreads(32, 1, 1)]
 void DDGIProbeRelocationCS(uint3 DispatchThreadID : SV_DispatchThreadID)
+#endif
 {
     // Get the volume's index
     uint volumeIndex = GetDDGIVolumeIndex();
 
-    // Compute the probe index for this thread
-    uint probeIndex = DispatchThreadID.x;
-
 #if RTXGI_DDGI_BINDLESS_RESOURCES
     #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_DESCRIPTOR_HEAP
         // Get the DDGIVolume constants structured buffer from the descriptor heap (SM6.6+ only)
@@ -108,10 +110,22 @@ void DDGIProbeRelocationCS(uint3 DispatchThreadID : SV_DispatchThreadID)
     // Get the volume's constants
     DDGIVolumeDescGPU volume = UnpackDDGIVolumeDescGPU(DDGIVolumes[volumeIndex]);
 
+#if RTXGI_DDGI_FIXED_RAYS_WAVE_OPS
+    // Compute the probe index for this wave (one thread group per probe) and the fixed ray for this lane
+    uint probeIndex = DDGIGetProbeIndex(GroupID, 1, volume);
+    int rayIndex = (int)GroupIndex;
+#else
+    // Compute the probe index for this thread
+    uint probeIndex = DispatchThreadID.x;
+#endif
+
     // Early out: if this thread maps past the number of probes in the volume
     int numProbes = (volume.probeCounts.x * volume.probeCounts.y * volume.probeCounts.z);
     if (probeIndex >= numProbes) return;
 
+    // Early out: time slicing, the probe's group is relocated on another frame
+    if (!DDGIIsProbeInTimeSlice(probeIndex, volume)) return;
+
 #if RTXGI_DDGI_BINDLESS_RESOURCES
     #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_DESCRIPTOR_HEAP
         // Get the volume's resource indices from the descriptor heap (SM6.6+ only)
@@ -137,6 +151,36 @@ void DDGIProbeRelocationCS(uint3 DispatchThreadID : SV_DispatchThreadID)
     // Read the current world position offset
     float3 offset = DDGILoadProbeDataOffset(ProbeData, outputCoords, volume);
 
+    // Get the number of rays to inspect
+    int numRays = min(volume.probeNumRays, RTXGI_DDGI_NUM_FIXED_RAYS);
+
+#if RTXGI_DDGI_FIXED_RAYS_WAVE_OPS
+    // Each lane loads the hit distance of one fixed ray
+    float hitDistance = 0.f;
+    bool isFixedRay = (rayIndex < numRays);
+    if (isFixedRay) hitDistance = DDGILoadProbeRayDistance(RayData, DDGIGetRayDataTexelCoords(rayIndex, probeIndex, volume), volume);
+
+    bool isBackface = isFixedRay && (hitDistance < 0.f);
+    bool isFrontface = isFixedRay && !isBackface;
+
+    // Negate the hit distance on a backface hit and scale back to the full distance
+    if (isBackface) hitDistance = hitDistance * -5.f;
+
+    // Find the number of backfaces and closest/farthest distances to the probe across the wave
+    float backfaceCount = (float)WaveActiveCountBits(isBackface);
+    float closestBackfaceDistance = WaveActiveMin(isBackface ? hitDistance : 1e27f);
+    float closestFrontfaceDistance = WaveActiveMin(isFrontface ? hitDistance : 1e27f);
+    float farthestFrontfaceDistance = WaveActiveMax(isFrontface ? hitDistance : 0.f);
+
+    // The lowest ray index holding each distance is selected, as in the per-thread loop.
+    // No matching lane leaves 0xFFFFFFFF, which is -1 as an int (no ray found).
+    int closestBackfaceIndex = (int)WaveActiveMin((isBackface && hitDistance == closestBackfaceDistance) ? (uint)rayIndex : 0xFFFFFFFF);
+    int closestFrontfaceIndex = (int)WaveActiveMin((isFrontface && hitDistance == closestFrontfaceDistance) ? (uint)rayIndex : 0xFFFFFFFF);
+    int farthestFrontfaceIndex = (int)WaveActiveMin((isFrontface && hitDistance == farthestFrontfaceDistance) ? (uint)rayIndex : 0xFFFFFFFF);
+
+    // The remaining work is wave uniform, only the first lane writes the result
+    if (!WaveIsFirstLane()) return;
+#else
     // Initialize variables
     int   closestBackfaceIndex = -1;
     int   closestFrontfaceIndex = -1;
@@ -146,9 +190,6 @@ void DDGIProbeRelocationCS(uint3 DispatchThreadID : SV_DispatchThreadID)
     float farthestFrontfaceDistance = 0.f;
     float backfaceCount = 0.f;
 
-    // Get the number of rays to inspect
-    int numRays = min(volume.probeNumRays, RTXGI_DDGI_NUM_FIXED_RAYS);
-
     // Iterate over the rays cast for this probe to find the number of backfaces and closest/farthest distances to the probe
     for (int rayIndex = 0; rayIndex < numRays; rayIndex++)
     {
@@ -189,6 +230,7 @@ void DDGIProbeRelocationCS(uint3 DispatchThreadID : SV_DispatchThreadID)
             }
         }
     }
+#endif // RTXGI_DDGI_FIXED_RAYS_WAVE_OPS
 
     float3 fullOffset = float3(1e27f, 1e27f, 1e27f);
 
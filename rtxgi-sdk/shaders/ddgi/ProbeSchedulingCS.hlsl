@@ -0,0 +1,354 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+// For example usage, see DDGI_[D3D12|VK].cpp::CompileDDGIVolumeShaders() function.
+
+// -------- CONFIG FILE ---------------------------------------------------------------------------
+
+#if RTXGI_DDGI_USE_SHADER_CONFIG_FILE
+#include <DDGIShaderConfig.h>
+#endif
+
+// -------- DEFINE VALIDATION ---------------------------------------------------------------------
+
+#include "include/validation/ProbeSchedulingDefines.hlsl"
+
+// -------- REGISTER DECLARATIONS -----------------------------------------------------------------
+
+#if RTXGI_DDGI_SHADER_REFLECTION || defined(__spirv__)
+
+    // Don't declare registers when using reflection or cross-compiling to SPIRV
+    #define VOLUME_CONSTS_REG_DECL 
+    #if RTXGI_DDGI_BINDLESS_RESOURCES
+        #define VOLUME_RESOURCES_REG_DECL 
+        #define RWTEX2DARRAY_REG_DECL 
+        #define PROBE_SCHEDULE_REG_DECL 
+    #else
+        #define PROBE_DATA_REG_DECL 
+        #define PROBE_VARIABILITY_REG_DECL 
+        #define PROBE_VARIABILITY_AVERAGE_REG_DECL 
+        #define PROBE_SCHEDULE_REG_DECL 
+    #endif
+
+#else
+
+    // Declare registers and spaces when using D3D *without* reflection
+    #define VOLUME_CONSTS_REG_DECL : register(VOLUME_CONSTS_REGISTER, VOLUME_CONSTS_SPACE)
+    #if RTXGI_DDGI_BINDLESS_RESOURCES
+        #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
+            #define VOLUME_RESOURCES_REG_DECL : register(VOLUME_RESOURCES_REGISTER, VOLUME_RESOURCES_SPACE)
+            #define RWTEX2DARRAY_REG_DECL : register(RWTEX2DARRAY_REGISTER, RWTEX2DARRAY_SPACE)
+            #define PROBE_SCHEDULE_REG_DECL : register(PROBE_SCHEDULE_REGISTER, PROBE_SCHEDULE_SPACE)
+        #endif
+    #else
+        #define PROBE_DATA_REG_DECL : register(PROBE_DATA_REGISTER, PROBE_DATA_SPACE)
+        #define PROBE_VARIABILITY_REG_DECL : register(PROBE_VARIABILITY_REGISTER, PROBE_VARIABILITY_SPACE)
+        #define PROBE_VARIABILITY_AVERAGE_REG_DECL : register(PROBE_VARIABILITY_AVERAGE_REGISTER, PROBE_VARIABILITY_SPACE)
+        #define PROBE_SCHEDULE_REG_DECL : register(PROBE_SCHEDULE_REGISTER, PROBE_SCHEDULE_SPACE)
+    #endif
+
+#endif // RTXGI_DDGI_SHADER_REFLECTION || SPIRV
+
+// -------- ROOT / PUSH CONSTANT DECLARATIONS -----------------------------------------------------
+
+#include "include/ProbeCommon.hlsl"
+#include "include/DDGIRootConstants.hlsl"
+
+// -------- RESOURCE DECLARATIONS -----------------------------------------------------------------
+
+#if RTXGI_DDGI_BINDLESS_RESOURCES
+    #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
+
+        // DDGIVolume constants structured buffer
+        RTXGI_VK_BINDING(VOLUME_CONSTS_REGISTER, VOLUME_CONSTS_SPACE)
+        StructuredBuffer<DDGIVolumeDescGPUPacked> DDGIVolumes VOLUME_CONSTS_REG_DECL;
+
+        // DDGIVolume resource indices structured buffer
+        RTXGI_VK_BINDING(VOLUME_RESOURCES_REGISTER, VOLUME_RESOURCES_SPACE)
+        StructuredBuffer<DDGIVolumeResourceIndices> DDGIVolumeBindless VOLUME_RESOURCES_REG_DECL;
+
+        // DDGIVolume probe data, probe variability, and probe variability average
+        RTXGI_VK_BINDING(RWTEX2DARRAY_REGISTER, RWTEX2DARRAY_SPACE)
+        RWTexture2DArray<float4> RWTex2DArray[] RWTEX2DARRAY_REG_DECL;
+
+        // DDGIVolume probe schedules
+        RTXGI_VK_BINDING(PROBE_SCHEDULE_REGISTER, PROBE_SCHEDULE_SPACE)
+        RWByteAddressBuffer ProbeSchedules[] PROBE_SCHEDULE_REG_DECL;
+
+    #endif
+#else
+
+    // DDGIVolume constants structured buffer
+    RTXGI_VK_BINDING(VOLUME_CONSTS_REGISTER, VOLUME_CONSTS_SPACE)
+    StructuredBuffer<DDGIVolumeDescGPUPacked> DDGIVolumes VOLUME_CONSTS_REG_DECL;
+
+    // Probe data (world-space offsets and classification states)
+    RTXGI_VK_BINDING(PROBE_DATA_REGISTER, PROBE_DATA_SPACE)
+    RWTexture2DArray<float4> ProbeData PROBE_DATA_REG_DECL;
+
+    // Probe variability
+    RTXGI_VK_BINDING(PROBE_VARIABILITY_REGISTER, PROBE_VARIABILITY_SPACE)
+    RWTexture2DArray<float4> ProbeVariability PROBE_VARIABILITY_REG_DECL;
+
+    // Probe variability average
+    RTXGI_VK_BINDING(PROBE_VARIABILITY_AVERAGE_REGISTER, PROBE_VARIABILITY_SPACE)
+    RWTexture2DArray<float4> ProbeVariabilityAverage PROBE_VARIABILITY_AVERAGE_REG_DECL;
+
+    // Probe schedule (dispatch arguments, append counter, and list of scheduled probe indices)
+    RTXGI_VK_BINDING(PROBE_SCHEDULE_REGISTER, PROBE_SCHEDULE_SPACE)
+    RWByteAddressBuffer ProbeSchedule PROBE_SCHEDULE_REG_DECL;
+
+#endif // RTXGI_DDGI_BINDLESS_RESOURCES
+
+/**
+ * Whether a probe's irradiance must be refreshed with every ray this frame: the probe has scrolled into view
+ * (the blending passes clear or seed it) or its cell overlaps a small light change (see DDGIVolumeBase::OnSmallLightChange()).
+ */
+bool DDGIGetProbeRefreshNeeded(int3 probeCoords, DDGIVolumeDescGPU volume, RWTexture2DArray<float4> ProbeData)
+{
+    if (IsVolumeMovementScrolling(volume))
+    {
+        bool scrollClear = false;
+        scrollClear |= DDGIClearScrolledPlane(probeCoords, 0, volume);
+        scrollClear |= DDGIClearScrolledPlane(probeCoords, 1, volume);
+        scrollClear |= DDGIClearScrolledPlane(probeCoords, 2, volume);
+        if (scrollClear) return true;
+    }
+
+    if (volume.probeEventRadius > 0.f)
+    {
+        float3 probeWorldPosition = DDGIGetProbeWorldPosition(probeCoords, volume, ProbeData);
+        float3 delta = max(abs(volume.probeEventOrigin - probeWorldPosition) - volume.probeSpacing, 0.f);
+        if (dot(delta, delta) <= (volume.probeEventRadius * volume.probeEventRadius)) return true;
+    }
+
+    return false;
+}
+
+/**
+ * Computes the average variability of a probe's irradiance texels.
+ * Variability is zero before a probe is first blended, so zero means unknown instead of converged.
+ */
+float DDGIGetProbeAverageVariability(int probeIndex, DDGIVolumeDescGPU volume, RWTexture2DArray<float4> ProbeVariability)
+{
+    uint3 probeTexelCoords = DDGIGetProbeTexelCoords(probeIndex, volume);
+    uint numTexels = (uint)volume.probeNumIrradianceInteriorTexels;
+    uint3 baseCoords = uint3(probeTexelCoords.xy * numTexels, probeTexelCoords.z);
+
+    float variability = 0.f;
+    for (uint y = 0; y < numTexels; y++)
+    {
+        for (uint x = 0; x < numTexels; x++)
+        {
+            variability += ProbeVariability[baseCoords + uint3(x, y, 0)].r;
+        }
+    }
+    return variability / (float)(numTexels * numTexels);
+}
+
+/**
+ * Computes the log2 of the number of frames between updates of a probe.
+ * Probes that need a refresh update every frame, derived, inactive, and converged probes update at the slowest rate,
+ * probes near the view origin update every frame, and the interval doubles each time the distance to the view origin doubles after that.
+ */
+uint DDGIGetProbeUpdateIntervalLog2(
+    int probeIndex,
+    bool refreshNeeded,
+    bool derived,
+    float variability,
+    DDGIVolumeDescGPU volume,
+    RWTexture2DArray<float4> ProbeData)
+{
+    if (refreshNeeded) return 0;
+
+    uint maxIntervalLog2 = volume.probeSchedulingMaxIntervalLog2;
+
+    // Derived probes take their irradiance from the derivation volume, their rays only keep the distance, relocation, and classification current
+    if (derived) return maxIntervalLog2;
+
+    // Inactive probes are only refreshed to notice when they become active again
+    if (volume.probeClassificationEnabled)
+    {
+        if (DDGILoadProbeState(probeIndex, ProbeData, volume) == RTXGI_DDGI_PROBE_STATE_INACTIVE) return maxIntervalLog2;
+    }
+
+    // Converged probes are refreshed at the slowest rate
+    if (volume.probeVariabilityEnabled)
+    {
+        if (variability > 0.f && variability < volume.probeSchedulingVariabilityThreshold) return maxIntervalLog2;
+    }
+
+    // Fall off the update rate with distance (in probe spacings) from the view origin
+    float3 probeWorldPosition = DDGIGetProbeWorldPosition(DDGIGetProbeCoords(probeIndex, volume), volume, ProbeData);
+    float distance = length((probeWorldPosition - volume.probeSchedulingViewOrigin) / volume.probeSpacing);
+    float distanceRatio = max(distance / (float)volume.probeSchedulingFullRateDistance, 1.f);
+
+    return min((uint)ceil(log2(distanceRatio)), maxIntervalLog2);
+}
+
+/**
+ * Counts the consecutive updates whose volume average variability is below the convergence threshold (GPU convergence tracking).
+ * The average is the one of the last variability reduction, zero (unknown) and a new wake generation restart the count.
+ * Once the count reaches probeConvergenceFrames, DDGIProbeSchedulingArgsCS() writes empty dispatch arguments and the volume freezes:
+ * its probes are neither traced nor blended, so the average doesn't change until an update event wakes the volume.
+ */
+void DDGIUpdateProbeConvergence(DDGIVolumeDescGPU volume, RWTexture2DArray<float4> ProbeVariabilityAverage, RWByteAddressBuffer ProbeSchedule)
+{
+    uint2 convergence = ProbeSchedule.Load2(RTXGI_DDGI_PROBE_SCHEDULE_CONVERGENCE_OFFSET);
+    float variability = ProbeVariabilityAverage[uint3(0, 0, 0)].r;
+
+    bool converged = (variability > 0.f && variability < volume.probeConvergenceVariabilityThreshold);
+    if (!converged || convergence.y != volume.probeConvergenceWakeGeneration) convergence.x = 0;
+    else convergence.x = min(convergence.x + 1, volume.probeConvergenceFrames);
+
+    ProbeSchedule.Store2(RTXGI_DDGI_PROBE_SCHEDULE_CONVERGENCE_OFFSET, uint2(convergence.x, volume.probeConvergenceWakeGeneration));
+}
+
+/**
+ * Computes the number of rays a scheduled probe traces this frame (adaptive rays).
+ * Probes that need a refresh, have unknown variability, or have variability at or above probeAdaptiveRaysVariabilityThreshold
+ * trace probeNumRays rays. The count falls off linearly to probeAdaptiveRaysMin blended rays as the probe converges,
+ * rounded up to RTXGI_DDGI_PROBE_ADAPTIVE_RAYS_GRANULARITY rays. The fixed rays of relocation and classification are traced on top.
+ */
+uint DDGIGetProbeAdaptiveNumRays(bool refreshNeeded, float variability, DDGIVolumeDescGPU volume)
+{
+    uint maxRays = (uint)volume.probeNumRays;
+    if (refreshNeeded || variability <= 0.f) return maxRays;
+
+    uint numFixedRays = (volume.probeRelocationEnabled || volume.probeClassificationEnabled) ? RTXGI_DDGI_NUM_FIXED_RAYS : 0;
+    uint minRays = min(numFixedRays + volume.probeAdaptiveRaysMin, maxRays);
+
+    float t = saturate(variability / volume.probeAdaptiveRaysVariabilityThreshold);
+    uint numRays = (uint)ceil(lerp((float)minRays, (float)maxRays, t));
+    numRays = ((numRays + RTXGI_DDGI_PROBE_ADAPTIVE_RAYS_GRANULARITY - 1) / RTXGI_DDGI_PROBE_ADAPTIVE_RAYS_GRANULARITY) * RTXGI_DDGI_PROBE_ADAPTIVE_RAYS_GRANULARITY;
+
+    return clamp(numRays, minRays, maxRays);
+}
+
+[numthreads(32, 1, 1)]
+void DDGIProbeSchedulingCS(uint3 DispatchThreadID : SV_DispatchThreadID)
+{
+    // Get the volume's index
+    uint volumeIndex = GetDDGIVolumeIndex();
+
+    // Compute the probe index for this thread
+    int probeIndex = DispatchThreadID.x;
+
+#if RTXGI_DDGI_BINDLESS_RESOURCES
+    #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_DESCRIPTOR_HEAP
+        // Get the DDGIVolume constants structured buffer from the descriptor heap (SM6.6+ only)
+        StructuredBuffer<DDGIVolumeDescGPUPacked> DDGIVolumes = ResourceDescriptorHeap[GetDDGIVolumeConstantsIndex()];
+    #endif
+#endif
+
+    // Get the volume's constants
+    DDGIVolumeDescGPU volume = UnpackDDGIVolumeDescGPU(DDGIVolumes[volumeIndex]);
+
+    // Early out: if this thread maps past the number of probes in the volume
+    int numProbes = (volume.probeCounts.x * volume.probeCounts.y * volume.probeCounts.z);
+    if (probeIndex >= numProbes) return;
+
+#if RTXGI_DDGI_BINDLESS_RESOURCES
+    #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_DESCRIPTOR_HEAP
+        // Get the volume's resource indices from the descriptor heap (SM6.6+ only)
+        StructuredBuffer<DDGIVolumeResourceIndices> DDGIVolumeBindless = ResourceDescriptorHeap[GetDDGIVolumeResourceIndicesIndex()];
+        DDGIVolumeResourceIndices resourceIndices = DDGIVolumeBindless[volumeIndex];
+
+        // Get the volume's probe data, probe variability, probe variability average, and probe schedule UAVs from the descriptor heap (SM6.6+ only)
+        RWTexture2DArray<float4> ProbeData = ResourceDescriptorHeap[resourceIndices.probeDataUAVIndex];
+        RWTexture2DArray<float4> ProbeVariability = ResourceDescriptorHeap[resourceIndices.probeVariabilityUAVIndex];
+        RWTexture2DArray<float4> ProbeVariabilityAverage = ResourceDescriptorHeap[resourceIndices.probeVariabilityAverageUAVIndex];
+        RWByteAddressBuffer ProbeSchedule = ResourceDescriptorHeap[resourceIndices.probeScheduleUAVIndex];
+    #elif RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
+        // Get the volume's resource indices
+        DDGIVolumeResourceIndices resourceIndices = DDGIVolumeBindless[volumeIndex];
+
+        // Get the volume's probe data, probe variability, probe variability average, and probe schedule UAVs
+        RWTexture2DArray<float4> ProbeData = RWTex2DArray[resourceIndices.probeDataUAVIndex];
+        RWTexture2DArray<float4> ProbeVariability = RWTex2DArray[resourceIndices.probeVariabilityUAVIndex];
+        RWTexture2DArray<float4> ProbeVariabilityAverage = RWTex2DArray[resourceIndices.probeVariabilityAverageUAVIndex];
+        RWByteAddressBuffer ProbeSchedule = ProbeSchedules[resourceIndices.probeScheduleUAVIndex];
+    #endif
+#endif
+
+    // Track the volume's convergence once per update, the arguments pass freezes converged volumes
+    if (volume.probeConvergenceFreezeEnabled && probeIndex == 0) DDGIUpdateProbeConvergence(volume, ProbeVariabilityAverage, ProbeSchedule);
+
+    bool refreshNeeded = DDGIGetProbeRefreshNeeded(DDGIGetProbeCoords(probeIndex, volume), volume, ProbeData);
+    float variability = volume.probeVariabilityEnabled ? DDGIGetProbeAverageVariability(probeIndex, volume, ProbeVariability) : 0.f;
+
+    // Check if the probe is derived from another volume (see DDGIProbeDerivationCS())
+    bool derived = false;
+    uint derivationVolumeIndex = GetDDGIProbeDerivationVolumeIndex();
+    if (derivationVolumeIndex != RTXGI_DDGI_PROBE_DERIVATION_NONE)
+    {
+        float3 probeWorldPosition = DDGIGetProbeWorldPosition(DDGIGetProbeCoords(probeIndex, volume), volume, ProbeData);
+        derived = DDGIIsProbeDerived(probeWorldPosition, UnpackDDGIVolumeDescGPU(DDGIVolumes[derivationVolumeIndex]));
+    }
+
+    // Stagger probes that share an update interval across the frames of the interval
+    uint intervalMask = (1u << DDGIGetProbeUpdateIntervalLog2(probeIndex, refreshNeeded, derived, variability, volume, ProbeData)) - 1;
+    if (((volume.probeSchedulingFrame + (uint)probeIndex) & intervalMask) != 0) return;
+
+    // Store the probe's ray count for the trace and blending passes
+    if (volume.probeAdaptiveRaysEnabled)
+    {
+        ProbeSchedule.Store(RTXGI_DDGI_PROBE_SCHEDULE_LIST_OFFSET + ((numProbes + probeIndex) * 4), DDGIGetProbeAdaptiveNumRays(refreshNeeded, variability, volume));
+    }
+
+    // Append the probe to the schedule
+    uint slot;
+    ProbeSchedule.InterlockedAdd(RTXGI_DDGI_PROBE_SCHEDULE_COUNT_OFFSET, 1, slot);
+    ProbeSchedule.Store(RTXGI_DDGI_PROBE_SCHEDULE_LIST_OFFSET + (slot * 4), (uint)probeIndex);
+}
+
+[numthreads(1, 1, 1)]
+void DDGIProbeSchedulingArgsCS()
+{
+    // Get the volume's index
+    uint volumeIndex = GetDDGIVolumeIndex();
+
+#if RTXGI_DDGI_BINDLESS_RESOURCES
+    #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_DESCRIPTOR_HEAP
+        // Get the DDGIVolume constants structured buffer from the descriptor heap (SM6.6+ only)
+        StructuredBuffer<DDGIVolumeDescGPUPacked> DDGIVolumes = ResourceDescriptorHeap[GetDDGIVolumeConstantsIndex()];
+
+        // Get the volume's resource indices from the descriptor heap (SM6.6+ only)
+        StructuredBuffer<DDGIVolumeResourceIndices> DDGIVolumeBindless = ResourceDescriptorHeap[GetDDGIVolumeResourceIndicesIndex()];
+        DDGIVolumeResourceIndices resourceIndices = DDGIVolumeBindless[volumeIndex];
+
+        // Get the volume's probe schedule UAV from the descriptor heap (SM6.6+ only)
+        RWByteAddressBuffer ProbeSchedule = ResourceDescriptorHeap[resourceIndices.probeScheduleUAVIndex];
+    #elif RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
+        // Get the volume's probe schedule UAV
+        DDGIVolumeResourceIndices resourceIndices = DDGIVolumeBindless[volumeIndex];
+        RWByteAddressBuffer ProbeSchedule = ProbeSchedules[resourceIndices.probeScheduleUAVIndex];
+    #endif
+#endif
+
+    // Get the volume's constants
+    DDGIVolumeDescGPU volume = UnpackDDGIVolumeDescGPU(DDGIVolumes[volumeIndex]);
+
+    uint count = ProbeSchedule.Load(RTXGI_DDGI_PROBE_SCHEDULE_COUNT_OFFSET);
+
+    // Converged volumes are frozen: nothing is traced or blended (see DDGIUpdateProbeConvergence())
+    if (volume.probeConvergenceFreezeEnabled)
+    {
+        if (ProbeSchedule.Load(RTXGI_DDGI_PROBE_SCHEDULE_CONVERGENCE_OFFSET) >= volume.probeConvergenceFrames) count = 0;
+    }
+    uint numRayGroups = (volume.probeNumRays + RTXGI_DDGI_PROBE_SCHEDULE_TRACE_GROUP_SIZE - 1) / RTXGI_DDGI_PROBE_SCHEDULE_TRACE_GROUP_SIZE;
+
+    // Write the trace (ray groups x scheduled probes) and blend (one group per scheduled probe) dispatch arguments
+    ProbeSchedule.Store3(RTXGI_DDGI_PROBE_SCHEDULE_TRACE_ARGS_OFFSET, uint3(numRayGroups, count, 1));
+    ProbeSchedule.Store3(RTXGI_DDGI_PROBE_SCHEDULE_BLEND_ARGS_OFFSET, uint3(count, 1, 1));
+
+    // Reset the append counter for the next frame
+    ProbeSchedule.Store(RTXGI_DDGI_PROBE_SCHEDULE_COUNT_OFFSET, 0);
+}
@@ -35,6 +35,7 @@
         #define PROBE_VARIABILITY_REG_DECL 
         #define PROBE_VARIABILITY_AVERAGE_REG_DECL
     #endif
+    #define PROBE_SCHEDULE_REG_DECL
 
 #else
 
@@ -52,9 +53,19 @@
         #define PROBE_VARIABILITY_REG_DECL : register(PROBE_VARIABILITY_REGISTER, PROBE_VARIABILITY_SPACE)
         #define PROBE_VARIABILITY_AVERAGE_REG_DECL : register(PROBE_VARIABILITY_AVERAGE_REGISTER, PROBE_VARIABILITY_SPACE)
     #endif // RTXGI_DDGI_BINDLESS_RESOURCES
+    #if RTXGI_DDGI_REDUCTION_SINGLE_PASS && (!RTXGI_DDGI_BINDLESS_RESOURCES || (RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS))
+        #define PROBE_SCHEDULE_REG_DECL : register(PROBE_SCHEDULE_REGISTER, PROBE_SCHEDULE_SPACE)
+    #endif
 
 #endif // RTXGI_DDGI_SHADER_REFLECTION || SPIRV
 
+// The single pass reduction reads the averages written by other thread groups
+#if RTXGI_DDGI_REDUCTION_SINGLE_PASS
+    #define REDUCTION_AVERAGE_COHERENT globallycoherent
+#else
+    #define REDUCTION_AVERAGE_COHERENT
+#endif
+
 // -------- ROOT / PUSH CONSTANT DECLARATIONS -----------------------------------------------------
 
 #include "include/ProbeCommon.hlsl"
@@ -78,6 +89,12 @@
         RTXGI_VK_BINDING(RWTEX2DARRAY_REGISTER, RWTEX2DARRAY_SPACE)
         RWTexture2DArray<float4> RWTex2DArray[] RWTEX2DARRAY_REG_DECL;
 
+    #if RTXGI_DDGI_REDUCTION_SINGLE_PASS
+        // DDGIVolume probe lists (holds the single pass reduction's thread group counter)
+        RTXGI_VK_BINDING(PROBE_SCHEDULE_REGISTER, PROBE_SCHEDULE_SPACE)
+        RWByteAddressBuffer ProbeSchedules[] PROBE_SCHEDULE_REG_DECL;
+    #endif
+
     #endif
 
 #else
@@ -96,7 +113,13 @@
 
     // Probe variability average
     RTXGI_VK_BINDING(PROBE_VARIABILITY_AVERAGE_REGISTER, PROBE_VARIABILITY_SPACE)
-    RWTexture2DArray<float4> ProbeVariabilityAverage PROBE_VARIABILITY_AVERAGE_REG_DECL;
+    REDUCTION_AVERAGE_COHERENT RWTexture2DArray<float4> ProbeVariabilityAverage PROBE_VARIABILITY_AVERAGE_REG_DECL;
+
+#if RTXGI_DDGI_REDUCTION_SINGLE_PASS
+    // Probe list (holds the single pass reduction's thread group counter)
+    RTXGI_VK_BINDING(PROBE_SCHEDULE_REGISTER, PROBE_SCHEDULE_SPACE)
+    RWByteAddressBuffer ProbeSchedule PROBE_SCHEDULE_REG_DECL;
+#endif
 
 #endif // RTXGI_DDGI_BINDLESS_RESOURCES
 
@@ -112,6 +135,11 @@ groupshared float ThreadGroupSum[NUM_WAVES];
 groupshared uint MaxSumEntry;
 groupshared uint NumTotalSamples;
 
+#if RTXGI_DDGI_REDUCTION_SINGLE_PASS
+groupshared float ThreadGroupWeightSum[NUM_WAVES];
+groupshared bool IsLastThreadGroup;
+#endif
+
 // -------- HELPER FUNCTIONS ----------------------------------------------------------------------
 
 // Sums values in the ThreadGroupSum shared memory array, from 0 to MaxSumEntry
@@ -182,8 +210,11 @@ void DDGIReductionCS(uint3 GroupID : SV_GroupID, uint3 GroupThreadID : SV_GroupT
 
         // Get the volume's texture array UAVs from the descriptor heap (SM6.6+ only)
         RWTexture2DArray<float4> ProbeVariability = ResourceDescriptorHeap[resourceIndices.probeVariabilityUAVIndex];
-        RWTexture2DArray<float4> ProbeVariabilityAverage = ResourceDescriptorHeap[resourceIndices.probeVariabilityAverageUAVIndex];
+        REDUCTION_AVERAGE_COHERENT RWTexture2DArray<float4> ProbeVariabilityAverage = ResourceDescriptorHeap[resourceIndices.probeVariabilityAverageUAVIndex];
         RWTexture2DArray<float4> ProbeData = ResourceDescriptorHeap[resourceIndices.probeDataUAVIndex];
+        #if RTXGI_DDGI_REDUCTION_SINGLE_PASS
+            RWByteAddressBuffer ProbeSchedule = ResourceDescriptorHeap[resourceIndices.probeScheduleUAVIndex];
+        #endif
 
     #elif RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
 
@@ -192,8 +223,11 @@ void DDGIReductionCS(uint3 GroupID : SV_GroupID, uint3 GroupThreadID : SV_GroupT
 
         // Get the volume's texture array UAVs
         RWTexture2DArray<float4> ProbeVariability = RWTex2DArray[resourceIndices.probeVariabilityUAVIndex];
-        RWTexture2DArray<float4> ProbeVariabilityAverage = RWTex2DArray[resourceIndices.probeVariabilityAverageUAVIndex];
+        REDUCTION_AVERAGE_COHERENT RWTexture2DArray<float4> ProbeVariabilityAverage = RWTex2DArray[resourceIndices.probeVariabilityAverageUAVIndex];
         RWTexture2DArray<float4> ProbeData = RWTex2DArray[resourceIndices.probeDataUAVIndex];
+        #if RTXGI_DDGI_REDUCTION_SINGLE_PASS
+            RWByteAddressBuffer ProbeSchedule = ProbeSchedules[resourceIndices.probeScheduleUAVIndex];
+        #endif
 
     #endif
 #endif
@@ -261,6 +295,81 @@ void DDGIReductionCS(uint3 GroupID : SV_GroupID, uint3 GroupThreadID : SV_GroupT
         // Normalizing "weight" factor for this thread group, to allow partial thread groups to average properly with full groups
         ProbeVariabilityAverage[GroupID.xyz].g = NumTotalSamples / TotalPossibleSamples;
     }
+
+#if RTXGI_DDGI_REDUCTION_SINGLE_PASS
+    // Single pass: the last thread group to finish averages the results of all thread groups (instead of extra reduction passes)
+    uint3 groupFootprint = uint3(NUM_THREADS_X, NUM_THREADS_Y, NUM_THREADS_Z) * ThreadSampleFootprint;
+    uint3 numGroups = (probeVariabilitySize + groupFootprint - 1) / groupFootprint;
+    uint numTotalGroups = (numGroups.x * numGroups.y * numGroups.z);
+
+    // Early out: a single thread group already wrote the volume's average
+    if (numTotalGroups <= 1) return;
+
+    if (ThreadIndexInGroup == 0)
+    {
+        // Make this thread group's average visible to the other thread groups before counting it as done
+        DeviceMemoryBarrier();
+
+        uint numGroupsDone;
+        ProbeSchedule.InterlockedAdd(RTXGI_DDGI_PROBE_SCHEDULE_REDUCTION_COUNT_OFFSET, 1, numGroupsDone);
+        IsLastThreadGroup = (numGroupsDone == (numTotalGroups - 1));
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    // Early out: other thread groups are still running
+    if (!IsLastThreadGroup) return;
+
+    // Weight and sum the thread group averages, strided across the thread group
+    float valueSum = 0.f;
+    float weightSum = 0.f;
+    for (uint groupIndex = ThreadIndexInGroup; groupIndex < numTotalGroups; groupIndex += NUM_THREADS)
+    {
+        uint3 groupCoords = uint3(groupIndex % numGroups.x, (groupIndex / numGroups.x) % numGroups.y, groupIndex / (numGroups.x * numGroups.y));
+        float2 groupAverage = ProbeVariabilityAverage[groupCoords].rg;
+        valueSum += (groupAverage.r * groupAverage.g);
+        weightSum += groupAverage.g;
+    }
+
+    // Sum up the warp
+    float waveValueSum = WaveActiveSum(valueSum);
+    float waveWeightSum = WaveActiveSum(weightSum);
+    if (WaveIsFirstLane())
+    {
+        ThreadGroupSum[waveIndex] = waveValueSum;
+        ThreadGroupWeightSum[waveIndex] = waveWeightSum;
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    if (ThreadIndexInGroup >= waveLaneCount) return;
+
+    float totalValue = 0.f;
+    float totalWeight = 0.f;
+    if (waveLaneCount >= wavesPerThreadGroup)
+    {
+        // The first wave has a lane for each wave's sums
+        bool usefulThread = ThreadIndexInGroup < wavesPerThreadGroup;
+        totalValue = WaveActiveSum(usefulThread ? ThreadGroupSum[ThreadIndexInGroup] : 0.f);
+        totalWeight = WaveActiveSum(usefulThread ? ThreadGroupWeightSum[ThreadIndexInGroup] : 0.f);
+    }
+    else
+    {
+        for (uint index = 0; index < wavesPerThreadGroup; index++)
+        {
+            totalValue += ThreadGroupSum[index];
+            totalWeight += ThreadGroupWeightSum[index];
+        }
+    }
+
+    if (ThreadIndexInGroup == 0)
+    {
+        // Write the volume's average variability and weight, as the extra reduction passes do
+        ProbeVariabilityAverage[uint3(0, 0, 0)].r = (totalWeight > 0.f) ? (totalValue / totalWeight) : 0.f;
+        ProbeVariabilityAverage[uint3(0, 0, 0)].g = totalWeight / numTotalGroups;
+
+        // Reset the thread group counter for the next reduction
+        ProbeSchedule.Store(RTXGI_DDGI_PROBE_SCHEDULE_REDUCTION_COUNT_OFFSET, 0);
+    }
+#endif // RTXGI_DDGI_REDUCTION_SINGLE_PASS
 }
 
 // -------- SHARED MEMORY DECLARATIONS ------------------------------------------------------------
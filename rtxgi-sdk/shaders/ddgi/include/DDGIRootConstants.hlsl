@@ -8,6 +8,9 @@
 * license agreement from NVIDIA CORPORATION is strictly prohibited.
 */
 
+#ifndef RTXGI_DDGI_ROOT_CONSTANTS_HLSL
+#define RTXGI_DDGI_ROOT_CONSTANTS_HLSL
+
 #include "../../../include/rtxgi/ddgi/DDGIRootConstants.h"
 
 #ifndef __spirv__ // D3D12
@@ -38,6 +41,7 @@
     uint GetDDGIVolumeConstantsIndex() { return DDGI.volumeConstantsIndex; }
     uint GetDDGIVolumeResourceIndicesIndex() { return DDGI.volumeResourceIndicesIndex; }
     uint3 GetReductionInputSize() { return uint3(DDGI.reductionInputSizeX, DDGI.reductionInputSizeY, DDGI.reductionInputSizeZ); }
+    uint GetDDGIProbeDerivationVolumeIndex() { return DDGI.probeDerivationVolumeIndex; }
 
 #else // VULKAN
 
@@ -112,4 +116,9 @@
     uint GetDDGIVolumeConstantsIndex() { return 0; }
     uint GetDDGIVolumeResourceIndicesIndex() { return 0; }
 
+    // Probe derivation reads another volume's resources bindlessly from the descriptor heap, so it is D3D12 only
+    uint GetDDGIProbeDerivationVolumeIndex() { return 0xFFFFFFFF; } // RTXGI_DDGI_PROBE_DERIVATION_NONE
+
 #endif
+
+#endif // RTXGI_DDGI_ROOT_CONSTANTS_HLSL
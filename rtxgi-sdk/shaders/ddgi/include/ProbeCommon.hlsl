@@ -16,6 +16,7 @@
 #include "ProbeRayCommon.hlsl"
 #include "ProbeIndexing.hlsl"
 #include "ProbeOctahedral.hlsl"
+#include "ProbeSphericalHarmonics.hlsl"
 
 //------------------------------------------------------------------------
 // Probe World Position
@@ -97,4 +98,40 @@ float3 DDGIGetProbeWorldPosition(int3 probeCoords, DDGIVolumeDescGPU volume, RWT
     return probeWorldPosition;
 }
 
+//------------------------------------------------------------------------
+// Probe Time Slicing
+//------------------------------------------------------------------------
+
+/**
+ * Whether probe relocation and classification process the probe this frame.
+ * Probes are sliced in groups of RTXGI_DDGI_PROBE_TIME_SLICE_GROUP_SIZE, one of every (1 << probeTimeSliceStrideLog2)
+ * groups is processed per frame and the processed group rotates with the volume's frame counter.
+ */
+bool DDGIIsProbeInTimeSlice(uint probeIndex, DDGIVolumeDescGPU volume)
+{
+    uint strideMask = (1u << volume.probeTimeSliceStrideLog2) - 1;
+    return (((probeIndex / RTXGI_DDGI_PROBE_TIME_SLICE_GROUP_SIZE) & strideMask) == (volume.probeSchedulingFrame & strideMask));
+}
+
+//------------------------------------------------------------------------
+// Probe Derivation
+//------------------------------------------------------------------------
+
+/**
+ * Whether a probe at the given world-space position is derived from the derivation volume (see DDGIProbeDerivationCS()).
+ * Probes more than one probe spacing inside the derivation volume's probe grid are derived, so the derivation volume's
+ * probes around them are never at its edges (e.g. scrolled in and cleared this frame).
+ */
+bool DDGIIsProbeDerived(float3 probeWorldPosition, DDGIVolumeDescGPU derivationVolume)
+{
+    // Get the vector from the derivation volume's origin to the probe
+    float3 position = probeWorldPosition - (derivationVolume.origin + (derivationVolume.probeScrollOffsets * derivationVolume.probeSpacing));
+
+    // Rotate the position into the derivation volume's space
+    if (!IsVolumeMovementScrolling(derivationVolume)) position = RTXGIQuaternionRotate(position, RTXGIQuaternionConjugate(derivationVolume.rotation));
+
+    float3 extent = (derivationVolume.probeSpacing * (derivationVolume.probeCounts - 1)) * 0.5f;
+    return all(abs(position) < (extent - derivationVolume.probeSpacing));
+}
+
 #endif // RTXGI_DDGI_PROBE_COMMON_HLSL
@@ -275,6 +275,55 @@ float DDGILoadProbeState(int probeIndex, Texture2DArray<float4> probeData, DDGIV
     return state;
 }
 
+/**
+ * Loads the probe's state bit from the probe schedule buffer (see RTXGI_DDGI_PROBE_SCHEDULE_STATE_BITS_OFFSET).
+ * Returns true when the probe is inactive. Only valid when the volume's probeStateBitsEnabled is set.
+ */
+bool DDGILoadProbeStateBit(int probeIndex, RWByteAddressBuffer probeSchedule, DDGIVolumeDescGPU volume)
+{
+    int numProbes = (volume.probeCounts.x * volume.probeCounts.y * volume.probeCounts.z);
+    uint bits = probeSchedule.Load(RTXGI_DDGI_PROBE_SCHEDULE_STATE_BITS_OFFSET(numProbes) + ((probeIndex >> 5) * 4));
+    return ((bits >> (probeIndex & 31)) & 1) != 0;
+}
+
+/**
+ * Stores the probe's state bit to the probe schedule buffer (see RTXGI_DDGI_PROBE_SCHEDULE_STATE_BITS_OFFSET).
+ * The bit is set when the probe is inactive, so a cleared buffer reads as all probes active.
+ */
+void DDGIStoreProbeStateBit(int probeIndex, bool inactive, RWByteAddressBuffer probeSchedule, DDGIVolumeDescGPU volume)
+{
+    int numProbes = (volume.probeCounts.x * volume.probeCounts.y * volume.probeCounts.z);
+    uint address = RTXGI_DDGI_PROBE_SCHEDULE_STATE_BITS_OFFSET(numProbes) + ((probeIndex >> 5) * 4);
+    uint bit = (1u << (probeIndex & 31));
+    if (inactive) probeSchedule.InterlockedOr(address, bit);
+    else probeSchedule.InterlockedAnd(address, ~bit);
+}
+
+/**
+ * Loads the visibility mask of the probe cage cell whose base probe has the given (storage) index from the probe
+ * schedule buffer (see RTXGI_DDGI_PROBE_SCHEDULE_VISIBILITY_MASKS_OFFSET). Bit n is set when the probe at adjacent
+ * offset (n & 1, (n >> 1) & 1, (n >> 2) & 1) sees the whole cell. Only valid when the volume's probeVisibilityMaskEnabled is set.
+ */
+uint DDGILoadProbeVisibilityMask(int cellIndex, RWByteAddressBuffer probeSchedule, DDGIVolumeDescGPU volume)
+{
+    int numProbes = (volume.probeCounts.x * volume.probeCounts.y * volume.probeCounts.z);
+    uint masks = probeSchedule.Load(RTXGI_DDGI_PROBE_SCHEDULE_VISIBILITY_MASKS_OFFSET(numProbes) + ((cellIndex >> 2) * 4));
+    return (masks >> ((cellIndex & 3) * 8)) & 0xFF;
+}
+
+/**
+ * Stores one bit of a probe cage cell's visibility mask to the probe schedule buffer (see DDGILoadProbeVisibilityMask()).
+ * Each bit has a single writer (the cell's probe at that offset), so a cleared buffer reads as no probe seeing any cell.
+ */
+void DDGIStoreProbeVisibilityBit(int cellIndex, int adjacentProbeIndex, bool visible, RWByteAddressBuffer probeSchedule, DDGIVolumeDescGPU volume)
+{
+    int numProbes = (volume.probeCounts.x * volume.probeCounts.y * volume.probeCounts.z);
+    uint address = RTXGI_DDGI_PROBE_SCHEDULE_VISIBILITY_MASKS_OFFSET(numProbes) + ((cellIndex >> 2) * 4);
+    uint bit = (1u << (((cellIndex & 3) * 8) + adjacentProbeIndex));
+    if (visible) probeSchedule.InterlockedOr(address, bit);
+    else probeSchedule.InterlockedAnd(address, ~bit);
+}
+
 //------------------------------------------------------------------------
 // Infinite Scrolling
 //------------------------------------------------------------------------
@@ -310,4 +359,32 @@ bool DDGIClearScrolledPlane(int3 probeCoords, int planeIndex, DDGIVolumeDescGPU
     return false;
 }
 
+/**
+ * Gets the index of the probe a scrolled probe is seeded from when probeScrollSeedEnabled is set.
+ * The seed probe is one plane inward along each axis the probe was scrolled on, i.e. the volume's edge probe before the scroll.
+ * Returns -1 when the probe has not been scrolled or no seed exists (a single probe along a scrolled axis).
+ */
+int DDGIGetScrolledProbeSeedIndex(int3 probeCoords, DDGIVolumeDescGPU volume)
+{
+    int3 seedCoords = probeCoords;
+    bool scrolled = false;
+
+    [unroll]
+    for (int planeIndex = 0; planeIndex < 3; planeIndex++)
+    {
+        if (DDGIClearScrolledPlane(probeCoords, planeIndex, volume))
+        {
+            int probeCount = volume.probeCounts[planeIndex];
+            if (probeCount < 2) return -1;
+
+            // Step against the scroll direction (wrapped, the probes are stored in a ring)
+            int step = volume.probeScrollDirections[planeIndex] ? (probeCount - 1) : 1;
+            seedCoords[planeIndex] = (probeCoords[planeIndex] + step) % probeCount;
+            scrolled = true;
+        }
+    }
+
+    return scrolled ? DDGIGetProbeIndex(seedCoords, volume) : -1;
+}
+
 #endif // RTXGI_DDGI_PROBE_INDEXING_HLSL
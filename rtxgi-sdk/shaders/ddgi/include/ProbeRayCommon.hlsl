@@ -13,6 +13,37 @@
 
 #include "Common.hlsl"
 
+//------------------------------------------------------------------------
+// Probe Ray Data U32 Texel Packing
+//------------------------------------------------------------------------
+
+// U32 ray data texels hold a ray's radiance and hit distance in the 32 bits of an R32 float channel:
+// bits 0-14: |hit distance| as a half (without its sign), bits 15-29: sqrt(radiance) as R5G5B5 unorm,
+// bit 30: clear (the texel is never a NaN bit pattern), bit 31: hit distance sign (backface hits).
+// Distances beyond the half range (misses) clamp to the largest half.
+
+float DDGIPackProbeRayU32(float3 radiance, float hitT)
+{
+    uint distance = f32tof16(min(abs(hitT), 65504.f)) & 0x7FFF;
+    uint3 color = (uint3)(sqrt(saturate(radiance)) * 31.f + 0.5f);
+    uint sign = (hitT < 0.f) ? 0x80000000 : 0;
+    return asfloat(distance | (color.r << 15) | (color.g << 20) | (color.b << 25) | sign);
+}
+
+float3 DDGIUnpackProbeRayU32Radiance(float texel)
+{
+    uint packed = asuint(texel);
+    float3 color = float3((packed >> 15) & 0x1F, (packed >> 20) & 0x1F, (packed >> 25) & 0x1F) / 31.f;
+    return (color * color);
+}
+
+float DDGIUnpackProbeRayU32Distance(float texel)
+{
+    uint packed = asuint(texel);
+    float distance = f16tof32(packed & 0x7FFF);
+    return (packed & 0x80000000) ? -distance : distance;
+}
+
 //------------------------------------------------------------------------
 // Probe Ray Data Texture Write Helpers
 //------------------------------------------------------------------------
@@ -27,6 +58,10 @@ void DDGIStoreProbeRayMiss(RWTexture2DArray<float4> RayData, uint3 coords, DDGIV
     {
         RayData[coords] = float4(asfloat(RTXGIFloat3ToUint(radiance)), 1e27f, 0.f, 0.f);
     }
+    else if (volume.probeRayDataFormat == RTXGI_DDGI_VOLUME_TEXTURE_FORMAT_U32)
+    {
+        RayData[coords] = float4(DDGIPackProbeRayU32(radiance, 1e27f), 0.f, 0.f, 0.f);
+    }
 }
 
 void DDGIStoreProbeRayFrontfaceHit(RWTexture2DArray<float4> RayData, uint3 coords, DDGIVolumeDescGPU volume, float3 radiance, float hitT)
@@ -44,6 +79,11 @@ void DDGIStoreProbeRayFrontfaceHit(RWTexture2DArray<float4> RayData, uint3 coord
         if (RTXGIMaxComponent(radiance.rgb) <= c_threshold) radiance.rgb = float3(0.f, 0.f, 0.f);
         RayData[coords] = float4(asfloat(RTXGIFloat3ToUint(radiance.rgb)), hitT, 0.f, 0.f);
     }
+    else if (volume.probeRayDataFormat == RTXGI_DDGI_VOLUME_TEXTURE_FORMAT_U32)
+    {
+        // Pack color as R5G5B5 and the hit distance as a half in R32 (see DDGIPackProbeRayU32)
+        RayData[coords] = float4(DDGIPackProbeRayU32(radiance, hitT), 0.f, 0.f, 0.f);
+    }
 }
 
 void DDGIStoreProbeRayFrontfaceHit(RWTexture2DArray<float4> RayData, uint3 coords, DDGIVolumeDescGPU volume, float hitT)
@@ -56,6 +96,11 @@ void DDGIStoreProbeRayFrontfaceHit(RWTexture2DArray<float4> RayData, uint3 coord
     {
         RayData[coords].g = hitT;
     }
+    else if (volume.probeRayDataFormat == RTXGI_DDGI_VOLUME_TEXTURE_FORMAT_U32)
+    {
+        // Keep the ray's previous radiance
+        RayData[coords].r = DDGIPackProbeRayU32(DDGIUnpackProbeRayU32Radiance(RayData[coords].r), hitT);
+    }
 }
 
 void DDGIStoreProbeRayBackfaceHit(RWTexture2DArray<float4> RayData, uint3 coords, DDGIVolumeDescGPU volume, float hitT)
@@ -70,6 +115,10 @@ void DDGIStoreProbeRayBackfaceHit(RWTexture2DArray<float4> RayData, uint3 coords
     {
         RayData[coords].g = -hitT * 0.2f;
     }
+    else if (volume.probeRayDataFormat == RTXGI_DDGI_VOLUME_TEXTURE_FORMAT_U32)
+    {
+        RayData[coords].r = DDGIPackProbeRayU32(DDGIUnpackProbeRayU32Radiance(RayData[coords].r), -hitT * 0.2f);
+    }
 }
 
 //------------------------------------------------------------------------
@@ -86,6 +135,10 @@ float3 DDGILoadProbeRayRadiance(RWTexture2DArray<float4> RayData, uint3 coords,
     {
         return RTXGIUintToFloat3(asuint(RayData[coords].r));
     }
+    else if (volume.probeRayDataFormat == RTXGI_DDGI_VOLUME_TEXTURE_FORMAT_U32)
+    {
+        return DDGIUnpackProbeRayU32Radiance(RayData[coords].r);
+    }
     return float3(0.f, 0.f, 0.f);
 }
 
@@ -99,6 +152,10 @@ float DDGILoadProbeRayDistance(RWTexture2DArray<float4> RayData, uint3 coords, D
     {
         return RayData[coords].g;
     }
+    else if (volume.probeRayDataFormat == RTXGI_DDGI_VOLUME_TEXTURE_FORMAT_U32)
+    {
+        return DDGIUnpackProbeRayU32Distance(RayData[coords].r);
+    }
     return 0.f;
 }
 
@@ -107,14 +164,13 @@ float DDGILoadProbeRayDistance(RWTexture2DArray<float4> RayData, uint3 coords, D
 //------------------------------------------------------------------------
 
 /**
- * Computes a spherically distributed, normalized ray direction for the given ray index in a set of ray samples.
+ * Computes a spherically distributed, normalized ray direction for the given ray index in a set of numRays ray samples.
  * Applies the volume's random probe ray rotation transformation to "non-fixed" ray direction samples.
  */
-float3 DDGIGetProbeRayDirection(int rayIndex, DDGIVolumeDescGPU volume)
+float3 DDGIGetProbeRayDirection(int rayIndex, int numRays, DDGIVolumeDescGPU volume)
 {
     bool isFixedRay = false;
     int sampleIndex = rayIndex;
-    int numRays = volume.probeNumRays;
 
     if (volume.probeRelocationEnabled || volume.probeClassificationEnabled)
     {
@@ -133,5 +189,25 @@ float3 DDGIGetProbeRayDirection(int rayIndex, DDGIVolumeDescGPU volume)
     return normalize(RTXGIQuaternionRotate(direction, RTXGIQuaternionConjugate(volume.probeRayRotation)));
 }
 
+/**
+ * Computes a spherically distributed, normalized ray direction for the given ray index in the volume's set of ray samples.
+ */
+float3 DDGIGetProbeRayDirection(int rayIndex, DDGIVolumeDescGPU volume)
+{
+    return DDGIGetProbeRayDirection(rayIndex, volume.probeNumRays, volume);
+}
+
+/**
+ * Gets the number of rays traced (and blended) for a probe this frame.
+ * With adaptive rays, probe scheduling picks the ray count of each scheduled probe (see DDGIGetProbeAdaptiveNumRays()).
+ */
+int DDGIGetProbeNumRays(int probeIndex, DDGIVolumeDescGPU volume, RWByteAddressBuffer ProbeSchedule)
+{
+    if (!volume.probeAdaptiveRaysEnabled) return volume.probeNumRays;
+
+    int numProbes = (volume.probeCounts.x * volume.probeCounts.y * volume.probeCounts.z);
+    return (int)ProbeSchedule.Load(RTXGI_DDGI_PROBE_SCHEDULE_LIST_OFFSET + ((numProbes + probeIndex) * 4));
+}
+
 
 #endif // RTXGI_DDGI_PROBE_RAY_COMMON_HLSL
@@ -0,0 +1,85 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#ifndef RTXGI_DDGI_PROBE_SPHERICAL_HARMONICS_HLSL
+#define RTXGI_DDGI_PROBE_SPHERICAL_HARMONICS_HLSL
+
+#include "Common.hlsl"
+
+//------------------------------------------------------------------------
+// Probe Spherical Harmonics
+//------------------------------------------------------------------------
+
+/**
+ * Gets the number of spherical harmonics coefficients used by the volume's probe irradiance encoding.
+ */
+uint DDGIGetProbeSHNumCoefficients(DDGIVolumeDescGPU volume)
+{
+    return (volume.probeIrradianceEncoding == RTXGI_DDGI_PROBE_IRRADIANCE_ENCODING_SH_L2) ? 9 : 4;
+}
+
+/**
+ * Gets the index of the probe's first spherical harmonics coefficient in the probe SH buffer.
+ */
+uint DDGIGetProbeSHIndex(int probeIndex)
+{
+    return uint(probeIndex) * RTXGI_DDGI_PROBE_SH_MAX_COEFFICIENTS;
+}
+
+/**
+ * Computes the real spherical harmonics basis functions (bands 0-2) for the given unit direction.
+ */
+void DDGIGetSHBasis(float3 direction, out float basis[RTXGI_DDGI_PROBE_SH_MAX_COEFFICIENTS])
+{
+    basis[0] = 0.282095f;
+    basis[1] = 0.488603f * direction.y;
+    basis[2] = 0.488603f * direction.z;
+    basis[3] = 0.488603f * direction.x;
+    basis[4] = 1.092548f * direction.x * direction.y;
+    basis[5] = 1.092548f * direction.y * direction.z;
+    basis[6] = 0.315392f * ((3.f * direction.z * direction.z) - 1.f);
+    basis[7] = 1.092548f * direction.x * direction.z;
+    basis[8] = 0.546274f * ((direction.x * direction.x) - (direction.y * direction.y));
+}
+
+/**
+ * Gets the factor applied to a projected radiance coefficient to convolve it with the clamped cosine lobe,
+ * divided by 2pi so the evaluated coefficients match the irradiance stored in octahedral texels.
+ * Band 0: pi / 2pi, Band 1: (2pi / 3) / 2pi, Band 2: (pi / 4) / 2pi.
+ */
+float DDGIGetSHConvolution(uint coefficientIndex)
+{
+    if (coefficientIndex == 0) return (1.f / 2.f);
+    if (coefficientIndex < 4) return (1.f / 3.f);
+    return (1.f / 8.f);
+}
+
+/**
+ * Evaluates the probe's spherical harmonics coefficients in the given direction.
+ * Returns irradiance / 2pi (linear), the same quantity stored in the octahedral irradiance texels.
+ * Used by DDGIGetVolumeIrradiance() in Irradiance.hlsl.
+ */
+float3 DDGIEvaluateProbeSH(int probeIndex, float3 direction, RWStructuredBuffer<float3> probeSH, DDGIVolumeDescGPU volume)
+{
+    float basis[RTXGI_DDGI_PROBE_SH_MAX_COEFFICIENTS];
+    DDGIGetSHBasis(direction, basis);
+
+    uint baseIndex = DDGIGetProbeSHIndex(probeIndex);
+    uint numCoefficients = DDGIGetProbeSHNumCoefficients(volume);
+
+    float3 result = float3(0.f, 0.f, 0.f);
+    for (uint coefficientIndex = 0; coefficientIndex < numCoefficients; coefficientIndex++)
+    {
+        result += probeSH[baseIndex + coefficientIndex] * basis[coefficientIndex];
+    }
+    return max(result, float3(0.f, 0.f, 0.f));
+}
+
+#endif // RTXGI_DDGI_PROBE_SPHERICAL_HARMONICS_HLSL
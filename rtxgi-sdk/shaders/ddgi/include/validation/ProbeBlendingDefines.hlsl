@@ -44,6 +44,12 @@
                 #define OUTPUT_SPACE 0
                 #define PROBE_DATA_REGISTER 4
                 #define PROBE_DATA_SPACE 0
+                #define PROBE_SCHEDULE_REGISTER 7
+                #define PROBE_SCHEDULE_SPACE 0
+                #define PROBE_SH_REGISTER 8
+                #define PROBE_SH_SPACE 0
+                #define PROBE_IRRADIANCE_MIPS_REGISTER 9
+                #define PROBE_IRRADIANCE_MIPS_SPACE 0
             #else
                 #define CONSTS_REGISTER b0
                 #define CONSTS_SPACE space1
@@ -61,6 +67,12 @@
                 #define OUTPUT_SPACE space1
                 #define PROBE_DATA_REGISTER u3
                 #define PROBE_DATA_SPACE space1
+                #define PROBE_SCHEDULE_REGISTER u6
+                #define PROBE_SCHEDULE_SPACE space1
+                #define PROBE_SH_REGISTER u7
+                #define PROBE_SH_SPACE space1
+                #define PROBE_IRRADIANCE_MIPS_REGISTER u8
+                #define PROBE_IRRADIANCE_MIPS_SPACE space1
             #endif
         #endif // RTXGI_DDGI_RESOURCE_MANAGEMENT
 
@@ -238,6 +250,129 @@
 
 // -------- OPTIONAL DEFINES -----------------------------------------------------------------
 
+// Define RTXGI_DDGI_PROBE_SCHEDULING before compiling SDK HLSL shaders to blend only the probes
+// listed in the volume's probe schedule (see ProbeSchedulingCS.hlsl) when probe scheduling is enabled,
+// or only the active probes listed by probe classification when probeBlendingActiveOnly is set.
+// 0: Disabled (default).
+// 1: Enabled.
+#ifndef RTXGI_DDGI_PROBE_SCHEDULING
+    #pragma message "Optional define RTXGI_DDGI_PROBE_SCHEDULING is not defined, defaulting to 0."
+    #define RTXGI_DDGI_PROBE_SCHEDULING 0
+#endif
+
+#if RTXGI_DDGI_PROBE_SCHEDULING && !RTXGI_DDGI_SHADER_REFLECTION
+    #if !RTXGI_DDGI_BINDLESS_RESOURCES || (RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS)
+        // PROBE_SCHEDULE_REGISTER and PROBE_SCHEDULE_SPACE must be passed in as defines at shader compilation time
+        // *when not using reflection* and not using the (D3D12) descriptor heap, when probe scheduling is enabled.
+        // These defines specify the shader register and space used for the DDGIVolume probe schedule buffer
+        // (or the RWByteAddressBuffer resource array it is retrieved from bindlessly).
+        // Ex: PROBE_SCHEDULE_REGISTER u6
+        // Ex: PROBE_SCHEDULE_SPACE space1
+        #ifndef PROBE_SCHEDULE_REGISTER
+            #error Required define PROBE_SCHEDULE_REGISTER is not defined for ProbeBlendingCS.hlsl!
+        #endif
+        #ifndef PROBE_SCHEDULE_SPACE
+            #error Required define PROBE_SCHEDULE_SPACE is not defined for ProbeBlendingCS.hlsl!
+        #endif
+    #endif
+#endif
+
+// Define RTXGI_DDGI_BLEND_SH before compiling the irradiance blending shader (RTXGI_DDGI_BLEND_RADIANCE 1)
+// to project probe ray radiance onto spherical harmonics when the volume's probeIrradianceEncoding is not octahedral.
+// The coefficients are stored in the volume's probe SH buffer. D3D12 only.
+// 0: Disabled (default).
+// 1: Enabled.
+#ifndef RTXGI_DDGI_BLEND_SH
+    #pragma message "Optional define RTXGI_DDGI_BLEND_SH is not defined, defaulting to 0."
+    #define RTXGI_DDGI_BLEND_SH 0
+#endif
+
+#if RTXGI_DDGI_BLEND_SH && RTXGI_DDGI_BLEND_RADIANCE && !RTXGI_DDGI_SHADER_REFLECTION
+    #if !RTXGI_DDGI_BINDLESS_RESOURCES || (RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS)
+        // PROBE_SH_REGISTER and PROBE_SH_SPACE must be passed in as defines at shader compilation time
+        // *when not using reflection* and not using the (D3D12) descriptor heap, when spherical harmonics blending is enabled.
+        // These defines specify the shader register and space used for the DDGIVolume probe SH buffer
+        // (or the RWStructuredBuffer resource array it is retrieved from bindlessly).
+        // Ex: PROBE_SH_REGISTER u7
+        // Ex: PROBE_SH_SPACE space1
+        #ifndef PROBE_SH_REGISTER
+            #error Required define PROBE_SH_REGISTER is not defined for ProbeBlendingCS.hlsl!
+        #endif
+        #ifndef PROBE_SH_SPACE
+            #error Required define PROBE_SH_SPACE is not defined for ProbeBlendingCS.hlsl!
+        #endif
+    #endif
+#endif
+
+// Define RTXGI_DDGI_BLEND_IRRADIANCE_MIPS before compiling the irradiance blending shader (RTXGI_DDGI_BLEND_RADIANCE 1)
+// to write each probe's pre-filtered irradiance mips (2x2 texels and the probe average) when the volume's probeIrradianceMipsEnabled is set.
+// The mips are stored in the volume's probe irradiance mips buffer. D3D12 only.
+// 0: Disabled (default).
+// 1: Enabled.
+#ifndef RTXGI_DDGI_BLEND_IRRADIANCE_MIPS
+    #pragma message "Optional define RTXGI_DDGI_BLEND_IRRADIANCE_MIPS is not defined, defaulting to 0."
+    #define RTXGI_DDGI_BLEND_IRRADIANCE_MIPS 0
+#endif
+
+#if RTXGI_DDGI_BLEND_IRRADIANCE_MIPS && RTXGI_DDGI_BLEND_RADIANCE && !RTXGI_DDGI_SHADER_REFLECTION
+    #if !RTXGI_DDGI_BINDLESS_RESOURCES || (RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS)
+        // PROBE_IRRADIANCE_MIPS_REGISTER and PROBE_IRRADIANCE_MIPS_SPACE must be passed in as defines at shader compilation time
+        // *when not using reflection* and not using the (D3D12) descriptor heap, when irradiance mips are enabled.
+        // These defines specify the shader register and space used for the DDGIVolume probe irradiance mips buffer
+        // (or the RWStructuredBuffer resource array it is retrieved from bindlessly).
+        // Ex: PROBE_IRRADIANCE_MIPS_REGISTER u8
+        // Ex: PROBE_IRRADIANCE_MIPS_SPACE space1
+        #ifndef PROBE_IRRADIANCE_MIPS_REGISTER
+            #error Required define PROBE_IRRADIANCE_MIPS_REGISTER is not defined for ProbeBlendingCS.hlsl!
+        #endif
+        #ifndef PROBE_IRRADIANCE_MIPS_SPACE
+            #error Required define PROBE_IRRADIANCE_MIPS_SPACE is not defined for ProbeBlendingCS.hlsl!
+        #endif
+    #endif
+#endif
+
+// Define RTXGI_DDGI_BLEND_BORDER_SHARED_MEMORY before compiling SDK HLSL shaders to keep each probe's
+// blended interior texels in shared memory and update the probe's border texels from shared memory,
+// instead of re-reading the interior texels from the irradiance or distance texture array after a device memory barrier.
+// 0: Disabled (default).
+// 1: Enabled.
+#ifndef RTXGI_DDGI_BLEND_BORDER_SHARED_MEMORY
+    #pragma message "Optional define RTXGI_DDGI_BLEND_BORDER_SHARED_MEMORY is not defined, defaulting to 0."
+    #define RTXGI_DDGI_BLEND_BORDER_SHARED_MEMORY 0
+#endif
+
+// Define RTXGI_DDGI_BLEND_SHARED_MEMORY_TILED before compiling SDK HLSL shaders to stream a probe's rays through shared memory
+// in tiles of RTXGI_DDGI_BLEND_RAYS_PER_TILE rays, instead of caching all of the probe's rays (RTXGI_DDGI_BLEND_SHARED_MEMORY).
+// Radiance is stored at half precision and ray directions are recomputed from the ray index, so the shared memory footprint
+// does not grow with the ray count. Does not require RTXGI_DDGI_BLEND_RAYS_PER_PROBE.
+// 0: Disabled (default).
+// 1: Enabled.
+#ifndef RTXGI_DDGI_BLEND_SHARED_MEMORY_TILED
+    #pragma message "Optional define RTXGI_DDGI_BLEND_SHARED_MEMORY_TILED is not defined, defaulting to 0."
+    #define RTXGI_DDGI_BLEND_SHARED_MEMORY_TILED 0
+#endif
+
+// Define RTXGI_DDGI_BLEND_RAY_LOADER before compiling the blending shaders when the application provides the probe rays
+// itself (for example, straight from its own hit and radiance caches) instead of the volume's ray data texture array.
+// The application must define DDGIBlendLoadProbeRay() (see ProbeBlendingCS.hlsl) before including ProbeBlendingCS.hlsl.
+// 0: Disabled (default), rays are loaded from the ray data texture array.
+// 1: Enabled.
+#ifndef RTXGI_DDGI_BLEND_RAY_LOADER
+    #define RTXGI_DDGI_BLEND_RAY_LOADER 0
+#endif
+
+#if RTXGI_DDGI_BLEND_SHARED_MEMORY_TILED
+    #if RTXGI_DDGI_BLEND_SHARED_MEMORY
+        #error RTXGI_DDGI_BLEND_SHARED_MEMORY and RTXGI_DDGI_BLEND_SHARED_MEMORY_TILED are mutually exclusive for ProbeBlendingCS.hlsl!
+    #endif
+
+    // Define RTXGI_DDGI_BLEND_RAYS_PER_TILE to set the number of rays in each shared memory tile.
+    // Default: 64.
+    #ifndef RTXGI_DDGI_BLEND_RAYS_PER_TILE
+        #define RTXGI_DDGI_BLEND_RAYS_PER_TILE 64
+    #endif
+#endif
+
 // Define RTXGI_DDGI_DEBUG_PROBE_INDEXING before compiling SDK HLSL shaders to toggle
 // a visualization mode that outputs probe indices as probe color. Useful when debugging.
 // 0: Disabled (default).
@@ -38,6 +38,8 @@
                 #define RAY_DATA_SPACE 0
                 #define PROBE_DATA_REGISTER 4
                 #define PROBE_DATA_SPACE 0
+                #define PROBE_SCHEDULE_REGISTER 7
+                #define PROBE_SCHEDULE_SPACE 0
             #else
                 #define CONSTS_REGISTER b0
                 #define CONSTS_SPACE space1
@@ -47,6 +49,8 @@
                 #define RAY_DATA_SPACE space1
                 #define PROBE_DATA_REGISTER u3
                 #define PROBE_DATA_SPACE space1
+                #define PROBE_SCHEDULE_REGISTER u6
+                #define PROBE_SCHEDULE_SPACE space1
             #endif
         #endif // RTXGI_DDGI_RESOURCE_MANAGEMENT
 
@@ -143,4 +147,43 @@
     #endif // !RTXGI_DDGI_SHADER_REFLECTION
 #endif // RTXGI_DDGI_BINDLESS_RESOURCES
 
+// -------- OPTIONAL DEFINES -----------------------------------------------------------------
+
+// Define RTXGI_DDGI_PROBE_SCHEDULING before compiling SDK HLSL shaders to append the active probes
+// to the volume's probe list (see ProbeSchedulingCS.hlsl) when probeBlendingActiveOnly is set,
+// and to write the probe state bits of the probe schedule buffer when probeStateBitsEnabled is set.
+// 0: Disabled (default).
+// 1: Enabled.
+#ifndef RTXGI_DDGI_PROBE_SCHEDULING
+    #pragma message "Optional define RTXGI_DDGI_PROBE_SCHEDULING is not defined, defaulting to 0."
+    #define RTXGI_DDGI_PROBE_SCHEDULING 0
+#endif
+
+// Define RTXGI_DDGI_FIXED_RAYS_WAVE_OPS before compiling SDK HLSL shaders to process each probe with one wave,
+// where each lane inspects one fixed ray and the results are reduced with wave intrinsics.
+// Requires a wave lane count of at least RTXGI_DDGI_NUM_FIXED_RAYS (32) and DDGIVolumeDesc::probeFixedRaysUseWaveOps.
+// 0: Disabled (default), one thread per probe.
+// 1: Enabled.
+#ifndef RTXGI_DDGI_FIXED_RAYS_WAVE_OPS
+    #pragma message "Optional define RTXGI_DDGI_FIXED_RAYS_WAVE_OPS is not defined, defaulting to 0."
+    #define RTXGI_DDGI_FIXED_RAYS_WAVE_OPS 0
+#endif
+
+#if RTXGI_DDGI_PROBE_SCHEDULING && !RTXGI_DDGI_SHADER_REFLECTION
+    #if !RTXGI_DDGI_BINDLESS_RESOURCES || (RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS)
+        // PROBE_SCHEDULE_REGISTER and PROBE_SCHEDULE_SPACE must be passed in as defines at shader compilation time
+        // *when not using reflection* and not using the (D3D12) descriptor heap, when probe scheduling is enabled.
+        // These defines specify the shader register and space used for the DDGIVolume probe schedule buffer
+        // (or the RWByteAddressBuffer resource array it is retrieved from bindlessly).
+        // Ex: PROBE_SCHEDULE_REGISTER u6
+        // Ex: PROBE_SCHEDULE_SPACE space1
+        #ifndef PROBE_SCHEDULE_REGISTER
+            #error Required define PROBE_SCHEDULE_REGISTER is not defined for ProbeClassificationCS.hlsl!
+        #endif
+        #ifndef PROBE_SCHEDULE_SPACE
+            #error Required define PROBE_SCHEDULE_SPACE is not defined for ProbeClassificationCS.hlsl!
+        #endif
+    #endif
+#endif
+
 // -------------------------------------------------------------------------------------------
@@ -0,0 +1,118 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+// -------- MANAGED RESOURCES DEFINES -------------------------------------------------------------
+
+// RTXGI_DDGI_RESOURCE_MANAGEMENT must be passed in as a define at shader compilation time.
+// This define specifies if the shader resources are managed by the SDK (and not the application).
+// Ex: RTXGI_DDGI_RESOURCE_MANAGEMENT [0|1]
+#ifndef RTXGI_DDGI_RESOURCE_MANAGEMENT
+    #error Required define RTXGI_DDGI_RESOURCE_MANAGEMENT is not defined for ProbeDerivationCS.hlsl!
+#endif
+
+// -------- SHADER REFLECTION DEFINES -------------------------------------------------------------
+
+// RTXGI_DDGI_SHADER_REFLECTION must be passed in as a define at shader compilation time.
+// This define specifies if the shader resources will be determined using shader reflection.
+// Ex: RTXGI_DDGI_SHADER_REFLECTION [0|1]
+#ifndef RTXGI_DDGI_SHADER_REFLECTION
+    #error Required define RTXGI_DDGI_SHADER_REFLECTION is not defined for ProbeDerivationCS.hlsl!
+#endif
+
+// -------- RESOURCE BINDING DEFINES --------------------------------------------------------------
+
+// RTXGI_DDGI_BINDLESS_RESOURCES must be passed in as a define at shader compilation time.
+// This define specifies whether resources will be accessed bindlessly or not.
+// Probe derivation reads the textures of two volumes, so it requires bindless resources.
+// Ex: RTXGI_DDGI_BINDLESS_RESOURCES 1
+#ifndef RTXGI_DDGI_BINDLESS_RESOURCES
+    #error Required define RTXGI_DDGI_BINDLESS_RESOURCES is not defined for ProbeDerivationCS.hlsl!
+#elif !RTXGI_DDGI_BINDLESS_RESOURCES
+    #error ProbeDerivationCS.hlsl requires RTXGI_DDGI_BINDLESS_RESOURCES to be 1!
+#else
+    // RTXGI_BINDLESS_TYPE must be passed in as a define at shader compilation time.
+    // This define specifies whether bindless resources will be accessed through bindless resource arrays or the (D3D12) descriptor heap.
+    // Ex: RTXGI_BINDLESS_TYPE [RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS(0)|RTXGI_BINDLESS_TYPE_DESCRIPTOR_HEAP(1)]
+    #ifndef RTXGI_BINDLESS_TYPE
+        #error Required define RTXGI_BINDLESS_TYPE is not defined for ProbeDerivationCS.hlsl!
+    #endif
+
+    #if !RTXGI_DDGI_SHADER_REFLECTION
+        // CONSTS_REGISTER and CONSTS_SPACE must be passed in as defines at shader compilation time *when not using reflection*.
+        // These defines specify the shader register and space used for the DDGI root constants.
+        // Ex: CONSTS_REGISTER b0
+        // Ex: CONSTS_SPACE space1
+        #ifndef CONSTS_REGISTER
+            #error Required define CONSTS_REGISTER is not defined for ProbeDerivationCS.hlsl!
+        #endif
+        #ifndef CONSTS_SPACE
+            #error Required define CONSTS_SPACE is not defined for ProbeDerivationCS.hlsl!
+        #endif
+
+        #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
+            // Bindless resources are accessed using SM6.5 and below style resource arrays
+
+            // VOLUME_CONSTS_REGISTER and VOLUME_CONSTS_SPACE must be passed in as defines at shader compilation time
+            // *not* using reflection and using bindless resource arrays.
+            // These defines specify the shader register and space used for the DDGIVolumeDescGPUPacked structured buffer.
+            // Ex: VOLUME_CONSTS_REGISTER t5
+            // Ex: VOLUME_CONSTS_SPACE space0
+            #ifndef VOLUME_CONSTS_REGISTER
+                #error Required define VOLUME_CONSTS_REGISTER is not defined for ProbeDerivationCS.hlsl!
+            #endif
+            #ifndef VOLUME_CONSTS_SPACE
+                #error Required define VOLUME_CONSTS_SPACE is not defined for ProbeDerivationCS.hlsl!
+            #endif
+
+            // VOLUME_RESOURCES_REGISTER and VOLUME_RESOURCES_SPACE must be passed in as defines at shader compilation time
+            // *not* using reflection and using bindless resource arrays.
+            // These defines specify the shader register and space used for the DDGIVolumeResourceIndices structured buffer.
+            // Ex: VOLUME_RESOURCES_REGISTER t6
+            // Ex: VOLUME_RESOURCES_SPACE space0
+            #ifndef VOLUME_RESOURCES_REGISTER
+                #error Required define VOLUME_RESOURCES_REGISTER is not defined for ProbeDerivationCS.hlsl!
+            #endif
+            #ifndef VOLUME_RESOURCES_SPACE
+                #error Required define VOLUME_RESOURCES_SPACE is not defined for ProbeDerivationCS.hlsl!
+            #endif
+
+            // RWTEX2DARRAY_REGISTER and RWTEX2DARRAY_SPACE must be passed in as defines at shader compilation time
+            // *not* using reflection and using bindless resource arrays.
+            // These defines specify the shader register and space of the RWTexture2DArray resource array that the
+            // volumes' probe irradiance and probe data texture arrays are retrieved from bindlessly.
+            // Ex: RWTEX2DARRAY_REGISTER u6
+            // Ex: RWTEX2DARRAY_SPACE space1
+            #ifndef RWTEX2DARRAY_REGISTER
+                #error Required bindless mode define RWTEX2DARRAY_REGISTER is not defined for ProbeDerivationCS.hlsl!
+            #endif
+            #ifndef RWTEX2DARRAY_SPACE
+                #error Required bindless mode define RWTEX2DARRAY_SPACE is not defined for ProbeDerivationCS.hlsl!
+            #endif
+        #endif // RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
+    #endif // !RTXGI_DDGI_SHADER_REFLECTION
+#endif // RTXGI_DDGI_BINDLESS_RESOURCES
+
+// -------- CONFIGURATION DEFINES -----------------------------------------------------------------
+
+// RTXGI_DDGI_PROBE_NUM_TEXELS must be passed in as a define at shader compilation time.
+// This define specifies the number of texels in a single dimension of a probe's irradiance *including* the 1-texel probe border.
+// Ex: RTXGI_DDGI_PROBE_NUM_TEXELS 8 => irradiance data is 6x6 texels, with a 1-texel border (for a single probe)
+#ifndef RTXGI_DDGI_PROBE_NUM_TEXELS
+    #error Required define RTXGI_DDGI_PROBE_NUM_TEXELS is not defined for ProbeDerivationCS.hlsl!
+#endif
+
+// RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS must be passed in as a define at shader compilation time.
+// This define specifies the number of texels in a single dimension of a probe's irradiance *excluding* the 1-texel probe border.
+// Ex: RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS 6 => irradiance data is 6x6 texels (for a single probe)
+#ifndef RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS
+    #error Required define RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS is not defined for ProbeDerivationCS.hlsl!
+#endif
+
+// -------------------------------------------------------------------------------------------
@@ -143,4 +143,16 @@
     #endif // !RTXGI_DDGI_SHADER_REFLECTION
 #endif // RTXGI_DDGI_BINDLESS_RESOURCES
 
+// -------- OPTIONAL DEFINES -----------------------------------------------------------------
+
+// Define RTXGI_DDGI_FIXED_RAYS_WAVE_OPS before compiling SDK HLSL shaders to process each probe with one wave,
+// where each lane inspects one fixed ray and the results are reduced with wave intrinsics.
+// Requires a wave lane count of at least RTXGI_DDGI_NUM_FIXED_RAYS (32) and DDGIVolumeDesc::probeFixedRaysUseWaveOps.
+// 0: Disabled (default), one thread per probe.
+// 1: Enabled.
+#ifndef RTXGI_DDGI_FIXED_RAYS_WAVE_OPS
+    #pragma message "Optional define RTXGI_DDGI_FIXED_RAYS_WAVE_OPS is not defined, defaulting to 0."
+    #define RTXGI_DDGI_FIXED_RAYS_WAVE_OPS 0
+#endif
+
 // ------------------------------------------------------------------------------------------------
@@ -167,4 +167,31 @@
 #error Required define RTXGI_DDGI_WAVE_LANE_COUNT is not defined for ReductionCS.hlsl!
 #endif
 
+// -------- OPTIONAL DEFINES -----------------------------------------------------------------
+
+// Define RTXGI_DDGI_REDUCTION_SINGLE_PASS before compiling SDK HLSL shaders to average the probe variability
+// in a single DDGIReductionCS dispatch. The last thread group to finish (counted in the probe schedule buffer)
+// averages the results of all thread groups, so no DDGIExtraReductionCS passes are needed (D3D12 only).
+// 0: Disabled (default).
+// 1: Enabled.
+#ifndef RTXGI_DDGI_REDUCTION_SINGLE_PASS
+    #pragma message "Optional define RTXGI_DDGI_REDUCTION_SINGLE_PASS is not defined, defaulting to 0."
+    #define RTXGI_DDGI_REDUCTION_SINGLE_PASS 0
+#endif
+
+#if RTXGI_DDGI_REDUCTION_SINGLE_PASS && !RTXGI_DDGI_SHADER_REFLECTION
+    #if !RTXGI_DDGI_BINDLESS_RESOURCES || (RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS)
+        // PROBE_SCHEDULE_REGISTER and PROBE_SCHEDULE_SPACE must be passed in as defines at shader compilation time
+        // *when not using reflection* and not using the (D3D12) descriptor heap, when the single pass reduction is enabled.
+        // Ex: PROBE_SCHEDULE_REGISTER u6
+        // Ex: PROBE_SCHEDULE_SPACE space1
+        #ifndef PROBE_SCHEDULE_REGISTER
+            #error Required define PROBE_SCHEDULE_REGISTER is not defined for ReductionCS.hlsl!
+        #endif
+        #ifndef PROBE_SCHEDULE_SPACE
+            #error Required define PROBE_SCHEDULE_SPACE is not defined for ReductionCS.hlsl!
+        #endif
+    #endif
+#endif
+
 // -------------------------------------------------------------------------------------------
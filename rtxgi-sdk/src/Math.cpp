@@ -13,6 +13,14 @@
 
 #include <math.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RTXGI_MATH_SSE2 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define RTXGI_MATH_NEON 1
+#include <arm_neon.h>
+#endif
+
 namespace rtxgi
 {
 
@@ -187,6 +195,110 @@ namespace rtxgi
         return rotation;
     }
 
+    void GetGridRowPositions(float3* positions, int count, const float3& origin, const float3& spacing, const int3& startCoords, int axis, const float3& shift)
+    {
+        static_assert(sizeof(float3) == 3 * sizeof(float), "float3 must be tightly packed");
+
+        // Components that don't change along the row
+        float3 rowStart = (origin + (spacing * startCoords)) - shift;
+
+        int index = 0;
+    #if RTXGI_MATH_SSE2 || RTXGI_MATH_NEON
+        // Four positions (12 floats) per iteration. Lane l of output vector v holds component (4v + l) % 3 of
+        // position (4v + l) / 3, so the stepped component sits in the lanes where that component equals axis.
+        alignas(16) float rowStartLanes[3][4];
+        alignas(16) uint32_t axisLanes[3][4];
+        for (int v = 0; v < 3; v++)
+        {
+            for (int l = 0; l < 4; l++)
+            {
+                int component = ((4 * v) + l) % 3;
+                rowStartLanes[v][l] = rowStart[component];
+                axisLanes[v][l] = (component == axis) ? 0xFFFFFFFF : 0;
+            }
+        }
+
+        float* output = reinterpret_cast<float*>(positions);
+    #if RTXGI_MATH_SSE2
+        __m128 o = _mm_set1_ps(origin[axis]);
+        __m128 s = _mm_set1_ps(spacing[axis]);
+        __m128 h = _mm_set1_ps(shift[axis]);
+        __m128i steps = _mm_setr_epi32(0, 1, 2, 3);
+
+        __m128 templates[3], masks[3];
+        for (int v = 0; v < 3; v++)
+        {
+            templates[v] = _mm_load_ps(rowStartLanes[v]);
+            masks[v] = _mm_castsi128_ps(_mm_load_si128(reinterpret_cast<const __m128i*>(axisLanes[v])));
+        }
+
+        for (; index + 4 <= count; index += 4)
+        {
+            __m128 coords = _mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32(startCoords[axis] + index), steps));
+            __m128 values = _mm_sub_ps(_mm_add_ps(o, _mm_mul_ps(s, coords)), h);
+
+            // Spread the four stepped values to their lanes: positions (0,0,0,1), (1,1,2,2), (2,3,3,3)
+            __m128 lanes[3] = {
+                _mm_shuffle_ps(values, values, _MM_SHUFFLE(1, 0, 0, 0)),
+                _mm_shuffle_ps(values, values, _MM_SHUFFLE(2, 2, 1, 1)),
+                _mm_shuffle_ps(values, values, _MM_SHUFFLE(3, 3, 3, 2))
+            };
+
+            for (int v = 0; v < 3; v++)
+            {
+                __m128 result = _mm_or_ps(_mm_andnot_ps(masks[v], templates[v]), _mm_and_ps(masks[v], lanes[v]));
+                _mm_storeu_ps(output + (index * 3) + (v * 4), result);
+            }
+        }
+    #else
+        float32x4_t o = vdupq_n_f32(origin[axis]);
+        float32x4_t s = vdupq_n_f32(spacing[axis]);
+        float32x4_t h = vdupq_n_f32(shift[axis]);
+        const int32_t stepValues[4] = { 0, 1, 2, 3 };
+        int32x4_t steps = vld1q_s32(stepValues);
+
+        // Byte indices that spread the four stepped values to their lanes: positions (0,0,0,1), (1,1,2,2), (2,3,3,3)
+        static const uint8_t spreadIndices[3][16] = {
+            { 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 6, 7 },
+            { 4, 5, 6, 7, 4, 5, 6, 7, 8, 9, 10, 11, 8, 9, 10, 11 },
+            { 8, 9, 10, 11, 12, 13, 14, 15, 12, 13, 14, 15, 12, 13, 14, 15 }
+        };
+
+        float32x4_t templates[3];
+        uint32x4_t masks[3];
+        uint8x16_t spreads[3];
+        for (int v = 0; v < 3; v++)
+        {
+            templates[v] = vld1q_f32(rowStartLanes[v]);
+            masks[v] = vld1q_u32(axisLanes[v]);
+            spreads[v] = vld1q_u8(spreadIndices[v]);
+        }
+
+        for (; index + 4 <= count; index += 4)
+        {
+            float32x4_t coords = vcvtq_f32_s32(vaddq_s32(vdupq_n_s32(startCoords[axis] + index), steps));
+            float32x4_t values = vsubq_f32(vaddq_f32(o, vmulq_f32(s, coords)), h);
+            uint8x16_t valueBytes = vreinterpretq_u8_f32(values);
+
+            for (int v = 0; v < 3; v++)
+            {
+                float32x4_t lanes = vreinterpretq_f32_u8(vqtbl1q_u8(valueBytes, spreads[v]));
+                vst1q_f32(output + (index * 3) + (v * 4), vbslq_f32(masks[v], lanes, templates[v]));
+            }
+        }
+    #endif
+    #endif
+
+        // Remaining positions
+        for (; index < count; index++)
+        {
+            int3 coords = startCoords;
+            coords[axis] += index;
+            positions[index] = rowStart;
+            positions[index][axis] = (origin[axis] + (spacing[axis] * (float)coords[axis])) - shift[axis];
+        }
+    }
+
     //------------------------------------------------------------------------
     // Addition
     //------------------------------------------------------------------------
@@ -0,0 +1,129 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#include "rtxgi/ddgi/DDGIClipmap.h"
+
+#include <cmath>
+
+namespace rtxgi
+{
+    //------------------------------------------------------------------------
+    // Private Helper Functions
+    //------------------------------------------------------------------------
+
+    static bool IsClipmapLevelSpacing(float levelSpacing, float baseSpacing, uint32_t level)
+    {
+        float expected = baseSpacing * static_cast<float>(1u << level);
+        return (std::fabs(levelSpacing - expected) <= (expected * 1e-3f));
+    }
+
+    //------------------------------------------------------------------------
+    // Public RTXGI Namespace DDGI Clipmap Functions
+    //------------------------------------------------------------------------
+
+    void GetDDGIClipmapLevelDesc(const DDGIVolumeDesc& baseDesc, uint32_t level, DDGIVolumeDesc& levelDesc)
+    {
+        float scale = static_cast<float>(1u << level);
+
+        levelDesc = baseDesc;
+        levelDesc.index = baseDesc.index + level;
+        levelDesc.movementType = EDDGIVolumeMovementType::Scrolling;
+        levelDesc.probeSpacing = { baseDesc.probeSpacing.x * scale, baseDesc.probeSpacing.y * scale, baseDesc.probeSpacing.z * scale };
+        levelDesc.probeMaxRayDistance = baseDesc.probeMaxRayDistance * scale;
+
+        // probeSchedulingFullRateDistance is measured in the level's probe spacings, which already scale with the level
+    }
+
+    //------------------------------------------------------------------------
+    // Public DDGIClipmap Functions
+    //------------------------------------------------------------------------
+
+    ERTXGIStatus DDGIClipmap::Create(const DDGIClipmapDesc& desc, DDGIVolumeBase** levels)
+    {
+        if (desc.numLevels == 0 || desc.numLevels > RTXGI_DDGI_CLIPMAP_MAX_LEVELS) return ERTXGIStatus::ERROR_DDGI_INVALID_CLIPMAP_DESC;
+        if (levels == nullptr || levels[0] == nullptr) return ERTXGIStatus::ERROR_DDGI_INVALID_CLIPMAP_LEVEL;
+
+        // Validate the levels are nested scrolling volumes with consecutive indices
+        const DDGIVolumeBase* base = levels[0];
+        for (uint32_t level = 0; level < desc.numLevels; level++)
+        {
+            const DDGIVolumeBase* volume = levels[level];
+            if (volume == nullptr) return ERTXGIStatus::ERROR_DDGI_INVALID_CLIPMAP_LEVEL;
+            if (volume->GetMovementType() != EDDGIVolumeMovementType::Scrolling) return ERTXGIStatus::ERROR_DDGI_INVALID_CLIPMAP_LEVEL;
+            if (volume->GetIndex() != (base->GetIndex() + level)) return ERTXGIStatus::ERROR_DDGI_INVALID_CLIPMAP_LEVEL;
+
+            int3 counts = volume->GetProbeCounts();
+            int3 baseCounts = base->GetProbeCounts();
+            if (counts.x != baseCounts.x || counts.y != baseCounts.y || counts.z != baseCounts.z) return ERTXGIStatus::ERROR_DDGI_INVALID_CLIPMAP_LEVEL;
+
+            float3 spacing = volume->GetProbeSpacing();
+            float3 baseSpacing = base->GetProbeSpacing();
+            if (!IsClipmapLevelSpacing(spacing.x, baseSpacing.x, level)
+                || !IsClipmapLevelSpacing(spacing.y, baseSpacing.y, level)
+                || !IsClipmapLevelSpacing(spacing.z, baseSpacing.z, level)) return ERTXGIStatus::ERROR_DDGI_INVALID_CLIPMAP_LEVEL;
+        }
+
+        Destroy();
+
+        m_desc = desc;
+        for (uint32_t level = 0; level < desc.numLevels; level++) m_levels[level] = levels[level];
+
+        // Start every level at the current anchor
+        SetAnchor(m_anchor);
+
+        return ERTXGIStatus::OK;
+    }
+
+    void DDGIClipmap::Destroy()
+    {
+        for (uint32_t level = 0; level < RTXGI_DDGI_CLIPMAP_MAX_LEVELS; level++) m_levels[level] = nullptr;
+        m_desc = {};
+        m_clipmapFrame = 0;
+    }
+
+    void DDGIClipmap::Update()
+    {
+        m_clipmapFrame++;
+    }
+
+    void DDGIClipmap::SetAnchor(const float3& value)
+    {
+        m_anchor = value;
+        for (uint32_t level = 0; level < m_desc.numLevels; level++) m_levels[level]->SetScrollAnchor(value);
+    }
+
+    bool DDGIClipmap::GetLevelUpdateNeeded(uint32_t level) const
+    {
+        if (level >= m_desc.numLevels) return false;
+        if (level == 0 || !m_desc.staggeredUpdatesEnabled) return true;
+
+        // Every level updates on the first frame, so each level's constants and probes are valid before the lookup uses them
+        if (m_clipmapFrame == 0) return true;
+
+        // Level L updates on the frames whose count has exactly (L - 1) trailing one bits, i.e. once every 2^L frames,
+        // and the frames of different levels never coincide. The coarsest level also takes the frames of the levels past it.
+        uint32_t trailingOnes = 0;
+        for (uint32_t frame = m_clipmapFrame; (frame & 1) && trailingOnes < 32; frame >>= 1) trailingOnes++;
+
+        if (level == (m_desc.numLevels - 1)) return (trailingOnes >= (level - 1));
+        return (trailingOnes == (level - 1));
+    }
+
+    uint32_t DDGIClipmap::GetLevelsToUpdate(DDGIVolumeBase** levels) const
+    {
+        uint32_t numLevels = 0;
+        for (uint32_t level = 0; level < m_desc.numLevels; level++)
+        {
+            if (GetLevelUpdateNeeded(level)) levels[numLevels++] = m_levels[level];
+        }
+        return numLevels;
+    }
+
+} // namespace rtxgi
@@ -13,7 +13,8 @@
 #include <algorithm>
 #include <assert.h>
 #include <cmath>
-#include <random>
+#include <cstring>
+#include <vector>
 
 namespace rtxgi
 {
@@ -96,6 +97,150 @@ namespace rtxgi
         }
     }
 
+    uint64_t GetDDGIVolumeGPUMemoryUsedInBytes(const DDGIVolumeDesc& desc)
+    {
+        uint64_t bytesPerVolume = 0;
+
+        uint32_t numRayDataBytesPerTexel = 0;
+        uint32_t numIrradianceBytesPerTexel = 0;
+        uint32_t numDistanceBytesPerTexel = 0;
+        uint32_t numProbeDataBytesPerTexel = 0;
+        uint32_t numProbeVariabilityBytesPerTexel = 0;
+        uint32_t numProbeVariabilityAverageBytesPerTexel = 0;
+
+        // Compute the number of irradiance and distance texels
+        uint32_t numIrradianceTexelsPerProbe = (desc.probeNumIrradianceTexels * desc.probeNumIrradianceTexels);
+        uint32_t numDistanceTexelsPerProbe = (desc.probeNumDistanceTexels * desc.probeNumDistanceTexels);
+
+        // Get the number of bytes per ray data texel
+        if (desc.probeRayDataFormat == EDDGIVolumeTextureFormat::F32x2) numRayDataBytesPerTexel = 8;
+        else if (desc.probeRayDataFormat == EDDGIVolumeTextureFormat::F32x4) numRayDataBytesPerTexel = 16;
+        else if (desc.probeRayDataFormat == EDDGIVolumeTextureFormat::U32) numRayDataBytesPerTexel = 4;
+
+        // Get the number of bytes per irradiance texel
+        if (desc.probeIrradianceFormat == EDDGIVolumeTextureFormat::U32) numIrradianceBytesPerTexel = 4;
+        else if (desc.probeIrradianceFormat == EDDGIVolumeTextureFormat::F16x4) numIrradianceBytesPerTexel = 8;
+        else if (desc.probeIrradianceFormat == EDDGIVolumeTextureFormat::F32x4) numIrradianceBytesPerTexel = 16;
+
+        // Get the number of bytes per distance texel
+        if (desc.probeDistanceFormat == EDDGIVolumeTextureFormat::F16x2) numDistanceBytesPerTexel = 4;
+        else if (desc.probeDistanceFormat == EDDGIVolumeTextureFormat::F32x2) numDistanceBytesPerTexel = 8;
+
+        // Get the number of bytes per probe data texel
+        if (desc.probeDataFormat == EDDGIVolumeTextureFormat::F16x4) numProbeDataBytesPerTexel = 8;
+        else if (desc.probeDataFormat == EDDGIVolumeTextureFormat::F32x4) numProbeDataBytesPerTexel = 16;
+
+        // Get the number of bytes per probe variability texel
+        if (desc.probeVariabilityFormat == EDDGIVolumeTextureFormat::F16) numProbeVariabilityBytesPerTexel = 2;
+        else if (desc.probeVariabilityFormat == EDDGIVolumeTextureFormat::F32) numProbeVariabilityBytesPerTexel = 4;
+
+        // Variability average is always F32x2 (8 bytes)
+        numProbeVariabilityAverageBytesPerTexel = 8;
+
+        // Compute the number of bytes per probe
+        uint64_t bytesPerProbe = 0;
+        bytesPerProbe += desc.probeNumRays * numRayDataBytesPerTexel;
+        bytesPerProbe += (numIrradianceTexelsPerProbe * numIrradianceBytesPerTexel);
+        bytesPerProbe += (numDistanceTexelsPerProbe * numDistanceBytesPerTexel);
+        bytesPerProbe += numProbeDataBytesPerTexel;
+        bytesPerProbe += numProbeVariabilityBytesPerTexel;
+
+        // Published copies of the irradiance, distance, and probe data textures
+        if (desc.probeAtlasDoubleBuffered)
+        {
+            bytesPerProbe += (numIrradianceTexelsPerProbe * numIrradianceBytesPerTexel);
+            bytesPerProbe += (numDistanceTexelsPerProbe * numDistanceBytesPerTexel);
+            bytesPerProbe += numProbeDataBytesPerTexel;
+        }
+
+        // Coefficient of variation average texture is different (smaller) dimensions from other textures
+        uint32_t width, height, arraySize;
+        GetDDGIVolumeTextureDimensions(desc, EDDGIVolumeTextureType::VariabilityAverage, width, height, arraySize);
+        bytesPerVolume += static_cast<uint64_t>(width) * height * arraySize * numProbeVariabilityAverageBytesPerTexel;
+
+        // Add the per probe memory use
+        uint64_t numProbes = static_cast<uint64_t>(desc.probeCounts.x) * desc.probeCounts.y * desc.probeCounts.z;
+        bytesPerVolume += numProbes * bytesPerProbe;
+
+        // Add the memory used for the GPU-side DDGIVolumeDescGPUPacked (176B)
+        bytesPerVolume += sizeof(DDGIVolumeDescGPUPacked);
+
+        return bytesPerVolume;
+    }
+
+    /**
+     * Apply the next memory saving step to a volume. Returns false when the volume can't be degraded further.
+     */
+    static bool DegradeDDGIVolumeDesc(DDGIVolumeDesc& desc)
+    {
+        // Texel formats, the smaller format of each texture first
+        if (desc.probeRayDataFormat == EDDGIVolumeTextureFormat::F32x4) { desc.probeRayDataFormat = EDDGIVolumeTextureFormat::F32x2; return true; }
+        if (desc.probeIrradianceFormat == EDDGIVolumeTextureFormat::F32x4) { desc.probeIrradianceFormat = EDDGIVolumeTextureFormat::F16x4; return true; }
+        if (desc.probeDistanceFormat == EDDGIVolumeTextureFormat::F32x2) { desc.probeDistanceFormat = EDDGIVolumeTextureFormat::F16x2; return true; }
+        if (desc.probeDataFormat == EDDGIVolumeTextureFormat::F32x4) { desc.probeDataFormat = EDDGIVolumeTextureFormat::F16x4; return true; }
+        if (desc.probeVariabilityFormat == EDDGIVolumeTextureFormat::F32) { desc.probeVariabilityFormat = EDDGIVolumeTextureFormat::F16; return true; }
+        if (desc.probeRayDataFormat == EDDGIVolumeTextureFormat::F32x2) { desc.probeRayDataFormat = EDDGIVolumeTextureFormat::U32; return true; }
+        if (desc.probeIrradianceFormat == EDDGIVolumeTextureFormat::F16x4 && desc.probeIrradianceEncodingGamma > 1.f) { desc.probeIrradianceFormat = EDDGIVolumeTextureFormat::U32; return true; }
+
+        // Rays per probe (more than the fixed rays of relocation and classification)
+        if (desc.probeNumRays >= 128) { desc.probeNumRays /= 2; return true; }
+
+        // Interior texels of the probe octahedral maps
+        if (desc.probeNumIrradianceInteriorTexels > 4)
+        {
+            desc.probeNumIrradianceInteriorTexels -= 2;
+            desc.probeNumIrradianceTexels = desc.probeNumIrradianceInteriorTexels + 2;
+            return true;
+        }
+        if (desc.probeNumDistanceInteriorTexels > 6)
+        {
+            desc.probeNumDistanceInteriorTexels = std::max(desc.probeNumDistanceInteriorTexels - 4, 6);
+            desc.probeNumDistanceTexels = desc.probeNumDistanceInteriorTexels + 2;
+            return true;
+        }
+        return false;
+    }
+
+    bool FitDDGIVolumesToMemoryBudget(DDGIVolumeDesc* descs, const int* priorities, uint32_t numVolumes, uint64_t budgetInBytes, uint64_t* usedInBytes)
+    {
+        std::vector<uint64_t> volumeBytes(numVolumes);
+        std::vector<bool> degradable(numVolumes, true);
+
+        uint64_t totalBytes = 0;
+        for (uint32_t volumeIndex = 0; volumeIndex < numVolumes; volumeIndex++)
+        {
+            volumeBytes[volumeIndex] = GetDDGIVolumeGPUMemoryUsedInBytes(descs[volumeIndex]);
+            totalBytes += volumeBytes[volumeIndex];
+        }
+
+        while (totalBytes > budgetInBytes)
+        {
+            // Pick the lowest priority volume (the largest, on ties) that can still be degraded
+            uint32_t selected = numVolumes;
+            for (uint32_t volumeIndex = 0; volumeIndex < numVolumes; volumeIndex++)
+            {
+                if (!degradable[volumeIndex]) continue;
+                if (selected == numVolumes
+                    || priorities[volumeIndex] < priorities[selected]
+                    || (priorities[volumeIndex] == priorities[selected] && volumeBytes[volumeIndex] > volumeBytes[selected])) selected = volumeIndex;
+            }
+            if (selected == numVolumes) break;
+
+            if (!DegradeDDGIVolumeDesc(descs[selected]))
+            {
+                degradable[selected] = false;
+                continue;
+            }
+
+            totalBytes -= volumeBytes[selected];
+            volumeBytes[selected] = GetDDGIVolumeGPUMemoryUsedInBytes(descs[selected]);
+            totalBytes += volumeBytes[selected];
+        }
+
+        if (usedInBytes) *usedInBytes = totalBytes;
+        return (totalBytes <= budgetInBytes);
+    }
+
     //------------------------------------------------------------------------
     // Public DDGIVolume Functions
     //------------------------------------------------------------------------
@@ -107,6 +252,134 @@ namespace rtxgi
 
         // Update scrolling offsets and clear flags
         if(m_desc.movementType == EDDGIVolumeMovementType::Scrolling) ComputeScrolling();
+
+        // Advance the frame counter that staggers scheduled probe updates (and rotates the time slices)
+        m_probeSchedulingFrame = (m_probeSchedulingFrame + 1) & 0xFF;
+
+        // Probes scrolled into the volume need relocation and classification, catch up at full rate
+        if (m_probeScrollClear[0] || m_probeScrollClear[1] || m_probeScrollClear[2]) OnLargeObjectChange();
+
+        // Consume a full rate time slicing update, if catching up
+        m_probeTimeSliceFullRate = (m_probeTimeSliceCatchUpFrames > 0);
+        if (m_probeTimeSliceFullRate) m_probeTimeSliceCatchUpFrames--;
+
+        // Consume an update of the global light change recovery, the weight falls off linearly
+        uint32_t recoveryFrames = static_cast<uint32_t>(std::max(m_desc.probeEventRecoveryFrames, 1));
+        m_eventGlobalLightWeight = static_cast<float>(std::min(m_eventGlobalLightFrames, recoveryFrames)) / static_cast<float>(recoveryFrames);
+        if (m_eventGlobalLightFrames > 0) m_eventGlobalLightFrames--;
+
+        // Consume an update of the small light changes, drop the bounding sphere once they have been traced long enough
+        if (m_eventSmallLightFrames > 0) m_eventSmallLightFrames--;
+        else m_eventSmallLightRadius = 0.f;
+    }
+
+    void DDGIVolumeBase::OnGlobalLightChange()
+    {
+        OnUpdateEvent();
+        if (!m_desc.probeEventUpdatesEnabled) return;
+
+        // Lower the hysteresis and trace every probe until the probes recover
+        m_eventGlobalLightFrames = static_cast<uint32_t>(std::max(m_desc.probeEventRecoveryFrames, 1));
+    }
+
+    void DDGIVolumeBase::OnLargeObjectChange()
+    {
+        OnUpdateEvent();
+
+        // Relocate and classify every probe until each time slice has been processed again
+        m_probeTimeSliceCatchUpFrames = (1u << GetProbeTimeSliceStrideLog2());
+    }
+
+    void DDGIVolumeBase::OnSmallLightChange()
+    {
+        // The light's extent is unknown, wake the volume
+        OnUpdateEvent();
+    }
+
+    void DDGIVolumeBase::OnSmallLightChange(const float3& position, float radius)
+    {
+        OnUpdateEvent();
+        if (!m_desc.probeEventUpdatesEnabled || radius <= 0.f) return;
+
+        if (m_eventSmallLightRadius <= 0.f)
+        {
+            m_eventSmallLightOrigin = position;
+            m_eventSmallLightRadius = radius;
+        }
+        else
+        {
+            // Merge the lights into one bounding sphere
+            float3 delta = { position.x - m_eventSmallLightOrigin.x, position.y - m_eventSmallLightOrigin.y, position.z - m_eventSmallLightOrigin.z };
+            float distance = std::sqrt((delta.x * delta.x) + (delta.y * delta.y) + (delta.z * delta.z));
+            if ((distance + radius) > m_eventSmallLightRadius)
+            {
+                if ((distance + m_eventSmallLightRadius) <= radius)
+                {
+                    // The new light contains the current sphere
+                    m_eventSmallLightOrigin = position;
+                    m_eventSmallLightRadius = radius;
+                }
+                else
+                {
+                    float mergedRadius = (distance + radius + m_eventSmallLightRadius) * 0.5f;
+                    float t = (mergedRadius - m_eventSmallLightRadius) / distance;
+                    m_eventSmallLightOrigin = { m_eventSmallLightOrigin.x + (delta.x * t), m_eventSmallLightOrigin.y + (delta.y * t), m_eventSmallLightOrigin.z + (delta.z * t) };
+                    m_eventSmallLightRadius = mergedRadius;
+                }
+            }
+        }
+
+        // Trace the probes near the lights every frame until they recover
+        m_eventSmallLightFrames = static_cast<uint32_t>(std::max(m_desc.probeEventRecoveryFrames, 1));
+    }
+
+    void DDGIVolumeBase::SetVolumeAverageVariability(float value)
+    {
+        m_averageVariability = value;
+
+        // Variability is zero before it is first measured, so zero is treated as unknown and doesn't count towards convergence
+        if (!m_desc.probeVariabilityEnabled || m_desc.probeConvergenceVariabilityThreshold <= 0.f || value <= 0.f || value >= m_desc.probeConvergenceVariabilityThreshold)
+        {
+            ResetProbeConvergence();
+            return;
+        }
+
+        m_probeConvergenceSamples++;
+        m_probeConverged = (m_probeConvergenceSamples >= static_cast<uint32_t>(std::max(m_desc.probeConvergenceFrames, 1)));
+    }
+
+    bool DDGIVolumeBase::PollUpdateNeeded()
+    {
+        m_eventIdle = false;
+
+        // Events wake converged volumes
+        bool eventPending = m_eventPending;
+        m_eventPending = false;
+        if (eventPending) ResetProbeConvergence();
+
+        // Converged volumes pause their updates
+        if (m_desc.probeConvergencePauseUpdates && m_probeConverged) return false;
+
+        if (!m_desc.probeEventUpdatesEnabled) return true;
+
+        // Events and their recovery update the volume every frame
+        if (eventPending || m_eventGlobalLightFrames > 0 || m_eventSmallLightFrames > 0 || m_probeTimeSliceCatchUpFrames > 0)
+        {
+            m_eventIdleFrames = 0;
+            return true;
+        }
+
+        // Volumes that haven't converged update every frame. Variability is zero before it is first measured, so zero is treated as unknown.
+        if (!m_desc.probeVariabilityEnabled || m_averageVariability <= 0.f || m_averageVariability >= m_desc.probeEventIdleVariabilityThreshold)
+        {
+            m_eventIdleFrames = 0;
+            return true;
+        }
+
+        // Idle volumes update at the maintenance rate
+        m_eventIdle = true;
+        uint32_t intervalMask = (1u << std::clamp(m_desc.probeEventIdleIntervalLog2, 0, RTXGI_DDGI_PROBE_EVENT_MAX_IDLE_INTERVAL_LOG2)) - 1;
+        return ((m_eventIdleFrames++ & intervalMask) == 0);
     }
 
 #if _DEBUG
@@ -119,6 +392,8 @@ namespace rtxgi
         assert(l.probeCounts.x == r.probeCounts.x);
         assert(l.probeCounts.y == r.probeCounts.y);
         assert(l.probeCounts.z == r.probeCounts.z);
+        assert(l.probeBlendingActiveOnly == r.probeBlendingActiveOnly);
+        assert(l.probeStateBitsEnabled == r.probeStateBitsEnabled);
 
         // Packed1, expect precision loss going from FP32->FP16->FP32
         assert(abs(l.probeRandomRayBackfaceThreshold - r.probeRandomRayBackfaceThreshold) <= (1.f / 65536.f));
@@ -126,6 +401,7 @@ namespace rtxgi
 
         // Packed2
         assert(l.probeNumRays == r.probeNumRays);
+        assert(l.probeTimeSliceStrideLog2 == r.probeTimeSliceStrideLog2);
         assert(l.probeNumIrradianceInteriorTexels == r.probeNumIrradianceInteriorTexels);
         assert(l.probeNumDistanceInteriorTexels == r.probeNumDistanceInteriorTexels);
 
@@ -147,6 +423,38 @@ namespace rtxgi
         assert(l.probeScrollDirections[0] == r.probeScrollDirections[0]);
         assert(l.probeScrollDirections[1] == r.probeScrollDirections[1]);
         assert(l.probeScrollDirections[2] == r.probeScrollDirections[2]);
+
+        // Packed5, expect precision loss on the variability threshold
+        assert(l.probeSchedulingEnabled == r.probeSchedulingEnabled);
+        assert(l.probeSchedulingMaxIntervalLog2 == r.probeSchedulingMaxIntervalLog2);
+        assert(l.probeSchedulingFullRateDistance == r.probeSchedulingFullRateDistance);
+        assert(l.probeSchedulingFrame == r.probeSchedulingFrame);
+        assert(abs(l.probeSchedulingVariabilityThreshold - r.probeSchedulingVariabilityThreshold) <= (1.f / 4095.f));
+
+        // Update Events
+        assert(l.probeEventRadius == r.probeEventRadius);
+
+        // Packed6
+        assert(l.probeAdaptiveRaysEnabled == r.probeAdaptiveRaysEnabled);
+        assert(l.probeAdaptiveRaysMin == r.probeAdaptiveRaysMin);
+        assert(l.probeIrradianceEncoding == r.probeIrradianceEncoding);
+        assert(l.probeScrollSeedEnabled == r.probeScrollSeedEnabled);
+        assert(l.probeAdaptiveHysteresisEnabled == r.probeAdaptiveHysteresisEnabled);
+        assert(abs(l.probeAdaptiveHysteresisVariabilityThreshold - r.probeAdaptiveHysteresisVariabilityThreshold) <= (1.f / 4095.f));
+        assert(l.probeIrradianceMipsEnabled == r.probeIrradianceMipsEnabled);
+        assert(l.probeVisibilityMaskEnabled == r.probeVisibilityMaskEnabled);
+
+        // Packed7, expect precision loss going from FP32->UNORM16->FP32
+        assert(abs(l.probeAdaptiveHysteresisMin - r.probeAdaptiveHysteresisMin) <= (1.f / 65535.f));
+        assert(abs(l.probeAdaptiveHysteresisMax - r.probeAdaptiveHysteresisMax) <= (1.f / 65535.f));
+
+        assert(l.probeIrradianceMipDistance == r.probeIrradianceMipDistance);
+
+        // Packed8
+        assert(l.probeConvergenceFreezeEnabled == r.probeConvergenceFreezeEnabled);
+        assert(l.probeConvergenceFrames == r.probeConvergenceFrames);
+        assert(l.probeConvergenceWakeGeneration == r.probeConvergenceWakeGeneration);
+        assert(l.probeConvergenceVariabilityThreshold == r.probeConvergenceVariabilityThreshold);
     }
 #endif
 
@@ -167,6 +475,11 @@ namespace rtxgi
         descGPU.probeNumIrradianceInteriorTexels = m_desc.probeNumIrradianceInteriorTexels;
         descGPU.probeNumDistanceInteriorTexels = m_desc.probeNumDistanceInteriorTexels;
         descGPU.probeHysteresis = m_desc.probeHysteresis;
+        if (m_eventGlobalLightWeight > 0.f)
+        {
+            // Recovering from a global light change, blend toward the (lower) event hysteresis
+            descGPU.probeHysteresis += (m_desc.probeEventHysteresis - m_desc.probeHysteresis) * m_eventGlobalLightWeight;
+        }
         descGPU.probeMaxRayDistance = m_desc.probeMaxRayDistance;
         descGPU.probeNormalBias = m_desc.probeNormalBias;
         descGPU.probeViewBias = m_desc.probeViewBias;
@@ -188,21 +501,82 @@ namespace rtxgi
 
         descGPU.probeRayDataFormat = static_cast<uint32_t>(m_desc.probeRayDataFormat);
         descGPU.probeIrradianceFormat = static_cast<uint32_t>(m_desc.probeIrradianceFormat);
+        descGPU.probeIrradianceEncoding = static_cast<uint32_t>(m_desc.probeIrradianceEncoding);
         descGPU.probeRelocationEnabled = m_desc.probeRelocationEnabled;
         descGPU.probeClassificationEnabled = m_desc.probeClassificationEnabled;
         descGPU.probeVariabilityEnabled = m_desc.probeVariabilityEnabled;
+        descGPU.probeBlendingActiveOnly = GetProbeBlendingActiveListEnabled();
+        descGPU.probeStateBitsEnabled = m_desc.probeStateBitsEnabled;
         descGPU.probeScrollClear[0] = m_probeScrollClear[0];
         descGPU.probeScrollClear[1] = m_probeScrollClear[1];
         descGPU.probeScrollClear[2] = m_probeScrollClear[2];
+        descGPU.probeScrollSeedEnabled = m_desc.probeScrollSeedEnabled;
         descGPU.probeScrollDirections[0] = (m_probeScrollDirections[0] > 0);
         descGPU.probeScrollDirections[1] = (m_probeScrollDirections[1] > 0);
         descGPU.probeScrollDirections[2] = (m_probeScrollDirections[2] > 0);
 
+        // 3-bits used for the maximum update interval, 8-bits for the full rate distance, and 12-bits for the variability threshold
+        descGPU.probeSchedulingEnabled = m_desc.probeSchedulingEnabled;
+        descGPU.probeSchedulingMaxIntervalLog2 = static_cast<uint32_t>(std::clamp(m_desc.probeSchedulingMaxIntervalLog2, 0, RTXGI_DDGI_PROBE_SCHEDULE_MAX_INTERVAL_LOG2));
+        if (m_eventGlobalLightWeight > 0.f) descGPU.probeSchedulingMaxIntervalLog2 = 0; // Trace every probe while recovering from a global light change
+        descGPU.probeSchedulingFullRateDistance = static_cast<uint32_t>(std::clamp(m_desc.probeSchedulingFullRateDistance, 1, 255));
+        descGPU.probeSchedulingFrame = m_probeSchedulingFrame;
+        descGPU.probeSchedulingVariabilityThreshold = std::clamp(m_desc.probeSchedulingVariabilityThreshold, 0.f, 1.f);
+        descGPU.probeSchedulingViewOrigin = m_probeSchedulingViewOrigin;
+
+        // 3-bits used for the time slice stride, full rate while catching up
+        descGPU.probeTimeSliceStrideLog2 = m_probeTimeSliceFullRate ? 0 : GetProbeTimeSliceStrideLog2();
+
+        // Small light changes, probes near them are traced every frame
+        descGPU.probeEventOrigin = m_eventSmallLightOrigin;
+        descGPU.probeEventRadius = m_eventSmallLightRadius;
+
+        // 13-bits used for the minimum ray count, adaptive rays are picked by probe scheduling from the probe variability
+        descGPU.probeAdaptiveRaysEnabled = (m_desc.probeAdaptiveRaysEnabled && m_desc.probeSchedulingEnabled && m_desc.probeVariabilityEnabled);
+        descGPU.probeAdaptiveRaysMin = static_cast<uint32_t>(std::clamp(m_desc.probeAdaptiveRaysMin, 1, std::max(m_desc.probeNumRays, 1)));
+        descGPU.probeAdaptiveRaysVariabilityThreshold = std::max(m_desc.probeAdaptiveRaysVariabilityThreshold, 1e-6f);
+
+        descGPU.probeAdaptiveHysteresisEnabled = (m_desc.probeAdaptiveHysteresisEnabled && m_desc.probeVariabilityEnabled);
+        descGPU.probeAdaptiveHysteresisMin = std::clamp(m_desc.probeAdaptiveHysteresisMin, 0.f, 1.f);
+        descGPU.probeAdaptiveHysteresisMax = std::clamp(m_desc.probeAdaptiveHysteresisMax, descGPU.probeAdaptiveHysteresisMin, 1.f);
+        descGPU.probeAdaptiveHysteresisVariabilityThreshold = std::clamp(m_desc.probeAdaptiveHysteresisVariabilityThreshold, 1.f / 4095.f, 1.f);
+
+        // The mips are blended from the octahedral irradiance texels
+        descGPU.probeIrradianceMipsEnabled = (m_desc.probeIrradianceMipsEnabled && m_desc.probeIrradianceEncoding == EDDGIVolumeProbeIrradianceEncoding::Octahedral);
+        descGPU.probeIrradianceMipDistance = std::max(m_desc.probeIrradianceMipDistance, 1e-3f);
+
+        // The masks live in the probe schedule buffer, which only exists on D3D12 (see DDGIVolume_D3D12.cpp)
+        descGPU.probeVisibilityMaskEnabled = m_desc.probeVisibilityMaskEnabled;
+
+        // 15-bits used for the convergence frames, GPU convergence tracking is done by probe scheduling from the volume average variability
+        descGPU.probeConvergenceFreezeEnabled = (m_desc.probeConvergenceFreezeOnGPU && m_desc.probeSchedulingEnabled && m_desc.probeVariabilityEnabled && m_desc.probeConvergenceVariabilityThreshold > 0.f);
+        descGPU.probeConvergenceFrames = static_cast<uint32_t>(std::clamp(m_desc.probeConvergenceFrames, 1, 0x7FFF));
+        descGPU.probeConvergenceWakeGeneration = m_probeConvergenceWakeGeneration;
+        descGPU.probeConvergenceVariabilityThreshold = m_desc.probeConvergenceVariabilityThreshold;
+
         return descGPU;
     }
 
+    uint32_t DDGIVolumeBase::GetProbeTimeSliceStrideLog2() const
+    {
+        return static_cast<uint32_t>(std::clamp(m_desc.probeTimeSliceStrideLog2, 0, RTXGI_DDGI_PROBE_TIME_SLICE_MAX_STRIDE_LOG2));
+    }
+
     DDGIVolumeDescGPUPacked DDGIVolumeBase::GetDescGPUPacked() const { return PackDDGIVolumeDescGPU(GetDescGPU()); }
 
+    bool DDGIVolumeBase::GetConstantsUploadNeeded(const DDGIVolumeDescGPUPacked& packed, const void* constantsBuffer) const
+    {
+        // Compare the packed data rather than tracking setters, Update() also changes the ray rotation and scroll state
+        if (m_uploadedConstantsBuffer != constantsBuffer) return true;
+        return (memcmp(&m_uploadedDescGPUPacked, &packed, sizeof(DDGIVolumeDescGPUPacked)) != 0);
+    }
+
+    void DDGIVolumeBase::SetConstantsUploaded(const DDGIVolumeDescGPUPacked& packed, const void* constantsBuffer)
+    {
+        m_uploadedDescGPUPacked = packed;
+        m_uploadedConstantsBuffer = constantsBuffer;
+    }
+
     void DDGIVolumeBase::GetRayDispatchDimensions(uint32_t& width, uint32_t& height, uint32_t& depth) const
     {
         GetDDGIVolumeTextureDimensions(m_desc, EDDGIVolumeTextureType::RayData, width, height, depth);
@@ -236,6 +610,34 @@ namespace rtxgi
         return (m_desc.origin + probeGridWorldPosition - probeGridShift);
     }
 
+    bool DDGIVolumeBase::GetProbeWorldPositions(float3* positions, int numPositions) const
+    {
+        if (positions == nullptr || numPositions < GetNumProbes()) return false;
+
+        // Probe index order, fastest varying axis first (see GetProbeGridCoords())
+    #if RTXGI_COORDINATE_SYSTEM == RTXGI_COORDINATE_SYSTEM_LEFT || RTXGI_COORDINATE_SYSTEM == RTXGI_COORDINATE_SYSTEM_RIGHT
+        const int rowAxis = 0, columnAxis = 2, sliceAxis = 1;
+    #elif RTXGI_COORDINATE_SYSTEM == RTXGI_COORDINATE_SYSTEM_LEFT_Z_UP
+        const int rowAxis = 1, columnAxis = 0, sliceAxis = 2;
+    #elif RTXGI_COORDINATE_SYSTEM == RTXGI_COORDINATE_SYSTEM_RIGHT_Z_UP
+        const int rowAxis = 0, columnAxis = 1, sliceAxis = 2;
+    #endif
+
+        float3 probeGridShift = (m_desc.probeSpacing * (m_desc.probeCounts - 1)) / 2.f;
+        int rowLength = m_desc.probeCounts[rowAxis];
+
+        int3 coords = { 0, 0, 0 };
+        for (coords[sliceAxis] = 0; coords[sliceAxis] < m_desc.probeCounts[sliceAxis]; coords[sliceAxis]++)
+        {
+            for (coords[columnAxis] = 0; coords[columnAxis] < m_desc.probeCounts[columnAxis]; coords[columnAxis]++)
+            {
+                GetGridRowPositions(positions, rowLength, m_desc.origin, m_desc.probeSpacing, coords, rowAxis, probeGridShift);
+                positions += rowLength;
+            }
+        }
+        return true;
+    }
+
     AABB DDGIVolumeBase::GetAxisAlignedBoundingBox() const
     {
         float3 origin = m_desc.origin;
@@ -284,63 +686,7 @@ namespace rtxgi
 
     uint32_t DDGIVolumeBase::GetGPUMemoryUsedInBytes() const
     {
-        uint32_t bytesPerVolume = 0;
-
-        uint32_t numRayDataBytesPerTexel = 0;
-        uint32_t numIrradianceBytesPerTexel = 0;
-        uint32_t numDistanceBytesPerTexel = 0;
-        uint32_t numProbeDataBytesPerTexel = 0;
-        uint32_t numProbeVariabilityBytesPerTexel = 0;
-        uint32_t numProbeVariabilityAverageBytesPerTexel = 0;
-
-        // Compute the number of irradiance and distance texels
-        uint32_t numIrradianceTexelsPerProbe = (m_desc.probeNumIrradianceTexels * m_desc.probeNumIrradianceTexels);
-        uint32_t numDistanceTexelsPerProbe = (m_desc.probeNumDistanceTexels * m_desc.probeNumDistanceTexels);
-
-        // Get the number of bytes per ray data texel
-        if (m_desc.probeRayDataFormat == EDDGIVolumeTextureFormat::F32x2) numRayDataBytesPerTexel = 8;
-        else if (m_desc.probeRayDataFormat == EDDGIVolumeTextureFormat::F32x4) numRayDataBytesPerTexel = 16;
-
-        // Get the number of bytes per irradiance texel
-        if (m_desc.probeIrradianceFormat == EDDGIVolumeTextureFormat::U32) numIrradianceBytesPerTexel = 4;
-        else if (m_desc.probeIrradianceFormat == EDDGIVolumeTextureFormat::F16x4) numIrradianceBytesPerTexel = 8;
-        else if (m_desc.probeIrradianceFormat == EDDGIVolumeTextureFormat::F32x4) numIrradianceBytesPerTexel = 16;
-
-        // Get the number of bytes per distance texel
-        if (m_desc.probeDistanceFormat == EDDGIVolumeTextureFormat::F16x2) numDistanceBytesPerTexel = 4;
-        else if (m_desc.probeIrradianceFormat == EDDGIVolumeTextureFormat::F32x2) numDistanceBytesPerTexel = 8;
-
-        // Get the number of bytes per probe data texel
-        if (m_desc.probeDataFormat == EDDGIVolumeTextureFormat::F16x4) numProbeDataBytesPerTexel = 8;
-        else if (m_desc.probeDataFormat == EDDGIVolumeTextureFormat::F32x4) numProbeDataBytesPerTexel = 16;
-
-        // Get the number of bytes per probe variability texel
-        if (m_desc.probeVariabilityFormat == EDDGIVolumeTextureFormat::F16) numProbeVariabilityBytesPerTexel = 2;
-        else if (m_desc.probeVariabilityFormat == EDDGIVolumeTextureFormat::F32) numProbeVariabilityBytesPerTexel = 4;
-
-        // Variability average is always F32x2 (8 bytes)
-        numProbeVariabilityAverageBytesPerTexel = 8;
-
-        // Compute the number of bytes per probe
-        uint32_t bytesPerProbe = 0;
-        bytesPerProbe += GetNumRaysPerProbe() * numRayDataBytesPerTexel;
-        bytesPerProbe += (numIrradianceTexelsPerProbe * numIrradianceBytesPerTexel);
-        bytesPerProbe += (numDistanceTexelsPerProbe * numDistanceBytesPerTexel);
-        bytesPerProbe += numProbeDataBytesPerTexel;
-        bytesPerProbe += numProbeVariabilityBytesPerTexel;
-
-        // Coefficient of variation average texture is different (smaller) dimensions from other textures
-        uint32_t width, height, arraySize;
-        GetDDGIVolumeTextureDimensions(m_desc, EDDGIVolumeTextureType::VariabilityAverage, width, height, arraySize);
-        bytesPerVolume += width * height * arraySize * numProbeVariabilityAverageBytesPerTexel;
-
-        // Add the per probe memory use
-        bytesPerVolume += GetNumProbes() * bytesPerProbe;
-
-        // Add the memory used for the GPU-side DDGIVolumeDescGPUPacked (128B)
-        bytesPerVolume += (uint32_t)sizeof(DDGIVolumeDescGPUPacked);
-
-        return bytesPerVolume;
+        return static_cast<uint32_t>(GetDDGIVolumeGPUMemoryUsedInBytes(m_desc));
     }
 
     //------------------------------------------------------------------------
@@ -379,17 +725,33 @@ namespace rtxgi
     // Random number generation
     //------------------------------------------------------------------------
 
-    static std::uniform_real_distribution<float> s_distribution(0.f, 1.f);
-    static std::mt19937 m_rng;
+    // PCG32 (O'Neill, "PCG: A Family of Simple Fast Space-Efficient Statistically Good Algorithms for Random Number Generation").
+    // Each volume has its own generator, so volumes seeded alike draw the same rotations whatever the other volumes do,
+    // and volumes can be updated concurrently.
+    static const uint64_t RNGMultiplier = 6364136223846793005ull;
+    static const uint64_t RNGIncrement = 1442695040888963407ull;
+
+    static uint32_t NextRandom(uint64_t& state)
+    {
+        uint64_t previous = state;
+        state = (previous * RNGMultiplier) + RNGIncrement;
+        uint32_t xorShifted = (uint32_t)(((previous >> 18u) ^ previous) >> 27u);
+        uint32_t rotation = (uint32_t)(previous >> 59u);
+        return (xorShifted >> rotation) | (xorShifted << ((32u - rotation) & 31u));
+    }
 
     void DDGIVolumeBase::SeedRNG(const int seed)
     {
-        m_rng.seed((uint32_t)seed);
+        m_rngState = 0;
+        NextRandom(m_rngState);
+        m_rngState += (uint32_t)seed;
+        NextRandom(m_rngState);
     }
 
     float DDGIVolumeBase::GetRandomFloat()
     {
-        return s_distribution(m_rng);
+        // The top 24 bits, uniform in [0, 1)
+        return (float)(NextRandom(m_rngState) >> 8) * (1.f / 16777216.f);
     }
 
     //------------------------------------------------------------------------
@@ -437,21 +799,57 @@ namespace rtxgi
         }
     }
 
+    float3 DDGIVolumeBase::GetLowDiscrepancyRotationSample()
+    {
+        // R3 sequence (Roberts, "The Unreasonable Effectiveness of Quasirandom Sequences"), based on the generalized golden ratio
+        // phi3, the real root of x^4 = x + 1. Consecutive points stay well spread in the unit cube, so consecutive rotations
+        // (Arvo's mapping preserves uniformity) cover the sphere more evenly than independent random rotations.
+        const double phi3 = 1.2207440845776245;
+        const double alpha[3] = { 1.0 / phi3, 1.0 / (phi3 * phi3), 1.0 / (phi3 * phi3 * phi3) };
+
+        // Offset the sequence randomly once per volume (Cranley-Patterson rotation), so volumes don't share rotations
+        if (m_probeRayRotationIndex == 0) m_probeRayRotationOffset = { GetRandomFloat(), GetRandomFloat(), GetRandomFloat() };
+
+        double n = (double)(m_probeRayRotationIndex + 1);
+        float3 sample =
+        {
+            (float)fmod(m_probeRayRotationOffset.x + (n * alpha[0]), 1.0),
+            (float)fmod(m_probeRayRotationOffset.y + (n * alpha[1]), 1.0),
+            (float)fmod(m_probeRayRotationOffset.z + (n * alpha[2]), 1.0)
+        };
+
+        // Restart the sequence before the doubles lose fractional precision
+        m_probeRayRotationIndex = (m_probeRayRotationIndex + 1) & 0xFFFFFF;
+
+        return sample;
+    }
+
     void DDGIVolumeBase::ComputeRandomRotation()
     {
         // This approach is based on James Arvo's implementation from Graphics Gems 3 (pg 117-120).
         // Also available at: http://citeseerx.ist.psu.edu/viewdoc/download?doi=10.1.1.53.1357&rep=rep1&type=pdf
 
+        // Get 3 uniform RVs, random or the next point of the low-discrepancy sequence
+        float3 u;
+        if (m_desc.probeRayRotationType == EDDGIVolumeProbeRayRotationType::LowDiscrepancy)
+        {
+            u = GetLowDiscrepancyRotationSample();
+        }
+        else
+        {
+            u = { GetRandomFloat(), GetRandomFloat(), GetRandomFloat() };
+        }
+
         // Setup a random rotation matrix using 3 uniform RVs
-        float u1 = RTXGI_2PI * GetRandomFloat();
+        float u1 = RTXGI_2PI * u.x;
         float cos1 = cosf(u1);
         float sin1 = sinf(u1);
 
-        float u2 = RTXGI_2PI * GetRandomFloat();
+        float u2 = RTXGI_2PI * u.y;
         float cos2 = cosf(u2);
         float sin2 = sinf(u2);
 
-        float u3 = GetRandomFloat();
+        float u3 = u.z;
         float sq3 = 2.f * sqrtf(u3 * (1.f - u3));
 
         float s2 = 2.f * u3 * sin2 * sin2 - 1.f;
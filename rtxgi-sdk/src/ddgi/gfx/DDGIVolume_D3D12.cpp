@@ -14,6 +14,7 @@
 #include <pix.h>
 #endif
 
+#include <algorithm>
 #include <random>
 #include <string>
 #include <vector>
@@ -22,14 +23,82 @@ namespace rtxgi
 {
     namespace d3d12
     {
+    #if RTXGI_DDGI_RESOURCE_MANAGEMENT
+        //------------------------------------------------------------------------
+        // Sparse Probe Textures (Managed Resources)
+        //------------------------------------------------------------------------
+
+        #define RTXGI_DDGI_SPARSE_TILE_UNMAPPED 0xFFFFFFFF
+
+        struct DDGIVolumeSparseTexture
+        {
+            ID3D12Resource*                 resource = nullptr;                 // Reserved texture array (owned by the volume), nullptr if the texture was committed
+            UINT                            probeTexels = 0;                    // Texels per probe along X and Y
+            D3D12_TILE_SHAPE                tileShape = {};                     // Texels per tile
+            UINT                            tilesX = 0;                         // Tiles per array slice along X
+            UINT                            tilesY = 0;                         // Tiles per array slice along Y
+            std::vector<UINT>               tiles;                              // Heap tile backing each texture tile (slice, row, column order) or RTXGI_DDGI_SPARSE_TILE_UNMAPPED
+        };
+
+        struct DDGIVolumeSparseResidency
+        {
+            DDGIVolumeSparseTexture         textures[3];                        // Irradiance, distance, and variability
+
+            std::vector<ID3D12Heap*>        heaps;                              // Tile heaps of RTXGI_DDGI_SPARSE_TILES_PER_HEAP tiles, created on first use
+            std::vector<UINT>               freeTiles;                          // Heap tiles not backing a texture tile (stack, lowest tiles on top)
+
+            ID3D12DescriptorHeap*           rtvDescriptorHeap = nullptr;        // Per array slice render target views of the irradiance and distance textures
+            UINT                            rtvDescriptorSize = 0;
+
+            ID3D12Resource*                 probeDataReadback = nullptr;        // RTXGI_DDGI_SPARSE_READBACK_BUFFERS copies of the probe data texture array
+            UINT64                          probeDataReadbackSize = 0;          // Size (in bytes) of one copy
+            std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> probeDataFootprints; // Layout of one copy, per array slice
+            bool                            probeDataReadbackValid[RTXGI_DDGI_SPARSE_READBACK_BUFFERS] = {};
+        };
+
+        //------------------------------------------------------------------------
+        // Probe Texture Resource Pool (Managed Resources)
+        //------------------------------------------------------------------------
+
+        struct DDGIVolumePoolHeap
+        {
+            ID3D12Heap*                     heap = nullptr;                     // nullptr once an outgrown transient heap is released
+            D3D12_HEAP_FLAGS                flags = D3D12_HEAP_FLAG_NONE;       // Texture category, render target textures must be kept apart on resource heap tier 1
+            UINT64                          size = 0;                           // Size (in bytes) of the heap
+            bool                            transient = false;                  // The heap is aliased by the probe ray data of every volume placed in it
+            UINT                            numResources = 0;                   // Resources placed in the heap
+            std::vector<std::pair<UINT64, UINT64>> freeBlocks;                  // Offset and size (in bytes) of the unused ranges, sorted by offset (not used by transient heaps)
+        };
+
+        struct DDGIVolumePoolResource
+        {
+            ID3D12Resource*                 resource = nullptr;                 // Placed resource (owned by a volume)
+            UINT                            heapIndex = 0;
+            UINT64                          offset = 0;                         // Offset (in bytes) of the resource in the heap
+            UINT64                          size = 0;                           // Size (in bytes) of the resource in the heap
+        };
+
+        struct DDGIVolumeResourcePool
+        {
+            ID3D12Device*                   device = nullptr;
+            DDGIVolumeResourcePoolDesc      desc = {};
+            std::vector<DDGIVolumePoolHeap> heaps;                              // Indices are stable, released heaps are left in place (nullptr)
+            std::vector<DDGIVolumePoolResource> resources;
+            std::vector<DDGIVolume*>        volumes;                            // Recycled volumes, oldest first (see RecycleDDGIVolume())
+        };
+    #endif
+
         //------------------------------------------------------------------------
         // Private RTXGI Namespace Helper Functions
         //------------------------------------------------------------------------
 
-        ERTXGIStatus ValidateManagedResourcesDesc(const DDGIVolumeManagedResourcesDesc& desc)
+        ERTXGIStatus ValidateManagedResourcesDesc(const DDGIVolumeManagedResourcesDesc& desc, bool probeScheduleRequired)
         {
             // D3D device
             if (desc.device == nullptr) return ERTXGIStatus::ERROR_DDGI_D3D12_INVALID_DEVICE;
+        #if RTXGI_DDGI_RESOURCE_MANAGEMENT
+            if (desc.pool != nullptr && desc.pool->device != desc.device) return ERTXGIStatus::ERROR_DDGI_D3D12_INVALID_DEVICE;
+        #endif
 
             // Shader bytecode
             if (!ValidateShaderBytecode(desc.probeBlendingIrradianceCS)) return ERTXGIStatus::ERROR_DDGI_INVALID_BYTECODE_PROBE_BLENDING_IRRADIANCE;
@@ -40,11 +109,16 @@ namespace rtxgi
             if (!ValidateShaderBytecode(desc.probeClassification.resetCS)) return ERTXGIStatus::ERROR_DDGI_INVALID_BYTECODE_PROBE_CLASSIFICATION_RESET;
             if (!ValidateShaderBytecode(desc.probeVariability.reductionCS)) return ERTXGIStatus::ERROR_DDGI_INVALID_BYTECODE_PROBE_VARIABILITY_REDUCTION;
             if (!ValidateShaderBytecode(desc.probeVariability.extraReductionCS)) return ERTXGIStatus::ERROR_DDGI_INVALID_BYTECODE_PROBE_VARIABILITY_EXTRA_REDUCTION;
+            if (probeScheduleRequired)
+            {
+                if (!ValidateShaderBytecode(desc.probeScheduling.scheduleCS)) return ERTXGIStatus::ERROR_DDGI_INVALID_BYTECODE_PROBE_SCHEDULING;
+                if (!ValidateShaderBytecode(desc.probeScheduling.argsCS)) return ERTXGIStatus::ERROR_DDGI_INVALID_BYTECODE_PROBE_SCHEDULING_ARGS;
+            }
 
             return ERTXGIStatus::OK;
         }
 
-        ERTXGIStatus ValidateUnmanagedResourcesDesc(const DDGIVolumeUnmanagedResourcesDesc& desc)
+        ERTXGIStatus ValidateUnmanagedResourcesDesc(const DDGIVolumeUnmanagedResourcesDesc& desc, bool probeScheduleRequired, bool probeSHRequired, bool probeIrradianceMipsRequired, bool probesPublishedRequired)
         {
             // Root Signature
             if (desc.rootSignature == nullptr) return ERTXGIStatus::ERROR_DDGI_D3D12_INVALID_ROOT_SIGNATURE;
@@ -57,6 +131,7 @@ namespace rtxgi
             if (desc.probeVariability == nullptr) return ERTXGIStatus::ERROR_DDGI_INVALID_TEXTURE_PROBE_VARIABILITY;
             if (desc.probeVariabilityAverage == nullptr) return ERTXGIStatus::ERROR_DDGI_INVALID_TEXTURE_PROBE_VARIABILITY_AVERAGE;
             if (desc.probeVariabilityReadback == nullptr) return ERTXGIStatus::ERROR_DDGI_INVALID_TEXTURE_PROBE_VARIABILITY_READBACK;
+            if (desc.probeVariabilityReadback->GetDesc().Width < RTXGI_DDGI_VARIABILITY_READBACK_SIZE) return ERTXGIStatus::ERROR_DDGI_INVALID_TEXTURE_PROBE_VARIABILITY_READBACK;
 
             // Render Target Views
             if (desc.probeIrradianceRTV.ptr == 0) return ERTXGIStatus::ERROR_DDGI_D3D12_INVALID_DESCRIPTOR;
@@ -72,9 +147,328 @@ namespace rtxgi
             if (desc.probeVariabilityPSOs.reductionPSO == nullptr) return ERTXGIStatus::ERROR_DDGI_D3D12_INVALID_PSO_PROBE_REDUCTION;
             if (desc.probeVariabilityPSOs.extraReductionPSO == nullptr) return ERTXGIStatus::ERROR_DDGI_D3D12_INVALID_PSO_PROBE_EXTRA_REDUCTION;
 
+            // Probe Scheduling
+            if (probeScheduleRequired)
+            {
+                if (desc.probeSchedule == nullptr) return ERTXGIStatus::ERROR_DDGI_INVALID_BUFFER_PROBE_SCHEDULE;
+                if (desc.probeScheduleArgs == nullptr) return ERTXGIStatus::ERROR_DDGI_INVALID_BUFFER_PROBE_SCHEDULE;
+                if (desc.probeScheduleCommandSignature == nullptr) return ERTXGIStatus::ERROR_DDGI_D3D12_INVALID_COMMAND_SIGNATURE_PROBE_SCHEDULE;
+                if (desc.probeScheduling.schedulePSO == nullptr) return ERTXGIStatus::ERROR_DDGI_D3D12_INVALID_PSO_PROBE_SCHEDULING;
+                if (desc.probeScheduling.argsPSO == nullptr) return ERTXGIStatus::ERROR_DDGI_D3D12_INVALID_PSO_PROBE_SCHEDULING_ARGS;
+            }
+
+            // Probe Spherical Harmonics
+            if (probeSHRequired)
+            {
+                if (desc.probeSH == nullptr) return ERTXGIStatus::ERROR_DDGI_INVALID_BUFFER_PROBE_SH;
+            }
+
+            // Probe Irradiance Mips
+            if (probeIrradianceMipsRequired)
+            {
+                if (desc.probeIrradianceMips == nullptr) return ERTXGIStatus::ERROR_DDGI_INVALID_BUFFER_PROBE_IRRADIANCE_MIPS;
+            }
+
+            // Published Probe Texture Arrays
+            if (probesPublishedRequired)
+            {
+                if (desc.probeIrradiancePublished == nullptr) return ERTXGIStatus::ERROR_DDGI_INVALID_TEXTURE_PROBE_IRRADIANCE;
+                if (desc.probeDistancePublished == nullptr) return ERTXGIStatus::ERROR_DDGI_INVALID_TEXTURE_PROBE_DISTANCE;
+                if (desc.probeDataPublished == nullptr) return ERTXGIStatus::ERROR_DDGI_INVALID_TEXTURE_PROBE_DATA;
+            }
+
             return ERTXGIStatus::OK;
         }
 
+        /**
+         * Copies a volume's probe irradiance, distance, and data textures over their published copies.
+         * The textures are expected to be in the D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE state, and are returned to it.
+         */
+        void CopyProbesToPublished(ID3D12GraphicsCommandList* cmdList, const DDGIVolume* volume)
+        {
+            ID3D12Resource* sources[3] = { volume->GetProbeIrradiance(), volume->GetProbeDistance(), volume->GetProbeData() };
+            ID3D12Resource* destinations[3] = { volume->GetProbeIrradianceSRV(), volume->GetProbeDistanceSRV(), volume->GetProbeDataSRV() };
+
+            D3D12_RESOURCE_BARRIER barriers[6] = {};
+            for (UINT textureIndex = 0; textureIndex < 3; textureIndex++)
+            {
+                D3D12_RESOURCE_BARRIER& source = barriers[textureIndex * 2];
+                source.Transition.pResource = sources[textureIndex];
+                source.Transition.StateBefore = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+                source.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
+                source.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+
+                D3D12_RESOURCE_BARRIER& destination = barriers[(textureIndex * 2) + 1];
+                destination.Transition.pResource = destinations[textureIndex];
+                destination.Transition.StateBefore = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+                destination.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
+                destination.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+            }
+            cmdList->ResourceBarrier(6, barriers);
+
+            for (UINT textureIndex = 0; textureIndex < 3; textureIndex++) cmdList->CopyResource(destinations[textureIndex], sources[textureIndex]);
+
+            for (D3D12_RESOURCE_BARRIER& barrier : barriers)
+            {
+                barrier.Transition.StateBefore = barrier.Transition.StateAfter;
+                barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+            }
+            cmdList->ResourceBarrier(6, barriers);
+        }
+
+        /**
+         * Writes the dispatch arguments of the probes appended to a volume's probe schedule and resets the append counter.
+         * Expects the volume's root signature and descriptor tables to be set.
+         */
+        void WriteProbeScheduleArgs(ID3D12GraphicsCommandList* cmdList, const DDGIVolume* volume)
+        {
+            D3D12_RESOURCE_BARRIER barriers[2] = {};
+            barriers[0].Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+            barriers[0].UAV.pResource = volume->GetProbeSchedule();
+
+            // Wait for the list to be complete
+            cmdList->ResourceBarrier(1, barriers);
+
+            // Write the dispatch arguments and reset the append counter
+            cmdList->SetPipelineState(volume->GetProbeSchedulingArgsPSO());
+            cmdList->Dispatch(1, 1, 1);
+
+            // The schedule is read as a UAV by the scheduled passes, so copy the arguments to a buffer
+            // that stays in the indirect argument state while those passes execute
+            barriers[0].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+            barriers[0].Transition.pResource = volume->GetProbeSchedule();
+            barriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+            barriers[0].Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
+            barriers[0].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+
+            barriers[1].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+            barriers[1].Transition.pResource = volume->GetProbeScheduleArgs();
+            barriers[1].Transition.StateBefore = D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT;
+            barriers[1].Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
+            barriers[1].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+
+            cmdList->ResourceBarrier(2, barriers);
+            cmdList->CopyBufferRegion(volume->GetProbeScheduleArgs(), 0, volume->GetProbeSchedule(), 0, RTXGI_DDGI_PROBE_SCHEDULE_COUNT_OFFSET);
+
+            barriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE;
+            barriers[0].Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+            barriers[1].Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+            barriers[1].Transition.StateAfter = D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT;
+
+            cmdList->ResourceBarrier(2, barriers);
+        }
+
+        /**
+         * Records the barriers that end a pass, or appends them to the caller's deferred barriers (flushed once for several volumes).
+         */
+        void EndPassBarriers(ID3D12GraphicsCommandList* cmdList, const std::vector<D3D12_RESOURCE_BARRIER>& barriers, std::vector<D3D12_RESOURCE_BARRIER>* deferredBarriers)
+        {
+            if (barriers.empty()) return;
+            if (deferredBarriers) deferredBarriers->insert(deferredBarriers->end(), barriers.begin(), barriers.end());
+            else cmdList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+        }
+
+    #if RTXGI_DDGI_RESOURCE_MANAGEMENT
+        /**
+         * Places a texture in the pool. Transient textures alias the start of the largest transient heap, other textures use the first free range that fits.
+         */
+        bool AllocatePoolResource(DDGIVolumeResourcePool* pool, const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES state, const D3D12_CLEAR_VALUE* clear, bool transient, ID3D12Resource** resource)
+        {
+            D3D12_RESOURCE_ALLOCATION_INFO info = pool->device->GetResourceAllocationInfo(0, 1, &desc);
+            if (info.SizeInBytes == UINT64_MAX) return false;
+
+            D3D12_HEAP_FLAGS flags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+            if (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)) flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+
+            UINT heapIndex = UINT_MAX;
+            UINT64 offset = 0;
+            if (transient)
+            {
+                for (UINT index = 0; index < (UINT)pool->heaps.size(); index++)
+                {
+                    const DDGIVolumePoolHeap& heap = pool->heaps[index];
+                    if (!heap.transient || heap.heap == nullptr || heap.flags != flags) continue;
+                    if (heapIndex == UINT_MAX || heap.size > pool->heaps[heapIndex].size) heapIndex = index;
+                }
+
+                // The texture doesn't fit in the largest transient heap, a larger one replaces it
+                if (heapIndex != UINT_MAX && pool->heaps[heapIndex].size < info.SizeInBytes) heapIndex = UINT_MAX;
+            }
+            else
+            {
+                for (UINT index = 0; index < (UINT)pool->heaps.size() && heapIndex == UINT_MAX; index++)
+                {
+                    DDGIVolumePoolHeap& heap = pool->heaps[index];
+                    if (heap.transient || heap.heap == nullptr || heap.flags != flags) continue;
+
+                    for (size_t blockIndex = 0; blockIndex < heap.freeBlocks.size(); blockIndex++)
+                    {
+                        UINT64 blockStart = heap.freeBlocks[blockIndex].first;
+                        UINT64 blockEnd = blockStart + heap.freeBlocks[blockIndex].second;
+                        UINT64 start = RTXGI_ALIGN(info.Alignment, blockStart);
+                        if (start + info.SizeInBytes > blockEnd) continue;
+
+                        // Split the free range around the texture
+                        heap.freeBlocks.erase(heap.freeBlocks.begin() + blockIndex);
+                        if (start + info.SizeInBytes < blockEnd) heap.freeBlocks.insert(heap.freeBlocks.begin() + blockIndex, { start + info.SizeInBytes, blockEnd - (start + info.SizeInBytes) });
+                        if (blockStart < start) heap.freeBlocks.insert(heap.freeBlocks.begin() + blockIndex, { blockStart, start - blockStart });
+
+                        heapIndex = index;
+                        offset = start;
+                        break;
+                    }
+                }
+            }
+
+            if (heapIndex == UINT_MAX)
+            {
+                // Create a heap, textures larger than the pool's heap size get a heap of their own
+                DDGIVolumePoolHeap heap;
+                heap.flags = flags;
+                heap.transient = transient;
+                heap.size = transient ? info.SizeInBytes : (std::max)(pool->desc.heapSizeInBytes, info.SizeInBytes);
+                heap.size = RTXGI_ALIGN(info.Alignment, heap.size);
+
+                D3D12_HEAP_DESC heapDesc = {};
+                heapDesc.SizeInBytes = heap.size;
+                heapDesc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+                heapDesc.Alignment = info.Alignment;
+                heapDesc.Flags = flags;
+
+                HRESULT hr = pool->device->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap.heap));
+                if (FAILED(hr)) return false;
+            #ifdef RTXGI_GFX_NAME_OBJECTS
+                heap.heap->SetName(transient ? L"DDGIVolume Resource Pool Transient Heap" : L"DDGIVolume Resource Pool Heap");
+            #endif
+
+                if (!transient && info.SizeInBytes < heap.size) heap.freeBlocks.push_back({ info.SizeInBytes, heap.size - info.SizeInBytes });
+
+                heapIndex = (UINT)pool->heaps.size();
+                pool->heaps.push_back(heap);
+            }
+
+            DDGIVolumePoolHeap& heap = pool->heaps[heapIndex];
+            HRESULT hr = pool->device->CreatePlacedResource(heap.heap, offset, &desc, state, clear, IID_PPV_ARGS(resource));
+            if (FAILED(hr))
+            {
+                // Return the range to the heap
+                if (!transient)
+                {
+                    heap.freeBlocks.push_back({ offset, info.SizeInBytes });
+                    std::sort(heap.freeBlocks.begin(), heap.freeBlocks.end());
+                }
+                return false;
+            }
+
+            DDGIVolumePoolResource entry;
+            entry.resource = *resource;
+            entry.heapIndex = heapIndex;
+            entry.offset = offset;
+            entry.size = info.SizeInBytes;
+            pool->resources.push_back(entry);
+            heap.numResources++;
+
+            return true;
+        }
+
+        /**
+         * Releases a texture placed in the pool and returns its memory to the heap. Returns false if the texture isn't in the pool.
+         */
+        bool ReleasePoolResource(DDGIVolumeResourcePool* pool, ID3D12Resource* resource)
+        {
+            auto it = std::find_if(pool->resources.begin(), pool->resources.end(), [resource](const DDGIVolumePoolResource& entry) { return entry.resource == resource; });
+            if (it == pool->resources.end()) return false;
+
+            DDGIVolumePoolResource entry = *it;
+            pool->resources.erase(it);
+            entry.resource->Release();
+
+            DDGIVolumePoolHeap& heap = pool->heaps[entry.heapIndex];
+            heap.numResources--;
+
+            if (heap.transient)
+            {
+                // Release an empty transient heap once a larger one replaced it
+                if (heap.numResources > 0) return true;
+                for (const DDGIVolumePoolHeap& other : pool->heaps)
+                {
+                    if (!other.transient || other.heap == nullptr || other.flags != heap.flags || other.size <= heap.size) continue;
+                    RTXGI_SAFE_RELEASE(heap.heap);
+                    heap.size = 0;
+                    break;
+                }
+                return true;
+            }
+
+            // Insert the range and merge it with its neighbours
+            auto block = std::lower_bound(heap.freeBlocks.begin(), heap.freeBlocks.end(), std::make_pair(entry.offset, entry.size));
+            block = heap.freeBlocks.insert(block, { entry.offset, entry.size });
+            if ((block + 1) != heap.freeBlocks.end() && (block->first + block->second) == (block + 1)->first)
+            {
+                block->second += (block + 1)->second;
+                heap.freeBlocks.erase(block + 1);
+            }
+            if (block != heap.freeBlocks.begin() && ((block - 1)->first + (block - 1)->second) == block->first)
+            {
+                (block - 1)->second += block->second;
+                heap.freeBlocks.erase(block);
+            }
+
+            return true;
+        }
+
+        /**
+         * Checks if a volume created with desc can be created again with other without allocating textures or buffers.
+         */
+        bool IsSameSizeClass(const DDGIVolumeDesc& desc, const DDGIVolumeDesc& other)
+        {
+            DDGIVolumeDesc copy = desc;
+            if (copy.ShouldAllocateProbes(other) || copy.ShouldAllocateRayData(other)) return false;
+            if (copy.ShouldAllocateIrradiance(other) || copy.ShouldAllocateDistance(other)) return false;
+
+            // Texture formats
+            if (desc.probeRayDataFormat != other.probeRayDataFormat) return false;
+            if (desc.probeIrradianceFormat != other.probeIrradianceFormat) return false;
+            if (desc.probeDistanceFormat != other.probeDistanceFormat) return false;
+            if (desc.probeDataFormat != other.probeDataFormat) return false;
+            if (desc.probeVariabilityFormat != other.probeVariabilityFormat) return false;
+
+            // Optional probe buffers
+            if (desc.probeSchedulingEnabled != other.probeSchedulingEnabled) return false;
+            if (desc.probeBlendingActiveOnly != other.probeBlendingActiveOnly) return false;
+            if (desc.probeVariabilityUseSinglePassReduction != other.probeVariabilityUseSinglePassReduction) return false;
+            if (desc.probeStateBitsEnabled != other.probeStateBitsEnabled) return false;
+            if (desc.probeVisibilityMaskEnabled != other.probeVisibilityMaskEnabled) return false;
+            if (desc.probeIrradianceEncoding != other.probeIrradianceEncoding) return false;
+            if (desc.probeIrradianceMipsEnabled != other.probeIrradianceMipsEnabled) return false;
+            return true;
+        }
+
+        /**
+         * Hashes (64-bit FNV-1a) the shader bytecode of the volume's pipeline state objects.
+         */
+        UINT64 GetShaderBytecodeHash(const DDGIVolumeManagedResourcesDesc& managed)
+        {
+            const ShaderBytecode shaders[] =
+            {
+                managed.probeBlendingIrradianceCS, managed.probeBlendingDistanceCS,
+                managed.probeRelocation.updateCS, managed.probeRelocation.resetCS,
+                managed.probeClassification.updateCS, managed.probeClassification.resetCS,
+                managed.probeVariability.reductionCS, managed.probeVariability.extraReductionCS,
+                managed.probeScheduling.scheduleCS, managed.probeScheduling.argsCS, managed.probeScheduling.derivationCS
+            };
+
+            UINT64 hash = 14695981039346656037ull;
+            for (const ShaderBytecode& shader : shaders)
+            {
+                const BYTE* data = static_cast<const BYTE*>(shader.pData);
+                for (size_t index = 0; data != nullptr && index < shader.size; index++) hash = (hash ^ data[index]) * 1099511628211ull;
+                hash = (hash ^ shader.size) * 1099511628211ull;
+            }
+            return hash;
+        }
+    #endif
+
         //------------------------------------------------------------------------
         // Public RTXGI D3D12 Namespace Functions
         //------------------------------------------------------------------------
@@ -85,6 +479,7 @@ namespace rtxgi
             {
                 if (format == EDDGIVolumeTextureFormat::F32x2) return DXGI_FORMAT_R32G32_FLOAT;
                 else if (format == EDDGIVolumeTextureFormat::F32x4) return DXGI_FORMAT_R32G32B32A32_FLOAT;
+                else if (format == EDDGIVolumeTextureFormat::U32) return DXGI_FORMAT_R32_FLOAT;     // Packed radiance and hit distance (see ProbeRayCommon.hlsl)
             }
             else if (type == EDDGIVolumeTextureType::Irradiance)
             {
@@ -124,7 +519,10 @@ namespace rtxgi
             // 1 UAV for probe data texture array         (u3, space1)
             // 1 UAV for probe variation array            (u4, space1)
             // 1 UAV for probe variation average array    (u5, space1)
-            D3D12_DESCRIPTOR_RANGE ranges[7];
+            // 1 UAV for probe schedule buffer            (u6, space1)
+            // 1 UAV for probe SH buffer                  (u7, space1)
+            // 1 UAV for probe irradiance mips buffer     (u8, space1)
+            D3D12_DESCRIPTOR_RANGE ranges[10];
 
             // Volume Constants Structured Buffer (t0, space1)
             ranges[0].NumDescriptors = 1;
@@ -175,6 +573,27 @@ namespace rtxgi
             ranges[6].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
             ranges[6].OffsetInDescriptorsFromTableStart = heapDesc.resourceIndices.probeVariabilityAverageUAVIndex;
 
+            // Probe Schedule Buffer UAV (u6, space1)
+            ranges[7].NumDescriptors = 1;
+            ranges[7].BaseShaderRegister = 6;
+            ranges[7].RegisterSpace = 1;
+            ranges[7].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
+            ranges[7].OffsetInDescriptorsFromTableStart = heapDesc.resourceIndices.probeScheduleUAVIndex;
+
+            // Probe Spherical Harmonics Buffer UAV (u7, space1)
+            ranges[8].NumDescriptors = 1;
+            ranges[8].BaseShaderRegister = 7;
+            ranges[8].RegisterSpace = 1;
+            ranges[8].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
+            ranges[8].OffsetInDescriptorsFromTableStart = heapDesc.resourceIndices.probeSHUAVIndex;
+
+            // Probe Irradiance Mips Buffer UAV (u8, space1)
+            ranges[9].NumDescriptors = 1;
+            ranges[9].BaseShaderRegister = 8;
+            ranges[9].RegisterSpace = 1;
+            ranges[9].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
+            ranges[9].OffsetInDescriptorsFromTableStart = heapDesc.resourceIndices.probeIrradianceMipsUAVIndex;
+
             // Root Parameters
             std::vector<D3D12_ROOT_PARAMETER> rootParameters;
 
@@ -257,22 +676,55 @@ namespace rtxgi
             return ERTXGIStatus::OK;
         }
 
-        ERTXGIStatus UploadDDGIVolumeConstants(ID3D12GraphicsCommandList* cmdList, UINT bufferingIndex, UINT numVolumes, DDGIVolume** volumes)
+        ERTXGIStatus UploadDDGIVolumeConstants(ID3D12GraphicsCommandList* cmdList, UINT bufferingIndex, UINT numVolumes, DDGIVolume** volumes, const DDGIVolumeDescGPUPacked* gpuDescs)
         {
+            // Only the constants of volumes that changed since their last upload are copied. Volumes typically share the
+            // upload and device constants buffers, so the upload buffer is mapped once and copies of adjacent volumes are merged.
+            ID3D12Resource* mappedBuffer = nullptr;
+            UINT8* pMappedData = nullptr;
+
+            // Pending copy of the upload buffer to the device buffer
+            ID3D12Resource* copyDst = nullptr;
+            ID3D12Resource* copySrc = nullptr;
+            UINT64 copyDstOffset = 0;
+            UINT64 copySrcOffset = 0;
+            UINT64 copySize = 0;
+
             // Copy the constants for each volume
             for(UINT volumeIndex = 0; volumeIndex < numVolumes; volumeIndex++)
             {
                 // Get the volume
-                const DDGIVolume* volume = volumes[volumeIndex];
+                DDGIVolume* volume = volumes[volumeIndex];
 
                 // Validate the upload and device buffers
                 if (volume->GetConstantsBuffer() == nullptr) return ERTXGIStatus::ERROR_DDGI_INVALID_CONSTANTS_BUFFER;
                 if (volume->GetConstantsBufferUpload() == nullptr) return ERTXGIStatus::ERROR_DDGI_INVALID_CONSTANTS_UPLOAD_BUFFER;
 
-                // Map the constant buffer and update it
-                UINT8* pData = nullptr;
-                HRESULT hr = volume->GetConstantsBufferUpload()->Map(0, nullptr, reinterpret_cast<void**>(&pData));
-                if (FAILED(hr)) return ERTXGIStatus::ERROR_DDGI_MAP_FAILURE_CONSTANTS_UPLOAD_BUFFER;
+                // Get the packed DDGIVolume GPU descriptor
+                const DDGIVolumeDescGPUPacked gpuDesc = gpuDescs ? gpuDescs[volumeIndex] : volume->GetDescGPUPacked();
+
+            #ifdef _DEBUG
+                volume->ValidatePackedData(gpuDesc);
+            #endif
+
+                // Skip the volume if the device buffer already holds its constants
+                if (!volume->GetConstantsUploadNeeded(gpuDesc, volume->GetConstantsBuffer())) continue;
+
+                // Map the constants upload buffer (once per upload buffer)
+                if (volume->GetConstantsBufferUpload() != mappedBuffer)
+                {
+                    if (mappedBuffer) mappedBuffer->Unmap(0, nullptr);
+                    mappedBuffer = nullptr;
+
+                    HRESULT hr = volume->GetConstantsBufferUpload()->Map(0, nullptr, reinterpret_cast<void**>(&pMappedData));
+                    if (FAILED(hr))
+                    {
+                        // Don't drop the copy of volumes already marked as uploaded
+                        if (copySize > 0) cmdList->CopyBufferRegion(copyDst, copyDstOffset, copySrc, copySrcOffset, copySize);
+                        return ERTXGIStatus::ERROR_DDGI_MAP_FAILURE_CONSTANTS_UPLOAD_BUFFER;
+                    }
+                    mappedBuffer = volume->GetConstantsBufferUpload();
+                }
 
                 // Offset to the constants data to write to (e.g. double buffering)
                 UINT64 bufferOffset = volume->GetConstantsBufferSizeInBytes() * bufferingIndex;
@@ -283,29 +735,59 @@ namespace rtxgi
                 // Offset to the volume constants in the upload buffer
                 UINT64 srcOffset = (bufferOffset + volumeOffset);
 
-                // Get the packed DDGIVolume GPU descriptor
-                const DDGIVolumeDescGPUPacked gpuDesc = volume->GetDescGPUPacked();
+                memcpy(pMappedData + srcOffset, &gpuDesc, sizeof(DDGIVolumeDescGPUPacked));
+                volume->SetConstantsUploaded(gpuDesc, volume->GetConstantsBuffer());
 
-            #ifdef _DEBUG
-                volume->ValidatePackedData(gpuDesc);
-            #endif
+                // Extend the pending copy if this volume's constants directly follow it, otherwise schedule it and start a new one
+                if (copyDst == volume->GetConstantsBuffer() && copySrc == volume->GetConstantsBufferUpload()
+                    && (copyDstOffset + copySize) == volumeOffset && (copySrcOffset + copySize) == srcOffset)
+                {
+                    copySize += sizeof(DDGIVolumeDescGPUPacked);
+                    continue;
+                }
 
-                pData += srcOffset;
-                memcpy(pData, &gpuDesc, sizeof(DDGIVolumeDescGPUPacked));
+                if (copySize > 0) cmdList->CopyBufferRegion(copyDst, copyDstOffset, copySrc, copySrcOffset, copySize);
 
-                volume->GetConstantsBufferUpload()->Unmap(0, nullptr);
+                copyDst = volume->GetConstantsBuffer();
+                copySrc = volume->GetConstantsBufferUpload();
+                copyDstOffset = volumeOffset;
+                copySrcOffset = srcOffset;
+                copySize = sizeof(DDGIVolumeDescGPUPacked);
+            }
 
-                // Schedule a copy of the upload buffer to the device buffer
-                cmdList->CopyBufferRegion(volume->GetConstantsBuffer(), volumeOffset, volume->GetConstantsBufferUpload(), srcOffset, sizeof(DDGIVolumeDescGPUPacked));
+            if (mappedBuffer) mappedBuffer->Unmap(0, nullptr);
+
+            // Schedule the last copy of the upload buffer to the device buffer
+            if (copySize > 0) cmdList->CopyBufferRegion(copyDst, copyDstOffset, copySrc, copySrcOffset, copySize);
+
+            return ERTXGIStatus::OK;
+        }
+
+        ERTXGIStatus PublishDDGIVolumeProbes(ID3D12GraphicsCommandList* cmdList, UINT numVolumes, DDGIVolume** volumes)
+        {
+            if (bInsertPerfMarkers) PIXBeginEvent(cmdList, PIX_COLOR(RTXGI_PERF_MARKER_GREEN), "RTXGI DDGI Publish Probes");
+
+            for (UINT volumeIndex = 0; volumeIndex < numVolumes; volumeIndex++)
+            {
+                DDGIVolume* volume = volumes[volumeIndex];
+                if (!volume->GetProbesPublishPending() || volume->GetProbeIrradianceSRV() == volume->GetProbeIrradiance()) continue;
+
+                CopyProbesToPublished(cmdList, volume);
+                volume->SetProbesPublishPending(false);
             }
 
+            if (bInsertPerfMarkers) PIXEndEvent(cmdList);
+
             return ERTXGIStatus::OK;
         }
 
-        ERTXGIStatus UpdateDDGIVolumeProbes(ID3D12GraphicsCommandList* cmdList, UINT numVolumes, DDGIVolume* volumes)
+        ERTXGIStatus UpdateDDGIVolumeProbes(ID3D12GraphicsCommandList* cmdList, UINT numVolumes, DDGIVolume* volumes, std::vector<D3D12_RESOURCE_BARRIER>* deferredBarriers)
         {
             if (bInsertPerfMarkers) PIXBeginEvent(cmdList, PIX_COLOR(RTXGI_PERF_MARKER_GREEN), "RTXGI DDGI Update Probes");
 
+            // The next PublishDDGIVolumeProbes() copies the updated probes
+            if (volumes->GetProbeAtlasDoubleBuffered()) volumes->SetProbesPublishPending(true);
+
             std::vector<D3D12_RESOURCE_BARRIER> barriers;
 
             // Irradiance Blending
@@ -355,7 +837,15 @@ namespace rtxgi
 
                     // Set the PSO and dispatch threads
                     cmdList->SetPipelineState(volume->GetProbeBlendingIrradiancePSO());
-                    cmdList->Dispatch(probeCountX, probeCountY, probeCountZ);
+                    if (volume->GetProbeSchedulingEnabled() || volume->GetProbeBlendingActiveListEnabled())
+                    {
+                        // Blend only the probes scheduled this frame, or the active probes (one thread group per probe)
+                        cmdList->ExecuteIndirect(volume->GetProbeScheduleCommandSignature(), 1, volume->GetProbeScheduleArgs(), RTXGI_DDGI_PROBE_SCHEDULE_BLEND_ARGS_OFFSET, nullptr, 0);
+                    }
+                    else
+                    {
+                        cmdList->Dispatch(probeCountX, probeCountY, probeCountZ);
+                    }
 
                     if (bInsertPerfMarkers && volume->GetInsertPerfMarkers()) PIXEndEvent(cmdList);
                 }
@@ -367,6 +857,16 @@ namespace rtxgi
                 barriers.push_back(barrier);
                 barrier.UAV.pResource = volume->GetProbeVariability();
                 barriers.push_back(barrier);
+                if (volume->GetProbeSH())
+                {
+                    barrier.UAV.pResource = volume->GetProbeSH();
+                    barriers.push_back(barrier);
+                }
+                if (volume->GetProbeIrradianceMips())
+                {
+                    barrier.UAV.pResource = volume->GetProbeIrradianceMips();
+                    barriers.push_back(barrier);
+                }
             }
             if (bInsertPerfMarkers) PIXEndEvent(cmdList);
 
@@ -417,7 +917,15 @@ namespace rtxgi
 
                     // Set the PSO and dispatch threads
                     cmdList->SetPipelineState(volume->GetProbeBlendingDistancePSO());
-                    cmdList->Dispatch(probeCountX, probeCountY, probeCountZ);
+                    if (volume->GetProbeSchedulingEnabled() || volume->GetProbeBlendingActiveListEnabled())
+                    {
+                        // Blend only the probes scheduled this frame, or the active probes (one thread group per probe)
+                        cmdList->ExecuteIndirect(volume->GetProbeScheduleCommandSignature(), 1, volume->GetProbeScheduleArgs(), RTXGI_DDGI_PROBE_SCHEDULE_BLEND_ARGS_OFFSET, nullptr, 0);
+                    }
+                    else
+                    {
+                        cmdList->Dispatch(probeCountX, probeCountY, probeCountZ);
+                    }
 
                     if (bInsertPerfMarkers && volume->GetInsertPerfMarkers()) PIXEndEvent(cmdList);
                 }
@@ -432,17 +940,117 @@ namespace rtxgi
 
             // Barrier(s)
             // Wait for the irradiance and distance blending passes to complete before using the textures
-            if (!barriers.empty()) cmdList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+            EndPassBarriers(cmdList, barriers, deferredBarriers);
+
+            if (bInsertPerfMarkers) PIXEndEvent(cmdList);
+
+            return ERTXGIStatus::OK;
+        }
+
+        ERTXGIStatus ScheduleDDGIVolumeProbes(ID3D12GraphicsCommandList* cmdList, UINT numVolumes, DDGIVolume* volumes)
+        {
+            // Early out: probe scheduling is not enabled
+            const DDGIVolume* volume = volumes;
+            if (!volume->GetProbeSchedulingEnabled()) return ERTXGIStatus::OK;
+
+            if (bInsertPerfMarkers) PIXBeginEvent(cmdList, PIX_COLOR(RTXGI_PERF_MARKER_GREEN), "RTXGI DDGI Schedule Probes");
+
+            // Set the descriptor heap(s)
+            std::vector<ID3D12DescriptorHeap*> heaps;
+            heaps.push_back(volume->GetResourceDescriptorHeap());
+            if (volume->GetSamplerDescriptorHeap()) heaps.push_back(volume->GetSamplerDescriptorHeap());
+            cmdList->SetDescriptorHeaps((UINT)heaps.size(), heaps.data());
+
+            // Set root signature and root constants
+            cmdList->SetComputeRootSignature(volume->GetRootSignature());
+            cmdList->SetComputeRoot32BitConstants(volume->GetRootParamSlotRootConstants(), DDGIRootConstants::GetNum32BitValues(), volume->GetRootConstants().GetData(), 0);
+
+            // Set the descriptor tables (when relevant)
+            if (volume->GetBindlessEnabled())
+            {
+                // Bindless resources, using application's root signature
+                if (volume->GetBindlessType() == EBindlessType::RESOURCE_ARRAYS)
+                {
+                    // Only need to set descriptor tables when using traditional resource array bindless
+                    cmdList->SetComputeRootDescriptorTable(volume->GetRootParamSlotResourceDescriptorTable(), volume->GetResourceDescriptorHeap()->GetGPUDescriptorHandleForHeapStart());
+                    if (volume->GetSamplerDescriptorHeap()) cmdList->SetComputeRootDescriptorTable(volume->GetRootParamSlotSamplerDescriptorTable(), volume->GetSamplerDescriptorHeap()->GetGPUDescriptorHandleForHeapStart());
+                }
+            }
+            else
+            {
+                // Bound resources, using the SDK's root signature
+                cmdList->SetComputeRootDescriptorTable(volume->GetRootParamSlotResourceDescriptorTable(), volume->GetResourceDescriptorHeap()->GetGPUDescriptorHandleForHeapStart());
+            }
+
+            // Append the probes to update this frame to the schedule
+            const float groupSizeX = 32.f;
+            UINT numGroupsX = (UINT)ceil((float)volume->GetNumProbes() / groupSizeX);
+            cmdList->SetPipelineState(volume->GetProbeSchedulingPSO());
+            cmdList->Dispatch(numGroupsX, 1, 1);
+
+            // Write the trace and blend dispatch arguments
+            WriteProbeScheduleArgs(cmdList, volume);
 
             if (bInsertPerfMarkers) PIXEndEvent(cmdList);
 
             return ERTXGIStatus::OK;
         }
 
-        ERTXGIStatus RelocateDDGIVolumeProbes(ID3D12GraphicsCommandList* cmdList, UINT numVolumes, DDGIVolume* volumes)
+        ERTXGIStatus DeriveDDGIVolumeProbes(ID3D12GraphicsCommandList* cmdList, UINT numVolumes, DDGIVolume* volumes)
+        {
+            // Early out: the volume has no derivation volume
+            const DDGIVolume* volume = volumes;
+            if (!volume->GetProbeDerivationEnabled()) return ERTXGIStatus::OK;
+
+            // The derivation shader reads the derivation volume's textures bindlessly
+            if (!volume->GetBindlessEnabled()) return ERTXGIStatus::ERROR_DDGI_INVALID_RESOURCES_DESC;
+            if (volume->GetProbeDerivationPSO() == nullptr) return ERTXGIStatus::ERROR_DDGI_D3D12_INVALID_PSO_PROBE_DERIVATION;
+
+            if (bInsertPerfMarkers) PIXBeginEvent(cmdList, PIX_COLOR(RTXGI_PERF_MARKER_GREEN), "RTXGI DDGI Derive Probes");
+
+            // Set the descriptor heap(s)
+            std::vector<ID3D12DescriptorHeap*> heaps;
+            heaps.push_back(volume->GetResourceDescriptorHeap());
+            if (volume->GetSamplerDescriptorHeap()) heaps.push_back(volume->GetSamplerDescriptorHeap());
+            cmdList->SetDescriptorHeaps((UINT)heaps.size(), heaps.data());
+
+            // Set root signature and root constants
+            cmdList->SetComputeRootSignature(volume->GetRootSignature());
+            cmdList->SetComputeRoot32BitConstants(volume->GetRootParamSlotRootConstants(), DDGIRootConstants::GetNum32BitValues(), volume->GetRootConstants().GetData(), 0);
+
+            // Only need to set descriptor tables when using traditional resource array bindless
+            if (volume->GetBindlessType() == EBindlessType::RESOURCE_ARRAYS)
+            {
+                cmdList->SetComputeRootDescriptorTable(volume->GetRootParamSlotResourceDescriptorTable(), volume->GetResourceDescriptorHeap()->GetGPUDescriptorHandleForHeapStart());
+                if (volume->GetSamplerDescriptorHeap()) cmdList->SetComputeRootDescriptorTable(volume->GetRootParamSlotSamplerDescriptorTable(), volume->GetSamplerDescriptorHeap()->GetGPUDescriptorHandleForHeapStart());
+            }
+
+            // Get the number of probes on each axis
+            UINT probeCountX, probeCountY, probeCountZ;
+            GetDDGIVolumeProbeCounts(volume->GetDesc(), probeCountX, probeCountY, probeCountZ);
+
+            // One thread group per probe (like irradiance blending), groups of probes that aren't derived exit early
+            cmdList->SetPipelineState(volume->GetProbeDerivationPSO());
+            cmdList->Dispatch(probeCountX, probeCountY, probeCountZ);
+
+            // Wait for the derived texels to be written before the irradiance is used
+            D3D12_RESOURCE_BARRIER barrier = {};
+            barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+            barrier.UAV.pResource = volume->GetProbeIrradiance();
+            cmdList->ResourceBarrier(1, &barrier);
+
+            if (bInsertPerfMarkers) PIXEndEvent(cmdList);
+
+            return ERTXGIStatus::OK;
+        }
+
+        ERTXGIStatus RelocateDDGIVolumeProbes(ID3D12GraphicsCommandList* cmdList, UINT numVolumes, DDGIVolume* volumes, std::vector<D3D12_RESOURCE_BARRIER>* deferredBarriers)
         {
             if (bInsertPerfMarkers) PIXBeginEvent(cmdList, PIX_COLOR(RTXGI_PERF_MARKER_GREEN), "RTXGI DDGI Relocate Probes");
 
+            // Relocation writes the probe data
+            if (volumes->GetProbeAtlasDoubleBuffered()) volumes->SetProbesPublishPending(true);
+
             std::vector<D3D12_RESOURCE_BARRIER> barriers;
 
             D3D12_RESOURCE_BARRIER barrier = {};
@@ -531,10 +1139,20 @@ namespace rtxgi
                 }
 
                 // Probe relocation
-                float groupSizeX = 32.f;
-                UINT numGroupsX = (UINT)ceil((float)volume->GetNumProbes() / groupSizeX);
                 cmdList->SetPipelineState(volume->GetProbeRelocationPSO());
-                cmdList->Dispatch(numGroupsX, 1, 1);
+                if (volume->GetProbeFixedRaysUseWaveOps())
+                {
+                    // One thread group (wave) per probe
+                    UINT probeCountX, probeCountY, probeCountZ;
+                    GetDDGIVolumeProbeCounts(volume->GetDesc(), probeCountX, probeCountY, probeCountZ);
+                    cmdList->Dispatch(probeCountX, probeCountY, probeCountZ);
+                }
+                else
+                {
+                    float groupSizeX = 32.f;
+                    UINT numGroupsX = (UINT)ceil((float)volume->GetNumProbes() / groupSizeX);
+                    cmdList->Dispatch(numGroupsX, 1, 1);
+                }
 
                 // Add a barrier
                 barrier.UAV.pResource = volume->GetProbeData();
@@ -542,17 +1160,20 @@ namespace rtxgi
             }
 
             // Probe Relocation Barrier(s)
-            if(!barriers.empty()) cmdList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+            EndPassBarriers(cmdList, barriers, deferredBarriers);
 
             if (bInsertPerfMarkers) PIXEndEvent(cmdList);
 
             return ERTXGIStatus::OK;
         }
 
-        ERTXGIStatus ClassifyDDGIVolumeProbes(ID3D12GraphicsCommandList* cmdList, UINT numVolumes, DDGIVolume* volumes)
+        ERTXGIStatus ClassifyDDGIVolumeProbes(ID3D12GraphicsCommandList* cmdList, UINT numVolumes, DDGIVolume* volumes, std::vector<D3D12_RESOURCE_BARRIER>* deferredBarriers)
         {
             if (bInsertPerfMarkers) PIXBeginEvent(cmdList, PIX_COLOR(RTXGI_PERF_MARKER_GREEN), "RTXGI DDGI Classify Probes");
 
+            // Classification writes the probe data
+            if (volumes->GetProbeAtlasDoubleBuffered()) volumes->SetProbesPublishPending(true);
+
             UINT volumeIndex;
             std::vector<D3D12_RESOURCE_BARRIER> barriers;
 
@@ -602,6 +1223,13 @@ namespace rtxgi
                 // Add a barrier
                 barrier.UAV.pResource = volume->GetProbeData();
                 barriers.push_back(barrier);
+
+                // The reset also clears the probe state bits
+                if (volume->GetProbeStateBitsEnabled() && volume->GetProbeSchedule())
+                {
+                    barrier.UAV.pResource = volume->GetProbeSchedule();
+                    barriers.push_back(barrier);
+                }
             }
 
             // Probe Classification Reset Barrier(s)
@@ -642,29 +1270,51 @@ namespace rtxgi
                 }
 
                 // Probe classification
-                const float groupSizeX = 32.f;
-                UINT numGroupsX = (UINT)ceil((float)volume->GetNumProbes() / groupSizeX);
                 cmdList->SetPipelineState(volume->GetProbeClassificationPSO());
-                cmdList->Dispatch(numGroupsX, 1, 1);
+                if (volume->GetProbeFixedRaysUseWaveOps())
+                {
+                    // One thread group (wave) per probe
+                    UINT probeCountX, probeCountY, probeCountZ;
+                    GetDDGIVolumeProbeCounts(volume->GetDesc(), probeCountX, probeCountY, probeCountZ);
+                    cmdList->Dispatch(probeCountX, probeCountY, probeCountZ);
+                }
+                else
+                {
+                    const float groupSizeX = 32.f;
+                    UINT numGroupsX = (UINT)ceil((float)volume->GetNumProbes() / groupSizeX);
+                    cmdList->Dispatch(numGroupsX, 1, 1);
+                }
+
+                // Write the blend dispatch arguments of the active probes appended by classification (used by the next UpdateDDGIVolumeProbes())
+                if (volume->GetProbeBlendingActiveListEnabled()) WriteProbeScheduleArgs(cmdList, volume);
 
                 // Add a barrier
                 barrier.UAV.pResource = volume->GetProbeData();
                 barriers.push_back(barrier);
+
+                // Probe state bits read by irradiance sampling
+                if (volume->GetProbeStateBitsEnabled() && volume->GetProbeSchedule())
+                {
+                    barrier.UAV.pResource = volume->GetProbeSchedule();
+                    barriers.push_back(barrier);
+                }
             }
 
             // Probe Classification Barrier(s)
-            if (!barriers.empty()) cmdList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+            EndPassBarriers(cmdList, barriers, deferredBarriers);
 
             if (bInsertPerfMarkers) PIXEndEvent(cmdList);
 
             return ERTXGIStatus::OK;
         }
 
-        ERTXGIStatus CalculateDDGIVolumeVariability(ID3D12GraphicsCommandList* cmdList, UINT numVolumes, DDGIVolume* volumes)
+        ERTXGIStatus CalculateDDGIVolumeVariability(ID3D12GraphicsCommandList* cmdList, UINT bufferingIndex, UINT numVolumes, DDGIVolume* volumes, std::vector<D3D12_RESOURCE_BARRIER>* deferredBarriers)
         {
+            if (bufferingIndex >= RTXGI_DDGI_VARIABILITY_READBACK_BUFFERS) return ERTXGIStatus::ERROR_DDGI_INVALID_BUFFERING_INDEX;
+
             if (bInsertPerfMarkers) PIXBeginEvent(cmdList, PIX_COLOR(RTXGI_PERF_MARKER_GREEN), "Probe Variability Calculation");
 
-            const DDGIVolume* volume = volumes;
+            DDGIVolume* volume = volumes;
             if (volume->GetProbeVariabilityEnabled())
             {
                 // Set the descriptor heap(s)
@@ -746,8 +1396,11 @@ namespace rtxgi
                 reductionBarrier.UAV.pResource = volume->GetProbeVariabilityAverage();
                 cmdList->ResourceBarrier(1, &reductionBarrier);
 
+                // The single pass reduction's last thread group already averaged the values down to a single value
+                bool singlePass = volume->GetProbeVariabilityUseSinglePassReduction() && (volume->GetProbeSchedule() != nullptr);
+
                 // Extra reduction passes average values in variability texture down to single value
-                while (inputTexelsX > 1 || inputTexelsY > 1 || inputTexelsZ > 1)
+                while (!singlePass && (inputTexelsX > 1 || inputTexelsY > 1 || inputTexelsZ > 1))
                 {
                     if (bInsertPerfMarkers && volume->GetInsertPerfMarkers())
                     {
@@ -811,7 +1464,7 @@ namespace rtxgi
 
                 if (volume->GetProbeVariabilityEnabled())
                 {
-
+                    // Copy the average to the buffering index's slot, read back once the frame completes
                     D3D12_TEXTURE_COPY_LOCATION copyLocSrc = {};
                     copyLocSrc.pResource = volume->GetProbeVariabilityAverage();
                     copyLocSrc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
@@ -820,7 +1473,7 @@ namespace rtxgi
                     D3D12_TEXTURE_COPY_LOCATION copyLocDst = {};
                     copyLocDst.pResource = volume->GetProbeVariabilityReadback();
                     copyLocDst.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
-                    copyLocDst.PlacedFootprint.Offset = 0;
+                    copyLocDst.PlacedFootprint.Offset = static_cast<UINT64>(D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT) * bufferingIndex;
                     copyLocDst.PlacedFootprint.Footprint.Width = 1;
                     copyLocDst.PlacedFootprint.Footprint.Height = 1;
                     copyLocDst.PlacedFootprint.Footprint.Depth = 1;
@@ -829,12 +1482,13 @@ namespace rtxgi
 
                     D3D12_BOX box = { 0, 0, 0, 1, 1, 1};
                     cmdList->CopyTextureRegion(&copyLocDst, 0, 0, 0, &copyLocSrc, &box);
+                    volume->SetProbeVariabilityReadbackValid(bufferingIndex, true);
 
                     afterBarrier.Transition.pResource = volume->GetProbeVariabilityAverage();
                     barriers.push_back(afterBarrier);
                 }
 
-                if (!barriers.empty()) cmdList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+                EndPassBarriers(cmdList, barriers, deferredBarriers);
             }
 
             if (bInsertPerfMarkers) PIXEndEvent(cmdList);
@@ -842,27 +1496,126 @@ namespace rtxgi
             return ERTXGIStatus::OK;
         }
 
-        ERTXGIStatus ReadbackDDGIVolumeVariability(UINT numVolumes, DDGIVolume* volumes)
+        ERTXGIStatus ReadbackDDGIVolumeVariability(UINT bufferingIndex, UINT numVolumes, DDGIVolume* volumes)
         {
+            if (bufferingIndex >= RTXGI_DDGI_VARIABILITY_READBACK_BUFFERS) return ERTXGIStatus::ERROR_DDGI_INVALID_BUFFERING_INDEX;
+
             DDGIVolume* volume = volumes;
-            if (volume->GetProbeVariabilityEnabled())
+            if (volume->GetProbeVariabilityEnabled() && volume->GetProbeVariabilityReadbackValid(bufferingIndex))
             {
                 // Get the probe variability readback buffer
                 ID3D12Resource* readback = volume->GetProbeVariabilityReadback();
 
-                // Read the first 32-bits of the readback buffer
-                float* pMappedMemory = nullptr;
-                D3D12_RANGE readRange = { 0, sizeof(float) };
+                // Read the first 32-bits of the buffering index's slot
+                SIZE_T offset = static_cast<SIZE_T>(D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT) * bufferingIndex;
+                UINT8* pMappedMemory = nullptr;
+                D3D12_RANGE readRange = { offset, offset + sizeof(float) };
                 D3D12_RANGE writeRange = {};
                 HRESULT hr = readback->Map(0, &readRange, (void**)&pMappedMemory);
                 if (FAILED(hr)) return ERTXGIStatus::ERROR_DDGI_MAP_FAILURE_VARIABILITY_READBACK_BUFFER;
-                float value = pMappedMemory[0];
+                float value = 0.f;
+                memcpy(&value, pMappedMemory + offset, sizeof(float));
                 readback->Unmap(0, &writeRange);
 
-                volume->SetVolumeAverageVariability(value);
+                volume->SetProbeVariabilityReadbackValid(bufferingIndex, false);
+                volume->SetVolumeAverageVariability(value);
+            }
+            return ERTXGIStatus::OK;
+        }
+
+    #if RTXGI_DDGI_RESOURCE_MANAGEMENT
+        ERTXGIStatus UpdateDDGIVolumeSparseTiles(ID3D12CommandQueue* queue, ID3D12GraphicsCommandList* cmdList, UINT bufferingIndex, UINT numVolumes, DDGIVolume** volumes)
+        {
+            if (bInsertPerfMarkers) PIXBeginEvent(cmdList, PIX_COLOR(RTXGI_PERF_MARKER_GREEN), "RTXGI DDGI Sparse Tiles");
+
+            ERTXGIStatus result = ERTXGIStatus::OK;
+            for (UINT volumeIndex = 0; volumeIndex < numVolumes; volumeIndex++)
+            {
+                // Does nothing for volumes without sparse probe textures
+                result = volumes[volumeIndex]->UpdateSparseTiles(queue, cmdList, bufferingIndex);
+                if (result != ERTXGIStatus::OK) break;
+            }
+
+            if (bInsertPerfMarkers) PIXEndEvent(cmdList);
+
+            return result;
+        }
+
+        ERTXGIStatus CreateDDGIVolumeResourcePool(ID3D12Device* device, const DDGIVolumeResourcePoolDesc& desc, DDGIVolumeResourcePool** pool)
+        {
+            if (device == nullptr) return ERTXGIStatus::ERROR_DDGI_D3D12_INVALID_DEVICE;
+            if (pool == nullptr || desc.heapSizeInBytes == 0) return ERTXGIStatus::ERROR_DDGI_ALLOCATE_FAILURE_RESOURCE_POOL;
+
+            *pool = new DDGIVolumeResourcePool();
+            (*pool)->device = device;
+            (*pool)->desc = desc;
+            (*pool)->desc.heapSizeInBytes = RTXGI_ALIGN(D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT, desc.heapSizeInBytes);
+
+            return ERTXGIStatus::OK;
+        }
+
+        void DestroyDDGIVolumeResourcePool(DDGIVolumeResourcePool*& pool)
+        {
+            if (pool == nullptr) return;
+
+            // Destroy the recycled volumes
+            for (DDGIVolume* volume : pool->volumes)
+            {
+                volume->Destroy();
+                delete volume;
+            }
+            pool->volumes.clear();
+
+            // Other volumes should be destroyed first, release what they left behind
+            for (DDGIVolumePoolResource& entry : pool->resources) RTXGI_SAFE_RELEASE(entry.resource);
+            for (DDGIVolumePoolHeap& heap : pool->heaps) RTXGI_SAFE_RELEASE(heap.heap);
+
+            delete pool;
+            pool = nullptr;
+        }
+
+        UINT64 GetDDGIVolumeResourcePoolSizeInBytes(const DDGIVolumeResourcePool* pool)
+        {
+            UINT64 size = 0;
+            if (pool == nullptr) return size;
+            for (const DDGIVolumePoolHeap& heap : pool->heaps) size += heap.size;
+            return size;
+        }
+
+        bool RecycleDDGIVolume(DDGIVolumeResourcePool* pool, DDGIVolume*& volume)
+        {
+            if (pool == nullptr || volume == nullptr) return false;
+            if (pool->desc.maxRecycledVolumes == 0 || volume->GetResourcePool() != pool) return false;
+
+            pool->volumes.push_back(volume);
+            volume = nullptr;
+
+            // Destroy the oldest volumes beyond the pool's limit
+            while ((UINT)pool->volumes.size() > pool->desc.maxRecycledVolumes)
+            {
+                pool->volumes.front()->Destroy();
+                delete pool->volumes.front();
+                pool->volumes.erase(pool->volumes.begin());
+            }
+            return true;
+        }
+
+        DDGIVolume* AcquireDDGIVolume(DDGIVolumeResourcePool* pool, const DDGIVolumeDesc& desc)
+        {
+            if (pool == nullptr) return nullptr;
+
+            // Take the most recently recycled volume of the size class
+            for (size_t index = pool->volumes.size(); index > 0; index--)
+            {
+                DDGIVolume* volume = pool->volumes[index - 1];
+                if (!IsSameSizeClass(volume->GetDesc(), desc)) continue;
+
+                pool->volumes.erase(pool->volumes.begin() + (index - 1));
+                return volume;
             }
-            return ERTXGIStatus::OK;
+            return nullptr;
         }
+    #endif
 
         //------------------------------------------------------------------------
         // Private DDGIVolume Functions
@@ -884,17 +1637,26 @@ namespace rtxgi
             RTXGI_SAFE_RELEASE(m_probeClassificationResetPSO);
             RTXGI_SAFE_RELEASE(m_probeVariabilityReductionPSO);
             RTXGI_SAFE_RELEASE(m_probeVariabilityExtraReductionPSO);
+            RTXGI_SAFE_RELEASE(m_probeSchedulingPSO);
+            RTXGI_SAFE_RELEASE(m_probeSchedulingArgsPSO);
+            RTXGI_SAFE_RELEASE(m_probeDerivationPSO);
+            RTXGI_SAFE_RELEASE(m_probeScheduleCommandSignature);
         }
 
         ERTXGIStatus DDGIVolume::CreateManagedResources(const DDGIVolumeDesc& desc, const DDGIVolumeManagedResourcesDesc& managed)
         {
             bool deviceChanged = IsDeviceChanged(managed);
 
+            // Recycled and recreated volumes keep their pipeline state objects unless the shaders changed
+            UINT64 shaderHash = GetShaderBytecodeHash(managed);
+            bool shadersChanged = (shaderHash != m_shaderHash);
+
             // Create the root signature and pipeline state objects
-            if (deviceChanged)
+            if (deviceChanged || shadersChanged)
             {
-                // The device may have changed, release resources on that device
+                // The device or shaders may have changed, release the existing resources
                 if (m_device != nullptr) ReleaseManagedResources();
+                m_shaderHash = shaderHash;
 
                 // Store the handle to the new device
                 m_device = managed.device;
@@ -942,10 +1704,53 @@ namespace rtxgi
                     managed.probeVariability.extraReductionCS,
                     &m_probeVariabilityExtraReductionPSO,
                     "Probe Variability Extra Reduction")) return ERTXGIStatus::ERROR_DDGI_D3D12_CREATE_FAILURE_PSO;
+
+                // Probe scheduling is optional, only create its pipeline state objects when the bytecode is provided
+                if (ValidateShaderBytecode(managed.probeScheduling.scheduleCS) && ValidateShaderBytecode(managed.probeScheduling.argsCS))
+                {
+                    if (!CreateComputePSO(
+                        managed.probeScheduling.scheduleCS,
+                        &m_probeSchedulingPSO,
+                        "Probe Scheduling")) return ERTXGIStatus::ERROR_DDGI_D3D12_CREATE_FAILURE_PSO;
+
+                    if (!CreateComputePSO(
+                        managed.probeScheduling.argsCS,
+                        &m_probeSchedulingArgsPSO,
+                        "Probe Scheduling Arguments")) return ERTXGIStatus::ERROR_DDGI_D3D12_CREATE_FAILURE_PSO;
+
+                    if (!CreateProbeScheduleCommandSignature()) return ERTXGIStatus::ERROR_DDGI_D3D12_CREATE_FAILURE_COMMAND_SIGNATURE;
+                }
+
+                // Probe derivation is optional too
+                if (ValidateShaderBytecode(managed.probeScheduling.derivationCS))
+                {
+                    if (!CreateComputePSO(
+                        managed.probeScheduling.derivationCS,
+                        &m_probeDerivationPSO,
+                        "Probe Derivation")) return ERTXGIStatus::ERROR_DDGI_D3D12_CREATE_FAILURE_PSO;
+                }
+            }
+
+            // Sparse probe textures need tiled resources (tier 2 reads unmapped tiles as zero) and heaps that hold any texture type
+            if (desc.probeSparseTexturesEnabled)
+            {
+                D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+                HRESULT hr = m_device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options));
+                if (FAILED(hr)) return ERTXGIStatus::ERROR_DDGI_SPARSE_TEXTURES_UNSUPPORTED;
+                if (options.TiledResourcesTier < D3D12_TILED_RESOURCES_TIER_2) return ERTXGIStatus::ERROR_DDGI_SPARSE_TEXTURES_UNSUPPORTED;
+                if (options.ResourceHeapTier < D3D12_RESOURCE_HEAP_TIER_2) return ERTXGIStatus::ERROR_DDGI_SPARSE_TEXTURES_UNSUPPORTED;
+            }
+
+            // Probe textures stay in the pool they were placed in, move them when the pool changes
+            bool poolChanged = (managed.pool != m_pool);
+            if (poolChanged)
+            {
+                ReleaseTextures();
+                m_pool = managed.pool;
             }
 
             // Create the textures
-            if (deviceChanged || m_desc.ShouldAllocateProbes(desc))
+            if (deviceChanged || poolChanged || m_desc.ShouldAllocateProbes(desc))
             {
                 // Probe counts have changed. The texture arrays are the wrong size or aren't allocated yet.
                 // (Re)allocate the probe ray data, irradiance, distance, data, and variability textures.
@@ -955,6 +1760,21 @@ namespace rtxgi
                 if (!CreateProbeData(desc)) return ERTXGIStatus::ERROR_DDGI_ALLOCATE_FAILURE_TEXTURE_PROBE_DATA;
                 if (!CreateProbeVariability(desc)) return ERTXGIStatus::ERROR_DDGI_ALLOCATE_FAILURE_TEXTURE_PROBE_VARIABILITY;
                 if (!CreateProbeVariabilityAverage(desc)) return ERTXGIStatus::ERROR_DDGI_ALLOCATE_FAILURE_TEXTURE_PROBE_VARIABILITY_AVERAGE;
+
+                // The probe schedule holds one entry per probe (and the single pass reduction's thread group counter, the probe state bits, and the probe visibility masks)
+                if ((m_probeSchedulingPSO || desc.probeVariabilityUseSinglePassReduction || desc.probeStateBitsEnabled || desc.probeVisibilityMaskEnabled) && !CreateProbeSchedule(desc)) return ERTXGIStatus::ERROR_DDGI_ALLOCATE_FAILURE_BUFFER_PROBE_SCHEDULE;
+
+                // The probe SH buffer holds the spherical harmonics coefficients of each probe
+                if ((desc.probeIrradianceEncoding != EDDGIVolumeProbeIrradianceEncoding::Octahedral) && !CreateProbeSH(desc)) return ERTXGIStatus::ERROR_DDGI_ALLOCATE_FAILURE_BUFFER_PROBE_SH;
+
+                // The probe irradiance mips buffer holds the pre-filtered irradiance of each probe
+                if (desc.probeIrradianceMipsEnabled && !CreateProbeIrradianceMips(desc)) return ERTXGIStatus::ERROR_DDGI_ALLOCATE_FAILURE_BUFFER_PROBE_IRRADIANCE_MIPS;
+
+                // The new probe textures start without resident tiles
+                if (!CreateSparseResidency(desc)) return ERTXGIStatus::ERROR_DDGI_ALLOCATE_FAILURE_SPARSE_RESIDENCY;
+
+                // The published copies of the probe textures (when double buffered)
+                if (!CreateProbesPublished(desc)) return ERTXGIStatus::ERROR_DDGI_ALLOCATE_FAILURE_TEXTURE_PROBE_IRRADIANCE;
             }
             else
             {
@@ -975,6 +1795,21 @@ namespace rtxgi
                     // The number of distance texels per probe has changed. Reallocate the distance texture array.
                     if (!CreateProbeDistance(desc)) return ERTXGIStatus::ERROR_DDGI_ALLOCATE_FAILURE_TEXTURE_PROBE_DISTANCE;
                 }
+
+                if (m_desc.ShouldAllocateIrradiance(desc) || m_desc.ShouldAllocateDistance(desc))
+                {
+                    // The reallocated probe textures start without resident tiles
+                    if (!CreateSparseResidency(desc)) return ERTXGIStatus::ERROR_DDGI_ALLOCATE_FAILURE_SPARSE_RESIDENCY;
+
+                    // The published copies match the probe textures' dimensions
+                    if (!CreateProbesPublished(desc)) return ERTXGIStatus::ERROR_DDGI_ALLOCATE_FAILURE_TEXTURE_PROBE_IRRADIANCE;
+                }
+
+                if (desc.probeIrradianceMipsEnabled && m_probeIrradianceMips == nullptr)
+                {
+                    // Irradiance mips were enabled on an existing volume. Allocate the irradiance mips buffer.
+                    if (!CreateProbeIrradianceMips(desc)) return ERTXGIStatus::ERROR_DDGI_ALLOCATE_FAILURE_BUFFER_PROBE_IRRADIANCE_MIPS;
+                }
             }
 
             return ERTXGIStatus::OK;
@@ -999,6 +1834,23 @@ namespace rtxgi
             m_probeVariabilityAverage = unmanaged.probeVariabilityAverage;
             m_probeVariabilityReadback = unmanaged.probeVariabilityReadback;
 
+            // Probe Scheduling
+            m_probeSchedule = unmanaged.probeSchedule;
+            m_probeScheduleArgs = unmanaged.probeScheduleArgs;
+            m_probeScheduleCommandSignature = unmanaged.probeScheduleCommandSignature;
+
+            // Probe Spherical Harmonics
+            m_probeSH = unmanaged.probeSH;
+
+            // Probe Irradiance Mips
+            m_probeIrradianceMips = unmanaged.probeIrradianceMips;
+
+            // Published Texture Arrays
+            m_probeIrradiancePublished = unmanaged.probeIrradiancePublished;
+            m_probeDistancePublished = unmanaged.probeDistancePublished;
+            m_probeDataPublished = unmanaged.probeDataPublished;
+            m_probesPublishPending = (m_probeIrradiancePublished != nullptr);
+
             // Render Target Views
             m_probeIrradianceRTV = unmanaged.probeIrradianceRTV;
             m_probeDistanceRTV = unmanaged.probeDistanceRTV;
@@ -1012,6 +1864,9 @@ namespace rtxgi
             m_probeClassificationResetPSO = unmanaged.probeClassification.resetPSO;
             m_probeVariabilityReductionPSO = unmanaged.probeVariabilityPSOs.reductionPSO;
             m_probeVariabilityExtraReductionPSO = unmanaged.probeVariabilityPSOs.extraReductionPSO;
+            m_probeSchedulingPSO = unmanaged.probeScheduling.schedulePSO;
+            m_probeSchedulingArgsPSO = unmanaged.probeScheduling.argsPSO;
+            m_probeDerivationPSO = unmanaged.probeScheduling.derivationPSO;
         }
     #endif
 
@@ -1024,6 +1879,9 @@ namespace rtxgi
             // Validate the probe counts
             if (desc.probeCounts.x <= 0 || desc.probeCounts.y <= 0 || desc.probeCounts.z <= 0) return ERTXGIStatus::ERROR_DDGI_INVALID_PROBE_COUNTS;
 
+            // Validate the probe ray count, it is packed in 13 bits of the GPU volume desc (see PackDDGIVolumeDescGPU())
+            if (desc.probeNumRays < 1 || desc.probeNumRays > 8191) return ERTXGIStatus::ERROR_DDGI_INVALID_PROBE_NUM_RAYS;
+
             // Validate the resource descriptor heap
             if (resources.descriptorHeap.resources == nullptr) return ERTXGIStatus::ERROR_DDGI_D3D12_INVALID_RESOURCE_DESCRIPTOR_HEAP;
 
@@ -1040,12 +1898,17 @@ namespace rtxgi
             if (resources.managed.enabled && resources.unmanaged.enabled) return ERTXGIStatus::ERROR_DDGI_INVALID_RESOURCES_DESC;
             if (!resources.managed.enabled && !resources.unmanaged.enabled) return ERTXGIStatus::ERROR_DDGI_INVALID_RESOURCES_DESC;
 
+        #if !RTXGI_DDGI_RESOURCE_MANAGEMENT
+            // Sparse probe textures are allocated and mapped by the SDK
+            if (desc.probeSparseTexturesEnabled) return ERTXGIStatus::ERROR_DDGI_SPARSE_TEXTURES_UNSUPPORTED;
+        #endif
+
             // Validate the resources
             ERTXGIStatus result = ERTXGIStatus::OK;
         #if RTXGI_DDGI_RESOURCE_MANAGEMENT
-            result = ValidateManagedResourcesDesc(resources.managed);
+            result = ValidateManagedResourcesDesc(resources.managed, desc.probeSchedulingEnabled || desc.probeBlendingActiveOnly);
         #else
-            result = ValidateUnmanagedResourcesDesc(resources.unmanaged);
+            result = ValidateUnmanagedResourcesDesc(resources.unmanaged, desc.probeSchedulingEnabled || desc.probeBlendingActiveOnly, desc.probeIrradianceEncoding != EDDGIVolumeProbeIrradianceEncoding::Octahedral, desc.probeIrradianceMipsEnabled, desc.probeAtlasDoubleBuffered);
         #endif
             if (result != ERTXGIStatus::OK) return result;
 
@@ -1071,6 +1934,12 @@ namespace rtxgi
             // Store the new volume descriptor
             m_desc = desc;
 
+            // Upload the constants on the next UploadDDGIVolumeConstants() call
+            ResetConstantsUploaded();
+
+            // Relocate and classify every probe while the new probes settle
+            OnLargeObjectChange();
+
         #if RTXGI_DDGI_RESOURCE_MANAGEMENT
             // Create the resource descriptors
             if (!CreateDescriptors()) return ERTXGIStatus::ERROR_DDGI_D3D12_CREATE_FAILURE_DESCRIPTORS;
@@ -1132,11 +2001,288 @@ namespace rtxgi
             // Wait for the transitions
             cmdList->ResourceBarrier(2, barriers);
 
+            // Publish the cleared probes right away, sampling shouldn't see the probes from before the clear
+            if (m_probeIrradiancePublished)
+            {
+                CopyProbesToPublished(cmdList, this);
+                m_probesPublishPending = false;
+            }
+
             if (bInsertPerfMarkers) PIXEndEvent(cmdList);
 
             return ERTXGIStatus::OK;
         }
 
+    #if RTXGI_DDGI_RESOURCE_MANAGEMENT
+        ERTXGIStatus DDGIVolume::UpdateSparseTiles(ID3D12CommandQueue* queue, ID3D12GraphicsCommandList* cmdList, UINT bufferingIndex)
+        {
+            DDGIVolumeSparseResidency* sparse = m_sparseResidency;
+            if (sparse == nullptr) return ERTXGIStatus::OK;
+            if (bufferingIndex >= RTXGI_DDGI_SPARSE_READBACK_BUFFERS) return ERTXGIStatus::ERROR_DDGI_INVALID_BUFFERING_INDEX;
+
+            ERTXGIStatus result = ERTXGIStatus::OK;
+
+            D3D12_RESOURCE_DESC probeDataDesc = m_probeData->GetDesc();
+            UINT probesX = (UINT)probeDataDesc.Width;
+            UINT probesY = probeDataDesc.Height;
+            UINT arraySize = probeDataDesc.DepthOrArraySize;
+
+            UINT64 readbackOffset = (sparse->probeDataReadbackSize * bufferingIndex);
+
+            // Update the tile mappings from the probe states copied RTXGI_DDGI_SPARSE_READBACK_BUFFERS calls ago
+            if (sparse->probeDataReadbackValid[bufferingIndex])
+            {
+                // Map the probe data copy
+                UINT8* pMappedMemory = nullptr;
+                D3D12_RANGE readRange = { (SIZE_T)readbackOffset, (SIZE_T)(readbackOffset + sparse->probeDataReadbackSize) };
+                D3D12_RANGE writeRange = {};
+                HRESULT hr = sparse->probeDataReadback->Map(0, &readRange, (void**)&pMappedMemory);
+                if (FAILED(hr)) return ERTXGIStatus::ERROR_DDGI_MAP_FAILURE_PROBE_DATA_READBACK_BUFFER;
+
+                // Read the probe states (W channel), active probes store RTXGI_DDGI_PROBE_STATE_ACTIVE (0)
+                bool halfPrecision = (m_desc.probeDataFormat == EDDGIVolumeTextureFormat::F16x4);
+                UINT bytesPerTexel = halfPrecision ? 8 : 16;
+
+                std::vector<UINT8> activeProbes(probesX * probesY * arraySize);
+                for (UINT slice = 0; slice < arraySize; slice++)
+                {
+                    const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& footprint = sparse->probeDataFootprints[slice];
+                    for (UINT y = 0; y < probesY; y++)
+                    {
+                        const UINT8* pRow = pMappedMemory + readbackOffset + footprint.Offset + (y * footprint.Footprint.RowPitch);
+                        for (UINT x = 0; x < probesX; x++)
+                        {
+                            const UINT8* pState = pRow + (x * bytesPerTexel) + (bytesPerTexel / 4) * 3;
+
+                            bool active = false;
+                            if (halfPrecision)
+                            {
+                                UINT16 state = 0;
+                                memcpy(&state, pState, sizeof(UINT16));
+                                active = ((state & 0x7FFF) == 0);
+                            }
+                            else
+                            {
+                                float state = 0.f;
+                                memcpy(&state, pState, sizeof(float));
+                                active = (state == 0.f);
+                            }
+                            activeProbes[(slice * probesY + y) * probesX + x] = active ? 1 : 0;
+                        }
+                    }
+                }
+
+                sparse->probeDataReadback->Unmap(0, &writeRange);
+
+                D3D12_TILE_REGION_SIZE tileRegion = {};
+                tileRegion.NumTiles = 1;
+
+                // Newly mapped irradiance and distance tiles, per array slice
+                std::vector<std::vector<D3D12_RECT>> clearRects(arraySize * 2);
+                bool clear = false;
+
+                for (UINT textureIndex = 0; textureIndex < 3; textureIndex++)
+                {
+                    DDGIVolumeSparseTexture& texture = sparse->textures[textureIndex];
+                    if (texture.resource == nullptr) continue;
+
+                    D3D12_RESOURCE_DESC textureDesc = texture.resource->GetDesc();
+                    UINT tileWidth = texture.tileShape.WidthInTexels;
+                    UINT tileHeight = texture.tileShape.HeightInTexels;
+
+                    std::vector<D3D12_TILED_RESOURCE_COORDINATE> unmapCoords;
+                    std::vector<D3D12_TILED_RESOURCE_COORDINATE> mapCoords;
+                    std::vector<UINT> mapTiles;
+
+                    for (UINT slice = 0; slice < arraySize; slice++)
+                    {
+                        for (UINT tileY = 0; tileY < texture.tilesY; tileY++)
+                        {
+                            for (UINT tileX = 0; tileX < texture.tilesX; tileX++)
+                            {
+                                // Find the probes the tile covers
+                                UINT probeX0 = (tileX * tileWidth) / texture.probeTexels;
+                                UINT probeX1 = (std::min)(((tileX + 1) * tileWidth + texture.probeTexels - 1) / texture.probeTexels, probesX);
+                                UINT probeY0 = (tileY * tileHeight) / texture.probeTexels;
+                                UINT probeY1 = (std::min)(((tileY + 1) * tileHeight + texture.probeTexels - 1) / texture.probeTexels, probesY);
+
+                                // The tile is resident if any of its probes is active
+                                bool resident = false;
+                                for (UINT probeY = probeY0; probeY < probeY1 && !resident; probeY++)
+                                {
+                                    for (UINT probeX = probeX0; probeX < probeX1 && !resident; probeX++)
+                                    {
+                                        resident = (activeProbes[(slice * probesY + probeY) * probesX + probeX] != 0);
+                                    }
+                                }
+
+                                UINT& heapTile = texture.tiles[(slice * texture.tilesY + tileY) * texture.tilesX + tileX];
+                                if (resident == (heapTile != RTXGI_DDGI_SPARSE_TILE_UNMAPPED)) continue;
+
+                                D3D12_TILED_RESOURCE_COORDINATE coord = { tileX, tileY, 0, slice };
+                                if (!resident)
+                                {
+                                    // Return the tile's memory to the free list
+                                    sparse->freeTiles.push_back(heapTile);
+                                    heapTile = RTXGI_DDGI_SPARSE_TILE_UNMAPPED;
+                                    unmapCoords.push_back(coord);
+                                    continue;
+                                }
+
+                                // Assign memory to the tile, creating its heap if necessary
+                                UINT freeTile = sparse->freeTiles.back();
+                                ID3D12Heap*& heap = sparse->heaps[freeTile / RTXGI_DDGI_SPARSE_TILES_PER_HEAP];
+                                if (heap == nullptr)
+                                {
+                                    D3D12_HEAP_DESC heapDesc = {};
+                                    heapDesc.SizeInBytes = (RTXGI_DDGI_SPARSE_TILES_PER_HEAP * D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES);
+                                    heapDesc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+                                    heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+                                    heapDesc.Flags = D3D12_HEAP_FLAG_NONE;
+
+                                    hr = m_device->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap));
+                                    if (FAILED(hr))
+                                    {
+                                        // Leave the tile unmapped, update the other tiles and report the failure
+                                        heap = nullptr;
+                                        result = ERTXGIStatus::ERROR_DDGI_ALLOCATE_FAILURE_SPARSE_RESIDENCY;
+                                        continue;
+                                    }
+                                }
+                                sparse->freeTiles.pop_back();
+
+                                heapTile = freeTile;
+                                mapCoords.push_back(coord);
+                                mapTiles.push_back(freeTile);
+
+                                if (textureIndex < 2)
+                                {
+                                    D3D12_RECT rect;
+                                    rect.left = (LONG)(tileX * tileWidth);
+                                    rect.top = (LONG)(tileY * tileHeight);
+                                    rect.right = (LONG)(std::min)((UINT64)((tileX + 1) * tileWidth), textureDesc.Width);
+                                    rect.bottom = (LONG)(std::min)((tileY + 1) * tileHeight, textureDesc.Height);
+                                    clearRects[textureIndex * arraySize + slice].push_back(rect);
+                                    clear = true;
+                                }
+                            }
+                        }
+                    }
+
+                    // Unmap the tiles without active probes (before their memory is mapped elsewhere)
+                    if (!unmapCoords.empty())
+                    {
+                        std::vector<D3D12_TILE_REGION_SIZE> regionSizes(unmapCoords.size(), tileRegion);
+                        D3D12_TILE_RANGE_FLAGS rangeFlags = D3D12_TILE_RANGE_FLAG_NULL;
+                        queue->UpdateTileMappings(texture.resource, (UINT)unmapCoords.size(), unmapCoords.data(), regionSizes.data(), nullptr, 1, &rangeFlags, nullptr, nullptr, D3D12_TILE_MAPPING_FLAG_NONE);
+                    }
+
+                    // Map memory to the tiles with active probes, one call per heap
+                    for (UINT heapIndex = 0; heapIndex < (UINT)sparse->heaps.size(); heapIndex++)
+                    {
+                        std::vector<D3D12_TILED_RESOURCE_COORDINATE> coords;
+                        std::vector<UINT> heapOffsets;
+                        for (size_t mapIndex = 0; mapIndex < mapCoords.size(); mapIndex++)
+                        {
+                            if ((mapTiles[mapIndex] / RTXGI_DDGI_SPARSE_TILES_PER_HEAP) != heapIndex) continue;
+                            coords.push_back(mapCoords[mapIndex]);
+                            heapOffsets.push_back(mapTiles[mapIndex] % RTXGI_DDGI_SPARSE_TILES_PER_HEAP);
+                        }
+                        if (coords.empty()) continue;
+
+                        std::vector<D3D12_TILE_REGION_SIZE> regionSizes(coords.size(), tileRegion);
+                        std::vector<D3D12_TILE_RANGE_FLAGS> rangeFlags(coords.size(), D3D12_TILE_RANGE_FLAG_NONE);
+                        std::vector<UINT> rangeTileCounts(coords.size(), 1);
+                        queue->UpdateTileMappings(texture.resource, (UINT)coords.size(), coords.data(), regionSizes.data(), sparse->heaps[heapIndex], (UINT)coords.size(), rangeFlags.data(), heapOffsets.data(), rangeTileCounts.data(), D3D12_TILE_MAPPING_FLAG_NONE);
+                    }
+                }
+
+                // Clear the newly mapped irradiance and distance tiles, their memory holds stale data
+                if (clear)
+                {
+                    D3D12_RESOURCE_BARRIER barriers[2] = {};
+                    barriers[0].Transition.pResource = m_probeIrradiance;
+                    barriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+                    barriers[0].Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
+                    barriers[0].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+
+                    barriers[1].Transition.pResource = m_probeDistance;
+                    barriers[1].Transition.StateBefore = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+                    barriers[1].Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
+                    barriers[1].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+
+                    cmdList->ResourceBarrier(2, barriers);
+
+                    float values[4] = { 0.f, 0.f, 0.f, 1.f };
+
+                    D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = sparse->rtvDescriptorHeap->GetCPUDescriptorHandleForHeapStart();
+                    for (UINT rtvIndex = 0; rtvIndex < (UINT)clearRects.size(); rtvIndex++)
+                    {
+                        if (!clearRects[rtvIndex].empty())
+                        {
+                            cmdList->ClearRenderTargetView(rtvHandle, values, (UINT)clearRects[rtvIndex].size(), clearRects[rtvIndex].data());
+                        }
+                        rtvHandle.ptr += sparse->rtvDescriptorSize;
+                    }
+
+                    barriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
+                    barriers[0].Transition.StateAfter = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+
+                    barriers[1].Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
+                    barriers[1].Transition.StateAfter = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+
+                    cmdList->ResourceBarrier(2, barriers);
+                }
+            }
+
+            // Copy the probe states for the call RTXGI_DDGI_SPARSE_READBACK_BUFFERS calls from now
+            D3D12_RESOURCE_BARRIER barrier = {};
+            barrier.Transition.pResource = m_probeData;
+            barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+            barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
+            barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+            cmdList->ResourceBarrier(1, &barrier);
+
+            for (UINT slice = 0; slice < arraySize; slice++)
+            {
+                D3D12_TEXTURE_COPY_LOCATION copyLocSrc = {};
+                copyLocSrc.pResource = m_probeData;
+                copyLocSrc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+                copyLocSrc.SubresourceIndex = slice;
+
+                D3D12_TEXTURE_COPY_LOCATION copyLocDst = {};
+                copyLocDst.pResource = sparse->probeDataReadback;
+                copyLocDst.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+                copyLocDst.PlacedFootprint = sparse->probeDataFootprints[slice];
+                copyLocDst.PlacedFootprint.Offset += readbackOffset;
+
+                cmdList->CopyTextureRegion(&copyLocDst, 0, 0, 0, &copyLocSrc, nullptr);
+            }
+
+            barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE;
+            barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+            cmdList->ResourceBarrier(1, &barrier);
+
+            sparse->probeDataReadbackValid[bufferingIndex] = true;
+
+            return result;
+        }
+    #endif
+
+    #if RTXGI_DDGI_RESOURCE_MANAGEMENT
+        void DDGIVolume::AliasProbeRayData(ID3D12GraphicsCommandList* cmdList) const
+        {
+            if (!m_probeRayDataAliased) return;
+
+            // The probe trace overwrites every ray, the previous contents of the aliased memory don't matter
+            D3D12_RESOURCE_BARRIER barrier = {};
+            barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+            barrier.Aliasing.pResourceBefore = nullptr;
+            barrier.Aliasing.pResourceAfter = m_probeRayData;
+            cmdList->ResourceBarrier(1, &barrier);
+        }
+    #endif
+
         void DDGIVolume::TransitionResources(ID3D12GraphicsCommandList* cmdList, EDDGIExecutionStage stage) const
         {
             std::vector<D3D12_RESOURCE_BARRIER> barriers;
@@ -1269,6 +2415,7 @@ namespace rtxgi
 
             m_probeIrradianceRTV.ptr = 0;
             m_probeDistanceRTV.ptr = 0;
+            m_probesPublishPending = false;
 
             m_desc = {};
 
@@ -1284,22 +2431,28 @@ namespace rtxgi
                 { 0.f, 1.f, 0.f },
                 { 0.f, 0.f, 1.f }
             };
+            m_probeRayRotationIndex = 0;
 
             m_probeScrollOffsets = {};
 
         #if RTXGI_DDGI_RESOURCE_MANAGEMENT
             m_device = nullptr;
+            m_shaderHash = 0;
 
             RTXGI_SAFE_RELEASE(m_rootSignature);
             RTXGI_SAFE_RELEASE(m_rtvDescriptorHeap);
 
-            RTXGI_SAFE_RELEASE(m_probeRayData);
-            RTXGI_SAFE_RELEASE(m_probeIrradiance);
-            RTXGI_SAFE_RELEASE(m_probeDistance);
-            RTXGI_SAFE_RELEASE(m_probeData);
-            RTXGI_SAFE_RELEASE(m_probeVariability);
-            RTXGI_SAFE_RELEASE(m_probeVariabilityAverage);
+            ReleaseSparseResidency();
+
+            ReleaseTextures();
+            m_pool = nullptr;
+
             RTXGI_SAFE_RELEASE(m_probeVariabilityReadback);
+            RTXGI_SAFE_RELEASE(m_probeSchedule);
+            RTXGI_SAFE_RELEASE(m_probeScheduleArgs);
+            RTXGI_SAFE_RELEASE(m_probeScheduleCommandSignature);
+            RTXGI_SAFE_RELEASE(m_probeSH);
+            RTXGI_SAFE_RELEASE(m_probeIrradianceMips);
 
             RTXGI_SAFE_RELEASE(m_probeBlendingIrradiancePSO);
             RTXGI_SAFE_RELEASE(m_probeBlendingDistancePSO);
@@ -1309,6 +2462,9 @@ namespace rtxgi
             RTXGI_SAFE_RELEASE(m_probeClassificationResetPSO);
             RTXGI_SAFE_RELEASE(m_probeVariabilityReductionPSO);
             RTXGI_SAFE_RELEASE(m_probeVariabilityExtraReductionPSO);
+            RTXGI_SAFE_RELEASE(m_probeSchedulingPSO);
+            RTXGI_SAFE_RELEASE(m_probeSchedulingArgsPSO);
+            RTXGI_SAFE_RELEASE(m_probeDerivationPSO);
         #else
             m_rootSignature = nullptr;
 
@@ -1319,6 +2475,15 @@ namespace rtxgi
             m_probeVariability = nullptr;
             m_probeVariabilityAverage = nullptr;
             m_probeVariabilityReadback = nullptr;
+            memset(m_probeVariabilityReadbackValid, 0, sizeof(m_probeVariabilityReadbackValid));
+            m_probeSchedule = nullptr;
+            m_probeScheduleArgs = nullptr;
+            m_probeScheduleCommandSignature = nullptr;
+            m_probeSH = nullptr;
+            m_probeIrradianceMips = nullptr;
+            m_probeIrradiancePublished = nullptr;
+            m_probeDistancePublished = nullptr;
+            m_probeDataPublished = nullptr;
 
             m_probeBlendingIrradiancePSO = nullptr;
             m_probeBlendingDistancePSO = nullptr;
@@ -1328,6 +2493,9 @@ namespace rtxgi
             m_probeClassificationResetPSO = nullptr;
             m_probeVariabilityReductionPSO = nullptr;
             m_probeVariabilityExtraReductionPSO = nullptr;
+            m_probeSchedulingPSO = nullptr;
+            m_probeSchedulingArgsPSO = nullptr;
+            m_probeDerivationPSO = nullptr;
         #endif;
         }
 
@@ -1341,6 +2509,19 @@ namespace rtxgi
                 bytesPerVolume += sizeof(DDGIVolumeResourceIndices);
             }
 
+            if (m_probeSchedule)
+            {
+                // Add the memory used for the probe schedule and its indirect arguments copy
+                bytesPerVolume += (uint32_t)m_probeSchedule->GetDesc().Width;
+                if (m_probeScheduleArgs) bytesPerVolume += (uint32_t)m_probeScheduleArgs->GetDesc().Width;
+            }
+
+            // Add the memory used for the probe spherical harmonics coefficients
+            if (m_probeSH) bytesPerVolume += (uint32_t)m_probeSH->GetDesc().Width;
+
+            // Add the memory used for the probe irradiance mips
+            if (m_probeIrradianceMips) bytesPerVolume += (uint32_t)m_probeIrradianceMips->GetDesc().Width;
+
             return bytesPerVolume;
         }
 
@@ -1399,7 +2580,7 @@ namespace rtxgi
 
                 srvDesc.Format = uavDesc.Format = GetDDGIVolumeTextureFormat(EDDGIVolumeTextureType::Irradiance, m_desc.probeIrradianceFormat);
                 m_device->CreateUnorderedAccessView(m_probeIrradiance, nullptr, &uavDesc, uavHandle);
-                m_device->CreateShaderResourceView(m_probeIrradiance, &srvDesc, srvHandle);
+                m_device->CreateShaderResourceView(GetProbeIrradianceSRV(), &srvDesc, srvHandle);
             }
 
             // Probe Distance texture array descriptors
@@ -1409,7 +2590,7 @@ namespace rtxgi
 
                 srvDesc.Format = uavDesc.Format = GetDDGIVolumeTextureFormat(EDDGIVolumeTextureType::Distance, m_desc.probeDistanceFormat);
                 m_device->CreateUnorderedAccessView(m_probeDistance, nullptr, &uavDesc, uavHandle);
-                m_device->CreateShaderResourceView(m_probeDistance, &srvDesc, srvHandle);
+                m_device->CreateShaderResourceView(GetProbeDistanceSRV(), &srvDesc, srvHandle);
             }
 
             // Probe Data texture array descriptors
@@ -1419,7 +2600,7 @@ namespace rtxgi
 
                 srvDesc.Format = uavDesc.Format = GetDDGIVolumeTextureFormat(EDDGIVolumeTextureType::Data, m_desc.probeDataFormat);
                 m_device->CreateUnorderedAccessView(m_probeData, nullptr, &uavDesc, uavHandle);
-                m_device->CreateShaderResourceView(m_probeData, &srvDesc, srvHandle);
+                m_device->CreateShaderResourceView(GetProbeDataSRV(), &srvDesc, srvHandle);
             }
 
             // Probe variability texture descriptors
@@ -1446,19 +2627,61 @@ namespace rtxgi
                 m_device->CreateShaderResourceView(m_probeVariabilityAverage, &srvDesc, srvHandle);
             }
 
+            // Probe schedule buffer descriptor (raw)
+            if (m_probeSchedule)
+            {
+                uavHandle.ptr = heapStart.ptr + (m_descriptorHeapDesc.resourceIndices.probeScheduleUAVIndex * m_descriptorHeapDesc.entrySize);
+
+                D3D12_UNORDERED_ACCESS_VIEW_DESC rawUavDesc = {};
+                rawUavDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+                rawUavDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+                rawUavDesc.Buffer.NumElements = (UINT)(m_probeSchedule->GetDesc().Width / sizeof(UINT));
+                rawUavDesc.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_RAW;
+                m_device->CreateUnorderedAccessView(m_probeSchedule, nullptr, &rawUavDesc, uavHandle);
+            }
+
+            // Probe spherical harmonics buffer descriptor (structured, float3 elements)
+            if (m_probeSH)
+            {
+                uavHandle.ptr = heapStart.ptr + (m_descriptorHeapDesc.resourceIndices.probeSHUAVIndex * m_descriptorHeapDesc.entrySize);
+
+                D3D12_UNORDERED_ACCESS_VIEW_DESC structuredUavDesc = {};
+                structuredUavDesc.Format = DXGI_FORMAT_UNKNOWN;
+                structuredUavDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+                structuredUavDesc.Buffer.NumElements = (UINT)(m_probeSH->GetDesc().Width / (3 * sizeof(float)));
+                structuredUavDesc.Buffer.StructureByteStride = 3 * sizeof(float);
+                m_device->CreateUnorderedAccessView(m_probeSH, nullptr, &structuredUavDesc, uavHandle);
+            }
+
+            // Probe irradiance mips buffer descriptor (structured, float3 elements)
+            if (m_probeIrradianceMips)
+            {
+                uavHandle.ptr = heapStart.ptr + (m_descriptorHeapDesc.resourceIndices.probeIrradianceMipsUAVIndex * m_descriptorHeapDesc.entrySize);
+
+                D3D12_UNORDERED_ACCESS_VIEW_DESC structuredUavDesc = {};
+                structuredUavDesc.Format = DXGI_FORMAT_UNKNOWN;
+                structuredUavDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+                structuredUavDesc.Buffer.NumElements = (UINT)(m_probeIrradianceMips->GetDesc().Width / (3 * sizeof(float)));
+                structuredUavDesc.Buffer.StructureByteStride = 3 * sizeof(float);
+                m_device->CreateUnorderedAccessView(m_probeIrradianceMips, nullptr, &structuredUavDesc, uavHandle);
+            }
+
             // Describe the RTV heap
             D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
             heapDesc.NumDescriptors = GetDDGIVolumeNumRTVDescriptors();
             heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
             heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
 
-            // Create the RTV heap
-            HRESULT hr = m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_rtvDescriptorHeap));
-            if (FAILED(hr)) return false;
-        #ifdef RTXGI_GFX_NAME_OBJECTS
-            std::wstring name = L"DDGIVolume[" + std::to_wstring(m_desc.index) + L"], RTV Descriptor Heap";
-            m_rtvDescriptorHeap->SetName(name.c_str());
-        #endif
+            // Create the RTV heap (volumes created again keep theirs)
+            if (m_rtvDescriptorHeap == nullptr)
+            {
+                HRESULT hr = m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_rtvDescriptorHeap));
+                if (FAILED(hr)) return false;
+            #ifdef RTXGI_GFX_NAME_OBJECTS
+                std::wstring name = L"DDGIVolume[" + std::to_wstring(m_desc.index) + L"], RTV Descriptor Heap";
+                m_rtvDescriptorHeap->SetName(name.c_str());
+            #endif
+            }
 
             UINT rtvDescHeapEntrySize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
 
@@ -1523,7 +2746,7 @@ namespace rtxgi
             return true;
         }
 
-        bool DDGIVolume::CreateTexture(UINT64 width, UINT height, UINT arraySize, DXGI_FORMAT format, D3D12_RESOURCE_STATES state, D3D12_RESOURCE_FLAGS flags, ID3D12Resource** resource)
+        bool DDGIVolume::CreateTexture(UINT64 width, UINT height, UINT arraySize, DXGI_FORMAT format, D3D12_RESOURCE_STATES state, D3D12_RESOURCE_FLAGS flags, ID3D12Resource** resource, bool reserved, bool transient)
         {
             D3D12_HEAP_PROPERTIES defaultHeapProperties = {};
             defaultHeapProperties.Type = D3D12_HEAP_TYPE_DEFAULT;
@@ -1548,14 +2771,59 @@ namespace rtxgi
 
             // Create the texture
             bool useClear = (flags & D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
-            HRESULT hr = m_device->CreateCommittedResource(&defaultHeapProperties, D3D12_HEAP_FLAG_NONE, &desc, state, useClear ? &clear : nullptr, IID_PPV_ARGS(resource));
+            HRESULT hr = S_OK;
+            if (reserved)
+            {
+                // Sparse textures are reserved resources, UpdateSparseTiles() maps memory to their tiles
+                desc.Layout = D3D12_TEXTURE_LAYOUT_64KB_UNDEFINED_SWIZZLE;
+                hr = m_device->CreateReservedResource(&desc, state, useClear ? &clear : nullptr, IID_PPV_ARGS(resource));
+                if (FAILED(hr)) return false;
+
+                // Textures smaller than a tile are stored as packed mips, commit those instead
+                D3D12_PACKED_MIP_INFO packedMipInfo = {};
+                m_device->GetResourceTiling(*resource, nullptr, &packedMipInfo, nullptr, nullptr, 0, nullptr);
+                if (packedMipInfo.NumPackedMips == 0) return true;
+
+                (*resource)->Release();
+                *resource = nullptr;
+                desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+            }
+
+            // Place the texture in the pool's heaps when the volume has one
+            if (m_pool != nullptr) return AllocatePoolResource(m_pool, desc, state, useClear ? &clear : nullptr, transient, resource);
+
+            hr = m_device->CreateCommittedResource(&defaultHeapProperties, D3D12_HEAP_FLAG_NONE, &desc, state, useClear ? &clear : nullptr, IID_PPV_ARGS(resource));
             if (FAILED(hr)) return false;
             return true;
         }
 
+        void DDGIVolume::ReleaseTexture(ID3D12Resource*& resource)
+        {
+            if (resource == nullptr) return;
+
+            // Reserved (sparse) textures aren't placed in the pool
+            if (m_pool == nullptr || !ReleasePoolResource(m_pool, resource)) resource->Release();
+            resource = nullptr;
+        }
+
+        void DDGIVolume::ReleaseTextures()
+        {
+            ReleaseTexture(m_probeRayData);
+            ReleaseTexture(m_probeIrradiance);
+            ReleaseTexture(m_probeDistance);
+            ReleaseTexture(m_probeData);
+            ReleaseTexture(m_probeVariability);
+            ReleaseTexture(m_probeVariabilityAverage);
+            ReleaseTexture(m_probeIrradiancePublished);
+            ReleaseTexture(m_probeDistancePublished);
+            ReleaseTexture(m_probeDataPublished);
+            m_probeRayDataAliased = false;
+            m_probesPublishPending = false;
+        }
+
         bool DDGIVolume::CreateProbeRayData(const DDGIVolumeDesc& desc)
         {
-            RTXGI_SAFE_RELEASE(m_probeRayData);
+            ReleaseTexture(m_probeRayData);
 
             UINT width = 0;
             UINT height = 0;
@@ -1569,7 +2837,9 @@ namespace rtxgi
             if (width <= 0 || height <= 0 || arraySize <= 0) return false;
 
             // Create the texture resource
-            bool result = CreateTexture(width, height, arraySize, format, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, &m_probeRayData);
+            // Ray data is only read until the volume's probe classification, the pool may alias it across volumes
+            m_probeRayDataAliased = (m_pool != nullptr && m_pool->desc.aliasProbeRayData);
+            bool result = CreateTexture(width, height, arraySize, format, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, &m_probeRayData, false, m_probeRayDataAliased);
             if (!result) return false;
         #ifdef RTXGI_GFX_NAME_OBJECTS
             std::wstring name = L"DDGIVolume[" + std::to_wstring(desc.index) + L"], Probe Ray Data";
@@ -1581,7 +2851,7 @@ namespace rtxgi
 
         bool DDGIVolume::CreateProbeIrradiance(const DDGIVolumeDesc& desc)
         {
-            RTXGI_SAFE_RELEASE(m_probeIrradiance);
+            ReleaseTexture(m_probeIrradiance);
 
             UINT width = 0;
             UINT height = 0;
@@ -1596,7 +2866,7 @@ namespace rtxgi
 
             // Create the texture resource
             D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS | D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
-            bool result = CreateTexture(width, height, arraySize, format, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, flags, &m_probeIrradiance);
+            bool result = CreateTexture(width, height, arraySize, format, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, flags, &m_probeIrradiance, desc.probeSparseTexturesEnabled);
             if (!result) return false;
         #ifdef RTXGI_GFX_NAME_OBJECTS
             std::wstring name = L"DDGIVolume[" + std::to_wstring(desc.index) + L"], Probe Irradiance";
@@ -1607,7 +2877,7 @@ namespace rtxgi
 
         bool DDGIVolume::CreateProbeDistance(const DDGIVolumeDesc& desc)
         {
-            RTXGI_SAFE_RELEASE(m_probeDistance);
+            ReleaseTexture(m_probeDistance);
 
             UINT width = 0;
             UINT height = 0;
@@ -1622,7 +2892,7 @@ namespace rtxgi
 
             // Create the texture resource
             D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS | D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
-            bool result = CreateTexture(width, height, arraySize, format, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, flags, &m_probeDistance);
+            bool result = CreateTexture(width, height, arraySize, format, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, flags, &m_probeDistance, desc.probeSparseTexturesEnabled);
             if (!result) return false;
         #ifdef RTXGI_GFX_NAME_OBJECTS
             std::wstring name = L"DDGIVolume[" + std::to_wstring(desc.index) + L"], Probe Distance";
@@ -1634,7 +2904,7 @@ namespace rtxgi
 
         bool DDGIVolume::CreateProbeData(const DDGIVolumeDesc& desc)
         {
-            RTXGI_SAFE_RELEASE(m_probeData);
+            ReleaseTexture(m_probeData);
 
             UINT width = 0;
             UINT height = 0;
@@ -1658,9 +2928,54 @@ namespace rtxgi
             return true;
         }
 
+        bool DDGIVolume::CreateProbesPublished(const DDGIVolumeDesc& desc)
+        {
+            ReleaseTexture(m_probeIrradiancePublished);
+            ReleaseTexture(m_probeDistancePublished);
+            ReleaseTexture(m_probeDataPublished);
+            m_probesPublishPending = false;
+
+            if (!desc.probeAtlasDoubleBuffered) return true;
+
+            const EDDGIVolumeTextureType types[3] = { EDDGIVolumeTextureType::Irradiance, EDDGIVolumeTextureType::Distance, EDDGIVolumeTextureType::Data };
+            const EDDGIVolumeTextureFormat formats[3] = { desc.probeIrradianceFormat, desc.probeDistanceFormat, desc.probeDataFormat };
+            ID3D12Resource** textures[3] = { &m_probeIrradiancePublished, &m_probeDistancePublished, &m_probeDataPublished };
+
+            for (UINT textureIndex = 0; textureIndex < 3; textureIndex++)
+            {
+                UINT width = 0;
+                UINT height = 0;
+                UINT arraySize = 0;
+
+                // Get the texture dimensions and format
+                GetDDGIVolumeTextureDimensions(desc, types[textureIndex], width, height, arraySize);
+                DXGI_FORMAT format = GetDDGIVolumeTextureFormat(types[textureIndex], formats[textureIndex]);
+
+                // Check for problems
+                if (width <= 0 || height <= 0 || arraySize <= 0) return false;
+
+                // Create the texture resource, only ever copied to and sampled
+                bool result = CreateTexture(width, height, arraySize, format, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_FLAG_NONE, textures[textureIndex]);
+                if (!result) return false;
+            }
+
+        #ifdef RTXGI_GFX_NAME_OBJECTS
+            std::wstring name = L"DDGIVolume[" + std::to_wstring(desc.index) + L"], Probe Irradiance (Published)";
+            m_probeIrradiancePublished->SetName(name.c_str());
+            name = L"DDGIVolume[" + std::to_wstring(desc.index) + L"], Probe Distance (Published)";
+            m_probeDistancePublished->SetName(name.c_str());
+            name = L"DDGIVolume[" + std::to_wstring(desc.index) + L"], Probe Data (Published)";
+            m_probeDataPublished->SetName(name.c_str());
+        #endif
+
+            // The copies start uninitialized, publish on the next PublishDDGIVolumeProbes()
+            m_probesPublishPending = true;
+            return true;
+        }
+
         bool DDGIVolume::CreateProbeVariability(const DDGIVolumeDesc& desc)
         {
-            RTXGI_SAFE_RELEASE(m_probeVariability);
+            ReleaseTexture(m_probeVariability);
 
             UINT width = 0;
             UINT height = 0;
@@ -1675,7 +2990,7 @@ namespace rtxgi
             if (width <= 0 || height <= 0 || arraySize <= 0) return false;
 
             // Create the texture resource
-            bool result = CreateTexture(width, height, arraySize, format, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, &m_probeVariability);
+            bool result = CreateTexture(width, height, arraySize, format, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, &m_probeVariability, desc.probeSparseTexturesEnabled);
             if (!result) return false;
         #ifdef RTXGI_GFX_NAME_OBJECTS
             std::wstring name = L"DDGIVolume[" + std::to_wstring(desc.index) + L"], Probe Variability";
@@ -1687,7 +3002,7 @@ namespace rtxgi
 
         bool DDGIVolume::CreateProbeVariabilityAverage(const DDGIVolumeDesc& desc)
         {
-            RTXGI_SAFE_RELEASE(m_probeVariabilityAverage);
+            ReleaseTexture(m_probeVariabilityAverage);
 
             UINT width = 0;
             UINT height = 0;
@@ -1709,8 +3024,9 @@ namespace rtxgi
             m_probeVariabilityAverage->SetName(name.c_str());
         #endif
 
-            // Create the readback texture
+            // Create the readback buffer (a slot per buffering index)
             RTXGI_SAFE_RELEASE(m_probeVariabilityReadback);
+            memset(m_probeVariabilityReadbackValid, 0, sizeof(m_probeVariabilityReadbackValid));
 
             // Readback texture is always in "full" format (R32G32F)
             format = GetDDGIVolumeTextureFormat(EDDGIVolumeTextureType::VariabilityAverage, desc.probeVariabilityFormat);
@@ -1720,7 +3036,7 @@ namespace rtxgi
 
                 D3D12_RESOURCE_DESC desc = {};
                 desc.Format = DXGI_FORMAT_UNKNOWN;
-                desc.Width = sizeof(float) * 2;
+                desc.Width = RTXGI_DDGI_VARIABILITY_READBACK_SIZE;
                 desc.Height = 1;
                 desc.MipLevels = 1;
                 desc.DepthOrArraySize = 1;
@@ -1742,6 +3058,250 @@ namespace rtxgi
             return true;
         }
 
+        bool DDGIVolume::CreateProbeSchedule(const DDGIVolumeDesc& desc)
+        {
+            RTXGI_SAFE_RELEASE(m_probeSchedule);
+            RTXGI_SAFE_RELEASE(m_probeScheduleArgs);
+
+            UINT numProbes = (UINT)(desc.probeCounts.x * desc.probeCounts.y * desc.probeCounts.z);
+
+            D3D12_HEAP_PROPERTIES defaultHeapProperties = {};
+            defaultHeapProperties.Type = D3D12_HEAP_TYPE_DEFAULT;
+
+            // Describe the schedule buffer: dispatch arguments, append counter, one probe index per probe, and one ray count per probe.
+            // Committed resources are zero initialized, so the append counter starts at zero.
+            D3D12_RESOURCE_DESC bufferDesc = {};
+            bufferDesc.Format = DXGI_FORMAT_UNKNOWN;
+            bufferDesc.Width = RTXGI_DDGI_PROBE_SCHEDULE_SIZE(numProbes);
+            bufferDesc.Height = 1;
+            bufferDesc.MipLevels = 1;
+            bufferDesc.DepthOrArraySize = 1;
+            bufferDesc.SampleDesc.Count = 1;
+            bufferDesc.SampleDesc.Quality = 0;
+            bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+            bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+            bufferDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+
+            HRESULT hr = m_device->CreateCommittedResource(&defaultHeapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr, IID_PPV_ARGS(&m_probeSchedule));
+            if (FAILED(hr)) return false;
+
+            // Describe the indirect arguments buffer (trace and blend dispatch arguments)
+            bufferDesc.Width = RTXGI_DDGI_PROBE_SCHEDULE_COUNT_OFFSET;
+            bufferDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+            hr = m_device->CreateCommittedResource(&defaultHeapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT, nullptr, IID_PPV_ARGS(&m_probeScheduleArgs));
+            if (FAILED(hr)) return false;
+
+        #ifdef RTXGI_GFX_NAME_OBJECTS
+            std::wstring name = L"DDGIVolume[" + std::to_wstring(desc.index) + L"], Probe Schedule";
+            m_probeSchedule->SetName(name.c_str());
+            name = L"DDGIVolume[" + std::to_wstring(desc.index) + L"], Probe Schedule Arguments";
+            m_probeScheduleArgs->SetName(name.c_str());
+        #endif
+
+            return true;
+        }
+
+        bool DDGIVolume::CreateProbeSH(const DDGIVolumeDesc& desc)
+        {
+            RTXGI_SAFE_RELEASE(m_probeSH);
+
+            UINT numProbes = (UINT)(desc.probeCounts.x * desc.probeCounts.y * desc.probeCounts.z);
+
+            D3D12_HEAP_PROPERTIES defaultHeapProperties = {};
+            defaultHeapProperties.Type = D3D12_HEAP_TYPE_DEFAULT;
+
+            // Describe the spherical harmonics buffer: RTXGI_DDGI_PROBE_SH_MAX_COEFFICIENTS float3 coefficients per probe.
+            // Committed resources are zero initialized, so probe blending starts without history.
+            D3D12_RESOURCE_DESC bufferDesc = {};
+            bufferDesc.Format = DXGI_FORMAT_UNKNOWN;
+            bufferDesc.Width = RTXGI_DDGI_PROBE_SH_SIZE(numProbes);
+            bufferDesc.Height = 1;
+            bufferDesc.MipLevels = 1;
+            bufferDesc.DepthOrArraySize = 1;
+            bufferDesc.SampleDesc.Count = 1;
+            bufferDesc.SampleDesc.Quality = 0;
+            bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+            bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+            bufferDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+
+            HRESULT hr = m_device->CreateCommittedResource(&defaultHeapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr, IID_PPV_ARGS(&m_probeSH));
+            if (FAILED(hr)) return false;
+
+        #ifdef RTXGI_GFX_NAME_OBJECTS
+            std::wstring name = L"DDGIVolume[" + std::to_wstring(desc.index) + L"], Probe SH";
+            m_probeSH->SetName(name.c_str());
+        #endif
+
+            return true;
+        }
+
+        bool DDGIVolume::CreateProbeIrradianceMips(const DDGIVolumeDesc& desc)
+        {
+            RTXGI_SAFE_RELEASE(m_probeIrradianceMips);
+
+            UINT numProbes = (UINT)(desc.probeCounts.x * desc.probeCounts.y * desc.probeCounts.z);
+
+            D3D12_HEAP_PROPERTIES defaultHeapProperties = {};
+            defaultHeapProperties.Type = D3D12_HEAP_TYPE_DEFAULT;
+
+            // Describe the irradiance mips buffer: RTXGI_DDGI_PROBE_IRRADIANCE_MIP_TEXELS float3 texels per probe
+            D3D12_RESOURCE_DESC bufferDesc = {};
+            bufferDesc.Format = DXGI_FORMAT_UNKNOWN;
+            bufferDesc.Width = RTXGI_DDGI_PROBE_IRRADIANCE_MIPS_SIZE(numProbes);
+            bufferDesc.Height = 1;
+            bufferDesc.MipLevels = 1;
+            bufferDesc.DepthOrArraySize = 1;
+            bufferDesc.SampleDesc.Count = 1;
+            bufferDesc.SampleDesc.Quality = 0;
+            bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+            bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+            bufferDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+
+            HRESULT hr = m_device->CreateCommittedResource(&defaultHeapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr, IID_PPV_ARGS(&m_probeIrradianceMips));
+            if (FAILED(hr)) return false;
+
+        #ifdef RTXGI_GFX_NAME_OBJECTS
+            std::wstring name = L"DDGIVolume[" + std::to_wstring(desc.index) + L"], Probe Irradiance Mips";
+            m_probeIrradianceMips->SetName(name.c_str());
+        #endif
+
+            return true;
+        }
+
+        bool DDGIVolume::CreateProbeScheduleCommandSignature()
+        {
+            D3D12_INDIRECT_ARGUMENT_DESC argumentDesc = {};
+            argumentDesc.Type = D3D12_INDIRECT_ARGUMENT_TYPE_DISPATCH;
+
+            D3D12_COMMAND_SIGNATURE_DESC signatureDesc = {};
+            signatureDesc.ByteStride = sizeof(D3D12_DISPATCH_ARGUMENTS);
+            signatureDesc.NumArgumentDescs = 1;
+            signatureDesc.pArgumentDescs = &argumentDesc;
+
+            HRESULT hr = m_device->CreateCommandSignature(&signatureDesc, nullptr, IID_PPV_ARGS(&m_probeScheduleCommandSignature));
+            if (FAILED(hr)) return false;
+        #ifdef RTXGI_GFX_NAME_OBJECTS
+            std::wstring name = L"DDGIVolume[" + std::to_wstring(m_desc.index) + L"], Probe Schedule Command Signature";
+            m_probeScheduleCommandSignature->SetName(name.c_str());
+        #endif
+
+            return true;
+        }
+
+        bool DDGIVolume::CreateSparseResidency(const DDGIVolumeDesc& desc)
+        {
+            ReleaseSparseResidency();
+            if (!desc.probeSparseTexturesEnabled) return true;
+
+            m_sparseResidency = new DDGIVolumeSparseResidency();
+            DDGIVolumeSparseResidency* sparse = m_sparseResidency;
+
+            ID3D12Resource* resources[3] = { m_probeIrradiance, m_probeDistance, m_probeVariability };
+            UINT probeTexels[3] = { (UINT)desc.probeNumIrradianceTexels, (UINT)desc.probeNumDistanceTexels, (UINT)desc.probeNumIrradianceInteriorTexels };
+
+            // Get the tiling of the reserved probe textures (textures smaller than a tile are committed, see CreateTexture())
+            UINT numHeapTiles = 0;
+            for (UINT textureIndex = 0; textureIndex < 3; textureIndex++)
+            {
+                if (resources[textureIndex]->GetDesc().Layout != D3D12_TEXTURE_LAYOUT_64KB_UNDEFINED_SWIZZLE) continue;
+
+                DDGIVolumeSparseTexture& texture = sparse->textures[textureIndex];
+
+                UINT numTiles = 0;
+                UINT numSubresourceTilings = 1;
+                D3D12_SUBRESOURCE_TILING tiling = {};
+                m_device->GetResourceTiling(resources[textureIndex], &numTiles, nullptr, &texture.tileShape, &numSubresourceTilings, 0, &tiling);
+
+                texture.resource = resources[textureIndex];
+                texture.probeTexels = probeTexels[textureIndex];
+                texture.tilesX = tiling.WidthInTiles;
+                texture.tilesY = tiling.HeightInTiles;
+                texture.tiles.assign(numTiles, RTXGI_DDGI_SPARSE_TILE_UNMAPPED);
+
+                numHeapTiles += numTiles;
+            }
+
+            // Reserve heap slots for every tile being resident, the heaps themselves are created on first use
+            sparse->heaps.resize((numHeapTiles + RTXGI_DDGI_SPARSE_TILES_PER_HEAP - 1) / RTXGI_DDGI_SPARSE_TILES_PER_HEAP, nullptr);
+            sparse->freeTiles.resize(numHeapTiles);
+            for (UINT tileIndex = 0; tileIndex < numHeapTiles; tileIndex++) sparse->freeTiles[tileIndex] = (numHeapTiles - 1 - tileIndex);
+
+            // Create per array slice render target views of the irradiance and distance textures, newly mapped tiles are cleared
+            UINT arraySize = resources[0]->GetDesc().DepthOrArraySize;
+
+            D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+            heapDesc.NumDescriptors = (arraySize * 2);
+            heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
+            heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+
+            HRESULT hr = m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&sparse->rtvDescriptorHeap));
+            if (FAILED(hr)) return false;
+        #ifdef RTXGI_GFX_NAME_OBJECTS
+            std::wstring name = L"DDGIVolume[" + std::to_wstring(desc.index) + L"], Sparse RTV Descriptor Heap";
+            sparse->rtvDescriptorHeap->SetName(name.c_str());
+        #endif
+
+            sparse->rtvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+
+            D3D12_RENDER_TARGET_VIEW_DESC rtvDesc = {};
+            rtvDesc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2DARRAY;
+            rtvDesc.Texture2DArray.ArraySize = 1;
+
+            D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = sparse->rtvDescriptorHeap->GetCPUDescriptorHandleForHeapStart();
+            for (UINT textureIndex = 0; textureIndex < 2; textureIndex++)
+            {
+                rtvDesc.Format = resources[textureIndex]->GetDesc().Format;
+                for (UINT slice = 0; slice < arraySize; slice++)
+                {
+                    rtvDesc.Texture2DArray.FirstArraySlice = slice;
+                    m_device->CreateRenderTargetView(resources[textureIndex], &rtvDesc, rtvHandle);
+                    rtvHandle.ptr += sparse->rtvDescriptorSize;
+                }
+            }
+
+            // Get the layout of a probe data copy
+            D3D12_RESOURCE_DESC probeDataDesc = m_probeData->GetDesc();
+            sparse->probeDataFootprints.resize(probeDataDesc.DepthOrArraySize);
+            m_device->GetCopyableFootprints(&probeDataDesc, 0, probeDataDesc.DepthOrArraySize, 0, sparse->probeDataFootprints.data(), nullptr, nullptr, &sparse->probeDataReadbackSize);
+            sparse->probeDataReadbackSize = RTXGI_ALIGN(D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, sparse->probeDataReadbackSize);
+
+            // Create the probe data readback buffer
+            D3D12_HEAP_PROPERTIES readbackHeapProperties = {};
+            readbackHeapProperties.Type = D3D12_HEAP_TYPE_READBACK;
+
+            D3D12_RESOURCE_DESC bufferDesc = {};
+            bufferDesc.Format = DXGI_FORMAT_UNKNOWN;
+            bufferDesc.Width = sparse->probeDataReadbackSize * RTXGI_DDGI_SPARSE_READBACK_BUFFERS;
+            bufferDesc.Height = 1;
+            bufferDesc.MipLevels = 1;
+            bufferDesc.DepthOrArraySize = 1;
+            bufferDesc.SampleDesc.Count = 1;
+            bufferDesc.SampleDesc.Quality = 0;
+            bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+            bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+            bufferDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+            hr = m_device->CreateCommittedResource(&readbackHeapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&sparse->probeDataReadback));
+            if (FAILED(hr)) return false;
+        #ifdef RTXGI_GFX_NAME_OBJECTS
+            name = L"DDGIVolume[" + std::to_wstring(desc.index) + L"], Probe Data Readback";
+            sparse->probeDataReadback->SetName(name.c_str());
+        #endif
+
+            return true;
+        }
+
+        void DDGIVolume::ReleaseSparseResidency()
+        {
+            if (m_sparseResidency == nullptr) return;
+
+            for (ID3D12Heap*& heap : m_sparseResidency->heaps) RTXGI_SAFE_RELEASE(heap);
+            RTXGI_SAFE_RELEASE(m_sparseResidency->rtvDescriptorHeap);
+            RTXGI_SAFE_RELEASE(m_sparseResidency->probeDataReadback);
+            RTXGI_SAFE_DELETE(m_sparseResidency);
+        }
+
     #endif // RTXGI_DDGI_RESOURCE_MANAGEMENT
 
     } // namespace d3d12
@@ -12,6 +12,7 @@
 
 #include "rtxgi/VulkanExtensions.h"
 
+#include <algorithm>
 #include <cstring>
 #include <random>
 #include <string>
@@ -56,6 +57,113 @@ namespace rtxgi
     namespace vulkan
     {
 
+        //------------------------------------------------------------------------
+        // Device Memory Pool
+        //------------------------------------------------------------------------
+
+        struct DDGIMemoryBlock
+        {
+            VkDeviceMemory                  memory = nullptr;                   // nullptr once the block is released
+            uint32_t                        memoryTypeIndex = 0;
+            VkMemoryAllocateFlags           flags = 0;
+            bool                            linear = true;                      // Buffers and linear images, or optimal tiling images
+            VkDeviceSize                    size = 0;                           // Size (in bytes) of the block
+            VkDeviceSize                    usedSize = 0;                       // Bytes used by the block's allocations
+            uint32_t                        numAllocations = 0;
+            uint8_t*                        mappedData = nullptr;               // Host pointer to the block (host visible memory only)
+            std::vector<std::pair<VkDeviceSize, VkDeviceSize>> freeBlocks;      // Offset and size (in bytes) of the unused ranges, sorted by offset
+        };
+
+        struct DDGIMemoryPool
+        {
+            VkDevice                        device = nullptr;
+            DDGIMemoryPoolDesc              desc = {};
+            VkPhysicalDeviceMemoryProperties memoryProperties = {};
+            std::vector<DDGIMemoryBlock>    blocks;                             // Released blocks are left in place (nullptr memory) and reused
+            std::vector<DDGIMemoryAllocation*> allocations;                     // Block and dedicated allocations
+            VkDeviceSize                    dedicatedSizeInBytes = 0;           // Bytes in dedicated allocations
+            uint32_t                        numDedicatedAllocations = 0;
+        };
+
+        /**
+         * Allocates device memory and maps it when it is host visible.
+         */
+        bool AllocateDeviceMemory(DDGIMemoryPool* pool, uint32_t memoryTypeIndex, VkMemoryAllocateFlags flags, VkDeviceSize size, VkDeviceMemory* memory, void** mappedData)
+        {
+            VkMemoryAllocateFlagsInfo allocateFlagsInfo = {};
+            allocateFlagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+            allocateFlagsInfo.flags = flags;
+
+            VkMemoryAllocateInfo memoryAllocateInfo = {};
+            memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            memoryAllocateInfo.pNext = &allocateFlagsInfo;
+            memoryAllocateInfo.memoryTypeIndex = memoryTypeIndex;
+            memoryAllocateInfo.allocationSize = size;
+
+            VkResult result = vkAllocateMemory(pool->device, &memoryAllocateInfo, nullptr, memory);
+            if (VKFAILED(result)) return false;
+
+            *mappedData = nullptr;
+            if (pool->memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+            {
+                result = vkMapMemory(pool->device, *memory, 0, VK_WHOLE_SIZE, 0, mappedData);
+                if (VKFAILED(result))
+                {
+                    vkFreeMemory(pool->device, *memory, nullptr);
+                    *memory = nullptr;
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * Takes an aligned range from the first free range of the block that fits it.
+         */
+        bool TakeBlockRange(DDGIMemoryBlock& block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset)
+        {
+            for (size_t rangeIndex = 0; rangeIndex < block.freeBlocks.size(); rangeIndex++)
+            {
+                VkDeviceSize rangeStart = block.freeBlocks[rangeIndex].first;
+                VkDeviceSize rangeEnd = rangeStart + block.freeBlocks[rangeIndex].second;
+                VkDeviceSize start = RTXGI_ALIGN(alignment, rangeStart);
+                if (start + size > rangeEnd) continue;
+
+                // Split the free range around the allocation
+                block.freeBlocks.erase(block.freeBlocks.begin() + rangeIndex);
+                if (start + size < rangeEnd) block.freeBlocks.insert(block.freeBlocks.begin() + rangeIndex, { start + size, rangeEnd - (start + size) });
+                if (rangeStart < start) block.freeBlocks.insert(block.freeBlocks.begin() + rangeIndex, { rangeStart, start - rangeStart });
+
+                block.usedSize += size;
+                block.numAllocations++;
+                offset = start;
+                return true;
+            }
+            return false;
+        }
+
+        /**
+         * Returns a range to the block and merges it with its neighbours.
+         */
+        void ReturnBlockRange(DDGIMemoryBlock& block, VkDeviceSize offset, VkDeviceSize size)
+        {
+            auto range = std::lower_bound(block.freeBlocks.begin(), block.freeBlocks.end(), std::make_pair(offset, size));
+            range = block.freeBlocks.insert(range, { offset, size });
+            if ((range + 1) != block.freeBlocks.end() && (range->first + range->second) == (range + 1)->first)
+            {
+                range->second += (range + 1)->second;
+                block.freeBlocks.erase(range + 1);
+            }
+            if (range != block.freeBlocks.begin() && ((range - 1)->first + (range - 1)->second) == range->first)
+            {
+                (range - 1)->second += range->second;
+                block.freeBlocks.erase(range);
+            }
+
+            block.usedSize -= size;
+            block.numAllocations--;
+        }
+
         //------------------------------------------------------------------------
         // Private RTXGI Namespace Helper Functions
         //------------------------------------------------------------------------
@@ -145,6 +253,7 @@ namespace rtxgi
             {
                 if (format == EDDGIVolumeTextureFormat::F32x2) return VK_FORMAT_R32G32_SFLOAT;
                 else if (format == EDDGIVolumeTextureFormat::F32x4) return VK_FORMAT_R32G32B32A32_SFLOAT;
+                else if (format == EDDGIVolumeTextureFormat::U32) return VK_FORMAT_R32_SFLOAT;     // Packed radiance and hit distance (see ProbeRayCommon.hlsl)
             }
             else if (type == EDDGIVolumeTextureType::Irradiance)
             {
@@ -302,19 +411,55 @@ namespace rtxgi
             return ERTXGIStatus::OK;
         }
 
-        ERTXGIStatus UploadDDGIVolumeConstants(VkDevice device, VkCommandBuffer cmdBuffer, uint32_t bufferingIndex, uint32_t numVolumes, DDGIVolume** volumes)
+        ERTXGIStatus UploadDDGIVolumeConstants(VkDevice device, VkCommandBuffer cmdBuffer, uint32_t bufferingIndex, uint32_t numVolumes, DDGIVolume** volumes, const DDGIVolumeDescGPUPacked* gpuDescs)
         {
+            // Only the constants of volumes that changed since their last upload are copied. Volumes typically share the
+            // upload and device constants buffers, so the upload memory is mapped once and copies of adjacent volumes are merged.
+            VkDeviceMemory mappedMemory = nullptr;
+            uint8_t* pMappedData = nullptr;
+
+            // Pending copy of the upload buffer to the device buffer
+            VkBuffer copyDst = nullptr;
+            VkBuffer copySrc = nullptr;
+            VkBufferCopy bufferCopy = {};
+
             // Copy the constants for each volume
             for (uint32_t volumeIndex = 0; volumeIndex < numVolumes; volumeIndex++)
             {
                 // Get the volume
-                const DDGIVolume* volume = volumes[volumeIndex];
+                DDGIVolume* volume = volumes[volumeIndex];
 
                 // Validate the upload and device buffers
                 if (volume->GetConstantsBuffer() == nullptr) return ERTXGIStatus::ERROR_DDGI_INVALID_CONSTANTS_BUFFER;
                 if (volume->GetConstantsBufferUpload() == nullptr) return ERTXGIStatus::ERROR_DDGI_INVALID_CONSTANTS_UPLOAD_BUFFER;
                 if (volume->GetConstantsBufferUploadMemory() == nullptr) return ERTXGIStatus::ERROR_DDGI_VK_INVALID_CONSTANTS_UPLOAD_MEMORY;
 
+                // Get the packed DDGIVolume GPU descriptor
+                const DDGIVolumeDescGPUPacked gpuDesc = gpuDescs ? gpuDescs[volumeIndex] : volume->GetDescGPUPacked();
+
+            #if _DEBUG
+                volume->ValidatePackedData(gpuDesc);
+            #endif
+
+                // Skip the volume if the device buffer already holds its constants
+                if (!volume->GetConstantsUploadNeeded(gpuDesc, volume->GetConstantsBuffer())) continue;
+
+                // Map the constants upload memory (once per upload memory)
+                if (volume->GetConstantsBufferUploadMemory() != mappedMemory)
+                {
+                    if (mappedMemory) vkUnmapMemory(device, mappedMemory);
+                    mappedMemory = nullptr;
+
+                    VkResult result = vkMapMemory(device, volume->GetConstantsBufferUploadMemory(), 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&pMappedData));
+                    if (VKFAILED(result))
+                    {
+                        // Don't drop the copy of volumes already marked as uploaded
+                        if (bufferCopy.size > 0) vkCmdCopyBuffer(cmdBuffer, copySrc, copyDst, 1, &bufferCopy);
+                        return ERTXGIStatus::ERROR_DDGI_MAP_FAILURE_CONSTANTS_UPLOAD_BUFFER;
+                    }
+                    mappedMemory = volume->GetConstantsBufferUploadMemory();
+                }
+
                 // Offset to the constants data to write to (e.g. double buffering)
                 uint64_t bufferOffset = volume->GetConstantsBufferSizeInBytes() * bufferingIndex;
 
@@ -324,30 +469,31 @@ namespace rtxgi
                 // Offset to the volume constants in the upload buffer
                 uint64_t srcOffset = (bufferOffset + volumeOffset);
 
-                // Map the constants buffer and update it
-                void* pData = nullptr;
-                VkResult result = vkMapMemory(device, volume->GetConstantsBufferUploadMemory(), srcOffset, sizeof(DDGIVolumeDescGPUPacked), 0, &pData);
-                if (VKFAILED(result)) return ERTXGIStatus::ERROR_DDGI_MAP_FAILURE_CONSTANTS_UPLOAD_BUFFER;
-
-                // Get the packed DDGIVolume GPU descriptor
-                const DDGIVolumeDescGPUPacked gpuDesc = volume->GetDescGPUPacked();
-
-            #if _DEBUG
-                volume->ValidatePackedData(gpuDesc);
-            #endif
+                memcpy(pMappedData + srcOffset, &gpuDesc, sizeof(DDGIVolumeDescGPUPacked));
+                volume->SetConstantsUploaded(gpuDesc, volume->GetConstantsBuffer());
 
-                memcpy(pData, &gpuDesc, sizeof(DDGIVolumeDescGPUPacked));
+                // Extend the pending copy if this volume's constants directly follow it, otherwise schedule it and start a new one
+                if (copyDst == volume->GetConstantsBuffer() && copySrc == volume->GetConstantsBufferUpload()
+                    && (bufferCopy.dstOffset + bufferCopy.size) == volumeOffset && (bufferCopy.srcOffset + bufferCopy.size) == srcOffset)
+                {
+                    bufferCopy.size += sizeof(DDGIVolumeDescGPUPacked);
+                    continue;
+                }
 
-                vkUnmapMemory(device, volume->GetConstantsBufferUploadMemory());
+                if (bufferCopy.size > 0) vkCmdCopyBuffer(cmdBuffer, copySrc, copyDst, 1, &bufferCopy);
 
-                // Schedule a copy of the upload buffer to the device buffer
-                VkBufferCopy bufferCopy = {};
+                copyDst = volume->GetConstantsBuffer();
+                copySrc = volume->GetConstantsBufferUpload();
                 bufferCopy.size = sizeof(DDGIVolumeDescGPUPacked);
                 bufferCopy.srcOffset = srcOffset;
                 bufferCopy.dstOffset = volumeOffset;
-                vkCmdCopyBuffer(cmdBuffer, volume->GetConstantsBufferUpload(), volume->GetConstantsBuffer(), 1, &bufferCopy);
             }
 
+            if (mappedMemory) vkUnmapMemory(device, mappedMemory);
+
+            // Schedule the last copy of the upload buffer to the device buffer
+            if (bufferCopy.size > 0) vkCmdCopyBuffer(cmdBuffer, copySrc, copyDst, 1, &bufferCopy);
+
             return ERTXGIStatus::OK;
         }
 
@@ -536,10 +682,20 @@ namespace rtxgi
                 vkCmdPushConstants(cmdBuffer, volume->GetPipelineLayout(), VK_SHADER_STAGE_ALL, volume->GetPushConstantsOffset(), DDGIRootConstants::GetSizeInBytes(), volume->GetPushConstants().GetData());
 
                 // Probe relocation
-                float groupSizeX = 32.f;
-                uint32_t numGroupsX = (uint32_t)ceil((float)volume->GetNumProbes() / groupSizeX);
                 vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, volume->GetProbeRelocationPipeline());
-                vkCmdDispatch(cmdBuffer, numGroupsX, 1, 1);
+                if (volume->GetProbeFixedRaysUseWaveOps())
+                {
+                    // One thread group (wave) per probe
+                    uint32_t probeCountX, probeCountY, probeCountZ;
+                    GetDDGIVolumeProbeCounts(volume->GetDesc(), probeCountX, probeCountY, probeCountZ);
+                    vkCmdDispatch(cmdBuffer, probeCountX, probeCountY, probeCountZ);
+                }
+                else
+                {
+                    float groupSizeX = 32.f;
+                    uint32_t numGroupsX = (uint32_t)ceil((float)volume->GetNumProbes() / groupSizeX);
+                    vkCmdDispatch(cmdBuffer, numGroupsX, 1, 1);
+                }
 
                 // Add a barrier
                 barrier.image = volume->GetProbeData();
@@ -636,10 +792,20 @@ namespace rtxgi
                 vkCmdPushConstants(cmdBuffer, volume->GetPipelineLayout(), VK_SHADER_STAGE_ALL, volume->GetPushConstantsOffset(), DDGIRootConstants::GetSizeInBytes(), volume->GetPushConstants().GetData());
 
                 // Probe classification
-                const float groupSizeX = 32.f;
-                uint32_t numGroupsX = (uint32_t)ceil((float)volume->GetNumProbes() / groupSizeX);
                 vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, volume->GetProbeClassificationPipeline());
-                vkCmdDispatch(cmdBuffer, numGroupsX, 1, 1);
+                if (volume->GetProbeFixedRaysUseWaveOps())
+                {
+                    // One thread group (wave) per probe
+                    uint32_t probeCountX, probeCountY, probeCountZ;
+                    GetDDGIVolumeProbeCounts(volume->GetDesc(), probeCountX, probeCountY, probeCountZ);
+                    vkCmdDispatch(cmdBuffer, probeCountX, probeCountY, probeCountZ);
+                }
+                else
+                {
+                    const float groupSizeX = 32.f;
+                    uint32_t numGroupsX = (uint32_t)ceil((float)volume->GetNumProbes() / groupSizeX);
+                    vkCmdDispatch(cmdBuffer, numGroupsX, 1, 1);
+                }
 
                 // Add a barrier
                 barrier.image = volume->GetProbeData();
@@ -891,6 +1057,300 @@ namespace rtxgi
             return ERTXGIStatus::OK;
         }
 
+        ERTXGIStatus CreateDDGIMemoryPool(VkDevice device, VkPhysicalDevice physicalDevice, const DDGIMemoryPoolDesc& desc, DDGIMemoryPool** pool)
+        {
+            if (device == nullptr) return ERTXGIStatus::ERROR_DDGI_VK_INVALID_DEVICE;
+            if (physicalDevice == nullptr) return ERTXGIStatus::ERROR_DDGI_VK_INVALID_PHYSICAL_DEVICE;
+            if (pool == nullptr || desc.blockSizeInBytes == 0) return ERTXGIStatus::ERROR_DDGI_ALLOCATE_FAILURE_RESOURCE_POOL;
+
+            *pool = new DDGIMemoryPool();
+            (*pool)->device = device;
+            (*pool)->desc = desc;
+            vkGetPhysicalDeviceMemoryProperties(physicalDevice, &(*pool)->memoryProperties);
+
+            return ERTXGIStatus::OK;
+        }
+
+        void DestroyDDGIMemoryPool(DDGIMemoryPool*& pool)
+        {
+            if (pool == nullptr) return;
+
+            // Allocations should be freed first, release what was left behind
+            for (DDGIMemoryAllocation* allocation : pool->allocations)
+            {
+                if (allocation->blockIndex == UINT32_MAX) vkFreeMemory(pool->device, allocation->memory, nullptr);
+                delete allocation;
+            }
+            for (DDGIMemoryBlock& block : pool->blocks) vkFreeMemory(pool->device, block.memory, nullptr);
+
+            delete pool;
+            pool = nullptr;
+        }
+
+        ERTXGIStatus AllocateDDGIMemory(DDGIMemoryPool* pool, const DDGIMemoryAllocationDesc& desc, DDGIMemoryAllocation** allocation)
+        {
+            if (pool == nullptr || allocation == nullptr) return ERTXGIStatus::ERROR_DDGI_VK_ALLOCATE_FAILURE_MEMORY;
+
+            // Find a memory type with the required properties
+            uint32_t memoryTypeIndex = 0;
+            while (memoryTypeIndex < pool->memoryProperties.memoryTypeCount)
+            {
+                bool isRequiredType = desc.requirements.memoryTypeBits & (1 << memoryTypeIndex);
+                bool hasRequiredProperties = (pool->memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & desc.properties) == desc.properties;
+                if (isRequiredType && hasRequiredProperties) break;
+                ++memoryTypeIndex;
+            }
+            if (memoryTypeIndex == pool->memoryProperties.memoryTypeCount) return ERTXGIStatus::ERROR_DDGI_VK_ALLOCATE_FAILURE_MEMORY;
+
+            VkDeviceSize alignment = (std::max)(desc.requirements.alignment, (VkDeviceSize)1);
+
+            DDGIMemoryAllocation entry;
+            entry.size = desc.requirements.size;
+            entry.alignment = alignment;
+            entry.userData = desc.userData;
+
+            if (desc.dedicated || desc.requirements.size >= pool->desc.dedicatedSizeInBytes)
+            {
+                // Large resources get a device memory allocation of their own
+                if (!AllocateDeviceMemory(pool, memoryTypeIndex, desc.flags, entry.size, &entry.memory, &entry.mappedData)) return ERTXGIStatus::ERROR_DDGI_VK_ALLOCATE_FAILURE_MEMORY;
+                pool->dedicatedSizeInBytes += entry.size;
+                pool->numDedicatedAllocations++;
+            }
+            else
+            {
+                uint32_t blockIndex = UINT32_MAX;
+                for (uint32_t index = 0; index < static_cast<uint32_t>(pool->blocks.size()) && blockIndex == UINT32_MAX; index++)
+                {
+                    DDGIMemoryBlock& block = pool->blocks[index];
+                    if (block.memory == nullptr || block.memoryTypeIndex != memoryTypeIndex || block.flags != desc.flags || block.linear != desc.linear) continue;
+                    if (TakeBlockRange(block, entry.size, alignment, entry.offset)) blockIndex = index;
+                }
+
+                if (blockIndex == UINT32_MAX)
+                {
+                    // Create a block, in the slot of a released block when there is one
+                    DDGIMemoryBlock block;
+                    block.memoryTypeIndex = memoryTypeIndex;
+                    block.flags = desc.flags;
+                    block.linear = desc.linear;
+                    block.size = (std::max)(pool->desc.blockSizeInBytes, entry.size);
+
+                    void* mappedData = nullptr;
+                    if (!AllocateDeviceMemory(pool, memoryTypeIndex, desc.flags, block.size, &block.memory, &mappedData)) return ERTXGIStatus::ERROR_DDGI_VK_ALLOCATE_FAILURE_MEMORY;
+                    block.mappedData = static_cast<uint8_t*>(mappedData);
+                    block.freeBlocks.push_back({ 0, block.size });
+
+                    auto slot = std::find_if(pool->blocks.begin(), pool->blocks.end(), [](const DDGIMemoryBlock& other) { return other.memory == nullptr; });
+                    blockIndex = static_cast<uint32_t>(slot - pool->blocks.begin());
+                    if (slot == pool->blocks.end()) pool->blocks.push_back(block);
+                    else *slot = block;
+
+                    TakeBlockRange(pool->blocks[blockIndex], entry.size, alignment, entry.offset);
+                }
+
+                const DDGIMemoryBlock& block = pool->blocks[blockIndex];
+                entry.memory = block.memory;
+                entry.mappedData = block.mappedData ? block.mappedData + entry.offset : nullptr;
+                entry.blockIndex = blockIndex;
+            }
+
+            *allocation = new DDGIMemoryAllocation(entry);
+            pool->allocations.push_back(*allocation);
+
+            return ERTXGIStatus::OK;
+        }
+
+        ERTXGIStatus AllocateDDGIBufferMemory(DDGIMemoryPool* pool, VkBuffer buffer, VkMemoryPropertyFlags properties, VkMemoryAllocateFlags flags, DDGIMemoryAllocation** allocation)
+        {
+            if (pool == nullptr || buffer == nullptr) return ERTXGIStatus::ERROR_DDGI_VK_ALLOCATE_FAILURE_MEMORY;
+
+            // Get the memory requirements, including the driver's preference for a dedicated allocation
+            VkMemoryDedicatedRequirements dedicatedReqs = {};
+            dedicatedReqs.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+
+            VkMemoryRequirements2 reqs = {};
+            reqs.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+            reqs.pNext = &dedicatedReqs;
+
+            VkBufferMemoryRequirementsInfo2 info = {};
+            info.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2;
+            info.buffer = buffer;
+            vkGetBufferMemoryRequirements2(pool->device, &info, &reqs);
+
+            DDGIMemoryAllocationDesc desc;
+            desc.requirements = reqs.memoryRequirements;
+            desc.properties = properties;
+            desc.flags = flags;
+            desc.linear = true;
+            desc.dedicated = (dedicatedReqs.prefersDedicatedAllocation || dedicatedReqs.requiresDedicatedAllocation);
+
+            ERTXGIStatus status = AllocateDDGIMemory(pool, desc, allocation);
+            if (status != ERTXGIStatus::OK) return status;
+
+            VkResult result = vkBindBufferMemory(pool->device, buffer, (*allocation)->memory, (*allocation)->offset);
+            if (VKFAILED(result))
+            {
+                FreeDDGIMemory(pool, *allocation);
+                return ERTXGIStatus::ERROR_DDGI_VK_ALLOCATE_FAILURE_MEMORY;
+            }
+            return ERTXGIStatus::OK;
+        }
+
+        ERTXGIStatus AllocateDDGIImageMemory(DDGIMemoryPool* pool, VkImage image, VkMemoryPropertyFlags properties, DDGIMemoryAllocation** allocation)
+        {
+            if (pool == nullptr || image == nullptr) return ERTXGIStatus::ERROR_DDGI_VK_ALLOCATE_FAILURE_MEMORY;
+
+            // Get the memory requirements, including the driver's preference for a dedicated allocation
+            VkMemoryDedicatedRequirements dedicatedReqs = {};
+            dedicatedReqs.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+
+            VkMemoryRequirements2 reqs = {};
+            reqs.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+            reqs.pNext = &dedicatedReqs;
+
+            VkImageMemoryRequirementsInfo2 info = {};
+            info.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2;
+            info.image = image;
+            vkGetImageMemoryRequirements2(pool->device, &info, &reqs);
+
+            DDGIMemoryAllocationDesc desc;
+            desc.requirements = reqs.memoryRequirements;
+            desc.properties = properties;
+            desc.linear = false;
+            desc.dedicated = (dedicatedReqs.prefersDedicatedAllocation || dedicatedReqs.requiresDedicatedAllocation);
+
+            ERTXGIStatus status = AllocateDDGIMemory(pool, desc, allocation);
+            if (status != ERTXGIStatus::OK) return status;
+
+            VkResult result = vkBindImageMemory(pool->device, image, (*allocation)->memory, (*allocation)->offset);
+            if (VKFAILED(result))
+            {
+                FreeDDGIMemory(pool, *allocation);
+                return ERTXGIStatus::ERROR_DDGI_VK_ALLOCATE_FAILURE_MEMORY;
+            }
+            return ERTXGIStatus::OK;
+        }
+
+        void FreeDDGIMemory(DDGIMemoryPool* pool, DDGIMemoryAllocation*& allocation)
+        {
+            if (pool == nullptr || allocation == nullptr) return;
+
+            auto it = std::find(pool->allocations.begin(), pool->allocations.end(), allocation);
+            if (it != pool->allocations.end()) pool->allocations.erase(it);
+
+            if (allocation->blockIndex == UINT32_MAX)
+            {
+                vkFreeMemory(pool->device, allocation->memory, nullptr);
+                pool->dedicatedSizeInBytes -= allocation->size;
+                pool->numDedicatedAllocations--;
+            }
+            else
+            {
+                ReturnBlockRange(pool->blocks[allocation->blockIndex], allocation->offset, allocation->size);
+            }
+
+            delete allocation;
+            allocation = nullptr;
+        }
+
+        uint32_t DefragmentDDGIMemoryPool(DDGIMemoryPool* pool, DDGIMemoryMoveCallback callback, void* userData, uint32_t maxMoves)
+        {
+            if (pool == nullptr || callback == nullptr) return 0;
+
+            // Visit the blocks from the most sparsely used to the most densely used
+            std::vector<uint32_t> order;
+            for (uint32_t index = 0; index < static_cast<uint32_t>(pool->blocks.size()); index++)
+            {
+                if (pool->blocks[index].memory != nullptr && pool->blocks[index].numAllocations > 0) order.push_back(index);
+            }
+            std::sort(order.begin(), order.end(), [pool](uint32_t a, uint32_t b) { return pool->blocks[a].usedSize < pool->blocks[b].usedSize; });
+
+            // A block is emptied when the denser blocks of the same kind have room for its allocations.
+            // Allocations are never moved into a block that is being emptied, so the ranges read by the recorded copies aren't overwritten.
+            std::vector<bool> source(pool->blocks.size(), false);
+            for (size_t orderIndex = 0; orderIndex < order.size(); orderIndex++)
+            {
+                const DDGIMemoryBlock& block = pool->blocks[order[orderIndex]];
+
+                VkDeviceSize available = 0;
+                for (size_t otherIndex = orderIndex + 1; otherIndex < order.size(); otherIndex++)
+                {
+                    const DDGIMemoryBlock& other = pool->blocks[order[otherIndex]];
+                    if (other.memoryTypeIndex != block.memoryTypeIndex || other.flags != block.flags || other.linear != block.linear) continue;
+                    available += (other.size - other.usedSize);
+                }
+                source[order[orderIndex]] = (available >= block.usedSize);
+            }
+
+            uint32_t numMoves = 0;
+            std::vector<DDGIMemoryAllocation*> allocations = pool->allocations;
+            for (DDGIMemoryAllocation* allocation : allocations)
+            {
+                if (numMoves == maxMoves) break;
+                if (allocation->blockIndex == UINT32_MAX || !source[allocation->blockIndex]) continue;
+
+                DDGIMemoryBlock& src = pool->blocks[allocation->blockIndex];
+                for (uint32_t index = 0; index < static_cast<uint32_t>(pool->blocks.size()); index++)
+                {
+                    DDGIMemoryBlock& dst = pool->blocks[index];
+                    if (source[index] || dst.memory == nullptr || dst.memoryTypeIndex != src.memoryTypeIndex || dst.flags != src.flags || dst.linear != src.linear) continue;
+
+                    VkDeviceSize offset = 0;
+                    if (!TakeBlockRange(dst, allocation->size, allocation->alignment, offset)) continue;
+
+                    if (!callback(allocation, dst.memory, offset, userData))
+                    {
+                        ReturnBlockRange(dst, offset, allocation->size);
+                        break;
+                    }
+
+                    ReturnBlockRange(src, allocation->offset, allocation->size);
+                    allocation->memory = dst.memory;
+                    allocation->offset = offset;
+                    allocation->mappedData = dst.mappedData ? dst.mappedData + offset : nullptr;
+                    allocation->blockIndex = index;
+                    numMoves++;
+                    break;
+                }
+            }
+
+            return numMoves;
+        }
+
+        uint32_t ReleaseDDGIMemoryPoolEmptyBlocks(DDGIMemoryPool* pool)
+        {
+            if (pool == nullptr) return 0;
+
+            uint32_t numReleased = 0;
+            for (DDGIMemoryBlock& block : pool->blocks)
+            {
+                if (block.memory == nullptr || block.numAllocations > 0) continue;
+                vkFreeMemory(pool->device, block.memory, nullptr);
+                block = {};
+                numReleased++;
+            }
+            return numReleased;
+        }
+
+        VkDeviceSize GetDDGIMemoryPoolSizeInBytes(const DDGIMemoryPool* pool)
+        {
+            VkDeviceSize size = 0;
+            if (pool == nullptr) return size;
+            for (const DDGIMemoryBlock& block : pool->blocks) size += block.size;
+            return size + pool->dedicatedSizeInBytes;
+        }
+
+        uint32_t GetDDGIMemoryPoolDeviceAllocationCount(const DDGIMemoryPool* pool)
+        {
+            if (pool == nullptr) return 0;
+            uint32_t count = pool->numDedicatedAllocations;
+            for (const DDGIMemoryBlock& block : pool->blocks)
+            {
+                if (block.memory != nullptr) count++;
+            }
+            return count;
+        }
+
         //------------------------------------------------------------------------
         // Private DDGIVolume Functions
         //------------------------------------------------------------------------
@@ -937,6 +1397,7 @@ namespace rtxgi
                 m_device = managed.device;
                 m_physicalDevice = managed.physicalDevice;
                 m_descriptorPool = managed.descriptorPool;
+                m_memoryPool = managed.memoryPool;
 
                 // Create the descriptor set layout and pipeline layout
                 if(!CreateLayouts()) return ERTXGIStatus::ERROR_DDGI_VK_CREATE_FAILURE_LAYOUTS;
@@ -1102,6 +1563,9 @@ namespace rtxgi
             // Validate the probe counts
             if (desc.probeCounts.x <= 0 || desc.probeCounts.y <= 0 || desc.probeCounts.z <= 0) return ERTXGIStatus::ERROR_DDGI_INVALID_PROBE_COUNTS;
 
+            // Validate the probe ray count, it is packed in 13 bits of the GPU volume desc (see PackDDGIVolumeDescGPU())
+            if (desc.probeNumRays < 1 || desc.probeNumRays > 8191) return ERTXGIStatus::ERROR_DDGI_INVALID_PROBE_NUM_RAYS;
+
             // Validate the resource indices buffer (when necessary)
             if(resources.bindless.enabled)
             {
@@ -1115,6 +1579,9 @@ namespace rtxgi
             if (resources.managed.enabled && resources.unmanaged.enabled) return ERTXGIStatus::ERROR_DDGI_INVALID_RESOURCES_DESC;
             if (!resources.managed.enabled && !resources.unmanaged.enabled) return ERTXGIStatus::ERROR_DDGI_INVALID_RESOURCES_DESC;
 
+            // Sparse probe textures are only implemented for D3D12
+            if (desc.probeSparseTexturesEnabled) return ERTXGIStatus::ERROR_DDGI_SPARSE_TEXTURES_UNSUPPORTED;
+
             // Validate the resources
             ERTXGIStatus result = ERTXGIStatus::OK;
         #if RTXGI_DDGI_RESOURCE_MANAGEMENT
@@ -1150,6 +1617,12 @@ namespace rtxgi
             // Store the new volume descriptor
             m_desc = desc;
 
+            // Upload the constants on the next UploadDDGIVolumeConstants() call
+            ResetConstantsUploaded();
+
+            // Relocate and classify every probe while the new probes settle
+            OnLargeObjectChange();
+
             // Vulkan only: Force relocation reset in case the allocated memory isn't zeroed
             if(m_desc.probeRelocationEnabled) m_desc.probeRelocationNeedsReset = true;
 
@@ -1228,6 +1701,7 @@ namespace rtxgi
                 { 0.f, 1.f, 0.f },
                 { 0.f, 0.f, 1.f },
             };
+            m_probeRayRotationIndex = 0;
 
             m_probeScrollOffsets = {};
 
@@ -1259,33 +1733,34 @@ namespace rtxgi
             // Texture Arrays
             vkDestroyImage(m_device, m_probeRayData, nullptr);
             vkDestroyImageView(m_device, m_probeRayDataView, nullptr);
-            vkFreeMemory(m_device, m_probeRayDataMemory, nullptr);
+            ReleaseMemory(m_probeRayDataMemory, m_probeRayDataAllocation);
 
             vkDestroyImage(m_device, m_probeIrradiance, nullptr);
             vkDestroyImageView(m_device, m_probeIrradianceView, nullptr);
-            vkFreeMemory(m_device, m_probeIrradianceMemory, nullptr);
+            ReleaseMemory(m_probeIrradianceMemory, m_probeIrradianceAllocation);
 
             vkDestroyImage(m_device, m_probeDistance, nullptr);
             vkDestroyImageView(m_device, m_probeDistanceView, nullptr);
-            vkFreeMemory(m_device, m_probeDistanceMemory, nullptr);
+            ReleaseMemory(m_probeDistanceMemory, m_probeDistanceAllocation);
 
             vkDestroyImage(m_device, m_probeData, nullptr);
             vkDestroyImageView(m_device, m_probeDataView, nullptr);
-            vkFreeMemory(m_device, m_probeDataMemory, nullptr);
+            ReleaseMemory(m_probeDataMemory, m_probeDataAllocation);
 
             vkDestroyImage(m_device, m_probeVariability, nullptr);
             vkDestroyImageView(m_device, m_probeVariabilityView, nullptr);
-            vkFreeMemory(m_device, m_probeVariabilityMemory, nullptr);
+            ReleaseMemory(m_probeVariabilityMemory, m_probeVariabilityAllocation);
 
             vkDestroyImage(m_device, m_probeVariabilityAverage, nullptr);
             vkDestroyImageView(m_device, m_probeVariabilityAverageView, nullptr);
-            vkFreeMemory(m_device, m_probeVariabilityAverageMemory, nullptr);
+            ReleaseMemory(m_probeVariabilityAverageMemory, m_probeVariabilityAverageAllocation);
 
             vkDestroyBuffer(m_device, m_probeVariabilityReadback, nullptr);
             vkFreeMemory(m_device, m_probeVariabilityReadbackMemory, nullptr);
 
             m_descriptorSetLayout = nullptr;
             m_descriptorPool = nullptr;
+            m_memoryPool = nullptr;
             m_device = nullptr;
             m_physicalDevice = nullptr;
         #endif
@@ -1426,6 +1901,14 @@ namespace rtxgi
             return true;
         }
 
+        void DDGIVolume::ReleaseMemory(VkDeviceMemory& memory, DDGIMemoryAllocation*& allocation)
+        {
+            // Memory suballocated from the pool is returned to it, other memory is freed
+            if (allocation != nullptr) FreeDDGIMemory(m_memoryPool, allocation);
+            else vkFreeMemory(m_device, memory, nullptr);
+            memory = nullptr;
+        }
+
         bool DDGIVolume::CreateDescriptorSet()
         {
             // Describe the descriptor set allocation
@@ -1580,7 +2063,7 @@ namespace rtxgi
             return true;
         }
 
-        bool DDGIVolume::CreateTexture(uint32_t width, uint32_t height, uint32_t arraySize, VkFormat format, VkImageUsageFlags usage, VkImage* image, VkDeviceMemory* imageMemory, VkImageView* imageView)
+        bool DDGIVolume::CreateTexture(uint32_t width, uint32_t height, uint32_t arraySize, VkFormat format, VkImageUsageFlags usage, VkImage* image, VkDeviceMemory* imageMemory, DDGIMemoryAllocation** allocation, VkImageView* imageView)
         {
             // Describe the texture
             VkImageCreateInfo imageCreateInfo = {};
@@ -1602,18 +2085,27 @@ namespace rtxgi
             VkResult result = vkCreateImage(m_device, &imageCreateInfo, nullptr, image);
             if (VKFAILED(result)) return false;
 
-            // Get memory requirements
-            VkMemoryRequirements reqs;
-            vkGetImageMemoryRequirements(m_device, *image, &reqs);
-
-            // Allocate memory
-            VkMemoryAllocateFlags flags = 0;
             VkMemoryPropertyFlags props = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-            if (!AllocateMemory(reqs, props, flags, imageMemory)) return false;
+            if (m_memoryPool != nullptr)
+            {
+                // Suballocate memory from the pool and bind it to the texture resource
+                if (AllocateDDGIImageMemory(m_memoryPool, *image, props, allocation) != ERTXGIStatus::OK) return false;
+                *imageMemory = (*allocation)->memory;
+            }
+            else
+            {
+                // Get memory requirements
+                VkMemoryRequirements reqs;
+                vkGetImageMemoryRequirements(m_device, *image, &reqs);
 
-            // Bind the memory to the texture resource
-            result = vkBindImageMemory(m_device, *image, *imageMemory, 0);
-            if (VKFAILED(result)) return false;
+                // Allocate memory
+                VkMemoryAllocateFlags flags = 0;
+                if (!AllocateMemory(reqs, props, flags, imageMemory)) return false;
+
+                // Bind the memory to the texture resource
+                result = vkBindImageMemory(m_device, *image, *imageMemory, 0);
+                if (VKFAILED(result)) return false;
+            }
 
             // Describe the texture's image view
             VkImageViewCreateInfo imageViewCreateInfo = {};
@@ -1637,7 +2129,7 @@ namespace rtxgi
         {
             vkDestroyImage(m_device, m_probeRayData, nullptr);
             vkDestroyImageView(m_device, m_probeRayDataView, nullptr);
-            vkFreeMemory(m_device, m_probeRayDataMemory, nullptr);
+            ReleaseMemory(m_probeRayDataMemory, m_probeRayDataAllocation);
 
             uint32_t width = 0;
             uint32_t height = 0;
@@ -1651,7 +2143,7 @@ namespace rtxgi
             VkImageUsageFlags usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 
             // Create the texture, allocate memory, and bind the memory
-            bool result = CreateTexture(width, height, arraySize, format, usage, &m_probeRayData, &m_probeRayDataMemory, &m_probeRayDataView);
+            bool result = CreateTexture(width, height, arraySize, format, usage, &m_probeRayData, &m_probeRayDataMemory, &m_probeRayDataAllocation, &m_probeRayDataView);
             if (!result) return false;
         #ifdef RTXGI_GFX_NAME_OBJECTS
             std::string name = "DDGIVolume[" + std::to_string(desc.index) + "], Probe Ray Data";
@@ -1669,7 +2161,7 @@ namespace rtxgi
         {
             vkDestroyImage(m_device, m_probeIrradiance, nullptr);
             vkDestroyImageView(m_device, m_probeIrradianceView, nullptr);
-            vkFreeMemory(m_device, m_probeIrradianceMemory, nullptr);
+            ReleaseMemory(m_probeIrradianceMemory, m_probeIrradianceAllocation);
 
             uint32_t width = 0;
             uint32_t height = 0;
@@ -1683,7 +2175,7 @@ namespace rtxgi
             VkImageUsageFlags usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 
             // Create the texture, allocate memory, and bind the memory
-            bool result = CreateTexture(width, height, arraySize, format, usage, &m_probeIrradiance, &m_probeIrradianceMemory, &m_probeIrradianceView);
+            bool result = CreateTexture(width, height, arraySize, format, usage, &m_probeIrradiance, &m_probeIrradianceMemory, &m_probeIrradianceAllocation, &m_probeIrradianceView);
             if (!result) return false;
         #ifdef RTXGI_GFX_NAME_OBJECTS
             std::string name = "DDGIVolume[" + std::to_string(desc.index) + "], Probe Irradiance";
@@ -1700,7 +2192,7 @@ namespace rtxgi
         {
             vkDestroyImage(m_device, m_probeDistance, nullptr);
             vkDestroyImageView(m_device, m_probeDistanceView, nullptr);
-            vkFreeMemory(m_device, m_probeDistanceMemory, nullptr);
+            ReleaseMemory(m_probeDistanceMemory, m_probeDistanceAllocation);
 
             uint32_t width = 0;
             uint32_t height = 0;
@@ -1714,7 +2206,7 @@ namespace rtxgi
             VkImageUsageFlags usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 
             // Create the texture, allocate memory, and bind the memory
-            bool result = CreateTexture(width, height, arraySize, format, usage, &m_probeDistance, &m_probeDistanceMemory, &m_probeDistanceView);
+            bool result = CreateTexture(width, height, arraySize, format, usage, &m_probeDistance, &m_probeDistanceMemory, &m_probeDistanceAllocation, &m_probeDistanceView);
             if (!result) return false;
         #ifdef RTXGI_GFX_NAME_OBJECTS
             std::string name = "DDGIVolume[" + std::to_string(desc.index) + "], Probe Distance";
@@ -1731,7 +2223,7 @@ namespace rtxgi
         {
             vkDestroyImage(m_device, m_probeData, nullptr);
             vkDestroyImageView(m_device, m_probeDataView, nullptr);
-            vkFreeMemory(m_device, m_probeDataMemory, nullptr);
+            ReleaseMemory(m_probeDataMemory, m_probeDataAllocation);
 
             uint32_t width = 0;
             uint32_t height = 0;
@@ -1745,7 +2237,7 @@ namespace rtxgi
             VkImageUsageFlags usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 
             // Create the texture, allocate memory, and bind the memory
-            bool result = CreateTexture(width, height, arraySize, format, usage, &m_probeData, &m_probeDataMemory, &m_probeDataView);
+            bool result = CreateTexture(width, height, arraySize, format, usage, &m_probeData, &m_probeDataMemory, &m_probeDataAllocation, &m_probeDataView);
             if (!result) return false;
         #ifdef RTXGI_GFX_NAME_OBJECTS
             std::string name = "DDGIVolume[" + std::to_string(desc.index) + "], Probe Data";
@@ -1762,7 +2254,7 @@ namespace rtxgi
         {
             vkDestroyImage(m_device, m_probeVariability, nullptr);
             vkDestroyImageView(m_device, m_probeVariabilityView, nullptr);
-            vkFreeMemory(m_device, m_probeVariabilityMemory, nullptr);
+            ReleaseMemory(m_probeVariabilityMemory, m_probeVariabilityAllocation);
 
             uint32_t width = 0;
             uint32_t height = 0;
@@ -1776,7 +2268,7 @@ namespace rtxgi
             VkImageUsageFlags usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
 
             // Create the texture, allocate memory, and bind the memory
-            bool result = CreateTexture(width, height, arraySize, format, usage, &m_probeVariability, &m_probeVariabilityMemory, &m_probeVariabilityView);
+            bool result = CreateTexture(width, height, arraySize, format, usage, &m_probeVariability, &m_probeVariabilityMemory, &m_probeVariabilityAllocation, &m_probeVariabilityView);
             if (!result) return false;
         #ifdef RTXGI_GFX_NAME_OBJECTS
             std::string name = "DDGIVolume[" + std::to_string(desc.index) + "], Probe Variability";
@@ -1793,7 +2285,7 @@ namespace rtxgi
         {
             vkDestroyImage(m_device, m_probeVariabilityAverage, nullptr);
             vkDestroyImageView(m_device, m_probeVariabilityAverageView, nullptr);
-            vkFreeMemory(m_device, m_probeVariabilityAverageMemory, nullptr);
+            ReleaseMemory(m_probeVariabilityAverageMemory, m_probeVariabilityAverageAllocation);
 
             uint32_t width = 0;
             uint32_t height = 0;
@@ -1807,7 +2299,7 @@ namespace rtxgi
             VkImageUsageFlags usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 
             // Create the texture, allocate memory, and bind the memory
-            bool result = CreateTexture(width, height, arraySize, format, usage, &m_probeVariabilityAverage, &m_probeVariabilityAverageMemory, &m_probeVariabilityAverageView);
+            bool result = CreateTexture(width, height, arraySize, format, usage, &m_probeVariabilityAverage, &m_probeVariabilityAverageMemory, &m_probeVariabilityAverageAllocation, &m_probeVariabilityAverageView);
             if (!result) return false;
         #ifdef RTXGI_GFX_NAME_OBJECTS
             std::string name = "DDGIVolume[" + std::to_string(desc.index) + "], Probe Variability Average";
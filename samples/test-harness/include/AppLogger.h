@@ -7,6 +7,7 @@
  * - D3D12 device removed reason logging
  * - Shader compilation error capture
  * - Agent-friendly log format for easy parsing
+ * - Non-blocking: entries are queued (lock-free) and written in batches by a background thread
  */
 
 #pragma once
@@ -18,6 +19,10 @@
 #include <iomanip>
 #include <mutex>
 #include <vector>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <deque>
 
 #ifdef _WIN32
 // Save and undefine Windows macros that conflict with our enum
@@ -29,6 +34,17 @@
 #pragma comment(lib, "dbghelp.lib")
 #endif
 
+// APP_LOG_MIN_LEVEL may be defined at compile time (0 = DEBUG, 1 = INFO, 2 = WARNING).
+// LOG_* macros below the level compile to nothing, their arguments are not evaluated.
+// Errors and fatal errors are always logged. Defaults to DEBUG in debug builds and INFO otherwise.
+#ifndef APP_LOG_MIN_LEVEL
+    #if _DEBUG
+        #define APP_LOG_MIN_LEVEL 0
+    #else
+        #define APP_LOG_MIN_LEVEL 1
+    #endif
+#endif
+
 namespace AppLog
 {
     enum class Level
@@ -50,6 +66,64 @@ namespace AppLog
         int line;
     };
 
+    /**
+     * Lock-free multiple producer, single consumer queue.
+     * Push() never blocks, Pop() must only be called by one thread at a time.
+     * The consumer owns a dummy node (the last popped node), producers link new nodes behind the head.
+     */
+    template<typename T>
+    class MPSCQueue
+    {
+    public:
+        MPSCQueue()
+        {
+            m_tail = new Node();
+            m_head.store(m_tail, std::memory_order_relaxed);
+        }
+
+        ~MPSCQueue()
+        {
+            T value;
+            while (Pop(value)) {}
+            delete m_tail;
+        }
+
+        MPSCQueue(const MPSCQueue&) = delete;
+        MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+        void Push(T&& value)
+        {
+            Node* node = new Node();
+            node->value = std::move(value);
+            Node* previous = m_head.exchange(node, std::memory_order_acq_rel);
+            previous->next.store(node, std::memory_order_release);
+        }
+
+        /**
+         * Pop the oldest value. Returns false if the queue is empty (or the oldest push is not linked yet).
+         */
+        bool Pop(T& value)
+        {
+            Node* next = m_tail->next.load(std::memory_order_acquire);
+            if (next == nullptr) return false;
+
+            value = std::move(next->value);
+            delete m_tail;
+            m_tail = next;
+            return true;
+        }
+
+    private:
+        struct Node
+        {
+            std::atomic<Node*> next = { nullptr };
+            T value;
+        };
+
+        std::atomic<Node*> m_head;
+        Node* m_tail = nullptr;
+    };
+
     class Logger
     {
     public:
@@ -61,7 +135,10 @@ namespace AppLog
 
         bool Initialize(const std::string& logPath = "app_log.txt")
         {
-            std::lock_guard<std::mutex> lock(m_mutex);
+            // The headless benchmark initializes the logger once per run
+            if (m_initialized.load()) Shutdown();
+
+            std::lock_guard<std::mutex> lock(m_writeMutex);
 
             m_logPath = logPath;
             m_file.open(logPath, std::ios::out | std::ios::trunc);
@@ -70,12 +147,20 @@ namespace AppLog
             // Write header
             m_file << "================================================================================\n";
             m_file << "Application Log - Sipher-DDGI Test Harness\n";
-            m_file << "Started: " << GetTimestamp() << "\n";
+            m_file << "Started: " << GetTimestamp(std::chrono::system_clock::now()) << "\n";
             m_file << "================================================================================\n\n";
             m_file << "FORMAT: [TIMESTAMP] [LEVEL] [CATEGORY] MESSAGE\n";
             m_file << "================================================================================\n\n";
             m_file.flush();
 
+            m_errorCount = 0;
+            m_warningCount = 0;
+            m_recentEntries.clear();
+
+            // Start the background writer
+            m_stop = false;
+            m_writer = std::thread(&Logger::WriterThread, this);
+
             m_initialized = true;
 
 #ifdef _WIN32
@@ -91,12 +176,23 @@ namespace AppLog
 
         void Shutdown()
         {
-            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_initialized.exchange(false)) return;
+
+            // Stop the background writer, then write what it left in the queue
+            {
+                std::lock_guard<std::mutex> wakeLock(m_wakeMutex);
+                m_stop = true;
+            }
+            m_wake.notify_one();
+            if (m_writer.joinable()) m_writer.join();
+
+            std::lock_guard<std::mutex> lock(m_writeMutex);
+            DrainQueue();
 
             if (m_file.is_open())
             {
                 m_file << "\n================================================================================\n";
-                m_file << "Application shutdown: " << GetTimestamp() << "\n";
+                m_file << "Application shutdown: " << GetTimestamp(std::chrono::system_clock::now()) << "\n";
                 m_file << "Total errors: " << m_errorCount << "\n";
                 m_file << "Total warnings: " << m_warningCount << "\n";
                 m_file << "================================================================================\n";
@@ -108,80 +204,77 @@ namespace AppLog
 #endif
         }
 
+        /**
+         * Queue a log entry, formatting and writing happen on the background writer thread.
+         * The file must have static storage (e.g. __FILE__).
+         * Errors are written before returning, the application may exit (or crash) right after logging them.
+         */
         void Log(Level level, const std::string& category, const std::string& message,
                  const char* file = nullptr, int line = 0)
         {
-            std::lock_guard<std::mutex> lock(m_mutex);
-
-            if (!m_initialized) return;
+            if (!m_initialized.load(std::memory_order_acquire)) return;
 
             // Track counts
             if (level == Level::LOG_ERROR || level == Level::LOG_FATAL) m_errorCount++;
             if (level == Level::LOG_WARNING) m_warningCount++;
 
-            // Format log entry
-            std::stringstream ss;
-            ss << "[" << GetTimestamp() << "] ";
-            ss << "[" << LevelToString(level) << "] ";
-            ss << "[" << category << "] ";
-            ss << message;
-
-            if (file && line > 0)
-            {
-                ss << " (" << ExtractFilename(file) << ":" << line << ")";
-            }
-
-            ss << "\n";
-
-            m_file << ss.str();
-            m_file.flush();  // Always flush for crash safety
-
-            // Store recent entries for crash dump
-            LogEntry entry;
-            entry.timestamp = GetTimestamp();
+            QueuedEntry entry;
+            entry.time = std::chrono::system_clock::now();
             entry.level = level;
             entry.category = category;
             entry.message = message;
-            entry.file = file ? file : "";
+            entry.file = file;
             entry.line = line;
+            m_queue.Push(std::move(entry));
 
-            m_recentEntries.push_back(entry);
-            if (m_recentEntries.size() > 100)
-            {
-                m_recentEntries.erase(m_recentEntries.begin());
-            }
+            if (level == Level::LOG_ERROR || level == Level::LOG_FATAL) Flush();
         }
 
         void LogShaderError(const std::string& shaderName, const std::string& errorMessage)
         {
-            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_initialized.load(std::memory_order_acquire)) return;
 
-            if (!m_initialized) return;
+            std::stringstream ss;
+            ss << "\n";
+            ss << "================================================================================\n";
+            ss << "[SHADER_ERROR] " << shaderName << "\n";
+            ss << "--------------------------------------------------------------------------------\n";
+            ss << errorMessage << "\n";
+            ss << "================================================================================\n\n";
 
-            m_file << "\n";
-            m_file << "================================================================================\n";
-            m_file << "[SHADER_ERROR] " << shaderName << "\n";
-            m_file << "--------------------------------------------------------------------------------\n";
-            m_file << errorMessage << "\n";
-            m_file << "================================================================================\n\n";
-            m_file.flush();
+            QueuedEntry entry;
+            entry.section = true;
+            entry.message = ss.str();
+            m_queue.Push(std::move(entry));
 
             m_errorCount++;
+            Flush();
+        }
+
+        /**
+         * Write the queued entries now, on the calling thread.
+         */
+        void Flush()
+        {
+            std::lock_guard<std::mutex> lock(m_writeMutex);
+            DrainQueue();
         }
 
 #ifdef _WIN32
         void LogD3D12DeviceRemoved(ID3D12Device* device)
         {
-            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_initialized.load(std::memory_order_acquire) || !device) return;
 
-            if (!m_initialized || !device) return;
+            // Write the queued entries first, so the recent entries are complete
+            std::lock_guard<std::mutex> lock(m_writeMutex);
+            DrainQueue();
 
             HRESULT reason = device->GetDeviceRemovedReason();
 
             m_file << "\n";
             m_file << "================================================================================\n";
             m_file << "[D3D12_DEVICE_REMOVED]\n";
-            m_file << "Timestamp: " << GetTimestamp() << "\n";
+            m_file << "Timestamp: " << GetTimestamp(std::chrono::system_clock::now()) << "\n";
             m_file << "Reason: " << D3D12DeviceRemovedReasonToString(reason) << "\n";
             m_file << "HRESULT: 0x" << std::hex << reason << std::dec << "\n";
             m_file << "--------------------------------------------------------------------------------\n";
@@ -201,15 +294,17 @@ namespace AppLog
         {
             Logger& logger = Instance();
 
-            std::lock_guard<std::mutex> lock(logger.m_mutex);
+            if (!logger.m_initialized.load()) return EXCEPTION_CONTINUE_SEARCH;
 
-            if (!logger.m_initialized) return EXCEPTION_CONTINUE_SEARCH;
+            // The crash may be on the writer thread while it holds the lock, write the crash record regardless
+            std::unique_lock<std::mutex> lock(logger.m_writeMutex, std::try_to_lock);
+            if (lock.owns_lock()) logger.DrainQueue();
 
             logger.m_file << "\n";
             logger.m_file << "********************************************************************************\n";
             logger.m_file << "[CRASH] APPLICATION CRASH DETECTED\n";
             logger.m_file << "********************************************************************************\n";
-            logger.m_file << "Timestamp: " << logger.GetTimestamp() << "\n";
+            logger.m_file << "Timestamp: " << logger.GetTimestamp(std::chrono::system_clock::now()) << "\n";
             logger.m_file << "Exception Code: 0x" << std::hex << exceptionInfo->ExceptionRecord->ExceptionCode << std::dec << "\n";
             logger.m_file << "Exception Address: 0x" << std::hex << (uintptr_t)exceptionInfo->ExceptionRecord->ExceptionAddress << std::dec << "\n";
             logger.m_file << "Exception Type: " << logger.ExceptionCodeToString(exceptionInfo->ExceptionRecord->ExceptionCode) << "\n";
@@ -347,12 +442,93 @@ namespace AppLog
 #endif
 
     private:
+        // An entry in the log queue, formatted by the writer
+        struct QueuedEntry
+        {
+            std::chrono::system_clock::time_point time;
+            Level level = Level::LOG_INFO;
+            std::string category;
+            std::string message;
+            const char* file = nullptr;
+            int line = 0;
+            bool section = false;  // The message is a preformatted section (e.g. [SHADER_ERROR]), written as is
+        };
+
+        static constexpr uint32_t WriteIntervalMs = 16; // The writer batches the entries queued in this interval
+        static constexpr size_t MaxRecentEntries = 100;
+
         Logger() = default;
         ~Logger() { Shutdown(); }
 
-        std::string GetTimestamp()
+        /**
+         * Background writer: write the queued entries in batches until Shutdown().
+         */
+        void WriterThread()
+        {
+            for (;;)
+            {
+                {
+                    std::unique_lock<std::mutex> wakeLock(m_wakeMutex);
+                    m_wake.wait_for(wakeLock, std::chrono::milliseconds(WriteIntervalMs), [this] { return m_stop; });
+                    if (m_stop) return;
+                }
+
+                std::lock_guard<std::mutex> lock(m_writeMutex);
+                DrainQueue();
+            }
+        }
+
+        /**
+         * Write every queued entry, flushing the file once. The caller holds m_writeMutex (the queue's single consumer).
+         */
+        void DrainQueue()
+        {
+            bool wrote = false;
+            QueuedEntry entry;
+            while (m_queue.Pop(entry))
+            {
+                WriteEntry(entry);
+                wrote = true;
+            }
+            if (wrote) m_file.flush();
+        }
+
+        void WriteEntry(const QueuedEntry& queued)
+        {
+            if (queued.section)
+            {
+                m_file << queued.message;
+                return;
+            }
+
+            // Format log entry
+            LogEntry entry;
+            entry.timestamp = GetTimestamp(queued.time);
+            entry.level = queued.level;
+            entry.category = queued.category;
+            entry.message = queued.message;
+            entry.file = queued.file ? queued.file : "";
+            entry.line = queued.line;
+
+            m_file << "[" << entry.timestamp << "] ";
+            m_file << "[" << LevelToString(entry.level) << "] ";
+            m_file << "[" << entry.category << "] ";
+            m_file << entry.message;
+
+            if (queued.file && queued.line > 0)
+            {
+                m_file << " (" << ExtractFilename(queued.file) << ":" << queued.line << ")";
+            }
+
+            m_file << "\n";
+
+            // Store recent entries for crash dump
+            m_recentEntries.push_back(std::move(entry));
+            if (m_recentEntries.size() > MaxRecentEntries) m_recentEntries.pop_front();
+        }
+
+        std::string GetTimestamp(std::chrono::system_clock::time_point now)
         {
-            auto now = std::chrono::system_clock::now();
             auto time = std::chrono::system_clock::to_time_t(now);
             auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
                 now.time_since_epoch()) % 1000;
@@ -382,19 +558,37 @@ namespace AppLog
             return (pos != std::string::npos) ? path.substr(pos + 1) : path;
         }
 
-        bool m_initialized = false;
+        std::atomic<bool> m_initialized = { false };
         std::string m_logPath;
-        std::ofstream m_file;
-        std::mutex m_mutex;
-        std::vector<LogEntry> m_recentEntries;
-        int m_errorCount = 0;
-        int m_warningCount = 0;
+        std::ofstream m_file;                   // Written while holding m_writeMutex
+        std::mutex m_writeMutex;
+        std::deque<LogEntry> m_recentEntries;   // Written while holding m_writeMutex
+        std::atomic<int> m_errorCount = { 0 };
+        std::atomic<int> m_warningCount = { 0 };
+
+        MPSCQueue<QueuedEntry> m_queue;
+        std::thread m_writer;
+        std::mutex m_wakeMutex;
+        std::condition_variable m_wake;
+        bool m_stop = false;                    // Written while holding m_wakeMutex
     };
 
-    // Convenience macros for logging
+    // Convenience macros for logging, compiled out below APP_LOG_MIN_LEVEL
+#if APP_LOG_MIN_LEVEL <= 0
     #define LOG_DEBUG(category, msg) AppLog::Logger::Instance().Log(AppLog::Level::LOG_DEBUG, category, msg, __FILE__, __LINE__)
+#else
+    #define LOG_DEBUG(category, msg) ((void)0)
+#endif
+#if APP_LOG_MIN_LEVEL <= 1
     #define LOG_INFO(category, msg) AppLog::Logger::Instance().Log(AppLog::Level::LOG_INFO, category, msg, __FILE__, __LINE__)
+#else
+    #define LOG_INFO(category, msg) ((void)0)
+#endif
+#if APP_LOG_MIN_LEVEL <= 2
     #define LOG_WARNING(category, msg) AppLog::Logger::Instance().Log(AppLog::Level::LOG_WARNING, category, msg, __FILE__, __LINE__)
+#else
+    #define LOG_WARNING(category, msg) ((void)0)
+#endif
     #define LOG_ERROR(category, msg) AppLog::Logger::Instance().Log(AppLog::Level::LOG_ERROR, category, msg, __FILE__, __LINE__)
     #define LOG_FATAL(category, msg) AppLog::Logger::Instance().Log(AppLog::Level::LOG_FATAL, category, msg, __FILE__, __LINE__)
 
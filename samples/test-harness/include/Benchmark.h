@@ -13,19 +13,78 @@
 #include "Instrumentation.h"
 #include "Configs.h"
 #include "Graphics.h"
+#include "Scenes.h"
 
 #include <sstream>
 
 namespace Benchmark
 {
     const static uint32_t NumBenchmarkFrames = 1024;
+    const static double BaselineToleranceMs = 0.05;     // GPU time (ms) a pass may exceed its baseline by regardless of the tolerance (timer noise of short passes)
+    const static int ExitRegression = 2;                // Exit code of a headless benchmark that regressed against its baselines
+
+    struct StatSummary
+    {
+        double mean = 0;     // milliseconds
+        double min = 0;
+        double max = 0;
+        double p50 = 0;
+        double p95 = 0;
+        double p99 = 0;
+        double stdDev = 0;
+        double low1Fps = 0;  // Frames per second at the mean of the slowest 1% of the samples
+    };
 
     struct BenchmarkRun
     {
+        uint32_t numFrames = NumBenchmarkFrames;
+        uint32_t numWarmupFrames = 0;
+        uint32_t numFramesWarmed = 0;
         uint32_t numFramesBenched = 0;
+        uint32_t numCounterFrames = 0;                                      // Benchmarked frames with a GPU counters readback
+        uint64_t lastCounterFrame = 0;
+        uint64_t counterTotals[Instrumentation::COUNTER_COUNT] = {};
+        uint64_t csInvocationTotals[Instrumentation::PASS_COUNT] = {};
         std::stringstream cpuTimingCsv;
         std::stringstream gpuTimingCsv;
+        std::stringstream radianceCacheCsv;                                 // Radiance cache occupancy of each counter readback
+        bool finished = false;                                              // The results were written to disk
+        std::vector<std::pair<std::string, double>> gpuMedians;             // Median GPU time (ms) of each stat, compared against the baselines
     };
     void StartBenchmark(BenchmarkRun& benchmarkRun, Instrumentation::Performance& perf, Configs::Config& config, Graphics::Globals& gfx);
     bool UpdateBenchmark(BenchmarkRun& benchmarkRun, Instrumentation::Performance& perf, Configs::Config& config, Graphics::Globals& gfx, std::ofstream& log);
+    bool UpdateBenchmarkCamera(const BenchmarkRun& benchmarkRun, const Configs::Config& config, Scenes::Scene& scene);
+    bool CompareToBaseline(const BenchmarkRun& benchmarkRun, const Configs::Config& config, std::ofstream& log);
+
+    // The passes with both a ray tracing pipeline and an inline ray tracing (compute) backend
+    enum ERayTracingPass
+    {
+        RT_PASS_GBUFFER = 0,
+        RT_PASS_RTAO,
+        RT_PASS_RADIANCE_CACHE,
+        RT_PASS_COUNT
+    };
+
+    // Values of the app.rayTracingBackend config
+    enum ERayTracingBackend
+    {
+        RT_BACKEND_AUTO = 0,
+        RT_BACKEND_PIPELINE,
+        RT_BACKEND_INLINE
+    };
+
+    struct BackendSelection
+    {
+        const static uint32_t NumWarmupFrames = 8;          // Frames rendered with a backend before it is sampled (PSO warm up, timestamp readback latency)
+        const static uint32_t NumSampleFrames = 32;         // Frames sampled per backend
+
+        bool running = false;
+        uint32_t frame = 0;                                 // Frames measured since the selection started
+        bool defaultInline[RT_PASS_COUNT] = {};             // Backends of the config, kept for passes without samples
+        double gpuTimeTotals[RT_PASS_COUNT][2] = {};        // Summed GPU times (ms) of the pipeline (0) and inline (1) backends
+        uint32_t numSamples[RT_PASS_COUNT][2] = {};
+        std::string cachePath;
+    };
+    void StartBackendSelection(BackendSelection& selection, Configs::Config& config, std::ofstream& log);
+    void UpdateBackendSelection(BackendSelection& selection, const Instrumentation::Performance& perf, Configs::Config& config, std::ofstream& log);
 }
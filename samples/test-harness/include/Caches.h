@@ -14,6 +14,57 @@
 
 namespace Caches
 {
+    // The texels of a DDGIVolume probe texture array, tightly packed (rowBytes per row, height rows per slice)
+    struct DDGIVolumeCacheTexture
+    {
+        uint32_t format = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t arraySize = 0;
+        uint32_t rowBytes = 0;
+        std::vector<uint8_t> texels;
+    };
+
+    // The probe textures of a converged DDGIVolume. The key identifies the scene and volume the probes were computed for.
+    struct DDGIVolumeCache
+    {
+        uint64_t key = 0;
+        DDGIVolumeCacheTexture irradiance;
+        DDGIVolumeCacheTexture distance;
+        DDGIVolumeCacheTexture probeData;
+        DDGIVolumeCacheTexture variability;
+    };
+
+    // The occupied slots of a radiance cache, each with its metadata, resolved radiance, and history entries.
+    // Cells stay in their hash table slots, the key identifies the scene and cache settings they were computed for.
+    struct RadianceCacheCells
+    {
+        uint64_t key = 0;
+        uint32_t slotCount = 0;                // Slots of the hash table, across every cascade
+        uint32_t metadataStride = 0;
+        uint32_t radianceStride = 0;
+        uint32_t historyStride = 0;
+        std::vector<uint32_t> slots;
+        std::vector<uint8_t> metadata;         // metadataStride bytes per slot
+        std::vector<uint8_t> radiance;         // radianceStride bytes per slot
+        std::vector<uint8_t> history;          // historyStride bytes per slot
+    };
+
+    // 64-bit FNV-1a hash, pass the previous hash to hash several values
+    uint64_t Hash(const void* data, size_t size, uint64_t hash = 14695981039346656037ull);
+    bool HashFile(const std::string& filepath, uint64_t& hash);
+    uint64_t GetFileStamp(const std::string& filepath);
+    bool IsFileCurrent(const std::string& filepath, uint64_t& stamp, uint64_t hash);
+    bool MapFile(const std::string& filepath, uint8_t** data, uint64_t* size);
+    void UnmapFile(uint8_t* data, uint64_t size);
+
     bool Serialize(const std::string& filepath, Scenes::Scene& scene, std::ofstream& log);
     bool Deserialize(const std::string& filepath, Scenes::Scene& scene, std::ofstream& log);
+    void Unmap(Scenes::Scene& scene);
+
+    bool Serialize(const std::string& filepath, DDGIVolumeCache& cache, std::ofstream& log);
+    bool Deserialize(const std::string& filepath, uint64_t key, DDGIVolumeCache& cache, std::ofstream& log);
+
+    bool Serialize(const std::string& filepath, RadianceCacheCells& cells, std::ofstream& log);
+    bool Deserialize(const std::string& filepath, uint64_t key, RadianceCacheCells& cells, std::ofstream& log);
 }
@@ -36,13 +36,20 @@ namespace Configs
         std::string        name = "";
         uint32_t           index = 0;
         uint32_t           rngSeed = 0;
+        bool               probeRayRotationLowDiscrepancy = false;
 
         bool               insertPerfMarkers = false;
         bool               showProbes = false;
         bool               clearProbes = false;
         bool               probeRelocationEnabled = false;
         bool               probeClassificationEnabled = false;
+        bool               probeBlendingActiveOnly = false;
+        bool               probeVisibilityMaskEnabled = false;
         bool               probeVariabilityEnabled = false;
+        bool               probeVariabilityFreezeOnGPU = false;  // Freeze the converged volume on the GPU (requires probe scheduling), instead of through the variability readback
+        bool               probeSchedulingEnabled = false;
+        bool               probeAtlasDoubleBuffered = false;
+        bool               probeSparseTexturesEnabled = false;   // D3D12 managed mode: back the probe textures with memory only for tiles of active probes
         bool               infiniteScrollingEnabled = false;
         bool               clearProbeVariability = false;
 
@@ -66,6 +73,33 @@ namespace Configs
 
         float              probeMinFrontfaceDistance = 0.f;
 
+        int                probeSchedulingMaxIntervalLog2 = 3;
+        int                probeSchedulingFullRateDistance = 4;
+        float              probeSchedulingVariabilityThreshold = 0.02f;
+
+        int                probeTimeSliceStrideLog2 = 0;
+
+        int                probeDerivationVolume = -1;    // Index of a nested volume the volume's probes inside of are derived from instead of traced (-1: none)
+
+        bool               probeEventUpdatesEnabled = false;
+        float              probeEventHysteresis = 0.5f;
+        int                probeEventRecoveryFrames = 32;
+        int                probeEventIdleIntervalLog2 = 4;
+        float              probeEventIdleVariabilityThreshold = 0.01f;
+
+        bool               probeAdaptiveRaysEnabled = false;
+        int                probeAdaptiveRaysMin = 32;
+        float              probeAdaptiveRaysVariabilityThreshold = 0.1f;
+
+        bool               probeAdaptiveHysteresisEnabled = false;
+        float              probeAdaptiveHysteresisMin = 0.8f;
+        float              probeAdaptiveHysteresisMax = 0.99f;
+        float              probeAdaptiveHysteresisVariabilityThreshold = 0.1f;
+
+        bool               probeCacheEnabled = false;     // Load the volume's probes from its cache file at startup, store them at shutdown
+        bool               probeBakeEnabled = false;      // Freeze the volume once converged and sample a BC6H compressed copy of its irradiance
+        int                budgetPriority = 0;            // Volumes with a lower priority are degraded first to fit ddgi.memoryBudget, and blended after higher priority volumes
+
         DDGIVolumeTextures textureFormats;
 
         // Visualization
@@ -86,18 +120,48 @@ namespace Configs
         bool enabled = true;
         bool reload = false;
         bool showProbes = false;
+        bool rasterizeProbes = true;          // Draw the probe visualization (requires rasterizer ordered views), instead of ray tracing a TLAS of probe spheres
+        bool proceduralProbes = false;        // Ray trace procedural (AABB intersection) probe spheres, instead of icosphere LODs selected by their size on screen
         bool showTextures = false;
+        uint32_t textureVisZoom = 0;          // Magnification of the texture visualization, as a power of two
+        uint32_t textureVisPanX = 0;          // Top left texel of the texture visualization's layout that is shown (texels of the unmagnified layout)
+        uint32_t textureVisPanY = 0;
+        uint32_t textureVisRefreshFrames = 8; // Frames between redraws of an unchanged texture visualization (0: redraw only when its view changes)
         bool showIndirect = false;
         bool insertPerfMarkers = true;
         bool shaderExecutionReordering = false;
-        bool useInlineRayTracing = false;
+        bool useInlineRayTracing = true;      // D3D12: shade the radiance cache with RadianceCacheCS (inline ray tracing) instead of RadianceCacheRGS (ray tracing pipeline)
         bool showWorldRadianceCache = false;
         bool showDirectRadianceCache = true;
         bool showIndirectRadianceCache = true;
+        bool showRadianceCacheCoverage = false; // Show a heatmap of the probe rays that hit each radiance cache cell (requires app.gpuCounters)
+        uint32_t indirectScale = 1;           // Indirect lighting resolution divisor (1: full, 2: half, 4: quarter resolution), upsampled with GBuffer depth and normals
+        bool radianceCacheFileEnabled = false; // Load the radiance cache cells from the scene's radiance cache file at startup, store them at shutdown
+        uint32_t radianceCacheHash = 0;       // Radiance cache cell hash function: 0 (FNV-1a + Wang), 1 (PCG3D), 2 (xxHash32), 3 (Morton ordered bricks), see SpatialHash.hlsl
+        bool radianceCacheBricks = false;     // Hash 4x4x4 bricks of radiance cache cells to buckets of 64 contiguous slots, for cache line locality of neighbouring lookups
+        uint32_t memoryBudget = 0;            // Megabytes of GPU memory for the textures of all DDGIVolumes, degraded by priority to fit (0: no budget)
+        bool memoryBudgetAdaptive = false;    // Also fit the volumes to the video memory left by the rest of the process, re-planned as it changes
+        float costBudget = 0.f;               // Milliseconds of DDGI GPU time, probe and radiance cache work and indirect resolution are stepped down and back up to fit (0: no budget)
+        float costBudgetHysteresis = 0.1f;    // Fraction of costBudget the GPU time may drift over or under before a step is taken or undone
+        bool probePlacement = false;          // Replace the DDGIVolumes with volumes fit to the scene geometry, the first volume is their template (see DDGI::PlaceProbes)
+        uint32_t probePlacementBudget = 65536; // Probes of all placed volumes
+        uint32_t probePlacementMaxVolumes = 4; // Placed volumes, including the coarse volume that covers the whole scene
+        float probePlacementMinSpacing = 0.5f; // Smallest probe spacing of a placed volume
+        bool probeDeltas = false;             // D3D12: create the buffers of the packets that stream the volumes' changed probe tiles (see DDGI::QueueProbeDeltaExport)
         uint32_t selectedVolume = 0;
         std::vector<DDGIVolume> volumes;
     };
 
+    // The cheapest way to apply a change of a DDGIVolume's config to the running volume (see DiffDDGIVolume)
+    enum class EDDGIVolumeChange
+    {
+        NONE = 0,   // Nothing the volume uses changed (visualization settings are read from the config every frame)
+        CONSTANTS,  // Set on the running volume, uploaded with the volume constants
+        SHADERS,    // Read when the volume is created: its shaders and pipelines are recreated, the probe textures are kept
+        TEXTURES,   // Probe, ray, or texel counts: the volume shaders are recompiled and the resized probe textures reallocated
+        REBUILD     // The volume is destroyed and created again
+    };
+
     // ------------------------------------------------
 
     struct PostProcessTonemapping
@@ -113,7 +177,9 @@ namespace Configs
     struct PostProcessExposure
     {
         bool  enabled = false;
-        float fstops = 1.f;
+        float fstops = 1.f;             // Exposure, or the compensation of the automatic exposure
+        bool  automatic = false;        // Expose the frame's average luminance to middle grey (D3D12 only)
+        float adaptation = 0.05f;       // Fraction of the automatic exposure change applied each frame
     };
 
     struct PostProcessGamma
@@ -121,6 +187,11 @@ namespace Configs
         bool enabled = false;
     };
 
+    struct PostProcessVariableRateShading
+    {
+        bool enabled = false;
+    };
+
     struct PostProcess
     {
         bool enabled = true;
@@ -129,6 +200,7 @@ namespace Configs
         PostProcessDithering dither;
         PostProcessExposure exposure;
         PostProcessGamma gamma;
+        PostProcessVariableRateShading vrs;
     };
 
     struct RTAO
@@ -143,6 +215,8 @@ namespace Configs
         float powerLog = -1.f;
         float filterDistanceSigma = 10.f;
         float filterDepthSigma = 0.25f;
+        bool  temporal = false;              // Accumulate occlusion over frames, tracing half of the pixels (checkerboard) each frame
+        uint32_t temporalMaxHistory = 16;    // Maximum number of frames accumulated per pixel
     };
 
     struct PathTrace
@@ -152,11 +226,17 @@ namespace Configs
         bool  progressive = true;
         bool  shaderExecutionReordering = false;
         bool  useInlineRayTracing = false;
+        bool  wavefront = false;
+        bool  convergence = false;              // Stop accumulating when the estimated relative error is below the threshold
+        bool  convergenceSteering = false;      // Stop tracing the tiles that are converged
+        bool  converged = false;                // Set by the path tracer when every tile is converged
         bool  reload = false;
         float rayNormalBias = 0.001f;
         float rayViewBias = 0.001f;
+        float convergenceThreshold = 0.01f;     // Relative error (standard error / mean) of a converged tile
         uint32_t numBounces = 1;
         uint32_t samplesPerPixel = 1;
+        uint32_t radianceCacheBounce = 0;       // Paths end in the DDGI radiance cache from this bounce on (1 or 2), once their footprint covers a cell (0: off, D3D12 ray tracing pipeline only)
     };
 
     struct Light
@@ -189,9 +269,15 @@ namespace Configs
         std::string name = "";
         std::string path = "";
         std::string file = "";
+        std::string placements = "";             // Binary file of instanced DDGIVolumes and lights, added after the config file's (see Configs::LoadPlacements)
         std::string screenshotPath = "";
         DirectX::XMFLOAT3 skyColor = { 0.f, 0.f, 0.f };
         float skyIntensity = 1.f;
+        bool sortTriangles = false;              // Sort mesh primitive triangles spatially at scene cache build, for faster BLAS traversal
+
+        bool textureStreaming = false;           // Stream scene texture mip levels from shader feedback, only the mip tails stay resident
+        uint32_t textureStreamingBudget = 4096;  // Max megabytes of resident scene textures
+        uint32_t textureStreamingTailSize = 128; // Mip levels with at most this many texels along the largest axis are the mip tail
 
         std::vector<Camera> cameras;
         std::vector<Light> lights;
@@ -202,6 +288,7 @@ namespace Configs
         bool  invertPan = true;
         float movementSpeed = 1.f;
         float rotationSpeed = 1.f;
+        bool  lateLatch = true;             // DDGI mode: process the mouse again just before submit and rewrite the frame's camera constants (see Graphics::LatchCamera)
     };
 
     struct Shaders
@@ -211,6 +298,31 @@ namespace Configs
         bool  disableValidation = false;    // disable validation
         bool  shaderSymbols = false;        // include symbols in shader blobs
         bool  lifetimeMarkers = false;      // enable variable lifetime markers
+        bool  cache = true;                 // load unchanged shaders from the on-disk shader cache instead of compiling them
+        bool  pipelineCache = true;         // load pipeline state objects from the on-disk pipeline cache instead of creating them
+        uint32_t watchPort = 0;             // reload the workloads of the shaders rebuilt by tools/ShaderCompiler --watch --notify <port>, 0 = off (see ShaderWatch.h)
+    };
+
+    struct BenchmarkKeyframe
+    {
+        DirectX::XMFLOAT3 position = { 0.f, 0.f, 0.f };
+        float yaw = 0.f;
+        float pitch = 0.f;
+    };
+
+    struct Benchmark
+    {
+        bool        headless = false;                   // Set by --benchmark: run the benchmark of each config without user input, then exit
+        uint32_t    warmupFrames = 0;                   // Frames rendered (and not timed) before the benchmark
+        uint32_t    frames = 1024;                      // Frames timed by the benchmark
+        std::vector<BenchmarkKeyframe> keyframes;       // Camera spline followed by the benchmark, the camera doesn't move without keyframes
+        std::vector<std::string> configs;               // Config files benchmarked in turn by --benchmark
+        std::string baselines = "";                     // Set by --baselines: folder of the per config baselines the headless benchmark is compared against
+        bool        updateBaselines = false;            // Set by --update-baselines: write the results over the baselines instead of comparing them
+        float       tolerance = 5.f;                    // Set by --tolerance: percent a pass's GPU time may exceed its baseline by
+        bool        compareImages = false;              // Set by --compare-images: differing image hashes fail the comparison (needs deterministic rendering)
+        std::string record = "";                        // Set by --record <file>: write the inputs, camera, and timing of each frame to a replay log (see Replay.h)
+        std::string replay = "";                        // Set by --replay <file>: drive the frames from a replay log, then compare the GPU times against the recording
     };
 
     struct Application
@@ -221,9 +333,26 @@ namespace Configs
         bool        fullscreen = false;
         bool        showUI = true;
         bool        showPerf = false;
+        bool        uiLowOverhead = false;       // Build the UI only after input and when its stats refresh (4 Hz), other frames render the previous draw data (see UI::BeginFrame)
         bool        benchmarkRunning = false;
+        bool        visibilityBuffer = false;    // GBuffer writes primary ray hit IDs, world positions and normals are reconstructed on demand
+        bool        gbufferTiles = false;        // D3D12: GBuffer classifies its tiles, indirect lighting and RTAO dispatch indirectly over the tiles with geometry
+        bool        gpuCounters = false;         // DDGI passes count rays and radiance cache lookups, shown in the perf window and benchmark output
+        bool        parallelRecording = true;    // Record the render passes on their own command lists in parallel (see Graphics::RecordPasses)
+        bool        enhancedBarriers = true;     // D3D12: flush the batched DDGI stage barriers as enhanced barriers when supported (see D3D12::FlushBarriers)
+        bool        gbufferInlineRayTracing = true;  // GBuffer traces with inline ray tracing (GBufferCS) instead of the ray tracing pipeline (GBufferRGS)
+
+        uint32_t    rayTracingBackend = 0;       // GBuffer, RTAO, and radiance cache shading: 0 = the faster backend on this GPU (measured at startup and cached), 1 = ray tracing pipeline, 2 = inline ray tracing
 
         uint32_t    benchmarkProgress = 0;
+        uint32_t    traceFrames = 60;            // Frames recorded by a trace capture (F3), written to trace.json in the screenshot path
+        uint32_t    captureInterval = 0;         // Frames between automatic intermediate image captures (as F2), for soak tests, 0 = off
+        uint32_t    captureFormat = 0;           // Captured image files: 0 = PNG, 1 = PNG with fast compression, 2 = QOI, 3 = uncompressed TGA (see ImageCapture::EFormat)
+        bool        captureHdr = false;          // D3D12: half-float resources are captured as Radiance HDR files, without tone mapping
+        bool        hotReload = false;           // Watch the config file and apply the changes of its DDGIVolumes while running (see Configs::ReloadDDGIVolumes)
+        bool        dynamicResolution = false;   // DDGI mode: scale the resolution of the screen-space passes to hold the target frame rate, upscaled before the UI (see DynamicResolution.h)
+        float       dynamicResolutionFPS = 60.f;         // Target frame rate of the GPU work
+        float       dynamicResolutionMinScale = 0.5f;    // Lowest resolution scale (per axis)
 
         std::string filepath = "";
         std::string root = "";
@@ -231,6 +360,7 @@ namespace Configs
         std::string title = "";
         std::string api = "";
         std::string gpuName = "";
+        uint64_t    gpuDriverVersion = 0;
 
         ERenderMode renderMode = ERenderMode::DDGI;
 
@@ -243,6 +373,7 @@ namespace Configs
     struct Config
     {
         Application   app;
+        Benchmark     benchmark;
         Shaders       shaders;
         Input         input;
         Scene         scene;
@@ -254,4 +385,8 @@ namespace Configs
 
     bool ParseCommandLine(const std::vector<std::string>& arguments, Config& config, std::ofstream& log);
     bool Load(Config& config, std::ofstream& log);
+
+    EDDGIVolumeChange DiffDDGIVolume(const DDGIVolume& previous, const DDGIVolume& current);
+    void WriteDDGIVolumePlacement(const DDGIVolume& volume, std::ostream& out);
+    bool ReloadDDGIVolumes(Config& config, std::vector<EDDGIVolumeChange>& changes, std::ofstream& log);
 }
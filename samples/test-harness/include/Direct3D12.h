@@ -31,8 +31,8 @@ namespace Graphics
         #define D3DCHECK(hr) if(!Check(hr, __FILE__, __LINE__)) { return false; }
 
     #ifdef GFX_PERF_INSTRUMENTATION
-        #define GPU_TIMESTAMP_BEGIN(x) d3d.cmdList[d3d.frameIndex]->EndQuery(d3dResources.timestampHeap, D3D12_QUERY_TYPE_TIMESTAMP, x);
-        #define GPU_TIMESTAMP_END(x) d3d.cmdList[d3d.frameIndex]->EndQuery(d3dResources.timestampHeap, D3D12_QUERY_TYPE_TIMESTAMP, x);
+        #define GPU_TIMESTAMP_BEGIN(x) GetCmdList(d3d)->EndQuery(d3dResources.timestampHeap, D3D12_QUERY_TYPE_TIMESTAMP, x);
+        #define GPU_TIMESTAMP_END(x) GetCmdList(d3d)->EndQuery(d3dResources.timestampHeap, D3D12_QUERY_TYPE_TIMESTAMP, x);
     #else
         #define GPU_TIMESTAMP_BEGIN(x) 
         #define GPU_TIMESTAMP_END(x) 
@@ -71,6 +71,7 @@ namespace Graphics
             D3D12_INPUT_ELEMENT_DESC* inputLayoutDescs = nullptr;
             D3D12_BLEND_DESC blendDesc = {};
             D3D12_RASTERIZER_DESC rasterDesc = {};
+            UINT numRenderTargets = 1;  // 0 for UAV only rendering
         };
 
         struct AccelerationStructure
@@ -89,36 +90,218 @@ namespace Graphics
             }
         };
 
+        struct BLASPool
+        {
+            ID3D12Resource* as = nullptr;                     // compacted BLAS of every scene mesh
+            ID3D12Resource* build = nullptr;                  // uncompacted BLAS, released after scene load
+            ID3D12Resource* scratch = nullptr;                // scratch arena shared by the builds, released after scene load
+            ID3D12Resource* compactedSizes = nullptr;         // postbuild compacted sizes, released after scene load
+            ID3D12Resource* compactedSizesReadback = nullptr; // released after scene load
+            std::vector<UINT64> offsets;                      // byte offset of each mesh's BLAS in the pool
+
+            D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress(UINT meshIndex) const { return as->GetGPUVirtualAddress() + offsets[meshIndex]; }
+
+            void ReleaseBuild()
+            {
+                SAFE_RELEASE(build);
+                SAFE_RELEASE(scratch);
+                SAFE_RELEASE(compactedSizes);
+                SAFE_RELEASE(compactedSizesReadback);
+            }
+
+            void Release()
+            {
+                ReleaseBuild();
+                SAFE_RELEASE(as);
+                offsets.clear();
+            }
+        };
+
+        // Suballocation of the upload ring (or a dedicated upload buffer), see AllocateUpload()
+        struct UploadAllocation
+        {
+            ID3D12Resource* buffer = nullptr;
+            UINT64 offset = 0;                                // byte offset of the allocation in the buffer
+            UINT8* ptr = nullptr;                             // mapped address of the allocation
+        };
+
+        // Copy of an upload allocation to a range of a device buffer, recorded with the frame's other copies
+        struct BufferCopy
+        {
+            ID3D12Resource* resource = nullptr;
+            D3D12_RESOURCE_STATES state = D3D12_RESOURCE_STATE_GENERIC_READ;   // state of the device buffer outside of the copy
+            UINT64 offset = 0;                                // byte offset of the range in the device buffer
+            UploadAllocation upload;
+            UINT64 size = 0;
+        };
+
+        // The scene data copies of a frame: the camera, the modified lights, and the modified TLAS instances
+        using BufferCopies = Memory::FixedVector<BufferCopy, 4>;
+
+        // Persistently mapped upload heap ring buffer, shared by the staging copies of buffer and texture uploads.
+        // Positions increase monotonically (modulo size in the buffer). Space is recycled once cmdQueue passes the
+        // fence value signaled after the command list that reads it, see SignalUploads().
+        struct UploadRing
+        {
+            ID3D12Resource* buffer = nullptr;
+            UINT8* ptr = nullptr;
+            UINT64 size = 64 * 1024 * 1024;
+            UINT64 head = 0;                                  // position of the next allocation
+            UINT64 tail = 0;                                  // position of the oldest allocation the GPU may still read
+            UINT64 submitted = 0;                             // head at the last signal, later allocations are not submitted yet
+            ID3D12Fence* fence = nullptr;                     // values only increase, never reset
+            UINT64 fenceValue = 0;
+            std::vector<std::pair<UINT64, UINT64>> pending;   // fence value and head of each signal
+            std::vector<std::pair<UINT64, ID3D12Resource*>> dedicated; // fence value (0 until signaled) and buffer of allocations that don't fit the ring
+        };
+
+        // Passes that use transient resources, in the order they are recorded every frame (see main.cpp)
+        enum class ETransientPass
+        {
+            DDGI_PROBE_TRACE = 0,
+            DDGI_RADIANCE_CACHE,
+            DDGI_PROBE_RAY_RESOLVE,
+            RTAO,
+            COUNT
+        };
+
+        // Transient resource placed in a transient heap, in use from its first pass through its last pass
+        struct TransientAllocation
+        {
+            ID3D12Resource* resource = nullptr;
+            UINT heapIndex = 0;
+            UINT64 offset = 0;
+            UINT64 size = 0;
+            ETransientPass firstPass = ETransientPass::DDGI_PROBE_TRACE;
+            ETransientPass lastPass = ETransientPass::DDGI_PROBE_TRACE;
+        };
+
+        struct TransientHeap
+        {
+            ID3D12Heap* heap = nullptr;
+            D3D12_HEAP_FLAGS flags = D3D12_HEAP_FLAG_NONE;    // resource category on resource heap tier 1
+            UINT64 size = 0;
+        };
+
+        // Default heaps shared by resources that are only used during part of the frame. Resources whose passes don't
+        // overlap alias the same memory, each pass activates its resources with AliasTransients(). Heaps are kept for reuse.
+        struct TransientHeaps
+        {
+            UINT64 heapSize = 64 * 1024 * 1024;               // resources larger than this get a heap of their own
+            std::vector<TransientHeap> heaps;
+            std::vector<TransientAllocation> allocations;
+        };
+
+        // A texture copy requested by WriteResourceToDisk, one readback buffer per array slice
+        struct ResourceCapture
+        {
+            std::string file;
+            ID3D12Resource* resource = nullptr;               // referenced until the copy is recorded
+            D3D12_RESOURCE_STATES state = D3D12_RESOURCE_STATE_COMMON;
+            D3D12_RESOURCE_DESC desc = {};
+            UINT numRows = 0;
+            UINT64 rowPitch = 0;                              // rows of the readback buffers are aligned to 256B
+            std::vector<ID3D12Resource*> readbacks;
+            UINT64 fenceValue = 0;                            // 0 until the frame that copies it is submitted
+        };
+
+        // Resource captures don't stall the frame: the copies are recorded at the start of the next frame's command list,
+        // and once the GPU completes them the images are converted and written to disk by the ImageCapture writer threads.
+        struct ResourceCaptures
+        {
+            std::vector<ResourceCapture> requested;           // not recorded yet
+            std::vector<ResourceCapture> copying;             // recorded, waiting for the fence
+            std::vector<ID3D12Resource*> readbackPool;        // free readback buffers, reused by size
+            ID3D12Fence* fence = nullptr;                     // values only increase, never reset
+            UINT64 fenceValue = 0;
+        };
+
         struct Features
         {
             UINT waveLaneCount;
         };
 
+        // Compute and raster PSOs are stored in a pipeline library that persists across launches, keyed by a hash of the
+        // shaders, pipeline state, and root signature. The library of the previous launch is only read from: pipelines used
+        // this launch are copied to a new library, which replaces the file at shutdown (so stale pipelines are dropped).
+        // D3D12 can't serialize ray tracing state objects, they are kept in memory and reused by reloads with unchanged shaders.
+        struct PipelineCache
+        {
+            ID3D12PipelineLibrary*       library = nullptr;             // pipelines used this launch
+            ID3D12PipelineLibrary*       previous = nullptr;            // pipelines of the previous launch
+            std::vector<char>            previousData;                  // must outlive the previous library
+            std::string                  filepath = "";
+
+            std::vector<std::pair<uint64_t, ID3D12StateObject*>> stateObjects;
+        };
+
         struct Globals
         {
             IDXGIFactory7*               factory = nullptr;
             ID3D12Device6*               device = nullptr;
             ID3D12CommandQueue*          cmdQueue = nullptr;
-            ID3D12CommandAllocator*      cmdAlloc[MAX_FRAMES_IN_FLIGHT] = { nullptr, nullptr };
-            ID3D12GraphicsCommandList4*  cmdList[MAX_FRAMES_IN_FLIGHT] = { nullptr, nullptr };
+            ID3D12CommandAllocator*      cmdAlloc[MAX_FRAMES_IN_FLIGHT] = {};
+            ID3D12GraphicsCommandList5*  cmdList[MAX_FRAMES_IN_FLIGHT] = {};
 
             IDXGISwapChain4*             swapChain = nullptr;
-            ID3D12Resource*              backBuffer[MAX_FRAMES_IN_FLIGHT] = { nullptr, nullptr };
+            ID3D12Resource*              backBuffer[MAX_FRAMES_IN_FLIGHT] = {};
 
-            ID3D12Fence*                 fence[MAX_FRAMES_IN_FLIGHT] = { nullptr, nullptr };
+            ID3D12Fence*                 fence[MAX_FRAMES_IN_FLIGHT] = {};
             ID3D12Fence*                 immediateFence = nullptr;
             HANDLE                       fenceEvent[MAX_FRAMES_IN_FLIGHT];
             HANDLE                       immediateFenceEvent;
+
+            // Async compute (DDGI probe update chain)
+            ID3D12CommandQueue*          computeQueue = nullptr;
+            ID3D12CommandAllocator*      computeCmdAlloc[MAX_FRAMES_IN_FLIGHT] = {};
+            ID3D12GraphicsCommandList4*  computeCmdList[MAX_FRAMES_IN_FLIGHT] = {};
+            ID3D12Fence*                 graphicsToComputeFence = nullptr;  // Signaled by cmdQueue when the compute work may start
+            ID3D12Fence*                 computeToGraphicsFence = nullptr;  // Signaled by computeQueue when the compute work is done
+            UINT64                       graphicsToComputeFenceValue = 0;
+            UINT64                       computeToGraphicsFenceValue = 0;
+            bool                         computeWaitInFrame = false;        // The rest of the frame's graphics work waits on the compute work submitted so far, see WaitForAsyncCompute()
+
+            // Copy queue (texture streaming uploads)
+            ID3D12CommandQueue*          copyQueue = nullptr;
+            ID3D12CommandAllocator*      copyCmdAlloc = nullptr;
+            ID3D12GraphicsCommandList*   copyCmdList = nullptr;
+            ID3D12Fence*                 copyFence = nullptr;               // Signaled by copyQueue when a streaming batch is uploaded
+            UINT64                       copyFenceValue = 0;
+
+            // Parallel pass recording (see RecordPasses), the last list of each frame records the work after the passes
+            ID3D12CommandAllocator*      passCmdAlloc[MAX_FRAMES_IN_FLIGHT][MAX_PASS_CMD_LISTS + 1] = {};
+            ID3D12GraphicsCommandList5*  passCmdList[MAX_FRAMES_IN_FLIGHT][MAX_PASS_CMD_LISTS + 1] = {};
+            std::vector<ID3D12CommandList*> frameCmdLists;              // Closed lists of the frame, submitted in order by SubmitCmdList()
+            Jobs::Pool                   passWorkers;
+            std::function<void()>        passJobs[MAX_PASS_CMD_LISTS];  // Record recordingPasses[i] on its own list, built once
+            const std::vector<std::function<void()>>* recordingPasses = nullptr;
+            bool                         parallelRecording = false;     // config app.parallelRecording
+
+            // Transient CPU data of the frame (barrier lists, scratch arrays), reset by MoveToNextFrame()
+            Memory::FrameArena           frameArena;
+
+            // Upload ring (staging copies on the graphics queue)
+            UploadRing                   uploads;
+
+            // Transient resource heaps
+            TransientHeaps               transients;
+
+            // Asynchronous resource captures (see WriteResourceToDisk)
+            ResourceCaptures             captures;
+
             UINT                         frameIndex = 0;
             UINT                         frameNumber = 0;
 
             D3D12_VIEWPORT               viewport;
             D3D12_RECT                   scissor;
+            D3D12_VIEWPORT               renderViewport;                 // The render area of the screen-space passes (see renderWidth)
+            D3D12_RECT                   renderScissor;
 
             GLFWwindow*                  window = nullptr;
             RECT                         windowRect = {};
 
             Shaders::ShaderCompiler      shaderCompiler;
+            PipelineCache                pipelines;
 
             Features                     features = {};
 
@@ -130,6 +313,9 @@ namespace Graphics
 
             int                          width = 0;
             int                          height = 0;
+            int                          renderWidth = 0;                // DDGI mode's screen-space passes render to the top left renderWidth x renderHeight
+            int                          renderHeight = 0;               // of the (width x height) render targets, see SetResolutionScale()
+            float                        resolutionScale = 1.f;
             bool                         vsync = true;
             bool                         vsyncChanged = false;
             int                          fullscreen = 0;
@@ -137,13 +323,57 @@ namespace Graphics
 
             bool                         allowTearing = false;
             bool                         supportsShaderExecutionReordering = false;
+            bool                         supportsRasterizerOrderedViews = false;
+            bool                         supportsVariableRateShading = false;            // Variable rate shading tier 2 (screen-space shading rate image)
+            bool                         supportsAdditionalShadingRates = false;
+            bool                         supportsMixedResourceHeaps = false;             // Resource heap tier 2 (buffers and textures in the same heap)
+            bool                         supportsEnhancedBarriers = false;               // ID3D12GraphicsCommandList7::Barrier (D3D12_OPTIONS12)
+            bool                         enhancedBarriers = false;                       // config app.enhancedBarriers
+            UINT                         shadingRateImageTileSize = 0;
 
             UINT                         CacheCount = 100000;
             UINT                         NumVolume = 1;
             float                        CascadeCellRadius = 0.2f;
             float                        CascadeDistance = 20.0f;
             float                        RadianceCacheSampleCount = 16.0f;
-            UINT                         FinalGatherDownScale = 1;  // Set to 1 for full resolution indirect lighting (better for debug)
+            UINT                         FinalGatherDownScale = 1;  // Indirect lighting resolution divisor (config ddgi.indirectScale), set to 1 for full resolution indirect lighting (better for debug)
+            bool                         RadianceCacheSortHits = true;      // Sort the radiance cache work list by (InstanceIndex, GeometryIndex) before shading
+            UINT                         RadianceCacheSortBinCount = 4096;  // Counting sort bins, must be a multiple of 1024
+            UINT                         RadianceCacheRayBudget = 1048576;  // Max inline rays per frame for radiance cache updates (0 = unlimited)
+            bool                         RadianceCacheCompactHits = true;   // Store hit cache entries in the 16 byte HitPackedData layout (HIT_CACHE_COMPACT)
+            UINT                         RadianceCacheRadianceFormat = 2;   // Resolved radiance storage: 0 = float3, 1 = R11G11B10, 2 = RGB9E5
+            bool                         RadianceCacheIndirectFromProbes = true; // Radiance cache cells read the DDGIVolumes' probe irradiance, secondary rays only where no volume covers them
+            bool                         RadianceCacheReservoirSampling = true; // Radiance cache secondary rays: one per cell per frame, resampled against the cell's reservoir of past directions (see RadianceCacheReservoir.hlsl)
+            bool                         RadianceCacheWaveRays = true;      // Fixed direction secondary rays (no reservoir sampling) are traced one per thread, RadianceCacheSampleCount threads per cell
+            UINT                         RadianceCacheCascadeMode = 1;      // Radiance cache cascade selection: 0 = camera distance, 1 = querying ray length (camera independent)
+            UINT                         RadianceCacheHashFunction = 0;     // Radiance cache cell hash (config ddgi.radianceCacheHash): 0 = FNV-1a + Wang, 1 = PCG3D, 2 = xxHash32, 3 = Morton ordered bricks
+            bool                         RadianceCacheBrickLayout = false;  // Radiance cache 4x4x4 cell bricks are hashed to buckets of 64 contiguous slots (config ddgi.radianceCacheBricks, RADIANCE_CACHE_BRICK_LAYOUT)
+            UINT                         RadianceCacheCompactionInterval = 16; // Frames between radiance cache compaction passes (free stale slots, shorten probe sequences), 0 = never
+            UINT                         PTRadianceCacheBounce = 0;         // Path tracing paths end in the radiance cache from this bounce on, once their footprint covers a cell (config pathTrace.radianceCacheBounce, 0 = off, see PathTraceRadianceCache.hlsl)
+            bool                         RadianceCacheGather = false;       // IndirectCS reads the radiance cache cell of each pixel, the probes only fill in cells with little history (see IndirectCS.hlsl)
+            bool                         RadianceCacheLightGrid = true;     // Radiance cache shading only evaluates the spot and point lights listed in its world-space light grid cell (see LightGrid.hlsl)
+            bool                         RadianceCacheStochasticLights = false; // One shadow ray per cache cell for the light grid's lights, picked by unshadowed contribution
+            bool                         RadianceCacheEmissiveLights = true; // Radiance cache shading samples one emissive triangle per cell from the light BVH and traces a shadow ray to it (EMISSIVE_LIGHTS)
+            bool                         RadianceCacheLightVisibility = true; // Radiance cache cells reuse the shadow ray results of the first 32 lights until a light or instance moves, or every 64 frames (LIGHT_VISIBILITY_CACHE)
+            UINT                         LightGridDim = 16;                 // Light grid cells per axis
+            UINT                         LightGridMaxLightsPerCell = 31;    // Light list capacity of a light grid cell, crowded cells fall back to evaluating every light
+            bool                         DDGIAsyncCompute = false;          // Run the DDGI probe update chain on the compute queue, one frame behind the gather
+            bool                         DDGIBatchProbeTrace = false;       // Trace and resolve the probe rays of every selected DDGIVolume in one dispatch per frame
+        #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_DESCRIPTOR_HEAP
+            bool                         DDGIFusedRayResolve = true;        // Probe blending reads the ray hit map and radiance cache directly, ProbeRayResolveCS is skipped (see ProbeBlendingRadianceCacheCS.hlsl)
+        #else
+            bool                         DDGIFusedRayResolve = false;       // Requires RTXGI_BINDLESS_TYPE_DESCRIPTOR_HEAP
+        #endif
+            bool                         DDGIVolumeInstanceMasks = true;    // Probe rays only traverse the TLAS instances within reach of their DDGIVolume (see TLAS_INSTANCE_MASK_FLAGS)
+            bool                         DDGISpecializedSampling = true;    // Compile the shaders that sample the DDGIVolumes with the options all volumes share baked in (see Graphics::DDGI::AddSpecializationDefines)
+            bool                         GIMaterials = true;                // Probe and radiance cache hits read the 8 byte GIMaterial instead of the Material, and use its average albedo texture color (GI_MATERIALS)
+            bool                         GIVertexAlbedo = true;             // With GIMaterials, probe and radiance cache hits interpolate the baked vertex albedos instead of sampling the albedo texture (GI_VERTEX_ALBEDO)
+            bool                         DDGIClipmap = false;               // The DDGIVolumes are the levels of a DDGIClipmap (finest first): shared anchor, staggered level updates, finest level gather
+            bool                         DDGIBlendVolumes = false;          // The indirect gather blends the overlapping DDGIVolumes in priority and density order until their weights saturate, instead of picking a cascade
+            bool                         GBufferVisibility = false;         // The GBuffer pass writes the visibility buffer instead of GBufferB and GBufferC (config app.visibilityBuffer)
+            bool                         GBufferTiles = false;              // The GBuffer pass writes the list of tiles with geometry, indirect lighting and RTAO dispatch over them (config app.gbufferTiles)
+            bool                         TextureStreaming = false;          // Scene texture samples write the texture streaming feedback buffer (config scene.textureStreaming.enable)
+            bool                         GPUCounters = false;               // The DDGI passes count rays and radiance cache lookups, with pipeline statistics queries (config app.gpuCounters)
         };
 
         struct RenderTargets
@@ -153,6 +383,60 @@ namespace Graphics
             ID3D12Resource*              GBufferB = nullptr;  // XYZ: World Position, W: Primary Ray Hit Distance
             ID3D12Resource*              GBufferC = nullptr;  // XYZ: Normal, W: unused
             ID3D12Resource*              GBufferD = nullptr;  // RGB: Direct Diffuse, A: unused
+            ID3D12Resource*              GBufferVisibility = nullptr;  // XY: Primary Ray Hit IDs (only with Globals::GBufferVisibility)
+
+            // GBuffer Tiles (only with Globals::GBufferTiles)
+            ID3D12Resource*              GBufferTiles = nullptr;       // Dispatch arguments, tile count, and the list of tiles with geometry (see GBufferTiles.hlsl)
+            ID3D12Resource*              GBufferTileArgs = nullptr;    // Dispatch arguments copied from GBufferTiles, rests in the indirect argument state
+        };
+
+        struct StreamedTexture
+        {
+            bool                         streamed = false;            // BC7 texture with mip levels finer than the mip tail
+            UINT                         tailMip = 0;                 // Finest mip level of the (always resident) mip tail
+            UINT                         residentMip = 0;             // Finest mip level of the resident texture resource
+            UINT                         requestedMip = 0;            // Finest mip level last requested by the feedback buffer
+            UINT                         requestedFrame = 0;          // Frame number of the last request
+            UINT64                       residentBytes = 0;           // Size of the resident texture resource
+        };
+
+        struct StreamedTextureSwap
+        {
+            UINT                         textureIndex = 0;
+            UINT                         topMip = 0;
+            UINT64                       bytes = 0;
+            ID3D12Resource*              resource = nullptr;          // Replaces the resident texture resource when the copy completes
+        };
+
+        struct TextureStreaming
+        {
+            bool                         enabled = false;
+            UINT64                       budget = 0;                  // Max bytes of resident scene textures
+            UINT64                       residentBytes = 0;           // Bytes of resident scene textures
+            UINT                         tailSize = 0;                // Max texels along the largest axis of the pinned mip tail
+
+            std::vector<StreamedTexture> textures;                    // One for each scene texture
+            std::vector<UINT>            requests;                    // Scratch lists of StreamTextures(), kept to reuse their storage
+            std::vector<UINT>            evictions;
+
+            // Feedback (requested resolution of each material texture index, see TextureStreaming.hlsl)
+            ID3D12Resource*              feedback = nullptr;
+            ID3D12Resource*              feedbackClear = nullptr;     // Zeros, copied to the feedback buffer after every readback
+            ID3D12Resource*              feedbackReadback[MAX_FRAMES_IN_FLIGHT] = {};
+            UINT                         feedbackReadbackFrame[MAX_FRAMES_IN_FLIGHT] = {};
+            UINT                         feedbackSize = 0;
+
+            // Batch of mip level copies in flight on the copy queue
+            std::vector<StreamedTextureSwap> swaps;
+            ID3D12Resource*              upload = nullptr;
+            UINT64                       fenceValue = 0;
+        };
+
+        struct TimestampFrame
+        {
+            UINT                         numQueries = 0;              // Queries resolved to the frame's readback buffer, 0 once read
+            UINT                         traceFrame = 0;              // Trace capture frame the queries belong to
+            std::vector<std::pair<Instrumentation::Stat*, INT32>> stats; // GPU stats active in the frame and their first query index
         };
 
         struct Resources
@@ -175,7 +459,8 @@ namespace Graphics
 
             // Performance Queries
             ID3D12QueryHeap*                       timestampHeap = nullptr;
-            ID3D12Resource*                        timestamps = nullptr;
+            ID3D12Resource*                        timestamps[MAX_FRAMES_IN_FLIGHT] = {};  // Readback ring, a frame's timestamps are read once its fence completes
+            TimestampFrame                         timestampFrames[MAX_FRAMES_IN_FLIGHT];
             UINT64                                 timestampFrequency = 0;
 
             // Root signature (bindless resource access)
@@ -183,67 +468,69 @@ namespace Graphics
 
             // Constant Buffers
             ID3D12Resource*                        cameraCB = nullptr;
-            UINT8*                                 cameraCBPtr = nullptr;
+            Graphics::Camera                       previousCamera = {};        // Camera of the previous frame, for temporal reprojection
+            Graphics::Camera                       cameraData = {};            // Camera constants of this frame, with the previous frame's camera
+            UINT8*                                 cameraUploadPtr = nullptr;  // Upload ring allocation of this frame's camera constants, rewritten by LatchCamera()
 
             // Structured Buffers
             ID3D12Resource*                        lightsSTB = nullptr;
-            ID3D12Resource*                        lightsSTBUpload = nullptr;
             ID3D12Resource*                        materialsSTB = nullptr;
-            ID3D12Resource*                        materialsSTBUpload = nullptr;
-
-            UINT8*                                 lightsSTBPtr = nullptr;
-            UINT8*                                 materialsSTBPtr = nullptr;
+            ID3D12Resource*                        giMaterialsSTB = nullptr;   // GIMaterial of each material (GI_MATERIALS)
+            ID3D12Resource*                        lightBVHNodesSTB = nullptr; // Light BVH over the emissive triangles (EMISSIVE_LIGHTS)
+            ID3D12Resource*                        emissiveTrianglesSTB = nullptr; // World-space emissive triangles of the scene (EMISSIVE_LIGHTS)
 
             // ByteAddress Buffers
             ID3D12Resource*                        meshOffsetsRB = nullptr;
-            ID3D12Resource*                        meshOffsetsRBUpload = nullptr;
-            UINT8*                                 meshOffsetsRBPtr = nullptr;
-
             ID3D12Resource*                        geometryDataRB = nullptr;
-            ID3D12Resource*                        geometryDataRBUpload = nullptr;
-            UINT8*                                 geometryDataRBPtr = nullptr;
 
             // Shared Render Targets
             RenderTargets                          rt;
 
             // Scene Geometry
             std::vector<ID3D12Resource*>           sceneIBs;
-            std::vector<ID3D12Resource*>           sceneIBUploadBuffers;
             std::vector<D3D12_INDEX_BUFFER_VIEW>   sceneIBViews;
             std::vector<ID3D12Resource*>           sceneVBs;
-            std::vector<ID3D12Resource*>           sceneVBUploadBuffers;
             std::vector<D3D12_VERTEX_BUFFER_VIEW>  sceneVBViews;
 
             // Scene Ray Tracing Acceleration Structures
-            std::vector<AccelerationStructure>     blas;
+            BLASPool                               blas;
             AccelerationStructure                  tlas;
+            UINT                                   tlasInstancesCapacity = 0;   // Number of instances the TLAS buffers are sized for
+            std::vector<rtxgi::AABB>               tlasVolumeBounds;            // Reach of each DDGIVolume's probe rays, sets the volume's TLAS instance mask bit (see GetSceneInstanceDesc())
 
             // Scene textures
             std::vector<ID3D12Resource*>           sceneTextures;
-            std::vector<ID3D12Resource*>           sceneTextureUploadBuffers;
+            TextureStreaming                       textureStreaming;
 
             // Additional textures
             std::vector<ID3D12Resource*>           textures;
-            std::vector<ID3D12Resource*>           textureUploadBuffers;
         };
 
         ID3D12RootSignature* CreateRootSignature(Globals& d3d, const D3D12_ROOT_SIGNATURE_DESC& desc);
         bool CreateBuffer(Globals& d3d, const BufferDesc& info, ID3D12Resource** ppResource);
-        bool CreateVertexBuffer(Globals& d3d, const Scenes::Mesh& mesh, ID3D12Resource** device, ID3D12Resource** upload, D3D12_VERTEX_BUFFER_VIEW& view);
-        bool CreateIndexBuffer(Globals& d3d, const Scenes::Mesh& mesh, ID3D12Resource** device, ID3D12Resource** upload, D3D12_INDEX_BUFFER_VIEW& view);
+        bool AllocateUpload(Globals& d3d, UINT64 size, UINT64 alignment, UploadAllocation& allocation);
+        bool CreateVertexBuffer(Globals& d3d, const Scenes::Mesh& mesh, ID3D12Resource** device, D3D12_VERTEX_BUFFER_VIEW& view);
+        bool CreateIndexBuffer(Globals& d3d, const Scenes::Mesh& mesh, ID3D12Resource** device, D3D12_INDEX_BUFFER_VIEW& view);
         bool CreateTexture(Globals& d3d, const TextureDesc& info, ID3D12Resource** resource);
+        bool CreateTransientBuffer(Globals& d3d, const BufferDesc& info, ETransientPass firstPass, ETransientPass lastPass, ID3D12Resource** resource);
+        bool CreateTransientTexture(Globals& d3d, const TextureDesc& info, ETransientPass firstPass, ETransientPass lastPass, ID3D12Resource** resource);
+        void ReleaseTransient(Globals& d3d, ID3D12Resource*& resource);
+        void AliasTransients(Globals& d3d, ID3D12GraphicsCommandList* cmdList, ETransientPass pass);
+        void FlushBarriers(Globals& d3d, ID3D12GraphicsCommandList* cmdList, std::vector<D3D12_RESOURCE_BARRIER>& barriers);
+
+        void SetRootSignatureHash(ID3D12RootSignature* rootSignature, const void* serialized, size_t size);
 
         bool CreateRasterPSO(
-            ID3D12Device* device,
+            Globals& d3d,
             ID3D12RootSignature* rootSignature,
             const Shaders::ShaderPipeline& shaders,
             const RasterDesc& desc,
             ID3D12PipelineState** pso);
 
-        bool CreateComputePSO(ID3D12Device* device, ID3D12RootSignature* rootSignature, const Shaders::ShaderProgram& shader, ID3D12PipelineState** pso);
+        bool CreateComputePSO(Globals& d3d, ID3D12RootSignature* rootSignature, const Shaders::ShaderProgram& shader, ID3D12PipelineState** pso);
 
         bool CreateRayTracingPSO(
-            ID3D12Device5* device,
+            Globals& d3d,
             ID3D12RootSignature* rootSignature,
             const Shaders::ShaderRTPipeline& shaders,
             ID3D12StateObject** rtpso,
@@ -251,6 +538,10 @@ namespace Graphics
 
         bool WriteResourceToDisk(Globals& d3d, std::string file, ID3D12Resource* pResource, D3D12_RESOURCE_STATES state);
 
+        ID3D12GraphicsCommandList5* GetCmdList(Globals& d3d);
+        bool ResetComputeCmdList(Globals& d3d);
+        bool SubmitComputeCmdList(Globals& d3d);
+
         namespace SamplerHeapOffsets
         {
             const int BILINEAR_WRAP = 0;                                            // 0: bilinear filter, repeat
@@ -269,21 +560,52 @@ namespace Graphics
             const int STB_TLAS_INSTANCES = STB_MATERIALS + 1;                       //   3:   1 SRV for the Scene TLAS instance descriptors structured buffer
             const int STB_DDGI_VOLUME_CONSTS = STB_TLAS_INSTANCES + 1;              //   4:   1 SRV for DDGIVolume constants structured buffers
             const int STB_DDGI_VOLUME_RESOURCE_INDICES = STB_DDGI_VOLUME_CONSTS + 1;//   5:   1 SRV for DDGIVolume resource indices structured buffers
+            const int STB_DDGI_VOLUME_BOUNDS = STB_DDGI_VOLUME_RESOURCE_INDICES + 1;//   6:   1 SRV for the DDGIVolume bounds structured buffer (see DDGIVolumeBoundsGPU)
+            const int STB_GI_MATERIALS = STB_DDGI_VOLUME_BOUNDS + 1;                //   7:   1 SRV for the GI materials structured buffer (see GIMaterial)
+            const int STB_LIGHT_BVH_NODES = STB_GI_MATERIALS + 1;                   //   8:   1 SRV for the emissive triangles' light BVH structured buffer (see LightBVHNode)
+            const int STB_EMISSIVE_TRIANGLES = STB_LIGHT_BVH_NODES + 1;             //   9:   1 SRV for the emissive triangles structured buffer (see EmissiveTriangle)
 
             // Unordered Access Views
-            const int UAV_START = STB_DDGI_VOLUME_RESOURCE_INDICES + 1;             //   6:   UAV Start
+            const int UAV_START = STB_EMISSIVE_TRIANGLES + 1;                       //  10:   UAV Start
 
             // RW Structured Buffers
-            const int UAV_STB_TLAS_INSTANCES = UAV_START;                           //   6:   1 UAV for the Scene TLAS instance descriptors structured buffer
+            const int UAV_STB_TLAS_INSTANCES = UAV_START;                           //  10:   1 UAV for the Scene TLAS instance descriptors structured buffer
             const int UAV_HIT_CACHING = UAV_STB_TLAS_INSTANCES + 1;
             const int UAV_RADIANCE_CACHING = UAV_HIT_CACHING + 1;
             const int UAV_RADIANCE_CACHING_VISUALIZATION = UAV_RADIANCE_CACHING + 1;
             const int UAV_RADIANCE_CACHE_ACCUMULATION = UAV_RADIANCE_CACHING_VISUALIZATION + 1;   // SHaRC-style atomic accumulation
             const int UAV_RADIANCE_CACHE_METADATA = UAV_RADIANCE_CACHE_ACCUMULATION + 1;         // SHaRC-style: checksum + age for collision detection
             const int UAV_PROBE_RAY_HIT_MAP = UAV_RADIANCE_CACHE_METADATA + 1;                   // Maps ProbeRayIndex -> HashID for resolve pass
+            const int UAV_RADIANCE_CACHE_WORK_LIST = UAV_PROBE_RAY_HIT_MAP + 1;                  // Cache slots touched this frame
+            const int UAV_RADIANCE_CACHE_WORK_LIST_ARGS = UAV_RADIANCE_CACHE_WORK_LIST + 1;      // Work list dispatch arguments + append counter
+            const int UAV_RADIANCE_CACHE_SORTED_WORK_LIST = UAV_RADIANCE_CACHE_WORK_LIST_ARGS + 1; // Work list ordered by (InstanceIndex, GeometryIndex)
+            const int UAV_RADIANCE_CACHE_SORT_BINS = UAV_RADIANCE_CACHE_SORTED_WORK_LIST + 1;    // Counting sort bin counts / offsets
+            const int UAV_RADIANCE_CACHE_BUDGET = UAV_RADIANCE_CACHE_SORT_BINS + 1;              // Update budget priority histogram + threshold
+            const int UAV_DDGI_PROBE_SCHEDULE = UAV_RADIANCE_CACHE_BUDGET + 1;                   // MAX_DDGIVOLUMES UAVs for the DDGIVolume probe schedules
+            const int UAV_PROBE_TRACE_BATCH = UAV_DDGI_PROBE_SCHEDULE + MAX_DDGIVOLUMES;         // Batched probe trace volume table
+            const int UAV_PT_WAVEFRONT_PATHS = UAV_PROBE_TRACE_BATCH + 1;                        // Wavefront path tracing path state
+            const int UAV_PT_WAVEFRONT_HITS = UAV_PT_WAVEFRONT_PATHS + 1;                        // Wavefront path tracing hits
+            const int UAV_PT_WAVEFRONT_SURFACES = UAV_PT_WAVEFRONT_HITS + 1;                     // Wavefront path tracing shaded surfaces
+            const int UAV_PT_WAVEFRONT_QUEUES = UAV_PT_WAVEFRONT_SURFACES + 1;                   // Wavefront path tracing ray queues
+            const int UAV_PT_WAVEFRONT_COUNTERS = UAV_PT_WAVEFRONT_QUEUES + 1;                   // Wavefront path tracing queue counters + material sort bins
+            const int UAV_PT_CONVERGENCE = UAV_PT_WAVEFRONT_COUNTERS + 1;                        // Path tracing unconverged tile counts + tile flags
+            const int UAV_GBUFFER_VISIBILITY = UAV_PT_CONVERGENCE + 1;                           // GBuffer visibility buffer RWTexture (primary ray hit IDs)
+            const int UAV_COMPOSITE_SHADING_RATE = UAV_GBUFFER_VISIBILITY + 1;                   // Composite shading rate image RWTexture (VRS tier 2)
 
             // Texture2D UAV
-            const int UAV_TEX2D_START = UAV_PROBE_RAY_HIT_MAP + 1;                                //   RWTexture2D UAV Start
+            const int UAV_TEXTURE_FEEDBACK = UAV_COMPOSITE_SHADING_RATE + 1;                     // Texture streaming feedback buffer (requested resolution per texture)
+            const int UAV_GPU_COUNTERS = UAV_TEXTURE_FEEDBACK + 1;                               // DDGI ray and radiance cache counters (see GPUCounters.hlsl)
+            const int UAV_RADIANCE_CACHE_STATS = UAV_GPU_COUNTERS + 1;                           // Radiance cache occupancy per cascade (see RadianceCacheStatsCS.hlsl)
+
+            const int UAV_GBUFFER_TILES = UAV_RADIANCE_CACHE_STATS + 1;                          // GBuffer geometry tile list + dispatch arguments (see GBufferTiles.hlsl)
+
+            const int UAV_LIGHT_GRID = UAV_GBUFFER_TILES + 1;                                    // World-space light grid bounds + per cell light lists (see LightGrid.hlsl)
+            const int UAV_RADIANCE_CACHE_RESERVOIRS = UAV_LIGHT_GRID + 1;                        // Radiance cache indirect sample reservoirs (see RadianceCacheReservoir.hlsl)
+            const int UAV_IRRADIANCE_QUERIES = UAV_RADIANCE_CACHE_RESERVOIRS + 1;                // DDGIVolume irradiance queries of the CPU (see IrradianceQueryCS.hlsl)
+            const int UAV_COMPOSITE_EXPOSURE = UAV_IRRADIANCE_QUERIES + 1;                       // Auto exposure luminance histogram + exposure (see CompositeExposureCS.hlsl)
+            const int UAV_PROBE_DELTAS = UAV_COMPOSITE_EXPOSURE + 1;                             // DDGIVolume probe tile delta packets (see ProbeDeltaCS.hlsl)
+
+            const int UAV_TEX2D_START = UAV_PROBE_DELTAS + 1;                                     //   RWTexture2D UAV Start
             const int UAV_PT_OUTPUT = UAV_TEX2D_START;                              //   7:   1 UAV for the Path Tracer Output RWTexture
             const int UAV_PT_ACCUMULATION = UAV_PT_OUTPUT + 1;                      //   8    1 UAV for the Path Tracer Accumulation RWTexture
             const int UAV_GBUFFERA = UAV_PT_ACCUMULATION + 1;                       //   9:   1 UAV for the GBufferA RWTexture
@@ -293,10 +615,13 @@ namespace Graphics
             const int UAV_RTAO_OUTPUT = UAV_GBUFFERD + 1;                           //  13:   1 UAV for the RTAO Output RWTexture
             const int UAV_RTAO_RAW = UAV_RTAO_OUTPUT + 1;                           //  14:   1 UAV for the RTAO Raw RWTexture
             const int UAV_DDGI_OUTPUT = UAV_RTAO_RAW + 1;                           //  15:   1 UAV for the DDGI RWTexture
+            const int UAV_RTAO_HISTORY = UAV_DDGI_OUTPUT + 1;                       //  16:   2 UAV for the RTAO temporal history RWTextures (ping-pong)
+            const int UAV_PT_VARIANCE = UAV_RTAO_HISTORY + 2;                       //  18:   1 UAV for the Path Tracer Variance RWTexture
+            const int UAV_DDGI_TEXTURE_VIS = UAV_PT_VARIANCE + 1;                   //  19:   1 UAV for the DDGI texture visualization cache RWTexture
 
             // Texture2DArray UAV
-            const int UAV_TEX2DARRAY_START = UAV_DDGI_OUTPUT + 1;                   //  16:   RWTexture2DArray UAV Start
-            const int UAV_DDGI_VOLUME_TEX2DARRAY = UAV_TEX2DARRAY_START;            //  16:   36 UAV, 6 for each DDGIVolume (RayData, Irradiance, Distance, Probe Data, Variability, VariabilityAverage)
+            const int UAV_TEX2DARRAY_START = UAV_DDGI_TEXTURE_VIS + 1;              //  20:   RWTexture2DArray UAV Start
+            const int UAV_DDGI_VOLUME_TEX2DARRAY = UAV_TEX2DARRAY_START;            //  20:   36 UAV, 6 for each DDGIVolume (RayData, Irradiance, Distance, Probe Data, Variability, VariabilityAverage)
 
             // Shader Resource Views                                                //  52:   SRV Start
             const int SRV_START = UAV_DDGI_VOLUME_TEX2DARRAY + (rtxgi::GetDDGIVolumeNumTex2DArrayDescriptors() * MAX_DDGIVOLUMES);
@@ -315,9 +640,10 @@ namespace Graphics
             // Texture2DArray SRV
             const int SRV_TEX2DARRAY_START = SRV_SCENE_TEXTURES + MAX_TEXTURES;     // 356:   Texture2DArray SRV Start
             const int SRV_DDGI_VOLUME_TEX2DARRAY = SRV_TEX2DARRAY_START;            // 356:  36 SRV, 6 for each DDGIVolume (RayData, Irradiance, Distance, Probe Data, Variability, Variability Average)
+            const int SRV_DDGI_VOLUME_BAKED_IRRADIANCE = SRV_DDGI_VOLUME_TEX2DARRAY + (rtxgi::GetDDGIVolumeNumTex2DArrayDescriptors() * MAX_DDGIVOLUMES); // MAX_DDGIVOLUMES SRVs for the BC6H baked irradiance of each DDGIVolume
 
             // ByteAddressBuffer SRV                                                // 392:   ByteAddressBuffer SRV Start
-            const int SRV_BYTEADDRESS_START = SRV_TEX2DARRAY_START + (rtxgi::GetDDGIVolumeNumTex2DArrayDescriptors() * MAX_DDGIVOLUMES);
+            const int SRV_BYTEADDRESS_START = SRV_DDGI_VOLUME_BAKED_IRRADIANCE + MAX_DDGIVOLUMES;
             const int SRV_SPHERE_INDICES = SRV_BYTEADDRESS_START;                   // 392:  1 SRV for DDGI Probe Vis Sphere Index Buffer
             const int SRV_SPHERE_VERTICES = SRV_SPHERE_INDICES + 1;                 // 393:  1 SRV for DDGI Probe Vis Sphere Vertex Buffer
             const int SRV_MESH_OFFSETS = SRV_SPHERE_VERTICES + 1;                   // 394:  1 SRV for Mesh Offsets in the Geometry Data Buffer
@@ -0,0 +1,30 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#pragma once
+
+#include "Configs.h"
+
+namespace DynamicResolution
+{
+    struct Controller
+    {
+        float    scale = 1.f;           // Render resolution scale (of the width and height) in use
+        double   frameTime = 0;         // Filtered GPU frame time (milliseconds)
+        uint32_t settleFrames = 0;      // Frames left before the next adjustment
+    };
+
+    /**
+     * Filter the last GPU frame time and, every few frames, move the render resolution scale towards the
+     * scale that meets the frame rate target (config.app.dynamicResolutionFPS). Returns the scale to render at,
+     * 1 when dynamic resolution is disabled.
+     */
+    float Update(Controller& controller, const Configs::Config& config, double gpuFrameTime);
+}
@@ -14,5 +14,6 @@
 namespace Geometry
 {
     void CreateSphere(uint32_t latitudes, uint32_t longitudes, Scenes::Mesh& mesh);
+    void CreateIcosphere(uint32_t subdivisions, Scenes::Mesh& mesh);
 }
 
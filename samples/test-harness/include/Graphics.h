@@ -14,12 +14,23 @@
 #include "Shaders.h"
 #include "Scenes.h"
 #include "Instrumentation.h"
+#include "Jobs.h"
+#include "Memory.h"
 
-const int MAX_FRAMES_IN_FLIGHT = 2;
+// Frames the CPU may record ahead of the GPU, set with RTXGISAMPLES_TEST_HARNESS_FRAMES_IN_FLIGHT.
+// Per-frame command lists, fences, upload buffer slots, and readbacks are ring-indexed by frameIndex.
+#ifndef GFX_FRAMES_IN_FLIGHT
+#define GFX_FRAMES_IN_FLIGHT 2
+#endif
+const int MAX_FRAMES_IN_FLIGHT = GFX_FRAMES_IN_FLIGHT;
+static_assert(MAX_FRAMES_IN_FLIGHT >= 2 && MAX_FRAMES_IN_FLIGHT <= 4, "GFX_FRAMES_IN_FLIGHT must be 2, 3, or 4");
+const int MAX_SWAPCHAIN_IMAGES = 8;
+const int MAX_PASS_CMD_LISTS = 8;   // Passes recorded on their own command lists by RecordPasses()
 const int MAX_TLAS = 2;
 const int MAX_TEXTURES = 300;
 const int MAX_DDGIVOLUMES = 6;
 const int MAX_TIMESTAMPS = 200;
+const int GBUFFER_TILE_SIZE = 8;    // GBuffer classification tiles are GBufferCS thread groups, see GBufferTiles.hlsl
 
 #define RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS 0
 #define RTXGI_BINDLESS_TYPE_DESCRIPTOR_HEAP 1
@@ -51,11 +62,17 @@ namespace Graphics
     bool Initialize(const Configs::Config& config, Scenes::Scene& scene, Globals& gfx, GlobalResources& resources, std::ofstream& log);
     bool PostInitialize(Globals& gfx, std::ofstream& log);
     void Update(Globals& gfx, GlobalResources& gfxResources, const Configs::Config& config, Scenes::Scene& scene);
+    void LatchCamera(Globals& gfx, GlobalResources& gfxResources, const Scenes::Scene& scene);
     bool ResizeBegin(Globals& gfx, GlobalResources& resources, int width, int height, std::ofstream& log);
     bool ResizeEnd(Globals& gfx);
     bool ToggleFullscreen(Globals& gfx);
+    void SetResolutionScale(Globals& gfx, float scale);
+    bool GetVideoMemoryInfo(Globals& gfx, uint64_t& budget, uint64_t& usage);
     bool ResetCmdList(Globals& gfx);
     bool SubmitCmdList(Globals& gfx);
+    bool RecordPasses(Globals& gfx, const std::vector<std::function<void()>>& passes);
+    void GlobalBarrier(Globals& gfx);
+    void WaitForAsyncCompute(Globals& gfx);
     bool Present(Globals& gfx);
     bool WaitForGPU(Globals& gfx);
     bool WaitForPrevGPUFrame(Globals& gfx);
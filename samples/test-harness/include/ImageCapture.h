@@ -11,6 +11,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <functional>
 #include <string>
 
 #if defined(_WIN32) || defined(WIN32)
@@ -22,7 +23,28 @@
 namespace ImageCapture
 {
     const static uint32_t NumChannels = 4;
+
+    // File formats of the captured images (config app.captureFormat)
+    enum class EFormat
+    {
+        PNG = 0,        // Default zlib compression
+        PNG_FAST,       // Lowest zlib compression level, larger files
+        QOI,            // Quite OK Image format, lossless and an order of magnitude faster to encode than PNG
+        TGA             // Uncompressed
+    };
+
+    void SetFormat(EFormat format, bool hdr);
+    bool GetHdr();
+
     bool CapturePng(std::string file, uint32_t width, uint32_t height, const unsigned char* data);
+    bool CaptureQoi(std::string file, uint32_t width, uint32_t height, const unsigned char* data);
+    bool CaptureImage(std::string file, uint32_t width, uint32_t height, const unsigned char* data);
+    bool CaptureHdr(std::string file, uint32_t width, uint32_t height, uint64_t srcRowPitch, const unsigned char* pSrcData);
+
+    // Image writes run on a pool of writer threads, started with the first write.
+    // Flush() waits for the queued writes and stops the writers, it returns false when a write failed.
+    void QueueWrite(std::function<bool()> write);
+    bool Flush();
 
 #if defined(_WIN32) || defined(WIN32)
     IWICImagingFactory2* CreateWICImagingFactory();
@@ -26,6 +26,7 @@ namespace Inputs
         CAMERA_MOVEMENT,
         FULLSCREEN_CHANGE,
         RUN_BENCHMARK,
+        TRACE_CAPTURE,
         COUNT
     };
 
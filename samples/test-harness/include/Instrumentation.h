@@ -12,7 +12,9 @@
 
 #include "Common.h"
 
-#include <queue>
+#include <atomic>
+#include <deque>
+#include <mutex>
 #include <stack>
 #include <iostream>
 
@@ -38,24 +40,58 @@ namespace Instrumentation
         PRESENT,
     };
 
+    // The DDGI ray and radiance cache counters, in the order of the GPUCounters buffer (see GPUCounters.hlsl)
+    enum ECounter
+    {
+        PROBE_RAYS = 0,
+        PROBE_RAY_HITS,
+        PROBE_RAY_MISSES,
+        CACHE_HITS,
+        CACHE_MISSES,
+        CACHE_COLLISIONS,
+        INDIRECT_RAYS,
+        INDIRECT_RAY_HITS,
+        INDIRECT_RAY_MISSES,
+        INDIRECT_CACHE_HITS,
+        INDIRECT_CACHE_MISSES,
+        CACHE_EVICTIONS,
+        COUNTER_COUNT,
+    };
+
+    // The DDGI passes measured by pipeline statistics queries
+    enum ECounterPass
+    {
+        PASS_PROBE_TRACE = 0,
+        PASS_RADIANCE_CACHE_SHADE,
+        PASS_PROBE_RAY_RESOLVE,
+        PASS_COUNT,
+    };
+
     enum class EStatType
     {
         CPU = 0,
         GPU,
     };
 
+    // The timelines of a trace capture
+    enum class ETraceTrack
+    {
+        CPU = 0,
+        GPU_GRAPHICS,
+    };
+
     struct Stat
     {
-        static uint32_t frameGPUQueryCount;
+        static std::atomic<uint32_t> frameGPUQueryCount;    // Passes recorded in parallel (Graphics::RecordPasses) allocate queries concurrently
         static void ResetGPUQueryCount() { frameGPUQueryCount = 0; }
 
-        Stat() {}
-        Stat(EStatType type) { this->type = type; }
+        Stat() { Reset(); }
+        Stat(EStatType type) { this->type = type; Reset(); }
         Stat(EStatType type, std::string name, uint32_t sampleSize)
         {
             this->type = type;
             this->name = name;
-            this->sampleSize = sampleSize;
+            Reset(sampleSize);
         }
 
         const static uint32_t FallbackSampleSize = 10;
@@ -74,24 +110,181 @@ namespace Instrumentation
         uint32_t sampleSize = FallbackSampleSize;
         double elapsed = 0; // milliseconds
         double average = 0;
-        double total = 0;
-        std::queue<double> samples;
+        double total = 0;                   // Running sum of the samples
+        std::vector<double> samples;        // Ring buffer of the last sampleSize elapsed times, only (re)allocated by Reset()
+        uint32_t sampleCount = 0;           // Number of valid samples
+        uint32_t sampleHead = 0;            // Next sample to overwrite
 
         void Reset(uint32_t sampleSize = FallbackSampleSize)
         {
             elapsed = 0;
             average = 0;
             total = 0;
-            samples = {};
-            this->sampleSize = sampleSize;
+            this->sampleSize = (std::max)(sampleSize, 1u);
+            samples.assign(this->sampleSize, 0.0);
+            sampleCount = 0;
+            sampleHead = 0;
         }
 
+        /**
+         * Elapsed time (ms) at the given percentile (0.0 - 1.0) of the valid samples.
+         * Sorts a copy of the samples, call it for reporting (not every frame).
+         */
+        double GetPercentile(double percentile) const;
+
+    };
+
+    // Histogram bins of the radiance cache coverage: cells hit by 1, 2-3, 4-7, ..., 512 or more probe rays
+    static const uint32_t CACHE_COVERAGE_BINS = 10;
+
+    // Radiance cache occupancy and probe ray coverage of a cascade, reduced from the cache metadata (see RadianceCacheStatsCS.hlsl)
+    struct CacheCascadeStats
+    {
+        uint32_t occupied = 0;                          // Slots owned by a cell
+        uint32_t live = 0;                              // Occupied slots used within the eviction age
+        uint32_t ageSum = 0;                            // Frames since the last use, summed over the live slots
+        uint32_t stepSum = 0;                           // Probe sequence steps from the home slot, summed over the live slots
+        uint32_t probeRays = 0;                         // Probe rays that hit a cell
+        uint32_t coveredCells = 0;                      // Cells hit by probe rays
+        uint32_t coverage[CACHE_COVERAGE_BINS] = {};    // Covered cells by probe rays that hit them (bin i: 2^i to 2^(i+1) - 1 rays)
+    };
+
+    /**
+     * The GPU counters of the last frame read back (config app.gpuCounters).
+     */
+    struct Counters
+    {
+        static const char* GetName(ECounter counter);
+        static const char* GetPassName(ECounterPass pass);
+
+        bool enabled = false;
+        uint64_t frame = 0;                             // Frame the counters were recorded (0 until the first readback)
+        uint32_t values[COUNTER_COUNT] = {};
+        uint64_t csInvocations[PASS_COUNT] = {};        // Compute shader invocations of each pass (pipeline statistics)
+        uint32_t cacheCascadeCells = 0;                 // Slots of each radiance cache cascade
+        std::vector<CacheCascadeStats> cacheCascades;
+
+        uint64_t GetRays() const { return (uint64_t)values[PROBE_RAYS] + values[INDIRECT_RAYS]; }
+
+        /**
+         * Fraction of the probe ray hits whose radiance cache cell had radiance history.
+         */
+        double GetCacheHitRate() const
+        {
+            uint64_t lookups = (uint64_t)values[CACHE_HITS] + values[CACHE_MISSES] + values[CACHE_COLLISIONS];
+            return (lookups > 0) ? ((double)values[CACHE_HITS] / (double)lookups) : 0.0;
+        }
+
+        /**
+         * Radiance cache occupancy summed over the cascades.
+         */
+        CacheCascadeStats GetCacheTotals() const
+        {
+            CacheCascadeStats totals;
+            for (const CacheCascadeStats& cascade : cacheCascades)
+            {
+                totals.occupied += cascade.occupied;
+                totals.live += cascade.live;
+                totals.ageSum += cascade.ageSum;
+                totals.stepSum += cascade.stepSum;
+                totals.probeRays += cascade.probeRays;
+                totals.coveredCells += cascade.coveredCells;
+                for (uint32_t bin = 0; bin < CACHE_COVERAGE_BINS; bin++) totals.coverage[bin] += cascade.coverage[bin];
+            }
+            return totals;
+        }
+
+        /**
+         * Fraction of the cascade's slots owned by a cell, or of every slot when cascade is -1.
+         */
+        double GetCacheLoadFactor(int32_t cascade = -1) const
+        {
+            uint64_t slots = (cascade < 0) ? ((uint64_t)cacheCascadeCells * cacheCascades.size()) : cacheCascadeCells;
+            if (slots == 0 || cascade >= (int32_t)cacheCascades.size()) return 0.0;
+
+            uint32_t occupied = (cascade < 0) ? GetCacheTotals().occupied : cacheCascades[cascade].occupied;
+            return (double)occupied / (double)slots;
+        }
+
+        /**
+         * Average frames since the last use of the live radiance cache slots.
+         */
+        double GetCacheAverageAge() const
+        {
+            CacheCascadeStats totals = GetCacheTotals();
+            return (totals.live > 0) ? ((double)totals.ageSum / (double)totals.live) : 0.0;
+        }
+
+        /**
+         * Average probe sequence length of the live radiance cache slots (1: every cell owns its home slot).
+         * Compares the collisions of the radiance cache hash functions (config ddgi.radianceCacheHash).
+         */
+        double GetCacheAverageProbeLength() const
+        {
+            CacheCascadeStats totals = GetCacheTotals();
+            return (totals.live > 0) ? (1.0 + (double)totals.stepSum / (double)totals.live) : 0.0;
+        }
+
+        /**
+         * Probe rays per covered radiance cache cell of the cascade, or of every cascade when cascade is -1.
+         * The amortization factor of the cache: rays that share a cell share its shading.
+         */
+        double GetCacheAmortization(int32_t cascade = -1) const
+        {
+            if (cascade >= (int32_t)cacheCascades.size()) return 0.0;
+            CacheCascadeStats stats = (cascade < 0) ? GetCacheTotals() : cacheCascades[cascade];
+            return (stats.coveredCells > 0) ? ((double)stats.probeRays / (double)stats.coveredCells) : 0.0;
+        }
+
+        /**
+         * Rays traced per second at the given GPU frame time (ms).
+         */
+        double GetRaysPerSecond(double frameMs) const { return (frameMs > 0) ? ((double)GetRays() * 1000.0 / frameMs) : 0.0; }
+    };
+
+    struct TraceEvent
+    {
+        const Stat* stat = nullptr;
+        int64_t begin = 0;                              // Perf counter ticks, GPU timestamps are aligned to the CPU clock
+        int64_t end = 0;
+        uint32_t frame = 0;                             // Frame of the capture the scope belongs to
+        ETraceTrack track = ETraceTrack::CPU;
+    };
+
+    /**
+     * Records every CPU scope and GPU timestamp pair for a number of frames.
+     * The capture is written as Chrome Trace Event JSON (chrome://tracing, ui.perfetto.dev).
+     */
+    struct Trace
+    {
+        bool capturing = false;
+        uint32_t frame = 0;                             // Frames since the capture started
+        uint32_t numFrames = 0;
+        int64_t origin = 0;                             // Perf counter ticks at the start of the capture
+        std::vector<TraceEvent> events;
+        std::mutex mutex;                               // Guards events, CPU scopes are recorded from the pass recording threads too
+
+        void Start(uint32_t frames);
+        void Stop();
+
+        /**
+         * Move to the next frame, returns true when the capture completes.
+         * Call after the GPU timestamps of the previous frame are read back.
+         */
+        bool NextFrame();
+
+        void Record(const Stat* stat, int64_t begin, int64_t end, uint32_t frame, ETraceTrack track);
+        bool Write(std::string file) const;
     };
 
     struct Performance
     {
+        std::deque<Stat> stats;             // Storage of every stat, a deque never moves its elements as it grows
+        Counters counters;
+        Trace trace;
         std::vector<Stat*> gpuTimes;
         std::vector<Stat*> cpuTimes;
+        uint64_t frameAllocations = 0;      // Heap allocations of the last frame (see Memory::GetAllocationCount), zero at steady state
 
         const static uint32_t DefaultSampleSize = 50;
 
@@ -99,15 +292,17 @@ namespace Instrumentation
 
         uint32_t GetNumTotalGPUQueries() const { return static_cast<uint32_t>(gpuTimes.size()) * 2; }
 
-        Stat*& AddCPUStat(std::string name, uint32_t sampleSize = DefaultSampleSize)
+        Stat* AddCPUStat(std::string name, uint32_t sampleSize = DefaultSampleSize)
         {
-            cpuTimes.emplace_back(new Stat(EStatType::CPU, name, sampleSize));
+            stats.emplace_back(EStatType::CPU, name, sampleSize);
+            cpuTimes.push_back(&stats.back());
             return cpuTimes.back();
         }
 
-        Stat*& AddGPUStat(std::string name, uint32_t sampleSize = DefaultSampleSize)
+        Stat* AddGPUStat(std::string name, uint32_t sampleSize = DefaultSampleSize)
         {
-            gpuTimes.emplace_back(new Stat(EStatType::GPU, name, sampleSize));
+            stats.emplace_back(EStatType::GPU, name, sampleSize);
+            gpuTimes.push_back(&stats.back());
             return gpuTimes.back();
         }
 
@@ -119,38 +314,27 @@ namespace Instrumentation
 
         void Reset(uint32_t sampleSize = DefaultSampleSize)
         {
-            for (Stat* stat : cpuTimes)
-            {
-                stat->Reset(sampleSize);
-            }
-
-            for (Stat* stat : gpuTimes)
+            for (Stat& stat : stats)
             {
-                stat->Reset(sampleSize);
+                stat.Reset(sampleSize);
             }
         }
 
         void Cleanup()
         {
-            size_t index;
-            for (index = 0; index < cpuTimes.size(); index++)
-            {
-                delete cpuTimes[index];
-                cpuTimes[index] = nullptr;
-            }
-
-            for (index = 0; index < gpuTimes.size(); index++)
-            {
-                delete gpuTimes[index];
-                gpuTimes[index] = nullptr;
-            }
-
             cpuTimes.clear();
             gpuTimes.clear();
+            stats.clear();
+            counters = Counters();
+            trace.Stop();
+            trace.events.clear();
         }
 
     };
 
+    int64_t GetPerfCounter();
+    int64_t GetPerfCounterFrequency();
+
     void Begin(Stat* s);
     void End(Stat* s);
     void Resolve(Stat* s);
@@ -0,0 +1,52 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Jobs
+{
+    /**
+     * A fixed set of worker threads that run batches of jobs.
+     * Run() returns once every job of the batch is done, the calling thread takes jobs too.
+     */
+    class Pool
+    {
+    public:
+        ~Pool() { Stop(); }
+
+        void Start(uint32_t numWorkers);
+        void Stop();
+        void Run(const std::vector<std::function<void()>>& jobs) { Run(jobs.data(), jobs.size()); }
+        void Run(const std::function<void()>* jobs, size_t numJobs);
+
+        uint32_t GetNumWorkers() const { return static_cast<uint32_t>(workers.size()); }
+
+    private:
+        bool RunNextJob(std::unique_lock<std::mutex>& lock);
+        void Work();
+
+        std::vector<std::thread> workers;
+        std::mutex mutex;
+        std::condition_variable wake;                           // Signaled when a batch starts or the pool stops
+        std::condition_variable done;                           // Signaled when the last job of the batch completes
+
+        const std::function<void()>* batch = nullptr;
+        size_t batchSize = 0;
+        size_t next = 0;                                        // Index of the next job to take
+        size_t remaining = 0;                                   // Jobs of the batch not yet completed
+        bool stopping = false;
+    };
+}
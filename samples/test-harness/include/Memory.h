@@ -0,0 +1,108 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace Memory
+{
+    /**
+     * Number of heap allocations (global operator new) made by the process so far, from any thread.
+     * The difference across a frame is the frame's allocation count, zero once the render loop reaches a steady state.
+     */
+    uint64_t GetAllocationCount();
+
+    /**
+     * A linear allocator for the transient data of a frame (barrier lists, scratch arrays).
+     * Allocate() is thread safe (passes recorded in parallel share the arena), Reset() is not and runs at the start of a frame.
+     * Allocations that don't fit come from the heap and are freed by the next Reset(), which grows the arena to fit the frame.
+     * Nothing allocated from the arena is destroyed, it holds trivially destructible types only.
+     */
+    class FrameArena
+    {
+    public:
+        const static size_t DefaultCapacity = 256 * 1024;
+
+        explicit FrameArena(size_t capacity = DefaultCapacity);
+        ~FrameArena();
+
+        FrameArena(const FrameArena&) = delete;
+        FrameArena& operator=(const FrameArena&) = delete;
+
+        void* Allocate(size_t size, size_t alignment);
+
+        /**
+         * Allocate an uninitialized array of count elements.
+         */
+        template<typename T>
+        T* Allocate(size_t count)
+        {
+            static_assert(std::is_trivially_destructible<T>::value, "FrameArena allocations are never destroyed");
+            return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+        }
+
+        void Reset();
+
+        size_t GetCapacity() const { return capacity; }
+        size_t GetUsed() const { return offset.load(std::memory_order_relaxed); }
+
+    private:
+        uint8_t* block = nullptr;
+        size_t capacity = 0;
+        std::atomic<size_t> offset;
+
+        std::mutex overflowMutex;
+        std::vector<void*> overflow;                    // Heap allocations of the frame that didn't fit
+        size_t overflowSize = 0;                        // Bytes requested by them (alignment included)
+    };
+
+    /**
+     * A vector with inline storage for up to N elements, for small lists built every frame.
+     * Pushing past the capacity is a bug, it asserts (debug builds) and drops the element.
+     */
+    template<typename T, size_t N>
+    class FixedVector
+    {
+    public:
+        void push_back(const T& item)
+        {
+            assert(count < N);
+            if (count < N) items[count++] = item;
+        }
+
+        void clear() { count = 0; }
+
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        static constexpr size_t capacity() { return N; }
+
+        T* data() { return items; }
+        const T* data() const { return items; }
+
+        T& operator[](size_t index) { return items[index]; }
+        const T& operator[](size_t index) const { return items[index]; }
+
+        T* begin() { return items; }
+        T* end() { return items + count; }
+        const T* begin() const { return items; }
+        const T* end() const { return items + count; }
+
+    private:
+        T items[N] = {};
+        size_t count = 0;
+    };
+}
@@ -0,0 +1,96 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace RenderGraph
+{
+    // The frame resources the passes exchange, one bit each in the read and write masks of a pass
+    enum EResource
+    {
+        GBUFFER = 0,        // GBuffer A-D (and the visibility buffer)
+        DDGI_PROBES,        // Probe textures of the DDGIVolumes (irradiance, distance, data, variability)
+        DDGI_OUTPUT,        // Indirect lighting gathered from the probes in screen-space
+        RTAO_OUTPUT,        // Filtered ambient occlusion
+        BACKBUFFER,         // The swap chain image presented at the end of the frame
+        RESOURCE_COUNT
+    };
+
+    inline uint32_t Bit(EResource resource) { return (1u << resource); }
+
+    enum class EQueue
+    {
+        GRAPHICS = 0,
+        COMPUTE,
+    };
+
+    const uint32_t MaxPasses = 16;
+
+    struct Pass
+    {
+        const char* name = nullptr;
+        const std::function<void()>* execute = nullptr;
+        uint32_t reads = 0;                 // Resources the pass reads (EResource bits)
+        uint32_t writes = 0;                // Resources the pass writes
+        uint32_t asyncWrites = 0;           // Written by the part of the pass that may run on the compute queue (a subset of writes)
+        bool     sideEffects = false;       // Never culled (the pass writes something outside of the graph)
+
+        // Derived by Compile()
+        bool     culled = false;            // Nothing live reads what the pass writes, it isn't recorded
+        EQueue   queue = EQueue::GRAPHICS;  // Queue the asyncWrites are produced on
+        uint32_t barriers = 0;              // Resources with writes (or reads) of earlier passes to wait for before the pass accesses them
+        bool     waitForAsync = false;      // The pass accesses asyncWrites of an earlier pass, the graphics queue waits for the compute queue first
+    };
+
+    /**
+     * A render graph rebuilt every frame: the passes declare the resources they read and write, in submission order.
+     * Compile() culls the passes whose writes are never read, derives the barriers between the passes and the queue
+     * of each pass's async work, and the lifetime of each resource. The storage is fixed, building a frame doesn't allocate.
+     *
+     * The barriers are recorded by the function set with SetBarrierFunction(), ahead of the pass on its command list.
+     */
+    class Graph
+    {
+    public:
+        using BarrierFunction = std::function<void(const Pass& pass)>;
+
+        Graph();
+        Graph(const Graph&) = delete;
+        Graph& operator=(const Graph&) = delete;
+
+        void SetBarrierFunction(const BarrierFunction& function) { barrierFunction = function; }
+
+        void Reset();
+        bool AddPass(const char* name, const std::function<void()>& execute, uint32_t reads, uint32_t writes, uint32_t asyncWrites = 0, bool sideEffects = false);
+        void Compile(uint32_t outputs, bool asyncCompute);
+        void GetPasses(std::vector<std::function<void()>>& passes) const;
+
+        uint32_t GetNumPasses() const { return numPasses; }
+        const Pass& GetPass(uint32_t passIndex) const { return graphPasses[passIndex]; }
+
+        bool GetLifetime(EResource resource, uint32_t& firstPass, uint32_t& lastPass) const;
+        bool CanAlias(EResource a, EResource b) const;
+
+    private:
+        Pass graphPasses[MaxPasses];
+        std::function<void()> recordPasses[MaxPasses];  // Records the barriers of a pass, then the pass. Built once.
+        uint32_t numPasses = 0;
+        uint32_t outputs = 0;                           // Resources read after the frame (presented, or history of the next frame)
+
+        uint32_t firstUse[RESOURCE_COUNT] = {};         // Index of the first and last live pass accessing each resource
+        uint32_t lastUse[RESOURCE_COUNT] = {};
+
+        BarrierFunction barrierFunction;
+    };
+}
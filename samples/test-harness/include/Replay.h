@@ -0,0 +1,71 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#pragma once
+
+#include "Configs.h"
+#include "Inputs.h"
+#include "Instrumentation.h"
+#include "Scenes.h"
+
+namespace Replay
+{
+    // Config options toggled by the keyboard, stored as bits of each recorded frame
+    enum EToggle
+    {
+        TOGGLE_DDGI = 0,
+        TOGGLE_DDGI_SHOW_INDIRECT,
+        TOGGLE_DDGI_SHOW_TEXTURES,
+        TOGGLE_DDGI_SHOW_PROBES,
+        TOGGLE_RTAO,
+        TOGGLE_PATH_TRACE,
+        TOGGLE_SHOW_UI,
+        TOGGLE_SHOW_PERF,
+        TOGGLE_COUNT
+    };
+
+    // The state of a frame once its inputs are handled, and the frame's timing
+    struct Frame
+    {
+        uint32_t event = 0;                         // Inputs::EInputEvent left for the end of the frame (camera movement, image captures, fullscreen)
+        uint32_t toggles = 0;                       // Bits of EToggle
+        uint32_t renderMode = 0;
+        uint32_t activeCamera = 0;
+        DirectX::XMFLOAT3 position = { 0.f, 0.f, 0.f };
+        float yaw = 0.f;
+        float pitch = 0.f;
+        float cpuTime = 0.f;                        // Frame CPU time (ms)
+    };
+
+    /**
+     * Records the frames of a run to a replay log (--record <file>), or drives the frames of a run from one (--replay <file>).
+     * The DDGIVolumes' random rotations are seeded from the log, so the replayed frames trace the recorded rays.
+     * A finished replay writes its per pass GPU times next to the recorded ones (replayComparison.csv in the screenshot path).
+     */
+    struct Session
+    {
+        bool recording = false;
+        bool replaying = false;
+        bool finished = false;                      // Every recorded frame was replayed
+        uint32_t frameIndex = 0;                    // Next frame to replay
+
+        std::vector<uint32_t> rngSeeds;             // Random rotation seed of each DDGIVolume
+        std::vector<Frame> frames;
+        std::vector<std::string> gpuStatNames;
+        std::vector<float> gpuTimes;                // GPU time (ms) of each stat, gpuStatNames.size() per frame
+        std::vector<float> replayedGPUTimes;
+        std::vector<float> replayedCPUTimes;
+    };
+
+    bool Start(Session& session, Configs::Config& config, std::ofstream& log);
+    void UpdateInputs(Session& session, Inputs::Input& input, Configs::Config& config, Scenes::Scene& scene);
+    void EndFrame(Session& session, const Instrumentation::Performance& perf);
+    bool Finish(Session& session, const Configs::Config& config, std::ofstream& log);
+}
@@ -18,17 +18,28 @@
 namespace Scenes
 {
 
+    // A file the scene is parsed from, the modification stamp and content hash detect changes (see Caches::IsFileCurrent())
+    struct SourceFile
+    {
+        std::string filepath = "";
+        uint64_t stamp = 0;
+        uint64_t hash = 0;
+    };
+
     struct MeshPrimitive
     {
-        int                           index = -1;
-        int                           material = -1;
-        bool                          opaque = true;
-        bool                          doubleSided = false;
-        uint32_t                      vertexByteOffset = 0;
-        uint32_t                      indexByteOffset = 0;
-        rtxgi::AABB                   boundingBox; // not instanced transformed
-        std::vector<Graphics::Vertex> vertices;
-        std::vector<uint32_t>         indices;
+        int                                 index = -1;
+        int                                 material = -1;
+        bool                                opaque = true;
+        bool                                doubleSided = false;
+        uint32_t                            vertexByteOffset = 0;
+        uint32_t                            indexByteOffset = 0;
+        uint64_t                            hash = 0;    // hash of the glTF source geometry, unchanged geometry is reused from the scene cache
+        rtxgi::AABB                         boundingBox; // not instanced transformed
+        std::vector<Graphics::Vertex>       vertices;    // empty for scene meshes after PackVertices()
+        std::vector<Graphics::PackedVertex> packedVertices;
+        std::vector<uint32_t>               vertexAlbedos; // RGBA8 low frequency albedo and opacity of each vertex, for GI hit shading (see Caches::BakeVertexAlbedos())
+        std::vector<uint32_t>               indices;
     };
 
     struct Mesh
@@ -45,6 +56,7 @@ namespace Scenes
     {
         std::string name = "";
         int meshIndex = -1;
+        bool dirty = false;      // transform changed, the TLAS is refit
         rtxgi::AABB boundingBox; // instance transformed
         float transform[3][4] =
         {
@@ -112,8 +124,23 @@ namespace Scenes
 
         rtxgi::AABB boundingBox;
 
+        bool instancesRebuild = false; // instances added, removed, or their meshes changed, the TLAS is rebuilt
+        bool sortedTriangles = false;  // mesh primitive triangles sorted spatially when the cache was built (config scene.sortTriangles)
+
+        uint8_t* cacheData = nullptr;  // memory mapped scene cache file, cached texture texels point into it (see Caches::Deserialize)
+        uint64_t cacheSize = 0;
+
+        std::vector<SourceFile> sources; // the glTF file and its buffer files
+
         std::vector<int> rootNodes;
         std::vector<SceneNode> nodes;
+
+        // The scene graph flattened breadth first, parents before their children (see UpdateTransforms)
+        std::vector<int> flatNodes;                      // node index at each flat position
+        std::vector<int> flatParents;                    // flat position of the parent, -1 for root nodes
+        std::vector<uint32_t> flatLevels;                // first flat position of each depth, then the end
+        std::vector<DirectX::XMMATRIX> worldTransforms;  // global transform at each flat position
+
         std::vector<Camera> cameras;
         std::vector<Light> lights;
         std::vector<MeshInstance> instances;
@@ -126,7 +153,7 @@ namespace Scenes
     };
 
     bool Initialize(const Configs::Config& config, Scene& scene, std::ofstream& log);
-    void Traverse(size_t nodeIndex, DirectX::XMMATRIX transform, Scene& scene);
+    void UpdateTransforms(Scene& scene);
     void UpdateCamera(Camera& camera);
     void Cleanup(Scene& scene);
 
@@ -0,0 +1,33 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ShaderWatch
+{
+    /**
+     * Receives the shaders rebuilt by the watch mode of the shader compiler tool (tools/ShaderCompiler --watch --notify <port>),
+     * as UDP datagrams on the loopback interface. Polled once a frame, the workloads using the shaders are reloaded.
+     */
+    struct Listener
+    {
+        intptr_t socket = -1;
+        uint32_t port = 0;
+    };
+
+    bool Open(Listener& listener, uint32_t port, std::ofstream& log);
+    bool Poll(Listener& listener, std::vector<std::string>& sourcePaths);
+    void Close(Listener& listener);
+}
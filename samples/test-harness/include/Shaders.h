@@ -14,6 +14,9 @@
 #include "Configs.h"
 
 #include <dxcapi.h>
+#include <unordered_map>
+
+class HashCache;
 
 namespace Shaders
 {
@@ -33,6 +36,10 @@ namespace Shaders
 
         std::string           root = "";
         std::string           rtxgi = "";
+
+        HashCache*            cache = nullptr;       // on-disk shader cache index (tools/ShaderCompiler format), null when disabled
+        std::string           cachePath = "";        // directory of the cached bytecode and the cache index
+        std::string           compilerVersion = "";
     };
 
     struct ShaderProgram
@@ -117,8 +124,27 @@ namespace Shaders
         }
     };
 
+    // The bytecode of the permutations compiled in one batch, reused by shaders with the same source, entry point, arguments, and defines.
+    // Release it at the end of the batch, the sources are not checked for changes in between.
+    struct ShaderPermutations
+    {
+        std::unordered_map<std::wstring, IDxcBlob*> bytecode;
+        uint32_t hits = 0;
+
+        void Release()
+        {
+            for (auto& permutation : bytecode)
+            {
+                SAFE_RELEASE(permutation.second);
+            }
+            bytecode.clear();
+            hits = 0;
+        }
+    };
+
     bool Initialize(const Configs::Config& config, ShaderCompiler& compiler);
     void AddDefine(ShaderProgram& shader, std::wstring name, std::wstring value);
     bool Compile(ShaderCompiler& compiler, ShaderProgram& shader, bool warningsAsErrors = true);
+    bool Compile(ShaderCompiler& compiler, ShaderProgram& shader, ShaderPermutations& permutations, bool warningsAsErrors = true);
     void Cleanup(ShaderCompiler& compiler);
 }
@@ -42,7 +42,11 @@ namespace Textures
         uint64_t texelBytes = 0;    // the number of bytes (aligned, all mips)
         uint8_t* texels = nullptr;
 
+        uint64_t sourceStamp = 0;   // the source image file's modification stamp and content hash (see Caches::IsFileCurrent())
+        uint64_t sourceHash = 0;
+
         bool cached = false;
+        bool mapped = false;        // the texels point into a memory mapped cache file and are not owned
 
         void SetName(std::string n)
         {
@@ -53,11 +57,14 @@ namespace Textures
 #if defined(GPU_COMPRESSION)
     bool Initialize();
     void Cleanup();
+    bool CompressBC6H(uint32_t width, uint32_t height, uint32_t format, size_t rowPitch, const uint8_t* texels, std::vector<uint8_t>& compressed);
 #endif
 
     bool Load(Texture& texture);
     void Unload(Texture& texture);
     uint32_t GetBC7TextureSizeInBytes(uint32_t width, uint32_t height);
+    bool GetMipTexels(const Texture& texture, uint32_t mip, std::vector<uint8_t>& texels, uint32_t& width, uint32_t& height);
+    bool GetAverageColor(const Texture& texture, float color[3]);
 #if defined(__x86_64__) || defined(_M_X64)
     bool Compress(Texture& texture, bool quick = false);
     bool MipmapAndCompress(Texture& texture, bool quick = false);
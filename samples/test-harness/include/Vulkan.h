@@ -15,7 +15,7 @@
 #endif
 #include <vulkan/vulkan.h>
 
-#include <rtxgi/ddgi/DDGIVolume.h>
+#include <rtxgi/ddgi/gfx/DDGIVolume_VK.h>
 
 namespace Graphics
 {
@@ -31,8 +31,8 @@ namespace Graphics
             uint64_t availability;
         };
 
-        #define GPU_TIMESTAMP_BEGIN(x) vkCmdWriteTimestamp(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, vkResources.timestampPool, x);
-        #define GPU_TIMESTAMP_END(x) vkCmdWriteTimestamp(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, vkResources.timestampPool, x);
+        #define GPU_TIMESTAMP_BEGIN(x) vkCmdWriteTimestamp(GetCmdBuffer(vk), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, vkResources.timestampPool, x);
+        #define GPU_TIMESTAMP_END(x) vkCmdWriteTimestamp(GetCmdBuffer(vk), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, vkResources.timestampPool, x);
     #else
         #define GPU_TIMESTAMP_BEGIN(x) 
         #define GPU_TIMESTAMP_END(x) 
@@ -121,14 +121,18 @@ namespace Graphics
             VkDeviceMemory instancesMemory = nullptr;       // Only valid for TLAS
             VkBuffer instancesUpload = nullptr;             // Only valid for TLAS
             VkDeviceMemory instancesUploadMemory = nullptr; // Only valid for TLAS
+            rtxgi::vulkan::DDGIMemoryAllocation* asAllocation = nullptr;      // Only valid for memory pool BLAS (asMemory is nullptr)
+            rtxgi::vulkan::DDGIMemoryAllocation* scratchAllocation = nullptr; // Only valid for memory pool BLAS (scratchMemory is nullptr)
 
-            void Release(VkDevice device)
+            void Release(VkDevice device, rtxgi::vulkan::DDGIMemoryPool* pool = nullptr)
             {
                 vkDestroyAccelerationStructureKHR(device, asKHR, nullptr);
                 vkDestroyBuffer(device, asBuffer, nullptr);
                 vkFreeMemory(device, asMemory, nullptr);
                 vkDestroyBuffer(device, scratch, nullptr);
                 vkFreeMemory(device, scratchMemory, nullptr);
+                rtxgi::vulkan::FreeDDGIMemory(pool, asAllocation);
+                rtxgi::vulkan::FreeDDGIMemory(pool, scratchAllocation);
                 if (instances != nullptr) vkDestroyBuffer(device, instances, nullptr);
                 if (instancesMemory != nullptr) vkFreeMemory(device, instancesMemory, nullptr);
                 if (instancesUpload != nullptr) vkDestroyBuffer(device, instancesUpload, nullptr);
@@ -212,31 +216,66 @@ namespace Graphics
             int                                     queueFamilyIndex = -1;
 
             VkCommandPool                           commandPool = nullptr;
-            VkCommandBuffer                         cmdBuffer[MAX_FRAMES_IN_FLIGHT] = { nullptr, nullptr };
+            VkCommandBuffer                         cmdBuffer[MAX_FRAMES_IN_FLIGHT] = {};
+
+            // Async compute (DDGI probe update chain), on a dedicated compute queue family when the device has one.
+            // Timeline semaphores order the queues, see SubmitComputeCmdList().
+            VkQueue                                 computeQueue = nullptr;
+            int                                     computeQueueFamilyIndex = -1;
+            uint32_t                                sharedQueueFamilyIndices[2] = {};   // Graphics and compute, for concurrent sharing of resources
+            VkCommandPool                           computeCommandPool[MAX_FRAMES_IN_FLIGHT] = {};
+            VkCommandBuffer                         computeCmdBuffer[MAX_FRAMES_IN_FLIGHT] = {};
+            VkSemaphore                             graphicsToComputeSemaphore = nullptr;   // Signaled by queue when the compute work may start
+            VkSemaphore                             computeToGraphicsSemaphore = nullptr;   // Signaled by computeQueue when the compute work is done
+            uint64_t                                graphicsToComputeValue = 0;
+            uint64_t                                computeToGraphicsValue = 0;
+            uint64_t                                computeWaitValue = 0;   // The compute work the current frame's graphics work waits on (the previous frame's)
+
+            // Parallel pass recording (see RecordPasses), a command pool per command buffer since pools are externally synchronized.
+            // The last command buffer of each frame records the work after the passes.
+            VkCommandPool                           passCommandPool[MAX_FRAMES_IN_FLIGHT][MAX_PASS_CMD_LISTS + 1] = {};
+            VkCommandBuffer                         passCmdBuffer[MAX_FRAMES_IN_FLIGHT][MAX_PASS_CMD_LISTS + 1] = {};
+            std::vector<VkCommandBuffer>            frameCmdBuffers;        // Ended command buffers of the frame, submitted in order by SubmitCmdList()
+            Jobs::Pool                              passWorkers;
+            std::function<void()>                   passJobs[MAX_PASS_CMD_LISTS];   // Record recordingPasses[i] on its own buffer, built once
+            const std::vector<std::function<void()>>* recordingPasses = nullptr;
+            bool                                    parallelRecording = false;  // config app.parallelRecording
+
+            // Transient CPU data of the frame (barrier lists, scratch arrays), reset by MoveToNextFrame()
+            Memory::FrameArena                      frameArena;
 
             VkSurfaceKHR                            surface = nullptr;
             VkSwapchainKHR                          swapChain = nullptr;
-            VkImage                                 swapChainImage[MAX_FRAMES_IN_FLIGHT] = { nullptr, nullptr };
-            VkImageView                             swapChainImageView[MAX_FRAMES_IN_FLIGHT] = { nullptr, nullptr };
+            VkImage                                 swapChainImage[MAX_SWAPCHAIN_IMAGES] = {};      // Indexed by imageIndex, not frameIndex
+            VkImageView                             swapChainImageView[MAX_SWAPCHAIN_IMAGES] = {};
+            uint32_t                                swapChainImageCount = 0;
             VkFormat                                swapChainFormat = VK_FORMAT_UNDEFINED;
             VkColorSpaceKHR                         swapChainColorSpace;
 
             VkRenderPass                            renderPass = nullptr;
-            VkFramebuffer                           frameBuffer[MAX_FRAMES_IN_FLIGHT] = { nullptr, nullptr };
+            VkFramebuffer                           frameBuffer[MAX_SWAPCHAIN_IMAGES] = {};
 
             VkFence                                 immediateFence = nullptr;
-            VkFence                                 fences[MAX_FRAMES_IN_FLIGHT] = { nullptr, nullptr };
 
-            VkSemaphore                             imageAcquiredSemaphore[MAX_FRAMES_IN_FLIGHT] = { nullptr, nullptr };
-            VkSemaphore                             presentSemaphore[MAX_FRAMES_IN_FLIGHT] = { nullptr, nullptr };
+            // Frame pacing, a timeline semaphore signaled with the frame number by each frame's submission
+            VkSemaphore                             frameSemaphore = nullptr;
+            uint64_t                                frameSemaphoreValue[MAX_FRAMES_IN_FLIGHT] = {};     // Frame number last submitted with this frame index
+            uint64_t                                frameComputeValue[MAX_FRAMES_IN_FLIGHT] = {};       // Compute work last submitted with this frame index
+
+            VkSemaphore                             imageAcquiredSemaphore[MAX_FRAMES_IN_FLIGHT] = {};
+            VkSemaphore                             presentSemaphore[MAX_FRAMES_IN_FLIGHT] = {};
 
             VkViewport                              viewport = {};
             VkRect2D                                scissor = {};
+            VkViewport                              renderViewport = {};    // The render area of the screen-space passes (see renderWidth)
+            VkRect2D                                renderScissor = {};
 
             GLFWwindow*                             window = nullptr;
             RECT                                    windowRect = {};
 
             Shaders::ShaderCompiler                 shaderCompiler;
+            VkPipelineCache                         pipelineCache = nullptr;    // persisted across launches (shaders.pipelineCache)
+            std::string                             pipelineCachePath = "";
 
             Features                                features = {};
 
@@ -252,15 +291,39 @@ namespace Graphics
 
             int                                     width = 0;
             int                                     height = 0;
+            int                                     renderWidth = 0;        // DDGI mode's screen-space passes render to the top left renderWidth x renderHeight
+            int                                     renderHeight = 0;       // of the (width x height) render targets, see SetResolutionScale()
+            float                                   resolutionScale = 1.f;
             bool                                    vsync = true;
             bool                                    vsyncChanged = false;
             int                                     fullscreen = 0;
             bool                                    fullscreenChanged = false;
 
             bool                                    supportsShaderExecutionReordering = false;
+            bool                                    supportsMemoryBudget = false;             // VK_EXT_memory_budget is enabled
+            bool                                    supportsRasterizerOrderedViews = false;   // Not implemented in Vulkan
+            bool                                    supportsVariableRateShading = false;   // Not implemented in Vulkan
+
+            bool                                    DDGIAsyncCompute = false;   // Run the DDGI probe update chain on the compute queue, one frame behind the gather
+
+            // Radiance cache (see Direct3D12.h, the Vulkan path has no light grid, update budget, work list sort, or GPU counters)
+            uint32_t                                CacheCount = 100000;
+            float                                   CascadeCellRadius = 0.2f;
+            float                                   CascadeDistance = 20.0f;
+            float                                   RadianceCacheSampleCount = 16.0f;
+            bool                                    RadianceCacheCompactHits = true;
+            uint32_t                                RadianceCacheRadianceFormat = 2;
+            bool                                    RadianceCacheReservoirSampling = true;
+            bool                                    RadianceCacheWaveRays = true;
+            uint32_t                                RadianceCacheCascadeMode = 1;
+            uint32_t                                RadianceCacheHashFunction = 0;
+            bool                                    RadianceCacheBrickLayout = false;
+            uint32_t                                RadianceCacheCompactionInterval = 16;
 
             VkDebugUtilsMessengerEXT                debugUtilsMessenger = nullptr;
 
+            rtxgi::vulkan::DDGIMemoryPool*          memoryPool = nullptr;       // Suballocates scene geometry, acceleration structure, and texture memory
+
             VkPhysicalDeviceFeatures                           deviceFeatures = {};
             VkPhysicalDeviceProperties2                        deviceProps = {};
             VkPhysicalDeviceAccelerationStructurePropertiesKHR deviceASProps = {};
@@ -312,12 +375,14 @@ namespace Graphics
             // Constant Buffers
             VkBuffer                                cameraCB = nullptr;
             VkDeviceMemory                          cameraCBMemory = nullptr;
+            VkBuffer                                cameraCBUploadBuffer = nullptr;   // MAX_FRAMES_IN_FLIGHT slots, indexed by frameIndex
+            VkDeviceMemory                          cameraCBUploadMemory = nullptr;
             uint8_t*                                cameraCBPtr = nullptr;
 
             // Structured Buffers
             VkBuffer                                lightsSTB = nullptr;
             VkDeviceMemory                          lightsSTBMemory = nullptr;
-            VkBuffer                                lightsSTBUploadBuffer = nullptr;
+            VkBuffer                                lightsSTBUploadBuffer = nullptr;  // MAX_FRAMES_IN_FLIGHT slots, indexed by frameIndex
             VkDeviceMemory                          lightsSTBUploadMemory = nullptr;
             uint8_t*                                lightsSTBPtr = nullptr;
 
@@ -345,14 +410,14 @@ namespace Graphics
 
             // Scene Geometry
             std::vector<VkBuffer>                   sceneVBs;
-            std::vector<VkDeviceMemory>             sceneVBMemory;
+            std::vector<rtxgi::vulkan::DDGIMemoryAllocation*> sceneVBMemory;
             std::vector<VkBuffer>                   sceneVBUploadBuffers;
-            std::vector<VkDeviceMemory>             sceneVBUploadMemory;
+            std::vector<rtxgi::vulkan::DDGIMemoryAllocation*> sceneVBUploadMemory;
 
             std::vector<VkBuffer>                   sceneIBs;
-            std::vector<VkDeviceMemory>             sceneIBMemory;
+            std::vector<rtxgi::vulkan::DDGIMemoryAllocation*> sceneIBMemory;
             std::vector<VkBuffer>                   sceneIBUploadBuffers;
-            std::vector<VkDeviceMemory>             sceneIBUploadMemory;
+            std::vector<rtxgi::vulkan::DDGIMemoryAllocation*> sceneIBUploadMemory;
 
             // Scene Ray Tracing Acceleration Structures
             std::vector<AccelerationStructure>      blas;
@@ -360,16 +425,16 @@ namespace Graphics
 
             // Scene textures
             std::vector<VkImage>                    sceneTextures;
-            std::vector<VkDeviceMemory>             sceneTextureMemory;
+            std::vector<rtxgi::vulkan::DDGIMemoryAllocation*> sceneTextureMemory;
             std::vector<VkImageView>                sceneTextureViews;
             std::vector<VkBuffer>                   sceneTextureUploadBuffer;
-            std::vector<VkDeviceMemory>             sceneTextureUploadMemory;
+            std::vector<rtxgi::vulkan::DDGIMemoryAllocation*> sceneTextureUploadMemory;
 
             // Additional textures
             std::vector<VkImage>                    textures;
-            std::vector<VkDeviceMemory>             textureMemory;
+            std::vector<rtxgi::vulkan::DDGIMemoryAllocation*> textureMemory;
             std::vector<VkBuffer>                   textureUploadBuffer;
-            std::vector<VkDeviceMemory>             textureUploadMemory;
+            std::vector<rtxgi::vulkan::DDGIMemoryAllocation*> textureUploadMemory;
             std::vector<VkImageView>                textureViews;
 
             // Samplers
@@ -377,21 +442,26 @@ namespace Graphics
         };
 
         VkDeviceAddress GetBufferDeviceAddress(VkDevice device, VkBuffer buffer);
+        VkCommandBuffer GetCmdBuffer(Globals& vk);
+        bool ResetComputeCmdList(Globals& vk);
+        bool SubmitComputeCmdList(Globals& vk);
 
         void SetImageMemoryBarrier(VkCommandBuffer cmdBuffer, VkImage image, const ImageBarrierDesc info);
         void SetImageLayoutBarrier(VkCommandBuffer cmdBuffer, VkImage image, const ImageBarrierDesc info);
 
         bool CreateBuffer(Globals& vk, const BufferDesc& info, VkBuffer* buffer, VkDeviceMemory* memory);
-        bool CreateIndexBuffer(Globals& vk, const Scenes::Mesh& mesh, VkBuffer* ib, VkDeviceMemory* ibMemory, VkBuffer* ibUpload, VkDeviceMemory* ibUploadMemory);
-        bool CreateVertexBuffer(Globals& vk, const Scenes::Mesh& mesh, VkBuffer* vb, VkDeviceMemory* vbMemory, VkBuffer* vbUpload, VkDeviceMemory* vbUploadMemory);
+        bool CreateBuffer(Globals& vk, const BufferDesc& info, VkBuffer* buffer, rtxgi::vulkan::DDGIMemoryAllocation** allocation);
+        bool CreateIndexBuffer(Globals& vk, const Scenes::Mesh& mesh, VkBuffer* ib, rtxgi::vulkan::DDGIMemoryAllocation** ibAllocation, VkBuffer* ibUpload, rtxgi::vulkan::DDGIMemoryAllocation** ibUploadAllocation);
+        bool CreateVertexBuffer(Globals& vk, const Scenes::Mesh& mesh, VkBuffer* vb, rtxgi::vulkan::DDGIMemoryAllocation** vbAllocation, VkBuffer* vbUpload, rtxgi::vulkan::DDGIMemoryAllocation** vbUploadAllocation);
         bool CreateTexture(Globals& vk, const TextureDesc& info, VkImage* image, VkDeviceMemory* imageMemory, VkImageView* imageView);
+        bool CreateTexture(Globals& vk, const TextureDesc& info, VkImage* image, rtxgi::vulkan::DDGIMemoryAllocation** allocation, VkImageView* imageView);
 
         bool CreateShaderModule(VkDevice device, const Shaders::ShaderProgram& shader, VkShaderModule* module);
         bool CreateRasterShaderModules(VkDevice device, const Shaders::ShaderPipeline& shaders, ShaderModules& modules);
         bool CreateRayTracingShaderModules(VkDevice device, const Shaders::ShaderRTPipeline& shaders, RTShaderModules& modules);
 
         bool CreateRasterPipeline(
-            VkDevice device,
+            Globals& vk,
             VkPipelineLayout pipelineLayout,
             VkRenderPass renderPass,
             const Shaders::ShaderPipeline& shaders,
@@ -400,14 +470,14 @@ namespace Graphics
             VkPipeline* pipeline);
 
         bool CreateComputePipeline(
-            VkDevice device,
+            Globals& vk,
             VkPipelineLayout pipelineLayout,
             const Shaders::ShaderProgram& shader,
             const VkShaderModule& module,
             VkPipeline* pipeline);
 
         bool CreateRayTracingPipeline(
-            VkDevice device,
+            Globals& vk,
             VkPipelineLayout pipelineLayout,
             const Shaders::ShaderRTPipeline& shaders,
             const RTShaderModules& modules,
@@ -423,6 +493,7 @@ namespace Graphics
 
     #ifdef GFX_PERF_MARKERS
         void AddPerfMarker(Globals& vk, uint8_t r, uint8_t g, uint8_t b, std::string name);
+        void AddPerfMarker(VkCommandBuffer cmdBuffer, uint8_t r, uint8_t g, uint8_t b, std::string name);
     #endif
 
         namespace SamplerIndices
@@ -456,6 +527,18 @@ namespace Graphics
             const int SRV_TEX2D = SRV_TLAS + 1;                                     // 11: Tex2D SRVs (resource array)
             const int SRV_TEX2DARRAY = SRV_TEX2D + 1;                               // 12: Tex2DArray SRVs (resource array)
             const int SRV_BYTEADDRESS = SRV_TEX2DARRAY + 1;                         // 13: ByteAddressBuffer SRVs (resource array)
+
+            // Radiance Cache UAVs
+            const int UAV_HIT_CACHING = SRV_BYTEADDRESS + 1;                        // 14: Hit caching structured buffer
+            const int UAV_RADIANCE_CACHING = UAV_HIT_CACHING + 1;                   // 15: Resolved radiance structured buffer
+            const int UAV_RADIANCE_CACHING_VISUALIZATION = UAV_RADIANCE_CACHING + 1;// 16: Radiance cache visualization structured buffer
+            const int UAV_RADIANCE_CACHE_ACCUMULATION = UAV_RADIANCE_CACHING_VISUALIZATION + 1; // 17: Radiance cache accumulation ByteAddressBuffer
+            const int UAV_RADIANCE_CACHE_METADATA = UAV_RADIANCE_CACHE_ACCUMULATION + 1;        // 18: Radiance cache metadata ByteAddressBuffer
+            const int UAV_PROBE_RAY_HIT_MAP = UAV_RADIANCE_CACHE_METADATA + 1;      // 19: Probe ray hit map structured buffer
+            const int UAV_RADIANCE_CACHE_WORK_LIST = UAV_PROBE_RAY_HIT_MAP + 1;     // 20: Radiance cache work list structured buffer
+            const int UAV_RADIANCE_CACHE_WORK_LIST_ARGS = UAV_RADIANCE_CACHE_WORK_LIST + 1;     // 21: Radiance cache work list dispatch arguments ByteAddressBuffer
+            const int UAV_RADIANCE_CACHE_RESERVOIRS = UAV_RADIANCE_CACHE_WORK_LIST_ARGS + 1;    // 22: Radiance cache reservoirs ByteAddressBuffer
+            const int UAV_DDGI_PROBE_SCHEDULES = UAV_RADIANCE_CACHE_RESERVOIRS + 1; // 23: DDGIVolume probe schedules (resource array, unused: Vulkan volumes don't schedule probes)
         };
 
         namespace RWTex2DIndices
@@ -23,6 +23,22 @@ namespace Graphics
                 Shaders::ShaderPipeline shaders;
                 ID3D12PipelineState*    pso = nullptr;
 
+                Shaders::ShaderPipeline upscaleShaders;     // Dynamic resolution: upscale the render area to the back buffer
+                ID3D12PipelineState*    upscalePSO = nullptr;
+                bool                    upscale = false;
+
+                // Variable rate shading (tier 2 shading rate image, see CompositeShadingRateCS.hlsl)
+                ID3D12Resource*         shadingRateImage = nullptr;
+                Shaders::ShaderProgram  shadingRateCS;
+                ID3D12PipelineState*    shadingRatePSO = nullptr;
+                bool                    vrs = false;
+
+                // Automatic exposure (luminance histogram + exposure, see CompositeExposureCS.hlsl)
+                ID3D12Resource*         exposure = nullptr;
+                Shaders::ShaderProgram  exposureCS;
+                ID3D12PipelineState*    exposurePSO = nullptr;
+                bool                    autoExposure = false;
+
                 Instrumentation::Stat*  cpuStat = nullptr;
                 Instrumentation::Stat*  gpuStat = nullptr;
             };
@@ -26,6 +26,10 @@ namespace Graphics
                 VkDescriptorSet         descriptorSet = nullptr;
                 VkPipeline              pipeline = nullptr;
 
+                Shaders::ShaderPipeline upscaleShaders;     // Dynamic resolution: upscale the render area to the back buffer
+                ShaderModules           upscaleModules;
+                VkPipeline              upscalePipeline = nullptr;
+
                 Instrumentation::Stat*  cpuStat = nullptr;
                 Instrumentation::Stat*  gpuStat = nullptr;
             };
@@ -13,6 +13,8 @@
 #include "Graphics.h"
 #include "DDGIDefines.h"
 
+#include <functional>
+
 #ifdef GFX_PERF_INSTRUMENTATION
 #include "Instrumentation.h"
 #endif
@@ -27,15 +29,88 @@ namespace Graphics
 {
     namespace DDGI
     {
+        enum class EReloadStatus
+        {
+            NONE = 0,   // No reload is pending
+            PENDING,    // The shaders are still compiling
+            SUCCEEDED,  // The new shaders and PSOs were swapped in
+            FAILED,     // Compilation failed, the previous shaders and PSOs are still in use
+            SWAP_FAILED // The new shaders and PSOs were swapped in, but recreating the volumes failed
+        };
+
+        // The volumes' GPU memory plan (see PlanMemoryBudget)
+        struct MemoryBudget
+        {
+            std::vector<Configs::DDGIVolume> requested; // The volumes as configured, before they are fit to the budget
+            uint64_t budget = 0;                        // Bytes the current plan fits the volumes to
+            uint64_t used = 0;                          // Bytes of the planned volumes' textures
+        };
+
+        // The settings the GI cost controller turns (see ControlCost)
+        enum ECostKnob
+        {
+            COST_KNOB_PROBE_UPDATES = 0,        // Probes updated per frame: probe scheduling full rate distance and relocation/classification time slicing (volume constants)
+            COST_KNOB_PROBE_RAYS,               // Rays per probe (reallocates the volumes' ray data)
+            COST_KNOB_RADIANCE_CACHE_BUDGET,    // Radiance cache rays per frame, D3D12 (reloads the DDGI shaders)
+            COST_KNOB_RADIANCE_CACHE_SAMPLES,   // Radiance cache samples per cell (reloads the DDGI shaders)
+            COST_KNOB_INDIRECT_SCALE,           // Indirect lighting resolution divisor, D3D12 (resizes the indirect lighting output)
+            COST_KNOB_COUNT
+        };
+
+        // A step the controller took, undone last in first out
+        struct CostStep
+        {
+            ECostKnob knob = COST_KNOB_PROBE_UPDATES;
+            double costBefore = 0;                      // DDGI GPU time (ms) before the step
+            double saved = 0;                           // DDGI GPU time (ms) the step saved, once measured
+        };
+
+        // Closed loop control of the DDGI GPU time toward ddgi.costBudget (see ControlCost)
+        struct CostController
+        {
+            bool active = false;
+            uint32_t levels[COST_KNOB_COUNT] = {};      // Steps taken of each knob
+            std::vector<CostStep> steps;
+            double measured = 0;                        // DDGI GPU time average (ms)
+            uint32_t holdFrames = 0;                    // Frames left for the measurement to settle after a step
+            uint32_t overFrames = 0;                    // Consecutive frames over the budget's upper band
+            uint32_t underFrames = 0;                   // Consecutive frames a restored step would fit under the budget's lower band
+
+            // The settings before the controller started
+            std::vector<uint32_t> baseRays;
+            std::vector<int> baseFullRateDistance;
+            std::vector<int> baseTimeSliceStrideLog2;
+            float baseRadianceCacheSamples = 0.f;
+            uint32_t baseRadianceCacheRayBudget = 0;
+            uint32_t baseIndirectScale = 1;
+        };
+
         bool Initialize(Globals& globals, GlobalResources& gfxResources, Resources& resources, const Configs::Config& config, Instrumentation::Performance& perf, std::ofstream& log);
         bool Reload(Globals& globals, GlobalResources& gfxResources, Resources& resources, const Configs::Config& config, std::ofstream& log);
+        bool ReloadAsync(Globals& globals, GlobalResources& gfxResources, Resources& resources, const Configs::Config& config, std::ofstream& log);
+        EReloadStatus FinishReload(Globals& globals, GlobalResources& gfxResources, Resources& resources, const Configs::Config& config, std::ofstream& log);
         bool Resize(Globals& globals, GlobalResources& gfxResources, Resources& resources, std::ofstream& log);
         void Update(Globals& globals, GlobalResources& gfxResources, Resources& resources, Configs::Config& config, Scenes::Scene& scene);
         void Execute(Globals& globals, GlobalResources& gfxResources, Resources& resources);
         void Cleanup(Globals& globals, Resources& resources);
 
         void AddCommonShaderDefines(Shaders::ShaderProgram& shader, const DDGIVolumeDesc& volumeDesc, bool spirv);
-        bool CompileDDGIVolumeShaders(Globals& vk, const DDGIVolumeDesc& volumeDesc, std::vector<Shaders::ShaderProgram>& volumeShaders, bool spirv, std::ofstream& log);
+        void AddSpecializationDefines(Shaders::ShaderProgram& shader, const std::vector<DDGIVolumeDesc>& volumeDescs);
+        bool CompileDDGIVolumeShaders(Globals& vk, const DDGIVolumeDesc& volumeDesc, std::vector<Shaders::ShaderProgram>& volumeShaders, bool spirv, std::ofstream& log, Shaders::ShaderPermutations* permutations = nullptr);
+
+        void SetDDGIVolumeConstants(rtxgi::DDGIVolumeBase* volume, const Configs::DDGIVolume& volumeConfig);
+        bool ApplyVolumeChanges(Globals& globals, GlobalResources& gfxResources, Resources& resources, const Configs::Config& config, const std::vector<Configs::EDDGIVolumeChange>& changes, std::ofstream& log);
+        bool PlanMemoryBudget(Globals& globals, MemoryBudget& memoryBudget, Configs::Config& config, std::vector<Configs::EDDGIVolumeChange>& changes, bool force, std::ofstream& log);
+        bool ControlCost(Globals& globals, CostController& controller, const Resources& resources, Configs::Config& config, std::vector<Configs::EDDGIVolumeChange>& changes, bool& resizeIndirect, std::ofstream& log);
+        bool PlaceProbes(Configs::Config& config, const Scenes::Scene& scene, std::ofstream& log);
+        bool QueueIrradianceQueries(Resources& resources, const IrradianceQuery* queries, uint32_t count, std::function<void(const float4* results, uint32_t count)> callback);
+        bool QueueProbeDeltaExport(Resources& resources, uint32_t volumeIndex, float threshold, std::function<void(const uint8_t* packet, uint32_t size)> callback);
+        bool QueueProbeDeltaImport(Resources& resources, uint32_t volumeIndex, const uint8_t* packet, uint32_t size);
+
+        bool LoadVolumeCaches(Globals& globals, GlobalResources& gfxResources, Resources& resources, const Configs::Config& config, const Scenes::Scene& scene, std::ofstream& log);
+        bool StoreVolumeCaches(Globals& globals, GlobalResources& gfxResources, Resources& resources, const Configs::Config& config, const Scenes::Scene& scene, std::ofstream& log);
+        bool LoadRadianceCache(Globals& globals, GlobalResources& gfxResources, Resources& resources, const Configs::Config& config, const Scenes::Scene& scene, std::ofstream& log);
+        bool StoreRadianceCache(Globals& globals, GlobalResources& gfxResources, Resources& resources, const Configs::Config& config, const Scenes::Scene& scene, std::ofstream& log);
 
         bool WriteVolumesToDisk(Globals& globals, GlobalResources& gfxResources, Resources& resources, std::string directory);
         bool WriteIndirectOutputToDisk(Globals& globals, GlobalResources& gfxResources, Resources& resources, std::string directory);
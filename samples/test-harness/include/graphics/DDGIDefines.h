@@ -22,6 +22,14 @@
 #error RTXGI_DDGI_BLEND_SHARED_MEMORY is not defined!
 #endif
 
+#ifndef RTXGI_DDGI_BLEND_BORDER_SHARED_MEMORY
+#error RTXGI_DDGI_BLEND_BORDER_SHARED_MEMORY is not defined!
+#endif
+
+#ifndef RTXGI_DDGI_BLEND_SHARED_MEMORY_TILED
+#error RTXGI_DDGI_BLEND_SHARED_MEMORY_TILED is not defined!
+#endif
+
 // Debug visualization modes
 #ifndef RTXGI_DDGI_DEBUG_OCTAHEDRAL_INDEXING
 #error RTXGI_DDGI_DEBUG_OCTAHEDRAL_INDEXING is not defined!
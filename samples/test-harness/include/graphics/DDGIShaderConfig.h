@@ -31,12 +31,17 @@
 // Bindless Resource implementation type
 // 0: RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
 // 1: RTXGI_BINDLESS_TYPE_DESCRIPTOR_HEAP
+// SPIR-V always uses resource arrays
+#if __spirv__
 #define RTXGI_BINDLESS_TYPE 0
+#else
+#define RTXGI_BINDLESS_TYPE 1
+#endif
 
 // Should DDGI use bindless resources?
 // 0: no
 // 1: yes
-#define RTXGI_DDGI_BINDLESS_RESOURCES 0
+#define RTXGI_DDGI_BINDLESS_RESOURCES 1
 
 //-------------------------------------------------------------------------------------------------
 // Optional Defines (including in this file since we compile with warnings as errors)
@@ -95,6 +100,8 @@
         #define VOLUME_CONSTS_SPACE space0
         #define RWTEX2DARRAY_REGISTER u6
         #define RWTEX2DARRAY_SPACE space1
+        #define PROBE_SCHEDULE_REGISTER u5
+        #define PROBE_SCHEDULE_SPACE space12
     #else
         // Using the RTXGI SDK's root signature (not bindless)
         #define VOLUME_CONSTS_REGISTER t0
@@ -112,6 +119,8 @@
         #define PROBE_VARIABILITY_REGISTER u4
         #define PROBE_VARIABILITY_AVERAGE_REGISTER u5
         #define PROBE_VARIABILITY_SPACE space1
+        #define PROBE_SCHEDULE_REGISTER u6
+        #define PROBE_SCHEDULE_SPACE space1
     #endif
 #endif
 #endif
@@ -38,6 +38,9 @@ namespace Graphics
                 VIS_FLAG_SHOW_TEXTURES = 0x4
             };
 
+            // Icosphere LODs of the ray traced probe spheres (20, 80, 320, and 1280 triangles), selected by the probe's size on screen
+            const uint32_t PROBE_SPHERE_LODS = 4;
+
             bool Initialize(Globals& globals, GlobalResources& gfxResources, DDGI::Resources& ddgiResources, Resources& resources, Instrumentation::Performance& perf, Configs::Config& config, std::ofstream& log);
             bool Reload(Globals& globals, GlobalResources& gfxResources, DDGI::Resources& ddgiResources, Resources& resources, Configs::Config& config, std::ofstream& log);
             bool Resize(Globals& globals, GlobalResources& gfxResources, Resources& resources, std::ofstream& log);
@@ -21,6 +21,14 @@ namespace Graphics
             namespace Visualizations
             {
 
+                struct ProbeDraw
+                {
+                    UINT                                        volumeIndex = 0;
+                    UINT                                        numProbes = 0;
+                    UINT                                        probeVisType = 0;
+                    float                                       probeRadius = 1.f;
+                };
+
                 struct Resources
                 {
                     // Flags
@@ -30,7 +38,9 @@ namespace Graphics
                     Shaders::ShaderRTPipeline                   rtShaders;
                     Shaders::ShaderRTPipeline                   rtShaders2;
                     Shaders::ShaderProgram                      textureVisCS;
+                    Shaders::ShaderProgram                      textureVisCompositeCS;
                     Shaders::ShaderProgram                      updateTlasCS;
+                    Shaders::ShaderPipeline                     rasterShaders;
 
                     // Ray Tracing
                     ID3D12Resource*                             shaderTable = nullptr;
@@ -41,7 +51,9 @@ namespace Graphics
                     ID3D12StateObjectProperties*                rtpsoInfo = nullptr;
                     ID3D12StateObjectProperties*                rtpsoInfo2 = nullptr;
                     ID3D12PipelineState*                        texturesVisPSO = nullptr;
+                    ID3D12PipelineState*                        texturesVisCompositePSO = nullptr;
                     ID3D12PipelineState*                        updateTlasPSO = nullptr;
+                    ID3D12PipelineState*                        rasterPSO = nullptr;
 
                     UINT                                        shaderTableSize = 0;
                     UINT                                        shaderTableRecordSize = 0;
@@ -55,20 +67,36 @@ namespace Graphics
 
                     // Probe Sphere Resources
                     ID3D12Resource*                             probeVB = nullptr;
-                    ID3D12Resource*                             probeVBUpload = nullptr;
                     D3D12_VERTEX_BUFFER_VIEW                    probeVBView;
 
                     ID3D12Resource*                             probeIB = nullptr;
-                    ID3D12Resource*                             probeIBUpload = nullptr;
                     D3D12_INDEX_BUFFER_VIEW                     probeIBView;
 
-                    Scenes::Mesh                                probe;
-                    AccelerationStructure                       blas;
+                    Scenes::Mesh                                probe;                  // Icosphere LODs, a mesh primitive per LOD
+                    AccelerationStructure                       blas;                   // BLAS of each LOD, blasLodStride bytes apart (see ProbesUpdateCS.hlsl)
+                    AccelerationStructure                       proceduralBlas;         // BLAS of the probe sphere's AABB (see ProbesIS.hlsl)
+                    ID3D12Resource*                             probeAABB = nullptr;
+                    UINT                                        blasLodStride = 0;
+                    bool                                        proceduralProbes = false;
                     AccelerationStructure                       tlas;
 
                     UINT                                        maxProbeInstances = 0;
                     std::vector<D3D12_RAYTRACING_INSTANCE_DESC> probeInstances;
 
+                    // Rasterized Probes (see ProbesRaster.hlsl)
+                    bool                                        rasterizeProbes = false;
+                    std::vector<ProbeDraw>                      probeDraws;
+
+                    // Texture Visualization Cache (see VolumeTexturesCS.hlsl)
+                    ID3D12Resource*                             textureVisCache = nullptr;
+                    DDGIVisConsts                               textureVisConsts = {};  // Texture visualization constants of the last redraw
+                    UINT                                        textureVisVolume = UINT_MAX;
+                    UINT                                        textureVisWidth = 0;                   // Render size of the last redraw
+                    UINT                                        textureVisHeight = 0;
+                    UINT                                        textureVisRefreshFrames = 0;
+                    UINT                                        textureVisFramesSinceDraw = 0;
+                    bool                                        textureVisDirty = true;
+
                     // DDGI Resources
                     UINT                                        selectedVolume = 0;
                     std::vector<rtxgi::DDGIVolumeBase*>*        volumes;
@@ -66,17 +66,24 @@ namespace Graphics
 
                     // Probe Sphere Resources
                     VkBuffer                                        probeVB = nullptr;
-                    VkDeviceMemory                                  probeVBMemory = nullptr;
+                    rtxgi::vulkan::DDGIMemoryAllocation*            probeVBMemory = nullptr;
                     VkBuffer                                        probeVBUpload = nullptr;
-                    VkDeviceMemory                                  probeVBUploadMemory = nullptr;
+                    rtxgi::vulkan::DDGIMemoryAllocation*            probeVBUploadMemory = nullptr;
 
                     VkBuffer                                        probeIB = nullptr;
-                    VkDeviceMemory                                  probeIBMemory = nullptr;
+                    rtxgi::vulkan::DDGIMemoryAllocation*            probeIBMemory = nullptr;
                     VkBuffer                                        probeIBUpload = nullptr;
-                    VkDeviceMemory                                  probeIBUploadMemory = nullptr;
-
-                    Scenes::Mesh                                    probe;
-                    AccelerationStructure                           blas;
+                    rtxgi::vulkan::DDGIMemoryAllocation*            probeIBUploadMemory = nullptr;
+
+                    Scenes::Mesh                                    probe;                  // Icosphere LODs, a mesh primitive per LOD
+                    AccelerationStructure                           blas;                   // Buffer of the LOD BLAS, blasLodStride bytes apart (see ProbesUpdateCS.hlsl)
+                    std::vector<VkAccelerationStructureKHR>         blasLods;               // BLAS of each LOD, in the blas buffer
+                    AccelerationStructure                           proceduralBlas;         // BLAS of the probe sphere's AABB (see ProbesIS.hlsl)
+                    VkBuffer                                        probeAABB = nullptr;
+                    VkDeviceMemory                                  probeAABBMemory = nullptr;
+                    uint32_t                                        blasLodStride = 0;
+                    uint32_t                                        numBlasLods = 0;        // 1 when the LOD BLAS addresses aren't blasLodStride apart, the finest LOD is used
+                    bool                                            proceduralProbes = false;
                     AccelerationStructure                           tlas;
 
                     uint32_t                                        maxProbeInstances = 0;
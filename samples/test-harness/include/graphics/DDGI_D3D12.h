@@ -11,14 +11,55 @@
 #pragma once
 
 #include "Graphics.h"
+#include <rtxgi/ddgi/DDGIClipmap.h>
 #include <rtxgi/ddgi/gfx/DDGIVolume_D3D12.h>
 
+#include <atomic>
+#include <functional>
+#include <thread>
+
 namespace Graphics
 {
     namespace D3D12
     {
         namespace DDGI
         {
+            struct AsyncReload;
+
+            // Receives the irradiance (xyz) and summed volume blend weight (w) of each query of a batch, see QueueIrradianceQueries()
+            using IrradianceQueryCallback = std::function<void(const float4* results, UINT count)>;
+
+            struct IrradianceQueryBatch
+            {
+                UINT                         first = 0;                                    // Index of the batch's first query in the frame's queries
+                UINT                         count = 0;
+                IrradianceQueryCallback      callback;
+            };
+
+            // Receives a probe delta packet (a ProbeDeltaHeader, then its tiles), see QueueProbeDeltaExport()
+            using ProbeDeltaCallback = std::function<void(const uint8_t* packet, UINT size)>;
+
+            struct ProbeDeltaExport
+            {
+                UINT                         volumeIndex = 0;
+                float                        threshold = 0.f;
+                ProbeDeltaCallback           callback;
+            };
+
+            struct ProbeDeltaImport
+            {
+                UINT                         volumeIndex = 0;
+                std::vector<uint8_t>         packet;
+            };
+
+            // The tiles a volume last exported, in the probe deltas buffer
+            struct ProbeDeltaVolume
+            {
+                UINT                         probeCount = 0;
+                UINT                         tileStride = 0;
+                UINT                         referenceOffset = 0;
+            };
+
             struct Resources
             {
                 // Textures
@@ -49,10 +90,29 @@ namespace Graphics
                 D3D12_GPU_VIRTUAL_ADDRESS    shaderTableMissTableStartAddress = 0;
                 D3D12_GPU_VIRTUAL_ADDRESS    shaderTableHitGroupTableStartAddress = 0;
 
+                // Radiance Cache (Ray Tracing Pipeline - Ray Generation Shader), the records follow the DDGI records in the shader table
+                Shaders::ShaderRTPipeline    radianceCacheRTShaders;
+                ID3D12StateObject*           radianceCacheRTPSO = nullptr;
+                ID3D12StateObjectProperties* radianceCacheRTPSOInfo = nullptr;
+                D3D12_GPU_VIRTUAL_ADDRESS    radianceCacheShaderTableRGSStartAddress = 0;
+                D3D12_GPU_VIRTUAL_ADDRESS    radianceCacheShaderTableMissTableStartAddress = 0;
+                D3D12_GPU_VIRTUAL_ADDRESS    radianceCacheShaderTableHitGroupTableStartAddress = 0;
+                UINT                         radianceCacheShaderTableHitGroupTableSize = 0;
+                bool                         radianceCacheInline = true;                  // Shade the radiance cache with RadianceCacheCS (config ddgi.useInlineRayTracing), RadianceCacheRGS otherwise
+
                 // DDGI
                 std::vector<rtxgi::DDGIVolumeDesc> volumeDescs;
+                Shaders::ShaderPermutations  volumeShaderPermutations;                     // Shared by the volumes created together, see CompileDDGIVolumeShaders()
                 std::vector<rtxgi::DDGIVolumeBase*> volumes;
                 std::vector<rtxgi::d3d12::DDGIVolume*> selectedVolumes;
+                std::vector<rtxgi::d3d12::DDGIVolume*> updateVolumes;                      // Volumes whose probes are updated this frame, see Execute()
+                std::vector<rtxgi::DDGIVolumeDescGPUPacked> selectedVolumeDescs;           // Packed constants of the selected volumes, see UpdateDDGIVolumes()
+                Jobs::Pool                   volumeWorkers;                                // Update and pack many volumes in parallel, started on first use
+                std::vector<std::function<void()>> volumeUpdateJobs;
+                std::vector<UINT>            volumeBlendOrder;                             // Volume indices in the order sampling shaders blend them, see SortDDGIVolumeBlendOrder()
+                std::vector<D3D12_RESOURCE_BARRIER> stageBarriers;                         // Barriers batched across the volumes per SDK stage, see Execute()
+                rtxgi::DDGIClipmap           clipmap;                                      // The volumes as clipmap levels, see Globals::DDGIClipmap
+                rtxgi::d3d12::DDGIVolumeResourcePool* volumePool = nullptr;                // Heaps of the (managed) volume probe textures
 
                 ID3D12DescriptorHeap*        rtvDescriptorHeap = nullptr;
 
@@ -64,22 +124,106 @@ namespace Graphics
                 ID3D12Resource*              volumeConstantsSTBUpload = nullptr;
                 UINT                         volumeConstantsSTBSizeInBytes = 0;
 
+                ID3D12Resource*              volumeBoundsSTB = nullptr;                    // The volumes' DDGIVolumeBoundsGPU, read by the sampling shaders before unpacking a volume's constants
+                ID3D12Resource*              volumeBoundsSTBUpload = nullptr;
+                UINT                         volumeBoundsSTBSizeInBytes = 0;
+
                 // Radiance Cache (Inline Ray Tracing - Compute Shader)
                 Shaders::ShaderProgram       radianceCacheCS;
                 Shaders::ShaderProgram       probeRayResolveCS;
+                Shaders::ShaderProgram       radianceCacheWorkListArgsCS;
+                Shaders::ShaderProgram       radianceCacheSortHistogramCS;
+                Shaders::ShaderProgram       radianceCacheSortPrefixSumCS;
+                Shaders::ShaderProgram       radianceCacheSortScatterCS;
+                Shaders::ShaderProgram       radianceCacheBudgetHistogramCS;
+                Shaders::ShaderProgram       radianceCacheBudgetThresholdCS;
+                Shaders::ShaderProgram       radianceCacheStatsCS;
+                Shaders::ShaderProgram       lightGridBoundsCS;
+                Shaders::ShaderProgram       lightGridBuildCS;
+                Shaders::ShaderProgram       radianceCacheEvictCS;
+                Shaders::ShaderProgram       radianceCacheRehashCS;
+                Shaders::ShaderProgram       radianceCacheTrimCS;
                 ID3D12PipelineState*         radianceCachePSO = nullptr;
                 ID3D12PipelineState*         probeRayResolvePSO = nullptr;
+                ID3D12PipelineState*         radianceCacheWorkListArgsPSO = nullptr;
+                ID3D12PipelineState*         radianceCacheSortHistogramPSO = nullptr;
+                ID3D12PipelineState*         radianceCacheSortPrefixSumPSO = nullptr;
+                ID3D12PipelineState*         radianceCacheSortScatterPSO = nullptr;
+                ID3D12PipelineState*         radianceCacheBudgetHistogramPSO = nullptr;
+                ID3D12PipelineState*         radianceCacheBudgetThresholdPSO = nullptr;
+                ID3D12PipelineState*         radianceCacheStatsPSO = nullptr;
+                ID3D12PipelineState*         lightGridBoundsPSO = nullptr;
+                ID3D12PipelineState*         lightGridBuildPSO = nullptr;
+                ID3D12PipelineState*         radianceCacheEvictPSO = nullptr;
+                ID3D12PipelineState*         radianceCacheRehashPSO = nullptr;
+                ID3D12PipelineState*         radianceCacheTrimPSO = nullptr;
+                ID3D12CommandSignature*      radianceCacheCommandSignature = nullptr;      // Indirect dispatch of RadianceCacheCS over the work list, and of IndirectCS over the GBuffer tiles
                 ID3D12Resource*              HitCachingResource = nullptr;
                 ID3D12Resource*              RadianceCachingResource = nullptr;
                 ID3D12Resource*              RadianceCachingVisualizationResource = nullptr;
                 ID3D12Resource*              RadianceCacheAccumulationResource = nullptr;  // SHaRC-style atomic accumulation
-                ID3D12Resource*              RadianceCacheMetadataResource = nullptr;      // SHaRC-style: checksum + age for collision detection
+                ID3D12Resource*              RadianceCacheMetadataResource = nullptr;      // Checksum, age, shaded frame, and volatility per slot
+                ID3D12Resource*              RadianceCacheReservoirResource = nullptr;     // Indirect sample reservoir per slot (see RadianceCacheReservoir.hlsl)
                 ID3D12Resource*              ProbeRayHitMapResource = nullptr;             // Maps ProbeRayIndex -> HashID for resolve pass
+                ID3D12Resource*              RadianceCacheWorkListResource = nullptr;      // Cache slots touched this frame
+                ID3D12Resource*              RadianceCacheWorkListArgsResource = nullptr;  // Work list dispatch arguments + append counter
+                ID3D12Resource*              RadianceCacheSortedWorkListResource = nullptr; // Work list ordered by (InstanceIndex, GeometryIndex)
+                ID3D12Resource*              RadianceCacheSortBinsResource = nullptr;      // Counting sort bin counts / offsets
+                ID3D12Resource*              RadianceCacheBudgetResource = nullptr;        // Update budget priority histogram + threshold
+                ID3D12Resource*              LightGridResource = nullptr;                  // World-space light grid bounds + per cell light lists (see LightGrid.hlsl)
+                ID3D12Resource*              ProbeTraceBatchResource = nullptr;            // Batched probe trace volume table (see ProbeTraceBatch.hlsl)
+                ID3D12Resource*              ProbeTraceBatchUploadResource = nullptr;      // Double buffered
+                UINT                         ProbeTraceBatchSizeInBytes = 0;
+                UINT                         ProbeTraceBatchRayGroups = 0;                 // Ray groups of the batch's volume with the most rays per probe
+                UINT                         ProbeTraceBatchProbes = 0;                    // Probes of all batched volumes
                 UINT                         CascadeCellNum;
                 UINT                         TotalProbeRays = 0;                           // NumProbes * RaysPerProbe
 
-                // Variability Tracking
-                std::vector<uint32_t>        numVolumeVariabilitySamples;
+                // GPU Counters (see GPUCounters.hlsl, only with Globals::GPUCounters)
+                ID3D12Resource*              gpuCounters = nullptr;
+                ID3D12Resource*              gpuCountersClear = nullptr;                   // Zeros, copied to the counters and cache stats after every readback
+                ID3D12Resource*              gpuCountersReadback[MAX_FRAMES_IN_FLIGHT] = {};  // Counters, pipeline statistics, then the cache stats
+                UINT                         gpuCountersReadbackFrame[MAX_FRAMES_IN_FLIGHT] = {};
+                UINT                         gpuCountersSize = 0;
+                UINT                         pipelineStatsOffset = 0;                      // Offset of the pipeline statistics in the readback buffers
+                ID3D12Resource*              radianceCacheStats = nullptr;                 // A uint4 per cascade, reduced from the cache metadata (see RadianceCacheStatsCS.hlsl)
+                UINT                         radianceCacheStatsSize = 0;
+                UINT                         radianceCacheStatsOffset = 0;                 // Offset of the cache stats in the readback buffers
+                ID3D12QueryHeap*             pipelineStatsHeap = nullptr;                  // One query per Instrumentation::ECounterPass
+                Instrumentation::Counters*   counters = nullptr;                           // Instrumentation::Performance::counters, updated by the readback
+
+                // Irradiance Queries (DDGIVolume irradiance at points queried by the CPU, see QueueIrradianceQueries())
+                Shaders::ShaderProgram       irradianceQueryCS;
+                ID3D12PipelineState*         irradianceQueryPSO = nullptr;
+                ID3D12Resource*              irradianceQueries = nullptr;                  // The query count, then the frame's IrradianceQuery entries
+                ID3D12Resource*              irradianceQueriesUpload[MAX_FRAMES_IN_FLIGHT] = {};
+                ID3D12Resource*              irradianceQueriesReadback[MAX_FRAMES_IN_FLIGHT] = {};
+                std::vector<IrradianceQuery> irradianceQueriesPending;                     // Queued since the last Execute()
+                std::vector<IrradianceQueryBatch> irradianceQueryBatchesPending;
+                std::vector<IrradianceQueryBatch> irradianceQueryBatches[MAX_FRAMES_IN_FLIGHT]; // In flight, called back when the frame's readback buffer is reused
+                std::vector<float4>          irradianceQueryResults;                       // The results of a readback, passed to the callbacks
+
+                // Probe Deltas (the changed probe tiles of a volume, exported to and imported from packets, see QueueProbeDeltaExport())
+                Shaders::ShaderProgram       probeDeltaExportCS;
+                Shaders::ShaderProgram       probeDeltaImportCS;
+                ID3D12PipelineState*         probeDeltaExportPSO = nullptr;
+                ID3D12PipelineState*         probeDeltaImportPSO = nullptr;
+                ID3D12Resource*              probeDeltas = nullptr;                        // The header, a packet, then the tiles each volume last exported
+                ID3D12Resource*              probeDeltasUpload[MAX_FRAMES_IN_FLIGHT] = {};
+                ID3D12Resource*              probeDeltasReadback[MAX_FRAMES_IN_FLIGHT] = {};
+                UINT                         probeDeltaPacketSize = 0;                     // The header and the largest packet
+                std::vector<ProbeDeltaVolume> probeDeltaVolumes;
+                std::vector<ProbeDeltaExport> probeDeltaExportsPending;                    // Queued, one is exported per frame
+                std::vector<ProbeDeltaImport> probeDeltaImportsPending;                    // Queued, one is imported per frame
+                ProbeDeltaExport             probeDeltaExports[MAX_FRAMES_IN_FLIGHT];      // In flight, called back when the frame's readback buffer is reused
+                std::vector<uint8_t>         probeDeltaPacket;                             // The packet of a readback, passed to the callback
+
+                // Baked Irradiance (BC6H copies of the irradiance of converged, frozen volumes, see BakeDDGIVolumeIrradiance())
+                std::vector<ID3D12Resource*> bakedIrradiance;
+
+                // Update Events (the lights and sky last forwarded to the volumes, see NotifyDDGIVolumeLightChanges())
+                std::vector<Graphics::Light> eventLights;
+                float3                       eventSkyRadiance = { 0.f, 0.f, 0.f };
 
                 // Performance Stats
                 Instrumentation::Stat*       cpuStat = nullptr;
@@ -87,13 +231,38 @@ namespace Graphics
 
                 Instrumentation::Stat*       classifyStat = nullptr;
                 Instrumentation::Stat*       rtStat = nullptr;
+                Instrumentation::Stat*       radianceCacheCompactStat = nullptr;
+                Instrumentation::Stat*       radianceCacheStat = nullptr;
+                Instrumentation::Stat*       radianceCacheClearStat = nullptr;
+                Instrumentation::Stat*       radianceCacheLightGridStat = nullptr;
+                Instrumentation::Stat*       radianceCacheWorkListStat = nullptr;
+                Instrumentation::Stat*       radianceCacheBudgetStat = nullptr;
+                Instrumentation::Stat*       radianceCacheSortStat = nullptr;
+                Instrumentation::Stat*       radianceCacheShadeStat = nullptr;
+                Instrumentation::Stat*       resolveStat = nullptr;
                 Instrumentation::Stat*       blendStat = nullptr;
+                std::vector<Instrumentation::Stat*> volumeBlendStats;  // Indexed by volume index
                 Instrumentation::Stat*       relocateStat = nullptr;
                 Instrumentation::Stat*       lightingStat = nullptr;
                 Instrumentation::Stat*       variabilityStat = nullptr;
 
+                AsyncReload*                 reload = nullptr;                              // The pending background reload, see ReloadAsync()
+
                 bool                         enabled = false;
             };
+
+            // Shaders and PSOs recompiled on a worker thread while the current ones keep rendering, swapped in by FinishReload()
+            struct AsyncReload
+            {
+                std::thread                  thread;
+                std::atomic<bool>            done{ false };
+                bool                         succeeded = false;
+
+                Resources                    staging;                                      // Receives the recompiled shaders and PSOs
+                std::vector<Configs::DDGIVolume> volumes;                                  // The volume configs at the time of the request
+                std::vector<std::vector<Shaders::ShaderProgram>> volumeShaders;            // Indexed by volume index
+                std::ofstream                log;                                          // The worker's log, appended to the main log when swapped
+            };
         }
     }
 
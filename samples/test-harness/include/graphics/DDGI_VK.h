@@ -30,11 +30,23 @@ namespace Graphics
                 Shaders::ShaderRTPipeline       rtShaders;
                 Shaders::ShaderProgram          indirectCS;
                 Shaders::ShaderProgram          probeTraceCS;
+                Shaders::ShaderProgram          radianceCacheCS;
+                Shaders::ShaderProgram          radianceCacheWorkListArgsCS;
+                Shaders::ShaderProgram          probeRayResolveCS;
+                Shaders::ShaderProgram          radianceCacheEvictCS;
+                Shaders::ShaderProgram          radianceCacheRehashCS;
+                Shaders::ShaderProgram          radianceCacheTrimCS;
 
                 // Shader Modules
                 RTShaderModules                 rtShaderModules;
                 VkShaderModule                  indirectShaderModule = nullptr;
                 VkShaderModule                  probeTraceCSModule = nullptr;
+                VkShaderModule                  radianceCacheModule = nullptr;
+                VkShaderModule                  radianceCacheWorkListArgsModule = nullptr;
+                VkShaderModule                  probeRayResolveModule = nullptr;
+                VkShaderModule                  radianceCacheEvictModule = nullptr;
+                VkShaderModule                  radianceCacheRehashModule = nullptr;
+                VkShaderModule                  radianceCacheTrimModule = nullptr;
 
                 // Ray Tracing
                 VkBuffer                        shaderTable = nullptr;
@@ -46,6 +58,12 @@ namespace Graphics
                 VkPipeline                      rtPipeline = nullptr;
                 VkPipeline                      indirectPipeline = nullptr;
                 VkPipeline                      probeTracePipeline = nullptr;
+                VkPipeline                      radianceCachePipeline = nullptr;
+                VkPipeline                      radianceCacheWorkListArgsPipeline = nullptr;
+                VkPipeline                      probeRayResolvePipeline = nullptr;
+                VkPipeline                      radianceCacheEvictPipeline = nullptr;
+                VkPipeline                      radianceCacheRehashPipeline = nullptr;
+                VkPipeline                      radianceCacheTrimPipeline = nullptr;
                 bool                            useInlineRayTracing = false;
 
                 uint32_t                        shaderTableSize = 0;
@@ -57,10 +75,36 @@ namespace Graphics
                 VkDeviceAddress                 shaderTableMissTableStartAddress = 0;
                 VkDeviceAddress                 shaderTableHitGroupTableStartAddress = 0;
 
+                // Radiance Cache (inline ray tracing only, see DDGI_VK.cpp::CreateCachingBuffers())
+                VkBuffer                        hitCaching = nullptr;
+                VkBuffer                        radianceCaching = nullptr;
+                VkBuffer                        radianceCachingVisualization = nullptr;
+                VkBuffer                        radianceCacheAccumulation = nullptr;
+                VkBuffer                        radianceCacheMetadata = nullptr;
+                VkBuffer                        probeRayHitMap = nullptr;
+                VkBuffer                        radianceCacheWorkList = nullptr;
+                VkBuffer                        radianceCacheWorkListArgs = nullptr;
+                VkBuffer                        radianceCacheReservoirs = nullptr;
+                VkDeviceMemory                  hitCachingMemory = nullptr;
+                VkDeviceMemory                  radianceCachingMemory = nullptr;
+                VkDeviceMemory                  radianceCachingVisualizationMemory = nullptr;
+                VkDeviceMemory                  radianceCacheAccumulationMemory = nullptr;
+                VkDeviceMemory                  radianceCacheMetadataMemory = nullptr;
+                VkDeviceMemory                  probeRayHitMapMemory = nullptr;
+                VkDeviceMemory                  radianceCacheWorkListMemory = nullptr;
+                VkDeviceMemory                  radianceCacheWorkListArgsMemory = nullptr;
+                VkDeviceMemory                  radianceCacheReservoirsMemory = nullptr;
+
+                uint32_t                        cascadeCellNum = 0;
+                uint32_t                        totalProbeRays = 0;
+
                 // DDGI
                 std::vector<rtxgi::DDGIVolumeDesc> volumeDescs;
+                Shaders::ShaderPermutations     volumeShaderPermutations;                  // Shared by the volumes created together, see CompileDDGIVolumeShaders()
                 std::vector<rtxgi::DDGIVolumeBase*> volumes;
                 std::vector<rtxgi::vulkan::DDGIVolume*> selectedVolumes;
+                std::vector<rtxgi::vulkan::DDGIVolume*> updateVolumes;                     // Volumes whose probes are updated this frame, see Execute()
+                uint32_t                        updateVolumeIndex = 0;
 
             #if !RTXGI_DDGI_RESOURCE_MANAGEMENT && !RTXGI_DDGI_BINDLESS_RESOURCES
                 VkPipelineLayout                volumePipelineLayout = nullptr;
@@ -87,7 +131,10 @@ namespace Graphics
                 Instrumentation::Stat*          gpuStat = nullptr;
 
                 Instrumentation::Stat*          classifyStat = nullptr;
+                Instrumentation::Stat*          radianceCacheCompactStat = nullptr;
                 Instrumentation::Stat*          rtStat = nullptr;
+                Instrumentation::Stat*          radianceCacheStat = nullptr;
+                Instrumentation::Stat*          resolveStat = nullptr;
                 Instrumentation::Stat*          blendStat = nullptr;
                 Instrumentation::Stat*          relocateStat = nullptr;
                 Instrumentation::Stat*          lightingStat = nullptr;
@@ -24,10 +24,12 @@ namespace Graphics
                 ID3D12Resource*              shaderTableUpload = nullptr;
                 Shaders::ShaderRTPipeline    shaders;
                 Shaders::ShaderProgram       rayTraceCS;
+                Shaders::ShaderProgram       tileArgsCS;                // GBuffer tile dispatch arguments (only with Globals::GBufferTiles)
 
                 ID3D12StateObject*           rtpso = nullptr;
                 ID3D12StateObjectProperties* rtpsoInfo = nullptr;
                 ID3D12PipelineState*           rayTracePSO = nullptr;
+                ID3D12PipelineState*         tileArgsPSO = nullptr;
 
                 uint32_t                     shaderTableSize = 0;
                 uint32_t                     shaderTableRecordSize = 0;
@@ -40,6 +42,8 @@ namespace Graphics
 
                 Instrumentation::Stat*       cpuStat = nullptr;
                 Instrumentation::Stat*       gpuStat = nullptr;
+
+                bool                         useInlineRayTracing = true;   // GBufferCS (inline ray tracing) instead of GBufferRGS (ray tracing pipeline)
             };
         }
     }
@@ -22,6 +22,9 @@ namespace Graphics
             {
                 ID3D12Resource*              PTOutput = nullptr;
                 ID3D12Resource*              PTAccumulation = nullptr;
+                ID3D12Resource*              PTVariance = nullptr;
+                ID3D12Resource*              PTConvergence = nullptr;
+                ID3D12Resource*              PTConvergenceReadback[MAX_FRAMES_IN_FLIGHT] = {};
 
                 ID3D12Resource*              shaderTable = nullptr;
                 ID3D12Resource*              shaderTableUpload = nullptr;
@@ -39,6 +42,43 @@ namespace Graphics
                 D3D12_GPU_VIRTUAL_ADDRESS    shaderTableMissTableStartAddress = 0;
                 D3D12_GPU_VIRTUAL_ADDRESS    shaderTableHitGroupTableStartAddress = 0;
 
+                // Wavefront path tracing (see PathTraceWavefrontCS.hlsl)
+                ID3D12Resource*              PTWavefrontPaths = nullptr;
+                ID3D12Resource*              PTWavefrontHits = nullptr;
+                ID3D12Resource*              PTWavefrontSurfaces = nullptr;
+                ID3D12Resource*              PTWavefrontQueues = nullptr;
+                ID3D12Resource*              PTWavefrontCounters = nullptr;
+
+                Shaders::ShaderProgram       wavefrontGenerateCS;
+                Shaders::ShaderProgram       wavefrontExtendCS;
+                Shaders::ShaderProgram       wavefrontSortCS;
+                Shaders::ShaderProgram       wavefrontScatterCS;
+                Shaders::ShaderProgram       wavefrontShadeCS;
+                Shaders::ShaderProgram       wavefrontConnectCS;
+                Shaders::ShaderProgram       wavefrontResolveCS;
+
+                ID3D12PipelineState*         wavefrontGeneratePSO = nullptr;
+                ID3D12PipelineState*         wavefrontExtendPSO = nullptr;
+                ID3D12PipelineState*         wavefrontSortPSO = nullptr;
+                ID3D12PipelineState*         wavefrontScatterPSO = nullptr;
+                ID3D12PipelineState*         wavefrontShadePSO = nullptr;
+                ID3D12PipelineState*         wavefrontConnectPSO = nullptr;
+                ID3D12PipelineState*         wavefrontResolvePSO = nullptr;
+
+                bool                         wavefront = false;
+                uint32_t                     numBounces = 0;
+                uint32_t                     samplesPerPixel = 0;
+
+                // Convergence (see PathTraceConvergence.hlsl)
+                Shaders::ShaderProgram       convergenceCS;
+                ID3D12PipelineState*         convergencePSO = nullptr;
+
+                bool                         convergence = false;
+                bool                         converged = false;                           // Every tile is converged, tracing stopped
+                uint32_t                     numConvergenceTiles = 0;
+                uint32_t                     numUnconvergedTiles = 0;
+                uint32_t                     convergenceReadbackFrame[MAX_FRAMES_IN_FLIGHT] = {};  // Frame number of each readback, 0 when invalid
+
                 Instrumentation::Stat*       cpuStat = nullptr;
                 Instrumentation::Stat*       gpuStat = nullptr;
             };
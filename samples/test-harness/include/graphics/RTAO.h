@@ -32,6 +32,7 @@ namespace Graphics
         void Update(Globals& globals, GlobalResources& gfxResources, Resources& resources, const Configs::Config& config);
         void Execute(Globals& globals, GlobalResources& gfxResources, Resources& resources);
         void Cleanup(Globals& globals, Resources& resources);
+        bool Warmup(Globals& globals, std::ofstream& log);
         bool WriteRTAOBuffersToDisk(Globals& globals, GlobalResources& gfxResources, Resources& resources, std::string directory);
     }
 }
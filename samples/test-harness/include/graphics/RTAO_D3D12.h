@@ -22,15 +22,24 @@ namespace Graphics
             {
                 ID3D12Resource*              RTAOOutput = nullptr;
                 ID3D12Resource*              RTAORaw = nullptr;
+                ID3D12Resource*              RTAOHistory[2] = {};          // Temporal accumulation (ping-pong)
 
                 ID3D12Resource*              shaderTable = nullptr;
                 ID3D12Resource*              shaderTableUpload = nullptr;
+                ID3D12Resource*              traceArgs = nullptr;          // Indirect ray dispatch over the GBuffer tiles: full and checkerboard D3D12_DISPATCH_RAYS_DESCs
+                ID3D12Resource*              traceArgsUpload = nullptr;
+                ID3D12CommandSignature*      traceCommandSignature = nullptr;
+                ID3D12CommandSignature*      traceCSCommandSignature = nullptr;  // Indirect dispatch of the inline trace over the GBuffer tiles
                 Shaders::ShaderRTPipeline    rtShaders;
+                Shaders::ShaderProgram       traceCS;                      // Inline ray tracing variant of the trace
                 Shaders::ShaderProgram       filterCS;
+                Shaders::ShaderProgram       temporalCS;
 
                 ID3D12StateObject*           rtpso = nullptr;
                 ID3D12StateObjectProperties* rtpsoInfo = nullptr;
+                ID3D12PipelineState*         tracePSO = nullptr;
                 ID3D12PipelineState*         filterPSO = nullptr;
+                ID3D12PipelineState*         temporalPSO = nullptr;
 
                 uint32_t                     shaderTableSize = 0;
                 uint32_t                     shaderTableRecordSize = 0;
@@ -45,6 +54,10 @@ namespace Graphics
                 Instrumentation::Stat*       gpuStat = nullptr;
 
                 bool                         enabled = false;
+                bool                         useInlineRayTracing = false;  // RTAOTraceCS (inline ray tracing) instead of RTAOTraceRGS (ray tracing pipeline)
+                bool                         temporal = false;
+                bool                         historyValid = false;
+                uint32_t                     historyIndex = 0;             // Index of the history texture written this frame
             };
         }
     }
@@ -35,6 +35,7 @@ namespace Graphics
         COMPOSITE_FLAG_SHOW_DDGI_VOLUME_TEXTURES = 0x8,
         COMPOSITE_FLAG_SHOW_DDGI_DIRECT_RADIANCE_CACHE = 0x10,
         COMPOSITE_FLAG_SHOW_DDGI_INDIRECT_RADIANCE_CACHE = 0x20,
+        COMPOSITE_FLAG_SHOW_DDGI_RADIANCE_CACHE_COVERAGE = 0x40,
     };
 
     enum POSTPROCESS_USE_FLAGS
@@ -44,6 +45,33 @@ namespace Graphics
         POSTPROCESS_FLAG_USE_TONEMAPPING = 0x2,
         POSTPROCESS_FLAG_USE_DITHER = 0x4,
         POSTPROCESS_FLAG_USE_GAMMA = 0x8,
+        POSTPROCESS_FLAG_USE_AUTO_EXPOSURE = 0x10,
+    };
+
+    enum RTAO_TEMPORAL_FLAGS
+    {
+        RTAO_TEMPORAL_FLAG_NONE = 0,
+        RTAO_TEMPORAL_FLAG_ENABLED = 0x1,               // Checkerboard tracing and temporal accumulation
+        RTAO_TEMPORAL_FLAG_HISTORY_VALID = 0x2,         // The history texture read this frame holds last frame's occlusion
+        RTAO_TEMPORAL_FLAG_CHECKERBOARD_ODD = 0x4,      // Parity of the pixels traced this frame
+        RTAO_TEMPORAL_FLAG_HISTORY_INDEX = 0x8,         // Index of the history texture written this frame
+    };
+
+    // Packed in the upper 16 bits of PathTraceConsts::convergence (the lower 16 bits hold the relative error threshold)
+    enum PT_CONVERGENCE_FLAGS
+    {
+        PT_CONVERGENCE_FLAG_NONE = 0,
+        PT_CONVERGENCE_FLAG_ENABLED = 0x10000,          // Estimate the variance of the accumulated pixels, per tile
+        PT_CONVERGENCE_FLAG_STEERING = 0x20000,         // Stop tracing the converged tiles
+        PT_CONVERGENCE_FLAG_STOPPED = 0x40000,          // Every tile is converged, stop tracing
+    };
+
+    // Scene TLAS instance mask bits. Every instance has the scene bit, which the other ray tracing passes test (0xFF).
+    // A DDGIVolume's probe rays only test the volume's bit, set on the instances within reach of its probe rays (see Graphics::DDGI::Update()).
+    enum TLAS_INSTANCE_MASK_FLAGS
+    {
+        TLAS_INSTANCE_MASK_SCENE = 0x80,
+        TLAS_INSTANCE_MASK_DDGI_VOLUMES = 0x7F,         // Volumes share the 7 bits, volume i uses bit (i % 7)
     };
 
     struct Payload
@@ -75,6 +103,32 @@ namespace Graphics
                                        // 44
     };
 
+    // A world-space point the CPU queries the DDGIVolume irradiance of (see IrradianceQueryCS.hlsl).
+    // The query's position and pad0 are overwritten with the irradiance and the volumes' summed blend weight.
+    struct IrradianceQuery
+    {                                  // Byte Offset
+        float3 position;               // 0
+        float  pad0;                   // 12
+        float3 normal;                 // 16
+        float  pad1;                   // 28
+                                       // 32
+    };
+
+    // The header of a DDGIVolume probe delta packet (see ProbeDeltaCS.hlsl), followed by tileCount probe tiles of tileStride bytes.
+    // A tile is the probe index, then the probe's data texel, irradiance texels, and distance texels (borders included) as half floats.
+    struct ProbeDeltaHeader
+    {                                  // Byte Offset
+        uint   volumeIndex;            // 0
+        float  threshold;              // 4   Tiles that changed by more than the threshold are exported (negative: every tile)
+        uint   tileCount;              // 8
+        uint   tileStride;             // 12
+        uint   referenceOffset;        // 16  Offset of the tiles the volume last exported in the probe deltas buffer
+        uint   probeCount;             // 20
+        uint   maxTiles;               // 24  Tiles that fit a packet, the rest are exported by later packets
+        uint   pad0;                   // 28
+                                       // 32
+    };
+
     struct HitCachingPayload
     {
         PackedPayload payload;
@@ -84,13 +138,39 @@ namespace Graphics
         uint          volumeIndex;
     };
 
+    // Priority buckets of the radiance cache update budget (one frame of age per bucket, see RadianceCacheBudget.hlsl).
+    // The budget buffer holds the bucket counts, then the threshold bucket and its remaining quota.
+#ifndef RADIANCE_CACHE_BUDGET_PRIORITY_BUCKETS
+#define RADIANCE_CACHE_BUDGET_PRIORITY_BUCKETS 64
+#endif
+#define RADIANCE_CACHE_BUDGET_ELEMENTS (RADIANCE_CACHE_BUDGET_PRIORITY_BUCKETS + 2)
+
+    // HIT_CACHE_COMPACT may be passed in as a define at shader compilation time (Globals::RadianceCacheCompactHits).
+    // The compact layout is 16 bytes per hit instead of 32. It drops the probe, ray, and volume indices (nothing
+    // reads them back) and stores the spatial hash checksum of the hit's cell instead of its grid coordinate.
+#ifndef HIT_CACHE_COMPACT
+#define HIT_CACHE_COMPACT 0
+#endif
+
+#if HIT_CACHE_COMPACT
+    struct HitPackedData
+    {
+        uint PrimitivePacked; // 22 bits primitive index, 10 bits geometry index (the full layout's geometry index range)
+        uint InstancePacked;  // 12 bits instance index, 4 bits cascade index, 16 bits hit distance (f16)
+        uint Barycentrics;    // 16 bits barycentric coordinate U, 16 bits barycentric coordinate V (unorm16)
+        uint Checksum;        // Spatial hash checksum of the hit's grid cell, see SpatialHash_ChecksumGrid()
+    };
+#else
     struct HitPackedData
     {
         uint ProbePacked;     // 16 bits Probe index, 8 bits ray index, 8 bits volume index
         uint PrimitivePacked; // 12 bits Instance index, 10 bits primitive index, 10 bits geometry index
         uint Barycentrics;    // 16 bits barycentric coordinate U, 16 bits barycentric coordinate V
         float HitDistance;
+        int3 GridCoord;       // Quantized spatial hash grid coordinate of the hit (cascade cell size)
+        uint CascadeIndex;    // Radiance cache cascade of the hit
     };
+#endif
 
     struct HitUnpackedData
     {
@@ -102,12 +182,55 @@ namespace Graphics
         uint GeometryIndex;
         float2 Barycentrics;
         float HitDistance;
+        int3 GridCoord;       // Not stored with HIT_CACHE_COMPACT
+        uint CascadeIndex;
+        uint Checksum;        // Only stored with HIT_CACHE_COMPACT
+    };
+
+    // Wavefront path tracing, see PathTraceWavefrontCS.hlsl
+    struct PathTraceWavefrontPath
+    {
+        float3 origin;               // Next ray origin
+        uint   seed;                 // Random number seed
+        float3 direction;            // Next ray direction
+        float  pad0;
+        float3 throughput;           // Path throughput
+        float  pad1;
+        float3 radiance;             // Radiance of the pixel, summed over the samples
+        float  pad2;
+    };
+
+    struct PathTraceWavefrontHit
+    {
+        uint   instanceIndex;        // Index of the TLAS instance
+        uint   geometryIndex;
+        uint   primitiveIndex;
+        float  hitT;
+        float2 barycentrics;
+        uint   materialBin;          // Material sort bin
+        uint   pad0;
+    };
+
+    struct PathTraceWavefrontSurface
+    {
+        float3 worldPosition;
+        float  pad0;
+        float3 normal;
+        float  pad1;
+        float3 shadingNormal;
+        float  pad2;
+        float3 albedo;               // Surface albedo, multiplied by the path throughput
+        float  pad3;
     };
 
     struct RadianceCacheVisualization
     {
         float3 DirectRadiance;
         float3 IndirectRadiance;
+        float3 IndirectIrradiance;   // Indirect irradiance / PI (albedo free), read by the per-pixel radiance cache gather (see IndirectCS.hlsl)
+        uint   HistoryFrames;        // Frames shaded since the slot was claimed, saturates at RADIANCE_CACHE_MAX_ACCUMULATED_SAMPLES
+        uint   HomeSlot;             // First slot of the cell's probe sequence (open addressing), the compaction pass moves the cell toward it
+        uint   ProbeRays;            // Probe rays that hit the cell in the last frame (GPU counters only, see RadianceCacheStatsCS.hlsl)
     };
 
     // Radiance cache entry with temporal accumulation support
@@ -157,11 +280,22 @@ namespace Graphics
         float2 uv0;
     };
 
+    // Scene mesh vertex, quantized at scene cache build time (see Scenes.cpp::PackVertices())
+    struct PackedVertex
+    {
+        uint4  data;        // x: 16: position x         16: position y        (UNORM in the mesh primitive bounding box)
+                            // y: 16: position z         16: tangent           (octahedral 7:7 SNORM, 1 unused, 1 bitangent sign)
+                            // z: 16: normal x           16: normal y          (octahedral SNORM)
+                            // w: 16: uv0 x              16: uv0 y             (half)
+    };
+
     struct GeometryData
     {
-        uint materialIndex;
-        uint indexByteAddress;
-        uint vertexByteAddress;
+        uint   materialIndex;
+        uint   indexByteAddress;
+        uint   vertexByteAddress;
+        uint   albedoByteAddress;     // Address of the vertex albedos in the mesh's vertex buffer (see Scenes::MeshPrimitive::vertexAlbedos), 0xFFFFFFFF: none
+        float4 positionTransform[3];  // Row major 3x4 transform of the quantized (UNORM) positions to mesh space, also the BLAS geometry transform
     };
 
     struct Camera
@@ -175,7 +309,17 @@ namespace Graphics
         float3 forward;
         float  pad0;
         float2 resolution;
-        float  pad1;
+        float2 prevResolution;
+
+        // Previous frame camera (written by the renderer each frame, used for temporal reprojection)
+        float3 prevPosition;
+        float  prevAspect;
+        float3 prevUp;
+        float  prevTanHalfFovY;
+        float3 prevRight;
+        float  pad3;
+        float3 prevForward;
+        float  pad4;
     };
 
     struct Light
@@ -188,7 +332,8 @@ namespace Graphics
         float3  color;
         float   umbraAngle;          // Spot
         float   penumbraAngle;       // Spot
-        float2  pad0;
+        uint    changedFrame;        // Frame the light or the scene's instances last changed, older cached shadow ray visibility is stale (LIGHT_VISIBILITY_CACHE)
+        float   pad0;
     };
 
     struct Material
@@ -207,6 +352,36 @@ namespace Graphics
         int    emissiveTexIdx;          // RGB [0-1]
     };
 
+    // The albedo and opacity of a Material, packed for GI hit shading (GI_MATERIALS)
+    struct GIMaterial
+    {
+        uint   albedoOpacity;           // RGBA8 UNORM: albedo RGB, opacity A
+        uint   albedoTexture;           // 15 bits albedo texture index (0x7FFF: none), 1 bit average is valid, 16 bits average albedo texture color (RGB565)
+    };
+
+    // A world-space emissive triangle of the scene, sampled as a light by the radiance cache (EMISSIVE_LIGHTS)
+    struct EmissiveTriangle
+    {
+        float3 position;                // World-space first vertex
+        float  area;
+        float3 edge1;                   // World-space second vertex - first vertex
+        uint   doubleSided;             // 0: emits on the front face (counter-clockwise winding), 1: emits on both faces
+        float3 edge2;                   // World-space third vertex - first vertex
+        float  pad0;
+        float3 radiance;                // Emitted radiance: material emissive color x average emissive texture color
+        float  pad1;
+    };
+
+    // A node of the emissive triangles' light BVH (EMISSIVE_LIGHTS), the root is node 0
+#define LIGHT_BVH_LEAF 0x80000000
+    struct LightBVHNode
+    {
+        float3 boundsMin;
+        uint   child;                   // Internal node: index of the first of its two consecutive children, leaf: emissive triangle index | LIGHT_BVH_LEAF
+        float3 boundsMax;
+        float  power;                   // Emitted power of the node's triangles (radiance luminance x area), 0 when the scene has no emissive triangles
+    };
+
     struct AppConsts
     {
         uint   frameNumber;    // updated every frame, used for random number generation
@@ -235,12 +410,16 @@ namespace Graphics
         float rayViewBias;
         uint  numBounces;
         uint  samplesPerPixel;
+        uint  wavefrontBounce;      // Wavefront path tracing: bounce of the current dispatch
+        uint  wavefrontFirstPath;   // Wavefront path tracing: first pixel of the current chunk of paths
+        uint  wavefrontSample;      // Wavefront path tracing: sample of the current dispatch
+        uint  convergence;          // Convergence: relative error threshold (f16) + PT_CONVERGENCE_FLAGS
 
     #ifndef HLSL
-        uint32_t data[4];
-        static uint32_t GetNum32BitValues() { return 4; }
+        uint32_t data[8];
+        static uint32_t GetNum32BitValues() { return 8; }
         static uint32_t GetSizeInBytes() { return GetNum32BitValues() * 4; }
-        static uint32_t GetAlignedNum32BitValues() { return 4; }
+        static uint32_t GetAlignedNum32BitValues() { return 8; }
         static uint32_t GetAlignedSizeInBytes() { return GetAlignedNum32BitValues() * 4; }
         uint32_t* GetData()
         {
@@ -248,6 +427,10 @@ namespace Graphics
             data[1] = *(uint32_t*)&rayViewBias;
             data[2] = numBounces;
             data[3] = samplesPerPixel;
+            data[4] = wavefrontBounce;
+            data[5] = wavefrontFirstPath;
+            data[6] = wavefrontSample;
+            data[7] = convergence;
             return data;
         }
 
@@ -311,10 +494,12 @@ namespace Graphics
         float filterDistKernel3;
         float filterDistKernel4;
         float filterDistKernel5;
+        uint  temporalFlags;        // RTAO_TEMPORAL_FLAGS
+        float temporalMinBlend;     // minimum weight of the current frame's occlusion (1 / max history length)
 
     #ifndef HLSL
-        uint32_t data[14] = {};
-        static uint32_t GetNum32BitValues() { return 14; }
+        uint32_t data[16] = {};
+        static uint32_t GetNum32BitValues() { return 16; }
         static uint32_t GetSizeInBytes() { return GetNum32BitValues() * 4; }
         static uint32_t GetAlignedNum32BitValues() { return 16; }
         static uint32_t GetAlignedSizeInBytes() { return GetAlignedNum32BitValues() * 4; }
@@ -334,8 +519,8 @@ namespace Graphics
             data[11] = *(uint32_t*)&filterDistKernel3;
             data[12] = *(uint32_t*)&filterDistKernel4;
             data[13] = *(uint32_t*)&filterDistKernel5;
-          //data[14] = 0; // empty, for alignment
-          //data[15] = 0; // empty, for alignment
+            data[14] = temporalFlags;
+            data[15] = *(uint32_t*)&temporalMinBlend;
             return data;
         }
     #endif
@@ -366,11 +551,12 @@ namespace Graphics
     struct PostProcessConsts
     {
         uint  useFlags;
-        float exposure;
+        float exposure;             // Manual exposure, or the compensation of the automatic exposure
+        float exposureAdaptation;   // Automatic exposure: fraction of the change in f-stops applied each frame
 
     #ifndef HLSL
-        uint32_t data[2];
-        static uint32_t GetNum32BitValues() { return 2; }
+        uint32_t data[3];
+        static uint32_t GetNum32BitValues() { return 3; }
         static uint32_t GetSizeInBytes() { return GetNum32BitValues() * 4; }
         static uint32_t GetAlignedNum32BitValues() { return 4; }
         static uint32_t GetAlignedSizeInBytes() { return GetAlignedNum32BitValues() * 4; }
@@ -378,7 +564,7 @@ namespace Graphics
         {
             data[0] = useFlags;
             data[1] = *(uint32_t*)&exposure;
-          //data[2] = 0; // empty, alignment padding
+            data[2] = *(uint32_t*)&exposureAdaptation;
           //data[3] = 0; // empty, alignment padding
             return data;
         }
@@ -388,7 +574,7 @@ namespace Graphics
     struct DDGIVisConsts
     {
         // Probe Visualization
-        uint  instanceOffset;   // Offset of the current volume's sphere instances in the acceleration structure's TLAS instances
+        uint  instanceOffset;   // [0-15]: offset of the current volume's sphere instances in the TLAS instances | [16-19]: probe sphere BLAS LODs | [20-31]: bytes between the LOD BLAS / 256
         uint  probeType;        // 0: irradiance | 1: distance
         float probeRadius;      // world-space value
         float distanceDivisor;  // divisor that normalizes the displayed distance values
@@ -401,9 +587,15 @@ namespace Graphics
         float probeVariabilityTextureScale;
         float probeVariabilityTextureThreshold;
 
+        // Rasterized Probe Visualization
+        uint  probeVisType;     // EDDGIVolumeProbeVisType of the volume being drawn
+
+        // Probe Textures Visualization View
+        uint  textureView;      // [0-3]: magnification (power of two) | [4-17]: x pan | [18-31]: y pan (texels of the unmagnified layout)
+
     #ifndef HLSL
-        uint32_t data[10];
-        static uint32_t GetNum32BitValues() { return 10; }
+        uint32_t data[12];
+        static uint32_t GetNum32BitValues() { return 12; }
         static uint32_t GetSizeInBytes() { return GetNum32BitValues() * 4; }
         static uint32_t GetAlignedNum32BitValues() { return 12; }
         static uint32_t GetAlignedSizeInBytes() { return GetAlignedNum32BitValues() * 4; }
@@ -419,7 +611,8 @@ namespace Graphics
             data[7] = *(uint32_t*)&probeDataTextureScale;
             data[8] = *(uint32_t*)&probeVariabilityTextureScale;
             data[9] = *(uint32_t*)&probeVariabilityTextureThreshold;
-            //data[10/11] = 0; // empty, alignment padding
+            data[10] = probeVisType;
+            data[11] = textureView;
 
             return data;
         }
@@ -430,13 +623,13 @@ namespace Graphics
     {
     #ifndef HLSL
         AppConsts         app;         //  4 32-bit values,  16 bytes
-        PathTraceConsts   pt;          //  4 32-bit values,  16 bytes
+        PathTraceConsts   pt;          //  8 32-bit values,  32 bytes
         LightingConsts    lights;      //  4 32-bit values,  16 bytes
         RTAOConsts        rtao;        // 16 32-bit values,  64 bytes
         CompositeConsts   composite;   //  4 32-bit values,  16 bytes
         PostProcessConsts post;        //  4 32-bit values,  16 bytes
         DDGIVisConsts     ddgivis;     // 12 32-bit values,  48 bytes
-                                       // 48 32-bit values, 192 bytes
+                                       // 52 32-bit values, 208 bytes
 
         static uint32_t GetNum32BitValues()
         {
@@ -495,6 +688,10 @@ namespace Graphics
         float  pt_rayViewBias;
         uint   pt_numBounces;
         uint   pt_samplesPerPixel;
+        uint   pt_wavefrontBounce;
+        uint   pt_wavefrontFirstPath;
+        uint   pt_wavefrontSample;
+        uint   pt_convergence;
 
         // Lighting Constants
         uint   lighting_hasDirectionalLight;   // -1: no directional light
@@ -517,7 +714,8 @@ namespace Graphics
         float  rtao_filterDistKernel3;
         float  rtao_filterDistKernel4;
         float  rtao_filterDistKernel5;
-        uint2  rtao_pad;
+        uint   rtao_temporalFlags;
+        float  rtao_temporalMinBlend;
 
         // Composite Constants
         uint   composite_useFlags;
@@ -527,7 +725,8 @@ namespace Graphics
         // Post Process Constants
         uint   post_useFlags;
         float  post_exposure;
-        uint2  post_pad;
+        float  post_exposureAdaptation;
+        uint   post_pad;
 
         // DDGI Visualization Constants
         uint   ddgivis_instanceOffset;
@@ -540,7 +739,8 @@ namespace Graphics
         float  ddgivis_probeDataTextureScale;
         float  ddgivis_probeVariabilityTextureScale;
         float  ddgivis_probeVariabilityTextureThreshold;
-        uint2  ddgivis_pad;
+        uint   ddgivis_probeVisType;
+        uint   ddgivis_textureView;
 
     #ifdef __spirv__
         // DDGIRootConstants
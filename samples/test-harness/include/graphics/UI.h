@@ -28,9 +28,13 @@ namespace Graphics
     namespace UI
     {
         extern bool s_initialized;
+        extern bool s_reuseDrawData;
+
+        bool BeginFrame(Graphics::Globals& gfx, Configs::Config& config, const Instrumentation::Performance& performance);
+        void Invalidate();
 
         bool Initialize(Graphics::Globals& gfx, Graphics::GlobalResources& gfxResources, Resources& resources, Instrumentation::Performance& perf, std::ofstream& log);
-        void Update(Graphics::Globals& gfx, Resources& resources, Configs::Config& config, Inputs::Input& input, Scenes::Scene& scene, std::vector<DDGIVolumeBase*>& volumes, const Instrumentation::Performance& performance);
+        void Update(Graphics::Globals& gfx, Resources& resources, Configs::Config& config, Inputs::Input& input, Scenes::Scene& scene, std::vector<DDGIVolumeBase*>& volumes, const DDGI::CostController& costController, const Instrumentation::Performance& performance);
         bool MessageBox(std::string message);
         bool MessageRetryBox(std::string message);
         bool CapturedMouse();
@@ -38,7 +42,7 @@ namespace Graphics
         void Execute(Graphics::Globals& gfx, Graphics::GlobalResources& gfxResources, Resources& resources, const Configs::Config& config);
         void Cleanup();
 
-        void CreateDebugWindow(Graphics::Globals& gfx, Configs::Config& config, Inputs::Input& input, Scenes::Scene& scene, std::vector<DDGIVolumeBase*>& volumes);
+        void CreateDebugWindow(Graphics::Globals& gfx, Configs::Config& config, Inputs::Input& input, Scenes::Scene& scene, std::vector<DDGIVolumeBase*>& volumes, const DDGI::CostController& costController, const Instrumentation::Performance& perf);
         void CreatePerfWindow(Graphics::Globals& gfx, const Configs::Config& config, const Instrumentation::Performance& performance);
     }
 }
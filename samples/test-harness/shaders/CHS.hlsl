@@ -188,25 +188,45 @@ void CHS_GI(inout PackedPayload packedPayload, BuiltInTriangleIntersectionAttrib
     payload.normal = normalize(mul(ObjectToWorld3x4(), float4(payload.normal, 0.f)).xyz);
     payload.shadingNormal = payload.normal;
 
+#if GI_MATERIALS
+    int albedoTexIdx = -1;
+#if GI_VERTEX_ALBEDO
+    if (geometry.albedoByteAddress != 0xFFFFFFFF)
+    {
+        // Interpolate the baked vertex albedos, no material or texture is read
+        float4 albedo = LoadAndInterpolateVertexAlbedo(InstanceID(), PrimitiveIndex(), geometry, barycentrics);
+        payload.albedo = albedo.rgb;
+        payload.opacity = albedo.a;
+    }
+    else
+#endif
+    {
+        // Load the surface's GI material, the albedo texture is only sampled when the material has no average color of it
+        albedoTexIdx = UnpackGIMaterial(GetGIMaterial(geometry), payload.albedo, payload.opacity);
+    }
+#else
     // Load the surface material
     Material material = GetMaterial(geometry);
     payload.albedo = material.albedo;
     payload.opacity = material.opacity;
+    int albedoTexIdx = material.albedoTexIdx;
+#endif
 
     // Albedo and Opacity
-    if (material.albedoTexIdx > -1)
+    if (albedoTexIdx > -1)
     {
         // Get the number of mip levels
         uint width, height, numLevels;
-        GetTex2D(material.albedoTexIdx).GetDimensions(0, width, height, numLevels);
+        GetTex2D(albedoTexIdx).GetDimensions(0, width, height, numLevels);
 
         // Sample the albedo texture
-        float4 bco = GetTex2D(material.albedoTexIdx).SampleLevel(GetBilinearWrapSampler(), v.uv0, numLevels / 2.f);
+        float4 bco = GetTex2D(albedoTexIdx).SampleLevel(GetBilinearWrapSampler(), v.uv0, numLevels / 2.f);
         payload.albedo *= bco.rgb;
         payload.opacity *= bco.a;
     }
 
-    // Shading normal
+    // Shading normal (GI materials shade with the geometric normal)
+#if !GI_MATERIALS
     if (material.normalTexIdx > -1)
     {
         // Get the number of mip levels
@@ -220,6 +240,7 @@ void CHS_GI(inout PackedPayload packedPayload, BuiltInTriangleIntersectionAttrib
         payload.shadingNormal = (payload.shadingNormal * 2.f) - 1.f;    // Transform to [-1, 1]
         payload.shadingNormal = mul(payload.shadingNormal, TBN);        // Transform tangent-space normal to world-space
     }
+#endif
 
     // Pack the payload
     packedPayload = PackPayload(payload);
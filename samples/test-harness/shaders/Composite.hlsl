@@ -12,6 +12,7 @@
 #include "include/Descriptors.hlsl"
 #include "include/Random.hlsl"
 #include "include/SpatialHash.hlsl"
+#include "include/VisibilityBuffer.hlsl"
 
 // ---[ Structures ]---
 
@@ -39,11 +40,101 @@ PSInput VS(uint VertID : SV_VertexID)
     return result;
 }
 
+// ---[ Helper Functions ]---
+
+#if FINAL_GATHER_DOWNSCALE > 1
+// Sharpness of the depth and normal weights of the indirect lighting upsample
+#define INDIRECT_UPSAMPLE_DEPTH_SIGMA 0.05f
+#define INDIRECT_UPSAMPLE_NORMAL_POWER 32.f
+
+struct IndirectTap
+{
+    float3 indirect;
+    float3 normal;
+    float  hitT;
+};
+
+/**
+ * Load a DDGIOutput texel and the GBuffer depth and normal it was gathered with (misses have a zero normal, so get no weight).
+ * Each DDGIOutput texel holds the lighting gathered for the full resolution pixel at (texel * FINAL_GATHER_DOWNSCALE), see IndirectCS.hlsl.
+ */
+IndirectTap LoadIndirectTap(int2 tapCoords, RWTexture2D<float4> DDGIOutput)
+{
+    IndirectTap tap;
+    float4 tapWorldPosHitT;
+    GBufferLoadSurface(uint2(tapCoords * FINAL_GATHER_DOWNSCALE), tapWorldPosHitT, tap.normal);
+    tap.hitT = tapWorldPosHitT.w;
+    tap.indirect = DDGIOutput.Load(tapCoords).rgb;
+    return tap;
+}
+
+/**
+ * Load the four DDGIOutput texels around the pixel, once per 2x2 pixel quad.
+ * Quads are 2x2 aligned and FINAL_GATHER_DOWNSCALE is even, so the pixels of a quad use the same four texels:
+ * each lane loads one of them and reads the others from its neighbors. Lanes that don't share their
+ * neighbors' texels (e.g. coarse shaded quads) load the texels themselves.
+ * Must be called from quad uniform control flow.
+ */
+void LoadIndirectTaps(int2 pixel, RWTexture2D<float4> DDGIOutput, out IndirectTap taps[4], out float2 bilinear)
+{
+    // Texels gathered for the render area (see GetRenderResolution)
+    uint2 outputSize = (GetRenderResolution() + (FINAL_GATHER_DOWNSCALE - 1)) / FINAL_GATHER_DOWNSCALE;
+
+    float2 outputCoords = float2(pixel) / FINAL_GATHER_DOWNSCALE;
+    int2   baseCoords = int2(floor(outputCoords));
+    bilinear = frac(outputCoords);
+
+    // Quad lane of the pixel (0: top left, 1: top right, 2: bottom left, 3: bottom right), it loads the texel at the same offset
+    uint quadLane = (pixel.x & 1) | ((pixel.y & 1) << 1);
+    IndirectTap laneTap = LoadIndirectTap(min(baseCoords + int2(quadLane & 1, quadLane >> 1), int2(outputSize) - 1), DDGIOutput);
+
+    [unroll]
+    for (uint tap = 0; tap < 4; tap++)
+    {
+        taps[tap].indirect = QuadReadLaneAt(laneTap.indirect, tap);
+        taps[tap].normal = QuadReadLaneAt(laneTap.normal, tap);
+        taps[tap].hitT = QuadReadLaneAt(laneTap.hitT, tap);
+
+        bool shared = all(QuadReadLaneAt(baseCoords, tap) == baseCoords) && (QuadReadLaneAt(quadLane, tap) == tap);
+        if (!shared) taps[tap] = LoadIndirectTap(min(baseCoords + int2(tap & 1, tap >> 1), int2(outputSize) - 1), DDGIOutput);
+    }
+}
+
+/**
+ * Joint bilateral upsample of the reduced resolution DDGI indirect lighting.
+ * The four texels around the pixel are weighted bilinearly and by how closely their GBuffer depth and normal match the pixel's.
+ */
+float3 GetUpsampledIndirect(float hitT, float3 normal, IndirectTap taps[4], float2 bilinear)
+{
+    float3 indirect = float3(0.f, 0.f, 0.f);
+    float  weightSum = 0.f;
+
+    [unroll]
+    for (int tap = 0; tap < 4; tap++)
+    {
+        float2 offset = float2(tap & 1, tap >> 1);
+        float2 bilinearWeights = lerp(1.f - bilinear, bilinear, offset);
+        float  weight = bilinearWeights.x * bilinearWeights.y;
+        weight *= exp(-abs(taps[tap].hitT - hitT) / (INDIRECT_UPSAMPLE_DEPTH_SIGMA * hitT));
+        weight *= pow(saturate(dot(taps[tap].normal, normal)), INDIRECT_UPSAMPLE_NORMAL_POWER);
+
+        indirect += taps[tap].indirect * weight;
+        weightSum += weight;
+    }
+
+    // No texel matches the pixel's surface (e.g. thin geometry), use the nearest texel
+    if (weightSum <= 1e-4f) return taps[0].indirect;
+
+    return (indirect / weightSum);
+}
+#endif
+
 // ---[ Pixel Shader ]---
 
-float4 PS(PSInput input) : SV_TARGET
+float4 CompositePixel(PSInput input)
 {
     float3 color = float3(0.f, 0.f, 0.f);
+    float3 indirect = float3(0.f, 0.f, 0.f);
     float  ambientOcclusion = 1.f;
 
     // Load the albedo and convert to linear before lighting
@@ -56,20 +147,35 @@ float4 PS(PSInput input) : SV_TARGET
     // Get the usage flags
     uint useFlags = GetGlobalConst(composite, useFlags);
 
+    bool isLit = (albedo.a >= COMPOSITE_FLAG_LIGHT_PIXEL);
+
+#if FINAL_GATHER_DOWNSCALE > 1
+    // Load the reduced resolution indirect lighting once per quad, outside of the (divergent) primary ray hit branch.
+    // Quads without primary ray hits (e.g. sky) skip the loads.
+    IndirectTap indirectTaps[4] = (IndirectTap[4])0;
+    float2 indirectBilinear = float2(0.f, 0.f);
+
+    uint quadLit = isLit ? 1 : 0;
+    quadLit |= QuadReadAcrossX(quadLit) | QuadReadAcrossY(quadLit) | QuadReadAcrossDiagonal(quadLit);
+    if ((useFlags & COMPOSITE_FLAG_USE_DDGI) && quadLit)
+    {
+        LoadIndirectTaps(int2(input.position.xy), GetRWTex2D(DDGI_OUTPUT_INDEX), indirectTaps, indirectBilinear);
+    }
+#endif
+
     // Primary ray hit, need to light it
-    if (albedo.a >= COMPOSITE_FLAG_LIGHT_PIXEL)
+    if (isLit)
     {
         // Get the (bindless) resources
-        RWTexture2D<float4> GBufferB = GetRWTex2D(GBUFFERB_INDEX);
-        RWTexture2D<float4> GBufferC = GetRWTex2D(GBUFFERC_INDEX);
         RWTexture2D<float4> GBufferD = GetRWTex2D(GBUFFERD_INDEX);
 
         // Convert albedo back to linear
         albedo.rgb = SRGBToLinear(albedo.rgb);
 
-        // Load world position, hit distance, and normal
-        float4 worldPosHitT = GBufferB.Load(input.position.xy);
-        float3 normal = GBufferC.Load(input.position.xy).xyz;
+        // Load (or reconstruct from the visibility buffer) world position, hit distance, and normal
+        float4 worldPosHitT;
+        float3 normal;
+        GBufferLoadSurface(uint2(input.position.xy), worldPosHitT, normal);
 
         // Load the direct lighting
         color = GBufferD.Load(input.position.xy).rgb;
@@ -78,8 +184,12 @@ float4 PS(PSInput input) : SV_TARGET
         if (useFlags & COMPOSITE_FLAG_USE_DDGI)
         {
             // Add direct and indirect lighting
+        #if FINAL_GATHER_DOWNSCALE > 1
+            indirect = GetUpsampledIndirect(worldPosHitT.w, normal, indirectTaps, indirectBilinear);
+        #else
             RWTexture2D<float4> DDGIOutput = GetRWTex2D(DDGI_OUTPUT_INDEX);
-            float3 indirect = DDGIOutput.Load(input.position.xy / FINAL_GATHER_DOWNSCALE).rgb;
+            indirect = DDGIOutput.Load(input.position.xy).rgb;
+        #endif
             color += indirect;
         }
 
@@ -108,20 +218,25 @@ float4 PS(PSInput input) : SV_TARGET
     if ((useFlags & COMPOSITE_FLAG_USE_DDGI) && (showFlags & COMPOSITE_FLAG_SHOW_DDGI_INDIRECT))
     {
         // Show only the indirect lighting from DDGI
-        RWTexture2D<float4> DDGIOutput = GetRWTex2D(DDGI_OUTPUT_INDEX);
-        float3 indirect = DDGIOutput.Load(input.position.xy / FINAL_GATHER_DOWNSCALE).rgb;
         color = indirect;
     }
 
-    bool ShowRadianceCacheVisualization = (showFlags & COMPOSITE_FLAG_SHOW_DDGI_DIRECT_RADIANCE_CACHE) || (showFlags & COMPOSITE_FLAG_SHOW_DDGI_INDIRECT_RADIANCE_CACHE);
+    bool ShowRadianceCacheVisualization = (showFlags & (COMPOSITE_FLAG_SHOW_DDGI_DIRECT_RADIANCE_CACHE | COMPOSITE_FLAG_SHOW_DDGI_INDIRECT_RADIANCE_CACHE | COMPOSITE_FLAG_SHOW_DDGI_RADIANCE_CACHE_COVERAGE));
     if ((useFlags & COMPOSITE_FLAG_USE_DDGI) && ShowRadianceCacheVisualization)
     {
-        RWTexture2D<float4> GBufferB = GetRWTex2D(GBUFFERB_INDEX);
-        float3 WorldPos = GBufferB.Load(input.position.xy).xyz;
-        uint HashID = SpatialHashCascadeIndex(WorldPos, GetCascadeCellRadius(), GetMaxCacheCellCount(), GetCascadeCount(), GetCascadeBaseDistance());
-        RWStructuredBuffer<RadianceCacheVisualization> RadianceCacheVisualizationBuffer = GetRadianceCachingVisualizationBuffer();
-        float3 DirectRadiance = RadianceCacheVisualizationBuffer[HashID].DirectRadiance;
-        float3 IndirectRadiance = RadianceCacheVisualizationBuffer[HashID].IndirectRadiance;
+        float4 WorldPosHitT = GBufferLoadWorldPosHitT(uint2(input.position.xy));
+        float3 WorldPos = WorldPosHitT.xyz;
+        uint HashID = SpatialHashCascadeFind(WorldPos, WorldPosHitT.w, GetCascadeCellRadius(), GetMaxCacheCellCount(), GetCascadeCount(), GetCascadeBaseDistance(), GetRadianceCacheMetadataBuffer());
+        float3 DirectRadiance = float3(0.f, 0.f, 0.f);
+        float3 IndirectRadiance = float3(0.f, 0.f, 0.f);
+        uint ProbeRays = 0;
+        if (HashID != RADIANCE_CACHE_INVALID_SLOT)
+        {
+            RWStructuredBuffer<RadianceCacheVisualization> RadianceCacheVisualizationBuffer = GetRadianceCachingVisualizationBuffer();
+            DirectRadiance = RadianceCacheVisualizationBuffer[HashID].DirectRadiance;
+            IndirectRadiance = RadianceCacheVisualizationBuffer[HashID].IndirectRadiance;
+            ProbeRays = RadianceCacheVisualizationBuffer[HashID].ProbeRays;
+        }
         float3 WorldRadiance = DirectRadiance + IndirectRadiance;
 
         if (showFlags & COMPOSITE_FLAG_SHOW_DDGI_DIRECT_RADIANCE_CACHE)
@@ -136,6 +251,16 @@ float4 PS(PSInput input) : SV_TARGET
         {
             color = WorldRadiance;
         }
+        if (showFlags & COMPOSITE_FLAG_SHOW_DDGI_RADIANCE_CACHE_COVERAGE)
+        {
+            // Heatmap of the probe rays that hit the cell last frame: blue (1 ray), green, red (512 or more rays), black (none)
+            float t = saturate(log2((float)max(ProbeRays, 1u)) / 9.f);
+            float3 heat = (t < 0.5f) ? lerp(float3(0.f, 0.f, 1.f), float3(0.f, 1.f, 0.f), t * 2.f) : lerp(float3(0.f, 1.f, 0.f), float3(1.f, 0.f, 0.f), (t * 2.f) - 1.f);
+            color = (ProbeRays > 0) ? heat : float3(0.f, 0.f, 0.f);
+
+            // Heatmap colors are not post processed
+            return float4(color, 1.f);
+        }
     }
 
     // Early out, no post processing
@@ -148,6 +273,9 @@ float4 PS(PSInput input) : SV_TARGET
         if (ppUseFlags & POSTPROCESS_FLAG_USE_EXPOSURE)
         {
             color *= GetGlobalConst(post, exposure);
+
+            // Automatic exposure, computed from the frame's luminance histogram (see CompositeExposureCS.hlsl)
+            if (ppUseFlags & POSTPROCESS_FLAG_USE_AUTO_EXPOSURE) color *= asfloat(GetCompositeExposure().Load(0));
         }
 
         // Tonemapping
@@ -172,3 +300,42 @@ float4 PS(PSInput input) : SV_TARGET
 
     return float4(color, 1.f);
 }
+
+/**
+ * Composite the render area. With dynamic resolution it is smaller than the back buffer, and the result
+ * replaces the pixel's direct lighting in GBufferD for UpscalePS to fill the back buffer.
+ */
+float4 PS(PSInput input) : SV_TARGET
+{
+    float4 color = CompositePixel(input);
+
+    RWTexture2D<float4> GBufferD = GetRWTex2D(GBUFFERD_INDEX);
+    uint2 targetSize;
+    GBufferD.GetDimensions(targetSize.x, targetSize.y);
+    if (any(GetRenderResolution() != targetSize)) GBufferD[uint2(input.position.xy)] = color;
+
+    return color;
+}
+
+// ---[ Upscale Pixel Shader ]---
+
+/**
+ * Bilinear upscale of the composited render area (see PS) to the back buffer, with dynamic resolution.
+ */
+float4 UpscalePS(PSInput input) : SV_TARGET
+{
+    RWTexture2D<float4> GBufferD = GetRWTex2D(GBUFFERD_INDEX);
+    uint2 targetSize;
+    GBufferD.GetDimensions(targetSize.x, targetSize.y);
+
+    int2   renderSize = int2(GetRenderResolution());
+    float2 sourcePos = (input.position.xy * (float2(renderSize) / float2(targetSize))) - 0.5f;
+    int2   base = int2(floor(sourcePos));
+    float2 bilinear = frac(sourcePos);
+
+    int2 p0 = clamp(base, int2(0, 0), renderSize - 1);
+    int2 p1 = clamp(base + 1, int2(0, 0), renderSize - 1);
+    float4 top = lerp(GBufferD.Load(p0), GBufferD.Load(int2(p1.x, p0.y)), bilinear.x);
+    float4 bottom = lerp(GBufferD.Load(int2(p0.x, p1.y)), GBufferD.Load(p1), bilinear.x);
+    return lerp(top, bottom, bilinear.y);
+}
@@ -0,0 +1,169 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+// -------- CONFIGURATION DEFINES -----------------------------------------------------------------
+
+// EXPOSURE_HISTOGRAM_BINS must be passed in as a define at shader compilation time.
+// This define specifies the number of log2 luminance bins of the histogram (at most EXPOSURE_THREADS^2).
+// Ex: EXPOSURE_HISTOGRAM_BINS 128
+#ifndef EXPOSURE_HISTOGRAM_BINS
+    #error Required define EXPOSURE_HISTOGRAM_BINS is not defined for CompositeExposureCS.hlsl!
+#endif
+
+// FINAL_GATHER_DOWNSCALE must be passed in as a define at shader compilation time.
+// This define specifies the downscale factor of the DDGI indirect lighting output.
+// Ex: FINAL_GATHER_DOWNSCALE 1
+#ifndef FINAL_GATHER_DOWNSCALE
+    #error Required define FINAL_GATHER_DOWNSCALE is not defined for CompositeExposureCS.hlsl!
+#endif
+
+// -------------------------------------------------------------------------------------------
+
+#include "include/Common.hlsl"
+#include "include/Descriptors.hlsl"
+
+// Exposure buffer layout (see GetCompositeExposure): a 16 byte header, then EXPOSURE_HISTOGRAM_BINS bin counts
+#define EXPOSURE_VALUE_OFFSET 0                 // float: exposure applied by the composite pass
+#define EXPOSURE_AVERAGE_OFFSET 4               // float: average log2 luminance of the clipped histogram
+#define EXPOSURE_GROUP_COUNTER_OFFSET 8         // uint: thread groups done with the frame's histogram
+#define EXPOSURE_HISTOGRAM_OFFSET 16
+
+#define EXPOSURE_THREADS 16
+#define EXPOSURE_SAMPLE_STRIDE 4                // One luminance sample per 4x4 pixels, at a position that changes every frame
+#define EXPOSURE_MIN_LOG2_LUMINANCE -10.f
+#define EXPOSURE_LOG2_LUMINANCE_RANGE 20.f
+#define EXPOSURE_LOW_PERCENTILE 0.5f            // The darkest half of the samples (e.g. shadows) is left out of the average
+#define EXPOSURE_HIGH_PERCENTILE 0.95f          // And so are the brightest samples (e.g. light sources)
+#define EXPOSURE_KEY 0.18f                      // Middle grey
+
+groupshared uint HistogramBins[EXPOSURE_HISTOGRAM_BINS];
+groupshared bool IsLastGroup;
+
+/**
+ * Reconstruct the composited (pre-exposure) color of a pixel, like CompositePixel.
+ */
+bool LoadCompositeColor(uint2 pixel, out float3 color)
+{
+    RWTexture2D<float4> GBufferA = GetRWTex2D(GBUFFERA_INDEX);
+    float4 albedo = GBufferA.Load(pixel);
+
+    // Pixels without post processing (e.g. visualizations) don't affect the exposure
+    color = albedo.rgb;
+    if (albedo.a <= COMPOSITE_FLAG_IGNORE_PIXEL) return false;
+    if (albedo.a < COMPOSITE_FLAG_LIGHT_PIXEL) return true;
+
+    uint useFlags = GetGlobalConst(composite, useFlags);
+
+    color = GetRWTex2D(GBUFFERD_INDEX).Load(pixel).rgb;
+    if (useFlags & COMPOSITE_FLAG_USE_DDGI) color += GetRWTex2D(DDGI_OUTPUT_INDEX).Load(pixel / FINAL_GATHER_DOWNSCALE).rgb;
+    if (useFlags & COMPOSITE_FLAG_USE_RTAO) color *= GetRWTex2D(RTAO_OUTPUT_INDEX).Load(pixel).x;
+    return true;
+}
+
+float GetBinLog2Luminance(uint bin)
+{
+    return EXPOSURE_MIN_LOG2_LUMINANCE + ((float(bin) + 0.5f) / EXPOSURE_HISTOGRAM_BINS) * EXPOSURE_LOG2_LUMINANCE_RANGE;
+}
+
+// Dispatch: (DivRoundUp(RenderWidth, 64), DivRoundUp(RenderHeight, 64), 1), the last thread group to finish computes the exposure
+[numthreads(EXPOSURE_THREADS, EXPOSURE_THREADS, 1)]
+void CS(uint3 DispatchThreadID : SV_DispatchThreadID, uint GroupIndex : SV_GroupIndex)
+{
+    RWByteAddressBuffer Exposure = GetCompositeExposure();
+
+    if (GroupIndex < EXPOSURE_HISTOGRAM_BINS) HistogramBins[GroupIndex] = 0;
+    GroupMemoryBarrierWithGroupSync();
+
+    // Sample one pixel of the thread's tile
+    uint2 dimensions = GetRenderResolution();
+    uint  frameNumber = GetGlobalConst(app, frameNumber);
+    uint2 jitter = uint2(frameNumber, frameNumber / EXPOSURE_SAMPLE_STRIDE) % EXPOSURE_SAMPLE_STRIDE;
+    uint2 pixel = (DispatchThreadID.xy * EXPOSURE_SAMPLE_STRIDE) + jitter;
+
+    float3 color;
+    bool valid = all(pixel < dimensions) && LoadCompositeColor(pixel, color);
+    uint bin = 0;
+    if (valid)
+    {
+        float log2Luminance = log2(max(dot(color, float3(0.2126f, 0.7152f, 0.0722f)), 1e-6f));
+        bin = uint(saturate((log2Luminance - EXPOSURE_MIN_LOG2_LUMINANCE) / EXPOSURE_LOG2_LUMINANCE_RANGE) * (EXPOSURE_HISTOGRAM_BINS - 1));
+    }
+
+    // Lanes of a wave that land in the same bin add to it once
+    [loop]
+    while (valid)
+    {
+        if (bin == WaveReadLaneFirst(bin))
+        {
+            uint count = WaveActiveCountBits(true);
+            if (WaveIsFirstLane()) InterlockedAdd(HistogramBins[bin], count);
+            valid = false;
+        }
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    // Add the group's bins to the frame's histogram
+    if (GroupIndex < EXPOSURE_HISTOGRAM_BINS && HistogramBins[GroupIndex] > 0)
+    {
+        Exposure.InterlockedAdd(EXPOSURE_HISTOGRAM_OFFSET + (GroupIndex * 4), HistogramBins[GroupIndex]);
+    }
+    DeviceMemoryBarrierWithGroupSync();
+
+    if (GroupIndex == 0)
+    {
+        uint2 numGroups = (dimensions + ((EXPOSURE_THREADS * EXPOSURE_SAMPLE_STRIDE) - 1)) / (EXPOSURE_THREADS * EXPOSURE_SAMPLE_STRIDE);
+        uint groupsDone;
+        Exposure.InterlockedAdd(EXPOSURE_GROUP_COUNTER_OFFSET, 1, groupsDone);
+        IsLastGroup = (groupsDone == (numGroups.x * numGroups.y) - 1);
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    if (!IsLastGroup) return;
+
+    // Read the frame's histogram and clear it for the next frame
+    if (GroupIndex < EXPOSURE_HISTOGRAM_BINS)
+    {
+        uint count;
+        Exposure.InterlockedExchange(EXPOSURE_HISTOGRAM_OFFSET + (GroupIndex * 4), 0, count);
+        HistogramBins[GroupIndex] = count;
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    if (GroupIndex != 0) return;
+
+    uint index;
+    uint total = 0;
+    for (index = 0; index < EXPOSURE_HISTOGRAM_BINS; index++) total += HistogramBins[index];
+
+    // Average the log2 luminance of the samples between the low and high percentiles
+    float low = total * EXPOSURE_LOW_PERCENTILE;
+    float high = total * EXPOSURE_HIGH_PERCENTILE;
+    float cumulative = 0.f;
+    float sum = 0.f;
+    float weight = 0.f;
+    for (index = 0; index < EXPOSURE_HISTOGRAM_BINS; index++)
+    {
+        float count = float(HistogramBins[index]);
+        float clipped = max(min(cumulative + count, high) - max(cumulative, low), 0.f);
+        sum += clipped * GetBinLog2Luminance(index);
+        weight += clipped;
+        cumulative += count;
+    }
+
+    float previousExposure = asfloat(Exposure.Load(EXPOSURE_VALUE_OFFSET));
+    float average = (weight > 0.f) ? (sum / weight) : asfloat(Exposure.Load(EXPOSURE_AVERAGE_OFFSET));
+    float exposure = log2(EXPOSURE_KEY) - average;
+
+    // Adapt to the new exposure over several frames (in f-stops), the first frame starts at it
+    if (previousExposure > 0.f) exposure = lerp(log2(previousExposure), exposure, GetGlobalConst(post, exposureAdaptation));
+
+    // Store the exposure and the average, and reset the group counter
+    Exposure.Store3(EXPOSURE_VALUE_OFFSET, uint3(asuint(exp2(exposure)), asuint(average), 0));
+}
@@ -0,0 +1,65 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+// -------- CONFIGURATION DEFINES -----------------------------------------------------------------
+
+// VRS_TILE_SIZE must be passed in as a define at shader compilation time.
+// This define specifies the shading rate image tile size of the device (8, 16, or 32).
+// Ex: VRS_TILE_SIZE 16
+#ifndef VRS_TILE_SIZE
+    #error Required define VRS_TILE_SIZE is not defined for CompositeShadingRateCS.hlsl!
+#endif
+
+// VRS_COARSE_RATE must be passed in as a define at shader compilation time.
+// This define specifies the D3D12_SHADING_RATE of the tiles that only contain sky pixels.
+// Ex: VRS_COARSE_RATE 5 (D3D12_SHADING_RATE_2X2)
+#ifndef VRS_COARSE_RATE
+    #error Required define VRS_COARSE_RATE is not defined for CompositeShadingRateCS.hlsl!
+#endif
+
+// -------------------------------------------------------------------------------------------
+
+#include "include/Common.hlsl"
+#include "include/Descriptors.hlsl"
+
+#define VRS_THREADS 8
+#define VRS_FULL_RATE 0  // D3D12_SHADING_RATE_1X1
+
+groupshared uint TileNeedsFullRate;
+
+// Dispatch: (NumTilesX, NumTilesY, 1), one thread group per shading rate image tile
+[numthreads(VRS_THREADS, VRS_THREADS, 1)]
+void CS(uint3 GroupID : SV_GroupID, uint3 GroupThreadID : SV_GroupThreadID, uint GroupIndex : SV_GroupIndex)
+{
+    RWTexture2D<float4> GBufferA = GetRWTex2D(GBUFFERA_INDEX);
+
+    uint2 dimensions = GetRenderResolution();
+
+    if (GroupIndex == 0) TileNeedsFullRate = 0;
+    GroupMemoryBarrierWithGroupSync();
+
+    // Lit pixels and visualizations are composited at full rate, the sky (post processed only) is constant
+    bool fullRate = false;
+    for (uint y = GroupThreadID.y; y < VRS_TILE_SIZE; y += VRS_THREADS)
+    {
+        for (uint x = GroupThreadID.x; x < VRS_TILE_SIZE; x += VRS_THREADS)
+        {
+            uint2 pixel = (GroupID.xy * VRS_TILE_SIZE) + uint2(x, y);
+            if (any(pixel >= dimensions)) continue;
+
+            float flag = GBufferA.Load(pixel).a;
+            fullRate = fullRate || (abs(flag - COMPOSITE_FLAG_POSTPROCESS_PIXEL) > 0.1f);
+        }
+    }
+    if (WaveActiveAnyTrue(fullRate) && WaveIsFirstLane()) InterlockedOr(TileNeedsFullRate, 1);
+    GroupMemoryBarrierWithGroupSync();
+
+    if (GroupIndex == 0) GetCompositeShadingRate()[GroupID.xy] = TileNeedsFullRate ? VRS_FULL_RATE : VRS_COARSE_RATE;
+}
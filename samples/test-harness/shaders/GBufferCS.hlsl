@@ -12,11 +12,14 @@
 #include "include/Descriptors.hlsl"
 #include "include/InlineRayTracingCommon.hlsl"
 #include "include/InlineLighting.hlsl"
+#include "include/VisibilityBuffer.hlsl"
+#include "include/GBufferTiles.hlsl"
 
-[numthreads(8, 8, 1)]
-void CS(uint3 GroupID : SV_GroupID, uint3 GroupThreadID : SV_GroupThreadID, uint3 DispatchThreadID : SV_DispatchThreadID)
+/**
+ * Traces the primary ray of the pixel and writes the GBuffer. Returns true when the ray hits geometry.
+ */
+bool TracePrimaryRay(uint2 LaunchIndex)
 {
-    uint2 LaunchIndex = DispatchThreadID.xy;
     uint2 LaunchDimensions;
 
     // Get the lights
@@ -28,10 +31,10 @@ void CS(uint3 GroupID : SV_GroupID, uint3 GroupThreadID : SV_GroupThreadID, uint
     RWTexture2D<float4> GBufferC = GetRWTex2D(GBUFFERC_INDEX);
     RWTexture2D<float4> GBufferD = GetRWTex2D(GBUFFERD_INDEX);
     RaytracingAccelerationStructure SceneTLAS = GetAccelerationStructure(SCENE_TLAS_INDEX);
-    GBufferA.GetDimensions(LaunchDimensions.x, LaunchDimensions.y);
+    LaunchDimensions = GetRenderResolution();
 
     // Early exit for out-of-bounds threads
-    if (LaunchIndex.x >= LaunchDimensions.x || LaunchIndex.y >= LaunchDimensions.y) return;
+    if (LaunchIndex.x >= LaunchDimensions.x || LaunchIndex.y >= LaunchDimensions.y) return false;
 
     // Setup the primary ray
     RayDesc ray = (RayDesc)0;
@@ -39,15 +42,8 @@ void CS(uint3 GroupID : SV_GroupID, uint3 GroupThreadID : SV_GroupThreadID, uint
     ray.TMin = 0.f;
     ray.TMax = 1e27f;
 
-    // Pixel coordinates, remapped to [-1, 1] with y-direction flipped to match world-space
-    // Camera basis, adjusted for the aspect ratio and vertical field of view
-    float  px = (((float)LaunchIndex.x + 0.5f) / (float)LaunchDimensions.x) * 2.f - 1.f;
-    float  py = (((float)LaunchIndex.y + 0.5f) / (float)LaunchDimensions.y) * -2.f + 1.f;
-    float3 right = GetCamera().aspect * GetCamera().tanHalfFovY * GetCamera().right;
-    float3 up = GetCamera().tanHalfFovY * GetCamera().up;
-
     // Compute the primary ray direction
-    ray.Direction = (px * right) + (py * up) + GetCamera().forward;
+    ray.Direction = GetPrimaryRayDirection(LaunchIndex, LaunchDimensions);
 
     RayQuery<RAY_FLAG_CULL_BACK_FACING_TRIANGLES> RQuery;
     RQuery.TraceRayInline(SceneTLAS,
@@ -69,20 +65,65 @@ void CS(uint3 GroupID : SV_GroupID, uint3 GroupThreadID : SV_GroupThreadID, uint
 
         // Write the GBuffer
         GBufferA[LaunchIndex] = float4(payload.albedo, COMPOSITE_FLAG_LIGHT_PIXEL);
+    #if GBUFFER_VISIBILITY
+        GetGBufferVisibility()[LaunchIndex] = VisibilityPack(RQuery.CommittedInstanceIndex(), RQuery.CommittedGeometryIndex(), RQuery.CommittedPrimitiveIndex());
+    #else
         GBufferB[LaunchIndex] = float4(payload.worldPosition, payload.hitT);
         GBufferC[LaunchIndex] = float4(payload.normal, 1.f);
+    #endif
         GBufferD[LaunchIndex] = float4(diffuse, 1.f);
+        return true;
     }
     else
     {
         // Convert albedo to sRGB before storing
         GBufferA[LaunchIndex] = float4(LinearToSRGB(GetGlobalConst(app, skyRadiance)), COMPOSITE_FLAG_POSTPROCESS_PIXEL);
+    #if GBUFFER_VISIBILITY
+        GetGBufferVisibility()[LaunchIndex] = uint2(0, GBUFFER_VISIBILITY_MISS);
+    #else
         GBufferB[LaunchIndex].w = -1.f;
 
         // Optional clear writes. Not necessary for final image, but
         // useful for image comparisons during regression testing.
         GBufferB[LaunchIndex] = float4(0.f, 0.f, 0.f, -1.f);
         GBufferC[LaunchIndex] = float4(0.f, 0.f, 0.f, 0.f);
+    #endif
         GBufferD[LaunchIndex] = float4(0.f, 0.f, 0.f, 0.f);
+        return false;
     }
 }
+
+#if GBUFFER_TILES
+groupshared uint GBufferTileHits;
+
+/**
+ * Appends the thread group's tile to the list when any of its pixels has a primary ray hit.
+ * Called by every thread of the group, in uniform control flow.
+ */
+void GBufferTilesClassify(uint2 tile, uint threadIndexInGroup, bool hit)
+{
+    if (threadIndexInGroup == 0) GBufferTileHits = 0;
+    GroupMemoryBarrierWithGroupSync();
+
+    if (WaveActiveAnyTrue(hit) && WaveIsFirstLane()) InterlockedOr(GBufferTileHits, 1);
+    GroupMemoryBarrierWithGroupSync();
+
+    if (threadIndexInGroup == 0 && GBufferTileHits != 0)
+    {
+        uint index;
+        GetGBufferTiles().InterlockedAdd(GBUFFER_TILES_COUNT_OFFSET, 1, index);
+        GetGBufferTiles().Store(GBUFFER_TILES_LIST_OFFSET + (index * 4), tile.x | (tile.y << 16));
+    }
+}
+#endif
+
+[numthreads(GBUFFER_TILE_SIZE, GBUFFER_TILE_SIZE, 1)]
+void CS(uint3 GroupID : SV_GroupID, uint GroupIndex : SV_GroupIndex, uint3 DispatchThreadID : SV_DispatchThreadID)
+{
+    bool hit = TracePrimaryRay(DispatchThreadID.xy);
+
+#if GBUFFER_TILES
+    // List the tile for the indirect lighting and RTAO passes when it holds any geometry
+    GBufferTilesClassify(GroupID.xy, GroupIndex, hit);
+#endif
+}
@@ -0,0 +1,29 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+// ============================================================================
+// GBufferTileArgsCS - Build the indirect dispatch over the GBuffer geometry tiles
+// ============================================================================
+//
+// Runs as a single thread after GBufferCS: writes the dispatch arguments (one
+// thread group per listed tile) and resets the append counter for the next frame.
+// ============================================================================
+
+#include "include/GBufferTiles.hlsl"
+
+[numthreads(1, 1, 1)]
+void CS()
+{
+    RWByteAddressBuffer GBufferTiles = GetGBufferTiles();
+
+    uint count = GBufferTiles.Load(GBUFFER_TILES_COUNT_OFFSET);
+    GBufferTiles.Store3(GBUFFER_TILES_ARGS_OFFSET, uint3(count, 1, 1));
+    GBufferTiles.Store(GBUFFER_TILES_COUNT_OFFSET, 0);
+}
@@ -31,19 +31,83 @@
     #error Required define THGP_DIM_Y is not defined for IndirectCS.hlsl!
 #endif
 
+// DDGI_CLIPMAP may be passed in as a define at shader compilation time.
+// With DDGI_CLIPMAP, the DDGIVolumes are the levels of a DDGIClipmap (finest first)
+// and the gather samples the finest level that covers the surface.
+// Ex: DDGI_CLIPMAP 1
+#ifndef DDGI_CLIPMAP
+    #define DDGI_CLIPMAP 0
+#endif
+
+// DDGI_BLEND_VOLUMES may be passed in as a define at shader compilation time.
+// With DDGI_BLEND_VOLUMES, the gather blends the DDGIVolumes that cover the surface in their blend order
+// (higher budget priority first, then finer probe spacing, see the bounds' blendOrder) and stops
+// once the blend weights saturate, the coarser volumes behind them aren't sampled.
+// Ex: DDGI_BLEND_VOLUMES 1
+#ifndef DDGI_BLEND_VOLUMES
+    #define DDGI_BLEND_VOLUMES 0
+#endif
+
+// GBUFFER_TILES may be passed in as a define at shader compilation time.
+// With GBUFFER_TILES, the dispatch is indirect with one thread group per GBuffer tile that holds geometry
+// (see GBufferTiles.hlsl), and the thread group covers the tile's output texels:
+// THGP_DIM_X = THGP_DIM_Y = GBUFFER_TILE_SIZE / FINAL_GATHER_DOWNSCALE.
+// Ex: GBUFFER_TILES 1
+
+// RADIANCE_CACHE_GATHER may be passed in as a define at shader compilation time.
+// With RADIANCE_CACHE_GATHER, each pixel first reads the indirect irradiance of the world-space
+// radiance cache cell that contains it. The DDGIVolumes are only sampled when the cell is missing
+// or has fewer than RADIANCE_CACHE_GATHER_CONFIDENT_FRAMES frames of history, and blended by that confidence.
+// Ex: RADIANCE_CACHE_GATHER 1
+#ifndef RADIANCE_CACHE_GATHER
+    #define RADIANCE_CACHE_GATHER 0
+#endif
+
+#ifndef RADIANCE_CACHE_GATHER_CONFIDENT_FRAMES
+    #define RADIANCE_CACHE_GATHER_CONFIDENT_FRAMES 8
+#endif
+
 // -------------------------------------------------------------------------------------------
 
 #include "include/Common.hlsl"
 #include "include/Descriptors.hlsl"
 #include "include/SpatialHash.hlsl"
+#include "include/VisibilityBuffer.hlsl"
+#include "include/GBufferTiles.hlsl"
 
 #include "../../../rtxgi-sdk/shaders/ddgi/include/DDGIRootConstants.hlsl"
 #include "../../../rtxgi-sdk/shaders/ddgi/Irradiance.hlsl"
 
 // ---[ Compute Shader ]---
 
+/**
+ * Get a volume's bounds, the only constants read for the volumes that don't cover the surface.
+ * The Vulkan path has no DDGIVolume bounds buffer and takes them from the volume's constants.
+ */
+DDGIVolumeBoundsGPU GetVolumeBounds(uint VolumeIndex)
+{
+#ifdef __spirv__
+    StructuredBuffer<DDGIVolumeDescGPUPacked> DDGIVolumes = GetDDGIVolumeConstants(GetDDGIVolumeConstantsIndex());
+    return GetDDGIVolumeBoundsGPU(UnpackDDGIVolumeDescGPU(DDGIVolumes[VolumeIndex]));
+#else
+    return GetDDGIVolumeBounds()[VolumeIndex];
+#endif
+}
 
-float3 GetVolumeIrradiance(float3 WorldPos, float3 Normal, float3 ViewDir, float VolumeIndex)
+/**
+ * Get the index of the volume blended at the given position of the blend order.
+ * The Vulkan path has no DDGIVolume bounds buffer and blends the volumes in index order.
+ */
+uint GetBlendOrderVolumeIndex(uint OrderIndex)
+{
+#ifdef __spirv__
+    return OrderIndex;
+#else
+    return GetDDGIVolumeBounds()[OrderIndex].blendOrder;
+#endif
+}
+
+float3 SampleVolumeIrradiance(float3 WorldPos, float3 Normal, float3 ViewDir, float VolumeIndex)
 {
     StructuredBuffer<DDGIVolumeDescGPUPacked> DDGIVolumes = GetDDGIVolumeConstants(GetDDGIVolumeConstantsIndex());
     StructuredBuffer<DDGIVolumeResourceIndices> DDGIVolumeBindless = GetDDGIVolumeResourceIndices(GetDDGIVolumeResourceIndicesIndex());
@@ -59,23 +123,28 @@ float3 GetVolumeIrradiance(float3 WorldPos, float3 Normal, float3 ViewDir, float
     resources.probeDistance = GetTex2DArray(resourceIndices.probeDistanceSRVIndex);
     resources.probeData = GetTex2DArray(resourceIndices.probeDataSRVIndex);
     resources.bilinearSampler = GetBilinearWrapSampler();
+#if RTXGI_DDGI_PROBE_STATE_BITS || RTXGI_DDGI_PROBE_VISIBILITY_MASK
+    resources.probeSchedule = GetDDGIProbeSchedule(resourceIndices.probeScheduleUAVIndex);
+#endif
 
-    // Get the blend weight for this volume's contribution to the surface
-    float blendWeight = DDGIGetVolumeBlendWeight(WorldPos, volume);
-    float3 IrradianceOut = (float3)0.0f;
-    //if(blendWeight > 0)
-    {
-        // Get irradiance for the world-space position in the volume
-        IrradianceOut = DDGIGetVolumeIrradiance(
-            WorldPos,
-            surfaceBias,
-            Normal,
-            volume,
-            resources);
-            
-        IrradianceOut *= blendWeight;
-    }
-    return IrradianceOut;
+    // Get irradiance for the world-space position in the volume
+    return DDGIGetVolumeIrradianceFast(
+        WorldPos,
+        surfaceBias,
+        Normal,
+        volume,
+        resources);
+}
+
+float3 GetVolumeIrradiance(float3 WorldPos, float3 Normal, float3 ViewDir, float VolumeIndex)
+{
+    // Get the blend weight for this volume's contribution to the surface from the volume's bounds
+    float blendWeight = DDGIGetVolumeBlendWeight(WorldPos, GetVolumeBounds((uint)VolumeIndex));
+
+    // Early out: the volume doesn't cover the surface, skip the constants and probe lookups
+    if (blendWeight <= 0) return (float3)0.0f;
+
+    return SampleVolumeIrradiance(WorldPos, Normal, ViewDir, VolumeIndex) * blendWeight;
 }
 
 float3 GetCascadedIrradiance(float3 Pos, float3 Normal, float3 CameraPos, float BlendableStartDist)
@@ -98,19 +167,80 @@ float3 GetCascadedIrradiance(float3 Pos, float3 Normal, float3 CameraPos, float
     return IrradianceOut;
 }
 
-[numthreads(THGP_DIM_X, THGP_DIM_Y, 1)]
-void CS(uint3 DispatchThreadID : SV_DispatchThreadID)
+float3 GetClipmapIrradiance(float3 Pos, float3 Normal, float3 CameraPos)
+{
+    // Find the finest clipmap level that covers the surface
+    float NextLevelWeight;
+#ifdef __spirv__
+    uint Level = DDGIGetClipmapLevel(Pos, GetDDGIVolumeConstants(GetDDGIVolumeConstantsIndex()), 0, RTXGI_DDGI_NUM_VOLUMES, NextLevelWeight);
+#else
+    uint Level = DDGIGetClipmapLevel(Pos, GetDDGIVolumeBounds(), 0, RTXGI_DDGI_NUM_VOLUMES, NextLevelWeight);
+#endif
+
+    float3 ViewDir = normalize(CameraPos - Pos);
+    float3 IrradianceOut = GetVolumeIrradiance(Pos, Normal, ViewDir, Level);
+
+    // Blend toward the next level across the outermost probe cell of the level
+    if (NextLevelWeight > 0.0f)
+    {
+        float3 IrradianceNext = GetVolumeIrradiance(Pos, Normal, ViewDir, Level + 1);
+        IrradianceOut = lerp(IrradianceOut, IrradianceNext, NextLevelWeight);
+    }
+    return IrradianceOut;
+}
+
+float3 GetBlendedIrradiance(float3 Pos, float3 Normal, float3 CameraPos)
+{
+    float3 ViewDir = normalize(CameraPos - Pos);
+    float3 IrradianceOut = float3(0.f, 0.f, 0.f);
+
+    // Blend the volumes that cover the surface in blend order, until their weights sum to 1
+    float WeightSum = 0.f;
+    for (uint OrderIndex = 0; OrderIndex < RTXGI_DDGI_NUM_VOLUMES && WeightSum < 1.f; OrderIndex++)
+    {
+        uint VolumeIndex = GetBlendOrderVolumeIndex(OrderIndex);
+
+        // Skip the constants and probe lookups of the volumes that don't cover the surface
+        float BlendWeight = DDGIGetVolumeBlendWeight(Pos, GetVolumeBounds(VolumeIndex));
+        if (BlendWeight <= 0.f) continue;
+
+        float Weight = min(BlendWeight, 1.f - WeightSum);
+        IrradianceOut += SampleVolumeIrradiance(Pos, Normal, ViewDir, VolumeIndex) * Weight;
+        WeightSum += Weight;
+    }
+
+    // Surfaces at the edge of every volume that covers them fade out like a single volume's edge
+    return IrradianceOut;
+}
+
+#if RADIANCE_CACHE_GATHER
+/**
+ * Read the indirect irradiance of the radiance cache cell containing the surface.
+ * Confidence is 0 when the cell isn't cached, and reaches 1 after RADIANCE_CACHE_GATHER_CONFIDENT_FRAMES shaded frames.
+ */
+float3 GetRadianceCacheIrradiance(float3 Pos, float HitT, out float Confidence)
+{
+    Confidence = 0.f;
+
+    uint HashID = SpatialHashCascadeFind(Pos, HitT, GetCascadeCellRadius(), GetMaxCacheCellCount(), GetCascadeCount(), GetCascadeBaseDistance(), GetRadianceCacheMetadataBuffer());
+    if (HashID == RADIANCE_CACHE_INVALID_SLOT) return float3(0.f, 0.f, 0.f);
+
+    RadianceCacheVisualization Entry = GetRadianceCachingVisualizationBuffer()[HashID];
+    Confidence = saturate((float)Entry.HistoryFrames / RADIANCE_CACHE_GATHER_CONFIDENT_FRAMES);
+    return (Entry.IndirectIrradiance * PI);
+}
+#endif
+
+void GatherIndirectLighting(uint2 texel)
 {
     float3 color = float3(0.f, 0.f, 0.f);
 
     // Get the (bindless) resources
     RWTexture2D<float4> GBufferA = GetRWTex2D(GBUFFERA_INDEX);
-    RWTexture2D<float4> GBufferB = GetRWTex2D(GBUFFERB_INDEX);
-    RWTexture2D<float4> GBufferC = GetRWTex2D(GBUFFERC_INDEX);
     RWTexture2D<float4> DDGIOutput = GetRWTex2D(DDGI_OUTPUT_INDEX);
 
     // Load the albedo and primary ray hit distance
-    float4 albedo = GBufferA.Load(DispatchThreadID.xy * FINAL_GATHER_DOWNSCALE);
+    float4 albedo = GBufferA.Load(texel * FINAL_GATHER_DOWNSCALE);
 
     // Primary ray hit, need to light it
     if (albedo.a > 0.f)
@@ -118,12 +248,46 @@ void CS(uint3 DispatchThreadID : SV_DispatchThreadID)
         // Convert albedo back to linear
         albedo.rgb = SRGBToLinear(albedo.rgb);
 
-        // Load the world position, hit distance, and normal
-        float4 worldPosHitT = GBufferB.Load(DispatchThreadID.xy * FINAL_GATHER_DOWNSCALE);
-        float3 normal = GBufferC.Load(DispatchThreadID.xy * FINAL_GATHER_DOWNSCALE).xyz;
-        
+        // Load (or reconstruct from the visibility buffer) the world position, hit distance, and normal
+        float4 worldPosHitT;
+        float3 normal;
+        GBufferLoadSurface(texel * FINAL_GATHER_DOWNSCALE, worldPosHitT, normal);
+
+        // Read the radiance cache first, the probes only fill in where it isn't confident
+        float3 irradiance = float3(0.f, 0.f, 0.f);
+        float confidence = 0.f;
+    #if RADIANCE_CACHE_GATHER
+        irradiance = GetRadianceCacheIrradiance(worldPosHitT.xyz, worldPosHitT.w, confidence);
+    #endif
+
+        if (confidence < 1.f)
+        {
+        #if DDGI_CLIPMAP
+            float3 probeIrradiance = GetClipmapIrradiance(worldPosHitT.xyz, normal, GetCamera().position);
+        #elif DDGI_BLEND_VOLUMES
+            float3 probeIrradiance = GetBlendedIrradiance(worldPosHitT.xyz, normal, GetCamera().position);
+        #else
+            float3 probeIrradiance = GetCascadedIrradiance(worldPosHitT.xyz, normal, GetCamera().position, 1.0f);
+        #endif
+            irradiance = lerp(probeIrradiance, irradiance, confidence);
+        }
+
         // Compute final color
-        color = (albedo.rgb / PI) * GetCascadedIrradiance(worldPosHitT.xyz, normal, GetCamera().position, 1.0f);
+        color = (albedo.rgb / PI) * irradiance;
     }
-    DDGIOutput[DispatchThreadID.xy] = float4(color, 1.0f);
-}
\ No newline at end of file
+    DDGIOutput[texel] = float4(color, 1.0f);
+}
+
+#if GBUFFER_TILES
+[numthreads(THGP_DIM_X, THGP_DIM_Y, 1)]
+void CS(uint3 GroupID : SV_GroupID, uint3 GroupThreadID : SV_GroupThreadID)
+{
+    GatherIndirectLighting((GBufferTilesGetTile(GroupID.x) * uint2(THGP_DIM_X, THGP_DIM_Y)) + GroupThreadID.xy);
+}
+#else
+[numthreads(THGP_DIM_X, THGP_DIM_Y, 1)]
+void CS(uint3 DispatchThreadID : SV_DispatchThreadID)
+{
+    GatherIndirectLighting(DispatchThreadID.xy);
+}
+#endif
@@ -0,0 +1,78 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#include "include/Descriptors.hlsl"
+#include "include/PathTraceConvergence.hlsl"
+
+#include "../../../rtxgi-sdk/shaders/Common.hlsl"
+
+#define PT_CONVERGENCE_TILE_PIXELS (PT_CONVERGENCE_TILE_SIZE * PT_CONVERGENCE_TILE_SIZE)
+
+groupshared float3 TileSums[PT_CONVERGENCE_TILE_PIXELS];
+groupshared uint TileMinFrames;
+
+// Dispatch: (NumTilesX, NumTilesY, 1), one thread group per tile
+[numthreads(PT_CONVERGENCE_TILE_SIZE, PT_CONVERGENCE_TILE_SIZE, 1)]
+void CS(uint3 GroupID : SV_GroupID, uint3 DispatchThreadID : SV_DispatchThreadID, uint GroupIndex : SV_GroupIndex)
+{
+    RWTexture2D<float4> PTAccumulation = GetRWTex2D(PT_ACCUMULATION_INDEX);
+    RWTexture2D<float4> PTVariance = GetRWTex2D(PT_VARIANCE_INDEX);
+    RWByteAddressBuffer PTConvergence = GetPTConvergence();
+
+    uint2 dimensions;
+    PTAccumulation.GetDimensions(dimensions.x, dimensions.y);
+
+    // Reset the unconverged tile count of the next frame (read back from the GPU before this frame's dispatch)
+    uint countAddress = (GetGlobalConst(app, frameNumber) & 1) * 4;
+    if (all(GroupID.xy == 0) && GroupIndex == 0) PTConvergence.Store(countAddress ^ 4, 0);
+
+    if (GroupIndex == 0) TileMinFrames = 0xFFFFFFFF;
+    GroupMemoryBarrierWithGroupSync();
+
+    // Variance of the pixel's accumulated mean, from the variance of its frame luminances
+    float3 sums = float3(0.f, 0.f, 0.f);
+    uint2 pixel = DispatchThreadID.xy;
+    if (all(pixel < dimensions))
+    {
+        float4 accumulation = PTAccumulation[pixel];
+        float2 moments = PTVariance[pixel].xy;
+
+        float numFrames = moments.y;
+        float mean = (accumulation.w > 0.f) ? RTXGILinearRGBToLuminance(accumulation.xyz / accumulation.w) : 0.f;
+
+        float variance = 0.f;
+        if (numFrames > 1.f)
+        {
+            variance = max((moments.x / numFrames) - (mean * mean), 0.f) * (numFrames / (numFrames - 1.f));
+            variance /= numFrames;
+        }
+
+        sums = float3(variance, mean, 1.f);
+        InterlockedMin(TileMinFrames, (uint)numFrames);
+    }
+    TileSums[GroupIndex] = sums;
+    GroupMemoryBarrierWithGroupSync();
+
+    // Sum the tile's pixels (the edge tiles are partial)
+    for (uint stride = (PT_CONVERGENCE_TILE_PIXELS / 2); stride > 0; stride >>= 1)
+    {
+        if (GroupIndex < stride) TileSums[GroupIndex] += TileSums[GroupIndex + stride];
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    if (GroupIndex != 0) return;
+
+    // Relative error of the tile's mean, tiles that haven't accumulated enough frames are not converged
+    float relativeError = sqrt(TileSums[0].x / TileSums[0].z) / max(TileSums[0].y / TileSums[0].z, 0.001f);
+    bool converged = (TileMinFrames >= PT_CONVERGENCE_MIN_FRAMES) && (relativeError <= PTConvergenceThreshold());
+
+    PTConvergence.Store(PT_CONVERGENCE_TILE_FLAGS_OFFSET + (PTConvergenceGetTileIndex(pixel, dimensions.x) * 4), converged ? 1 : 0);
+    if (!converged) PTConvergence.InterlockedAdd(countAddress, 1);
+}
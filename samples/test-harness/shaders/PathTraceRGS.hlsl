@@ -10,6 +10,8 @@
 
 #include "include/Descriptors.hlsl"
 #include "include/Lighting.hlsl"
+#include "include/PathTraceConvergence.hlsl"
+#include "include/PathTraceRadianceCache.hlsl"
 #include "include/Random.hlsl"
 #include "include/RayTracing.hlsl"
 
@@ -22,6 +24,11 @@ float3 TracePath(RayDesc ray, uint seed)
     float3 throughput = float3(1.f, 1.f, 1.f);
     float3 color = float3(0.f, 0.f, 0.f);
 
+#if PT_RADIANCE_CACHE_BOUNCE
+    PTRadianceCachePath cachePath;
+    PTRadianceCacheBegin(cachePath, DispatchRaysDimensions().y);
+#endif
+
     // Get the lights and scene acceleration structure
     StructuredBuffer<Light> Lights = GetLights();
     RaytracingAccelerationStructure SceneTLAS = GetAccelerationStructure(SCENE_TLAS_INDEX);
@@ -45,7 +52,7 @@ float3 TracePath(RayDesc ray, uint seed)
                 ray,
                 packedPayload,
                 hit);
-            NvReorderThread(hit, 0, 0);
+            NvReorderThread(hit, GetReorderCoherenceHint(hit), SER_HINT_BITS);
             NvInvokeHitObject(SceneTLAS, hit, packedPayload);
         }
         else
@@ -82,6 +89,16 @@ float3 TracePath(RayDesc ray, uint seed)
             break;
         }
 
+    #if PT_RADIANCE_CACHE_BOUNCE
+        // End the path in the radiance cache once its footprint covers a cell
+        float3 cachedRadiance;
+        if (PTRadianceCacheAddVertex(cachePath, bounceIndex, payload.worldPosition, payload.hitT, color, throughput, cachedRadiance))
+        {
+            color += cachedRadiance * throughput;
+            break;
+        }
+    #endif
+
         // Direct Lighting
         float3 diffuse = DirectDiffuseLighting(payload, GetGlobalConst(pt, rayNormalBias), GetGlobalConst(pt, rayViewBias), SceneTLAS, Lights);
 
@@ -111,6 +128,11 @@ float3 TracePath(RayDesc ray, uint seed)
         // End the path if the throughput is close to zero
         if (RTXGIMaxComponent(throughput) <= 0.005f) break;
     }
+
+#if PT_RADIANCE_CACHE_BOUNCE
+    // Update the cache cells of the path's vertices
+    PTRadianceCacheEnd(cachePath, color);
+#endif
     return color;
 }
 
@@ -131,10 +153,13 @@ void RayGen()
     RWTexture2D<float4> PTAccumulation = GetRWTex2D(PT_ACCUMULATION_INDEX);
     Texture2D<float4> BlueNoise = GetTex2D(BLUE_NOISE_INDEX);
 
+    // Converged pixels keep their accumulated color
+    bool converged = PTConvergenceIsPixelConverged(LaunchIndex, LaunchDimensions.x);
+
     // Trace the paths for this pixel
     float3 color = float3(0.f, 0.f, 0.f);
     float2 offsets = float2(0.5f, 0.5f);
-    for (int sampleIndex = 0; sampleIndex < GetPTSamplesPerPixel(); sampleIndex++)
+    for (int sampleIndex = 0; sampleIndex < (converged ? 0 : GetPTSamplesPerPixel()); sampleIndex++)
     {
         // Setup the ray
         RayDesc ray = (RayDesc)0;
@@ -169,10 +194,18 @@ void RayGen()
     // Progressive Accumulation
     float numPaths = (float)GetPTSamplesPerPixel();
 
-    if (GetGlobalConst(app, frameNumber) > 1)
+    if (converged)
+    {
+        color = PTAccumulation[LaunchIndex.xy].xyz;
+        numPaths = PTAccumulation[LaunchIndex.xy].w;
+    }
+    else if (GetGlobalConst(app, frameNumber) > 1)
     {
         if (GetPTProgressive())
         {
+            // Update the pixel's variance estimate with this frame's color
+            PTConvergenceAccumulate(LaunchIndex, color / numPaths);
+
             // Read the previous color and number of paths
             float3 previousColor = PTAccumulation[LaunchIndex.xy].xyz;
             float  numPreviousPaths = PTAccumulation[LaunchIndex.xy].w;
@@ -189,6 +222,7 @@ void RayGen()
     {
         // Clear the accumulation buffer when moving
         PTAccumulation[LaunchIndex.xy] = float4(0.f, 0.f, 0.f, 0.f);
+        PTConvergenceClear(LaunchIndex);
     }
 
     // Normalize
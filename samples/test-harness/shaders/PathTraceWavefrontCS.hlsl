@@ -0,0 +1,503 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+// ============================================================================
+// PathTraceWavefrontCS - Wavefront (multi-kernel) reference path tracer
+// ============================================================================
+//
+// Splits the path tracing megakernel (PathTraceCS.hlsl) into one kernel per
+// path tracing stage, with the paths in flight passed between the kernels in
+// ray queues. Each bounce of a chunk of PT_WAVEFRONT_MAX_PATHS paths runs:
+//   1. ExtendCS:    trace the queued rays, append the hits to the hit queue
+//                   and count them per material sort bin (misses add sky radiance)
+//   2. SortCS:      (1 group) convert the bin counts to exclusive offsets
+//   3. ScatterCS:   order the hit queue by material
+//   4. ShadeCS:     evaluate the hit materials, queue the next bounce's rays
+//   5. ConnectCS:   trace the shadow rays of the hits (direct lighting)
+// GenerateCS queues the primary rays of each sample and ResolveCS accumulates
+// and post processes the chunk's paths once all samples are traced.
+//
+// ExtendCS, ScatterCS, ShadeCS, and ConnectCS use persistent threads: a fixed
+// number of thread groups fetch batches of queue entries (one per wave) until
+// the queue is exhausted, so the dispatches don't depend on the queue sizes.
+//
+// Path index p of the chunk is pixel (pt_wavefrontFirstPath + p).
+// Queues (uint): [0, MAX_PATHS)             ray queue (paths to extend)
+//                [MAX_PATHS, 2 * MAX_PATHS) hit queue
+//                [2 * MAX_PATHS, 3 * MAX_PATHS) hit queue, sorted by material
+// Counters (bytes): see the PT_WAVEFRONT_COUNTERS_* defines.
+// Must match PathTracing_D3D12.cpp.
+// ============================================================================
+
+#include "include/Descriptors.hlsl"
+#include "include/InlineLighting.hlsl"
+#include "include/InlineRayTracingCommon.hlsl"
+#include "include/PathTraceConvergence.hlsl"
+#include "include/Random.hlsl"
+
+#include "../../../rtxgi-sdk/shaders/Common.hlsl"
+
+#ifndef PT_WAVEFRONT_MAX_PATHS
+#define PT_WAVEFRONT_MAX_PATHS (256 * 1024)
+#endif
+
+#ifndef PT_WAVEFRONT_MAX_BOUNCES
+#define PT_WAVEFRONT_MAX_BOUNCES 32
+#endif
+
+#define PT_WAVEFRONT_GROUP_SIZE 64
+#define PT_WAVEFRONT_SORT_BIN_COUNT 256
+
+#define PT_WAVEFRONT_RAY_QUEUE 0
+#define PT_WAVEFRONT_HIT_QUEUE PT_WAVEFRONT_MAX_PATHS
+#define PT_WAVEFRONT_SORTED_HIT_QUEUE (2 * PT_WAVEFRONT_MAX_PATHS)
+
+// Counters layout (bytes)
+#define PT_WAVEFRONT_COUNTERS_BIN_COUNTS_OFFSET 0
+#define PT_WAVEFRONT_COUNTERS_BIN_OFFSETS_OFFSET (PT_WAVEFRONT_SORT_BIN_COUNT * 4)
+#define PT_WAVEFRONT_COUNTERS_BOUNCES_OFFSET (PT_WAVEFRONT_SORT_BIN_COUNT * 8)
+#define PT_WAVEFRONT_COUNTERS_BOUNCE_STRIDE 32
+
+// Counters of a bounce (bytes, from the bounce's start)
+#define PT_WAVEFRONT_BOUNCE_RAY_COUNT 0         // Entries in the ray queue
+#define PT_WAVEFRONT_BOUNCE_HIT_COUNT 4         // Entries in the hit queue
+#define PT_WAVEFRONT_BOUNCE_EXTEND_WORK 8       // Persistent thread work counters
+#define PT_WAVEFRONT_BOUNCE_SCATTER_WORK 12
+#define PT_WAVEFRONT_BOUNCE_SHADE_WORK 16
+#define PT_WAVEFRONT_BOUNCE_CONNECT_WORK 20
+
+// ---[ Helper Functions ]---
+
+uint GetBounceCounterAddress(uint bounce, uint counter)
+{
+    return PT_WAVEFRONT_COUNTERS_BOUNCES_OFFSET + (bounce * PT_WAVEFRONT_COUNTERS_BOUNCE_STRIDE) + counter;
+}
+
+uint GetCurrentBounceCounterAddress(uint counter)
+{
+    return GetBounceCounterAddress(GetGlobalConst(pt, wavefrontBounce), counter);
+}
+
+/**
+ * Number of paths in the current chunk.
+ */
+uint GetChunkNumPaths()
+{
+    uint2 dimensions;
+    GetRWTex2D(PT_OUTPUT_INDEX).GetDimensions(dimensions.x, dimensions.y);
+    return min(PT_WAVEFRONT_MAX_PATHS, (dimensions.x * dimensions.y) - GetGlobalConst(pt, wavefrontFirstPath));
+}
+
+uint2 GetPathPixel(uint pathIndex, uint width)
+{
+    uint pixelIndex = GetGlobalConst(pt, wavefrontFirstPath) + pathIndex;
+    return uint2(pixelIndex % width, pixelIndex / width);
+}
+
+/**
+ * Persistent threads: fetch the next queue entry of the thread, one batch (of the active lanes) per wave.
+ */
+uint FetchWork(uint workCounterAddress)
+{
+    uint base = 0;
+    uint count = WaveActiveCountBits(true);
+    if (WaveIsFirstLane()) GetPTWavefrontCounters().InterlockedAdd(workCounterAddress, count, base);
+    return WaveReadLaneFirst(base) + WavePrefixCountBits(true);
+}
+
+// ---[ Compute Shader Entry Points ]---
+
+/**
+ * Sets up the primary rays of a sample and resets the queue counters.
+ * Dispatch: (DivRoundUp(NumChunkPaths, 64), 1, 1)
+ */
+[numthreads(PT_WAVEFRONT_GROUP_SIZE, 1, 1)]
+void GenerateCS(uint3 DispatchThreadID : SV_DispatchThreadID)
+{
+    uint pathIndex = DispatchThreadID.x;
+    uint numPaths = GetChunkNumPaths();
+
+    RWByteAddressBuffer Counters = GetPTWavefrontCounters();
+
+    // Reset the material sort bins and the bounce counters, the first bounce extends every path
+    if (pathIndex < PT_WAVEFRONT_SORT_BIN_COUNT)
+    {
+        Counters.Store(PT_WAVEFRONT_COUNTERS_BIN_COUNTS_OFFSET + (pathIndex * 4), 0);
+    }
+    if (pathIndex < (PT_WAVEFRONT_MAX_BOUNCES * PT_WAVEFRONT_COUNTERS_BOUNCE_STRIDE / 4))
+    {
+        Counters.Store(PT_WAVEFRONT_COUNTERS_BOUNCES_OFFSET + (pathIndex * 4), (pathIndex == 0) ? numPaths : 0);
+    }
+
+    if (pathIndex >= numPaths) return;
+
+    uint2 LaunchDimensions;
+    GetRWTex2D(PT_OUTPUT_INDEX).GetDimensions(LaunchDimensions.x, LaunchDimensions.y);
+    uint2 LaunchIndex = GetPathPixel(pathIndex, LaunchDimensions.x);
+
+    // Initialize the random seed, advanced once per previous sample (matches PathTraceRGS.hlsl)
+    uint seed = (LaunchIndex.y * LaunchDimensions.x) + LaunchIndex.x;
+    seed *= GetGlobalConst(app, frameNumber);
+
+    float2 offsets = float2(0.5f, 0.5f);
+    if (GetPTAntialiasing())
+    {
+        for (uint sampleIndex = 0; sampleIndex <= GetGlobalConst(pt, wavefrontSample); sampleIndex++)
+        {
+            // Generate offsets in [0, 1]
+            offsets.x = GetRandomNumber(seed);
+            offsets.y = GetRandomNumber(seed);
+        }
+    }
+
+    // Compute the primary ray direction
+    float  halfHeight = GetCamera().tanHalfFovY;
+    float  halfWidth = (GetCamera().aspect * halfHeight);
+    float3 lowerLeftCorner = GetCamera().position - (halfWidth * GetCamera().right) - (halfHeight * GetCamera().up) + GetCamera().forward;
+    float3 horizontal = (2.f * halfWidth) * GetCamera().right;
+    float3 vertical = (2.f * halfHeight) * GetCamera().up;
+
+    float s = ((float)LaunchIndex.x + offsets.x) / (float)LaunchDimensions.x;
+    float t = 1.f - (((float)LaunchIndex.y + offsets.y) / (float)LaunchDimensions.y);
+
+    RWStructuredBuffer<PathTraceWavefrontPath> Paths = GetPTWavefrontPaths();
+
+    PathTraceWavefrontPath path = (PathTraceWavefrontPath)0;
+    path.origin = GetCamera().position;
+    path.direction = (lowerLeftCorner + s * horizontal + t * vertical) - path.origin;
+    path.seed = seed;
+    path.throughput = float3(1.f, 1.f, 1.f);
+
+    // Converged pixels keep their accumulated color, their paths are skipped by ExtendCS
+    if (PTConvergenceIsPixelConverged(LaunchIndex, LaunchDimensions.x)) path.throughput = float3(0.f, 0.f, 0.f);
+
+    path.radiance = (GetGlobalConst(pt, wavefrontSample) > 0) ? Paths[pathIndex].radiance : float3(0.f, 0.f, 0.f);
+    Paths[pathIndex] = path;
+
+    GetPTWavefrontQueues()[PT_WAVEFRONT_RAY_QUEUE + pathIndex] = pathIndex;
+}
+
+/**
+ * Traces the queued rays (closest hit). Hits are appended to the hit queue and counted per material sort bin.
+ * Dispatch: persistent threads
+ */
+[numthreads(PT_WAVEFRONT_GROUP_SIZE, 1, 1)]
+void ExtendCS()
+{
+    RWByteAddressBuffer Counters = GetPTWavefrontCounters();
+    RWStructuredBuffer<PathTraceWavefrontPath> Paths = GetPTWavefrontPaths();
+    RWStructuredBuffer<PathTraceWavefrontHit> Hits = GetPTWavefrontHits();
+    RWStructuredBuffer<uint> Queues = GetPTWavefrontQueues();
+    RaytracingAccelerationStructure SceneTLAS = GetAccelerationStructure(SCENE_TLAS_INDEX);
+
+    uint numRays = Counters.Load(GetCurrentBounceCounterAddress(PT_WAVEFRONT_BOUNCE_RAY_COUNT));
+    for (;;)
+    {
+        uint queueIndex = FetchWork(GetCurrentBounceCounterAddress(PT_WAVEFRONT_BOUNCE_EXTEND_WORK));
+        if (WaveReadLaneFirst(queueIndex) >= numRays) break;
+        if (queueIndex >= numRays) continue;
+
+        uint pathIndex = Queues[PT_WAVEFRONT_RAY_QUEUE + queueIndex];
+        PathTraceWavefrontPath path = Paths[pathIndex];
+        if (!any(path.throughput)) continue;
+
+        RayDesc ray;
+        ray.Origin = path.origin;
+        ray.Direction = path.direction;
+        ray.TMin = 0.f;
+        ray.TMax = 1e27f;
+
+        RayQuery<RAY_FLAG_CULL_BACK_FACING_TRIANGLES> RQuery;
+        RQuery.TraceRayInline(
+            SceneTLAS,
+            RAY_FLAG_CULL_BACK_FACING_TRIANGLES,
+            0xFF,
+            ray);
+        RQuery.Proceed();
+
+        // Miss, add the sky radiance and end the path
+        if (RQuery.CommittedStatus() != COMMITTED_TRIANGLE_HIT)
+        {
+            Paths[pathIndex].radiance = path.radiance + (GetGlobalConst(app, skyRadiance) * path.throughput);
+            continue;
+        }
+
+        // Sort the hits by material
+        GeometryData geometry;
+        GetGeometryData(RQuery.CommittedInstanceID(), RQuery.CommittedGeometryIndex(), geometry);
+
+        PathTraceWavefrontHit hit = (PathTraceWavefrontHit)0;
+        hit.instanceIndex = RQuery.CommittedInstanceIndex();
+        hit.geometryIndex = RQuery.CommittedGeometryIndex();
+        hit.primitiveIndex = RQuery.CommittedPrimitiveIndex();
+        hit.hitT = RQuery.CommittedRayT();
+        hit.barycentrics = RQuery.CommittedTriangleBarycentrics();
+        hit.materialBin = geometry.materialIndex % PT_WAVEFRONT_SORT_BIN_COUNT;
+        Hits[pathIndex] = hit;
+
+        Counters.InterlockedAdd(PT_WAVEFRONT_COUNTERS_BIN_COUNTS_OFFSET + (hit.materialBin * 4), 1);
+
+        uint hitIndex;
+        Counters.InterlockedAdd(GetCurrentBounceCounterAddress(PT_WAVEFRONT_BOUNCE_HIT_COUNT), 1, hitIndex);
+        Queues[PT_WAVEFRONT_HIT_QUEUE + hitIndex] = pathIndex;
+    }
+}
+
+groupshared uint ScanSums[PT_WAVEFRONT_SORT_BIN_COUNT];
+
+/**
+ * Converts the material sort bin counts to exclusive offsets and resets the counts for the next bounce.
+ * Dispatch: (1, 1, 1)
+ */
+[numthreads(PT_WAVEFRONT_SORT_BIN_COUNT, 1, 1)]
+void SortCS(uint ThreadIndexInGroup : SV_GroupIndex)
+{
+    RWByteAddressBuffer Counters = GetPTWavefrontCounters();
+
+    uint count = Counters.Load(PT_WAVEFRONT_COUNTERS_BIN_COUNTS_OFFSET + (ThreadIndexInGroup * 4));
+    ScanSums[ThreadIndexInGroup] = count;
+    GroupMemoryBarrierWithGroupSync();
+
+    // Inclusive scan of the bin counts (Hillis-Steele)
+    for (uint offset = 1; offset < PT_WAVEFRONT_SORT_BIN_COUNT; offset <<= 1)
+    {
+        uint value = (ThreadIndexInGroup >= offset) ? ScanSums[ThreadIndexInGroup - offset] : 0;
+        GroupMemoryBarrierWithGroupSync();
+        ScanSums[ThreadIndexInGroup] += value;
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    Counters.Store(PT_WAVEFRONT_COUNTERS_BIN_OFFSETS_OFFSET + (ThreadIndexInGroup * 4), ScanSums[ThreadIndexInGroup] - count);
+    Counters.Store(PT_WAVEFRONT_COUNTERS_BIN_COUNTS_OFFSET + (ThreadIndexInGroup * 4), 0);
+}
+
+/**
+ * Writes the hit queue to the sorted hit queue, ordered by material sort bin.
+ * Dispatch: persistent threads
+ */
+[numthreads(PT_WAVEFRONT_GROUP_SIZE, 1, 1)]
+void ScatterCS()
+{
+    RWByteAddressBuffer Counters = GetPTWavefrontCounters();
+    RWStructuredBuffer<uint> Queues = GetPTWavefrontQueues();
+
+    uint numHits = Counters.Load(GetCurrentBounceCounterAddress(PT_WAVEFRONT_BOUNCE_HIT_COUNT));
+    for (;;)
+    {
+        uint hitIndex = FetchWork(GetCurrentBounceCounterAddress(PT_WAVEFRONT_BOUNCE_SCATTER_WORK));
+        if (WaveReadLaneFirst(hitIndex) >= numHits) break;
+        if (hitIndex >= numHits) continue;
+
+        uint pathIndex = Queues[PT_WAVEFRONT_HIT_QUEUE + hitIndex];
+        uint bin = GetPTWavefrontHits()[pathIndex].materialBin;
+
+        uint sortedIndex;
+        Counters.InterlockedAdd(PT_WAVEFRONT_COUNTERS_BIN_OFFSETS_OFFSET + (bin * 4), 1, sortedIndex);
+        Queues[PT_WAVEFRONT_SORTED_HIT_QUEUE + sortedIndex] = pathIndex;
+    }
+}
+
+/**
+ * Evaluates the materials of the sorted hits, stores the surfaces for ConnectCS, and queues the next bounce's rays.
+ * Dispatch: persistent threads
+ */
+[numthreads(PT_WAVEFRONT_GROUP_SIZE, 1, 1)]
+void ShadeCS()
+{
+    RWByteAddressBuffer Counters = GetPTWavefrontCounters();
+    RWStructuredBuffer<PathTraceWavefrontPath> Paths = GetPTWavefrontPaths();
+    RWStructuredBuffer<uint> Queues = GetPTWavefrontQueues();
+    StructuredBuffer<TLASInstance> Instances = GetTLASInstances();
+
+    uint bounce = GetGlobalConst(pt, wavefrontBounce);
+    uint numHits = Counters.Load(GetCurrentBounceCounterAddress(PT_WAVEFRONT_BOUNCE_HIT_COUNT));
+    for (;;)
+    {
+        uint hitIndex = FetchWork(GetCurrentBounceCounterAddress(PT_WAVEFRONT_BOUNCE_SHADE_WORK));
+        if (WaveReadLaneFirst(hitIndex) >= numHits) break;
+        if (hitIndex >= numHits) continue;
+
+        uint pathIndex = Queues[PT_WAVEFRONT_SORTED_HIT_QUEUE + hitIndex];
+        PathTraceWavefrontPath path = Paths[pathIndex];
+        PathTraceWavefrontHit hit = GetPTWavefrontHits()[pathIndex];
+        TLASInstance instance = Instances[hit.instanceIndex];
+
+        // Shade the hit
+        Payload payload = (Payload)0;
+        ShadeTriangleHitInternal(
+            payload,
+            hit.hitT,
+            (instance.instanceID24_Mask8 & 0xFFFFFF),
+            hit.geometryIndex,
+            hit.primitiveIndex,
+            hit.barycentrics,
+            instance.transform,
+            path.direction);
+
+        // Store the surface, with the albedo weighted by the path throughput, for direct lighting
+        PathTraceWavefrontSurface surface = (PathTraceWavefrontSurface)0;
+        surface.worldPosition = payload.worldPosition;
+        surface.normal = payload.normal;
+        surface.shadingNormal = payload.shadingNormal;
+        surface.albedo = payload.albedo * path.throughput;
+        GetPTWavefrontSurfaces()[pathIndex] = surface;
+
+        // Increment the seed
+        path.seed += bounce;
+
+        // Set the ray origin for the next bounce
+        path.origin = payload.worldPosition;
+        path.origin += (payload.normal * GetGlobalConst(pt, rayNormalBias) - (normalize(path.direction) * GetGlobalConst(pt, rayViewBias)));
+
+        // Select random directions on the hemisphere with a cos(theta) distribution and then compute throughput
+        path.direction = GetRandomCosineDirectionOnHemisphere(payload.normal, path.seed);
+
+        // Perfectly diffuse reflectors don't exist in the real world.
+        // Limit the BRDF albedo to a maximum value to account for the energy loss at each bounce.
+        float maxAlbedo = 0.9f;
+        path.throughput *= min(payload.albedo, float3(maxAlbedo, maxAlbedo, maxAlbedo));
+
+        Paths[pathIndex].origin = path.origin;
+        Paths[pathIndex].direction = path.direction;
+        Paths[pathIndex].seed = path.seed;
+        Paths[pathIndex].throughput = path.throughput;
+
+        // End the path after the last bounce or if the throughput is close to zero
+        if ((bounce + 1) >= GetPTNumBounces() || RTXGIMaxComponent(path.throughput) <= 0.005f) continue;
+
+        // Queue the next bounce's ray
+        uint rayIndex;
+        Counters.InterlockedAdd(GetBounceCounterAddress(bounce + 1, PT_WAVEFRONT_BOUNCE_RAY_COUNT), 1, rayIndex);
+        Queues[PT_WAVEFRONT_RAY_QUEUE + rayIndex] = pathIndex;
+    }
+}
+
+/**
+ * Traces the shadow rays of the hits to the lights and adds the direct lighting to the path radiance.
+ * Dispatch: persistent threads
+ */
+[numthreads(PT_WAVEFRONT_GROUP_SIZE, 1, 1)]
+void ConnectCS()
+{
+    RWByteAddressBuffer Counters = GetPTWavefrontCounters();
+    RWStructuredBuffer<PathTraceWavefrontPath> Paths = GetPTWavefrontPaths();
+    RWStructuredBuffer<uint> Queues = GetPTWavefrontQueues();
+    RaytracingAccelerationStructure SceneTLAS = GetAccelerationStructure(SCENE_TLAS_INDEX);
+    StructuredBuffer<Light> Lights = GetLights();
+
+    uint numHits = Counters.Load(GetCurrentBounceCounterAddress(PT_WAVEFRONT_BOUNCE_HIT_COUNT));
+    for (;;)
+    {
+        uint hitIndex = FetchWork(GetCurrentBounceCounterAddress(PT_WAVEFRONT_BOUNCE_CONNECT_WORK));
+        if (WaveReadLaneFirst(hitIndex) >= numHits) break;
+        if (hitIndex >= numHits) continue;
+
+        uint pathIndex = Queues[PT_WAVEFRONT_SORTED_HIT_QUEUE + hitIndex];
+        PathTraceWavefrontSurface surface = GetPTWavefrontSurfaces()[pathIndex];
+
+        Payload payload = (Payload)0;
+        payload.worldPosition = surface.worldPosition;
+        payload.normal = surface.normal;
+        payload.shadingNormal = surface.shadingNormal;
+        payload.albedo = surface.albedo;
+
+        // Direct Lighting using inline visibility rays (the albedo includes the path throughput)
+        Paths[pathIndex].radiance += DirectDiffuseLightingInline(payload, GetGlobalConst(pt, rayNormalBias), GetGlobalConst(pt, rayViewBias), SceneTLAS, Lights);
+    }
+}
+
+/**
+ * Accumulates and post processes the chunk's pixels.
+ * Dispatch: (DivRoundUp(NumChunkPaths, 64), 1, 1)
+ */
+[numthreads(PT_WAVEFRONT_GROUP_SIZE, 1, 1)]
+void ResolveCS(uint3 DispatchThreadID : SV_DispatchThreadID)
+{
+    uint pathIndex = DispatchThreadID.x;
+    if (pathIndex >= GetChunkNumPaths()) return;
+
+    // Get the (bindless) resources
+    RWTexture2D<float4> PTOutput = GetRWTex2D(PT_OUTPUT_INDEX);
+    RWTexture2D<float4> PTAccumulation = GetRWTex2D(PT_ACCUMULATION_INDEX);
+    Texture2D<float4> BlueNoise = GetTex2D(BLUE_NOISE_INDEX);
+
+    uint2 LaunchDimensions;
+    PTOutput.GetDimensions(LaunchDimensions.x, LaunchDimensions.y);
+    uint2 LaunchIndex = GetPathPixel(pathIndex, LaunchDimensions.x);
+
+    float3 color = GetPTWavefrontPaths()[pathIndex].radiance;
+
+    // Progressive Accumulation
+    float numPaths = (float)GetPTSamplesPerPixel();
+
+    if (PTConvergenceIsPixelConverged(LaunchIndex, LaunchDimensions.x))
+    {
+        color = PTAccumulation[LaunchIndex.xy].xyz;
+        numPaths = PTAccumulation[LaunchIndex.xy].w;
+    }
+    else if (GetGlobalConst(app, frameNumber) > 1)
+    {
+        if (GetPTProgressive())
+        {
+            // Update the pixel's variance estimate with this frame's color
+            PTConvergenceAccumulate(LaunchIndex, color / numPaths);
+
+            // Read the previous color and number of paths
+            float3 previousColor = PTAccumulation[LaunchIndex.xy].xyz;
+            float  numPreviousPaths = PTAccumulation[LaunchIndex.xy].w;
+
+            // Add in the new color and number of paths
+            color = (previousColor + color);
+            numPaths = (numPreviousPaths + numPaths);
+
+            // Store to the accumulation buffer
+            PTAccumulation[LaunchIndex.xy] = float4(color, numPaths);
+        }
+    }
+    else
+    {
+        // Clear the accumulation buffer when moving
+        PTAccumulation[LaunchIndex.xy] = float4(0.f, 0.f, 0.f, 0.f);
+        PTConvergenceClear(LaunchIndex);
+    }
+
+    // Normalize
+    color /= numPaths;
+
+    // Get the post processing useFlags
+    uint ppUseFlags = GetGlobalConst(post, useFlags);
+
+    // Exposure
+    if (ppUseFlags & POSTPROCESS_FLAG_USE_EXPOSURE)
+    {
+        color *= GetGlobalConst(post, exposure);
+    }
+
+    // Tonemapping
+    if (ppUseFlags & POSTPROCESS_FLAG_USE_TONEMAPPING)
+    {
+        color = ACESFilm(color);
+    }
+
+    // Dither to reduce SDR color banding
+    if (ppUseFlags & POSTPROCESS_FLAG_USE_DITHER)
+    {
+        color += GetLowDiscrepancyBlueNoise(int2(LaunchIndex), GetGlobalConst(app, frameNumber), 1.f / 256.f, BlueNoise);
+    }
+
+    // Gamma correction
+    if (ppUseFlags & POSTPROCESS_FLAG_USE_GAMMA)
+    {
+        color = LinearToSRGB(color);
+    }
+
+    // Store result
+    PTOutput[LaunchIndex] = float4(color, 1.f);
+}
@@ -9,6 +9,8 @@
 */
 
 #include "include/Descriptors.hlsl"
+#include "include/RTAOTemporal.hlsl"
+#include "include/VisibilityBuffer.hlsl"
 
 static const int c_radius = 5;
 static const int c_paddedPixelWidth = BLOCK_SIZE + c_radius * 2;
@@ -57,9 +59,11 @@ float FilterAO(int2 paddedPixelPos)
 void CS(uint3 GroupID : SV_GroupID, uint GroupIndex : SV_GroupIndex, uint3 GroupThreadID : SV_GroupThreadID, uint3 DispatchThreadID : SV_DispatchThreadID)
 {
     // Get the (bindless) resources
-    RWTexture2D<float4> GBufferB = GetRWTex2D(GBUFFERB_INDEX);
     RWTexture2D<float4> RTAOOutput = GetRWTex2D(RTAO_OUTPUT_INDEX);
-    RWTexture2D<float4> RTAORaw = GetRWTex2D(RTAO_RAW_INDEX);
+
+    // With temporal accumulation, filter the accumulated occlusion
+    uint rtaoInputIndex = RTAOTemporalEnabled() ? (RTAO_HISTORY_INDEX + RTAOTemporalHistoryIndex()) : RTAO_RAW_INDEX;
+    RWTexture2D<float4> RTAOInput = GetRWTex2D(rtaoInputIndex);
 
     // Load hit distance and ambient occlusion for this pixel and share it with the thread group
     {
@@ -82,8 +86,8 @@ void CS(uint3 GroupID : SV_GroupID, uint GroupIndex : SV_GroupIndex, uint3 Group
                 }
                 else
                 {
-                    float distance = GBufferB.Load(srcPixel).w;
-                    float occlusion = RTAORaw.Load(srcPixel).x;
+                    float distance = GBufferLoadWorldPosHitT(uint2(srcPixel)).w;
+                    float occlusion = RTAOInput.Load(srcPixel).x;
                     DistanceAndAO[paddedPixel.x][paddedPixel.y] = float2(distance, occlusion);
                 }
             }
@@ -0,0 +1,92 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#include "include/Common.hlsl"
+#include "include/Descriptors.hlsl"
+#include "include/RTAOTemporal.hlsl"
+#include "include/VisibilityBuffer.hlsl"
+
+[numthreads(BLOCK_SIZE, BLOCK_SIZE, 1)]
+void CS(uint3 DispatchThreadID : SV_DispatchThreadID)
+{
+    int2 pixel = int2(DispatchThreadID.xy);
+    int2 bufferSize = int2(GetGlobalConst(rtao, filterBufferWidth), GetGlobalConst(rtao, filterBufferHeight));
+    if (any(pixel >= bufferSize)) return;
+
+    // Get the (bindless) resources
+    RWTexture2D<float4> GBufferA = GetRWTex2D(GBUFFERA_INDEX);
+    RWTexture2D<float4> RTAORaw = GetRWTex2D(RTAO_RAW_INDEX);
+    RWTexture2D<float4> HistoryIn = GetRWTex2D(RTAO_HISTORY_INDEX + (1 - RTAOTemporalHistoryIndex()));
+    RWTexture2D<float4> HistoryOut = GetRWTex2D(RTAO_HISTORY_INDEX + RTAOTemporalHistoryIndex());
+
+    // Pixels without a primary ray intersection are not occluded and have no history
+    if (GBufferA.Load(pixel).w < COMPOSITE_FLAG_LIGHT_PIXEL)
+    {
+        HistoryOut[pixel] = float4(1.f, 0.f, 0.f, 0.f);
+        return;
+    }
+
+    // Gather the occlusion of the neighbors traced this frame (3x3, on a checkerboard every other pixel)
+    float current = 0.f;
+    float currentCount = 0.f;
+    float neighborMin = 1.f;
+    float neighborMax = 0.f;
+    for (int y = -1; y <= 1; y++)
+    {
+        for (int x = -1; x <= 1; x++)
+        {
+            int2 neighbor = pixel + int2(x, y);
+            if (any(neighbor < 0) || any(neighbor >= bufferSize)) continue;
+            if (!RTAOTemporalIsTracedPixel(neighbor)) continue;
+            if (GBufferA.Load(neighbor).w < COMPOSITE_FLAG_LIGHT_PIXEL) continue;
+
+            float occlusion = RTAORaw.Load(neighbor).x;
+            neighborMin = min(neighborMin, occlusion);
+            neighborMax = max(neighborMax, occlusion);
+
+            // Pixels skipped this frame take the average of their traced (4-connected) neighbors
+            if ((x == 0 && y == 0) || (!RTAOTemporalIsTracedPixel(pixel) && (x == 0 || y == 0)))
+            {
+                current += occlusion;
+                currentCount++;
+            }
+        }
+    }
+    current = (currentCount > 0.f) ? (current / currentCount) : RTAORaw.Load(pixel).x;
+    if (currentCount == 0.f) { neighborMin = 0.f; neighborMax = 1.f; }
+
+    // Reproject the history with last frame's camera
+    float3 worldPos = GBufferLoadWorldPosHitT(uint2(pixel)).xyz;
+    float  distance = length(worldPos - GetCamera().position);
+
+    float  occlusion = current;
+    float  historyLength = 1.f;
+
+    int2 prevPixel;
+    if (RTAOTemporalHistoryValid() && RTAOTemporalReproject(worldPos, prevPixel))
+    {
+        float4 history = HistoryIn.Load(prevPixel);
+
+        // Reject the history of a different surface (disocclusion)
+        float prevDistance = length(worldPos - GetCamera().prevPosition);
+        if (history.y > 0.f && abs(history.z - prevDistance) <= (RTAO_TEMPORAL_DISTANCE_THRESHOLD * prevDistance))
+        {
+            // Clamp the history to this frame's neighborhood to limit ghosting
+            float clampedHistory = clamp(history.x, neighborMin, neighborMax);
+
+            float minBlend = GetGlobalConst(rtao, temporalMinBlend);
+            historyLength = min(history.y + 1.f, 1.f / minBlend);
+            float blend = max(minBlend, 1.f / historyLength);
+            occlusion = lerp(clampedHistory, current, blend);
+        }
+    }
+
+    HistoryOut[pixel] = float4(occlusion, historyLength, distance, 0.f);
+}
@@ -11,6 +11,9 @@
 #include "include/Common.hlsl"
 #include "include/Descriptors.hlsl"
 #include "include/InlineLighting.hlsl"
+#include "include/RTAOTemporal.hlsl"
+#include "include/VisibilityBuffer.hlsl"
+#include "include/GBufferTiles.hlsl"
 
 // ============================================================================
 // Helper Functions
@@ -39,7 +42,8 @@ float GetOcclusionInline(int2 screenPos, float3 worldPos, float3 normal, Raytrac
     static const float c_numAngles = 10.f;
 
     // Load a value from the noise texture
-    float  blueNoiseValue = BlueNoise.Load(int3(screenPos.xy, 0) % 256).r;
+    // With temporal accumulation, offset the lookup every frame to vary the ray directions
+    float  blueNoiseValue = BlueNoise.Load(int3((screenPos.xy + RTAOTemporalGetNoiseOffset()) % 256, 0)).r;
     float3 blueNoiseUnitVector = SphericalFibonacci(clamp(blueNoiseValue * c_numAngles, 0, c_numAngles - 1), c_numAngles);
 
     // Use the noise vector to perturb the normal, creating a new direction
@@ -77,22 +81,29 @@ float GetOcclusionInline(int2 screenPos, float3 worldPos, float3 normal, Raytrac
 // Compute Shader Entry Point
 // ============================================================================
 
-[numthreads(8, 8, 1)]
+// The thread group is a GBuffer tile (RTAO_TRACE_BLOCK_SIZE in the C++ code)
+[numthreads(GBUFFER_TILE_SIZE, GBUFFER_TILE_SIZE, 1)]
 void CS(uint3 GroupID : SV_GroupID, uint3 GroupThreadID : SV_GroupThreadID, uint3 DispatchThreadID : SV_DispatchThreadID)
 {
-    int2 LaunchIndex = int2(DispatchThreadID.xy);
+#if GBUFFER_TILES
+    // The dispatch is indirect, one thread group per GBuffer tile with geometry.
+    // With temporal accumulation, trace the tile's pixels on this frame's checkerboard.
+    int2 LaunchIndex = int2((GBufferTilesGetTile(GroupID.x) * GBUFFER_TILE_SIZE) + GroupThreadID.xy);
+    if (!RTAOTemporalIsTracedPixel(LaunchIndex)) return;
+#else
+    // With temporal accumulation, the dispatch is half width and covers this frame's checkerboard pixels
+    int2 LaunchIndex = RTAOTemporalGetTracedPixel(int2(DispatchThreadID.xy));
+#endif
     uint2 LaunchDimensions;
 
     // Get the (bindless) resources
     RWTexture2D<float4> GBufferA = GetRWTex2D(GBUFFERA_INDEX);
-    RWTexture2D<float4> GBufferB = GetRWTex2D(GBUFFERB_INDEX);
-    RWTexture2D<float4> GBufferC = GetRWTex2D(GBUFFERC_INDEX);
     RWTexture2D<float4> GBufferD = GetRWTex2D(GBUFFERD_INDEX);
     RWTexture2D<float4> RTAORaw = GetRWTex2D(RTAO_RAW_INDEX);
     Texture2D<float4> BlueNoise = GetTex2D(BLUE_NOISE_INDEX);
     RaytracingAccelerationStructure SceneTLAS = GetAccelerationStructure(SCENE_TLAS_INDEX);
 
-    GBufferA.GetDimensions(LaunchDimensions.x, LaunchDimensions.y);
+    LaunchDimensions = GetRenderResolution();
 
     // Early exit for out-of-bounds threads
     if (LaunchIndex.x >= (int)LaunchDimensions.x || LaunchIndex.y >= (int)LaunchDimensions.y) return;
@@ -104,10 +115,11 @@ void CS(uint3 GroupID : SV_GroupID, uint3 GroupThreadID : SV_GroupThreadID, uint
         return;
     }
 
-    // Load the world position and normal from the GBuffer
-    float3 worldPos = GBufferB.Load(LaunchIndex).xyz;
-    float3 normal = GBufferC.Load(LaunchIndex).xyz;
+    // Load (or reconstruct from the visibility buffer) the world position and normal
+    float4 worldPosHitT;
+    float3 normal;
+    GBufferLoadSurface(uint2(LaunchIndex), worldPosHitT, normal);
 
     // Store the occlusion using inline ray tracing
-    RTAORaw[LaunchIndex] = GetOcclusionInline(LaunchIndex, worldPos, normal, SceneTLAS, BlueNoise);
+    RTAORaw[LaunchIndex] = GetOcclusionInline(LaunchIndex, worldPosHitT.xyz, normal, SceneTLAS, BlueNoise);
 }
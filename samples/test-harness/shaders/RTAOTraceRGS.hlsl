@@ -11,6 +11,9 @@
 #include "include/Common.hlsl"
 #include "include/Descriptors.hlsl"
 #include "include/RayTracing.hlsl"
+#include "include/RTAOTemporal.hlsl"
+#include "include/VisibilityBuffer.hlsl"
+#include "include/GBufferTiles.hlsl"
 
 /**
  * Computes a low discrepancy spherically distributed direction on the unit sphere,
@@ -39,7 +42,8 @@ float GetOcclusion(int2 screenPos, float3 worldPos, float3 normal)
     RaytracingAccelerationStructure SceneTLAS = GetAccelerationStructure(SCENE_TLAS_INDEX);
 
     // Load a value from the noise texture
-    float  blueNoiseValue = BlueNoise.Load(int3(screenPos.xy, 0) % 256).r;
+    // With temporal accumulation, offset the lookup every frame to vary the ray directions
+    float  blueNoiseValue = BlueNoise.Load(int3((screenPos.xy + RTAOTemporalGetNoiseOffset()) % 256, 0)).r;
     float3 blueNoiseUnitVector = SphericalFibonacci(clamp(blueNoiseValue * c_numAngles, 0, c_numAngles - 1), c_numAngles);
 
     // Use the noise vector to perturb the normal, creating a new direction
@@ -73,12 +77,21 @@ float GetOcclusion(int2 screenPos, float3 worldPos, float3 normal)
 [shader("raygeneration")]
 void RayGen()
 {
-    int2 LaunchIndex = int2(DispatchRaysIndex().xy);
+#if GBUFFER_TILES
+    // The dispatch is indirect: one row per GBuffer tile with geometry, one ray per tile pixel
+    // (with temporal accumulation, per checkerboard pixel of the tile) along the row
+    int tileWidth = RTAOTemporalEnabled() ? (GBUFFER_TILE_SIZE / 2) : GBUFFER_TILE_SIZE;
+    int2 tilePixel = int2(DispatchRaysIndex().x % tileWidth, DispatchRaysIndex().x / tileWidth);
+    int2 LaunchIndex = int2(GBufferTilesGetTile(DispatchRaysIndex().y) * GBUFFER_TILE_SIZE) + RTAOTemporalGetTracedPixel(tilePixel);
+    if (LaunchIndex.y >= (int)GetGlobalConst(rtao, filterBufferHeight)) return;
+#else
+    // With temporal accumulation, the dispatch is half width and covers this frame's checkerboard pixels
+    int2 LaunchIndex = RTAOTemporalGetTracedPixel(int2(DispatchRaysIndex().xy));
+#endif
+    if (LaunchIndex.x >= (int)GetGlobalConst(rtao, filterBufferWidth)) return;
 
     // Get the (bindless) resources
     RWTexture2D<float4> GBufferA = GetRWTex2D(GBUFFERA_INDEX);
-    RWTexture2D<float4> GBufferB = GetRWTex2D(GBUFFERB_INDEX);
-    RWTexture2D<float4> GBufferC = GetRWTex2D(GBUFFERC_INDEX);
     RWTexture2D<float4> GBufferD = GetRWTex2D(GBUFFERD_INDEX);
     RWTexture2D<float4> RTAORaw = GetRWTex2D(RTAO_RAW_INDEX);
 
@@ -90,8 +103,10 @@ void RayGen()
     }
 
     // Load the world position and normal from the GBuffer
-    float3 worldPos = GBufferB.Load(LaunchIndex).xyz;
-    float3 normal = GBufferC.Load(LaunchIndex).xyz;
+    float4 worldPosHitT;
+    float3 normal;
+    GBufferLoadSurface(uint2(LaunchIndex), worldPosHitT, normal);
+    float3 worldPos = worldPosHitT.xyz;
 
     // Store the occlusion
     RTAORaw[LaunchIndex] = GetOcclusion(LaunchIndex, worldPos, normal);
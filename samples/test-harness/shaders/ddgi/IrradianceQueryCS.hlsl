@@ -0,0 +1,95 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+// ============================================================================
+// IrradianceQueryCS - Evaluate DDGIVolume irradiance at points queried by the CPU
+// ============================================================================
+//
+// One thread per query of the IrradianceQueries buffer (see Graphics::DDGI::QueueIrradianceQueries).
+// The buffer holds the number of queries, then a world-space position and normal per query.
+// Each thread blends the irradiance of the volumes that cover its point (finest first, like the
+// radiance cache's probe lookup) and overwrites the query's position with the irradiance and
+// the summed blend weight (0 when no volume covers the point). The application then copies the
+// buffer to a readback buffer, read MAX_FRAMES_IN_FLIGHT frames later.
+// ============================================================================
+
+// RTXGI_DDGI_NUM_VOLUMES must be passed in as a define at shader compilation time.
+#ifndef RTXGI_DDGI_NUM_VOLUMES
+    #error Required define RTXGI_DDGI_NUM_VOLUMES is not defined for IrradianceQueryCS.hlsl!
+#endif
+
+// Default defines for DDGI SDK (should be overridden by compiler defines)
+#ifndef CONSTS_REGISTER
+#define CONSTS_REGISTER b0
+#endif
+
+#ifndef CONSTS_SPACE
+#define CONSTS_SPACE space1
+#endif
+
+// The queries follow a 16 byte header (the query count), IRRADIANCE_QUERY_STRIDE is sizeof(IrradianceQuery) (see Types.h)
+#define IRRADIANCE_QUERY_HEADER_SIZE 16
+#define IRRADIANCE_QUERY_STRIDE 32
+
+#include "../include/Common.hlsl"
+#include "../include/Descriptors.hlsl"
+
+#include "../../../../rtxgi-sdk/shaders/ddgi/include/DDGIRootConstants.hlsl"
+#include "../../../../rtxgi-sdk/shaders/ddgi/Irradiance.hlsl"
+
+[numthreads(64, 1, 1)]
+void CS(uint3 DispatchThreadID : SV_DispatchThreadID)
+{
+    RWByteAddressBuffer Queries = GetIrradianceQueries();
+
+    uint QueryIndex = DispatchThreadID.x;
+    if (QueryIndex >= Queries.Load(0)) return;
+
+    uint Address = IRRADIANCE_QUERY_HEADER_SIZE + (QueryIndex * IRRADIANCE_QUERY_STRIDE);
+    float3 WorldPosition = asfloat(Queries.Load3(Address));
+    float3 WorldNormal = asfloat(Queries.Load3(Address + 16));
+
+    StructuredBuffer<DDGIVolumeDescGPUPacked> DDGIVolumes = GetDDGIVolumeConstants(GetDDGIVolumeConstantsIndex());
+    StructuredBuffer<DDGIVolumeResourceIndices> DDGIVolumeBindless = GetDDGIVolumeResourceIndices(GetDDGIVolumeResourceIndicesIndex());
+    StructuredBuffer<DDGIVolumeBoundsGPU> DDGIVolumeBounds = GetDDGIVolumeBounds();
+
+    float3 Irradiance = float3(0.f, 0.f, 0.f);
+    float WeightSum = 0.f;
+    for (uint OrderIndex = 0; OrderIndex < RTXGI_DDGI_NUM_VOLUMES && WeightSum < 1.f; OrderIndex++)
+    {
+        // Read the volume's bounds in blend order, only the volumes that cover the point are unpacked
+        uint VolumeIndex = DDGIVolumeBounds[OrderIndex].blendOrder;
+        float BlendWeight = DDGIGetVolumeBlendWeight(WorldPosition, DDGIVolumeBounds[VolumeIndex]);
+        if (BlendWeight <= 0.f) continue;
+
+        DDGIVolumeDescGPU Volume = UnpackDDGIVolumeDescGPU(DDGIVolumes[VolumeIndex]);
+
+        DDGIVolumeResourceIndices ResourceIndices = DDGIVolumeBindless[VolumeIndex];
+        DDGIVolumeResources Resources;
+        Resources.probeIrradiance = GetTex2DArray(ResourceIndices.probeIrradianceSRVIndex);
+        Resources.probeDistance = GetTex2DArray(ResourceIndices.probeDistanceSRVIndex);
+        Resources.probeData = GetTex2DArray(ResourceIndices.probeDataSRVIndex);
+        Resources.bilinearSampler = GetBilinearWrapSampler();
+    #if RTXGI_DDGI_PROBE_STATE_BITS || RTXGI_DDGI_PROBE_VISIBILITY_MASK
+        Resources.probeSchedule = GetDDGIProbeSchedule(ResourceIndices.probeScheduleUAVIndex);
+    #endif
+
+        // Queries have no view direction, view the point along its normal
+        float3 SurfaceBias = DDGIGetSurfaceBias(WorldNormal, -WorldNormal, Volume);
+
+        // Preferred (higher priority, then finer) volumes take precedence, the next volumes fill in the rest of the weight
+        float Weight = min(BlendWeight, 1.f - WeightSum);
+        Irradiance += DDGIGetVolumeIrradiance(WorldPosition, SurfaceBias, WorldNormal, Volume, Resources) * Weight;
+        WeightSum += Weight;
+    }
+
+    if (WeightSum > 0.f) Irradiance /= WeightSum;
+    Queries.Store4(Address, asuint(float4(Irradiance, WeightSum)));
+}
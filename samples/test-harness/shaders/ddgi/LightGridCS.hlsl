@@ -0,0 +1,117 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+// ============================================================================
+// LightGridCS - Build the world-space light grid used by RadianceCacheCS
+// ============================================================================
+//
+// Runs before RadianceCacheCS, every frame (lights can move):
+//   1. BoundsCS (1 group): reduce the spot and point light spheres to the grid bounds
+//   2. BuildCS (1 thread per cell): list the lights whose sphere overlaps the cell
+//
+// See LightGrid.hlsl for the buffer layout.
+// ============================================================================
+
+// Default defines for DDGI SDK (should be overridden by compiler defines)
+#ifndef CONSTS_REGISTER
+#define CONSTS_REGISTER b0
+#endif
+
+#ifndef CONSTS_SPACE
+#define CONSTS_SPACE space1
+#endif
+
+#include "../include/Common.hlsl"
+#include "../include/Descriptors.hlsl"
+#include "../include/LightGrid.hlsl"
+
+#define LIGHT_GRID_BOUNDS_GROUP_SIZE 256
+#define LIGHT_GRID_BUILD_GROUP_SIZE 4
+
+groupshared float3 BoundsMin[LIGHT_GRID_BOUNDS_GROUP_SIZE];
+groupshared float3 BoundsMax[LIGHT_GRID_BOUNDS_GROUP_SIZE];
+
+[numthreads(LIGHT_GRID_BOUNDS_GROUP_SIZE, 1, 1)]
+void BoundsCS(uint GroupIndex : SV_GroupIndex)
+{
+    StructuredBuffer<Light> SceneLights = GetLights();
+    uint FirstLocalLight = HasDirectionalLight();
+    uint NumLocalLights = GetNumSpotLights() + GetNumPointLights();
+
+    float3 LocalMin = float3(1e27f, 1e27f, 1e27f);
+    float3 LocalMax = -LocalMin;
+    for (uint LightIndex = GroupIndex; LightIndex < NumLocalLights; LightIndex += LIGHT_GRID_BOUNDS_GROUP_SIZE)
+    {
+        Light SceneLight = SceneLights[FirstLocalLight + LightIndex];
+        LocalMin = min(LocalMin, SceneLight.position - SceneLight.radius);
+        LocalMax = max(LocalMax, SceneLight.position + SceneLight.radius);
+    }
+
+    BoundsMin[GroupIndex] = LocalMin;
+    BoundsMax[GroupIndex] = LocalMax;
+    GroupMemoryBarrierWithGroupSync();
+
+    for (uint Stride = (LIGHT_GRID_BOUNDS_GROUP_SIZE / 2); Stride > 0; Stride >>= 1)
+    {
+        if (GroupIndex < Stride)
+        {
+            BoundsMin[GroupIndex] = min(BoundsMin[GroupIndex], BoundsMin[GroupIndex + Stride]);
+            BoundsMax[GroupIndex] = max(BoundsMax[GroupIndex], BoundsMax[GroupIndex + Stride]);
+        }
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    if (GroupIndex == 0)
+    {
+        // Keep the cells non-degenerate when every light sits at the same point with a zero radius
+        float3 CellSize = max((BoundsMax[0] - BoundsMin[0]) / LIGHT_GRID_DIM, 1e-3f);
+        GetLightGrid().Store4(0, uint4(asuint(BoundsMin[0]), NumLocalLights));
+        GetLightGrid().Store4(16, uint4(asuint(CellSize), 0));
+    }
+}
+
+[numthreads(LIGHT_GRID_BUILD_GROUP_SIZE, LIGHT_GRID_BUILD_GROUP_SIZE, LIGHT_GRID_BUILD_GROUP_SIZE)]
+void BuildCS(uint3 DispatchThreadID : SV_DispatchThreadID)
+{
+    if (any(DispatchThreadID >= LIGHT_GRID_DIM)) return;
+
+    RWByteAddressBuffer Grid = GetLightGrid();
+    StructuredBuffer<Light> SceneLights = GetLights();
+
+    float3 GridMin = asfloat(Grid.Load3(0));
+    uint NumLocalLights = Grid.Load(12);
+    float3 CellSize = asfloat(Grid.Load3(16));
+
+    float3 CellMin = GridMin + (float3(DispatchThreadID) * CellSize);
+    float3 CellMax = CellMin + CellSize;
+
+    uint CellOffset = LightGridCellOffset(DispatchThreadID);
+    uint FirstLocalLight = HasDirectionalLight();
+    uint Count = 0;
+    for (uint LightIndex = 0; LightIndex < NumLocalLights; LightIndex++)
+    {
+        Light SceneLight = SceneLights[FirstLocalLight + LightIndex];
+
+        // Sphere vs. AABB: distance from the light to the closest point of the cell
+        float3 Closest = clamp(SceneLight.position, CellMin, CellMax);
+        float3 Delta = SceneLight.position - Closest;
+        if (dot(Delta, Delta) > (SceneLight.radius * SceneLight.radius)) continue;
+
+        if (Count == LIGHT_GRID_MAX_LIGHTS_PER_CELL)
+        {
+            Count = LIGHT_GRID_CELL_OVERFLOW;
+            break;
+        }
+
+        Grid.Store(CellOffset + 4 + (Count * 4), FirstLocalLight + LightIndex);
+        Count++;
+    }
+    Grid.Store(CellOffset, Count);
+}
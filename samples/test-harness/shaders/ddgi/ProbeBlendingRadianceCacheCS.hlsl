@@ -0,0 +1,74 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+// ============================================================================
+// Probe Blending with Fused Ray Resolve
+// ============================================================================
+//
+// The SDK's probe blending (irradiance and distance) with the rays loaded
+// straight from the probe ray hit map and the world-space radiance cache.
+// Replaces ProbeRayResolveCS: cached front face hits are never written to
+// RayData, and the blending loads them while it fills groupshared memory.
+//
+// For each probe ray:
+//   - Cached front face hit: radiance from the radiance cache, distance from the hit map
+//   - Otherwise (miss, backface, fixed ray, no cache slot): RayData, as stored by ProbeTraceCS
+//
+// Requires RTXGI_BINDLESS_TYPE_DESCRIPTOR_HEAP, the harness resource arrays
+// would collide with the SDK blending's own declarations.
+//
+// Compiled by DDGI.cpp::CompileDDGIVolumeShaders() when Globals::DDGIFusedRayResolve is set.
+// ============================================================================
+
+#include "../include/Descriptors.hlsl"
+#include "../include/ProbeTraceBatch.hlsl"
+#include "../include/ProbeRayHitMap.hlsl"
+
+#include "../../../../rtxgi-sdk/shaders/ddgi/include/ProbeCommon.hlsl"
+#include "../../../../rtxgi-sdk/shaders/ddgi/include/DDGIRootConstants.hlsl"
+
+/**
+ * Get the first ProbeRayHitMap entry of the DDGIVolume being blended.
+ */
+uint GetProbeRayHitMapOffset(uint volumeIndex)
+{
+#if PROBE_TRACE_BATCHED
+    // The batch table lists a handful of volumes, a linear scan is enough
+    RWStructuredBuffer<uint4> Batch = GetProbeTraceBatch();
+    uint numVolumes = Batch[0].x;
+    for (uint index = 0; index < numVolumes; index++)
+    {
+        uint4 volumeEntry = Batch[1 + index];
+        if (volumeEntry.x == volumeIndex) return volumeEntry.z;
+    }
+#endif
+    return 0;
+}
+
+/**
+ * Load a probe ray's radiance and hit distance for blending (see RTXGI_DDGI_BLEND_RAY_LOADER).
+ */
+void DDGIBlendLoadProbeRay(RWTexture2DArray<float4> RayData, int rayIndex, int probeIndex, DDGIVolumeDescGPU volume, out float3 radiance, out float distance)
+{
+    uint2 hitMapData = GetProbeRayHitMap()[GetProbeRayHitMapOffset(GetDDGIVolumeIndex()) + (probeIndex * volume.probeNumRays) + rayIndex];
+    if (hitMapData.x != PROBE_RAY_HIT_MAP_INVALID)
+    {
+        radiance = LoadProbeRayCachedRadiance(hitMapData.x);
+        distance = asfloat(hitMapData.y);
+        return;
+    }
+
+    uint3 rayDataTexCoords = DDGIGetRayDataTexelCoords(rayIndex, probeIndex, volume);
+    radiance = DDGILoadProbeRayRadiance(RayData, rayDataTexCoords, volume);
+    distance = DDGILoadProbeRayDistance(RayData, rayDataTexCoords, volume);
+}
+
+#define RTXGI_DDGI_BLEND_RAY_LOADER 1
+#include "../../../../rtxgi-sdk/shaders/ddgi/ProbeBlendingCS.hlsl"
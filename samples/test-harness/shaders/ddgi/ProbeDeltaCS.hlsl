@@ -0,0 +1,248 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+// ============================================================================
+// ProbeDeltaCS - Export and import the changed probe tiles of a DDGIVolume
+// ============================================================================
+//
+// The ProbeDeltas buffer holds a ProbeDeltaHeader (see Types.h), a packet of probe tiles, then the tiles
+// each volume last exported (see Graphics::DDGI::QueueProbeDeltaExport). A tile is the probe index, then the
+// probe's data texel, irradiance texels, and distance texels (borders included) as half floats.
+//
+// ExportCS runs a thread group per probe of the header's volume. The group compares the probe's texels with
+// the tile the volume last exported: irradiance in its encoded (gamma) space, distance relative to the probe
+// spacing. When a texel changed by more than the header's threshold, the group appends the probe's tile to
+// the packet and keeps it as the last exported tile. Probes that don't fit the packet stay unchanged and are
+// exported by a later packet.
+//
+// ImportCS runs a thread group per tile of the packet and writes the tile's texels to the probe textures of
+// the header's volume, the client side mirror of ExportCS.
+// ============================================================================
+
+// Default defines for DDGI SDK (should be overridden by compiler defines)
+#ifndef CONSTS_REGISTER
+#define CONSTS_REGISTER b0
+#endif
+
+#ifndef CONSTS_SPACE
+#define CONSTS_SPACE space1
+#endif
+
+// Probe deltas buffer layout (see ProbeDeltaHeader in Types.h), the packet's tiles follow the header
+#define PROBE_DELTA_TILE_COUNT_OFFSET 8
+#define PROBE_DELTA_HEADER_SIZE 32
+
+// Tile layout: the probe index, the probe data texel (half4), then the irradiance (half4) and distance (half2) texels
+#define PROBE_DELTA_DATA_OFFSET 4
+#define PROBE_DELTA_IRRADIANCE_OFFSET 12
+
+#define PROBE_DELTA_THREADS 64
+#define PROBE_DELTA_GROUPS_X 256                // Dispatch: (PROBE_DELTA_GROUPS_X, DivRoundUp(count, PROBE_DELTA_GROUPS_X), 1)
+
+#include "../include/Common.hlsl"
+#include "../include/Descriptors.hlsl"
+
+#include "../../../../rtxgi-sdk/shaders/ddgi/include/DDGIRootConstants.hlsl"
+#include "../../../../rtxgi-sdk/shaders/ddgi/include/ProbeIndexing.hlsl"
+
+groupshared uint MaxDelta;
+groupshared uint TileAddress;
+
+struct ProbeDeltaParams
+{
+    uint  volumeIndex;
+    float threshold;
+    uint  tileCount;
+    uint  tileStride;
+    uint  referenceOffset;
+    uint  probeCount;
+    uint  maxTiles;
+};
+
+ProbeDeltaParams LoadProbeDeltaParams(RWByteAddressBuffer Deltas)
+{
+    uint4 header0 = Deltas.Load4(0);
+    uint4 header1 = Deltas.Load4(16);
+
+    ProbeDeltaParams params;
+    params.volumeIndex = header0.x;
+    params.threshold = asfloat(header0.y);
+    params.tileCount = header0.z;
+    params.tileStride = header0.w;
+    params.referenceOffset = header1.x;
+    params.probeCount = header1.y;
+    params.maxTiles = header1.z;
+    return params;
+}
+
+uint2 PackHalf4(float4 value)
+{
+    uint4 halfs = f32tof16(value);
+    return uint2(halfs.x | (halfs.y << 16), halfs.z | (halfs.w << 16));
+}
+
+float4 UnpackHalf4(uint2 packed)
+{
+    return f16tof32(uint4(packed.x, packed.x >> 16, packed.y, packed.y >> 16));
+}
+
+uint PackHalf2(float2 value)
+{
+    uint2 halfs = f32tof16(value);
+    return halfs.x | (halfs.y << 16);
+}
+
+float2 UnpackHalf2(uint packed)
+{
+    return f16tof32(uint2(packed, packed >> 16));
+}
+
+/**
+ * Get the texture array coordinates of a texel of a probe's tile (numTexels x numTexels, borders included).
+ */
+uint3 GetTileTexelCoords(uint3 probeTexelCoords, uint texelIndex, uint numTexels)
+{
+    uint2 texel = uint2(texelIndex % numTexels, texelIndex / numTexels);
+    return uint3((probeTexelCoords.xy * numTexels) + texel, probeTexelCoords.z);
+}
+
+// Dispatch: (PROBE_DELTA_GROUPS_X, DivRoundUp(probeCount, PROBE_DELTA_GROUPS_X), 1), a thread group per probe
+[numthreads(PROBE_DELTA_THREADS, 1, 1)]
+void ExportCS(uint3 GroupID : SV_GroupID, uint GroupIndex : SV_GroupIndex)
+{
+    RWByteAddressBuffer Deltas = GetProbeDeltas();
+    ProbeDeltaParams params = LoadProbeDeltaParams(Deltas);
+
+    uint probeIndex = (GroupID.y * PROBE_DELTA_GROUPS_X) + GroupID.x;
+    if (probeIndex >= params.probeCount) return;
+
+    StructuredBuffer<DDGIVolumeDescGPUPacked> DDGIVolumes = GetDDGIVolumeConstants(GetDDGIVolumeConstantsIndex());
+    StructuredBuffer<DDGIVolumeResourceIndices> DDGIVolumeBindless = GetDDGIVolumeResourceIndices(GetDDGIVolumeResourceIndicesIndex());
+
+    DDGIVolumeDescGPU volume = UnpackDDGIVolumeDescGPU(DDGIVolumes[params.volumeIndex]);
+    DDGIVolumeResourceIndices resourceIndices = DDGIVolumeBindless[params.volumeIndex];
+    Texture2DArray<float4> ProbeIrradiance = GetTex2DArray(resourceIndices.probeIrradianceSRVIndex);
+    Texture2DArray<float4> ProbeDistance = GetTex2DArray(resourceIndices.probeDistanceSRVIndex);
+    Texture2DArray<float4> ProbeData = GetTex2DArray(resourceIndices.probeDataSRVIndex);
+
+    uint3 probeTexelCoords = DDGIGetProbeTexelCoords(probeIndex, volume);
+    uint numIrradianceTexels = uint(volume.probeNumIrradianceInteriorTexels + 2);
+    uint numDistanceTexels = uint(volume.probeNumDistanceInteriorTexels + 2);
+    uint distanceOffset = PROBE_DELTA_IRRADIANCE_OFFSET + (numIrradianceTexels * numIrradianceTexels * 8);
+    float distanceScale = 1.f / length(volume.probeSpacing);
+
+    uint referenceAddress = params.referenceOffset + (probeIndex * params.tileStride);
+
+    if (GroupIndex == 0) MaxDelta = 0;
+    GroupMemoryBarrierWithGroupSync();
+
+    // Compare the texels as they would be exported (half floats), so unchanged probes have no delta
+    float delta = 0.f;
+    uint texelIndex;
+    if (GroupIndex == 0)
+    {
+        float4 data = UnpackHalf4(PackHalf4(ProbeData.Load(int4(probeTexelCoords, 0))));
+        float4 difference = abs(data - UnpackHalf4(Deltas.Load2(referenceAddress + PROBE_DELTA_DATA_OFFSET)));
+        delta = max(max(difference.x, difference.y), max(difference.z, difference.w));
+    }
+    for (texelIndex = GroupIndex; texelIndex < (numIrradianceTexels * numIrradianceTexels); texelIndex += PROBE_DELTA_THREADS)
+    {
+        float3 irradiance = UnpackHalf4(PackHalf4(ProbeIrradiance.Load(int4(GetTileTexelCoords(probeTexelCoords, texelIndex, numIrradianceTexels), 0)))).rgb;
+        float3 difference = abs(irradiance - UnpackHalf4(Deltas.Load2(referenceAddress + PROBE_DELTA_IRRADIANCE_OFFSET + (texelIndex * 8))).rgb);
+        delta = max(delta, max(difference.x, max(difference.y, difference.z)));
+    }
+    for (texelIndex = GroupIndex; texelIndex < (numDistanceTexels * numDistanceTexels); texelIndex += PROBE_DELTA_THREADS)
+    {
+        float distance = UnpackHalf2(PackHalf2(ProbeDistance.Load(int4(GetTileTexelCoords(probeTexelCoords, texelIndex, numDistanceTexels), 0)).rg)).x;
+        delta = max(delta, abs(distance - UnpackHalf2(Deltas.Load(referenceAddress + distanceOffset + (texelIndex * 4))).x) * distanceScale);
+    }
+
+    delta = WaveActiveMax(delta);
+    if (WaveIsFirstLane()) InterlockedMax(MaxDelta, asuint(delta));
+    GroupMemoryBarrierWithGroupSync();
+
+    // A negative threshold exports every probe
+    if (asfloat(MaxDelta) <= params.threshold) return;
+
+    // Append the probe's tile to the packet
+    if (GroupIndex == 0)
+    {
+        uint tileIndex;
+        Deltas.InterlockedAdd(PROBE_DELTA_TILE_COUNT_OFFSET, 1, tileIndex);
+        TileAddress = (tileIndex < params.maxTiles) ? PROBE_DELTA_HEADER_SIZE + (tileIndex * params.tileStride) : 0;
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    // The packet is full, the probe keeps its last exported tile and is exported by a later packet
+    if (TileAddress == 0) return;
+
+    // Store the tile to the packet and keep it as the last exported tile
+    if (GroupIndex == 0)
+    {
+        uint2 data = PackHalf4(ProbeData.Load(int4(probeTexelCoords, 0)));
+        Deltas.Store3(TileAddress, uint3(probeIndex, data));
+        Deltas.Store3(referenceAddress, uint3(probeIndex, data));
+    }
+    for (texelIndex = GroupIndex; texelIndex < (numIrradianceTexels * numIrradianceTexels); texelIndex += PROBE_DELTA_THREADS)
+    {
+        uint2 irradiance = PackHalf4(ProbeIrradiance.Load(int4(GetTileTexelCoords(probeTexelCoords, texelIndex, numIrradianceTexels), 0)));
+        Deltas.Store2(TileAddress + PROBE_DELTA_IRRADIANCE_OFFSET + (texelIndex * 8), irradiance);
+        Deltas.Store2(referenceAddress + PROBE_DELTA_IRRADIANCE_OFFSET + (texelIndex * 8), irradiance);
+    }
+    for (texelIndex = GroupIndex; texelIndex < (numDistanceTexels * numDistanceTexels); texelIndex += PROBE_DELTA_THREADS)
+    {
+        uint distance = PackHalf2(ProbeDistance.Load(int4(GetTileTexelCoords(probeTexelCoords, texelIndex, numDistanceTexels), 0)).rg);
+        Deltas.Store(TileAddress + distanceOffset + (texelIndex * 4), distance);
+        Deltas.Store(referenceAddress + distanceOffset + (texelIndex * 4), distance);
+    }
+}
+
+// Dispatch: (PROBE_DELTA_GROUPS_X, DivRoundUp(tileCount, PROBE_DELTA_GROUPS_X), 1), a thread group per tile
+[numthreads(PROBE_DELTA_THREADS, 1, 1)]
+void ImportCS(uint3 GroupID : SV_GroupID, uint GroupIndex : SV_GroupIndex)
+{
+    RWByteAddressBuffer Deltas = GetProbeDeltas();
+    ProbeDeltaParams params = LoadProbeDeltaParams(Deltas);
+
+    uint tileIndex = (GroupID.y * PROBE_DELTA_GROUPS_X) + GroupID.x;
+    if (tileIndex >= min(params.tileCount, params.maxTiles)) return;
+
+    uint tileAddress = PROBE_DELTA_HEADER_SIZE + (tileIndex * params.tileStride);
+    uint probeIndex = Deltas.Load(tileAddress);
+    if (probeIndex >= params.probeCount) return;
+
+    StructuredBuffer<DDGIVolumeDescGPUPacked> DDGIVolumes = GetDDGIVolumeConstants(GetDDGIVolumeConstantsIndex());
+    StructuredBuffer<DDGIVolumeResourceIndices> DDGIVolumeBindless = GetDDGIVolumeResourceIndices(GetDDGIVolumeResourceIndicesIndex());
+
+    DDGIVolumeDescGPU volume = UnpackDDGIVolumeDescGPU(DDGIVolumes[params.volumeIndex]);
+    DDGIVolumeResourceIndices resourceIndices = DDGIVolumeBindless[params.volumeIndex];
+    RWTexture2DArray<float4> ProbeIrradiance = GetRWTex2DArray(resourceIndices.probeIrradianceUAVIndex);
+    RWTexture2DArray<float4> ProbeDistance = GetRWTex2DArray(resourceIndices.probeDistanceUAVIndex);
+    RWTexture2DArray<float4> ProbeData = GetRWTex2DArray(resourceIndices.probeDataUAVIndex);
+
+    uint3 probeTexelCoords = DDGIGetProbeTexelCoords(probeIndex, volume);
+    uint numIrradianceTexels = uint(volume.probeNumIrradianceInteriorTexels + 2);
+    uint numDistanceTexels = uint(volume.probeNumDistanceInteriorTexels + 2);
+    uint distanceOffset = PROBE_DELTA_IRRADIANCE_OFFSET + (numIrradianceTexels * numIrradianceTexels * 8);
+
+    if (GroupIndex == 0) ProbeData[probeTexelCoords] = UnpackHalf4(Deltas.Load2(tileAddress + PROBE_DELTA_DATA_OFFSET));
+
+    uint texelIndex;
+    for (texelIndex = GroupIndex; texelIndex < (numIrradianceTexels * numIrradianceTexels); texelIndex += PROBE_DELTA_THREADS)
+    {
+        float4 irradiance = UnpackHalf4(Deltas.Load2(tileAddress + PROBE_DELTA_IRRADIANCE_OFFSET + (texelIndex * 8)));
+        ProbeIrradiance[GetTileTexelCoords(probeTexelCoords, texelIndex, numIrradianceTexels)] = irradiance;
+    }
+    for (texelIndex = GroupIndex; texelIndex < (numDistanceTexels * numDistanceTexels); texelIndex += PROBE_DELTA_THREADS)
+    {
+        float2 distance = UnpackHalf2(Deltas.Load(tileAddress + distanceOffset + (texelIndex * 4)));
+        ProbeDistance[GetTileTexelCoords(probeTexelCoords, texelIndex, numDistanceTexels)] = float4(distance, 0.f, 0.f);
+    }
+}
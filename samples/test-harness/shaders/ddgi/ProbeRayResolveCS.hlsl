@@ -13,11 +13,13 @@
 // ============================================================================
 //
 // This shader resolves the world-space radiance cache to per-probe-ray RayData.
-// It runs after RadianceCacheCS and before ProbeBlendingCS.
+// It runs after RadianceCacheCS and before ProbeBlendingCS. With the fused
+// probe blending (Globals::DDGIFusedRayResolve), the blending reads the hit map
+// and the radiance cache itself and this pass is skipped (see ProbeRayHitMap.hlsl).
 //
 // For each probe ray:
 //   1. Load the HashID from ProbeRayHitMap (stored by ProbeTraceCS)
-//   2. If valid (not INVALID sentinel), lookup RadianceCachingBuffer[HashID]
+//   2. If valid (not INVALID sentinel), load the cached radiance of HashID (LoadCachedRadiance)
 //   3. Load hit distance from HitCachingBuffer[HashID]
 //   4. Write to RayData using DDGIStoreProbeRayFrontfaceHit
 //
@@ -36,20 +38,25 @@
 
 #include "../include/Descriptors.hlsl"
 #include "../include/SpatialHash.hlsl"
+#include "../include/ProbeTraceBatch.hlsl"
+#include "../include/ProbeRayHitMap.hlsl"
 
 #include "../../../../rtxgi-sdk/shaders/ddgi/include/DDGIRootConstants.hlsl"
 #include "../../../../rtxgi-sdk/shaders/ddgi/Irradiance.hlsl"
 
-// Sentinel value indicating no cache lookup needed (miss/backface/fixed ray)
-#define PROBE_RAY_HIT_MAP_INVALID 0xFFFFFFFF
-
 [numthreads(64, 1, 1)]
 void CS(uint3 GroupID : SV_GroupID, uint3 GroupThreadID : SV_GroupThreadID, uint ThreadIndexInGroup : SV_GroupIndex)
 {
     uint ProbeRayIndex = GroupID.x * 64 + ThreadIndexInGroup;
 
+#if PROBE_TRACE_BATCHED
+    // The batched dispatch matches ProbeTraceCS: (MaxRayGroupsPerProbe, TotalProbes, 1), see ProbeTraceBatch.hlsl
+    ProbeTraceBatchEntry BatchEntry = GetProbeTraceBatchEntry(GroupID.y);
+    uint VolumeIndex = BatchEntry.volumeIndex;
+#else
     // Get the DDGIVolume's index (from root/push constants)
     uint VolumeIndex = GetDDGIVolumeIndex();
+#endif
 
     // Get the DDGIVolume structured buffers
     StructuredBuffer<DDGIVolumeDescGPUPacked> DDGIVolumes = GetDDGIVolumeConstants(GetDDGIVolumeConstantsIndex());
@@ -64,6 +71,23 @@ void CS(uint3 GroupID : SV_GroupID, uint3 GroupThreadID : SV_GroupThreadID, uint
     uint RaysPerProbe = Volume.probeNumRays;
     uint TotalRaysThisVolume = NumProbes * RaysPerProbe;
 
+#if PROBE_TRACE_BATCHED
+    uint RayIndex = GroupID.x * 64 + ThreadIndexInGroup;
+    if (RayIndex >= RaysPerProbe)
+        return;
+
+    uint ProbeIndex = BatchEntry.probeIndex;
+    if (Volume.probeSchedulingEnabled)
+    {
+        // Skip the rows past the scheduled count, like ProbeTraceCS
+        RWByteAddressBuffer ProbeSchedule = GetDDGIProbeSchedule(resourceIndices.probeScheduleUAVIndex);
+        if (ProbeIndex >= ProbeSchedule.Load(RTXGI_DDGI_PROBE_SCHEDULE_TRACE_ARGS_OFFSET + 4))
+            return;
+
+        ProbeIndex = ProbeSchedule.Load(RTXGI_DDGI_PROBE_SCHEDULE_LIST_OFFSET + (ProbeIndex * 4));
+    }
+    ProbeRayIndex = BatchEntry.hitMapOffset + ProbeIndex * RaysPerProbe + RayIndex;
+#else
     // Bounds check
     if (ProbeRayIndex >= TotalRaysThisVolume)
         return;
@@ -72,11 +96,27 @@ void CS(uint3 GroupID : SV_GroupID, uint3 GroupThreadID : SV_GroupThreadID, uint
     uint ProbeIndex = ProbeRayIndex / RaysPerProbe;
     uint RayIndex = ProbeRayIndex % RaysPerProbe;
 
+    // With probe scheduling, the dispatch matches ProbeTraceCS: (RayGroupsPerProbe, NumScheduledProbes, 1)
+    if (Volume.probeSchedulingEnabled)
+    {
+        RayIndex = GroupID.x * 64 + ThreadIndexInGroup;
+        if (RayIndex >= RaysPerProbe)
+            return;
+
+        ProbeIndex = GetDDGIProbeSchedule(resourceIndices.probeScheduleUAVIndex).Load(RTXGI_DDGI_PROBE_SCHEDULE_LIST_OFFSET + (GroupID.y * 4));
+        ProbeRayIndex = ProbeIndex * RaysPerProbe + RayIndex;
+    }
+#endif
+
     // Skip fixed rays - they are handled directly by ProbeTraceCS
     // Fixed rays are used for relocation/classification and don't need radiance
     if ((Volume.probeRelocationEnabled || Volume.probeClassificationEnabled) && RayIndex < RTXGI_DDGI_NUM_FIXED_RAYS)
         return;
 
+    // Skip the rays past the probe's adaptive ray count, ProbeTraceCS didn't trace them this frame
+    if (Volume.probeAdaptiveRaysEnabled && RayIndex >= (uint)DDGIGetProbeNumRays(ProbeIndex, Volume, GetDDGIProbeSchedule(resourceIndices.probeScheduleUAVIndex)))
+        return;
+
     // Load the hash ID and hit distance for this probe ray
     // Format: .x = HashID (or INVALID), .y = asuint(HitDistance)
     RWStructuredBuffer<uint2> ProbeRayHitMapBuffer = GetProbeRayHitMap();
@@ -90,13 +130,7 @@ void CS(uint3 GroupID : SV_GroupID, uint3 GroupThreadID : SV_GroupThreadID, uint
         return;
 
     // Load cached radiance from world-space radiance cache
-    RWStructuredBuffer<float3> RadianceCachingBuffer = GetRadianceCachingBuffer();
-    float3 CachedRadiance = RadianceCachingBuffer[HashID];
-
-    // DEBUG: Use constant white to test if probe blending works correctly
-    // If this makes the scene smoothly lit with white indirect, then probe blending is OK
-    // and the issue is with RadianceCachingBuffer values
-    CachedRadiance = float3(0.5, 0.5, 0.5);
+    float3 CachedRadiance = LoadProbeRayCachedRadiance(HashID);
 
     // Get RayData texture
     RWTexture2DArray<float4> RayData = GetRWTex2DArray(resourceIndices.rayDataUAVIndex);
@@ -105,5 +139,5 @@ void CS(uint3 GroupID : SV_GroupID, uint3 GroupThreadID : SV_GroupThreadID, uint
     uint3 outputCoords = DDGIGetRayDataTexelCoords(RayIndex, ProbeIndex, Volume);
 
     // Store to RayData - scatter the cached radiance to this probe ray
-    DDGIStoreProbeRayFrontfaceHit(RayData, outputCoords, Volume, saturate(CachedRadiance), HitDistance);
+    DDGIStoreProbeRayFrontfaceHit(RayData, outputCoords, Volume, CachedRadiance, HitDistance);
 }
@@ -2,20 +2,34 @@
 #include "../include/Lighting.hlsl"
 #include "../include/RayTracing.hlsl"
 #include "../include/SpatialHash.hlsl"
+#include "../include/RadianceCacheWorkList.hlsl"
+#include "../include/RadianceCacheBudget.hlsl"
+#include "../include/RadianceCacheReservoir.hlsl"
+#include "../include/ProbeTraceBatch.hlsl"
+#include "../include/ProbeRayHitMap.hlsl"
+#include "../include/GPUCounters.hlsl"
 
 #include "../../../../rtxgi-sdk/shaders/ddgi/include/DDGIRootConstants.hlsl"
 #include "../../../../rtxgi-sdk/shaders/ddgi/Irradiance.hlsl"
 
-// Sentinel value for ProbeRayHitMap indicating miss/backface (no cache lookup needed)
-#define PROBE_RAY_HIT_MAP_INVALID 0xFFFFFFFF
-
 // Dispatch pattern: (RayGroupsPerProbe, NumProbes, 1)
 // where RayGroupsPerProbe = ceil(probeNumRays / 64)
+// With probe scheduling, the dispatch is indirect over the scheduled probes: (RayGroupsPerProbe, NumScheduledProbes, 1)
+// With adaptive rays, each scheduled probe traces only its own ray count (see DDGIGetProbeNumRays())
+// With PROBE_TRACE_BATCHED, one dispatch covers every batched volume: (MaxRayGroupsPerProbe, TotalProbes, 1), see ProbeTraceBatch.hlsl
 [numthreads(64, 1, 1)]
 void CS(uint3 GroupID : SV_GroupID, uint3 GroupThreadID : SV_GroupThreadID, uint ThreadIndexInGroup : SV_GroupIndex)
 {
+#if PROBE_TRACE_BATCHED
+    // Get the DDGIVolume (and its probe) that owns this row of the batched dispatch
+    ProbeTraceBatchEntry BatchEntry = GetProbeTraceBatchEntry(GroupID.y);
+    uint VolumeIndex = BatchEntry.volumeIndex;
+    uint HitMapOffset = BatchEntry.hitMapOffset;
+#else
     //Get the DDGIVolume's index (from root/push constants)
     uint VolumeIndex = GetDDGIVolumeIndex();
+    uint HitMapOffset = 0;
+#endif
 
     // Get the DDGIVolume structured buffers
     StructuredBuffer<DDGIVolumeDescGPUPacked> DDGIVolumes = GetDDGIVolumeConstants(GetDDGIVolumeConstantsIndex());
@@ -32,14 +46,33 @@ void CS(uint3 GroupID : SV_GroupID, uint3 GroupThreadID : SV_GroupThreadID, uint
     // New dispatch pattern: GroupID.x = ray group index, GroupID.y = probe linear index
     int ProbeIndex = GroupID.y;
     int RayIndex = GroupID.x * 64 + GroupThreadID.x;
+#if PROBE_TRACE_BATCHED
+    ProbeIndex = BatchEntry.probeIndex;
+#endif
+
+    // Number of rays traced for the probe this frame (fewer than probeNumRays with adaptive rays)
+    int NumRays = volume.probeNumRays;
+
+    // Scheduled dispatch pattern: GroupID.y = index in the volume's probe schedule
+    if (volume.probeSchedulingEnabled)
+    {
+        RWByteAddressBuffer ProbeSchedule = GetDDGIProbeSchedule(ResourceIndices.probeScheduleUAVIndex);
+    #if PROBE_TRACE_BATCHED
+        // The batch reserves a row for every probe of the volume, skip the rows past the scheduled count
+        if ((uint)ProbeIndex >= ProbeSchedule.Load(RTXGI_DDGI_PROBE_SCHEDULE_TRACE_ARGS_OFFSET + 4))
+            return;
+    #endif
+        ProbeIndex = ProbeSchedule.Load(RTXGI_DDGI_PROBE_SCHEDULE_LIST_OFFSET + (ProbeIndex * 4));
+        NumRays = DDGIGetProbeNumRays(ProbeIndex, volume, ProbeSchedule);
+    }
 
-    // Bounds check for ray index (in case probeNumRays is not multiple of 64)
-    if (RayIndex >= volume.probeNumRays)
+    // Bounds check for ray index (in case the ray count is not multiple of 64)
+    if (RayIndex >= NumRays)
         return;
 
     // Calculate linear index for ProbeRayHitMap
     uint NumProbes = ProbeCount.x * ProbeCount.y * ProbeCount.z;
-    uint ProbeRayIndex = ProbeIndex * volume.probeNumRays + RayIndex;
+    uint ProbeRayIndex = HitMapOffset + ProbeIndex * volume.probeNumRays + RayIndex;
 
     // Get the ProbeRayHitMap buffer for storing hash ID and hit distance mapping
     // Format: .x = HashID (or INVALID), .y = asuint(HitDistance)
@@ -59,7 +92,7 @@ void CS(uint3 GroupID : SV_GroupID, uint3 GroupThreadID : SV_GroupThreadID, uint
     float3 probeWorldPosition = DDGIGetProbeWorldPosition(ProbeCoords, volume, ProbeData);
 
     // Get a random normalized ray direction to use for a probe ray
-    float3 probeRayDirection = DDGIGetProbeRayDirection(RayIndex, volume);
+    float3 probeRayDirection = DDGIGetProbeRayDirection(RayIndex, NumRays, volume);
 
     // Get the coordinates for the probe ray in the RayData texture array
     // Note: probe index is the scroll adjusted index (if scrolling is enabled)
@@ -81,10 +114,24 @@ void CS(uint3 GroupID : SV_GroupID, uint3 GroupThreadID : SV_GroupThreadID, uint
     RayQuery<RAY_FLAG_NONE> RQuery;
     RQuery.TraceRayInline(SceneTLAS,
             0,
-            0xFF,
+            GetDDGIVolumeInstanceMask(VolumeIndex),
             ray);
-    RQuery.Proceed();
-    if(RQuery.CommittedStatus() == COMMITTED_TRIANGLE_HIT)
+    while (RQuery.Proceed())
+    {
+        // Alpha test the non-opaque candidates (blended and masked primitives that can be cut out, see Caches::ClassifyOpaquePrimitives)
+        if (RQuery.CandidateType() == CANDIDATE_NON_OPAQUE_TRIANGLE &&
+            AlphaTestGI(RQuery.CandidateInstanceID(), RQuery.CandidateGeometryIndex(), RQuery.CandidatePrimitiveIndex(), RQuery.CandidateTriangleBarycentrics()))
+        {
+            RQuery.CommitNonOpaqueTriangleHit();
+        }
+    }
+
+    bool bHit = (RQuery.CommittedStatus() == COMMITTED_TRIANGLE_HIT);
+    GPUCounterIncrement(GPU_COUNTER_PROBE_RAYS, true);
+    GPUCounterIncrement(GPU_COUNTER_PROBE_RAY_HITS, bHit);
+    GPUCounterIncrement(GPU_COUNTER_PROBE_RAY_MISSES, !bHit);
+
+    if(bHit)
     {
         float RayDistance = RQuery.CommittedRayT();
 
@@ -110,7 +157,74 @@ void CS(uint3 GroupID : SV_GroupID, uint3 GroupThreadID : SV_GroupThreadID, uint
 
         RWStructuredBuffer<HitPackedData> HitCachingBuffer = GetHitCachingBuffer();
         float3 HitWorldPosition = probeWorldPosition + probeRayDirection * RayDistance;
-        uint HashID = SpatialHashCascadeIndex(HitWorldPosition, GetCascadeCellRadius(), GetMaxCacheCellCount(), GetCascadeCount(), GetCascadeBaseDistance());
+
+        // Quantize the hit once. Later passes reuse this grid coordinate instead of
+        // re-quantizing a reconstructed position, so every pass agrees on the cell key.
+        uint CascadeIndex;
+        int3 HitGridCoord;
+        SpatialHashCascadeGridCoord(
+            HitWorldPosition,
+            RayDistance,
+            GetCascadeCellRadius(),
+            GetCascadeCount(),
+            GetCascadeBaseDistance(),
+            CascadeIndex,
+            HitGridCoord);
+
+        // Find or claim the hit's cache slot (open addressing with bounded linear probing)
+        bool bEvicted;
+        bool bClaimed;
+        bool bFirstTouch;
+        uint HashID = SpatialHashGridInsert(
+            HitGridCoord,
+            CascadeIndex,
+            GetMaxCacheCellCount(),
+            GetRadianceCacheMetadataBuffer(),
+            GetGlobalConst(app, frameNumber),
+            bEvicted,
+            bClaimed,
+            bFirstTouch);
+
+        bool bValidSlot = (HashID != RADIANCE_CACHE_INVALID_SLOT);
+        GPUCounterIncrement(GPU_COUNTER_CACHE_HITS, bValidSlot && !bClaimed);
+        GPUCounterIncrement(GPU_COUNTER_CACHE_MISSES, bValidSlot && bClaimed);
+        GPUCounterIncrement(GPU_COUNTER_CACHE_COLLISIONS, !bValidSlot);
+        GPUCounterIncrement(GPU_COUNTER_CACHE_EVICTIONS, bValidSlot && bEvicted);
+    #if GPU_COUNTERS
+        // Count the probe rays that share the cell (reduced into the coverage stats by RadianceCacheStatsCS)
+        if (bValidSlot) GetRadianceCacheMetadataBuffer().InterlockedAdd(HashID * RADIANCE_CACHE_METADATA_STRIDE + RADIANCE_CACHE_METADATA_PROBE_RAYS_OFFSET, 1);
+    #endif
+
+        if (!bValidSlot)
+        {
+            // The probe sequence is saturated with live cells. Keep the ray's previous radiance,
+            // but update its hit distance so distance blending stays correct.
+            DDGIStoreProbeRayFrontfaceHit(RayData, outputCoords, volume, RayDistance);
+            ProbeRayHitMapBuffer[ProbeRayIndex] = uint2(PROBE_RAY_HIT_MAP_INVALID, 0);
+            return;
+        }
+
+        if (bEvicted)
+        {
+            // A stale cell was reclaimed, don't let the new cell inherit its radiance history
+            StoreCachedRadiance(HashID, float3(0.f, 0.f, 0.f));
+
+            // Reset the update budget history (last shaded frame, volatility)
+            GetRadianceCacheMetadataBuffer().Store2(HashID * RADIANCE_CACHE_METADATA_STRIDE + RADIANCE_CACHE_METADATA_SHADED_FRAME_OFFSET, uint2(0, 0));
+
+            // The light visibility cache belongs to the old cell's surface
+            GetRadianceCacheMetadataBuffer().Store3(HashID * RADIANCE_CACHE_METADATA_STRIDE + RADIANCE_CACHE_METADATA_LIGHT_VISIBILITY_OFFSET, uint3(0, 0, 0));
+        }
+
+        // A new cell starts with no indirect irradiance history (its confidence in the per-pixel gather)
+        // and an empty indirect sample reservoir, and records where its probe sequence starts for the compaction pass
+        if (bClaimed)
+        {
+            RadianceCacheReservoirClear(GetRadianceCacheReservoirBuffer(), HashID);
+            GetRadianceCachingVisualizationBuffer()[HashID].HistoryFrames = 0;
+            GetRadianceCachingVisualizationBuffer()[HashID].HomeSlot = SpatialHashGridHomeSlot(HitGridCoord, GetMaxCacheCellCount()) + (CascadeIndex * GetMaxCacheCellCount());
+        }
+
         HitUnpackedData NewUnpackedData;
         NewUnpackedData.ProbeIndex = ProbeIndex;
         NewUnpackedData.RayIndex = RayIndex;
@@ -120,10 +234,16 @@ void CS(uint3 GroupID : SV_GroupID, uint3 GroupThreadID : SV_GroupThreadID, uint
         NewUnpackedData.GeometryIndex = RQuery.CommittedGeometryIndex();
         NewUnpackedData.HitDistance = RayDistance;
         NewUnpackedData.Barycentrics = RQuery.CommittedTriangleBarycentrics();
+        NewUnpackedData.GridCoord = HitGridCoord;
+        NewUnpackedData.CascadeIndex = CascadeIndex;
+        NewUnpackedData.Checksum = SpatialHash_ChecksumGrid(HitGridCoord);
         HitPackedData NewPackedData;
         PackData(NewUnpackedData, NewPackedData);
         HitCachingBuffer[HashID] = NewPackedData;
 
+        // Schedule the slot for RadianceCacheCS once per frame
+        if (bFirstTouch) RadianceCacheWorkListAppend(HashID);
+
         // Store HashID AND HitDistance for resolve pass
         // Each ray needs its own HitDistance (not shared from hash cell)
         ProbeRayHitMapBuffer[ProbeRayIndex] = uint2(HashID, asuint(RayDistance));
@@ -85,28 +85,29 @@ void RayGen()
     RaytracingAccelerationStructure SceneTLAS = GetAccelerationStructure(SCENE_TLAS_INDEX);
 
 #if GFX_NVAPI
+    // Probe rays must hit back faces (probe relocation and classification detect probes inside geometry from them)
     if (GetPTShaderExecutionReordering())
     {
         NvHitObject hit;
         NvTraceRayHitObject(
             SceneTLAS,
-            RAY_FLAG_CULL_BACK_FACING_TRIANGLES,
-            0xFF,
+            RAY_FLAG_NONE,
+            GetDDGIVolumeInstanceMask(volumeIndex),
             0,
             0,
             0,
             ray,
             packedPayload,
             hit);
-        NvReorderThread(hit, 0, 0);
+        NvReorderThread(hit, GetReorderCoherenceHint(hit), SER_HINT_BITS);
         NvInvokeHitObject(SceneTLAS, hit, packedPayload);
     }
     else
     {
         TraceRay(
             SceneTLAS,
-            RAY_FLAG_CULL_BACK_FACING_TRIANGLES,
-            0xFF,
+            RAY_FLAG_NONE,
+            GetDDGIVolumeInstanceMask(volumeIndex),
             0,
             0,
             0,
@@ -118,7 +119,7 @@ void RayGen()
     TraceRay(
         SceneTLAS,
         RAY_FLAG_NONE,
-        0xFF,
+        GetDDGIVolumeInstanceMask(volumeIndex),
         0,
         0,
         0,
@@ -158,7 +159,7 @@ void RayGen()
     }
 
     // RWStructuredBuffer<HitCachingPayload> HitCachingBuffer = GetHitCachingBuffer();
-    // uint HashID = SpatialHashCascadeIndex(payload.worldPosition, GetCascadeCellRadius(), GetMaxCacheCellCount(), GetCascadeCount(), GetCascadeBaseDistance());
+    // uint HashID = SpatialHashCascadeIndex(payload.worldPosition, payload.hitT, GetCascadeCellRadius(), GetMaxCacheCellCount(), GetCascadeCount(), GetCascadeBaseDistance());
     // HitCachingPayload NewPayload;
     // NewPayload.payload = packedPayload;
     // NewPayload.isActived = true;
@@ -0,0 +1,71 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+// ============================================================================
+// RadianceCacheBudgetCS - Pick the radiance cache slots shaded this frame
+// ============================================================================
+//
+// Runs between RadianceCacheWorkListArgsCS and RadianceCacheCS:
+//   1. PriorityHistogramCS (indirect): count the listed slots per priority bucket
+//   2. ThresholdCS (1 thread):         walk the buckets from the highest priority
+//                                      down and stop at the one that fills the budget
+//
+// PriorityHistogramCS uses the work list dispatch arguments. The passes compile
+// to no-ops when RADIANCE_CACHE_RAY_BUDGET is 0.
+// ============================================================================
+
+// Default defines for DDGI SDK (should be overridden by compiler defines)
+#ifndef CONSTS_REGISTER
+#define CONSTS_REGISTER b0
+#endif
+
+#ifndef CONSTS_SPACE
+#define CONSTS_SPACE space1
+#endif
+
+#include "../include/Common.hlsl"
+#include "../include/Descriptors.hlsl"
+#include "../include/RadianceCacheWorkList.hlsl"
+#include "../include/RadianceCacheBudget.hlsl"
+
+[numthreads(RADIANCE_CACHE_WORK_LIST_GROUP_SIZE, 1, 1)]
+void PriorityHistogramCS(uint3 DispatchThreadID : SV_DispatchThreadID)
+{
+#if RADIANCE_CACHE_RAY_BUDGET > 0
+    uint Slot = GetRadianceCacheWorkList()[DispatchThreadID.x];
+    if (Slot == RADIANCE_CACHE_INVALID_SLOT) return;
+
+    uint Priority = RadianceCacheBudgetPriority(Slot, GetGlobalConst(app, frameNumber));
+    GetRadianceCacheBudgetBuffer().InterlockedAdd(Priority * 4, 1);
+#endif
+}
+
+[numthreads(1, 1, 1)]
+void ThresholdCS()
+{
+#if RADIANCE_CACHE_RAY_BUDGET > 0
+    RWByteAddressBuffer Budget = GetRadianceCacheBudgetBuffer();
+    uint Remaining = RadianceCacheBudgetSlotCount();
+
+    for (int Bucket = RADIANCE_CACHE_BUDGET_PRIORITY_BUCKETS - 1; Bucket >= 0; Bucket--)
+    {
+        uint Count = Budget.Load(Bucket * 4);
+        if (Count >= Remaining)
+        {
+            Budget.Store2(RADIANCE_CACHE_BUDGET_THRESHOLD_OFFSET, uint2(Bucket, Remaining));
+            return;
+        }
+        Remaining -= Count;
+    }
+
+    // Everything fits, shade every listed slot
+    Budget.Store2(RADIANCE_CACHE_BUDGET_THRESHOLD_OFFSET, uint2(0, Remaining));
+#endif
+}
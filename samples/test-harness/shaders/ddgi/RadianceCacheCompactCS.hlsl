@@ -0,0 +1,157 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+// ============================================================================
+// RadianceCacheCompactCS - Free stale radiance cache slots, shorten probe sequences
+// ============================================================================
+//
+// Runs every Globals::RadianceCacheCompactionInterval frames, before the probe
+// trace claims this frame's slots. One thread per slot in every pass:
+//   1. EvictCS:  free the slots not used for RADIANCE_CACHE_MAX_ENTRY_AGE frames
+//                (radiance, accumulation, history, and reservoir cleared). With open addressing
+//                the slot becomes a tombstone, otherwise it becomes empty.
+//   2. RehashCS: (open addressing) move each live cell that sits at least
+//                RADIANCE_CACHE_COMPACTION_REHASH_STEPS slots past its home slot
+//                to the first tombstone of its probe sequence, leaving a tombstone.
+//   3. TrimCS:   (open addressing) turn a tombstone back to empty when no live cell
+//                within a probe sequence length after it could walk through it.
+//
+// Tombstones keep every probe sequence that ran through a freed slot intact, so
+// lookups still find the cells behind it. See SpatialHash.hlsl.
+// ============================================================================
+
+// Default defines for DDGI SDK (should be overridden by compiler defines)
+#ifndef CONSTS_REGISTER
+#define CONSTS_REGISTER b0
+#endif
+
+#ifndef CONSTS_SPACE
+#define CONSTS_SPACE space1
+#endif
+
+// MAX_ENTRY_AGE: Frames since last use after which a slot is freed (see RadianceCacheCS.hlsl)
+#ifndef RADIANCE_CACHE_MAX_ENTRY_AGE
+#define RADIANCE_CACHE_MAX_ENTRY_AGE 8
+#endif
+
+// COMPACTION_REHASH_STEPS: Minimum distance from the home slot at which a live cell is moved
+#ifndef RADIANCE_CACHE_COMPACTION_REHASH_STEPS
+#define RADIANCE_CACHE_COMPACTION_REHASH_STEPS 2
+#endif
+
+#include "../include/Common.hlsl"
+#include "../include/Descriptors.hlsl"
+#include "../include/SpatialHash.hlsl"
+#include "../include/RadianceCacheReservoir.hlsl"
+
+#define RADIANCE_CACHE_COMPACT_GROUP_SIZE 64
+
+bool IsLiveKey(uint Key)
+{
+    return (Key != 0) && (Key != RADIANCE_CACHE_TOMBSTONE_KEY);
+}
+
+[numthreads(RADIANCE_CACHE_COMPACT_GROUP_SIZE, 1, 1)]
+void EvictCS(uint3 DispatchThreadID : SV_DispatchThreadID)
+{
+    uint Slot = DispatchThreadID.x;
+    if (Slot >= GetMaxCacheCellCount() * GetCascadeCount()) return;
+
+    RWByteAddressBuffer Metadata = GetRadianceCacheMetadataBuffer();
+    uint MetaOffset = Slot * RADIANCE_CACHE_METADATA_STRIDE;
+    uint2 Meta = Metadata.Load2(MetaOffset);
+    if (!IsLiveKey(Meta.x)) return;
+
+    uint Age = GetGlobalConst(app, frameNumber) - Meta.y;
+    if (Age <= RADIANCE_CACHE_MAX_ENTRY_AGE) return;
+
+    // Free the slot: key, last used frame, the update budget history, and the light visibility cache
+#if RADIANCE_CACHE_USE_OPEN_ADDRESSING
+    Metadata.Store4(MetaOffset, uint4(RADIANCE_CACHE_TOMBSTONE_KEY, 0, 0, 0));
+#else
+    Metadata.Store4(MetaOffset, uint4(0, 0, 0, 0));
+#endif
+    Metadata.Store4(MetaOffset + RADIANCE_CACHE_METADATA_LIGHT_VISIBILITY_OFFSET, uint4(0, 0, 0, 0));
+
+    StoreCachedRadiance(Slot, float3(0.f, 0.f, 0.f));
+    GetRadianceCacheAccumulationByteBuffer().Store4(Slot * 16, uint4(0, 0, 0, 0));
+    GetRadianceCachingVisualizationBuffer()[Slot] = (RadianceCacheVisualization)0;
+    RadianceCacheReservoirClear(GetRadianceCacheReservoirBuffer(), Slot);
+}
+
+[numthreads(RADIANCE_CACHE_COMPACT_GROUP_SIZE, 1, 1)]
+void RehashCS(uint3 DispatchThreadID : SV_DispatchThreadID)
+{
+#if RADIANCE_CACHE_USE_OPEN_ADDRESSING
+    uint CellNum = GetMaxCacheCellCount();
+    uint Slot = DispatchThreadID.x;
+    if (Slot >= CellNum * GetCascadeCount()) return;
+
+    RWByteAddressBuffer Metadata = GetRadianceCacheMetadataBuffer();
+    uint Key = Metadata.Load(Slot * RADIANCE_CACHE_METADATA_STRIDE);
+    if (!IsLiveKey(Key)) return;
+
+    // Distance from the home slot along the probe sequence (which wraps within the cascade)
+    RWStructuredBuffer<RadianceCacheVisualization> Visualization = GetRadianceCachingVisualizationBuffer();
+    uint CascadeOffset = (Slot / CellNum) * CellNum;
+    uint HomeSlot = Visualization[Slot].HomeSlot - CascadeOffset;
+    uint Steps = ((Slot - CascadeOffset) + CellNum - HomeSlot) % CellNum;
+    if (Steps < RADIANCE_CACHE_COMPACTION_REHASH_STEPS || Steps >= RADIANCE_CACHE_PROBE_SEQUENCE_LENGTH) return;
+
+    for (uint Step = 0; Step < Steps; Step++)
+    {
+        uint Target = CascadeOffset + ((HomeSlot + Step) % CellNum);
+        uint TargetMetaOffset = Target * RADIANCE_CACHE_METADATA_STRIDE;
+
+        // Claim the tombstone, other cells moving down the same sequence race for it
+        uint PreviousKey;
+        Metadata.InterlockedCompareExchange(TargetMetaOffset, RADIANCE_CACHE_TOMBSTONE_KEY, Key, PreviousKey);
+        if (PreviousKey != RADIANCE_CACHE_TOMBSTONE_KEY) continue;
+
+        // Move the cell, then free its old slot (no lookups run during compaction)
+        Metadata.Store3(TargetMetaOffset + 4, Metadata.Load3((Slot * RADIANCE_CACHE_METADATA_STRIDE) + 4));
+        Metadata.Store4(TargetMetaOffset + RADIANCE_CACHE_METADATA_LIGHT_VISIBILITY_OFFSET, Metadata.Load4((Slot * RADIANCE_CACHE_METADATA_STRIDE) + RADIANCE_CACHE_METADATA_LIGHT_VISIBILITY_OFFSET));
+        GetRadianceCachingBuffer()[Target] = GetRadianceCachingBuffer()[Slot];
+        GetHitCachingBuffer()[Target] = GetHitCachingBuffer()[Slot];
+        Visualization[Target] = Visualization[Slot];
+        GetRadianceCacheReservoirBuffer().Store4(Target * RADIANCE_CACHE_RESERVOIR_STRIDE, GetRadianceCacheReservoirBuffer().Load4(Slot * RADIANCE_CACHE_RESERVOIR_STRIDE));
+        DeviceMemoryBarrier();
+
+        Metadata.Store4(Slot * RADIANCE_CACHE_METADATA_STRIDE, uint4(RADIANCE_CACHE_TOMBSTONE_KEY, 0, 0, 0));
+        Metadata.Store4((Slot * RADIANCE_CACHE_METADATA_STRIDE) + RADIANCE_CACHE_METADATA_LIGHT_VISIBILITY_OFFSET, uint4(0, 0, 0, 0));
+        return;
+    }
+#endif
+}
+
+[numthreads(RADIANCE_CACHE_COMPACT_GROUP_SIZE, 1, 1)]
+void TrimCS(uint3 DispatchThreadID : SV_DispatchThreadID)
+{
+#if RADIANCE_CACHE_USE_OPEN_ADDRESSING
+    uint CellNum = GetMaxCacheCellCount();
+    uint Slot = DispatchThreadID.x;
+    if (Slot >= CellNum * GetCascadeCount()) return;
+
+    RWByteAddressBuffer Metadata = GetRadianceCacheMetadataBuffer();
+    if (Metadata.Load(Slot * RADIANCE_CACHE_METADATA_STRIDE) != RADIANCE_CACHE_TOMBSTONE_KEY) return;
+
+    // A live cell is never more than a probe sequence length past its home slot, so if the
+    // slots that follow hold no live cell, no lookup walks through this one to reach a cell.
+    // Neighbouring tombstones may be emptied concurrently, which doesn't change the outcome.
+    uint CascadeOffset = (Slot / CellNum) * CellNum;
+    for (uint Step = 1; Step < RADIANCE_CACHE_PROBE_SEQUENCE_LENGTH; Step++)
+    {
+        uint Next = CascadeOffset + (((Slot - CascadeOffset) + Step) % CellNum);
+        if (IsLiveKey(Metadata.Load(Next * RADIANCE_CACHE_METADATA_STRIDE))) return;
+    }
+
+    Metadata.Store(Slot * RADIANCE_CACHE_METADATA_STRIDE, 0);
+#endif
+}
@@ -0,0 +1,114 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+// ============================================================================
+// RadianceCacheSortCS - Order the radiance cache work list by material
+// ============================================================================
+//
+// Single digit counting sort of the work list, keyed by the hit's
+// (InstanceIndex, GeometryIndex). Runs between RadianceCacheWorkListArgsCS
+// and RadianceCacheCS:
+//   1. HistogramCS (indirect): count the listed slots per sort bin
+//   2. PrefixSumCS (1 group):  convert the bin counts to exclusive offsets
+//   3. ScatterCS   (indirect): write each slot to its bin in the sorted list
+//
+// HistogramCS and ScatterCS use the work list dispatch arguments, so the
+// sorted list keeps the INVALID padding of the last thread group. The passes
+// compile to no-ops when RADIANCE_CACHE_SORT_WORK_LIST is disabled.
+// ============================================================================
+
+// Default defines for DDGI SDK (should be overridden by compiler defines)
+#ifndef CONSTS_REGISTER
+#define CONSTS_REGISTER b0
+#endif
+
+#ifndef CONSTS_SPACE
+#define CONSTS_SPACE space1
+#endif
+
+#include "../include/Common.hlsl"
+#include "../include/Descriptors.hlsl"
+#include "../include/RadianceCacheWorkList.hlsl"
+
+#define RADIANCE_CACHE_SORT_BINS_PER_THREAD (RADIANCE_CACHE_SORT_BIN_COUNT / RADIANCE_CACHE_SORT_SCAN_GROUP_SIZE)
+
+groupshared uint ScanSums[RADIANCE_CACHE_SORT_SCAN_GROUP_SIZE];
+
+[numthreads(RADIANCE_CACHE_WORK_LIST_GROUP_SIZE, 1, 1)]
+void HistogramCS(uint3 DispatchThreadID : SV_DispatchThreadID)
+{
+#if RADIANCE_CACHE_SORT_WORK_LIST
+    uint Slot = GetRadianceCacheWorkList()[DispatchThreadID.x];
+    if (Slot == RADIANCE_CACHE_INVALID_SLOT) return;
+
+    RWStructuredBuffer<uint> Bins = GetRadianceCacheSortBins();
+    uint Bin = RadianceCacheSortBin(GetHitCachingBuffer()[Slot]);
+    InterlockedAdd(Bins[Bin], 1);
+#endif
+}
+
+[numthreads(RADIANCE_CACHE_SORT_SCAN_GROUP_SIZE, 1, 1)]
+void PrefixSumCS(uint ThreadIndexInGroup : SV_GroupIndex)
+{
+#if RADIANCE_CACHE_SORT_WORK_LIST
+    RWStructuredBuffer<uint> Bins = GetRadianceCacheSortBins();
+    uint FirstBin = ThreadIndexInGroup * RADIANCE_CACHE_SORT_BINS_PER_THREAD;
+
+    // Sum this thread's contiguous run of bins
+    uint ThreadSum = 0;
+    uint Bin;
+    for (Bin = 0; Bin < RADIANCE_CACHE_SORT_BINS_PER_THREAD; Bin++)
+    {
+        ThreadSum += Bins[FirstBin + Bin];
+    }
+    ScanSums[ThreadIndexInGroup] = ThreadSum;
+    GroupMemoryBarrierWithGroupSync();
+
+    // Inclusive scan of the per-thread sums (Hillis-Steele)
+    for (uint Offset = 1; Offset < RADIANCE_CACHE_SORT_SCAN_GROUP_SIZE; Offset <<= 1)
+    {
+        uint Value = (ThreadIndexInGroup >= Offset) ? ScanSums[ThreadIndexInGroup - Offset] : 0;
+        GroupMemoryBarrierWithGroupSync();
+        ScanSums[ThreadIndexInGroup] += Value;
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    // Write exclusive offsets for this thread's bins
+    uint Running = ScanSums[ThreadIndexInGroup] - ThreadSum;
+    for (Bin = 0; Bin < RADIANCE_CACHE_SORT_BINS_PER_THREAD; Bin++)
+    {
+        uint Count = Bins[FirstBin + Bin];
+        Bins[FirstBin + Bin] = Running;
+        Running += Count;
+    }
+#endif
+}
+
+[numthreads(RADIANCE_CACHE_WORK_LIST_GROUP_SIZE, 1, 1)]
+void ScatterCS(uint3 DispatchThreadID : SV_DispatchThreadID)
+{
+#if RADIANCE_CACHE_SORT_WORK_LIST
+    RWStructuredBuffer<uint> SortedWorkList = GetRadianceCacheSortedWorkList();
+
+    uint Slot = GetRadianceCacheWorkList()[DispatchThreadID.x];
+    if (Slot == RADIANCE_CACHE_INVALID_SLOT)
+    {
+        // Padding sits past the last valid entry, carry it over to the sorted list
+        SortedWorkList[DispatchThreadID.x] = RADIANCE_CACHE_INVALID_SLOT;
+        return;
+    }
+
+    RWStructuredBuffer<uint> Bins = GetRadianceCacheSortBins();
+    uint Bin = RadianceCacheSortBin(GetHitCachingBuffer()[Slot]);
+    uint SortedIndex;
+    InterlockedAdd(Bins[Bin], 1, SortedIndex);
+    SortedWorkList[SortedIndex] = Slot;
+#endif
+}
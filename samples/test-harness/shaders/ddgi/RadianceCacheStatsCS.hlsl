@@ -0,0 +1,87 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+// ============================================================================
+// RadianceCacheStatsCS - Reduce the radiance cache metadata to occupancy stats
+// ============================================================================
+//
+// Runs at the end of the probe update chain (with GPU_COUNTERS), one thread per
+// slot of the hash table. Sums, per cascade, the occupied slots, the live slots
+// (used within RADIANCE_CACHE_EVICT_AGE frames), the age of the live slots, and the
+// distance of the live slots from their home slots (probe sequence steps, a measure
+// of RADIANCE_CACHE_HASH_FUNCTION's collisions) into the RadianceCacheStats buffer.
+// It also reduces the probe rays that hit each cell this frame (counted by ProbeTraceCS
+// in the cell's metadata) into the per cascade coverage stats and histogram, and moves
+// the count to the cell's RadianceCacheVisualization for the coverage heatmap
+// (see Composite.hlsl). Probe rays per covered cell is the cache's amortization factor. (see GPUCounters.hlsl). The application
+// copies the buffer to the GPU counters readback buffer, then clears it.
+// ============================================================================
+
+// Default defines for DDGI SDK (should be overridden by compiler defines)
+#ifndef CONSTS_REGISTER
+#define CONSTS_REGISTER b0
+#endif
+
+#ifndef CONSTS_SPACE
+#define CONSTS_SPACE space1
+#endif
+
+#include "../include/Common.hlsl"
+#include "../include/Descriptors.hlsl"
+#include "../include/SpatialHash.hlsl"
+#include "../include/GPUCounters.hlsl"
+
+[numthreads(64, 1, 1)]
+void CS(uint3 DispatchThreadID : SV_DispatchThreadID)
+{
+#if GPU_COUNTERS
+    uint Slot = DispatchThreadID.x;
+    if (Slot >= GetMaxCacheCellCount() * GetCascadeCount()) return;
+
+    uint2 Meta = GetRadianceCacheMetadataBuffer().Load2(Slot * RADIANCE_CACHE_METADATA_STRIDE);
+    uint Age = GetGlobalConst(app, frameNumber) - Meta.y;
+
+    bool bOccupied = (Meta.x != 0) && (Meta.x != RADIANCE_CACHE_TOMBSTONE_KEY);
+    bool bLive = bOccupied && (Age < RADIANCE_CACHE_EVICT_AGE);
+    uint Cascade = Slot / GetMaxCacheCellCount();
+
+    // Probe rays that hit the cell this frame, restart the count for the next frame
+    uint ProbeRays = 0;
+    if (bOccupied)
+    {
+        uint ProbeRaysOffset = (Slot * RADIANCE_CACHE_METADATA_STRIDE) + RADIANCE_CACHE_METADATA_PROBE_RAYS_OFFSET;
+        ProbeRays = GetRadianceCacheMetadataBuffer().Load(ProbeRaysOffset);
+        if (ProbeRays > 0) GetRadianceCacheMetadataBuffer().Store(ProbeRaysOffset, 0);
+        GetRadianceCachingVisualizationBuffer()[Slot].ProbeRays = ProbeRays;
+    }
+
+    // Probe sequence steps from the cell's home slot to the slot it owns
+    uint Steps = 0;
+    if (bLive)
+    {
+        uint CascadeOffset = Cascade * GetMaxCacheCellCount();
+        uint HomeSlot = GetRadianceCachingVisualizationBuffer()[Slot].HomeSlot - CascadeOffset;
+        Steps = ((Slot - CascadeOffset) + GetMaxCacheCellCount() - HomeSlot) % GetMaxCacheCellCount();
+    }
+
+    // A wave spans at most a few cascades, reduce each in turn so the buffer sees one set of atomics per cascade and wave
+    for (;;)
+    {
+        uint WaveCascade = WaveReadLaneFirst(Cascade);
+        if (Cascade == WaveCascade)
+        {
+            uint4 Sums = uint4(WaveActiveCountBits(bOccupied), WaveActiveCountBits(bLive), WaveActiveSum(bLive ? Age : 0), WaveActiveSum(Steps));
+            if (WaveIsFirstLane()) RadianceCacheStatsAdd(WaveCascade, Sums);
+            RadianceCacheCoverageAdd(WaveCascade, ProbeRays);
+            break;
+        }
+    }
+#endif
+}
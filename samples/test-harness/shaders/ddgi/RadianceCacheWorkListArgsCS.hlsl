@@ -0,0 +1,88 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+// ============================================================================
+// RadianceCacheWorkListArgsCS - Build the indirect dispatch for RadianceCacheCS
+// ============================================================================
+//
+// Runs as a single thread group after ProbeTraceCS:
+//   1. Read the number of slots ProbeTraceCS appended to the work list
+//   2. Pad the last thread group of the list with RADIANCE_CACHE_INVALID_SLOT
+//   3. Write the dispatch arguments and reset the append counter for the next frame
+//   4. Clear the sort bins when RADIANCE_CACHE_SORT_WORK_LIST is enabled
+//   5. Clear the priority histogram when RADIANCE_CACHE_RAY_BUDGET is set
+//
+// With open addressing disabled, ProbeTraceCS does not append and the
+// arguments cover the whole hash table instead.
+// ============================================================================
+
+// Default defines for DDGI SDK (should be overridden by compiler defines)
+#ifndef CONSTS_REGISTER
+#define CONSTS_REGISTER b0
+#endif
+
+#ifndef CONSTS_SPACE
+#define CONSTS_SPACE space1
+#endif
+
+#include "../include/Common.hlsl"
+#include "../include/Descriptors.hlsl"
+#include "../include/RadianceCacheWorkList.hlsl"
+#include "../include/RadianceCacheBudget.hlsl"
+
+groupshared uint WorkListCount;
+
+[numthreads(RADIANCE_CACHE_WORK_LIST_GROUP_SIZE, 1, 1)]
+void CS(uint ThreadIndexInGroup : SV_GroupIndex)
+{
+    RWByteAddressBuffer WorkListArgs = GetRadianceCacheWorkListArgs();
+
+#if RADIANCE_CACHE_USE_OPEN_ADDRESSING
+    if (ThreadIndexInGroup == 0)
+    {
+        WorkListCount = WorkListArgs.Load(RADIANCE_CACHE_WORK_LIST_ARGS_COUNT_OFFSET);
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    uint Count = WorkListCount;
+    uint NumGroups = (Count + RADIANCE_CACHE_WORK_LIST_GROUP_SIZE - 1) / RADIANCE_CACHE_WORK_LIST_GROUP_SIZE;
+
+    // Pad the partially filled last group so RadianceCacheCS can skip the tail without a count
+    uint PadIndex = Count + ThreadIndexInGroup;
+    if (PadIndex < NumGroups * RADIANCE_CACHE_WORK_LIST_GROUP_SIZE)
+    {
+        GetRadianceCacheWorkList()[PadIndex] = RADIANCE_CACHE_INVALID_SLOT;
+    }
+
+#if RADIANCE_CACHE_SORT_WORK_LIST
+    // Clear the counting sort bins for this frame's histogram
+    for (uint Bin = ThreadIndexInGroup; Bin < RADIANCE_CACHE_SORT_BIN_COUNT; Bin += RADIANCE_CACHE_WORK_LIST_GROUP_SIZE)
+    {
+        GetRadianceCacheSortBins()[Bin] = 0;
+    }
+#endif
+
+#if RADIANCE_CACHE_RAY_BUDGET > 0
+    // Clear the update budget priority histogram
+    for (uint Bucket = ThreadIndexInGroup; Bucket < RADIANCE_CACHE_BUDGET_PRIORITY_BUCKETS; Bucket += RADIANCE_CACHE_WORK_LIST_GROUP_SIZE)
+    {
+        GetRadianceCacheBudgetBuffer().Store(Bucket * 4, 0);
+    }
+#endif
+#else
+    uint NumGroups = (GetMaxCacheCellCount() * GetCascadeCount() + RADIANCE_CACHE_WORK_LIST_GROUP_SIZE - 1) / RADIANCE_CACHE_WORK_LIST_GROUP_SIZE;
+#endif
+
+    if (ThreadIndexInGroup == 0)
+    {
+        WorkListArgs.Store3(RADIANCE_CACHE_WORK_LIST_ARGS_DISPATCH_OFFSET, uint3(NumGroups, 1, 1));
+        WorkListArgs.Store(RADIANCE_CACHE_WORK_LIST_ARGS_COUNT_OFFSET, 0);
+    }
+}
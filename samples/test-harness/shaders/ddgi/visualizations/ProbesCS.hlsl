@@ -118,7 +118,7 @@ void CS(uint3 GroupID : SV_GroupID, uint3 GroupThreadID : SV_GroupThreadID, uint
     RWTexture2D<float4> GBufferB = GetRWTex2D(GBUFFERB_INDEX);
     RaytracingAccelerationStructure DDGIProbeVisTLAS = GetAccelerationStructure(DDGIPROBEVIS_TLAS_INDEX);
 
-    GBufferA.GetDimensions(LaunchDimensions.x, LaunchDimensions.y);
+    LaunchDimensions = GetRenderResolution();
 
     // Early exit for out-of-bounds threads
     if (LaunchIndex.x >= LaunchDimensions.x || LaunchIndex.y >= LaunchDimensions.y) return;
@@ -236,7 +236,7 @@ void CS_HideInactive(uint3 GroupID : SV_GroupID, uint3 GroupThreadID : SV_GroupT
     RWTexture2D<float4> GBufferB = GetRWTex2D(GBUFFERB_INDEX);
     RaytracingAccelerationStructure DDGIProbeVisTLAS = GetAccelerationStructure(DDGIPROBEVIS_TLAS_INDEX);
 
-    GBufferA.GetDimensions(LaunchDimensions.x, LaunchDimensions.y);
+    LaunchDimensions = GetRenderResolution();
 
     // Early exit for out-of-bounds threads
     if (LaunchIndex.x >= LaunchDimensions.x || LaunchIndex.y >= LaunchDimensions.y) return;
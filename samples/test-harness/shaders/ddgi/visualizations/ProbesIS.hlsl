@@ -0,0 +1,38 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#include "../../../include/graphics/Types.h"
+
+// ---[ Intersection Shader ]---
+
+/**
+ * Intersect the procedural probe sphere: a sphere with a radius of 0.5 at the origin of its AABB (like the icosphere LODs).
+ * Only the ray's entry into the sphere is reported, like the culled back faces of the triangle spheres.
+ */
+[shader("intersection")]
+void IS()
+{
+    // The object space ray is not normalized, its hit distances are the world space hit distances
+    float3 origin = ObjectRayOrigin();
+    float3 direction = ObjectRayDirection();
+
+    float a = dot(direction, direction);
+    float b = dot(origin, direction);
+    float c = dot(origin, origin) - 0.25f;
+    float discriminant = (b * b) - (a * c);
+    if (discriminant < 0.f || c < 0.f) return;
+
+    float hitT = (-b - sqrt(discriminant)) / a;
+    if (hitT >= RayTMin() && hitT <= RayTCurrent())
+    {
+        BuiltInTriangleIntersectionAttributes attrib = (BuiltInTriangleIntersectionAttributes)0;
+        ReportHit(hitT, 0, attrib);
+    }
+}
@@ -11,6 +11,7 @@
 #include "../../include/Common.hlsl"
 #include "../../include/Descriptors.hlsl"
 #include "../../include/RayTracing.hlsl"
+#include "../../include/VisibilityBuffer.hlsl"
 
 #include "../../../../../rtxgi-sdk/shaders/ddgi/include/ProbeCommon.hlsl"
 #include "../../../../../rtxgi-sdk/shaders/ddgi/include/DDGIRootConstants.hlsl"
@@ -103,6 +104,21 @@ void WriteResult(
     GBufferBOutput[LaunchIndex].w = hitT;
 }
 
+/**
+ * Depth of the closest surface in the GBuffer: a visualization written this frame or the primary ray hit.
+ */
+float GetGBufferDepth(
+    uint2 LaunchIndex,
+    RWTexture2D<float4> GBufferA,
+    RWTexture2D<float4> GBufferB)
+{
+#if GBUFFER_VISIBILITY
+    // GBufferB is only written by visualizations, the primary ray hit distance is reconstructed
+    if (GBufferA[LaunchIndex].w >= COMPOSITE_FLAG_POSTPROCESS_PIXEL) return GBufferLoadWorldPosHitT(LaunchIndex).w;
+#endif
+    return GBufferB[LaunchIndex].w;
+}
+
 // ---[ Ray Generation Shaders ]---
 
 [shader("raygeneration")]
@@ -151,7 +167,7 @@ void RayGen()
         // If the GBuffer doesn't contain geometry or a visualization
         // probe is hit by a primary ray - and the probe is the
         // closest surface - overwrite GBufferA with probe information.
-        float depth = GBufferB[LaunchIndex].w;
+        float depth = GetGBufferDepth(LaunchIndex, GBufferA, GBufferB);
         if(depth < 0.f || payload.hitT < depth)
         {
             // Get the DDGIVolume index
@@ -268,7 +284,7 @@ void RayGenHideInactive()
             // If the GBuffer doesn't contain geometry or a visualization
             // probe is hit by a primary ray - and the probe is the
             // closest surface - overwrite GBufferA with probe information.
-            float depth = GBufferB[LaunchIndex].w;
+            float depth = GetGBufferDepth(LaunchIndex, GBufferA, GBufferB);
             if (depth < 0.f || payload.hitT < depth)
             {
                 // Get the DDGIVolume index
@@ -0,0 +1,264 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#include "../../include/Common.hlsl"
+#include "../../include/Descriptors.hlsl"
+#include "../../include/VisibilityBuffer.hlsl"
+
+#include "../../../../../rtxgi-sdk/shaders/ddgi/include/ProbeCommon.hlsl"
+#include "../../../../../rtxgi-sdk/shaders/ddgi/include/DDGIRootConstants.hlsl"
+
+// Rasterized probe visualization, one instance per probe of the volume (DrawInstanced(4, numProbes)).
+// Each probe is drawn as a camera facing quad that bounds the probe sphere, the pixel shader intersects
+// the pixel's primary ray with the sphere and writes the same GBuffer values as ProbesRGS.hlsl. The GBuffer
+// is accessed through rasterizer ordered views, so the closest probe wins without a depth buffer.
+
+#define PROBE_VIS_TYPE_DEFAULT 0        // EDDGIVolumeProbeVisType::Default
+#define PROBE_VIS_TYPE_HIDE_INACTIVE 1  // EDDGIVolumeProbeVisType::Hide_Inactive
+
+// ---[ Structures ]---
+
+struct PSInput
+{
+    float4                 position      : SV_POSITION;
+    nointerpolation float3 probePosition : PROBE_POSITION;
+    nointerpolation uint   probeIndex    : PROBE_INDEX;
+};
+
+// ---[ Helpers ]---
+
+float3 GetProbeData(
+    int probeIndex,
+    int3 probeCoords,
+    float3 worldPosition,
+    DDGIVolumeResourceIndices resourceIndices,
+    DDGIVolumeDescGPU volume,
+    out float3 sampleDirection)
+{
+    float3 color = float3(0.f, 0.f, 0.f);
+
+    // Get the probe data texture array
+    Texture2DArray<float4> ProbeData = GetTex2DArray(resourceIndices.probeDataSRVIndex);
+
+    // Get the probe's world-space position
+    float3 probePosition = DDGIGetProbeWorldPosition(probeCoords, volume, ProbeData);
+
+    // Get the octahedral coordinates for the direction
+    sampleDirection = normalize(worldPosition - probePosition);
+    float2 octantCoords = DDGIGetOctahedralCoordinates(sampleDirection);
+
+    // Get the probe data type to visualize
+    uint type = GetGlobalConst(ddgivis, probeType);
+    if (type == RTXGI_DDGI_VISUALIZE_PROBE_IRRADIANCE)
+    {
+        // Get the volume's irradiance texture array
+        Texture2DArray<float4> ProbeIrradiance = GetTex2DArray(resourceIndices.probeIrradianceSRVIndex);
+
+        // Get the texture array uv coordinates for the octant of the probe
+        float3 uv = DDGIGetProbeUV(probeIndex, octantCoords, volume.probeNumIrradianceInteriorTexels, volume);
+
+        // Sample the irradiance texture
+        color = ProbeIrradiance.SampleLevel(GetBilinearWrapSampler(), uv, 0).rgb;
+
+        // Decode the tone curve
+        float3 exponent = volume.probeIrradianceEncodingGamma * 0.5f;
+        color = pow(color, exponent);
+
+        // Go back to linear irradiance
+        color *= color;
+
+        // Multiply by the area of the integration domain (2PI) to complete the irradiance estimate. Divide by PI to normalize for the display.
+        color *= 2.f;
+
+        // Adjust for energy loss due to reduced precision in the R10G10B10A2 irradiance texture format
+        if (volume.probeIrradianceFormat == RTXGI_DDGI_VOLUME_TEXTURE_FORMAT_U32)
+        {
+            color *= 1.0989f;
+        }
+    }
+    else if (type == RTXGI_DDGI_VISUALIZE_PROBE_DISTANCE)
+    {
+        // Get the volume's distance texture array
+        Texture2DArray<float4> ProbeDistance = GetTex2DArray(resourceIndices.probeDistanceSRVIndex);
+
+        // Get the texture array uv coordinates for the octant of the probe
+        float3 uv = DDGIGetProbeUV(probeIndex, octantCoords, volume.probeNumDistanceInteriorTexels, volume);
+
+        // Sample the distance texture and reconstruct the depth
+        float distance = 2.f * ProbeDistance.SampleLevel(GetBilinearWrapSampler(), uv, 0).r;
+
+        // Normalize the distance for visualization
+        float value = saturate(distance / GetGlobalConst(ddgivis, distanceDivisor));
+        color = float3(value, value, value);
+    }
+
+    return color;
+}
+
+/**
+ * Projects a world-space position with the camera used for the primary rays (see GetPrimaryRayDirection()).
+ */
+float4 GetClipPosition(float3 worldPosition)
+{
+    float3 view = worldPosition - GetCamera().position;
+    float  depth = dot(view, GetCamera().forward);
+
+    float4 position;
+    position.x = dot(view, GetCamera().right) / (GetCamera().aspect * GetCamera().tanHalfFovY);
+    position.y = dot(view, GetCamera().up) / GetCamera().tanHalfFovY;
+    position.z = depth * 0.5f;
+    position.w = depth;
+    return position;
+}
+
+// ---[ Vertex Shader ]---
+
+PSInput VS(uint VertexID : SV_VertexID, uint InstanceID : SV_InstanceID)
+{
+    PSInput result = (PSInput)0;
+
+    // Get the DDGIVolume index from root/push constants
+    uint volumeIndex = GetDDGIVolumeIndex();
+
+    // Get the DDGIVolume structured buffers
+    StructuredBuffer<DDGIVolumeDescGPUPacked> DDGIVolumes = GetDDGIVolumeConstants(GetDDGIVolumeConstantsIndex());
+    StructuredBuffer<DDGIVolumeResourceIndices> DDGIVolumeBindless = GetDDGIVolumeResourceIndices(GetDDGIVolumeResourceIndicesIndex());
+
+    // Load and unpack the DDGIVolume's constants
+    DDGIVolumeDescGPU volume = UnpackDDGIVolumeDescGPU(DDGIVolumes[volumeIndex]);
+
+    // Get the DDGIVolume's bindless resource indices
+    DDGIVolumeResourceIndices resourceIndices = DDGIVolumeBindless[volumeIndex];
+
+    // Get the probe data texture array
+    Texture2DArray<float4> ProbeData = GetTex2DArray(resourceIndices.probeDataSRVIndex);
+
+    // Get the probe's world position from the probe index
+    float3 probeCoords = DDGIGetProbeCoords(InstanceID, volume);
+    float3 probePosition = DDGIGetProbeWorldPosition(probeCoords, volume, ProbeData);
+    float  probeRadius = GetGlobalConst(ddgivis, probeRadius);
+
+    // Cull the probe if the camera is inside of it
+    float3 toCamera = GetCamera().position - probePosition;
+    float  distance = length(toCamera);
+    bool   culled = (distance <= probeRadius);
+
+    // Cull inactive probes
+    if (GetGlobalConst(ddgivis, probeVisType) == PROBE_VIS_TYPE_HIDE_INACTIVE)
+    {
+        int probeIndex = DDGIGetScrollingProbeIndex(probeCoords, volume);
+        float probeState = ProbeData[DDGIGetProbeTexelCoords(probeIndex, volume)].w;
+        culled = culled || (probeState == RTXGI_DDGI_PROBE_STATE_INACTIVE);
+    }
+
+    // Culled probes are degenerate quads
+    if (culled) return result;
+
+    // A camera facing quad, moved toward the camera by the radius and with a half size of the radius, covers the sphere's silhouette
+    float3 axisZ = toCamera / distance;
+    float3 reference = (abs(dot(axisZ, GetCamera().up)) < 0.99f) ? GetCamera().up : GetCamera().right;
+    float3 axisX = normalize(cross(reference, axisZ));
+    float3 axisY = cross(axisZ, axisX);
+
+    float2 corner = float2((VertexID & 1) ? 1.f : -1.f, (VertexID & 2) ? 1.f : -1.f);
+    float3 worldPosition = probePosition + ((axisZ + (corner.x * axisX) + (corner.y * axisY)) * probeRadius);
+
+    result.position = GetClipPosition(worldPosition);
+    result.probePosition = probePosition;
+    result.probeIndex = InstanceID;
+    return result;
+}
+
+// ---[ Pixel Shader ]---
+
+void PS(PSInput input)
+{
+    uint2 pixel = uint2(input.position.xy);
+
+    // Get the (bindless) resources
+    RasterizerOrderedTexture2D<float4> GBufferA = GetROVTex2D(GBUFFERA_INDEX);
+    RasterizerOrderedTexture2D<float4> GBufferB = GetROVTex2D(GBUFFERB_INDEX);
+
+    uint2 dimensions = GetRenderResolution();
+
+    // Intersect the pixel's primary ray with the probe sphere (hit distances are in the units of the ray direction, like ProbesRGS.hlsl)
+    float3 origin = GetCamera().position;
+    float3 direction = GetPrimaryRayDirection(pixel, dimensions);
+    float3 toOrigin = origin - input.probePosition;
+    float  probeRadius = GetGlobalConst(ddgivis, probeRadius);
+
+    float a = dot(direction, direction);
+    float b = dot(direction, toOrigin);
+    float c = dot(toOrigin, toOrigin) - (probeRadius * probeRadius);
+    float discriminant = (b * b) - (a * c);
+    if (discriminant < 0.f) return;
+
+    float  hitT = (-b - sqrt(discriminant)) / a;
+    float3 worldPosition = origin + (direction * hitT);
+
+    // Get the DDGIVolume index from root/push constants
+    uint volumeIndex = GetDDGIVolumeIndex();
+
+    // Get the DDGIVolume structured buffers
+    StructuredBuffer<DDGIVolumeDescGPUPacked> DDGIVolumes = GetDDGIVolumeConstants(GetDDGIVolumeConstantsIndex());
+    StructuredBuffer<DDGIVolumeResourceIndices> DDGIVolumeBindless = GetDDGIVolumeResourceIndices(GetDDGIVolumeResourceIndicesIndex());
+
+    // Get the DDGIVolume's bindless resource indices
+    DDGIVolumeResourceIndices resourceIndices = DDGIVolumeBindless[volumeIndex];
+
+    // Load the DDGIVolume constants
+    DDGIVolumeDescGPU volume = UnpackDDGIVolumeDescGPU(DDGIVolumes[volumeIndex]);
+
+    // Get the probe's grid coordinates
+    float3 probeCoords = DDGIGetProbeCoords(input.probeIndex, volume);
+
+    // Adjust probe index for scroll offsets
+    int probeIndex = DDGIGetScrollingProbeIndex(probeCoords, volume);
+
+    // Get the probe's data to display
+    float3 sampleDirection;
+    float3 color = GetProbeData(probeIndex, probeCoords, worldPosition, resourceIndices, volume, sampleDirection);
+
+    // Color the probe if classification is enabled (hidden inactive probes are culled)
+    if (volume.probeClassificationEnabled && (GetGlobalConst(ddgivis, probeVisType) == PROBE_VIS_TYPE_DEFAULT))
+    {
+        const float3 INACTIVE_COLOR = float3(1.f, 0.f, 0.f);      // Red
+        const float3 ACTIVE_COLOR = float3(0.f, 1.f, 0.f);        // Green
+
+        // Get the probe data texture array
+        Texture2DArray<float4> ProbeData = GetTex2DArray(resourceIndices.probeDataSRVIndex);
+
+        // Get the probe's state
+        float probeState = ProbeData[DDGIGetProbeTexelCoords(probeIndex, volume)].w;
+
+        // Probe coloring
+        if (abs(dot(direction, sampleDirection)) < 0.45f)
+        {
+            if (probeState == RTXGI_DDGI_PROBE_STATE_ACTIVE) color = ACTIVE_COLOR;
+            else if (probeState == RTXGI_DDGI_PROBE_STATE_INACTIVE) color = INACTIVE_COLOR;
+        }
+    }
+
+    // If the GBuffer doesn't contain geometry or a visualization - or the
+    // probe is the closest surface - overwrite GBufferA with probe information.
+    float depth = GBufferB[pixel].w;
+#if GBUFFER_VISIBILITY
+    // GBufferB is only written by visualizations, the primary ray hit distance is reconstructed
+    if (GBufferA[pixel].w >= COMPOSITE_FLAG_POSTPROCESS_PIXEL) depth = GBufferLoadWorldPosHitT(pixel).w;
+#endif
+    if (depth >= 0.f && hitT >= depth) return;
+
+    // Overwrite GBufferA's albedo (sRGB) and mark the pixel to not be lit or post processed
+    GBufferA[pixel] = float4(LinearToSRGB(color), COMPOSITE_FLAG_IGNORE_PIXEL);
+
+    // Overwrite GBufferB's hit distance with the distance to the probe
+    float4 worldPosHitT = GBufferB[pixel];
+    GBufferB[pixel] = float4(worldPosHitT.xyz, hitT);
+}
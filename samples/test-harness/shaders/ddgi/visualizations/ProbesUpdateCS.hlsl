@@ -47,16 +47,32 @@ void CS(uint3 DispatchThreadID : SV_DispatchThreadID)
     // Get the probe radius
     float probeRadius = GetGlobalConst(ddgivis, probeRadius);
 
-    // Get the instance offset (where one volume's probes end and another begin)
+    // Get the instance offset (where one volume's probes end and another begin) and the probe sphere LODs
     uint instanceOffset = GetGlobalConst(ddgivis, instanceOffset);
+    uint numLods = (instanceOffset >> 16) & 0xF;
+    uint lodStride = (instanceOffset >> 20) * 256;
+    uint instanceIndex = (instanceOffset & 0xFFFF) + DispatchThreadID.x;
 
     // Get the TLAS Instances structured buffer
     RWStructuredBuffer<TLASInstance> RWInstances = GetDDGIProbeVisTLASInstances();
 
     // Set the probe's transform
-    RWInstances[(instanceOffset + DispatchThreadID.x)].transform = float3x4(
+    RWInstances[instanceIndex].transform = float3x4(
         probeRadius, 0.f, 0.f, probeWorldPosition.x,
         0.f, probeRadius, 0.f, probeWorldPosition.y,
         0.f, 0.f, probeRadius, probeWorldPosition.z);
 
+    // Select the probe sphere's LOD by its height on screen, the instance references LOD 0 (see Geometry::CreateIcosphere)
+    if (numLods > 1)
+    {
+        // Each LOD halves the edge length of the previous LOD: LOD 0 below 16 pixels, then one LOD per doubling of the height
+        float distance = max(length(probeWorldPosition - GetCamera().position), 1e-4f);
+        float pixels = (probeRadius / (2.f * distance * GetCamera().tanHalfFovY)) * GetCamera().resolution.y;
+        uint lod = (uint)clamp(floor(log2(pixels / 8.f)), 0.f, (float)(numLods - 1));
+
+        uint2 blasAddress = RWInstances[instanceIndex].blasAddress;
+        uint address = blasAddress.x + (lod * lodStride);
+        RWInstances[instanceIndex].blasAddress = uint2(address, blasAddress.y + ((address < blasAddress.x) ? 1 : 0));
+    }
+
 }
@@ -32,11 +32,16 @@
 #include "../../../../../rtxgi-sdk/shaders/ddgi/include/ProbeCommon.hlsl"
 #include "../../../../../rtxgi-sdk/shaders/ddgi/include/DDGIRootConstants.hlsl"
 
-// ---[ Compute Shader ]---
+// ---[ Texture Layout ]---
 
-[numthreads(THGP_DIM_X, THGP_DIM_Y, 1)]
-void CS(uint3 DispatchThreadID : SV_DispatchThreadID)
+/**
+ * Get the visualization of the texel at the given coordinates of the volume's texture layout (the texture atlases stacked vertically).
+ * Returns false if the coordinates are not covered by a texture.
+ */
+bool GetVolumeTextureTexel(uint2 LayoutCoords, out float4 output)
 {
+    output = float4(0.f, 0.f, 0.f, 0.f);
+
     // Get the DDGIVolume index from root/push constants
     uint volumeIndex = GetDDGIVolumeIndex();
 
@@ -48,7 +53,6 @@ void CS(uint3 DispatchThreadID : SV_DispatchThreadID)
     DDGIVolumeResourceIndices resourceIndices = DDGIVolumeBindless[volumeIndex];
 
     // Get the (bindless) resources
-    RWTexture2D<float4> GBufferA = GetRWTex2D(GBUFFERA_INDEX);
     Texture2DArray<float4> RayData = GetTex2DArray(resourceIndices.rayDataSRVIndex);
     Texture2DArray<float4> ProbeIrradiance = GetTex2DArray(resourceIndices.probeIrradianceSRVIndex);
     Texture2DArray<float4> ProbeDistance = GetTex2DArray(resourceIndices.probeDistanceSRVIndex);
@@ -82,12 +86,12 @@ void CS(uint3 DispatchThreadID : SV_DispatchThreadID)
     float irradianceScale = GetGlobalConst(ddgivis, irradianceTextureScale);
     uint2 numTexelsPerSlice = numProbesPerSlice * numIrradianceProbeTexels;
     uint2 irradianceRect = uint2(numTexelsPerSlice.x * numSlices, numTexelsPerSlice.y) * irradianceScale;
-    if(DispatchThreadID.x < irradianceRect.x && DispatchThreadID.y < irradianceRect.y)
+    if(LayoutCoords.x < irradianceRect.x && LayoutCoords.y < irradianceRect.y)
     {
         // Compute the sampling coordinates
         uint2  numScaledTexelsPerSlice = numTexelsPerSlice * irradianceScale;
-        float2 sliceUV = (float2(0.5f, 0.5f) + float2(DispatchThreadID.xy % numScaledTexelsPerSlice)) / float2(numScaledTexelsPerSlice);
-        float  sliceIndex = float(DispatchThreadID.x / numScaledTexelsPerSlice.x);
+        float2 sliceUV = (float2(0.5f, 0.5f) + float2(LayoutCoords % numScaledTexelsPerSlice)) / float2(numScaledTexelsPerSlice);
+        float  sliceIndex = float(LayoutCoords.x / numScaledTexelsPerSlice.x);
         float3 coords = float3(sliceUV, sliceIndex);
 
         // Sample the irradiance texture array
@@ -112,10 +116,10 @@ void CS(uint3 DispatchThreadID : SV_DispatchThreadID)
         // Convert to sRGB before storing
         color = LinearToSRGB(color);
 
-        // Overwrite GBufferA's albedo and mark the pixel to not be lit or post-processed
+        // Replace the albedo and mark the pixel to not be lit or post-processed
         // Note: because the visualized probe's irradiance marked to be ignored during post-processing, it will be visible during the furnace test!
-        GBufferA[DispatchThreadID.xy] = float4(color, COMPOSITE_FLAG_IGNORE_PIXEL);
-        return;
+        output = float4(color, COMPOSITE_FLAG_IGNORE_PIXEL);
+        return true;
     }
 
     // Distance
@@ -125,12 +129,12 @@ void CS(uint3 DispatchThreadID : SV_DispatchThreadID)
     float xmax = distanceRect.x;
     float ymin = irradianceRect.y + 5;
     float ymax = (ymin + distanceRect.y);
-    if (DispatchThreadID.x < xmax && DispatchThreadID.y >= ymin && DispatchThreadID.y < ymax)
+    if (LayoutCoords.x < xmax && LayoutCoords.y >= ymin && LayoutCoords.y < ymax)
     {
         // Compute the sampling coordinates
         uint2  numScaledTexelsPerSlice = numTexelsPerSlice * distanceScale;
-        float2 sliceUV = (float2(0.5f, 0.5f) + float2(uint2(DispatchThreadID.x, DispatchThreadID.y - ymin) % numScaledTexelsPerSlice)) / float2(numScaledTexelsPerSlice);
-        float  sliceIndex = float(DispatchThreadID.x / numScaledTexelsPerSlice.x);
+        float2 sliceUV = (float2(0.5f, 0.5f) + float2(uint2(LayoutCoords.x, LayoutCoords.y - ymin) % numScaledTexelsPerSlice)) / float2(numScaledTexelsPerSlice);
+        float  sliceIndex = float(LayoutCoords.x / numScaledTexelsPerSlice.x);
         float3 coords = float3(sliceUV, sliceIndex);
 
         // Sample the distance texture array
@@ -139,9 +143,9 @@ void CS(uint3 DispatchThreadID : SV_DispatchThreadID)
         // Normalize for display
         color.r = saturate(color.r / GetGlobalConst(ddgivis, distanceDivisor));
 
-        // Overwrite GBufferA's albedo and mark the pixel to not be lit or post-processed
-        GBufferA[DispatchThreadID.xy] = float4(color.rrr, COMPOSITE_FLAG_IGNORE_PIXEL);
-        return;
+        // Replace the albedo and mark the pixel to not be lit or post-processed
+        output = float4(color.rrr, COMPOSITE_FLAG_IGNORE_PIXEL);
+        return true;
     }
 
     // Variability
@@ -151,12 +155,12 @@ void CS(uint3 DispatchThreadID : SV_DispatchThreadID)
     xmax = variabilityRect.x;
     ymin += distanceRect.y + 5;
     ymax = (ymin + variabilityRect.y);
-    if (DispatchThreadID.x < xmax.x && DispatchThreadID.y >= ymin && DispatchThreadID.y < ymax)
+    if (LayoutCoords.x < xmax.x && LayoutCoords.y >= ymin && LayoutCoords.y < ymax)
     {
         // Compute the sampling coordinates
         uint2  numScaledTexelsPerSlice = numTexelsPerSlice * variabilityScale;
-        float2 sliceUV = (float2(0.5f, 0.5f) + float2(uint2(DispatchThreadID.x, DispatchThreadID.y - ymin) % numScaledTexelsPerSlice)) / float2(numScaledTexelsPerSlice);
-        float  sliceIndex = float(DispatchThreadID.x / numScaledTexelsPerSlice.x);
+        float2 sliceUV = (float2(0.5f, 0.5f) + float2(uint2(LayoutCoords.x, LayoutCoords.y - ymin) % numScaledTexelsPerSlice)) / float2(numScaledTexelsPerSlice);
+        float  sliceIndex = float(LayoutCoords.x / numScaledTexelsPerSlice.x);
         float3 coords = float3(sliceUV, sliceIndex);
 
         // Sample the variability texture
@@ -177,10 +181,10 @@ void CS(uint3 DispatchThreadID : SV_DispatchThreadID)
         else if (diff > GetGlobalConst(ddgivis, probeVariabilityTextureThreshold)) color = float3(0.f, 1.0, 0.f);
         else color = float3(1.f, 0.f, 0.f);
 
-        // Overwrite GBufferA's albedo and mark the pixel to not be lit
-        GBufferA[DispatchThreadID.xy] = float4(color, 0.f);
+        // Replace the albedo and mark the pixel to not be lit
+        output = float4(color, 0.f);
 
-        return;
+        return true;
     }
 
     // Variability average
@@ -189,12 +193,12 @@ void CS(uint3 DispatchThreadID : SV_DispatchThreadID)
     xmax = variabilityAvgRect.x;
     ymin += variabilityRect.y + 5;
     ymax = (ymin + variabilityAvgRect.y);
-    if (DispatchThreadID.x < xmax.x && DispatchThreadID.y >= ymin && DispatchThreadID.y < ymax)
+    if (LayoutCoords.x < xmax.x && LayoutCoords.y >= ymin && LayoutCoords.y < ymax)
     {
         // Compute the sampling coordinates
         uint2  numScaledTexelsPerSlice = numTexelsPerSlice * variabilityScale;
-        float2 sliceUV = (float2(0.5f, 0.5f) + float2(uint2(DispatchThreadID.x, DispatchThreadID.y - ymin) % numScaledTexelsPerSlice)) / float2(numScaledTexelsPerSlice);
-        float  sliceIndex = float(DispatchThreadID.x / numScaledTexelsPerSlice.x);
+        float2 sliceUV = (float2(0.5f, 0.5f) + float2(uint2(LayoutCoords.x, LayoutCoords.y - ymin) % numScaledTexelsPerSlice)) / float2(numScaledTexelsPerSlice);
+        float  sliceIndex = float(LayoutCoords.x / numScaledTexelsPerSlice.x);
         float3 coords = float3(sliceUV, sliceIndex);
 
         // Sample the variability average texture
@@ -205,10 +209,10 @@ void CS(uint3 DispatchThreadID : SV_DispatchThreadID)
         else if (diff > GetGlobalConst(ddgivis, probeVariabilityTextureThreshold)) color = float3(0.f, 1.f, 0.f);
         else color = float3(1.f, 0.f, 0.f);
 
-        // Overwrite GBufferA's albedo and mark the pixel to not be lit
-        GBufferA[DispatchThreadID.xy] = float4(color, 0.f);
+        // Replace the albedo and mark the pixel to not be lit
+        output = float4(color, 0.f);
 
-        return;
+        return true;
     }
 
     // Get the texture scale factor for probe data
@@ -223,20 +227,20 @@ void CS(uint3 DispatchThreadID : SV_DispatchThreadID)
 
         xmax = offsetRect.x;
         ymax = (ymin + offsetRect.y);
-        if (DispatchThreadID.x < xmax && DispatchThreadID.y >= ymin && DispatchThreadID.y < ymax)
+        if (LayoutCoords.x < xmax && LayoutCoords.y >= ymin && LayoutCoords.y < ymax)
         {
             // Compute the sampling coordinates
             uint2  numScaledTexelsPerSlice = numProbesPerSlice * probeDataScale;
-            float2 sliceUV = (float2(0.5f, 0.5f) + float2(uint2(DispatchThreadID.x, DispatchThreadID.y - ymin) % numScaledTexelsPerSlice)) / float2(numScaledTexelsPerSlice);
-            float  sliceIndex = float(DispatchThreadID.x / numScaledTexelsPerSlice.x);
+            float2 sliceUV = (float2(0.5f, 0.5f) + float2(uint2(LayoutCoords.x, LayoutCoords.y - ymin) % numScaledTexelsPerSlice)) / float2(numScaledTexelsPerSlice);
+            float  sliceIndex = float(LayoutCoords.x / numScaledTexelsPerSlice.x);
             float3 coords = float3(sliceUV, sliceIndex);
 
             // Sample the probe data texture array
             color = ProbeData.SampleLevel(GetPointClampSampler(), coords, 0).rgb;
 
-            // Overwrite GBufferA's albedo and mark the pixel to not be lit or post-processed
-            GBufferA[DispatchThreadID.xy] = float4(color, COMPOSITE_FLAG_IGNORE_PIXEL);
-            return;
+            // Replace the albedo and mark the pixel to not be lit or post-processed
+            output = float4(color, COMPOSITE_FLAG_IGNORE_PIXEL);
+            return true;
         }
     }
 
@@ -250,12 +254,12 @@ void CS(uint3 DispatchThreadID : SV_DispatchThreadID)
         else ymin += 5;
 
         ymax = (ymin + statesRect.y);
-        if (DispatchThreadID.x < xmax && DispatchThreadID.y >= ymin && DispatchThreadID.y < ymax)
+        if (LayoutCoords.x < xmax && LayoutCoords.y >= ymin && LayoutCoords.y < ymax)
         {
             // Compute the sampling coordinates
             uint2  numScaledTexelsPerSlice = numProbesPerSlice * probeDataScale;
-            float2 sliceUV = (float2(0.5f, 0.5f) + float2(uint2(DispatchThreadID.x, DispatchThreadID.y - ymin) % numScaledTexelsPerSlice)) / float2(numScaledTexelsPerSlice);
-            float  sliceIndex = float(DispatchThreadID.x / numScaledTexelsPerSlice.x);
+            float2 sliceUV = (float2(0.5f, 0.5f) + float2(uint2(LayoutCoords.x, LayoutCoords.y - ymin) % numScaledTexelsPerSlice)) / float2(numScaledTexelsPerSlice);
+            float  sliceIndex = float(LayoutCoords.x / numScaledTexelsPerSlice.x);
             float3 coords = float3(sliceUV, sliceIndex);
 
             // Sample the probe data texture
@@ -265,9 +269,9 @@ void CS(uint3 DispatchThreadID : SV_DispatchThreadID)
             if(state == RTXGI_DDGI_PROBE_STATE_ACTIVE) color = float3(0.f, 1.f, 0.f);
             else color = float3(1.f, 0.f, 0.f);
 
-            // Overwrite GBufferA's albedo and mark the pixel to not be lit or post-processed
-            GBufferA[DispatchThreadID.xy] = float4(color, COMPOSITE_FLAG_IGNORE_PIXEL);
-            return;
+            // Replace the albedo and mark the pixel to not be lit or post-processed
+            output = float4(color, COMPOSITE_FLAG_IGNORE_PIXEL);
+            return true;
         }
     }
 
@@ -278,12 +282,12 @@ void CS(uint3 DispatchThreadID : SV_DispatchThreadID)
     xmax = rayDataRect.x;
     ymin = ymax + 5;
     ymax = (ymin + rayDataRect.y);
-    if (DispatchThreadID.x <= xmax && DispatchThreadID.y > ymin && DispatchThreadID.y <= ymax)
+    if (LayoutCoords.x <= xmax && LayoutCoords.y > ymin && LayoutCoords.y <= ymax)
     {
         // Compute the sampling coordinates
         uint2  numScaledTexelsPerSlice = numTexelsPerSlice * rayDataScale;
-        float2 sliceUV = (float2(0.5f, 0.5f) + float2(uint2(DispatchThreadID.x, DispatchThreadID.y - ymin) % numScaledTexelsPerSlice)) / float2(numScaledTexelsPerSlice);
-        float  sliceIndex = float(DispatchThreadID.x / numScaledTexelsPerSlice.x);
+        float2 sliceUV = (float2(0.5f, 0.5f) + float2(uint2(LayoutCoords.x, LayoutCoords.y - ymin) % numScaledTexelsPerSlice)) / float2(numScaledTexelsPerSlice);
+        float  sliceIndex = float(LayoutCoords.x / numScaledTexelsPerSlice.x);
         float3 coords = float3(sliceUV, sliceIndex);
 
         if (volume.probeRayDataFormat == RTXGI_DDGI_VOLUME_TEXTURE_FORMAT_F32x4)
@@ -294,10 +298,71 @@ void CS(uint3 DispatchThreadID : SV_DispatchThreadID)
         {
             color = RTXGIUintToFloat3(asuint(RayData.SampleLevel(GetPointClampSampler(), coords, 0).r));
         }
+        else if (volume.probeRayDataFormat == RTXGI_DDGI_VOLUME_TEXTURE_FORMAT_U32)
+        {
+            color = DDGIUnpackProbeRayU32Radiance(RayData.SampleLevel(GetPointClampSampler(), coords, 0).r);
+        }
 
-        // Overwrite GBufferA's albedo and mark the pixel to not be lit or post-processed
-        GBufferA[DispatchThreadID.xy] = float4(color, COMPOSITE_FLAG_IGNORE_PIXEL);
-        return;
+        // Replace the albedo and mark the pixel to not be lit or post-processed
+        output = float4(color, COMPOSITE_FLAG_IGNORE_PIXEL);
+        return true;
     }
 
+    return false;
+}
+
+/**
+ * Get the coordinates of the texture layout shown at the given pixel, after the visualization view's magnification and pan.
+ * Only the texels in the visible region of the layout are read.
+ */
+uint2 GetLayoutCoords(uint2 pixel)
+{
+    uint view = GetGlobalConst(ddgivis, textureView);
+    uint  zoom = (view & 0xF);
+    uint2 pan = uint2((view >> 4) & 0x3FFF, (view >> 18) & 0x3FFF);
+    return (pixel >> zoom) + pan;
+}
+
+// ---[ Compute Shaders ]---
+
+/**
+ * Draw the visualization into GBufferA.
+ */
+[numthreads(THGP_DIM_X, THGP_DIM_Y, 1)]
+void CS(uint3 DispatchThreadID : SV_DispatchThreadID)
+{
+    float4 texel;
+    if (!GetVolumeTextureTexel(GetLayoutCoords(DispatchThreadID.xy), texel)) return;
+
+    // Overwrite GBufferA's albedo and composite flags
+    RWTexture2D<float4> GBufferA = GetRWTex2D(GBUFFERA_INDEX);
+    GBufferA[DispatchThreadID.xy] = texel;
+}
+
+/**
+ * Draw the visualization into its cache texture, only when the view changes (see DDGIVisualizations_D3D12.cpp).
+ * Pixels not covered by a texture are marked with a negative alpha.
+ */
+[numthreads(THGP_DIM_X, THGP_DIM_Y, 1)]
+void DrawCS(uint3 DispatchThreadID : SV_DispatchThreadID)
+{
+    float4 texel;
+    if (!GetVolumeTextureTexel(GetLayoutCoords(DispatchThreadID.xy), texel)) texel = float4(0.f, 0.f, 0.f, -1.f);
+
+    RWTexture2D<float4> TextureVis = GetRWTex2D(DDGI_TEXTURE_VIS_INDEX);
+    TextureVis[DispatchThreadID.xy] = texel;
+}
+
+/**
+ * Copy the cached visualization into GBufferA, every frame.
+ */
+[numthreads(THGP_DIM_X, THGP_DIM_Y, 1)]
+void CompositeCS(uint3 DispatchThreadID : SV_DispatchThreadID)
+{
+    RWTexture2D<float4> TextureVis = GetRWTex2D(DDGI_TEXTURE_VIS_INDEX);
+    float4 texel = TextureVis[DispatchThreadID.xy];
+    if (texel.a < 0.f) return;
+
+    RWTexture2D<float4> GBufferA = GetRWTex2D(GBUFFERA_INDEX);
+    GBufferA[DispatchThreadID.xy] = texel;
 }
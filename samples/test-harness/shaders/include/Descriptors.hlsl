@@ -14,6 +14,7 @@
 #include "../../../../rtxgi-sdk/include/rtxgi/ddgi/DDGIVolumeDescGPU.h"
 #include "../../include/graphics/Types.h"
 #include "Platform.hlsl"
+#include "RadianceCachePacking.hlsl"
 
 #define RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS 0
 #define RTXGI_BINDLESS_TYPE_DESCRIPTOR_HEAP 1
@@ -70,21 +71,53 @@ VK_BINDING(3, 0) StructuredBuffer<Material>                  Materials
 VK_BINDING(4, 0) StructuredBuffer<TLASInstance>              TLASInstances       : register(t4, space0);
 VK_BINDING(5, 0) StructuredBuffer<DDGIVolumeDescGPUPacked>   DDGIVolumes         : register(t5, space0);
 VK_BINDING(6, 0) StructuredBuffer<DDGIVolumeResourceIndices> DDGIVolumeBindless  : register(t6, space0);
+#ifndef __spirv__
+StructuredBuffer<DDGIVolumeBoundsGPU>                        DDGIVolumeBounds    : register(t0, space4);  // D3D12 only (see DDGIVolumeBoundsGPU)
+StructuredBuffer<GIMaterial>                                 GIMaterials         : register(t1, space4);  // D3D12 only (see GIMaterial)
+StructuredBuffer<LightBVHNode>                               LightBVHNodes       : register(t2, space4);  // D3D12 only (see LightBVHNode)
+StructuredBuffer<EmissiveTriangle>                           EmissiveTriangles   : register(t3, space4);  // D3D12 only (see EmissiveTriangle)
+#endif
 
 VK_BINDING(7, 0) RWStructuredBuffer<TLASInstance>                   RWTLASInstances                  : register(u5, space0);
+// Vulkan binds the radiance cache pipeline's buffers at 14-23 (see Vulkan.h DescriptorLayoutBindings), the D3D12 only buffers share binding 24, which is not in the layout
 VK_BINDING(14, 0) RWStructuredBuffer<HitPackedData>             HitCaching                       : register(u5, space1);
-VK_BINDING(14, 0) RWStructuredBuffer<float3>                        RadianceCaching                  : register(u5, space2);
-VK_BINDING(14, 0) RWStructuredBuffer<RadianceCacheVisualization>    RadianceCachingVisualization     : register(u5, space3);
-VK_BINDING(14, 0) RWByteAddressBuffer                                RadianceCacheAccumulation        : register(u5, space4);  // SHaRC-style atomic
-VK_BINDING(14, 0) RWByteAddressBuffer                                RadianceCacheMetadata            : register(u5, space5);  // SHaRC-style: checksum + age
+VK_BINDING(15, 0) RWStructuredBuffer<RadianceCacheStorage>          RadianceCaching                  : register(u5, space2);  // See RADIANCE_CACHE_RADIANCE_FORMAT
+VK_BINDING(16, 0) RWStructuredBuffer<RadianceCacheVisualization>    RadianceCachingVisualization     : register(u5, space3);
+VK_BINDING(17, 0) RWByteAddressBuffer                                RadianceCacheAccumulation        : register(u5, space4);  // SHaRC-style atomic
+VK_BINDING(18, 0) RWByteAddressBuffer                                RadianceCacheMetadata            : register(u5, space5);  // SHaRC-style: checksum + age
 // ProbeRayHitMap stores: .x = HashID (or INVALID), .y = asuint(HitDistance)
-VK_BINDING(14, 0) RWStructuredBuffer<uint2>                          ProbeRayHitMap                   : register(u5, space6);  // Maps ProbeRayIndex -> (HashID, HitDistance)
+VK_BINDING(19, 0) RWStructuredBuffer<uint2>                          ProbeRayHitMap                   : register(u5, space6);  // Maps ProbeRayIndex -> (HashID, HitDistance)
+VK_BINDING(20, 0) RWStructuredBuffer<uint>                           RadianceCacheWorkList            : register(u5, space7);  // Cache slots touched this frame
+VK_BINDING(21, 0) RWByteAddressBuffer                                RadianceCacheWorkListArgs        : register(u5, space8);  // Dispatch arguments + append counter
+VK_BINDING(24, 0) RWStructuredBuffer<uint>                           RadianceCacheSortedWorkList      : register(u5, space9);  // Work list ordered by (InstanceIndex, GeometryIndex)
+VK_BINDING(24, 0) RWStructuredBuffer<uint>                           RadianceCacheSortBins            : register(u5, space10); // Counting sort bin counts / offsets
+VK_BINDING(24, 0) RWByteAddressBuffer                                RadianceCacheBudget              : register(u5, space11); // Update budget priority histogram + threshold
+VK_BINDING(23, 0) RWByteAddressBuffer                                DDGIProbeSchedules[]             : register(u5, space12); // Per-volume probe schedules (see ProbeSchedulingCS.hlsl)
+VK_BINDING(24, 0) RWStructuredBuffer<uint4>                          ProbeTraceBatch                  : register(u5, space13); // Batched probe trace volume table (see ProbeTraceBatch.hlsl)
+VK_BINDING(24, 0) RWStructuredBuffer<PathTraceWavefrontPath>         PTWavefrontPaths                 : register(u5, space14); // Wavefront path tracing path state (see PathTraceWavefrontCS.hlsl)
+VK_BINDING(24, 0) RWStructuredBuffer<PathTraceWavefrontHit>          PTWavefrontHits                  : register(u5, space15); // Wavefront path tracing hits
+VK_BINDING(24, 0) RWStructuredBuffer<PathTraceWavefrontSurface>      PTWavefrontSurfaces              : register(u5, space16); // Wavefront path tracing shaded surfaces
+VK_BINDING(24, 0) RWStructuredBuffer<uint>                           PTWavefrontQueues                : register(u5, space17); // Wavefront path tracing ray queues
+VK_BINDING(24, 0) RWByteAddressBuffer                                PTWavefrontCounters              : register(u5, space18); // Wavefront path tracing queue counters + material sort bins
+VK_BINDING(24, 0) RWByteAddressBuffer                                PTConvergence                    : register(u5, space19); // Path tracing unconverged tile counts + tile flags (see PathTraceConvergence.hlsl)
+VK_BINDING(24, 0) RWTexture2D<uint2>                                 GBufferVisibility                : register(u5, space20); // Primary ray hit IDs (see VisibilityBuffer.hlsl)
+VK_BINDING(24, 0) RWTexture2D<uint>                                  CompositeShadingRate             : register(u5, space21); // Composite shading rate image (D3D12_SHADING_RATE per tile)
+VK_BINDING(24, 0) RWByteAddressBuffer                                TextureFeedback                  : register(u5, space22); // Texture streaming requested resolutions (see TextureStreaming.hlsl)
+VK_BINDING(24, 0) RWByteAddressBuffer                                GPUCounters                      : register(u5, space23); // DDGI ray and radiance cache counters (see GPUCounters.hlsl)
+VK_BINDING(24, 0) RWByteAddressBuffer                                RadianceCacheStats               : register(u5, space24); // Radiance cache occupancy per cascade (see RadianceCacheStatsCS.hlsl)
+VK_BINDING(24, 0) RWByteAddressBuffer                                GBufferTiles                     : register(u5, space25); // GBuffer geometry tile list + dispatch arguments (see GBufferTiles.hlsl)
+VK_BINDING(24, 0) RWByteAddressBuffer                                LightGrid                        : register(u5, space26); // World-space light grid bounds + per cell light lists (see LightGrid.hlsl)
+VK_BINDING(22, 0) RWByteAddressBuffer                                RadianceCacheReservoirs          : register(u5, space27); // Radiance cache indirect sample reservoirs (see RadianceCacheReservoir.hlsl)
+VK_BINDING(24, 0) RWByteAddressBuffer                                IrradianceQueries                : register(u5, space28); // DDGIVolume irradiance queries of the CPU (see IrradianceQueryCS.hlsl)
+VK_BINDING(24, 0) RWByteAddressBuffer                                CompositeExposure                : register(u5, space29); // Auto exposure luminance histogram + exposure (see CompositeExposureCS.hlsl)
+VK_BINDING(24, 0) RWByteAddressBuffer                                ProbeDeltas                      : register(u5, space30); // DDGIVolume probe tile delta packets (see ProbeDeltaCS.hlsl)
 
 
 // Bindless Resources ---------------------------------------------------------------------------------------
 
 VK_BINDING(8, 0) RWTexture2D<float4>                         RWTex2D[]           : register(u6, space0);
 VK_BINDING(9, 0) RWTexture2DArray<float4>                    RWTex2DArray[]      : register(u6, space1);
+VK_BINDING(8, 0) RasterizerOrderedTexture2D<float4>          ROVTex2D[]          : register(u6, space2);  // Aliases RWTex2D[], for ordered pixel shader writes
 VK_BINDING(10, 0) RaytracingAccelerationStructure            TLAS[]              : register(t7, space0);
 VK_BINDING(11, 0) Texture2D                                  Tex2D[]             : register(t7, space1);
 VK_BINDING(12, 0) Texture2DArray                             Tex2DArray[]        : register(t7, space2);
@@ -101,6 +134,9 @@ VK_BINDING(13, 0) ByteAddressBuffer                          ByteAddrBuffer[]
 #define RTAO_OUTPUT_INDEX 6
 #define RTAO_RAW_INDEX 7
 #define DDGI_OUTPUT_INDEX 8
+#define RTAO_HISTORY_INDEX 9
+#define PT_VARIANCE_INDEX 11
+#define DDGI_TEXTURE_VIS_INDEX 12
 
 #define SCENE_TLAS_INDEX 0
 #define DDGIPROBEVIS_TLAS_INDEX 1
@@ -128,61 +164,63 @@ StructuredBuffer<Light> GetLights() { return Lights; }
 void GetGeometryData(uint meshIndex, uint geometryIndex, out GeometryData geometry)
 {
     uint address = ByteAddrBuffer[MESH_OFFSETS_INDEX].Load(meshIndex * 4); // address of the Mesh in the GeometryData buffer
-    address += geometryIndex * 12; // offset to mesh primitive geometry, GeometryData stride is 12 bytes
+    address += geometryIndex * 64; // offset to mesh primitive geometry, GeometryData stride is 64 bytes
 
     geometry.materialIndex = ByteAddrBuffer[GEOMETRY_DATA_INDEX].Load(address);
     geometry.indexByteAddress = ByteAddrBuffer[GEOMETRY_DATA_INDEX].Load(address + 4);
     geometry.vertexByteAddress = ByteAddrBuffer[GEOMETRY_DATA_INDEX].Load(address + 8);
+    geometry.albedoByteAddress = ByteAddrBuffer[GEOMETRY_DATA_INDEX].Load(address + 12);
+    geometry.positionTransform[0] = asfloat(ByteAddrBuffer[GEOMETRY_DATA_INDEX].Load4(address + 16));
+    geometry.positionTransform[1] = asfloat(ByteAddrBuffer[GEOMETRY_DATA_INDEX].Load4(address + 32));
+    geometry.positionTransform[2] = asfloat(ByteAddrBuffer[GEOMETRY_DATA_INDEX].Load4(address + 48));
 }
 Material GetMaterial(GeometryData geometry) { return Materials[geometry.materialIndex]; }
+#ifndef __spirv__
+GIMaterial GetGIMaterial(GeometryData geometry) { return GIMaterials[geometry.materialIndex]; }
+StructuredBuffer<LightBVHNode> GetLightBVHNodes() { return LightBVHNodes; }
+StructuredBuffer<EmissiveTriangle> GetEmissiveTriangles() { return EmissiveTriangles; }
+#endif
 
 StructuredBuffer<DDGIVolumeDescGPUPacked> GetDDGIVolumeConstants(uint index) { return DDGIVolumes; }
 StructuredBuffer<DDGIVolumeResourceIndices> GetDDGIVolumeResourceIndices(uint index) { return DDGIVolumeBindless; }
+#ifndef __spirv__
+StructuredBuffer<DDGIVolumeBoundsGPU> GetDDGIVolumeBounds() { return DDGIVolumeBounds; }
+#endif
 
 RWStructuredBuffer<TLASInstance> GetDDGIProbeVisTLASInstances() { return RWTLASInstances; }
 StructuredBuffer<TLASInstance> GetTLASInstances() { return TLASInstances; }
 
 RWStructuredBuffer<HitPackedData> GetHitCachingBuffer() { return HitCaching; }
 
-void PackData(HitUnpackedData InData, out HitPackedData OutData)
-{
-    OutData.ProbePacked = (InData.ProbeIndex & 0xFFFF) |
-                          ((InData.RayIndex & 0xFF) << 16) |
-                          (InData.VolumeIndex & 0xFF) << 24;
-
-    OutData.PrimitivePacked = (InData.InstanceIndex & 0xFFF) | 
-                              ((InData.PrimitiveIndex & 0x3FF) << 12) | 
-                              ((InData.GeometryIndex & 0x3FF) << 22);
-
-    uint2 UBarycentrics = f32tof16(InData.Barycentrics);
-    OutData.Barycentrics = (UBarycentrics.x & 0xFFFF) | 
-                            ((UBarycentrics.y & 0xFFFF) << 16);
-
-    OutData.HitDistance = InData.HitDistance;
-}
-
-void UnpackData(HitPackedData InData, out HitUnpackedData OutData)
-{
-    OutData.ProbeIndex = InData.ProbePacked & 0xFFFF;    
-    OutData.RayIndex = (InData.ProbePacked >> 16) & 0xFF;
-    OutData.VolumeIndex = (InData.ProbePacked >> 24) & 0xFF;
-
-    OutData.InstanceIndex = InData.PrimitivePacked & 0xFFF;
-    OutData.PrimitiveIndex = (InData.PrimitivePacked >> 12) & 0x3FF;
-    OutData.GeometryIndex = (InData.PrimitivePacked >> 22) & 0x3FF;
-
-    uint2 UBarycentrics;
-    UBarycentrics.x = InData.Barycentrics & 0xFFFF;
-    UBarycentrics.y = (InData.Barycentrics >> 16) & 0xFFFF;
-    OutData.Barycentrics = f16tof32(UBarycentrics);
-
-    OutData.HitDistance = InData.HitDistance;
-}
-RWStructuredBuffer<float3>            GetRadianceCachingBuffer() { return RadianceCaching; }
+RWStructuredBuffer<RadianceCacheStorage> GetRadianceCachingBuffer() { return RadianceCaching; }
 RWStructuredBuffer<RadianceCacheVisualization>            GetRadianceCachingVisualizationBuffer() { return RadianceCachingVisualization; }
 RWByteAddressBuffer                   GetRadianceCacheAccumulationByteBuffer() { return RadianceCacheAccumulation; }  // SHaRC-style atomic
-RWByteAddressBuffer                   GetRadianceCacheMetadataBuffer() { return RadianceCacheMetadata; }  // SHaRC-style: checksum + age
+RWByteAddressBuffer                   GetRadianceCacheMetadataBuffer() { return RadianceCacheMetadata; }  // SHaRC-style: checksum + age, update budget history
 RWStructuredBuffer<uint2>             GetProbeRayHitMap() { return ProbeRayHitMap; }  // Maps ProbeRayIndex -> (HashID, HitDistance)
+RWStructuredBuffer<uint>              GetRadianceCacheWorkList() { return RadianceCacheWorkList; }  // Cache slots touched this frame
+RWByteAddressBuffer                   GetRadianceCacheWorkListArgs() { return RadianceCacheWorkListArgs; }  // Dispatch arguments + append counter
+RWStructuredBuffer<uint>              GetRadianceCacheSortedWorkList() { return RadianceCacheSortedWorkList; }  // Work list ordered by (InstanceIndex, GeometryIndex)
+RWStructuredBuffer<uint>              GetRadianceCacheSortBins() { return RadianceCacheSortBins; }  // Counting sort bin counts / offsets
+RWByteAddressBuffer                   GetRadianceCacheBudgetBuffer() { return RadianceCacheBudget; }  // Update budget priority histogram + threshold
+RWByteAddressBuffer                   GetDDGIProbeSchedule(uint index) { return DDGIProbeSchedules[index]; }  // Probes scheduled this frame, index is DDGIVolumeResourceIndices::probeScheduleUAVIndex
+RWStructuredBuffer<uint4>             GetProbeTraceBatch() { return ProbeTraceBatch; }  // Batched probe trace volume table
+RWStructuredBuffer<PathTraceWavefrontPath>    GetPTWavefrontPaths() { return PTWavefrontPaths; }  // Wavefront path tracing path state
+RWStructuredBuffer<PathTraceWavefrontHit>     GetPTWavefrontHits() { return PTWavefrontHits; }  // Wavefront path tracing hits
+RWStructuredBuffer<PathTraceWavefrontSurface> GetPTWavefrontSurfaces() { return PTWavefrontSurfaces; }  // Wavefront path tracing shaded surfaces
+RWStructuredBuffer<uint>                      GetPTWavefrontQueues() { return PTWavefrontQueues; }  // Wavefront path tracing ray queues
+RWByteAddressBuffer                           GetPTWavefrontCounters() { return PTWavefrontCounters; }  // Wavefront path tracing queue counters + material sort bins
+RWByteAddressBuffer                           GetPTConvergence() { return PTConvergence; }  // Path tracing unconverged tile counts + tile flags
+RWTexture2D<uint2>                            GetGBufferVisibility() { return GBufferVisibility; }  // Primary ray hit IDs
+RWTexture2D<uint>                             GetCompositeShadingRate() { return CompositeShadingRate; }  // Composite shading rate image
+RWByteAddressBuffer                           GetTextureFeedback() { return TextureFeedback; }  // Texture streaming requested resolutions
+RWByteAddressBuffer                           GetGPUCounters() { return GPUCounters; }  // DDGI ray and radiance cache counters
+RWByteAddressBuffer                           GetRadianceCacheStats() { return RadianceCacheStats; }  // Radiance cache occupancy per cascade
+RWByteAddressBuffer                           GetGBufferTiles() { return GBufferTiles; }  // GBuffer geometry tile list + dispatch arguments
+RWByteAddressBuffer                           GetLightGrid() { return LightGrid; }  // World-space light grid bounds + per cell light lists
+RWByteAddressBuffer                           GetRadianceCacheReservoirBuffer() { return RadianceCacheReservoirs; }  // Radiance cache indirect sample reservoirs
+RWByteAddressBuffer                           GetIrradianceQueries() { return IrradianceQueries; }  // DDGIVolume irradiance queries of the CPU
+RWByteAddressBuffer                           GetCompositeExposure() { return CompositeExposure; }  // Auto exposure luminance histogram + exposure
+RWByteAddressBuffer                           GetProbeDeltas() { return ProbeDeltas; }  // DDGIVolume probe tile delta packets
 
 RaytracingAccelerationStructure GetAccelerationStructure(uint index) { return TLAS[index]; }
 
@@ -195,6 +233,7 @@ ByteAddressBuffer GetVertexBuffer(uint meshIndex) { return ByteAddrBuffer[GEOMET
 // Bindless Resource Array Accessors ------------------------------------------------------------------------
 
 RWTexture2D<float4> GetRWTex2D(uint index) { return RWTex2D[index]; }
+RasterizerOrderedTexture2D<float4> GetROVTex2D(uint index) { return ROVTex2D[index]; }
 Texture2D<float4> GetTex2D(uint index) { return Tex2D[index]; }
 
 RWTexture2DArray<float4> GetRWTex2DArray(uint index) { return RWTex2DArray[index]; }
@@ -203,33 +242,72 @@ Texture2DArray<float4> GetTex2DArray(uint index) { return Tex2DArray[index]; }
 #elif RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_DESCRIPTOR_HEAP
 
 // Defines for Convenience ----------------------------------------------------------------------------------
+// Descriptor heap indices, these must match DescriptorHeapOffsets in Direct3D12.h
 
 #define CAMERA_INDEX 0
 #define LIGHTS_INDEX 1
 #define MATERIALS_INDEX 2
 #define SCENE_TLAS_INSTANCES_INDEX 3
-#define DDGIPROBEVIS_TLAS_INSTANCES_INDEX 6
-
-#define PT_OUTPUT_INDEX 7
-#define PT_ACCUMULATION_INDEX 8
-#define GBUFFERA_INDEX 9
-#define GBUFFERB_INDEX 10
-#define GBUFFERC_INDEX 11
-#define GBUFFERD_INDEX 12
-#define RTAO_OUTPUT_INDEX 13
-#define RTAO_RAW_INDEX 14
-#define DDGI_OUTPUT_INDEX 15
-
-#define SCENE_TLAS_INDEX 52
-#define DDGIPROBEVIS_TLAS_INDEX 53
-
-#define BLUE_NOISE_INDEX 54
-
-#define SPHERE_INDEX_BUFFER_INDEX 392
-#define SPHERE_VERTEX_BUFFER_INDEX 393
-#define MESH_OFFSETS_INDEX 394
-#define GEOMETRY_DATA_INDEX 395
-#define GEOMETRY_BUFFERS_INDEX 396
+#define DDGI_VOLUME_BOUNDS_INDEX 6
+#define GI_MATERIALS_INDEX 7
+#define LIGHT_BVH_NODES_INDEX 8
+#define EMISSIVE_TRIANGLES_INDEX 9
+
+#define DDGIPROBEVIS_TLAS_INSTANCES_INDEX 10
+#define HIT_CACHING_INDEX 11
+#define RADIANCE_CACHING_INDEX 12
+#define RADIANCE_CACHING_VISUALIZATION_INDEX 13
+#define RADIANCE_CACHE_ACCUMULATION_INDEX 14
+#define RADIANCE_CACHE_METADATA_INDEX 15
+#define PROBE_RAY_HIT_MAP_INDEX 16
+#define RADIANCE_CACHE_WORK_LIST_INDEX 17
+#define RADIANCE_CACHE_WORK_LIST_ARGS_INDEX 18
+#define RADIANCE_CACHE_SORTED_WORK_LIST_INDEX 19
+#define RADIANCE_CACHE_SORT_BINS_INDEX 20
+#define RADIANCE_CACHE_BUDGET_INDEX 21
+#define DDGI_PROBE_SCHEDULE_INDEX 22
+#define PROBE_TRACE_BATCH_INDEX 28
+#define PT_WAVEFRONT_PATHS_INDEX 29
+#define PT_WAVEFRONT_HITS_INDEX 30
+#define PT_WAVEFRONT_SURFACES_INDEX 31
+#define PT_WAVEFRONT_QUEUES_INDEX 32
+#define PT_WAVEFRONT_COUNTERS_INDEX 33
+#define PT_CONVERGENCE_INDEX 34
+#define GBUFFER_VISIBILITY_INDEX 35
+#define COMPOSITE_SHADING_RATE_INDEX 36
+#define TEXTURE_FEEDBACK_INDEX 37
+#define GPU_COUNTERS_INDEX 38
+#define RADIANCE_CACHE_STATS_INDEX 39
+#define GBUFFER_TILES_INDEX 40
+#define LIGHT_GRID_INDEX 41
+#define RADIANCE_CACHE_RESERVOIRS_INDEX 42
+#define IRRADIANCE_QUERIES_INDEX 43
+#define COMPOSITE_EXPOSURE_INDEX 44
+#define PROBE_DELTAS_INDEX 45
+
+#define PT_OUTPUT_INDEX 46
+#define PT_ACCUMULATION_INDEX 47
+#define GBUFFERA_INDEX 48
+#define GBUFFERB_INDEX 49
+#define GBUFFERC_INDEX 50
+#define GBUFFERD_INDEX 51
+#define RTAO_OUTPUT_INDEX 52
+#define RTAO_RAW_INDEX 53
+#define DDGI_OUTPUT_INDEX 54
+#define RTAO_HISTORY_INDEX 55
+#define PT_VARIANCE_INDEX 57
+#define DDGI_TEXTURE_VIS_INDEX 58
+
+#define SCENE_TLAS_INDEX 95
+#define DDGIPROBEVIS_TLAS_INDEX 96
+
+#define BLUE_NOISE_INDEX 97
+
+#define SPHERE_INDEX_BUFFER_INDEX 441
+#define SPHERE_VERTEX_BUFFER_INDEX 442
+#define MESH_OFFSETS_INDEX 443
+#define GEOMETRY_DATA_INDEX 444
+#define GEOMETRY_BUFFERS_INDEX 445
 
 // Sampler Accessor Functions ------------------------------------------------------------------------------
 
@@ -245,24 +323,65 @@ StructuredBuffer<Light> GetLights() { return StructuredBuffer<Light>(ResourceDes
 
 void GetGeometryData(uint meshIndex, uint geometryIndex, out GeometryData geometry)
 {
-    uint address = ByteAddressBuffer(ResourceDescriptorHeap[MESH_OFFSETS_INDEX]).Load(meshIndex * 4) * 12; // offset to start of mesh, GeometryData is 12 bytes
-    address += geometryIndex * 12; // offset to mesh primitive geometry
+    uint address = ByteAddressBuffer(ResourceDescriptorHeap[MESH_OFFSETS_INDEX]).Load(meshIndex * 4); // address of the Mesh in the GeometryData buffer
+    address += geometryIndex * 64; // offset to mesh primitive geometry, GeometryData stride is 64 bytes
 
     ByteAddressBuffer geometryData = ByteAddressBuffer(ResourceDescriptorHeap[GEOMETRY_DATA_INDEX]);
     geometry.materialIndex = geometryData.Load(address);
     geometry.indexByteAddress = geometryData.Load(address + 4);
     geometry.vertexByteAddress = geometryData.Load(address + 8);
+    geometry.albedoByteAddress = geometryData.Load(address + 12);
+    geometry.positionTransform[0] = asfloat(geometryData.Load4(address + 16));
+    geometry.positionTransform[1] = asfloat(geometryData.Load4(address + 32));
+    geometry.positionTransform[2] = asfloat(geometryData.Load4(address + 48));
 }
 Material GetMaterial(GeometryData geometry) { return StructuredBuffer<Material>(ResourceDescriptorHeap[MATERIALS_INDEX]).Load(geometry.materialIndex); }
+GIMaterial GetGIMaterial(GeometryData geometry) { return StructuredBuffer<GIMaterial>(ResourceDescriptorHeap[GI_MATERIALS_INDEX]).Load(geometry.materialIndex); }
+StructuredBuffer<LightBVHNode> GetLightBVHNodes() { return ResourceDescriptorHeap[LIGHT_BVH_NODES_INDEX]; }
+StructuredBuffer<EmissiveTriangle> GetEmissiveTriangles() { return ResourceDescriptorHeap[EMISSIVE_TRIANGLES_INDEX]; }
 
 StructuredBuffer<DDGIVolumeDescGPUPacked> GetDDGIVolumeConstants(uint index) { return ResourceDescriptorHeap[index]; }
 StructuredBuffer<DDGIVolumeResourceIndices> GetDDGIVolumeResourceIndices(uint index) { return ResourceDescriptorHeap[index]; }
+StructuredBuffer<DDGIVolumeBoundsGPU> GetDDGIVolumeBounds() { return ResourceDescriptorHeap[DDGI_VOLUME_BOUNDS_INDEX]; }
 
 RWStructuredBuffer<TLASInstance> GetDDGIProbeVisTLASInstances() { return ResourceDescriptorHeap[DDGIPROBEVIS_TLAS_INSTANCES_INDEX]; }
+StructuredBuffer<TLASInstance> GetTLASInstances() { return ResourceDescriptorHeap[SCENE_TLAS_INSTANCES_INDEX]; }
+
+RWStructuredBuffer<HitPackedData>             GetHitCachingBuffer() { return ResourceDescriptorHeap[HIT_CACHING_INDEX]; }
+RWStructuredBuffer<RadianceCacheStorage>      GetRadianceCachingBuffer() { return ResourceDescriptorHeap[RADIANCE_CACHING_INDEX]; }
+RWStructuredBuffer<RadianceCacheVisualization> GetRadianceCachingVisualizationBuffer() { return ResourceDescriptorHeap[RADIANCE_CACHING_VISUALIZATION_INDEX]; }
+RWByteAddressBuffer                           GetRadianceCacheAccumulationByteBuffer() { return ResourceDescriptorHeap[RADIANCE_CACHE_ACCUMULATION_INDEX]; }
+RWByteAddressBuffer                           GetRadianceCacheMetadataBuffer() { return ResourceDescriptorHeap[RADIANCE_CACHE_METADATA_INDEX]; }
+RWStructuredBuffer<uint2>                     GetProbeRayHitMap() { return ResourceDescriptorHeap[PROBE_RAY_HIT_MAP_INDEX]; }
+RWStructuredBuffer<uint>                      GetRadianceCacheWorkList() { return ResourceDescriptorHeap[RADIANCE_CACHE_WORK_LIST_INDEX]; }
+RWByteAddressBuffer                           GetRadianceCacheWorkListArgs() { return ResourceDescriptorHeap[RADIANCE_CACHE_WORK_LIST_ARGS_INDEX]; }
+RWStructuredBuffer<uint>                      GetRadianceCacheSortedWorkList() { return ResourceDescriptorHeap[RADIANCE_CACHE_SORTED_WORK_LIST_INDEX]; }
+RWStructuredBuffer<uint>                      GetRadianceCacheSortBins() { return ResourceDescriptorHeap[RADIANCE_CACHE_SORT_BINS_INDEX]; }
+RWByteAddressBuffer                           GetRadianceCacheBudgetBuffer() { return ResourceDescriptorHeap[RADIANCE_CACHE_BUDGET_INDEX]; }
+RWByteAddressBuffer                           GetDDGIProbeSchedule(uint index) { return ResourceDescriptorHeap[index]; }  // index is DDGIVolumeResourceIndices::probeScheduleUAVIndex (a heap index)
+RWStructuredBuffer<uint4>                     GetProbeTraceBatch() { return ResourceDescriptorHeap[PROBE_TRACE_BATCH_INDEX]; }
+RWStructuredBuffer<PathTraceWavefrontPath>    GetPTWavefrontPaths() { return ResourceDescriptorHeap[PT_WAVEFRONT_PATHS_INDEX]; }
+RWStructuredBuffer<PathTraceWavefrontHit>     GetPTWavefrontHits() { return ResourceDescriptorHeap[PT_WAVEFRONT_HITS_INDEX]; }
+RWStructuredBuffer<PathTraceWavefrontSurface> GetPTWavefrontSurfaces() { return ResourceDescriptorHeap[PT_WAVEFRONT_SURFACES_INDEX]; }
+RWStructuredBuffer<uint>                      GetPTWavefrontQueues() { return ResourceDescriptorHeap[PT_WAVEFRONT_QUEUES_INDEX]; }
+RWByteAddressBuffer                           GetPTWavefrontCounters() { return ResourceDescriptorHeap[PT_WAVEFRONT_COUNTERS_INDEX]; }
+RWByteAddressBuffer                           GetPTConvergence() { return ResourceDescriptorHeap[PT_CONVERGENCE_INDEX]; }
+RWTexture2D<uint2>                            GetGBufferVisibility() { return ResourceDescriptorHeap[GBUFFER_VISIBILITY_INDEX]; }
+RWTexture2D<uint>                             GetCompositeShadingRate() { return ResourceDescriptorHeap[COMPOSITE_SHADING_RATE_INDEX]; }
+RWByteAddressBuffer                           GetTextureFeedback() { return ResourceDescriptorHeap[TEXTURE_FEEDBACK_INDEX]; }
+RWByteAddressBuffer                           GetGPUCounters() { return ResourceDescriptorHeap[GPU_COUNTERS_INDEX]; }
+RWByteAddressBuffer                           GetRadianceCacheStats() { return ResourceDescriptorHeap[RADIANCE_CACHE_STATS_INDEX]; }
+RWByteAddressBuffer                           GetGBufferTiles() { return ResourceDescriptorHeap[GBUFFER_TILES_INDEX]; }
+RWByteAddressBuffer                           GetLightGrid() { return ResourceDescriptorHeap[LIGHT_GRID_INDEX]; }
+RWByteAddressBuffer                           GetRadianceCacheReservoirBuffer() { return ResourceDescriptorHeap[RADIANCE_CACHE_RESERVOIRS_INDEX]; }
+RWByteAddressBuffer                           GetIrradianceQueries() { return ResourceDescriptorHeap[IRRADIANCE_QUERIES_INDEX]; }
+RWByteAddressBuffer                           GetCompositeExposure() { return ResourceDescriptorHeap[COMPOSITE_EXPOSURE_INDEX]; }
+RWByteAddressBuffer                           GetProbeDeltas() { return ResourceDescriptorHeap[PROBE_DELTAS_INDEX]; }
 
 RaytracingAccelerationStructure GetAccelerationStructure(uint index) { return ResourceDescriptorHeap[index];}
 
 RWTexture2D<float4> GetRWTex2D(uint index) { return ResourceDescriptorHeap[index]; }
+RasterizerOrderedTexture2D<float4> GetROVTex2D(uint index) { return ResourceDescriptorHeap[index]; }
 Texture2D<float4> GetTex2D(uint index) { return ResourceDescriptorHeap[index]; }
 
 RWTexture2DArray<float4> GetRWTex2DArray(uint index) { return ResourceDescriptorHeap[index]; }
@@ -276,4 +395,85 @@ ByteAddressBuffer GetVertexBuffer(uint meshIndex) { return ResourceDescriptorHea
 
 #endif // RTXGI_BINDLESS_TYPE
 
+// Hit Cache and Radiance Cache Helpers ----------------------------------------------------------------------
+
+void PackData(HitUnpackedData InData, out HitPackedData OutData)
+{
+#if HIT_CACHE_COMPACT
+    OutData.PrimitivePacked = (InData.PrimitiveIndex & 0x3FFFFF) |
+                              ((InData.GeometryIndex & 0x3FF) << 22);
+
+    OutData.InstancePacked = (InData.InstanceIndex & 0xFFF) |
+                             ((InData.CascadeIndex & 0xF) << 12) |
+                             (f32tof16(InData.HitDistance) << 16);
+
+    uint2 UBarycentrics = (uint2)(saturate(InData.Barycentrics) * 65535.f + 0.5f);
+    OutData.Barycentrics = UBarycentrics.x | (UBarycentrics.y << 16);
+
+    OutData.Checksum = InData.Checksum;
+#else
+    OutData.ProbePacked = (InData.ProbeIndex & 0xFFFF) |
+                          ((InData.RayIndex & 0xFF) << 16) |
+                          (InData.VolumeIndex & 0xFF) << 24;
+
+    OutData.PrimitivePacked = (InData.InstanceIndex & 0xFFF) | 
+                              ((InData.PrimitiveIndex & 0x3FF) << 12) | 
+                              ((InData.GeometryIndex & 0x3FF) << 22);
+
+    uint2 UBarycentrics = f32tof16(InData.Barycentrics);
+    OutData.Barycentrics = (UBarycentrics.x & 0xFFFF) | 
+                            ((UBarycentrics.y & 0xFFFF) << 16);
+
+    OutData.HitDistance = InData.HitDistance;
+    OutData.GridCoord = InData.GridCoord;
+    OutData.CascadeIndex = InData.CascadeIndex;
+#endif
+}
+
+void UnpackData(HitPackedData InData, out HitUnpackedData OutData)
+{
+#if HIT_CACHE_COMPACT
+    OutData.ProbeIndex = 0;
+    OutData.RayIndex = 0;
+    OutData.VolumeIndex = 0;
+
+    OutData.PrimitiveIndex = InData.PrimitivePacked & 0x3FFFFF;
+    OutData.GeometryIndex = (InData.PrimitivePacked >> 22) & 0x3FF;
+    OutData.InstanceIndex = InData.InstancePacked & 0xFFF;
+    OutData.CascadeIndex = (InData.InstancePacked >> 12) & 0xF;
+    OutData.HitDistance = f16tof32(InData.InstancePacked >> 16);
+
+    uint2 UBarycentrics = uint2(InData.Barycentrics & 0xFFFF, InData.Barycentrics >> 16);
+    OutData.Barycentrics = (float2)UBarycentrics / 65535.f;
+
+    OutData.GridCoord = int3(0, 0, 0);
+    OutData.Checksum = InData.Checksum;
+#else
+    OutData.ProbeIndex = InData.ProbePacked & 0xFFFF;    
+    OutData.RayIndex = (InData.ProbePacked >> 16) & 0xFF;
+    OutData.VolumeIndex = (InData.ProbePacked >> 24) & 0xFF;
+
+    OutData.InstanceIndex = InData.PrimitivePacked & 0xFFF;
+    OutData.PrimitiveIndex = (InData.PrimitivePacked >> 12) & 0x3FF;
+    OutData.GeometryIndex = (InData.PrimitivePacked >> 22) & 0x3FF;
+
+    uint2 UBarycentrics;
+    UBarycentrics.x = InData.Barycentrics & 0xFFFF;
+    UBarycentrics.y = (InData.Barycentrics >> 16) & 0xFFFF;
+    OutData.Barycentrics = f16tof32(UBarycentrics);
+
+    OutData.HitDistance = InData.HitDistance;
+    OutData.GridCoord = InData.GridCoord;
+    OutData.CascadeIndex = InData.CascadeIndex;
+    OutData.Checksum = 0;
+#endif
+}
+
+// Resolved radiance of a cache slot, in the RADIANCE_CACHE_RADIANCE_FORMAT storage format
+float3 LoadCachedRadiance(uint slot) { return UnpackCachedRadiance(GetRadianceCachingBuffer()[slot]); }
+void StoreCachedRadiance(uint slot, float3 radiance) { GetRadianceCachingBuffer()[slot] = PackCachedRadiance(radiance); }
+
+// Resolution of the screen-space passes, the top left of the (window sized) render targets with dynamic resolution
+uint2 GetRenderResolution() { return uint2(GetCamera().resolution); }
+
 #endif // DESCRIPTORS_HLSL
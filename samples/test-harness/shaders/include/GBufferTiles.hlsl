@@ -0,0 +1,50 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#ifndef GBUFFER_TILES_HLSL
+#define GBUFFER_TILES_HLSL
+
+#include "Descriptors.hlsl"
+
+// ============================================================================
+// GBuffer Tile Classification
+// ============================================================================
+// GBufferCS lists the GBUFFER_TILE_SIZE^2 pixel tiles (its thread groups) that
+// hold at least one primary ray hit. GBufferTileArgsCS turns the list count into
+// indirect arguments, and the indirect lighting gather (IndirectCS) and the RTAO
+// trace run over the listed tiles only. Sky tiles have nothing to light or occlude.
+//
+// GBufferTiles (RWByteAddressBuffer):
+//   0: ThreadGroupCountX, ThreadGroupCountY, ThreadGroupCountZ (D3D12_DISPATCH_ARGUMENTS, one group per tile)
+//  12: Number of tiles appended this frame (reset by GBufferTileArgsCS)
+//  16: The listed tiles, packed (x | y << 16)
+// The arguments are copied to a buffer that stays in the indirect argument state
+// while the consumers read the list, see GBuffer_D3D12.cpp.
+
+#define GBUFFER_TILE_SIZE 8                   // Must match GBUFFER_TILE_SIZE in Graphics.h
+#define GBUFFER_TILES_ARGS_OFFSET 0
+#define GBUFFER_TILES_COUNT_OFFSET 12
+#define GBUFFER_TILES_LIST_OFFSET 16
+
+// GBUFFER_TILES may be passed in as a define at shader compilation time (Globals::GBufferTiles).
+#ifndef GBUFFER_TILES
+#define GBUFFER_TILES 0
+#endif
+
+/**
+ * Coordinates of a listed tile (in tiles).
+ */
+uint2 GBufferTilesGetTile(uint index)
+{
+    uint packed = GetGBufferTiles().Load(GBUFFER_TILES_LIST_OFFSET + (index * 4));
+    return uint2(packed & 0xFFFF, packed >> 16);
+}
+
+#endif // GBUFFER_TILES_HLSL
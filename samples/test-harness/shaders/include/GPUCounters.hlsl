@@ -0,0 +1,116 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+// Note: you must include Descriptors.hlsl before this file
+
+#ifndef GPU_COUNTERS_HLSL
+#define GPU_COUNTERS_HLSL
+
+// ============================================================================
+// GPU Counters
+// ============================================================================
+// With GPU_COUNTERS, the DDGI passes count their rays and radiance cache lookups in the GPUCounters buffer.
+// One uint per counter, in the order of Instrumentation::ECounter (see Instrumentation.h).
+// The application copies the buffer to a readback buffer at the end of the probe update chain, then clears it.
+// RadianceCacheStatsCS reduces the radiance cache metadata into the RadianceCacheStats buffer, read back the same way.
+
+// GPU_COUNTERS may be passed in as a define at shader compilation time (config app.gpuCounters).
+#ifndef GPU_COUNTERS
+#define GPU_COUNTERS 0
+#endif
+
+#define GPU_COUNTER_PROBE_RAYS              0   // Probe rays traced (ProbeTraceCS)
+#define GPU_COUNTER_PROBE_RAY_HITS          1
+#define GPU_COUNTER_PROBE_RAY_MISSES        2
+#define GPU_COUNTER_CACHE_HITS              3   // Probe ray hits whose cell already had radiance history
+#define GPU_COUNTER_CACHE_MISSES            4   // Probe ray hits that claimed an empty cell or evicted a stale one
+#define GPU_COUNTER_CACHE_COLLISIONS        5   // Saturated probe sequences (ProbeTraceCS) and checksum mismatches (RadianceCacheCS)
+#define GPU_COUNTER_INDIRECT_RAYS           6   // Radiance cache update rays traced (see RadianceCommon.hlsl)
+#define GPU_COUNTER_INDIRECT_RAY_HITS       7
+#define GPU_COUNTER_INDIRECT_RAY_MISSES     8
+#define GPU_COUNTER_INDIRECT_CACHE_HITS     9   // Update ray hits that found a live cell
+#define GPU_COUNTER_INDIRECT_CACHE_MISSES   10  // Update ray hits without a cell (no radiance)
+#define GPU_COUNTER_CACHE_EVICTIONS         11  // Probe ray hits that reclaimed a stale cell of another key
+#define GPU_COUNTER_COUNT                   12
+
+// RadianceCacheStats layout: RADIANCE_CACHE_STATS_STRIDE bytes per cascade
+// - occupied slots, live slots, sum of the live slots' age, sum of the live slots' probe sequence steps
+// - probe rays that hit a cell this frame, cells hit by probe rays this frame (covered cells)
+// - RADIANCE_CACHE_STATS_COVERAGE_BINS histogram bins of the covered cells by probe rays: 1, 2-3, 4-7, ..., 512 or more
+#define RADIANCE_CACHE_STATS_STRIDE         64
+#define RADIANCE_CACHE_STATS_COVERAGE_OFFSET 16
+#define RADIANCE_CACHE_STATS_COVERAGE_BINS  10
+
+/**
+ * Add value to the counter. The active lanes of the wave are summed, so the buffer sees one atomic per wave.
+ */
+void GPUCounterAdd(uint counter, uint value)
+{
+#if GPU_COUNTERS
+    uint waveValue = WaveActiveSum(value);
+    if (WaveIsFirstLane() && waveValue > 0) GetGPUCounters().InterlockedAdd(counter * 4, waveValue);
+#endif
+}
+
+/**
+ * Add one to the counter for every active lane of the wave where condition is true.
+ */
+void GPUCounterIncrement(uint counter, bool condition)
+{
+#if GPU_COUNTERS
+    uint waveValue = WaveActiveCountBits(condition);
+    if (WaveIsFirstLane() && waveValue > 0) GetGPUCounters().InterlockedAdd(counter * 4, waveValue);
+#endif
+}
+
+/**
+ * Add the occupied slots, live slots, live slot age, and live slot probe sequence steps of a wave to the cascade's radiance cache stats.
+ */
+void RadianceCacheStatsAdd(uint cascade, uint4 sums)
+{
+#if GPU_COUNTERS
+    RWByteAddressBuffer stats = GetRadianceCacheStats();
+    uint address = cascade * RADIANCE_CACHE_STATS_STRIDE;
+    if (sums.x > 0) stats.InterlockedAdd(address, sums.x);
+    if (sums.y > 0) stats.InterlockedAdd(address + 4, sums.y);
+    if (sums.z > 0) stats.InterlockedAdd(address + 8, sums.z);
+    if (sums.w > 0) stats.InterlockedAdd(address + 12, sums.w);
+#endif
+}
+
+/**
+ * Add the probe rays and covered cells of a wave to the cascade's radiance cache coverage stats.
+ * ProbeRays is the number of probe rays that hit the lane's cell this frame (0: the cell wasn't hit).
+ */
+void RadianceCacheCoverageAdd(uint cascade, uint probeRays)
+{
+#if GPU_COUNTERS
+    RWByteAddressBuffer stats = GetRadianceCacheStats();
+    uint address = (cascade * RADIANCE_CACHE_STATS_STRIDE) + RADIANCE_CACHE_STATS_COVERAGE_OFFSET;
+
+    uint waveRays = WaveActiveSum(probeRays);
+    uint waveCells = WaveActiveCountBits(probeRays > 0);
+    if (WaveIsFirstLane() && waveRays > 0)
+    {
+        stats.InterlockedAdd(address, waveRays);
+        stats.InterlockedAdd(address + 4, waveCells);
+    }
+
+    // Histogram of the covered cells, one bin per power of two of probe rays
+    uint bin = min(firstbithigh(probeRays), RADIANCE_CACHE_STATS_COVERAGE_BINS - 1);
+    for (uint binIndex = 0; binIndex < RADIANCE_CACHE_STATS_COVERAGE_BINS; binIndex++)
+    {
+        uint waveBinCells = WaveActiveCountBits((probeRays > 0) && (bin == binIndex));
+        if (WaveIsFirstLane() && waveBinCells > 0) stats.InterlockedAdd(address + 8 + (binIndex * 4), waveBinCells);
+    }
+#endif
+}
+
+#endif // GPU_COUNTERS_HLSL
@@ -13,11 +13,70 @@
 
 #include "Common.hlsl"
 #include "Descriptors.hlsl"
+#include "RayTracing.hlsl"
+
+// LIGHT_GRID: Spot and point lights come from the world-space light grid (see LightGrid.hlsl)
+// - 1 = evaluate only the lights listed in the shaded point's cell (the grid must be built this frame)
+// - 0 = evaluate every light
+#ifndef LIGHT_GRID
+#define LIGHT_GRID 0
+#endif
+
+// LIGHT_GRID_STOCHASTIC: One shadow ray per shaded point for the light grid's lights
+// - 1 = pick one light of the cell, weighted by its unshadowed contribution (RIS over
+//       the cell's light list), and trace a single shadow ray. Noisy per sample,
+//       intended for passes that accumulate over frames (radiance cache).
+// - 0 = trace a shadow ray for every light of the cell
+#ifndef LIGHT_GRID_STOCHASTIC
+#define LIGHT_GRID_STOCHASTIC 0
+#endif
+
+// EMISSIVE_LIGHTS: The scene's emissive triangles light the surface (D3D12 only)
+// - 1 = EvaluateEmissiveLightInline samples one emissive triangle from the light BVH (see
+//       LightBVHNode) and traces a single shadow ray to it. Noisy per sample, intended
+//       for passes that accumulate over frames (radiance cache).
+// - 0 = emissive triangles don't light other surfaces
+#ifndef EMISSIVE_LIGHTS
+#define EMISSIVE_LIGHTS 0
+#endif
+
+// LIGHT_VISIBILITY_CACHE: Shadow ray results of the first LIGHT_VISIBILITY_CACHE_LIGHTS lights are reused (D3D12 only)
+// - 1 = the caller loads the visibility bits of the surface into LightVisibilityBits/Valid/Frame before
+//       shading, and stores the bits traced (LightVisibilityTraced) after. A light's bit is reused while
+//       it is valid and the light (or the scene's instances) didn't change since LightVisibilityFrame
+//       (see Light::changedFrame). Intended for passes that shade the same surfaces every frame (radiance cache).
+// - 0 = trace a shadow ray for every light evaluated
+#ifndef LIGHT_VISIBILITY_CACHE
+#define LIGHT_VISIBILITY_CACHE 0
+#endif
+
+#define LIGHT_VISIBILITY_CACHE_LIGHTS 32
+
+#if LIGHT_GRID
+#include "LightGrid.hlsl"
+#endif
+
+#if LIGHT_GRID || EMISSIVE_LIGHTS
+#include "Random.hlsl"
+#endif
 
 // ============================================================================
 // Inline Ray Tracing Visibility Functions
 // ============================================================================
 
+/**
+ * Commit a visibility ray's non-opaque candidate if it passes the GI alpha test (see AlphaTestGI).
+ * Opaque candidates are committed by the query itself.
+ */
+void CommitAlphaTestedCandidateInline(RayQuery<RAY_FLAG_ACCEPT_FIRST_HIT_AND_END_SEARCH> RQuery)
+{
+    if (RQuery.CandidateType() != CANDIDATE_NON_OPAQUE_TRIANGLE) return;
+    if (AlphaTestGI(RQuery.CandidateInstanceID(), RQuery.CandidateGeometryIndex(), RQuery.CandidatePrimitiveIndex(), RQuery.CandidateTriangleBarycentrics()))
+    {
+        RQuery.CommitNonOpaqueTriangleHit();
+    }
+}
+
 /**
  * Computes the visibility factor for a given vector to a light using inline ray tracing (RayQuery).
  * Returns 1.0 if visible, 0.0 if occluded.
@@ -43,12 +102,49 @@ float LightVisibilityInline(
         RAY_FLAG_ACCEPT_FIRST_HIT_AND_END_SEARCH,
         0xFF,
         ray);
-    RQuery.Proceed();
+    while (RQuery.Proceed()) CommitAlphaTestedCandidateInline(RQuery);
 
     // If no hit committed, the light is visible
     return (RQuery.CommittedStatus() == COMMITTED_NOTHING) ? 1.f : 0.f;
 }
 
+#if LIGHT_VISIBILITY_CACHE
+// Light visibility cache of the surface being shaded (bit i: light i)
+static uint LightVisibilityBits = 0;      // 1: the light is visible
+static uint LightVisibilityValid = 0;     // 1: the light's bit can be reused (if the light didn't change since LightVisibilityFrame)
+static uint LightVisibilityFrame = 0;     // Frame the bits were last traced
+static uint LightVisibilityTraced = 0;    // 1: the light's bit was traced while shading the surface
+#endif
+
+/**
+ * Computes the visibility factor of a light of the Lights buffer, reusing (and recording)
+ * its cached shadow ray result when LIGHT_VISIBILITY_CACHE is enabled.
+ */
+float CachedLightVisibilityInline(
+    uint lightIndex,
+    Light light,
+    Payload payload,
+    float3 lightVector,
+    float tmax,
+    float normalBias,
+    float viewBias,
+    RaytracingAccelerationStructure bvh)
+{
+#if LIGHT_VISIBILITY_CACHE
+    if (lightIndex < LIGHT_VISIBILITY_CACHE_LIGHTS)
+    {
+        uint bit = (1u << lightIndex);
+        if ((LightVisibilityValid & bit) && (light.changedFrame < LightVisibilityFrame)) return (LightVisibilityBits & bit) ? 1.f : 0.f;
+
+        float visibility = LightVisibilityInline(payload, lightVector, tmax, normalBias, viewBias, bvh);
+        LightVisibilityBits = (visibility > 0.f) ? (LightVisibilityBits | bit) : (LightVisibilityBits & ~bit);
+        LightVisibilityTraced |= bit;
+        return visibility;
+    }
+#endif
+    return LightVisibilityInline(payload, lightVector, tmax, normalBias, viewBias, bvh);
+}
+
 /**
  * Trace a visibility ray and return whether it hit anything (for shadow testing).
  * Returns true if occluded, false if visible.
@@ -72,7 +168,7 @@ bool TraceVisibilityRayInline(
         RAY_FLAG_ACCEPT_FIRST_HIT_AND_END_SEARCH,
         0xFF,
         ray);
-    RQuery.Proceed();
+    while (RQuery.Proceed()) CommitAlphaTestedCandidateInline(RQuery);
 
     return (RQuery.CommittedStatus() == COMMITTED_TRIANGLE_HIT);
 }
@@ -125,7 +221,7 @@ float3 EvaluateSpotLightInline(
         if (lightDistance > spotLight.radius) continue;
 
         float tmax = (lightDistance - viewBias);
-        float visibility = LightVisibilityInline(payload, lightVector, tmax, normalBias, viewBias, bvh);
+        float visibility = CachedLightVisibilityInline(index, spotLight, payload, lightVector, tmax, normalBias, viewBias, bvh);
 
         // Early out, this light isn't visible from the surface
         if (visibility <= 0.f) continue;
@@ -169,7 +265,7 @@ float3 EvaluatePointLightInline(
         if (lightDistance > pointLight.radius) continue;
 
         float tmax = (lightDistance - viewBias);
-        float visibility = LightVisibilityInline(payload, lightVector, tmax, normalBias, viewBias, bvh);
+        float visibility = CachedLightVisibilityInline(index, pointLight, payload, lightVector, tmax, normalBias, viewBias, bvh);
 
         // Early out, this light isn't visible from the surface
         if (visibility <= 0.f) continue;
@@ -198,7 +294,7 @@ float3 EvaluateDirectionalLightInline(
     // Load the directional light data (directional light is always the first light)
     Light directionalLight = lights[0];
 
-    float visibility = LightVisibilityInline(payload, -directionalLight.direction, 1e27f, normalBias, viewBias, bvh);
+    float visibility = CachedLightVisibilityInline(0, directionalLight, payload, -directionalLight.direction, 1e27f, normalBias, viewBias, bvh);
 
     // Early out, the light isn't visible from the surface
     if (visibility <= 0.f) return float3(0.f, 0.f, 0.f);
@@ -210,6 +306,226 @@ float3 EvaluateDirectionalLightInline(
     return directionalLight.power * directionalLight.color * nol * visibility;
 }
 
+#if LIGHT_GRID
+/**
+ * Evaluate the unshadowed direct lighting of a spot or point light (inline version).
+ * Returns zero when the surface is out of the light's reach.
+ */
+float3 EvaluateLocalLightUnshadowedInline(Payload payload, Light light, out float3 lightVector, out float lightDistance)
+{
+    lightVector = (light.position - payload.worldPosition);
+    lightDistance = length(lightVector);
+
+    // Light energy doesn't reach the surface
+    if (lightDistance > light.radius) return float3(0.f, 0.f, 0.f);
+
+    float3 lightDirection = normalize(lightVector);
+    float  nol = max(dot(payload.normal, lightDirection), 0.f);
+    float  attenuation = 1.f;
+    if (light.type == 1)
+    {
+        float3 spotDirection = normalize(light.direction);
+        attenuation = SpotAttenuationInline(spotDirection, -lightDirection, light.umbraAngle, light.penumbraAngle);
+    }
+    float  falloff = LightFalloffInline(lightDistance);
+    float  window = LightWindowingInline(lightDistance, light.radius);
+
+    return light.power * light.color * nol * attenuation * falloff * window;
+}
+
+/**
+ * Evaluate direct lighting for the current surface and the spot and point lights listed
+ * in its light grid cell (inline version).
+ */
+float3 EvaluateLightGridInline(
+    Payload payload,
+    float normalBias,
+    float viewBias,
+    RaytracingAccelerationStructure bvh,
+    StructuredBuffer<Light> lights)
+{
+    RWByteAddressBuffer grid = GetLightGrid();
+
+    // Early out, no local light reaches the surface
+    uint cellOffset;
+    if (!LightGridFindCell(grid, payload.worldPosition, cellOffset)) return float3(0.f, 0.f, 0.f);
+
+    // The cell's list overflowed, evaluate every light
+    uint count = grid.Load(cellOffset);
+    if (count == LIGHT_GRID_CELL_OVERFLOW)
+    {
+        return EvaluateSpotLightInline(payload, normalBias, viewBias, bvh, lights)
+             + EvaluatePointLightInline(payload, normalBias, viewBias, bvh, lights);
+    }
+
+    float3 lightVector;
+    float  lightDistance;
+#if LIGHT_GRID_STOCHASTIC
+    // Weighted reservoir sampling over the cell's lights, target = unshadowed luminance
+    uint seed = WangHash(asuint(payload.worldPosition.x) ^ WangHash(asuint(payload.worldPosition.y) ^ WangHash(asuint(payload.worldPosition.z))));
+    seed += GetGlobalConst(app, frameNumber);
+
+    uint   selectedIndex = 0;
+    float3 selectedColor = 0.f;
+    float3 selectedVector = 0.f;
+    float  selectedDistance = 0.f;
+    float  selectedWeight = 0.f;
+    float  weightSum = 0.f;
+    for (uint listIndex = 0; listIndex < count; listIndex++)
+    {
+        uint   lightIndex = grid.Load(cellOffset + 4 + (listIndex * 4));
+        float3 color = EvaluateLocalLightUnshadowedInline(payload, lights[lightIndex], lightVector, lightDistance);
+        float  weight = dot(color, float3(0.2126f, 0.7152f, 0.0722f));
+        if (weight <= 0.f) continue;
+
+        weightSum += weight;
+        if (GetRandomNumber(seed) * weightSum < weight)
+        {
+            selectedIndex = lightIndex;
+            selectedColor = color;
+            selectedVector = lightVector;
+            selectedDistance = lightDistance;
+            selectedWeight = weight;
+        }
+    }
+
+    // Early out, no listed light reaches the surface
+    if (weightSum <= 0.f) return float3(0.f, 0.f, 0.f);
+
+    float visibility = CachedLightVisibilityInline(selectedIndex, lights[selectedIndex], payload, selectedVector, (selectedDistance - viewBias), normalBias, viewBias, bvh);
+    return selectedColor * visibility * (weightSum / selectedWeight);
+#else
+    float3 color = 0;
+    for (uint listIndex = 0; listIndex < count; listIndex++)
+    {
+        uint   lightIndex = grid.Load(cellOffset + 4 + (listIndex * 4));
+        Light  light = lights[lightIndex];
+        float3 lightColor = EvaluateLocalLightUnshadowedInline(payload, light, lightVector, lightDistance);
+
+        // Early out, the light doesn't light the surface
+        if (all(lightColor <= 0.f)) continue;
+
+        float tmax = (lightDistance - viewBias);
+        color += lightColor * CachedLightVisibilityInline(lightIndex, light, payload, lightVector, tmax, normalBias, viewBias, bvh);
+    }
+    return color;
+#endif
+}
+#endif
+
+#if EMISSIVE_LIGHTS
+// Light BVH traversal depth limit, the median split BVH of 2^(N-1) triangles is N levels deep
+#define LIGHT_BVH_MAX_DEPTH 32
+
+/**
+ * Estimate how much a light BVH node lights a surface: the node's power over the squared distance
+ * to its bounds' center (clamped to the bounds' extent). Zero when the bounds are behind the surface.
+ */
+float LightBVHNodeImportance(LightBVHNode node, float3 position, float3 normal)
+{
+    float3 center = (node.boundsMin + node.boundsMax) * 0.5f;
+    float3 extent = (node.boundsMax - node.boundsMin);
+
+    // The corner of the bounds furthest along the normal is behind the surface
+    float3 corner = center + (extent * 0.5f * sign(normal));
+    if (dot(corner - position, normal) <= 0.f) return 0.f;
+
+    float3 toCenter = (center - position);
+    float  distanceSquared = max(dot(toCenter, toCenter), dot(extent, extent) * 0.25f);
+    return node.power / max(distanceSquared, 1e-6f);
+}
+
+/**
+ * Stochastically traverse the light BVH from the root to an emissive triangle, choosing the child
+ * at each node in proportion to its importance for the surface.
+ * Returns false when no emissive triangle lights the surface.
+ */
+bool SampleLightBVH(float3 position, float3 normal, float u, out uint triangleIndex, out float pdf)
+{
+    StructuredBuffer<LightBVHNode> nodes = GetLightBVHNodes();
+
+    triangleIndex = 0;
+    pdf = 1.f;
+
+    LightBVHNode node = nodes[0];
+    if (node.power <= 0.f) return false;
+
+    for (uint depth = 0; depth < LIGHT_BVH_MAX_DEPTH; depth++)
+    {
+        if (node.child & LIGHT_BVH_LEAF)
+        {
+            triangleIndex = (node.child & ~LIGHT_BVH_LEAF);
+            return true;
+        }
+
+        LightBVHNode left = nodes[node.child];
+        LightBVHNode right = nodes[node.child + 1];
+        float leftImportance = LightBVHNodeImportance(left, position, normal);
+        float rightImportance = LightBVHNodeImportance(right, position, normal);
+        float importance = (leftImportance + rightImportance);
+        if (importance <= 0.f) return false;
+
+        // Pick a child and rescale the random number to [0, 1) for the next level
+        float leftProbability = (leftImportance / importance);
+        if (u < leftProbability)
+        {
+            u = (u / leftProbability);
+            pdf *= leftProbability;
+            node = left;
+        }
+        else
+        {
+            u = (u - leftProbability) / (1.f - leftProbability);
+            pdf *= (1.f - leftProbability);
+            node = right;
+        }
+        u = min(u, 0.99999994f);
+    }
+    return false;
+}
+
+/**
+ * Evaluate direct lighting for the current surface from one emissive triangle (inline version).
+ * The triangle is picked from the light BVH and a point is picked uniformly on it (next event estimation).
+ */
+float3 EvaluateEmissiveLightInline(
+    Payload payload,
+    float normalBias,
+    float viewBias,
+    RaytracingAccelerationStructure bvh,
+    inout uint seed)
+{
+    uint  triangleIndex;
+    float selectionPdf;
+    if (!SampleLightBVH(payload.worldPosition, payload.normal, GetRandomNumber(seed), triangleIndex, selectionPdf)) return float3(0.f, 0.f, 0.f);
+
+    EmissiveTriangle emitter = GetEmissiveTriangles()[triangleIndex];
+
+    // Uniform point on the triangle
+    float u = sqrt(GetRandomNumber(seed));
+    float v = GetRandomNumber(seed);
+    float3 lightPosition = emitter.position + (emitter.edge1 * (u * (1.f - v))) + (emitter.edge2 * (u * v));
+
+    float3 lightVector = (lightPosition - payload.worldPosition);
+    float  lightDistance = length(lightVector);
+    if (lightDistance <= viewBias) return float3(0.f, 0.f, 0.f);
+
+    float3 lightDirection = (lightVector / lightDistance);
+    float  cosLight = -dot(normalize(cross(emitter.edge1, emitter.edge2)), lightDirection);
+    if (emitter.doubleSided) cosLight = abs(cosLight);
+    float  nol = dot(payload.normal, lightDirection);
+
+    // Early out, the surface and the emitting face don't face each other
+    if (cosLight <= 0.f || nol <= 0.f) return float3(0.f, 0.f, 0.f);
+
+    // Convert the area pdf to solid angle
+    float pdf = selectionPdf * (lightDistance * lightDistance) / (emitter.area * cosLight);
+
+    float visibility = LightVisibilityInline(payload, lightVector, (lightDistance - viewBias), normalBias, viewBias, bvh);
+    return emitter.radiance * nol * visibility / pdf;
+}
+#endif
+
 /**
  * Computes the diffuse reflection of light off the given surface (direct lighting) using inline ray tracing.
  */
@@ -228,6 +544,12 @@ float3 DirectDiffuseLightingInline(
         lighting += EvaluateDirectionalLightInline(payload, normalBias, viewBias, bvh, lights);
     }
 
+#if LIGHT_GRID
+    if ((GetNumSpotLights() + GetNumPointLights()) > 0)
+    {
+        lighting += EvaluateLightGridInline(payload, normalBias, viewBias, bvh, lights);
+    }
+#else
     if (GetNumSpotLights() > 0)
     {
         lighting += EvaluateSpotLightInline(payload, normalBias, viewBias, bvh, lights);
@@ -237,6 +559,7 @@ float3 DirectDiffuseLightingInline(
     {
         lighting += EvaluatePointLightInline(payload, normalBias, viewBias, bvh, lights);
     }
+#endif
 
     return (brdf * lighting);
 }
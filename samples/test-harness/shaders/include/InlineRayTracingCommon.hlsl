@@ -3,6 +3,7 @@
 
 // Include RayTracing.hlsl for common functions (LoadIndices, LoadVertices, InterpolateVertex, etc.)
 #include "RayTracing.hlsl"
+#include "TextureStreaming.hlsl"
 
 // ============================================================================
 // Helper functions for inline ray tracing (compute shaders)
@@ -102,6 +103,7 @@ void ShadeTriangleHitInternal(
     if (material.albedoTexIdx > -1)
     {
         float4 bco = GetTex2D(material.albedoTexIdx).SampleGrad(GetAnisoWrapSampler(), v.uv0, dUVdx, dUVdy);
+        TextureFeedbackRecordGrad(material.albedoTexIdx, dUVdx, dUVdy);
         payload.albedo *= bco.rgb;
         payload.opacity *= bco.a;
     }
@@ -114,6 +116,7 @@ void ShadeTriangleHitInternal(
         float3x3 TBN = { tangent, bitangent, payload.normal };
 
         payload.shadingNormal = GetTex2D(material.normalTexIdx).SampleGrad(GetAnisoWrapSampler(), v.uv0, dUVdx, dUVdy).xyz;
+        TextureFeedbackRecordGrad(material.normalTexIdx, dUVdx, dUVdy);
         payload.shadingNormal = (payload.shadingNormal * 2.f) - 1.f;
         payload.shadingNormal = mul(payload.shadingNormal, TBN);
     }
@@ -122,6 +125,7 @@ void ShadeTriangleHitInternal(
     if (material.roughnessMetallicTexIdx > -1)
     {
         float2 rm = GetTex2D(material.roughnessMetallicTexIdx).SampleGrad(GetAnisoWrapSampler(), v.uv0, dUVdx, dUVdy).gb;
+        TextureFeedbackRecordGrad(material.roughnessMetallicTexIdx, dUVdx, dUVdy);
         payload.roughness = rm.x;
         payload.metallic = rm.y;
     }
@@ -130,6 +134,7 @@ void ShadeTriangleHitInternal(
     if (material.emissiveTexIdx > -1)
     {
         payload.albedo += GetTex2D(material.emissiveTexIdx).SampleGrad(GetAnisoWrapSampler(), v.uv0, dUVdx, dUVdy).rgb;
+        TextureFeedbackRecordGrad(material.emissiveTexIdx, dUVdx, dUVdy);
     }
 }
 
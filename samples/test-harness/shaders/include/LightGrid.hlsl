@@ -0,0 +1,80 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#ifndef LIGHT_GRID_HLSL
+#define LIGHT_GRID_HLSL
+
+// ============================================================================
+// World-Space Light Grid
+// ============================================================================
+// A uniform grid over the union of the spot and point lights' spheres of
+// influence (position +/- radius), rebuilt every frame by LightGridCS.hlsl:
+//   1. BoundsCS (1 group): reduce the light spheres to the grid bounds
+//   2. BuildCS (1 thread per cell): list the lights whose sphere overlaps the cell
+// DirectDiffuseLightingInline then only evaluates (and traces shadow rays for)
+// the lights listed in the cell of the shaded point. Points outside the grid
+// are out of reach of every local light. The directional light is never listed.
+
+// GRID_DIM: Cells per axis
+#ifndef LIGHT_GRID_DIM
+#define LIGHT_GRID_DIM 16
+#endif
+
+// MAX_LIGHTS_PER_CELL: Light list capacity of a cell
+// - A cell reached by more lights is marked LIGHT_GRID_CELL_OVERFLOW and its
+//   points evaluate every light, as without the grid
+#ifndef LIGHT_GRID_MAX_LIGHTS_PER_CELL
+#define LIGHT_GRID_MAX_LIGHTS_PER_CELL 31
+#endif
+
+#define LIGHT_GRID_CELL_COUNT (LIGHT_GRID_DIM * LIGHT_GRID_DIM * LIGHT_GRID_DIM)
+#define LIGHT_GRID_CELL_STRIDE ((1 + LIGHT_GRID_MAX_LIGHTS_PER_CELL) * 4)
+#define LIGHT_GRID_CELL_OVERFLOW 0xFFFFFFFF
+
+// Light grid buffer layout (RWByteAddressBuffer):
+//   0:  float3 grid min
+//   12: uint   number of local lights in the grid
+//   16: float3 cell size
+//   28: unused
+//   LIGHT_GRID_HEADER_SIZE + (cell * LIGHT_GRID_CELL_STRIDE):
+//       uint light count (or LIGHT_GRID_CELL_OVERFLOW),
+//       LIGHT_GRID_MAX_LIGHTS_PER_CELL uint indices into the Lights buffer
+#define LIGHT_GRID_HEADER_SIZE 32
+#define LIGHT_GRID_SIZE_IN_BYTES (LIGHT_GRID_HEADER_SIZE + (LIGHT_GRID_CELL_COUNT * LIGHT_GRID_CELL_STRIDE))
+
+/**
+ * Get the byte offset of a light grid cell.
+ */
+uint LightGridCellOffset(uint3 cell)
+{
+    uint cellIndex = cell.x + (cell.y * LIGHT_GRID_DIM) + (cell.z * LIGHT_GRID_DIM * LIGHT_GRID_DIM);
+    return LIGHT_GRID_HEADER_SIZE + (cellIndex * LIGHT_GRID_CELL_STRIDE);
+}
+
+/**
+ * Find the light grid cell containing a world-space position.
+ * Returns false when the position is outside the grid, i.e. out of reach of every local light.
+ */
+bool LightGridFindCell(RWByteAddressBuffer grid, float3 worldPosition, out uint cellOffset)
+{
+    cellOffset = 0;
+
+    float4 gridMin = asfloat(grid.Load4(0));
+    float3 cellSize = asfloat(grid.Load3(16));
+    if (asuint(gridMin.w) == 0) return false;
+
+    float3 cell = floor((worldPosition - gridMin.xyz) / cellSize);
+    if (any(cell < 0.f) || any(cell >= LIGHT_GRID_DIM)) return false;
+
+    cellOffset = LightGridCellOffset(uint3(cell));
+    return true;
+}
+
+#endif // LIGHT_GRID_HLSL
@@ -0,0 +1,83 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#ifndef PATH_TRACE_CONVERGENCE_HLSL
+#define PATH_TRACE_CONVERGENCE_HLSL
+
+#include "Descriptors.hlsl"
+
+#include "../../../../rtxgi-sdk/shaders/Common.hlsl"
+
+// ============================================================================
+// Path Tracing Convergence
+// ============================================================================
+// With progressive accumulation, the path tracer stores the second moment of
+// each frame's (per pixel mean) luminance next to the accumulated color:
+//   PTVariance: x = sum of the squared frame luminances, y = accumulated frames
+// PathTraceConvergenceCS estimates the relative error of the accumulated mean
+// of every PT_CONVERGENCE_TILE_SIZE^2 tile and stores a converged flag per tile.
+//
+// PTConvergence (bytes):
+//   [0, 8)     unconverged tile counts, ping-pong on the frame number parity
+//              (read back by PathTracing_D3D12.cpp)
+//   [16, ...)  one converged flag (uint) per tile, in row major order
+// Flags: PT_CONVERGENCE_FLAGS in Types.h, set by PathTracing_D3D12.cpp::Update().
+
+#define PT_CONVERGENCE_TILE_SIZE 16
+#define PT_CONVERGENCE_MIN_FRAMES 16          // Frames accumulated before a tile's variance estimate is trusted
+#define PT_CONVERGENCE_TILE_FLAGS_OFFSET 16
+
+bool PTConvergenceEnabled() { return (GetGlobalConst(pt, convergence) & PT_CONVERGENCE_FLAG_ENABLED); }
+bool PTConvergenceSteering() { return (GetGlobalConst(pt, convergence) & PT_CONVERGENCE_FLAG_STEERING); }
+bool PTConvergenceStopped() { return (GetGlobalConst(pt, convergence) & PT_CONVERGENCE_FLAG_STOPPED); }
+float PTConvergenceThreshold() { return f16tof32(GetGlobalConst(pt, convergence) & 0xFFFF); }
+
+uint PTConvergenceGetTileIndex(uint2 pixel, uint width)
+{
+    uint numTilesX = (width + PT_CONVERGENCE_TILE_SIZE - 1) / PT_CONVERGENCE_TILE_SIZE;
+    uint2 tile = pixel / PT_CONVERGENCE_TILE_SIZE;
+    return (tile.y * numTilesX) + tile.x;
+}
+
+/**
+ * Whether the pixel no longer needs paths. Converged pixels keep their accumulated color.
+ */
+bool PTConvergenceIsPixelConverged(uint2 pixel, uint width)
+{
+    if (!PTConvergenceEnabled()) return false;
+    if (GetGlobalConst(app, frameNumber) <= PT_CONVERGENCE_MIN_FRAMES) return false;
+    if (PTConvergenceStopped()) return true;
+    if (!PTConvergenceSteering()) return false;
+    return (GetPTConvergence().Load(PT_CONVERGENCE_TILE_FLAGS_OFFSET + (PTConvergenceGetTileIndex(pixel, width) * 4)) != 0);
+}
+
+/**
+ * Adds a frame's (mean) color of the pixel to its variance estimate.
+ */
+void PTConvergenceAccumulate(uint2 pixel, float3 frameColor)
+{
+    if (!PTConvergenceEnabled()) return;
+
+    RWTexture2D<float4> PTVariance = GetRWTex2D(PT_VARIANCE_INDEX);
+    float luminance = RTXGILinearRGBToLuminance(frameColor);
+    float2 moments = PTVariance[pixel].xy;
+    PTVariance[pixel] = float4(moments.x + (luminance * luminance), moments.y + 1.f, 0.f, 0.f);
+}
+
+/**
+ * Clears the variance estimate of the pixel (along with the accumulation buffer).
+ */
+void PTConvergenceClear(uint2 pixel)
+{
+    if (!PTConvergenceEnabled()) return;
+    GetRWTex2D(PT_VARIANCE_INDEX)[pixel] = float4(0.f, 0.f, 0.f, 0.f);
+}
+
+#endif // PATH_TRACE_CONVERGENCE_HLSL
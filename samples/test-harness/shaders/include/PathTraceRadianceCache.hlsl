@@ -0,0 +1,152 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#ifndef PATH_TRACE_RADIANCE_CACHE_HLSL
+#define PATH_TRACE_RADIANCE_CACHE_HLSL
+
+#include "Common.hlsl"
+#include "Descriptors.hlsl"
+#include "SpatialHash.hlsl"
+#include "RadianceCacheBudget.hlsl"
+#include "RadianceCacheReservoir.hlsl"
+
+#include "../../../../rtxgi-sdk/shaders/Common.hlsl"
+
+// ============================================================================
+// Path Tracing Radiance Cache Termination (SHaRC-style)
+// ============================================================================
+// With PT_RADIANCE_CACHE_BOUNCE > 0, paths end in the DDGI radiance cache: from
+// bounce PT_RADIANCE_CACHE_BOUNCE on, at the first vertex whose path footprint
+// covers the vertex's cache cell and whose cell has PT_RADIANCE_CACHE_MIN_HISTORY
+// updates, the cell's cached (outgoing) radiance replaces the vertex's direct
+// lighting and the rest of the path.
+//
+// The DDGI passes don't run in path tracing mode, so the paths update the cache:
+// the first PT_RADIANCE_CACHE_MAX_VERTICES vertices of a path claim their cells
+// and blend in the radiance the path gathered from the vertex on. Paths that
+// update a cell in the same frame race and one of them wins, like the non-atomic
+// fallback of ResolveRadianceCacheHit (see RadianceCommon.hlsl).
+//
+// Footprint: the primary ray spreads by the angle of a pixel and a diffuse bounce
+// by about a radian, so past the first bounce a path ends once a bounce ray is
+// longer than the cell it hits.
+
+#ifndef PT_RADIANCE_CACHE_BOUNCE
+#define PT_RADIANCE_CACHE_BOUNCE 0
+#endif
+
+#define PT_RADIANCE_CACHE_MAX_VERTICES 4
+#define PT_RADIANCE_CACHE_MIN_HISTORY 4          // Updates of a cell before paths end in it
+#define PT_RADIANCE_CACHE_MAX_HISTORY 32         // The blend weight of an update is 1 / min(updates, PT_RADIANCE_CACHE_MAX_HISTORY)
+#define PT_RADIANCE_CACHE_DIFFUSE_SPREAD 1.f     // Footprint growth per unit of distance past a diffuse bounce
+
+struct PTRadianceCacheVertex
+{
+    uint   slot;
+    float3 colorBefore;         // Path radiance gathered before the vertex
+    float3 throughput;          // Path throughput arriving at the vertex
+};
+
+struct PTRadianceCachePath
+{
+    float footprint;            // World-space width of the path's footprint at the last vertex
+    float spread;               // Footprint growth per unit of distance of the next ray
+    uint  numVertices;
+    PTRadianceCacheVertex vertices[PT_RADIANCE_CACHE_MAX_VERTICES];
+};
+
+void PTRadianceCacheBegin(out PTRadianceCachePath path, uint height)
+{
+    path = (PTRadianceCachePath)0;
+    path.spread = (2.f * GetCamera().tanHalfFovY) / (float)height;
+}
+
+/**
+ * Claim the cache cell of a path vertex, before the vertex is shaded.
+ * Returns true when the path ends in the cell, cachedRadiance is then the cell's radiance.
+ */
+bool PTRadianceCacheAddVertex(
+    inout PTRadianceCachePath path,
+    uint bounceIndex,
+    float3 position,
+    float hitT,
+    float3 color,
+    float3 throughput,
+    out float3 cachedRadiance)
+{
+    cachedRadiance = float3(0.f, 0.f, 0.f);
+
+    path.footprint += (hitT * path.spread);
+    path.spread = PT_RADIANCE_CACHE_DIFFUSE_SPREAD;
+
+    uint cascadeIndex;
+    int3 gridCoord;
+    SpatialHashCascadeGridCoord(position, hitT, GetCascadeCellRadius(), GetCascadeCount(), GetCascadeBaseDistance(), cascadeIndex, gridCoord);
+
+    bool evicted;
+    bool claimed;
+    bool firstTouch;
+    uint slot = SpatialHashGridInsert(gridCoord, cascadeIndex, GetMaxCacheCellCount(), GetRadianceCacheMetadataBuffer(), GetGlobalConst(app, frameNumber), evicted, claimed, firstTouch);
+    if (slot == RADIANCE_CACHE_INVALID_SLOT) return false;
+
+    // A reclaimed or new cell starts without history (see ProbeTraceCS.hlsl)
+    if (evicted)
+    {
+        StoreCachedRadiance(slot, float3(0.f, 0.f, 0.f));
+        GetRadianceCacheMetadataBuffer().Store2(slot * RADIANCE_CACHE_METADATA_STRIDE + RADIANCE_CACHE_METADATA_SHADED_FRAME_OFFSET, uint2(0, 0));
+        GetRadianceCacheMetadataBuffer().Store3(slot * RADIANCE_CACHE_METADATA_STRIDE + RADIANCE_CACHE_METADATA_LIGHT_VISIBILITY_OFFSET, uint3(0, 0, 0));
+    }
+    if (claimed)
+    {
+        RadianceCacheReservoirClear(GetRadianceCacheReservoirBuffer(), slot);
+        GetRadianceCachingVisualizationBuffer()[slot].HistoryFrames = 0;
+        GetRadianceCachingVisualizationBuffer()[slot].HomeSlot = SpatialHashGridHomeSlot(gridCoord, GetMaxCacheCellCount()) + (cascadeIndex * GetMaxCacheCellCount());
+    }
+
+    // End the path in a cell the footprint covers, once the cell has history
+    if (bounceIndex >= PT_RADIANCE_CACHE_BOUNCE && !evicted && !claimed)
+    {
+        float cellSize = CalculateCascadeCellSize(cascadeIndex, GetCascadeCellRadius());
+        if (path.footprint > cellSize && GetRadianceCachingVisualizationBuffer()[slot].HistoryFrames >= PT_RADIANCE_CACHE_MIN_HISTORY)
+        {
+            cachedRadiance = LoadCachedRadiance(slot);
+            return true;
+        }
+    }
+
+    // Record the vertex for the update at the end of the path
+    if (path.numVertices < PT_RADIANCE_CACHE_MAX_VERTICES)
+    {
+        path.vertices[path.numVertices].slot = slot;
+        path.vertices[path.numVertices].colorBefore = color;
+        path.vertices[path.numVertices].throughput = throughput;
+        path.numVertices++;
+    }
+    return false;
+}
+
+/**
+ * Blend the radiance the path gathered from each recorded vertex on into the vertex's cell.
+ */
+void PTRadianceCacheEnd(PTRadianceCachePath path, float3 color)
+{
+    for (uint vertexIndex = 0; vertexIndex < path.numVertices; vertexIndex++)
+    {
+        PTRadianceCacheVertex v = path.vertices[vertexIndex];
+        float3 radiance = (color - v.colorBefore) / max(v.throughput, 1e-4f);
+
+        uint history = GetRadianceCachingVisualizationBuffer()[v.slot].HistoryFrames + 1;
+        float blend = 1.f / (float)min(history, PT_RADIANCE_CACHE_MAX_HISTORY);
+        StoreCachedRadiance(v.slot, lerp(LoadCachedRadiance(v.slot), radiance, blend));
+        GetRadianceCachingVisualizationBuffer()[v.slot].HistoryFrames = min(history, PT_RADIANCE_CACHE_MAX_HISTORY);
+    }
+}
+
+#endif // PATH_TRACE_RADIANCE_CACHE_HLSL
@@ -0,0 +1,39 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#ifndef PROBE_RAY_HIT_MAP_HLSL
+#define PROBE_RAY_HIT_MAP_HLSL
+
+// ============================================================================
+// Probe Ray Hit Map
+// ============================================================================
+// ProbeTraceCS stores one entry per traced probe ray:
+//   .x = radiance cache slot (HashID) of a front face hit, or PROBE_RAY_HIT_MAP_INVALID
+//   .y = asuint(HitDistance)
+// Rays without a cache slot (misses, backfaces, fixed rays, and hits that found
+// no free slot) are stored straight to RayData by ProbeTraceCS.
+//
+// The cached hits are resolved either by ProbeRayResolveCS (scattered to RayData),
+// or by the fused probe blending (ProbeBlendingRadianceCacheCS), which reads them
+// here while it loads the probe's rays.
+//
+// Entry index: hitMapOffset + ProbeIndex * probeNumRays + RayIndex, where
+// hitMapOffset is the volume's first entry with PROBE_TRACE_BATCHED (else 0).
+
+// Sentinel value indicating no cache lookup needed (miss/backface/fixed ray)
+#define PROBE_RAY_HIT_MAP_INVALID 0xFFFFFFFF
+
+// Radiance of a cached probe ray hit, in the range stored to RayData
+float3 LoadProbeRayCachedRadiance(uint HashID)
+{
+    return saturate(LoadCachedRadiance(HashID));
+}
+
+#endif // PROBE_RAY_HIT_MAP_HLSL
@@ -0,0 +1,66 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#ifndef PROBE_TRACE_BATCH_HLSL
+#define PROBE_TRACE_BATCH_HLSL
+
+// ============================================================================
+// Batched Probe Tracing
+// ============================================================================
+// With PROBE_TRACE_BATCHED, ProbeTraceCS and ProbeRayResolveCS cover every
+// DDGIVolume updated this frame in a single dispatch:
+//   (MaxRayGroupsPerProbe, TotalProbes, 1)
+// GroupID.y indexes the probes of all batched volumes back to back. The batch
+// table (written by DDGI_D3D12.cpp each frame) holds the prefix sums that map a
+// row back to its volume:
+//   [0]:     x = number of batched volumes, y = total probes
+//   [1 + n]: x = DDGIVolume index, y = first row of the volume,
+//            z = first ProbeRayHitMap entry of the volume, w = unused
+// Must match DDGI_D3D12.cpp::UploadProbeTraceBatch().
+
+#ifndef PROBE_TRACE_BATCHED
+#define PROBE_TRACE_BATCHED 0
+#endif
+
+struct ProbeTraceBatchEntry
+{
+    uint volumeIndex;    // Index of the volume's constants and resource indices
+    uint probeIndex;     // Probe of the volume (before probe scheduling remaps it)
+    uint hitMapOffset;   // First ProbeRayHitMap entry of the volume
+};
+
+#if PROBE_TRACE_BATCHED
+/**
+ * Find the batched volume that owns a dispatch row (binary search over the row prefix sums).
+ */
+ProbeTraceBatchEntry GetProbeTraceBatchEntry(uint row)
+{
+    RWStructuredBuffer<uint4> Batch = GetProbeTraceBatch();
+
+    uint first = 0;
+    uint last = Batch[0].x - 1;
+    while (first < last)
+    {
+        uint middle = (first + last + 1) / 2;
+        if (Batch[1 + middle].y <= row) first = middle;
+        else last = middle - 1;
+    }
+
+    uint4 volumeEntry = Batch[1 + first];
+
+    ProbeTraceBatchEntry entry;
+    entry.volumeIndex = volumeEntry.x;
+    entry.probeIndex = row - volumeEntry.y;
+    entry.hitMapOffset = volumeEntry.z;
+    return entry;
+}
+#endif
+
+#endif // PROBE_TRACE_BATCH_HLSL
@@ -0,0 +1,87 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#ifndef RTAO_TEMPORAL_HLSL
+#define RTAO_TEMPORAL_HLSL
+
+// ============================================================================
+// RTAO Temporal Accumulation
+// ============================================================================
+// With temporal accumulation, RTAOTraceRGS traces one ray for half of the pixels
+// each frame (a checkerboard that alternates every frame) and RTAOTemporalCS
+// blends the result with the reprojected history:
+//   RTAORaw:         occlusion of the pixels traced this frame
+//   RTAO History[2]: x = accumulated occlusion, y = history length (frames),
+//                    z = distance to the camera, w = unused (ping-pong)
+// Flags: RTAO_TEMPORAL_FLAGS in Types.h, set by RTAO_D3D12.cpp::Update().
+
+// Relative camera distance change past which the reprojected history is rejected
+#define RTAO_TEMPORAL_DISTANCE_THRESHOLD 0.02f
+
+bool RTAOTemporalEnabled() { return (GetGlobalConst(rtao, temporalFlags) & RTAO_TEMPORAL_FLAG_ENABLED); }
+bool RTAOTemporalHistoryValid() { return (GetGlobalConst(rtao, temporalFlags) & RTAO_TEMPORAL_FLAG_HISTORY_VALID); }
+uint RTAOTemporalCheckerboardParity() { return (GetGlobalConst(rtao, temporalFlags) & RTAO_TEMPORAL_FLAG_CHECKERBOARD_ODD) ? 1 : 0; }
+uint RTAOTemporalHistoryIndex() { return (GetGlobalConst(rtao, temporalFlags) & RTAO_TEMPORAL_FLAG_HISTORY_INDEX) ? 1 : 0; }
+
+/**
+ * Whether the pixel is traced this frame.
+ */
+bool RTAOTemporalIsTracedPixel(int2 pixel)
+{
+    if (!RTAOTemporalEnabled()) return true;
+    return (((pixel.x + pixel.y + RTAOTemporalCheckerboardParity()) & 1) == 0);
+}
+
+/**
+ * Maps a (half width) checkerboard launch index to the pixel traced this frame.
+ */
+int2 RTAOTemporalGetTracedPixel(int2 launchIndex)
+{
+    if (!RTAOTemporalEnabled()) return launchIndex;
+    return int2((launchIndex.x * 2) + ((launchIndex.y + RTAOTemporalCheckerboardParity()) & 1), launchIndex.y);
+}
+
+/**
+ * Offsets the (tiled) blue noise lookup every frame, so accumulated frames use different ray directions.
+ */
+int2 RTAOTemporalGetNoiseOffset()
+{
+    if (!RTAOTemporalEnabled()) return int2(0, 0);
+
+    // R2 low discrepancy sequence over the 256x256 blue noise texture
+    uint frame = GetGlobalConst(app, frameNumber);
+    return int2(frac(float2(0.7548776662f, 0.5698402910f) * frame) * 256.f);
+}
+
+/**
+ * Projects a world position with the previous frame's camera.
+ * Returns false when the position is behind the camera or off screen.
+ */
+bool RTAOTemporalReproject(float3 worldPos, out int2 pixel)
+{
+    Camera camera = GetCamera();
+    pixel = int2(0, 0);
+
+    float3 v = worldPos - camera.prevPosition;
+    float  z = dot(v, camera.prevForward);
+    if (z <= 0.f) return false;
+
+    float2 ndc;
+    ndc.x = dot(v, camera.prevRight) / (z * camera.prevAspect * camera.prevTanHalfFovY);
+    ndc.y = dot(v, camera.prevUp) / (z * camera.prevTanHalfFovY);
+
+    // Inverse of the primary ray setup (see GBufferRGS.hlsl), at the previous frame's (dynamic) resolution
+    float2 screenPos = float2((ndc.x + 1.f) * 0.5f, (1.f - ndc.y) * 0.5f) * camera.prevResolution;
+    pixel = int2(floor(screenPos));
+
+    return (all(pixel >= 0) && all(pixel < int2(camera.prevResolution)));
+}
+
+#endif // RTAO_TEMPORAL_HLSL
@@ -0,0 +1,127 @@
+#ifndef RADIANCE_CACHE_BUDGET_HLSL
+#define RADIANCE_CACHE_BUDGET_HLSL
+
+#include "RadianceCacheWorkList.hlsl"
+
+// ============================================================================
+// Radiance Cache Update Budget
+// ============================================================================
+// Caps the inline rays RadianceCacheCS traces per frame, so the GI cost stays
+// fixed no matter how many cells are live. Every listed slot gets a priority
+// from the metadata the cache already keeps:
+//   priority = frames since the slot was last shaded
+//            + VOLATILITY_WEIGHT * (smoothed relative luminance change)
+// RadianceCacheBudgetCS histograms the priorities of this frame's work list and
+// finds the lowest priority bucket that still fits in the budget. RadianceCacheCS
+// shades every slot above that bucket, and the first slots of that bucket up to the
+// remaining quota. Skipped slots keep their cached radiance and age into a higher
+// priority next frame.
+
+#ifndef RADIANCE_CACHE_SAMPLE_COUNT
+#define RADIANCE_CACHE_SAMPLE_COUNT 8
+#endif
+
+// RAY_BUDGET: Maximum inline rays traced by RadianceCacheCS per frame
+// - Each shaded slot costs RADIANCE_CACHE_SAMPLE_COUNT rays
+// - 0 = unlimited (every listed slot is shaded every frame)
+#ifndef RADIANCE_CACHE_RAY_BUDGET
+#define RADIANCE_CACHE_RAY_BUDGET 0
+#endif
+
+// The budget ranks the work list, which is only built with open addressing
+#if !RADIANCE_CACHE_USE_OPEN_ADDRESSING
+#undef RADIANCE_CACHE_RAY_BUDGET
+#define RADIANCE_CACHE_RAY_BUDGET 0
+#endif
+
+// PRIORITY_BUCKETS: Number of priority histogram buckets (one frame of age per bucket)
+// - Slots older than PRIORITY_BUCKETS - 1 frames share the top bucket
+// - Defined in Types.h (included with Descriptors.hlsl), which also sizes the budget buffer (RADIANCE_CACHE_BUDGET_ELEMENTS)
+
+// VOLATILITY_WEIGHT: Frames of age that a 100% luminance change is worth
+// - Higher = volatile cells are refreshed sooner relative to stale, stable cells
+#ifndef RADIANCE_CACHE_BUDGET_VOLATILITY_WEIGHT
+#define RADIANCE_CACHE_BUDGET_VOLATILITY_WEIGHT 16.0f
+#endif
+
+// VOLATILITY_BLEND: Exponential blend factor of the luminance change history
+#ifndef RADIANCE_CACHE_BUDGET_VOLATILITY_BLEND
+#define RADIANCE_CACHE_BUDGET_VOLATILITY_BLEND 0.25f
+#endif
+
+// Metadata fields used by the scheduler (see RADIANCE_CACHE_METADATA_STRIDE)
+// - The shaded frame is stored plus one, 0 marks a slot that was never shaded (cleared, new, or reclaimed)
+#define RADIANCE_CACHE_METADATA_SHADED_FRAME_OFFSET 8
+#define RADIANCE_CACHE_METADATA_VOLATILITY_OFFSET 12
+
+// Budget buffer layout (RWByteAddressBuffer):
+//   0: PRIORITY_BUCKETS bucket counts
+//   PRIORITY_BUCKETS * 4 + 0: Threshold bucket
+//   PRIORITY_BUCKETS * 4 + 4: Remaining quota of the threshold bucket
+#define RADIANCE_CACHE_BUDGET_THRESHOLD_OFFSET (RADIANCE_CACHE_BUDGET_PRIORITY_BUCKETS * 4)
+#define RADIANCE_CACHE_BUDGET_QUOTA_OFFSET (RADIANCE_CACHE_BUDGET_THRESHOLD_OFFSET + 4)
+
+// Number of slots RadianceCacheCS may shade this frame
+uint RadianceCacheBudgetSlotCount()
+{
+    return max(1u, (uint)(RADIANCE_CACHE_RAY_BUDGET / max(RADIANCE_CACHE_SAMPLE_COUNT, 1.f)));
+}
+
+// Stored shaded frame of the current frame: frame + 1, and never 0 (the never shaded marker) when the frame counter wraps
+uint RadianceCacheBudgetShadedFrame(uint CurrentFrame)
+{
+    return max(CurrentFrame + 1, 1u);
+}
+
+// Priority bucket of a listed slot. Only RadianceCacheCS updates the fields it reads,
+// so RadianceCacheBudgetCS and RadianceCacheCS agree on it within a frame.
+uint RadianceCacheBudgetPriority(uint Slot, uint CurrentFrame)
+{
+    RWByteAddressBuffer Metadata = GetRadianceCacheMetadataBuffer();
+    uint MetaOffset = Slot * RADIANCE_CACHE_METADATA_STRIDE;
+    uint ShadedFrame = Metadata.Load(MetaOffset + RADIANCE_CACHE_METADATA_SHADED_FRAME_OFFSET);
+    float Volatility = asfloat(Metadata.Load(MetaOffset + RADIANCE_CACHE_METADATA_VOLATILITY_OFFSET));
+
+    // Never shaded (new or reclaimed slot) goes first
+    if (ShadedFrame == 0) return RADIANCE_CACHE_BUDGET_PRIORITY_BUCKETS - 1;
+
+    uint Age = RadianceCacheBudgetShadedFrame(CurrentFrame) - ShadedFrame;
+    uint Priority = Age + (uint)(Volatility * RADIANCE_CACHE_BUDGET_VOLATILITY_WEIGHT);
+    return min(Priority, RADIANCE_CACHE_BUDGET_PRIORITY_BUCKETS - 1);
+}
+
+/**
+ * Decide whether RadianceCacheCS shades a slot this frame. Slots above the threshold
+ * bucket are always shaded; slots in the threshold bucket take a ticket from its quota.
+ */
+bool RadianceCacheBudgetAdmit(uint Slot, uint CurrentFrame)
+{
+    RWByteAddressBuffer Budget = GetRadianceCacheBudgetBuffer();
+    uint Priority = RadianceCacheBudgetPriority(Slot, CurrentFrame);
+    uint Threshold = Budget.Load(RADIANCE_CACHE_BUDGET_THRESHOLD_OFFSET);
+
+    if (Priority > Threshold) return true;
+    if (Priority < Threshold) return false;
+
+    uint PreviousQuota;
+    Budget.InterlockedAdd(RADIANCE_CACHE_BUDGET_QUOTA_OFFSET, 0xFFFFFFFF, PreviousQuota);
+    return asint(PreviousQuota) > 0;
+}
+
+// Record that a slot was shaded this frame and fold its luminance change into the history
+void RadianceCacheBudgetRecordUpdate(uint Slot, uint CurrentFrame, float3 PreviousRadiance, float3 NewRadiance)
+{
+    RWByteAddressBuffer Metadata = GetRadianceCacheMetadataBuffer();
+    uint MetaOffset = Slot * RADIANCE_CACHE_METADATA_STRIDE;
+
+    float PreviousLuminance = dot(PreviousRadiance, float3(0.299f, 0.587f, 0.114f));
+    float NewLuminance = dot(NewRadiance, float3(0.299f, 0.587f, 0.114f));
+    float Change = saturate(abs(NewLuminance - PreviousLuminance) / max(PreviousLuminance, 0.0001f));
+
+    float Volatility = asfloat(Metadata.Load(MetaOffset + RADIANCE_CACHE_METADATA_VOLATILITY_OFFSET));
+    Volatility = lerp(Volatility, Change, RADIANCE_CACHE_BUDGET_VOLATILITY_BLEND);
+
+    Metadata.Store2(MetaOffset + RADIANCE_CACHE_METADATA_SHADED_FRAME_OFFSET, uint2(RadianceCacheBudgetShadedFrame(CurrentFrame), asuint(Volatility)));
+}
+
+#endif // RADIANCE_CACHE_BUDGET_HLSL
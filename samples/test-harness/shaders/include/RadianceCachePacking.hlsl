@@ -0,0 +1,111 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#ifndef RADIANCE_CACHE_PACKING_HLSL
+#define RADIANCE_CACHE_PACKING_HLSL
+
+// ============================================================================
+// Radiance Cache Storage Formats
+// ============================================================================
+// RADIANCE_CACHE_RADIANCE_FORMAT selects how RadianceCaching stores the resolved radiance:
+// - 0 = float3 (12 bytes per slot)
+// - 1 = R11G11B10 float (4 bytes per slot, 6/6/5 bit mantissas, no sign)
+// - 2 = RGB9E5 shared exponent (4 bytes per slot, 9 bit mantissas, max 65408)
+// Must match DDGI_D3D12.cpp, which sizes the buffer and sets the UAV stride from it.
+#define RADIANCE_CACHE_RADIANCE_FORMAT_FLOAT3 0
+#define RADIANCE_CACHE_RADIANCE_FORMAT_R11G11B10 1
+#define RADIANCE_CACHE_RADIANCE_FORMAT_RGB9E5 2
+
+#ifndef RADIANCE_CACHE_RADIANCE_FORMAT
+#define RADIANCE_CACHE_RADIANCE_FORMAT RADIANCE_CACHE_RADIANCE_FORMAT_RGB9E5
+#endif
+
+#if RADIANCE_CACHE_RADIANCE_FORMAT == RADIANCE_CACHE_RADIANCE_FORMAT_FLOAT3
+#define RadianceCacheStorage float3
+#else
+#define RadianceCacheStorage uint
+#endif
+
+#define RADIANCE_CACHE_R11G11B10_MAX 65024.f
+#define RADIANCE_CACHE_RGB9E5_MAX 65408.f
+
+/**
+ * Pack a non-negative color into R11G11B10 float, rounding to nearest.
+ */
+uint PackR11G11B10(float3 color)
+{
+    uint3 half3 = f32tof16(clamp(color, 0.f, RADIANCE_CACHE_R11G11B10_MAX));
+    uint packed = ((half3.r + 0x8) >> 4) & 0x7FF;
+    packed |= (((half3.g + 0x8) >> 4) & 0x7FF) << 11;
+    packed |= (((half3.b + 0x10) >> 5) & 0x3FF) << 22;
+    return packed;
+}
+
+/**
+ * Complement of PackR11G11B10().
+ */
+float3 UnpackR11G11B10(uint packed)
+{
+    return f16tof32(uint3((packed << 4) & 0x7FF0, (packed >> 7) & 0x7FF0, (packed >> 17) & 0x7FE0));
+}
+
+/**
+ * Pack a non-negative color into RGB9E5 (shared exponent), rounding to nearest.
+ */
+uint PackRGB9E5(float3 color)
+{
+    color = clamp(color, 0.f, RADIANCE_CACHE_RGB9E5_MAX);
+    float maxChannel = max(color.r, max(color.g, color.b));
+
+    // Exponent bias is 15, mantissas have 9 bits
+    int exponent = (int)max(-16.f, floor(log2(maxChannel))) + 16;
+    float scale = exp2((float)(exponent - 24));
+    if (floor(maxChannel / scale + 0.5f) >= 512.f)
+    {
+        scale *= 2.f;
+        exponent++;
+    }
+
+    uint3 mantissa = (uint3)floor(color / scale + 0.5f);
+    return mantissa.r | (mantissa.g << 9) | (mantissa.b << 18) | ((uint)exponent << 27);
+}
+
+/**
+ * Complement of PackRGB9E5().
+ */
+float3 UnpackRGB9E5(uint packed)
+{
+    float scale = exp2((float)((int)(packed >> 27) - 24));
+    return float3(uint3(packed, packed >> 9, packed >> 18) & 0x1FF) * scale;
+}
+
+RadianceCacheStorage PackCachedRadiance(float3 radiance)
+{
+#if RADIANCE_CACHE_RADIANCE_FORMAT == RADIANCE_CACHE_RADIANCE_FORMAT_R11G11B10
+    return PackR11G11B10(radiance);
+#elif RADIANCE_CACHE_RADIANCE_FORMAT == RADIANCE_CACHE_RADIANCE_FORMAT_RGB9E5
+    return PackRGB9E5(radiance);
+#else
+    return radiance;
+#endif
+}
+
+float3 UnpackCachedRadiance(RadianceCacheStorage packed)
+{
+#if RADIANCE_CACHE_RADIANCE_FORMAT == RADIANCE_CACHE_RADIANCE_FORMAT_R11G11B10
+    return UnpackR11G11B10(packed);
+#elif RADIANCE_CACHE_RADIANCE_FORMAT == RADIANCE_CACHE_RADIANCE_FORMAT_RGB9E5
+    return UnpackRGB9E5(packed);
+#else
+    return packed;
+#endif
+}
+
+#endif // RADIANCE_CACHE_PACKING_HLSL
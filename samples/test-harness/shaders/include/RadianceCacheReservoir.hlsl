@@ -0,0 +1,76 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#ifndef RADIANCE_CACHE_RESERVOIR_HLSL
+#define RADIANCE_CACHE_RESERVOIR_HLSL
+
+#include "../../../../rtxgi-sdk/shaders/ddgi/include/ProbeOctahedral.hlsl"
+
+// ============================================================================
+// Radiance Cache Indirect Sample Reservoirs
+// ============================================================================
+// One weighted reservoir per cache slot holds the secondary ray direction that
+// RadianceCacheCS resamples over time (temporal resampled importance sampling):
+//   1. Trace one new cosine distributed direction per cell per frame
+//   2. Re-evaluate the reservoir's direction by reading the cache at its stored
+//      hit point (no ray), the target function is the luminance of the incoming
+//      radiance times the cosine term
+//   3. Keep one of the two in proportion to its resampling weight
+// Bright directions survive across frames, so the cell converges toward them
+// with a single ray per frame. The reservoir is emptied when ProbeTraceCS claims
+// the slot for a new cell, and moves with the cell during compaction.
+
+// MAX_HISTORY: Cap on the sample count carried over from the previous frames
+// - Higher = lower variance for static lighting
+// - Lower = faster reaction when the cached radiance changes
+#ifndef RADIANCE_CACHE_RESERVOIR_MAX_HISTORY
+#define RADIANCE_CACHE_RESERVOIR_MAX_HISTORY 20
+#endif
+
+// Reservoir buffer layout (RWByteAddressBuffer), RADIANCE_CACHE_RESERVOIR_STRIDE bytes per slot:
+//   0:  uint  sample direction (octahedral coordinates, 2x f16)
+//   4:  float sample hit distance (0: the ray missed, the sample sees the sky)
+//   8:  float unbiased contribution weight
+//   12: uint  sample count (0: empty reservoir)
+#define RADIANCE_CACHE_RESERVOIR_STRIDE 16
+
+struct RadianceCacheReservoir
+{
+    float3 Direction;
+    float  HitT;
+    float  Weight;
+    uint   SampleCount;
+};
+
+RadianceCacheReservoir RadianceCacheReservoirLoad(RWByteAddressBuffer reservoirs, uint slot)
+{
+    uint4 data = reservoirs.Load4(slot * RADIANCE_CACHE_RESERVOIR_STRIDE);
+
+    RadianceCacheReservoir reservoir;
+    reservoir.Direction = DDGIGetOctahedralDirection(float2(f16tof32(data.x), f16tof32(data.x >> 16)));
+    reservoir.HitT = asfloat(data.y);
+    reservoir.Weight = asfloat(data.z);
+    reservoir.SampleCount = data.w;
+    return reservoir;
+}
+
+void RadianceCacheReservoirStore(RWByteAddressBuffer reservoirs, uint slot, RadianceCacheReservoir reservoir)
+{
+    float2 coords = DDGIGetOctahedralCoordinates(reservoir.Direction);
+    uint direction = f32tof16(coords.x) | (f32tof16(coords.y) << 16);
+    reservoirs.Store4(slot * RADIANCE_CACHE_RESERVOIR_STRIDE, uint4(direction, asuint(reservoir.HitT), asuint(reservoir.Weight), reservoir.SampleCount));
+}
+
+void RadianceCacheReservoirClear(RWByteAddressBuffer reservoirs, uint slot)
+{
+    reservoirs.Store4(slot * RADIANCE_CACHE_RESERVOIR_STRIDE, uint4(0, 0, 0, 0));
+}
+
+#endif // RADIANCE_CACHE_RESERVOIR_HLSL
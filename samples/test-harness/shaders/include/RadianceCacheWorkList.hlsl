@@ -0,0 +1,86 @@
+#ifndef RADIANCE_CACHE_WORK_LIST_HLSL
+#define RADIANCE_CACHE_WORK_LIST_HLSL
+
+#include "SpatialHash.hlsl"
+
+// ============================================================================
+// Radiance Cache Work List
+// ============================================================================
+// ProbeTraceCS appends each cache slot the first time it is touched in a frame.
+// RadianceCacheWorkListArgsCS turns the append count into indirect dispatch
+// arguments, and RadianceCacheCS runs one thread per listed slot instead of one
+// thread per cell of the whole hash table.
+//
+// With RADIANCE_CACHE_SORT_WORK_LIST, RadianceCacheSortCS reorders the list into
+// the sorted work list first (histogram, prefix sum, scatter).
+//
+// Arguments buffer layout (RWByteAddressBuffer, 16 bytes):
+//   0: ThreadGroupCountX, ThreadGroupCountY, ThreadGroupCountZ (D3D12_DISPATCH_ARGUMENTS)
+//  12: Number of slots appended this frame
+//
+// The work list holds CellNum * CascadeNum entries plus one thread group of padding.
+// The arguments pass fills the tail of the last group with RADIANCE_CACHE_INVALID_SLOT,
+// so RadianceCacheCS needs no count (the arguments buffer is in the indirect argument
+// state while it runs).
+#define RADIANCE_CACHE_WORK_LIST_ARGS_DISPATCH_OFFSET 0
+#define RADIANCE_CACHE_WORK_LIST_ARGS_COUNT_OFFSET 12
+#define RADIANCE_CACHE_WORK_LIST_GROUP_SIZE 64
+
+// SORT_WORK_LIST: Reorder the work list by (InstanceIndex, GeometryIndex) before shading
+// - 1 = counting sort into SORT_BIN_COUNT bins, so neighbouring lanes fetch the same
+//       vertex, material, and texture data in RadianceCacheCS
+// - 0 = shade in append order (effectively random across instances and materials)
+#ifndef RADIANCE_CACHE_SORT_WORK_LIST
+#define RADIANCE_CACHE_SORT_WORK_LIST 1
+#endif
+
+// The work list is only built with open addressing, legacy indexing shades the whole table in order
+#if !RADIANCE_CACHE_USE_OPEN_ADDRESSING
+#undef RADIANCE_CACHE_SORT_WORK_LIST
+#define RADIANCE_CACHE_SORT_WORK_LIST 0
+#endif
+
+// SORT_BIN_COUNT: Number of counting sort bins, must be a multiple of SORT_SCAN_GROUP_SIZE
+#ifndef RADIANCE_CACHE_SORT_BIN_COUNT
+#define RADIANCE_CACHE_SORT_BIN_COUNT 4096
+#endif
+
+#define RADIANCE_CACHE_SORT_SCAN_GROUP_SIZE 1024
+
+// Append a cache slot to this frame's work list
+void RadianceCacheWorkListAppend(uint Slot)
+{
+    uint Index;
+    GetRadianceCacheWorkListArgs().InterlockedAdd(RADIANCE_CACHE_WORK_LIST_ARGS_COUNT_OFFSET, 1, Index);
+    GetRadianceCacheWorkList()[Index] = Slot;
+}
+
+/**
+ * Sort bin of a cached hit. The key is (InstanceIndex, GeometryIndex), read straight from
+ * the packed hit. Keys are hashed so the bins stay balanced; hits that share a key always
+ * land in the same bin, so each bin of the sorted list covers one or a few materials.
+ */
+uint RadianceCacheSortBin(HitPackedData Hit)
+{
+#if HIT_CACHE_COMPACT
+    uint InstanceIndex = Hit.InstancePacked & 0xFFF;
+    uint GeometryIndex = (Hit.PrimitivePacked >> 22) & 0x3FF;
+#else
+    uint InstanceIndex = Hit.PrimitivePacked & 0xFFF;
+    uint GeometryIndex = (Hit.PrimitivePacked >> 22) & 0x3FF;
+#endif
+    uint Key = (InstanceIndex << 10) | GeometryIndex;
+    return WangHash(Key) % RADIANCE_CACHE_SORT_BIN_COUNT;
+}
+
+// Work list RadianceCacheCS shades
+RWStructuredBuffer<uint> GetRadianceCacheShadingWorkList()
+{
+#if RADIANCE_CACHE_SORT_WORK_LIST
+    return GetRadianceCacheSortedWorkList();
+#else
+    return GetRadianceCacheWorkList();
+#endif
+}
+
+#endif // RADIANCE_CACHE_WORK_LIST_HLSL
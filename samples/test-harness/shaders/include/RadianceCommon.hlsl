@@ -1,60 +1,732 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
 #ifndef RADIANCE_COMMON_HLSL
 #define RADIANCE_COMMON_HLSL
 
+// ============================================================================
+// Radiance Cache Shading
+// ============================================================================
+// Shared by the two radiance cache shading backends, which only differ in how
+// they trace the secondary rays and how they are dispatched:
+//   - RadianceCacheCS.hlsl:  compute shader, inline ray tracing (RayQuery),
+//                            indirect dispatch over the work list
+//   - RadianceCacheRGS.hlsl: ray generation shader, TraceRay, one thread per
+//                            cache slot
+// Each shades a work list entry with ShadeRadianceCacheWorkItem(), and defines
+//   float TraceIndirectSample(float3 Origin, float3 Direction, RaytracingAccelerationStructure BVH)
+// (the hit distance, or 0 when the ray missed) before it includes this file.
+// The direct lighting shadow rays are traced inline by both (see InlineLighting.hlsl).
+
+#ifndef RADIANCE_CACHE_SAMPLE_COUNT
+#define RADIANCE_CACHE_SAMPLE_COUNT 8
+#endif
+
+// ============================================================================
+// Temporal Stability Parameters (idTech8/SHaRC-inspired)
+// ============================================================================
+// The approach: linear accumulation for first N samples, then exponential blend
+// This provides fast convergence initially, then temporal stability
+//
+// MAX_ACCUMULATED_SAMPLES: After this many samples, switch to exponential blend
+// - Higher = more stable but slower to react to lighting changes
+// - Lower = faster reaction but more noise
+// - idTech8/Bevy Solari uses 32 samples
+#ifndef RADIANCE_CACHE_MAX_ACCUMULATED_SAMPLES
+#define RADIANCE_CACHE_MAX_ACCUMULATED_SAMPLES 32.0f
+#endif
+
+// CHANGE_THRESHOLD: Relative luminance change that triggers "reset"
+// - When lighting changes significantly, reset to linear accumulation
+// - 1.0 = 100% change considered significant (more stable)
+#ifndef RADIANCE_CACHE_CHANGE_THRESHOLD
+#define RADIANCE_CACHE_CHANGE_THRESHOLD 1.0f
+#endif
+
+// FIXED_BLEND_MODE: Use fixed blend factor instead of adaptive
+// - 1 = use fixed blend of 1/MAX_ACCUMULATED_SAMPLES (most stable)
+// - 0 = use adaptive blend based on luminance change
+#ifndef RADIANCE_CACHE_FIXED_BLEND_MODE
+#define RADIANCE_CACHE_FIXED_BLEND_MODE 1
+#endif
+
+// UPDATE_JITTER: Temporal spreading to reduce race conditions
+// - Each cell only updates when (HashID + frameNumber) % UPDATE_JITTER == 0
+// - Reduces chance of multiple threads writing same cell in same frame
+// - Higher value = more stable but slower convergence
+// - 1 = no jittering (all cells update every frame)
+#ifndef RADIANCE_CACHE_UPDATE_JITTER
+#define RADIANCE_CACHE_UPDATE_JITTER 4
+#endif
+
+// USE_ATOMIC_ACCUMULATION: Use SHaRC-style atomic operations
+// - 1 = use InterlockedAdd for thread-safe accumulation (recommended)
+// - 0 = use temporal jittering (simpler fallback)
+#ifndef RADIANCE_CACHE_USE_ATOMIC_ACCUMULATION
+#define RADIANCE_CACHE_USE_ATOMIC_ACCUMULATION 1
+#endif
+
+// RADIANCE_SCALE: Scale factor for converting float radiance to integer for atomics
+// Higher = more precision, but risk of overflow
+// SHaRC uses different scales, we use 1024 as a safe default
+#ifndef RADIANCE_CACHE_RADIANCE_SCALE
+#define RADIANCE_CACHE_RADIANCE_SCALE 1024.0f
+#endif
+
+// INDIRECT_FROM_PROBES: Where the indirect lighting of a cache cell comes from
+// - 1 = the probe irradiance of the DDGIVolumes covering the cell (one lookup per volume,
+//       no rays). Multiple bounces come from the probes' feedback through the cache.
+//       RADIANCE_CACHE_SAMPLE_COUNT secondary rays are traced only where no volume covers the cell.
+// - 0 = always trace RADIANCE_CACHE_SAMPLE_COUNT secondary rays and read the cache at their hits
+#ifndef RADIANCE_CACHE_INDIRECT_FROM_PROBES
+#define RADIANCE_CACHE_INDIRECT_FROM_PROBES 0
+#endif
+
+// RESERVOIR: How the secondary rays are sampled
+// - 1 = one cosine distributed ray per cell per frame, resampled against the cell's
+//       reservoir of past directions (see RadianceCacheReservoir.hlsl)
+// - 0 = RADIANCE_CACHE_SAMPLE_COUNT rays in fixed directions per cell
+#ifndef RADIANCE_CACHE_RESERVOIR
+#define RADIANCE_CACHE_RESERVOIR 0
+#endif
+
+// LIGHT_VISIBILITY_REFRESH_FRAMES: Frames a cell reuses the shadow ray results of its lights
+// (LIGHT_VISIBILITY_CACHE, see InlineLighting.hlsl) before it traces every light again.
+// A light that moves (or any scene instance that moves) invalidates its bit sooner.
+#ifndef RADIANCE_CACHE_LIGHT_VISIBILITY_REFRESH_FRAMES
+#define RADIANCE_CACHE_LIGHT_VISIBILITY_REFRESH_FRAMES 64
+#endif
+
+// ============================================================================
+// Collision Detection Parameters (idTech8/SHaRC-style)
+// ============================================================================
+// USE_COLLISION_DETECTION: Enable checksum-based collision detection
+// - 1 = detect and handle hash collisions using checksums (recommended)
+// - 0 = disable collision detection (faster but may have light bleeding)
+// The checksum is computed from the grid coordinate quantized by ProbeTraceCS and
+// carried in HitPackedData, never from the interpolated vertex position, so both
+// passes agree on the key regardless of FP differences in position reconstruction
+#ifndef RADIANCE_CACHE_USE_COLLISION_DETECTION
+#define RADIANCE_CACHE_USE_COLLISION_DETECTION 1
+#endif
+
+// MAX_ENTRY_AGE: Maximum age (in frames) before an entry can be evicted
+// - Higher = more stable for static scenes
+// - Lower = faster adaptation for dynamic scenes
+// - idTech8 uses 8-16 frames typically
+#ifndef RADIANCE_CACHE_MAX_ENTRY_AGE
+#define RADIANCE_CACHE_MAX_ENTRY_AGE 8
+#endif
+
+// COLLISION_EVICT_THRESHOLD: Age threshold for eviction on collision
+// - If existing entry is older than this, evict it for new entry
+// - Should be <= MAX_ENTRY_AGE
+#ifndef RADIANCE_CACHE_COLLISION_EVICT_THRESHOLD
+#define RADIANCE_CACHE_COLLISION_EVICT_THRESHOLD 4
+#endif
+
 #include "Random.hlsl"
-#include "../include/Descriptors.hlsl"
-#include "../include/RayTracing.hlsl"
-#include "../include/Common.hlsl"
-#include "../include/SpatialHash.hlsl"
+#include "Descriptors.hlsl"
+#include "InlineLighting.hlsl"
+#include "InlineRayTracingCommon.hlsl"
+#include "SpatialHash.hlsl"
+#include "RadianceCacheWorkList.hlsl"
+#include "RadianceCacheBudget.hlsl"
+#include "RadianceCacheReservoir.hlsl"
+#include "GPUCounters.hlsl"
+
+#include "../../../../rtxgi-sdk/shaders/ddgi/include/DDGIRootConstants.hlsl"
 #include "../../../../rtxgi-sdk/shaders/ddgi/Irradiance.hlsl"
 
+// ============================================================================
+// Indirect Radiance Evaluation
+// ============================================================================
+
+/**
+ * Get the radiance arriving along a secondary ray: the sky radiance when it missed (HitT is 0),
+ * otherwise the radiance of the cache cell at its hit point (none when the hit has no cell).
+ */
+float3 GetIndirectSampleRadiance(float3 Origin, float3 Direction, float HitT, out bool bCacheHit)
+{
+    bCacheHit = false;
+    if (HitT <= 0.f) return GetGlobalConst(app, skyRadiance);
+
+    float3 HitPosition = Origin + Direction * HitT;
+    uint HashID = SpatialHashCascadeFind(HitPosition, HitT, GetCascadeCellRadius(), GetMaxCacheCellCount(), GetCascadeCount(), GetCascadeBaseDistance(), GetRadianceCacheMetadataBuffer());
+    if (HashID == RADIANCE_CACHE_INVALID_SLOT) return float3(0.f, 0.f, 0.f);
+
+    bCacheHit = true;
+    return LoadCachedRadiance(HashID);
+}
+
+/**
+ * Evaluate one of the fixed direction secondary rays of a cell for a white surface (irradiance / PI).
+ */
+float3 EvaluateIndirectSample(float3 WorldPosition, float3 WorldNormal, RaytracingAccelerationStructure BVH, uint Idx, out bool bHit, out bool bCacheHit)
+{
+    float3 Origin = WorldPosition + (WorldNormal * GetGlobalConst(pt, rayNormalBias));
+
+    // Fully deterministic seed - no frame number dependency
+    // Each cache cell always samples the exact same directions for stability
+    uint Seed = asuint(WorldPosition.x) ^ asuint(WorldPosition.y) ^ asuint(WorldPosition.z);
+    Seed = WangHash(Seed + Idx * 17);
+    float3 SamplingDirection = normalize(GetRandomDirectionOnHemisphere(WorldNormal, Seed));
+
+    // Sky radiance when the ray missed, the cached radiance at its hit otherwise
+    float HitT = TraceIndirectSample(Origin, SamplingDirection, BVH);
+    float3 InIrradiance = GetIndirectSampleRadiance(Origin, SamplingDirection, HitT, bCacheHit);
+    bHit = (HitT > 0.f);
+
+    float CosN = max(dot(WorldNormal, SamplingDirection), 0.0f);
+    float Pdf = CosN / PI;
+    return (Pdf > 0.0001f) ? (InIrradiance * CosN) / (PI * Pdf) : float3(0.f, 0.f, 0.f);
+}
+
+/**
+ * Evaluate the indirect radiance of SampleCount fixed direction secondary rays.
+ */
 float3 EvaluateIndirectRadiance(float3 Albedo, float3 WorldPosition, float3 WorldNormal, RaytracingAccelerationStructure BVH, uint SampleCount)
 {
     float3 IndirectLight = float3(0.0, 0.0, 0.0);
-    float3 SurfaceBias = WorldNormal + GetGlobalConst(pt, rayNormalBias);
-    for (half Idx = 0; Idx < SampleCount; Idx++)
-    {
-        uint Seed = Idx * 10;
-        float3 SamplingDirection = GetRandomDirectionOnHemisphere(WorldNormal, Seed);
-        RayDesc ray;
-        ray.Origin = WorldPosition + SurfaceBias; // TODO: not using viewBias!
-        ray.Direction = normalize(SamplingDirection);
-        ray.TMin = 0.f;
-        ray.TMax = 1e27f;
-
-        // Trace a visibility ray
-        // Skip the CHS to avoid evaluating materials
-        PackedPayload packedPayload = (PackedPayload)0;
-        TraceRay(
-            BVH,
-            RAY_FLAG_ACCEPT_FIRST_HIT_AND_END_SEARCH,
-            0xFF,
-            0,
-            0,
-            0,
-            ray,
-            packedPayload);
-
-        float3 InIrradiance = float3(0.0f, 0.0f, 0.0f);
-        if (packedPayload.hitT < 0.f)
+
+    // Counted per thread, then added to the GPU counters once per wave after the loop
+    uint NumHits = 0;
+    uint NumCacheHits = 0;
+
+    for (uint Idx = 0; Idx < SampleCount; Idx++)
+    {
+        bool bHit, bCacheHit;
+        IndirectLight += Albedo * EvaluateIndirectSample(WorldPosition, WorldNormal, BVH, Idx, bHit, bCacheHit);
+        NumHits += bHit ? 1 : 0;
+        NumCacheHits += bCacheHit ? 1 : 0;
+    }
+
+    GPUCounterAdd(GPU_COUNTER_INDIRECT_RAYS, SampleCount);
+    GPUCounterAdd(GPU_COUNTER_INDIRECT_RAY_HITS, NumHits);
+    GPUCounterAdd(GPU_COUNTER_INDIRECT_RAY_MISSES, SampleCount - NumHits);
+    GPUCounterAdd(GPU_COUNTER_INDIRECT_CACHE_HITS, NumCacheHits);
+    GPUCounterAdd(GPU_COUNTER_INDIRECT_CACHE_MISSES, NumHits - NumCacheHits);
+
+    IndirectLight /= (float)SampleCount;
+    return IndirectLight;
+}
+
+#if RADIANCE_CACHE_RESERVOIR
+// Resampling target function of a secondary ray sample: incoming luminance times the cosine term
+float RadianceCacheReservoirTarget(float3 Radiance, float CosN)
+{
+    return dot(Radiance, float3(0.299f, 0.587f, 0.114f)) * CosN;
+}
+
+/**
+ * Evaluate indirect radiance with one secondary ray, resampled against the slot's reservoir
+ * of the directions kept in previous frames (see RadianceCacheReservoir.hlsl).
+ */
+float3 EvaluateIndirectRadianceReservoir(float3 Albedo, float3 WorldPosition, float3 WorldNormal, RaytracingAccelerationStructure BVH, uint Slot)
+{
+    float3 Origin = WorldPosition + WorldNormal * GetGlobalConst(pt, rayNormalBias);
+
+    // New candidate: a cosine distributed direction, different every frame
+    uint Seed = WangHash(asuint(WorldPosition.x) ^ WangHash(asuint(WorldPosition.y) ^ WangHash(asuint(WorldPosition.z) ^ GetGlobalConst(app, frameNumber))));
+    float3 CandidateDirection = GetRandomCosineDirectionOnHemisphere(WorldNormal, Seed);
+
+    bool bCacheHit;
+    float CandidateHitT = TraceIndirectSample(Origin, CandidateDirection, BVH);
+    float3 CandidateRadiance = GetIndirectSampleRadiance(Origin, CandidateDirection, CandidateHitT, bCacheHit);
+    float CandidateCosN = max(dot(WorldNormal, CandidateDirection), 0.f);
+    float CandidatePdf = CandidateCosN / PI;
+
+    GPUCounterAdd(GPU_COUNTER_INDIRECT_RAYS, 1);
+    GPUCounterIncrement(GPU_COUNTER_INDIRECT_RAY_HITS, CandidateHitT > 0.f);
+    GPUCounterIncrement(GPU_COUNTER_INDIRECT_RAY_MISSES, CandidateHitT <= 0.f);
+    GPUCounterIncrement(GPU_COUNTER_INDIRECT_CACHE_HITS, bCacheHit);
+    GPUCounterIncrement(GPU_COUNTER_INDIRECT_CACHE_MISSES, (CandidateHitT > 0.f) && !bCacheHit);
+
+    // Stream the candidate into the reservoir
+    RadianceCacheReservoir Reservoir;
+    Reservoir.Direction = CandidateDirection;
+    Reservoir.HitT = CandidateHitT;
+    Reservoir.SampleCount = 1;
+
+    float3 SelectedRadiance = CandidateRadiance;
+    float SelectedCosN = CandidateCosN;
+    float SelectedTarget = RadianceCacheReservoirTarget(CandidateRadiance, CandidateCosN);
+    float WeightSum = (CandidatePdf > 0.0001f) ? (SelectedTarget / CandidatePdf) : 0.f;
+
+    // Stream the previous frames' sample, re-evaluated from the cache at its hit point (no ray).
+    // Its sample count is capped, so the history can't outweigh new candidates forever.
+    RWByteAddressBuffer Reservoirs = GetRadianceCacheReservoirBuffer();
+    RadianceCacheReservoir Previous = RadianceCacheReservoirLoad(Reservoirs, Slot);
+    if (Previous.SampleCount > 0)
+    {
+        uint PreviousCount = min(Previous.SampleCount, RADIANCE_CACHE_RESERVOIR_MAX_HISTORY);
+        float3 PreviousRadiance = GetIndirectSampleRadiance(Origin, Previous.Direction, Previous.HitT, bCacheHit);
+        float PreviousCosN = max(dot(WorldNormal, Previous.Direction), 0.f);
+        float PreviousTarget = RadianceCacheReservoirTarget(PreviousRadiance, PreviousCosN);
+        float PreviousWeight = PreviousTarget * Previous.Weight * PreviousCount;
+
+        WeightSum += PreviousWeight;
+        Reservoir.SampleCount += PreviousCount;
+        if ((GetRandomNumber(Seed) * WeightSum) < PreviousWeight)
+        {
+            Reservoir.Direction = Previous.Direction;
+            Reservoir.HitT = Previous.HitT;
+            SelectedRadiance = PreviousRadiance;
+            SelectedCosN = PreviousCosN;
+            SelectedTarget = PreviousTarget;
+        }
+    }
+
+    // Unbiased contribution weight of the selected sample
+    Reservoir.Weight = (SelectedTarget > 0.f) ? (WeightSum / (Reservoir.SampleCount * SelectedTarget)) : 0.f;
+    RadianceCacheReservoirStore(Reservoirs, Slot, Reservoir);
+
+    return (Albedo / PI) * SelectedRadiance * SelectedCosN * Reservoir.Weight;
+}
+#endif
+
+#if RADIANCE_CACHE_INDIRECT_FROM_PROBES
+/**
+ * Evaluate indirect radiance from the probe irradiance of the DDGIVolumes that cover the surface (in blend order).
+ * Returns false when no volume covers the surface.
+ */
+bool EvaluateIndirectRadianceProbes(float3 Albedo, float3 WorldPosition, float3 WorldNormal, out float3 IndirectLight)
+{
+    StructuredBuffer<DDGIVolumeDescGPUPacked> DDGIVolumes = GetDDGIVolumeConstants(GetDDGIVolumeConstantsIndex());
+    StructuredBuffer<DDGIVolumeResourceIndices> DDGIVolumeBindless = GetDDGIVolumeResourceIndices(GetDDGIVolumeResourceIndicesIndex());
+    StructuredBuffer<DDGIVolumeBoundsGPU> DDGIVolumeBounds = GetDDGIVolumeBounds();
+
+    float3 Irradiance = float3(0.f, 0.f, 0.f);
+    float WeightSum = 0.f;
+    for (uint OrderIndex = 0; OrderIndex < RTXGI_DDGI_NUM_VOLUMES && WeightSum < 1.f; OrderIndex++)
+    {
+        // Read the volume's bounds in blend order, only the volumes that cover the point are unpacked
+        uint VolumeIndex = DDGIVolumeBounds[OrderIndex].blendOrder;
+        float BlendWeight = DDGIGetVolumeBlendWeight(WorldPosition, DDGIVolumeBounds[VolumeIndex]);
+        if (BlendWeight <= 0.f) continue;
+
+        DDGIVolumeDescGPU Volume = UnpackDDGIVolumeDescGPU(DDGIVolumes[VolumeIndex]);
+
+        DDGIVolumeResourceIndices ResourceIndices = DDGIVolumeBindless[VolumeIndex];
+        DDGIVolumeResources Resources;
+        Resources.probeIrradiance = GetTex2DArray(ResourceIndices.probeIrradianceSRVIndex);
+        Resources.probeDistance = GetTex2DArray(ResourceIndices.probeDistanceSRVIndex);
+        Resources.probeData = GetTex2DArray(ResourceIndices.probeDataSRVIndex);
+        Resources.bilinearSampler = GetBilinearWrapSampler();
+
+        // The probe ray's direction isn't cached, view the surface along its normal
+        float3 SurfaceBias = DDGIGetSurfaceBias(WorldNormal, -WorldNormal, Volume);
+
+        // Preferred (higher priority, then finer) volumes take precedence, the next volumes fill in the rest of the weight
+        float Weight = min(BlendWeight, 1.f - WeightSum);
+        Irradiance += DDGIGetVolumeIrradiance(WorldPosition, SurfaceBias, WorldNormal, Volume, Resources) * Weight;
+        WeightSum += Weight;
+    }
+
+    IndirectLight = (WeightSum > 0.f) ? (Albedo / PI) * (Irradiance / WeightSum) : float3(0.f, 0.f, 0.f);
+    return (WeightSum > 0.f);
+}
+#endif
+
+// ============================================================================
+// Work List Entry Shading
+// ============================================================================
+
+/**
+ * Load the probe ray hit of a work list entry and fill the payload with its surface.
+ * Returns false when the entry holds no hit, or when the update budget skips its slot this frame.
+ */
+bool LoadRadianceCacheHit(uint WorkIndex, out uint HitIndex, out HitUnpackedData hitData, out Payload payload)
+{
+    hitData = (HitUnpackedData)0;
+    payload = (Payload)0;
+
+#if RADIANCE_CACHE_USE_OPEN_ADDRESSING
+    // Only the slots ProbeTraceCS touched this frame are listed, the tail is padded with INVALID
+    HitIndex = GetRadianceCacheShadingWorkList()[WorkIndex];
+    if (HitIndex == RADIANCE_CACHE_INVALID_SLOT) return false;
+#else
+    HitIndex = WorkIndex;
+#endif
+
+    RWStructuredBuffer<HitPackedData> HitCachingBuffer = GetHitCachingBuffer();
+    HitPackedData packedHitData = HitCachingBuffer[HitIndex];
+
+    // Unpack hit data
+    UnpackData(packedHitData, hitData);
+
+    // Skip inactive entries (check if primitive index is valid)
+    if (hitData.PrimitiveIndex == 0 && hitData.InstanceIndex == 0 && hitData.HitDistance == 0.0f)
+    {
+        return false;
+    }
+
+#if RADIANCE_CACHE_RAY_BUDGET > 0
+    // Over budget: keep the cached radiance, the slot ages into a higher priority next frame
+    if (!RadianceCacheBudgetAdmit(HitIndex, GetGlobalConst(app, frameNumber)))
+    {
+        return false;
+    }
+#endif
+
+    // Load geometry data for the hit
+    GeometryData geometry;
+    GetGeometryData(hitData.InstanceIndex, hitData.GeometryIndex, geometry);
+
+    // Load and interpolate vertex data
+    Vertex vertices[3];
+    LoadVertices(hitData.InstanceIndex, hitData.PrimitiveIndex, geometry, vertices);
+
+    float3 barycentrics = float3(1.f - hitData.Barycentrics.x - hitData.Barycentrics.y, hitData.Barycentrics.x, hitData.Barycentrics.y);
+    Vertex v = InterpolateVertex(vertices, barycentrics);
+
+    // Get instance transform
+    TLASInstance instance = GetTLASInstances()[hitData.InstanceIndex];
+    float3x4 objectToWorld = instance.transform;
+
+    // Create payload from hit data
+    payload.hitT = hitData.HitDistance;
+    payload.worldPosition = mul(objectToWorld, float4(v.position, 1.f)).xyz;
+    payload.normal = normalize(mul(objectToWorld, float4(v.normal, 0.f)).xyz);
+    payload.shadingNormal = payload.normal;
+
+#if GI_MATERIALS
+    int albedoTexIdx = -1;
+#if GI_VERTEX_ALBEDO
+    if (geometry.albedoByteAddress != 0xFFFFFFFF)
+    {
+        // Interpolate the baked vertex albedos, no material or texture is read
+        float4 albedo = LoadAndInterpolateVertexAlbedo(hitData.InstanceIndex, hitData.PrimitiveIndex, geometry, barycentrics);
+        payload.albedo = albedo.rgb;
+        payload.opacity = albedo.a;
+    }
+    else
+#endif
+    {
+        // Load the GI material, the albedo texture is only sampled when the material has no average color of it
+        albedoTexIdx = UnpackGIMaterial(GetGIMaterial(geometry), payload.albedo, payload.opacity);
+    }
+#else
+    // Load material
+    Material material = GetMaterial(geometry);
+    payload.albedo = material.albedo;
+    payload.opacity = material.opacity;
+    int albedoTexIdx = material.albedoTexIdx;
+#endif
+
+    // Sample textures (use fixed LOD for probe rays)
+    if (albedoTexIdx > -1)
+    {
+        uint width, height, numLevels;
+        GetTex2D(albedoTexIdx).GetDimensions(0, width, height, numLevels);
+        float4 bco = GetTex2D(albedoTexIdx).SampleLevel(GetBilinearWrapSampler(), v.uv0, numLevels / 2.f);
+        TextureFeedbackRecordLevel(albedoTexIdx, width, height, numLevels / 2.f);
+        payload.albedo *= bco.rgb;
+        payload.opacity *= bco.a;
+    }
+
+    // Shading normal (GI materials shade with the geometric normal)
+#if !GI_MATERIALS
+    if (material.normalTexIdx > -1)
+    {
+        uint width, height, numLevels;
+        GetTex2D(material.normalTexIdx).GetDimensions(0, width, height, numLevels);
+        float3 tangent = normalize(mul(objectToWorld, float4(v.tangent.xyz, 0.f)).xyz);
+        float3 bitangent = cross(payload.normal, tangent) * v.tangent.w;
+        float3x3 TBN = { tangent, bitangent, payload.normal };
+        payload.shadingNormal = GetTex2D(material.normalTexIdx).SampleLevel(GetBilinearWrapSampler(), v.uv0, numLevels / 2.f).xyz;
+        TextureFeedbackRecordLevel(material.normalTexIdx, width, height, numLevels / 2.f);
+        payload.shadingNormal = (payload.shadingNormal * 2.f) - 1.f;
+        payload.shadingNormal = mul(payload.shadingNormal, TBN);
+    }
+#endif
+
+    return true;
+}
+
+/**
+ * Accumulate the radiance shaded for a hit into its cache slot, and update the slot's
+ * budget, visualization, and gather history.
+ */
+void ResolveRadianceCacheHit(uint HitIndex, HitUnpackedData hitData, float3 Albedo, float3 DirectLight, float3 IndirectIrradiance)
+{
+#if RADIANCE_CACHE_RAY_BUDGET > 0
+    float3 PreviousRadiance = LoadCachedRadiance(HitIndex);
+#endif
+
+    float3 IndirectLight = Albedo * IndirectIrradiance;
+
+    // Compute new radiance for this frame
+    float3 NewRadiance = DirectLight + IndirectLight;
+
+    // ============================================================================
+    // Spatial Hash Indexing with Checksum (SHaRC-style collision detection)
+    // ============================================================================
+    // IMPORTANT: Use HitIndex (original HashID from ProbeTraceCS) for RadianceCachingBuffer
+    // to ensure consistency with ProbeRayResolveCS. The checksum comes from the grid
+    // coordinate ProbeTraceCS quantized, not from payload.worldPosition.
+#if HIT_CACHE_COMPACT
+    uint Checksum = hitData.Checksum;
+#else
+    uint Checksum = SpatialHash_ChecksumGrid(hitData.GridCoord);
+#endif
+
+    // Use HitIndex as the canonical hash ID (matches ProbeTraceCS and ProbeRayResolveCS)
+    uint HashID = HitIndex;
+
+    float3 FinalRadiance;
+
+#if RADIANCE_CACHE_USE_ATOMIC_ACCUMULATION
+    // ============================================================================
+    // SHaRC-style Atomic Accumulation with Collision Detection (idTech8-inspired)
+    // ============================================================================
+    RWByteAddressBuffer AccumulationBuffer = GetRadianceCacheAccumulationByteBuffer();
+    RWByteAddressBuffer MetadataBuffer = GetRadianceCacheMetadataBuffer();
+
+    // Calculate byte offsets using HitIndex (original HashID)
+    // Accumulation: 16 bytes per entry (R, G, B, Count)
+    // Metadata: RADIANCE_CACHE_METADATA_STRIDE bytes per entry (Checksum, Age, ...)
+    uint AccumByteOffset = HitIndex * 16;
+    uint MetaByteOffset = HitIndex * RADIANCE_CACHE_METADATA_STRIDE;
+
+    // ============================================================================
+    // Collision Detection (idTech8/SHaRC-style)
+    // Uses frame number instead of age counter to avoid needing separate age increment pass
+    // ============================================================================
+    bool bSkipAccumulation = false;
+
+#if RADIANCE_CACHE_USE_COLLISION_DETECTION
+#if RADIANCE_CACHE_USE_OPEN_ADDRESSING
+    // Slot ownership is resolved when ProbeTraceCS claims the slot. Only verify that the
+    // cached hit still belongs to the cell that owns the slot.
+    bool IsCollision = (MetadataBuffer.Load(MetaByteOffset + 0) != SpatialHashKey(Checksum));
+    GPUCounterIncrement(GPU_COUNTER_CACHE_COLLISIONS, IsCollision);
+    if (IsCollision)
+    {
+        FinalRadiance = LoadCachedRadiance(HashID);
+        bSkipAccumulation = true;
+    }
+#else
+    uint CurrentFrame = GetGlobalConst(app, frameNumber);
+
+    // Read stored checksum and last update frame
+    uint StoredChecksum = MetadataBuffer.Load(MetaByteOffset + 0);
+    uint StoredFrame = MetadataBuffer.Load(MetaByteOffset + 4);
+
+    // Calculate age as frames since last update
+    uint Age = CurrentFrame - StoredFrame;
+
+    bool IsEmpty = (StoredChecksum == 0);
+    bool IsSameCell = (StoredChecksum == Checksum);
+    bool IsCollision = !IsEmpty && !IsSameCell;
+    GPUCounterIncrement(GPU_COUNTER_CACHE_COLLISIONS, IsCollision);
+
+    if (IsCollision)
+    {
+        // Collision detected - check if we should evict the old entry
+        if (Age >= RADIANCE_CACHE_COLLISION_EVICT_THRESHOLD)
         {
-            InIrradiance = GetGlobalConst(app, skyRadiance);
+            // Old entry is stale, evict it and take over this slot
+            // Reset accumulation buffer for this cell
+            AccumulationBuffer.Store4(AccumByteOffset, uint4(0, 0, 0, 0));
+            // Update metadata with new checksum and current frame
+            MetadataBuffer.Store(MetaByteOffset + 0, Checksum);
+            MetadataBuffer.Store(MetaByteOffset + 4, CurrentFrame);
+            // Clear radiance history
+            StoreCachedRadiance(HashID, float3(0, 0, 0));
         }
         else
         {
-            // Unpack the payload
-            Payload Payloaded = UnpackPayload(packedPayload);
-            uint HashID = SpatialHashCascadeIndex(Payloaded.worldPosition, GetCascadeCellRadius(), GetMaxCacheCellCount(), GetCascadeCount(), GetCascadeBaseDistance());
-            RWStructuredBuffer<float3> RadianceCachingBuffer = GetRadianceCachingBuffer();
-            InIrradiance = RadianceCachingBuffer[HashID];
+            // Existing entry is recent, skip this update to avoid light bleeding
+            // Still need to output something for DDGI
+            FinalRadiance = LoadCachedRadiance(HashID);
+            bSkipAccumulation = true;
         }
+    }
+    else if (IsEmpty)
+    {
+        // First write to this cell - claim it
+        MetadataBuffer.Store(MetaByteOffset + 0, Checksum);
+        MetadataBuffer.Store(MetaByteOffset + 4, CurrentFrame);
+    }
+    else // IsSameCell
+    {
+        // Same cell, update frame to mark as recently used
+        MetadataBuffer.Store(MetaByteOffset + 4, CurrentFrame);
+    }
+#endif // RADIANCE_CACHE_USE_OPEN_ADDRESSING
+#elif !RADIANCE_CACHE_USE_OPEN_ADDRESSING
+    // No collision detection: still record the slot's owner and last use, so the compaction pass can free it
+    MetadataBuffer.Store2(MetaByteOffset, uint2(Checksum, GetGlobalConst(app, frameNumber)));
+#endif // RADIANCE_CACHE_USE_COLLISION_DETECTION
+
+    if (!bSkipAccumulation)
+    {
+        // Scale radiance to integers for atomic operations
+        uint3 ScaledRadiance = uint3(saturate(NewRadiance) * RADIANCE_CACHE_RADIANCE_SCALE);
+
+        // Atomic add - thread-safe accumulation
+        uint OriginalR, OriginalG, OriginalB, OriginalCount;
+        AccumulationBuffer.InterlockedAdd(AccumByteOffset + 0, ScaledRadiance.x, OriginalR);
+        AccumulationBuffer.InterlockedAdd(AccumByteOffset + 4, ScaledRadiance.y, OriginalG);
+        AccumulationBuffer.InterlockedAdd(AccumByteOffset + 8, ScaledRadiance.z, OriginalB);
+        AccumulationBuffer.InterlockedAdd(AccumByteOffset + 12, 1u, OriginalCount);
 
-        float3 BRDF = Albedo / PI;
-        float CosN = dot(WorldNormal, SamplingDirection);
-        float Pdf = CosN / PI;
-        IndirectLight += (BRDF * InIrradiance * CosN ) / Pdf;
+        // Read back accumulated values (after our add)
+        uint NewR = OriginalR + ScaledRadiance.x;
+        uint NewG = OriginalG + ScaledRadiance.y;
+        uint NewB = OriginalB + ScaledRadiance.z;
+        uint NewCount = OriginalCount + 1;
+
+        float SampleCount = max((float)NewCount, 1.0f);
+
+        // Compute average radiance from accumulated samples
+        float3 AccumulatedRadiance = float3(NewR, NewG, NewB) / (RADIANCE_CACHE_RADIANCE_SCALE * SampleCount);
+
+        // Blend accumulated radiance with resolved history
+        float3 OldRadiance = LoadCachedRadiance(HashID);
+        float BlendFactor = 1.0f / min(SampleCount, RADIANCE_CACHE_MAX_ACCUMULATED_SAMPLES);
+
+        // For first sample, use new value directly
+        if (SampleCount <= 1.0f)
+        {
+            BlendFactor = 1.0f;
+        }
+
+        FinalRadiance = lerp(OldRadiance, AccumulatedRadiance, BlendFactor);
+        StoreCachedRadiance(HashID, FinalRadiance);
     }
-    IndirectLight /= SampleCount;
-    return IndirectLight;
+
+#else
+    // ============================================================================
+    // Non-atomic fallback with temporal jittering
+    // ============================================================================
+    float3 OldRadiance = LoadCachedRadiance(HashID);
+    uint FrameNumber = GetGlobalConst(app, frameNumber);
+    bool ShouldUpdate = ((HashID + FrameNumber) % RADIANCE_CACHE_UPDATE_JITTER) == 0;
+
+    FinalRadiance = OldRadiance; // Default: keep old value
+
+    if (ShouldUpdate)
+    {
+        float OldLuminance = dot(OldRadiance, float3(0.299f, 0.587f, 0.114f));
+        float BlendFactor = (float)RADIANCE_CACHE_UPDATE_JITTER / RADIANCE_CACHE_MAX_ACCUMULATED_SAMPLES;
+
+        if (OldLuminance < 0.0001f)
+        {
+            BlendFactor = 1.0f;
+        }
+
+        FinalRadiance = lerp(OldRadiance, NewRadiance, BlendFactor);
+        StoreCachedRadiance(HashID, FinalRadiance);
+    }
+#endif
+
+#if RADIANCE_CACHE_RAY_BUDGET > 0
+    RadianceCacheBudgetRecordUpdate(HitIndex, GetGlobalConst(app, frameNumber), PreviousRadiance, NewRadiance);
+#endif
+
+    // ============================================================================
+    // Visualization buffer (still uses HitIndex for per-ray debugging)
+    // Uses fixed blend factor for stability
+    // ============================================================================
+    float VisualizationBlend = 1.0f / RADIANCE_CACHE_MAX_ACCUMULATED_SAMPLES;
+    RWStructuredBuffer<RadianceCacheVisualization> IndirectRadianceCachingBuffer = GetRadianceCachingVisualizationBuffer();
+    float3 OldDirectRadiance = IndirectRadianceCachingBuffer[HitIndex].DirectRadiance;
+    float3 OldIndirectRadiance = IndirectRadianceCachingBuffer[HitIndex].IndirectRadiance;
+
+    IndirectRadianceCachingBuffer[HitIndex].DirectRadiance = lerp(OldDirectRadiance, DirectLight, VisualizationBlend);
+    IndirectRadianceCachingBuffer[HitIndex].IndirectRadiance = lerp(OldIndirectRadiance, IndirectLight, VisualizationBlend);
+
+    // Indirect irradiance history for the per-pixel gather (see IndirectCS.hlsl), reset when ProbeTraceCS claims the slot
+    uint HistoryFrames = IndirectRadianceCachingBuffer[HitIndex].HistoryFrames + 1;
+    float IrradianceBlend = 1.0f / min((float)HistoryFrames, RADIANCE_CACHE_MAX_ACCUMULATED_SAMPLES);
+    IndirectRadianceCachingBuffer[HitIndex].IndirectIrradiance = lerp(IndirectRadianceCachingBuffer[HitIndex].IndirectIrradiance, IndirectIrradiance, IrradianceBlend);
+    IndirectRadianceCachingBuffer[HitIndex].HistoryFrames = min(HistoryFrames, (uint)RADIANCE_CACHE_MAX_ACCUMULATED_SAMPLES);
+
+    // NOTE: RayData write has been moved to ProbeRayResolveCS
+    // This shader now only writes to the world-space RadianceCachingBuffer
+    // ProbeRayResolveCS scatters the cached radiance to all probe rays via ProbeRayHitMap
+}
+
+/**
+ * Evaluate the direct lighting of a cache slot's hit: the scene lights, with the slot's cached
+ * light visibility (LIGHT_VISIBILITY_CACHE), and one emissive triangle (EMISSIVE_LIGHTS).
+ */
+float3 EvaluateRadianceCacheDirectLight(uint HitIndex, Payload payload, RaytracingAccelerationStructure SceneTLAS)
+{
+#if LIGHT_VISIBILITY_CACHE
+    // Load the slot's light visibility: bits, refresh frame, update frame.
+    // A new slot (zero refresh frame) or one due for a refresh traces every light.
+    RWByteAddressBuffer Metadata = GetRadianceCacheMetadataBuffer();
+    uint VisibilityOffset = (HitIndex * RADIANCE_CACHE_METADATA_STRIDE) + RADIANCE_CACHE_METADATA_LIGHT_VISIBILITY_OFFSET;
+    uint3 Visibility = Metadata.Load3(VisibilityOffset);
+    uint CurrentFrame = GetGlobalConst(app, frameNumber);
+    bool bRefresh = (Visibility.y == 0) || ((CurrentFrame - Visibility.y) >= RADIANCE_CACHE_LIGHT_VISIBILITY_REFRESH_FRAMES);
+
+    LightVisibilityBits = Visibility.x;
+    LightVisibilityValid = bRefresh ? 0 : 0xFFFFFFFF;
+    LightVisibilityFrame = Visibility.z;
+    LightVisibilityTraced = 0;
+#endif
+
+    float3 DirectLight = DirectDiffuseLightingInline(payload, GetGlobalConst(pt, rayNormalBias), GetGlobalConst(pt, rayViewBias), SceneTLAS, GetLights());
+
+#if LIGHT_VISIBILITY_CACHE
+    // Store the bits traced this frame
+    if (bRefresh) Metadata.Store3(VisibilityOffset, uint3(LightVisibilityBits, CurrentFrame, CurrentFrame));
+    else if (LightVisibilityTraced != 0) Metadata.Store3(VisibilityOffset, uint3(LightVisibilityBits, Visibility.y, CurrentFrame));
+#endif
+
+#if EMISSIVE_LIGHTS
+    // One emissive triangle per cell and frame, the noise averages out as the slot accumulates
+    uint Seed = WangHash(asuint(payload.worldPosition.x) ^ WangHash(asuint(payload.worldPosition.y) ^ WangHash(asuint(payload.worldPosition.z))));
+    Seed += GetGlobalConst(app, frameNumber);
+    DirectLight += (payload.albedo / PI) * EvaluateEmissiveLightInline(payload, GetGlobalConst(pt, rayNormalBias), GetGlobalConst(pt, rayViewBias), SceneTLAS, Seed);
+#endif
+
+    return DirectLight;
 }
-#endif
\ No newline at end of file
+
+/**
+ * Shade the cache slot of a work list entry: direct and indirect lighting of its cached hit,
+ * accumulated into the slot.
+ */
+void ShadeRadianceCacheWorkItem(uint WorkIndex)
+{
+    uint HitIndex;
+    HitUnpackedData hitData;
+    Payload payload;
+    if (!LoadRadianceCacheHit(WorkIndex, HitIndex, hitData, payload)) return;
+
+    // Get the acceleration structure
+    RaytracingAccelerationStructure SceneTLAS = GetAccelerationStructure(SCENE_TLAS_INDEX);
+
+    // Direct Lighting and Shadowing using inline ray tracing
+    float3 DirectLight = EvaluateRadianceCacheDirectLight(HitIndex, payload, SceneTLAS);
+
+    // Indirect lighting from the probes, or using secondary rays where no volume covers the hit.
+    // Evaluated for a white surface (irradiance / PI), so the per-pixel gather can reuse it with the pixel's albedo.
+    float3 IndirectIrradiance;
+#if RADIANCE_CACHE_INDIRECT_FROM_PROBES
+    if (!EvaluateIndirectRadianceProbes(float3(1.f, 1.f, 1.f), payload.worldPosition, payload.shadingNormal, IndirectIrradiance))
+#endif
+    {
+#if RADIANCE_CACHE_RESERVOIR
+        IndirectIrradiance = EvaluateIndirectRadianceReservoir(float3(1.f, 1.f, 1.f), payload.worldPosition, payload.shadingNormal, SceneTLAS, HitIndex);
+#else
+        IndirectIrradiance = EvaluateIndirectRadiance(float3(1.f, 1.f, 1.f), payload.worldPosition, payload.shadingNormal, SceneTLAS, RADIANCE_CACHE_SAMPLE_COUNT);
+#endif
+    }
+
+    ResolveRadianceCacheHit(HitIndex, hitData, payload.albedo, DirectLight, IndirectIrradiance);
+}
+
+#endif // RADIANCE_COMMON_HLSL
@@ -13,6 +13,26 @@
 #ifndef RAYTRACING_HLSL
 #define RAYTRACING_HLSL
 
+// GI_MATERIALS may be passed in as a define at shader compilation time (Globals::GIMaterials, D3D12 only).
+// GI hit shading reads the GIMaterial of the hit instead of its Material.
+#ifndef GI_MATERIALS
+#define GI_MATERIALS 0
+#endif
+
+// GI_VERTEX_ALBEDO may be passed in as a define at shader compilation time (Globals::GIVertexAlbedo, D3D12 only).
+// With GI_MATERIALS, GI hit shading interpolates the baked vertex albedos of the hit instead of sampling its albedo texture.
+#ifndef GI_VERTEX_ALBEDO
+#define GI_VERTEX_ALBEDO 0
+#endif
+
+/**
+ * Get the TLAS instance mask probe rays of a DDGIVolume are traced with (see TLAS_INSTANCE_MASK_FLAGS).
+ */
+uint GetDDGIVolumeInstanceMask(uint volumeIndex)
+{
+    return (1u << (volumeIndex % 7u));
+}
+
 /**
  * Pack the payload into a compressed format.
  * Complement of UnpackPayload().
@@ -69,6 +89,25 @@ Payload UnpackPayload(PackedPayload input)
     return output;
 }
 
+/**
+ * Unpack the albedo and opacity of a GI material (see GIMaterial).
+ * The material's average albedo texture color is applied when it has one, otherwise the albedo texture index is returned (-1 for none).
+ */
+int UnpackGIMaterial(GIMaterial material, out float3 albedo, out float opacity)
+{
+    albedo = float3(material.albedoOpacity & 0xFF, (material.albedoOpacity >> 8) & 0xFF, (material.albedoOpacity >> 16) & 0xFF) / 255.f;
+    opacity = float(material.albedoOpacity >> 24) / 255.f;
+
+    uint albedoTexIdx = (material.albedoTexture & 0x7FFF);
+    if (albedoTexIdx == 0x7FFF) return -1;
+    if (material.albedoTexture & 0x8000)
+    {
+        albedo *= float3((material.albedoTexture >> 16) & 0x1F, (material.albedoTexture >> 21) & 0x3F, (material.albedoTexture >> 27) & 0x1F) / float3(31.f, 63.f, 31.f);
+        return -1;
+    }
+    return int(albedoTexIdx);
+}
+
 /**
  * Load a triangle's indices.
  */
@@ -78,6 +117,53 @@ uint3 LoadIndices(uint meshIndex, uint primitiveIndex, GeometryData geometry)
     return GetIndexBuffer(meshIndex).Load3(address); // Mesh index buffers start at index 4 and alternate with vertex buffer pointers
 }
 
+/**
+ * Sign extend and normalize a signed normalized integer with the given number of bits.
+ */
+float UnpackSnorm(uint value, uint bits)
+{
+    int q = int(value << (32 - bits)) >> (32 - bits);
+    return max((float)q / (float)((1 << (bits - 1)) - 1), -1.f);
+}
+
+/**
+ * Decode an octahedral encoded unit vector.
+ */
+float3 OctDecode(float2 e)
+{
+    float3 v = float3(e.x, e.y, 1.f - abs(e.x) - abs(e.y));
+    float t = saturate(-v.z);
+    v.x += (v.x >= 0.f) ? -t : t;
+    v.y += (v.y >= 0.f) ? -t : t;
+    return normalize(v);
+}
+
+/**
+ * Dequantize a vertex position to mesh space (see Types.h::PackedVertex).
+ */
+float3 UnpackVertexPosition(uint4 data, GeometryData geometry)
+{
+    float4 position = float4(float3(data.x & 0xFFFF, data.x >> 16, data.y & 0xFFFF) / 65535.f, 1.f);
+    return float3(dot(geometry.positionTransform[0], position), dot(geometry.positionTransform[1], position), dot(geometry.positionTransform[2], position));
+}
+
+/**
+ * Unpack a quantized vertex (see Types.h::PackedVertex).
+ */
+Vertex UnpackVertex(uint4 data, GeometryData geometry)
+{
+    Vertex v;
+    v.position = UnpackVertexPosition(data, geometry);
+    v.normal = OctDecode(float2(UnpackSnorm(data.z, 16), UnpackSnorm(data.z >> 16, 16)));
+
+    uint tangent = (data.y >> 16);
+    v.tangent.xyz = OctDecode(float2(UnpackSnorm(tangent, 7), UnpackSnorm(tangent >> 7, 7)));
+    v.tangent.w = (tangent & 0x8000) ? -1.f : 1.f;
+
+    v.uv0 = float2(f16tof32(data.w), f16tof32(data.w >> 16));
+    return v;
+}
+
 /**
  * Load a triangle's vertex data (all: position, normal, tangent, uv0).
  */
@@ -86,27 +172,11 @@ void LoadVertices(uint meshIndex, uint primitiveIndex, GeometryData geometry, ou
     // Get the indices
     uint3 indices = LoadIndices(meshIndex, primitiveIndex, geometry);
 
-    // Load the vertices
-    uint address;
+    // Load and unpack the vertices
     for (uint i = 0; i < 3; i++)
     {
-        vertices[i] = (Vertex)0;
-        address = geometry.vertexByteAddress + (indices[i] * 12) * 4;  // Vertices contain 12 floats / 48 bytes
-
-        // Load the position
-        vertices[i].position = asfloat(GetVertexBuffer(meshIndex).Load3(address));
-        address += 12;
-
-        // Load the normal
-        vertices[i].normal = asfloat(GetVertexBuffer(meshIndex).Load3(address));
-        address += 12;
-
-        // Load the tangent
-        vertices[i].tangent = asfloat(GetVertexBuffer(meshIndex).Load4(address));
-        address += 16;
-
-        // Load the texture coordinates
-        vertices[i].uv0 = asfloat(GetVertexBuffer(meshIndex).Load2(address));
+        uint address = geometry.vertexByteAddress + (indices[i] * 16);  // Packed vertices are 16 bytes
+        vertices[i] = UnpackVertex(GetVertexBuffer(meshIndex).Load4(address), geometry);
     }
 }
 
@@ -119,19 +189,33 @@ void LoadVerticesPosUV0(uint meshIndex, uint primitiveIndex, GeometryData geomet
     uint3 indices = LoadIndices(meshIndex, primitiveIndex, geometry);
 
     // Load the vertices
-    uint address;
     for (uint i = 0; i < 3; i++)
     {
         vertices[i] = (Vertex)0;
-        address = geometry.vertexByteAddress + (indices[i] * 12) * 4;  // Vertices contain 12 floats / 48 bytes
+        uint address = geometry.vertexByteAddress + (indices[i] * 16);  // Packed vertices are 16 bytes
+        uint4 data = GetVertexBuffer(meshIndex).Load4(address);
+
+        // Unpack the position and texture coordinates
+        vertices[i].position = UnpackVertexPosition(data, geometry);
+        vertices[i].uv0 = float2(f16tof32(data.w), f16tof32(data.w >> 16));
+    }
+}
 
-        // Load the position
-        vertices[i].position = asfloat(GetVertexBuffer(meshIndex).Load3(address));
-        address += 40; // skip normal and tangent
+/**
+ * Load a triangle's baked vertex albedos (see GeometryData::albedoByteAddress) and return the barycentric interpolated albedo and opacity.
+ */
+float4 LoadAndInterpolateVertexAlbedo(uint meshIndex, uint primitiveIndex, GeometryData geometry, float3 barycentrics)
+{
+    // Get the indices
+    uint3 indices = LoadIndices(meshIndex, primitiveIndex, geometry);
 
-        // Load the texture coordinates
-        vertices[i].uv0 = asfloat(GetVertexBuffer(meshIndex).Load2(address));
+    float4 albedo = 0.f;
+    for (uint i = 0; i < 3; i++)
+    {
+        uint packed = GetVertexBuffer(meshIndex).Load(geometry.albedoByteAddress + (indices[i] * 4)); // RGBA8 UNORM
+        albedo += barycentrics[i] * (float4(packed & 0xFF, (packed >> 8) & 0xFF, (packed >> 16) & 0xFF, packed >> 24) / 255.f);
     }
+    return albedo;
 }
 
 /**
@@ -143,18 +227,48 @@ float2 LoadAndInterpolateUV0(uint meshIndex, uint primitiveIndex, GeometryData g
     uint3 indices = LoadIndices(meshIndex, primitiveIndex, geometry);
 
     // Interpolate the texture coordinates
-    int address;
     float2 uv0 = float2(0.f, 0.f);
     for (uint i = 0; i < 3; i++)
     {
-        address = geometry.vertexByteAddress + (indices[i] * 12) * 4;  // 12 floats (3: pos, 3: normals, 4:tangent, 2:uv0)
-        address += 40;                                                // 40 bytes (10 * 4): skip position, normal, and tangent
-        uv0 += asfloat(GetVertexBuffer(meshIndex).Load2(address)) * barycentrics[i];
+        uint address = geometry.vertexByteAddress + (indices[i] * 16) + 12;  // Packed vertices are 16 bytes, uv0 are the last 4 (2x half)
+        uint data = GetVertexBuffer(meshIndex).Load(address);
+        uv0 += float2(f16tof32(data), f16tof32(data >> 16)) * barycentrics[i];
     }
 
     return uv0;
 }
 
+/**
+ * Alpha test a non-opaque triangle hit for GI rays: the material's opacity times (masked materials) its albedo texture's
+ * alpha in a low mip level. Returns true if the hit passes the alpha test (the AHS_GI any-hit shader and inline GI rays).
+ */
+bool AlphaTestGI(uint meshIndex, uint geometryIndex, uint primitiveIndex, float2 attribBarycentrics)
+{
+    // Load the intersected mesh geometry's data
+    GeometryData geometry;
+    GetGeometryData(meshIndex, geometryIndex, geometry);
+
+    // Load the surface material
+    Material material = GetMaterial(geometry);
+
+    float alpha = material.opacity;
+    if (material.alphaMode == 2 && material.albedoTexIdx > -1)
+    {
+        // Interpolate the triangle's texture coordinates
+        float3 barycentrics = float3((1.f - attribBarycentrics.x - attribBarycentrics.y), attribBarycentrics.x, attribBarycentrics.y);
+        float2 uv0 = LoadAndInterpolateUV0(meshIndex, primitiveIndex, geometry, barycentrics);
+
+        // Get the number of mip levels
+        uint width, height, numLevels;
+        GetTex2D(material.albedoTexIdx).GetDimensions(0, width, height, numLevels);
+
+        // Sample the texture
+        alpha *= GetTex2D(material.albedoTexIdx).SampleLevel(GetBilinearWrapSampler(), uv0, numLevels * 0.6667f).a;
+    }
+
+    return (alpha >= material.alphaCutoff);
+}
+
 /**
  * Return interpolated vertex attributes (all).
  */
@@ -312,4 +426,25 @@ void ComputeUV0Differentials(Vertex vertices[3], float3 rayDirection, float hitT
     InterpolateTexCoordDifferentials(dBarydx, dBarydy, vertices, dUVdx, dUVdy);
 }
 
+#if GFX_NVAPI
+// Shader Execution Reordering coherence hint: the hit material in the high bits, the instance (mesh) in the low bits
+#define SER_HINT_INSTANCE_BITS 4
+#define SER_HINT_BITS 16
+
+/**
+ * Get the coherence hint that reorders threads by hit material, then instance, before closest hit shading.
+ * NvReorderThread() already groups threads by hit group (shader), the hint groups the threads of a hit group by the data they load.
+ */
+uint GetReorderCoherenceHint(NvHitObject hit)
+{
+    if (!hit.IsHit()) return 0;
+
+    GeometryData geometry;
+    GetGeometryData(hit.GetInstanceID(), hit.GetGeometryIndex(), geometry);
+
+    uint instanceHint = hit.GetInstanceID() & ((1u << SER_HINT_INSTANCE_BITS) - 1);
+    return ((geometry.materialIndex << SER_HINT_INSTANCE_BITS) | instanceHint) & ((1u << SER_HINT_BITS) - 1);
+}
+#endif
+
 #endif // RAYTRACING_HLSL
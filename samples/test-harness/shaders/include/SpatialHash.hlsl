@@ -3,6 +3,98 @@
 
 #include "Random.hlsl"
 
+// ============================================================================
+// Open Addressing Parameters
+// ============================================================================
+// USE_OPEN_ADDRESSING: Resolve hash collisions with bounded linear probing
+// - 1 = the cell checksum is the key, claimed in the metadata buffer with
+//       InterlockedCompareExchange; colliding cells move to the next free slot
+// - 0 = legacy modulo indexing, colliding cells overwrite each other
+#ifndef RADIANCE_CACHE_USE_OPEN_ADDRESSING
+#define RADIANCE_CACHE_USE_OPEN_ADDRESSING 1
+#endif
+
+// PROBE_SEQUENCE_LENGTH: Maximum number of slots visited by a lookup or insert
+// - Higher = fewer failed inserts in dense tables, but longer lookups
+#ifndef RADIANCE_CACHE_PROBE_SEQUENCE_LENGTH
+#define RADIANCE_CACHE_PROBE_SEQUENCE_LENGTH 8
+#endif
+
+// EVICT_AGE: Frames since last use after which an occupied slot may be reclaimed
+// by a different key. Matches the radiance cache entry lifetime.
+#ifndef RADIANCE_CACHE_EVICT_AGE
+#define RADIANCE_CACHE_EVICT_AGE 8
+#endif
+
+// Metadata layout: 32 bytes per slot (key/checksum, last used frame, last shaded frame, volatility,
+// light visibility bits, light visibility refresh frame, light visibility update frame, probe rays)
+// The last shaded frame and volatility belong to the update budget scheduler (see RadianceCacheBudget.hlsl),
+// the light visibility fields to the shadow ray cache of the radiance cache shading (see RadianceCommon.hlsl),
+// the probe rays that hit the cell this frame to the coverage stats (GPU_COUNTERS, see RadianceCacheStatsCS.hlsl)
+#define RADIANCE_CACHE_METADATA_STRIDE 32
+#define RADIANCE_CACHE_METADATA_LIGHT_VISIBILITY_OFFSET 16
+#define RADIANCE_CACHE_METADATA_PROBE_RAYS_OFFSET 28
+
+// Returned by lookups and inserts that did not find (or could not claim) a slot
+#define RADIANCE_CACHE_INVALID_SLOT 0xFFFFFFFF
+
+// Metadata key of a slot freed by the compaction pass (see RadianceCacheCompactCS.hlsl).
+// Lookups walk past it like a live slot, so the probe sequences through it stay intact,
+// and inserts reclaim it like a stale slot. Never used as a cell key.
+#define RADIANCE_CACHE_TOMBSTONE_KEY 0xFFFFFFFF
+
+// ============================================================================
+// Cascade Selection
+// ============================================================================
+// CASCADE_MODE: What selects the cascade (and cell size) of a cache lookup or insert
+// - CAMERA     = distance from the camera to the cached point. Every camera move
+//                re-keys the cells near the cascade boundaries.
+// - RAY_LENGTH = length of the querying ray (its footprint at the cached point).
+//                Independent of the camera, so cells stay valid while it moves.
+#define RADIANCE_CACHE_CASCADE_MODE_CAMERA 0
+#define RADIANCE_CACHE_CASCADE_MODE_RAY_LENGTH 1
+
+#ifndef RADIANCE_CACHE_CASCADE_MODE
+#define RADIANCE_CACHE_CASCADE_MODE RADIANCE_CACHE_CASCADE_MODE_CAMERA
+#endif
+
+// ============================================================================
+// Hash Function
+// ============================================================================
+// HASH_FUNCTION: How a grid cell is hashed to its home slot and checksum (key)
+// - FNV_WANG = FNV-1a of the coordinates, finalized with WangHash; the checksum sums
+//              XorShift32 of each coordinate
+// - PCG3D    = one PCG3D round of the coordinates (Jarzynski and Olano 2020), its x
+//              output is the home slot hash and its y output the checksum
+// - XXHASH32 = xxHash32 of the coordinates, seeded differently for the checksum
+// - MORTON   = the cells of each 16x16x16 brick of the grid get consecutive, Morton ordered
+//              home slots (neighbouring cells share cache lines), the brick is placed by
+//              the FNV_WANG hash. Linear probe sequences of neighbouring cells overlap.
+// The radiance cache stats report the average probe sequence length of the live cells
+// (see RadianceCacheStatsCS.hlsl), the benchmark writes it per frame.
+#define RADIANCE_CACHE_HASH_FNV_WANG 0
+#define RADIANCE_CACHE_HASH_PCG3D 1
+#define RADIANCE_CACHE_HASH_XXHASH32 2
+#define RADIANCE_CACHE_HASH_MORTON 3
+
+#ifndef RADIANCE_CACHE_HASH_FUNCTION
+#define RADIANCE_CACHE_HASH_FUNCTION RADIANCE_CACHE_HASH_FNV_WANG
+#endif
+
+// BRICK_LAYOUT: Two-level layout of the hash table (see SpatialHashGridHomeSlot)
+// - 1 = the HASH_FUNCTION places each 4x4x4 brick of cells in a bucket of 64 contiguous
+//       slots, the brick's cells are indexed linearly inside it. Spatially coherent lookups
+//       (neighbouring probe rays and pixels) read the same cache lines. Bricks that share a
+//       bucket collide on the same local indices.
+// - 0 = the HASH_FUNCTION places each cell
+#ifndef RADIANCE_CACHE_BRICK_LAYOUT
+#define RADIANCE_CACHE_BRICK_LAYOUT 0
+#endif
+
+#define RADIANCE_CACHE_BRICK_SIZE_LOG2 2
+#define RADIANCE_CACHE_BRICK_SIZE (1 << RADIANCE_CACHE_BRICK_SIZE_LOG2)
+#define RADIANCE_CACHE_BRICK_CELLS (RADIANCE_CACHE_BRICK_SIZE * RADIANCE_CACHE_BRICK_SIZE * RADIANCE_CACHE_BRICK_SIZE)
+
 uint XorShift32(uint x)
 {
     x ^= (x << 13);
@@ -11,16 +103,54 @@ uint XorShift32(uint x)
     return x;
 }
 
+uint3 Pcg3d(uint3 v)
+{
+    v = v * 1664525u + 1013904223u;
+    v.x += v.y * v.z;
+    v.y += v.z * v.x;
+    v.z += v.x * v.y;
+    v ^= v >> 16u;
+    v.x += v.y * v.z;
+    v.y += v.z * v.x;
+    v.z += v.x * v.y;
+    return v;
+}
+
+uint XXHash32(uint3 v, uint seed)
+{
+    const uint PRIME32_2 = 2246822519u;
+    const uint PRIME32_3 = 3266489917u;
+    const uint PRIME32_4 = 668265263u;
+    const uint PRIME32_5 = 374761393u;
+
+    uint h = seed + PRIME32_5 + 12u;
+    for (uint i = 0; i < 3; i++)
+    {
+        h += v[i] * PRIME32_3;
+        h = PRIME32_4 * ((h << 17) | (h >> 15));
+    }
+    h = PRIME32_2 * (h ^ (h >> 15));
+    h = PRIME32_3 * (h ^ (h >> 13));
+    return h ^ (h >> 16);
+}
+
+// Interleave the low 4 bits of each coordinate (12 bit Morton code)
+uint Morton3D4(uint3 v)
+{
+    v &= 0xFu;
+    v = (v | (v << 4)) & 0xC3u;
+    v = (v | (v << 2)) & 0x249u;
+    return v.x | (v.y << 1) | (v.z << 2);
+}
+
 int3 GridCoord(float3 P, float cellSize)
 {
     float3 q = floor(P / cellSize);
     return (int3)q;
 }
 
-uint SpatialHash_H(float3 P, float cellSize)
+uint SpatialHash_FnvWang(int3 g)
 {
-    int3 g = GridCoord(P, cellSize);
-
     // Better hash combining using PCG-style mixing (idTech8/SHaRC approach)
     // Avoids collisions from simple addition (e.g., (1,2,3) vs (3,2,1))
     uint h = 0x811c9dc5u; // FNV offset basis
@@ -35,15 +165,61 @@ uint SpatialHash_H(float3 P, float cellSize)
     return WangHash(h);
 }
 
-uint SpatialHash_Checksum(float3 P, float cellSize)
+uint SpatialHash_HGrid(int3 g)
 {
-    int3 g = GridCoord(P, cellSize);
+#if RADIANCE_CACHE_HASH_FUNCTION == RADIANCE_CACHE_HASH_PCG3D
+    return Pcg3d((uint3)g).x;
+#elif RADIANCE_CACHE_HASH_FUNCTION == RADIANCE_CACHE_HASH_XXHASH32
+    return XXHash32((uint3)g, 0u);
+#elif RADIANCE_CACHE_HASH_FUNCTION == RADIANCE_CACHE_HASH_MORTON
+    // 4096 consecutive slots per brick (the arithmetic shift keeps negative bricks distinct)
+    return (SpatialHash_FnvWang(g >> 4) << 12) + Morton3D4((uint3)g);
+#else
+    return SpatialHash_FnvWang(g);
+#endif
+}
 
+uint SpatialHash_H(float3 P, float cellSize)
+{
+    return SpatialHash_HGrid(GridCoord(P, cellSize));
+}
+
+uint SpatialHash_ChecksumGrid(int3 g)
+{
+#if RADIANCE_CACHE_HASH_FUNCTION == RADIANCE_CACHE_HASH_PCG3D
+    return Pcg3d((uint3)g).y;
+#elif RADIANCE_CACHE_HASH_FUNCTION == RADIANCE_CACHE_HASH_XXHASH32
+    return XXHash32((uint3)g, 0x9E3779B9u);
+#else
     uint cx = XorShift32((uint)g.x);
     uint cy = XorShift32((uint)g.y);
     uint cz = XorShift32((uint)g.z);
 
     return cx + cy + cz;
+#endif
+}
+
+uint SpatialHash_Checksum(float3 P, float cellSize)
+{
+    return SpatialHash_ChecksumGrid(GridCoord(P, cellSize));
+}
+
+/**
+ * Home slot (within the cascade's range) of a grid cell.
+ * With RADIANCE_CACHE_BRICK_LAYOUT, the cell's brick is hashed to a bucket of RADIANCE_CACHE_BRICK_CELLS
+ * contiguous slots and the cell is indexed linearly inside it.
+ */
+uint SpatialHashGridHomeSlot(int3 Grid, uint CellNum)
+{
+#if RADIANCE_CACHE_BRICK_LAYOUT
+    uint3 Local = (uint3)Grid & (RADIANCE_CACHE_BRICK_SIZE - 1);
+    uint LocalIndex = (((Local.z * RADIANCE_CACHE_BRICK_SIZE) + Local.y) * RADIANCE_CACHE_BRICK_SIZE) + Local.x;
+    uint NumBuckets = max(CellNum / RADIANCE_CACHE_BRICK_CELLS, 1u);
+    uint Bucket = SpatialHash_HGrid(Grid >> RADIANCE_CACHE_BRICK_SIZE_LOG2) % NumBuckets;
+    return ((Bucket * RADIANCE_CACHE_BRICK_CELLS) + LocalIndex) % CellNum;
+#else
+    return SpatialHash_HGrid(Grid) % CellNum;
+#endif
 }
 
 float CalculateCascadeMaxDistance(uint CascadeIdx, float CascadeBaseDistance)
@@ -61,7 +237,20 @@ uint CalculateCascadeIndex(float3 P, float3 CameraPos, uint CascadeNum, float Ca
 uint GetCascadeIndex(float3 P, uint CascadeNum, float CascadeDistance)
 {
     float3 CameraPos = GetCamera().position;
-    return CalculateCascadeIndex(P, CameraPos, CascadeNum, CascadeDistance);;
+    return CalculateCascadeIndex(P, CameraPos, CascadeNum, CascadeDistance);
+}
+
+/**
+ * Get the radiance cache cascade of a point reached by a ray of length RayLength (see RADIANCE_CACHE_CASCADE_MODE).
+ * Cascades are RayLength / CascadeDistance apart, like the camera distance cascades.
+ */
+uint GetCacheCascadeIndex(float3 P, float RayLength, uint CascadeNum, float CascadeDistance)
+{
+#if RADIANCE_CACHE_CASCADE_MODE == RADIANCE_CACHE_CASCADE_MODE_RAY_LENGTH
+    return min(floor(abs(RayLength) / CascadeDistance), CascadeNum - 1);
+#else
+    return GetCascadeIndex(P, CascadeNum, CascadeDistance);
+#endif
 }
 
 float CalculateCascadeCellSize(float CascadeIndex, float CellSize)
@@ -71,19 +260,110 @@ float CalculateCascadeCellSize(float CascadeIndex, float CellSize)
 
 uint SpatialHashIndex(float3 P, float CellSize, uint CellNum)
 {
-    return SpatialHash_H(P, CellSize) % CellNum;
+    return SpatialHashGridHomeSlot(GridCoord(P, CellSize), CellNum);
 }
 
-uint SpatialHashCascadeIndex(float3 P, float BaseCellSize, uint CellNum, uint CascadeNum, float CascadeDistance)
+uint SpatialHashCascadeIndex(float3 P, float RayLength, float BaseCellSize, uint CellNum, uint CascadeNum, float CascadeDistance)
 {
-    float CascadeIndex = GetCascadeIndex(P, CascadeNum, CascadeDistance);
+    float CascadeIndex = GetCacheCascadeIndex(P, RayLength, CascadeNum, CascadeDistance);
     float CellSize = CalculateCascadeCellSize(CascadeIndex, BaseCellSize);
     return SpatialHashIndex(P, CellSize, CellNum) + CascadeIndex * CellNum;
 }
 
+// Metadata key for a checksum. Zero marks an empty slot and RADIANCE_CACHE_TOMBSTONE_KEY a freed slot,
+// so neither is used as a key.
+uint SpatialHashKey(uint Checksum)
+{
+    return ((Checksum == 0) || (Checksum == RADIANCE_CACHE_TOMBSTONE_KEY)) ? 1u : Checksum;
+}
+
+/**
+ * Find the slot that owns Key by walking the bounded linear probe sequence
+ * starting at HomeSlot. The sequence wraps within the cascade's range of CellNum slots.
+ * Returns RADIANCE_CACHE_INVALID_SLOT when the key is not present.
+ */
+uint SpatialHashFindSlot(RWByteAddressBuffer Metadata, uint HomeSlot, uint CascadeIndex, uint CellNum, uint Key)
+{
+    uint CascadeOffset = CascadeIndex * CellNum;
+    for (uint Step = 0; Step < RADIANCE_CACHE_PROBE_SEQUENCE_LENGTH; Step++)
+    {
+        uint Slot = CascadeOffset + ((HomeSlot + Step) % CellNum);
+        uint StoredKey = Metadata.Load(Slot * RADIANCE_CACHE_METADATA_STRIDE);
+        if (StoredKey == Key) return Slot;
+
+        // Slots are only released back to empty when no probe sequence runs through them
+        // (see RadianceCacheCompactCS.hlsl), so an empty slot ends the chain
+        if (StoredKey == 0) break;
+    }
+    return RADIANCE_CACHE_INVALID_SLOT;
+}
+
+/**
+ * Find or claim the slot for Key along the bounded linear probe sequence starting at HomeSlot.
+ * Empty slots are claimed with InterlockedCompareExchange so concurrent inserts of different keys
+ * never share a slot. If every slot in the sequence is owned by another key, the first slot that has
+ * not been used for RADIANCE_CACHE_EVICT_AGE frames is reclaimed and bEvicted is set, so the caller
+ * can discard the previous owner's radiance history. bClaimed is set when the slot was empty or
+ * evicted, i.e. it holds no radiance history for Key yet.
+ * The slot's last used frame is exchanged atomically, so exactly one insert per slot and frame
+ * sets bFirstTouch; that caller appends the slot to the radiance cache work list.
+ * Returns RADIANCE_CACHE_INVALID_SLOT when the sequence is saturated with live entries.
+ */
+uint SpatialHashInsertSlot(RWByteAddressBuffer Metadata, uint HomeSlot, uint CascadeIndex, uint CellNum, uint Key, uint CurrentFrame, out bool bEvicted, out bool bClaimed, out bool bFirstTouch)
+{
+    bEvicted = false;
+    bClaimed = false;
+    bFirstTouch = false;
+
+    uint PreviousFrame;
+
+    uint CascadeOffset = CascadeIndex * CellNum;
+    uint Step;
+    for (Step = 0; Step < RADIANCE_CACHE_PROBE_SEQUENCE_LENGTH; Step++)
+    {
+        uint Slot = CascadeOffset + ((HomeSlot + Step) % CellNum);
+        uint MetaOffset = Slot * RADIANCE_CACHE_METADATA_STRIDE;
+
+        uint PreviousKey;
+        Metadata.InterlockedCompareExchange(MetaOffset, 0, Key, PreviousKey);
+        if (PreviousKey == 0 || PreviousKey == Key)
+        {
+            bClaimed = (PreviousKey == 0);
+            Metadata.InterlockedExchange(MetaOffset + 4, CurrentFrame, PreviousFrame);
+            bFirstTouch = (PreviousFrame != CurrentFrame);
+            return Slot;
+        }
+    }
+
+    // Probe sequence is full, try to reclaim a stale slot
+    for (Step = 0; Step < RADIANCE_CACHE_PROBE_SEQUENCE_LENGTH; Step++)
+    {
+        uint Slot = CascadeOffset + ((HomeSlot + Step) % CellNum);
+        uint MetaOffset = Slot * RADIANCE_CACHE_METADATA_STRIDE;
+
+        uint StoredKey = Metadata.Load(MetaOffset);
+        uint StoredFrame = Metadata.Load(MetaOffset + 4);
+        if ((CurrentFrame - StoredFrame) < RADIANCE_CACHE_EVICT_AGE) continue;
+
+        uint PreviousKey;
+        Metadata.InterlockedCompareExchange(MetaOffset, StoredKey, Key, PreviousKey);
+        if (PreviousKey == StoredKey || PreviousKey == Key)
+        {
+            bEvicted = (PreviousKey == StoredKey);
+            bClaimed = bEvicted;
+            Metadata.InterlockedExchange(MetaOffset + 4, CurrentFrame, PreviousFrame);
+            bFirstTouch = (PreviousFrame != CurrentFrame);
+            return Slot;
+        }
+    }
+
+    return RADIANCE_CACHE_INVALID_SLOT;
+}
+
 // Get both hash index and checksum for collision detection (SHaRC-style)
 void SpatialHashCascadeIndexWithChecksum(
     float3 P,
+    float RayLength,
     float BaseCellSize,
     uint CellNum,
     uint CascadeNum,
@@ -91,12 +371,112 @@ void SpatialHashCascadeIndexWithChecksum(
     out uint HashIndex,
     out uint Checksum)
 {
-    float CascadeIndex = GetCascadeIndex(P, CascadeNum, CascadeDistance);
+    float CascadeIndex = GetCacheCascadeIndex(P, RayLength, CascadeNum, CascadeDistance);
     float CellSize = CalculateCascadeCellSize(CascadeIndex, BaseCellSize);
     HashIndex = SpatialHashIndex(P, CellSize, CellNum) + CascadeIndex * CellNum;
     Checksum = SpatialHash_Checksum(P, CellSize);
 }
 
+/**
+ * Quantize a world-space position to its cascade and integer grid coordinate.
+ * The grid coordinate is the canonical cell identity: passes that only have an
+ * approximation of the original position (e.g. an interpolated vertex position
+ * instead of the ray equation) must reuse it rather than re-quantize.
+ * RayLength is the length of the ray that reached P (see RADIANCE_CACHE_CASCADE_MODE).
+ */
+void SpatialHashCascadeGridCoord(
+    float3 P,
+    float RayLength,
+    float BaseCellSize,
+    uint CascadeNum,
+    float CascadeDistance,
+    out uint CascadeIndex,
+    out int3 Grid)
+{
+    CascadeIndex = GetCacheCascadeIndex(P, RayLength, CascadeNum, CascadeDistance);
+    Grid = GridCoord(P, CalculateCascadeCellSize(CascadeIndex, BaseCellSize));
+}
+
+// Metadata key of a grid cell
+uint SpatialHashGridKey(int3 Grid)
+{
+    return SpatialHashKey(SpatialHash_ChecksumGrid(Grid));
+}
+
+/**
+ * Get the cascade, home slot (within the cascade), and key for a world-space position.
+ */
+void SpatialHashCascadeHomeSlot(
+    float3 P,
+    float RayLength,
+    float BaseCellSize,
+    uint CellNum,
+    uint CascadeNum,
+    float CascadeDistance,
+    out uint CascadeIndex,
+    out uint HomeSlot,
+    out uint Key)
+{
+    int3 Grid;
+    SpatialHashCascadeGridCoord(P, RayLength, BaseCellSize, CascadeNum, CascadeDistance, CascadeIndex, Grid);
+    HomeSlot = SpatialHashGridHomeSlot(Grid, CellNum);
+    Key = SpatialHashGridKey(Grid);
+}
+
+/**
+ * Look up the radiance cache slot of a quantized grid cell.
+ * With open addressing disabled this is the legacy modulo index and always succeeds.
+ */
+uint SpatialHashGridFind(int3 Grid, uint CascadeIndex, uint CellNum, RWByteAddressBuffer Metadata)
+{
+#if RADIANCE_CACHE_USE_OPEN_ADDRESSING
+    return SpatialHashFindSlot(Metadata, SpatialHashGridHomeSlot(Grid, CellNum), CascadeIndex, CellNum, SpatialHashGridKey(Grid));
+#else
+    return SpatialHashGridHomeSlot(Grid, CellNum) + CascadeIndex * CellNum;
+#endif
+}
+
+/**
+ * Find or claim the radiance cache slot of a quantized grid cell.
+ * With open addressing disabled this is the legacy modulo index and always succeeds,
+ * and bFirstTouch is never set (the radiance cache pass scans the whole table).
+ */
+uint SpatialHashGridInsert(int3 Grid, uint CascadeIndex, uint CellNum, RWByteAddressBuffer Metadata, uint CurrentFrame, out bool bEvicted, out bool bClaimed, out bool bFirstTouch)
+{
+#if RADIANCE_CACHE_USE_OPEN_ADDRESSING
+    return SpatialHashInsertSlot(Metadata, SpatialHashGridHomeSlot(Grid, CellNum), CascadeIndex, CellNum, SpatialHashGridKey(Grid), CurrentFrame, bEvicted, bClaimed, bFirstTouch);
+#else
+    bEvicted = false;
+    bClaimed = false;
+    bFirstTouch = false;
+    return SpatialHashGridHomeSlot(Grid, CellNum) + CascadeIndex * CellNum;
+#endif
+}
+
+/**
+ * Look up the radiance cache slot of a world-space position.
+ * With open addressing disabled this is the legacy modulo index and always succeeds.
+ */
+uint SpatialHashCascadeFind(float3 P, float RayLength, float BaseCellSize, uint CellNum, uint CascadeNum, float CascadeDistance, RWByteAddressBuffer Metadata)
+{
+    uint CascadeIndex;
+    int3 Grid;
+    SpatialHashCascadeGridCoord(P, RayLength, BaseCellSize, CascadeNum, CascadeDistance, CascadeIndex, Grid);
+    return SpatialHashGridFind(Grid, CascadeIndex, CellNum, Metadata);
+}
+
+/**
+ * Find or claim the radiance cache slot of a world-space position.
+ * With open addressing disabled this is the legacy modulo index and always succeeds.
+ */
+uint SpatialHashCascadeInsert(float3 P, float RayLength, float BaseCellSize, uint CellNum, uint CascadeNum, float CascadeDistance, RWByteAddressBuffer Metadata, uint CurrentFrame, out bool bEvicted, out bool bClaimed, out bool bFirstTouch)
+{
+    uint CascadeIndex;
+    int3 Grid;
+    SpatialHashCascadeGridCoord(P, RayLength, BaseCellSize, CascadeNum, CascadeDistance, CascadeIndex, Grid);
+    return SpatialHashGridInsert(Grid, CascadeIndex, CellNum, Metadata, CurrentFrame, bEvicted, bClaimed, bFirstTouch);
+}
+
 float3 GetSpatialHashVisualColor(uint Hash)
 {
     float3 color;
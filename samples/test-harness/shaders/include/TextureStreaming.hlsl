@@ -0,0 +1,74 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+// Note: you must include Descriptors.hlsl before this file
+
+#ifndef TEXTURE_STREAMING_HLSL
+#define TEXTURE_STREAMING_HLSL
+
+// ============================================================================
+// Texture Streaming Feedback
+// ============================================================================
+// With TEXTURE_STREAMING, texture samples record the resolution they need in the TextureFeedback buffer.
+// One uint per material texture index (see Direct3D12.cpp::CreateSceneMaterialsBuffer()):
+//   0:     the texture was not sampled this frame
+//   1 + n: the texture was sampled and needs a mip level of (at least) 2^n texels along its largest axis
+// The application reads the buffer back, streams in (or evicts) mip levels, and clears it every frame.
+
+// TEXTURE_STREAMING may be passed in as a define at shader compilation time (config scene.textureStreaming.enable).
+#ifndef TEXTURE_STREAMING
+#define TEXTURE_STREAMING 0
+#endif
+
+#define TEXTURE_STREAMING_MAX_LOG2 15
+#define TEXTURE_STREAMING_MAX_ANISOTROPY 16.f  // Matches the anisotropic sampler, see Direct3D12.cpp::CreateSamplers()
+
+/**
+ * Record that the texture needs 2^log2Resolution texels along its largest axis.
+ */
+void TextureFeedbackRecord(int texIdx, uint log2Resolution)
+{
+#if TEXTURE_STREAMING
+    RWByteAddressBuffer feedback = GetTextureFeedback();
+    uint address = (uint)texIdx * 4;
+    uint value = 1 + min(log2Resolution, TEXTURE_STREAMING_MAX_LOG2);
+
+    // Most samples of a texture request the same level, skip the atomic when it adds nothing
+    if (feedback.Load(address) < value) feedback.InterlockedMax(address, value);
+#endif
+}
+
+/**
+ * Record the resolution an anisotropic SampleGrad() with the given texture coordinate gradients needs.
+ */
+void TextureFeedbackRecordGrad(int texIdx, float2 dUVdx, float2 dUVdy)
+{
+#if TEXTURE_STREAMING
+    // The minor axis of the footprint selects the mip level, up to the max anisotropy
+    float major = max(length(dUVdx), length(dUVdy));
+    float minor = min(length(dUVdx), length(dUVdy));
+    float footprint = max(max(minor, major / TEXTURE_STREAMING_MAX_ANISOTROPY), 1e-6f);
+
+    TextureFeedbackRecord(texIdx, (uint)max(ceil(-log2(footprint)), 0.f));
+#endif
+}
+
+/**
+ * Record the resolution a SampleLevel() of the currently resident mip chain reads.
+ */
+void TextureFeedbackRecordLevel(int texIdx, uint width, uint height, float level)
+{
+#if TEXTURE_STREAMING
+    uint size = max(max(width, height) >> (uint)level, 1);
+    TextureFeedbackRecord(texIdx, firstbithigh(size));
+#endif
+}
+
+#endif // TEXTURE_STREAMING_HLSL
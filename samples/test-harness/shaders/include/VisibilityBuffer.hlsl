@@ -0,0 +1,141 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+// Note: you must include Descriptors.hlsl before this file
+
+#ifndef VISIBILITY_BUFFER_HLSL
+#define VISIBILITY_BUFFER_HLSL
+
+#include "RayTracing.hlsl"
+
+// ============================================================================
+// Visibility Buffer
+// ============================================================================
+// With GBUFFER_VISIBILITY, GBufferCS writes the primary ray hit's IDs to one 64-bit
+// target instead of the world position (GBufferB) and normal (GBufferC) targets:
+//   GBufferVisibility: x = primitive index
+//                      y = 12 bits instance index, 10 bits unused, 10 bits geometry index
+//                          (the HitPackedData::PrimitivePacked layout), GBUFFER_VISIBILITY_MISS for a miss
+// The primitive index is moved to its own 32 bits, HitPackedData's 10 bits are too few for scene meshes.
+// The barycentrics are not stored, the surface is reconstructed by intersecting the pixel's primary
+// ray with the triangle again. GBufferA (albedo, composite flags) and GBufferD (direct lighting) are
+// written in both modes.
+// GBufferLoad*() return the GBufferB/GBufferC values in either mode.
+
+// GBUFFER_VISIBILITY may be passed in as a define at shader compilation time (config app.visibilityBuffer).
+#ifndef GBUFFER_VISIBILITY
+#define GBUFFER_VISIBILITY 0
+#endif
+
+#define GBUFFER_VISIBILITY_MISS 0xFFFFFFFF
+
+uint2 VisibilityPack(uint instanceIndex, uint geometryIndex, uint primitiveIndex)
+{
+    return uint2(primitiveIndex, (instanceIndex & 0xFFF) | ((geometryIndex & 0x3FF) << 22));
+}
+
+/**
+ * Direction of the primary ray through the center of the pixel (not normalized, hit distances are in its units).
+ */
+float3 GetPrimaryRayDirection(uint2 pixel, uint2 dimensions)
+{
+    // Pixel coordinates, remapped to [-1, 1] with y-direction flipped to match world-space
+    // Camera basis, adjusted for the aspect ratio and vertical field of view
+    float  px = (((float)pixel.x + 0.5f) / (float)dimensions.x) * 2.f - 1.f;
+    float  py = (((float)pixel.y + 0.5f) / (float)dimensions.y) * -2.f + 1.f;
+    float3 right = GetCamera().aspect * GetCamera().tanHalfFovY * GetCamera().right;
+    float3 up = GetCamera().tanHalfFovY * GetCamera().up;
+
+    return (px * right) + (py * up) + GetCamera().forward;
+}
+
+#if GBUFFER_VISIBILITY
+/**
+ * Reconstructs the world position, hit distance, and (interpolated vertex) normal of the pixel's primary ray hit.
+ * Returns false for a miss, with the cleared GBuffer values (zero position and normal, -1 hit distance).
+ */
+bool VisibilityLoadSurface(uint2 pixel, out float4 worldPosHitT, out float3 normal)
+{
+    worldPosHitT = float4(0.f, 0.f, 0.f, -1.f);
+    normal = float3(0.f, 0.f, 0.f);
+
+    RWTexture2D<uint2> GBufferVisibility = GetGBufferVisibility();
+    uint2 visibility = GBufferVisibility.Load(pixel);
+    if (visibility.y == GBUFFER_VISIBILITY_MISS) return false;
+
+    uint2 dimensions = GetRenderResolution();
+
+    uint primitiveIndex = visibility.x;
+    uint instanceIndex = visibility.y & 0xFFF;
+    uint geometryIndex = (visibility.y >> 22) & 0x3FF;
+
+    TLASInstance instance = GetTLASInstances()[instanceIndex];
+    uint meshIndex = (instance.instanceID24_Mask8 & 0xFFFFFF);
+
+    // Load the triangle's vertices
+    GeometryData geometry;
+    GetGeometryData(meshIndex, geometryIndex, geometry);
+
+    Vertex vertices[3];
+    LoadVertices(meshIndex, primitiveIndex, geometry, vertices);
+
+    // Intersect the primary ray with the world-space triangle for the barycentrics and hit distance
+    float3 origin = GetCamera().position;
+    float3 direction = GetPrimaryRayDirection(pixel, dimensions);
+
+    float3 p0 = mul(instance.transform, float4(vertices[0].position, 1.f)).xyz;
+    float3 edge01 = mul(instance.transform, float4(vertices[1].position, 1.f)).xyz - p0;
+    float3 edge02 = mul(instance.transform, float4(vertices[2].position, 1.f)).xyz - p0;
+
+    float3 pvec = cross(direction, edge02);
+    float3 tvec = origin - p0;
+    float3 qvec = cross(tvec, edge01);
+    float  invDet = 1.f / dot(edge01, pvec);
+    float2 barycentrics = float2(dot(tvec, pvec), dot(direction, qvec)) * invDet;
+
+    // Interpolate the triangle's attributes for the hit location (see ShadeTriangleHitInternal())
+    Vertex v = InterpolateVertex(vertices, float3((1.f - barycentrics.x - barycentrics.y), barycentrics.x, barycentrics.y));
+
+    worldPosHitT.xyz = mul(instance.transform, float4(v.position, 1.f)).xyz;
+    worldPosHitT.w = dot(edge02, qvec) * invDet;
+    normal = normalize(mul(instance.transform, float4(v.normal, 0.f)).xyz);
+    return true;
+}
+#endif
+
+/**
+ * World position (xyz) and primary ray hit distance (w) of the pixel, the GBufferB layout.
+ */
+float4 GBufferLoadWorldPosHitT(uint2 pixel)
+{
+#if GBUFFER_VISIBILITY
+    float4 worldPosHitT;
+    float3 normal;
+    VisibilityLoadSurface(pixel, worldPosHitT, normal);
+    return worldPosHitT;
+#else
+    return GetRWTex2D(GBUFFERB_INDEX).Load(pixel);
+#endif
+}
+
+/**
+ * World position and hit distance (the GBufferB layout) and normal (GBufferC) of the pixel.
+ */
+void GBufferLoadSurface(uint2 pixel, out float4 worldPosHitT, out float3 normal)
+{
+#if GBUFFER_VISIBILITY
+    VisibilityLoadSurface(pixel, worldPosHitT, normal);
+#else
+    worldPosHitT = GetRWTex2D(GBUFFERB_INDEX).Load(pixel);
+    normal = GetRWTex2D(GBUFFERC_INDEX).Load(pixel).xyz;
+#endif
+}
+
+#endif // VISIBILITY_BUFFER_HLSL
@@ -17,6 +17,7 @@
  * - InterpolateVertex: Verify barycentric interpolation
  * - RayDiff: Verify ray differential computation
  * - PackData/UnpackData: Verify hit data packing/unpacking
+ * - PackR11G11B10/PackRGB9E5: Verify radiance cache storage formats
  *
  * Test results are written to an output buffer where:
  * - 0 = PASS
@@ -125,9 +126,12 @@ uint TestHitDataPacking()
     original.VolumeIndex = 5;         // 8 bits max
     original.PrimitiveIndex = 512;    // 10 bits max
     original.InstanceIndex = 2048;    // 12 bits max
-    original.GeometryIndex = 100;     // 10 bits max
+    original.GeometryIndex = 1000;    // 10 bits max (both layouts)
     original.Barycentrics = float2(0.3f, 0.4f);
     original.HitDistance = 25.5f;
+    original.GridCoord = int3(-42, 7, 100000);
+    original.CascadeIndex = 3;
+    original.Checksum = 0x9E3779B9;
 
     // Pack
     HitPackedData packed;
@@ -138,6 +142,7 @@ uint TestHitDataPacking()
     UnpackData(packed, unpacked);
 
     // Verify
+#if !HIT_CACHE_COMPACT
     if (unpacked.ProbeIndex != original.ProbeIndex)
     {
         return 10; // Test failed: ProbeIndex mismatch
@@ -152,6 +157,7 @@ uint TestHitDataPacking()
     {
         return 12; // Test failed: VolumeIndex mismatch
     }
+#endif
 
     if (unpacked.PrimitiveIndex != original.PrimitiveIndex)
     {
@@ -168,7 +174,7 @@ uint TestHitDataPacking()
         return 15; // Test failed: GeometryIndex mismatch
     }
 
-    // Note: Barycentrics use f16 conversion, so precision is reduced
+    // Note: Barycentrics use f16 (unorm16 with HIT_CACHE_COMPACT) conversion, so precision is reduced
     if (abs(unpacked.Barycentrics.x - original.Barycentrics.x) > 0.01f)
     {
         return 16; // Test failed: Barycentrics.x mismatch
@@ -179,6 +185,31 @@ uint TestHitDataPacking()
         return 17; // Test failed: Barycentrics.y mismatch
     }
 
+#if HIT_CACHE_COMPACT
+    // The compact layout stores the hit distance as f16
+    if (abs(unpacked.HitDistance - original.HitDistance) > 0.01f)
+    {
+        return 20; // Test failed: HitDistance mismatch
+    }
+
+    // Checksum must round trip exactly, it is the cell key in later passes
+    if (unpacked.Checksum != original.Checksum)
+    {
+        return 18; // Test failed: Checksum mismatch
+    }
+#else
+    // Grid coordinate must round trip exactly, it is the cell key in later passes
+    if (any(unpacked.GridCoord != original.GridCoord))
+    {
+        return 18; // Test failed: GridCoord mismatch
+    }
+#endif
+
+    if (unpacked.CascadeIndex != original.CascadeIndex)
+    {
+        return 19; // Test failed: CascadeIndex mismatch
+    }
+
     return 0; // All tests passed
 }
 
@@ -344,6 +375,43 @@ uint TestNormalization()
     return 0; // All tests passed
 }
 
+// ============================================================================
+// Test: Radiance Cache Storage Formats
+// ============================================================================
+
+uint TestRadiancePacking()
+{
+    // Both formats round to 6+ mantissa bits, compare with a relative tolerance
+    float3 radiance = float3(1.5f, 0.25f, 12.0f);
+
+    float3 r11g11b10 = UnpackR11G11B10(PackR11G11B10(radiance));
+    if (any(abs(r11g11b10 - radiance) > radiance * (1.0f / 32.0f)))
+    {
+        return 60; // Test failed: R11G11B10 round trip out of tolerance
+    }
+
+    float3 rgb9e5 = UnpackRGB9E5(PackRGB9E5(radiance));
+    if (any(abs(rgb9e5 - radiance) > max(radiance.r, max(radiance.g, radiance.b)) * (1.0f / 512.0f)))
+    {
+        return 61; // Test failed: RGB9E5 round trip out of tolerance
+    }
+
+    // Black must stay black
+    if (!Float3Equals(UnpackRGB9E5(PackRGB9E5(float3(0, 0, 0))), float3(0, 0, 0)) ||
+        !Float3Equals(UnpackR11G11B10(PackR11G11B10(float3(0, 0, 0))), float3(0, 0, 0)))
+    {
+        return 62; // Test failed: Black should stay black
+    }
+
+    // Negative input clamps to zero (neither format has a sign)
+    if (!Float3Equals(UnpackRGB9E5(PackRGB9E5(float3(-1, 0.5f, 0.5f))), float3(0, 0.5f, 0.5f)))
+    {
+        return 63; // Test failed: Negative channel should clamp to zero
+    }
+
+    return 0; // All tests passed
+}
+
 // ============================================================================
 // Main Test Entry Point
 // ============================================================================
@@ -384,6 +452,11 @@ void CS_RunAllTests(uint3 DispatchThreadID : SV_DispatchThreadID)
     TestResults[testIndex++] = result;
     if (result != 0) return;
 
+    // Test 6: Radiance Cache Storage Formats
+    result = TestRadiancePacking();
+    TestResults[testIndex++] = result;
+    if (result != 0) return;
+
     // All tests passed - write sentinel value
     TestResults[testIndex] = 0xFFFFFFFF;
 }
@@ -427,3 +500,9 @@ void CS_TestNormalization(uint3 DispatchThreadID : SV_DispatchThreadID)
 {
     TestResults[0] = TestNormalization();
 }
+
+[numthreads(1, 1, 1)]
+void CS_TestRadiancePacking(uint3 DispatchThreadID : SV_DispatchThreadID)
+{
+    TestResults[0] = TestRadiancePacking();
+}
@@ -9,21 +9,257 @@
 */
 
 #include "Benchmark.h"
+#include "Caches.h"
 
+#include <algorithm>
+#include <cmath>
 #include <filesystem>
+#include <fstream>
+#include <iomanip>
 
 namespace Benchmark
 {
+    //----------------------------------------------------------------------------------------------------------
+    // Private Functions
+    //----------------------------------------------------------------------------------------------------------
+
+    /**
+     * Summarize the samples of a stat. The benchmark resets the stats with NumBenchmarkFrames samples, so they cover the whole run.
+     */
+    StatSummary SummarizeStat(const Instrumentation::Stat& stat)
+    {
+        StatSummary summary;
+        if (stat.sampleCount == 0) return summary;
+
+        std::vector<double> sorted(stat.samples.begin(), stat.samples.begin() + stat.sampleCount);
+        std::sort(sorted.begin(), sorted.end());
+
+        size_t count = sorted.size();
+        auto percentile = [&](double p) { return sorted[static_cast<size_t>(p * (count - 1) + 0.5)]; };
+
+        double sum = 0;
+        for (double sample : sorted) sum += sample;
+        summary.mean = sum / count;
+
+        double variance = 0;
+        for (double sample : sorted) variance += (sample - summary.mean) * (sample - summary.mean);
+        summary.stdDev = std::sqrt(variance / count);
+
+        summary.min = sorted.front();
+        summary.max = sorted.back();
+        summary.p50 = percentile(0.5);
+        summary.p95 = percentile(0.95);
+        summary.p99 = percentile(0.99);
+
+        // Average the slowest 1% of the samples (at least one)
+        size_t lowCount = (std::max)(count / 100, (size_t)1);
+        double lowSum = 0;
+        for (size_t index = count - lowCount; index < count; index++) lowSum += sorted[index];
+        double lowMean = lowSum / lowCount;
+        summary.low1Fps = (lowMean > 0) ? (1000.0 / lowMean) : 0;
+
+        return summary;
+    }
+
+    /**
+     * Write the summaries of the stats as a JSON array.
+     */
+    void WriteStatSummaries(std::ofstream& json, const std::vector<Instrumentation::Stat*>& stats, bool& first)
+    {
+        for (const Instrumentation::Stat* stat : stats)
+        {
+            StatSummary summary = SummarizeStat(*stat);
+
+            // Stat names are indented for the UI hierarchy
+            std::string name = stat->name;
+            name.erase(0, name.find_first_not_of(' '));
+
+            std::string escaped;
+            for (char c : name)
+            {
+                if (c == '"' || c == '\\') escaped += '\\';
+                escaped += c;
+            }
+
+            if (!first) json << "," << std::endl;
+            first = false;
+
+            json << "    { \"name\": \"" << escaped << "\", \"type\": \"" << (stat->type == Instrumentation::EStatType::CPU ? "cpu" : "gpu") << "\"";
+            json << ", \"samples\": " << stat->sampleCount;
+            json << ", \"mean\": " << summary.mean << ", \"min\": " << summary.min << ", \"max\": " << summary.max;
+            json << ", \"p50\": " << summary.p50 << ", \"p95\": " << summary.p95 << ", \"p99\": " << summary.p99;
+            json << ", \"stdDev\": " << summary.stdDev << ", \"low1Fps\": " << summary.low1Fps << " }";
+        }
+    }
+
+    /**
+     * Clear the GPU counter totals of the benchmark run.
+     */
+    void ResetCounterTotals(BenchmarkRun& benchmarkRun)
+    {
+        benchmarkRun.numCounterFrames = 0;
+        benchmarkRun.lastCounterFrame = 0;
+        for (uint64_t& total : benchmarkRun.counterTotals) total = 0;
+        for (uint64_t& total : benchmarkRun.csInvocationTotals) total = 0;
+        benchmarkRun.radianceCacheCsv.str("");
+    }
+
+    /**
+     * Add the GPU counters to the run's totals, once for each frame read back.
+     */
+    void AccumulateCounters(BenchmarkRun& benchmarkRun, const Instrumentation::Counters& counters)
+    {
+        if (!counters.enabled || counters.frame == 0 || counters.frame == benchmarkRun.lastCounterFrame) return;
+
+        for (uint32_t counter = 0; counter < Instrumentation::COUNTER_COUNT; counter++) benchmarkRun.counterTotals[counter] += counters.values[counter];
+        for (uint32_t pass = 0; pass < Instrumentation::PASS_COUNT; pass++) benchmarkRun.csInvocationTotals[pass] += counters.csInvocations[pass];
+        benchmarkRun.lastCounterFrame = counters.frame;
+        benchmarkRun.numCounterFrames++;
+
+        // Make a row for the radiance cache occupancy
+        if (!counters.cacheCascades.empty())
+        {
+            Instrumentation::CacheCascadeStats totals = counters.GetCacheTotals();
+            std::stringstream& csv = benchmarkRun.radianceCacheCsv;
+            csv << counters.frame << "," << totals.occupied << "," << totals.live << "," << counters.GetCacheAverageAge() << "," << counters.GetCacheAverageProbeLength() << ",";
+            csv << totals.probeRays << "," << totals.coveredCells << "," << counters.GetCacheAmortization() << ",";
+            csv << counters.values[Instrumentation::CACHE_EVICTIONS] << "," << counters.values[Instrumentation::CACHE_COLLISIONS] << "," << counters.GetCacheLoadFactor() << ",";
+            for (int32_t cascade = 0; cascade < static_cast<int32_t>(counters.cacheCascades.size()); cascade++) csv << counters.GetCacheLoadFactor(cascade) << ",";
+            for (int32_t cascade = 0; cascade < static_cast<int32_t>(counters.cacheCascades.size()); cascade++) csv << counters.GetCacheAmortization(cascade) << ",";
+            csv << std::endl;
+        }
+    }
+
+    /**
+     * The per frame averages of the run's GPU counters (see AccumulateCounters()).
+     */
+    Instrumentation::Counters GetAverageCounters(const BenchmarkRun& benchmarkRun)
+    {
+        Instrumentation::Counters average;
+        average.enabled = (benchmarkRun.numCounterFrames > 0);
+        if (!average.enabled) return average;
+
+        average.frame = benchmarkRun.lastCounterFrame;
+        for (uint32_t counter = 0; counter < Instrumentation::COUNTER_COUNT; counter++)
+        {
+            average.values[counter] = static_cast<uint32_t>(benchmarkRun.counterTotals[counter] / benchmarkRun.numCounterFrames);
+        }
+        for (uint32_t pass = 0; pass < Instrumentation::PASS_COUNT; pass++)
+        {
+            average.csInvocations[pass] = benchmarkRun.csInvocationTotals[pass] / benchmarkRun.numCounterFrames;
+        }
+        return average;
+    }
+
+    /**
+     * Set the backend a ray tracing pass traces with.
+     */
+    void SetInlineRayTracing(Configs::Config& config, ERayTracingPass pass, bool inlineRayTracing)
+    {
+        if (pass == RT_PASS_GBUFFER) config.app.gbufferInlineRayTracing = inlineRayTracing;
+        else if (pass == RT_PASS_RTAO) config.rtao.useInlineRayTracing = inlineRayTracing;
+        else if (pass == RT_PASS_RADIANCE_CACHE) config.ddgi.useInlineRayTracing = inlineRayTracing;
+    }
+
+    /**
+     * Find the GPU stat of a pass by the name it was added with.
+     */
+    const Instrumentation::Stat* FindGPUStat(const Instrumentation::Performance& perf, const std::string& name)
+    {
+        for (const Instrumentation::Stat* stat : perf.gpuTimes)
+        {
+            if (stat->name == name) return stat;
+        }
+        return nullptr;
+    }
+
+    /**
+     * Hash the contents of a file (64-bit FNV-1a), as a hex string. Returns an empty string if the file can't be read.
+     */
+    std::string HashFile(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::in | std::ios::binary);
+        if (!file.is_open()) return "";
+
+        uint64_t hash = 14695981039346656037ull;
+        char buffer[65536];
+        while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0)
+        {
+            std::streamsize count = file.gcount();
+            for (std::streamsize index = 0; index < count; index++)
+            {
+                hash ^= static_cast<uint8_t>(buffer[index]);
+                hash *= 1099511628211ull;
+            }
+        }
+
+        std::stringstream hex;
+        hex << std::hex << std::setw(16) << std::setfill('0') << hash;
+        return hex.str();
+    }
+
+    /**
+     * Write the benchmark results in the baseline format: one "type,name,value" row per GPU stat (median ms) and per image (hash).
+     */
+    void WriteBaselineRows(std::ostream& csv, const std::vector<std::pair<std::string, double>>& gpuMedians, const std::vector<std::pair<std::string, std::string>>& imageHashes)
+    {
+        csv << "Type,Name,Value" << std::endl;
+        for (const auto& stat : gpuMedians) csv << "gpu," << stat.first << "," << stat.second << std::endl;
+        for (const auto& image : imageHashes) csv << "image," << image.first << "," << image.second << std::endl;
+    }
+
+    /**
+     * Read a baseline file (see WriteBaselineRows). Names may contain commas, the type and value can't.
+     */
+    bool ReadBaselineRows(const std::string& path, std::vector<std::pair<std::string, double>>& gpuMedians, std::vector<std::pair<std::string, std::string>>& imageHashes)
+    {
+        std::ifstream csv(path, std::ios::in);
+        if (!csv.is_open()) return false;
+
+        std::string line;
+        std::getline(csv, line); // Header
+        while (std::getline(csv, line))
+        {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+
+            size_t first = line.find(',');
+            size_t last = line.rfind(',');
+            if (first == std::string::npos || first == last) continue;
+
+            std::string type = line.substr(0, first);
+            std::string name = line.substr(first + 1, last - first - 1);
+            std::string value = line.substr(last + 1);
+            if (type == "gpu") gpuMedians.emplace_back(name, std::stod(value));
+            else if (type == "image") imageHashes.emplace_back(name, value);
+        }
+        return true;
+    }
+
+    const char* RayTracingPassNames[RT_PASS_COUNT] = { "GBuffer", "RTAO", "RadianceCache" };
+
+    // Names of the GPU stats the passes are timed with (the radiance cache shading stat is nested under DDGI)
+    const char* RayTracingPassStatNames[RT_PASS_COUNT] = { "GBuffer", "RTAO", "    Shade" };
+
+    //----------------------------------------------------------------------------------------------------------
+    // Public Functions
+    //----------------------------------------------------------------------------------------------------------
+
     void StartBenchmark(BenchmarkRun& benchmarkRun, Instrumentation::Performance& perf, Configs::Config& config, Graphics::Globals& gfx)
     {
         std::filesystem::create_directories(config.scene.screenshotPath.c_str());
 
+        benchmarkRun.numFrames = (std::max)(config.benchmark.frames, 1u);
+        benchmarkRun.numWarmupFrames = config.benchmark.warmupFrames;
+        benchmarkRun.numFramesWarmed = 0;
         benchmarkRun.numFramesBenched = 0;
+        ResetCounterTotals(benchmarkRun);
         benchmarkRun.cpuTimingCsv.str("");
         benchmarkRun.gpuTimingCsv.str("");
+        benchmarkRun.finished = false;
+        benchmarkRun.gpuMedians.clear();
 
-        // Clear timer history when starting benchmark mode
-        perf.Reset(NumBenchmarkFrames);
+        // Clear timer history when starting benchmark mode (and again after the warm up)
+        perf.Reset(benchmarkRun.numFrames);
         if (config.app.renderMode == ERenderMode::DDGI)
         {
             // Reload ddgi configs to reset the RNG state
@@ -35,15 +271,31 @@ namespace Benchmark
 
     bool UpdateBenchmark(BenchmarkRun& benchmarkRun, Instrumentation::Performance& perf, Configs::Config& config, Graphics::Globals& gfx, std::ofstream& log)
     {
-        config.app.benchmarkProgress = (uint32_t)(((float)benchmarkRun.numFramesBenched / (float)NumBenchmarkFrames) * 100.f);
+        // Render the warm up frames without recording them
+        if (benchmarkRun.numFramesWarmed < benchmarkRun.numWarmupFrames)
+        {
+            benchmarkRun.numFramesWarmed++;
+            if (benchmarkRun.numFramesWarmed == benchmarkRun.numWarmupFrames)
+            {
+                perf.Reset(benchmarkRun.numFrames);
+                ResetCounterTotals(benchmarkRun);
+            }
+            return false;
+        }
+
+        config.app.benchmarkProgress = (uint32_t)(((float)benchmarkRun.numFramesBenched / (float)benchmarkRun.numFrames) * 100.f);
+
+        // The path tracer ends the benchmark early once its accumulation has converged
+        bool converged = (config.app.renderMode == ERenderMode::PATH_TRACE && config.pathTrace.converged);
 
         // If the benchmark is currently running, make a row for the frame's timings
-        if(benchmarkRun.numFramesBenched < NumBenchmarkFrames)
+        if(benchmarkRun.numFramesBenched < benchmarkRun.numFrames && !converged)
         {
             benchmarkRun.cpuTimingCsv << gfx.frameNumber << ",";
             benchmarkRun.gpuTimingCsv << gfx.frameNumber << ",";
             benchmarkRun.cpuTimingCsv << perf.cpuTimes;
             benchmarkRun.gpuTimingCsv << perf.gpuTimes;
+            AccumulateCounters(benchmarkRun, perf.counters);
         }
         else
         {
@@ -105,18 +357,92 @@ namespace Benchmark
                 csv << gpuHeader << std::endl << benchmarkRun.gpuTimingCsv.str();
             }
             csv.close();
+
+            // Write the radiance cache occupancy to file
+            if (perf.counters.enabled && !perf.counters.cacheCascades.empty())
+            {
+                csv.open(config.scene.screenshotPath + "/benchmarkRadianceCache.csv", std::ios::out);
+                if (csv.is_open())
+                {
+                    csv << "FrameIndex,Occupied,Live,LiveAverageAge,LiveAverageProbeLength,ProbeRays,CoveredCells,ProbeRaysPerCell,Evictions,Collisions,LoadFactor,";
+                    for (size_t cascade = 0; cascade < perf.counters.cacheCascades.size(); cascade++) csv << "Cascade " << cascade << " LoadFactor,";
+                    for (size_t cascade = 0; cascade < perf.counters.cacheCascades.size(); cascade++) csv << "Cascade " << cascade << " ProbeRaysPerCell,";
+                    csv << std::endl << benchmarkRun.radianceCacheCsv.str();
+                }
+                csv.close();
+            }
+
+            // Per frame averages of the GPU counters, rays per second at the average GPU frame time
+            Instrumentation::Counters counters = GetAverageCounters(benchmarkRun);
+            double raysPerSecond = counters.GetRaysPerSecond(perf.gpuTimes[0]->average);
+
+            // Write the summary of every stat (milliseconds), for comparing runs against a baseline
+            std::ofstream json;
+            json.open(config.scene.screenshotPath + "/benchmarkSummary.json", std::ios::out);
+            if (json.is_open())
+            {
+                bool first = true;
+                json << "{" << std::endl;
+                json << "  \"frames\": " << benchmarkRun.numFramesBenched << "," << std::endl;
+                json << "  \"stats\": [" << std::endl;
+                WriteStatSummaries(json, perf.cpuTimes, first);
+                WriteStatSummaries(json, perf.gpuTimes, first);
+                json << std::endl << "  ]";
+                if (counters.enabled)
+                {
+                    json << "," << std::endl << "  \"counters\": {" << std::endl;
+                    json << "    \"frames\": " << benchmarkRun.numCounterFrames << "," << std::endl;
+                    json << "    \"raysPerSecond\": " << raysPerSecond << "," << std::endl;
+                    json << "    \"cacheHitRate\": " << counters.GetCacheHitRate();
+                    for (uint32_t counter = 0; counter < Instrumentation::COUNTER_COUNT; counter++)
+                    {
+                        json << "," << std::endl << "    \"" << Instrumentation::Counters::GetName((Instrumentation::ECounter)counter) << "\": " << counters.values[counter];
+                    }
+                    for (uint32_t pass = 0; pass < Instrumentation::PASS_COUNT; pass++)
+                    {
+                        json << "," << std::endl << "    \"" << Instrumentation::Counters::GetPassName((Instrumentation::ECounterPass)pass) << " CS Invocations\": " << counters.csInvocations[pass];
+                    }
+                    json << std::endl << "  }";
+                }
+                json << std::endl << "}" << std::endl;
+            }
+            json.close();
             log << "Wrote benchmark results to csv." << std::endl;
+            if (converged) log << "Path tracer converged after " << benchmarkRun.numFramesBenched << " frames." << std::endl;
 
             // Print averages to the log file
             log << "Benchmark Timings:" << std::endl;
             for (Instrumentation::Stat* stat : perf.cpuTimes)
             {
-                log << "\t" << stat->name << "=" << stat->average << "ms(CPU)" << std::endl;
+                log << "\t" << stat->name << "=" << stat->average << "ms(CPU)";
+                log << " p50=" << stat->GetPercentile(0.5) << " p95=" << stat->GetPercentile(0.95) << " p99=" << stat->GetPercentile(0.99) << std::endl;
             }
             for (Instrumentation::Stat* stat : perf.gpuTimes)
             {
-                log << "\t" << stat->name << "=" << stat->average << "ms(GPU)" << std::endl;
+                log << "\t" << stat->name << "=" << stat->average << "ms(GPU)";
+                log << " p50=" << stat->GetPercentile(0.5) << " p95=" << stat->GetPercentile(0.95) << " p99=" << stat->GetPercentile(0.99) << std::endl;
+            }
+            if (counters.enabled)
+            {
+                log << "Benchmark GPU Counters (per frame average of " << benchmarkRun.numCounterFrames << " frames):" << std::endl;
+                log << "\tRays=" << raysPerSecond << "/s Cache Hit Rate=" << (counters.GetCacheHitRate() * 100.0) << "%" << std::endl;
+                for (uint32_t counter = 0; counter < Instrumentation::COUNTER_COUNT; counter++)
+                {
+                    log << "\t" << Instrumentation::Counters::GetName((Instrumentation::ECounter)counter) << "=" << counters.values[counter] << std::endl;
+                }
+                for (uint32_t pass = 0; pass < Instrumentation::PASS_COUNT; pass++)
+                {
+                    log << "\t" << Instrumentation::Counters::GetPassName((Instrumentation::ECounterPass)pass) << " CS Invocations=" << counters.csInvocations[pass] << std::endl;
+                }
+            }
+
+            // Keep the median GPU times for the baseline comparison (see CompareToBaseline)
+            benchmarkRun.gpuMedians.clear();
+            for (const Instrumentation::Stat* stat : perf.gpuTimes)
+            {
+                benchmarkRun.gpuMedians.emplace_back(stat->name, SummarizeStat(*stat).p50);
             }
+            benchmarkRun.finished = true;
 
             config.app.benchmarkRunning = false;
             return true;
@@ -125,4 +451,284 @@ namespace Benchmark
         benchmarkRun.numFramesBenched++;
         return false;
     }
+
+    /**
+     * Move the active camera along the benchmark's camera spline (a Catmull-Rom spline through the keyframes).
+     * The camera follows the spline over the benchmarked frames and stays at the first keyframe during the warm up.
+     * Returns true if the camera moved.
+     */
+    bool UpdateBenchmarkCamera(const BenchmarkRun& benchmarkRun, const Configs::Config& config, Scenes::Scene& scene)
+    {
+        const std::vector<Configs::BenchmarkKeyframe>& keyframes = config.benchmark.keyframes;
+        if (keyframes.empty() || scene.cameras.empty()) return false;
+
+        // Find the spline segment of the frame
+        float t = 0.f;
+        if (benchmarkRun.numFramesWarmed >= benchmarkRun.numWarmupFrames && benchmarkRun.numFrames > 1)
+        {
+            t = (float)(std::min)(benchmarkRun.numFramesBenched, benchmarkRun.numFrames - 1) / (float)(benchmarkRun.numFrames - 1);
+        }
+
+        int lastKeyframe = static_cast<int>(keyframes.size()) - 1;
+        float position = t * (float)lastKeyframe;
+        int segment = (std::min)(static_cast<int>(position), (std::max)(lastKeyframe - 1, 0));
+        float s = position - (float)segment;
+
+        // The spline passes through the first and last keyframes, the end points are repeated
+        auto keyframe = [&](int index) -> const Configs::BenchmarkKeyframe& { return keyframes[(std::max)(0, (std::min)(index, lastKeyframe))]; };
+        const Configs::BenchmarkKeyframe& k0 = keyframe(segment - 1);
+        const Configs::BenchmarkKeyframe& k1 = keyframe(segment);
+        const Configs::BenchmarkKeyframe& k2 = keyframe(segment + 1);
+        const Configs::BenchmarkKeyframe& k3 = keyframe(segment + 2);
+
+        XMFLOAT3 cameraPosition;
+        XMStoreFloat3(&cameraPosition, XMVectorCatmullRom(XMLoadFloat3(&k0.position), XMLoadFloat3(&k1.position), XMLoadFloat3(&k2.position), XMLoadFloat3(&k3.position), s));
+
+        XMFLOAT2 rotation;
+        XMStoreFloat2(&rotation, XMVectorCatmullRom(XMVectorSet(k0.yaw, k0.pitch, 0.f, 0.f), XMVectorSet(k1.yaw, k1.pitch, 0.f, 0.f), XMVectorSet(k2.yaw, k2.pitch, 0.f, 0.f), XMVectorSet(k3.yaw, k3.pitch, 0.f, 0.f), s));
+
+        Scenes::Camera& camera = scene.cameras[scene.activeCamera];
+        camera.data.position = { cameraPosition.x, cameraPosition.y, cameraPosition.z };
+        camera.yaw = rotation.x;
+        camera.pitch = rotation.y;
+        Scenes::UpdateCamera(camera);
+
+        return true;
+    }
+
+    /**
+     * Select the ray tracing backend of the GBuffer, RTAO, and radiance cache shading passes.
+     * An automatic selection loads the backends measured on this GPU and driver from the shader cache directory,
+     * or measures them over the first frames when there is no cached selection.
+     */
+    /**
+     * Compare the results of a finished headless benchmark against the config's baseline (<baselines>/<config>.csv).
+     * A pass regresses when its median GPU time exceeds the baseline's by more than the tolerance (percent) and BaselineToleranceMs.
+     * Image hashes of the stored images are compared too, and fail the comparison with --compare-images.
+     * A missing baseline (or --update-baselines) is written from the results instead. Returns false if the benchmark regressed.
+     * Call after the graphics cleanup, so the images stored at the end of the benchmark are on disk.
+     */
+    bool CompareToBaseline(const BenchmarkRun& benchmarkRun, const Configs::Config& config, std::ofstream& log)
+    {
+        if (!benchmarkRun.finished) return true;
+
+        // Hash the images stored at the end of the benchmark
+        std::vector<std::pair<std::string, std::string>> imageHashes;
+        std::error_code error;
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(config.scene.screenshotPath, error))
+        {
+            if (!entry.is_regular_file()) continue;
+            std::string extension = entry.path().extension().string();
+            if (extension != ".png" && extension != ".hdr" && extension != ".exr") continue;
+            imageHashes.emplace_back(entry.path().filename().string(), HashFile(entry.path()));
+        }
+        std::sort(imageHashes.begin(), imageHashes.end());
+
+        // Write the results next to the benchmark's other output, in the baseline format
+        std::ofstream csv;
+        csv.open(config.scene.screenshotPath + "/benchmarkResults.csv", std::ios::out);
+        if (csv.is_open()) WriteBaselineRows(csv, benchmarkRun.gpuMedians, imageHashes);
+        csv.close();
+
+        if (config.benchmark.baselines.empty()) return true;
+
+        std::string configName = std::filesystem::path(config.app.filepath).stem().string();
+        std::string baselinePath = config.benchmark.baselines + "/" + configName + ".csv";
+
+        // Record the baseline
+        std::vector<std::pair<std::string, double>> baselineMedians;
+        std::vector<std::pair<std::string, std::string>> baselineHashes;
+        if (config.benchmark.updateBaselines || !ReadBaselineRows(baselinePath, baselineMedians, baselineHashes))
+        {
+            std::filesystem::create_directories(config.benchmark.baselines, error);
+            csv.open(baselinePath, std::ios::out);
+            if (!csv.is_open())
+            {
+                log << "\nError: failed to write the benchmark baseline " << baselinePath << "\n";
+                return false;
+            }
+            WriteBaselineRows(csv, benchmarkRun.gpuMedians, imageHashes);
+            csv.close();
+            log << "Wrote the benchmark baseline " << baselinePath << std::endl;
+            return true;
+        }
+
+        // Compare the GPU times
+        bool passed = true;
+        log << "Benchmark Baseline (" << baselinePath << ", tolerance " << config.benchmark.tolerance << "%):" << std::endl;
+        for (const auto& baseline : baselineMedians)
+        {
+            std::string name = baseline.first;
+            name.erase(0, name.find_first_not_of(' '));
+
+            auto result = std::find_if(benchmarkRun.gpuMedians.begin(), benchmarkRun.gpuMedians.end(), [&](const auto& stat) { return stat.first == baseline.first; });
+            if (result == benchmarkRun.gpuMedians.end())
+            {
+                log << "\t" << name << " is not timed anymore" << std::endl;
+                continue;
+            }
+
+            double delta = result->second - baseline.second;
+            double percent = (baseline.second > 0) ? (delta / baseline.second) * 100.0 : 0.0;
+            bool regressed = (percent > config.benchmark.tolerance) && (delta > BaselineToleranceMs);
+            log << "\t" << name << "=" << result->second << "ms baseline=" << baseline.second << "ms (" << (percent >= 0 ? "+" : "") << percent << "%)";
+            log << (regressed ? " REGRESSED" : "") << std::endl;
+            if (regressed) passed = false;
+        }
+
+        // Compare the image hashes
+        for (const auto& baseline : baselineHashes)
+        {
+            auto result = std::find_if(imageHashes.begin(), imageHashes.end(), [&](const auto& image) { return image.first == baseline.first; });
+            if (result != imageHashes.end() && result->second == baseline.second) continue;
+
+            log << "\t" << baseline.first << (result == imageHashes.end() ? " is missing" : " differs from the baseline") << std::endl;
+            if (config.benchmark.compareImages) passed = false;
+        }
+
+        log << (passed ? "Benchmark matches the baseline." : "Benchmark regressed against the baseline!") << std::endl;
+        return passed;
+    }
+
+    void StartBackendSelection(BackendSelection& selection, Configs::Config& config, std::ofstream& log)
+    {
+        selection = BackendSelection();
+        selection.defaultInline[RT_PASS_GBUFFER] = config.app.gbufferInlineRayTracing;
+        selection.defaultInline[RT_PASS_RTAO] = config.rtao.useInlineRayTracing;
+        selection.defaultInline[RT_PASS_RADIANCE_CACHE] = config.ddgi.useInlineRayTracing;
+
+        if (config.app.rayTracingBackend != RT_BACKEND_AUTO)
+        {
+            bool inlineRayTracing = (config.app.rayTracingBackend == RT_BACKEND_INLINE);
+            for (uint32_t pass = 0; pass < RT_PASS_COUNT; pass++) SetInlineRayTracing(config, static_cast<ERayTracingPass>(pass), inlineRayTracing);
+            return;
+        }
+
+        // The selection is specific to the graphics API, GPU, driver, and the GBuffer features that change the passes' work
+        uint64_t key = Caches::Hash(config.app.api.data(), config.app.api.size());
+        key = Caches::Hash(config.app.gpuName.data(), config.app.gpuName.size(), key);
+        key = Caches::Hash(&config.app.gpuDriverVersion, sizeof(config.app.gpuDriverVersion), key);
+        bool features[] = { config.app.visibilityBuffer, config.app.gbufferTiles, config.scene.textureStreaming, config.rtao.temporal };
+        key = Caches::Hash(features, sizeof(features), key);
+
+        std::stringstream path;
+        path << config.app.root << "shadercache/rtbackends-" << std::hex << key << ".txt";
+        selection.cachePath = path.str();
+
+        // Load the cached selection, one "pass=backend" line per pass
+        std::ifstream in(selection.cachePath);
+        if (in.is_open())
+        {
+            uint32_t numLoaded = 0;
+            std::string line;
+            while (std::getline(in, line))
+            {
+                size_t separator = line.find('=');
+                if (separator == std::string::npos) continue;
+                std::string name = line.substr(0, separator);
+                std::string backend = line.substr(separator + 1);
+                for (uint32_t pass = 0; pass < RT_PASS_COUNT; pass++)
+                {
+                    if (name != RayTracingPassNames[pass]) continue;
+                    SetInlineRayTracing(config, static_cast<ERayTracingPass>(pass), (backend == "inline"));
+                    numLoaded++;
+                }
+            }
+
+            if (numLoaded == RT_PASS_COUNT)
+            {
+                log << "Ray tracing backends: GBuffer " << (config.app.gbufferInlineRayTracing ? "inline" : "pipeline");
+                log << ", RTAO " << (config.rtao.useInlineRayTracing ? "inline" : "pipeline");
+                log << ", RadianceCache " << (config.ddgi.useInlineRayTracing ? "inline" : "pipeline") << " (cached)\n";
+                return;
+            }
+        }
+
+        // Measure the ray tracing pipeline first, then inline ray tracing
+        for (uint32_t pass = 0; pass < RT_PASS_COUNT; pass++) SetInlineRayTracing(config, static_cast<ERayTracingPass>(pass), false);
+        selection.running = true;
+        log << "Ray tracing backends: measuring...\n";
+    }
+
+    /**
+     * Sample the GPU times of the ray tracing passes with the backend being measured. Call once per frame, after the timestamps are read back.
+     * Once both backends are measured, each pass keeps the faster backend and the selection is written to the cache.
+     */
+    void UpdateBackendSelection(BackendSelection& selection, const Instrumentation::Performance& perf, Configs::Config& config, std::ofstream& log)
+    {
+        if (!selection.running) return;
+
+        // Only DDGI frames render both passes, and a benchmark run measures the backends it was started with
+        if (config.app.renderMode != ERenderMode::DDGI || config.app.benchmarkRunning) return;
+
+        const uint32_t numPhaseFrames = BackendSelection::NumWarmupFrames + BackendSelection::NumSampleFrames;
+        uint32_t backend = (selection.frame / numPhaseFrames);
+        if ((selection.frame % numPhaseFrames) >= BackendSelection::NumWarmupFrames)
+        {
+            for (uint32_t pass = 0; pass < RT_PASS_COUNT; pass++)
+            {
+                // Disabled RTAO still records (empty) timestamps
+                if (pass == RT_PASS_RTAO && !config.rtao.enabled) continue;
+
+                const Instrumentation::Stat* stat = FindGPUStat(perf, RayTracingPassStatNames[pass]);
+                if (stat == nullptr || stat->elapsed <= 0) continue;
+
+                selection.gpuTimeTotals[pass][backend] += stat->elapsed;
+                selection.numSamples[pass][backend]++;
+            }
+        }
+
+        selection.frame++;
+        if (selection.frame == numPhaseFrames)
+        {
+            for (uint32_t pass = 0; pass < RT_PASS_COUNT; pass++) SetInlineRayTracing(config, static_cast<ERayTracingPass>(pass), true);
+            return;
+        }
+        if (selection.frame < (numPhaseFrames * 2)) return;
+
+        // Keep the faster backend of each pass, inline ray tracing on a tie
+        selection.running = false;
+
+        bool complete = true;
+        std::stringstream cache;
+        log << "Ray tracing backends:";
+        for (uint32_t pass = 0; pass < RT_PASS_COUNT; pass++)
+        {
+            ERayTracingPass rtPass = static_cast<ERayTracingPass>(pass);
+
+            // A pass without a GPU stat doesn't run on this graphics API (the radiance cache is D3D12 only), keep its config backend
+            if (FindGPUStat(perf, RayTracingPassStatNames[pass]) == nullptr)
+            {
+                SetInlineRayTracing(config, rtPass, selection.defaultInline[pass]);
+                cache << RayTracingPassNames[pass] << "=" << (selection.defaultInline[pass] ? "inline" : "pipeline") << "\n";
+                log << "\n\t" << RayTracingPassNames[pass] << ": not available, " << (selection.defaultInline[pass] ? "inline" : "pipeline");
+                continue;
+            }
+
+            if (selection.numSamples[pass][0] == 0 || selection.numSamples[pass][1] == 0)
+            {
+                complete = false;
+                SetInlineRayTracing(config, rtPass, selection.defaultInline[pass]);
+                log << "\n\t" << RayTracingPassNames[pass] << ": not measured, " << (selection.defaultInline[pass] ? "inline" : "pipeline");
+                continue;
+            }
+
+            double pipelineTime = selection.gpuTimeTotals[pass][0] / selection.numSamples[pass][0];
+            double inlineTime = selection.gpuTimeTotals[pass][1] / selection.numSamples[pass][1];
+            bool inlineRayTracing = (inlineTime <= pipelineTime);
+            SetInlineRayTracing(config, rtPass, inlineRayTracing);
+
+            cache << RayTracingPassNames[pass] << "=" << (inlineRayTracing ? "inline" : "pipeline") << "\n";
+            log << "\n\t" << RayTracingPassNames[pass] << ": pipeline " << pipelineTime << " ms, inline " << inlineTime << " ms, " << (inlineRayTracing ? "inline" : "pipeline");
+        }
+        log << "\n";
+
+        // Cache only complete selections, an unmeasured pass is measured again on the next run
+        if (!complete) return;
+
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::path(selection.cachePath).parent_path(), ec);
+        std::ofstream out(selection.cachePath, std::ios::trunc);
+        if (out.is_open()) out << cache.str();
+    }
 }
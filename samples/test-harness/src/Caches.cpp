@@ -9,14 +9,84 @@
 */
 
 #include "Caches.h"
+#include "Jobs.h"
+
+#include <atomic>
+#include <filesystem>
+
+#if __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <DirectXPackedVector.h>
 
 using namespace DirectX;
 
-#define SCENE_CACHE_VERSION 4
+#define SCENE_CACHE_VERSION 12
+#define SCENE_CACHE_BLOB_ALIGNMENT 4096
+#define DDGI_VOLUME_CACHE_VERSION 1
+#define RADIANCE_CACHE_FILE_VERSION 1
 
 namespace Caches
 {
 
+    //----------------------------------------------------------------------------------------------------------
+    // Geometry Coding
+    //----------------------------------------------------------------------------------------------------------
+
+    // Mesh geometry is stored as streams of 32-bit words, each word delta coded against the same word of the previous
+    // element (stride words back), zigzag mapped, and written as a LEB128 varint. Quantized vertices and indices in
+    // vertex cache order change little from one element to the next, so most words take one or two bytes.
+
+    /**
+     * Encode a stream of 32-bit words with elements of stride words.
+     */
+    void EncodeWords(const uint32_t* words, uint64_t numWords, uint32_t stride, std::vector<uint8_t>& encoded)
+    {
+        encoded.clear();
+        encoded.reserve(numWords * 2);
+        for (uint64_t wordIndex = 0; wordIndex < numWords; wordIndex++)
+        {
+            uint32_t previous = (wordIndex >= stride) ? words[wordIndex - stride] : 0;
+            int32_t delta = static_cast<int32_t>(words[wordIndex] - previous);
+            uint32_t value = (static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31);
+            while (value >= 0x80)
+            {
+                encoded.push_back(static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            encoded.push_back(static_cast<uint8_t>(value));
+        }
+    }
+
+    /**
+     * Decode a stream of 32-bit words encoded by EncodeWords(), returns false if the data is truncated or corrupt.
+     */
+    bool DecodeWords(const uint8_t* encoded, uint64_t size, uint32_t stride, uint32_t* words, uint64_t numWords)
+    {
+        const uint8_t* end = encoded + size;
+        for (uint64_t wordIndex = 0; wordIndex < numWords; wordIndex++)
+        {
+            uint32_t value = 0;
+            uint32_t shift = 0;
+            while (true)
+            {
+                if (encoded == end || shift > 28) return false;
+                uint8_t byte = *encoded++;
+                value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) break;
+                shift += 7;
+            }
+
+            uint32_t previous = (wordIndex >= stride) ? words[wordIndex - stride] : 0;
+            words[wordIndex] = previous + ((value >> 1) ^ (0u - (value & 1)));
+        }
+        return (encoded == end);
+    }
+
     //----------------------------------------------------------------------------------------------------------
     // Private Deserialization Functions
     //----------------------------------------------------------------------------------------------------------
@@ -33,26 +103,48 @@ namespace Caches
         in.seekg(in.tellg());
     }
 
-    void ReadTexture(std::ifstream& in, Textures::Texture& texture)
+    // Scene cache files are memory mapped, reads advance a cursor through the mapped view
+    struct MappedReader
     {
-        // Texture name
-        uint32_t numChars;
-        Read(in, &numChars);
+        uint8_t* data = nullptr;
+        uint64_t size = 0;
+        uint64_t offset = 0;
+        bool good = true;
+    };
 
-        char* buffer = new char[numChars];
-        in.read(buffer, numChars);
-        in.seekg(in.tellg());
-        texture.name = std::string(buffer);
-        delete[] buffer;
+    void Read(MappedReader& in, void* value, size_t size = sizeof(uint32_t))
+    {
+        if (!in.good || (in.offset + size) > in.size) { in.good = false; return; }
+        memcpy(value, in.data + in.offset, size);
+        in.offset += size;
+    }
 
-        // Texture filepath
+    void Read(MappedReader& in, std::string& value)
+    {
+        uint32_t numChars = 0;
         Read(in, &numChars);
+        if (!in.good || numChars == 0 || (in.offset + numChars) > in.size) { in.good = false; return; }
+        value = std::string(reinterpret_cast<const char*>(in.data + in.offset));
+        in.offset += numChars;
+    }
 
-        buffer = new char[numChars];
-        in.read(buffer, numChars);
-        in.seekg(in.tellg());
-        texture.filepath = std::string(buffer);
-        delete[] buffer;
+    /**
+     * Read a blob reference (file offset and size) and return a pointer to the blob in the mapped view.
+     */
+    uint8_t* ReadBlob(MappedReader& in, uint64_t& size)
+    {
+        uint64_t offset = 0;
+        Read(in, &offset, sizeof(uint64_t));
+        Read(in, &size, sizeof(uint64_t));
+        if (!in.good || (offset + size) > in.size) { in.good = false; return nullptr; }
+        return in.data + offset;
+    }
+
+    void ReadTexture(MappedReader& in, Textures::Texture& texture)
+    {
+        // Texture name and filepath
+        Read(in, texture.name);
+        Read(in, texture.filepath);
 
         // Texture metadata
         Read(in, &texture.type, sizeof(Textures::ETextureType));
@@ -61,40 +153,44 @@ namespace Caches
         Read(in, &texture.height);
         Read(in, &texture.stride);
         Read(in, &texture.mips);
-        Read(in, &texture.texelBytes, sizeof(uint64_t));
-
-        texture.texels = new uint8_t[texture.texelBytes];
-        memset(texture.texels, 0, texture.texelBytes);
-        Read(in, texture.texels, texture.texelBytes);
+        Read(in, &texture.sourceStamp, sizeof(uint64_t));
+        Read(in, &texture.sourceHash, sizeof(uint64_t));
 
+        // The texels are not copied, they point into the mapped view
+        texture.texels = ReadBlob(in, texture.texelBytes);
+        texture.mapped = true;
         texture.cached = true;
     }
 
-    void ReadMaterial(std::ifstream& in, Scenes::Material& material)
+    void ReadMaterial(MappedReader& in, Scenes::Material& material)
     {
-        uint32_t numChars = 0;
-        Read(in, &numChars);
-
-        char* buffer = new char[numChars];
-        in.read(buffer, numChars);
-        in.seekg(in.tellg());
-        material.name = std::string(buffer);
-        delete[] buffer;
-
+        Read(in, material.name);
         Read(in, &material.data, material.GetGPUDataSize());
     }
 
-    void ReadMesh(std::ifstream& in, Scenes::Mesh& mesh)
+    /**
+     * Read an encoded geometry blob reference and its word count, then size the destination and queue its decode.
+     */
+    template<typename T>
+    void ReadGeometryBlob(MappedReader& in, uint32_t stride, std::vector<T>& destination, std::vector<std::function<void()>>& decodes, std::atomic<bool>& decoded)
     {
-        uint32_t numChars = 0;
-        Read(in, &numChars);
-
-        char* buffer = new char[numChars];
-        in.read(buffer, numChars);
-        in.seekg(in.tellg());
-        mesh.name = std::string(buffer);
-        delete[] buffer;
+        uint64_t numWords = 0;
+        uint64_t size = 0;
+        Read(in, &numWords, sizeof(uint64_t));
+        const uint8_t* encoded = ReadBlob(in, size);
+        if (!in.good || (numWords % (sizeof(T) / sizeof(uint32_t))) != 0) { in.good = false; return; }
+
+        destination.resize(numWords / (sizeof(T) / sizeof(uint32_t)));
+        uint32_t* words = reinterpret_cast<uint32_t*>(destination.data());
+        decodes.push_back([encoded, size, stride, words, numWords, &decoded]()
+        {
+            if (!DecodeWords(encoded, size, stride, words, numWords)) decoded = false;
+        });
+    }
 
+    void ReadMesh(MappedReader& in, Scenes::Mesh& mesh, std::vector<std::function<void()>>& decodes, std::atomic<bool>& decoded)
+    {
+        Read(in, mesh.name);
         Read(in, &mesh.index, sizeof(uint32_t));
         Read(in, &mesh.numIndices, sizeof(uint32_t));
         Read(in, &mesh.numVertices, sizeof(uint32_t));
@@ -103,14 +199,12 @@ namespace Caches
         Read(in, &mesh.boundingBox, sizeof(rtxgi::AABB));
 
         // Read MeshPrimitives
-        uint32_t numPrimitives;
+        uint32_t numPrimitives = 0;
         Read(in, &numPrimitives);
+        if (!in.good) return;
         mesh.primitives.resize(numPrimitives);
         for (uint32_t primitiveIndex = 0; primitiveIndex < numPrimitives; primitiveIndex++)
         {
-            uint32_t numVertices = 0;
-            uint32_t numIndices = 0;
-
             Scenes::MeshPrimitive& mp = mesh.primitives[primitiveIndex];
 
             // Read the mesh primitive data
@@ -120,15 +214,14 @@ namespace Caches
             Read(in, &mp.doubleSided, sizeof(bool));
             Read(in, &mp.indexByteOffset, sizeof(uint32_t));
             Read(in, &mp.vertexByteOffset, sizeof(uint32_t));
+            Read(in, &mp.hash, sizeof(uint64_t));
             Read(in, &mp.boundingBox, sizeof(rtxgi::AABB)); // post-transform bounding box
 
-            Read(in, &numVertices);
-            mp.vertices.resize(numVertices);
-            Read(in, mp.vertices.data(), sizeof(Graphics::Vertex) * numVertices);
-
-            Read(in, &numIndices);
-            mp.indices.resize(numIndices);
-            Read(in, mp.indices.data(), sizeof(uint32_t) * numIndices);
+            // Queue the decode of the vertex, index, and vertex albedo blobs from the mapped view
+            ReadGeometryBlob(in, sizeof(Graphics::PackedVertex) / sizeof(uint32_t), mp.packedVertices, decodes, decoded);
+            ReadGeometryBlob(in, 1, mp.indices, decodes, decoded);
+            ReadGeometryBlob(in, 1, mp.vertexAlbedos, decodes, decoded);
+            if (!in.good) return;
 
             // Update the mesh bounding box
             mesh.boundingBox.min = { fmin(mesh.boundingBox.min.x, mp.boundingBox.min.x), fmin(mesh.boundingBox.min.y, mp.boundingBox.min.y) };
@@ -136,51 +229,51 @@ namespace Caches
         }
     }
 
-    void ReadMeshInstance(std::ifstream& in, Scenes::MeshInstance& instance)
+    void ReadSourceFile(MappedReader& in, Scenes::SourceFile& source)
     {
-        uint32_t numChars = 0;
-        Read(in, &numChars);
-
-        char* buffer = new char[numChars];
-        in.read(buffer, numChars);
-        in.seekg(in.tellg());
-        instance.name = std::string(buffer);
-        delete[] buffer;
+        Read(in, source.filepath);
+        Read(in, &source.stamp, sizeof(uint64_t));
+        Read(in, &source.hash, sizeof(uint64_t));
+    }
 
+    void ReadMeshInstance(MappedReader& in, Scenes::MeshInstance& instance)
+    {
+        Read(in, instance.name);
         Read(in, &instance.meshIndex, sizeof(int));
         Read(in, &instance.boundingBox, sizeof(rtxgi::AABB));
         Read(in, &instance.transform, sizeof(float) * 12);
     }
 
-    void ReadLight(std::ifstream& in, Scenes::Light& light)
+    void ReadLight(MappedReader& in, Scenes::Light& light)
     {
-        uint32_t numChars = 0;
-        Read(in, &numChars);
-
-        char* buffer = new char[numChars];
-        in.read(buffer, numChars);
-        in.seekg(in.tellg());
-        light.name = std::string(buffer);
-        delete[] buffer;
-
+        Read(in, light.name);
         Read(in, &light.data, light.GetGPUDataSize());
     }
 
-    void ReadCamera(std::ifstream& in, Scenes::Camera& camera)
+    void ReadCamera(MappedReader& in, Scenes::Camera& camera)
     {
-        uint32_t numChars = 0;
-        Read(in, &numChars);
+        Read(in, camera.name);
+        Read(in, &camera.data, camera.GetGPUDataSize());
+    }
 
-        char* buffer = new char[numChars];
-        in.read(buffer, numChars);
-        in.seekg(in.tellg());
-        camera.name = std::string(buffer);
-        delete[] buffer;
+    bool ReadDDGIVolumeTexture(std::ifstream& in, DDGIVolumeCacheTexture& texture)
+    {
+        Read(in, &texture.format);
+        Read(in, &texture.width);
+        Read(in, &texture.height);
+        Read(in, &texture.arraySize);
+        Read(in, &texture.rowBytes);
 
-        Read(in, &camera.data, camera.GetGPUDataSize());
+        uint64_t texelBytes = 0;
+        Read(in, &texelBytes, sizeof(uint64_t));
+        if (!in.good() || texelBytes != (static_cast<uint64_t>(texture.rowBytes) * texture.height * texture.arraySize)) return false;
+
+        texture.texels.resize(texelBytes);
+        Read(in, texture.texels.data(), texelBytes);
+        return in.good();
     }
 
-    void ReadSceneNode(std::ifstream& in, Scenes::SceneNode& node)
+    void ReadSceneNode(MappedReader& in, Scenes::SceneNode& node)
     {
         Read(in, &node.instance, sizeof(int));
         Read(in, &node.camera, sizeof(int));
@@ -189,14 +282,70 @@ namespace Caches
         Read(in, &node.scale, sizeof(XMFLOAT3));
 
         // Read child node indices
-        uint32_t numChildren;
+        uint32_t numChildren = 0;
         Read(in, &numChildren);
-        if (numChildren <= 0) return;
+        if (!in.good || numChildren <= 0) return;
 
         node.children.resize(numChildren);
         Read(in, node.children.data(), (sizeof(int) * numChildren));
     }
 
+    /**
+     * Memory map a file (copy-on-write, writes are not stored to the file).
+     */
+    bool MapFile(const std::string& filepath, uint8_t** data, uint64_t* size)
+    {
+    #if defined(_WIN32) || defined(WIN32)
+        HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER fileSize = {};
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        // The view keeps the file mapping open, the handles are not needed after mapping
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping == nullptr) return false;
+
+        void* view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+        CloseHandle(mapping);
+        if (view == nullptr) return false;
+
+        *size = static_cast<uint64_t>(fileSize.QuadPart);
+    #elif __linux__
+        int file = open(filepath.c_str(), O_RDONLY);
+        if (file < 0) return false;
+
+        struct stat fileStat = {};
+        if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0)
+        {
+            close(file);
+            return false;
+        }
+
+        void* view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+        close(file);
+        if (view == MAP_FAILED) return false;
+
+        *size = static_cast<uint64_t>(fileStat.st_size);
+    #endif
+        *data = static_cast<uint8_t*>(view);
+        return true;
+    }
+
+    void UnmapFile(uint8_t* data, uint64_t size)
+    {
+    #if defined(_WIN32) || defined(WIN32)
+        UnmapViewOfFile(data);
+    #elif __linux__
+        munmap(data, static_cast<size_t>(size));
+    #endif
+    }
+
     //----------------------------------------------------------------------------------------------------------
     // Private Serialization Functions
     //----------------------------------------------------------------------------------------------------------
@@ -207,7 +356,52 @@ namespace Caches
         out.seekp(out.tellp());
     }
 
-    void WriteTexture(std::ofstream& out, Textures::Texture& texture)
+    // A large data block written after the scene description, page-aligned so it can be used in place from the mapped view
+    struct Blob
+    {
+        std::streampos reference = 0;   // position of the blob's file offset in the scene description
+        const void* data = nullptr;
+        uint64_t size = 0;
+    };
+
+    /**
+     * Write a blob reference (file offset and size), the offset is patched when the blobs are written.
+     */
+    void WriteBlob(std::ofstream& out, std::vector<Blob>& blobs, const void* data, uint64_t size)
+    {
+        Blob blob = { out.tellp(), data, size };
+        blobs.push_back(blob);
+
+        uint64_t offset = 0;
+        Write(out, &offset, sizeof(uint64_t));
+        Write(out, &size, sizeof(uint64_t));
+    }
+
+    /**
+     * Write the blobs at page-aligned offsets and patch their references.
+     */
+    void WriteBlobs(std::ofstream& out, std::vector<Blob>& blobs)
+    {
+        std::vector<uint64_t> offsets(blobs.size());
+        const char padding[SCENE_CACHE_BLOB_ALIGNMENT] = {};
+        for (size_t blobIndex = 0; blobIndex < blobs.size(); blobIndex++)
+        {
+            uint64_t position = static_cast<uint64_t>(out.tellp());
+            uint64_t offset = (position + SCENE_CACHE_BLOB_ALIGNMENT - 1) & ~static_cast<uint64_t>(SCENE_CACHE_BLOB_ALIGNMENT - 1);
+            out.write(padding, static_cast<std::streamsize>(offset - position));
+            out.write(static_cast<const char*>(blobs[blobIndex].data), static_cast<std::streamsize>(blobs[blobIndex].size));
+            offsets[blobIndex] = offset;
+        }
+
+        for (size_t blobIndex = 0; blobIndex < blobs.size(); blobIndex++)
+        {
+            out.seekp(blobs[blobIndex].reference);
+            Write(out, &offsets[blobIndex], sizeof(uint64_t));
+        }
+        out.seekp(0, std::ios::end);
+    }
+
+    void WriteTexture(std::ofstream& out, std::vector<Blob>& blobs, Textures::Texture& texture)
     {
         // Texture name
         uint32_t numChars = static_cast<uint32_t>(strlen(texture.name.c_str())) + 1;
@@ -228,10 +422,11 @@ namespace Caches
         Write(out, &texture.height);
         Write(out, &texture.stride);
         Write(out, &texture.mips);
-        Write(out, &texture.texelBytes, sizeof(uint64_t));
+        Write(out, &texture.sourceStamp, sizeof(uint64_t));
+        Write(out, &texture.sourceHash, sizeof(uint64_t));
 
         // Texels
-        Write(out, texture.texels, texture.texelBytes);
+        WriteBlob(out, blobs, texture.texels, texture.texelBytes);
     }
 
     void WriteMaterial(std::ofstream& out, Scenes::Material& material)
@@ -244,7 +439,21 @@ namespace Caches
         Write(out, &material.data, material.GetGPUDataSize());
     }
 
-    void WriteMesh(std::ofstream& out, Scenes::Mesh& mesh)
+    /**
+     * Encode a geometry stream and write its word count and blob reference (see EncodeWords()).
+     * The encoded bytes are kept in the encoded list until the blobs are written.
+     */
+    void WriteGeometryBlob(std::ofstream& out, std::vector<Blob>& blobs, std::vector<std::vector<uint8_t>>& encoded, const void* data, uint64_t size, uint32_t stride)
+    {
+        uint64_t numWords = size / sizeof(uint32_t);
+        std::vector<uint8_t>& bytes = encoded.emplace_back();
+        EncodeWords(static_cast<const uint32_t*>(data), numWords, stride, bytes);
+
+        Write(out, &numWords, sizeof(uint64_t));
+        WriteBlob(out, blobs, bytes.data(), bytes.size());
+    }
+
+    void WriteMesh(std::ofstream& out, std::vector<Blob>& blobs, std::vector<std::vector<uint8_t>>& encoded, Scenes::Mesh& mesh)
     {
         uint32_t numChars = static_cast<uint32_t>(strlen(mesh.name.c_str())) + 1;
         Write(out, &numChars);
@@ -263,20 +472,18 @@ namespace Caches
         Write(out, &numPrimitives);
         for (uint32_t primitiveIndex = 0; primitiveIndex < numPrimitives; primitiveIndex++)
         {
-            Scenes::MeshPrimitive primitive = mesh.primitives[primitiveIndex];
-            uint32_t numVertices = static_cast<uint32_t>(primitive.vertices.size());
-            uint32_t numIndices = static_cast<uint32_t>(primitive.indices.size());
+            Scenes::MeshPrimitive& primitive = mesh.primitives[primitiveIndex];
             Write(out, &primitive.index, sizeof(int));
             Write(out, &primitive.material, sizeof(int));
             Write(out, &primitive.opaque, sizeof(bool));
             Write(out, &primitive.doubleSided, sizeof(bool));
             Write(out, &primitive.indexByteOffset, sizeof(uint32_t));
             Write(out, &primitive.vertexByteOffset, sizeof(uint32_t));
+            Write(out, &primitive.hash, sizeof(uint64_t));
             Write(out, &primitive.boundingBox, sizeof(rtxgi::AABB));
-            Write(out, &numVertices);
-            Write(out, primitive.vertices.data(), sizeof(Graphics::Vertex) * numVertices);
-            Write(out, &numIndices);
-            Write(out, primitive.indices.data(), sizeof(uint32_t) * numIndices);
+            WriteGeometryBlob(out, blobs, encoded, primitive.packedVertices.data(), sizeof(Graphics::PackedVertex) * primitive.packedVertices.size(), sizeof(Graphics::PackedVertex) / sizeof(uint32_t));
+            WriteGeometryBlob(out, blobs, encoded, primitive.indices.data(), sizeof(uint32_t) * primitive.indices.size(), 1);
+            WriteGeometryBlob(out, blobs, encoded, primitive.vertexAlbedos.data(), sizeof(uint32_t) * primitive.vertexAlbedos.size(), 1);
         }
 
     }
@@ -293,6 +500,17 @@ namespace Caches
         Write(out, &instance.transform, sizeof(float) * 12);
     }
 
+    void WriteSourceFile(std::ofstream& out, Scenes::SourceFile& source)
+    {
+        uint32_t numChars = static_cast<uint32_t>(strlen(source.filepath.c_str())) + 1;
+        Write(out, &numChars);
+        out.write(source.filepath.c_str(), numChars);
+        out.seekp(out.tellp());
+
+        Write(out, &source.stamp, sizeof(uint64_t));
+        Write(out, &source.hash, sizeof(uint64_t));
+    }
+
     void WriteLight(std::ofstream& out, Scenes::Light& light)
     {
         uint32_t numChars = static_cast<uint32_t>(strlen(light.name.c_str())) + 1;
@@ -313,6 +531,19 @@ namespace Caches
         Write(out, &camera.data, camera.GetGPUDataSize());
     }
 
+    void WriteDDGIVolumeTexture(std::ofstream& out, DDGIVolumeCacheTexture& texture)
+    {
+        Write(out, &texture.format);
+        Write(out, &texture.width);
+        Write(out, &texture.height);
+        Write(out, &texture.arraySize);
+        Write(out, &texture.rowBytes);
+
+        uint64_t texelBytes = static_cast<uint64_t>(texture.texels.size());
+        Write(out, &texelBytes, sizeof(uint64_t));
+        Write(out, texture.texels.data(), texelBytes);
+    }
+
     void WriteSceneNode(std::ofstream& out, Scenes::SceneNode& node)
     {
         Write(out, &node.instance, sizeof(int));
@@ -327,10 +558,198 @@ namespace Caches
         Write(out, node.children.data(), (sizeof(int) * numChildren));
     }
 
+    /**
+     * Bake the low frequency albedo and opacity of each mesh primitive vertex (the material's albedo and opacity
+     * times its albedo texture at the vertex, in the middle mip level like the GI hit shaders sample it).
+     * GI hit shading interpolates the vertex albedos instead of sampling the albedo texture (see Globals::GIVertexAlbedo).
+     */
+    void BakeVertexAlbedos(Scenes::Scene& scene)
+    {
+        // The decoded middle mip level of each albedo texture
+        struct MipTexels
+        {
+            bool decoded = false;
+            bool valid = false;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            std::vector<uint8_t> texels;
+        };
+        std::vector<MipTexels> mips(scene.textures.size());
+
+        auto PackUnorm = [](float value) { return static_cast<uint32_t>((std::min)((std::max)(value, 0.f), 1.f) * 255.f + 0.5f); };
+
+        for (Scenes::Mesh& mesh : scene.meshes)
+        {
+            for (Scenes::MeshPrimitive& mp : mesh.primitives)
+            {
+                const Graphics::Material& material = scene.materials[mp.material].data;
+
+                // Decode the albedo texture's middle mip level (once)
+                MipTexels* mip = nullptr;
+                if (material.albedoTexIdx > -1)
+                {
+                    mip = &mips[material.albedoTexIdx];
+                    if (!mip->decoded)
+                    {
+                        const Textures::Texture& texture = scene.textures[material.albedoTexIdx];
+                        uint32_t numLevels = static_cast<uint32_t>(log2f(static_cast<float>((std::max)(texture.width, texture.height)))) + 1;
+                        uint32_t level = (std::min)(numLevels / 2, (texture.format == Textures::ETextureFormat::BC7) ? texture.mips - 1 : numLevels - 1);
+                        mip->valid = Textures::GetMipTexels(texture, level, mip->texels, mip->width, mip->height);
+                        mip->decoded = true;
+                    }
+                    if (!mip->valid) mip = nullptr;
+                }
+
+                mp.vertexAlbedos.resize(mp.packedVertices.size());
+                for (size_t vertexIndex = 0; vertexIndex < mp.packedVertices.size(); vertexIndex++)
+                {
+                    float albedo[4] = { material.albedo.x, material.albedo.y, material.albedo.z, material.opacity };
+                    if (mip)
+                    {
+                        // Bilinear filter the mip level at the vertex texture coordinates (wrap addressing)
+                        uint32_t uv = mp.packedVertices[vertexIndex].data.w;
+                        float u = PackedVector::XMConvertHalfToFloat(static_cast<PackedVector::HALF>(uv & 0xFFFF));
+                        float v = PackedVector::XMConvertHalfToFloat(static_cast<PackedVector::HALF>(uv >> 16));
+                        float x = ((u - floorf(u)) * mip->width) - 0.5f;
+                        float y = ((v - floorf(v)) * mip->height) - 0.5f;
+                        float fx = x - floorf(x);
+                        float fy = y - floorf(y);
+                        int x0 = static_cast<int>(floorf(x));
+                        int y0 = static_cast<int>(floorf(y));
+
+                        float texel[4] = { 0.f, 0.f, 0.f, 0.f };
+                        for (int corner = 0; corner < 4; corner++)
+                        {
+                            int cx = x0 + (corner & 1);
+                            int cy = y0 + (corner >> 1);
+                            uint32_t tx = static_cast<uint32_t>((cx % static_cast<int>(mip->width) + static_cast<int>(mip->width)) % static_cast<int>(mip->width));
+                            uint32_t ty = static_cast<uint32_t>((cy % static_cast<int>(mip->height) + static_cast<int>(mip->height)) % static_cast<int>(mip->height));
+                            float weight = ((corner & 1) ? fx : (1.f - fx)) * ((corner >> 1) ? fy : (1.f - fy));
+
+                            const uint8_t* t = &mip->texels[(static_cast<size_t>(ty) * mip->width + tx) * 4];
+                            for (uint32_t channel = 0; channel < 4; channel++) texel[channel] += weight * (t[channel] / 255.f);
+                        }
+                        for (uint32_t channel = 0; channel < 4; channel++) albedo[channel] *= texel[channel];
+                    }
+
+                    mp.vertexAlbedos[vertexIndex] = PackUnorm(albedo[0]) | (PackUnorm(albedo[1]) << 8) | (PackUnorm(albedo[2]) << 16) | (PackUnorm(albedo[3]) << 24);
+                }
+            }
+        }
+    }
+
+    /**
+     * Mark the blended and masked mesh primitives that never fail the any-hit alpha test as opaque.
+     * A masked primitive passes when its material's opacity times the smallest alpha of its albedo texture's
+     * top mip level (filtered and lower mip levels can't be smaller) is at least the alpha cutoff.
+     * Opaque primitives are built into the BLAS with the opaque geometry flag, rays skip their any-hit shader.
+     */
+    void ClassifyOpaquePrimitives(Scenes::Scene& scene)
+    {
+        // The smallest alpha of each albedo texture (-1: not yet decoded, 0: unknown)
+        std::vector<float> minAlphas(scene.textures.size(), -1.f);
+
+        for (Scenes::Mesh& mesh : scene.meshes)
+        {
+            for (Scenes::MeshPrimitive& mp : mesh.primitives)
+            {
+                if (mp.opaque) continue;
+
+                const Graphics::Material& material = scene.materials[mp.material].data;
+
+                float alpha = material.opacity;
+                if (material.alphaMode == 2 && material.albedoTexIdx > -1)
+                {
+                    float& minAlpha = minAlphas[material.albedoTexIdx];
+                    if (minAlpha < 0.f)
+                    {
+                        uint32_t width, height;
+                        std::vector<uint8_t> texels;
+                        minAlpha = 0.f;
+                        if (Textures::GetMipTexels(scene.textures[material.albedoTexIdx], 0, texels, width, height))
+                        {
+                            uint8_t texelAlpha = 255;
+                            for (size_t texelIndex = 3; texelIndex < texels.size(); texelIndex += 4) texelAlpha = (std::min)(texelAlpha, texels[texelIndex]);
+                            minAlpha = texelAlpha / 255.f;
+                        }
+                    }
+                    alpha *= minAlpha;
+                }
+
+                if (alpha >= material.alphaCutoff) mp.opaque = true;
+            }
+        }
+    }
+
     //----------------------------------------------------------------------------------------------------------
     // Public Functions
     //----------------------------------------------------------------------------------------------------------
 
+    /**
+     * Hash the given bytes (64-bit FNV-1a).
+     */
+    uint64_t Hash(const void* data, size_t size, uint64_t hash)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t byteIndex = 0; byteIndex < size; byteIndex++)
+        {
+            hash ^= bytes[byteIndex];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    /**
+     * Hash the contents of a file.
+     */
+    bool HashFile(const std::string& filepath, uint64_t& hash)
+    {
+        std::ifstream in(filepath, std::ios::in | std::ios::binary);
+        if (!in.is_open()) return false;
+
+        std::vector<char> buffer(1024 * 1024);
+        hash = Hash(nullptr, 0);
+        while (in)
+        {
+            in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            hash = Hash(buffer.data(), static_cast<size_t>(in.gcount()), hash);
+        }
+        return in.eof();
+    }
+
+    /**
+     * Get a file's modification stamp (a hash of its size and last write time), 0 if the file does not exist.
+     */
+    uint64_t GetFileStamp(const std::string& filepath)
+    {
+        std::error_code error;
+        uint64_t size = static_cast<uint64_t>(std::filesystem::file_size(filepath, error));
+        if (error) return 0;
+
+        int64_t time = static_cast<int64_t>(std::filesystem::last_write_time(filepath, error).time_since_epoch().count());
+        if (error) return 0;
+
+        return Hash(&time, sizeof(int64_t), Hash(&size, sizeof(uint64_t)));
+    }
+
+    /**
+     * Check if a file still matches the content hash it was cached with.
+     * Files with an unchanged stamp are not read. Touched files are hashed, the stamp is updated when the content is unchanged.
+     * Missing files are treated as current, scene cache files can be used without their sources.
+     */
+    bool IsFileCurrent(const std::string& filepath, uint64_t& stamp, uint64_t hash)
+    {
+        uint64_t current = GetFileStamp(filepath);
+        if (current == 0 || current == stamp) return true;
+
+        uint64_t contentHash = 0;
+        if (!HashFile(filepath, contentHash)) return true;
+        if (contentHash != hash) return false;
+
+        stamp = current;
+        return true;
+    }
+
     /**
      * Write the scene cache file to disk.
      */
@@ -344,6 +763,16 @@ namespace Caches
 
             out.seekp(0, std::ios::beg);
 
+            // Bake the vertex albedos for GI hit shading from the scene's textures
+            BakeVertexAlbedos(scene);
+
+            // Skip the any-hit shader of blended and masked mesh primitives that are never cut out
+            ClassifyOpaquePrimitives(scene);
+
+            // Vertices, vertex albedos, indices, and texels are written after the scene description
+            std::vector<Blob> blobs;
+            std::vector<std::vector<uint8_t>> encodedBlobs;
+
             // Header
             uint32_t cacheVersion = SCENE_CACHE_VERSION;
             Write(out, &cacheVersion);
@@ -354,14 +783,23 @@ namespace Caches
             Write(out, &scene.activeCamera);
             Write(out, &scene.numMeshPrimitives);
             Write(out, &scene.numTriangles);
+            Write(out, &scene.sortedTriangles, sizeof(bool));
             Write(out, &scene.hasDirectionalLight);
             Write(out, &scene.numPointLights);
             Write(out, &scene.numSpotLights);
 
             Write(out, &scene.boundingBox, sizeof(rtxgi::AABB));
 
+            // Source Files
+            uint32_t numElements = static_cast<uint32_t>(scene.sources.size());
+            Write(out, &numElements);
+            for (uint32_t sourceIndex = 0; sourceIndex < numElements; sourceIndex++)
+            {
+                WriteSourceFile(out, scene.sources[sourceIndex]);
+            }
+
             // Root Nodes
-            uint32_t numElements = static_cast<uint32_t>(scene.rootNodes.size());
+            numElements = static_cast<uint32_t>(scene.rootNodes.size());
             Write(out, &numElements);
             if (numElements > 0)
             {
@@ -405,7 +843,7 @@ namespace Caches
             Write(out, &numElements);
             for (uint32_t meshIndex = 0; meshIndex < numElements; meshIndex++)
             {
-                WriteMesh(out, scene.meshes[meshIndex]);
+                WriteMesh(out, blobs, encodedBlobs, scene.meshes[meshIndex]);
             }
 
             // Materials
@@ -421,9 +859,12 @@ namespace Caches
             Write(out, &numElements, sizeof(uint32_t));
             for (uint32_t textureIndex = 0; textureIndex < numElements; textureIndex++)
             {
-                WriteTexture(out, scene.textures[textureIndex]);
+                WriteTexture(out, blobs, scene.textures[textureIndex]);
             }
 
+            // Blobs
+            WriteBlobs(out, blobs);
+
             out.close();
             return true;
         }
@@ -434,38 +875,42 @@ namespace Caches
 
     /**
      * Read the scene cache file from disk.
+     * The file stays memory mapped until Unmap(), the cached texture texels point into the mapped view.
      */
     bool Deserialize(const std::string& filepath, Scenes::Scene& scene, std::ofstream& log)
     {
-        std::ifstream in;
-        in.open(filepath, std::ios::in | std::ios::binary);
-        if (in.is_open())
+        MappedReader in;
+        if (MapFile(filepath, &in.data, &in.size))
         {
-            in.seekg(0, std::ios::beg);
-
             // Header
-            uint32_t cacheVersion;
+            uint32_t cacheVersion = 0;
             Read(in, &cacheVersion, sizeof(uint32_t));
             if(cacheVersion != SCENE_CACHE_VERSION)
             {
                 log << "\n\tWarning: scene cache version '" << cacheVersion << "' does not match expected version '" << SCENE_CACHE_VERSION << "'";
                 log << "\n\tRebuilding scene cache...";
+                UnmapFile(in.data, in.size);
                 return false;
             }
 
-            uint32_t coordinateSystem;
+            uint32_t coordinateSystem = 0;
             Read(in, &coordinateSystem, sizeof(uint32_t));
             if(coordinateSystem != COORDINATE_SYSTEM)
             {
                 log << "\n\tWarning: scene cache coordinate system '" << GetCoordinateSystemName(coordinateSystem);
                 log << "' does not match current coordinate system '" << GetCoordinateSystemName(COORDINATE_SYSTEM) << "'";
                 log << "\n\tRebuilding scene cache...";
+                UnmapFile(in.data, in.size);
                 return false;
             }
 
+            scene.cacheData = in.data;
+            scene.cacheSize = in.size;
+
             Read(in, &scene.activeCamera);
             Read(in, &scene.numMeshPrimitives);
             Read(in, &scene.numTriangles);
+            Read(in, &scene.sortedTriangles, sizeof(bool));
             Read(in, &scene.hasDirectionalLight);
             Read(in, &scene.numPointLights);
             Read(in, &scene.numSpotLights);
@@ -474,17 +919,28 @@ namespace Caches
 
             uint32_t numElements = 0;
 
+            // Source Files
+            Read(in, &numElements);
+            if (in.good && numElements > 0)
+            {
+                scene.sources.resize(numElements);
+                for (uint32_t sourceIndex = 0; sourceIndex < numElements; sourceIndex++)
+                {
+                    ReadSourceFile(in, scene.sources[sourceIndex]);
+                }
+            }
+
             // Root Nodes
             Read(in, &numElements);
-            if (numElements > 0)
+            if (in.good && numElements > 0)
             {
                 scene.rootNodes.resize(numElements);
-                Read(in, reinterpret_cast<char*>(scene.rootNodes.data()), sizeof(int) * numElements);
+                Read(in, scene.rootNodes.data(), sizeof(int) * numElements);
             }
 
             // Scene Nodes
             Read(in, &numElements);
-            if (numElements > 0)
+            if (in.good && numElements > 0)
             {
                 scene.nodes.resize(numElements);
                 for (uint32_t nodeIndex = 0; nodeIndex < numElements; nodeIndex++)
@@ -495,7 +951,7 @@ namespace Caches
 
             // Cameras
             Read(in, &numElements);
-            if (numElements > 0)
+            if (in.good && numElements > 0)
             {
                 scene.cameras.resize(numElements);
                 for (uint32_t cameraIndex = 0; cameraIndex < numElements; cameraIndex++)
@@ -506,7 +962,7 @@ namespace Caches
 
             // Lights
             Read(in, &numElements);
-            if (numElements > 0)
+            if (in.good && numElements > 0)
             {
                 scene.lights.resize(numElements);
                 for (uint32_t lightIndex = 0; lightIndex < numElements; lightIndex++)
@@ -517,7 +973,7 @@ namespace Caches
 
             // MeshInstances
             Read(in, &numElements);
-            if (numElements > 0)
+            if (in.good && numElements > 0)
             {
                 scene.instances.resize(numElements);
                 for (uint32_t instanceIndex = 0; instanceIndex < numElements; instanceIndex++)
@@ -526,20 +982,29 @@ namespace Caches
                 }
             }
 
-            // Meshes
+            // Meshes, the geometry blobs are decoded in parallel once the mesh descriptions are read
+            std::vector<std::function<void()>> decodes;
+            std::atomic<bool> decoded = true;
             Read(in, &numElements);
-            if (numElements > 0)
+            if (in.good && numElements > 0)
             {
                 scene.meshes.resize(numElements);
                 for (uint32_t meshIndex = 0; meshIndex < numElements; meshIndex++)
                 {
-                    ReadMesh(in, scene.meshes[meshIndex]);
+                    ReadMesh(in, scene.meshes[meshIndex], decodes, decoded);
                 }
             }
+            if (in.good && !decodes.empty())
+            {
+                Jobs::Pool decodeWorkers;
+                decodeWorkers.Start((std::max)(std::thread::hardware_concurrency(), 2u) - 1);
+                decodeWorkers.Run(decodes);
+            }
+            if (!decoded) in.good = false;
 
             // Materials
             Read(in, &numElements);
-            if (numElements > 0)
+            if (in.good && numElements > 0)
             {
                 scene.materials.resize(numElements);
                 for (uint32_t materialIndex = 0; materialIndex < numElements; materialIndex++)
@@ -550,7 +1015,7 @@ namespace Caches
 
             // Textures
             Read(in, &numElements);
-            if (numElements > 0)
+            if (in.good && numElements > 0)
             {
                 scene.textures.resize(numElements);
                 for (uint32_t textureIndex = 0; textureIndex < numElements; textureIndex++)
@@ -559,7 +1024,15 @@ namespace Caches
                 }
             }
 
-            in.close();
+            if (!in.good)
+            {
+                log << "\n\tWarning: scene cache file is truncated or corrupt!";
+                log << "\n\tRebuilding scene cache...";
+                Unmap(scene);
+                scene = {};
+                return false;
+            }
+
             return true;
         }
         else
@@ -569,4 +1042,225 @@ namespace Caches
         return false;
     }
 
+    /**
+     * Release the scene's memory mapped cache file.
+     */
+    void Unmap(Scenes::Scene& scene)
+    {
+        if (scene.cacheData == nullptr) return;
+        UnmapFile(scene.cacheData, scene.cacheSize);
+        scene.cacheData = nullptr;
+        scene.cacheSize = 0;
+    }
+
+    /**
+     * Write a DDGIVolume probe cache file to disk.
+     */
+    bool Serialize(const std::string& filepath, DDGIVolumeCache& cache, std::ofstream& log)
+    {
+        std::ofstream out;
+        out.open(filepath, std::ios::out | std::ios::binary);
+        if (out.is_open())
+        {
+            log << "\n\tWriting DDGIVolume cache file \'" + filepath + "\'...";
+
+            out.seekp(0, std::ios::beg);
+
+            // Header
+            uint32_t cacheVersion = DDGI_VOLUME_CACHE_VERSION;
+            Write(out, &cacheVersion);
+
+            uint32_t coordinateSystem = COORDINATE_SYSTEM;
+            Write(out, &coordinateSystem);
+
+            Write(out, &cache.key, sizeof(uint64_t));
+
+            // Probe textures
+            WriteDDGIVolumeTexture(out, cache.irradiance);
+            WriteDDGIVolumeTexture(out, cache.distance);
+            WriteDDGIVolumeTexture(out, cache.probeData);
+            WriteDDGIVolumeTexture(out, cache.variability);
+
+            out.close();
+            return true;
+        }
+
+        log << "\nFailed to write DDGIVolume cache file \'" + filepath + "\'";
+        return false;
+    }
+
+    /**
+     * Read a DDGIVolume probe cache file from disk.
+     * Fails when the file is missing, from another cache version or coordinate system, or was stored for another key.
+     */
+    bool Deserialize(const std::string& filepath, uint64_t key, DDGIVolumeCache& cache, std::ofstream& log)
+    {
+        std::ifstream in;
+        in.open(filepath, std::ios::in | std::ios::binary);
+        if (in.is_open())
+        {
+            in.seekg(0, std::ios::beg);
+
+            // Header
+            uint32_t cacheVersion = 0;
+            Read(in, &cacheVersion, sizeof(uint32_t));
+            if (cacheVersion != DDGI_VOLUME_CACHE_VERSION)
+            {
+                log << "\n\tWarning: DDGIVolume cache version '" << cacheVersion << "' does not match expected version '" << DDGI_VOLUME_CACHE_VERSION << "'";
+                return false;
+            }
+
+            uint32_t coordinateSystem = 0;
+            Read(in, &coordinateSystem, sizeof(uint32_t));
+            if (coordinateSystem != COORDINATE_SYSTEM)
+            {
+                log << "\n\tWarning: DDGIVolume cache coordinate system '" << GetCoordinateSystemName(coordinateSystem);
+                log << "' does not match current coordinate system '" << GetCoordinateSystemName(COORDINATE_SYSTEM) << "'";
+                return false;
+            }
+
+            Read(in, &cache.key, sizeof(uint64_t));
+            if (cache.key != key)
+            {
+                log << "\n\tWarning: DDGIVolume cache file \'" + filepath + "\' is out of date (the scene or volume changed)";
+                return false;
+            }
+
+            // Probe textures
+            bool result = ReadDDGIVolumeTexture(in, cache.irradiance);
+            result &= ReadDDGIVolumeTexture(in, cache.distance);
+            result &= ReadDDGIVolumeTexture(in, cache.probeData);
+            result &= ReadDDGIVolumeTexture(in, cache.variability);
+            if (!result)
+            {
+                log << "\n\tWarning: DDGIVolume cache file \'" + filepath + "\' is truncated or corrupt";
+                return false;
+            }
+
+            in.close();
+            return true;
+        }
+        else
+        {
+            log << "\n\tWarning: no DDGIVolume cache file exists!";
+        }
+        return false;
+    }
+    /**
+     * Write a radiance cache file to disk.
+     */
+    bool Serialize(const std::string& filepath, RadianceCacheCells& cells, std::ofstream& log)
+    {
+        std::ofstream out;
+        out.open(filepath, std::ios::out | std::ios::binary);
+        if (out.is_open())
+        {
+            log << "\n\tWriting radiance cache file \'" + filepath + "\'...";
+
+            out.seekp(0, std::ios::beg);
+
+            // Header
+            uint32_t cacheVersion = RADIANCE_CACHE_FILE_VERSION;
+            Write(out, &cacheVersion);
+
+            uint32_t coordinateSystem = COORDINATE_SYSTEM;
+            Write(out, &coordinateSystem);
+
+            Write(out, &cells.key, sizeof(uint64_t));
+            Write(out, &cells.slotCount);
+            Write(out, &cells.metadataStride);
+            Write(out, &cells.radianceStride);
+            Write(out, &cells.historyStride);
+
+            // Occupied slots
+            uint32_t numCells = static_cast<uint32_t>(cells.slots.size());
+            Write(out, &numCells);
+            Write(out, cells.slots.data(), sizeof(uint32_t) * numCells);
+            Write(out, cells.metadata.data(), cells.metadata.size());
+            Write(out, cells.radiance.data(), cells.radiance.size());
+            Write(out, cells.history.data(), cells.history.size());
+
+            out.close();
+            return true;
+        }
+
+        log << "\nFailed to write radiance cache file \'" + filepath + "\'";
+        return false;
+    }
+
+    /**
+     * Read a radiance cache file from disk.
+     * Fails when the file is missing, from another cache version or coordinate system, or was stored for another key.
+     */
+    bool Deserialize(const std::string& filepath, uint64_t key, RadianceCacheCells& cells, std::ofstream& log)
+    {
+        std::ifstream in;
+        in.open(filepath, std::ios::in | std::ios::binary);
+        if (in.is_open())
+        {
+            in.seekg(0, std::ios::beg);
+
+            // Header
+            uint32_t cacheVersion = 0;
+            Read(in, &cacheVersion, sizeof(uint32_t));
+            if (cacheVersion != RADIANCE_CACHE_FILE_VERSION)
+            {
+                log << "\n\tWarning: radiance cache file version '" << cacheVersion << "' does not match expected version '" << RADIANCE_CACHE_FILE_VERSION << "'";
+                return false;
+            }
+
+            uint32_t coordinateSystem = 0;
+            Read(in, &coordinateSystem, sizeof(uint32_t));
+            if (coordinateSystem != COORDINATE_SYSTEM)
+            {
+                log << "\n\tWarning: radiance cache file coordinate system '" << GetCoordinateSystemName(coordinateSystem);
+                log << "' does not match current coordinate system '" << GetCoordinateSystemName(COORDINATE_SYSTEM) << "'";
+                return false;
+            }
+
+            Read(in, &cells.key, sizeof(uint64_t));
+            if (cells.key != key)
+            {
+                log << "\n\tWarning: radiance cache file \'" + filepath + "\' is out of date (the scene or cache settings changed)";
+                return false;
+            }
+
+            Read(in, &cells.slotCount);
+            Read(in, &cells.metadataStride);
+            Read(in, &cells.radianceStride);
+            Read(in, &cells.historyStride);
+
+            // Occupied slots
+            uint32_t numCells = 0;
+            Read(in, &numCells);
+            if (!in.good() || numCells > cells.slotCount)
+            {
+                log << "\n\tWarning: radiance cache file \'" + filepath + "\' is truncated or corrupt";
+                return false;
+            }
+
+            cells.slots.resize(numCells);
+            cells.metadata.resize(static_cast<size_t>(cells.metadataStride) * numCells);
+            cells.radiance.resize(static_cast<size_t>(cells.radianceStride) * numCells);
+            cells.history.resize(static_cast<size_t>(cells.historyStride) * numCells);
+            Read(in, cells.slots.data(), sizeof(uint32_t) * numCells);
+            Read(in, cells.metadata.data(), cells.metadata.size());
+            Read(in, cells.radiance.data(), cells.radiance.size());
+            Read(in, cells.history.data(), cells.history.size());
+            if (!in.good())
+            {
+                log << "\n\tWarning: radiance cache file \'" + filepath + "\' is truncated or corrupt";
+                return false;
+            }
+
+            in.close();
+            return true;
+        }
+        else
+        {
+            log << "\n\tWarning: no radiance cache file exists!";
+        }
+        return false;
+    }
+
 }
@@ -9,6 +9,7 @@
 */
 
 #include "Configs.h"
+#include "Jobs.h"
 
 #include <rtxgi/ddgi/DDGIVolume.h>
 
@@ -43,38 +44,45 @@ namespace Configs
      */
     std::vector<std::string> Split(const std::string& line, const char delimiter = '.')
     {
+        // Same tokens as getline() on a stream, without the stream
         std::vector<std::string> tokens;
-        std::istringstream stream(line);
-        std::string token;
-
-        while (getline(stream, token, delimiter))
+        size_t start = 0;
+        while (start < line.size())
         {
-            tokens.push_back(token);
+            size_t end = line.find(delimiter, start);
+            if (end == std::string::npos) end = line.size();
+            tokens.emplace_back(line, start, end - start);
+            start = end + 1;
         }
         return tokens;
     }
 
-    void Store(std::string source, bool& destination)
+    void Store(const std::string& source, std::string& destination)
+    {
+        destination = source;
+    }
+
+    void Store(const std::string& source, bool& destination)
     {
         destination = (bool)stoi(source);
     }
 
-    void Store(std::string source, int& destination)
+    void Store(const std::string& source, int& destination)
     {
         destination = stoi(source);
     }
 
-    void Store(std::string source, unsigned int& destination)
+    void Store(const std::string& source, unsigned int& destination)
     {
         destination = (unsigned int)stoi(source);
     }
 
-    void Store(std::string source, float& destination)
+    void Store(const std::string& source, float& destination)
     {
         destination = stof(source);
     }
 
-    void StoreWorldCounts(std::string source, XMINT3& destination)
+    void StoreWorldCounts(const std::string& source, XMINT3& destination)
     {
         // Note: used to store world-space probe counts, negative values are not allowed
         std::vector<std::string> values = Split(source, ' ');
@@ -87,37 +95,73 @@ namespace Configs
     #endif
     }
 
-    void Store(std::string source, XMINT3& destination)
+    void Store(const std::string& source, XMINT3& destination)
     {
         std::vector<std::string> values = Split(source, ' ');
         destination = { static_cast<int32_t>(stol(values[0])), static_cast<int32_t>(stol(values[1])), static_cast<int32_t>(stol(values[2])) };
     }
 
-    void StoreWorldVector(std::string source, XMFLOAT3& destination)
+    XMFLOAT3 ToWorldVector(const XMFLOAT3& source)
     {
-        // Note: used to store world-space positions and directions
-        std::vector<std::string> values = Split(source, ' ');
+        // Note: converts right hand, y-up positions and directions to the target coordinate system
     #if COORDINATE_SYSTEM == COORDINATE_SYSTEM_RIGHT
-        destination = { stof(values[0]), stof(values[1]), stof(values[2]) };
+        return { source.x, source.y, source.z };
     #elif COORDINATE_SYSTEM == COORDINATE_SYSTEM_RIGHT_Z_UP
-        destination = { stof(values[0]), -stof(values[2]), stof(values[1]) };
+        return { source.x, -source.z, source.y };
     #elif COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT
-        destination = { stof(values[0]), stof(values[1]), -stof(values[2]) };
+        return { source.x, source.y, -source.z };
     #elif COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT_Z_UP
-        destination = { -stof(values[2]), stof(values[0]), stof(values[1]) };
+        return { -source.z, source.x, source.y };
     #endif
     }
 
-    void StoreEulerAngles(std::string source, XMFLOAT3& destination)
+    XMFLOAT3 FromWorldVector(const XMFLOAT3& source)
     {
-        // Store Euler angles for volume rotation
+        // Note: converts positions and directions of the target coordinate system back to right hand, y-up
+    #if COORDINATE_SYSTEM == COORDINATE_SYSTEM_RIGHT
+        return { source.x, source.y, source.z };
+    #elif COORDINATE_SYSTEM == COORDINATE_SYSTEM_RIGHT_Z_UP
+        return { source.x, source.z, -source.y };
+    #elif COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT
+        return { source.x, source.y, -source.z };
+    #elif COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT_Z_UP
+        return { source.y, source.z, -source.x };
+    #endif
+    }
+
+    XMINT3 FromWorldCounts(const XMINT3& source)
+    {
+        // Note: the inverse of StoreWorldCounts(), also used for world-space distances
+    #if COORDINATE_SYSTEM == COORDINATE_SYSTEM_RIGHT || COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT
+        return { source.x, source.y, source.z };
+    #elif COORDINATE_SYSTEM == COORDINATE_SYSTEM_RIGHT_Z_UP
+        return { source.x, source.z, source.y };
+    #elif COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT_Z_UP
+        return { source.y, source.z, source.x };
+    #endif
+    }
+
+    XMFLOAT3 ToEulerAngles(const XMFLOAT3& degrees)
+    {
+        rtxgi::float3 radians = rtxgi::ConvertEulerAngles({ degrees.x, degrees.y, degrees.z }, static_cast<rtxgi::ECoordinateSystem>(COORDINATE_SYSTEM));
+        return { radians.x, radians.y, radians.z };
+    }
+
+    void StoreWorldVector(const std::string& source, XMFLOAT3& destination)
+    {
+        // Note: used to store world-space positions and directions
         std::vector<std::string> values = Split(source, ' ');
+        destination = ToWorldVector({ stof(values[0]), stof(values[1]), stof(values[2]) });
+    }
 
-        rtxgi::float3 radians = rtxgi::ConvertEulerAngles({stof(values[0]), stof(values[1]), stof(values[2])}, static_cast<rtxgi::ECoordinateSystem>(COORDINATE_SYSTEM));
-        destination = { radians.x, radians.y, radians.z };
+    void StoreEulerAngles(const std::string& source, XMFLOAT3& destination)
+    {
+        // Store Euler angles for volume rotation
+        std::vector<std::string> values = Split(source, ' ');
+        destination = ToEulerAngles({ stof(values[0]), stof(values[1]), stof(values[2]) });
     }
 
-    void StoreWorldDistance(std::string source, XMFLOAT3& destination)
+    void StoreWorldDistance(const std::string& source, XMFLOAT3& destination)
     {
         // Note: used to store world-space distance values (between probes), negative values are not allowed
         std::vector<std::string> values = Split(source, ' ');
@@ -130,32 +174,305 @@ namespace Configs
     #endif
     }
 
-    void Store(std::string source, XMFLOAT3& destination)
+    void Store(const std::string& source, XMFLOAT3& destination)
     {
         std::vector<std::string> values = Split(source, ' ');
         destination = { stof(values[0]), stof(values[1]), stof(values[2]) };
     }
 
-    void Store(std::string source, ERenderMode& destination)
+    void Store(const std::string& source, ERenderMode& destination)
     {
         destination = (ERenderMode)stoi(source);
     }
 
-    void Store(std::string source, ELightType& destination)
+    void Store(const std::string& source, ELightType& destination)
     {
         destination = (ELightType)stoi(source);
     }
 
-    void Store(std::string source, rtxgi::EDDGIVolumeTextureFormat& destination)
+    void Store(const std::string& source, rtxgi::EDDGIVolumeTextureFormat& destination)
     {
         destination = (rtxgi::EDDGIVolumeTextureFormat)stoi(source);
     }
 
-    void Store(std::string source, rtxgi::EDDGIVolumeProbeVisType& destination)
+    void Store(const std::string& source, rtxgi::EDDGIVolumeProbeVisType& destination)
     {
         destination = (rtxgi::EDDGIVolumeProbeVisType)stoi(source);
     }
 
+    //----------------------------------------------------------------------------------------------------------
+    // DDGIVolume Keys
+    //----------------------------------------------------------------------------------------------------------
+
+    /**
+     * Hash a config key (FNV-1a), evaluated at compile time for the key table.
+     */
+    constexpr uint32_t HashKey(const char* key, size_t length)
+    {
+        uint32_t hash = 2166136261u;
+        for (size_t index = 0; index < length; index++) hash = (hash ^ static_cast<uint8_t>(key[index])) * 16777619u;
+        return hash;
+    }
+
+    constexpr uint32_t HashKey(const char* key)
+    {
+        size_t length = 0;
+        while (key[length] != '\0') length++;
+        return HashKey(key, length);
+    }
+
+    bool Equal(const XMFLOAT3& a, const XMFLOAT3& b) { return (a.x == b.x) && (a.y == b.y) && (a.z == b.z); }
+    bool Equal(const XMINT3& a, const XMINT3& b) { return (a.x == b.x) && (a.y == b.y) && (a.z == b.z); }
+
+    template<typename T>
+    bool Equal(const T& a, const T& b) { return (a == b); }
+
+    /**
+     * A DDGIVolume config key (the part after "ddgi.volume.<index>."), how its value is stored,
+     * and how the running volume takes a change of it on hot reload (see DiffDDGIVolume()).
+     */
+    struct VolumeKey
+    {
+        const char* key;
+        uint32_t hash;
+        EDDGIVolumeChange change;
+        void (*store)(const std::string& data, DDGIVolume& volume);
+        bool (*equal)(const DDGIVolume& a, const DDGIVolume& b);
+    };
+
+    #define VOLUME_KEY(key, change, store, member) { key, HashKey(key), EDDGIVolumeChange::change, \
+        [](const std::string& data, DDGIVolume& volume) { store(data, volume.member); }, \
+        [](const DDGIVolume& a, const DDGIVolume& b) { return Equal(a.member, b.member); } }
+
+    constexpr VolumeKey VolumeKeys[] =
+    {
+        // The volume's identity, movement type, and texture formats
+        VOLUME_KEY("name", REBUILD, Store, name),
+        VOLUME_KEY("infiniteScrolling.enabled", REBUILD, Store, infiniteScrollingEnabled),
+        VOLUME_KEY("textures.rayData.format", REBUILD, Store, textureFormats.rayDataFormat),
+        VOLUME_KEY("textures.irradiance.format", REBUILD, Store, textureFormats.irradianceFormat),
+        VOLUME_KEY("textures.distance.format", REBUILD, Store, textureFormats.distanceFormat),
+        VOLUME_KEY("textures.data.format", REBUILD, Store, textureFormats.dataFormat),
+        VOLUME_KEY("textures.variability.format", REBUILD, Store, textureFormats.variabilityFormat),
+
+        // The probe schedule buffer and the scheduling pipelines are only created for volumes that use them
+        VOLUME_KEY("probeClassification.blendActiveOnly", REBUILD, Store, probeBlendingActiveOnly),
+        VOLUME_KEY("probeScheduling.enabled", REBUILD, Store, probeSchedulingEnabled),
+
+        // The counts that size the probe textures (see DDGIVolumeDesc::ShouldAllocateProbes() and the like), also volume shader defines
+        VOLUME_KEY("probeCounts", TEXTURES, StoreWorldCounts, probeCounts),
+        VOLUME_KEY("probeNumRays", TEXTURES, Store, probeNumRays),
+        VOLUME_KEY("probeNumIrradianceTexels", TEXTURES, Store, probeNumIrradianceTexels),
+        VOLUME_KEY("probeNumDistanceTexels", TEXTURES, Store, probeNumDistanceTexels),
+
+        // The probe visibility masks need the probe schedule buffer, allocated with the volume's resources
+        VOLUME_KEY("probeVisibilityMask.enabled", TEXTURES, Store, probeVisibilityMaskEnabled),
+
+        // The published copies of the probe textures are allocated with the probe textures
+        VOLUME_KEY("probeAtlas.doubleBuffered", TEXTURES, Store, probeAtlasDoubleBuffered),
+
+        // Sparse probe textures are reserved resources instead of committed ones
+        VOLUME_KEY("probeSparseTextures.enabled", TEXTURES, Store, probeSparseTexturesEnabled),
+
+        // Settings without a DDGIVolume setter, read when the volume is created
+        VOLUME_KEY("rngSeed", SHADERS, Store, rngSeed),
+        VOLUME_KEY("probeRayRotationLowDiscrepancy", SHADERS, Store, probeRayRotationLowDiscrepancy),
+
+        // Settings with a DDGIVolume setter (see Graphics::DDGI::SetDDGIVolumeConstants())
+        VOLUME_KEY("origin", CONSTANTS, StoreWorldVector, origin),
+        VOLUME_KEY("rotation", CONSTANTS, StoreEulerAngles, eulerAngles),
+        VOLUME_KEY("probeSpacing", CONSTANTS, StoreWorldDistance, probeSpacing),
+        VOLUME_KEY("probeHysteresis", CONSTANTS, Store, probeHysteresis),
+        VOLUME_KEY("probeNormalBias", CONSTANTS, Store, probeNormalBias),
+        VOLUME_KEY("probeViewBias", CONSTANTS, Store, probeViewBias),
+        VOLUME_KEY("probeMaxRayDistance", CONSTANTS, Store, probeMaxRayDistance),
+        VOLUME_KEY("probeIrradianceThreshold", CONSTANTS, Store, probeIrradianceThreshold),
+        VOLUME_KEY("probeBrightnessThreshold", CONSTANTS, Store, probeBrightnessThreshold),
+        VOLUME_KEY("probeRelocation.enabled", CONSTANTS, Store, probeRelocationEnabled),
+        VOLUME_KEY("probeRelocation.minFrontfaceDistance", CONSTANTS, Store, probeMinFrontfaceDistance),
+        VOLUME_KEY("probeClassification.enabled", CONSTANTS, Store, probeClassificationEnabled),
+        VOLUME_KEY("probeVariability.enabled", CONSTANTS, Store, probeVariabilityEnabled),
+        VOLUME_KEY("probeVariability.threshold", CONSTANTS, Store, probeVariabilityThreshold),
+        VOLUME_KEY("probeVariability.freezeOnGPU", CONSTANTS, Store, probeVariabilityFreezeOnGPU),
+        VOLUME_KEY("probeScheduling.maxIntervalLog2", CONSTANTS, Store, probeSchedulingMaxIntervalLog2),
+        VOLUME_KEY("probeScheduling.fullRateDistance", CONSTANTS, Store, probeSchedulingFullRateDistance),
+        VOLUME_KEY("probeScheduling.variabilityThreshold", CONSTANTS, Store, probeSchedulingVariabilityThreshold),
+        VOLUME_KEY("probeTimeSlicing.strideLog2", CONSTANTS, Store, probeTimeSliceStrideLog2),
+        VOLUME_KEY("probeDerivation.volume", CONSTANTS, Store, probeDerivationVolume),
+        VOLUME_KEY("probeEventUpdates.enabled", CONSTANTS, Store, probeEventUpdatesEnabled),
+        VOLUME_KEY("probeEventUpdates.hysteresis", CONSTANTS, Store, probeEventHysteresis),
+        VOLUME_KEY("probeEventUpdates.recoveryFrames", CONSTANTS, Store, probeEventRecoveryFrames),
+        VOLUME_KEY("probeEventUpdates.idleIntervalLog2", CONSTANTS, Store, probeEventIdleIntervalLog2),
+        VOLUME_KEY("probeEventUpdates.idleVariabilityThreshold", CONSTANTS, Store, probeEventIdleVariabilityThreshold),
+        VOLUME_KEY("probeAdaptiveRays.enabled", CONSTANTS, Store, probeAdaptiveRaysEnabled),
+        VOLUME_KEY("probeAdaptiveRays.min", CONSTANTS, Store, probeAdaptiveRaysMin),
+        VOLUME_KEY("probeAdaptiveRays.variabilityThreshold", CONSTANTS, Store, probeAdaptiveRaysVariabilityThreshold),
+        VOLUME_KEY("probeAdaptiveHysteresis.enabled", CONSTANTS, Store, probeAdaptiveHysteresisEnabled),
+        VOLUME_KEY("probeAdaptiveHysteresis.min", CONSTANTS, Store, probeAdaptiveHysteresisMin),
+        VOLUME_KEY("probeAdaptiveHysteresis.max", CONSTANTS, Store, probeAdaptiveHysteresisMax),
+        VOLUME_KEY("probeAdaptiveHysteresis.variabilityThreshold", CONSTANTS, Store, probeAdaptiveHysteresisVariabilityThreshold),
+        VOLUME_KEY("vis.showProbes", CONSTANTS, Store, showProbes),
+        VOLUME_KEY("vis.probeVisType", CONSTANTS, Store, probeVisType),
+
+        // Settings of the test harness and visualization settings, read from the config every frame
+        VOLUME_KEY("budgetPriority", NONE, Store, budgetPriority),
+        VOLUME_KEY("probeCache.enabled", NONE, Store, probeCacheEnabled),
+        VOLUME_KEY("probeBake.enabled", NONE, Store, probeBakeEnabled),
+        VOLUME_KEY("vis.probeRadius", NONE, Store, probeRadius),
+        VOLUME_KEY("vis.probeDistanceDivisor", NONE, Store, probeDistanceDivisor),
+        VOLUME_KEY("vis.texture.rayDataScale", NONE, Store, probeRayDataScale),
+        VOLUME_KEY("vis.texture.irradianceScale", NONE, Store, probeIrradianceScale),
+        VOLUME_KEY("vis.texture.distanceScale", NONE, Store, probeDistanceScale),
+        VOLUME_KEY("vis.texture.probeDataScale", NONE, Store, probeDataScale),
+        VOLUME_KEY("vis.texture.probeVariabilityScale", NONE, Store, probeVariabilityScale),
+    };
+
+    #undef VOLUME_KEY
+
+    const static uint32_t NumVolumeKeys = sizeof(VolumeKeys) / sizeof(VolumeKey);
+    const static uint32_t VolumeKeySlots = 256;     // Open addressed, a power of two at least twice the number of keys
+    static_assert(NumVolumeKeys * 2 <= VolumeKeySlots, "Too many DDGIVolume keys for the key table!");
+
+    struct VolumeKeyTable
+    {
+        uint16_t slots[VolumeKeySlots];             // Index of the key in VolumeKeys, 0xFFFF when the slot is empty
+    };
+
+    constexpr VolumeKeyTable BuildVolumeKeyTable()
+    {
+        VolumeKeyTable table = {};
+        for (uint32_t slot = 0; slot < VolumeKeySlots; slot++) table.slots[slot] = 0xFFFF;
+        for (uint32_t keyIndex = 0; keyIndex < NumVolumeKeys; keyIndex++)
+        {
+            uint32_t slot = VolumeKeys[keyIndex].hash & (VolumeKeySlots - 1);
+            while (table.slots[slot] != 0xFFFF) slot = (slot + 1) & (VolumeKeySlots - 1);
+            table.slots[slot] = static_cast<uint16_t>(keyIndex);
+        }
+        return table;
+    }
+
+    constexpr VolumeKeyTable VolumeKeyLookup = BuildVolumeKeyTable();
+
+    /**
+     * Find a DDGIVolume config key, nullptr when the key is not supported.
+     */
+    const VolumeKey* FindVolumeKey(const std::string& key)
+    {
+        uint32_t hash = HashKey(key.data(), key.size());
+        for (uint32_t slot = hash & (VolumeKeySlots - 1); VolumeKeyLookup.slots[slot] != 0xFFFF; slot = (slot + 1) & (VolumeKeySlots - 1))
+        {
+            const VolumeKey& volumeKey = VolumeKeys[VolumeKeyLookup.slots[slot]];
+            if (volumeKey.hash == hash && key.compare(volumeKey.key) == 0) return &volumeKey;
+        }
+        return nullptr;
+    }
+
+    // A config entry of a DDGIVolume, the DDGIVolume entries are parsed once the other entries are
+    struct VolumeEntry
+    {
+        uint32_t lineNumber;
+        std::string key;
+        std::string rhs;
+    };
+
+    const static uint32_t parallelVolumeCount = 16;    // Volumes are parsed on worker threads from this many
+
+    /**
+     * Parse the DDGIVolume entries of the configuration file, the entries of each volume on a worker thread.
+     */
+    bool ParseConfigDDGIVolumeEntries(const std::vector<std::vector<VolumeEntry>>& volumeEntries, Config& config, std::ofstream& log)
+    {
+        if (volumeEntries.empty()) return true;
+
+        uint32_t numVolumes = static_cast<uint32_t>(volumeEntries.size());
+        config.ddgi.volumes.resize(numVolumes);
+        for (uint32_t volumeIndex = 0; volumeIndex < numVolumes; volumeIndex++)
+        {
+            if (volumeEntries[volumeIndex].empty())
+            {
+                log << "\nError: DDGIVolume " << volumeIndex << " has no config entries, volume indices must be contiguous!";
+                return false;
+            }
+            config.ddgi.volumes[volumeIndex].index = volumeIndex;
+        }
+
+        // The line of the first entry each volume fails to parse, the log is written once the jobs complete
+        std::vector<uint32_t> failedLines(numVolumes, 0);
+        std::vector<std::function<void()>> jobs;
+        for (uint32_t volumeIndex = 0; volumeIndex < numVolumes; volumeIndex++)
+        {
+            jobs.push_back([&volumeEntries, &config, &failedLines, volumeIndex]()
+            {
+                for (const VolumeEntry& entry : volumeEntries[volumeIndex])
+                {
+                    // Extract the data from the rhs, stripping out unnecessary characters
+                    std::string data;
+                    const VolumeKey* volumeKey = FindVolumeKey(entry.key);
+                    if (volumeKey == nullptr || !Extract(entry.rhs, data))
+                    {
+                        failedLines[volumeIndex] = entry.lineNumber;
+                        return;
+                    }
+                    volumeKey->store(data, config.ddgi.volumes[volumeIndex]);
+                }
+            });
+        }
+
+        if (numVolumes >= parallelVolumeCount)
+        {
+            Jobs::Pool volumeWorkers;
+            volumeWorkers.Start((std::max)(std::thread::hardware_concurrency(), 2u) - 1);
+            volumeWorkers.Run(jobs);
+        }
+        else
+        {
+            for (const std::function<void()>& job : jobs) job();
+        }
+
+        for (uint32_t volumeIndex = 0; volumeIndex < numVolumes; volumeIndex++)
+        {
+            if (failedLines[volumeIndex] == 0) continue;
+            log << "\nUnsupported configuration value specified!";
+            PARSE_CHECK(0, failedLines[volumeIndex], log);
+        }
+
+        return true;
+    }
+
+    /**
+     * Parse a benchmark configuration entry.
+     */
+    bool ParseConfigBenchmarkEntry(const std::vector<std::string>& tokens, const std::string& rhs, Config& config, uint32_t lineNumber, std::ofstream& log)
+    {
+        // Benchmark entries have 2 or 4 tokens
+        PARSE_CHECK((tokens.size() == 2 || tokens.size() == 4), lineNumber, log);
+
+        // Extract the data from the rhs, stripping out unnecessary characters
+        std::string data;
+        PARSE_CHECK(Extract(rhs, data), lineNumber, log);
+
+        if (tokens.size() == 2)
+        {
+            if (tokens[1].compare("warmupFrames") == 0) { Store(data, config.benchmark.warmupFrames); return true; }
+            if (tokens[1].compare("frames") == 0) { Store(data, config.benchmark.frames); return true; }
+        }
+
+        // Camera spline keyframes
+        if (tokens.size() == 4 && tokens[1].compare("keyframes") == 0)
+        {
+            uint32_t keyframeIndex = static_cast<uint32_t>(stoi(tokens[2]));
+            if (keyframeIndex >= config.benchmark.keyframes.size()) config.benchmark.keyframes.resize(keyframeIndex + 1);
+
+            if (tokens[3].compare("position") == 0) { StoreWorldVector(data, config.benchmark.keyframes[keyframeIndex].position); return true; }
+            if (tokens[3].compare("yaw") == 0) { Store(data, config.benchmark.keyframes[keyframeIndex].yaw); return true; }
+            if (tokens[3].compare("pitch") == 0) { Store(data, config.benchmark.keyframes[keyframeIndex].pitch); return true; }
+        }
+
+        log << "\nUnsupported configuration value specified!";
+        PARSE_CHECK(0, lineNumber, log);
+        return false;
+    }
+
     /**
      * Parse a post process configuration entry.
      */
@@ -177,6 +494,8 @@ namespace Configs
         {
             if (tokens[2].compare("enable") == 0) { Store(data, config.postProcess.exposure.enabled); return true; }
             if (tokens[2].compare("fstops") == 0) { Store(data, config.postProcess.exposure.fstops); return true; }
+            if (tokens[2].compare("automatic") == 0) { Store(data, config.postProcess.exposure.automatic); return true; }
+            if (tokens[2].compare("adaptation") == 0) { Store(data, config.postProcess.exposure.adaptation); return true; }
         }
 
         if (tokens[1].compare("tonemap") == 0)
@@ -194,6 +513,11 @@ namespace Configs
             if (tokens[2].compare("enable") == 0) { Store(data, config.postProcess.gamma.enabled); return true; }
         }
 
+        if (tokens[1].compare("vrs") == 0)
+        {
+            if (tokens[2].compare("enable") == 0) { Store(data, config.postProcess.vrs.enabled); return true; }
+        }
+
         log << "\nUnsupported configuration value specified!";
         PARSE_CHECK(0, lineNumber, log);
         return false;
@@ -204,169 +528,31 @@ namespace Configs
      */
     bool ParseConfigDDGIEntry(const std::vector<std::string>& tokens, const std::string& rhs, Config& config, uint32_t lineNumber, std::ofstream& log)
     {
-        // DDGI entries have no more than 6 tokens
-        PARSE_CHECK((tokens.size() <= 6), lineNumber, log);
+        // DDGI entries have no more than 3 tokens (DDGIVolume entries are parsed by ParseConfigDDGIVolumeEntries())
+        PARSE_CHECK((tokens.size() <= 3), lineNumber, log);
 
         // Extract the data from the rhs, stripping out unnecessary characters
         std::string data;
         PARSE_CHECK(Extract(rhs, data), lineNumber, log);
 
-        if (tokens[1].compare("volume") == 0)
+        if (tokens[1].compare("indirectScale") == 0) { Store(data, config.ddgi.indirectScale); return true; }
+        if (tokens[1].compare("rasterizeProbes") == 0) { Store(data, config.ddgi.rasterizeProbes); return true; }
+        if (tokens[1].compare("proceduralProbes") == 0) { Store(data, config.ddgi.proceduralProbes); return true; }
+        if (tokens[1].compare("radianceCacheFile") == 0) { Store(data, config.ddgi.radianceCacheFileEnabled); return true; }
+        if (tokens[1].compare("radianceCacheHash") == 0) { Store(data, config.ddgi.radianceCacheHash); return true; }
+        if (tokens[1].compare("radianceCacheBricks") == 0) { Store(data, config.ddgi.radianceCacheBricks); return true; }
+        if (tokens[1].compare("memoryBudget") == 0) { Store(data, config.ddgi.memoryBudget); return true; }
+        if (tokens[1].compare("memoryBudgetAdaptive") == 0) { Store(data, config.ddgi.memoryBudgetAdaptive); return true; }
+        if (tokens[1].compare("costBudget") == 0) { Store(data, config.ddgi.costBudget); return true; }
+        if (tokens[1].compare("costBudgetHysteresis") == 0) { Store(data, config.ddgi.costBudgetHysteresis); return true; }
+        if (tokens[1].compare("probeDeltas") == 0) { Store(data, config.ddgi.probeDeltas); return true; }
+
+        if (tokens[1].compare("probePlacement") == 0 && tokens.size() == 3)
         {
-            int volumeIndex = stoi(tokens[2]);
-            if (volumeIndex >= static_cast<int>(config.ddgi.volumes.size()))
-            {
-                config.ddgi.volumes.emplace_back();
-                config.ddgi.volumes.back().index = volumeIndex;
-            }
-
-            if (tokens[3].compare("name") == 0) { config.ddgi.volumes[volumeIndex].name = data; return true; }
-            if (tokens[3].compare("origin") == 0) { StoreWorldVector(data, config.ddgi.volumes[volumeIndex].origin); return true; }
-            if (tokens[3].compare("rotation") == 0) { StoreEulerAngles(data, config.ddgi.volumes[volumeIndex].eulerAngles); return true; }
-            if (tokens[3].compare("probeCounts") == 0) { StoreWorldCounts(data, config.ddgi.volumes[volumeIndex].probeCounts); return true; }
-            if (tokens[3].compare("probeSpacing") == 0) { StoreWorldDistance(data, config.ddgi.volumes[volumeIndex].probeSpacing); return true; }
-            if (tokens[3].compare("probeNumRays") == 0) { Store(data, config.ddgi.volumes[volumeIndex].probeNumRays); return true; }
-            if (tokens[3].compare("probeNumIrradianceTexels") == 0) { Store(data, config.ddgi.volumes[volumeIndex].probeNumIrradianceTexels); return true; }
-            if (tokens[3].compare("probeNumDistanceTexels") == 0) { Store(data, config.ddgi.volumes[volumeIndex].probeNumDistanceTexels); return true; }
-            if (tokens[3].compare("probeHysteresis") == 0) { Store(data, config.ddgi.volumes[volumeIndex].probeHysteresis); return true; }
-            if (tokens[3].compare("probeNormalBias") == 0) { Store(data, config.ddgi.volumes[volumeIndex].probeNormalBias); return true; }
-            if (tokens[3].compare("probeViewBias") == 0) { Store(data, config.ddgi.volumes[volumeIndex].probeViewBias); return true; }
-            if (tokens[3].compare("probeMaxRayDistance") == 0) { Store(data, config.ddgi.volumes[volumeIndex].probeMaxRayDistance); return true; }
-            if (tokens[3].compare("probeIrradianceThreshold") == 0) { Store(data, config.ddgi.volumes[volumeIndex].probeIrradianceThreshold); return true; }
-            if (tokens[3].compare("probeBrightnessThreshold") == 0) { Store(data, config.ddgi.volumes[volumeIndex].probeBrightnessThreshold); return true; }
-            if (tokens[3].compare("rngSeed") == 0) { Store(data, config.ddgi.volumes[volumeIndex].rngSeed); return true; }
-
-            if (tokens[3].compare("probeRelocation") == 0)
-            { 
-                if (tokens.size() == 5 && tokens[4].compare("enabled") == 0)
-                {
-                    Store(data, config.ddgi.volumes[volumeIndex].probeRelocationEnabled);
-                    return true;
-                }
-                else if (tokens.size() == 5 && tokens[4].compare("minFrontfaceDistance") == 0)
-                {
-                    Store(data, config.ddgi.volumes[volumeIndex].probeMinFrontfaceDistance);
-                    return true;
-                }
-            }
-
-            if (tokens[3].compare("probeClassification") == 0)
-            {
-                if (tokens.size() == 5 && tokens[4].compare("enabled") == 0)
-                {
-                    Store(data, config.ddgi.volumes[volumeIndex].probeClassificationEnabled); return true;
-                }
-            }
-
-            if (tokens[3].compare("probeVariability") == 0)
-            {
-                if (tokens.size() == 5 && tokens[4].compare("enabled") == 0)
-                {
-                    Store(data, config.ddgi.volumes[volumeIndex].probeVariabilityEnabled); return true;
-                }
-                else if (tokens.size() == 5 && tokens[4].compare("threshold") == 0)
-                {
-                    Store(data, config.ddgi.volumes[volumeIndex].probeVariabilityThreshold); return true;
-                }
-            }
-
-            if (tokens[3].compare("infiniteScrolling") == 0)
-            {
-                if (tokens.size() == 5 && tokens[4].compare("enabled") == 0)
-                {
-                    Store(data, config.ddgi.volumes[volumeIndex].infiniteScrollingEnabled);
-                    return true;
-                }
-            }
-
-            if (tokens[3].compare("textures") == 0)
-            {
-                if (tokens[4].compare("rayData") == 0 && tokens[5].compare("format") == 0)
-                {
-                    Store(data, config.ddgi.volumes[volumeIndex].textureFormats.rayDataFormat);
-                    return true;
-                }
-                else if (tokens[4].compare("irradiance") == 0 && tokens[5].compare("format") == 0)
-                {
-                    Store(data, config.ddgi.volumes[volumeIndex].textureFormats.irradianceFormat);
-                    return true;
-                }
-                else if (tokens[4].compare("distance") == 0 && tokens[5].compare("format") == 0)
-                {
-                    Store(data, config.ddgi.volumes[volumeIndex].textureFormats.distanceFormat);
-                    return true;
-                }
-                else if (tokens[4].compare("data") == 0 && tokens[5].compare("format") == 0)
-                {
-                    Store(data, config.ddgi.volumes[volumeIndex].textureFormats.dataFormat);
-                    return true;
-                }
-                else if (tokens[4].compare("variability") == 0 && tokens[5].compare("format") == 0)
-                {
-                    Store(data, config.ddgi.volumes[volumeIndex].textureFormats.variabilityFormat);
-                    return true;
-                }
-            }
-
-            if (tokens[3].compare("vis") == 0)
-            {
-                if(tokens[4].compare("probeVisType") == 0)
-                {
-                    Store(data, config.ddgi.volumes[volumeIndex].probeVisType);
-                    return true;
-                }
-
-                if (tokens[4].compare("probeRadius") == 0)
-                {
-                    Store(data, config.ddgi.volumes[volumeIndex].probeRadius);
-                    return true;
-                }
-
-                if (tokens[4].compare("probeDistanceDivisor") == 0)
-                {
-                    Store(data, config.ddgi.volumes[volumeIndex].probeDistanceDivisor);
-                    return true;
-                }
-
-                if (tokens[4].compare("showProbes") == 0)
-                {
-                    Store(data, config.ddgi.volumes[volumeIndex].showProbes);
-                    return true;
-                }
-
-                if (tokens[4].compare("texture") == 0)
-                {
-                    if (tokens[5].compare("rayDataScale") == 0)
-                    {
-                        Store(data, config.ddgi.volumes[volumeIndex].probeRayDataScale);
-                        return true;
-                    }
-
-                    if (tokens[5].compare("irradianceScale") == 0)
-                    {
-                        Store(data, config.ddgi.volumes[volumeIndex].probeIrradianceScale);
-                        return true;
-                    }
-
-                    if (tokens[5].compare("distanceScale") == 0)
-                    {
-                        Store(data, config.ddgi.volumes[volumeIndex].probeDistanceScale);
-                        return true;
-                    }
-
-                    if (tokens[5].compare("probeDataScale") == 0)
-                    {
-                        Store(data, config.ddgi.volumes[volumeIndex].probeDataScale);
-                        return true;
-                    }
-
-                    if (tokens[5].compare("probeVariabilityScale") == 0)
-                    {
-                        Store(data, config.ddgi.volumes[volumeIndex].probeVariabilityScale);
-                        return true;
-                    }
-                }
-            }
+            if (tokens[2].compare("enabled") == 0) { Store(data, config.ddgi.probePlacement); return true; }
+            if (tokens[2].compare("budget") == 0) { Store(data, config.ddgi.probePlacementBudget); return true; }
+            if (tokens[2].compare("maxVolumes") == 0) { Store(data, config.ddgi.probePlacementMaxVolumes); return true; }
+            if (tokens[2].compare("minSpacing") == 0) { Store(data, config.ddgi.probePlacementMinSpacing); return true; }
         }
 
         log << "\nUnsupported configuration value specified!";
@@ -393,6 +579,8 @@ namespace Configs
         if (tokens[1].compare("powerLog") == 0) { Store(data, config.rtao.powerLog); return true; }
         if (tokens[1].compare("filterDistanceSigma") == 0) { Store(data, config.rtao.filterDistanceSigma); return true; }
         if (tokens[1].compare("filterDepthSigma") == 0) { Store(data, config.rtao.filterDepthSigma); return true; }
+        if (tokens[1].compare("temporal") == 0) { Store(data, config.rtao.temporal); return true; }
+        if (tokens[1].compare("temporalMaxHistory") == 0) { Store(data, config.rtao.temporalMaxHistory); return true; }
 
         log << "\nUnsupported configuration value specified!";
         PARSE_CHECK(0, lineNumber, log);
@@ -415,7 +603,12 @@ namespace Configs
         if (tokens[1].compare("rayViewBias") == 0) { Store(data, config.pathTrace.rayViewBias); return true; }
         if (tokens[1].compare("numBounces") == 0) { Store(data, config.pathTrace.numBounces); return true; }
         if (tokens[1].compare("samplesPerPixel") == 0) { Store(data, config.pathTrace.samplesPerPixel); return true; }
+        if (tokens[1].compare("radianceCacheBounce") == 0) { Store(data, config.pathTrace.radianceCacheBounce); return true; }
         if (tokens[1].compare("antialiasing") == 0) { Store(data, config.pathTrace.antialiasing); return true; }
+        if (tokens[1].compare("wavefront") == 0) { Store(data, config.pathTrace.wavefront); return true; }
+        if (tokens[1].compare("convergence") == 0) { Store(data, config.pathTrace.convergence); return true; }
+        if (tokens[1].compare("convergenceSteering") == 0) { Store(data, config.pathTrace.convergenceSteering); return true; }
+        if (tokens[1].compare("convergenceThreshold") == 0) { Store(data, config.pathTrace.convergenceThreshold); return true; }
 
         log << "\nUnsupported configuration value specified!";
         PARSE_CHECK(0, lineNumber, log);
@@ -437,6 +630,7 @@ namespace Configs
         if (tokens[1].compare("movementSpeed") == 0) { Store(data, config.input.movementSpeed); return true; }
         if (tokens[1].compare("rotationSpeed") == 0) { Store(data, config.input.rotationSpeed); return true; }
         if (tokens[1].compare("invertPan") == 0) { Store(data, config.input.invertPan); return true; }
+        if (tokens[1].compare("lateLatch") == 0) { Store(data, config.input.lateLatch); return true; }
 
         log << "\nUnsupported configuration value specified!";
         PARSE_CHECK(0, lineNumber, log);
@@ -461,9 +655,19 @@ namespace Configs
             if (tokens[1].compare("name") == 0) { config.scene.name = data; return true; }
             if (tokens[1].compare("path") == 0) { config.scene.path = data; return true; }
             if (tokens[1].compare("file") == 0) { config.scene.file = data; return true; }
+            if (tokens[1].compare("placements") == 0) { config.scene.placements = data; return true; }
             if (tokens[1].compare("screenshotPath") == 0) { config.scene.screenshotPath = data; return true; }
             if (tokens[1].compare("skyColor") == 0) { Store(data, config.scene.skyColor); return true; }
             if (tokens[1].compare("skyIntensity") == 0) { Store(data, config.scene.skyIntensity); return true; }
+            if (tokens[1].compare("sortTriangles") == 0) { Store(data, config.scene.sortTriangles); return true; }
+        }
+
+        // Texture streaming
+        if (tokens.size() == 3 && tokens[1].compare("textureStreaming") == 0)
+        {
+            if (tokens[2].compare("enable") == 0) { Store(data, config.scene.textureStreaming); return true; }
+            if (tokens[2].compare("budget") == 0) { Store(data, config.scene.textureStreamingBudget); return true; }
+            if (tokens[2].compare("tailSize") == 0) { Store(data, config.scene.textureStreamingTailSize); return true; }
         }
 
         // Lights
@@ -519,6 +723,9 @@ namespace Configs
         if (tokens[1].compare("disableValidation") == 0) { Store(data, config.shaders.disableValidation); return true; }
         if (tokens[1].compare("shaderSymbols") == 0) { Store(data, config.shaders.shaderSymbols); return true; }
         if (tokens[1].compare("lifetimeMarkers") == 0) { Store(data, config.shaders.lifetimeMarkers); return true; }
+        if (tokens[1].compare("cache") == 0) { Store(data, config.shaders.cache); return true; }
+        if (tokens[1].compare("pipelineCache") == 0) { Store(data, config.shaders.pipelineCache); return true; }
+        if (tokens[1].compare("watchPort") == 0) { Store(data, config.shaders.watchPort); return true; }
 
         log << "\nUnsupported configuration value specified!";
         PARSE_CHECK(0, lineNumber, log);
@@ -542,6 +749,21 @@ namespace Configs
         if (tokens[1].compare("vsync") == 0) { Store(data, config.app.vsync); return true; }
         if (tokens[1].compare("fullscreen") == 0) { Store(data, config.app.fullscreen); return true; }
         if (tokens[1].compare("showUI") == 0) { Store(data, config.app.showUI); return true; }
+        if (tokens[1].compare("uiLowOverhead") == 0) { Store(data, config.app.uiLowOverhead); return true; }
+        if (tokens[1].compare("visibilityBuffer") == 0) { Store(data, config.app.visibilityBuffer); return true; }
+        if (tokens[1].compare("gbufferTiles") == 0) { Store(data, config.app.gbufferTiles); return true; }
+        if (tokens[1].compare("gpuCounters") == 0) { Store(data, config.app.gpuCounters); return true; }
+        if (tokens[1].compare("parallelRecording") == 0) { Store(data, config.app.parallelRecording); return true; }
+        if (tokens[1].compare("enhancedBarriers") == 0) { Store(data, config.app.enhancedBarriers); return true; }
+        if (tokens[1].compare("rayTracingBackend") == 0) { Store(data, config.app.rayTracingBackend); return true; }
+        if (tokens[1].compare("traceFrames") == 0) { Store(data, config.app.traceFrames); return true; }
+        if (tokens[1].compare("captureInterval") == 0) { Store(data, config.app.captureInterval); return true; }
+        if (tokens[1].compare("captureFormat") == 0) { Store(data, config.app.captureFormat); return true; }
+        if (tokens[1].compare("captureHdr") == 0) { Store(data, config.app.captureHdr); return true; }
+        if (tokens[1].compare("hotReload") == 0) { Store(data, config.app.hotReload); return true; }
+        if (tokens[1].compare("dynamicResolution") == 0) { Store(data, config.app.dynamicResolution); return true; }
+        if (tokens[1].compare("dynamicResolutionFPS") == 0) { Store(data, config.app.dynamicResolutionFPS); return true; }
+        if (tokens[1].compare("dynamicResolutionMinScale") == 0) { Store(data, config.app.dynamicResolutionMinScale); return true; }
         if (tokens[1].compare("root") == 0)
         {
             std::filesystem::path configFilePath(config.app.filepath);
@@ -575,18 +797,20 @@ namespace Configs
     /**
      * Parse the configuration file.
      */
-    bool ParseConfig(const char* buffer, Config& config, std::ofstream& log)
+    bool ParseConfig(const char* buffer, size_t size, Config& config, std::ofstream& log)
     {
-        std::string file(buffer);
-        std::stringstream stream;
         std::string line;
         uint32_t lineNumber = 0;
+        std::vector<std::vector<VolumeEntry>> volumeEntries;
 
-        stream.str(file);
-        while (!stream.eof())
+        // Lines end with a line break, text after the last one is ignored
+        const char* end = buffer + size;
+        for (const char* start = buffer; start < end;)
         {
-            getline(stream, line, '\n');
-            if (stream.eof()) break;
+            const char* lineEnd = std::find(start, end, '\n');
+            if (lineEnd == end) break;
+            line.assign(start, lineEnd);
+            start = lineEnd + 1;
             lineNumber++;
             if (line.length() == 0) continue;                      // line break, skip it
             if (line.find_first_of("#\t%\x0D\x0A") == 0) continue; // commented line, skip it
@@ -598,6 +822,19 @@ namespace Configs
             // Split the variable expression on each '.' character
             std::vector<std::string> tokens = Split(expression[0]);
 
+            // DDGIVolume entries (ddgi.volume.<index>.<key>), gathered by volume and parsed after the loop
+            if (tokens.size() >= 4 && tokens[0].compare("ddgi") == 0 && tokens[1].compare("volume") == 0)
+            {
+                char* indexEnd = nullptr;
+                unsigned long volumeIndex = strtoul(tokens[2].c_str(), &indexEnd, 10);
+                PARSE_CHECK((!tokens[2].empty() && *indexEnd == '\0' && volumeIndex < UINT16_MAX), lineNumber, log);
+                if (volumeIndex >= volumeEntries.size()) volumeEntries.resize(volumeIndex + 1);
+
+                size_t keyStart = tokens[0].size() + tokens[1].size() + tokens[2].size() + 3;
+                volumeEntries[volumeIndex].push_back({ lineNumber, expression[0].substr(keyStart), expression[1] });
+                continue;
+            }
+
             if (tokens[0].compare("app") == 0) { CHECK(ParseConfigAppEntry(tokens, expression[1], config, lineNumber, log), "parse config application entry!", log); continue; };
             if (tokens[0].compare("shaders") == 0) { CHECK(ParseConfigShadersEntry(tokens, expression[1], config, lineNumber, log), "parse config shaders entry!", log); continue; };
             if (tokens[0].compare("scene") == 0) { CHECK(ParseConfigSceneEntry(tokens, expression[1], config, lineNumber, log), "parse config scene entry!", log); continue; };
@@ -606,6 +843,23 @@ namespace Configs
             if (tokens[0].compare("ddgi") == 0) { CHECK(ParseConfigDDGIEntry(tokens, expression[1], config, lineNumber, log), "parse config ddgi entry!", log); continue; };
             if (tokens[0].compare("rtao") == 0) { CHECK(ParseConfigRTAOEntry(tokens, expression[1], config, lineNumber, log), "parse config rtao entry!", log); continue; };
             if (tokens[0].compare("pp") == 0) { CHECK(ParseConfigPostProcessEntry(tokens, expression[1], config, lineNumber, log), "parse config post process entry!", log); continue; };
+            if (tokens[0].compare("bench") == 0) { CHECK(ParseConfigBenchmarkEntry(tokens, expression[1], config, lineNumber, log), "parse config benchmark entry!", log); continue; };
+        }
+
+        CHECK(ParseConfigDDGIVolumeEntries(volumeEntries, config, log), "parse config ddgi volume entries!", log);
+
+        // Check the indirect lighting resolution divisor
+        if (config.ddgi.indirectScale != 1 && config.ddgi.indirectScale != 2 && config.ddgi.indirectScale != 4)
+        {
+            log << "\nWarning: ddgi.indirectScale must be 1, 2, or 4! Using full resolution indirect lighting.\n";
+            config.ddgi.indirectScale = 1;
+        }
+
+        // Check the radiance cache hash function
+        if (config.ddgi.radianceCacheHash > 3)
+        {
+            log << "\nWarning: ddgi.radianceCacheHash must be 0, 1, 2, or 3! Using the FNV-1a + Wang hash.\n";
+            config.ddgi.radianceCacheHash = 0;
         }
 
         // Check the probe ray counts for each volume
@@ -620,6 +874,117 @@ namespace Configs
         return true;
     }
 
+    // Placements file layout (little endian, positions and angles in the right hand, y-up coordinate system of the config file):
+    //   PlacementsHeader
+    //   PlacementsVolume[numVolumes]
+    //   PlacementsLight[numLights]
+    #define PLACEMENTS_MAGIC 0x50585452   // 'RTXP'
+    #define PLACEMENTS_VERSION 1
+
+    struct PlacementsHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t numVolumes;
+        uint32_t numLights;
+    };
+
+    // An instance of a DDGIVolume of the config file, placed elsewhere
+    struct PlacementsVolume
+    {
+        uint32_t templateIndex;                 // Volume of the config file whose settings are copied
+        XMFLOAT3 origin;
+        XMFLOAT3 rotation;                      // Euler angles, degrees
+    };
+
+    struct PlacementsLight
+    {
+        uint32_t type;                          // ELightType
+        XMFLOAT3 position;
+        XMFLOAT3 direction;
+        XMFLOAT3 color;
+        float power;
+        float radius;
+        float umbraAngle;
+        float penumbraAngle;
+    };
+
+    /**
+     * Load a placements file (config scene.placements) and add its volumes and lights after the ones of the config file.
+     * The records are read in bulk, scenes with hundreds of volumes and thousands of lights skip parsing their config entries.
+     */
+    bool LoadPlacements(const std::string& filepath, Config& config, std::ofstream& log)
+    {
+        std::ifstream in(filepath, std::ios::in | std::ios::binary);
+        if (!in.is_open())
+        {
+            log << "\nError: failed to open the placements file: '" << filepath << "'";
+            return false;
+        }
+
+        PlacementsHeader header = {};
+        in.read((char*)&header, sizeof(PlacementsHeader));
+        if (!in.good() || header.magic != PLACEMENTS_MAGIC || header.version != PLACEMENTS_VERSION)
+        {
+            log << "\nError: '" << filepath << "' is not a placements file of version " << PLACEMENTS_VERSION;
+            return false;
+        }
+
+        std::vector<PlacementsVolume> volumes(header.numVolumes);
+        std::vector<PlacementsLight> lights(header.numLights);
+        in.read((char*)volumes.data(), sizeof(PlacementsVolume) * volumes.size());
+        in.read((char*)lights.data(), sizeof(PlacementsLight) * lights.size());
+        if (!in.good())
+        {
+            log << "\nError: the placements file '" << filepath << "' is truncated";
+            return false;
+        }
+        in.close();
+
+        size_t numTemplates = config.ddgi.volumes.size();
+        config.ddgi.volumes.reserve(numTemplates + volumes.size());
+        for (const PlacementsVolume& placement : volumes)
+        {
+            if (placement.templateIndex >= numTemplates)
+            {
+                log << "\nError: placements file volume template " << placement.templateIndex << " is not a volume of the config file";
+                return false;
+            }
+
+            DDGIVolume volume = config.ddgi.volumes[placement.templateIndex];
+            volume.index = static_cast<uint32_t>(config.ddgi.volumes.size());
+            volume.name = volume.name + "-" + std::to_string(volume.index);
+            volume.origin = ToWorldVector(placement.origin);
+            volume.eulerAngles = ToEulerAngles(placement.rotation);
+            config.ddgi.volumes.push_back(std::move(volume));
+        }
+
+        config.scene.lights.reserve(config.scene.lights.size() + lights.size());
+        for (const PlacementsLight& placement : lights)
+        {
+            if (placement.type >= static_cast<uint32_t>(ELightType::COUNT))
+            {
+                log << "\nError: placements file light type " << placement.type << " is not supported";
+                return false;
+            }
+
+            config.scene.lights.emplace_back();
+            Light& light = config.scene.lights.back();
+            light.name = "Light " + std::to_string(config.scene.lights.size() - 1);
+            light.type = static_cast<ELightType>(placement.type);
+            light.position = ToWorldVector(placement.position);
+            light.direction = ToWorldVector(placement.direction);
+            light.color = placement.color;
+            light.power = placement.power;
+            light.radius = placement.radius;
+            light.umbraAngle = placement.umbraAngle;
+            light.penumbraAngle = placement.penumbraAngle;
+        }
+
+        log << "\n\tAdded " << volumes.size() << " volumes and " << lights.size() << " lights from the placements file";
+        return true;
+    }
+
     //----------------------------------------------------------------------------------------------------------
     // Public Functions
     //----------------------------------------------------------------------------------------------------------
@@ -630,6 +995,15 @@ namespace Configs
      *   --debug-capture              Enable debug capture mode
      *   --debug-output <folder>      Output folder for debug images (default: visual_debug)
      *   --debug-frames <N>           Frame delay before capture (default: 60)
+     * Supports a headless benchmark of one or more configuration files:
+     *   --benchmark <config> [...]   Benchmark each config in turn (bench.* entries), then exit
+     *   --baselines <folder>         Compare each config's benchmark results against <folder>/<config>.csv
+     *   --update-baselines           Write the benchmark results over the baselines
+     *   --tolerance <percent>        Percent a pass's GPU time may exceed its baseline by (default: 5)
+     *   --compare-images             Fail the comparison when an image differs from its baseline
+     * Supports recording a run and replaying it frame by frame (see Replay.h):
+     *   --record <file>              Write the frames of the run to a replay log
+     *   --replay <file>              Replay the frames of a replay log, then exit and compare the GPU times against the recording
      */
     bool ParseCommandLine(const std::vector<std::string>& arguments, Config& config, std::ofstream& log)
     {
@@ -677,14 +1051,64 @@ namespace Configs
                     return false;
                 }
             }
-            else if (arg[0] != '-')
+            else if (arg == "--benchmark")
             {
-                // This is the config file path (not starting with -)
-                if (configPathFound)
+                config.benchmark.headless = true;
+                log << "Headless benchmark mode enabled\n";
+            }
+            else if (arg == "--baselines")
+            {
+                if (i + 1 < arguments.size())
+                {
+                    config.benchmark.baselines = arguments[++i];
+                    log << "Benchmark baselines path: " << config.benchmark.baselines << "\n";
+                }
+                else
+                {
+                    log << "\nError: --baselines requires a folder path argument\n";
+                    return false;
+                }
+            }
+            else if (arg == "--update-baselines")
+            {
+                config.benchmark.updateBaselines = true;
+            }
+            else if (arg == "--tolerance")
+            {
+                if (i + 1 < arguments.size())
+                {
+                    config.benchmark.tolerance = std::stof(arguments[++i]);
+                    log << "Benchmark regression tolerance: " << config.benchmark.tolerance << "%\n";
+                }
+                else
+                {
+                    log << "\nError: --tolerance requires a number argument\n";
+                    return false;
+                }
+            }
+            else if (arg == "--compare-images")
+            {
+                config.benchmark.compareImages = true;
+            }
+            else if (arg == "--record" || arg == "--replay")
+            {
+                if (i + 1 < arguments.size())
+                {
+                    std::string& path = (arg == "--record") ? config.benchmark.record : config.benchmark.replay;
+                    path = arguments[++i];
+                    log << ((arg == "--record") ? "Recording to replay log: " : "Replaying replay log: ") << path << "\n";
+                }
+                else
                 {
-                    log << "\nError: multiple config file paths specified\n";
+                    log << "\nError: " << arg << " requires a file path argument\n";
                     return false;
                 }
+            }
+            else if (arg[0] != '-')
+            {
+                // This is the config file path (not starting with -)
+                config.benchmark.configs.push_back(arg);
+                if (configPathFound) continue;
                 config.app.filepath = arg;
                 configPathFound = true;
             }
@@ -700,6 +1124,32 @@ namespace Configs
             return false;
         }
 
+        // Baselines are only compared by the headless benchmark
+        if (!config.benchmark.headless && !config.benchmark.baselines.empty())
+        {
+            log << "\nError: --baselines requires --benchmark\n";
+            return false;
+        }
+
+        // A run is either recorded or replayed, the headless benchmark follows its own camera spline
+        if (!config.benchmark.record.empty() && !config.benchmark.replay.empty())
+        {
+            log << "\nError: --record and --replay can't be combined\n";
+            return false;
+        }
+        if (config.benchmark.headless && (!config.benchmark.record.empty() || !config.benchmark.replay.empty()))
+        {
+            log << "\nError: --record and --replay can't be combined with --benchmark\n";
+            return false;
+        }
+
+        // Only the headless benchmark walks a list of config files
+        if (!config.benchmark.headless && config.benchmark.configs.size() > 1)
+        {
+            log << "\nError: multiple config file paths specified\n";
+            return false;
+        }
+
         return true;
     }
 
@@ -725,12 +1175,86 @@ namespace Configs
         file.close();
 
         // Parse the config file
-        CHECK(ParseConfig(buffer, config, log), "parse config file!", log);
+        CHECK(ParseConfig(buffer, fileSize, config, log), "parse config file!", log);
 
         // Delete the config file buffer
         delete[] buffer;
 
+        // Add the instanced volumes and lights of the placements file
+        if (!config.scene.placements.empty())
+        {
+            CHECK(LoadPlacements(config.app.root + config.scene.path + config.scene.placements, config, log), "load the scene placements file!", log);
+        }
+
         return true;
     }
 
+    /**
+     * Compare two configs of a DDGIVolume and return the cheapest way to apply the difference to the running volume.
+     */
+    EDDGIVolumeChange DiffDDGIVolume(const DDGIVolume& previous, const DDGIVolume& current)
+    {
+        if (previous.index != current.index) return EDDGIVolumeChange::REBUILD;
+
+        // The most expensive change of the volume's config keys (see VolumeKeys)
+        EDDGIVolumeChange change = (previous.insertPerfMarkers != current.insertPerfMarkers) ? EDDGIVolumeChange::CONSTANTS : EDDGIVolumeChange::NONE;
+        for (const VolumeKey& volumeKey : VolumeKeys)
+        {
+            if (volumeKey.change > change && !volumeKey.equal(previous, current)) change = volumeKey.change;
+        }
+        return change;
+    }
+
+    /**
+     * Parse the configuration file again and take its DDGIVolumes, returning how each volume changed (see DiffDDGIVolume()).
+     * The rest of the config is left as is. Fails, keeping the current volumes, when the file doesn't parse or the number of volumes changed.
+     */
+    bool ReloadDDGIVolumes(Config& config, std::vector<EDDGIVolumeChange>& changes, std::ofstream& log)
+    {
+        Config reloaded;
+        reloaded.app.filepath = config.app.filepath;
+        if (!Load(reloaded, log)) return false;
+
+        if (reloaded.ddgi.volumes.size() != config.ddgi.volumes.size())
+        {
+            log << "\nWarning: the number of DDGIVolumes changed, restart to apply the config file!\n";
+            return false;
+        }
+
+        changes.resize(config.ddgi.volumes.size());
+        for (size_t volumeIndex = 0; volumeIndex < config.ddgi.volumes.size(); volumeIndex++)
+        {
+            DDGIVolume& volume = config.ddgi.volumes[volumeIndex];
+            changes[volumeIndex] = DiffDDGIVolume(volume, reloaded.ddgi.volumes[volumeIndex]);
+
+            // Keep the pending requests of the UI
+            bool clearProbes = volume.clearProbes;
+            bool clearProbeVariability = volume.clearProbeVariability;
+            volume = reloaded.ddgi.volumes[volumeIndex];
+            volume.clearProbes = clearProbes;
+            volume.clearProbeVariability = clearProbeVariability;
+        }
+
+        return true;
+    }
+
+    /**
+     * Write the config entries that place a DDGIVolume (name, origin, probe counts, and probe spacing).
+     */
+    void WriteDDGIVolumePlacement(const DDGIVolume& volume, std::ostream& out)
+    {
+        XMFLOAT3 origin = FromWorldVector(volume.origin);
+        XMINT3 counts = FromWorldCounts(volume.probeCounts);
+
+        // Probe spacing is stored like the counts, an axis permutation without sign changes
+        XMINT3 axes = FromWorldCounts({ 0, 1, 2 });
+        const float* spacing = &volume.probeSpacing.x;
+
+        std::string prefix = "ddgi.volume." + std::to_string(volume.index) + ".";
+        out << prefix << "name=" << volume.name << "\n";
+        out << prefix << "origin=" << origin.x << " " << origin.y << " " << origin.z << "\n";
+        out << prefix << "probeCounts=" << counts.x << " " << counts.y << " " << counts.z << "\n";
+        out << prefix << "probeSpacing=" << spacing[axes.x] << " " << spacing[axes.y] << " " << spacing[axes.z] << "\n";
+    }
+
 }
@@ -11,6 +11,10 @@
 #include "Graphics.h"
 #include "UI.h"
 #include "ImageCapture.h"
+#include "Caches.h"
+#include "AppLogger.h"
+
+#include <filesystem>
 
 #if GFX_NVAPI
 #include "nvapi.h"
@@ -26,6 +30,16 @@ namespace Graphics
 
     namespace D3D12
     {
+        // Index of the first scene texture in the bindless texture arrays, material texture indices are offset by it
+    #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
+        static const int SCENE_TEXTURES_INDEX = DescriptorHeapOffsets::SRV_SCENE_TEXTURES - DescriptorHeapOffsets::SRV_TEX2D_START;
+    #elif RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_DESCRIPTOR_HEAP
+        static const int SCENE_TEXTURES_INDEX = DescriptorHeapOffsets::SRV_SCENE_TEXTURES;
+    #endif
+
+        // Private data of the root signatures created by the application: a hash of the serialized root signature
+        static const GUID RootSignatureHashGUID = { 0x6a4c4d1e, 0x2f3b, 0x4f0a, { 0x9b, 0x61, 0x3e, 0x57, 0x0c, 0x8d, 0x24, 0xa9 } };
+
         //----------------------------------------------------------------------------------------------------------
         // Private Functions
         //----------------------------------------------------------------------------------------------------------
@@ -116,6 +130,9 @@ namespace Graphics
                         continue;
                     }
 
+                    // Rasterizer ordered views are used by the rasterized probe visualization
+                    d3d.supportsRasterizerOrderedViews = features.ROVsSupported;
+
                 #if GFX_NVAPI
                     // Check for SER HLSL extension support
                     NvAPI_Status status = NvAPI_D3D12_IsNvShaderExtnOpCodeSupported(
@@ -147,12 +164,36 @@ namespace Graphics
                         d3d.features.waveLaneCount = waveFeatures.WaveLaneCountMin;
                     }
 
+                    // Check for variable rate shading tier 2 (shading rate image) support
+                    D3D12_FEATURE_DATA_D3D12_OPTIONS6 vrsFeatures = {};
+                    hr = d3d.device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS6, &vrsFeatures, sizeof(vrsFeatures));
+                    if (SUCCEEDED(hr) && vrsFeatures.VariableShadingRateTier >= D3D12_VARIABLE_SHADING_RATE_TIER_2)
+                    {
+                        d3d.supportsVariableRateShading = true;
+                        d3d.supportsAdditionalShadingRates = vrsFeatures.AdditionalShadingRatesSupported;
+                        d3d.shadingRateImageTileSize = vrsFeatures.ShadingRateImageTileSize;
+                    }
+
+                    // Check for resource heap tier 2 (transient buffers and textures share heaps)
+                    D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+                    hr = d3d.device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options));
+                    if (SUCCEEDED(hr)) d3d.supportsMixedResourceHeaps = (options.ResourceHeapTier >= D3D12_RESOURCE_HEAP_TIER_2);
+
+                    // Check for enhanced barriers support
+                    D3D12_FEATURE_DATA_D3D12_OPTIONS12 options12 = {};
+                    hr = d3d.device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS12, &options12, sizeof(options12));
+                    if (SUCCEEDED(hr)) d3d.supportsEnhancedBarriers = options12.EnhancedBarriersSupported;
+
                     // Set the graphics API name
                     config.app.api = "Direct3D 12";
 
                     // Save the GPU name
                     std::wstring name(adapterDesc.Description);
                     ConvertWideStringToNarrow(name, config.app.gpuName);
+
+                    // Save the driver (user mode driver) version
+                    LARGE_INTEGER driverVersion = {};
+                    if (SUCCEEDED(adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &driverVersion))) config.app.gpuDriverVersion = static_cast<uint64_t>(driverVersion.QuadPart);
                 #ifdef GFX_NAME_OBJECTS
                     d3d.device->SetName(name.c_str());
                 #endif
@@ -182,6 +223,20 @@ namespace Graphics
         #ifdef GFX_NAME_OBJECTS
             d3d.cmdQueue->SetName(L"Command Queue");
         #endif
+
+            // Create the compute queue for async compute
+            desc.Type = D3D12_COMMAND_LIST_TYPE_COMPUTE;
+            D3DCHECK(d3d.device->CreateCommandQueue(&desc, IID_PPV_ARGS(&d3d.computeQueue)));
+        #ifdef GFX_NAME_OBJECTS
+            d3d.computeQueue->SetName(L"Compute Command Queue");
+        #endif
+
+            // Create the copy queue for texture streaming uploads
+            desc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+            D3DCHECK(d3d.device->CreateCommandQueue(&desc, IID_PPV_ARGS(&d3d.copyQueue)));
+        #ifdef GFX_NAME_OBJECTS
+            d3d.copyQueue->SetName(L"Copy Command Queue");
+        #endif
             return true;
         }
 
@@ -197,7 +252,27 @@ namespace Graphics
                 std::wstring name = L"Command Allocator " + std::to_wstring(index);
                 d3d.cmdAlloc[index]->SetName(name.c_str());
             #endif
+
+                D3DCHECK(d3d.device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COMPUTE, IID_PPV_ARGS(&d3d.computeCmdAlloc[index])));
+            #ifdef GFX_NAME_OBJECTS
+                name = L"Compute Command Allocator " + std::to_wstring(index);
+                d3d.computeCmdAlloc[index]->SetName(name.c_str());
+            #endif
+
+                for (UINT passIndex = 0; passIndex <= MAX_PASS_CMD_LISTS; passIndex++)
+                {
+                    D3DCHECK(d3d.device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&d3d.passCmdAlloc[index][passIndex])));
+                #ifdef GFX_NAME_OBJECTS
+                    name = L"Pass Command Allocator " + std::to_wstring(index) + L"." + std::to_wstring(passIndex);
+                    d3d.passCmdAlloc[index][passIndex]->SetName(name.c_str());
+                #endif
+                }
             }
+
+            D3DCHECK(d3d.device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&d3d.copyCmdAlloc)));
+        #ifdef GFX_NAME_OBJECTS
+            d3d.copyCmdAlloc->SetName(L"Copy Command Allocator");
+        #endif
             return true;
         }
 
@@ -214,7 +289,30 @@ namespace Graphics
                 std::wstring name = L"Command List " + std::to_wstring(index);
                 d3d.cmdList[index]->SetName(name.c_str());
             #endif
+
+                D3DCHECK(d3d.device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COMPUTE, d3d.computeCmdAlloc[index], nullptr, IID_PPV_ARGS(&d3d.computeCmdList[index])));
+                D3DCHECK(d3d.computeCmdList[index]->Close());
+            #ifdef GFX_NAME_OBJECTS
+                name = L"Compute Command List " + std::to_wstring(index);
+                d3d.computeCmdList[index]->SetName(name.c_str());
+            #endif
+
+                for (UINT passIndex = 0; passIndex <= MAX_PASS_CMD_LISTS; passIndex++)
+                {
+                    D3DCHECK(d3d.device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, d3d.passCmdAlloc[index][passIndex], nullptr, IID_PPV_ARGS(&d3d.passCmdList[index][passIndex])));
+                    D3DCHECK(d3d.passCmdList[index][passIndex]->Close());
+                #ifdef GFX_NAME_OBJECTS
+                    name = L"Pass Command List " + std::to_wstring(index) + L"." + std::to_wstring(passIndex);
+                    d3d.passCmdList[index][passIndex]->SetName(name.c_str());
+                #endif
+                }
             }
+
+            D3DCHECK(d3d.device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, d3d.copyCmdAlloc, nullptr, IID_PPV_ARGS(&d3d.copyCmdList)));
+            D3DCHECK(d3d.copyCmdList->Close());
+        #ifdef GFX_NAME_OBJECTS
+            d3d.copyCmdList->SetName(L"Copy Command List");
+        #endif
             return true;
         }
 
@@ -252,6 +350,20 @@ namespace Graphics
                 if (FAILED(HRESULT_FROM_WIN32(GetLastError()))) return false;
             }
 
+            // Create the async compute fences (values only increase, never reset)
+            D3DCHECK(d3d.device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&d3d.graphicsToComputeFence)));
+            D3DCHECK(d3d.device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&d3d.computeToGraphicsFence)));
+        #ifdef GFX_NAME_OBJECTS
+            d3d.graphicsToComputeFence->SetName(L"Graphics To Compute Fence");
+            d3d.computeToGraphicsFence->SetName(L"Compute To Graphics Fence");
+        #endif
+
+            // Create the copy fence (values only increase, never reset)
+            D3DCHECK(d3d.device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&d3d.copyFence)));
+        #ifdef GFX_NAME_OBJECTS
+            d3d.copyFence->SetName(L"Copy Fence");
+        #endif
+
             return true;
         }
 
@@ -395,8 +507,17 @@ namespace Graphics
             D3D12_HEAP_PROPERTIES heapProps = {};
             heapProps.Type = D3D12_HEAP_TYPE_READBACK;
 
-            // Create the timestamps resource
-            D3DCHECK(d3d.device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &resourceDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&resources.timestamps)));
+            // Create the timestamps resources, one for each frame in flight
+            for (UINT frameIndex = 0; frameIndex < MAX_FRAMES_IN_FLIGHT; frameIndex++)
+            {
+                D3DCHECK(d3d.device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &resourceDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&resources.timestamps[frameIndex])));
+            #ifdef GFX_NAME_OBJECTS
+                resources.timestamps[frameIndex]->SetName(L"Timestamps Readback");
+            #endif
+
+                // Record the frame's stats without allocating
+                resources.timestampFrames[frameIndex].stats.reserve(MAX_TIMESTAMPS / 2);
+            }
 
             // Get the frequency of timestamp ticks
             D3DCHECK(d3d.cmdQueue->GetTimestampFrequency(&resources.timestampFrequency));
@@ -478,18 +599,243 @@ namespace Graphics
         }
 
         /**
-         * Create the index buffer for a mesh.
-         * Copy the index data to the upload buffer and schedule a copy to the device buffer.
+         * Create the pipeline library for this launch and open the library of the previous launch.
+         * The pipeline cache is disabled when the driver doesn't support pipeline libraries.
          */
-        bool CreateIndexBuffer(Globals& d3d, const Scenes::Mesh& mesh, ID3D12Resource** device, ID3D12Resource** upload, D3D12_INDEX_BUFFER_VIEW& view)
+        void CreatePipelineCache(Globals& d3d, const Configs::Config& config)
         {
-            // Create the index buffer upload resource
-            UINT sizeInBytes = mesh.numIndices * sizeof(UINT);
-            BufferDesc desc = { sizeInBytes, 0, EHeapType::UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE };
-            if (!CreateBuffer(d3d, desc, upload)) return false;
+            if (!config.shaders.pipelineCache) return;
+
+            // Create an empty pipeline library
+            if (FAILED(d3d.device->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&d3d.pipelines.library)))) return;
+
+            std::error_code ec;
+            std::filesystem::create_directories(config.app.root + "shadercache/", ec);
+            d3d.pipelines.filepath = config.app.root + "shadercache/pipelines.d3d12";
+
+            // Load the previous launch's pipeline library. It is discarded when a different adapter or driver wrote it.
+            std::ifstream file(d3d.pipelines.filepath, std::ios::binary);
+            if (!file.is_open()) return;
+
+            d3d.pipelines.previousData.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            if (d3d.pipelines.previousData.empty()) return;
+
+            HRESULT hr = d3d.device->CreatePipelineLibrary(d3d.pipelines.previousData.data(), d3d.pipelines.previousData.size(), IID_PPV_ARGS(&d3d.pipelines.previous));
+            if (FAILED(hr))
+            {
+                d3d.pipelines.previous = nullptr;
+                d3d.pipelines.previousData.clear();
+            }
+        }
+
+        /**
+         * Write the pipelines used this launch to disk and release the pipeline cache.
+         */
+        void ReleasePipelineCache(Globals& d3d)
+        {
+            PipelineCache& pipelines = d3d.pipelines;
+            if (pipelines.library && !pipelines.filepath.empty())
+            {
+                std::vector<char> data(pipelines.library->GetSerializedSize());
+                if (!data.empty() && SUCCEEDED(pipelines.library->Serialize(data.data(), data.size())))
+                {
+                    // Write to a temporary file and replace the library, so a failed write doesn't leave a truncated library
+                    std::error_code ec;
+                    std::string temp = pipelines.filepath + ".tmp";
+                    std::ofstream file(temp, std::ios::binary);
+                    file.write(data.data(), data.size());
+                    file.close();
+                    if (!file.fail()) std::filesystem::rename(temp, pipelines.filepath, ec);
+                }
+            }
+
+            for (size_t index = 0; index < pipelines.stateObjects.size(); index++)
+            {
+                SAFE_RELEASE(pipelines.stateObjects[index].second);
+            }
+            pipelines.stateObjects.clear();
+
+            SAFE_RELEASE(pipelines.library);
+            SAFE_RELEASE(pipelines.previous);
+            pipelines.previousData.clear();
+            pipelines.filepath = "";
+        }
+
+        /**
+         * Get the pipeline library name of a pipeline from a hash of its shaders and state.
+         * Returns false when the pipeline can't be cached (the pipeline cache is disabled or the root signature has no hash).
+         */
+        bool GetPipelineName(Globals& d3d, ID3D12RootSignature* rootSignature, uint64_t hash, std::wstring& name)
+        {
+            if (!d3d.pipelines.library) return false;
+
+            uint64_t rootSignatureHash = 0;
+            UINT size = sizeof(uint64_t);
+            if (FAILED(rootSignature->GetPrivateData(RootSignatureHashGUID, &size, &rootSignatureHash))) return false;
+
+            hash = Caches::Hash(&rootSignatureHash, sizeof(uint64_t), hash);
+
+            wchar_t buffer[17];
+            swprintf(buffer, 17, L"%016llx", static_cast<unsigned long long>(hash));
+            name = buffer;
+            return true;
+        }
+
+        /**
+         * Hash a ray tracing shader's bytecode and export.
+         */
+        uint64_t HashRayTracingShader(const Shaders::ShaderProgram& shader, uint64_t hash)
+        {
+            if (!shader.bytecode) return Caches::Hash(nullptr, 0, hash);
+            hash = Caches::Hash(shader.bytecode->GetBufferPointer(), shader.bytecode->GetBufferSize(), hash);
+            hash = Caches::Hash(shader.entryPoint.c_str(), shader.entryPoint.size() * sizeof(wchar_t), hash);
+            return Caches::Hash(shader.exportName.c_str(), shader.exportName.size() * sizeof(wchar_t), hash);
+        }
+
+        /**
+         * Create the upload ring's persistently mapped upload heap buffer and fence.
+         */
+        bool CreateUploadRing(Globals& d3d)
+        {
+            UploadRing& ring = d3d.uploads;
+
+            BufferDesc desc = { ring.size, 0, EHeapType::UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE };
+            if (!CreateBuffer(d3d, desc, &ring.buffer)) return false;
+            D3DCHECK(d3d.device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&ring.fence)));
+        #ifdef GFX_NAME_OBJECTS
+            ring.buffer->SetName(L"Upload Ring Buffer");
+            ring.fence->SetName(L"Upload Ring Fence");
+        #endif
+
+            D3D12_RANGE readRange = {};
+            D3DCHECK(ring.buffer->Map(0, &readRange, reinterpret_cast<void**>(&ring.ptr)));
+
+            return true;
+        }
+
+        /**
+         * Recycle the upload ring space (and release the dedicated upload buffers) the GPU is done reading.
+         */
+        void RetireUploads(Globals& d3d)
+        {
+            UploadRing& ring = d3d.uploads;
+            UINT64 completed = ring.fence->GetCompletedValue();
+
+            while (!ring.pending.empty() && ring.pending.front().first <= completed)
+            {
+                ring.tail = ring.pending.front().second;
+                ring.pending.erase(ring.pending.begin());
+            }
+
+            // Nothing is in flight, start the next allocation at the beginning of the ring
+            if (ring.tail == ring.head) ring.head = ring.tail = ring.submitted = ALIGN(ring.size, ring.head);
+
+            for (size_t index = 0; index < ring.dedicated.size();)
+            {
+                if (ring.dedicated[index].first > 0 && ring.dedicated[index].first <= completed)
+                {
+                    SAFE_RELEASE(ring.dedicated[index].second);
+                    ring.dedicated.erase(ring.dedicated.begin() + index);
+                }
+                else index++;
+            }
+        }
+
+        /**
+         * Signal the upload ring fence after submitting a command list to cmdQueue.
+         * The uploads recorded before the submit are recycled once the GPU passes the fence.
+         */
+        bool SignalUploads(Globals& d3d)
+        {
+            UploadRing& ring = d3d.uploads;
+            if (ring.fence == nullptr) return true;
+
+            D3DCHECK(d3d.cmdQueue->Signal(ring.fence, ++ring.fenceValue));
+            if (ring.head != ring.submitted) ring.pending.push_back({ ring.fenceValue, ring.head });
+            ring.submitted = ring.head;
+
+            for (size_t index = 0; index < ring.dedicated.size(); index++)
+            {
+                if (ring.dedicated[index].first == 0) ring.dedicated[index].first = ring.fenceValue;
+            }
+
+            RetireUploads(d3d);
+            return true;
+        }
+
+        /**
+         * Suballocate upload heap memory for a staging copy recorded on the current frame's command list.
+         * Waits for the GPU when the ring is full of submitted uploads. Allocations that don't fit the ring
+         * (too large, or the ring is held by uploads that are not submitted yet) get a dedicated upload buffer.
+         */
+        bool AllocateUpload(Globals& d3d, UINT64 size, UINT64 alignment, UploadAllocation& allocation)
+        {
+            UploadRing& ring = d3d.uploads;
+            RetireUploads(d3d);
 
+            UINT64 offset = 0;
+            while (true)
+            {
+                // Wrap to the beginning of the ring when the allocation would cross its end
+                offset = ALIGN(alignment, ring.head);
+                if ((offset % ring.size) + size > ring.size) offset = ALIGN(ring.size, offset + 1);
+                if ((offset + size - ring.tail) <= ring.size || ring.pending.empty()) break;
+
+                // Wait (on the CPU) for the GPU to finish reading the oldest submitted uploads
+                D3DCHECK(ring.fence->SetEventOnCompletion(ring.pending.front().first, nullptr));
+                RetireUploads(d3d);
+            }
+
+            if ((offset + size - ring.tail) > ring.size)
+            {
+                // Create a dedicated upload buffer, released with the ring space of the same command list
+                ID3D12Resource* buffer = nullptr;
+                BufferDesc desc = { size, 0, EHeapType::UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE };
+                if (!CreateBuffer(d3d, desc, &buffer)) return false;
+                ring.dedicated.push_back({ 0, buffer });
+
+                D3D12_RANGE readRange = {};
+                allocation.buffer = buffer;
+                allocation.offset = 0;
+                D3DCHECK(buffer->Map(0, &readRange, reinterpret_cast<void**>(&allocation.ptr)));
+                return true;
+            }
+
+            ring.head = offset + size;
+            allocation.buffer = ring.buffer;
+            allocation.offset = offset % ring.size;
+            allocation.ptr = ring.ptr + allocation.offset;
+            return true;
+        }
+
+        /**
+         * Submit the command list and wait for the GPU when the uploads recorded during initialization fill half of the upload ring.
+         */
+        bool FlushInitUploads(Globals& d3d)
+        {
+            if ((d3d.uploads.head - d3d.uploads.submitted) <= (d3d.uploads.size / 2)) return true;
+
+            D3DCHECK(d3d.cmdList[d3d.frameIndex]->Close());
+            ID3D12CommandList* pGraphicsList = { d3d.cmdList[d3d.frameIndex] };
+            d3d.cmdQueue->ExecuteCommandLists(1, &pGraphicsList);
+            if (!SignalUploads(d3d)) return false;
+
+            if (!WaitForGPU(d3d)) return false;
+            if (!ResetCmdList(d3d)) return false;
+
+            RetireUploads(d3d);
+            return true;
+        }
+
+        /**
+         * Create the index buffer for a mesh.
+         * Copy the index data to the upload ring and schedule a copy to the device buffer.
+         */
+        bool CreateIndexBuffer(Globals& d3d, const Scenes::Mesh& mesh, ID3D12Resource** device, D3D12_INDEX_BUFFER_VIEW& view)
+        {
             // Create the index buffer device resource
-            desc = { sizeInBytes, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_FLAG_NONE };
+            UINT sizeInBytes = mesh.numIndices * sizeof(UINT);
+            BufferDesc desc = { sizeInBytes, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_FLAG_NONE };
             if (!CreateBuffer(d3d, desc, device)) return false;
 
             // Initialize the index buffer view
@@ -497,10 +843,9 @@ namespace Graphics
             view.SizeInBytes = sizeInBytes;
             view.BufferLocation = (*device)->GetGPUVirtualAddress();
 
-            // Copy the index data of each mesh primitive to the upload buffer
-            UINT8* pData = nullptr;
-            D3D12_RANGE readRange = {};
-            D3DCHECK((*upload)->Map(0, &readRange, reinterpret_cast<void**>(&pData)));
+            // Copy the index data of each mesh primitive to the upload ring
+            UploadAllocation upload;
+            if (!AllocateUpload(d3d, sizeInBytes, sizeof(UINT), upload)) return false;
 
             for (UINT primitiveIndex = 0; primitiveIndex < static_cast<UINT>(mesh.primitives.size()); primitiveIndex++)
             {
@@ -508,12 +853,11 @@ namespace Graphics
                 const Scenes::MeshPrimitive& primitive = mesh.primitives[primitiveIndex];
 
                 UINT size = static_cast<UINT>(primitive.indices.size()) * sizeof(UINT);
-                memcpy(pData + primitive.indexByteOffset, primitive.indices.data(), size);
+                memcpy(upload.ptr + primitive.indexByteOffset, primitive.indices.data(), size);
             }
-            (*upload)->Unmap(0, nullptr);
 
-            // Schedule a copy of the upload buffer to the device buffer
-            d3d.cmdList[d3d.frameIndex]->CopyBufferRegion(*device, 0, *upload, 0, sizeInBytes);
+            // Schedule a copy of the upload ring allocation to the device buffer
+            GetCmdList(d3d)->CopyBufferRegion(*device, 0, upload.buffer, upload.offset, sizeInBytes);
 
             // Transition the default heap resource to generic read after the copy is complete
             D3D12_RESOURCE_BARRIER barrier = {};
@@ -523,25 +867,26 @@ namespace Graphics
             barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_GENERIC_READ;
             barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
 
-            d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+            GetCmdList(d3d)->ResourceBarrier(1, &barrier);
 
             return true;
         }
 
         /**
          * Create the vertex buffer for a mesh.
-         * Copy the vertex data to the upload buffer and schedule a copy to the device buffer.
+         * Copy the vertex data to the upload ring and schedule a copy to the device buffer.
          */
-        bool CreateVertexBuffer(Globals& d3d, const Scenes::Mesh& mesh, ID3D12Resource** device, ID3D12Resource** upload, D3D12_VERTEX_BUFFER_VIEW& view)
+        bool CreateVertexBuffer(Globals& d3d, const Scenes::Mesh& mesh, ID3D12Resource** device, D3D12_VERTEX_BUFFER_VIEW& view)
         {
-            // Create the vertex buffer upload resource
-            UINT stride = sizeof(Vertex);
-            UINT sizeInBytes = mesh.numVertices * stride;
-            BufferDesc desc = { sizeInBytes, 0, EHeapType::UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE };
-            if (!CreateBuffer(d3d, desc, upload)) return false;
+            // Scene meshes store quantized vertices, other meshes (e.g. the probe sphere) full precision vertices
+            bool packed = !mesh.primitives.empty() && !mesh.primitives[0].packedVertices.empty();
 
             // Create the vertex buffer device resource
-            desc = { sizeInBytes, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_FLAG_NONE };
+            // The vertex albedos of packed mesh primitives (GI hit shading) follow the vertices, the vertex buffer view excludes them
+            UINT stride = packed ? sizeof(PackedVertex) : sizeof(Vertex);
+            UINT sizeInBytes = mesh.numVertices * stride;
+            UINT bufferSize = sizeInBytes + (packed ? (mesh.numVertices * sizeof(UINT)) : 0);
+            BufferDesc desc = { bufferSize, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_FLAG_NONE };
             if (!CreateBuffer(d3d, desc, device)) return false;
 
             // Initialize the vertex buffer view
@@ -549,23 +894,33 @@ namespace Graphics
             view.SizeInBytes = sizeInBytes;
             view.BufferLocation = (*device)->GetGPUVirtualAddress();
 
-            // Copy the vertex data of each mesh primitive to the upload buffer
-            UINT8* pData = nullptr;
-            D3D12_RANGE readRange = {};
-            D3DCHECK((*upload)->Map(0, &readRange, reinterpret_cast<void**>(&pData)));
+            // Copy the vertex data of each mesh primitive to the upload ring
+            UploadAllocation upload;
+            if (!AllocateUpload(d3d, bufferSize, 16, upload)) return false;
 
             for (UINT primitiveIndex = 0; primitiveIndex < static_cast<UINT>(mesh.primitives.size()); primitiveIndex++)
             {
                 // Get the mesh primitive and copy its vertices to the upload buffer
                 const Scenes::MeshPrimitive& primitive = mesh.primitives[primitiveIndex];
 
-                UINT size = static_cast<UINT>(primitive.vertices.size()) * stride;
-                memcpy(pData + primitive.vertexByteOffset, primitive.vertices.data(), size);
+                if (packed)
+                {
+                    UINT size = static_cast<UINT>(primitive.packedVertices.size()) * stride;
+                    memcpy(upload.ptr + primitive.vertexByteOffset, primitive.packedVertices.data(), size);
+
+                    // Copy the vertex albedos (see CreateSceneMaterialIndexingBuffers())
+                    UINT albedoOffset = sizeInBytes + (primitive.vertexByteOffset / stride) * sizeof(UINT);
+                    memcpy(upload.ptr + albedoOffset, primitive.vertexAlbedos.data(), primitive.vertexAlbedos.size() * sizeof(UINT));
+                }
+                else
+                {
+                    UINT size = static_cast<UINT>(primitive.vertices.size()) * stride;
+                    memcpy(upload.ptr + primitive.vertexByteOffset, primitive.vertices.data(), size);
+                }
             }
-            (*upload)->Unmap(0, nullptr);
 
-            // Schedule a copy of the upload buffer to the device buffer
-            d3d.cmdList[d3d.frameIndex]->CopyBufferRegion(*device, 0, *upload, 0, sizeInBytes);
+            // Schedule a copy of the upload ring allocation to the device buffer
+            GetCmdList(d3d)->CopyBufferRegion(*device, 0, upload.buffer, upload.offset, bufferSize);
 
             // Transition the default heap resource to generic read after the copy is complete
             D3D12_RESOURCE_BARRIER barrier = {};
@@ -575,19 +930,18 @@ namespace Graphics
             barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_GENERIC_READ;
             barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
 
-            d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+            GetCmdList(d3d)->ResourceBarrier(1, &barrier);
 
             return true;
         }
 
         /**
-         * Create a bottom level acceleration structure for a mesh.
+         * Describe the geometry of a mesh's bottom level acceleration structure.
+         * The quantized vertex positions are transformed to mesh space by the mesh primitives' GeometryData position transforms,
+         * geometryData is the address of the mesh's first GeometryData.
          */
-        bool CreateBLAS(Globals& d3d, Resources& resources, const Scenes::Mesh& mesh)
+        void GetBLASGeometryDescs(Resources& resources, const Scenes::Mesh& mesh, D3D12_GPU_VIRTUAL_ADDRESS geometryData, std::vector<D3D12_RAYTRACING_GEOMETRY_DESC>& primitives)
         {
-            // Describe the mesh primitives
-            std::vector<D3D12_RAYTRACING_GEOMETRY_DESC> primitives;
-
             D3D12_RAYTRACING_GEOMETRY_DESC desc = {};
             desc.Type = D3D12_RAYTRACING_GEOMETRY_TYPE_TRIANGLES;
             for (UINT primitiveIndex = 0; primitiveIndex < static_cast<UINT>(mesh.primitives.size()); primitiveIndex++)
@@ -597,8 +951,9 @@ namespace Graphics
 
                 desc.Triangles.VertexBuffer.StartAddress = resources.sceneVBs[mesh.index]->GetGPUVirtualAddress() + primitive.vertexByteOffset;
                 desc.Triangles.VertexBuffer.StrideInBytes = resources.sceneVBViews[mesh.index].StrideInBytes;
-                desc.Triangles.VertexCount = static_cast<UINT>(primitive.vertices.size());
-                desc.Triangles.VertexFormat = DXGI_FORMAT_R32G32B32_FLOAT;
+                desc.Triangles.VertexCount = static_cast<UINT>(primitive.packedVertices.size());
+                desc.Triangles.VertexFormat = DXGI_FORMAT_R16G16B16A16_UNORM; // the fourth component is ignored
+                desc.Triangles.Transform3x4 = geometryData + (primitiveIndex * sizeof(GeometryData)) + offsetof(GeometryData, positionTransform);
                 desc.Triangles.IndexBuffer = resources.sceneIBs[mesh.index]->GetGPUVirtualAddress() + primitive.indexByteOffset;
                 desc.Triangles.IndexFormat = resources.sceneIBViews[mesh.index].Format;
                 desc.Triangles.IndexCount = static_cast<UINT>(primitive.indices.size());
@@ -606,62 +961,6 @@ namespace Graphics
 
                 primitives.push_back(desc);
             }
-
-            D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAGS buildFlags = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE;
-
-            // Describe the bottom level acceleration structure inputs
-            D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS asInputs = {};
-            asInputs.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL;
-            asInputs.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
-            asInputs.NumDescs = static_cast<UINT>(primitives.size());
-            asInputs.pGeometryDescs = primitives.data();
-            asInputs.Flags = buildFlags;
-
-            // Get the size requirements for the BLAS buffer
-            D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO asPreBuildInfo = {};
-            d3d.device->GetRaytracingAccelerationStructurePrebuildInfo(&asInputs, &asPreBuildInfo);
-            asPreBuildInfo.ScratchDataSizeInBytes = ALIGN(D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT, asPreBuildInfo.ScratchDataSizeInBytes);
-            asPreBuildInfo.ResultDataMaxSizeInBytes = ALIGN(D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT, asPreBuildInfo.ResultDataMaxSizeInBytes);
-
-            // Create the BLAS scratch buffer
-            BufferDesc blasScratchDesc =
-            {
-                asPreBuildInfo.ScratchDataSizeInBytes,
-                D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT,
-                EHeapType::DEFAULT,
-                D3D12_RESOURCE_STATE_COMMON,
-                D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS,
-            };
-            if (!CreateBuffer(d3d, blasScratchDesc, &resources.blas[mesh.index].scratch)) return false;
-        #ifdef GFX_NAME_OBJECTS
-            std::wstring name = L"BLAS: " + std::wstring(mesh.name.begin(), mesh.name.end()) + L" (scratch)";
-            resources.blas[mesh.index].scratch->SetName(name.c_str());
-        #endif
-
-            // Create the BLAS buffer
-            BufferDesc blasDesc =
-            {
-                asPreBuildInfo.ResultDataMaxSizeInBytes,
-                D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT,
-                EHeapType::DEFAULT,
-                D3D12_RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE,
-                D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS,
-            };
-            if (!CreateBuffer(d3d, blasDesc, &resources.blas[mesh.index].as)) return false;
-        #ifdef GFX_NAME_OBJECTS
-            name = L"BLAS: " + std::wstring(mesh.name.begin(), mesh.name.end());
-            resources.blas[mesh.index].as->SetName(name.c_str());
-        #endif
-
-            // Describe and build the BLAS
-            D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC buildDesc = {};
-            buildDesc.Inputs = asInputs;
-            buildDesc.ScratchAccelerationStructureData = resources.blas[mesh.index].scratch->GetGPUVirtualAddress();
-            buildDesc.DestAccelerationStructureData = resources.blas[mesh.index].as->GetGPUVirtualAddress();
-
-            d3d.cmdList[d3d.frameIndex]->BuildRaytracingAccelerationStructure(&buildDesc, 0, nullptr);
-
-            return true;
         }
 
         /**
@@ -669,7 +968,9 @@ namespace Graphics
          */
         bool CreateTLAS(Globals& d3d, Resources& resources, const std::vector<D3D12_RAYTRACING_INSTANCE_DESC>& instances, const std::string debugName = "")
         {
+            // Allow updates so moving instances refit the TLAS instead of rebuilding it
             D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAGS buildFlags = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE;
+            buildFlags |= D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_UPDATE;
 
             // Get the size requirements for the TLAS buffers
             D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS ASInputs = {};
@@ -682,9 +983,9 @@ namespace Graphics
             D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO ASPreBuildInfo = {};
             d3d.device->GetRaytracingAccelerationStructurePrebuildInfo(&ASInputs, &ASPreBuildInfo);
             ASPreBuildInfo.ResultDataMaxSizeInBytes = ALIGN(D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT, ASPreBuildInfo.ResultDataMaxSizeInBytes);
-            ASPreBuildInfo.ScratchDataSizeInBytes = ALIGN(D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT, ASPreBuildInfo.ScratchDataSizeInBytes);
+            ASPreBuildInfo.ScratchDataSizeInBytes = ALIGN(D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT, (std::max)(ASPreBuildInfo.ScratchDataSizeInBytes, ASPreBuildInfo.UpdateScratchDataSizeInBytes));
 
-            // Create TLAS scratch buffer resource
+            // Create TLAS scratch buffer resource (sized for builds and updates)
             BufferDesc desc =
             {
                 ASPreBuildInfo.ScratchDataSizeInBytes,
@@ -712,41 +1013,62 @@ namespace Graphics
             buildDesc.ScratchAccelerationStructureData = resources.tlas.scratch->GetGPUVirtualAddress();
             buildDesc.DestAccelerationStructureData = resources.tlas.as->GetGPUVirtualAddress();
 
-            d3d.cmdList[d3d.frameIndex]->BuildRaytracingAccelerationStructure(&buildDesc, 0, nullptr);
+            GetCmdList(d3d)->BuildRaytracingAccelerationStructure(&buildDesc, 0, nullptr);
 
             // Wait for the TLAS build to complete
             D3D12_RESOURCE_BARRIER barrier = {};
             barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
             barrier.UAV.pResource = resources.tlas.as;
 
-            d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+            GetCmdList(d3d)->ResourceBarrier(1, &barrier);
+
+            resources.tlasInstancesCapacity = static_cast<UINT>(instances.size());
 
             return true;
         }
 
         /**
-         * Create GPU heap resources, upload the texture, and schedule a copy from the GPU upload to default heap.
+         * Rebuild or refit (update) the scene TLAS in place from the instances buffer.
          */
-        bool CreateAndUploadTexture(Globals& d3d, Resources& resources, const Textures::Texture& texture, std::ofstream& log)
+        void BuildTLAS(Globals& d3d, Resources& resources, UINT numInstances, bool update)
         {
-            std::vector<ID3D12Resource*>* tex;
-            std::vector<ID3D12Resource*>* upload;
-            if (texture.type == Textures::ETextureType::SCENE)
-            {
-                tex = &resources.sceneTextures;
-                upload = &resources.sceneTextureUploadBuffers;
-            }
-            else if (texture.type == Textures::ETextureType::ENGINE)
+            D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC buildDesc = {};
+            buildDesc.Inputs.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL;
+            buildDesc.Inputs.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
+            buildDesc.Inputs.InstanceDescs = resources.tlas.instances->GetGPUVirtualAddress();
+            buildDesc.Inputs.NumDescs = numInstances;
+            buildDesc.Inputs.Flags = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE | D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_UPDATE;
+            if (update)
             {
-                tex = &resources.textures;
-                upload = &resources.textureUploadBuffers;
+                // Refit the existing structure, the source and destination are the same
+                buildDesc.Inputs.Flags |= D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PERFORM_UPDATE;
+                buildDesc.SourceAccelerationStructureData = resources.tlas.as->GetGPUVirtualAddress();
             }
+            buildDesc.ScratchAccelerationStructureData = resources.tlas.scratch->GetGPUVirtualAddress();
+            buildDesc.DestAccelerationStructureData = resources.tlas.as->GetGPUVirtualAddress();
+
+            GetCmdList(d3d)->BuildRaytracingAccelerationStructure(&buildDesc, 0, nullptr);
+
+            // Wait for the TLAS build to complete
+            D3D12_RESOURCE_BARRIER barrier = {};
+            barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+            barrier.UAV.pResource = resources.tlas.as;
+
+            GetCmdList(d3d)->ResourceBarrier(1, &barrier);
+        }
+
+        /**
+         * Create GPU heap resources, upload the texture, and schedule a copy from the upload ring to the default heap.
+         */
+        bool CreateAndUploadTexture(Globals& d3d, Resources& resources, const Textures::Texture& texture, std::ofstream& log)
+        {
+            std::vector<ID3D12Resource*>* tex;
+            if (texture.type == Textures::ETextureType::SCENE) tex = &resources.sceneTextures;
+            else if (texture.type == Textures::ETextureType::ENGINE) tex = &resources.textures;
 
             tex->emplace_back();
-            upload->emplace_back();
 
             ID3D12Resource*& resource = tex->back();
-            ID3D12Resource*& uploadBuffer = upload->back();
 
             // Create the default heap texture resource
             {
@@ -760,22 +1082,13 @@ namespace Graphics
             #endif
             }
 
-            // Create the upload heap buffer resource
-            {
-                BufferDesc desc = { texture.texelBytes, 1, EHeapType::UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ , D3D12_RESOURCE_FLAG_NONE };
-                CHECK(CreateBuffer(d3d, desc, &uploadBuffer), "create the texture upload heap buffer!", log);
-            #ifdef GFX_NAME_OBJECTS
-                std::string name = " Texture Upload Buffer: " + texture.name;
-                std::wstring wname = std::wstring(name.begin(), name.end());
-                uploadBuffer->SetName(wname.c_str());
-            #endif
-            }
+            // Allocate the texel data in the upload ring
+            UploadAllocation upload;
+            CHECK(AllocateUpload(d3d, texture.texelBytes, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, upload), "allocate the texture upload memory!", log);
 
-            // Copy the texel data to the upload buffer resource
+            // Copy the texel data to the upload ring allocation
             {
-                UINT8* pData = nullptr;
-                D3D12_RANGE range = { 0, 0 };
-                if (FAILED(uploadBuffer->Map(0, &range, reinterpret_cast<void**>(&pData)))) return false;
+                UINT8* pData = upload.ptr;
 
                 if (texture.format == Textures::ETextureFormat::BC7)
                 {
@@ -798,17 +1111,15 @@ namespace Graphics
                         UINT8* pSource = texture.texels;
                         for (UINT rowIndex = 0; rowIndex < texture.height; rowIndex++)
                         {
-                            memcpy(pData, texture.texels, rowSize);
+                            memcpy(pData, pSource, rowSize);
                             pData += rowPitch;
                             pSource += rowSize;
                         }
                     }
                 }
-
-                uploadBuffer->Unmap(0, &range);
             }
 
-            // Schedule a copy the of the upload heap resource to the default heap resource, then transition it to a shader resource
+            // Schedule a copy the of the upload ring allocation to the default heap resource, then transition it to a shader resource
             {
                 // Describe the texture
                 D3D12_RESOURCE_DESC texDesc = {};
@@ -835,10 +1146,10 @@ namespace Graphics
                 d3d.device->GetCopyableFootprints(&texDesc, 0, texture.mips, 0, footprints.data(), numRows.data(), rowSizes.data(), &uploadSize);
                 assert(uploadSize <= texture.texelBytes);
 
-                // Describe the upload buffer resource (source)
+                // Describe the upload ring allocation (source)
                 D3D12_TEXTURE_COPY_LOCATION source = {};
                 source.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
-                source.pResource = uploadBuffer;
+                source.pResource = upload.buffer;
 
                 // Describe the default heap resource (destination)
                 D3D12_TEXTURE_COPY_LOCATION destination = {};
@@ -850,12 +1161,13 @@ namespace Graphics
                 {
                     // Update the mip level footprint
                     source.PlacedFootprint = footprints[mipIndex];
+                    source.PlacedFootprint.Offset += upload.offset;
 
                     // Update the destination mip level
                     destination.SubresourceIndex = mipIndex;
 
                     // Copy the texture from the upload heap to the default heap
-                    d3d.cmdList[d3d.frameIndex]->CopyTextureRegion(&destination, 0, 0, 0, &source, NULL);
+                    GetCmdList(d3d)->CopyTextureRegion(&destination, 0, 0, 0, &source, NULL);
                 }
 
                 // Transition the default heap texture resource to a shader resource
@@ -866,40 +1178,169 @@ namespace Graphics
                 barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
                 barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
 
-                d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+                GetCmdList(d3d)->ResourceBarrier(1, &barrier);
             }
 
             return true;
         }
 
         /**
-         * Create the global root signature.
+         * Describe a texture resource with the mip levels [topMip, texture.mips) of a BC7 scene texture.
          */
-        bool CreateGlobalRootSignature(Globals& d3d, Resources& resources)
+        D3D12_RESOURCE_DESC GetStreamedTextureDesc(const Textures::Texture& texture, UINT topMip)
         {
-            std::vector<D3D12_ROOT_PARAMETER> rootParameters;
+            D3D12_RESOURCE_DESC desc = {};
+            desc.Width = (std::max)(texture.width >> topMip, 1u);
+            desc.Height = (std::max)(texture.height >> topMip, 1u);
+            desc.MipLevels = static_cast<UINT16>(texture.mips - topMip);
+            desc.DepthOrArraySize = 1;
+            desc.SampleDesc.Count = 1;
+            desc.SampleDesc.Quality = 0;
+            desc.Format = DXGI_FORMAT_BC7_TYPELESS;
+            desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+            desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+            desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+            return desc;
+        }
 
-        #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
-            // Descriptor Heap Ranges
-            std::vector<D3D12_DESCRIPTOR_RANGE> ranges;
+        /**
+         * Get the coarsest mip level (at or finer than the given mip level) a streamed texture resource can start at.
+         * Block compressed texture resources need top mip level dimensions that are multiples of 4.
+         */
+        UINT GetStreamableMip(const Textures::Texture& texture, UINT mip)
+        {
+            while (mip > 0 && ((((std::max)(texture.width >> mip, 1u) % 4) != 0) || (((std::max)(texture.height >> mip, 1u) % 4) != 0))) mip--;
+            return mip;
+        }
 
-            // Cameras Constant Buffer CBV (b1, space0)
-            {
-                D3D12_DESCRIPTOR_RANGE range = {};
-                range.BaseShaderRegister = 1;
-                range.NumDescriptors = 1;
-                range.RegisterSpace = 0;
-                range.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_CBV;
-                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::CBV_CAMERA;
-                ranges.push_back(range);
-            }
+        /**
+         * Get the size of the upload buffer region for the mip levels [topMip, texture.mips) of a BC7 scene texture.
+         */
+        UINT64 GetStreamedTextureUploadSize(Globals& d3d, const Textures::Texture& texture, UINT topMip)
+        {
+            D3D12_RESOURCE_DESC desc = GetStreamedTextureDesc(texture, topMip);
 
-            // Lights StructuredBuffer SRV (t2, space0)
-            {
-                D3D12_DESCRIPTOR_RANGE range = {};
-                range.BaseShaderRegister = 2;
-                range.NumDescriptors = 1;
-                range.RegisterSpace = 0;
+            UINT64 size = 0;
+            d3d.device->GetCopyableFootprints(&desc, 0, desc.MipLevels, 0, nullptr, nullptr, nullptr, &size);
+            return ALIGN(D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, size);
+        }
+
+        /**
+         * Create a texture resource with the mip levels [topMip, texture.mips) of a BC7 scene texture, write the
+         * mip levels to the (mapped) upload buffer at the upload offset, and schedule the copies on the command list.
+         */
+        bool UploadStreamedTexture(
+            Globals& d3d,
+            const Textures::Texture& texture,
+            UINT topMip,
+            D3D12_RESOURCE_STATES state,
+            ID3D12GraphicsCommandList* cmdList,
+            ID3D12Resource* upload,
+            UINT8* uploadPtr,
+            UINT64& uploadOffset,
+            ID3D12Resource** resource)
+        {
+            // Create the default heap texture resource
+            D3D12_RESOURCE_DESC desc = GetStreamedTextureDesc(texture, topMip);
+            D3DCHECK(d3d.device->CreateCommittedResource(&defaultHeapProps, D3D12_HEAP_FLAG_NONE, &desc, state, nullptr, IID_PPV_ARGS(resource)));
+        #ifdef GFX_NAME_OBJECTS
+            std::string name = "Texture: " + texture.name + " (mip " + std::to_string(topMip) + ")";
+            std::wstring wname = std::wstring(name.begin(), name.end());
+            (*resource)->SetName(wname.c_str());
+        #endif
+
+            // Get the footprints of the mip levels in the texels (aligned, all mips)
+            D3D12_RESOURCE_DESC texelsDesc = GetStreamedTextureDesc(texture, 0);
+            std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> texelFootprints;
+            texelFootprints.resize(texture.mips);
+            d3d.device->GetCopyableFootprints(&texelsDesc, 0, texture.mips, 0, texelFootprints.data(), nullptr, nullptr, nullptr);
+
+            // Get the footprints of the mip levels in the upload buffer
+            UINT64 size = 0;
+            std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> footprints;
+            std::vector<UINT> numRows;
+            std::vector<UINT64> rowSizes;
+            footprints.resize(desc.MipLevels);
+            numRows.resize(desc.MipLevels);
+            rowSizes.resize(desc.MipLevels);
+            d3d.device->GetCopyableFootprints(&desc, 0, desc.MipLevels, 0, footprints.data(), numRows.data(), rowSizes.data(), &size);
+
+            // Describe the upload buffer resource (source)
+            D3D12_TEXTURE_COPY_LOCATION source = {};
+            source.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+            source.pResource = upload;
+
+            // Describe the default heap resource (destination)
+            D3D12_TEXTURE_COPY_LOCATION destination = {};
+            destination.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+            destination.pResource = *resource;
+
+            for (UINT mipIndex = 0; mipIndex < desc.MipLevels; mipIndex++)
+            {
+                // The mip level has the same dimensions (and row pitch) in both layouts, copy its rows in one go
+                const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& texels = texelFootprints[topMip + mipIndex];
+                assert(texels.Footprint.RowPitch == footprints[mipIndex].Footprint.RowPitch);
+
+                footprints[mipIndex].Offset += uploadOffset;
+                UINT64 mipSize = (static_cast<UINT64>(numRows[mipIndex] - 1) * footprints[mipIndex].Footprint.RowPitch) + rowSizes[mipIndex];
+                memcpy(uploadPtr + footprints[mipIndex].Offset, texture.texels + texels.Offset, mipSize);
+
+                // Copy the mip level from the upload heap to the default heap
+                source.PlacedFootprint = footprints[mipIndex];
+                destination.SubresourceIndex = mipIndex;
+                cmdList->CopyTextureRegion(&destination, 0, 0, 0, &source, NULL);
+            }
+
+            uploadOffset += ALIGN(D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, size);
+            return true;
+        }
+
+        /**
+         * Add the SRV of a scene texture's resident resource to the descriptor heap.
+         */
+        void CreateSceneTextureSRV(Globals& d3d, Resources& resources, const Textures::Texture& texture, UINT textureIndex)
+        {
+            D3D12_CPU_DESCRIPTOR_HANDLE handle;
+            handle.ptr = resources.srvDescHeapStart.ptr + ((DescriptorHeapOffsets::SRV_SCENE_TEXTURES + textureIndex) * resources.srvDescHeapEntrySize);
+
+            D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+            srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+            srvDesc.Texture2D.MipLevels = resources.sceneTextures[textureIndex]->GetDesc().MipLevels;
+            srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+            if (texture.format == Textures::ETextureFormat::UNCOMPRESSED) srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+            else if(texture.format == Textures::ETextureFormat::BC7) srvDesc.Format = DXGI_FORMAT_BC7_UNORM;
+
+            d3d.device->CreateShaderResourceView(resources.sceneTextures[textureIndex], &srvDesc, handle);
+        }
+
+        /**
+         * Create the global root signature.
+         */
+        bool CreateGlobalRootSignature(Globals& d3d, Resources& resources)
+        {
+            std::vector<D3D12_ROOT_PARAMETER> rootParameters;
+
+        #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
+            // Descriptor Heap Ranges
+            std::vector<D3D12_DESCRIPTOR_RANGE> ranges;
+
+            // Cameras Constant Buffer CBV (b1, space0)
+            {
+                D3D12_DESCRIPTOR_RANGE range = {};
+                range.BaseShaderRegister = 1;
+                range.NumDescriptors = 1;
+                range.RegisterSpace = 0;
+                range.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_CBV;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::CBV_CAMERA;
+                ranges.push_back(range);
+            }
+
+            // Lights StructuredBuffer SRV (t2, space0)
+            {
+                D3D12_DESCRIPTOR_RANGE range = {};
+                range.BaseShaderRegister = 2;
+                range.NumDescriptors = 1;
+                range.RegisterSpace = 0;
                 range.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
                 range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::STB_LIGHTS;
                 ranges.push_back(range);
@@ -949,6 +1390,39 @@ namespace Graphics
                 ranges.push_back(range);
             }
 
+            // DDGIVolume Bounds StructuredBuffer SRV (t0, space4)
+            {
+                D3D12_DESCRIPTOR_RANGE range = {};
+                range.BaseShaderRegister = 0;
+                range.NumDescriptors = 1;
+                range.RegisterSpace = 4;
+                range.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::STB_DDGI_VOLUME_BOUNDS;
+                ranges.push_back(range);
+            }
+
+            // GI Materials StructuredBuffer SRV (t1, space4)
+            {
+                D3D12_DESCRIPTOR_RANGE range = {};
+                range.BaseShaderRegister = 1;
+                range.NumDescriptors = 1;
+                range.RegisterSpace = 4;
+                range.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::STB_GI_MATERIALS;
+                ranges.push_back(range);
+            }
+
+            // Light BVH Nodes and Emissive Triangles StructuredBuffer SRVs (t2-t3, space4)
+            {
+                D3D12_DESCRIPTOR_RANGE range = {};
+                range.BaseShaderRegister = 2;
+                range.NumDescriptors = 2;
+                range.RegisterSpace = 4;
+                range.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::STB_LIGHT_BVH_NODES;
+                ranges.push_back(range);
+            }
+
             // TLAS Instances RWStructuredBuffer UAV (u5, space0)
             {
                 D3D12_DESCRIPTOR_RANGE range = {};
@@ -982,6 +1456,104 @@ namespace Graphics
                 range.RegisterSpace = 6;
                 range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::UAV_PROBE_RAY_HIT_MAP;
                 ranges.push_back(range);
+
+                range.RegisterSpace = 7;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::UAV_RADIANCE_CACHE_WORK_LIST;
+                ranges.push_back(range);
+
+                range.RegisterSpace = 8;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::UAV_RADIANCE_CACHE_WORK_LIST_ARGS;
+                ranges.push_back(range);
+
+                range.RegisterSpace = 9;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::UAV_RADIANCE_CACHE_SORTED_WORK_LIST;
+                ranges.push_back(range);
+
+                range.RegisterSpace = 10;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::UAV_RADIANCE_CACHE_SORT_BINS;
+                ranges.push_back(range);
+
+                range.RegisterSpace = 11;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::UAV_RADIANCE_CACHE_BUDGET;
+                ranges.push_back(range);
+
+                range.RegisterSpace = 12;
+                range.NumDescriptors = MAX_DDGIVOLUMES;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::UAV_DDGI_PROBE_SCHEDULE;
+                ranges.push_back(range);
+
+                range.RegisterSpace = 13;
+                range.NumDescriptors = 1;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::UAV_PROBE_TRACE_BATCH;
+                ranges.push_back(range);
+
+                range.RegisterSpace = 14;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::UAV_PT_WAVEFRONT_PATHS;
+                ranges.push_back(range);
+
+                range.RegisterSpace = 15;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::UAV_PT_WAVEFRONT_HITS;
+                ranges.push_back(range);
+
+                range.RegisterSpace = 16;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::UAV_PT_WAVEFRONT_SURFACES;
+                ranges.push_back(range);
+
+                range.RegisterSpace = 17;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::UAV_PT_WAVEFRONT_QUEUES;
+                ranges.push_back(range);
+
+                range.RegisterSpace = 18;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::UAV_PT_WAVEFRONT_COUNTERS;
+                ranges.push_back(range);
+
+                range.RegisterSpace = 19;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::UAV_PT_CONVERGENCE;
+                ranges.push_back(range);
+
+                range.RegisterSpace = 20;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::UAV_GBUFFER_VISIBILITY;
+                ranges.push_back(range);
+
+                range.RegisterSpace = 21;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::UAV_COMPOSITE_SHADING_RATE;
+                ranges.push_back(range);
+
+                range.RegisterSpace = 22;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::UAV_TEXTURE_FEEDBACK;
+                ranges.push_back(range);
+
+                range.RegisterSpace = 23;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::UAV_GPU_COUNTERS;
+                ranges.push_back(range);
+
+                range.RegisterSpace = 24;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::UAV_RADIANCE_CACHE_STATS;
+                ranges.push_back(range);
+
+                range.RegisterSpace = 25;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::UAV_GBUFFER_TILES;
+                ranges.push_back(range);
+
+                range.RegisterSpace = 26;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::UAV_LIGHT_GRID;
+                ranges.push_back(range);
+
+                range.RegisterSpace = 27;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::UAV_RADIANCE_CACHE_RESERVOIRS;
+                ranges.push_back(range);
+
+                range.RegisterSpace = 28;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::UAV_IRRADIANCE_QUERIES;
+                ranges.push_back(range);
+
+                range.RegisterSpace = 29;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::UAV_COMPOSITE_EXPOSURE;
+                ranges.push_back(range);
+
+                range.RegisterSpace = 30;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::UAV_PROBE_DELTAS;
+                ranges.push_back(range);
             }
 
             // Bindless UAVs, RWTexture2D (u6, space0)
@@ -995,6 +1567,17 @@ namespace Graphics
                 ranges.push_back(range);
             }
 
+            // Bindless UAVs, RasterizerOrderedTexture2D (u6, space2), aliases the RWTexture2D UAVs
+            {
+                D3D12_DESCRIPTOR_RANGE range = {};
+                range.BaseShaderRegister = 6;
+                range.NumDescriptors = UINT_MAX;
+                range.RegisterSpace = 2;
+                range.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
+                range.OffsetInDescriptorsFromTableStart = DescriptorHeapOffsets::UAV_TEX2D_START;
+                ranges.push_back(range);
+            }
+
             // Bindless UAVs, RWTexture2DArray (u6, space1)
             {
                 D3D12_DESCRIPTOR_RANGE range = {};
@@ -1193,6 +1776,48 @@ namespace Graphics
             handle.ptr = resources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_GBUFFERD * resources.srvDescHeapEntrySize);
             d3d.device->CreateUnorderedAccessView(resources.rt.GBufferD, nullptr, &uavDesc, handle);
 
+            if (d3d.GBufferVisibility)
+            {
+                // Create the GBuffer visibility (R32G32_UINT) texture resource
+                desc.format = DXGI_FORMAT_R32G32_UINT;
+                if (!CreateTexture(d3d, desc, &resources.rt.GBufferVisibility)) return false;
+            #ifdef GFX_NAME_OBJECTS
+                resources.rt.GBufferVisibility->SetName(L"GBuffer Visibility");
+            #endif
+
+                // Add the GBuffer visibility UAV to the descriptor heap
+                uavDesc.Format = desc.format;
+                handle.ptr = resources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_GBUFFER_VISIBILITY * resources.srvDescHeapEntrySize);
+                d3d.device->CreateUnorderedAccessView(resources.rt.GBufferVisibility, nullptr, &uavDesc, handle);
+            }
+
+            if (d3d.GBufferTiles)
+            {
+                // Create the GBuffer tiles buffer: dispatch arguments, tile count, and one packed coordinate per tile
+                UINT numTiles = DivRoundUp(d3d.width, GBUFFER_TILE_SIZE) * DivRoundUp(d3d.height, GBUFFER_TILE_SIZE);
+                BufferDesc bufferDesc = { 16 + (numTiles * sizeof(UINT)), 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+                if (!CreateBuffer(d3d, bufferDesc, &resources.rt.GBufferTiles)) return false;
+            #ifdef GFX_NAME_OBJECTS
+                resources.rt.GBufferTiles->SetName(L"GBuffer Tiles");
+            #endif
+
+                // Add the GBuffer tiles UAV (RWByteAddressBuffer) to the descriptor heap
+                D3D12_UNORDERED_ACCESS_VIEW_DESC rawUavDesc = {};
+                rawUavDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+                rawUavDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+                rawUavDesc.Buffer.NumElements = 4 + numTiles;
+                rawUavDesc.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_RAW;
+                handle.ptr = resources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_GBUFFER_TILES * resources.srvDescHeapEntrySize);
+                d3d.device->CreateUnorderedAccessView(resources.rt.GBufferTiles, nullptr, &rawUavDesc, handle);
+
+                // Create the GBuffer tile dispatch arguments buffer
+                bufferDesc = { sizeof(D3D12_DISPATCH_ARGUMENTS), 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT, D3D12_RESOURCE_FLAG_NONE };
+                if (!CreateBuffer(d3d, bufferDesc, &resources.rt.GBufferTileArgs)) return false;
+            #ifdef GFX_NAME_OBJECTS
+                resources.rt.GBufferTileArgs->SetName(L"GBuffer Tile Args");
+            #endif
+            }
+
             return true;
         }
 
@@ -1214,31 +1839,32 @@ namespace Graphics
 
             // Release query heaps
             SAFE_RELEASE(resources.timestampHeap);
-            SAFE_RELEASE(resources.timestamps);
+            for (UINT frameIndex = 0; frameIndex < MAX_FRAMES_IN_FLIGHT; frameIndex++)
+            {
+                SAFE_RELEASE(resources.timestamps[frameIndex]);
+            }
 
             // Release Root Signature
             SAFE_RELEASE(resources.rootSignature);
 
             // Buffers
-            if (resources.cameraCB) resources.cameraCB->Unmap(0, nullptr);
-            if (resources.lightsSTBUpload) resources.lightsSTBUpload->Unmap(0, nullptr);
             SAFE_RELEASE(resources.cameraCB);
             SAFE_RELEASE(resources.lightsSTB);
-            SAFE_RELEASE(resources.lightsSTBUpload);
             SAFE_RELEASE(resources.materialsSTB);
+            SAFE_RELEASE(resources.giMaterialsSTB);
+            SAFE_RELEASE(resources.lightBVHNodesSTB);
+            SAFE_RELEASE(resources.emissiveTrianglesSTB);
             SAFE_RELEASE(resources.meshOffsetsRB);
             SAFE_RELEASE(resources.geometryDataRB);
-            resources.cameraCBPtr = nullptr;
-            resources.lightsSTBPtr = nullptr;
-            resources.materialsSTBPtr = nullptr;
-            resources.meshOffsetsRBPtr = nullptr;
-            resources.geometryDataRBPtr = nullptr;
 
             // Render Targets
             SAFE_RELEASE(resources.rt.GBufferA);
             SAFE_RELEASE(resources.rt.GBufferB);
             SAFE_RELEASE(resources.rt.GBufferC);
             SAFE_RELEASE(resources.rt.GBufferD);
+            SAFE_RELEASE(resources.rt.GBufferVisibility);
+            SAFE_RELEASE(resources.rt.GBufferTiles);
+            SAFE_RELEASE(resources.rt.GBufferTileArgs);
 
             // Release Scene geometry
             size_t resourceIndex;
@@ -1254,11 +1880,9 @@ namespace Graphics
             resources.sceneIBViews.clear();
 
             // Release Scene acceleration structures
-            for (resourceIndex = 0; resourceIndex < resources.blas.size(); resourceIndex++)
-            {
-                resources.blas[resourceIndex].Release();
-            }
+            resources.blas.Release();
             resources.tlas.Release();
+            resources.tlasInstancesCapacity = 0;
 
             // Release Scene textures
             for (resourceIndex = 0; resourceIndex < resources.sceneTextures.size(); resourceIndex++)
@@ -1266,6 +1890,23 @@ namespace Graphics
                 SAFE_RELEASE(resources.sceneTextures[resourceIndex]);
             }
 
+            // Release texture streaming resources
+            TextureStreaming& streaming = resources.textureStreaming;
+            for (resourceIndex = 0; resourceIndex < streaming.swaps.size(); resourceIndex++)
+            {
+                SAFE_RELEASE(streaming.swaps[resourceIndex].resource);
+            }
+            for (UINT frameIndex = 0; frameIndex < MAX_FRAMES_IN_FLIGHT; frameIndex++)
+            {
+                SAFE_RELEASE(streaming.feedbackReadback[frameIndex]);
+            }
+            SAFE_RELEASE(streaming.feedback);
+            SAFE_RELEASE(streaming.feedbackClear);
+            SAFE_RELEASE(streaming.upload);
+            streaming.swaps.clear();
+            streaming.textures.clear();
+            streaming.residentBytes = 0;
+
             // Release default textures
             for (resourceIndex = 0; resourceIndex < resources.textures.size(); resourceIndex++)
             {
@@ -1278,10 +1919,16 @@ namespace Graphics
          */
         void Cleanup(Globals& d3d)
         {
+            d3d.passWorkers.Stop();
+
+            // Write the pending resource captures
+            FlushResourceCaptures(d3d);
+
             // Leave fullscreen mode if necessary
             if (d3d.fullscreen) d3d.swapChain->SetFullscreenState(FALSE, nullptr);
 
             Shaders::Cleanup(d3d.shaderCompiler);
+            ReleasePipelineCache(d3d);
 
             // Release core D3D12 objects
             for (UINT index = 0; index < MAX_FRAMES_IN_FLIGHT; index++)
@@ -1291,11 +1938,44 @@ namespace Graphics
                 SAFE_RELEASE(d3d.cmdAlloc[index]);
                 SAFE_RELEASE(d3d.fence[index]);
                 CloseHandle(d3d.fenceEvent[index]);
+                SAFE_RELEASE(d3d.computeCmdList[index]);
+                SAFE_RELEASE(d3d.computeCmdAlloc[index]);
+                for (UINT passIndex = 0; passIndex <= MAX_PASS_CMD_LISTS; passIndex++)
+                {
+                    SAFE_RELEASE(d3d.passCmdList[index][passIndex]);
+                    SAFE_RELEASE(d3d.passCmdAlloc[index][passIndex]);
+                }
             }
             SAFE_RELEASE(d3d.immediateFence);
             CloseHandle(d3d.immediateFenceEvent);
+            SAFE_RELEASE(d3d.graphicsToComputeFence);
+            SAFE_RELEASE(d3d.computeToGraphicsFence);
+            SAFE_RELEASE(d3d.copyCmdList);
+            SAFE_RELEASE(d3d.copyCmdAlloc);
+            SAFE_RELEASE(d3d.copyFence);
+
+            // Release the upload ring
+            for (size_t index = 0; index < d3d.uploads.dedicated.size(); index++)
+            {
+                SAFE_RELEASE(d3d.uploads.dedicated[index].second);
+            }
+            d3d.uploads.dedicated.clear();
+            if (d3d.uploads.buffer) d3d.uploads.buffer->Unmap(0, nullptr);
+            SAFE_RELEASE(d3d.uploads.buffer);
+            SAFE_RELEASE(d3d.uploads.fence);
+            d3d.uploads.ptr = nullptr;
+
+            // Release the transient heaps (the modules release their transient resources)
+            for (size_t index = 0; index < d3d.transients.heaps.size(); index++)
+            {
+                SAFE_RELEASE(d3d.transients.heaps[index].heap);
+            }
+            d3d.transients.heaps.clear();
+            d3d.transients.allocations.clear();
 
             SAFE_RELEASE(d3d.swapChain);
+            SAFE_RELEASE(d3d.copyQueue);
+            SAFE_RELEASE(d3d.computeQueue);
             SAFE_RELEASE(d3d.cmdQueue);
             SAFE_RELEASE(d3d.device);
             SAFE_RELEASE(d3d.factory);
@@ -1314,9 +1994,9 @@ namespace Graphics
          */
         bool CreateSceneCameraConstantBuffer(Globals& d3d, Resources& resources, const Scenes::Scene& scene)
         {
-            // Create the camera buffer resource
+            // Create the camera buffer resource (updated through the upload ring each frame, see Update())
             UINT size = ALIGN(D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, Scenes::Camera::GetGPUDataSize());
-            BufferDesc desc = { size, 0, EHeapType::UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE };
+            BufferDesc desc = { size, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, D3D12_RESOURCE_FLAG_NONE };
             if (!CreateBuffer(d3d, desc, &resources.cameraCB)) return false;
         #ifdef GFX_NAME_OBJECTS
             resources.cameraCB->SetName(L"Camera Constant Buffer");
@@ -1331,10 +2011,6 @@ namespace Graphics
             handle.ptr = resources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::CBV_CAMERA * resources.srvDescHeapEntrySize);
             d3d.device->CreateConstantBufferView(&cbvDesc, handle);
 
-            // Map the buffer for updates
-            D3D12_RANGE readRange = {};
-            D3DCHECK(resources.cameraCB->Map(0, &readRange, reinterpret_cast<void**>(&resources.cameraCBPtr)));
-
             return true;
         }
 
@@ -1346,33 +2022,26 @@ namespace Graphics
             UINT size = ALIGN(D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT, Scenes::Light::GetGPUDataSize() * static_cast<UINT>(scene.lights.size()));
             if (size == 0) return true; // scenes with no lights are valid
 
-            // Create the lights upload buffer resource
-            BufferDesc desc = { size, 0, EHeapType::UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE };
-            if (!CreateBuffer(d3d, desc, &resources.lightsSTBUpload)) return false;
-        #ifdef GFX_NAME_OBJECTS
-            resources.lightsSTBUpload->SetName(L"Lights Upload Structured Buffer");
-        #endif
-
             // Create the lights device buffer resource
-            desc = { size, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_FLAG_NONE };
+            BufferDesc desc = { size, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_FLAG_NONE };
             if (!CreateBuffer(d3d, desc, &resources.lightsSTB)) return false;
         #ifdef GFX_NAME_OBJECTS
             resources.lightsSTB->SetName(L"Lights Structured Buffer");
         #endif
 
-            // Copy the lights to the upload buffer. Leave the buffer mapped for updates.
+            // Copy the lights to the upload ring
             UINT offset = 0;
-            D3D12_RANGE readRange = {};
-            D3DCHECK(resources.lightsSTBUpload->Map(0, &readRange, reinterpret_cast<void**>(&resources.lightsSTBPtr)));
+            UploadAllocation upload;
+            if (!AllocateUpload(d3d, size, D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT, upload)) return false;
             for (UINT lightIndex = 0; lightIndex < static_cast<UINT>(scene.lights.size()); lightIndex++)
             {
                 const Scenes::Light& light = scene.lights[lightIndex];
-                memcpy(resources.lightsSTBPtr + offset, light.GetGPUData(), Scenes::Light::GetGPUDataSize());
+                memcpy(upload.ptr + offset, light.GetGPUData(), Scenes::Light::GetGPUDataSize());
                 offset += Scenes::Light::GetGPUDataSize();
             }
 
-            // Schedule a copy of the upload buffer to the device buffer
-            d3d.cmdList[d3d.frameIndex]->CopyBufferRegion(resources.lightsSTB, 0, resources.lightsSTBUpload, 0, size);
+            // Schedule a copy of the upload ring allocation to the device buffer
+            GetCmdList(d3d)->CopyBufferRegion(resources.lightsSTB, 0, upload.buffer, upload.offset, size);
 
             // Transition the default heap resource to generic read after the copy is complete
             D3D12_RESOURCE_BARRIER barrier = {};
@@ -1382,7 +2051,7 @@ namespace Graphics
             barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_GENERIC_READ;
             barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
 
-            d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+            GetCmdList(d3d)->ResourceBarrier(1, &barrier);
 
             // Add the lights structured buffer SRV to the descriptor heap
             D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
@@ -1400,40 +2069,67 @@ namespace Graphics
         }
 
         /**
-         * Create the scene materials buffer.
+         * Pack the albedo and opacity of a material for GI hit shading.
+         * The albedo texture's average color is computed from its CPU texels (the textures are not yet unloaded).
          */
-        bool CreateSceneMaterialsBuffer(Globals& d3d, Resources& resources, const Scenes::Scene& scene)
+        GIMaterial PackGIMaterial(const Scenes::Material& material, const Scenes::Scene& scene)
         {
-            // Create the materials buffer upload resource
-            UINT size = ALIGN(D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT, Scenes::Material::GetGPUDataSize() * static_cast<UINT>(scene.materials.size()));
-            BufferDesc desc = { size, 0, EHeapType::UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE };
-            if (!CreateBuffer(d3d, desc, &resources.materialsSTBUpload)) return false;
-        #ifdef GFX_NAME_OBJECTS
-            resources.materialsSTBUpload->SetName(L"Materials Upload Structured Buffer");
-        #endif
+            auto PackUnorm = [](float value, float scale) { return static_cast<UINT>((std::min)((std::max)(value, 0.f), 1.f) * scale + 0.5f); };
+
+            GIMaterial giMaterial = {};
+            giMaterial.albedoOpacity = PackUnorm(material.data.albedo.x, 255.f);
+            giMaterial.albedoOpacity |= PackUnorm(material.data.albedo.y, 255.f) << 8;
+            giMaterial.albedoOpacity |= PackUnorm(material.data.albedo.z, 255.f) << 16;
+            giMaterial.albedoOpacity |= PackUnorm(material.data.opacity, 255.f) << 24;
+
+            giMaterial.albedoTexture = 0x7FFF;
+            if (material.data.albedoTexIdx > -1)
+            {
+                giMaterial.albedoTexture = static_cast<UINT>(material.data.albedoTexIdx + SCENE_TEXTURES_INDEX) & 0x7FFF;
+
+                float color[3];
+                if (Textures::GetAverageColor(scene.textures[material.data.albedoTexIdx], color))
+                {
+                    giMaterial.albedoTexture |= 0x8000;
+                    giMaterial.albedoTexture |= PackUnorm(color[0], 31.f) << 16;
+                    giMaterial.albedoTexture |= PackUnorm(color[1], 63.f) << 21;
+                    giMaterial.albedoTexture |= PackUnorm(color[2], 31.f) << 27;
+                }
+            }
+            return giMaterial;
+        }
 
+        /**
+         * Create the scene materials buffer, and the GI materials buffer (see GIMaterial).
+         */
+        bool CreateSceneMaterialsBuffer(Globals& d3d, Resources& resources, const Scenes::Scene& scene)
+        {
             // Create the materials buffer device resource
-            desc = { size, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_FLAG_NONE };
+            UINT size = ALIGN(D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT, Scenes::Material::GetGPUDataSize() * static_cast<UINT>(scene.materials.size()));
+            BufferDesc desc = { size, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_FLAG_NONE };
             if (!CreateBuffer(d3d, desc, &resources.materialsSTB)) return false;
         #ifdef GFX_NAME_OBJECTS
             resources.materialsSTB->SetName(L"Materials Structured Buffer");
         #endif
 
-            // Determine the texture index offset
-        #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
-            const int SCENE_TEXTURES_INDEX = DescriptorHeapOffsets::SRV_SCENE_TEXTURES - DescriptorHeapOffsets::SRV_TEX2D_START;
-        #elif RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_DESCRIPTOR_HEAP
-            const int SCENE_TEXTURES_INDEX = DescriptorHeapOffsets::SRV_SCENE_TEXTURES;
+            // Create the GI materials buffer device resource
+            UINT giSize = ALIGN(D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT, static_cast<UINT>(sizeof(GIMaterial) * scene.materials.size()));
+            desc = { giSize, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_FLAG_NONE };
+            if (!CreateBuffer(d3d, desc, &resources.giMaterialsSTB)) return false;
+        #ifdef GFX_NAME_OBJECTS
+            resources.giMaterialsSTB->SetName(L"GI Materials Structured Buffer");
         #endif
 
-            // Copy the materials to the upload buffer
+            // Copy the materials and GI materials to the upload ring
             UINT offset = 0;
-            D3D12_RANGE readRange = {};
-            D3DCHECK(resources.materialsSTBUpload->Map(0, &readRange, reinterpret_cast<void**>(&resources.materialsSTBPtr)));
+            UploadAllocation upload;
+            if (!AllocateUpload(d3d, size + giSize, D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT, upload)) return false;
+            GIMaterial* giMaterials = reinterpret_cast<GIMaterial*>(upload.ptr + size);
             for (UINT materialIndex = 0; materialIndex < static_cast<UINT>(scene.materials.size()); materialIndex++)
             {
                 // Get the material
                 Scenes::Material material = scene.materials[materialIndex];
+                giMaterials[materialIndex] = PackGIMaterial(material, scene);
 
                 // Add the offset to the textures (in resource arrays or on the descriptor heap)
                 if (material.data.albedoTexIdx > -1) material.data.albedoTexIdx += SCENE_TEXTURES_INDEX;
@@ -1442,25 +2138,27 @@ namespace Graphics
                 if (material.data.emissiveTexIdx > -1) material.data.emissiveTexIdx += SCENE_TEXTURES_INDEX;
 
                 // Copy the material
-                memcpy(resources.materialsSTBPtr + offset, material.GetGPUData(), Scenes::Material::GetGPUDataSize());
+                memcpy(upload.ptr + offset, material.GetGPUData(), Scenes::Material::GetGPUDataSize());
 
                 // Move the destination pointer to the next material
                 offset += Scenes::Material::GetGPUDataSize();
             }
-            resources.materialsSTBUpload->Unmap(0, nullptr);
 
-            // Schedule a copy of the upload buffer to the device buffer
-            d3d.cmdList[d3d.frameIndex]->CopyBufferRegion(resources.materialsSTB, 0, resources.materialsSTBUpload, 0, size);
+            // Schedule copies of the upload ring allocation to the device buffers
+            GetCmdList(d3d)->CopyBufferRegion(resources.materialsSTB, 0, upload.buffer, upload.offset, size);
+            GetCmdList(d3d)->CopyBufferRegion(resources.giMaterialsSTB, 0, upload.buffer, upload.offset + size, giSize);
 
-            // Transition the default heap resource to generic read after the copy is complete
-            D3D12_RESOURCE_BARRIER barrier = {};
-            barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-            barrier.Transition.pResource = resources.materialsSTB;
-            barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
-            barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_GENERIC_READ;
-            barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+            // Transition the default heap resources to generic read after the copies are complete
+            D3D12_RESOURCE_BARRIER barriers[2] = {};
+            barriers[0].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+            barriers[0].Transition.pResource = resources.materialsSTB;
+            barriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+            barriers[0].Transition.StateAfter = D3D12_RESOURCE_STATE_GENERIC_READ;
+            barriers[0].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+            barriers[1] = barriers[0];
+            barriers[1].Transition.pResource = resources.giMaterialsSTB;
 
-            d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+            GetCmdList(d3d)->ResourceBarrier(2, barriers);
 
             // Add the materials structured buffer SRV to the descriptor heap
             D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
@@ -1474,57 +2172,289 @@ namespace Graphics
             handle.ptr = resources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::STB_MATERIALS * resources.srvDescHeapEntrySize);
             d3d.device->CreateShaderResourceView(resources.materialsSTB, &srvDesc, handle);
 
+            // Add the GI materials structured buffer SRV to the descriptor heap
+            srvDesc.Buffer.StructureByteStride = sizeof(GIMaterial);
+            handle.ptr = resources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::STB_GI_MATERIALS * resources.srvDescHeapEntrySize);
+            d3d.device->CreateShaderResourceView(resources.giMaterialsSTB, &srvDesc, handle);
+
             return true;
         }
 
         /**
-         * Create the scene material indexing buffers.
+         * Gather the world-space emissive triangles of the scene instances.
+         * The emitted radiance is the material's emissive color scaled by the emissive texture's average color.
          */
-        bool CreateSceneMaterialIndexingBuffers(Globals& d3d, Resources& resources, const Scenes::Scene& scene)
+        void GatherEmissiveTriangles(const Scenes::Scene& scene, std::vector<EmissiveTriangle>& triangles)
         {
-            // Mesh Offsets
-
-            // Create the mesh offsets upload buffer resource
-            UINT meshOffsetsSize = ALIGN(D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT, sizeof(UINT) * static_cast<UINT>(scene.meshes.size()) );
-            BufferDesc desc = { meshOffsetsSize, 0, EHeapType::UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE };
-            if (!CreateBuffer(d3d, desc, &resources.meshOffsetsRBUpload)) return false;
-        #ifdef GFX_NAME_OBJECTS
-            resources.meshOffsetsRBUpload->SetName(L"Mesh Offsets Upload ByteAddressBuffer");
-        #endif
-
-            // Create the mesh offsets device buffer resource
-            desc = { meshOffsetsSize, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_FLAG_NONE };
-            if (!CreateBuffer(d3d, desc, &resources.meshOffsetsRB)) return false;
-        #ifdef GFX_NAME_OBJECTS
-            resources.meshOffsetsRB->SetName(L"Mesh Offsets ByteAddressBuffer");
-        #endif
+            // Emitted radiance of each material, zero for non-emissive materials
+            std::vector<float3> radiances(scene.materials.size());
+            for (size_t materialIndex = 0; materialIndex < scene.materials.size(); materialIndex++)
+            {
+                const Material& material = scene.materials[materialIndex].data;
+                float3 radiance = material.emissiveColor;
+                if (material.emissiveTexIdx > -1)
+                {
+                    float color[3];
+                    if (Textures::GetAverageColor(scene.textures[material.emissiveTexIdx], color))
+                    {
+                        radiance = { radiance.x * color[0], radiance.y * color[1], radiance.z * color[2] };
+                    }
+                }
+                radiances[materialIndex] = radiance;
+            }
 
-            // Geometry Data
+            for (const Scenes::MeshInstance& instance : scene.instances)
+            {
+                const Scenes::Mesh& mesh = scene.meshes[instance.meshIndex];
+                for (const Scenes::MeshPrimitive& primitive : mesh.primitives)
+                {
+                    const float3& radiance = radiances[primitive.material];
+                    if ((radiance.x + radiance.y + radiance.z) <= 0.f) continue;
 
-            // Create the geometry (mesh primitive) data upload buffer resource
-            UINT geometryDataSize = ALIGN(D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT, sizeof(GeometryData) * scene.numMeshPrimitives);
-            desc = { geometryDataSize, 0, EHeapType::UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE };
-            if (!CreateBuffer(d3d, desc, &resources.geometryDataRBUpload)) return false;
-        #ifdef GFX_NAME_OBJECTS
-            resources.geometryDataRBUpload->SetName(L"Geometry Data Upload ByteAddressBuffer");
-        #endif
+                    // Decode the quantized (UNORM) positions in the primitive's bounding box, then instance transform them
+                    const rtxgi::AABB& bounds = primitive.boundingBox;
+                    auto GetPosition = [&](uint32_t index)
+                    {
+                        const uint4& data = primitive.packedVertices[index].data;
+                        float x = bounds.min.x + (static_cast<float>(data.x & 0xFFFF) / 65535.f) * (bounds.max.x - bounds.min.x);
+                        float y = bounds.min.y + (static_cast<float>(data.x >> 16) / 65535.f) * (bounds.max.y - bounds.min.y);
+                        float z = bounds.min.z + (static_cast<float>(data.y & 0xFFFF) / 65535.f) * (bounds.max.z - bounds.min.z);
+
+                        const float (&t)[3][4] = instance.transform;
+                        return XMVectorSet(
+                            (t[0][0] * x) + (t[0][1] * y) + (t[0][2] * z) + t[0][3],
+                            (t[1][0] * x) + (t[1][1] * y) + (t[1][2] * z) + t[1][3],
+                            (t[2][0] * x) + (t[2][1] * y) + (t[2][2] * z) + t[2][3],
+                            0.f);
+                    };
+
+                    for (size_t index = 0; (index + 2) < primitive.indices.size(); index += 3)
+                    {
+                        XMVECTOR p0 = GetPosition(primitive.indices[index]);
+                        XMVECTOR e1 = XMVectorSubtract(GetPosition(primitive.indices[index + 1]), p0);
+                        XMVECTOR e2 = XMVectorSubtract(GetPosition(primitive.indices[index + 2]), p0);
+
+                        float area = 0.5f * XMVectorGetX(XMVector3Length(XMVector3Cross(e1, e2)));
+                        if (area <= 0.f) continue;
+
+                        EmissiveTriangle triangle = {};
+                        XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(&triangle.position), p0);
+                        XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(&triangle.edge1), e1);
+                        XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(&triangle.edge2), e2);
+                        triangle.area = area;
+                        triangle.doubleSided = primitive.doubleSided ? 1 : 0;
+                        triangle.radiance = radiance;
+                        triangles.push_back(triangle);
+                    }
+                }
+            }
+        }
 
-            // Create the geometry (mesh primitive) data device buffer resource
-            desc = { geometryDataSize, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_FLAG_NONE };
-            if (!CreateBuffer(d3d, desc, &resources.geometryDataRB)) return false;
-        #ifdef GFX_NAME_OBJECTS
-            resources.geometryDataRB->SetName(L"Geometry Data ByteAddressBuffer");
-        #endif
+        /**
+         * Build a binary light BVH over the emissive triangles: median splits of the triangle centroids along
+         * their longest axis, down to one triangle per leaf. The children of a node are consecutive.
+         */
+        void BuildLightBVH(const std::vector<EmissiveTriangle>& triangles, std::vector<LightBVHNode>& nodes)
+        {
+            nodes.clear();
 
-            // Copy the mesh offsets and geometry data to the upload buffers
-            UINT primitiveOffset = 0;
-            D3D12_RANGE readRange = {};
-            D3DCHECK(resources.meshOffsetsRBUpload->Map(0, &readRange, reinterpret_cast<void**>(&resources.meshOffsetsRBPtr)));
-            D3DCHECK(resources.geometryDataRBUpload->Map(0, &readRange, reinterpret_cast<void**>(&resources.geometryDataRBPtr)));
+            // The root of an empty BVH has no power, the shaders skip emissive light sampling
+            if (triangles.empty())
+            {
+                nodes.push_back({});
+                return;
+            }
 
-            UINT8* meshOffsetsAddress = resources.meshOffsetsRBPtr;
-            UINT8* geometryDataAddress = resources.geometryDataRBPtr;
-            for (UINT meshIndex = 0; meshIndex < static_cast<UINT>(scene.meshes.size()); meshIndex++)
+            auto GetPower = [](const EmissiveTriangle& triangle)
+            {
+                float luminance = (0.2126f * triangle.radiance.x) + (0.7152f * triangle.radiance.y) + (0.0722f * triangle.radiance.z);
+                return luminance * triangle.area * (triangle.doubleSided ? 2.f : 1.f);
+            };
+
+            std::vector<uint32_t> order(triangles.size());
+            std::vector<XMFLOAT3> centroids(triangles.size());
+            for (uint32_t triangleIndex = 0; triangleIndex < static_cast<uint32_t>(triangles.size()); triangleIndex++)
+            {
+                const EmissiveTriangle& triangle = triangles[triangleIndex];
+                order[triangleIndex] = triangleIndex;
+                centroids[triangleIndex] =
+                {
+                    triangle.position.x + (triangle.edge1.x + triangle.edge2.x) / 3.f,
+                    triangle.position.y + (triangle.edge1.y + triangle.edge2.y) / 3.f,
+                    triangle.position.z + (triangle.edge1.z + triangle.edge2.z) / 3.f
+                };
+            }
+
+            // Nodes to build: node index, and the range of triangles (in order) it covers
+            struct BuildTask { uint32_t node; uint32_t first; uint32_t count; };
+            std::vector<BuildTask> tasks = { { 0, 0, static_cast<uint32_t>(triangles.size()) } };
+            nodes.reserve((2 * triangles.size()) - 1);
+            nodes.push_back({});
+            while (!tasks.empty())
+            {
+                BuildTask task = tasks.back();
+                tasks.pop_back();
+
+                // Bounds and power of the node's triangles, bounds of their centroids
+                XMVECTOR boundsMin = XMVectorReplicate(FLT_MAX);
+                XMVECTOR boundsMax = XMVectorReplicate(-FLT_MAX);
+                XMVECTOR centroidMin = boundsMin;
+                XMVECTOR centroidMax = boundsMax;
+                float power = 0.f;
+                for (uint32_t index = task.first; index < (task.first + task.count); index++)
+                {
+                    const EmissiveTriangle& triangle = triangles[order[index]];
+                    XMVECTOR p0 = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&triangle.position));
+                    XMVECTOR p1 = XMVectorAdd(p0, XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&triangle.edge1)));
+                    XMVECTOR p2 = XMVectorAdd(p0, XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&triangle.edge2)));
+                    boundsMin = XMVectorMin(boundsMin, XMVectorMin(p0, XMVectorMin(p1, p2)));
+                    boundsMax = XMVectorMax(boundsMax, XMVectorMax(p0, XMVectorMax(p1, p2)));
+
+                    XMVECTOR centroid = XMLoadFloat3(&centroids[order[index]]);
+                    centroidMin = XMVectorMin(centroidMin, centroid);
+                    centroidMax = XMVectorMax(centroidMax, centroid);
+                    power += GetPower(triangle);
+                }
+
+                LightBVHNode& node = nodes[task.node];
+                XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(&node.boundsMin), boundsMin);
+                XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(&node.boundsMax), boundsMax);
+                node.power = power;
+
+                if (task.count == 1)
+                {
+                    node.child = order[task.first] | LIGHT_BVH_LEAF;
+                    continue;
+                }
+
+                // Split at the median centroid along the longest axis of the centroid bounds
+                XMFLOAT3 extent;
+                XMStoreFloat3(&extent, XMVectorSubtract(centroidMax, centroidMin));
+                int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : ((extent.y >= extent.z) ? 1 : 2);
+                auto first = order.begin() + task.first;
+                auto middle = first + (task.count / 2);
+                std::nth_element(first, middle, first + task.count, [&](uint32_t a, uint32_t b)
+                {
+                    return (&centroids[a].x)[axis] < (&centroids[b].x)[axis];
+                });
+
+                node.child = static_cast<uint32_t>(nodes.size());
+                tasks.push_back({ node.child, task.first, task.count / 2 });
+                tasks.push_back({ node.child + 1, task.first + (task.count / 2), task.count - (task.count / 2) });
+                nodes.push_back({});
+                nodes.push_back({});
+            }
+        }
+
+        /**
+         * Create the scene's emissive triangles and light BVH buffers (see EMISSIVE_LIGHTS).
+         * The triangles are gathered once, at load, in the instances' load transforms.
+         */
+        bool CreateSceneEmissiveLightsBuffers(Globals& d3d, Resources& resources, const Scenes::Scene& scene)
+        {
+            std::vector<EmissiveTriangle> triangles;
+            std::vector<LightBVHNode> nodes;
+            GatherEmissiveTriangles(scene, triangles);
+            BuildLightBVH(triangles, nodes);
+
+            // Keep a triangle in the buffer when the scene has none, for a valid SRV
+            UINT numTriangles = (std::max)(static_cast<UINT>(triangles.size()), 1u);
+            UINT numNodes = static_cast<UINT>(nodes.size());
+            triangles.resize(numTriangles);
+
+            // Create the light BVH nodes and emissive triangles device buffer resources
+            UINT nodesSize = ALIGN(D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT, static_cast<UINT>(sizeof(LightBVHNode) * numNodes));
+            BufferDesc desc = { nodesSize, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_FLAG_NONE };
+            if (!CreateBuffer(d3d, desc, &resources.lightBVHNodesSTB)) return false;
+        #ifdef GFX_NAME_OBJECTS
+            resources.lightBVHNodesSTB->SetName(L"Light BVH Nodes Structured Buffer");
+        #endif
+
+            UINT trianglesSize = ALIGN(D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT, static_cast<UINT>(sizeof(EmissiveTriangle) * numTriangles));
+            desc = { trianglesSize, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_FLAG_NONE };
+            if (!CreateBuffer(d3d, desc, &resources.emissiveTrianglesSTB)) return false;
+        #ifdef GFX_NAME_OBJECTS
+            resources.emissiveTrianglesSTB->SetName(L"Emissive Triangles Structured Buffer");
+        #endif
+
+            // Copy the nodes and triangles to the upload ring
+            UploadAllocation upload;
+            if (!AllocateUpload(d3d, nodesSize + trianglesSize, D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT, upload)) return false;
+            memcpy(upload.ptr, nodes.data(), sizeof(LightBVHNode) * numNodes);
+            memcpy(upload.ptr + nodesSize, triangles.data(), sizeof(EmissiveTriangle) * numTriangles);
+
+            // Schedule copies of the upload ring allocation to the device buffers
+            GetCmdList(d3d)->CopyBufferRegion(resources.lightBVHNodesSTB, 0, upload.buffer, upload.offset, nodesSize);
+            GetCmdList(d3d)->CopyBufferRegion(resources.emissiveTrianglesSTB, 0, upload.buffer, upload.offset + nodesSize, trianglesSize);
+
+            // Transition the default heap resources to generic read after the copies are complete
+            D3D12_RESOURCE_BARRIER barriers[2] = {};
+            barriers[0].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+            barriers[0].Transition.pResource = resources.lightBVHNodesSTB;
+            barriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+            barriers[0].Transition.StateAfter = D3D12_RESOURCE_STATE_GENERIC_READ;
+            barriers[0].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+            barriers[1] = barriers[0];
+            barriers[1].Transition.pResource = resources.emissiveTrianglesSTB;
+
+            GetCmdList(d3d)->ResourceBarrier(2, barriers);
+
+            // Add the light BVH nodes structured buffer SRV to the descriptor heap
+            D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+            srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+            srvDesc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+            srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+            srvDesc.Buffer.NumElements = numNodes;
+            srvDesc.Buffer.StructureByteStride = sizeof(LightBVHNode);
+
+            D3D12_CPU_DESCRIPTOR_HANDLE handle;
+            handle.ptr = resources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::STB_LIGHT_BVH_NODES * resources.srvDescHeapEntrySize);
+            d3d.device->CreateShaderResourceView(resources.lightBVHNodesSTB, &srvDesc, handle);
+
+            // Add the emissive triangles structured buffer SRV to the descriptor heap
+            srvDesc.Buffer.NumElements = numTriangles;
+            srvDesc.Buffer.StructureByteStride = sizeof(EmissiveTriangle);
+            handle.ptr = resources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::STB_EMISSIVE_TRIANGLES * resources.srvDescHeapEntrySize);
+            d3d.device->CreateShaderResourceView(resources.emissiveTrianglesSTB, &srvDesc, handle);
+
+            return true;
+        }
+
+        /**
+         * Create the scene material indexing buffers.
+         */
+        bool CreateSceneMaterialIndexingBuffers(Globals& d3d, Resources& resources, const Scenes::Scene& scene)
+        {
+            // Mesh Offsets
+
+            // Create the mesh offsets device buffer resource
+            UINT meshOffsetsSize = ALIGN(D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT, sizeof(UINT) * static_cast<UINT>(scene.meshes.size()) );
+            BufferDesc desc = { meshOffsetsSize, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_FLAG_NONE };
+            if (!CreateBuffer(d3d, desc, &resources.meshOffsetsRB)) return false;
+        #ifdef GFX_NAME_OBJECTS
+            resources.meshOffsetsRB->SetName(L"Mesh Offsets ByteAddressBuffer");
+        #endif
+
+            // Geometry Data
+
+            // Create the geometry (mesh primitive) data device buffer resource
+            UINT geometryDataSize = ALIGN(D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT, sizeof(GeometryData) * scene.numMeshPrimitives);
+            desc = { geometryDataSize, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_FLAG_NONE };
+            if (!CreateBuffer(d3d, desc, &resources.geometryDataRB)) return false;
+        #ifdef GFX_NAME_OBJECTS
+            resources.geometryDataRB->SetName(L"Geometry Data ByteAddressBuffer");
+        #endif
+
+            // Copy the mesh offsets and geometry data to the upload ring
+            UINT primitiveOffset = 0;
+            UploadAllocation meshOffsetsUpload;
+            UploadAllocation geometryDataUpload;
+            if (!AllocateUpload(d3d, meshOffsetsSize, D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT, meshOffsetsUpload)) return false;
+            if (!AllocateUpload(d3d, geometryDataSize, D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT, geometryDataUpload)) return false;
+
+            UINT8* meshOffsetsAddress = meshOffsetsUpload.ptr;
+            UINT8* geometryDataAddress = geometryDataUpload.ptr;
+            for (UINT meshIndex = 0; meshIndex < static_cast<UINT>(scene.meshes.size()); meshIndex++)
             {
                 // Get the mesh
                 const Scenes::Mesh& mesh = scene.meshes[meshIndex];
@@ -1539,22 +2469,30 @@ namespace Graphics
                     // Get the mesh primitive and copy its material index to the upload buffer
                     const Scenes::MeshPrimitive& primitive = mesh.primitives[primitiveIndex];
 
-                    GeometryData data;
+                    GeometryData data = {};
                     data.materialIndex = primitive.material;
                     data.indexByteAddress = primitive.indexByteOffset;
                     data.vertexByteAddress = primitive.vertexByteOffset;
+
+                    // The vertex albedos follow the mesh's packed vertices in its vertex buffer (see CreateVertexBuffer())
+                    data.albedoByteAddress = 0xFFFFFFFF;
+                    if (!primitive.vertexAlbedos.empty()) data.albedoByteAddress = (mesh.numVertices * sizeof(PackedVertex)) + (primitive.vertexByteOffset / sizeof(PackedVertex)) * sizeof(UINT);
+
+                    // Transform of the quantized (UNORM) vertex positions to the primitive's bounding box
+                    const rtxgi::AABB& bounds = primitive.boundingBox;
+                    data.positionTransform[0] = { bounds.max.x - bounds.min.x, 0.f, 0.f, bounds.min.x };
+                    data.positionTransform[1] = { 0.f, bounds.max.y - bounds.min.y, 0.f, bounds.min.y };
+                    data.positionTransform[2] = { 0.f, 0.f, bounds.max.z - bounds.min.z, bounds.min.z };
                     memcpy(geometryDataAddress, &data, sizeof(GeometryData));
 
                     geometryDataAddress += sizeof(GeometryData);
                     primitiveOffset++;
                 }
             }
-            resources.meshOffsetsRBUpload->Unmap(0, nullptr);
-            resources.geometryDataRBUpload->Unmap(0, nullptr);
 
-            // Schedule a copy of the upload buffers to the device buffers
-            d3d.cmdList[d3d.frameIndex]->CopyBufferRegion(resources.meshOffsetsRB, 0, resources.meshOffsetsRBUpload, 0, meshOffsetsSize);
-            d3d.cmdList[d3d.frameIndex]->CopyBufferRegion(resources.geometryDataRB, 0, resources.geometryDataRBUpload, 0, geometryDataSize);
+            // Schedule a copy of the upload ring allocations to the device buffers
+            GetCmdList(d3d)->CopyBufferRegion(resources.meshOffsetsRB, 0, meshOffsetsUpload.buffer, meshOffsetsUpload.offset, meshOffsetsSize);
+            GetCmdList(d3d)->CopyBufferRegion(resources.geometryDataRB, 0, geometryDataUpload.buffer, geometryDataUpload.offset, geometryDataSize);
 
             // Transition the default heap resources to generic read after the copies are complete
             std::vector<D3D12_RESOURCE_BARRIER> barriers;
@@ -1570,7 +2508,7 @@ namespace Graphics
             barrier.Transition.pResource = resources.geometryDataRB;
             barriers.push_back(barrier);
 
-            d3d.cmdList[d3d.frameIndex]->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+            GetCmdList(d3d)->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
 
             // Add the mesh offsets ByteAddressBuffer SRV to the descriptor heap
             D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
@@ -1612,15 +2550,15 @@ namespace Graphics
             resources.tlas.instances->SetName(L"TLAS Instance Descriptors Buffer");
         #endif
 
-            // Copy the instance data to the upload buffer
+            // Copy the instance data to the upload buffer (instance updates go through the upload ring, see UpdateSceneTLASInstances())
             UINT8* pData = nullptr;
             D3D12_RANGE readRange = {};
             D3DCHECK(resources.tlas.instancesUpload->Map(0, &readRange, reinterpret_cast<void**>(&pData)));
-            memcpy(pData, instances.data(), desc.size);
+            memcpy(pData, instances.data(), instances.size() * sizeof(D3D12_RAYTRACING_INSTANCE_DESC));
             resources.tlas.instancesUpload->Unmap(0, nullptr);
 
             // Schedule a copy of the upload buffer to the device buffer
-            d3d.cmdList[d3d.frameIndex]->CopyBufferRegion(resources.tlas.instances, 0, resources.tlas.instancesUpload, 0, size);
+            GetCmdList(d3d)->CopyBufferRegion(resources.tlas.instances, 0, resources.tlas.instancesUpload, 0, size);
 
             // Transition the default heap resource to generic read after the copy is complete
             D3D12_RESOURCE_BARRIER barrier = {};
@@ -1630,7 +2568,7 @@ namespace Graphics
             barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_GENERIC_READ;
             barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
 
-            d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+            GetCmdList(d3d)->ResourceBarrier(1, &barrier);
 
             // Add the TLAS instances structured buffer SRV to the descriptor heap
             D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
@@ -1655,7 +2593,6 @@ namespace Graphics
             UINT numMeshes = static_cast<UINT>(scene.meshes.size());
 
             resources.sceneIBs.resize(numMeshes);
-            resources.sceneIBUploadBuffers.resize(numMeshes);
             resources.sceneIBViews.resize(numMeshes);
             for (UINT meshIndex = 0; meshIndex < numMeshes; meshIndex++)
             {
@@ -1663,10 +2600,8 @@ namespace Graphics
                 const Scenes::Mesh& mesh = scene.meshes[meshIndex];
 
                 // Create the index buffer and copy the index data to the GPU
-                if (!CreateIndexBuffer(d3d, mesh,
-                    &resources.sceneIBs[meshIndex],
-                    &resources.sceneIBUploadBuffers[meshIndex],
-                    resources.sceneIBViews[meshIndex])) return false;
+                if (!FlushInitUploads(d3d)) return false;
+                if (!CreateIndexBuffer(d3d, mesh, &resources.sceneIBs[meshIndex], resources.sceneIBViews[meshIndex])) return false;
             #ifdef GFX_NAME_OBJECTS
                 std::string name = "IB: " + mesh.name;
                 std::wstring n = std::wstring(name.begin(), name.end());
@@ -1696,7 +2631,6 @@ namespace Graphics
             UINT numMeshes = static_cast<UINT>(scene.meshes.size());
 
             resources.sceneVBs.resize(numMeshes);
-            resources.sceneVBUploadBuffers.resize(numMeshes);
             resources.sceneVBViews.resize(numMeshes);
             for (UINT meshIndex = 0; meshIndex < numMeshes; meshIndex++)
             {
@@ -1704,10 +2638,8 @@ namespace Graphics
                 const Scenes::Mesh& mesh = scene.meshes[meshIndex];
 
                 // Create the vertex buffer and copy the data to the GPU
-                if (!CreateVertexBuffer(d3d, mesh,
-                    &resources.sceneVBs[meshIndex],
-                    &resources.sceneVBUploadBuffers[meshIndex],
-                    resources.sceneVBViews[meshIndex])) return false;
+                if (!FlushInitUploads(d3d)) return false;
+                if (!CreateVertexBuffer(d3d, mesh, &resources.sceneVBs[meshIndex], resources.sceneVBViews[meshIndex])) return false;
             #ifdef GFX_NAME_OBJECTS
                 std::string name = "VB: " + mesh.name;
                 std::wstring n = std::wstring(name.begin(), name.end());
@@ -1718,7 +2650,7 @@ namespace Graphics
                 D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
                 srvDesc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
                 srvDesc.Format = DXGI_FORMAT_R32_TYPELESS;
-                srvDesc.Buffer.NumElements = (sizeof(Vertex) * mesh.numVertices) / 4;
+                srvDesc.Buffer.NumElements = ((sizeof(PackedVertex) + sizeof(UINT)) * mesh.numVertices) / 4;   // packed vertices and vertex albedos
                 srvDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_RAW;
                 srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
 
@@ -1734,24 +2666,191 @@ namespace Graphics
          */
         bool CreateSceneBLAS(Globals& d3d, Resources& resources, const Scenes::Scene& scene)
         {
-            // Build a BLAS for each mesh
-            resources.blas.resize(scene.meshes.size());
-            for (UINT meshIndex = 0; meshIndex < static_cast<UINT>(scene.meshes.size()); meshIndex++)
+            // Builds share one scratch arena, a build that doesn't fit waits for the builds before it to complete
+            const UINT64 maxScratchArenaSize = 128 * 1024 * 1024;
+            const UINT64 alignment = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT;
+
+            UINT numMeshes = static_cast<UINT>(scene.meshes.size());
+            if (numMeshes == 0) return true;
+
+            // Describe each mesh's BLAS and get its size requirements
+            std::vector<std::vector<D3D12_RAYTRACING_GEOMETRY_DESC>> primitives(numMeshes);
+            std::vector<D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS> asInputs(numMeshes);
+            std::vector<UINT64> buildOffsets(numMeshes);
+            std::vector<UINT64> scratchSizes(numMeshes);
+            UINT64 buildSize = 0;
+            UINT64 scratchSize = 0;
+            UINT64 maxScratchSize = 0;
+            D3D12_GPU_VIRTUAL_ADDRESS geometryData = resources.geometryDataRB->GetGPUVirtualAddress();
+            for (UINT meshIndex = 0; meshIndex < numMeshes; meshIndex++)
             {
-                // Get the mesh and create its BLAS
-                const Scenes::Mesh mesh = scene.meshes[meshIndex];
-                if (!CreateBLAS(d3d, resources, mesh)) return false;
+                GetBLASGeometryDescs(resources, scene.meshes[meshIndex], geometryData, primitives[meshIndex]);
+                geometryData += scene.meshes[meshIndex].primitives.size() * sizeof(GeometryData);
+
+                asInputs[meshIndex].Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL;
+                asInputs[meshIndex].DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
+                asInputs[meshIndex].NumDescs = static_cast<UINT>(primitives[meshIndex].size());
+                asInputs[meshIndex].pGeometryDescs = primitives[meshIndex].data();
+                asInputs[meshIndex].Flags = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE | D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_COMPACTION;
+
+                D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO asPreBuildInfo = {};
+                d3d.device->GetRaytracingAccelerationStructurePrebuildInfo(&asInputs[meshIndex], &asPreBuildInfo);
+
+                buildOffsets[meshIndex] = buildSize;
+                buildSize += ALIGN(alignment, asPreBuildInfo.ResultDataMaxSizeInBytes);
+                scratchSizes[meshIndex] = ALIGN(alignment, asPreBuildInfo.ScratchDataSizeInBytes);
+                scratchSize += scratchSizes[meshIndex];
+                maxScratchSize = (std::max)(maxScratchSize, scratchSizes[meshIndex]);
             }
+            scratchSize = (std::max)(maxScratchSize, (std::min)(scratchSize, maxScratchArenaSize));
 
-            // Wait for the BLAS builds to complete
+            // Create the uncompacted BLAS pool and the scratch arena
+            BufferDesc desc = { buildSize, alignment, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+            if (!CreateBuffer(d3d, desc, &resources.blas.build)) return false;
+        #ifdef GFX_NAME_OBJECTS
+            resources.blas.build->SetName(L"Scene BLAS (uncompacted)");
+        #endif
+
+            desc = { scratchSize, alignment, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+            if (!CreateBuffer(d3d, desc, &resources.blas.scratch)) return false;
+        #ifdef GFX_NAME_OBJECTS
+            resources.blas.scratch->SetName(L"Scene BLAS Scratch");
+        #endif
+
+            // Create the compacted size buffers
+            UINT64 compactedSizesSize = sizeof(D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_COMPACTED_SIZE_DESC) * numMeshes;
+            desc = { compactedSizesSize, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+            if (!CreateBuffer(d3d, desc, &resources.blas.compactedSizes)) return false;
+
+            desc = { compactedSizesSize, 0, EHeapType::READBACK, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_FLAG_NONE };
+            if (!CreateBuffer(d3d, desc, &resources.blas.compactedSizesReadback)) return false;
+        #ifdef GFX_NAME_OBJECTS
+            resources.blas.compactedSizes->SetName(L"Scene BLAS Compacted Sizes");
+            resources.blas.compactedSizesReadback->SetName(L"Scene BLAS Compacted Sizes Readback");
+        #endif
+
+            // Build the BLAS of every mesh, batched by the scratch arena's size
             D3D12_RESOURCE_BARRIER uavBarrier = {};
             uavBarrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
             uavBarrier.UAV.pResource = nullptr;
-            d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &uavBarrier);
+
+            UINT64 scratchOffset = 0;
+            for (UINT meshIndex = 0; meshIndex < numMeshes; meshIndex++)
+            {
+                if (scratchOffset + scratchSizes[meshIndex] > scratchSize)
+                {
+                    // Wait for the batch's builds to complete before reusing the scratch arena
+                    GetCmdList(d3d)->ResourceBarrier(1, &uavBarrier);
+                    scratchOffset = 0;
+                }
+
+                D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC buildDesc = {};
+                buildDesc.Inputs = asInputs[meshIndex];
+                buildDesc.ScratchAccelerationStructureData = resources.blas.scratch->GetGPUVirtualAddress() + scratchOffset;
+                buildDesc.DestAccelerationStructureData = resources.blas.build->GetGPUVirtualAddress() + buildOffsets[meshIndex];
+
+                D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_DESC postbuildDesc = {};
+                postbuildDesc.InfoType = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_COMPACTED_SIZE;
+                postbuildDesc.DestBuffer = resources.blas.compactedSizes->GetGPUVirtualAddress() + (sizeof(D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_COMPACTED_SIZE_DESC) * meshIndex);
+
+                GetCmdList(d3d)->BuildRaytracingAccelerationStructure(&buildDesc, 1, &postbuildDesc);
+                scratchOffset += scratchSizes[meshIndex];
+            }
+
+            // Wait for the BLAS builds to complete
+            GetCmdList(d3d)->ResourceBarrier(1, &uavBarrier);
+
+            // Copy the compacted sizes to the readback buffer
+            D3D12_RESOURCE_BARRIER barrier = {};
+            barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+            barrier.Transition.pResource = resources.blas.compactedSizes;
+            barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+            barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
+            barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+            GetCmdList(d3d)->ResourceBarrier(1, &barrier);
+
+            GetCmdList(d3d)->CopyResource(resources.blas.compactedSizesReadback, resources.blas.compactedSizes);
+
+            // Submit the builds and wait for the compacted sizes
+            D3DCHECK(d3d.cmdList[d3d.frameIndex]->Close());
+            ID3D12CommandList* pGraphicsList = { d3d.cmdList[d3d.frameIndex] };
+            d3d.cmdQueue->ExecuteCommandLists(1, &pGraphicsList);
+            if (!SignalUploads(d3d)) return false;
+
+            if (!WaitForGPU(d3d)) return false;
+            if (!ResetCmdList(d3d)) return false;
+
+            // Suballocate the compacted BLAS from one pool
+            D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_COMPACTED_SIZE_DESC* compactedSizes = nullptr;
+            D3D12_RANGE readRange = { 0, static_cast<SIZE_T>(compactedSizesSize) };
+            D3DCHECK(resources.blas.compactedSizesReadback->Map(0, &readRange, reinterpret_cast<void**>(&compactedSizes)));
+
+            UINT64 poolSize = 0;
+            resources.blas.offsets.resize(numMeshes);
+            for (UINT meshIndex = 0; meshIndex < numMeshes; meshIndex++)
+            {
+                resources.blas.offsets[meshIndex] = poolSize;
+                poolSize += ALIGN(alignment, compactedSizes[meshIndex].CompactedSizeInBytes);
+            }
+
+            D3D12_RANGE writeRange = {};
+            resources.blas.compactedSizesReadback->Unmap(0, &writeRange);
+
+            desc = { poolSize, alignment, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+            if (!CreateBuffer(d3d, desc, &resources.blas.as)) return false;
+        #ifdef GFX_NAME_OBJECTS
+            resources.blas.as->SetName(L"Scene BLAS");
+        #endif
+
+            // Compact each BLAS into the pool
+            for (UINT meshIndex = 0; meshIndex < numMeshes; meshIndex++)
+            {
+                GetCmdList(d3d)->CopyRaytracingAccelerationStructure(
+                    resources.blas.GetGPUVirtualAddress(meshIndex),
+                    resources.blas.build->GetGPUVirtualAddress() + buildOffsets[meshIndex],
+                    D3D12_RAYTRACING_ACCELERATION_STRUCTURE_COPY_MODE_COMPACT);
+            }
+
+            // Wait for the compaction to complete
+            GetCmdList(d3d)->ResourceBarrier(1, &uavBarrier);
 
             return true;
         }
 
+        /**
+         * Describe a scene mesh instance for the TLAS.
+         */
+        D3D12_RAYTRACING_INSTANCE_DESC GetSceneInstanceDesc(const Resources& resources, const Scenes::MeshInstance& instance)
+        {
+            D3D12_RAYTRACING_INSTANCE_DESC desc = {};
+            desc.InstanceID = instance.meshIndex; // quantized to 24-bits
+            desc.InstanceMask = 0xFF;
+
+            // Probe rays of a DDGIVolume only traverse the instances within their reach
+            if (!resources.tlasVolumeBounds.empty())
+            {
+                desc.InstanceMask = TLAS_INSTANCE_MASK_SCENE;
+                for (UINT volumeIndex = 0; volumeIndex < static_cast<UINT>(resources.tlasVolumeBounds.size()); volumeIndex++)
+                {
+                    const rtxgi::AABB& bounds = resources.tlasVolumeBounds[volumeIndex];
+                    if (instance.boundingBox.min.x > bounds.max.x || instance.boundingBox.max.x < bounds.min.x) continue;
+                    if (instance.boundingBox.min.y > bounds.max.y || instance.boundingBox.max.y < bounds.min.y) continue;
+                    if (instance.boundingBox.min.z > bounds.max.z || instance.boundingBox.max.z < bounds.min.z) continue;
+                    desc.InstanceMask |= (1u << (volumeIndex % 7));
+                }
+            }
+            desc.AccelerationStructure = resources.blas.GetGPUVirtualAddress(instance.meshIndex);
+        #if COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT || COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT_Z_UP
+            desc.Flags = D3D12_RAYTRACING_INSTANCE_FLAG_TRIANGLE_FRONT_COUNTERCLOCKWISE;
+        #endif
+            desc.Flags |= D3D12_RAYTRACING_INSTANCE_FLAG_TRIANGLE_CULL_DISABLE;
+
+            // Write the instance transform
+            memcpy(desc.Transform, instance.transform, sizeof(XMFLOAT4) * 3);
+
+            return desc;
+        }
+
         /**
          * Create the scene's top level acceleration structure.
          */
@@ -1761,23 +2860,7 @@ namespace Graphics
             std::vector<D3D12_RAYTRACING_INSTANCE_DESC> instances;
             for (size_t instanceIndex = 0; instanceIndex < scene.instances.size(); instanceIndex++)
             {
-                // Get the mesh instance
-                const Scenes::MeshInstance& instance = scene.instances[instanceIndex];
-
-                // Describe the mesh instance
-                D3D12_RAYTRACING_INSTANCE_DESC desc = {};
-                desc.InstanceID = instance.meshIndex; // quantized to 24-bits
-                desc.InstanceMask = 0xFF;
-                desc.AccelerationStructure = resources.blas[instance.meshIndex].as->GetGPUVirtualAddress();
-            #if COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT || COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT_Z_UP
-                desc.Flags = D3D12_RAYTRACING_INSTANCE_FLAG_TRIANGLE_FRONT_COUNTERCLOCKWISE;
-            #endif
-                desc.Flags |= D3D12_RAYTRACING_INSTANCE_FLAG_TRIANGLE_CULL_DISABLE;
-
-                // Write the instance transform
-                memcpy(desc.Transform, instance.transform, sizeof(XMFLOAT4) * 3);
-
-                instances.push_back(desc);
+                instances.push_back(GetSceneInstanceDesc(resources, scene.instances[instanceIndex]));
             }
 
             // Create the TLAS instances buffer
@@ -1799,38 +2882,145 @@ namespace Graphics
             return true;
         }
 
+        /**
+         * Create the texture streaming feedback buffer, with a uint for each material texture index (see TextureStreaming.hlsl).
+         */
+        bool CreateTextureStreamingFeedback(Globals& d3d, Resources& resources)
+        {
+            TextureStreaming& streaming = resources.textureStreaming;
+            streaming.feedbackSize = static_cast<UINT>((SCENE_TEXTURES_INDEX + MAX_TEXTURES) * sizeof(UINT));
+
+            // Create the feedback buffer
+            BufferDesc desc = { streaming.feedbackSize, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+            if (!CreateBuffer(d3d, desc, &streaming.feedback)) return false;
+        #ifdef GFX_NAME_OBJECTS
+            streaming.feedback->SetName(L"Texture Streaming Feedback");
+        #endif
+
+            // Create the buffer of zeros that clears the feedback buffer
+            desc = { streaming.feedbackSize, 0, EHeapType::UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE };
+            if (!CreateBuffer(d3d, desc, &streaming.feedbackClear)) return false;
+        #ifdef GFX_NAME_OBJECTS
+            streaming.feedbackClear->SetName(L"Texture Streaming Feedback Clear");
+        #endif
+
+            UINT8* pData = nullptr;
+            D3D12_RANGE readRange = {};
+            D3DCHECK(streaming.feedbackClear->Map(0, &readRange, reinterpret_cast<void**>(&pData)));
+            memset(pData, 0, streaming.feedbackSize);
+            streaming.feedbackClear->Unmap(0, nullptr);
+
+            // Create the readback buffers
+            desc = { streaming.feedbackSize, 0, EHeapType::READBACK, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_FLAG_NONE };
+            for (UINT frameIndex = 0; frameIndex < MAX_FRAMES_IN_FLIGHT; frameIndex++)
+            {
+                if (!CreateBuffer(d3d, desc, &streaming.feedbackReadback[frameIndex])) return false;
+            #ifdef GFX_NAME_OBJECTS
+                streaming.feedbackReadback[frameIndex]->SetName(L"Texture Streaming Feedback Readback");
+            #endif
+                streaming.feedbackReadbackFrame[frameIndex] = 0;
+            }
+
+            // Add the feedback buffer UAV (RWByteAddressBuffer) to the descriptor heap
+            D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+            uavDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+            uavDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+            uavDesc.Buffer.FirstElement = 0;
+            uavDesc.Buffer.NumElements = streaming.feedbackSize / sizeof(UINT);
+            uavDesc.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_RAW;
+
+            D3D12_CPU_DESCRIPTOR_HANDLE handle;
+            handle.ptr = resources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_TEXTURE_FEEDBACK * resources.srvDescHeapEntrySize);
+            d3d.device->CreateUnorderedAccessView(streaming.feedback, nullptr, &uavDesc, handle);
+
+            return true;
+        }
+
         /**
          * Create the scene textures.
+         * With texture streaming, only the mip tails of BC7 textures are created, finer mip levels are streamed in on request.
          */
         bool CreateSceneTextures(Globals& d3d, Resources& resources, const Scenes::Scene& scene, std::ofstream& log)
         {
             // Early out if there are no scene textures
             if (scene.textures.size() == 0) return true;
 
-            D3D12_CPU_DESCRIPTOR_HANDLE handle;
-            handle.ptr = resources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::SRV_SCENE_TEXTURES * resources.srvDescHeapEntrySize);
+            TextureStreaming& streaming = resources.textureStreaming;
+            if (streaming.enabled)
+            {
+                CHECK(CreateTextureStreamingFeedback(d3d, resources), "create texture streaming feedback buffers!\n", log);
+                streaming.textures.resize(scene.textures.size());
+            }
 
-            // Create the default and upload heap texture resources
+            // Create the texture resources and schedule their uploads
             for (UINT textureIndex = 0; textureIndex < static_cast<UINT>(scene.textures.size()); textureIndex++)
             {
                 // Get the texture
                 const Textures::Texture texture = scene.textures[textureIndex];
 
-                // Create the GPU texture resources, upload the texture data, and schedule a copy
-                CHECK(CreateAndUploadTexture(d3d, resources, texture, log), "create and upload scene texture!\n", log);
+                // Find the mip tail of streamed textures, the largest mip level that fits in the tail size
+                UINT tailMip = 0;
+                if (streaming.enabled && texture.format == Textures::ETextureFormat::BC7 && texture.texels != nullptr)
+                {
+                    while ((tailMip + 1 < texture.mips) && ((std::max)(texture.width >> tailMip, texture.height >> tailMip) > streaming.tailSize)) tailMip++;
+                    tailMip = GetStreamableMip(texture, tailMip);
+                }
+
+                // Submit the texture uploads recorded so far when they fill the upload ring
+                CHECK(FlushInitUploads(d3d), "flush the scene texture uploads!\n", log);
 
-                // Add the texture SRV to the descriptor heap
-                D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-                srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-                srvDesc.Texture2D.MipLevels = texture.mips;
-                srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-                if (texture.format == Textures::ETextureFormat::UNCOMPRESSED) srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-                else if(texture.format == Textures::ETextureFormat::BC7) srvDesc.Format = DXGI_FORMAT_BC7_UNORM;
+                if (tailMip > 0)
+                {
+                    resources.sceneTextures.emplace_back();
+
+                    // Allocate the mip tail in the upload ring
+                    UploadAllocation upload;
+                    CHECK(AllocateUpload(d3d, GetStreamedTextureUploadSize(d3d, texture, tailMip), D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, upload), "allocate the texture upload memory!", log);
+
+                    // Create the mip tail texture resource and schedule its upload
+                    UINT64 uploadOffset = upload.offset;
+                    bool result = UploadStreamedTexture(
+                        d3d,
+                        texture,
+                        tailMip,
+                        D3D12_RESOURCE_STATE_COPY_DEST,
+                        GetCmdList(d3d),
+                        upload.buffer,
+                        upload.ptr - upload.offset,
+                        uploadOffset,
+                        &resources.sceneTextures.back());
+                    CHECK(result, "create and upload scene texture mip tail!\n", log);
+
+                    // Transition the mip tail texture resource to a shader resource
+                    D3D12_RESOURCE_BARRIER barrier = {};
+                    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+                    barrier.Transition.pResource = resources.sceneTextures.back();
+                    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+                    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+                    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+
+                    GetCmdList(d3d)->ResourceBarrier(1, &barrier);
+                }
+                else
+                {
+                    // Create the GPU texture resources, upload the texture data, and schedule a copy
+                    CHECK(CreateAndUploadTexture(d3d, resources, texture, log), "create and upload scene texture!\n", log);
+                }
 
-                d3d.device->CreateShaderResourceView(resources.sceneTextures[textureIndex], &srvDesc, handle);
+                if (streaming.enabled)
+                {
+                    // Track the resident mip levels and memory of the texture
+                    D3D12_RESOURCE_DESC desc = resources.sceneTextures[textureIndex]->GetDesc();
+
+                    StreamedTexture& streamed = streaming.textures[textureIndex];
+                    streamed.streamed = (tailMip > 0);
+                    streamed.tailMip = streamed.residentMip = streamed.requestedMip = tailMip;
+                    streamed.residentBytes = d3d.device->GetResourceAllocationInfo(0, 1, &desc).SizeInBytes;
+                    streaming.residentBytes += streamed.residentBytes;
+                }
 
-                // Move to the next slot on the descriptor heap
-                handle.ptr += resources.srvDescHeapEntrySize;
+                // Add the texture SRV to the descriptor heap
+                CreateSceneTextureSRV(d3d, resources, texture, textureIndex);
             }
 
             return true;
@@ -1890,168 +3080,241 @@ namespace Graphics
         //----------------------------------------------------------------------------------------------------------
 
         /**
-         * Write an image (or images) to disk from the given D3D12 resource.
+         * Get a readback buffer of the given size from the capture pool, or create one.
          */
-        bool WriteResourceToDisk(Globals& d3d, std::string file, ID3D12Resource* pResource, D3D12_RESOURCE_STATES state)
+        bool AcquireCaptureReadback(Globals& d3d, UINT64 size, ID3D12Resource** ppReadback)
         {
-            // Get the heap properties
-            D3D12_HEAP_PROPERTIES sourceHeapProperties = {};
-            D3D12_HEAP_FLAGS sourceHeapFlags = {};
-            D3DCHECK(pResource->GetHeapProperties(&sourceHeapProperties, &sourceHeapFlags));
+            std::vector<ID3D12Resource*>& pool = d3d.captures.readbackPool;
+            for (size_t index = 0; index < pool.size(); index++)
+            {
+                if (pool[index]->GetDesc().Width != size) continue;
+                *ppReadback = pool[index];
+                pool.erase(pool.begin() + index);
+                return true;
+            }
 
-            // Create a command allocator
-            ID3D12CommandAllocator* commandAlloc = nullptr;
-            D3DCHECK(d3d.device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&commandAlloc)));
+            BufferDesc desc = { size, 0, EHeapType::READBACK, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_FLAG_NONE };
+            if (!CreateBuffer(d3d, desc, ppReadback)) return false;
         #ifdef GFX_NAME_OBJECTS
-            commandAlloc->SetName(L"WriteResourceToDisk Command Allocator");
+            (*ppReadback)->SetName(L"Resource Capture Readback Buffer");
         #endif
+            return true;
+        }
 
-            // Create a command list
-            ID3D12GraphicsCommandList* commandList = nullptr;
-            D3DCHECK(d3d.device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAlloc, nullptr, IID_PPV_ARGS(&commandList)));
-        #ifdef GFX_NAME_OBJECTS
-            commandList->SetName(L"WriteResourceToDisk Command List");
-        #endif
+        /**
+         * Record the copies of the requested captures on the current frame's command list, called when the list is reset.
+         * The source resources are expected in their capture states at the start of the frame.
+         */
+        bool RecordResourceCaptures(Globals& d3d)
+        {
+            ResourceCaptures& captures = d3d.captures;
+            if (captures.requested.empty()) return true;
 
-            // Create fence
-            ID3D12Fence* fence = nullptr;
-            D3DCHECK(d3d.device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence)));
-        #ifdef GFX_NAME_OBJECTS
-            fence->SetName(L"WriteResourceToDisk Fence");
-        #endif
+            ID3D12GraphicsCommandList5* cmdList = d3d.cmdList[d3d.frameIndex];
+            for (ResourceCapture& capture : captures.requested)
+            {
+                // Get the row count and row size in bytes of the (sub)resource
+                UINT64 rowSizeInBytes;
+                d3d.device->GetCopyableFootprints(&capture.desc, 0, 1, 0, nullptr, &capture.numRows, &rowSizeInBytes, nullptr);
 
-            // Get the resource descriptor
-            const D3D12_RESOURCE_DESC desc = pResource->GetDesc();
-
-            // Get the row count, row size in bytes, and size in bytes of the (sub)resource
-            UINT numRows;
-            UINT64 rowSizeInBytes;
-            UINT64 sizeInBytes;
-            d3d.device->GetCopyableFootprints(
-                &desc,
-                0,
-                1,
-                0,
-                nullptr,
-                &numRows,
-                &rowSizeInBytes,
-                &sizeInBytes);
-
-            // Round up the source row size (pitch) to multiples of 256B
-            UINT64 dstRowPitch = (rowSizeInBytes + 255) & ~0xFF;
-
-            // Describe the staging (read-back) buffer resource
-            D3D12_RESOURCE_DESC bufferDesc = {};
-            bufferDesc.Alignment = desc.Alignment;
-            bufferDesc.DepthOrArraySize = 1;
-            bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-            bufferDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
-            bufferDesc.Format = DXGI_FORMAT_UNKNOWN;
-            bufferDesc.Height = 1;
-            bufferDesc.Width = dstRowPitch * desc.Height;
-            bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-            bufferDesc.MipLevels = 1;
-            bufferDesc.SampleDesc.Count = 1;
-            bufferDesc.SampleDesc.Quality = 0;
-
-            // Transition the source texture resource to a copy source
-            D3D12_RESOURCE_BARRIER barrier = {};
-            barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-            barrier.Transition.pResource = pResource;
-            barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-            barrier.Transition.StateBefore = state;
-            barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
+                // Round up the source row size (pitch) to multiples of 256B
+                capture.rowPitch = (rowSizeInBytes + 255) & ~0xFF;
 
-            commandList->ResourceBarrier(1, &barrier);
-
-            // Loop over the subresources (array slices), copying them from the GPU
-            std::vector<ID3D12Resource*> stagingResources;
-            for(UINT subresourceIndex = 0; subresourceIndex < desc.DepthOrArraySize; subresourceIndex++)
-            {
-                // Create a staging texture resource
-                stagingResources.emplace_back(nullptr);
-                D3DCHECK(d3d.device->CreateCommittedResource(
-                    &readbackHeapProps,
-                    D3D12_HEAP_FLAG_NONE,
-                    &bufferDesc,
-                    D3D12_RESOURCE_STATE_COPY_DEST,
-                    nullptr,
-                    IID_PPV_ARGS(&stagingResources[subresourceIndex])));
-
-                // Describe the copy footprint of the resource
-                D3D12_PLACED_SUBRESOURCE_FOOTPRINT subresource = {};
-                subresource.Footprint.Width = static_cast<UINT>(desc.Width);
-                subresource.Footprint.Height = desc.Height;
-                subresource.Footprint.Depth = 1;
-                subresource.Footprint.RowPitch = static_cast<UINT>(dstRowPitch);
-                subresource.Footprint.Format = desc.Format;
-
-                // Describe the copy source resource
-                D3D12_TEXTURE_COPY_LOCATION copySrc = {};
-                copySrc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
-                copySrc.pResource = pResource;
-                copySrc.SubresourceIndex = subresourceIndex;
-
-                // Describe the copy destination resource
-                D3D12_TEXTURE_COPY_LOCATION copyDest = {};
-                copyDest.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
-                copyDest.pResource = stagingResources[subresourceIndex];
-                copyDest.PlacedFootprint = subresource;
-
-                // Schedule the texture copy
-                commandList->CopyTextureRegion(&copyDest, 0, 0, 0, &copySrc, nullptr);
-            }
-
-            // Transition the source texture resource to the specified state
-            barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE;
-            barrier.Transition.StateAfter = state;
-            commandList->ResourceBarrier(1, &barrier);
+                // Transition the source texture resource to a copy source
+                D3D12_RESOURCE_BARRIER barrier = {};
+                barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+                barrier.Transition.pResource = capture.resource;
+                barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+                barrier.Transition.StateBefore = capture.state;
+                barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
+                cmdList->ResourceBarrier(1, &barrier);
 
-            // Close the command list
-            D3DCHECK(commandList->Close());
+                // Copy the subresources (array slices) to readback buffers
+                for (UINT subresourceIndex = 0; subresourceIndex < capture.desc.DepthOrArraySize; subresourceIndex++)
+                {
+                    ID3D12Resource* readback = nullptr;
+                    if (!AcquireCaptureReadback(d3d, capture.rowPitch * capture.desc.Height, &readback)) return false;
+                    capture.readbacks.push_back(readback);
+
+                    // Describe the copy footprint of the resource
+                    D3D12_PLACED_SUBRESOURCE_FOOTPRINT subresource = {};
+                    subresource.Footprint.Width = static_cast<UINT>(capture.desc.Width);
+                    subresource.Footprint.Height = capture.desc.Height;
+                    subresource.Footprint.Depth = 1;
+                    subresource.Footprint.RowPitch = static_cast<UINT>(capture.rowPitch);
+                    subresource.Footprint.Format = capture.desc.Format;
+
+                    // Describe the copy source resource
+                    D3D12_TEXTURE_COPY_LOCATION copySrc = {};
+                    copySrc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+                    copySrc.pResource = capture.resource;
+                    copySrc.SubresourceIndex = subresourceIndex;
+
+                    // Describe the copy destination resource
+                    D3D12_TEXTURE_COPY_LOCATION copyDest = {};
+                    copyDest.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+                    copyDest.pResource = readback;
+                    copyDest.PlacedFootprint = subresource;
+
+                    // Schedule the texture copy
+                    cmdList->CopyTextureRegion(&copyDest, 0, 0, 0, &copySrc, nullptr);
+                }
+
+                // Transition the source texture resource back to its state
+                barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE;
+                barrier.Transition.StateAfter = capture.state;
+                cmdList->ResourceBarrier(1, &barrier);
+
+                // The command list keeps the source alive until it is executed
+                SAFE_RELEASE(capture.resource);
+                captures.copying.push_back(std::move(capture));
+            }
+            captures.requested.clear();
+
+            return true;
+        }
+
+        /**
+         * Queue the image writes of the captures the GPU has copied, and return their readback buffers to the pool.
+         */
+        bool RetireResourceCaptures(Globals& d3d)
+        {
+            ResourceCaptures& captures = d3d.captures;
+            if (captures.fence == nullptr) return true;
+
+            UINT64 completed = captures.fence->GetCompletedValue();
+            for (size_t index = 0; index < captures.copying.size();)
+            {
+                ResourceCapture& capture = captures.copying[index];
+                if (capture.fenceValue == 0 || capture.fenceValue > completed) { index++; continue; }
+
+                for (UINT subresourceIndex = 0; subresourceIndex < static_cast<UINT>(capture.readbacks.size()); subresourceIndex++)
+                {
+                    // Copy out the image, so the readback buffer can be reused right away
+                    UINT8* pData = nullptr;
+                    UINT64 imageSize = capture.rowPitch * capture.numRows;
+                    D3D12_RANGE readRange = { 0, static_cast<size_t>(imageSize) };
+                    D3DCHECK(capture.readbacks[subresourceIndex]->Map(0, &readRange, reinterpret_cast<void**>(&pData)));
+                    std::shared_ptr<std::vector<UINT8>> image = std::make_shared<std::vector<UINT8>>(pData, pData + imageSize);
+
+                    D3D12_RANGE writeRange = {};
+                    capture.readbacks[subresourceIndex]->Unmap(0, &writeRange);
+                    captures.readbackPool.push_back(capture.readbacks[subresourceIndex]);
+
+                    std::string filename = capture.file;
+                    if (capture.desc.DepthOrArraySize > 1) filename += "-Layer-" + std::to_string(subresourceIndex);
+
+                    // Convert the resource to RGBA8 UNORM (using WIC) and write it to disk in the capture format,
+                    // or write half-float resources as is with HDR captures
+                    D3D12_RESOURCE_DESC desc = capture.desc;
+                    UINT64 rowPitch = capture.rowPitch;
+                    ImageCapture::QueueWrite([desc, rowPitch, image, filename]()
+                    {
+                        uint32_t width = static_cast<uint32_t>(desc.Width);
+                        bool result = false;
+                        if (ImageCapture::GetHdr() && desc.Format == DXGI_FORMAT_R16G16B16A16_FLOAT)
+                        {
+                            result = ImageCapture::CaptureHdr(filename, width, desc.Height, rowPitch, image->data());
+                        }
+                        else
+                        {
+                            std::vector<unsigned char> converted(desc.Width * desc.Height * ImageCapture::NumChannels);
+                            result = SUCCEEDED(ImageCapture::ConvertTextureResource(desc, image->size(), rowPitch, image->data(), converted));
+                            result = result && ImageCapture::CaptureImage(filename, width, desc.Height, converted.data());
+                        }
+                        if (!result) LOG_ERROR("Graphics", "Failed to write resource capture " + filename);
+                        return result;
+                    });
+                }
 
-            // Execute the command list
-            d3d.cmdQueue->ExecuteCommandLists(1, reinterpret_cast<ID3D12CommandList**>(&commandList));
+                captures.copying.erase(captures.copying.begin() + index);
+            }
+
+            return true;
+        }
+
+        /**
+         * Signal the capture fence after submitting the frame's command list, the captures recorded on it are copied once the GPU passes it.
+         */
+        bool SignalResourceCaptures(Globals& d3d)
+        {
+            ResourceCaptures& captures = d3d.captures;
+            if (captures.fence == nullptr) return true;
 
-            // Signal the fence
-            D3DCHECK(d3d.cmdQueue->Signal(fence, 1));
+            bool signal = false;
+            for (ResourceCapture& capture : captures.copying)
+            {
+                if (capture.fenceValue > 0) continue;
+                if (!signal) captures.fenceValue++;
+                capture.fenceValue = captures.fenceValue;
+                signal = true;
+            }
+            if (signal) D3DCHECK(d3d.cmdQueue->Signal(captures.fence, captures.fenceValue));
+
+            return RetireResourceCaptures(d3d);
+        }
 
-            // Block until the copy is complete
-            while (fence->GetCompletedValue() < 1) SwitchToThread();
+        /**
+         * Complete every capture (recording the copies still requested), wait for the images to be written, and stop the capture worker.
+         */
+        bool FlushResourceCaptures(Globals& d3d)
+        {
+            ResourceCaptures& captures = d3d.captures;
+            if (captures.fence == nullptr) return true;
 
-            // Copy the staging resources and write them to disk
-            bool result = true;
-            for (UINT subresourceIndex = 0; subresourceIndex < desc.DepthOrArraySize; subresourceIndex++)
+            // Copy the captures requested after the last frame on a command list of their own
+            if (!captures.requested.empty())
             {
-                // Map the staging texture resource
-                UINT8* pData = nullptr;
-                UINT64 imageSize = dstRowPitch * numRows;
-                D3D12_RANGE readRange = { 0, static_cast<size_t>(imageSize) };
-                D3DCHECK(stagingResources[subresourceIndex]->Map(0, &readRange, (void**)&pData));
+                if (!WaitForGPU(d3d)) return false;
+                D3DCHECK(d3d.cmdAlloc[d3d.frameIndex]->Reset());
+                D3DCHECK(d3d.cmdList[d3d.frameIndex]->Reset(d3d.cmdAlloc[d3d.frameIndex], nullptr));
+                if (!RecordResourceCaptures(d3d)) return false;
+                D3DCHECK(d3d.cmdList[d3d.frameIndex]->Close());
+
+                ID3D12CommandList* pCmdList = { d3d.cmdList[d3d.frameIndex] };
+                d3d.cmdQueue->ExecuteCommandLists(1, &pCmdList);
+            }
+            if (!SignalResourceCaptures(d3d)) return false;
 
-                // Convert the resource to RGBA8 UNORM (using WIC)
-                std::vector<unsigned char> converted(desc.Width * desc.Height * ImageCapture::NumChannels);
-                D3DCHECK(ImageCapture::ConvertTextureResource(desc, imageSize, dstRowPitch, pData, converted));
+            // Wait for the copies, then for the image writes
+            D3DCHECK(captures.fence->SetEventOnCompletion(captures.fenceValue, nullptr));
+            if (!RetireResourceCaptures(d3d)) return false;
+            ImageCapture::Flush();
 
-                // Write the resource to disk as a PNG file (using STB)
-                std::string filename = file;
-                if(desc.DepthOrArraySize > 1) filename += "-Layer-" + std::to_string(subresourceIndex);
-                filename.append(".png");
-                result &= ImageCapture::CapturePng(filename, static_cast<uint32_t>(desc.Width), static_cast<uint32_t>(desc.Height), converted.data());
+            for (ID3D12Resource* readback : captures.readbackPool) SAFE_RELEASE(readback);
+            captures.readbackPool.clear();
+            SAFE_RELEASE(captures.fence);
+            return true;
+        }
 
-                // Unmap the staging texture
-                stagingResources[subresourceIndex]->Unmap(0, nullptr);
+        /**
+         * Write an image (or images) to disk from the given D3D12 resource, asynchronously (see ResourceCaptures).
+         * The resource is copied at the start of the next frame, in the given state, and written to disk by the
+         * ImageCapture writer threads a few frames later.
+         */
+        bool WriteResourceToDisk(Globals& d3d, std::string file, ID3D12Resource* pResource, D3D12_RESOURCE_STATES state)
+        {
+            ResourceCaptures& captures = d3d.captures;
 
-                // Release the staging texture
-                SAFE_RELEASE(stagingResources[subresourceIndex]);
+            // Create the capture fence with the first capture
+            if (captures.fence == nullptr)
+            {
+                D3DCHECK(d3d.device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&captures.fence)));
+            #ifdef GFX_NAME_OBJECTS
+                captures.fence->SetName(L"Resource Capture Fence");
+            #endif
+                captures.fenceValue = 0;
             }
 
-            // Clean up
-            SAFE_RELEASE(fence);
-            SAFE_RELEASE(commandList);
-            SAFE_RELEASE(commandAlloc);
+            ResourceCapture capture;
+            capture.file = file;
+            capture.resource = pResource;
+            capture.resource->AddRef();
+            capture.state = state;
+            capture.desc = pResource->GetDesc();
+            captures.requested.push_back(std::move(capture));
 
-            return result;
+            return true;
         }
 
         //----------------------------------------------------------------------------------------------------------
@@ -2085,15 +3348,59 @@ namespace Graphics
         }
 
         /**
-         * Create a D3D12 device.
+         * Set the resolution of DDGI mode's screen-space passes, a fraction (per axis) of the render targets'.
+         * The render size is even (quad aligned), and the full size at a scale of one.
          */
-        bool CreateDevice(Globals& d3d, Configs::Config& config)
+        void SetResolutionScale(Globals& d3d, float scale)
         {
-        #if _DEBUG
+            d3d.resolutionScale = (std::min)((std::max)(scale, 0.25f), 1.f);
+            if (d3d.resolutionScale < 1.f)
             {
-                // Enable the D3D12 debug layer.
-                ID3D12Debug* debug = nullptr;
-                if (SUCCEEDED(D3D12GetDebugInterface(IID_PPV_ARGS(&debug))))
+                d3d.renderWidth = (std::max)(static_cast<int>(d3d.width * d3d.resolutionScale) & ~1, 2);
+                d3d.renderHeight = (std::max)(static_cast<int>(d3d.height * d3d.resolutionScale) & ~1, 2);
+            }
+            else
+            {
+                d3d.renderWidth = d3d.width;
+                d3d.renderHeight = d3d.height;
+            }
+
+            d3d.renderViewport = d3d.viewport;
+            d3d.renderViewport.Width = static_cast<float>(d3d.renderWidth);
+            d3d.renderViewport.Height = static_cast<float>(d3d.renderHeight);
+            d3d.renderScissor = d3d.scissor;
+            d3d.renderScissor.right = d3d.renderWidth;
+            d3d.renderScissor.bottom = d3d.renderHeight;
+        }
+
+        /**
+         * Get the video memory budget the OS gives the process on the device's adapter (local segment), and the process's usage of it.
+         */
+        bool GetVideoMemoryInfo(Globals& d3d, uint64_t& budget, uint64_t& usage)
+        {
+            IDXGIAdapter3* adapter = nullptr;
+            if (FAILED(d3d.factory->EnumAdapterByLuid(d3d.device->GetAdapterLuid(), IID_PPV_ARGS(&adapter)))) return false;
+
+            DXGI_QUERY_VIDEO_MEMORY_INFO info = {};
+            HRESULT hr = adapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &info);
+            SAFE_RELEASE(adapter);
+            if (FAILED(hr)) return false;
+
+            budget = info.Budget;
+            usage = info.CurrentUsage;
+            return true;
+        }
+
+        /**
+         * Create a D3D12 device.
+         */
+        bool CreateDevice(Globals& d3d, Configs::Config& config)
+        {
+        #if _DEBUG
+            {
+                // Enable the D3D12 debug layer.
+                ID3D12Debug* debug = nullptr;
+                if (SUCCEEDED(D3D12GetDebugInterface(IID_PPV_ARGS(&debug))))
                 {
                     debug->EnableDebugLayer();
                 }
@@ -2135,11 +3442,22 @@ namespace Graphics
             HRESULT hr = d3d.device->CreateRootSignature(0, sig->GetBufferPointer(), sig->GetBufferSize(), IID_PPV_ARGS(&pRootSig));
             if (FAILED(hr)) return nullptr;
 
+            SetRootSignatureHash(pRootSig, sig->GetBufferPointer(), sig->GetBufferSize());
+
             SAFE_RELEASE(sig);
             SAFE_RELEASE(error);
             return pRootSig;
         }
 
+        /**
+         * Tag a root signature with a hash of its serialized desc, pipelines that use it can then be cached.
+         */
+        void SetRootSignatureHash(ID3D12RootSignature* rootSignature, const void* serialized, size_t size)
+        {
+            uint64_t hash = Caches::Hash(serialized, size);
+            rootSignature->SetPrivateData(RootSignatureHashGUID, sizeof(uint64_t), &hash);
+        }
+
         /**
          * Create a buffer resource.
          */
@@ -2209,10 +3527,234 @@ namespace Graphics
             return true;
         }
 
+        /**
+         * Place a resource in the transient heaps. Resources with overlapping pass ranges get separate memory,
+         * the others may alias it (first fit in the heaps of the resource's category).
+         */
+        bool CreateTransientResource(
+            Globals& d3d,
+            const D3D12_RESOURCE_DESC& desc,
+            D3D12_RESOURCE_STATES state,
+            const D3D12_CLEAR_VALUE* clear,
+            ETransientPass firstPass,
+            ETransientPass lastPass,
+            ID3D12Resource** resource)
+        {
+            TransientHeaps& transients = d3d.transients;
+            D3D12_RESOURCE_ALLOCATION_INFO info = d3d.device->GetResourceAllocationInfo(0, 1, &desc);
+            if (info.SizeInBytes == UINT64_MAX) return false;
+
+            // Resource heap tier 1 only places one resource category in a heap
+            D3D12_HEAP_FLAGS flags = D3D12_HEAP_FLAG_ALLOW_ALL_BUFFERS_AND_TEXTURES;
+            if (!d3d.supportsMixedResourceHeaps)
+            {
+                if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER) flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+                else if (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)) flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+                else flags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+            }
+
+            TransientAllocation allocation;
+            allocation.heapIndex = UINT_MAX;
+            allocation.size = info.SizeInBytes;
+            allocation.firstPass = firstPass;
+            allocation.lastPass = lastPass;
+            for (UINT heapIndex = 0; heapIndex < static_cast<UINT>(transients.heaps.size()); heapIndex++)
+            {
+                const TransientHeap& heap = transients.heaps[heapIndex];
+                if (heap.flags != flags || heap.size < info.SizeInBytes) continue;
+
+                // Memory of the heap's resources in use during the same passes
+                std::vector<std::pair<UINT64, UINT64>> used;
+                for (const TransientAllocation& other : transients.allocations)
+                {
+                    if (other.heapIndex != heapIndex) continue;
+                    if (other.lastPass < firstPass || other.firstPass > lastPass) continue;
+                    used.push_back({ other.offset, other.offset + other.size });
+                }
+                std::sort(used.begin(), used.end());
+
+                // Find the first gap that fits
+                UINT64 offset = 0;
+                for (const std::pair<UINT64, UINT64>& range : used)
+                {
+                    if (offset + info.SizeInBytes <= range.first) break;
+                    offset = (std::max)(offset, ALIGN(info.Alignment, range.second));
+                }
+                if (offset + info.SizeInBytes > heap.size) continue;
+
+                allocation.heapIndex = heapIndex;
+                allocation.offset = offset;
+                break;
+            }
+
+            if (allocation.heapIndex == UINT_MAX)
+            {
+                TransientHeap heap;
+                heap.flags = flags;
+                heap.size = ALIGN(info.Alignment, (std::max)(transients.heapSize, info.SizeInBytes));
+
+                D3D12_HEAP_DESC heapDesc = {};
+                heapDesc.SizeInBytes = heap.size;
+                heapDesc.Properties = defaultHeapProps;
+                heapDesc.Alignment = info.Alignment;
+                heapDesc.Flags = flags;
+                D3DCHECK(d3d.device->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap.heap)));
+            #ifdef GFX_NAME_OBJECTS
+                std::wstring name = L"Transient Heap " + std::to_wstring(transients.heaps.size());
+                heap.heap->SetName(name.c_str());
+            #endif
+
+                allocation.heapIndex = static_cast<UINT>(transients.heaps.size());
+                allocation.offset = 0;
+                transients.heaps.push_back(heap);
+            }
+
+            D3DCHECK(d3d.device->CreatePlacedResource(transients.heaps[allocation.heapIndex].heap, allocation.offset, &desc, state, clear, IID_PPV_ARGS(resource)));
+            allocation.resource = *resource;
+            transients.allocations.push_back(allocation);
+
+            return true;
+        }
+
+        /**
+         * Create a transient buffer resource on the default heap.
+         */
+        bool CreateTransientBuffer(Globals& d3d, const BufferDesc& info, ETransientPass firstPass, ETransientPass lastPass, ID3D12Resource** resource)
+        {
+            // Describe the buffer resource
+            D3D12_RESOURCE_DESC desc = {};
+            desc.Alignment = 0;
+            desc.Height = 1;
+            desc.Width = info.size;
+            desc.MipLevels = 1;
+            desc.DepthOrArraySize = 1;
+            desc.SampleDesc.Count = 1;
+            desc.SampleDesc.Quality = 0;
+            desc.Format = DXGI_FORMAT_UNKNOWN;
+            desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+            desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+            desc.Flags = info.flags;
+
+            return CreateTransientResource(d3d, desc, info.state, nullptr, firstPass, lastPass, resource);
+        }
+
+        /**
+         * Create a transient texture resource on the default heap.
+         * Note: render target and depth stencil textures must be cleared (or discarded) in their first pass.
+         */
+        bool CreateTransientTexture(Globals& d3d, const TextureDesc& info, ETransientPass firstPass, ETransientPass lastPass, ID3D12Resource** resource)
+        {
+            // Describe the texture resource
+            D3D12_RESOURCE_DESC desc = {};
+            desc.Width = info.width;
+            desc.Height = info.height;
+            desc.MipLevels = info.mips;
+            desc.Format = info.format;
+            desc.DepthOrArraySize = (UINT16)info.arraySize;
+            desc.SampleDesc.Count = 1;
+            desc.SampleDesc.Quality = 0;
+            desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+            desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+            desc.Flags = info.flags;
+
+            // Setup the optimized clear value
+            D3D12_CLEAR_VALUE clear = {};
+            clear.Color[3] = 1.f;
+            clear.Format = info.format;
+
+            bool useClear = (info.flags & D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+            return CreateTransientResource(d3d, desc, info.state, useClear ? &clear : nullptr, firstPass, lastPass, resource);
+        }
+
+        /**
+         * Release a transient resource, its memory is reused by later transient resources.
+         */
+        void ReleaseTransient(Globals& d3d, ID3D12Resource*& resource)
+        {
+            if (resource == nullptr) return;
+
+            std::vector<TransientAllocation>& allocations = d3d.transients.allocations;
+            for (size_t index = 0; index < allocations.size(); index++)
+            {
+                if (allocations[index].resource != resource) continue;
+                allocations.erase(allocations.begin() + index);
+                break;
+            }
+            SAFE_RELEASE(resource);
+        }
+
+        /**
+         * Activate the transient resources whose first pass is the given pass. Record before the pass uses them.
+         * The previous contents of the memory are undefined, the pass must overwrite (or clear) what it reads.
+         */
+        void AliasTransients(Globals& d3d, ID3D12GraphicsCommandList* cmdList, ETransientPass pass)
+        {
+            if (d3d.transients.allocations.empty()) return;
+
+            D3D12_RESOURCE_BARRIER* barriers = d3d.frameArena.Allocate<D3D12_RESOURCE_BARRIER>(d3d.transients.allocations.size());
+            UINT numBarriers = 0;
+            for (const TransientAllocation& allocation : d3d.transients.allocations)
+            {
+                if (allocation.firstPass != pass) continue;
+
+                D3D12_RESOURCE_BARRIER& barrier = barriers[numBarriers++];
+                barrier = {};
+                barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+                barrier.Aliasing.pResourceBefore = nullptr;
+                barrier.Aliasing.pResourceAfter = allocation.resource;
+            }
+            if (numBarriers > 0) cmdList->ResourceBarrier(numBarriers, barriers);
+        }
+
+        /**
+         * Record the barriers batched across several volumes or passes in one call, then clear the batch.
+         * With enhanced barriers, the UAV barriers become a single global barrier between compute shader writes and the
+         * shader reads and writes that follow (compute only on the compute queue), instead of one barrier per resource.
+         * Transitions stay legacy barriers.
+         */
+        void FlushBarriers(Globals& d3d, ID3D12GraphicsCommandList* cmdList, std::vector<D3D12_RESOURCE_BARRIER>& barriers)
+        {
+            if (barriers.empty()) return;
+
+            ID3D12GraphicsCommandList7* cmdList7 = nullptr;
+            if (d3d.enhancedBarriers && d3d.supportsEnhancedBarriers) cmdList->QueryInterface(IID_PPV_ARGS(&cmdList7));
+            if (cmdList7)
+            {
+                // Keep the transitions, drop the UAV barriers
+                bool uav = false;
+                std::vector<D3D12_RESOURCE_BARRIER>::iterator end = std::remove_if(barriers.begin(), barriers.end(), [&uav](const D3D12_RESOURCE_BARRIER& barrier)
+                {
+                    if (barrier.Type != D3D12_RESOURCE_BARRIER_TYPE_UAV) return false;
+                    uav = true;
+                    return true;
+                });
+                barriers.erase(end, barriers.end());
+
+                if (uav)
+                {
+                    D3D12_GLOBAL_BARRIER global = {};
+                    global.SyncBefore = D3D12_BARRIER_SYNC_COMPUTE_SHADING;
+                    global.SyncAfter = (cmdList->GetType() == D3D12_COMMAND_LIST_TYPE_COMPUTE) ? D3D12_BARRIER_SYNC_COMPUTE_SHADING : D3D12_BARRIER_SYNC_ALL_SHADING;
+                    global.AccessBefore = D3D12_BARRIER_ACCESS_UNORDERED_ACCESS;
+                    global.AccessAfter = D3D12_BARRIER_ACCESS_UNORDERED_ACCESS | D3D12_BARRIER_ACCESS_SHADER_RESOURCE;
+
+                    D3D12_BARRIER_GROUP group = {};
+                    group.Type = D3D12_BARRIER_TYPE_GLOBAL;
+                    group.NumBarriers = 1;
+                    group.pGlobalBarriers = &global;
+                    cmdList7->Barrier(1, &group);
+                }
+                cmdList7->Release();
+            }
+
+            if (!barriers.empty()) cmdList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+            barriers.clear();
+        }
+
         /**
          * Create a compute pipeline state object.
          */
-        bool CreateComputePSO(ID3D12Device* device, ID3D12RootSignature* rootSignature, const Shaders::ShaderProgram& shader, ID3D12PipelineState** pso)
+        bool CreateComputePSO(Globals& d3d, ID3D12RootSignature* rootSignature, const Shaders::ShaderProgram& shader, ID3D12PipelineState** pso)
         {
             if (!rootSignature) return false;
             if (!shader.bytecode) return false;
@@ -2223,7 +3765,20 @@ namespace Graphics
             desc.CS.BytecodeLength = shader.bytecode->GetBufferSize();
             desc.CS.pShaderBytecode = shader.bytecode->GetBufferPointer();
 
-            D3DCHECK(device->CreateComputePipelineState(&desc, IID_PPV_ARGS(pso)));
+            // Load the pipeline from the pipeline cache (this launch's library first, then the previous launch's)
+            std::wstring name;
+            if (GetPipelineName(d3d, rootSignature, Caches::Hash(desc.CS.pShaderBytecode, desc.CS.BytecodeLength), name))
+            {
+                if (SUCCEEDED(d3d.pipelines.library->LoadComputePipeline(name.c_str(), &desc, IID_PPV_ARGS(pso)))) return true;
+                if (!d3d.pipelines.previous || FAILED(d3d.pipelines.previous->LoadComputePipeline(name.c_str(), &desc, IID_PPV_ARGS(pso))))
+                {
+                    D3DCHECK(d3d.device->CreateComputePipelineState(&desc, IID_PPV_ARGS(pso)));
+                }
+                d3d.pipelines.library->StorePipeline(name.c_str(), *pso);
+                return true;
+            }
+
+            D3DCHECK(d3d.device->CreateComputePipelineState(&desc, IID_PPV_ARGS(pso)));
             return true;
         }
 
@@ -2231,7 +3786,7 @@ namespace Graphics
          * Create a raster graphics pipeline state object.
          */
         bool CreateRasterPSO(
-            ID3D12Device* device,
+            Globals& d3d,
             ID3D12RootSignature* rootSignature,
             const Shaders::ShaderPipeline& shaders,
             const RasterDesc& info,
@@ -2258,12 +3813,39 @@ namespace Graphics
             desc.BlendState = info.blendDesc;
             desc.SampleMask = UINT_MAX;
             desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
-            desc.NumRenderTargets = 1;
-            desc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
+            desc.NumRenderTargets = info.numRenderTargets;
+            if (info.numRenderTargets > 0) desc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
             desc.SampleDesc.Count = 1;
 
+            // Load the pipeline from the pipeline cache (this launch's library first, then the previous launch's)
+            uint64_t hash = Caches::Hash(vs.pShaderBytecode, vs.BytecodeLength);
+            hash = Caches::Hash(ps.pShaderBytecode, ps.BytecodeLength, hash);
+            hash = Caches::Hash(&desc.RasterizerState, sizeof(D3D12_RASTERIZER_DESC), hash);
+            hash = Caches::Hash(&desc.BlendState, sizeof(D3D12_BLEND_DESC), hash);
+            hash = Caches::Hash(&desc.NumRenderTargets, sizeof(UINT), hash);
+            for (UINT elementIndex = 0; elementIndex < info.numInputLayouts; elementIndex++)
+            {
+                const D3D12_INPUT_ELEMENT_DESC& element = info.inputLayoutDescs[elementIndex];
+                hash = Caches::Hash(element.SemanticName, strlen(element.SemanticName), hash);
+                hash = Caches::Hash(&element.SemanticIndex, sizeof(UINT), hash);
+                hash = Caches::Hash(&element.Format, sizeof(DXGI_FORMAT), hash);
+                hash = Caches::Hash(&element.AlignedByteOffset, sizeof(UINT), hash);
+            }
+
+            std::wstring name;
+            if (GetPipelineName(d3d, rootSignature, hash, name))
+            {
+                if (SUCCEEDED(d3d.pipelines.library->LoadGraphicsPipeline(name.c_str(), &desc, IID_PPV_ARGS(pso)))) return true;
+                if (!d3d.pipelines.previous || FAILED(d3d.pipelines.previous->LoadGraphicsPipeline(name.c_str(), &desc, IID_PPV_ARGS(pso))))
+                {
+                    D3DCHECK(d3d.device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(pso)));
+                }
+                d3d.pipelines.library->StorePipeline(name.c_str(), *pso);
+                return true;
+            }
+
             // Create the raster pipeline state object
-            D3DCHECK(device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(pso)));
+            D3DCHECK(d3d.device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(pso)));
             return true;
         }
 
@@ -2271,12 +3853,60 @@ namespace Graphics
          * Create a ray tracing graphics pipeline state object.
          */
         bool CreateRayTracingPSO(
-            ID3D12Device5* device,
+            Globals& d3d,
             ID3D12RootSignature* rootSignature,
             const Shaders::ShaderRTPipeline& shaders,
             ID3D12StateObject** rtpso,
             ID3D12StateObjectProperties** rtpsoProps)
         {
+            ID3D12Device5* device = d3d.device;
+            PipelineCache& pipelines = d3d.pipelines;
+
+            // Hash the shaders, payload size, and root signature (the cached state objects keep their root signatures alive)
+            uint64_t hash = reinterpret_cast<uint64_t>(rootSignature);
+            UINT hashSize = sizeof(uint64_t);
+            rootSignature->GetPrivateData(RootSignatureHashGUID, &hashSize, &hash);
+            hash = Caches::Hash(&hash, sizeof(uint64_t));
+            hash = Caches::Hash(&shaders.payloadSizeInBytes, sizeof(uint32_t), hash);
+            hash = HashRayTracingShader(shaders.rgs, hash);
+            hash = HashRayTracingShader(shaders.miss, hash);
+            for (size_t hitGroupIndex = 0; hitGroupIndex < shaders.hitGroups.size(); hitGroupIndex++)
+            {
+                const Shaders::ShaderRTHitGroup& hitGroup = shaders.hitGroups[hitGroupIndex];
+                hash = Caches::Hash(hitGroup.exportName, wcslen(hitGroup.exportName) * sizeof(wchar_t), hash);
+                hash = HashRayTracingShader(hitGroup.chs, hash);
+                hash = HashRayTracingShader(hitGroup.ahs, hash);
+                hash = HashRayTracingShader(hitGroup.is, hash);
+            }
+
+            // Reuse the state object of an earlier call with the same shaders (e.g. a reload that didn't change these shaders)
+            if (pipelines.library)
+            {
+                for (size_t objectIndex = 0; objectIndex < pipelines.stateObjects.size(); objectIndex++)
+                {
+                    if (pipelines.stateObjects[objectIndex].first != hash) continue;
+
+                    *rtpso = pipelines.stateObjects[objectIndex].second;
+                    (*rtpso)->AddRef();
+                    D3DCHECK((*rtpso)->QueryInterface(IID_PPV_ARGS(rtpsoProps)));
+                    return true;
+                }
+
+                // Release the state objects that were replaced (the cache holds their only reference)
+                for (size_t objectIndex = 0; objectIndex < pipelines.stateObjects.size();)
+                {
+                    ID3D12StateObject* stateObject = pipelines.stateObjects[objectIndex].second;
+                    stateObject->AddRef();
+                    if (stateObject->Release() == 1)
+                    {
+                        stateObject->Release();
+                        pipelines.stateObjects.erase(pipelines.stateObjects.begin() + objectIndex);
+                        continue;
+                    }
+                    objectIndex++;
+                }
+            }
+
             UINT index = 0;
             std::vector<LPCWCHAR> exportNames;
 
@@ -2348,6 +3978,7 @@ namespace Graphics
             {
                 const Shaders::ShaderRTHitGroup& hitGroup = shaders.hitGroups[hitGroupIndex];
                 hitGroupDescs[hitGroupIndex].HitGroupExport = hitGroup.exportName;
+                hitGroupDescs[hitGroupIndex].Type = hitGroup.hasIS() ? D3D12_HIT_GROUP_TYPE_PROCEDURAL_PRIMITIVE : D3D12_HIT_GROUP_TYPE_TRIANGLES;
 
                 if (hitGroup.hasCHS())
                 {
@@ -2480,6 +4111,12 @@ namespace Graphics
             assert(status == NVAPI_OK);
         #endif
 
+            if (pipelines.library)
+            {
+                (*rtpso)->AddRef();
+                pipelines.stateObjects.push_back({ hash, *rtpso });
+            }
+
             return true;
         }
 
@@ -2492,6 +4129,22 @@ namespace Graphics
             d3d.width = config.app.width;
             d3d.height = config.app.height;
             d3d.vsync = config.app.vsync;
+            d3d.FinalGatherDownScale = config.ddgi.indirectScale;
+            d3d.NumVolume = static_cast<UINT>(config.ddgi.volumes.size());  // Radiance cache cascades of the path tracer, when it is initialized before the DDGI workload
+            d3d.PTRadianceCacheBounce = config.pathTrace.radianceCacheBounce;
+            d3d.RadianceCacheHashFunction = config.ddgi.radianceCacheHash;
+            d3d.RadianceCacheBrickLayout = config.ddgi.radianceCacheBricks;
+            d3d.GBufferVisibility = config.app.visibilityBuffer;
+            d3d.GBufferTiles = config.app.gbufferTiles;
+            d3d.TextureStreaming = config.scene.textureStreaming;
+            d3d.GPUCounters = config.app.gpuCounters;
+            d3d.parallelRecording = config.app.parallelRecording;
+            d3d.enhancedBarriers = config.app.enhancedBarriers;
+
+            // Texture streaming
+            resources.textureStreaming.enabled = config.scene.textureStreaming;
+            resources.textureStreaming.budget = static_cast<UINT64>(config.scene.textureStreamingBudget) * 1024 * 1024;
+            resources.textureStreaming.tailSize = (std::max)(config.scene.textureStreamingTailSize, 4u);
 
             // Lighting constants
             resources.constants.lights.hasDirectionalLight = scene.hasDirectionalLight;
@@ -2501,11 +4154,23 @@ namespace Graphics
             // Initialize the shader compiler
             CHECK(Shaders::Initialize(config, d3d.shaderCompiler), "initialize the shader compiler!", log);
 
+            // Open the pipeline cache
+            CreatePipelineCache(d3d, config);
+
             // Create D3D12 device objects
             CHECK(CreateCmdQueue(d3d), "create command queue!", log);
             CHECK(CreateCmdAllocators(d3d), "create command allocators!", log);
             CHECK(CreateFences(d3d), "create fence!", log);
             CHECK(CreateCmdLists(d3d), "create command list!", log);
+
+            // Start the pass recording workers, the main thread records a pass too
+            if (d3d.parallelRecording)
+            {
+                uint32_t numWorkers = (std::max)(std::thread::hardware_concurrency(), 2u) - 1;
+                d3d.passWorkers.Start((std::min)(numWorkers, static_cast<uint32_t>(MAX_PASS_CMD_LISTS - 1)));
+            }
+
+            CHECK(CreateUploadRing(d3d), "create upload ring!", log);
             CHECK(CreateDescriptorHeaps(d3d, resources, scene), "create descriptor heaps!", log);
             CHECK(CreateQueryHeaps(d3d, resources), "create query heaps!", log);
             CHECK(CreateGlobalRootSignature(d3d, resources), "create global root signature!", log);
@@ -2515,6 +4180,7 @@ namespace Graphics
             CHECK(CreateSamplers(d3d, resources), "create samplers!", log);
             CHECK(CreateViewport(d3d), "create viewport!", log);
             CHECK(CreateScissor(d3d), "create scissor!", log);
+            SetResolutionScale(d3d, d3d.resolutionScale);
             CHECK(ResetCmdList(d3d), " reset command list!", log);
 
             // Create default graphics resources
@@ -2524,6 +4190,7 @@ namespace Graphics
             CHECK(CreateSceneCameraConstantBuffer(d3d, resources, scene), "create scene camera constant buffer!", log);
             CHECK(CreateSceneLightsBuffer(d3d, resources, scene), "create scene lights structured buffer!", log);
             CHECK(CreateSceneMaterialsBuffer(d3d, resources, scene), "create scene materials buffer!", log);
+            CHECK(CreateSceneEmissiveLightsBuffers(d3d, resources, scene), "create scene emissive lights buffers!", log);
             CHECK(CreateSceneMaterialIndexingBuffers(d3d, resources, scene), "create scene material indexing buffers!", log);
             CHECK(CreateSceneIndexBuffers(d3d, resources, scene), "create scene index buffers!", log);
             CHECK(CreateSceneVertexBuffers(d3d, resources, scene), "create scene vertex buffers!", log);
@@ -2536,60 +4203,349 @@ namespace Graphics
             D3DCHECK(d3d.cmdList[d3d.frameIndex]->Close());
             ID3D12CommandList* pGraphicsList = { d3d.cmdList[d3d.frameIndex] };
             d3d.cmdQueue->ExecuteCommandLists(1, &pGraphicsList);
+            CHECK(SignalUploads(d3d), "signal the upload ring!", log);
 
             WaitForGPU(d3d);
             ResetCmdList(d3d);
 
-            // Release upload buffers
-            SAFE_RELEASE(resources.materialsSTBUpload);
-            SAFE_RELEASE(resources.meshOffsetsRBUpload);
-            SAFE_RELEASE(resources.geometryDataRBUpload);
-            SAFE_RELEASE(resources.tlas.instancesUpload);
+            // Release the BLAS build resources, the upload ring is recycled (and its dedicated buffers released) by the next allocation
+            resources.blas.ReleaseBuild();
 
-            // Release scene geometry upload buffers
-            UINT resourceIndex;
-            assert(resources.sceneIBs.size() == resources.sceneVBs.size());
-            for (resourceIndex = 0; resourceIndex < static_cast<UINT>(resources.sceneIBs.size()); resourceIndex++)
+            // Unload the CPU-side textures (streamed textures upload their mip levels from the texels, see main.cpp)
+            if (!resources.textureStreaming.enabled) Scenes::Cleanup(scene);
+
+            return true;
+        }
+
+        /**
+         * Post initialization tasks.
+         */
+        bool PostInitialize(Globals& d3d, std::ofstream& log)
+        {
+            // Close and submit the command list
+            D3DCHECK(d3d.cmdList[d3d.frameIndex]->Close());
+            ID3D12CommandList* pGraphicsList = { d3d.cmdList[d3d.frameIndex] };
+            d3d.cmdQueue->ExecuteCommandLists(1, &pGraphicsList);
+            if (!SignalUploads(d3d)) return false;
+
+            WaitForGPU(d3d);
+
+            return true;
+        }
+
+        /**
+         * Record the copies of this frame's scene data from the upload ring to the device buffers,
+         * with one barrier call before and one after all copies.
+         */
+        void RecordBufferCopies(Globals& d3d, const BufferCopies& copies)
+        {
+            if (copies.empty()) return;
+
+            Memory::FixedVector<D3D12_RESOURCE_BARRIER, BufferCopies::capacity()> barriers;
+            for (size_t copyIndex = 0; copyIndex < copies.size(); copyIndex++)
             {
-                SAFE_RELEASE(resources.sceneIBUploadBuffers[resourceIndex]);
-                SAFE_RELEASE(resources.sceneVBUploadBuffers[resourceIndex]);
+                barriers.push_back({});
+                barriers[copyIndex].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+                barriers[copyIndex].Transition.pResource = copies[copyIndex].resource;
+                barriers[copyIndex].Transition.StateBefore = copies[copyIndex].state;
+                barriers[copyIndex].Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
+                barriers[copyIndex].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
             }
-            resources.sceneIBUploadBuffers.clear();
-            resources.sceneVBUploadBuffers.clear();
+            GetCmdList(d3d)->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
 
-            // Release scene texture upload buffers
-            for (UINT resourceIndex = 0; resourceIndex < resources.sceneTextures.size(); resourceIndex++)
+            for (const BufferCopy& copy : copies)
             {
-                SAFE_RELEASE(resources.sceneTextureUploadBuffers[resourceIndex]);
+                GetCmdList(d3d)->CopyBufferRegion(copy.resource, copy.offset, copy.upload.buffer, copy.upload.offset, copy.size);
             }
-            resources.sceneTextureUploadBuffers.clear();
 
-            // Release default texture upload buffers
-            for (UINT resourceIndex = 0; resourceIndex < resources.textures.size(); resourceIndex++)
+            for (D3D12_RESOURCE_BARRIER& barrier : barriers)
+            {
+                std::swap(barrier.Transition.StateBefore, barrier.Transition.StateAfter);
+            }
+            GetCmdList(d3d)->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+        }
+
+        /**
+         * Write the instance descriptors modified since the last frame to the upload ring and add their copy.
+         * Returns true when the TLAS must be refit (or rebuilt, see rebuild) once the copies are recorded.
+         */
+        bool UpdateSceneTLASInstances(Globals& d3d, Resources& resources, Scenes::Scene& scene, BufferCopies& copies, bool& rebuild)
+        {
+            UINT numInstances = static_cast<UINT>(scene.instances.size());
+            if (numInstances == 0 || numInstances > resources.tlasInstancesCapacity) return false; // TLAS buffers are sized at scene load
+
+            // Rewrite all instance descriptors on a rebuild, only the range of dirty instances on a refit
+            rebuild = scene.instancesRebuild || (numInstances != resources.tlasInstancesCapacity);
+            UINT firstDirtyInstance = numInstances;
+            UINT lastDirtyInstance = 0;
+            for (UINT instanceIndex = 0; instanceIndex < numInstances; instanceIndex++)
             {
-                SAFE_RELEASE(resources.textureUploadBuffers[resourceIndex]);
+                Scenes::MeshInstance& instance = scene.instances[instanceIndex];
+                if (rebuild || instance.dirty)
+                {
+                    instance.dirty = false;
+                    firstDirtyInstance = (std::min)(firstDirtyInstance, instanceIndex);
+                    lastDirtyInstance = instanceIndex + 1;
+                }
             }
-            resources.sceneTextureUploadBuffers.clear();
+            scene.instancesRebuild = false;
 
-            // Unload the CPU-side textures
-            Scenes::Cleanup(scene);
+            if (lastDirtyInstance == 0) return false;
 
+            // Write the instance descriptors to the upload ring, frames in flight may still be copying from earlier allocations
+            BufferCopy copy = { resources.tlas.instances, D3D12_RESOURCE_STATE_GENERIC_READ };
+            copy.offset = firstDirtyInstance * sizeof(D3D12_RAYTRACING_INSTANCE_DESC);
+            copy.size = (lastDirtyInstance - firstDirtyInstance) * sizeof(D3D12_RAYTRACING_INSTANCE_DESC);
+            if (!AllocateUpload(d3d, copy.size, D3D12_RAYTRACING_INSTANCE_DESCS_BYTE_ALIGNMENT, copy.upload)) return false;
+
+            D3D12_RAYTRACING_INSTANCE_DESC* desc = reinterpret_cast<D3D12_RAYTRACING_INSTANCE_DESC*>(copy.upload.ptr);
+            for (UINT instanceIndex = firstDirtyInstance; instanceIndex < lastDirtyInstance; instanceIndex++, desc++)
+            {
+                *desc = GetSceneInstanceDesc(resources, scene.instances[instanceIndex]);
+            }
+
+            copies.push_back(copy);
             return true;
         }
 
         /**
-         * Post initialization tasks.
+         * Swap in the streamed textures of the last batch once its copies are complete.
          */
-        bool PostInitialize(Globals& d3d, std::ofstream& log)
+        void SwapStreamedTextures(Globals& d3d, Resources& resources, const Scenes::Scene& scene)
         {
-            // Close and submit the command list
-            D3DCHECK(d3d.cmdList[d3d.frameIndex]->Close());
-            ID3D12CommandList* pGraphicsList = { d3d.cmdList[d3d.frameIndex] };
-            d3d.cmdQueue->ExecuteCommandLists(1, &pGraphicsList);
+            TextureStreaming& streaming = resources.textureStreaming;
+            if (streaming.swaps.empty() || d3d.copyFence->GetCompletedValue() < streaming.fenceValue) return;
 
+            // Descriptors can't be modified while the GPU uses them, wait for the frame in flight
             WaitForGPU(d3d);
 
-            return true;
+            for (const StreamedTextureSwap& swap : streaming.swaps)
+            {
+                StreamedTexture& streamed = streaming.textures[swap.textureIndex];
+
+                // The new resource is in the common state (copy queue decay), it is implicitly promoted to a shader resource
+                SAFE_RELEASE(resources.sceneTextures[swap.textureIndex]);
+                resources.sceneTextures[swap.textureIndex] = swap.resource;
+                CreateSceneTextureSRV(d3d, resources, scene.textures[swap.textureIndex], swap.textureIndex);
+
+                streaming.residentBytes = streaming.residentBytes - streamed.residentBytes + swap.bytes;
+                streamed.residentMip = swap.topMip;
+                streamed.residentBytes = swap.bytes;
+            }
+            streaming.swaps.clear();
+            SAFE_RELEASE(streaming.upload);
+        }
+
+        /**
+         * Read back the mip levels the feedback buffer requested in a previous frame.
+         */
+        void ReadTextureStreamingFeedback(Globals& d3d, Resources& resources, const Scenes::Scene& scene)
+        {
+            TextureStreaming& streaming = resources.textureStreaming;
+
+            UINT feedbackFrame = streaming.feedbackReadbackFrame[d3d.frameIndex];
+            if (feedbackFrame == 0) return;
+
+            // The frame that copied the feedback to this readback buffer has completed on the GPU
+            UINT8* pData = nullptr;
+            D3D12_RANGE readRange = { 0, streaming.feedbackSize };
+            if (FAILED(streaming.feedbackReadback[d3d.frameIndex]->Map(0, &readRange, reinterpret_cast<void**>(&pData)))) return;
+
+            const UINT* feedback = reinterpret_cast<const UINT*>(pData) + SCENE_TEXTURES_INDEX;
+            for (UINT textureIndex = 0; textureIndex < static_cast<UINT>(streaming.textures.size()); textureIndex++)
+            {
+                StreamedTexture& streamed = streaming.textures[textureIndex];
+                if (!streamed.streamed || feedback[textureIndex] == 0) continue;
+
+                // Convert the requested resolution (log2 texels along the largest axis) to a mip level
+                const Textures::Texture& texture = scene.textures[textureIndex];
+                UINT log2Size = 0;
+                while (((std::max)(texture.width, texture.height) >> (log2Size + 1)) > 0) log2Size++;
+
+                UINT requestedLog2 = feedback[textureIndex] - 1;
+                UINT requestedMip = (requestedLog2 >= log2Size) ? 0 : (log2Size - requestedLog2);
+
+                streamed.requestedMip = (std::min)(requestedMip, streamed.tailMip);
+                streamed.requestedFrame = feedbackFrame;
+            }
+
+            D3D12_RANGE writeRange = {};
+            streaming.feedbackReadback[d3d.frameIndex]->Unmap(0, &writeRange);
+        }
+
+        /**
+         * Schedule copies for the requested mip levels of streamed textures on the copy queue.
+         * Evicts mip levels of the least recently requested textures when the requests exceed the memory budget.
+         */
+        void StreamTextures(Globals& d3d, Resources& resources, const Scenes::Scene& scene)
+        {
+            TextureStreaming& streaming = resources.textureStreaming;
+            if (!streaming.swaps.empty()) return; // One batch in flight at a time
+
+            const UINT maxBatchSize = 16;     // Max textures streamed in (or evicted) per batch
+            const UINT requestFrames = 120;   // Requests older than this many frames no longer keep mip levels resident
+
+            // Textures with requested mip levels that are not resident, the most missing mip levels first
+            // Textures with resident mip levels finer than requested, the least recently requested first
+            std::vector<UINT>& requests = streaming.requests;
+            std::vector<UINT>& evictions = streaming.evictions;
+            requests.clear();
+            evictions.clear();
+            for (UINT textureIndex = 0; textureIndex < static_cast<UINT>(streaming.textures.size()); textureIndex++)
+            {
+                StreamedTexture& streamed = streaming.textures[textureIndex];
+                if (!streamed.streamed) continue;
+
+                bool recent = (streamed.requestedFrame > 0) && ((d3d.frameNumber - streamed.requestedFrame) <= requestFrames);
+                UINT wantedMip = recent ? streamed.requestedMip : streamed.tailMip;
+                if (wantedMip < streamed.residentMip) requests.push_back(textureIndex);
+                else if (wantedMip > streamed.residentMip) evictions.push_back(textureIndex);
+            }
+            if (requests.empty()) return;
+
+            std::sort(requests.begin(), requests.end(), [&](UINT a, UINT b)
+            {
+                const StreamedTexture& ta = streaming.textures[a];
+                const StreamedTexture& tb = streaming.textures[b];
+                return (ta.residentMip - ta.requestedMip) > (tb.residentMip - tb.requestedMip);
+            });
+            std::sort(evictions.begin(), evictions.end(), [&](UINT a, UINT b)
+            {
+                return streaming.textures[a].requestedFrame < streaming.textures[b].requestedFrame;
+            });
+
+            // Build the batch, sized by the final resource sizes (old and new resources coexist briefly during the copies)
+            UINT64 residentBytes = streaming.residentBytes;
+            UINT64 uploadSize = 0;
+            size_t evictionIndex = 0;
+            for (UINT textureIndex : requests)
+            {
+                if (streaming.swaps.size() >= maxBatchSize) break;
+
+                const Textures::Texture& texture = scene.textures[textureIndex];
+                StreamedTexture& streamed = streaming.textures[textureIndex];
+
+                StreamedTextureSwap swap = {};
+                swap.textureIndex = textureIndex;
+                swap.topMip = GetStreamableMip(texture, streamed.requestedMip);
+                D3D12_RESOURCE_DESC desc = GetStreamedTextureDesc(texture, swap.topMip);
+                swap.bytes = d3d.device->GetResourceAllocationInfo(0, 1, &desc).SizeInBytes;
+
+                // Evict mip levels of the least recently requested textures until the request fits the budget
+                while ((residentBytes + swap.bytes - streamed.residentBytes) > streaming.budget && evictionIndex < evictions.size())
+                {
+                    UINT evictedIndex = evictions[evictionIndex++];
+                    const Textures::Texture& evictedTexture = scene.textures[evictedIndex];
+                    StreamedTexture& evicted = streaming.textures[evictedIndex];
+
+                    bool recent = (evicted.requestedFrame > 0) && ((d3d.frameNumber - evicted.requestedFrame) <= requestFrames);
+                    StreamedTextureSwap eviction = {};
+                    eviction.textureIndex = evictedIndex;
+                    eviction.topMip = GetStreamableMip(evictedTexture, recent ? evicted.requestedMip : evicted.tailMip);
+                    if (eviction.topMip <= evicted.residentMip) continue;
+
+                    D3D12_RESOURCE_DESC evictionDesc = GetStreamedTextureDesc(evictedTexture, eviction.topMip);
+                    eviction.bytes = d3d.device->GetResourceAllocationInfo(0, 1, &evictionDesc).SizeInBytes;
+
+                    residentBytes = residentBytes - evicted.residentBytes + eviction.bytes;
+                    uploadSize += GetStreamedTextureUploadSize(d3d, evictedTexture, eviction.topMip);
+                    streaming.swaps.push_back(eviction);
+                }
+
+                // Over budget with every other texture evicted (to its requested mip levels)
+                if ((residentBytes + swap.bytes - streamed.residentBytes) > streaming.budget) break;
+
+                residentBytes = residentBytes - streamed.residentBytes + swap.bytes;
+                uploadSize += GetStreamedTextureUploadSize(d3d, texture, swap.topMip);
+                streaming.swaps.push_back(swap);
+            }
+            if (streaming.swaps.empty()) return;
+
+            // Create the upload buffer for the batch
+            BufferDesc desc = { uploadSize, 1, EHeapType::UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE };
+            bool result = CreateBuffer(d3d, desc, &streaming.upload);
+        #ifdef GFX_NAME_OBJECTS
+            if (result) streaming.upload->SetName(L"Texture Streaming Upload Buffer");
+        #endif
+
+            // Write the mip levels to the upload buffer and schedule the copies on the copy queue
+            UINT8* pData = nullptr;
+            D3D12_RANGE range = { 0, 0 };
+            result = result && SUCCEEDED(streaming.upload->Map(0, &range, reinterpret_cast<void**>(&pData)));
+            result = result && SUCCEEDED(d3d.copyCmdAlloc->Reset());
+            result = result && SUCCEEDED(d3d.copyCmdList->Reset(d3d.copyCmdAlloc, nullptr));
+
+            UINT64 uploadOffset = 0;
+            for (size_t swapIndex = 0; result && swapIndex < streaming.swaps.size(); swapIndex++)
+            {
+                StreamedTextureSwap& swap = streaming.swaps[swapIndex];
+                result = UploadStreamedTexture(
+                    d3d,
+                    scene.textures[swap.textureIndex],
+                    swap.topMip,
+                    D3D12_RESOURCE_STATE_COMMON,
+                    d3d.copyCmdList,
+                    streaming.upload,
+                    pData,
+                    uploadOffset,
+                    &swap.resource);
+            }
+            if (pData) streaming.upload->Unmap(0, &range);
+            result = result && SUCCEEDED(d3d.copyCmdList->Close());
+
+            if (!result)
+            {
+                // Drop the batch, the requests are scheduled again on a later frame
+                for (StreamedTextureSwap& swap : streaming.swaps) SAFE_RELEASE(swap.resource);
+                streaming.swaps.clear();
+                SAFE_RELEASE(streaming.upload);
+                return;
+            }
+
+            ID3D12CommandList* pCopyList = { d3d.copyCmdList };
+            d3d.copyQueue->ExecuteCommandLists(1, &pCopyList);
+            d3d.copyQueue->Signal(d3d.copyFence, ++d3d.copyFenceValue);
+            streaming.fenceValue = d3d.copyFenceValue;
+        }
+
+        /**
+         * Stream scene texture mip levels: swap in completed copies, read back the shader feedback,
+         * schedule new copies, and copy (then clear) the feedback of the previous frame.
+         */
+        void UpdateTextureStreaming(Globals& d3d, Resources& resources, const Scenes::Scene& scene)
+        {
+            TextureStreaming& streaming = resources.textureStreaming;
+            if (!streaming.enabled || streaming.feedback == nullptr) return;
+
+            SwapStreamedTextures(d3d, resources, scene);
+            ReadTextureStreamingFeedback(d3d, resources, scene);
+            StreamTextures(d3d, resources, scene);
+
+            // Transition the feedback buffer to a copy source
+            D3D12_RESOURCE_BARRIER barrier = {};
+            barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+            barrier.Transition.pResource = streaming.feedback;
+            barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+            barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
+            barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+
+            GetCmdList(d3d)->ResourceBarrier(1, &barrier);
+
+            // Copy the previous frame's feedback to this frame's readback buffer
+            GetCmdList(d3d)->CopyBufferRegion(streaming.feedbackReadback[d3d.frameIndex], 0, streaming.feedback, 0, streaming.feedbackSize);
+            streaming.feedbackReadbackFrame[d3d.frameIndex] = d3d.frameNumber;
+
+            // Clear the feedback buffer
+            barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE;
+            barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
+            GetCmdList(d3d)->ResourceBarrier(1, &barrier);
+
+            GetCmdList(d3d)->CopyBufferRegion(streaming.feedback, 0, streaming.feedbackClear, 0, streaming.feedbackSize);
+
+            // Transition the feedback buffer back to a UAV for this frame's texture samples
+            barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+            barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+            GetCmdList(d3d)->ResourceBarrier(1, &barrier);
         }
 
         /**
@@ -2597,53 +4553,87 @@ namespace Graphics
          */
         void Update(Globals& d3d, Resources& resources, const Configs::Config& config, Scenes::Scene& scene)
         {
+            // Picked up by the next path tracing shader reload (config pathTrace.reload)
+            d3d.PTRadianceCacheBounce = config.pathTrace.radianceCacheBounce;
+
             // Update application constants
             resources.constants.app.frameNumber = d3d.frameNumber;
             resources.constants.app.skyRadiance = { config.scene.skyColor.x * config.scene.skyIntensity, config.scene.skyColor.y  * config.scene.skyIntensity, config.scene.skyColor.z  * config.scene.skyIntensity };
 
             // Update the camera constant buffer
             Scenes::Camera& camera = scene.GetActiveCamera();
-            camera.data.resolution.x = (float)d3d.width;
-            camera.data.resolution.y = (float)d3d.height;
-            camera.data.aspect = camera.data.resolution.x / camera.data.resolution.y;
-            memcpy(resources.cameraCBPtr, camera.GetGPUData(), camera.GetGPUDataSize());
+            // The resolution of the screen-space passes (smaller than the window with dynamic resolution)
+            camera.data.resolution.x = (float)d3d.renderWidth;
+            camera.data.resolution.y = (float)d3d.renderHeight;
+            camera.data.aspect = (float)d3d.width / (float)d3d.height;
+
+            // Add the previous frame's camera (the current camera on the first frame)
+            Graphics::Camera& cameraData = resources.cameraData;
+            const Graphics::Camera& previousCamera = (resources.previousCamera.resolution.x > 0.f) ? resources.previousCamera : camera.data;
+            cameraData = camera.data;
+            cameraData.prevPosition = previousCamera.position;
+            cameraData.prevAspect = previousCamera.aspect;
+            cameraData.prevUp = previousCamera.up;
+            cameraData.prevTanHalfFovY = previousCamera.tanHalfFovY;
+            cameraData.prevRight = previousCamera.right;
+            cameraData.prevForward = previousCamera.forward;
+            cameraData.prevResolution = previousCamera.resolution;
+            resources.previousCamera = camera.data;
+
+            // Scene data is written to this frame's upload ring allocations (frames in flight keep reading their own)
+            // and copied to the device buffers together, see RecordBufferCopies()
+            BufferCopies copies;
+
+            // Copy the camera to the upload ring
+            BufferCopy cameraCopy = { resources.cameraCB, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER };
+            cameraCopy.size = camera.GetGPUDataSize();
+            resources.cameraUploadPtr = nullptr;
+            if (AllocateUpload(d3d, cameraCopy.size, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, cameraCopy.upload))
+            {
+                memcpy(cameraCopy.upload.ptr, &cameraData, camera.GetGPUDataSize());
+                copies.push_back(cameraCopy);
+                resources.cameraUploadPtr = cameraCopy.upload.ptr;
+            }
+
+            // Update the TLAS instances that have been modified
+            bool rebuild = false;
+            bool updateTLAS = UpdateSceneTLASInstances(d3d, resources, scene, copies, rebuild);
 
-            // Update the lights buffer for lights that have been modified
+            // Update the range of lights that have been modified.
+            // Moved instances may cast different shadows from every light, so they change every light (see Light::changedFrame).
+            UINT firstDirtyLight = static_cast<UINT>(scene.lights.size());
             UINT lastDirtyLight = 0;
             for (UINT lightIndex = 0; lightIndex < static_cast<UINT>(scene.lights.size()); lightIndex++)
             {
                 Scenes::Light& light = scene.lights[lightIndex];
-                if (light.dirty)
+                if (light.dirty || updateTLAS)
                 {
-                    UINT offset = lightIndex * Scenes::Light::GetGPUDataSize();
-                    memcpy(resources.lightsSTBPtr + offset, light.GetGPUData(), Scenes::Light::GetGPUDataSize());
                     light.dirty = false;
+                    light.data.changedFrame = d3d.frameNumber;
+                    firstDirtyLight = (std::min)(firstDirtyLight, lightIndex);
                     lastDirtyLight = lightIndex + 1;
                 }
             }
 
-            if (lastDirtyLight > 0)
+            BufferCopy lightsCopy = { resources.lightsSTB, D3D12_RESOURCE_STATE_GENERIC_READ };
+            lightsCopy.offset = Scenes::Light::GetGPUDataSize() * firstDirtyLight;
+            lightsCopy.size = Scenes::Light::GetGPUDataSize() * (lastDirtyLight - firstDirtyLight);
+            if (lastDirtyLight > 0 && AllocateUpload(d3d, lightsCopy.size, D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT, lightsCopy.upload))
             {
-                // Transition the lights device buffer to a copy destination
-                D3D12_RESOURCE_BARRIER barrier = {};
-                barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-                barrier.Transition.pResource = resources.lightsSTB;
-                barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_GENERIC_READ;
-                barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
-                barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+                for (UINT lightIndex = firstDirtyLight; lightIndex < lastDirtyLight; lightIndex++)
+                {
+                    memcpy(lightsCopy.upload.ptr + ((lightIndex - firstDirtyLight) * Scenes::Light::GetGPUDataSize()), scene.lights[lightIndex].GetGPUData(), Scenes::Light::GetGPUDataSize());
+                }
+                copies.push_back(lightsCopy);
+            }
 
-                d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+            RecordBufferCopies(d3d, copies);
 
-                // Schedule a copy of the upload buffer to the device buffer
-                UINT size = Scenes::Light::GetGPUDataSize() * lastDirtyLight;
-                d3d.cmdList[d3d.frameIndex]->CopyBufferRegion(resources.lightsSTB, 0, resources.lightsSTBUpload, 0, size);
+            // Refit the TLAS, or rebuild it in place
+            if (updateTLAS) BuildTLAS(d3d, resources, static_cast<UINT>(scene.instances.size()), !rebuild);
 
-                // Transition the lights device buffer to generic read after the copy is complete
-                barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
-                barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_GENERIC_READ;
-
-                d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
-            }
+            // Stream the requested scene texture mip levels
+            UpdateTextureStreaming(d3d, resources, scene);
         }
 
         /**
@@ -2658,6 +4648,7 @@ namespace Graphics
             d3d.viewport.Height = static_cast<float>(d3d.height);
             d3d.scissor.right = d3d.width;
             d3d.scissor.bottom = d3d.height;
+            SetResolutionScale(d3d, d3d.resolutionScale);
 
             // Wait for GPU idle
             WaitForGPU(d3d);
@@ -2672,6 +4663,9 @@ namespace Graphics
             SAFE_RELEASE(resources.rt.GBufferB);
             SAFE_RELEASE(resources.rt.GBufferC);
             SAFE_RELEASE(resources.rt.GBufferD);
+            SAFE_RELEASE(resources.rt.GBufferVisibility);
+            SAFE_RELEASE(resources.rt.GBufferTiles);
+            SAFE_RELEASE(resources.rt.GBufferTileArgs);
 
             // Resize the swap chain
             DXGI_SWAP_CHAIN_DESC desc = {};
@@ -2695,6 +4689,19 @@ namespace Graphics
             return true;
         }
 
+        // The command list the calling thread records to, set by RecordPasses(). Unset, the frame's command list.
+        static thread_local ID3D12GraphicsCommandList5* recordingCmdList = nullptr;
+
+        /**
+         * Get the command list the calling thread records to: a pass's list inside RecordPasses(), the list of the
+         * work after the passes once RecordPasses() returns, otherwise the current frame's command list.
+         */
+        ID3D12GraphicsCommandList5* GetCmdList(Globals& d3d)
+        {
+            if (recordingCmdList) return recordingCmdList;
+            return d3d.cmdList[d3d.frameIndex];
+        }
+
         /**
          * Reset the current frame's command list.
          */
@@ -2706,20 +4713,61 @@ namespace Graphics
             // Reset the command list for the current frame
             D3DCHECK(d3d.cmdList[d3d.frameIndex]->Reset(d3d.cmdAlloc[d3d.frameIndex], nullptr));
 
-            return true;
+            recordingCmdList = nullptr;
+            d3d.frameCmdLists.clear();
+
+            // Copy the resources captured since the last frame, ahead of the frame's work
+            return RecordResourceCaptures(d3d);
+        }
+
+        /**
+         * Rewrite this frame's camera constants with the active camera (late latching).
+         * The copy to the camera constant buffer recorded by Update() reads the upload ring when the GPU executes it.
+         */
+        void LatchCamera(Resources& resources, const Scenes::Scene& scene)
+        {
+            if (resources.cameraUploadPtr == nullptr) return;
+
+            // Keep the previous frame's camera added by Update()
+            const Graphics::Camera& camera = scene.cameras[scene.activeCamera].data;
+            Graphics::Camera& cameraData = resources.cameraData;
+            cameraData.position = camera.position;
+            cameraData.up = camera.up;
+            cameraData.right = camera.right;
+            cameraData.forward = camera.forward;
+            resources.previousCamera = camera;
+
+            memcpy(resources.cameraUploadPtr, &cameraData, Scenes::Camera::GetGPUDataSize());
         }
 
         /**
          * Submit the current frame's command list.
+         * With passes recorded by RecordPasses(), the frame's lists are submitted in recording order.
          */
         bool SubmitCmdList(Globals& d3d)
         {
             // Close the command list
-            D3DCHECK(d3d.cmdList[d3d.frameIndex]->Close());
+            ID3D12GraphicsCommandList5* cmdList = GetCmdList(d3d);
+            D3DCHECK(cmdList->Close());
+            recordingCmdList = nullptr;
 
-            // Submit the command list
-            ID3D12CommandList* pGraphicsList = { d3d.cmdList[d3d.frameIndex] };
-            d3d.cmdQueue->ExecuteCommandLists(1, &pGraphicsList);
+            // Submit the command lists, behind this frame's async compute work when a pass consumes it
+            d3d.frameCmdLists.push_back(cmdList);
+            if (d3d.computeWaitInFrame)
+            {
+                D3DCHECK(d3d.cmdQueue->Wait(d3d.computeToGraphicsFence, d3d.computeToGraphicsFenceValue));
+                d3d.computeWaitInFrame = false;
+            }
+            d3d.cmdQueue->ExecuteCommandLists(static_cast<UINT>(d3d.frameCmdLists.size()), d3d.frameCmdLists.data());
+            d3d.frameCmdLists.clear();
+            if (!SignalUploads(d3d)) return false;
+            if (!SignalResourceCaptures(d3d)) return false;
+
+            // Hold the next frame's graphics work (and this frame's fence) until the async compute work is done
+            if (d3d.computeToGraphicsFenceValue > 0)
+            {
+                D3DCHECK(d3d.cmdQueue->Wait(d3d.computeToGraphicsFence, d3d.computeToGraphicsFenceValue));
+            }
 
             // Schedule a fence update in the queue (from the GPU)
             D3DCHECK(d3d.cmdQueue->Signal(d3d.fence[d3d.frameIndex], 1));
@@ -2727,6 +4775,119 @@ namespace Graphics
             return true;
         }
 
+        /**
+         * Record the passes on their own command lists, in parallel on the pass workers, for submission in order.
+         * The work recorded so far is closed ahead of the passes, and the work recorded after them continues on a list of its own.
+         * The passes record through GetCmdList() and set their descriptor heaps, root signatures, and render targets.
+         */
+        bool RecordPasses(Globals& d3d, const std::vector<std::function<void()>>& passes)
+        {
+            // Record the passes in order on the frame's command list when parallel recording is off. DDGI with async
+            // compute submits the frame's command list in the middle of its pass (see SubmitComputeCmdList).
+            if (!d3d.parallelRecording || d3d.DDGIAsyncCompute || passes.size() > MAX_PASS_CMD_LISTS)
+            {
+                for (const std::function<void()>& pass : passes) pass();
+                return true;
+            }
+
+            // Close the work recorded so far (constant uploads, TLAS build), it runs first
+            ID3D12GraphicsCommandList5* cmdList = GetCmdList(d3d);
+            D3DCHECK(cmdList->Close());
+            d3d.frameCmdLists.push_back(cmdList);
+
+            // Reset the pass command lists
+            UINT numPasses = static_cast<UINT>(passes.size());
+            for (UINT passIndex = 0; passIndex <= numPasses; passIndex++)
+            {
+                D3DCHECK(d3d.passCmdAlloc[d3d.frameIndex][passIndex]->Reset());
+                D3DCHECK(d3d.passCmdList[d3d.frameIndex][passIndex]->Reset(d3d.passCmdAlloc[d3d.frameIndex][passIndex], nullptr));
+            }
+
+            // Record each pass on its own command list (the jobs are built on first use, not every frame)
+            if (!d3d.passJobs[0])
+            {
+                for (UINT passIndex = 0; passIndex < MAX_PASS_CMD_LISTS; passIndex++)
+                {
+                    d3d.passJobs[passIndex] = [&d3d, passIndex]()
+                    {
+                        recordingCmdList = d3d.passCmdList[d3d.frameIndex][passIndex];
+                        (*d3d.recordingPasses)[passIndex]();
+                        recordingCmdList = nullptr;
+                    };
+                }
+            }
+            d3d.recordingPasses = &passes;
+            d3d.passWorkers.Run(d3d.passJobs, numPasses);
+            d3d.recordingPasses = nullptr;
+
+            // Close the pass command lists, in submission order
+            for (UINT passIndex = 0; passIndex < numPasses; passIndex++)
+            {
+                D3DCHECK(d3d.passCmdList[d3d.frameIndex][passIndex]->Close());
+                d3d.frameCmdLists.push_back(d3d.passCmdList[d3d.frameIndex][passIndex]);
+            }
+
+            // Continue recording the frame on the list after the passes
+            recordingCmdList = d3d.passCmdList[d3d.frameIndex][numPasses];
+            return true;
+        }
+
+        /**
+         * Make the writes of everything recorded so far visible to the work recorded after it (a UAV barrier on all resources).
+         */
+        void GlobalBarrier(Globals& d3d)
+        {
+            D3D12_RESOURCE_BARRIER barrier = {};
+            barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+            barrier.UAV.pResource = nullptr;
+            GetCmdList(d3d)->ResourceBarrier(1, &barrier);
+        }
+
+        /**
+         * Hold the graphics work recorded after the last SubmitComputeCmdList() until the compute work submitted so far is done.
+         * The queue waits ahead of the frame's remaining command lists, in SubmitCmdList().
+         */
+        void WaitForAsyncCompute(Globals& d3d)
+        {
+            if (d3d.computeToGraphicsFenceValue > 0) d3d.computeWaitInFrame = true;
+        }
+
+        /**
+         * Reset the current frame's compute command list.
+         */
+        bool ResetComputeCmdList(Globals& d3d)
+        {
+            // The frame fence covers the compute work of the frame that last used this allocator, see SubmitCmdList()
+            D3DCHECK(d3d.computeCmdAlloc[d3d.frameIndex]->Reset());
+            D3DCHECK(d3d.computeCmdList[d3d.frameIndex]->Reset(d3d.computeCmdAlloc[d3d.frameIndex], nullptr));
+            return true;
+        }
+
+        /**
+         * Submit the graphics work recorded so far, then the current frame's compute command list behind it.
+         * Recording continues on the (reset) graphics command list, which runs alongside the compute work.
+         */
+        bool SubmitComputeCmdList(Globals& d3d)
+        {
+            // Submit the graphics work the compute work depends on
+            D3DCHECK(d3d.cmdList[d3d.frameIndex]->Close());
+            ID3D12CommandList* pGraphicsList = { d3d.cmdList[d3d.frameIndex] };
+            d3d.cmdQueue->ExecuteCommandLists(1, &pGraphicsList);
+            if (!SignalUploads(d3d)) return false;
+            D3DCHECK(d3d.cmdQueue->Signal(d3d.graphicsToComputeFence, ++d3d.graphicsToComputeFenceValue));
+
+            // Submit the compute work once the graphics work is done
+            D3DCHECK(d3d.computeCmdList[d3d.frameIndex]->Close());
+            D3DCHECK(d3d.computeQueue->Wait(d3d.graphicsToComputeFence, d3d.graphicsToComputeFenceValue));
+            ID3D12CommandList* pComputeList = { d3d.computeCmdList[d3d.frameIndex] };
+            d3d.computeQueue->ExecuteCommandLists(1, &pComputeList);
+            D3DCHECK(d3d.computeQueue->Signal(d3d.computeToGraphicsFence, ++d3d.computeToGraphicsFenceValue));
+
+            // Continue recording the frame, the allocator keeps the submitted commands alive
+            D3DCHECK(d3d.cmdList[d3d.frameIndex]->Reset(d3d.cmdAlloc[d3d.frameIndex], nullptr));
+            return true;
+        }
+
         /**
          * Swap the back buffers.
          */
@@ -2740,16 +4901,20 @@ namespace Graphics
         }
 
         /**
-         * Wait for the previous frame's executing GPU work to complete.
+         * Wait for the GPU to complete the frame that last used the next frame's resources (MAX_FRAMES_IN_FLIGHT frames ago).
+         * The frames submitted since keep executing, the CPU only stalls when it gets MAX_FRAMES_IN_FLIGHT frames ahead.
          */
         bool WaitForPrevGPUFrame(Globals& d3d)
         {
-            // Wait (on the CPU) until the previous frame's fence has been processed on the GPU
-            D3DCHECK(d3d.fence[d3d.frameIndex]->SetEventOnCompletion(1, d3d.fenceEvent[d3d.frameIndex]));
-            WaitForSingleObjectEx(d3d.fenceEvent[d3d.frameIndex], INFINITE, FALSE);
+            // Present() has advanced the swap chain, its back buffer index selects the next frame's resources
+            UINT nextFrameIndex = d3d.swapChain->GetCurrentBackBufferIndex();
+
+            // Wait (on the CPU) until the fence of the frame that last used them has been processed on the GPU
+            D3DCHECK(d3d.fence[nextFrameIndex]->SetEventOnCompletion(1, d3d.fenceEvent[nextFrameIndex]));
+            WaitForSingleObjectEx(d3d.fenceEvent[nextFrameIndex], INFINITE, FALSE);
 
             // Reset the fence
-            d3d.fence[d3d.frameIndex]->Signal(0);
+            d3d.fence[nextFrameIndex]->Signal(0);
 
             return true;
         }
@@ -2779,6 +4944,9 @@ namespace Graphics
         {
             // Set the frame index for the next frame
             d3d.frameIndex = d3d.swapChain->GetCurrentBackBufferIndex();
+
+            // Release the previous frame's transient CPU data
+            d3d.frameArena.Reset();
             return true;
         }
 
@@ -2788,50 +4956,92 @@ namespace Graphics
     #ifdef GFX_PERF_INSTRUMENTATION
         void BeginFrame(Globals& d3d, GlobalResources& resources, Instrumentation::Performance& performance)
         {
-            d3d.cmdList[d3d.frameIndex]->EndQuery(resources.timestampHeap, D3D12_QUERY_TYPE_TIMESTAMP, performance.gpuTimes[0]->GetGPUQueryBeginIndex());
+            GetCmdList(d3d)->EndQuery(resources.timestampHeap, D3D12_QUERY_TYPE_TIMESTAMP, performance.gpuTimes[0]->GetGPUQueryBeginIndex());
         }
 
         void EndFrame(Globals& d3d, GlobalResources& resources, Instrumentation::Performance& performance)
         {
-            d3d.cmdList[d3d.frameIndex]->EndQuery(resources.timestampHeap, D3D12_QUERY_TYPE_TIMESTAMP, performance.gpuTimes[0]->GetGPUQueryEndIndex());
+            GetCmdList(d3d)->EndQuery(resources.timestampHeap, D3D12_QUERY_TYPE_TIMESTAMP, performance.gpuTimes[0]->GetGPUQueryEndIndex());
         }
 
+        /**
+         * Resolve the frame's timestamp queries to the frame's readback buffer.
+         * The GPU stats' query indices are kept with the buffer and reset for the next frame.
+         */
         void ResolveTimestamps(Globals& d3d, GlobalResources& resources, Instrumentation::Performance& performance)
         {
-            d3d.cmdList[d3d.frameIndex]->ResolveQueryData(resources.timestampHeap, D3D12_QUERY_TYPE_TIMESTAMP, 0, performance.GetNumActiveGPUQueries(), resources.timestamps, 0);
+            TimestampFrame& frame = resources.timestampFrames[d3d.frameIndex];
+            frame.numQueries = performance.GetNumActiveGPUQueries();
+            frame.traceFrame = performance.trace.frame;
+            frame.stats.clear();
+
+            for (Instrumentation::Stat* s : performance.gpuTimes)
+            {
+                // Skip the stat if it wasn't active this frame
+                if (s->gpuQueryStartIndex == -1) continue;
+
+                frame.stats.emplace_back(s, s->gpuQueryStartIndex);
+                s->ResetGPUQueryIndices();
+            }
+            Instrumentation::Stat::ResetGPUQueryCount();
+
+            // Resolve only the queries written this frame
+            if (frame.numQueries == 0) return;
+            GetCmdList(d3d)->ResolveQueryData(resources.timestampHeap, D3D12_QUERY_TYPE_TIMESTAMP, 0, frame.numQueries, resources.timestamps[d3d.frameIndex], 0);
         }
 
+        /**
+         * Update the GPU stats from the timestamps resolved by the last frame that used the frame's resources.
+         * Its fence has completed (see WaitForPrevGPUFrame), so reading them back never waits on the GPU.
+         * The stats trail the CPU by MAX_FRAMES_IN_FLIGHT frames.
+         */
         bool UpdateTimestamps(Globals& d3d, GlobalResources& resources, Instrumentation::Performance& performance)
         {
-            std::vector<UINT64> queries;
-            queries.resize(performance.GetNumActiveGPUQueries());
+            TimestampFrame& frame = resources.timestampFrames[d3d.frameIndex];
+            if (frame.numQueries == 0) return true;
+
+            UINT64* queries = d3d.frameArena.Allocate<UINT64>(frame.numQueries);
 
             // Copy the timestamps from the read-back buffer
             UINT64* pData = nullptr;
-            D3D12_RANGE readRange = {};
-            D3DCHECK(resources.timestamps->Map(0, &readRange, reinterpret_cast<void**>(&pData)));
-            memcpy(queries.data(), pData, sizeof(UINT64) * performance.GetNumActiveGPUQueries());
-            resources.timestamps->Unmap(0, nullptr);
+            D3D12_RANGE readRange = { 0, sizeof(UINT64) * frame.numQueries };
+            D3D12_RANGE writeRange = {};
+            D3DCHECK(resources.timestamps[d3d.frameIndex]->Map(0, &readRange, reinterpret_cast<void**>(&pData)));
+            memcpy(queries, pData, sizeof(UINT64) * frame.numQueries);
+            resources.timestamps[d3d.frameIndex]->Unmap(0, &writeRange);
+            frame.numQueries = 0;
+
+            // Align the GPU timestamps to the CPU clock for the trace capture
+            Instrumentation::Trace& trace = performance.trace;
+            UINT64 gpuCalibration = 0, cpuCalibration = 0;
+            double gpuToCpuTicks = 0;
+            if (trace.capturing)
+            {
+                D3DCHECK(d3d.cmdQueue->GetClockCalibration(&gpuCalibration, &cpuCalibration));
+                gpuToCpuTicks = static_cast<double>(Instrumentation::GetPerfCounterFrequency()) / static_cast<double>(resources.timestampFrequency);
+            }
 
-            // Update the GPU performance stats for the active GPU timestamp queries
+            // Update the GPU performance stats that were active in the frame
             UINT64 elapsedTicks = 0;
-            for (UINT statIndex = 0; statIndex < static_cast<UINT>(performance.gpuTimes.size()); statIndex++)
+            for (const std::pair<Instrumentation::Stat*, INT32>& entry : frame.stats)
             {
-                // Get the stat
-                Instrumentation::Stat*& s = performance.gpuTimes[statIndex];
-
-                // Skip the stat if it wasn't active this frame
-                if(s->gpuQueryStartIndex == -1) continue;
+                Instrumentation::Stat* s = entry.first;
+                UINT64 begin = queries[entry.second];
+                UINT64 end = queries[entry.second + 1];
 
                 // Compute the elapsed GPU time in milliseconds
-                elapsedTicks = queries[s->gpuQueryEndIndex] - queries[s->gpuQueryStartIndex];
+                elapsedTicks = end - begin;
                 s->elapsed = (1000 * static_cast<double>(elapsedTicks)) / static_cast<double>(resources.timestampFrequency);
                 Instrumentation::Resolve(s);
 
-                // Reset the GPU query indices for a new frame
-                s->ResetGPUQueryIndices();
+                // Record the timestamps in the trace frame they were resolved in
+                if (trace.capturing)
+                {
+                    INT64 traceBegin = static_cast<INT64>(cpuCalibration) + static_cast<INT64>(static_cast<double>(static_cast<INT64>(begin - gpuCalibration)) * gpuToCpuTicks);
+                    INT64 traceEnd = traceBegin + static_cast<INT64>(static_cast<double>(elapsedTicks) * gpuToCpuTicks);
+                    trace.Record(s, traceBegin, traceEnd, frame.traceFrame, Instrumentation::ETraceTrack::GPU_GRAPHICS);
+                }
             }
-            Instrumentation::Stat::ResetGPUQueryCount();
 
             return true;
         }
@@ -2842,6 +5052,13 @@ namespace Graphics
          */
         void Cleanup(Globals& d3d, GlobalResources& resources)
         {
+            // Wait for the texture streaming copies in flight
+            if (d3d.copyFence && d3d.copyFence->GetCompletedValue() < d3d.copyFenceValue)
+            {
+                d3d.copyFence->SetEventOnCompletion(d3d.copyFenceValue, d3d.immediateFenceEvent);
+                WaitForSingleObjectEx(d3d.immediateFenceEvent, INFINITE, FALSE);
+            }
+
             Cleanup(resources);
             Cleanup(d3d);
         }
@@ -2887,6 +5104,14 @@ namespace Graphics
         Graphics::D3D12::Update(gfx, gfxResources, config, scene);
     }
 
+    /**
+     * Rewrite the current frame's camera constants with the latest camera, just before submitting the frame.
+     */
+    void LatchCamera(Globals& gfx, GlobalResources& gfxResources, const Scenes::Scene& scene)
+    {
+        Graphics::D3D12::LatchCamera(gfxResources, scene);
+    }
+
     /**
      * Resize the swapchain.
      */
@@ -2908,6 +5133,22 @@ namespace Graphics
         return Graphics::D3D12::ToggleFullscreen(gfx);
     }
 
+    /**
+     * Set the resolution scale of DDGI mode's screen-space passes.
+     */
+    void SetResolutionScale(Globals& gfx, float scale)
+    {
+        Graphics::D3D12::SetResolutionScale(gfx, scale);
+    }
+
+    /**
+     * Get the video memory budget of the process on the device and its current usage, in bytes.
+     */
+    bool GetVideoMemoryInfo(Globals& gfx, uint64_t& budget, uint64_t& usage)
+    {
+        return Graphics::D3D12::GetVideoMemoryInfo(gfx, budget, usage);
+    }
+
     /**
      * Reset the current frame's command list.
      */
@@ -2924,6 +5165,30 @@ namespace Graphics
         return Graphics::D3D12::SubmitCmdList(gfx);
     }
 
+    /**
+     * Record the passes on their own command lists (in parallel), submitted in order by SubmitCmdList().
+     */
+    bool RecordPasses(Globals& gfx, const std::vector<std::function<void()>>& passes)
+    {
+        return Graphics::D3D12::RecordPasses(gfx, passes);
+    }
+
+    /**
+     * Record a barrier between all the work recorded so far and the work recorded after it.
+     */
+    void GlobalBarrier(Globals& gfx)
+    {
+        Graphics::D3D12::GlobalBarrier(gfx);
+    }
+
+    /**
+     * Make the rest of the frame's graphics work wait on the async compute work submitted so far.
+     */
+    void WaitForAsyncCompute(Globals& gfx)
+    {
+        Graphics::D3D12::WaitForAsyncCompute(gfx);
+    }
+
     /**
      * Present the current frame.
      */
@@ -2941,7 +5206,7 @@ namespace Graphics
     }
 
     /**
-     * Wait for the previous frame's graphics commands to complete on the GPU.
+     * Wait for the GPU to complete the frame that last used the next frame's resources.
      */
     bool WaitForPrevGPUFrame(Globals& gfx)
     {
@@ -0,0 +1,57 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace DynamicResolution
+{
+    // Frames between adjustments, the GPU time of a new scale shows up a few frames later
+    const uint32_t SettleFrames = 8;
+
+    // Weight of the last frame in the filtered GPU time
+    const double FilterWeight = 0.2;
+
+    // Fraction of the frame budget to aim for, the headroom absorbs spikes
+    const double TargetHeadroom = 0.9;
+
+    // Largest change of the scale per adjustment
+    const float MaxStep = 0.05f;
+
+    float Update(Controller& controller, const Configs::Config& config, double gpuFrameTime)
+    {
+        if (!config.app.dynamicResolution || config.app.dynamicResolutionFPS <= 0.f || gpuFrameTime <= 0)
+        {
+            controller = Controller();
+            return 1.f;
+        }
+
+        if (controller.frameTime <= 0) controller.frameTime = gpuFrameTime;
+        else controller.frameTime += (gpuFrameTime - controller.frameTime) * FilterWeight;
+
+        if (controller.settleFrames > 0)
+        {
+            controller.settleFrames--;
+            return controller.scale;
+        }
+        controller.settleFrames = SettleFrames;
+
+        // The GPU time scales with the pixel count, the square of the scale
+        double target = (1000.0 / config.app.dynamicResolutionFPS) * TargetHeadroom;
+        float scale = controller.scale * static_cast<float>(std::sqrt(target / controller.frameTime));
+        scale = std::max(controller.scale * (1.f - MaxStep), std::min(controller.scale * (1.f + MaxStep), scale));
+
+        float minScale = std::max(0.25f, std::min(1.f, config.app.dynamicResolutionMinScale));
+        controller.scale = std::max(minScale, std::min(1.f, scale));
+        return controller.scale;
+    }
+}
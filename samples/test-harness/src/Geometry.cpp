@@ -10,6 +10,8 @@
 
 #include "Geometry.h"
 
+#include <unordered_map>
+
 //----------------------------------------------------------------------------------------------------------
 // Private Functions
 //----------------------------------------------------------------------------------------------------------
@@ -122,6 +124,80 @@ namespace Geometry
         return indices;
     }
 
+    /**
+     * Convert a position on the unit sphere (right handed, y-up) to a vertex of a sphere with a radius of 0.5 in the coordinate system.
+     * Left handed systems mirror the z-axis, which also flips the triangle winding (see the TRIANGLE_FRONT_COUNTERCLOCKWISE instance flags).
+     */
+    Graphics::Vertex GetSphereVertex(const XMFLOAT3& p)
+    {
+        float x = 0.5f * p.x;
+        float y = 0.5f * p.y;
+        float z = 0.5f * p.z;
+    #if COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT
+        return { { x, y, -z } };
+    #elif COORDINATE_SYSTEM == COORDINATE_SYSTEM_RIGHT
+        return { { x, y, z } };
+    #elif COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT_Z_UP
+        return { { x, z, y } };
+    #elif COORDINATE_SYSTEM == COORDINATE_SYSTEM_RIGHT_Z_UP
+        return { { x, -z, y } };
+    #endif
+    }
+
+    /**
+     * Generate the unit sphere positions and (counter-clockwise) indices of an icosahedron, with each triangle subdivided into four the given number of times.
+     */
+    void GetIcosphere(uint32_t subdivisions, std::vector<XMFLOAT3>& positions, std::vector<uint32_t>& indices)
+    {
+        const float t = (1.f + sqrtf(5.f)) * 0.5f;
+        positions = { { -1.f, t, 0.f }, { 1.f, t, 0.f }, { -1.f, -t, 0.f }, { 1.f, -t, 0.f },
+                      { 0.f, -1.f, t }, { 0.f, 1.f, t }, { 0.f, -1.f, -t }, { 0.f, 1.f, -t },
+                      { t, 0.f, -1.f }, { t, 0.f, 1.f }, { -t, 0.f, -1.f }, { -t, 0.f, 1.f } };
+        indices = { 0, 11, 5,  0, 5, 1,  0, 1, 7,  0, 7, 10,  0, 10, 11,
+                    1, 5, 9,  5, 11, 4,  11, 10, 2,  10, 7, 6,  7, 1, 8,
+                    3, 9, 4,  3, 4, 2,  3, 2, 6,  3, 6, 8,  3, 8, 9,
+                    4, 9, 5,  2, 4, 11,  6, 2, 10,  8, 6, 7,  9, 8, 1 };
+
+        for (XMFLOAT3& p : positions)
+        {
+            XMStoreFloat3(&p, XMVector3Normalize(XMLoadFloat3(&p)));
+        }
+
+        for (uint32_t subdivision = 0; subdivision < subdivisions; subdivision++)
+        {
+            // Split each edge once, the midpoint vertex is shared by the edge's two triangles
+            std::unordered_map<uint64_t, uint32_t> midpoints;
+            auto GetMidpoint = [&](uint32_t a, uint32_t b)
+            {
+                uint64_t key = (static_cast<uint64_t>((std::min)(a, b)) << 32) | (std::max)(a, b);
+                auto it = midpoints.find(key);
+                if (it != midpoints.end()) return it->second;
+
+                XMFLOAT3 midpoint;
+                XMStoreFloat3(&midpoint, XMVector3Normalize(XMVectorAdd(XMLoadFloat3(&positions[a]), XMLoadFloat3(&positions[b]))));
+                positions.push_back(midpoint);
+
+                uint32_t index = static_cast<uint32_t>(positions.size() - 1);
+                midpoints.emplace(key, index);
+                return index;
+            };
+
+            std::vector<uint32_t> subdivided;
+            subdivided.reserve(indices.size() * 4);
+            for (size_t triangle = 0; triangle < indices.size(); triangle += 3)
+            {
+                uint32_t v1 = indices[triangle];
+                uint32_t v2 = indices[triangle + 1];
+                uint32_t v3 = indices[triangle + 2];
+                uint32_t a = GetMidpoint(v1, v2);
+                uint32_t b = GetMidpoint(v2, v3);
+                uint32_t c = GetMidpoint(v3, v1);
+                subdivided.insert(subdivided.end(), { v1, a, c, v2, b, a, v3, c, b, a, b, c });
+            }
+            indices = std::move(subdivided);
+        }
+    }
+
     //----------------------------------------------------------------------------------------------------------
     // Public Functions
     //----------------------------------------------------------------------------------------------------------
@@ -136,4 +212,29 @@ namespace Geometry
         mesh.numIndices = static_cast<int>(primitive.indices.size());
     }
 
+    /**
+     * Add an icosphere with a radius of 0.5 to the mesh, as a new mesh primitive that follows the existing primitives in the vertex and index buffers.
+     * Subdivision 0 is an icosahedron (20 triangles), each subdivision has four times the triangles of the previous one.
+     */
+    void CreateIcosphere(uint32_t subdivisions, Scenes::Mesh& mesh)
+    {
+        std::vector<XMFLOAT3> positions;
+        std::vector<uint32_t> indices;
+        GetIcosphere(subdivisions, positions, indices);
+
+        Scenes::MeshPrimitive& primitive = mesh.primitives.emplace_back();
+        primitive.index = static_cast<int>(mesh.primitives.size() - 1);
+        primitive.vertexByteOffset = mesh.numVertices * sizeof(Graphics::Vertex);
+        primitive.indexByteOffset = mesh.numIndices * sizeof(uint32_t);
+        for (const XMFLOAT3& p : positions)
+        {
+            primitive.vertices.push_back(GetSphereVertex(p));
+        }
+
+        primitive.indices = std::move(indices);
+
+        mesh.numVertices += static_cast<uint32_t>(primitive.vertices.size());
+        mesh.numIndices += static_cast<uint32_t>(primitive.indices.size());
+    }
+
 }
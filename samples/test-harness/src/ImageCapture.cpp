@@ -18,10 +18,34 @@
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include <stb_image_write.h>
 
+#include <algorithm>
 #include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace ImageCapture
 {
+    static EFormat captureFormat = EFormat::PNG;
+    static bool captureHdr = false;
+
+    // Writer threads of QueueWrite()
+    struct Writers
+    {
+        std::vector<std::thread> threads;
+        std::mutex mutex;
+        std::condition_variable wake;                           // Signaled when a write is queued or the writers stop
+        std::condition_variable idle;                           // Signaled when the queue is drained
+        std::deque<std::function<bool()>> writes;
+        uint32_t numWriting = 0;
+        bool failed = false;
+        bool stopping = false;
+    };
+    static Writers writers;
 
     /**
      * Convert IEEE 754 half-precision float (16-bit) to single-precision float (32-bit).
@@ -130,6 +154,25 @@ namespace ImageCapture
         return true;
     }
 
+    /**
+     * Set the file format of the captured images. With hdr, half-float resources are written as
+     * Radiance HDR files (without tone mapping) by the capture paths that support it.
+     */
+    void SetFormat(EFormat format, bool hdr)
+    {
+        captureFormat = format;
+        captureHdr = hdr;
+
+        // stb's zlib compression level (default 8), 1 is several times faster
+        stbi_write_png_compression_level = (format == EFormat::PNG_FAST) ? 1 : 8;
+        stbi_write_tga_with_rle = 0;
+    }
+
+    bool GetHdr()
+    {
+        return captureHdr;
+    }
+
     /**
      * Write image data to a PNG format file.
      */
@@ -139,6 +182,213 @@ namespace ImageCapture
         return result != 0;
     }
 
+    /**
+     * Write RGBA8 image data to a QOI format file (see https://qoiformat.org/qoi-specification.pdf).
+     */
+    bool CaptureQoi(std::string file, uint32_t width, uint32_t height, const unsigned char* data)
+    {
+        const uint8_t QOI_OP_INDEX = 0x00;
+        const uint8_t QOI_OP_DIFF = 0x40;
+        const uint8_t QOI_OP_LUMA = 0x80;
+        const uint8_t QOI_OP_RUN = 0xC0;
+        const uint8_t QOI_OP_RGB = 0xFE;
+        const uint8_t QOI_OP_RGBA = 0xFF;
+
+        std::vector<uint8_t> bytes;
+        bytes.reserve(14 + (static_cast<size_t>(width) * height * (NumChannels + 1)) + 8);
+
+        // Header: magic, big endian width and height, channels, and color space (sRGB with linear alpha)
+        const uint8_t header[14] =
+        {
+            'q', 'o', 'i', 'f',
+            static_cast<uint8_t>(width >> 24), static_cast<uint8_t>(width >> 16), static_cast<uint8_t>(width >> 8), static_cast<uint8_t>(width),
+            static_cast<uint8_t>(height >> 24), static_cast<uint8_t>(height >> 16), static_cast<uint8_t>(height >> 8), static_cast<uint8_t>(height),
+            NumChannels, 0
+        };
+        bytes.insert(bytes.end(), header, header + sizeof(header));
+
+        uint8_t index[64][4] = {};
+        uint8_t previous[4] = { 0, 0, 0, 255 };
+        uint32_t run = 0;
+
+        const size_t numPixels = static_cast<size_t>(width) * height;
+        for (size_t pixelIndex = 0; pixelIndex < numPixels; pixelIndex++)
+        {
+            const uint8_t* pixel = data + (pixelIndex * NumChannels);
+            if (memcmp(pixel, previous, 4) == 0)
+            {
+                run++;
+                if (run == 62 || pixelIndex == numPixels - 1)
+                {
+                    bytes.push_back(static_cast<uint8_t>(QOI_OP_RUN | (run - 1)));
+                    run = 0;
+                }
+                continue;
+            }
+
+            if (run > 0)
+            {
+                bytes.push_back(static_cast<uint8_t>(QOI_OP_RUN | (run - 1)));
+                run = 0;
+            }
+
+            uint32_t hash = ((pixel[0] * 3) + (pixel[1] * 5) + (pixel[2] * 7) + (pixel[3] * 11)) % 64;
+            if (memcmp(index[hash], pixel, 4) == 0)
+            {
+                bytes.push_back(static_cast<uint8_t>(QOI_OP_INDEX | hash));
+            }
+            else
+            {
+                memcpy(index[hash], pixel, 4);
+                if (pixel[3] == previous[3])
+                {
+                    int8_t dr = static_cast<int8_t>(pixel[0] - previous[0]);
+                    int8_t dg = static_cast<int8_t>(pixel[1] - previous[1]);
+                    int8_t db = static_cast<int8_t>(pixel[2] - previous[2]);
+                    int dr_dg = dr - dg;
+                    int db_dg = db - dg;
+
+                    if (dr > -3 && dr < 2 && dg > -3 && dg < 2 && db > -3 && db < 2)
+                    {
+                        bytes.push_back(static_cast<uint8_t>(QOI_OP_DIFF | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2)));
+                    }
+                    else if (dr_dg > -9 && dr_dg < 8 && dg > -33 && dg < 32 && db_dg > -9 && db_dg < 8)
+                    {
+                        bytes.push_back(static_cast<uint8_t>(QOI_OP_LUMA | (dg + 32)));
+                        bytes.push_back(static_cast<uint8_t>(((dr_dg + 8) << 4) | (db_dg + 8)));
+                    }
+                    else
+                    {
+                        const uint8_t rgb[4] = { QOI_OP_RGB, pixel[0], pixel[1], pixel[2] };
+                        bytes.insert(bytes.end(), rgb, rgb + 4);
+                    }
+                }
+                else
+                {
+                    const uint8_t rgba[5] = { QOI_OP_RGBA, pixel[0], pixel[1], pixel[2], pixel[3] };
+                    bytes.insert(bytes.end(), rgba, rgba + 5);
+                }
+            }
+            memcpy(previous, pixel, 4);
+        }
+
+        // End marker
+        const uint8_t padding[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+        bytes.insert(bytes.end(), padding, padding + sizeof(padding));
+
+        std::ofstream out(file, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) return false;
+        out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return out.good();
+    }
+
+    /**
+     * Write RGBA8 image data in the capture format. The file extension is appended to the given file name.
+     */
+    bool CaptureImage(std::string file, uint32_t width, uint32_t height, const unsigned char* data)
+    {
+        switch (captureFormat)
+        {
+            case EFormat::QOI: return CaptureQoi(file + ".qoi", width, height, data);
+            case EFormat::TGA: return stbi_write_tga((file + ".tga").c_str(), width, height, NumChannels, data) != 0;
+            default: return CapturePng(file + ".png", width, height, data);
+        }
+    }
+
+    /**
+     * Write R16G16B16A16_FLOAT image data to a Radiance HDR file, without tone mapping. The file extension is appended to the given file name.
+     */
+    bool CaptureHdr(std::string file, uint32_t width, uint32_t height, uint64_t srcRowPitch, const unsigned char* pSrcData)
+    {
+        std::vector<float> rgb(static_cast<size_t>(width) * height * 3);
+        for (uint32_t y = 0; y < height; y++)
+        {
+            const uint16_t* srcRow = reinterpret_cast<const uint16_t*>(pSrcData + y * srcRowPitch);
+            float* dstRow = rgb.data() + (static_cast<size_t>(y) * width * 3);
+            for (uint32_t x = 0; x < width; x++)
+            {
+                for (uint32_t channel = 0; channel < 3; channel++)
+                {
+                    float value = HalfToFloat(srcRow[x * 4 + channel]);
+                    dstRow[x * 3 + channel] = std::isfinite(value) ? (std::max)(0.0f, value) : 0.0f;
+                }
+            }
+        }
+        return stbi_write_hdr((file + ".hdr").c_str(), width, height, 3, rgb.data()) != 0;
+    }
+
+    /**
+     * Run the queued image writes until the writers stop.
+     */
+    static void WriterThread()
+    {
+    #if defined(_WIN32) || defined(WIN32)
+        CoInitialize(NULL);   // WIC format conversions
+    #endif
+
+        std::unique_lock<std::mutex> lock(writers.mutex);
+        while (true)
+        {
+            writers.wake.wait(lock, []() { return writers.stopping || !writers.writes.empty(); });
+            if (writers.writes.empty()) break;
+
+            std::function<bool()> write = std::move(writers.writes.front());
+            writers.writes.pop_front();
+            writers.numWriting++;
+
+            lock.unlock();
+            bool result = write();
+            lock.lock();
+
+            writers.failed |= !result;
+            writers.numWriting--;
+            if (writers.writes.empty() && writers.numWriting == 0) writers.idle.notify_all();
+        }
+
+    #if defined(_WIN32) || defined(WIN32)
+        CoUninitialize();
+    #endif
+    }
+
+    /**
+     * Queue an image write (conversion and encoding) on the writer threads.
+     */
+    void QueueWrite(std::function<bool()> write)
+    {
+        std::lock_guard<std::mutex> lock(writers.mutex);
+        if (writers.threads.empty())
+        {
+            // Half of the cores, the rest keep rendering
+            uint32_t numThreads = (std::max)(1u, std::thread::hardware_concurrency() / 2);
+            writers.stopping = false;
+            for (uint32_t threadIndex = 0; threadIndex < numThreads; threadIndex++) writers.threads.emplace_back(WriterThread);
+        }
+        writers.writes.push_back(std::move(write));
+        writers.wake.notify_one();
+    }
+
+    /**
+     * Wait for the queued image writes and stop the writer threads.
+     */
+    bool Flush()
+    {
+        bool failed = false;
+        {
+            std::unique_lock<std::mutex> lock(writers.mutex);
+            if (writers.threads.empty()) return true;
+
+            writers.idle.wait(lock, []() { return writers.writes.empty() && writers.numWriting == 0; });
+            writers.stopping = true;
+            failed = writers.failed;
+            writers.failed = false;
+        }
+        writers.wake.notify_all();
+
+        for (std::thread& thread : writers.threads) thread.join();
+        writers.threads.clear();
+        return !failed;
+    }
+
 #if defined(_WIN32) || defined(WIN32)
     /**
      * Create a Windows Image Component (WIC) imaging factory.
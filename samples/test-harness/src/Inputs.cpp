@@ -44,6 +44,9 @@ bool IsKeyReleased(int key, int action, int keycode)
  */
 void KeyHandler(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
+    // Keys edit UI items or toggle the options the UI shows
+    Graphics::UI::Invalidate();
+
     // ImGui captured the keyboard input, don't forward it
     if (Graphics::UI::CapturedKeyboard()) return;
 
@@ -75,6 +78,13 @@ void KeyHandler(GLFWwindow* window, int key, int scancode, int action, int mods)
         return;
     }
 
+    // Capture a trace of the CPU and GPU timelines
+    if (IsKeyReleased(key, action, GLFW_KEY_F3))
+    {
+        inputPtr->event = Inputs::EInputEvent::TRACE_CAPTURE;
+        return;
+    }
+
     // Run benchmark
     if (IsKeyReleased(key, action, GLFW_KEY_F4))
     {
@@ -173,8 +183,15 @@ void KeyHandler(GLFWwindow* window, int key, int scancode, int action, int mods)
  */
 void MousePositionHandler(GLFWwindow* window, double x, double y)
 {
+    // The cursor may hover the UI, camera drags don't change it
+    if (!inputPtr->mouseLeftBtnDown && !inputPtr->mouseRightBtnDown) Graphics::UI::Invalidate();
+
     // ImGui captured the mouse input, don't forward it
-    if (Graphics::UI::CapturedMouse()) return;
+    if (Graphics::UI::CapturedMouse())
+    {
+        Graphics::UI::Invalidate();
+        return;
+    }
 
     inputPtr->mousePos = { (int)x, (int)y };
 
@@ -234,7 +251,11 @@ void MousePositionHandler(GLFWwindow* window, double x, double y)
 void MouseButtonHandler(GLFWwindow* window, int button, int action, int mods)
 {
     // ImGui captured the mouse input, don't forward it
-    if (Graphics::UI::CapturedMouse()) return;
+    if (Graphics::UI::CapturedMouse())
+    {
+        Graphics::UI::Invalidate();
+        return;
+    }
 
     if(button == GLFW_MOUSE_BUTTON_LEFT)
     {
@@ -273,7 +294,11 @@ void MouseButtonHandler(GLFWwindow* window, int button, int action, int mods)
 void MouseScrollHandler(GLFWwindow* window, double xoffset, double yoffset)
 {
     // ImGui captured the mouse input, don't forward it
-    if (Graphics::UI::CapturedMouse()) return;
+    if (Graphics::UI::CapturedMouse())
+    {
+        Graphics::UI::Invalidate();
+        return;
+    }
 
     // Compute new camera position from zoom
     float speed = (float)-yoffset * configPtr->input.movementSpeed / 10.f;
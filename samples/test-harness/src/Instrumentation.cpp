@@ -10,6 +10,9 @@
 
 #include "Instrumentation.h"
 
+#include <algorithm>
+#include <fstream>
+
 #if __linux__
 #include <time.h>
 #endif
@@ -20,6 +23,26 @@ namespace Instrumentation
     // Private Functions
     //----------------------------------------------------------------------------------------------------------
 
+    static Trace* activeTrace = nullptr;    // The trace CPU scopes are recorded to, while a capture runs
+
+    /**
+     * Write the string as a JSON string value.
+     */
+    void WriteJSONString(std::ofstream& json, const std::string& value)
+    {
+        json << "\"";
+        for (char c : value)
+        {
+            if (c == '"' || c == '\\') json << '\\';
+            json << c;
+        }
+        json << "\"";
+    }
+
+    //----------------------------------------------------------------------------------------------------------
+    // Public Functions
+    //----------------------------------------------------------------------------------------------------------
+
     int64_t GetPerfCounter()
     {
     #if defined(_WIN32) || defined(WIN32)
@@ -37,42 +60,42 @@ namespace Instrumentation
     #endif
     }
 
-#if defined(_WIN32) || defined(WIN32)
     int64_t GetPerfCounterFrequency()
     {
+    #if defined(_WIN32) || defined(WIN32)
         LARGE_INTEGER value;
         QueryPerformanceFrequency(&value);
         return value.QuadPart;
+    #elif __linux__
+        // GetPerfCounter times are in nanoseconds on Linux
+        return 1000000000;
+    #endif
     }
 
+#if defined(_WIN32) || defined(WIN32)
     static int64_t frequency = GetPerfCounterFrequency();
 #endif
 
     /**
      * Get the number of milliseconds between the timer's start and the current time.
      */
-    void GetElapsed(Stat* s)
+    void GetElapsed(Stat* s, int64_t now)
     {
     #if defined(_WIN32) || defined(WIN32)
         // Frequency is ticks per second, so elapsed ticks / frequency = seconds
-        uint64_t seconds = (GetPerfCounter() - s->timestamp);
+        uint64_t seconds = (now - s->timestamp);
         s->elapsed += (static_cast<double>(seconds) / static_cast<double>(frequency)) * 1000;
     #elif __linux__
         // GetPerfCounter times are in nanoseconds on Linux
-        s->elapsed += (GetPerfCounter() - s->timestamp) * 0.000001;
+        s->elapsed += (now - s->timestamp) * 0.000001;
     #endif
     }
 
-    //----------------------------------------------------------------------------------------------------------
-    // Public Functions
-    //----------------------------------------------------------------------------------------------------------
-
-    uint32_t Stat::frameGPUQueryCount = 0;
+    std::atomic<uint32_t> Stat::frameGPUQueryCount = 0;
 
     int32_t Stat::GetGPUQueryBeginIndex()
     {
-        gpuQueryStartIndex = (Stat::frameGPUQueryCount * 2);
-        Stat::frameGPUQueryCount++;
+        gpuQueryStartIndex = (Stat::frameGPUQueryCount.fetch_add(1) * 2);
         return gpuQueryStartIndex;
     }
 
@@ -87,6 +110,47 @@ namespace Instrumentation
         gpuQueryStartIndex = gpuQueryEndIndex = -1;
     }
 
+    double Stat::GetPercentile(double percentile) const
+    {
+        if (sampleCount == 0) return 0;
+
+        std::vector<double> sorted(samples.begin(), samples.begin() + sampleCount);
+        size_t index = static_cast<size_t>(std::clamp(percentile, 0.0, 1.0) * (sampleCount - 1) + 0.5);
+        std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+        return sorted[index];
+    }
+
+    const char* Counters::GetName(ECounter counter)
+    {
+        switch (counter)
+        {
+            case PROBE_RAYS: return "Probe Rays";
+            case PROBE_RAY_HITS: return "Probe Ray Hits";
+            case PROBE_RAY_MISSES: return "Probe Ray Misses";
+            case CACHE_HITS: return "Cache Hits";
+            case CACHE_MISSES: return "Cache Misses";
+            case CACHE_COLLISIONS: return "Cache Collisions";
+            case INDIRECT_RAYS: return "Cache Update Rays";
+            case INDIRECT_RAY_HITS: return "Cache Update Ray Hits";
+            case INDIRECT_RAY_MISSES: return "Cache Update Ray Misses";
+            case INDIRECT_CACHE_HITS: return "Cache Update Lookup Hits";
+            case INDIRECT_CACHE_MISSES: return "Cache Update Lookup Misses";
+            case CACHE_EVICTIONS: return "Cache Evictions";
+            default: return "";
+        }
+    }
+
+    const char* Counters::GetPassName(ECounterPass pass)
+    {
+        switch (pass)
+        {
+            case PASS_PROBE_TRACE: return "Probe Trace";
+            case PASS_RADIANCE_CACHE_SHADE: return "Radiance Cache Shade";
+            case PASS_PROBE_RAY_RESOLVE: return "Probe Ray Resolve";
+            default: return "";
+        }
+    }
+
     void Begin(Stat* s)
     {
         s->elapsed = 0;
@@ -95,19 +159,29 @@ namespace Instrumentation
 
     void End(Stat* s)
     {
-        GetElapsed(s);
+        int64_t now = GetPerfCounter();
+        GetElapsed(s, now);
+        if (activeTrace) activeTrace->Record(s, s->timestamp, now, activeTrace->frame, ETraceTrack::CPU);
     }
 
     void Resolve(Stat* s)
     {
+        // Overwrite the oldest sample once the ring buffer is full
+        if (s->sampleCount == s->sampleSize) s->total -= s->samples[s->sampleHead];
+        else s->sampleCount++;
+
+        s->samples[s->sampleHead] = s->elapsed;
         s->total += s->elapsed;
-        if (static_cast<uint32_t>(s->samples.size()) >= s->sampleSize)
+        s->sampleHead = (s->sampleHead + 1) % s->sampleSize;
+
+        // Re-sum each time the ring buffer wraps so the running sum doesn't drift
+        if (s->sampleHead == 0)
         {
-            s->total -= s->samples.front();
-            s->samples.pop();
+            s->total = 0;
+            for (double sample : s->samples) s->total += sample;
         }
-        s->samples.push(s->elapsed);
-        s->average = std::max(s->total / s->samples.size(), (double)0);
+
+        s->average = std::max(s->total / s->sampleCount, (double)0);
     }
 
     void EndAndResolve(Stat* s)
@@ -116,6 +190,68 @@ namespace Instrumentation
         Resolve(s);
     }
 
+    void Trace::Start(uint32_t frames)
+    {
+        events.clear();
+        frame = 0;
+        numFrames = (std::max)(frames, 1u);
+        origin = GetPerfCounter();
+        capturing = true;
+        activeTrace = this;
+    }
+
+    void Trace::Stop()
+    {
+        capturing = false;
+        if (activeTrace == this) activeTrace = nullptr;
+    }
+
+    bool Trace::NextFrame()
+    {
+        if (!capturing) return false;
+
+        frame++;
+        if (frame < numFrames) return false;
+
+        Stop();
+        return true;
+    }
+
+    void Trace::Record(const Stat* stat, int64_t begin, int64_t end, uint32_t frame, ETraceTrack track)
+    {
+        if (!capturing) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        events.push_back({ stat, begin, end, frame, track });
+    }
+
+    bool Trace::Write(std::string file) const
+    {
+        std::ofstream json;
+        json.open(file, std::ios::out);
+        if (!json.is_open()) return false;
+
+        // Event times are microseconds since the start of the capture
+        double toMicroseconds = 1000000.0 / static_cast<double>(GetPerfCounterFrequency());
+
+        json << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [" << std::endl;
+        json << "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << (uint32_t)ETraceTrack::CPU << ", \"args\": {\"name\": \"CPU\"}}," << std::endl;
+        json << "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << (uint32_t)ETraceTrack::GPU_GRAPHICS << ", \"args\": {\"name\": \"GPU Graphics Queue\"}}";
+        json.setf(std::ios::fixed);
+        json.precision(3);
+        for (const TraceEvent& event : events)
+        {
+            json << "," << std::endl << "  {\"name\": ";
+            WriteJSONString(json, event.stat->name);
+            json << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << (uint32_t)event.track;
+            json << ", \"ts\": " << (static_cast<double>(event.begin - origin) * toMicroseconds);
+            json << ", \"dur\": " << (static_cast<double>(event.end - event.begin) * toMicroseconds);
+            json << ", \"args\": {\"frame\": " << event.frame << "}}";
+        }
+        json << std::endl << "]}" << std::endl;
+        json.close();
+        return true;
+    }
+
     std::ostream& operator<<(std::ostream& os, Stat* stat)
     {
         if(stat) os << stat->elapsed;
@@ -0,0 +1,93 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#include "Jobs.h"
+
+namespace Jobs
+{
+    /**
+     * Start the worker threads.
+     */
+    void Pool::Start(uint32_t numWorkers)
+    {
+        Stop();
+        stopping = false;
+        for (uint32_t workerIndex = 0; workerIndex < numWorkers; workerIndex++)
+        {
+            workers.emplace_back(&Pool::Work, this);
+        }
+    }
+
+    /**
+     * Stop and join the worker threads.
+     */
+    void Pool::Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+
+        for (std::thread& worker : workers) worker.join();
+        workers.clear();
+    }
+
+    /**
+     * Run the jobs of a batch on the worker threads and the calling thread, return when all are done.
+     * Jobs run in any order and concurrently, without workers the calling thread runs them in order.
+     */
+    void Pool::Run(const std::function<void()>* jobs, size_t numJobs)
+    {
+        if (numJobs == 0) return;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        batch = jobs;
+        batchSize = numJobs;
+        next = 0;
+        remaining = numJobs;
+        wake.notify_all();
+
+        while (RunNextJob(lock));
+        done.wait(lock, [this]() { return remaining == 0; });
+        batch = nullptr;
+        batchSize = 0;
+    }
+
+    /**
+     * Take the next job of the batch and run it (unlocked), returns false when no job is left to take.
+     */
+    bool Pool::RunNextJob(std::unique_lock<std::mutex>& lock)
+    {
+        if (!batch || next >= batchSize) return false;
+
+        const std::function<void()>& job = batch[next++];
+        lock.unlock();
+        job();
+        lock.lock();
+
+        if (--remaining == 0) done.notify_all();
+        return true;
+    }
+
+    /**
+     * Worker thread: run the jobs of each batch until the pool stops.
+     */
+    void Pool::Work()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            wake.wait(lock, [this]() { return stopping || (batch && next < batchSize); });
+            if (stopping) return;
+            while (RunNextJob(lock));
+        }
+    }
+}
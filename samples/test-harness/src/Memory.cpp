@@ -0,0 +1,113 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#include "Memory.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<uint64_t> allocationCount(0);
+}
+
+//----------------------------------------------------------------------------------------------------------
+// Global Allocation Counting
+//----------------------------------------------------------------------------------------------------------
+
+// The array and nothrow forms call these, as do the array and aligned forms of delete
+void* operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0) size = 1;
+    while (true)
+    {
+        if (void* ptr = std::malloc(size)) return ptr;
+
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace Memory
+{
+    uint64_t GetAllocationCount()
+    {
+        return allocationCount.load(std::memory_order_relaxed);
+    }
+
+    //----------------------------------------------------------------------------------------------------------
+    // FrameArena
+    //----------------------------------------------------------------------------------------------------------
+
+    FrameArena::FrameArena(size_t capacity) : capacity(capacity), offset(0)
+    {
+        block = static_cast<uint8_t*>(::operator new(capacity));
+    }
+
+    FrameArena::~FrameArena()
+    {
+        Reset();
+        ::operator delete(block);
+    }
+
+    /**
+     * Allocate size bytes at the given (power of two) alignment, valid until the next Reset().
+     */
+    void* FrameArena::Allocate(size_t size, size_t alignment)
+    {
+        size_t current = offset.load(std::memory_order_relaxed);
+        while (true)
+        {
+            size_t aligned = (current + (alignment - 1)) & ~(alignment - 1);
+            if (aligned + size > capacity) break;
+            if (offset.compare_exchange_weak(current, aligned + size, std::memory_order_relaxed)) return block + aligned;
+        }
+
+        // The arena is full, fall back to the heap until the next Reset() grows it
+        std::lock_guard<std::mutex> lock(overflowMutex);
+        void* ptr = ::operator new(size + alignment);
+        overflow.push_back(ptr);
+        overflowSize += size + alignment;
+
+        uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+        return reinterpret_cast<void*>((address + (alignment - 1)) & ~static_cast<uintptr_t>(alignment - 1));
+    }
+
+    /**
+     * Release the frame's allocations. When the last frame overflowed, the arena grows to hold it.
+     */
+    void FrameArena::Reset()
+    {
+        if (!overflow.empty())
+        {
+            for (void* ptr : overflow) ::operator delete(ptr);
+            overflow.clear();
+
+            ::operator delete(block);
+            capacity = (capacity + overflowSize) * 2;
+            block = static_cast<uint8_t*>(::operator new(capacity));
+            overflowSize = 0;
+        }
+        offset.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,154 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#include "RenderGraph.h"
+
+namespace RenderGraph
+{
+    const uint32_t Unused = UINT32_MAX;
+
+    Graph::Graph()
+    {
+        for (uint32_t passIndex = 0; passIndex < MaxPasses; passIndex++)
+        {
+            recordPasses[passIndex] = [this, passIndex]()
+            {
+                const Pass& pass = graphPasses[passIndex];
+                if (barrierFunction && (pass.barriers || pass.waitForAsync)) barrierFunction(pass);
+                (*pass.execute)();
+            };
+        }
+        Reset();
+    }
+
+    /**
+     * Start the declaration of a frame's passes.
+     */
+    void Graph::Reset()
+    {
+        numPasses = 0;
+        outputs = 0;
+        for (uint32_t resource = 0; resource < RESOURCE_COUNT; resource++)
+        {
+            firstUse[resource] = Unused;
+            lastUse[resource] = Unused;
+        }
+    }
+
+    /**
+     * Add a pass, after the passes added so far. The execute function is referenced, it must outlive the frame.
+     */
+    bool Graph::AddPass(const char* name, const std::function<void()>& execute, uint32_t reads, uint32_t writes, uint32_t asyncWrites, bool sideEffects)
+    {
+        if (numPasses >= MaxPasses) return false;
+
+        Pass& pass = graphPasses[numPasses++];
+        pass = Pass();
+        pass.name = name;
+        pass.execute = &execute;
+        pass.reads = reads;
+        pass.writes = writes | asyncWrites;
+        pass.asyncWrites = asyncWrites;
+        pass.sideEffects = sideEffects;
+        return true;
+    }
+
+    /**
+     * Derive the frame's schedule from the declared passes.
+     * Outputs are the resources read after the frame. With asyncCompute, the asyncWrites of the passes run on the compute queue.
+     */
+    void Graph::Compile(uint32_t outputs, bool asyncCompute)
+    {
+        this->outputs = outputs;
+
+        // Cull the passes whose writes are never read, walking back from the outputs.
+        // A resource written (and not read) by a live pass is no longer needed from the passes before it.
+        uint32_t needed = outputs;
+        for (uint32_t passIndex = numPasses; passIndex-- > 0;)
+        {
+            Pass& pass = graphPasses[passIndex];
+            pass.culled = !pass.sideEffects && ((pass.writes & needed) == 0);
+            if (pass.culled) continue;
+
+            needed = (needed & ~(pass.writes & ~pass.reads)) | pass.reads;
+        }
+
+        // Walk the live passes in order. A barrier is due when a pass accesses a resource with writes not yet waited for,
+        // or writes a resource read since the last barrier. Barriers are global (every resource), so one clears all hazards.
+        uint32_t pendingWrites = 0;
+        uint32_t pendingReads = 0;
+        uint32_t pendingAsyncWrites = 0;
+        for (uint32_t passIndex = 0; passIndex < numPasses; passIndex++)
+        {
+            Pass& pass = graphPasses[passIndex];
+            if (pass.culled) continue;
+
+            uint32_t accesses = pass.reads | pass.writes;
+            pass.barriers = (accesses & pendingWrites) | (pass.writes & pendingReads);
+            if (pass.barriers)
+            {
+                pendingWrites = 0;
+                pendingReads = 0;
+            }
+
+            pass.waitForAsync = (accesses & pendingAsyncWrites) != 0;
+            if (pass.waitForAsync) pendingAsyncWrites = 0;
+
+            pass.queue = (asyncCompute && pass.asyncWrites) ? EQueue::COMPUTE : EQueue::GRAPHICS;
+            uint32_t queueWrites = (pass.queue == EQueue::COMPUTE) ? (pass.writes & ~pass.asyncWrites) : pass.writes;
+            if (pass.queue == EQueue::COMPUTE) pendingAsyncWrites |= pass.asyncWrites;
+            pendingWrites |= queueWrites;
+            pendingReads |= pass.reads;
+
+            for (uint32_t resource = 0; resource < RESOURCE_COUNT; resource++)
+            {
+                if ((accesses & Bit(static_cast<EResource>(resource))) == 0) continue;
+                if (firstUse[resource] == Unused) firstUse[resource] = passIndex;
+                lastUse[resource] = passIndex;
+            }
+        }
+    }
+
+    /**
+     * Fill the list of passes to record (see Graphics::RecordPasses) with the live passes, in order.
+     */
+    void Graph::GetPasses(std::vector<std::function<void()>>& passes) const
+    {
+        passes.clear();
+        for (uint32_t passIndex = 0; passIndex < numPasses; passIndex++)
+        {
+            if (graphPasses[passIndex].culled) continue;
+            passes.emplace_back(std::cref(recordPasses[passIndex]));
+        }
+    }
+
+    /**
+     * The range of live passes that access the resource, returns false when no live pass does.
+     */
+    bool Graph::GetLifetime(EResource resource, uint32_t& firstPass, uint32_t& lastPass) const
+    {
+        if (firstUse[resource] == Unused) return false;
+        firstPass = firstUse[resource];
+        lastPass = lastUse[resource];
+        return true;
+    }
+
+    /**
+     * Whether two resources may share memory this frame: neither outlives the frame and their lifetimes don't overlap.
+     */
+    bool Graph::CanAlias(EResource a, EResource b) const
+    {
+        if (a == b || (outputs & (Bit(a) | Bit(b)))) return false;
+
+        uint32_t firstA, lastA, firstB, lastB;
+        if (!GetLifetime(a, firstA, lastA) || !GetLifetime(b, firstB, lastB)) return true;
+        return (lastA < firstB) || (lastB < firstA);
+    }
+}
@@ -0,0 +1,358 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#include "Replay.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace Replay
+{
+    // Replay log layout (little endian):
+    //   ReplayHeader
+    //   uint32_t rngSeeds[numVolumes]
+    //   GPU stat names[numGPUStats]: uint32_t length, char[length]
+    //   Frame frames[numFrames]
+    //   float gpuTimes[numFrames][numGPUStats]
+    #define REPLAY_MAGIC 0x52585452     // 'RTXR'
+    #define REPLAY_VERSION 1
+
+    struct ReplayHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t numVolumes;
+        uint32_t numGPUStats;
+        uint32_t numFrames;
+    };
+
+    //----------------------------------------------------------------------------------------------------------
+    // Private Functions
+    //----------------------------------------------------------------------------------------------------------
+
+    uint32_t GetToggles(const Configs::Config& config)
+    {
+        uint32_t toggles = 0;
+        if (config.ddgi.enabled) toggles |= (1 << TOGGLE_DDGI);
+        if (config.ddgi.showIndirect) toggles |= (1 << TOGGLE_DDGI_SHOW_INDIRECT);
+        if (config.ddgi.showTextures) toggles |= (1 << TOGGLE_DDGI_SHOW_TEXTURES);
+        if (config.ddgi.showProbes) toggles |= (1 << TOGGLE_DDGI_SHOW_PROBES);
+        if (config.rtao.enabled) toggles |= (1 << TOGGLE_RTAO);
+        if (config.pathTrace.enabled) toggles |= (1 << TOGGLE_PATH_TRACE);
+        if (config.app.showUI) toggles |= (1 << TOGGLE_SHOW_UI);
+        if (config.app.showPerf) toggles |= (1 << TOGGLE_SHOW_PERF);
+        return toggles;
+    }
+
+    void SetToggles(uint32_t toggles, Configs::Config& config)
+    {
+        config.ddgi.enabled = (toggles & (1 << TOGGLE_DDGI)) != 0;
+        config.ddgi.showIndirect = (toggles & (1 << TOGGLE_DDGI_SHOW_INDIRECT)) != 0;
+        config.ddgi.showTextures = (toggles & (1 << TOGGLE_DDGI_SHOW_TEXTURES)) != 0;
+        config.ddgi.showProbes = (toggles & (1 << TOGGLE_DDGI_SHOW_PROBES)) != 0;
+        config.rtao.enabled = (toggles & (1 << TOGGLE_RTAO)) != 0;
+        config.pathTrace.enabled = (toggles & (1 << TOGGLE_PATH_TRACE)) != 0;
+        config.app.showUI = (toggles & (1 << TOGGLE_SHOW_UI)) != 0;
+        config.app.showPerf = (toggles & (1 << TOGGLE_SHOW_PERF)) != 0;
+    }
+
+    /**
+     * Get a stat's name without the indentation of the UI hierarchy.
+     */
+    std::string GetStatName(const std::string& name)
+    {
+        size_t start = name.find_first_not_of(' ');
+        return (start == std::string::npos) ? name : name.substr(start);
+    }
+
+    /**
+     * Get the median of every stride-th value, from offset.
+     */
+    float GetMedian(const std::vector<float>& values, size_t offset, size_t stride)
+    {
+        std::vector<float> sorted;
+        for (size_t index = offset; index < values.size(); index += stride) sorted.push_back(values[index]);
+        if (sorted.empty()) return 0.f;
+
+        std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+        return sorted[sorted.size() / 2];
+    }
+
+    bool ReadLog(const std::string& path, Session& session, std::ofstream& log)
+    {
+        std::ifstream in(path, std::ios::in | std::ios::binary);
+        if (!in.is_open())
+        {
+            log << "\nError: failed to open the replay log '" << path << "'!";
+            return false;
+        }
+
+        ReplayHeader header = {};
+        in.read(reinterpret_cast<char*>(&header), sizeof(ReplayHeader));
+        if (!in.good() || header.magic != REPLAY_MAGIC || header.version != REPLAY_VERSION)
+        {
+            log << "\nError: '" << path << "' is not a replay log of this version!";
+            return false;
+        }
+
+        session.rngSeeds.resize(header.numVolumes);
+        in.read(reinterpret_cast<char*>(session.rngSeeds.data()), sizeof(uint32_t) * header.numVolumes);
+
+        session.gpuStatNames.resize(header.numGPUStats);
+        for (std::string& name : session.gpuStatNames)
+        {
+            uint32_t length = 0;
+            in.read(reinterpret_cast<char*>(&length), sizeof(uint32_t));
+            if (!in.good() || length > 1024) break;
+            name.resize(length);
+            in.read(name.data(), length);
+        }
+
+        session.frames.resize(header.numFrames);
+        session.gpuTimes.resize(static_cast<size_t>(header.numFrames) * header.numGPUStats);
+        in.read(reinterpret_cast<char*>(session.frames.data()), sizeof(Frame) * session.frames.size());
+        in.read(reinterpret_cast<char*>(session.gpuTimes.data()), sizeof(float) * session.gpuTimes.size());
+        if (!in.good())
+        {
+            log << "\nError: the replay log '" << path << "' is truncated!";
+            return false;
+        }
+        return true;
+    }
+
+    bool WriteLog(const std::string& path, const Session& session, std::ofstream& log)
+    {
+        std::ofstream out(path, std::ios::out | std::ios::binary);
+        if (!out.is_open())
+        {
+            log << "\nError: failed to write the replay log '" << path << "'!";
+            return false;
+        }
+
+        ReplayHeader header = {};
+        header.magic = REPLAY_MAGIC;
+        header.version = REPLAY_VERSION;
+        header.numVolumes = static_cast<uint32_t>(session.rngSeeds.size());
+        header.numGPUStats = static_cast<uint32_t>(session.gpuStatNames.size());
+        header.numFrames = static_cast<uint32_t>(session.frames.size());
+        out.write(reinterpret_cast<const char*>(&header), sizeof(ReplayHeader));
+        out.write(reinterpret_cast<const char*>(session.rngSeeds.data()), sizeof(uint32_t) * session.rngSeeds.size());
+        for (const std::string& name : session.gpuStatNames)
+        {
+            uint32_t length = static_cast<uint32_t>(name.size());
+            out.write(reinterpret_cast<const char*>(&length), sizeof(uint32_t));
+            out.write(name.data(), length);
+        }
+        out.write(reinterpret_cast<const char*>(session.frames.data()), sizeof(Frame) * session.frames.size());
+        out.write(reinterpret_cast<const char*>(session.gpuTimes.data()), sizeof(float) * session.gpuTimes.size());
+        return out.good();
+    }
+
+    //----------------------------------------------------------------------------------------------------------
+    // Public Functions
+    //----------------------------------------------------------------------------------------------------------
+
+    /**
+     * Start recording (--record) or replaying (--replay) the run. Call before the DDGIVolumes are created:
+     * recordings pin the random rotation seed of the volumes without one, replays take the recorded seeds.
+     */
+    bool Start(Session& session, Configs::Config& config, std::ofstream& log)
+    {
+        session = Session();
+        session.recording = !config.benchmark.record.empty();
+        session.replaying = !config.benchmark.replay.empty();
+        if (!session.recording && !session.replaying) return true;
+
+        if (session.replaying)
+        {
+            if (!ReadLog(config.benchmark.replay, session, log)) return false;
+            if (session.rngSeeds.size() != config.ddgi.volumes.size())
+            {
+                log << "\nError: the replay log was recorded with " << session.rngSeeds.size() << " DDGIVolumes, the config has " << config.ddgi.volumes.size() << "!";
+                return false;
+            }
+            for (size_t volumeIndex = 0; volumeIndex < config.ddgi.volumes.size(); volumeIndex++)
+            {
+                config.ddgi.volumes[volumeIndex].rngSeed = session.rngSeeds[volumeIndex];
+            }
+
+            // The recorded frames drive the camera and config, the config file and late mouse input are not applied
+            config.app.hotReload = false;
+            config.input.lateLatch = false;
+            log << "Replaying " << session.frames.size() << " frames of " << config.benchmark.replay << "\n";
+            return true;
+        }
+
+        // Seeds are nonzero, a zero seed is taken from the system time
+        for (size_t volumeIndex = 0; volumeIndex < config.ddgi.volumes.size(); volumeIndex++)
+        {
+            Configs::DDGIVolume& volume = config.ddgi.volumes[volumeIndex];
+            if (volume.rngSeed == 0) volume.rngSeed = static_cast<uint32_t>(volumeIndex) + 1;
+            session.rngSeeds.push_back(volume.rngSeed);
+        }
+        log << "Recording the frames to " << config.benchmark.record << "\n";
+        return true;
+    }
+
+    /**
+     * Record the frame's state once its inputs are handled, or replace it with the next recorded frame.
+     * Call after Inputs::PollInputs(). Quitting is left to the user, the replay ends by itself once every frame is replayed.
+     */
+    void UpdateInputs(Session& session, Inputs::Input& input, Configs::Config& config, Scenes::Scene& scene)
+    {
+        if (session.recording)
+        {
+            Frame frame;
+            if (input.event == Inputs::EInputEvent::CAMERA_MOVEMENT
+                || input.event == Inputs::EInputEvent::SCREENSHOT
+                || input.event == Inputs::EInputEvent::SAVE_IMAGES
+                || input.event == Inputs::EInputEvent::FULLSCREEN_CHANGE)
+            {
+                frame.event = static_cast<uint32_t>(input.event);
+            }
+            frame.toggles = GetToggles(config);
+            frame.renderMode = static_cast<uint32_t>(config.app.renderMode);
+            if (!scene.cameras.empty())
+            {
+                const Scenes::Camera& camera = scene.GetActiveCamera();
+                frame.activeCamera = scene.activeCamera;
+                frame.position = { camera.data.position.x, camera.data.position.y, camera.data.position.z };
+                frame.yaw = camera.yaw;
+                frame.pitch = camera.pitch;
+            }
+            session.frames.push_back(frame);
+            return;
+        }
+
+        if (!session.replaying || session.finished) return;
+        if (session.frameIndex >= session.frames.size())
+        {
+            session.finished = true;
+            return;
+        }
+
+        const Frame& frame = session.frames[session.frameIndex++];
+        if (input.event != Inputs::EInputEvent::QUIT) input.event = static_cast<Inputs::EInputEvent>(frame.event);
+        SetToggles(frame.toggles, config);
+        config.app.renderMode = static_cast<ERenderMode>(frame.renderMode);
+
+        if (frame.activeCamera < scene.cameras.size())
+        {
+            scene.activeCamera = frame.activeCamera;
+            Scenes::Camera& camera = scene.GetActiveCamera();
+            camera.data.position = { frame.position.x, frame.position.y, frame.position.z };
+            camera.yaw = frame.yaw;
+            camera.pitch = frame.pitch;
+            Scenes::UpdateCamera(camera);
+        }
+    }
+
+    /**
+     * Store the timing of the frame. The GPU times are those resolved this frame, recording and replay have the same latency.
+     */
+    void EndFrame(Session& session, const Instrumentation::Performance& perf)
+    {
+        if (session.recording && !session.frames.empty())
+        {
+            // The stats are taken from the first frame, stats added later aren't recorded
+            if (session.gpuStatNames.empty())
+            {
+                for (const Instrumentation::Stat* stat : perf.gpuTimes) session.gpuStatNames.push_back(stat->name);
+            }
+
+            size_t numStats = session.gpuStatNames.size();
+            session.frames.back().cpuTime = static_cast<float>(perf.cpuTimes[Instrumentation::EStatIndex::FRAME]->elapsed);
+            session.gpuTimes.resize(session.frames.size() * numStats, 0.f);
+            for (size_t statIndex = 0; statIndex < (std::min)(numStats, perf.gpuTimes.size()); statIndex++)
+            {
+                session.gpuTimes[(session.frames.size() - 1) * numStats + statIndex] = static_cast<float>(perf.gpuTimes[statIndex]->elapsed);
+            }
+            return;
+        }
+
+        if (session.replaying && !session.finished && session.frameIndex > 0)
+        {
+            // Replayed times are stored in the order of the recorded stats, stats not timed anymore stay zero
+            size_t numStats = session.gpuStatNames.size();
+            session.replayedCPUTimes.resize(session.frameIndex, 0.f);
+            session.replayedGPUTimes.resize(session.frameIndex * numStats, 0.f);
+            session.replayedCPUTimes[session.frameIndex - 1] = static_cast<float>(perf.cpuTimes[Instrumentation::EStatIndex::FRAME]->elapsed);
+            for (size_t statIndex = 0; statIndex < numStats; statIndex++)
+            {
+                for (const Instrumentation::Stat* stat : perf.gpuTimes)
+                {
+                    if (stat->name != session.gpuStatNames[statIndex]) continue;
+                    session.replayedGPUTimes[(session.frameIndex - 1) * numStats + statIndex] = static_cast<float>(stat->elapsed);
+                    break;
+                }
+            }
+        }
+    }
+
+    /**
+     * Write the replay log of a recording, or compare a finished replay against its recording.
+     * The comparison (replayComparison.csv in the screenshot path) has the median time of each pass, and the time of each frame,
+     * in both runs. Spikes of the recording that reproduce show up at the same frames.
+     */
+    bool Finish(Session& session, const Configs::Config& config, std::ofstream& log)
+    {
+        if (session.recording)
+        {
+            if (!WriteLog(config.benchmark.record, session, log)) return false;
+            log << "Recorded " << session.frames.size() << " frames to " << config.benchmark.record << "\n";
+            return true;
+        }
+
+        if (!session.replaying || session.replayedCPUTimes.empty()) return true;
+
+        std::error_code error;
+        std::filesystem::create_directories(config.scene.screenshotPath, error);
+        std::string path = config.scene.screenshotPath + "/replayComparison.csv";
+        std::ofstream csv(path, std::ios::out);
+        if (!csv.is_open())
+        {
+            log << "\nError: failed to write the replay comparison '" << path << "'!";
+            return false;
+        }
+
+        size_t numStats = session.gpuStatNames.size();
+        size_t numFrames = session.replayedCPUTimes.size();
+
+        log << "Replay Comparison (" << numFrames << " of " << session.frames.size() << " frames):" << std::endl;
+        csv << "Stat,Recorded Median (ms),Replayed Median (ms),Delta (%)\n";
+        for (size_t statIndex = 0; statIndex < numStats; statIndex++)
+        {
+            std::string name = GetStatName(session.gpuStatNames[statIndex]);
+
+            float recorded = GetMedian(session.gpuTimes, statIndex, numStats);
+            float replayed = GetMedian(session.replayedGPUTimes, statIndex, numStats);
+            float percent = (recorded > 0.f) ? ((replayed - recorded) / recorded) * 100.f : 0.f;
+            csv << name << "," << recorded << "," << replayed << "," << percent << "\n";
+            log << "\t" << name << "=" << replayed << "ms recorded=" << recorded << "ms (" << (percent >= 0.f ? "+" : "") << percent << "%)" << std::endl;
+        }
+
+        csv << "\nFrame,Recorded CPU (ms),Replayed CPU (ms)";
+        for (const std::string& name : session.gpuStatNames) csv << ",Recorded " << GetStatName(name) << " (ms),Replayed (ms)";
+        csv << "\n";
+        for (size_t frameIndex = 0; frameIndex < numFrames; frameIndex++)
+        {
+            csv << frameIndex << "," << session.frames[frameIndex].cpuTime << "," << session.replayedCPUTimes[frameIndex];
+            for (size_t statIndex = 0; statIndex < numStats; statIndex++)
+            {
+                csv << "," << session.gpuTimes[frameIndex * numStats + statIndex] << "," << session.replayedGPUTimes[frameIndex * numStats + statIndex];
+            }
+            csv << "\n";
+        }
+
+        log << "Wrote the replay comparison " << path << std::endl;
+        return true;
+    }
+}
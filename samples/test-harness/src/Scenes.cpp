@@ -9,6 +9,7 @@
 */
 
 #include "Caches.h"
+#include "Jobs.h"
 #include "Scenes.h"
 #include "UI.h"
 
@@ -18,8 +19,14 @@
 #define TINYGLTF_NO_STB_IMAGE_WRITE
 #include <tiny_gltf.h>
 
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
 #include <regex>
+#include <thread>
+#include <unordered_map>
 #include <math.h>
+#include <DirectXPackedVector.h>
 
 using namespace DirectX;
 
@@ -30,6 +37,71 @@ namespace Scenes
     // Private Functions
     //----------------------------------------------------------------------------------------------------------
 
+    // Worker threads of the scene graph and bounding box updates, started on first use
+    Jobs::Pool sceneWorkers;
+    const static uint32_t parallelBatchSize = 4096;    // Nodes or instances per job
+
+    /**
+     * Run the jobs on the scene workers, starting the workers on first use.
+     */
+    void RunSceneJobs(const std::vector<std::function<void()>>& jobs)
+    {
+        if (sceneWorkers.GetNumWorkers() == 0) sceneWorkers.Start((std::max)(std::thread::hardware_concurrency(), 2u) - 1);
+        sceneWorkers.Run(jobs);
+    }
+
+    /**
+     * Run the function over batches of [begin, end), on the scene workers when there is more than one batch.
+     * Batches start at multiples of parallelBatchSize from begin.
+     */
+    void ParallelFor(uint32_t begin, uint32_t end, const std::function<void(uint32_t, uint32_t)>& function)
+    {
+        if (end <= begin) return;
+
+        uint32_t numBatches = ((end - begin) + parallelBatchSize - 1) / parallelBatchSize;
+        if (numBatches == 1)
+        {
+            function(begin, end);
+            return;
+        }
+
+        std::vector<std::function<void()>> jobs;
+        for (uint32_t batchBegin = begin; batchBegin < end; batchBegin += parallelBatchSize)
+        {
+            uint32_t batchEnd = (std::min)(batchBegin + parallelBatchSize, end);
+            jobs.push_back([&function, batchBegin, batchEnd]() { function(batchBegin, batchEnd); });
+        }
+        RunSceneJobs(jobs);
+    }
+
+    /**
+     * Flatten the scene graph breadth first, so each depth is a range of flat positions that follows its parents' depth.
+     */
+    void FlattenNodes(Scene& scene)
+    {
+        scene.flatNodes.assign(scene.rootNodes.begin(), scene.rootNodes.end());
+        scene.flatParents.assign(scene.rootNodes.size(), -1);
+        scene.flatLevels.assign(1, 0);
+
+        uint32_t levelBegin = 0;
+        while (levelBegin < static_cast<uint32_t>(scene.flatNodes.size()))
+        {
+            uint32_t levelEnd = static_cast<uint32_t>(scene.flatNodes.size());
+            scene.flatLevels.push_back(levelEnd);
+            for (uint32_t flatIndex = levelBegin; flatIndex < levelEnd; flatIndex++)
+            {
+                for (int child : scene.nodes[scene.flatNodes[flatIndex]].children)
+                {
+                    scene.flatNodes.push_back(child);
+                    scene.flatParents.push_back(static_cast<int>(flatIndex));
+                }
+            }
+            levelBegin = levelEnd;
+        }
+
+        scene.worldTransforms.resize(scene.flatNodes.size());
+    }
+
     void SetTranslation(const tinygltf::Node& gltfNode, XMFLOAT3& translation)
     {
     #if COORDINATE_SYSTEM == COORDINATE_SYSTEM_RIGHT
@@ -186,13 +258,8 @@ namespace Scenes
             scene.nodes.push_back(node);
         }
 
-        // Traverse the scene graph and update instance transforms
-        for (size_t rootIndex = 0; rootIndex < scene.rootNodes.size(); rootIndex++)
-        {
-            XMMATRIX transform = XMMatrixIdentity();
-            int nodeIndex = scene.rootNodes[rootIndex];
-            Traverse(nodeIndex, transform, scene);
-        }
+        // Update the instance transforms from the scene graph
+        UpdateTransforms(scene);
     }
 
     /**
@@ -255,11 +322,60 @@ namespace Scenes
         }
     }
 
+    // Textures loaded, mipmapped, and compressed by worker threads while the rest of the scene is parsed
+    struct TextureTasks
+    {
+        std::unordered_map<std::string, const Textures::Texture*> cached; // textures of the previous scene cache, by source filepath
+        std::vector<Textures::Texture> textures;
+        std::vector<std::thread> workers;
+        std::atomic<uint32_t> next = 0;
+        std::atomic<bool> failed = false;
+    };
+
     /**
-     * Parse glTF textures and load the images.
+     * Worker thread: load, mipmap, and compress textures until none are left.
      */
-    bool ParseGLFTextures(const tinygltf::Model& gltfData, const Configs::Config& config, Scene& scene)
+    void ProcessGLTFTextures(TextureTasks& tasks)
     {
+        uint32_t textureIndex;
+        while (!tasks.failed && (textureIndex = tasks.next++) < static_cast<uint32_t>(tasks.textures.size()))
+        {
+            Textures::Texture& texture = tasks.textures[textureIndex];
+
+            // Reuse the processed texture of the previous scene cache if its source image is unchanged
+            const auto cachedTexture = tasks.cached.find(texture.filepath);
+            if (cachedTexture != tasks.cached.end())
+            {
+                Textures::Texture reused = *cachedTexture->second;
+                if (Caches::IsFileCurrent(texture.filepath, reused.sourceStamp, reused.sourceHash))
+                {
+                    reused.name = texture.name;
+                    texture = reused;
+                    continue;
+                }
+            }
+
+            // Hash the source image and load the texture from disk
+            texture.sourceStamp = Caches::GetFileStamp(texture.filepath);
+            if (!Caches::HashFile(texture.filepath, texture.sourceHash)) { tasks.failed = true; return; }
+            if (!Textures::Load(texture)) { tasks.failed = true; return; }
+
+        #if defined(WIN32) && defined(__x86_64__) || defined(_M_X64)
+            // Generate mipmaps and compress the texture (Windows only), pre-compressed DDS and KTX2 textures are used as is
+            if (texture.format == Textures::ETextureFormat::UNCOMPRESSED && !Textures::MipmapAndCompress(texture)) { tasks.failed = true; return; }
+        #endif
+        }
+    }
+
+    /**
+     * Parse the glTF textures and start loading them on worker threads.
+     * Each worker processes one texture at a time, the number of workers bounds the memory used by texture processing.
+     * Textures with unchanged source images are reused from the cached scene.
+     */
+    void BeginGLTFTextures(const tinygltf::Model& gltfData, const Configs::Config& config, const Scene& cached, TextureTasks& tasks)
+    {
+        for (const Textures::Texture& texture : cached.textures) tasks.cached[texture.filepath] = &texture;
+
         for (uint32_t textureIndex = 0; textureIndex < static_cast<uint32_t>(gltfData.textures.size()); textureIndex++)
         {
             // Get the GLTF texture
@@ -269,7 +385,7 @@ namespace Scenes
             if (gltfTexture.source == -1 || gltfData.images.size() <= gltfTexture.source) continue;
 
             // Get the GLTF image
-            const tinygltf::Image gltfImage = gltfData.images[gltfTexture.source];
+            const tinygltf::Image& gltfImage = gltfData.images[gltfTexture.source];
 
             Textures::Texture texture;
             texture.SetName(gltfImage.uri);
@@ -279,56 +395,588 @@ namespace Scenes
             // Construct the texture image filepath
             texture.filepath = config.app.root + config.scene.path + ParseURI(gltfImage.uri);
 
-            // Load the texture from disk
-            if (!Textures::Load(texture)) return false;
+            tasks.textures.push_back(texture);
+        }
 
-        #if defined(WIN32) && defined(__x86_64__) || defined(_M_X64)
-            // Generate mipmaps and compress the texture (Windows only)
-            if(!Textures::MipmapAndCompress(texture)) return false;
-        #endif
+        // Start the workers
+        uint32_t numWorkers = (std::min)((std::max)(std::thread::hardware_concurrency(), 1u), static_cast<uint32_t>(tasks.textures.size()));
+        for (uint32_t workerIndex = 0; workerIndex < numWorkers; workerIndex++)
+        {
+            tasks.workers.emplace_back(ProcessGLTFTextures, std::ref(tasks));
+        }
+    }
+
+    /**
+     * Wait for the texture workers to finish and add the textures to the scene.
+     */
+    bool EndGLTFTextures(TextureTasks& tasks, Scene& scene)
+    {
+        for (std::thread& worker : tasks.workers) worker.join();
+        tasks.workers.clear();
 
-            // Add the texture to the scene
-            scene.textures.push_back(texture);
+        if (tasks.failed)
+        {
+            for (Textures::Texture& texture : tasks.textures) Textures::Unload(texture);
+            return false;
         }
+
+        // Add the textures to the scene
+        scene.textures.insert(scene.textures.end(), tasks.textures.begin(), tasks.textures.end());
         return true;
     }
 
+    /**
+     * Reorder triangles for post transform vertex cache locality (Tipsify, Sander et al. 2007).
+     * The indices reference the vertices [0, numVertices).
+     */
+    void TipsifyTriangles(std::vector<uint32_t>& triangleIndices, uint32_t numVertices)
+    {
+        const int cacheSize = 16;
+        uint32_t numTriangles = static_cast<uint32_t>(triangleIndices.size() / 3);
+
+        // Build the vertex to triangle adjacency
+        std::vector<uint32_t> adjacencyOffsets(numVertices + 1, 0);
+        for (uint32_t index : triangleIndices) adjacencyOffsets[index + 1]++;
+        for (uint32_t vertexIndex = 0; vertexIndex < numVertices; vertexIndex++) adjacencyOffsets[vertexIndex + 1] += adjacencyOffsets[vertexIndex];
+
+        std::vector<uint32_t> adjacency(triangleIndices.size());
+        std::vector<uint32_t> liveTriangles(numVertices, 0);
+        for (uint32_t triangleIndex = 0; triangleIndex < numTriangles; triangleIndex++)
+        {
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                uint32_t index = triangleIndices[(triangleIndex * 3) + i];
+                adjacency[adjacencyOffsets[index] + liveTriangles[index]++] = triangleIndex;
+            }
+        }
+
+        // Fan out from a vertex, emitting its remaining triangles, then pick the next vertex among the
+        // emitted triangles' vertices that still has triangles and (likely) is still in the cache
+        std::vector<int> cacheTimes(numVertices, 0);
+        std::vector<bool> emitted(numTriangles, false);
+        std::vector<uint32_t> deadEnds;
+        std::vector<uint32_t> candidates;
+        std::vector<uint32_t> indices;
+        indices.reserve(triangleIndices.size());
+
+        int time = cacheSize + 1;
+        uint32_t cursor = 0;
+        while (cursor < numVertices && liveTriangles[cursor] == 0) cursor++;
+        int fanning = (cursor < numVertices) ? static_cast<int>(cursor) : -1;
+        while (fanning >= 0)
+        {
+            candidates.clear();
+            for (uint32_t a = adjacencyOffsets[fanning]; a < adjacencyOffsets[fanning + 1]; a++)
+            {
+                uint32_t triangleIndex = adjacency[a];
+                if (emitted[triangleIndex]) continue;
+
+                for (uint32_t i = 0; i < 3; i++)
+                {
+                    uint32_t index = triangleIndices[(triangleIndex * 3) + i];
+                    indices.push_back(index);
+                    deadEnds.push_back(index);
+                    candidates.push_back(index);
+                    liveTriangles[index]--;
+                    if ((time - cacheTimes[index]) > cacheSize) cacheTimes[index] = time++;
+                }
+                emitted[triangleIndex] = true;
+            }
+
+            // Prefer the oldest candidate that stays in the cache while its triangles are emitted
+            fanning = -1;
+            int bestPriority = -1;
+            for (uint32_t index : candidates)
+            {
+                if (liveTriangles[index] == 0) continue;
+
+                int priority = 0;
+                if ((time - cacheTimes[index]) + (2 * static_cast<int>(liveTriangles[index])) <= cacheSize) priority = time - cacheTimes[index];
+                if (priority > bestPriority)
+                {
+                    bestPriority = priority;
+                    fanning = static_cast<int>(index);
+                }
+            }
+
+            // Dead end, back up to a recently used vertex, or else the next vertex in order
+            while (fanning < 0 && !deadEnds.empty())
+            {
+                uint32_t index = deadEnds.back();
+                deadEnds.pop_back();
+                if (liveTriangles[index] > 0) fanning = static_cast<int>(index);
+            }
+            while (fanning < 0 && cursor < numVertices)
+            {
+                if (liveTriangles[cursor] > 0) fanning = static_cast<int>(cursor);
+                else cursor++;
+            }
+        }
+        assert(indices.size() == triangleIndices.size());
+        triangleIndices = std::move(indices);
+    }
+
+    /**
+     * Reorder a mesh primitive's triangles for post transform vertex cache locality, then reorder its vertices by first use
+     * for vertex fetch locality. Unreferenced vertices are removed. With a cluster size, the triangles are reordered within
+     * consecutive clusters of that many triangles, which keeps the order of the clusters (see SortTrianglesSpatially).
+     */
+    void OptimizeVertexCache(MeshPrimitive& mp, uint32_t clusterSize)
+    {
+        uint32_t numVertices = static_cast<uint32_t>(mp.vertices.size());
+        uint32_t numTriangles = static_cast<uint32_t>(mp.indices.size() / 3);
+        if (clusterSize == 0) clusterSize = (std::max)(numTriangles, 1u);
+
+        // Reorder each cluster's triangles, on the cluster's vertices renumbered from 0
+        std::vector<uint32_t> localIndices(numVertices, UINT32_MAX);
+        std::vector<uint32_t> clusterVertices;
+        std::vector<uint32_t> clusterIndices;
+        for (uint32_t firstTriangle = 0; firstTriangle < numTriangles; firstTriangle += clusterSize)
+        {
+            uint32_t begin = firstTriangle * 3;
+            uint32_t end = (std::min)(firstTriangle + clusterSize, numTriangles) * 3;
+
+            clusterVertices.clear();
+            clusterIndices.clear();
+            for (uint32_t i = begin; i < end; i++)
+            {
+                uint32_t index = mp.indices[i];
+                if (localIndices[index] == UINT32_MAX)
+                {
+                    localIndices[index] = static_cast<uint32_t>(clusterVertices.size());
+                    clusterVertices.push_back(index);
+                }
+                clusterIndices.push_back(localIndices[index]);
+            }
+
+            TipsifyTriangles(clusterIndices, static_cast<uint32_t>(clusterVertices.size()));
+
+            for (uint32_t i = begin; i < end; i++) mp.indices[i] = clusterVertices[clusterIndices[i - begin]];
+            for (uint32_t index : clusterVertices) localIndices[index] = UINT32_MAX;
+        }
+
+        // Reorder the vertices by first use
+        std::vector<uint32_t> remap(numVertices, UINT32_MAX);
+        std::vector<Graphics::Vertex> vertices;
+        vertices.reserve(numVertices);
+        for (uint32_t& index : mp.indices)
+        {
+            if (remap[index] == UINT32_MAX)
+            {
+                remap[index] = static_cast<uint32_t>(vertices.size());
+                vertices.push_back(mp.vertices[index]);
+            }
+            index = remap[index];
+        }
+
+        mp.vertices = std::move(vertices);
+    }
+
+    /**
+     * Spread the low 10 bits of a value to every third bit, for 30-bit Morton codes.
+     */
+    uint32_t SpreadBits3(uint32_t v)
+    {
+        v &= 0x3FF;
+        v = (v | (v << 16)) & 0x030000FF;
+        v = (v | (v << 8)) & 0x0300F00F;
+        v = (v | (v << 4)) & 0x030C30C3;
+        v = (v | (v << 2)) & 0x09249249;
+        return v;
+    }
+
+    /**
+     * Sort a mesh primitive's triangles along the Morton curve of their centroids in the primitive's bounding box.
+     * Consecutive triangles are then close in space, so the BLAS builder's leaves and the nodes above them are tighter.
+     */
+    void SortTrianglesSpatially(MeshPrimitive& mp)
+    {
+        uint32_t numTriangles = static_cast<uint32_t>(mp.indices.size() / 3);
+        if (numTriangles < 2) return;
+
+        const rtxgi::float3& min = mp.boundingBox.min;
+        const rtxgi::float3& max = mp.boundingBox.max;
+        rtxgi::float3 scale =
+        {
+            (max.x > min.x) ? 1023.f / (max.x - min.x) : 0.f,
+            (max.y > min.y) ? 1023.f / (max.y - min.y) : 0.f,
+            (max.z > min.z) ? 1023.f / (max.z - min.z) : 0.f
+        };
+
+        // Sort keys: the Morton code of the centroid above the triangle index
+        std::vector<uint64_t> keys(numTriangles);
+        for (uint32_t triangleIndex = 0; triangleIndex < numTriangles; triangleIndex++)
+        {
+            const rtxgi::float3& a = mp.vertices[mp.indices[(triangleIndex * 3) + 0]].position;
+            const rtxgi::float3& b = mp.vertices[mp.indices[(triangleIndex * 3) + 1]].position;
+            const rtxgi::float3& c = mp.vertices[mp.indices[(triangleIndex * 3) + 2]].position;
+
+            uint32_t x = static_cast<uint32_t>((std::min)((((a.x + b.x + c.x) / 3.f) - min.x) * scale.x, 1023.f));
+            uint32_t y = static_cast<uint32_t>((std::min)((((a.y + b.y + c.y) / 3.f) - min.y) * scale.y, 1023.f));
+            uint32_t z = static_cast<uint32_t>((std::min)((((a.z + b.z + c.z) / 3.f) - min.z) * scale.z, 1023.f));
+            uint64_t code = SpreadBits3(x) | (SpreadBits3(y) << 1) | (SpreadBits3(z) << 2);
+            keys[triangleIndex] = (code << 32) | triangleIndex;
+        }
+        std::sort(keys.begin(), keys.end());
+
+        std::vector<uint32_t> indices(mp.indices.size());
+        for (uint32_t i = 0; i < numTriangles; i++)
+        {
+            uint32_t triangleIndex = static_cast<uint32_t>(keys[i]);
+            indices[(i * 3) + 0] = mp.indices[(triangleIndex * 3) + 0];
+            indices[(i * 3) + 1] = mp.indices[(triangleIndex * 3) + 1];
+            indices[(i * 3) + 2] = mp.indices[(triangleIndex * 3) + 2];
+        }
+        mp.indices = std::move(indices);
+    }
+
+    /**
+     * Octahedral encode a unit vector to [-1, 1].
+     */
+    rtxgi::float2 OctEncode(const rtxgi::float3& v)
+    {
+        float l1 = fabsf(v.x) + fabsf(v.y) + fabsf(v.z);
+        if (l1 == 0.f) return { 0.f, 0.f };
+
+        rtxgi::float2 e = { v.x / l1, v.y / l1 };
+        if (v.z < 0.f)
+        {
+            rtxgi::float2 folded = { (1.f - fabsf(e.y)) * (e.x >= 0.f ? 1.f : -1.f), (1.f - fabsf(e.x)) * (e.y >= 0.f ? 1.f : -1.f) };
+            e = folded;
+        }
+        return e;
+    }
+
+    /**
+     * Convert a [-1, 1] value to a signed normalized integer with the given number of bits (two's complement, masked).
+     */
+    uint32_t PackSnorm(float value, uint32_t bits)
+    {
+        float scale = static_cast<float>((1 << (bits - 1)) - 1);
+        int32_t q = static_cast<int32_t>(roundf((std::max)(-1.f, (std::min)(value, 1.f)) * scale));
+        return static_cast<uint32_t>(q) & ((1u << bits) - 1);
+    }
+
+    /**
+     * Quantize a mesh primitive's vertices to the Graphics::PackedVertex layout and release the full precision vertices.
+     * Positions are stored as UNORM16 in the primitive's bounding box (see Direct3D12.cpp::CreateSceneMaterialIndexingBuffers()).
+     */
+    void PackVertices(MeshPrimitive& mp)
+    {
+        const rtxgi::float3& min = mp.boundingBox.min;
+        const rtxgi::float3& max = mp.boundingBox.max;
+        rtxgi::float3 scale =
+        {
+            (max.x > min.x) ? 65535.f / (max.x - min.x) : 0.f,
+            (max.y > min.y) ? 65535.f / (max.y - min.y) : 0.f,
+            (max.z > min.z) ? 65535.f / (max.z - min.z) : 0.f
+        };
+
+        mp.packedVertices.resize(mp.vertices.size());
+        for (size_t vertexIndex = 0; vertexIndex < mp.vertices.size(); vertexIndex++)
+        {
+            const Graphics::Vertex& v = mp.vertices[vertexIndex];
+            Graphics::PackedVertex& pv = mp.packedVertices[vertexIndex];
+
+            uint32_t px = static_cast<uint32_t>(roundf((std::min)((v.position.x - min.x) * scale.x, 65535.f)));
+            uint32_t py = static_cast<uint32_t>(roundf((std::min)((v.position.y - min.y) * scale.y, 65535.f)));
+            uint32_t pz = static_cast<uint32_t>(roundf((std::min)((v.position.z - min.z) * scale.z, 65535.f)));
+
+            rtxgi::float2 normal = OctEncode(v.normal);
+            rtxgi::float2 tangent = OctEncode({ v.tangent.x, v.tangent.y, v.tangent.z });
+            uint32_t packedTangent = PackSnorm(tangent.x, 7) | (PackSnorm(tangent.y, 7) << 7) | ((v.tangent.w < 0.f) ? 0x8000 : 0);
+
+            pv.data.x = px | (py << 16);
+            pv.data.y = pz | (packedTangent << 16);
+            pv.data.z = PackSnorm(normal.x, 16) | (PackSnorm(normal.y, 16) << 16);
+            pv.data.w = static_cast<uint32_t>(PackedVector::XMConvertFloatToHalf(v.uv0.x)) | (static_cast<uint32_t>(PackedVector::XMConvertFloatToHalf(v.uv0.y)) << 16);
+        }
+
+        mp.vertices.clear();
+        mp.vertices.shrink_to_fit();
+    }
+
+    /**
+     * Hash the bytes of a glTF accessor (and whether it exists).
+     */
+    uint64_t HashGLTFAccessor(const tinygltf::Model& gltfData, int accessorIndex, uint64_t hash)
+    {
+        bool exists = (accessorIndex > -1);
+        hash = Caches::Hash(&exists, sizeof(bool), hash);
+        if (!exists) return hash;
+
+        const tinygltf::Accessor& accessor = gltfData.accessors[accessorIndex];
+        const tinygltf::BufferView& bufferView = gltfData.bufferViews[accessor.bufferView];
+        const tinygltf::Buffer& buffer = gltfData.buffers[bufferView.buffer];
+        size_t stride = static_cast<size_t>(tinygltf::GetComponentSizeInBytes(accessor.componentType) * tinygltf::GetNumComponentsInType(accessor.type));
+
+        hash = Caches::Hash(&accessor.componentType, sizeof(int), hash);
+        return Caches::Hash(buffer.data.data() + bufferView.byteOffset + accessor.byteOffset, accessor.count * stride, hash);
+    }
+
+    /**
+     * Hash the glTF source data of a mesh primitive's geometry (its index and vertex attribute data).
+     */
+    uint64_t HashGLTFPrimitive(const tinygltf::Model& gltfData, const tinygltf::Primitive& p)
+    {
+        uint64_t hash = HashGLTFAccessor(gltfData, p.indices, Caches::Hash(nullptr, 0));
+
+        const char* attributes[] = { "POSITION", "NORMAL", "TANGENT", "TEXCOORD_0" };
+        for (const char* attribute : attributes)
+        {
+            int accessorIndex = (p.attributes.count(attribute) > 0) ? p.attributes.at(attribute) : -1;
+            hash = HashGLTFAccessor(gltfData, accessorIndex, hash);
+        }
+        return hash;
+    }
+
+    /**
+     * Get a glTF mesh primitive's vertex and index data, converted to the chosen coordinate system.
+     */
+    void ParseGLTFPrimitiveGeometry(const tinygltf::Model& gltfData, const tinygltf::Primitive& p, MeshPrimitive& mp)
+    {
+        // Get data indices
+        int indicesIndex = p.indices;
+        int positionIndex = -1;
+        int normalIndex = -1;
+        int tangentIndex = -1;
+        int uv0Index = -1;
+
+        if (p.attributes.count("POSITION") > 0)
+        {
+            positionIndex = p.attributes.at("POSITION");
+        }
+
+        if (p.attributes.count("NORMAL") > 0)
+        {
+            normalIndex = p.attributes.at("NORMAL");
+        }
+
+        if (p.attributes.count("TANGENT"))
+        {
+            tangentIndex = p.attributes.at("TANGENT");
+        }
+
+        if (p.attributes.count("TEXCOORD_0") > 0)
+        {
+            uv0Index = p.attributes.at("TEXCOORD_0");
+        }
+
+        // Vertex positions
+        const tinygltf::Accessor& positionAccessor = gltfData.accessors[positionIndex];
+        const tinygltf::BufferView& positionBufferView = gltfData.bufferViews[positionAccessor.bufferView];
+        const tinygltf::Buffer& positionBuffer = gltfData.buffers[positionBufferView.buffer];
+        const uint8_t* positionBufferAddress = positionBuffer.data.data();
+        int positionStride = tinygltf::GetComponentSizeInBytes(positionAccessor.componentType) * tinygltf::GetNumComponentsInType(positionAccessor.type);
+        assert(positionStride == 12);
+
+        // Vertex indices
+        const tinygltf::Accessor& indexAccessor = gltfData.accessors[indicesIndex];
+        const tinygltf::BufferView& indexBufferView = gltfData.bufferViews[indexAccessor.bufferView];
+        const tinygltf::Buffer& indexBuffer = gltfData.buffers[indexBufferView.buffer];
+        const uint8_t* indexBufferAddress = indexBuffer.data.data();
+        int indexStride = tinygltf::GetComponentSizeInBytes(indexAccessor.componentType) * tinygltf::GetNumComponentsInType(indexAccessor.type);
+        mp.indices.resize(indexAccessor.count);
+
+        // Vertex normals
+        tinygltf::Accessor normalAccessor;
+        tinygltf::BufferView normalBufferView;
+        const uint8_t* normalBufferAddress = nullptr;
+        int normalStride = -1;
+        if (normalIndex > -1)
+        {
+            normalAccessor = gltfData.accessors[normalIndex];
+            normalBufferView = gltfData.bufferViews[normalAccessor.bufferView];
+            normalStride = tinygltf::GetComponentSizeInBytes(normalAccessor.componentType) * tinygltf::GetNumComponentsInType(normalAccessor.type);
+            assert(normalStride == 12);
+
+            const tinygltf::Buffer& normalBuffer = gltfData.buffers[normalBufferView.buffer];
+            normalBufferAddress = normalBuffer.data.data();
+        }
+
+        // Vertex tangents
+        tinygltf::Accessor tangentAccessor;
+        tinygltf::BufferView tangentBufferView;
+        const uint8_t* tangentBufferAddress = nullptr;
+        int tangentStride = -1;
+        if (tangentIndex > -1)
+        {
+            tangentAccessor = gltfData.accessors[tangentIndex];
+            tangentBufferView = gltfData.bufferViews[tangentAccessor.bufferView];
+            tangentStride = tinygltf::GetComponentSizeInBytes(tangentAccessor.componentType) * tinygltf::GetNumComponentsInType(tangentAccessor.type);
+            assert(tangentStride == 16);
+
+            const tinygltf::Buffer& tangentBuffer = gltfData.buffers[tangentBufferView.buffer];
+            tangentBufferAddress = tangentBuffer.data.data();
+        }
+
+        // Vertex texture coordinates
+        tinygltf::Accessor uv0Accessor;
+        tinygltf::BufferView uv0BufferView;
+        const uint8_t* uv0BufferAddress = nullptr;
+        int uv0Stride = -1;
+        if (uv0Index > -1)
+        {
+            uv0Accessor = gltfData.accessors[uv0Index];
+            uv0BufferView = gltfData.bufferViews[uv0Accessor.bufferView];
+            uv0Stride = tinygltf::GetComponentSizeInBytes(uv0Accessor.componentType) * tinygltf::GetNumComponentsInType(uv0Accessor.type);
+            assert(uv0Stride == 8);
+
+            const tinygltf::Buffer& uv0Buffer = gltfData.buffers[uv0BufferView.buffer];
+            uv0BufferAddress = uv0Buffer.data.data();
+        }
+
+        // Get the vertex data
+        for (uint32_t vertexIndex = 0; vertexIndex < static_cast<uint32_t>(positionAccessor.count); vertexIndex++)
+        {
+            Graphics::Vertex v;
+
+            const uint8_t* address = positionBufferAddress + positionBufferView.byteOffset + positionAccessor.byteOffset + (vertexIndex * positionStride);
+            memcpy(&v.position, address, positionStride);
+
+        #if (COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT) || (COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT_Z_UP)
+            // Invert z-coordinate to convert from right hand to left hand
+            v.position.z *= -1.f;
+        #endif
+
+        #if COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT_Z_UP
+            // Convert to left hand, z-up (unreal)
+            v.position = { v.position.z, v.position.x, v.position.y };
+        #elif COORDINATE_SYSTEM == COORDINATE_SYSTEM_RIGHT_Z_UP
+            // Convert to right hand, z-up
+            v.position = { v.position.x, -v.position.z, v.position.y };
+        #endif
+
+            if (normalIndex > -1)
+            {
+                address = normalBufferAddress + normalBufferView.byteOffset + normalAccessor.byteOffset + (vertexIndex * normalStride);
+                memcpy(&v.normal, address, normalStride);
+
+            #if (COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT) || (COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT_Z_UP)
+                // Invert the z-coordinate to convert from right hand to left hand
+                v.normal.z *= -1.f;
+            #endif
+
+            #if COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT_Z_UP
+                // Convert to left hand, z-up (unreal)
+                v.normal = { v.normal.z, v.normal.x, v.normal.y };
+            #elif COORDINATE_SYSTEM == COORDINATE_SYSTEM_RIGHT_Z_UP
+                // Convert to right hand, z-up
+                v.normal = { v.normal.x, -v.normal.z, v.normal.y };
+            #endif
+            }
+
+            if (tangentIndex > -1)
+            {
+                address = tangentBufferAddress + tangentBufferView.byteOffset + tangentAccessor.byteOffset + (vertexIndex * tangentStride);
+                memcpy(&v.tangent, address, tangentStride);
+
+            #if COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT || COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT_Z_UP
+                // Invert the z-coordinate to convert from right hand to left hand
+                v.tangent.z *= -1.f;
+            #endif
+
+            #if COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT_Z_UP
+                // Convert to left hand, z-up (unreal)
+                v.tangent = { v.tangent.z, v.tangent.x, v.tangent.y, v.tangent.w };
+            #elif COORDINATE_SYSTEM == COORDINATE_SYSTEM_RIGHT_Z_UP
+                // Convert to right hand, z-up
+                v.tangent = { v.tangent.x, -v.tangent.z, v.tangent.y, v.tangent.w };
+            #endif
+            }
+
+            if (uv0Index > -1)
+            {
+                address = uv0BufferAddress + uv0BufferView.byteOffset + uv0Accessor.byteOffset + (vertexIndex * uv0Stride);
+                memcpy(&v.uv0, address, uv0Stride);
+            }
+
+            // Update the mesh primitive's bounding box
+            mp.boundingBox.min = rtxgi::Min(mp.boundingBox.min, v.position);
+            mp.boundingBox.max = rtxgi::Max(mp.boundingBox.max, v.position);
+
+            mp.vertices.push_back(v);
+        }
+
+        // Get the index data
+        // Indices can be either unsigned char, unsigned short, or unsigned long
+        // Converting to full precision for easy use on GPU
+        const uint8_t* baseAddress = indexBufferAddress + indexBufferView.byteOffset + indexAccessor.byteOffset;
+        if (indexStride == 1)
+        {
+            std::vector<uint8_t> quarter;
+            quarter.resize(indexAccessor.count);
+
+            memcpy(quarter.data(), baseAddress, (indexAccessor.count * indexStride));
+
+            // Convert quarter precision indices to full precision
+            for (size_t i = 0; i < indexAccessor.count; i++)
+            {
+                mp.indices[i] = quarter[i];
+            }
+        }
+        else if (indexStride == 2)
+        {
+            std::vector<uint16_t> half;
+            half.resize(indexAccessor.count);
+
+            memcpy(half.data(), baseAddress, (indexAccessor.count * indexStride));
+
+            // Convert half precision indices to full precision
+            for (size_t i = 0; i < indexAccessor.count; i++)
+            {
+                mp.indices[i] = half[i];
+            }
+        }
+        else
+        {
+            memcpy(mp.indices.data(), baseAddress, (indexAccessor.count * indexStride));
+        }
+    }
+
     /**
      * Parse the glTF meshes.
+     * The processed geometry of mesh primitives with unchanged source data is reused from the cached scene,
+     * the other primitives are processed in parallel on the scene workers.
      */
-    void ParseGLTFMeshes(const tinygltf::Model& gltfData, Scene& scene)
+    void ParseGLTFMeshes(const tinygltf::Model& gltfData, const Configs::Config& config, const Scene& cached, Scene& scene)
     {
+        std::unordered_map<uint64_t, const MeshPrimitive*> cachedPrimitives;
+        for (const Mesh& mesh : cached.meshes)
+        {
+            for (const MeshPrimitive& mp : mesh.primitives) cachedPrimitives[mp.hash] = &mp;
+        }
+
         // Note: GTLF 2.0's default coordinate system is Right Handed, Y-Up
         // https://github.com/KhronosGroup/glTF/tree/master/specification/2.0#coordinate-system-and-units
         // Meshes are converted from this coordinate system to the chosen coordinate system.
 
+        // The triangle order is part of the processed geometry, primitives processed with the other setting aren't reused
+        bool sortTriangles = config.scene.sortTriangles;
+        scene.sortedTriangles = sortTriangles;
+
+        // Set up the meshes and their primitives, reusing the cached geometry
+        std::vector<std::function<void()>> jobs;
         uint32_t geometryIndex = 0;
+        scene.meshes.resize(gltfData.meshes.size());
         for (uint32_t meshIndex = 0; meshIndex < static_cast<uint32_t>(gltfData.meshes.size()); meshIndex++)
         {
             const tinygltf::Mesh& gltfMesh = gltfData.meshes[meshIndex];
 
-            Mesh mesh;
+            Mesh& mesh = scene.meshes[meshIndex];
+            mesh.index = static_cast<int>(meshIndex);
             mesh.name = gltfMesh.name;
-            mesh.numVertices = 0;
-            mesh.numIndices = 0;
             if (mesh.name.compare("") == 0) mesh.name = "Mesh_" + std::to_string(meshIndex);
 
-            // Initialize the mesh bounding box
-            mesh.boundingBox.min = { FLT_MAX, FLT_MAX, FLT_MAX };
-            mesh.boundingBox.max = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
-
-            uint32_t vertexByteOffset = 0;
-            uint32_t indexByteOffset = 0;
+            mesh.primitives.resize(gltfMesh.primitives.size());
             for (uint32_t primitiveIndex = 0; primitiveIndex < static_cast<uint32_t>(gltfMesh.primitives.size()); primitiveIndex++)
             {
                 // Get a reference to the mesh primitive
                 const tinygltf::Primitive& p = gltfMesh.primitives[primitiveIndex];
 
-                MeshPrimitive mp;
-                mp.index = geometryIndex;
+                MeshPrimitive& mp = mesh.primitives[primitiveIndex];
+                mp.index = geometryIndex++;
                 mp.material = p.material;
-                mp.vertexByteOffset = vertexByteOffset;
-                mp.indexByteOffset = indexByteOffset;
 
                 // Initialize the mesh primitive bounding box
                 mp.boundingBox.min = { FLT_MAX, FLT_MAX, FLT_MAX };
@@ -342,225 +990,59 @@ namespace Scenes
                 const Material& mat = scene.materials[mp.material];
                 if (mat.data.alphaMode != 0) mp.opaque = false;
 
-                // Get data indices
-                int indicesIndex = p.indices;
-                int positionIndex = -1;
-                int normalIndex = -1;
-                int tangentIndex = -1;
-                int uv0Index = -1;
-
-                if (p.attributes.count("POSITION") > 0)
-                {
-                    positionIndex = p.attributes.at("POSITION");
-                }
-
-                if (p.attributes.count("NORMAL") > 0)
-                {
-                    normalIndex = p.attributes.at("NORMAL");
-                }
-
-                if (p.attributes.count("TANGENT"))
-                {
-                    tangentIndex = p.attributes.at("TANGENT");
-                }
-
-                if (p.attributes.count("TEXCOORD_0") > 0)
+                // Reuse the processed geometry of an unchanged mesh primitive from the scene cache
+                mp.hash = Caches::Hash(&sortTriangles, sizeof(bool), HashGLTFPrimitive(gltfData, p));
+                const auto cachedPrimitive = cachedPrimitives.find(mp.hash);
+                if (cachedPrimitive != cachedPrimitives.end())
                 {
-                    uv0Index = p.attributes.at("TEXCOORD_0");
+                    mp.boundingBox = cachedPrimitive->second->boundingBox;
+                    mp.packedVertices = cachedPrimitive->second->packedVertices;
+                    mp.indices = cachedPrimitive->second->indices;
+                    continue;
                 }
 
-                // Vertex positions
-                const tinygltf::Accessor& positionAccessor = gltfData.accessors[positionIndex];
-                const tinygltf::BufferView& positionBufferView = gltfData.bufferViews[positionAccessor.bufferView];
-                const tinygltf::Buffer& positionBuffer = gltfData.buffers[positionBufferView.buffer];
-                const uint8_t* positionBufferAddress = positionBuffer.data.data();
-                int positionStride = tinygltf::GetComponentSizeInBytes(positionAccessor.componentType) * tinygltf::GetNumComponentsInType(positionAccessor.type);
-                assert(positionStride == 12);
-
-                // Vertex indices
-                const tinygltf::Accessor& indexAccessor = gltfData.accessors[indicesIndex];
-                const tinygltf::BufferView& indexBufferView = gltfData.bufferViews[indexAccessor.bufferView];
-                const tinygltf::Buffer& indexBuffer = gltfData.buffers[indexBufferView.buffer];
-                const uint8_t* indexBufferAddress = indexBuffer.data.data();
-                int indexStride = tinygltf::GetComponentSizeInBytes(indexAccessor.componentType) * tinygltf::GetNumComponentsInType(indexAccessor.type);
-                mp.indices.resize(indexAccessor.count);
-
-                // Vertex normals
-                tinygltf::Accessor normalAccessor;
-                tinygltf::BufferView normalBufferView;
-                const uint8_t* normalBufferAddress = nullptr;
-                int normalStride = -1;
-                if (normalIndex > -1)
+                // Get the vertex and index data, order the triangles, and quantize the vertices (scene caches store the result)
+                jobs.push_back([&gltfData, &p, &mp, sortTriangles]()
                 {
-                    normalAccessor = gltfData.accessors[normalIndex];
-                    normalBufferView = gltfData.bufferViews[normalAccessor.bufferView];
-                    normalStride = tinygltf::GetComponentSizeInBytes(normalAccessor.componentType) * tinygltf::GetNumComponentsInType(normalAccessor.type);
-                    assert(normalStride == 12);
-
-                    const tinygltf::Buffer& normalBuffer = gltfData.buffers[normalBufferView.buffer];
-                    normalBufferAddress = normalBuffer.data.data();
-                }
-
-                // Vertex tangents
-                tinygltf::Accessor tangentAccessor;
-                tinygltf::BufferView tangentBufferView;
-                const uint8_t* tangentBufferAddress = nullptr;
-                int tangentStride = -1;
-                if (tangentIndex > -1)
-                {
-                    tangentAccessor = gltfData.accessors[tangentIndex];
-                    tangentBufferView = gltfData.bufferViews[tangentAccessor.bufferView];
-                    tangentStride = tinygltf::GetComponentSizeInBytes(tangentAccessor.componentType) * tinygltf::GetNumComponentsInType(tangentAccessor.type);
-                    assert(tangentStride == 16);
-
-                    const tinygltf::Buffer& tangentBuffer = gltfData.buffers[tangentBufferView.buffer];
-                    tangentBufferAddress = tangentBuffer.data.data();
-                }
-
-                // Vertex texture coordinates
-                tinygltf::Accessor uv0Accessor;
-                tinygltf::BufferView uv0BufferView;
-                const uint8_t* uv0BufferAddress = nullptr;
-                int uv0Stride = -1;
-                if (uv0Index > -1)
-                {
-                    uv0Accessor = gltfData.accessors[uv0Index];
-                    uv0BufferView = gltfData.bufferViews[uv0Accessor.bufferView];
-                    uv0Stride = tinygltf::GetComponentSizeInBytes(uv0Accessor.componentType) * tinygltf::GetNumComponentsInType(uv0Accessor.type);
-                    assert(uv0Stride == 8);
-
-                    const tinygltf::Buffer& uv0Buffer = gltfData.buffers[uv0BufferView.buffer];
-                    uv0BufferAddress = uv0Buffer.data.data();
-                }
-
-                // Get the vertex data
-                for (uint32_t vertexIndex = 0; vertexIndex < static_cast<uint32_t>(positionAccessor.count); vertexIndex++)
-                {
-                    Graphics::Vertex v;
-
-                    const uint8_t* address = positionBufferAddress + positionBufferView.byteOffset + positionAccessor.byteOffset + (vertexIndex * positionStride);
-                    memcpy(&v.position, address, positionStride);
-
-                #if (COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT) || (COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT_Z_UP)
-                    // Invert z-coordinate to convert from right hand to left hand
-                    v.position.z *= -1.f;
-                #endif
-
-                #if COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT_Z_UP
-                    // Convert to left hand, z-up (unreal)
-                    v.position = { v.position.z, v.position.x, v.position.y };
-                #elif COORDINATE_SYSTEM == COORDINATE_SYSTEM_RIGHT_Z_UP
-                    // Convert to right hand, z-up
-                    v.position = { v.position.x, -v.position.z, v.position.y };
-                #endif
-
-                    if (normalIndex > -1)
-                    {
-                        address = normalBufferAddress + normalBufferView.byteOffset + normalAccessor.byteOffset + (vertexIndex * normalStride);
-                        memcpy(&v.normal, address, normalStride);
-
-                    #if (COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT) || (COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT_Z_UP)
-                        // Invert the z-coordinate to convert from right hand to left hand
-                        v.normal.z *= -1.f;
-                    #endif
-
-                    #if COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT_Z_UP
-                        // Convert to left hand, z-up (unreal)
-                        v.normal = { v.normal.z, v.normal.x, v.normal.y };
-                    #elif COORDINATE_SYSTEM == COORDINATE_SYSTEM_RIGHT_Z_UP
-                        // Convert to right hand, z-up
-                        v.normal = { v.normal.x, -v.normal.z, v.normal.y };
-                    #endif
-                    }
-
-                    if (tangentIndex > -1)
-                    {
-                        address = tangentBufferAddress + tangentBufferView.byteOffset + tangentAccessor.byteOffset + (vertexIndex * tangentStride);
-                        memcpy(&v.tangent, address, tangentStride);
-
-                    #if COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT || COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT_Z_UP
-                        // Invert the z-coordinate to convert from right hand to left hand
-                        v.tangent.z *= -1.f;
-                    #endif
-
-                    #if COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT_Z_UP
-                        // Convert to left hand, z-up (unreal)
-                        v.tangent = { v.tangent.z, v.tangent.x, v.tangent.y, v.tangent.w };
-                    #elif COORDINATE_SYSTEM == COORDINATE_SYSTEM_RIGHT_Z_UP
-                        // Convert to right hand, z-up
-                        v.tangent = { v.tangent.x, -v.tangent.z, v.tangent.y, v.tangent.w };
-                    #endif
-                    }
-
-                    if (uv0Index > -1)
-                    {
-                        address = uv0BufferAddress + uv0BufferView.byteOffset + uv0Accessor.byteOffset + (vertexIndex * uv0Stride);
-                        memcpy(&v.uv0, address, uv0Stride);
-                    }
-
-                    // Update the mesh primitive's bounding box
-                    mp.boundingBox.min = rtxgi::Min(mp.boundingBox.min, v.position);
-                    mp.boundingBox.max = rtxgi::Max(mp.boundingBox.max, v.position);
-
-                    mp.vertices.push_back(v);
-                    mesh.numVertices++;
-                }
-
-                // Get the index data
-                // Indices can be either unsigned char, unsigned short, or unsigned long
-                // Converting to full precision for easy use on GPU
-                const uint8_t* baseAddress = indexBufferAddress + indexBufferView.byteOffset + indexAccessor.byteOffset;
-                if (indexStride == 1)
-                {
-                    std::vector<uint8_t> quarter;
-                    quarter.resize(indexAccessor.count);
-
-                    memcpy(quarter.data(), baseAddress, (indexAccessor.count * indexStride));
+                    ParseGLTFPrimitiveGeometry(gltfData, p, mp);
+                    if (sortTriangles) SortTrianglesSpatially(mp);
+                    OptimizeVertexCache(mp, sortTriangles ? 256 : 0);
+                    PackVertices(mp);
+                });
+            }
+        }
+        RunSceneJobs(jobs);
 
-                    // Convert quarter precision indices to full precision
-                    for (size_t i = 0; i < indexAccessor.count; i++)
-                    {
-                        mp.indices[i] = quarter[i];
-                    }
-                }
-                else if (indexStride == 2)
-                {
-                    std::vector<uint16_t> half;
-                    half.resize(indexAccessor.count);
+        // Lay out the primitives' geometry in their mesh's buffers
+        for (Mesh& mesh : scene.meshes)
+        {
+            mesh.numVertices = 0;
+            mesh.numIndices = 0;
 
-                    memcpy(half.data(), baseAddress, (indexAccessor.count * indexStride));
+            // Initialize the mesh bounding box
+            mesh.boundingBox.min = { FLT_MAX, FLT_MAX, FLT_MAX };
+            mesh.boundingBox.max = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
 
-                    // Convert half precision indices to full precision
-                    for (size_t i = 0; i < indexAccessor.count; i++)
-                    {
-                        mp.indices[i] = half[i];
-                    }
-                }
-                else
-                {
-                    memcpy(mp.indices.data(), baseAddress, (indexAccessor.count * indexStride));
-                }
+            uint32_t vertexByteOffset = 0;
+            uint32_t indexByteOffset = 0;
+            for (MeshPrimitive& mp : mesh.primitives)
+            {
+                mp.vertexByteOffset = vertexByteOffset;
+                mp.indexByteOffset = indexByteOffset;
 
                 // Update byte offsets
-                vertexByteOffset += static_cast<uint32_t>(mp.vertices.size()) * sizeof(Graphics::Vertex);
+                vertexByteOffset += static_cast<uint32_t>(mp.packedVertices.size()) * sizeof(Graphics::PackedVertex);
                 indexByteOffset += static_cast<uint32_t>(mp.indices.size()) * sizeof(UINT);
 
-                // Increment the triangle count
-                mesh.numIndices += static_cast<int>(indexAccessor.count);
-                scene.numTriangles += mesh.numIndices / 3;
+                // Update the vertex and index counts
+                mesh.numVertices += static_cast<uint32_t>(mp.packedVertices.size());
+                mesh.numIndices += static_cast<uint32_t>(mp.indices.size());
 
                 // Update the mesh's bounding box
                 mesh.boundingBox.min = rtxgi::Min(mesh.boundingBox.min, mp.boundingBox.min);
                 mesh.boundingBox.max = rtxgi::Max(mesh.boundingBox.max, mp.boundingBox.max);
-
-                // Add the mesh primitive
-                mesh.primitives.push_back(mp);
-
-                geometryIndex++;
             }
-
-            mesh.index = static_cast<int>(scene.meshes.size());
-            scene.meshes.push_back(mesh);
+            scene.numTriangles += mesh.numIndices / 3;
         }
 
         scene.numMeshPrimitives = geometryIndex;
@@ -568,63 +1050,67 @@ namespace Scenes
 
     /**
      * Update the scene mesh's bounding boxes, accounting for the mesh instances and instance transforms.
+     * Each batch of instances reduces its own box, the batches' boxes are then merged into the scene's.
      */
     void UpdateSceneBoundingBoxes(Scene& scene)
     {
-        // Initialize the scene bounding box
-        scene.boundingBox.min = { FLT_MAX, FLT_MAX };
-        scene.boundingBox.max = { -FLT_MAX, -FLT_MAX };
-
-        XMFLOAT4 r3  = XMFLOAT4(0.f, 0.f, 0.f, 1.f);
-        for(uint32_t instanceIndex = 0; instanceIndex < static_cast<uint32_t>(scene.instances.size()); instanceIndex++)
-        {
-            // Get the mesh instance and mesh
-            Scenes::MeshInstance& instance = scene.instances[instanceIndex];
-            const Scenes::Mesh& mesh = scene.meshes[instance.meshIndex];
-
-            // Initialize the mesh instance bounding box
-            instance.boundingBox.min = { FLT_MAX, FLT_MAX };
-            instance.boundingBox.max = { -FLT_MAX, -FLT_MAX };
-
-            // Instance transform rows
-            XMFLOAT4 instanceXformR0 = XMFLOAT4(&instance.transform[0][0]);
-            XMFLOAT4 instanceXformR1 = XMFLOAT4(&instance.transform[1][0]);
-            XMFLOAT4 instanceXformR2 = XMFLOAT4(&instance.transform[2][0]);
-
-            // Instance transform matrix
-            XMMATRIX xform;
-            xform.r[0] = DirectX::XMLoadFloat4(&instanceXformR0);
-            xform.r[1] = DirectX::XMLoadFloat4(&instanceXformR1);
-            xform.r[2] = DirectX::XMLoadFloat4(&instanceXformR2);
-            xform.r[3] = DirectX::XMLoadFloat4(&r3);
-
-            // Remove the transpose (transforms are transposed for copying to GPU)
-            XMMATRIX transpose = XMMatrixTranspose(xform);
+        uint32_t numInstances = static_cast<uint32_t>(scene.instances.size());
+        uint32_t numBatches = (numInstances + parallelBatchSize - 1) / parallelBatchSize;
 
-            // Get the mesh bounding box vertices
-            XMFLOAT3 min = XMFLOAT3(mesh.boundingBox.min.x, mesh.boundingBox.min.y, mesh.boundingBox.min.z);
-            XMFLOAT3 max = XMFLOAT3(mesh.boundingBox.max.x, mesh.boundingBox.max.y, mesh.boundingBox.max.z);
+        rtxgi::AABB empty = { { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } };
+        std::vector<rtxgi::AABB> batchBoxes(numBatches, empty);
 
-            // Transform the mesh bounding box vertices
-            DirectX::XMStoreFloat3(&min, XMVector3Transform(DirectX::XMLoadFloat3(&min), transpose));
-            DirectX::XMStoreFloat3(&max, XMVector3Transform(DirectX::XMLoadFloat3(&max), transpose));
+        ParallelFor(0, numInstances, [&scene, &batchBoxes](uint32_t begin, uint32_t end)
+        {
+            XMVECTOR batchMin = XMVectorReplicate(FLT_MAX);
+            XMVECTOR batchMax = XMVectorReplicate(-FLT_MAX);
+            for (uint32_t instanceIndex = begin; instanceIndex < end; instanceIndex++)
+            {
+                // Get the mesh instance and mesh
+                Scenes::MeshInstance& instance = scene.instances[instanceIndex];
+                const Scenes::Mesh& mesh = scene.meshes[instance.meshIndex];
+
+                // Instance transform matrix, loading the 3x4 rows removes the transpose (transforms are transposed for copying to GPU)
+                XMMATRIX xform = XMLoadFloat3x4(reinterpret_cast<const XMFLOAT3X4*>(instance.transform));
+
+                // Transform the mesh bounding box's center and extents, the extents along each axis are the sum of the absolute
+                // values of the transformed box axes (the box of the 8 transformed corners)
+                XMVECTOR min = XMVectorSet(mesh.boundingBox.min.x, mesh.boundingBox.min.y, mesh.boundingBox.min.z, 1.f);
+                XMVECTOR max = XMVectorSet(mesh.boundingBox.max.x, mesh.boundingBox.max.y, mesh.boundingBox.max.z, 1.f);
+                XMVECTOR center = XMVector3Transform(XMVectorScale(XMVectorAdd(min, max), 0.5f), xform);
+                XMVECTOR extents = XMVectorScale(XMVectorSubtract(max, min), 0.5f);
+                extents = XMVectorMultiplyAdd(XMVectorAbs(xform.r[0]), XMVectorSplatX(extents),
+                          XMVectorMultiplyAdd(XMVectorAbs(xform.r[1]), XMVectorSplatY(extents),
+                          XMVectorMultiply(XMVectorAbs(xform.r[2]), XMVectorSplatZ(extents))));
+
+                // Update the mesh instance bounding box
+                min = XMVectorSubtract(center, extents);
+                max = XMVectorAdd(center, extents);
+                XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(&instance.boundingBox.min), min);
+                XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(&instance.boundingBox.max), max);
+
+                batchMin = XMVectorMin(batchMin, min);
+                batchMax = XMVectorMax(batchMax, max);
+            }
 
-            // Update the mesh instance bounding box
-            instance.boundingBox.min = rtxgi::Min(instance.boundingBox.min, { max.x, max.y, max.z });
-            instance.boundingBox.min = rtxgi::Min(instance.boundingBox.min, { min.x, min.y, min.z });
-            instance.boundingBox.max = rtxgi::Max(instance.boundingBox.max, { max.x, max.y, max.z });
-            instance.boundingBox.max = rtxgi::Max(instance.boundingBox.max, { min.x, min.y, min.z });
+            rtxgi::AABB& batchBox = batchBoxes[begin / parallelBatchSize];
+            XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(&batchBox.min), batchMin);
+            XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(&batchBox.max), batchMax);
+        });
 
-            // Update the scene bounding box
-            scene.boundingBox.min = rtxgi::Min(scene.boundingBox.min, instance.boundingBox.min);
-            scene.boundingBox.max = rtxgi::Max(scene.boundingBox.min, instance.boundingBox.max);
+        // Update the scene bounding box
+        scene.boundingBox = empty;
+        for (const rtxgi::AABB& batchBox : batchBoxes)
+        {
+            scene.boundingBox.min = rtxgi::Min(scene.boundingBox.min, batchBox.min);
+            scene.boundingBox.max = rtxgi::Max(scene.boundingBox.max, batchBox.max);
         }
     }
 
     /**
      * Parse the various data of a GLTF file.
      */
-    bool ParseGLTF(const tinygltf::Model& gltfData, const Configs::Config& config, const bool binary, Scene& scene, std::ofstream& log)
+    bool ParseGLTF(const tinygltf::Model& gltfData, const Configs::Config& config, const bool binary, const Scene& cached, Scene& scene, std::ofstream& log)
     {
         if (binary && gltfData.textures.size() > 0)
         {
@@ -651,11 +1137,15 @@ namespace Scenes
         // Parse Materials
         ParseGLTFMaterials(gltfData, scene);
 
-        // Parse and Load Textures
-        if (!ParseGLFTextures(gltfData, config, scene)) return false;
+        // Parse Textures and load them on worker threads
+        TextureTasks textureTasks;
+        BeginGLTFTextures(gltfData, config, cached, textureTasks);
+
+        // Parse Meshes (in parallel with the texture loads)
+        ParseGLTFMeshes(gltfData, config, cached, scene);
 
-        // Parse Meshes
-        ParseGLTFMeshes(gltfData, scene);
+        // Wait for the texture loads
+        if (!EndGLTFTextures(textureTasks, scene)) return false;
 
         // Update the scene's bounding boxes, based on the instance transforms
         UpdateSceneBoundingBoxes(scene);
@@ -663,6 +1153,44 @@ namespace Scenes
         return true;
     }
 
+    /**
+     * Hash a source file of the scene and add it to the scene's source files.
+     */
+    bool AddSourceFile(const std::string& filepath, Scene& scene)
+    {
+        SourceFile source;
+        source.filepath = filepath;
+        source.stamp = Caches::GetFileStamp(filepath);
+        if (!Caches::HashFile(filepath, source.hash)) return false;
+
+        scene.sources.push_back(source);
+        return true;
+    }
+
+    /**
+     * Check if the scene's glTF, buffer, and texture source files and the geometry settings are unchanged since the scene cache was written.
+     */
+    bool IsCacheCurrent(Scene& scene, const Configs::Config& config)
+    {
+    #if defined(__aarch64__) || defined(_M_ARM64)
+        // Scene textures can't be processed on ARM64, scene caches are used as-is
+        return true;
+    #else
+        if (scene.sortedTriangles != config.scene.sortTriangles) return false;
+
+        for (SourceFile& source : scene.sources)
+        {
+            if (!Caches::IsFileCurrent(source.filepath, source.stamp, source.hash)) return false;
+        }
+
+        for (Textures::Texture& texture : scene.textures)
+        {
+            if (!Caches::IsFileCurrent(texture.filepath, texture.sourceStamp, texture.sourceHash)) return false;
+        }
+        return true;
+    #endif
+    }
+
     /**
      * Adds config specific cameras and lights.
      */
@@ -789,10 +1317,20 @@ namespace Scenes
 
         // Load the scene cache file, if it exists
         std::string sceneCache = config.app.root + config.scene.path + cacheName + ".cache";
+        Scene cached;
         if (Caches::Deserialize(sceneCache, scene, log))
         {
-            ParseConfigCamerasLights(config, scene);
-            return true;
+            if (IsCacheCurrent(scene, config))
+            {
+                ParseConfigCamerasLights(config, scene);
+                return true;
+            }
+
+            // Keep the cached scene, the assets with unchanged source data are reused instead of processed again
+            log << "\n\tScene source files or settings changed, updating the scene cache...";
+            cached = std::move(scene);
+            scene = {};
+            scene.name = config.scene.name;
         }
 
         // Load the scene GLTF (no cache file exists or the existing cache file is invalid)
@@ -823,11 +1361,38 @@ namespace Scenes
             return false;
         }
 
+        // Hash the GLTF file and its buffer files, the scene cache is updated when they change
+        CHECK(AddSourceFile(filepath, scene), "hash scene file!\n", log);
+        for (const tinygltf::Buffer& buffer : gltfData.buffers)
+        {
+            if (buffer.uri.empty() || buffer.uri.compare(0, 5, "data:") == 0) continue;
+            CHECK(AddSourceFile(config.app.root + config.scene.path + ParseURI(buffer.uri), scene), "hash scene buffer file!\n", log);
+        }
+
         // Parse the GLTF data
-        CHECK(ParseGLTF(gltfData, config, binary, scene, log), "parse scene file!\n", log);
+        CHECK(ParseGLTF(gltfData, config, binary, cached, scene, log), "parse scene file!\n", log);
 
         // Serialize the scene and store a cache file to speed up future loads
-        if (!Caches::Serialize(sceneCache, scene, log)) return false;
+        if (cached.cacheData == nullptr)
+        {
+            if (!Caches::Serialize(sceneCache, scene, log)) return false;
+        }
+        else
+        {
+            // Reused textures point into the previous cache file, write the updated cache next to it and load it in its place
+            std::string updatedCache = sceneCache + ".update";
+            if (!Caches::Serialize(updatedCache, scene, log)) return false;
+
+            Cleanup(scene);
+            Cleanup(cached);
+            scene = {};
+            scene.name = config.scene.name;
+
+            std::error_code error;
+            std::filesystem::rename(updatedCache, sceneCache, error);
+            CHECK(!error, "replace scene cache file!\n", log);
+            CHECK(Caches::Deserialize(sceneCache, scene, log), "load updated scene cache file!\n", log);
+        }
 
         // Add config specific cameras and lights
         ParseConfigCamerasLights(config, scene);
@@ -836,46 +1401,52 @@ namespace Scenes
     }
 
     /**
-     * Traverse the scene graph and update the instance transforms.
+     * Update the instance transforms from the scene graph.
+     * The nodes of each depth of the flattened graph are updated in parallel, after the global transforms of their parents.
      */
-    void Traverse(size_t nodeIndex, XMMATRIX transform, Scene& scene)
+    void UpdateTransforms(Scene& scene)
     {
-        // Get the node
-        SceneNode node = scene.nodes[nodeIndex];
+        if (scene.flatNodes.empty()) FlattenNodes(scene);
 
-        // Get the node's local transform
-        XMMATRIX nodeTransform;
-        if(node.hasMatrix)
-        {
-            nodeTransform = node.matrix;
-        }
-        else
+        for (size_t level = 0; (level + 1) < scene.flatLevels.size(); level++)
         {
-            // Compose the node's local transform, M = T * R * S
-            XMMATRIX t = XMMatrixTranslation(node.translation.x, node.translation.y, node.translation.z);
-            XMMATRIX r = XMMatrixRotationQuaternion(XMLoadFloat4(&node.rotation));
-            XMMATRIX s = XMMatrixScaling(node.scale.x, node.scale.y, node.scale.z);    // Note: do not use negative scale factors! This will flip the object inside and cause incorrect normals.
-            nodeTransform = XMMatrixMultiply(XMMatrixMultiply(s, r), t);
-        }
+            ParallelFor(scene.flatLevels[level], scene.flatLevels[level + 1], [&scene](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t flatIndex = begin; flatIndex < end; flatIndex++)
+                {
+                    const SceneNode& node = scene.nodes[scene.flatNodes[flatIndex]];
 
-        // Compose the global transform
-        transform = XMMatrixMultiply(nodeTransform, transform);
+                    // Get the node's local transform
+                    XMMATRIX transform;
+                    if (node.hasMatrix)
+                    {
+                        transform = node.matrix;
+                    }
+                    else
+                    {
+                        // Compose the node's local transform, M = T * R * S
+                        XMMATRIX t = XMMatrixTranslation(node.translation.x, node.translation.y, node.translation.z);
+                        XMMATRIX r = XMMatrixRotationQuaternion(XMLoadFloat4(&node.rotation));
+                        XMMATRIX s = XMMatrixScaling(node.scale.x, node.scale.y, node.scale.z);    // Note: do not use negative scale factors! This will flip the object inside and cause incorrect normals.
+                        transform = XMMatrixMultiply(XMMatrixMultiply(s, r), t);
+                    }
 
-        // When at a leaf node with a mesh, update the mesh instance's transform
-        // Not currently supporting nested transforms for camera nodes
-        if (node.children.size() == 0 && node.instance > -1)
-        {
-            // Update the instance's transform data
-            MeshInstance* instance = &scene.instances[node.instance];
-            XMMATRIX transpose = XMMatrixTranspose(transform);
-            memcpy(instance->transform, &transpose, sizeof(XMFLOAT4) * 3);
-            return;
-        }
+                    // Compose the global transform
+                    int parent = scene.flatParents[flatIndex];
+                    if (parent >= 0) transform = XMMatrixMultiply(transform, scene.worldTransforms[parent]);
+                    scene.worldTransforms[flatIndex] = transform;
 
-        // Recursively traverse the scene graph
-        for (size_t i = 0; i < node.children.size(); i++)
-        {
-            Traverse(node.children[i], transform, scene);
+                    // When at a leaf node with a mesh, update the mesh instance's transform
+                    // Not currently supporting nested transforms for camera nodes
+                    if (node.children.size() == 0 && node.instance > -1)
+                    {
+                        MeshInstance& instance = scene.instances[node.instance];
+                        XMMATRIX transpose = XMMatrixTranspose(transform);
+                        memcpy(instance.transform, &transpose, sizeof(XMFLOAT4) * 3);
+                        instance.dirty = true;
+                    }
+                }
+            });
         }
     }
 
@@ -931,6 +1502,11 @@ namespace Scenes
         {
             Textures::Unload(scene.textures[textureIndex]);
         }
+
+        // Release the memory mapped scene cache file
+        Caches::Unmap(scene);
+
+        sceneWorkers.Stop();
     }
 
 }
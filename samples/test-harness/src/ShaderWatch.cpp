@@ -0,0 +1,140 @@
+/*
+* Copyright (c) 2019-2023, NVIDIA CORPORATION.  All rights reserved.
+*
+* NVIDIA CORPORATION and its licensors retain all intellectual property
+* and proprietary rights in and to this software, related documentation
+* and any modifications thereto.  Any use, reproduction, disclosure or
+* distribution of this software and related documentation without an express
+* license agreement from NVIDIA CORPORATION is strictly prohibited.
+*/
+
+#if defined(_WIN32) || defined(WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+#include <sstream>
+
+#include "ShaderWatch.h"
+
+namespace ShaderWatch
+{
+    // The first line of the shader compiler's notifications
+    static const char* MessageHeader = "ShaderCompiler";
+
+    /**
+     * Listen for the notifications of the shader compiler's watch mode on the given port (loopback only).
+     */
+    bool Open(Listener& listener, uint32_t port, std::ofstream& log)
+    {
+        Close(listener);
+
+    #if defined(_WIN32) || defined(WIN32)
+        WSADATA data;
+        if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+        {
+            log << "\nFailed to initialize Windows sockets!";
+            return false;
+        }
+
+        SOCKET s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (s == INVALID_SOCKET)
+        {
+            WSACleanup();
+            log << "\nFailed to create the shader watch socket!";
+            return false;
+        }
+
+        u_long nonBlocking = 1;
+        ioctlsocket(s, FIONBIO, &nonBlocking);
+        listener.socket = static_cast<intptr_t>(s);
+    #else
+        int s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (s < 0)
+        {
+            log << "\nFailed to create the shader watch socket!";
+            return false;
+        }
+
+        fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+        listener.socket = s;
+    #endif
+
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    #if defined(_WIN32) || defined(WIN32)
+        bool bound = (bind(static_cast<SOCKET>(listener.socket), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0);
+    #else
+        bool bound = (bind(static_cast<int>(listener.socket), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0);
+    #endif
+        if (!bound)
+        {
+            Close(listener);
+            log << "\nFailed to listen for shader changes on port " << port << ", is another instance using it?";
+            return false;
+        }
+
+        listener.port = port;
+        return true;
+    }
+
+    /**
+     * Receive the pending notifications, returns true when shaders were rebuilt.
+     * The source paths are relative to the test harness directory (e.g. shaders/ddgi/ProbeTraceCS.hlsl).
+     */
+    bool Poll(Listener& listener, std::vector<std::string>& sourcePaths)
+    {
+        sourcePaths.clear();
+        if (listener.socket < 0) return false;
+
+        char buffer[65536];
+        while (true)
+        {
+        #if defined(_WIN32) || defined(WIN32)
+            int received = recv(static_cast<SOCKET>(listener.socket), buffer, sizeof(buffer), 0);
+        #else
+            ssize_t received = recv(static_cast<int>(listener.socket), buffer, sizeof(buffer), 0);
+        #endif
+            if (received <= 0) break;
+
+            std::istringstream message(std::string(buffer, static_cast<size_t>(received)));
+            std::string line;
+            if (!std::getline(message, line) || line != MessageHeader) continue;
+
+            while (std::getline(message, line))
+            {
+                if (!line.empty()) sourcePaths.push_back(line);
+            }
+        }
+
+        return !sourcePaths.empty();
+    }
+
+    /**
+     * Stop listening.
+     */
+    void Close(Listener& listener)
+    {
+        if (listener.socket < 0) return;
+
+    #if defined(_WIN32) || defined(WIN32)
+        closesocket(static_cast<SOCKET>(listener.socket));
+        WSACleanup();
+    #else
+        close(static_cast<int>(listener.socket));
+    #endif
+        listener.socket = -1;
+        listener.port = 0;
+    }
+
+}
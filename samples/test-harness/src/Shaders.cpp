@@ -12,9 +12,12 @@
 #include "graphics/UI.h"
 #include "AppLogger.h"
 
-#if __linux__
+#include "HashCache.h"
+#include "IncludeParser.h"
+
+#include <chrono>
+#include <ctime>
 #include <filesystem>
-#endif
 
 namespace Shaders
 {
@@ -67,6 +70,122 @@ namespace Shaders
         return S_OK;
     }
 
+    // Identifies a shader permutation in the shader cache
+    struct ShaderCacheKey
+    {
+        std::string name;                   // source file, entry point, and a hash of the defines, profile, and arguments
+        std::string hash;                   // name plus the contents of the source file and its includes
+        std::string sourcePath;
+        std::vector<std::string> includes;
+        std::vector<std::string> defines;
+        bool spirv = false;
+    };
+
+    std::string ToString(const std::wstring& value)
+    {
+        return std::string(value.begin(), value.end());
+    }
+
+    std::string GetCacheFile(const ShaderCompiler& dxc, const std::string& hash, bool spirv)
+    {
+        return dxc.cachePath + hash + (spirv ? ".spv" : ".dxil");
+    }
+
+    /**
+     * Get the shader cache key of a shader program with its final defines and arguments.
+     */
+    void GetCacheKey(ShaderCompiler& dxc, const ShaderProgram& shader, ShaderCacheKey& key)
+    {
+        std::filesystem::path source = std::filesystem::absolute(shader.filepath);
+        key.sourcePath = source.generic_string();
+
+        // Find the includes of the source file (the include path is relative to the source file, like DXC resolves it)
+        IncludeParser parser;
+        parser.SetCache(dxc.cache);
+        if(!shader.includePath.empty()) parser.AddIncludeDirectory((source.parent_path() / shader.includePath).string());
+        key.includes = parser.ParseDependencies(source.string());
+
+        key.defines.clear();
+        for(const DxcDefine& define : shader.defines)
+        {
+            key.defines.push_back(ToString(define.Name) + "=" + (define.Value ? ToString(define.Value) : ""));
+        }
+
+        std::string arguments = dxc.compilerVersion;
+        for(LPCWSTR argument : shader.arguments)
+        {
+            arguments.append(" " + ToString(argument));
+            if(std::wstring(argument) == L"-spirv") key.spirv = true;
+        }
+
+        std::string profile = ToString(shader.targetProfile);
+        std::string entryPoint = ToString(shader.entryPoint);
+
+        // Name the permutation, its bytecode is replaced when the sources change
+        std::vector<std::string> defines = key.defines;
+        std::sort(defines.begin(), defines.end());
+        uint64_t permutation = Hash::FNV1a(profile + arguments);
+        for(const std::string& define : defines) permutation = Hash::Combine(permutation, Hash::FNV1a(define));
+        key.name = key.sourcePath + ":" + entryPoint + ":" + Hash::ToHexString(permutation);
+
+        // Hash the permutation with the sources
+        std::string sourceHash = Hash::ComputeShaderHash(key.sourcePath, key.includes, key.defines, profile, entryPoint,
+            [&dxc](const std::string& path) { return dxc.cache->GetFileHash(path); });
+        key.hash = Hash::ToHexString(Hash::Combine(std::stoull(sourceHash, nullptr, 16), permutation));
+    }
+
+    /**
+     * Load a shader program's bytecode from the shader cache, if the cache has the current version of the permutation.
+     */
+    bool LoadCachedShader(ShaderCompiler& dxc, ShaderProgram& shader, const ShaderCacheKey& key)
+    {
+        if(dxc.cache->GetCachedHash(key.name) != key.hash) return false;
+
+        std::ifstream file(GetCacheFile(dxc, key.hash, key.spirv), std::ios::binary);
+        if(!file.is_open()) return false;
+
+        std::vector<char> bytecode((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if(bytecode.empty()) return false;
+
+        IDxcBlobEncoding* blob = nullptr;
+        if(FAILED(dxc.utils->CreateBlob(bytecode.data(), static_cast<UINT32>(bytecode.size()), DXC_CP_ACP, &blob))) return false;
+
+        shader.bytecode = blob;
+        return true;
+    }
+
+    /**
+     * Write a compiled shader program's bytecode to the shader cache.
+     */
+    void StoreCachedShader(ShaderCompiler& dxc, const ShaderProgram& shader, const ShaderCacheKey& key)
+    {
+        // Remove the bytecode of the permutation's previous version
+        std::error_code ec;
+        std::string previous = dxc.cache->GetCachedHash(key.name);
+        if(!previous.empty() && previous != key.hash) std::filesystem::remove(GetCacheFile(dxc, previous, key.spirv), ec);
+
+        std::string filepath = GetCacheFile(dxc, key.hash, key.spirv);
+        std::ofstream file(filepath, std::ios::binary);
+        if(!file.is_open()) return;
+        file.write(static_cast<const char*>(shader.bytecode->GetBufferPointer()), shader.bytecode->GetBufferSize());
+        file.close();
+        if(file.fail()) return;
+
+        std::time_t time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        char timestamp[64];
+        std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&time));
+
+        ShaderCacheEntry entry;
+        entry.hash = key.hash;
+        entry.sourcePath = key.sourcePath;
+        entry.includes = key.includes;
+        entry.defines = key.defines;
+        if(key.spirv) entry.outputSpirv = filepath;
+        else entry.outputDxil = filepath;
+        entry.lastCompiled = timestamp;
+        dxc.cache->UpdateEntry(key.name, entry);
+    }
+
     //----------------------------------------------------------------------------------------------------------
     // Public Functions
     //----------------------------------------------------------------------------------------------------------
@@ -92,6 +211,27 @@ namespace Shaders
         dxc.root = config.app.root;
         dxc.rtxgi = config.app.rtxgi;
 
+        // Load the shader cache index, the compiler version is part of every cache key
+        if(dxc.config.cache)
+        {
+            IDxcVersionInfo* versionInfo = nullptr;
+            if(SUCCEEDED(dxc.compiler->QueryInterface(IID_PPV_ARGS(&versionInfo))))
+            {
+                UINT32 major = 0, minor = 0;
+                versionInfo->GetVersion(&major, &minor);
+                dxc.compilerVersion = std::to_string(major) + "." + std::to_string(minor);
+                SAFE_RELEASE(versionInfo);
+            }
+
+            std::error_code ec;
+            dxc.cachePath = dxc.root + "shadercache/";
+            std::filesystem::create_directories(dxc.cachePath, ec);
+
+            dxc.cache = new HashCache();
+            dxc.cache->Load(dxc.cachePath + "cache.bin");
+            dxc.cache->SetCompilerVersion(dxc.compilerVersion);
+        }
+
         return true;
     }
 
@@ -160,6 +300,15 @@ namespace Shaders
                 shader.arguments.push_back(arg.c_str());
             }
 
+            // Load the shader from the shader cache when its sources, defines, and arguments are unchanged
+            ShaderCacheKey key;
+            if(dxc.cache)
+            {
+                dxc.cache->RevalidateFiles(); // sources may have been edited since the last compile (shader reloads and retries)
+                GetCacheKey(dxc, shader, key);
+                if(LoadCachedShader(dxc, shader, key)) return true;
+            }
+
             // Build the arguments array
             IDxcCompilerArgs* args = nullptr;
             dxc.utils->BuildArguments(
@@ -211,21 +360,59 @@ namespace Shaders
 
             // Get the shader bytecode
             if(FAILED(result->GetOutput(DXC_OUT_OBJECT, IID_PPV_ARGS(&shader.bytecode), &shader.shaderName))) return false;
+
+            if(dxc.cache) StoreCachedShader(dxc, shader, key);
         }
         return true;
     }
 
+    /**
+     * Compile a shader, or reuse the bytecode of an identical permutation compiled earlier in the batch.
+     */
+    bool Compile(ShaderCompiler& dxc, ShaderProgram& shader, ShaderPermutations& permutations, bool warningsAsErrors)
+    {
+        // Name the permutation by its source, entry point, arguments, and (sorted) defines
+        std::vector<std::wstring> defines;
+        for(const DxcDefine& define : shader.defines)
+        {
+            defines.push_back(std::wstring(define.Name) + L"=" + (define.Value ? define.Value : L""));
+        }
+        std::sort(defines.begin(), defines.end());
+
+        std::wstring key = shader.filepath + L"|" + shader.entryPoint + L"|" + shader.targetProfile + L"|" + shader.includePath + L"|" + (warningsAsErrors ? L"1" : L"0");
+        for(LPCWSTR argument : shader.arguments) key.append(L"|" + std::wstring(argument));
+        for(const std::wstring& define : defines) key.append(L"|" + define);
+
+        auto it = permutations.bytecode.find(key);
+        if(it != permutations.bytecode.end())
+        {
+            shader.bytecode = it->second;
+            shader.bytecode->AddRef();
+            permutations.hits++;
+            return true;
+        }
+
+        if(!Compile(dxc, shader, warningsAsErrors)) return false;
+
+        shader.bytecode->AddRef();
+        permutations.bytecode[key] = shader.bytecode;
+        return true;
+    }
+
     /**
      * Release memory used by the shader compiler.
      */
     void Cleanup(ShaderCompiler& dxc)
     {
+        if(dxc.cache) dxc.cache->Save(dxc.cachePath + "cache.bin");
+        SAFE_DELETE(dxc.cache);
         SAFE_RELEASE(dxc.utils);
         SAFE_RELEASE(dxc.compiler);
         SAFE_RELEASE(dxc.includes);
         UnloadDirectXCompiler(dxc);
         dxc.root = "";
         dxc.rtxgi = "";
+        dxc.cachePath = "";
     }
 
 }
@@ -20,11 +20,18 @@
 #include <stb_image.h>
 
 #include "Textures.h"
+#include "Caches.h"
 #include "UI.h"
 
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <mutex>
+
 #if defined(GPU_COMPRESSION)
 #include <d3d11.h>
-static ID3D11Device* d3d11Device = nullptr;
+#include <memory>
+#include <wrl/client.h>
 #endif
 
 #if __linux__
@@ -37,6 +44,17 @@ static ID3D11Device* d3d11Device = nullptr;
 #pragma GCC diagnostic pop
 #endif
 
+#if defined(GFX_BASIS_TRANSCODER)
+#include <basisu_transcoder.h>
+#endif
+
+#if defined(GPU_COMPRESSION)
+#include "thirdparty/directxtex/BCDirectCompute.h"
+static ID3D11Device* d3d11Device = nullptr;                   // null when no hardware device exists, compression falls back to the CPU
+static std::unique_ptr<DirectX::GPUCompressBC> bc7Compressor; // created once, its compute shaders are shared by every scene texture
+static std::mutex d3d11DeviceMutex;                           // textures are compressed on several threads, the D3D11 immediate context is not thread safe
+#endif
+
 using namespace DirectX;
 
 namespace Textures
@@ -92,99 +110,304 @@ namespace Textures
         return (texture.texelBytes > 0);
     }
 
-#if defined(__x86_64__) || defined(_M_X64)
+    // A mip level of BC7 blocks, rowPitch bytes between its rows of blocks
+    struct BC7Mip
+    {
+        const uint8_t* blocks = nullptr;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        size_t rowPitch = 0;
+    };
+
     /**
-     * Copy a compressed BC7 texture into our format, aligned for GPU use.
+     * Copy the mip levels of a BC7 texture into our format, aligned for GPU use:
+     * the placed footprints of the mip levels (rows of blocks 256 byte aligned, mip levels 512 byte aligned).
      */
-    bool FormatCompressedTexture(ScratchImage& src, Texture& dst)
+    bool FormatBC7Texture(const BC7Mip* mips, uint32_t numMips, Texture& dst)
     {
-        bool result = false;
-
-        // Get the texture's metadata
-        const TexMetadata metadata = src.GetMetadata();
+        if (numMips == 0 || mips[0].width == 0 || mips[0].height == 0) return false;
 
-        // Check if the texture's format is supported
-        if (metadata.format != DXGI_FORMAT_BC7_UNORM && metadata.format != DXGI_FORMAT_BC7_UNORM_SRGB && metadata.format != DXGI_FORMAT_BC7_TYPELESS)
-        {
-            std::string msg = "Error: unsupported compressed texture format for: \'" + dst.name + "\' \'" + dst.filepath + "\'\n. Compressed textures must be in BC7 format";
-            Graphics::UI::MessageBox(msg);
-            return false;
-        }
-
-        // Set texture data
-        dst.width = static_cast<int>(metadata.width);
-        dst.height = static_cast<int>(metadata.height);
+        dst.width = mips[0].width;
+        dst.height = mips[0].height;
         dst.stride = 1;
-        dst.mips = static_cast<int>(metadata.mipLevels);
-        dst.texelBytes = 0;
+        dst.mips = numMips;
+        dst.format = ETextureFormat::BC7;
 
         // Compute the total size of the texture in bytes (including alignment).
         // Note: BC7 uses fixed block sizes of 4x4 texels with 16 bytes per block, 1 byte per texel.
-        for (uint32_t mipIndex = 0; mipIndex < dst.mips; mipIndex++)
+        // The last mip level of a mip chain ends after its last row of blocks (like its copyable footprint).
+        uint64_t texelBytes = 0;
+        for (uint32_t mipIndex = 0; mipIndex < numMips; mipIndex++)
         {
-            // Compute the size of the mip level and add it to the total aligned memory size
-            const Image* image = src.GetImage(mipIndex, 0, 0);
-
-            uint32_t alignedWidth = ALIGN(4, static_cast<uint32_t>(image->width));
-            uint32_t alignedHeight = ALIGN(4, static_cast<uint32_t>(image->height));
-
-            // Add the size of the last mip (one texel)
-            if (dst.mips > 1 && (mipIndex + 1) == dst.mips)
+            uint32_t alignedWidth = ALIGN(4, mips[mipIndex].width);
+            uint32_t alignedHeight = ALIGN(4, mips[mipIndex].height);
+            if (numMips > 1 && (mipIndex + 1) == numMips)
             {
-                dst.texelBytes += 16; // BC7 blocks are 16 bytes
+                texelBytes += static_cast<uint64_t>((alignedHeight / 4) - 1) * ALIGN(256, alignedWidth * 4) + (alignedWidth * 4);
                 break;
             }
-
-            // Get the aligned memory size in bytes of the mip level and add it to the texture memory total
-            dst.texelBytes += GetBC7TextureSizeInBytes(alignedWidth, alignedHeight);
+            texelBytes += GetBC7TextureSizeInBytes(alignedWidth, alignedHeight);
         }
 
-        if (dst.texelBytes > 0)
+        if (dst.texels && !dst.mapped) delete[] dst.texels;
+        dst.mapped = false;
+        dst.texelBytes = texelBytes;
+        dst.texels = new uint8_t[texelBytes];
+        memset(dst.texels, 0, texelBytes);
+
+        // Copy each row of blocks of each mip level, padding for alignment
+        size_t alignedOffset = 0;
+        for (uint32_t mipIndex = 0; mipIndex < numMips; mipIndex++)
         {
-            // Delete existing texels
-            if(dst.texels)
+            const BC7Mip& mip = mips[mipIndex];
+            uint32_t rowBytes = (ALIGN(4, mip.width) / 4) * 16;
+            uint32_t numRows = ALIGN(4, mip.height) / 4;
+            for (uint32_t rowIndex = 0; rowIndex < numRows; rowIndex++)
             {
-                delete[] dst.texels;
-                dst.texels = nullptr;
+                memcpy(&dst.texels[alignedOffset + (rowIndex * ALIGN(256, rowBytes))], mip.blocks + (rowIndex * mip.rowPitch), rowBytes);
             }
+            alignedOffset = ALIGN(512, alignedOffset + (numRows * ALIGN(256, rowBytes)));
+        }
 
-            // Copy each aligned mip level to the texel array
-            size_t alignedOffset = 0;
-            dst.texels = new uint8_t[dst.texelBytes];
-            memset(dst.texels, 0, dst.texelBytes);
-            for (uint32_t mipIndex = 0; mipIndex < dst.mips; mipIndex++)
-            {
-                size_t offset = 0;
-                const Image* image = src.GetImage(mipIndex, 0, 0);
+        return true;
+    }
 
-                uint32_t alignedHeight = ALIGN(4, static_cast<uint32_t>(image->height));
+    // DDS and KTX2 file layouts, see https://learn.microsoft.com/windows/win32/direct3ddds/dds-header and https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html
+    static const uint32_t DDSMagic = 0x20534444;                // "DDS "
+    static const uint32_t DDSFourCCDX10 = 0x30315844;           // "DX10"
+    static const uint32_t DDSPixelFormatFourCC = 0x4;
+    static const uint8_t KTX2Identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+    static const uint32_t KTX2FormatBC7 = 145;                  // VK_FORMAT_BC7_UNORM_BLOCK
+    static const uint32_t KTX2FormatBC7SRGB = 146;              // VK_FORMAT_BC7_SRGB_BLOCK
 
-                // Copy the last mip level / block
-                if (dst.mips > 1 && (mipIndex + 1) == dst.mips)
-                {
-                    memcpy(&dst.texels[alignedOffset], &image->pixels[offset], image->rowPitch);
-                    alignedOffset += image->rowPitch;
-                    assert(dst.texelBytes == alignedOffset);
-                    break;
-                }
+    uint32_t ReadUint32(const uint8_t* data) { uint32_t value; memcpy(&value, data, sizeof(value)); return value; }
+    uint64_t ReadUint64(const uint8_t* data) { uint64_t value; memcpy(&value, data, sizeof(value)); return value; }
 
-                // Copy each row of the mip texture, padding for alignment
-                size_t numRows = alignedHeight / 4;
-                for (uint32_t rowIndex = 0; rowIndex < numRows; rowIndex++)
-                {
-                    memcpy(&dst.texels[alignedOffset], &image->pixels[offset], image->rowPitch);
-                    offset += image->rowPitch;
-                    alignedOffset += ALIGN(256, image->rowPitch);
-                }
+    /**
+     * Parse the BC7 mip levels of a DDS file (with a DX10 header), pointing into the file data.
+     */
+    bool ParseDDS(const uint8_t* data, uint64_t size, std::vector<BC7Mip>& mips)
+    {
+        const uint64_t headerSize = 4 + 124 + 20;    // magic, DDS_HEADER, DDS_HEADER_DXT10
+        if (size < headerSize || ReadUint32(data) != DDSMagic) return false;
+
+        const uint8_t* header = data + 4;
+        uint32_t height = ReadUint32(header + 8);
+        uint32_t width = ReadUint32(header + 12);
+        uint32_t mipCount = (std::max)(ReadUint32(header + 24), 1u);
+        uint32_t pixelFormatFlags = ReadUint32(header + 76);
+        uint32_t fourCC = ReadUint32(header + 80);
+        if (!(pixelFormatFlags & DDSPixelFormatFourCC) || fourCC != DDSFourCCDX10) return false;
+
+        const uint8_t* dx10 = header + 124;
+        uint32_t format = ReadUint32(dx10);
+        uint32_t dimension = ReadUint32(dx10 + 4);
+        uint32_t arraySize = ReadUint32(dx10 + 12);
+        if (format != DXGI_FORMAT_BC7_TYPELESS && format != DXGI_FORMAT_BC7_UNORM && format != DXGI_FORMAT_BC7_UNORM_SRGB) return false;
+        if (dimension != 3 || arraySize > 1) return false;    // D3D10_RESOURCE_DIMENSION_TEXTURE2D, not an array
+
+        // The mip levels are tightly packed
+        uint64_t offset = headerSize;
+        for (uint32_t mipIndex = 0; mipIndex < mipCount; mipIndex++)
+        {
+            BC7Mip mip;
+            mip.width = (std::max)(width >> mipIndex, 1u);
+            mip.height = (std::max)(height >> mipIndex, 1u);
+            mip.rowPitch = (ALIGN(4, mip.width) / 4) * 16;
+            mip.blocks = data + offset;
+
+            offset += mip.rowPitch * (ALIGN(4, mip.height) / 4);
+            if (offset > size) return false;
+            mips.push_back(mip);
+        }
+        return true;
+    }
 
-                alignedOffset = ALIGN(512, alignedOffset);
-            }
-            result =  true;
+    /**
+     * Parse the BC7 mip levels of a KTX2 file (without supercompression), pointing into the file data.
+     */
+    bool ParseKTX2(const uint8_t* data, uint64_t size, std::vector<BC7Mip>& mips)
+    {
+        const uint64_t levelIndexOffset = 80;        // identifier, header, and index
+        if (size < levelIndexOffset || memcmp(data, KTX2Identifier, sizeof(KTX2Identifier)) != 0) return false;
+
+        uint32_t format = ReadUint32(data + 12);
+        uint32_t width = ReadUint32(data + 20);
+        uint32_t height = ReadUint32(data + 24);
+        uint32_t depth = ReadUint32(data + 28);
+        uint32_t layerCount = ReadUint32(data + 32);
+        uint32_t faceCount = ReadUint32(data + 36);
+        uint32_t levelCount = (std::max)(ReadUint32(data + 40), 1u);
+        uint32_t supercompression = ReadUint32(data + 44);
+        if (format != KTX2FormatBC7 && format != KTX2FormatBC7SRGB) return false;
+        if (supercompression != 0 || depth > 1 || layerCount > 1 || faceCount != 1) return false;
+        if (size < levelIndexOffset + (levelCount * 24)) return false;
+
+        // The level index starts with the base mip level
+        for (uint32_t mipIndex = 0; mipIndex < levelCount; mipIndex++)
+        {
+            const uint8_t* level = data + levelIndexOffset + (mipIndex * 24);
+            uint64_t byteOffset = ReadUint64(level);
+            uint64_t byteLength = ReadUint64(level + 8);
+
+            BC7Mip mip;
+            mip.width = (std::max)(width >> mipIndex, 1u);
+            mip.height = (std::max)(height >> mipIndex, 1u);
+            mip.rowPitch = (ALIGN(4, mip.width) / 4) * 16;
+            mip.blocks = data + byteOffset;
+            if (byteLength < mip.rowPitch * (ALIGN(4, mip.height) / 4) || byteOffset > size || byteLength > size - byteOffset) return false;
+            mips.push_back(mip);
+        }
+        return true;
+    }
+
+#if defined(GFX_BASIS_TRANSCODER)
+    /**
+     * Transcode a Basis Universal (UASTC or ETC1S) KTX2 file to BC7 mip levels.
+     */
+    bool TranscodeKTX2(const uint8_t* data, uint64_t size, std::vector<std::vector<uint8_t>>& levels, std::vector<BC7Mip>& mips)
+    {
+        static std::once_flag initialized;
+        std::call_once(initialized, []() { basist::basisu_transcoder_init(); });
+
+        basist::ktx2_transcoder transcoder;
+        if (!transcoder.init(data, static_cast<uint32_t>(size)) || !transcoder.start_transcoding()) return false;
+        if (transcoder.get_layers() > 1 || transcoder.get_faces() > 1) return false;
+
+        uint32_t levelCount = (std::max)(transcoder.get_levels(), 1u);
+        levels.resize(levelCount);
+        for (uint32_t mipIndex = 0; mipIndex < levelCount; mipIndex++)
+        {
+            basist::ktx2_image_level_info info;
+            if (!transcoder.get_image_level_info(info, mipIndex, 0, 0)) return false;
+
+            levels[mipIndex].resize(static_cast<size_t>(info.m_total_blocks) * 16);
+            if (!transcoder.transcode_image_level(mipIndex, 0, 0, levels[mipIndex].data(), info.m_total_blocks, basist::transcoder_texture_format::cTFBC7_RGBA)) return false;
+
+            BC7Mip mip;
+            mip.width = info.m_orig_width;
+            mip.height = info.m_orig_height;
+            mip.rowPitch = static_cast<size_t>(info.m_num_blocks_x) * 16;
+            mip.blocks = levels[mipIndex].data();
+            mips.push_back(mip);
+        }
+        return true;
+    }
+#endif
+
+    /**
+     * Load a pre-compressed BC7 texture from a DDS or KTX2 file. The file is memory mapped and its mip levels are
+     * copied straight into our aligned format (no intermediate images). KTX2 files with Basis Universal textures
+     * are transcoded to BC7 when the transcoder is built in (GFX_BASIS_TRANSCODER).
+     */
+    bool LoadPrecompressed(Texture& texture)
+    {
+        uint8_t* data = nullptr;
+        uint64_t size = 0;
+        if (!Caches::MapFile(texture.filepath, &data, &size))
+        {
+            std::string msg = "Error: failed to load texture: \'" + texture.name + "\' \'" + texture.filepath + "\'";
+            Graphics::UI::MessageBox(msg);
+            return false;
+        }
+
+        std::vector<BC7Mip> mips;
+        std::vector<std::vector<uint8_t>> transcoded;
+        bool ktx2 = (size >= sizeof(KTX2Identifier) && memcmp(data, KTX2Identifier, sizeof(KTX2Identifier)) == 0);
+        bool parsed = ktx2 ? ParseKTX2(data, size, mips) : ParseDDS(data, size, mips);
+    #if defined(GFX_BASIS_TRANSCODER)
+        if (!parsed && ktx2)
+        {
+            mips.clear();
+            parsed = TranscodeKTX2(data, size, transcoded, mips);
+        }
+    #endif
+
+        bool result = parsed && FormatBC7Texture(mips.data(), static_cast<uint32_t>(mips.size()), texture);
+        Caches::UnmapFile(data, size);
+
+        if (!result)
+        {
+            std::string msg = "Error: unsupported compressed texture format for: \'" + texture.name + "\' \'" + texture.filepath + "\'\n. Compressed textures must be 2D BC7 DDS (with a DX10 header) or KTX2 files";
+        #if defined(GFX_BASIS_TRANSCODER)
+            msg += ", or Basis Universal KTX2 files";
+        #endif
+            Graphics::UI::MessageBox(msg);
+        }
+        return result;
+    }
+
+    /**
+     * Check if a texture file is a pre-compressed DDS or KTX2 file (by extension).
+     */
+    bool IsPrecompressed(const std::string& filepath)
+    {
+        std::string extension = std::filesystem::path(filepath).extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return (extension == ".dds" || extension == ".ktx2");
+    }
+
+#if defined(__x86_64__) || defined(_M_X64)
+    /**
+     * Copy a compressed BC7 texture into our format, aligned for GPU use.
+     */
+    bool FormatCompressedTexture(ScratchImage& src, Texture& dst)
+    {
+        // Get the texture's metadata
+        const TexMetadata metadata = src.GetMetadata();
+
+        // Check if the texture's format is supported
+        if (metadata.format != DXGI_FORMAT_BC7_UNORM && metadata.format != DXGI_FORMAT_BC7_UNORM_SRGB && metadata.format != DXGI_FORMAT_BC7_TYPELESS)
+        {
+            std::string msg = "Error: unsupported compressed texture format for: \'" + dst.name + "\' \'" + dst.filepath + "\'\n. Compressed textures must be in BC7 format";
+            Graphics::UI::MessageBox(msg);
+            return false;
+        }
+
+        std::vector<BC7Mip> mips(metadata.mipLevels);
+        for (uint32_t mipIndex = 0; mipIndex < static_cast<uint32_t>(metadata.mipLevels); mipIndex++)
+        {
+            const Image* image = src.GetImage(mipIndex, 0, 0);
+            mips[mipIndex] = { image->pixels, static_cast<uint32_t>(image->width), static_cast<uint32_t>(image->height), image->rowPitch };
         }
 
+        bool result = FormatBC7Texture(mips.data(), static_cast<uint32_t>(mips.size()), dst);
         src.Release();
         return result;
     }
+
+    /**
+     * Compress R8G8B8A8_UNORM 2D images (a mip chain) to BC7 format.
+     * Uses the shared GPU compressor when a D3D11 device exists, otherwise compresses on the CPU.
+     */
+    bool CompressBC7(const Image* images, size_t numImages, const TexMetadata& metadata, TEX_COMPRESS_FLAGS flags, ScratchImage& compressed)
+    {
+    #ifdef GPU_COMPRESSION
+        if (bc7Compressor && metadata.format == bc7Compressor->GetSourceFormat())
+        {
+            TexMetadata compressedMetadata = metadata;
+            compressedMetadata.format = DXGI_FORMAT_BC7_UNORM;
+            if (FAILED(compressed.Initialize(compressedMetadata)) || compressed.GetImageCount() != numImages) return false;
+
+            // Compress the mips back to back, the compressor only reallocates its buffers when the mip dimensions change
+            std::lock_guard<std::mutex> lock(d3d11DeviceMutex);
+            const Image* destination = compressed.GetImages();
+            for (size_t imageIndex = 0; imageIndex < numImages; imageIndex++)
+            {
+                if (FAILED(bc7Compressor->Prepare(images[imageIndex].width, images[imageIndex].height, flags, DXGI_FORMAT_BC7_UNORM, 1.f))) return false;
+                if (FAILED(bc7Compressor->Compress(images[imageIndex], destination[imageIndex]))) return false;
+            }
+            return true;
+        }
+        if (d3d11Device)
+        {
+            std::lock_guard<std::mutex> lock(d3d11DeviceMutex);
+            return SUCCEEDED(DirectX::Compress(d3d11Device, images, numImages, metadata, DXGI_FORMAT_BC7_UNORM, flags, 1.f, compressed));
+        }
+    #endif
+        flags |= TEX_COMPRESS_PARALLEL;
+        return SUCCEEDED(DirectX::Compress(images, numImages, metadata, DXGI_FORMAT_BC7_UNORM, flags, TEX_THRESHOLD_DEFAULT, compressed));
+    }
 #endif
 
     //----------------------------------------------------------------------------------------------------------
@@ -193,28 +416,78 @@ namespace Textures
 
 #if defined(GPU_COMPRESSION)
     /**
-     * Creates a D3D11Device for use with DirectXTex to compress textures with the GPU.
+     * Creates a D3D11Device and BC7 compressor for use with DirectXTex to compress textures with the GPU.
+     * Without a hardware device (e.g. headless machines), textures are compressed on the CPU instead.
      */
     bool Initialize()
     {
         D3D_FEATURE_LEVEL requested = D3D_FEATURE_LEVEL_11_1;
         D3D_FEATURE_LEVEL supported;
-        if(FAILED(D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, 0, &requested, 1, D3D11_SDK_VERSION, &d3d11Device, &supported, nullptr))) return false;
+        if(FAILED(D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, 0, &requested, 1, D3D11_SDK_VERSION, &d3d11Device, &supported, nullptr))) return true;
+
+        bc7Compressor = std::make_unique<GPUCompressBC>();
+        if (FAILED(bc7Compressor->Initialize(d3d11Device)) || FAILED(bc7Compressor->Prepare(4, 4, TEX_COMPRESS_DEFAULT, DXGI_FORMAT_BC7_UNORM, 1.f)))
+        {
+            // Use DirectXTex's per call compressor instead
+            bc7Compressor.reset();
+        }
         return true;
     }
 
     void Cleanup()
     {
+        bc7Compressor.reset();
         SAFE_RELEASE(d3d11Device);
     }
+
+    /**
+     * Compress an HDR image (of any format DirectXTex converts) to BC6H (unsigned) format with the GPU.
+     * Appends the compressed blocks to compressed, tightly packed (16 bytes per 4x4 texel block).
+     */
+    bool CompressBC6H(uint32_t width, uint32_t height, uint32_t format, size_t rowPitch, const uint8_t* texels, std::vector<uint8_t>& compressed)
+    {
+        // BC6H textures must be aligned to 4x4 texel blocks
+        if (width % 4 != 0 || height % 4 != 0) return false;
+
+        Image source = {};
+        source.width = width;
+        source.height = height;
+        source.rowPitch = rowPitch;
+        source.slicePitch = (rowPitch * height);
+        source.format = static_cast<DXGI_FORMAT>(format);
+        source.pixels = const_cast<uint8_t*>(texels);
+
+        ScratchImage destination;
+        if (d3d11Device == nullptr) return false;
+        {
+            std::lock_guard<std::mutex> lock(d3d11DeviceMutex);
+            if (FAILED(DirectX::Compress(d3d11Device, source, DXGI_FORMAT_BC6H_UF16, TEX_COMPRESS_DEFAULT, 1.f, destination))) return false;
+        }
+
+        // Copy the block rows, removing any row pitch padding
+        const Image* image = destination.GetImage(0, 0, 0);
+        size_t blockRowSize = (width / 4) * 16;
+        size_t offset = compressed.size();
+        compressed.resize(offset + (blockRowSize * (height / 4)));
+        for (uint32_t row = 0; row < (height / 4); row++)
+        {
+            memcpy(&compressed[offset + (row * blockRowSize)], image->pixels + (row * image->rowPitch), blockRowSize);
+        }
+
+        destination.Release();
+        return true;
+    }
 #endif
 
     /**
      * Load a texture file from disk.
      * Supports uncompressed R8G8B8A8_UNORM textures without mipmaps and BC7 compressed textures with or without mipmaps.
+     * DDS and KTX2 files are loaded as BC7 compressed textures.
      */
     bool Load(Texture& texture)
     {
+        if (IsPrecompressed(texture.filepath)) texture.format = ETextureFormat::BC7;
+
         if(texture.format == ETextureFormat::UNCOMPRESSED)
         {
             // Load the uncompressed texture with stb_image (require 4 component RGBA)
@@ -232,30 +505,11 @@ namespace Textures
             // Prep the texture for compression and use on the GPU
             return FormatTexture(texture);
         }
-    #if defined(__x86_64__) || defined(_M_X64)
         else if(texture.format == ETextureFormat::BC7)
         {
-            // Load the compressed texture from a DDS file
-            ScratchImage dds = {};
-            if(FAILED(LoadFromDDSFile(std::wstring(texture.filepath.begin(), texture.filepath.end()).c_str(), DDS_FLAGS_NONE, nullptr, dds)))
-            {
-                std::string msg = "Error: failed to load texture: \'" + texture.name + "\' \'" + texture.filepath + "\'\n.";
-                Graphics::UI::MessageBox(msg);
-                return false;
-            }
-
-            // Ensure the texture format is compressed as BC7
-            if(dds.GetMetadata().format != DXGI_FORMAT_BC7_UNORM)
-            {
-                std::string msg = "Error: loaded texture is not in BC7 (UNORM) format!";
-                Graphics::UI::MessageBox(msg);
-                return false;
-            }
-
-            // Copy the texture into our format, prepping it for upload to the GPU
-            return FormatCompressedTexture(dds, texture);
+            // Load the compressed texture from a DDS or KTX2 file
+            return LoadPrecompressed(texture);
         }
-    #endif
         return false;
     }
 
@@ -284,14 +538,18 @@ namespace Textures
         TEX_COMPRESS_FLAGS flags = TEX_COMPRESS_DEFAULT;
         if(quick) flags = TEX_COMPRESS_BC7_QUICK;
 
+        TexMetadata metadata = {};
+        metadata.width = source.width;
+        metadata.height = source.height;
+        metadata.depth = 1;
+        metadata.arraySize = 1;
+        metadata.mipLevels = 1;
+        metadata.format = source.format;
+        metadata.dimension = TEX_DIMENSION_TEXTURE2D;
+
         // Compress the source image to BC7 format
         ScratchImage destination;
-    #ifdef GPU_COMPRESSION
-        if (FAILED(DirectX::Compress(d3d11Device, source, DXGI_FORMAT_BC7_UNORM, flags, 1.f, destination))) return false;
-    #else
-        flags |= TEX_COMPRESS_PARALLEL;
-        if (FAILED(DirectX::Compress(source, DXGI_FORMAT_BC7_UNORM, flags, TEX_THRESHOLD_DEFAULT, destination))) return false;
-    #endif
+        if (!CompressBC7(&source, 1, metadata, flags, destination)) return false;
 
         // The image is now compressed, change the format descriptor
         texture.format = ETextureFormat::BC7;
@@ -330,12 +588,7 @@ namespace Textures
 
         // Compress the mip chain to BC7 format
         ScratchImage compressed;
-    #ifdef GPU_COMPRESSION
-        if (FAILED(DirectX::Compress(d3d11Device, mips.GetImages(), mips.GetImageCount(), mips.GetMetadata(), DXGI_FORMAT_BC7_UNORM, flags, 1.f, compressed))) return false;
-    #else
-        flags |= TEX_COMPRESS_PARALLEL;
-        if (FAILED(DirectX::Compress(mips.GetImages(), mips.GetImageCount(), mips.GetMetadata(), DXGI_FORMAT_BC7_UNORM, flags, TEX_THRESHOLD_DEFAULT, compressed))) return false;
-    #endif
+        if (!CompressBC7(mips.GetImages(), mips.GetImageCount(), mips.GetMetadata(), flags, compressed)) return false;
 
         mips.Release();
         texture.format = ETextureFormat::BC7;
@@ -351,7 +604,7 @@ namespace Textures
      */
     void Unload(Texture& texture)
     {
-        delete[] texture.texels;
+        if (!texture.mapped) delete[] texture.texels;
         texture = {};
     }
 
@@ -367,4 +620,159 @@ namespace Textures
         return ALIGN(512, numRows * ALIGN(256, rowPitch));
     }
 
+    /**
+     * Get the R8G8B8A8_UNORM texels of a texture's mip level.
+     * Uncompressed textures (stored without mipmaps) box filter their top mip level down to the mip level's dimensions.
+     * BC7 textures decode the mip level's blocks.
+     */
+    bool GetMipTexels(const Texture& texture, uint32_t mip, std::vector<uint8_t>& texels, uint32_t& width, uint32_t& height)
+    {
+        if (!texture.texels || texture.width == 0 || texture.height == 0) return false;
+
+        width = (std::max)(texture.width >> mip, 1u);
+        height = (std::max)(texture.height >> mip, 1u);
+        texels.resize(static_cast<size_t>(width) * height * 4);
+
+        if (texture.format == ETextureFormat::UNCOMPRESSED)
+        {
+            uint32_t footprintX = (texture.width / width);
+            uint32_t footprintY = (texture.height / height);
+            for (uint32_t y = 0; y < height; y++)
+            {
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    uint32_t sum[4] = { 0, 0, 0, 0 };
+                    for (uint32_t fy = 0; fy < footprintY; fy++)
+                    {
+                        const uint8_t* row = texture.texels + (static_cast<size_t>((y * footprintY) + fy) * texture.width * texture.stride);
+                        for (uint32_t fx = 0; fx < footprintX; fx++)
+                        {
+                            const uint8_t* texel = row + (static_cast<size_t>((x * footprintX) + fx) * texture.stride);
+                            for (uint32_t channel = 0; channel < 4; channel++) sum[channel] += texel[channel];
+                        }
+                    }
+
+                    uint8_t* dst = &texels[(static_cast<size_t>(y) * width + x) * 4];
+                    for (uint32_t channel = 0; channel < 4; channel++) dst[channel] = static_cast<uint8_t>(sum[channel] / (footprintX * footprintY));
+                }
+            }
+            return true;
+        }
+    #if defined(__x86_64__) || defined(_M_X64)
+        else if (texture.format == ETextureFormat::BC7)
+        {
+            if (mip >= texture.mips) return false;
+
+            // Find the mip level in the aligned texels (see FormatBC7Texture)
+            size_t offset = 0;
+            for (uint32_t mipIndex = 0; mipIndex < mip; mipIndex++)
+            {
+                uint32_t blocksWide = ((std::max)(texture.width >> mipIndex, 1u) + 3) / 4;
+                uint32_t blocksHigh = ((std::max)(texture.height >> mipIndex, 1u) + 3) / 4;
+                offset += static_cast<size_t>(blocksHigh) * ALIGN(256, blocksWide * 16);
+                offset = ALIGN(512, offset);
+            }
+
+            // The last mip level of a mip chain ends after its last row of blocks (see FormatBC7Texture)
+            bool lastMip = (texture.mips > 1 && (mip + 1) == texture.mips);
+            uint32_t rowBytes = ((width + 3) / 4) * 16;
+            uint32_t numRows = (height + 3) / 4;
+            Image image = {};
+            image.width = width;
+            image.height = height;
+            image.rowPitch = (lastMip && numRows == 1) ? rowBytes : ALIGN(256, rowBytes);
+            image.slicePitch = image.rowPitch * numRows;
+            image.format = DXGI_FORMAT_BC7_UNORM;
+            image.pixels = texture.texels + offset;
+            size_t mipBytes = lastMip ? (image.rowPitch * (numRows - 1)) + rowBytes : image.slicePitch;
+            if ((offset + mipBytes) > texture.texelBytes) return false;
+
+            ScratchImage decoded;
+            if (FAILED(Decompress(image, DXGI_FORMAT_R8G8B8A8_UNORM, decoded))) return false;
+
+            const Image* rgba = decoded.GetImage(0, 0, 0);
+            for (uint32_t y = 0; y < height; y++)
+            {
+                memcpy(&texels[static_cast<size_t>(y) * width * 4], rgba->pixels + (y * rgba->rowPitch), static_cast<size_t>(width) * 4);
+            }
+            return true;
+        }
+    #endif
+        return false;
+    }
+
+    /**
+     * Get the average RGB color of a texture's texels.
+     * Uncompressed textures average (at most) 64x64 evenly spaced texels of the top mip level.
+     * BC7 textures decode their last mip level, when it fits in a single 4x4 block.
+     */
+    bool GetAverageColor(const Texture& texture, float color[3])
+    {
+        if (!texture.texels || texture.width == 0 || texture.height == 0) return false;
+
+        if (texture.format == ETextureFormat::UNCOMPRESSED)
+        {
+            uint32_t stepX = (std::max)(texture.width / 64, 1u);
+            uint32_t stepY = (std::max)(texture.height / 64, 1u);
+
+            double sum[3] = { 0.0, 0.0, 0.0 };
+            uint32_t count = 0;
+            for (uint32_t y = 0; y < texture.height; y += stepY)
+            {
+                const uint8_t* row = texture.texels + (static_cast<size_t>(y) * texture.width * texture.stride);
+                for (uint32_t x = 0; x < texture.width; x += stepX)
+                {
+                    const uint8_t* texel = row + (static_cast<size_t>(x) * texture.stride);
+                    sum[0] += texel[0];
+                    sum[1] += texel[1];
+                    sum[2] += texel[2];
+                    count++;
+                }
+            }
+
+            for (uint32_t channel = 0; channel < 3; channel++) color[channel] = static_cast<float>(sum[channel] / (255.0 * count));
+            return true;
+        }
+    #if defined(__x86_64__) || defined(_M_X64)
+        else if (texture.format == ETextureFormat::BC7)
+        {
+            if (texture.mips == 0 || texture.texelBytes < 16) return false;
+
+            // The last mip level is the last block of the texels (see FormatBC7Texture)
+            uint32_t mipWidth = (std::max)(texture.width >> (texture.mips - 1), 1u);
+            uint32_t mipHeight = (std::max)(texture.height >> (texture.mips - 1), 1u);
+            if (mipWidth > 4 || mipHeight > 4) return false;
+
+            Image block = {};
+            block.width = mipWidth;
+            block.height = mipHeight;
+            block.rowPitch = 16;
+            block.slicePitch = 16;
+            block.format = DXGI_FORMAT_BC7_UNORM;
+            block.pixels = texture.texels + (texture.texelBytes - 16);
+
+            ScratchImage decoded;
+            if (FAILED(Decompress(block, DXGI_FORMAT_R8G8B8A8_UNORM, decoded))) return false;
+
+            const Image* image = decoded.GetImage(0, 0, 0);
+            double sum[3] = { 0.0, 0.0, 0.0 };
+            for (uint32_t y = 0; y < mipHeight; y++)
+            {
+                const uint8_t* row = image->pixels + (y * image->rowPitch);
+                for (uint32_t x = 0; x < mipWidth; x++)
+                {
+                    sum[0] += row[(x * 4) + 0];
+                    sum[1] += row[(x * 4) + 1];
+                    sum[2] += row[(x * 4) + 2];
+                }
+            }
+
+            const double count = static_cast<double>(mipWidth * mipHeight);
+            for (uint32_t channel = 0; channel < 3; channel++) color[channel] = static_cast<float>(sum[channel] / (255.0 * count));
+            return true;
+        }
+    #endif
+        return false;
+    }
+
 } //namespace Textures
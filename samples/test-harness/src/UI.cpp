@@ -27,6 +27,7 @@ namespace Graphics
     namespace UI
     {
         bool s_initialized = false;
+        bool s_reuseDrawData = false;       // Execute() renders the previous frame's draw data again (see BeginFrame())
 
         static int prevRes = 0;
         static int curRes = 0;
@@ -35,6 +36,16 @@ namespace Graphics
         static float perfWindowWidth = 300.f;
         static float perfWindowHeight = 640.f;
         static float indent = 150.f;
+
+        // Low overhead mode (config app.uiLowOverhead)
+        const static double statsRefreshInterval = 0.25;    // Seconds between the stats snapshots shown (4 Hz)
+        const static uint32_t settleFrameCount = 3;         // Frames built after input, ImGui needs a few to settle hover states and window sizes
+        static Instrumentation::Performance perfSnapshot;
+        static double perfSnapshotTime = 0.0;
+        static bool invalidated = true;
+        static uint32_t settleFrames = 0;
+        static int builtWidth = 0;
+        static int builtHeight = 0;
         struct ResolutionOption
         {
             int width = 0;
@@ -55,6 +66,37 @@ namespace Graphics
         // Private Functions
         //----------------------------------------------------------------------------------------------------------
 
+        /**
+         * Copy the stats the perf window shows, so they refresh at a fixed rate instead of every frame.
+         * The copies are rebuilt when the stats change, otherwise they are overwritten in place (reusing their storage).
+         */
+        void SnapshotStats(const Instrumentation::Performance& performance)
+        {
+            perfSnapshot.counters = performance.counters;
+            perfSnapshot.frameAllocations = performance.frameAllocations;
+
+            if (perfSnapshot.cpuTimes.size() == performance.cpuTimes.size() && perfSnapshot.gpuTimes.size() == performance.gpuTimes.size())
+            {
+                for (size_t statIndex = 0; statIndex < performance.cpuTimes.size(); statIndex++) *perfSnapshot.cpuTimes[statIndex] = *performance.cpuTimes[statIndex];
+                for (size_t statIndex = 0; statIndex < performance.gpuTimes.size(); statIndex++) *perfSnapshot.gpuTimes[statIndex] = *performance.gpuTimes[statIndex];
+                return;
+            }
+
+            perfSnapshot.stats.clear();
+            perfSnapshot.cpuTimes.clear();
+            perfSnapshot.gpuTimes.clear();
+            for (const Instrumentation::Stat* stat : performance.cpuTimes)
+            {
+                perfSnapshot.stats.push_back(*stat);
+                perfSnapshot.cpuTimes.push_back(&perfSnapshot.stats.back());
+            }
+            for (const Instrumentation::Stat* stat : performance.gpuTimes)
+            {
+                perfSnapshot.stats.push_back(*stat);
+                perfSnapshot.gpuTimes.push_back(&perfSnapshot.stats.back());
+            }
+        }
+
         /**
          * Initializes the style template.
          */
@@ -98,13 +140,13 @@ namespace Graphics
         /**
         * Adds a text tool-tip on hover.
         */
-        void AddHoverToolTip(std::string message)
+        void AddHoverToolTip(const char* message)
         {
             if (ImGui::IsItemHovered())
             {
                 ImGui::BeginTooltip();
                 ImGui::PushTextWrapPos(ImGui::GetFontSize() * 35.0f);
-                ImGui::TextUnformatted(message.c_str());
+                ImGui::TextUnformatted(message);
                 ImGui::PopTextWrapPos();
                 ImGui::EndTooltip();
             }
@@ -113,12 +155,13 @@ namespace Graphics
         /**
          * Add a float value slider.
          */
-        bool AddSlider(float& value, float min, float max, float step, std::string id, std::string label, std::string hoverText = "")
+        bool AddSlider(float& value, float min, float max, float step, const char* id, const char* label, const char* hoverText = "")
         {
             ImGui::PushItemWidth(ImGui::GetContentRegionAvail().x);
-            std::string format = label.append(": %.3f");
-            bool result = ImGui::DragFloat(id.c_str(), &value, step, min, max, format.c_str());
-            AddHoverToolTip(hoverText.c_str());
+            char format[128];
+            snprintf(format, sizeof(format), "%s: %%.3f", label);
+            bool result = ImGui::DragFloat(id, &value, step, min, max, format);
+            AddHoverToolTip(hoverText);
 
             return result;
         }
@@ -126,29 +169,29 @@ namespace Graphics
         /**
         * Helper to add a float3 slider.
         */
-        bool AddFloat3Slider(float3& value, float speed, float min, float max, std::string id, std::string label, std::string hoverText = "")
+        bool AddFloat3Slider(float3& value, float speed, float min, float max, const char* id, const char* label, const char* hoverText = "")
         {
             ImGui::PushItemWidth(ImGui::GetContentRegionAvail().x - indent);
 
             float data[3] = { value.x, value.y, value.z };
-            bool result = ImGui::DragFloat3(id.c_str(), data, speed, min, max, "%.3f");
+            bool result = ImGui::DragFloat3(id, data, speed, min, max, "%.3f");
             value = { data[0], data[1], data[2] };
-            AddHoverToolTip(hoverText.c_str());
+            AddHoverToolTip(hoverText);
 
-            ImGui::SameLine(); ImGui::PopItemWidth(); ImGui::Text("%s", label.c_str());
+            ImGui::SameLine(); ImGui::PopItemWidth(); ImGui::TextUnformatted(label);
             return result;
         }
 
         /**
          * Helper to add a color slider.
          */
-        bool AddColorSlider(float3& color, std::string id, std::string hoverText = "")
+        bool AddColorSlider(float3& color, const char* id, const char* hoverText = "")
         {
             ImGui::PushItemWidth(ImGui::GetContentRegionAvail().x - indent);
 
             float data[3] = { color.x, color.y, color.z };
-            bool result = ImGui::ColorEdit4(id.c_str(), data, ImGuiColorEditFlags_NoAlpha | ImGuiColorEditFlags_InputRGB | ImGuiColorEditFlags_Float);
-            AddHoverToolTip(hoverText.c_str());
+            bool result = ImGui::ColorEdit4(id, data, ImGuiColorEditFlags_NoAlpha | ImGuiColorEditFlags_InputRGB | ImGuiColorEditFlags_Float);
+            AddHoverToolTip(hoverText);
             color = { data[0], data[1], data[2] };
 
             ImGui::SameLine(); ImGui::PopItemWidth(); ImGui::Text("Color");
@@ -169,7 +212,7 @@ namespace Graphics
             ImGui::Text("------------------------------------------------------------------");
         }
 
-        void GetSceneScaleSliderValues(Scenes::Scene scene, float& max, float& step)
+        void GetSceneScaleSliderValues(const Scenes::Scene& scene, float& max, float& step)
         {
             // Find scene scale
             float d = rtxgi::Distance(scene.boundingBox.max, scene.boundingBox.min);
@@ -210,40 +253,45 @@ namespace Graphics
         /**
          * Converts a number to formatted text.
          */
-        void AddIntQuantityText(int value, std::string message)
+        void AddIntQuantityText(int value, const char* message)
         {
-            // Format text
-            std::string number = std::to_string(value);
-            if (value > 999) number.insert(number.end() - 3, ',');
-            if (value > 999999) number.insert(number.end() - 7, ',');
-            if (value > 999999999) number.insert(number.end() - 11, ',');
+            // Format text, with thousands separators
+            char digits[16];
+            int numDigits = snprintf(digits, sizeof(digits), "%d", value);
 
-            ImGui::Text("%s", std::string(number).c_str());
+            char number[24];
+            int length = 0;
+            for (int digitIndex = 0; digitIndex < numDigits; digitIndex++)
+            {
+                int remaining = numDigits - digitIndex;
+                if (digitIndex > 0 && digits[digitIndex - 1] != '-' && (remaining % 3) == 0) number[length++] = ',';
+                number[length++] = digits[digitIndex];
+            }
+            number[length] = '\0';
+
+            ImGui::TextUnformatted(number);
             ImGui::SameLine();
-            ImGui::Text("%s", message.c_str());
+            ImGui::TextUnformatted(message);
         }
 
-        void AddFloatQuantityText(float value, std::string message)
+        void AddFloatQuantityText(float value, const char* message)
         {
-            // Format text
-            std::string number = std::to_string(value);
-
-            ImGui::Text("%s", std::string(number).c_str());
+            ImGui::Text("%f", value);
             ImGui::SameLine();
-            ImGui::Text("%s", message.c_str());
+            ImGui::TextUnformatted(message);
         }
 
         /**
          * Creates the main debug window.
          */
-        void CreateDebugWindow(Graphics::Globals& gfx, Configs::Config& config, Inputs::Input& input, Scenes::Scene& scene, std::vector<DDGIVolumeBase*>& volumes)
+        void CreateDebugWindow(Graphics::Globals& gfx, Configs::Config& config, Inputs::Input& input, Scenes::Scene& scene, std::vector<DDGIVolumeBase*>& volumes, const DDGI::CostController& costController, const Instrumentation::Performance& perf)
         {
             SetupStyle();
 
             bool skyChanged = false;
             bool anyLightChanged = false;
-            std::vector<bool> volumeChanged;
-            volumeChanged.resize(volumes.size());
+            static std::vector<bool> volumeChanged;
+            volumeChanged.assign(volumes.size(), false);
 
             // Size the debug window based on the application height
             ImGui::SetNextWindowSize(ImVec2(debugWindowWidth, gfx.height - 40.f));
@@ -310,8 +358,14 @@ namespace Graphics
             // Performance
             if (ImGui::CollapsingHeader("Performance", ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_CollapsingHeader))
             {
+                // ImGui's framerate counts the frames the UI is built, low overhead mode builds fewer
+                float frameTime = 1000.f / ImGui::GetIO().Framerate;
+                if (config.app.uiLowOverhead && !perfSnapshot.cpuTimes.empty()) frameTime = static_cast<float>(perfSnapshot.cpuTimes[Instrumentation::EStatIndex::FRAME]->average);
+
                 ImGui::Text("Frame Number: %i", gfx.frameNumber);
-                ImGui::Text("Frame Time Average: %.3f ms/frame (%.1f FPS) ", 1000.f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+                ImGui::Text("Frame Time Average: %.3f ms/frame (%.1f FPS) ", frameTime, 1000.f / frameTime);
+                ImGui::Checkbox("Low Overhead UI", &config.app.uiLowOverhead);
+                ImGui::SameLine(); AddQuestionMark("Build the UI only after input and when its stats refresh (4 times per second), other frames draw the previous UI again.");
                 ImGui::Text("Device: %s", config.app.gpuName.c_str());
                 ImGui::Checkbox("Detailed Performance", &config.app.showPerf);
                 ImGui::SameLine(); AddQuestionMark("Shows detailed performance information. Press 'J' on the keyboard for a shortcut.");
@@ -326,6 +380,17 @@ namespace Graphics
                     ImGui::Text("Running...%d%%", config.app.benchmarkProgress);
                 }
                 ImGui::SameLine(); AddQuestionMark("Runs a benchmark that captures performance information for 1,000 frames. Press 'F4' on the keyboard for a shortcut.");
+
+                if (ImGui::Button("Capture Trace"))
+                {
+                    input.event = Inputs::EInputEvent::TRACE_CAPTURE;
+                }
+                if (perf.trace.capturing)
+                {
+                    ImGui::SameLine();
+                    ImGui::Text("Capturing...%u/%u", perf.trace.frame, perf.trace.numFrames);
+                }
+                ImGui::SameLine(); AddQuestionMark("Records the CPU and GPU timelines of the next frames (app.traceFrames) to trace.json, open it in chrome://tracing or ui.perfetto.dev. Press 'F3' on the keyboard for a shortcut.");
             }
             ImGui::Separator();
 
@@ -699,6 +764,22 @@ namespace Graphics
                     ImGui::Checkbox("Use Inline Ray Tracing##pt", &config.pathTrace.useInlineRayTracing);
                     ImGui::SameLine(); AddQuestionMark("Use inline ray tracing (RayQuery) compute shaders instead of traditional RT pipelines");
 
+                    ImGui::Checkbox("Wavefront##pt", &config.pathTrace.wavefront);
+                    ImGui::SameLine(); AddQuestionMark("Trace the paths with separate extend, shade, and connect kernels, with the hits sorted by material");
+
+                    ImGui::Checkbox("Stop on Convergence", &config.pathTrace.convergence);
+                    ImGui::SameLine(); AddQuestionMark("Stop accumulating when the estimated relative error of every tile is below the threshold (requires progressive accumulation)");
+                    if (config.pathTrace.convergence)
+                    {
+                        ImGui::Checkbox("Steer Samples to Unconverged Tiles", &config.pathTrace.convergenceSteering);
+                        ImGui::SameLine(); AddQuestionMark("Stop tracing the tiles that are converged");
+
+                        ImGui::DragFloat("##ptConvergenceThreshold", &config.pathTrace.convergenceThreshold, 0.001f, 0.001f, 1.f, "Convergence Threshold: %.3f");
+                        AddHoverToolTip("The relative error (standard error / mean luminance) of a converged tile");
+
+                        ImGui::Text("%s", config.pathTrace.converged ? "Converged" : "Converging...");
+                    }
+
                     ImGui::DragFloat("##ptNormalBias", &config.pathTrace.rayNormalBias, 0.0001f, 0.f, 10.f, "Ray Normal Bias: %.4f");
                     AddHoverToolTip("A world-space distance along the surface normal, used to avoid self intersection");
 
@@ -711,6 +792,14 @@ namespace Graphics
                     ImGui::DragInt("##ptNumBounces", &numBounces, 1, 1, 20, "Bounces Per Path: %.i");
                     AddHoverToolTip("The maximum number of bounces allowed per path");
 
+                    int radianceCacheBounce = static_cast<int>(config.pathTrace.radianceCacheBounce);
+                    if (ImGui::DragInt("##ptRadianceCacheBounce", &radianceCacheBounce, 1, 0, 2, "Radiance Cache Termination Bounce: %.i"))
+                    {
+                        config.pathTrace.radianceCacheBounce = static_cast<uint32_t>(radianceCacheBounce);
+                        config.pathTrace.reload = true;
+                    }
+                    AddHoverToolTip("Paths end in the DDGI radiance cache from this bounce on, once their footprint covers a cache cell, and update the cells they pass through (0: off, D3D12 ray tracing pipeline only)");
+
                     config.pathTrace.numBounces = static_cast<uint32_t>(numBounces);
                     config.pathTrace.samplesPerPixel = static_cast<uint32_t>(numPaths);
 
@@ -767,13 +856,47 @@ namespace Graphics
                         ImGui::Indent(20.f);
                         ImGui::Checkbox("Direct Radiance", &config.ddgi.showDirectRadianceCache);
                         ImGui::Checkbox("Indirect Radiance", &config.ddgi.showIndirectRadianceCache);
+                        if (config.app.gpuCounters)
+                        {
+                            ImGui::Checkbox("Probe Ray Coverage", &config.ddgi.showRadianceCacheCoverage);
+                            ImGui::SameLine(); AddQuestionMark("Heatmap of the probe rays that hit each cell last frame: blue (1 ray) to red (512 or more rays), black (no rays)");
+                        }
                         ImGui::Unindent(20.f);
                     }
                     AddSlider(gfx.RadianceCacheSampleCount, 1.0f, 1000.f, 1.0f, "##radianceCacheSampleCount", "Radiance Cache Sample Count", "Adjust the Radiance Cache Sample Count");
 
+                    AddSlider(config.ddgi.costBudget, 0.f, 20.f, 0.1f, "##ddgiCostBudget", "GI Budget (ms)", "DDGI GPU time to steer toward by stepping probe updates, probe rays, radiance cache work, and indirect resolution down and back up (0: off)");
+                    if (costController.active)
+                    {
+                        ImGui::Indent(20.f);
+                        ImGui::Text("Measured: %.2fms (budget %.2fms +/- %.0f%%)", costController.measured, config.ddgi.costBudget, config.ddgi.costBudgetHysteresis * 100.f);
+                        ImGui::Text("Steps: probe updates %u, probe rays %u", costController.levels[DDGI::COST_KNOB_PROBE_UPDATES], costController.levels[DDGI::COST_KNOB_PROBE_RAYS]);
+                        ImGui::Text("Steps: cache ray budget %u, cache samples %u", costController.levels[DDGI::COST_KNOB_RADIANCE_CACHE_BUDGET], costController.levels[DDGI::COST_KNOB_RADIANCE_CACHE_SAMPLES]);
+                        ImGui::Text("Steps: indirect resolution %u", costController.levels[DDGI::COST_KNOB_INDIRECT_SCALE]);
+                        if (!costController.steps.empty()) ImGui::Text("Last step saved: %.2fms", costController.steps.back().saved);
+                        if (costController.holdFrames > 0) ImGui::Text("Settling: %u frames", costController.holdFrames);
+                        ImGui::Unindent(20.f);
+                    }
+
                     ImGui::Checkbox("Probe Visualization", &config.ddgi.showProbes);
                     ImGui::SameLine(); AddQuestionMark("Toggles a visualization of DDGI probes for all volumes that have the \"Show Probes\" option selected. Press 'P' on the keyboard for a shortcut.");
 
+                    if (config.ddgi.showProbes)
+                    {
+                        ImGui::Indent(20.f);
+                        if (gfx.supportsRasterizerOrderedViews)
+                        {
+                            ImGui::Checkbox("Rasterize Probes", &config.ddgi.rasterizeProbes);
+                            ImGui::SameLine(); AddQuestionMark("Draw the probes instead of ray tracing a TLAS of probe spheres (the TLAS is rebuilt every frame)");
+                        }
+                        if (!config.ddgi.rasterizeProbes || !gfx.supportsRasterizerOrderedViews)
+                        {
+                            ImGui::Checkbox("Procedural Probe Spheres", &config.ddgi.proceduralProbes);
+                            ImGui::SameLine(); AddQuestionMark("Ray trace spheres intersected in their bounding boxes (no triangles), instead of icosphere LODs selected by the probe's size on screen");
+                        }
+                        ImGui::Unindent(20.f);
+                    }
+
                     ImGui::Checkbox("Texture Visualization", &config.ddgi.showTextures);
                     ImGui::SameLine(); AddQuestionMark("Visualize the volume's probe textures. Press 'T' on the keyboard for a shortcut.");
 
@@ -797,6 +920,21 @@ namespace Graphics
 
                         ImGui::NewLine();
                         AddSlider(selectedVolumeConfig.probeDistanceDivisor, 0.f, max, step, "##probeDistanceDivisor", "Distance Normalization", "Adjust the size of the divisor used to normalize probe distance values before display");
+
+                        ImGui::NewLine();
+                        int zoom = static_cast<int>(config.ddgi.textureVisZoom);
+                        int pan[2] = { static_cast<int>(config.ddgi.textureVisPanX), static_cast<int>(config.ddgi.textureVisPanY) };
+                        int refreshFrames = static_cast<int>(config.ddgi.textureVisRefreshFrames);
+                        ImGui::PushItemWidth(ImGui::GetContentRegionAvail().x);
+                        ImGui::DragInt("##textureVisZoom", &zoom, 0.05f, 0, 7, "Zoom (2^n): %d");
+                        ImGui::DragInt2("##textureVisPan", pan, 4.f, 0, 16383, "Pan: %d");
+                        ImGui::DragInt("##textureVisRefreshFrames", &refreshFrames, 0.2f, 0, 120, "Refresh Every %d Frames");
+                        ImGui::PopItemWidth();
+                        config.ddgi.textureVisZoom = static_cast<uint32_t>((std::min)((std::max)(zoom, 0), 7));
+                        config.ddgi.textureVisPanX = static_cast<uint32_t>((std::min)((std::max)(pan[0], 0), 16383));
+                        config.ddgi.textureVisPanY = static_cast<uint32_t>((std::min)((std::max)(pan[1], 0), 16383));
+                        config.ddgi.textureVisRefreshFrames = static_cast<uint32_t>((std::max)(refreshFrames, 0));
+                        ImGui::SameLine(); AddQuestionMark("The texture visualization is magnified by 2^zoom and panned in texels of its unmagnified layout. It is redrawn when its view changes, and otherwise every N frames (0: only when its view changes).");
                     }
 
                     AddHRule();
@@ -806,11 +944,26 @@ namespace Graphics
                     ImGui::PushItemWidth(ImGui::GetContentRegionAvail().x);
                     if (ImGui::BeginCombo("##ddgiVolumeSelect", label, ImGuiComboFlags_None))
                     {
-                        for (int i = 0; i < static_cast<int>(config.ddgi.volumes.size()); i++)
+                        auto addVolume = [&config](int i)
                         {
                             const bool selected = (config.ddgi.selectedVolume == i);
                             if (ImGui::Selectable(config.ddgi.volumes[i].name.c_str(), selected)) config.ddgi.selectedVolume = i;
                             if (selected) ImGui::SetItemDefaultFocus();
+                        };
+
+                        if (config.app.uiLowOverhead)
+                        {
+                            // Submit only the visible entries of long volume lists
+                            ImGuiListClipper clipper;
+                            clipper.Begin(static_cast<int>(config.ddgi.volumes.size()));
+                            while (clipper.Step())
+                            {
+                                for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) addVolume(i);
+                            }
+                        }
+                        else
+                        {
+                            for (int i = 0; i < static_cast<int>(config.ddgi.volumes.size()); i++) addVolume(i);
                         }
                         ImGui::EndCombo();
                     }
@@ -823,9 +976,9 @@ namespace Graphics
 
                     ImGui::Text("Volume Index: %i", volume->GetIndex());
 
-                    std::stringstream msg;
-                    msg << "Probes (" << std::to_string(desc.probeCounts.x) << ", " << std::to_string(desc.probeCounts.y) << ", " << std::to_string(desc.probeCounts.z) << ")";
-                    AddIntQuantityText(volume->GetNumProbes(), msg.str());
+                    char msg[64];
+                    snprintf(msg, sizeof(msg), "Probes (%i, %i, %i)", desc.probeCounts.x, desc.probeCounts.y, desc.probeCounts.z);
+                    AddIntQuantityText(volume->GetNumProbes(), msg);
                     AddIntQuantityText(desc.probeNumRays, "Rays Per Probe");
                     AddIntQuantityText(desc.probeNumRays * volume->GetNumProbes(), "Probe Rays Per Frame (max)");
                     AddIntQuantityText(desc.probeNumRays * volume->GetNumProbes() * 2, "Rays Per Frame (max) - includes shadow rays");
@@ -1140,9 +1293,12 @@ namespace Graphics
                     ImGui::Checkbox("Use Inline Ray Tracing##rtao", &config.rtao.useInlineRayTracing);
                     ImGui::SameLine(); AddQuestionMark("Use inline ray tracing (RayQuery) compute shaders instead of traditional RT pipelines");
 
+                    ImGui::Checkbox("Temporal Accumulation##rtao", &config.rtao.temporal);
+                    ImGui::SameLine(); AddQuestionMark("Trace half of the pixels (a checkerboard) each frame and accumulate the reprojected occlusion over frames");
+
                     ImGui::PushItemWidth(ImGui::GetWindowWidth());
 
-                    ImGui::DragFloat("###RTAORayLength", &config.rtao.rayLength, 0.01f, 0.0f, 50.f, "Ray Length: %.2f");
+                    ImGui::DragFloat("###RTAORayLength"", &config.rtao.rayLength, 0.01f, 0.0f, 50.f, "Ray Length: %.2f");
                     AddHoverToolTip("The maximum distance a ray may travel when determining ambient occlusion");
 
                     ImGui::DragFloat("###RTAORayNormalBias", &config.rtao.rayNormalBias, 0.0001f, 0.f, 5.f, "Ray Normal Bias: %.4f");
@@ -1160,6 +1316,14 @@ namespace Graphics
                     ImGui::DragFloat("###RTAOFilterDepthSigma", &config.rtao.filterDepthSigma, 0.1f, 0.f, 20.f, "Filter Depth Sigma: %.1f");
                     AddHoverToolTip("The sigma for the Gaussian weight for color differences, for the bilateral filter");
 
+                    if (config.rtao.temporal)
+                    {
+                        int maxHistory = static_cast<int>(config.rtao.temporalMaxHistory);
+                        ImGui::DragInt("###RTAOTemporalMaxHistory", &maxHistory, 1, 1, 64, "Temporal Max History: %.i");
+                        AddHoverToolTip("The maximum number of frames accumulated per pixel, lower values reduce ghosting and increase noise");
+                        config.rtao.temporalMaxHistory = static_cast<uint32_t>(maxHistory);
+                    }
+
                     if (ImGui::Button("Reload Shaders"))
                     {
                         config.rtao.reload = true;
@@ -1186,6 +1350,15 @@ namespace Graphics
 
                         ImGui::DragFloat("##PostProcessExposure", &config.postProcess.exposure.fstops, 0.01f, -8.f, 8.f, "Exposure (f-stops): %.1f");
                         AddHoverToolTip("The camera's exposure in f-stops");
+
+                        ImGui::Checkbox("Automatic Exposure", &config.postProcess.exposure.automatic);
+                        ImGui::SameLine(); AddQuestionMark("Expose the frame's average luminance (GPU histogram) to middle grey, the f-stops compensate it (D3D12 only)");
+
+                        if (config.postProcess.exposure.automatic)
+                        {
+                            ImGui::DragFloat("##PostProcessExposureAdaptation", &config.postProcess.exposure.adaptation, 0.001f, 0.001f, 1.f, "Adaptation Rate: %.3f");
+                            AddHoverToolTip("Fraction of the automatic exposure change (in f-stops) applied each frame");
+                        }
                     }
 
                     ImGui::Checkbox("Tonemapping", &config.postProcess.tonemap.enabled);
@@ -1197,6 +1370,12 @@ namespace Graphics
                     ImGui::Checkbox("Gamma Correction", &config.postProcess.gamma.enabled);
                     ImGui::SameLine(); AddQuestionMark("Enable or disable gamma correction");
 
+                    if (gfx.supportsVariableRateShading)
+                    {
+                        ImGui::Checkbox("Variable Rate Sky", &config.postProcess.vrs.enabled);
+                        ImGui::SameLine(); AddQuestionMark("Composite and post process the screen tiles that only contain sky at a coarse shading rate (VRS tier 2)");
+                    }
+
                     if (ImGui::Button("Reload Shaders"))
                     {
                         config.postProcess.reload = true;
@@ -1221,11 +1400,14 @@ namespace Graphics
         /**
          * Creates the detailed performance debug window.
          */
-        void CreatePerfWindow(Graphics::Globals& gfx, const Configs::Config& config, const Instrumentation::Performance& performance)
+        void CreatePerfWindow(Graphics::Globals& gfx, const Configs::Config& config, const Instrumentation::Performance& perf)
         {
             // Early out if the window shouldn't be open
             if (!config.app.showPerf) return;
 
+            // Low overhead mode shows the stats of the last snapshot (none yet the frame the mode is enabled)
+            const Instrumentation::Performance& performance = (config.app.uiLowOverhead && !perfSnapshot.cpuTimes.empty()) ? perfSnapshot : perf;
+
             SetupStyle();
 
             // Size the debug window based on the application height
@@ -1310,6 +1492,9 @@ namespace Graphics
                 double idle = frameStat->average - (cpuTotal + waitStat->average);
                 ImGui::Text("Idle: %.3lf ms", idle);
 
+                // Heap allocations of the last frame, zero at steady state
+                ImGui::TextColored(colors[(performance.frameAllocations > 0) ? 2 : 0], "Heap Allocations: %llu (last frame)", static_cast<unsigned long long>(performance.frameAllocations));
+
                 ImGui::Separator();
 
                 ImGui::Unindent(10.f);
@@ -1382,6 +1567,55 @@ namespace Graphics
                 ImGui::Separator();
             }
 
+            // GPU Counters
+            if (config.app.renderMode == ERenderMode::DDGI && performance.counters.enabled)
+            {
+                const Instrumentation::Counters& counters = performance.counters;
+                ImGui::TextColored(ImVec4(0.f, 0.71f, 0.071f, 1.f), "GPU Counters (frame %llu)", (unsigned long long)counters.frame);
+
+                ImGui::Text("Rays: %.2lf M/s", counters.GetRaysPerSecond(performance.gpuTimes[0]->average) / 1000000.0);
+                ImGui::Text("Cache Hit Rate: %.1lf%%", counters.GetCacheHitRate() * 100.0);
+                ImGui::Separator();
+
+                ImGui::Indent(10.f);
+                for (uint32_t counter = 0; counter < Instrumentation::COUNTER_COUNT; counter++)
+                {
+                    ImGui::Text("%s: %u", Instrumentation::Counters::GetName((Instrumentation::ECounter)counter), counters.values[counter]);
+                }
+                for (uint32_t pass = 0; pass < Instrumentation::PASS_COUNT; pass++)
+                {
+                    ImGui::Text("%s CS Invocations: %llu", Instrumentation::Counters::GetPassName((Instrumentation::ECounterPass)pass), (unsigned long long)counters.csInvocations[pass]);
+                }
+                ImGui::Unindent(10.f);
+                ImGui::Separator();
+
+                // Radiance cache occupancy
+                if (!counters.cacheCascades.empty())
+                {
+                    Instrumentation::CacheCascadeStats totals = counters.GetCacheTotals();
+                    ImGui::Text("Radiance Cache Load Factor: %.1lf%%", counters.GetCacheLoadFactor() * 100.0);
+                    ImGui::Indent(10.f);
+                    ImGui::Text("Occupied: %u (%u live, %u stale)", totals.occupied, totals.live, totals.occupied - totals.live);
+                    ImGui::Text("Live Average Age: %.2lf frames", counters.GetCacheAverageAge());
+                    ImGui::Text("Live Average Probe Length: %.3lf slots", counters.GetCacheAverageProbeLength());
+                    ImGui::Text("Probe Rays per Covered Cell: %.2lf (%u cells)", counters.GetCacheAmortization(), totals.coveredCells);
+                    ImGui::Text("Evictions: %u, Collisions: %u", counters.values[Instrumentation::CACHE_EVICTIONS], counters.values[Instrumentation::CACHE_COLLISIONS]);
+                    for (uint32_t cascade = 0; cascade < static_cast<uint32_t>(counters.cacheCascades.size()); cascade++)
+                    {
+                        const Instrumentation::CacheCascadeStats& stats = counters.cacheCascades[cascade];
+                        ImGui::Text("Cascade %u: %.1lf%% (%u / %u), %.2lf rays per cell", cascade, counters.GetCacheLoadFactor(cascade) * 100.0, stats.occupied, counters.cacheCascadeCells, counters.GetCacheAmortization(cascade));
+
+                        // Histogram of the covered cells by probe rays per cell (1, 2-3, 4-7, ...)
+                        float coverage[Instrumentation::CACHE_COVERAGE_BINS];
+                        for (uint32_t bin = 0; bin < Instrumentation::CACHE_COVERAGE_BINS; bin++) coverage[bin] = static_cast<float>(stats.coverage[bin]);
+                        std::string label = "##radianceCacheCoverage" + std::to_string(cascade);
+                        ImGui::PlotHistogram(label.c_str(), coverage, Instrumentation::CACHE_COVERAGE_BINS, 0, "covered cells by log2(probe rays)", 0.f, FLT_MAX, ImVec2(0.f, 40.f));
+                    }
+                    ImGui::Unindent(10.f);
+                    ImGui::Separator();
+                }
+            }
+
             ImGui::SetWindowPos("Detailed Performance", ImVec2((gfx.width - ImGui::GetWindowWidth() - debugWindowWidth - 20.f), 20));
             ImGui::End();
         }
@@ -1471,6 +1705,56 @@ namespace Graphics
         // Public Functions
         //----------------------------------------------------------------------------------------------------------
 
+        /**
+         * Mark the UI as changed, the next frames build it again. Called by the input handlers.
+         */
+        void Invalidate()
+        {
+            invalidated = true;
+        }
+
+        /**
+         * Returns true when the UI should be built this frame. In low overhead mode (config app.uiLowOverhead) the UI is built
+         * after input, while an item is active, on resize, and when the stats refresh. Other frames set s_reuseDrawData and
+         * Execute() renders the draw data of the last frame built again, which ImGui keeps until the next NewFrame().
+         */
+        bool BeginFrame(Graphics::Globals& gfx, Configs::Config& config, const Instrumentation::Performance& performance)
+        {
+            s_reuseDrawData = false;
+            if (!config.app.showUI)
+            {
+                invalidated = true;
+                return false;
+            }
+            if (!config.app.uiLowOverhead) return true;
+
+            double time = glfwGetTime();
+            bool refreshStats = ((time - perfSnapshotTime) >= statsRefreshInterval) || (perfSnapshot.gpuTimes.size() != performance.gpuTimes.size());
+            if (refreshStats)
+            {
+                SnapshotStats(performance);
+                perfSnapshotTime = time;
+            }
+
+            if (gfx.width != builtWidth || gfx.height != builtHeight) invalidated = true;
+            if (invalidated || ImGui::IsAnyItemActive() || ImGui::GetIO().WantTextInput) settleFrames = settleFrameCount;
+            invalidated = false;
+
+            if (settleFrames == 0 && !refreshStats)
+            {
+                // The UI flags changes for one frame only
+                for (Configs::DDGIVolume& volume : config.ddgi.volumes) volume.clearProbeVariability = false;
+
+                s_reuseDrawData = true;
+                return false;
+            }
+
+            if (settleFrames > 0) settleFrames--;
+            builtWidth = gfx.width;
+            builtHeight = gfx.height;
+            return true;
+        }
+
         bool CapturedMouse()
         {
             if (s_initialized) return ImGui::GetIO().WantCaptureMouse;
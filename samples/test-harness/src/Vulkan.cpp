@@ -13,6 +13,8 @@
 #include "UI.h"
 #include "ImageCapture.h"
 
+#include <filesystem>
+
 namespace Graphics
 {
     namespace Vulkan
@@ -108,6 +110,27 @@ namespace Graphics
             return false;
         }
 
+        /**
+         * Find a queue family that supports compute and not graphics (dedicated async compute hardware).
+         * Without one, the compute work shares the graphics queue family.
+         */
+        int FindComputeQueueFamily(VkPhysicalDevice physicalDevice, int graphicsQueueIndex)
+        {
+            uint32_t queueFamilyPropertyCount = 0;
+            vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyPropertyCount, nullptr);
+
+            std::vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyPropertyCount);
+            vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyPropertyCount, queueFamilyProperties.data());
+
+            for (uint32_t propertyIndex = 0; propertyIndex < queueFamilyPropertyCount; propertyIndex++)
+            {
+                const VkQueueFamilyProperties props = queueFamilyProperties[propertyIndex];
+                if ((props.queueFlags & VK_QUEUE_COMPUTE_BIT) && !(props.queueFlags & VK_QUEUE_GRAPHICS_BIT)) return static_cast<int>(propertyIndex);
+            }
+
+            return graphicsQueueIndex;
+        }
+
         /**
          * Get the index of the memory type used for the requested memory.
          */
@@ -310,23 +333,34 @@ namespace Graphics
             std::vector<VkPhysicalDevice> devices(physicalDeviceCount);
             VKCHECK(vkEnumeratePhysicalDevices(vk.instance, &physicalDeviceCount, devices.data()));
 
-            // Find a physical device that supports graphics queues
+            // Find a physical device that supports graphics queues, and its async compute queue family
             if (!FindPhysicalDeviceWithGraphicsQueue(devices, &vk.physicalDevice, &vk.queueFamilyIndex)) return false;
+            vk.computeQueueFamilyIndex = FindComputeQueueFamily(vk.physicalDevice, vk.queueFamilyIndex);
+            vk.sharedQueueFamilyIndices[0] = static_cast<uint32_t>(vk.queueFamilyIndex);
+            vk.sharedQueueFamilyIndices[1] = static_cast<uint32_t>(vk.computeQueueFamilyIndex);
 
-            // Describe the device queue
-            VkDeviceQueueCreateInfo deviceQueueCreateInfo = {};
-            deviceQueueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-            deviceQueueCreateInfo.queueCount = 1;
-            deviceQueueCreateInfo.queueFamilyIndex = vk.queueFamilyIndex;
-
+            // Describe the device queues
             static const float queuePriorities[] = { 1.f };
-            deviceQueueCreateInfo.pQueuePriorities = queuePriorities;
+
+            VkDeviceQueueCreateInfo deviceQueueCreateInfos[2] = {};
+            deviceQueueCreateInfos[0].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+            deviceQueueCreateInfos[0].queueCount = 1;
+            deviceQueueCreateInfos[0].queueFamilyIndex = vk.queueFamilyIndex;
+            deviceQueueCreateInfos[0].pQueuePriorities = queuePriorities;
+
+            uint32_t queueCreateInfoCount = 1;
+            if (vk.computeQueueFamilyIndex != vk.queueFamilyIndex)
+            {
+                deviceQueueCreateInfos[1] = deviceQueueCreateInfos[0];
+                deviceQueueCreateInfos[1].queueFamilyIndex = vk.computeQueueFamilyIndex;
+                queueCreateInfoCount++;
+            }
 
             // Describe the device
             VkDeviceCreateInfo deviceCreateInfo = {};
             deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-            deviceCreateInfo.queueCreateInfoCount = 1;
-            deviceCreateInfo.pQueueCreateInfos = &deviceQueueCreateInfo;
+            deviceCreateInfo.queueCreateInfoCount = queueCreateInfoCount;
+            deviceCreateInfo.pQueueCreateInfos = deviceQueueCreateInfos;
 
             std::vector<const char*> deviceLayerNames;
 
@@ -351,6 +385,19 @@ namespace Graphics
                 VK_KHR_MAINTENANCE3_EXTENSION_NAME
             };
 
+            // Enable the memory budget extension when available (see GetVideoMemoryInfo())
+            uint32_t extensionCount = 0;
+            VKCHECK(vkEnumerateDeviceExtensionProperties(vk.physicalDevice, nullptr, &extensionCount, nullptr));
+            std::vector<VkExtensionProperties> extensions(extensionCount);
+            VKCHECK(vkEnumerateDeviceExtensionProperties(vk.physicalDevice, nullptr, &extensionCount, extensions.data()));
+            for (const VkExtensionProperties& extension : extensions)
+            {
+                if (strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) != 0) continue;
+                deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+                vk.supportsMemoryBudget = true;
+                break;
+            }
+
             deviceCreateInfo.ppEnabledExtensionNames = deviceExtensions.data();
             deviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
 
@@ -394,7 +441,12 @@ namespace Graphics
             descriptorIndexingFeatures.runtimeDescriptorArray = VK_TRUE;
             descriptorIndexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
 
-            deviceCreateInfo.pNext = &descriptorIndexingFeatures;
+            VkPhysicalDeviceTimelineSemaphoreFeatures timelineSemaphoreFeatures = {};
+            timelineSemaphoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+            timelineSemaphoreFeatures.pNext = &descriptorIndexingFeatures;
+            timelineSemaphoreFeatures.timelineSemaphore = VK_TRUE;  // frame pacing and queue synchronization
+
+            deviceCreateInfo.pNext = &timelineSemaphoreFeatures;
 
             // Get the features supported by the physical device
             vkGetPhysicalDeviceFeatures(vk.physicalDevice, &vk.deviceFeatures);
@@ -407,13 +459,16 @@ namespace Graphics
             // Load the device extensions
             LoadDeviceExtensions(vk.device);
 
-            // Create the queue
+            // Create the queues, without a dedicated compute queue family the compute work is submitted to the graphics queue
             vkGetDeviceQueue(vk.device, vk.queueFamilyIndex, 0, &vk.queue);
             if (vk.queue == nullptr) return false;
+            vkGetDeviceQueue(vk.device, vk.computeQueueFamilyIndex, 0, &vk.computeQueue);
+            if (vk.computeQueue == nullptr) return false;
 
         #ifdef GFX_NAME_OBJECTS
             SetObjectName(vk.device, reinterpret_cast<uint64_t>(vk.device), "VKDevice", VK_OBJECT_TYPE_DEVICE);
             SetObjectName(vk.device, reinterpret_cast<uint64_t>(vk.queue), "VKQueue", VK_OBJECT_TYPE_QUEUE);
+            if (vk.computeQueue != vk.queue) SetObjectName(vk.device, reinterpret_cast<uint64_t>(vk.computeQueue), "VKComputeQueue", VK_OBJECT_TYPE_QUEUE);
             SetObjectName(vk.device, reinterpret_cast<uint64_t>(vk.surface), "VKSurface", VK_OBJECT_TYPE_SURFACE_KHR);
         #endif
 
@@ -437,28 +492,18 @@ namespace Graphics
             // Save the GPU device name
             std::string name(vk.deviceProps.properties.deviceName);
             config.app.gpuName = name;
+            config.app.gpuDriverVersion = vk.deviceProps.properties.driverVersion;
 
             return true;
         }
 
         /**
-         * Create the fences.
+         * Create the fences. Frames are paced with a timeline semaphore, see CreateSemaphores().
          */
         bool CreateFences(Globals& vk)
         {
             VkFenceCreateInfo fenceCreateInfo = {};
             fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-            fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-            for (uint32_t fenceIndex = 0; fenceIndex < MAX_FRAMES_IN_FLIGHT; fenceIndex++)
-            {
-                VKCHECK(vkCreateFence(vk.device, &fenceCreateInfo, nullptr, &vk.fences[fenceIndex]));
-            #ifdef GFX_NAME_OBJECTS
-                std::string fenceName = "Fence " + std::to_string(fenceIndex);
-                SetObjectName(vk.device, reinterpret_cast<uint64_t>(vk.fences[fenceIndex]), fenceName.c_str(), VK_OBJECT_TYPE_FENCE);
-            #endif
-            }
-
             fenceCreateInfo.flags = 0;
             VKCHECK(vkCreateFence(vk.device, &fenceCreateInfo, nullptr, &vk.immediateFence));
         #ifdef GFX_NAME_OBJECTS
@@ -495,10 +540,13 @@ namespace Graphics
             swapchainSize = surfaceCapabilities.currentExtent;
             if (swapchainSize.width != vk.width) return false;
             if (swapchainSize.height != vk.height) return false;
-            if (surfaceCapabilities.minImageCount > MAX_FRAMES_IN_FLIGHT) return false;
 
+            // Request an image per frame in flight, the surface may require (and the driver may return) more.
+            // Swap chain images are indexed by the acquired imageIndex, independent of frameIndex.
             // Note: maxImageCount of 0 means unlimited number of images
-            assert((surfaceCapabilities.maxImageCount != 0) && (surfaceCapabilities.maxImageCount > MAX_FRAMES_IN_FLIGHT));
+            uint32_t imageCount = std::max(surfaceCapabilities.minImageCount, static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT));
+            if (surfaceCapabilities.maxImageCount > 0) imageCount = std::min(imageCount, surfaceCapabilities.maxImageCount);
+            if (imageCount > MAX_SWAPCHAIN_IMAGES) return false;
 
             VkSurfaceTransformFlagBitsKHR surfaceTransformFlagBits =
                 surfaceCapabilities.supportedTransforms & VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR ? VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR : surfaceCapabilities.currentTransform;
@@ -511,7 +559,7 @@ namespace Graphics
             VkSwapchainCreateInfoKHR swapchainCreateInfo = {};
             swapchainCreateInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
             swapchainCreateInfo.surface = vk.surface;
-            swapchainCreateInfo.minImageCount = MAX_FRAMES_IN_FLIGHT;
+            swapchainCreateInfo.minImageCount = imageCount;
             swapchainCreateInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
             swapchainCreateInfo.preTransform = surfaceTransformFlagBits;
             swapchainCreateInfo.imageColorSpace = vk.swapChainColorSpace;
@@ -545,15 +593,14 @@ namespace Graphics
         #endif
 
             // Get the swap chain image count
-            uint32_t swapchainImageCount = 0;
-            VKCHECK(vkGetSwapchainImagesKHR(vk.device, vk.swapChain, &swapchainImageCount, nullptr));
-            if (swapchainImageCount != MAX_FRAMES_IN_FLIGHT) return false;
+            VKCHECK(vkGetSwapchainImagesKHR(vk.device, vk.swapChain, &vk.swapChainImageCount, nullptr));
+            if (vk.swapChainImageCount > MAX_SWAPCHAIN_IMAGES) return false;
 
             // Get the swap chain images
-            VKCHECK(vkGetSwapchainImagesKHR(vk.device, vk.swapChain, &swapchainImageCount, vk.swapChainImage));
+            VKCHECK(vkGetSwapchainImagesKHR(vk.device, vk.swapChain, &vk.swapChainImageCount, vk.swapChainImage));
 
             // Create views for the swap chain images
-            for (uint32_t imageIndex = 0; imageIndex < MAX_FRAMES_IN_FLIGHT; imageIndex++)
+            for (uint32_t imageIndex = 0; imageIndex < vk.swapChainImageCount; imageIndex++)
             {
                 // Describe the image view
                 VkImageViewCreateInfo imageViewCreateInfo = {};
@@ -587,9 +634,9 @@ namespace Graphics
             };
 
             // Transition the back buffers to present
-            for (uint32_t imageIndex = 0; imageIndex < MAX_FRAMES_IN_FLIGHT; imageIndex++)
+            for (uint32_t imageIndex = 0; imageIndex < vk.swapChainImageCount; imageIndex++)
             {
-                SetImageLayoutBarrier(vk.cmdBuffer[vk.frameIndex], vk.swapChainImage[imageIndex], barrier);
+                SetImageLayoutBarrier(GetCmdBuffer(vk), vk.swapChainImage[imageIndex], barrier);
             }
 
             return true;
@@ -641,7 +688,7 @@ namespace Graphics
          */
         bool CreateFrameBuffers(Globals& vk)
         {
-            for (uint32_t bufferIndex = 0; bufferIndex < MAX_FRAMES_IN_FLIGHT; bufferIndex++)
+            for (uint32_t bufferIndex = 0; bufferIndex < vk.swapChainImageCount; bufferIndex++)
             {
                 // Describe the frame buffer
                 VkFramebufferCreateInfo framebufferCreateInfo = {};
@@ -664,6 +711,66 @@ namespace Graphics
             return true;
         }
 
+        /**
+         * Create the pipeline cache, with the pipeline cache data of the previous launch.
+         * The driver ignores cache data written by a different device or driver version.
+         */
+        bool CreatePipelineCache(Globals& vk, const Configs::Config& config)
+        {
+            if (!config.shaders.pipelineCache) return true;
+
+            std::error_code ec;
+            std::filesystem::create_directories(config.app.root + "shadercache/", ec);
+            vk.pipelineCachePath = config.app.root + "shadercache/pipelines.vk";
+
+            std::vector<char> data;
+            std::ifstream file(vk.pipelineCachePath, std::ios::binary);
+            if (file.is_open()) data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+            // Describe the pipeline cache
+            VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {};
+            pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+            pipelineCacheCreateInfo.initialDataSize = data.size();
+            pipelineCacheCreateInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+            // Create the pipeline cache, without the previous data if it is rejected
+            if (vkCreatePipelineCache(vk.device, &pipelineCacheCreateInfo, nullptr, &vk.pipelineCache) != VK_SUCCESS)
+            {
+                pipelineCacheCreateInfo.initialDataSize = 0;
+                pipelineCacheCreateInfo.pInitialData = nullptr;
+                VKCHECK(vkCreatePipelineCache(vk.device, &pipelineCacheCreateInfo, nullptr, &vk.pipelineCache));
+            }
+            return true;
+        }
+
+        /**
+         * Write the pipeline cache data to disk and destroy the pipeline cache.
+         */
+        void ReleasePipelineCache(Globals& vk)
+        {
+            if (vk.pipelineCache == nullptr) return;
+
+            size_t size = 0;
+            if (vkGetPipelineCacheData(vk.device, vk.pipelineCache, &size, nullptr) == VK_SUCCESS && size > 0)
+            {
+                std::vector<char> data(size);
+                if (vkGetPipelineCacheData(vk.device, vk.pipelineCache, &size, data.data()) == VK_SUCCESS)
+                {
+                    // Write to a temporary file and replace the cache, so a failed write doesn't leave truncated data
+                    std::error_code ec;
+                    std::string temp = vk.pipelineCachePath + ".tmp";
+                    std::ofstream file(temp, std::ios::binary);
+                    file.write(data.data(), size);
+                    file.close();
+                    if (!file.fail()) std::filesystem::rename(temp, vk.pipelineCachePath, ec);
+                }
+            }
+
+            vkDestroyPipelineCache(vk.device, vk.pipelineCache, nullptr);
+            vk.pipelineCache = nullptr;
+            vk.pipelineCachePath = "";
+        }
+
         /**
          * Create the command pool.
          */
@@ -680,6 +787,31 @@ namespace Graphics
         #ifdef GFX_NAME_OBJECTS
             SetObjectName(vk.device, reinterpret_cast<uint64_t>(vk.commandPool), "Command Pool", VK_OBJECT_TYPE_COMMAND_POOL);
         #endif
+
+            // Create the pass command pools, reset as a whole each frame
+            commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            for (uint32_t index = 0; index < MAX_FRAMES_IN_FLIGHT; index++)
+            {
+                for (uint32_t passIndex = 0; passIndex <= MAX_PASS_CMD_LISTS; passIndex++)
+                {
+                    VKCHECK(vkCreateCommandPool(vk.device, &commandPoolCreateInfo, nullptr, &vk.passCommandPool[index][passIndex]));
+                #ifdef GFX_NAME_OBJECTS
+                    std::string name = "Pass Command Pool " + std::to_string(index) + "." + std::to_string(passIndex);
+                    SetObjectName(vk.device, reinterpret_cast<uint64_t>(vk.passCommandPool[index][passIndex]), name.c_str(), VK_OBJECT_TYPE_COMMAND_POOL);
+                #endif
+                }
+            }
+
+            // Create the compute command pools, reset as a whole each frame
+            commandPoolCreateInfo.queueFamilyIndex = vk.computeQueueFamilyIndex;
+            for (uint32_t index = 0; index < MAX_FRAMES_IN_FLIGHT; index++)
+            {
+                VKCHECK(vkCreateCommandPool(vk.device, &commandPoolCreateInfo, nullptr, &vk.computeCommandPool[index]));
+            #ifdef GFX_NAME_OBJECTS
+                std::string name = "Compute Command Pool " + std::to_string(index);
+                SetObjectName(vk.device, reinterpret_cast<uint64_t>(vk.computeCommandPool[index]), name.c_str(), VK_OBJECT_TYPE_COMMAND_POOL);
+            #endif
+            }
             return true;
         }
 
@@ -709,6 +841,32 @@ namespace Graphics
             #endif
             }
 
+            // Allocate the pass command buffers, one from each pass command pool
+            commandBufferAllocateInfo.commandBufferCount = 1;
+            for (uint32_t index = 0; index < MAX_FRAMES_IN_FLIGHT; index++)
+            {
+                for (uint32_t passIndex = 0; passIndex <= MAX_PASS_CMD_LISTS; passIndex++)
+                {
+                    commandBufferAllocateInfo.commandPool = vk.passCommandPool[index][passIndex];
+                    VKCHECK(vkAllocateCommandBuffers(vk.device, &commandBufferAllocateInfo, &vk.passCmdBuffer[index][passIndex]));
+                #ifdef GFX_NAME_OBJECTS
+                    std::string name = "Pass Command Buffer " + std::to_string(index) + "." + std::to_string(passIndex);
+                    SetObjectName(vk.device, reinterpret_cast<uint64_t>(vk.passCmdBuffer[index][passIndex]), name.c_str(), VK_OBJECT_TYPE_COMMAND_BUFFER);
+                #endif
+                }
+            }
+
+            // Allocate the compute command buffers, one from each compute command pool
+            for (uint32_t index = 0; index < MAX_FRAMES_IN_FLIGHT; index++)
+            {
+                commandBufferAllocateInfo.commandPool = vk.computeCommandPool[index];
+                VKCHECK(vkAllocateCommandBuffers(vk.device, &commandBufferAllocateInfo, &vk.computeCmdBuffer[index]));
+            #ifdef GFX_NAME_OBJECTS
+                std::string name = "Compute Command Buffer " + std::to_string(index);
+                SetObjectName(vk.device, reinterpret_cast<uint64_t>(vk.computeCmdBuffer[index]), name.c_str(), VK_OBJECT_TYPE_COMMAND_BUFFER);
+            #endif
+            }
+
             return true;
         }
 
@@ -734,6 +892,23 @@ namespace Graphics
                 SetObjectName(vk.device, reinterpret_cast<uint64_t>(vk.presentSemaphore[semaphoreIndex]), presentSemaphoreName.c_str(), VK_OBJECT_TYPE_SEMAPHORE);
             #endif
             }
+
+            // Create the timeline semaphores (frame pacing and async compute)
+            VkSemaphoreTypeCreateInfo semaphoreTypeCreateInfo = {};
+            semaphoreTypeCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+            semaphoreTypeCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+            semaphoreTypeCreateInfo.initialValue = 0;
+            semaphoreCreateInfo.pNext = &semaphoreTypeCreateInfo;
+            semaphoreCreateInfo.flags = 0;
+
+            VKCHECK(vkCreateSemaphore(vk.device, &semaphoreCreateInfo, nullptr, &vk.frameSemaphore));
+            VKCHECK(vkCreateSemaphore(vk.device, &semaphoreCreateInfo, nullptr, &vk.graphicsToComputeSemaphore));
+            VKCHECK(vkCreateSemaphore(vk.device, &semaphoreCreateInfo, nullptr, &vk.computeToGraphicsSemaphore));
+        #ifdef GFX_NAME_OBJECTS
+            SetObjectName(vk.device, reinterpret_cast<uint64_t>(vk.frameSemaphore), "Frame Timeline Semaphore", VK_OBJECT_TYPE_SEMAPHORE);
+            SetObjectName(vk.device, reinterpret_cast<uint64_t>(vk.graphicsToComputeSemaphore), "Graphics To Compute Timeline Semaphore", VK_OBJECT_TYPE_SEMAPHORE);
+            SetObjectName(vk.device, reinterpret_cast<uint64_t>(vk.computeToGraphicsSemaphore), "Compute To Graphics Timeline Semaphore", VK_OBJECT_TYPE_SEMAPHORE);
+        #endif
             return true;
         }
 
@@ -769,6 +944,15 @@ namespace Graphics
             return true;
         }
 
+        /**
+         * Create the memory pool scene geometry, acceleration structures, and textures are suballocated from.
+         */
+        bool CreateMemoryPool(Globals& vk)
+        {
+            rtxgi::vulkan::DDGIMemoryPoolDesc desc = {};
+            return (rtxgi::vulkan::CreateDDGIMemoryPool(vk.device, vk.physicalDevice, desc, &vk.memoryPool) == rtxgi::ERTXGIStatus::OK);
+        }
+
         /**
          * Create the query pool(s).
          */
@@ -787,7 +971,7 @@ namespace Graphics
         #endif
 
             // Reset the queries in the pool
-            vkCmdResetQueryPool(vk.cmdBuffer[vk.frameIndex], resources.timestampPool, 0, MAX_TIMESTAMPS * 2);
+            vkCmdResetQueryPool(GetCmdBuffer(vk), resources.timestampPool, 0, MAX_TIMESTAMPS * 2);
 
             // Create the timestamps resource (read-back)
             uint32_t size = MAX_TIMESTAMPS * sizeof(uint64_t) * 2;
@@ -892,21 +1076,20 @@ namespace Graphics
          * Create the index buffer and device memory for a mesh.
          * Copy the index data to the upload buffer and schedule a copy to the device buffer.
          */
-        bool CreateIndexBuffer(Globals& vk, const Scenes::Mesh& mesh, VkBuffer* ib, VkDeviceMemory* ibMemory, VkBuffer* ibUpload, VkDeviceMemory* ibUploadMemory)
+        bool CreateIndexBuffer(Globals& vk, const Scenes::Mesh& mesh, VkBuffer* ib, rtxgi::vulkan::DDGIMemoryAllocation** ibAllocation, VkBuffer* ibUpload, rtxgi::vulkan::DDGIMemoryAllocation** ibUploadAllocation)
         {
             // Create the index buffer upload resource
             uint32_t sizeInBytes = mesh.numIndices * sizeof(uint32_t);
             BufferDesc desc = { sizeInBytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT };
-            if (!CreateBuffer(vk, desc, ibUpload, ibUploadMemory)) return false;
+            if (!CreateBuffer(vk, desc, ibUpload, ibUploadAllocation)) return false;
 
             // Create the index buffer device resource
             desc.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR;
             desc.memoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-            if (!CreateBuffer(vk, desc, ib, ibMemory)) return false;
+            if (!CreateBuffer(vk, desc, ib, ibAllocation)) return false;
 
-            // Copy the index data of each mesh primitive to the upload buffer
-            uint8_t* pData = nullptr;
-            VKCHECK(vkMapMemory(vk.device, *ibUploadMemory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&pData)));
+            // Copy the index data of each mesh primitive to the (persistently mapped) upload buffer
+            uint8_t* pData = static_cast<uint8_t*>((*ibUploadAllocation)->mappedData);
 
             for (uint32_t primitiveIndex = 0; primitiveIndex < static_cast<uint32_t>(mesh.primitives.size()); primitiveIndex++)
             {
@@ -916,12 +1099,11 @@ namespace Graphics
                 uint32_t size = static_cast<uint32_t>(primitive.indices.size()) * sizeof(uint32_t);
                 memcpy(pData + primitive.indexByteOffset, primitive.indices.data(), size);
             }
-            vkUnmapMemory(vk.device, *ibUploadMemory);
 
             // Schedule a copy of the upload buffer to the device buffer
             VkBufferCopy bufferCopy = {};
             bufferCopy.size = sizeInBytes;
-            vkCmdCopyBuffer(vk.cmdBuffer[vk.frameIndex], *ibUpload, *ib, 1, &bufferCopy);
+            vkCmdCopyBuffer(GetCmdBuffer(vk), *ibUpload, *ib, 1, &bufferCopy);
 
             return true;
         }
@@ -930,22 +1112,21 @@ namespace Graphics
          * Create the vertex buffer and device memory for a mesh primitive.
          * Copy the vertex data to the upload buffer and schedule a copy to the device buffer.
          */
-        bool CreateVertexBuffer(Globals& vk, const Scenes::Mesh& mesh, VkBuffer* vb, VkDeviceMemory* vbMemory, VkBuffer* vbUpload, VkDeviceMemory* vbUploadMemory)
+        bool CreateVertexBuffer(Globals& vk, const Scenes::Mesh& mesh, VkBuffer* vb, rtxgi::vulkan::DDGIMemoryAllocation** vbAllocation, VkBuffer* vbUpload, rtxgi::vulkan::DDGIMemoryAllocation** vbUploadAllocation)
         {
             // Create the vertex buffer upload resource
             uint32_t stride = sizeof(Vertex);
             uint32_t sizeInBytes = mesh.numVertices * stride;
             BufferDesc desc = { sizeInBytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT };
-            if (!CreateBuffer(vk, desc, vbUpload, vbUploadMemory)) return false;
+            if (!CreateBuffer(vk, desc, vbUpload, vbUploadAllocation)) return false;
 
             // Create the vertex buffer device resource
             desc.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR;
             desc.memoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-            if (!CreateBuffer(vk, desc, vb, vbMemory)) return false;
+            if (!CreateBuffer(vk, desc, vb, vbAllocation)) return false;
 
-            // Copy the vertex data of each mesh primitive to the upload
-            uint8_t* pData = nullptr;
-            VKCHECK(vkMapMemory(vk.device, *vbUploadMemory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&pData)));
+            // Copy the vertex data of each mesh primitive to the (persistently mapped) upload buffer
+            uint8_t* pData = static_cast<uint8_t*>((*vbUploadAllocation)->mappedData);
 
             for (uint32_t primitiveIndex = 0; primitiveIndex < static_cast<uint32_t>(mesh.primitives.size()); primitiveIndex++)
             {
@@ -955,12 +1136,11 @@ namespace Graphics
                 uint32_t size = static_cast<uint32_t>(primitive.vertices.size()) * stride;
                 memcpy(pData + primitive.vertexByteOffset, primitive.vertices.data(), size);
             }
-            vkUnmapMemory(vk.device, *vbUploadMemory);
 
             // Schedule a copy of the upload buffer to the device buffer
             VkBufferCopy bufferCopy = {};
             bufferCopy.size = sizeInBytes;
-            vkCmdCopyBuffer(vk.cmdBuffer[vk.frameIndex], *vbUpload, *vb, 1, &bufferCopy);
+            vkCmdCopyBuffer(GetCmdBuffer(vk), *vbUpload, *vb, 1, &bufferCopy);
 
             return true;
         }
@@ -1026,12 +1206,12 @@ namespace Graphics
 
             // Create the BLAS scratch buffer, allocate and bind device memory
             BufferDesc blasScratchDesc = { asPreBuildInfo.buildScratchSize, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT };
-            if (!CreateBuffer(vk, blasScratchDesc, &as.scratch, &as.scratchMemory)) return false;
+            if (!CreateBuffer(vk, blasScratchDesc, &as.scratch, &as.scratchAllocation)) return false;
             asInputs.scratchData = VkDeviceOrHostAddressKHR{ GetBufferDeviceAddress(vk.device, as.scratch) };
 
             // Create the BLAS buffer, allocate and bind device memory
             BufferDesc blasDesc = { asPreBuildInfo.accelerationStructureSize, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT };
-            if (!CreateBuffer(vk, blasDesc, &as.asBuffer, &as.asMemory)) return false;
+            if (!CreateBuffer(vk, blasDesc, &as.asBuffer, &as.asAllocation)) return false;
 
             // Describe the BLAS acceleration structure
             VkAccelerationStructureCreateInfoKHR asCreateInfo = {};
@@ -1046,7 +1226,7 @@ namespace Graphics
             // Set the location of the final acceleration structure
             asInputs.dstAccelerationStructure = as.asKHR;
 
-            vkCmdBuildAccelerationStructuresKHR(vk.cmdBuffer[vk.frameIndex], 1, &asInputs, buildRangeInfos.data());
+            vkCmdBuildAccelerationStructuresKHR(GetCmdBuffer(vk), 1, &asInputs, buildRangeInfos.data());
 
             return true;
         }
@@ -1109,13 +1289,13 @@ namespace Graphics
             VkAccelerationStructureBuildRangeInfoKHR buildInfo = { primitiveCount, 0, 0, 0 };
             buildRangeInfos[0] = &buildInfo;
 
-            vkCmdBuildAccelerationStructuresKHR(vk.cmdBuffer[vk.frameIndex], 1, &asInputs, buildRangeInfos.data());
+            vkCmdBuildAccelerationStructuresKHR(GetCmdBuffer(vk), 1, &asInputs, buildRangeInfos.data());
 
             // Wait for the TLAS build to complete
             VkMemoryBarrier barrier{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
             barrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
             barrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
-            vkCmdPipelineBarrier(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+            vkCmdPipelineBarrier(GetCmdBuffer(vk), VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, 0, 1, &barrier, 0, nullptr, 0, nullptr);
 
             return true;
         }
@@ -1126,10 +1306,10 @@ namespace Graphics
         bool CreateAndUploadTexture(Globals& vk, Resources& resources, const Textures::Texture& texture, std::ofstream& log)
         {
             std::vector<VkImage>* textures;
-            std::vector<VkDeviceMemory>* textureMemory;
+            std::vector<rtxgi::vulkan::DDGIMemoryAllocation*>* textureMemory;
             std::vector<VkImageView>* textureViews;
             std::vector<VkBuffer>* uploadBuffers;
-            std::vector<VkDeviceMemory>* uploadBufferMemory;
+            std::vector<rtxgi::vulkan::DDGIMemoryAllocation*>* uploadBufferMemory;
             if (texture.type == Textures::ETextureType::SCENE)
             {
                 textures = &resources.sceneTextures;
@@ -1148,11 +1328,11 @@ namespace Graphics
             }
 
             VkImage& resource = textures->emplace_back();
-            VkDeviceMemory& resourceMemory = textureMemory->emplace_back();
+            rtxgi::vulkan::DDGIMemoryAllocation*& resourceMemory = textureMemory->emplace_back();
             VkImageView& resourceView = textureViews->emplace_back();
 
             VkBuffer& upload = uploadBuffers->emplace_back();
-            VkDeviceMemory& uploadMemory = uploadBufferMemory->emplace_back();
+            rtxgi::vulkan::DDGIMemoryAllocation*& uploadMemory = uploadBufferMemory->emplace_back();
 
             // Create the device texture resource, memory, and view
             {
@@ -1161,10 +1341,8 @@ namespace Graphics
                 CHECK(CreateTexture(vk, desc, &resource, &resourceMemory, &resourceView), "create the texture buffer, memory, and view!", log);
             #ifdef GFX_NAME_OBJECTS
                 std::string name = "Texture: " + texture.name;
-                std::string memory = "Texture Memory: " + texture.name;
                 std::string view = "Texture View: " + texture.name;
                 SetObjectName(vk.device, reinterpret_cast<uint64_t>(resource), name.c_str(), VK_OBJECT_TYPE_IMAGE);
-                SetObjectName(vk.device, reinterpret_cast<uint64_t>(resourceMemory), memory.c_str(), VK_OBJECT_TYPE_DEVICE_MEMORY);
                 SetObjectName(vk.device, reinterpret_cast<uint64_t>(resourceView), view.c_str(), VK_OBJECT_TYPE_IMAGE_VIEW);
             #endif
             }
@@ -1175,16 +1353,13 @@ namespace Graphics
                 CHECK(CreateBuffer(vk, desc, &upload, &uploadMemory), "create the texture upload buffer and memory!", log);
             #ifdef GFX_NAME_OBJECTS
                 std::string name = " Texture Upload Buffer: " + texture.name;
-                std::string memory = " Texture Upload Memory: " + texture.name;
                 SetObjectName(vk.device, reinterpret_cast<uint64_t>(upload), name.c_str(), VK_OBJECT_TYPE_BUFFER);
-                SetObjectName(vk.device, reinterpret_cast<uint64_t>(uploadMemory), memory.c_str(), VK_OBJECT_TYPE_DEVICE_MEMORY);
             #endif
             }
 
-            // Copy the texel data to the upload buffer resource
+            // Copy the texel data to the (persistently mapped) upload buffer resource
             {
-                uint8_t* pData = nullptr;
-                VKCHECK(vkMapMemory(vk.device, uploadMemory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&pData)));
+                uint8_t* pData = static_cast<uint8_t*>(uploadMemory->mappedData);
 
                 if (texture.format == Textures::ETextureFormat::BC7)
                 {
@@ -1213,8 +1388,6 @@ namespace Graphics
                         }
                     }
                 }
-
-                vkUnmapMemory(vk.device, uploadMemory);
             }
 
             // Schedule a copy the of the upload resource to the device resource, then transition it to a shader resource
@@ -1222,7 +1395,7 @@ namespace Graphics
                 // Transition the device texture to be a copy destination
                 VkImageSubresourceRange range = { VK_IMAGE_ASPECT_COLOR_BIT, 0, texture.mips, 0, 1 };
                 ImageBarrierDesc before = { VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, range };
-                SetImageMemoryBarrier(vk.cmdBuffer[vk.frameIndex], resource, before);
+                SetImageMemoryBarrier(GetCmdBuffer(vk), resource, before);
 
                 // Describe the buffer to image copy
                 // Copy each texture mip level from the upload heap to default heap
@@ -1257,11 +1430,11 @@ namespace Graphics
                 }
 
                 // Schedule a copy of the upload buffer to the device image buffer
-                vkCmdCopyBufferToImage(vk.cmdBuffer[vk.frameIndex], upload, resource, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(bufferImageCopies.size()), bufferImageCopies.data());
+                vkCmdCopyBufferToImage(GetCmdBuffer(vk), upload, resource, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(bufferImageCopies.size()), bufferImageCopies.data());
 
                 // Transition the device texture for reading in a shader
                 ImageBarrierDesc after = { VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, range };
-                SetImageMemoryBarrier(vk.cmdBuffer[vk.frameIndex], resource, after);
+                SetImageMemoryBarrier(GetCmdBuffer(vk), resource, after);
             }
 
             return true;
@@ -1391,7 +1564,7 @@ namespace Graphics
                 bind.binding = DescriptorLayoutBindings::SRV_TLAS;
                 bind.descriptorCount = maxAccelerationStructureDescriptorCount;
                 bind.descriptorType = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
-                bind.stageFlags = VK_SHADER_STAGE_RAYGEN_BIT_KHR;    // not allowing tracing in hit shaders (i.e. recursive tracing)
+                bind.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_RAYGEN_BIT_KHR;    // inline ray tracing in compute, not allowing tracing in hit shaders (i.e. recursive tracing)
 
                 bindings.push_back(bind);
             }
@@ -1429,6 +1602,29 @@ namespace Graphics
                 bindings.push_back(bind);
             }
 
+            // 14-22: Radiance Cache RWStructuredBuffers and RWByteAddressBuffers (see DDGI_VK.cpp::CreateCachingBuffers())
+            for (int binding = DescriptorLayoutBindings::UAV_HIT_CACHING; binding <= DescriptorLayoutBindings::UAV_RADIANCE_CACHE_RESERVOIRS; binding++)
+            {
+                VkDescriptorSetLayoutBinding bind = {};
+                bind.binding = binding;
+                bind.descriptorCount = 1;
+                bind.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                bind.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_RAYGEN_BIT_KHR;
+
+                bindings.push_back(bind);
+            }
+
+            // 23: DDGIVolume Probe Schedule RWByteAddressBuffers
+            {
+                VkDescriptorSetLayoutBinding bind = {};
+                bind.binding = DescriptorLayoutBindings::UAV_DDGI_PROBE_SCHEDULES;
+                bind.descriptorCount = 1;
+                bind.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                bind.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_RAYGEN_BIT_KHR;
+
+                bindings.push_back(bind);
+            }
+
             // Specify the descriptor binding flags for each binding
             VkDescriptorBindingFlags bindingFlags[] =
             {
@@ -1446,6 +1642,16 @@ namespace Graphics
                 VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT, // 11: Tex2D[]
                 VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT, // 12: Tex2DArray[]
                 VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT, // 13: ByteAddrBuffer[]
+                0, // 14: HitCaching RWStructuredBuffer
+                0, // 15: RadianceCaching RWStructuredBuffer
+                0, // 16: RadianceCachingVisualization RWStructuredBuffer
+                0, // 17: RadianceCacheAccumulation RWByteAddressBuffer
+                0, // 18: RadianceCacheMetadata RWByteAddressBuffer
+                0, // 19: ProbeRayHitMap RWStructuredBuffer
+                0, // 20: RadianceCacheWorkList RWStructuredBuffer
+                0, // 21: RadianceCacheWorkListArgs RWByteAddressBuffer
+                0, // 22: RadianceCacheReservoirs RWByteAddressBuffer
+                VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT, // 23: DDGIProbeSchedules[]
             };
             assert(_countof(bindingFlags) == bindings.size()); // must have 1 binding flag per binding slot
 
@@ -1546,10 +1752,10 @@ namespace Graphics
             };
 
             // Transition GBuffer resources for general use
-            SetImageLayoutBarrier(vk.cmdBuffer[vk.frameIndex], resources.rt.GBufferA, barrier);
-            SetImageLayoutBarrier(vk.cmdBuffer[vk.frameIndex], resources.rt.GBufferB, barrier);
-            SetImageLayoutBarrier(vk.cmdBuffer[vk.frameIndex], resources.rt.GBufferC, barrier);
-            SetImageLayoutBarrier(vk.cmdBuffer[vk.frameIndex], resources.rt.GBufferD, barrier);
+            SetImageLayoutBarrier(GetCmdBuffer(vk), resources.rt.GBufferA, barrier);
+            SetImageLayoutBarrier(GetCmdBuffer(vk), resources.rt.GBufferB, barrier);
+            SetImageLayoutBarrier(GetCmdBuffer(vk), resources.rt.GBufferC, barrier);
+            SetImageLayoutBarrier(GetCmdBuffer(vk), resources.rt.GBufferD, barrier);
 
             return true;
         }
@@ -1581,7 +1787,7 @@ namespace Graphics
          */
         void CleanupSwapchain(Globals& vk)
         {
-            for (uint32_t resourceIndex = 0; resourceIndex < MAX_FRAMES_IN_FLIGHT; resourceIndex++)
+            for (uint32_t resourceIndex = 0; resourceIndex < vk.swapChainImageCount; resourceIndex++)
             {
                 vkDestroyFramebuffer(vk.device, vk.frameBuffer[resourceIndex], nullptr);
                 vkDestroyImageView(vk.device, vk.swapChainImageView[resourceIndex], nullptr);
@@ -1592,14 +1798,16 @@ namespace Graphics
         /**
          * Release Vulkan resources.
          */
-        void Cleanup(VkDevice& device, Resources& resources)
+        void Cleanup(VkDevice& device, rtxgi::vulkan::DDGIMemoryPool* memoryPool, Resources& resources)
         {
             // Buffers
-            if (resources.cameraCBMemory) vkUnmapMemory(device, resources.cameraCBMemory);
+            if (resources.cameraCBUploadMemory) vkUnmapMemory(device, resources.cameraCBUploadMemory);
             if (resources.lightsSTBUploadMemory) vkUnmapMemory(device, resources.lightsSTBUploadMemory);
 
             vkDestroyBuffer(device, resources.cameraCB, nullptr);
             vkFreeMemory(device, resources.cameraCBMemory, nullptr);
+            vkDestroyBuffer(device, resources.cameraCBUploadBuffer, nullptr);
+            vkFreeMemory(device, resources.cameraCBUploadMemory, nullptr);
 
             vkDestroyBuffer(device, resources.lightsSTB, nullptr);
             vkFreeMemory(device, resources.lightsSTBMemory, nullptr);
@@ -1644,9 +1852,9 @@ namespace Graphics
             for (resourceIndex = 0; resourceIndex < resources.sceneIBs.size(); resourceIndex++)
             {
                 vkDestroyBuffer(device, resources.sceneIBs[resourceIndex], nullptr);
-                vkFreeMemory(device, resources.sceneIBMemory[resourceIndex], nullptr);
+                rtxgi::vulkan::FreeDDGIMemory(memoryPool, resources.sceneIBMemory[resourceIndex]);
                 vkDestroyBuffer(device, resources.sceneVBs[resourceIndex], nullptr);
-                vkFreeMemory(device, resources.sceneVBMemory[resourceIndex], nullptr);
+                rtxgi::vulkan::FreeDDGIMemory(memoryPool, resources.sceneVBMemory[resourceIndex]);
             }
             resources.sceneIBs.clear();
             resources.sceneIBMemory.clear();
@@ -1656,7 +1864,7 @@ namespace Graphics
             // Release Scene acceleration structures
             for (resourceIndex = 0; resourceIndex < resources.blas.size(); resourceIndex++)
             {
-                resources.blas[resourceIndex].Release(device);
+                resources.blas[resourceIndex].Release(device, memoryPool);
             }
             resources.tlas.Release(device);
 
@@ -1664,7 +1872,7 @@ namespace Graphics
             for (resourceIndex = 0; resourceIndex < resources.sceneTextures.size(); resourceIndex++)
             {
                 vkDestroyImage(device, resources.sceneTextures[resourceIndex], nullptr);
-                vkFreeMemory(device, resources.sceneTextureMemory[resourceIndex], nullptr);
+                rtxgi::vulkan::FreeDDGIMemory(memoryPool, resources.sceneTextureMemory[resourceIndex]);
                 vkDestroyImageView(device, resources.sceneTextureViews[resourceIndex], nullptr);
             }
 
@@ -1672,7 +1880,7 @@ namespace Graphics
             for (resourceIndex = 0; resourceIndex < resources.textures.size(); resourceIndex++)
             {
                 vkDestroyImage(device, resources.textures[resourceIndex], nullptr);
-                vkFreeMemory(device, resources.textureMemory[resourceIndex], nullptr);
+                rtxgi::vulkan::FreeDDGIMemory(memoryPool, resources.textureMemory[resourceIndex]);
                 vkDestroyImageView(device, resources.textureViews[resourceIndex], nullptr);
             }
 
@@ -1704,24 +1912,45 @@ namespace Graphics
         {
             uint32_t resourceIndex;
 
+            vk.passWorkers.Stop();
+
+            // Write the pending image captures
+            ImageCapture::Flush();
+
             Shaders::Cleanup(vk.shaderCompiler);
+            ReleasePipelineCache(vk);
 
             // Release core Vulkan objects
             for (resourceIndex = 0; resourceIndex < MAX_FRAMES_IN_FLIGHT; resourceIndex++)
             {
                 vkDestroySemaphore(vk.device, vk.imageAcquiredSemaphore[resourceIndex], nullptr);
                 vkDestroySemaphore(vk.device, vk.presentSemaphore[resourceIndex], nullptr);
+            }
+            vkDestroySemaphore(vk.device, vk.frameSemaphore, nullptr);
+            vkDestroySemaphore(vk.device, vk.graphicsToComputeSemaphore, nullptr);
+            vkDestroySemaphore(vk.device, vk.computeToGraphicsSemaphore, nullptr);
+
+            for (resourceIndex = 0; resourceIndex < vk.swapChainImageCount; resourceIndex++)
+            {
                 vkDestroyFramebuffer(vk.device, vk.frameBuffer[resourceIndex], nullptr);
-                vkDestroyFence(vk.device, vk.fences[resourceIndex], nullptr);
                 vkDestroyImageView(vk.device, vk.swapChainImageView[resourceIndex], nullptr);
             }
 
             vkFreeCommandBuffers(vk.device, vk.commandPool, MAX_FRAMES_IN_FLIGHT, vk.cmdBuffer);
             vkDestroyCommandPool(vk.device, vk.commandPool, nullptr);
+            for (resourceIndex = 0; resourceIndex < MAX_FRAMES_IN_FLIGHT; resourceIndex++)
+            {
+                for (uint32_t passIndex = 0; passIndex <= MAX_PASS_CMD_LISTS; passIndex++)
+                {
+                    vkDestroyCommandPool(vk.device, vk.passCommandPool[resourceIndex][passIndex], nullptr); // frees its command buffer
+                }
+                vkDestroyCommandPool(vk.device, vk.computeCommandPool[resourceIndex], nullptr);
+            }
             vkDestroyRenderPass(vk.device, vk.renderPass, nullptr);
             vkDestroyFence(vk.device, vk.immediateFence, nullptr);
             vkDestroySwapchainKHR(vk.device, vk.swapChain, nullptr);
             vkDestroySurfaceKHR(vk.instance, vk.surface, nullptr);
+            rtxgi::vulkan::DestroyDDGIMemoryPool(vk.memoryPool);
             vkDestroyDevice(vk.device, nullptr);
 
         #if _DEBUG
@@ -1741,17 +1970,22 @@ namespace Graphics
          */
         bool CreateSceneCameraConstantBuffer(Globals& vk, Resources& resources, const Scenes::Scene& scene)
         {
-            // Create the camera buffer resource and allocate device memory
+            // Create the camera upload buffer resource (a slot per frame in flight) and allocate host memory
             uint32_t size = ALIGN(256, Scenes::Camera::GetGPUDataSize());
-            BufferDesc desc = { size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT };
+            BufferDesc desc = { size * MAX_FRAMES_IN_FLIGHT, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT };
+            if (!CreateBuffer(vk, desc, &resources.cameraCBUploadBuffer, &resources.cameraCBUploadMemory)) return false;
+
+            // Create the camera buffer resource and allocate device memory
+            desc = { size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT };
             if (!CreateBuffer(vk, desc, &resources.cameraCB, &resources.cameraCBMemory)) return false;
         #ifdef GFX_NAME_OBJECTS
             SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.cameraCB), "Camera Constant Buffer", VK_OBJECT_TYPE_BUFFER);
             SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.cameraCBMemory), "Camera Constant Buffer Memory", VK_OBJECT_TYPE_DEVICE_MEMORY);
+            SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.cameraCBUploadBuffer), "Camera Constant Upload Buffer", VK_OBJECT_TYPE_BUFFER);
         #endif
 
-            // Map the buffer for updates
-            VKCHECK(vkMapMemory(vk.device, resources.cameraCBMemory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&resources.cameraCBPtr)));
+            // Map the upload buffer for updates
+            VKCHECK(vkMapMemory(vk.device, resources.cameraCBUploadMemory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&resources.cameraCBPtr)));
 
             return true;
         }
@@ -1764,11 +1998,12 @@ namespace Graphics
             uint32_t size = ALIGN(256, Scenes::Light::GetGPUDataSize() * static_cast<uint32_t>(scene.lights.size()));
             if (size == 0) return true; // scenes with no lights are valid
 
-            // Create the lights upload buffer resource and allocate host memory
-            BufferDesc desc = { size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT };
+            // Create the lights upload buffer resource (a slot per frame in flight) and allocate host memory
+            BufferDesc desc = { size * MAX_FRAMES_IN_FLIGHT, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT };
             if (!CreateBuffer(vk, desc, &resources.lightsSTBUploadBuffer, &resources.lightsSTBUploadMemory)) return false;
 
             // Create the lights device buffer resource and allocate device memory
+            desc.size = size;
             desc.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
             desc.memoryPropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
             if (!CreateBuffer(vk, desc, &resources.lightsSTB, &resources.lightsSTBMemory)) return false;
@@ -1777,8 +2012,8 @@ namespace Graphics
             SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.lightsSTBMemory), "Lights Structured Buffer Memory", VK_OBJECT_TYPE_DEVICE_MEMORY);
         #endif
 
-            // Copy the lights to the upload buffer. Leave the buffer mapped for updates.
-            uint32_t offset = 0;
+            // Copy the lights to the current frame's slot of the upload buffer. Leave the buffer mapped for updates.
+            uint32_t offset = size * vk.frameIndex;
             VKCHECK(vkMapMemory(vk.device, resources.lightsSTBUploadMemory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&resources.lightsSTBPtr)));
             for (uint32_t lightIndex = 0; lightIndex < static_cast<uint32_t>(scene.lights.size()); lightIndex++)
             {
@@ -1789,8 +2024,9 @@ namespace Graphics
 
             // Schedule a copy of the upload buffer to the device buffer
             VkBufferCopy bufferCopy = {};
+            bufferCopy.srcOffset = size * vk.frameIndex;
             bufferCopy.size = size;
-            vkCmdCopyBuffer(vk.cmdBuffer[vk.frameIndex], resources.lightsSTBUploadBuffer, resources.lightsSTB, 1, &bufferCopy);
+            vkCmdCopyBuffer(GetCmdBuffer(vk), resources.lightsSTBUploadBuffer, resources.lightsSTB, 1, &bufferCopy);
 
             return true;
         }
@@ -1839,7 +2075,7 @@ namespace Graphics
             // Schedule a copy of the upload buffer to the device buffer
             VkBufferCopy bufferCopy = {};
             bufferCopy.size = sizeInBytes;
-            vkCmdCopyBuffer(vk.cmdBuffer[vk.frameIndex], resources.materialsSTBUploadBuffer, resources.materialsSTB, 1, &bufferCopy);
+            vkCmdCopyBuffer(GetCmdBuffer(vk), resources.materialsSTBUploadBuffer, resources.materialsSTB, 1, &bufferCopy);
 
             return true;
         }
@@ -1915,6 +2151,7 @@ namespace Graphics
                     data.materialIndex = primitive.material;
                     data.indexByteAddress = primitive.indexByteOffset;
                     data.vertexByteAddress = primitive.vertexByteOffset;
+                    data.albedoByteAddress = 0xFFFFFFFF; // vertex albedos are not uploaded (D3D12 only)
                     memcpy(geometryDataAddress, &data, sizeof(GeometryData));
 
                     geometryDataAddress += sizeof(GeometryData);
@@ -1927,10 +2164,10 @@ namespace Graphics
             // Schedule a copy of the upload buffers to the device buffers
             VkBufferCopy bufferCopy = {};
             bufferCopy.size = meshOffsetsSize;
-            vkCmdCopyBuffer(vk.cmdBuffer[vk.frameIndex], resources.meshOffsetsRBUploadBuffer, resources.meshOffsetsRB, 1, &bufferCopy);
+            vkCmdCopyBuffer(GetCmdBuffer(vk), resources.meshOffsetsRBUploadBuffer, resources.meshOffsetsRB, 1, &bufferCopy);
 
             bufferCopy.size = geometryDataSize;
-            vkCmdCopyBuffer(vk.cmdBuffer[vk.frameIndex], resources.geometryDataRBUploadBuffer, resources.geometryDataRB, 1, &bufferCopy);
+            vkCmdCopyBuffer(GetCmdBuffer(vk), resources.geometryDataRBUploadBuffer, resources.geometryDataRB, 1, &bufferCopy);
 
             return true;
         }
@@ -1963,7 +2200,7 @@ namespace Graphics
             // Schedule a copy of the upload buffer to the device buffer
             VkBufferCopy bufferCopy = {};
             bufferCopy.size = size;
-            vkCmdCopyBuffer(vk.cmdBuffer[vk.frameIndex], resources.tlas.instancesUpload, resources.tlas.instances, 1, &bufferCopy);
+            vkCmdCopyBuffer(GetCmdBuffer(vk), resources.tlas.instancesUpload, resources.tlas.instances, 1, &bufferCopy);
 
             return true;
         }
@@ -1992,9 +2229,7 @@ namespace Graphics
                     &resources.sceneIBUploadMemory[meshIndex])) return false;
             #ifdef GFX_NAME_OBJECTS
                 std::string name = "IB: " + mesh.name;
-                std::string memoryName = "IB: " + mesh.name + " Memory";
                 SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.sceneIBs[meshIndex]), name.c_str(), VK_OBJECT_TYPE_BUFFER);
-                SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.sceneIBMemory[meshIndex]), memoryName.c_str(), VK_OBJECT_TYPE_DEVICE_MEMORY);
             #endif
             }
             return true;
@@ -2024,9 +2259,7 @@ namespace Graphics
                     &resources.sceneVBUploadMemory[meshIndex])) return false;
             #ifdef GFX_NAME_OBJECTS
                 std::string name = "VB: " + mesh.name;
-                std::string memoryName = "VB: " + mesh.name + " Memory";
                 SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.sceneVBs[meshIndex]), name.c_str(), VK_OBJECT_TYPE_BUFFER);
-                SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.sceneVBMemory[meshIndex]), memoryName.c_str(), VK_OBJECT_TYPE_DEVICE_MEMORY);
             #endif
             }
 
@@ -2052,12 +2285,9 @@ namespace Graphics
                 std::string name = "BLAS: " + mesh.name;
                 std::string memory = "BLAS Memory: " + mesh.name;
                 std::string scratch = "BLAS Scratch: " + mesh.name;
-                std::string scratchMemory = "BLAS Scratch Memory: " + mesh.name;
                 SetObjectName(vk.device, reinterpret_cast<uint64_t>(as.asKHR), name.c_str(), VK_OBJECT_TYPE_ACCELERATION_STRUCTURE_KHR);
                 SetObjectName(vk.device, reinterpret_cast<uint64_t>(as.asBuffer), memory.c_str(), VK_OBJECT_TYPE_BUFFER);
-                SetObjectName(vk.device, reinterpret_cast<uint64_t>(as.asMemory), memory.c_str(), VK_OBJECT_TYPE_DEVICE_MEMORY);
                 SetObjectName(vk.device, reinterpret_cast<uint64_t>(as.scratch), scratch.c_str(), VK_OBJECT_TYPE_BUFFER);
-                SetObjectName(vk.device, reinterpret_cast<uint64_t>(as.scratchMemory), scratchMemory.c_str(), VK_OBJECT_TYPE_DEVICE_MEMORY);
             #endif
             }
 
@@ -2065,7 +2295,7 @@ namespace Graphics
             VkMemoryBarrier barrier{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
             barrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
             barrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
-            vkCmdPipelineBarrier(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+            vkCmdPipelineBarrier(GetCmdBuffer(vk), VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, 0, 1, &barrier, 0, nullptr, 0, nullptr);
 
             return true;
         }
@@ -2401,14 +2631,16 @@ namespace Graphics
                 uint8_t* pData = nullptr;
                 VKCHECK(vkMapMemory(vk.device, stagingBufferMemory[subresourceIndex], 0, VK_WHOLE_SIZE, 0, (void**)&pData));
 
-                std::vector<uint8_t> converted(width * height * ImageCapture::NumChannels);
-                memcpy(converted.data(), pData, converted.size());
+                std::shared_ptr<std::vector<uint8_t>> converted = std::make_shared<std::vector<uint8_t>>(width * height * ImageCapture::NumChannels);
+                memcpy(converted->data(), pData, converted->size());
 
-                // Write the resource to disk as a PNG file (using STB)
+                // Write the resource to disk in the capture format, on the ImageCapture writer threads
                 std::string filename = file;
                 if (arraySize > 1) filename += "-Layer-" + std::to_string(subresourceIndex);
-                filename.append(".png");
-                result &= ImageCapture::CapturePng(filename, width, height, converted.data());
+                ImageCapture::QueueWrite([filename, width, height, converted]()
+                {
+                    return ImageCapture::CaptureImage(filename, width, height, converted->data());
+                });
 
                 // Unmap the linear buffers's memory
                 vkUnmapMemory(vk.device, stagingBufferMemory[subresourceIndex]);
@@ -2450,6 +2682,11 @@ namespace Graphics
          * Add a performance marker to the command buffer.
          */
         void AddPerfMarker(Globals& vk, uint8_t r, uint8_t g, uint8_t b, std::string name)
+        {
+            AddPerfMarker(GetCmdBuffer(vk), r, g, b, name);
+        }
+
+        void AddPerfMarker(VkCommandBuffer cmdBuffer, uint8_t r, uint8_t g, uint8_t b, std::string name)
         {
             VkDebugUtilsLabelEXT label = {};
             label.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT;
@@ -2458,7 +2695,7 @@ namespace Graphics
             label.color[1] = (float)g / 255.f;
             label.color[2] = (float)b / 255.f;
             label.color[3] = 1.f;
-            vkCmdBeginDebugUtilsLabelEXT(vk.cmdBuffer[vk.frameIndex], &label);
+            vkCmdBeginDebugUtilsLabelEXT(cmdBuffer, &label);
         }
     #endif
 
@@ -2492,6 +2729,58 @@ namespace Graphics
             return true;
         }
 
+        /**
+         * Set the resolution of DDGI mode's screen-space passes, a fraction (per axis) of the render targets'.
+         * The render size is even (quad aligned), and the full size at a scale of one.
+         */
+        void SetResolutionScale(Globals& vk, float scale)
+        {
+            vk.resolutionScale = (std::min)((std::max)(scale, 0.25f), 1.f);
+            if (vk.resolutionScale < 1.f)
+            {
+                vk.renderWidth = (std::max)(static_cast<int>(vk.width * vk.resolutionScale) & ~1, 2);
+                vk.renderHeight = (std::max)(static_cast<int>(vk.height * vk.resolutionScale) & ~1, 2);
+            }
+            else
+            {
+                vk.renderWidth = vk.width;
+                vk.renderHeight = vk.height;
+            }
+
+            vk.renderViewport = vk.viewport;
+            vk.renderViewport.width = static_cast<float>(vk.renderWidth);
+            vk.renderViewport.height = static_cast<float>(vk.renderHeight);
+            vk.renderScissor = vk.scissor;
+            vk.renderScissor.extent.width = vk.renderWidth;
+            vk.renderScissor.extent.height = vk.renderHeight;
+        }
+
+        /**
+         * Get the video memory budget of the process (from VK_EXT_memory_budget) and its usage, summed over the device local heaps.
+         */
+        bool GetVideoMemoryInfo(Globals& vk, uint64_t& budget, uint64_t& usage)
+        {
+            if (!vk.supportsMemoryBudget) return false;
+
+            VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties = {};
+            budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+            VkPhysicalDeviceMemoryProperties2 memoryProperties = {};
+            memoryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+            memoryProperties.pNext = &budgetProperties;
+            vkGetPhysicalDeviceMemoryProperties2(vk.physicalDevice, &memoryProperties);
+
+            budget = 0;
+            usage = 0;
+            for (uint32_t heapIndex = 0; heapIndex < memoryProperties.memoryProperties.memoryHeapCount; heapIndex++)
+            {
+                if ((memoryProperties.memoryProperties.memoryHeaps[heapIndex].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) == 0) continue;
+                budget += budgetProperties.heapBudget[heapIndex];
+                usage += budgetProperties.heapUsage[heapIndex];
+            }
+            return true;
+        }
+
         /**
          * Create a Vulkan device.
          */
@@ -2632,6 +2921,19 @@ namespace Graphics
             vkCmdPipelineBarrier(cmdBuffer, info.srcMask, info.dstMask, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
         }
 
+        /**
+         * Share a resource between the graphics and compute queue families when the DDGI update chain runs on a dedicated compute queue.
+         * Concurrent sharing keeps the resources accessible from both queues without queue family ownership transfers.
+         */
+        template<typename T>
+        void SetQueueFamilySharing(const Globals& vk, T& createInfo)
+        {
+            if (!vk.DDGIAsyncCompute || vk.computeQueueFamilyIndex == vk.queueFamilyIndex) return;
+            createInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+            createInfo.queueFamilyIndexCount = 2;
+            createInfo.pQueueFamilyIndices = vk.sharedQueueFamilyIndices;
+        }
+
         /**
          * Create a buffer, allocate and bind device memory to the buffer.
          */
@@ -2642,6 +2944,7 @@ namespace Graphics
             bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
             bufferCreateInfo.size = info.size;
             bufferCreateInfo.usage = info.usage;
+            SetQueueFamilySharing(vk, bufferCreateInfo);
 
             // Create the buffer
             VKCHECK(vkCreateBuffer(vk.device, &bufferCreateInfo, nullptr, buffer));
@@ -2659,6 +2962,37 @@ namespace Graphics
             return true;
         }
 
+        /**
+         * Create a buffer, suballocate device memory from the memory pool and bind it to the buffer.
+         */
+        bool CreateBuffer(Globals& vk, const BufferDesc& info, VkBuffer* buffer, rtxgi::vulkan::DDGIMemoryAllocation** allocation)
+        {
+            // Describe the buffer
+            VkBufferCreateInfo bufferCreateInfo = {};
+            bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            bufferCreateInfo.size = info.size;
+            bufferCreateInfo.usage = info.usage;
+            SetQueueFamilySharing(vk, bufferCreateInfo);
+
+            // Create the buffer
+            VKCHECK(vkCreateBuffer(vk.device, &bufferCreateInfo, nullptr, buffer));
+
+            // Describe the memory allocation
+            rtxgi::vulkan::DDGIMemoryAllocationDesc desc = {};
+            vkGetBufferMemoryRequirements(vk.device, *buffer, &desc.requirements);
+            desc.properties = info.memoryPropertyFlags;
+            desc.flags = info.usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT ? VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT : 0;
+
+            // Buffers are no longer at the start of their memory, keep device addresses aligned for acceleration structure scratch data
+            if (desc.flags) desc.requirements.alignment = std::max(desc.requirements.alignment, (VkDeviceSize)vk.deviceASProps.minAccelerationStructureScratchOffsetAlignment);
+
+            // Allocate and bind memory to the buffer
+            if (rtxgi::vulkan::AllocateDDGIMemory(vk.memoryPool, desc, allocation) != rtxgi::ERTXGIStatus::OK) return false;
+            VKCHECK(vkBindBufferMemory(vk.device, *buffer, (*allocation)->memory, (*allocation)->offset));
+
+            return true;
+        }
+
         /**
          * Create a texture, allocate and bind device memory, and create the texture's image view.
          */
@@ -2679,6 +3013,7 @@ namespace Graphics
             imageCreateInfo.usage = info.usage;
             imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
             imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            SetQueueFamilySharing(vk, imageCreateInfo);
 
             // Create the texture
             VKCHECK(vkCreateImage(vk.device, &imageCreateInfo, nullptr, image));
@@ -2710,6 +3045,51 @@ namespace Graphics
             return true;
         }
 
+        /**
+         * Create a texture, suballocate device memory from the memory pool and bind it, and create the texture's image view.
+         */
+        bool CreateTexture(Globals& vk, const TextureDesc& info, VkImage* image, rtxgi::vulkan::DDGIMemoryAllocation** allocation, VkImageView* imageView)
+        {
+            // Describe the texture
+            VkImageCreateInfo imageCreateInfo = {};
+            imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageCreateInfo.format = info.format;
+            imageCreateInfo.extent.width = info.width;
+            imageCreateInfo.extent.height = info.height;
+            imageCreateInfo.extent.depth = 1;
+            imageCreateInfo.mipLevels = info.mips;
+            imageCreateInfo.arrayLayers = info.arraySize;
+            imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageCreateInfo.usage = info.usage;
+            imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            SetQueueFamilySharing(vk, imageCreateInfo);
+
+            // Create the texture
+            VKCHECK(vkCreateImage(vk.device, &imageCreateInfo, nullptr, image));
+
+            // Suballocate the texture memory and bind it to the texture
+            if (rtxgi::vulkan::AllocateDDGIImageMemory(vk.memoryPool, *image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, allocation) != rtxgi::ERTXGIStatus::OK) return false;
+
+            // Describe the texture's image view
+            VkImageViewCreateInfo imageViewCreateInfo = {};
+            imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            imageViewCreateInfo.format = imageCreateInfo.format;
+            imageViewCreateInfo.image = *image;
+            imageViewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            imageViewCreateInfo.subresourceRange.levelCount = info.mips;
+            imageViewCreateInfo.subresourceRange.layerCount = info.arraySize;
+            if(info.arraySize > 1) imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+            else imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+
+            // Create the texture's image view
+            VKCHECK(vkCreateImageView(vk.device, &imageViewCreateInfo, nullptr, imageView));
+
+            return true;
+        }
+
         /**
          * Create a shader module from compiled DXIL bytecode.
          */
@@ -2784,7 +3164,7 @@ namespace Graphics
         /**
          * Create a rasterization pipeline.
          */
-        bool CreateRasterPipeline(VkDevice device, VkPipelineLayout pipelineLayout, VkRenderPass renderPass, const Shaders::ShaderPipeline& shaders, const ShaderModules& modules, const RasterDesc& desc, VkPipeline* pipeline)
+        bool CreateRasterPipeline(Globals& vk, VkPipelineLayout pipelineLayout, VkRenderPass renderPass, const Shaders::ShaderPipeline& shaders, const ShaderModules& modules, const RasterDesc& desc, VkPipeline* pipeline)
         {
             uint32_t numStages = shaders.numStages();
             uint32_t stageIndex = 0;
@@ -2837,7 +3217,7 @@ namespace Graphics
             rasterPipelineCreateInfo.stageCount = stageIndex;
 
             // Create the raster pipeline
-            VKCHECK(vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &rasterPipelineCreateInfo, nullptr, pipeline));
+            VKCHECK(vkCreateGraphicsPipelines(vk.device, vk.pipelineCache, 1, &rasterPipelineCreateInfo, nullptr, pipeline));
 
             return true;
         }
@@ -2845,7 +3225,7 @@ namespace Graphics
         /**
          * Create a compute pipeline.
          */
-        bool CreateComputePipeline(VkDevice device, VkPipelineLayout pipelineLayout, const Shaders::ShaderProgram& shader, const VkShaderModule& module, VkPipeline* pipeline)
+        bool CreateComputePipeline(Globals& vk, VkPipelineLayout pipelineLayout, const Shaders::ShaderProgram& shader, const VkShaderModule& module, VkPipeline* pipeline)
         {
             std::string entryPoint;
             std::wstring name = std::wstring(shader.entryPoint);
@@ -2862,7 +3242,7 @@ namespace Graphics
             computePipelineCreateInfo.layout = pipelineLayout;
 
             // Create the pipeline
-            VKCHECK(vkCreateComputePipelines(device, nullptr, 1, &computePipelineCreateInfo, nullptr, pipeline));
+            VKCHECK(vkCreateComputePipelines(vk.device, vk.pipelineCache, 1, &computePipelineCreateInfo, nullptr, pipeline));
 
             return true;
         }
@@ -2870,7 +3250,7 @@ namespace Graphics
         /**
          * Create a ray tracing pipeline.
          */
-        bool CreateRayTracingPipeline(VkDevice device, VkPipelineLayout pipelineLayout, const Shaders::ShaderRTPipeline& shaders, const RTShaderModules& modules, VkPipeline* pipeline)
+        bool CreateRayTracingPipeline(Globals& vk, VkPipelineLayout pipelineLayout, const Shaders::ShaderRTPipeline& shaders, const RTShaderModules& modules, VkPipeline* pipeline)
         {
             uint32_t numStages = 2;     // rgs + miss + (chs + ahs + is)
             uint32_t numGroups = 2;     // rgs + miss + hitGroups
@@ -2983,7 +3363,7 @@ namespace Graphics
                 // Describe the group for the shader hit group
                 VkRayTracingShaderGroupCreateInfoKHR group = {};
                 group.sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
-                group.type = VK_RAY_TRACING_SHADER_GROUP_TYPE_TRIANGLES_HIT_GROUP_KHR;
+                group.type = hitGroup.hasIS() ? VK_RAY_TRACING_SHADER_GROUP_TYPE_PROCEDURAL_HIT_GROUP_KHR : VK_RAY_TRACING_SHADER_GROUP_TYPE_TRIANGLES_HIT_GROUP_KHR;
                 group.generalShader = VK_SHADER_UNUSED_KHR;
                 group.closestHitShader = VK_SHADER_UNUSED_KHR;
                 group.anyHitShader = VK_SHADER_UNUSED_KHR;
@@ -3055,7 +3435,7 @@ namespace Graphics
             rayTracingPipelineCreateInfo.flags = VK_PIPELINE_CREATE_RAY_TRACING_SKIP_AABBS_BIT_KHR;
 
             // Create the pipeline
-            VKCHECK(vkCreateRayTracingPipelinesKHR(device, 0, 0, 1, &rayTracingPipelineCreateInfo, nullptr, pipeline));
+            VKCHECK(vkCreateRayTracingPipelinesKHR(vk.device, 0, vk.pipelineCache, 1, &rayTracingPipelineCreateInfo, nullptr, pipeline));
             return true;
         }
 
@@ -3068,14 +3448,14 @@ namespace Graphics
 
             VkRenderPassBeginInfo renderPassBeginInfo = {};
             renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-            renderPassBeginInfo.framebuffer = vk.frameBuffer[vk.frameIndex];
+            renderPassBeginInfo.framebuffer = vk.frameBuffer[vk.imageIndex];
             renderPassBeginInfo.renderArea.extent.width = vk.width;
             renderPassBeginInfo.renderArea.extent.height = vk.height;
             renderPassBeginInfo.renderPass = vk.renderPass;
             renderPassBeginInfo.pClearValues = &clearValue;
             renderPassBeginInfo.clearValueCount = 1;
 
-            vkCmdBeginRenderPass(vk.cmdBuffer[vk.frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+            vkCmdBeginRenderPass(GetCmdBuffer(vk), &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
         }
 
         /**
@@ -3087,6 +3467,9 @@ namespace Graphics
             vk.width = config.app.width;
             vk.height = config.app.height;
             vk.vsync = config.app.vsync;
+            vk.parallelRecording = config.app.parallelRecording;
+            vk.RadianceCacheHashFunction = config.ddgi.radianceCacheHash;
+            vk.RadianceCacheBrickLayout = config.ddgi.radianceCacheBricks;
 
             // Lighting constants
             resources.constants.lights.hasDirectionalLight = scene.hasDirectionalLight;
@@ -3097,15 +3480,26 @@ namespace Graphics
             CHECK(Shaders::Initialize(config, vk.shaderCompiler), "initialize the shader compiler!", log);
 
             // Create Vulkan device objects
+            CHECK(CreatePipelineCache(vk, config), "create pipeline cache!", log);
             CHECK(CreateCommandPool(vk), "create command pool!", log);
             CHECK(CreateCommandBuffers(vk), "create command buffers!", log);
+
+            // Start the pass recording workers, the main thread records a pass too
+            if (vk.parallelRecording)
+            {
+                uint32_t numWorkers = (std::max)(std::thread::hardware_concurrency(), 2u) - 1;
+                vk.passWorkers.Start((std::min)(numWorkers, static_cast<uint32_t>(MAX_PASS_CMD_LISTS - 1)));
+            }
+
             CHECK(CreateFences(vk), "create fences!", log);
             CHECK(CreateSemaphores(vk), "create semaphores!", log);
             CHECK(CreateDescriptorPool(vk, resources), "create descriptor pool!", log);
+            CHECK(CreateMemoryPool(vk), "create memory pool!", log);
             CHECK(CreateGlobalPipelineLayout(vk, resources), "create global pipeline layout!", log);
             CHECK(CreateSamplers(vk, resources), "create samplers!", log);
             CHECK(CreateViewport(vk), "create viewport!", log);
             CHECK(CreateScissor(vk), "create scissor!", log);
+            SetResolutionScale(vk, vk.resolutionScale);
 
             // Create Vulkan device objects that require command buffer operations (e.g. transitions)
             CHECK(ResetCmdList(vk), "reset command buffer!", log);
@@ -3162,9 +3556,9 @@ namespace Graphics
             for (resourceIndex = 0; resourceIndex < static_cast<uint32_t>(resources.sceneIBs.size()); resourceIndex++)
             {
                 vkDestroyBuffer(vk.device, resources.sceneIBUploadBuffers[resourceIndex], nullptr);
-                vkFreeMemory(vk.device, resources.sceneIBUploadMemory[resourceIndex], nullptr);
+                rtxgi::vulkan::FreeDDGIMemory(vk.memoryPool, resources.sceneIBUploadMemory[resourceIndex]);
                 vkDestroyBuffer(vk.device, resources.sceneVBUploadBuffers[resourceIndex], nullptr);
-                vkFreeMemory(vk.device, resources.sceneVBUploadMemory[resourceIndex], nullptr);
+                rtxgi::vulkan::FreeDDGIMemory(vk.memoryPool, resources.sceneVBUploadMemory[resourceIndex]);
             }
             resources.sceneIBUploadBuffers.clear();
             resources.sceneIBUploadMemory.clear();
@@ -3175,7 +3569,7 @@ namespace Graphics
             for (resourceIndex = 0; resourceIndex < static_cast<uint32_t>(resources.sceneTextures.size()); resourceIndex++)
             {
                 vkDestroyBuffer(vk.device, resources.sceneTextureUploadBuffer[resourceIndex], nullptr);
-                vkFreeMemory(vk.device, resources.sceneTextureUploadMemory[resourceIndex], nullptr);
+                rtxgi::vulkan::FreeDDGIMemory(vk.memoryPool, resources.sceneTextureUploadMemory[resourceIndex]);
             }
             resources.sceneTextureUploadBuffer.clear();
             resources.sceneTextureUploadMemory.clear();
@@ -3184,11 +3578,14 @@ namespace Graphics
             for (resourceIndex = 0; resourceIndex < static_cast<uint32_t>(resources.textures.size()); resourceIndex++)
             {
                 vkDestroyBuffer(vk.device, resources.textureUploadBuffer[resourceIndex], nullptr);
-                vkFreeMemory(vk.device, resources.textureUploadMemory[resourceIndex], nullptr);
+                rtxgi::vulkan::FreeDDGIMemory(vk.memoryPool, resources.textureUploadMemory[resourceIndex]);
             }
             resources.textureUploadBuffer.clear();
             resources.textureUploadMemory.clear();
 
+            // Release the (now empty) upload memory blocks
+            rtxgi::vulkan::ReleaseDDGIMemoryPoolEmptyBlocks(vk.memoryPool);
+
             // Unload the CPU-side textures
             Scenes::Cleanup(scene);
 
@@ -3226,20 +3623,27 @@ namespace Graphics
 
             // Update the camera constant buffer
             Scenes::Camera& camera = scene.GetActiveCamera();
-            camera.data.resolution.x = (float)vk.width;
-            camera.data.resolution.y = (float)vk.height;
-            camera.data.aspect = camera.data.resolution.x / camera.data.resolution.y;
-            memcpy(resources.cameraCBPtr, camera.GetGPUData(), camera.GetGPUDataSize());
+            // The resolution of the screen-space passes (smaller than the window with dynamic resolution)
+            camera.data.resolution.x = (float)vk.renderWidth;
+            camera.data.resolution.y = (float)vk.renderHeight;
+            camera.data.aspect = (float)vk.width / (float)vk.height;
+
+            // Write the camera to this frame's upload slot, earlier frames may still be reading theirs
+            uint32_t cameraSize = ALIGN(256, Scenes::Camera::GetGPUDataSize());
+            memcpy(resources.cameraCBPtr + (cameraSize * vk.frameIndex), camera.GetGPUData(), camera.GetGPUDataSize());
+
+            VkBufferCopy bufferCopy = {};
+            bufferCopy.srcOffset = cameraSize * vk.frameIndex;
+            bufferCopy.size = camera.GetGPUDataSize();
+            vkCmdCopyBuffer(GetCmdBuffer(vk), resources.cameraCBUploadBuffer, resources.cameraCB, 1, &bufferCopy);
 
-            // Update the lights buffer for lights that have been modified
+            // Update the lights buffer up to the last light that has been modified
             uint32_t lastDirtyLight = 0;
             for (uint32_t lightIndex = 0; lightIndex < static_cast<uint32_t>(scene.lights.size()); lightIndex++)
             {
                 Scenes::Light& light = scene.lights[lightIndex];
                 if (light.dirty)
                 {
-                    uint32_t offset = lightIndex * Scenes::Light::GetGPUDataSize();
-                    memcpy(resources.lightsSTBPtr + offset, light.GetGPUData(), Scenes::Light::GetGPUDataSize());
                     light.dirty = false;
                     lastDirtyLight = lightIndex + 1;
                 }
@@ -3247,11 +3651,25 @@ namespace Graphics
 
             if (lastDirtyLight > 0)
             {
-                // Schedule a copy of the upload buffer to the device buffer
-                VkBufferCopy bufferCopy = {};
+                // Copy the lights to this frame's upload slot, the slot is rewritten MAX_FRAMES_IN_FLIGHT frames from now
+                uint32_t lightsSize = ALIGN(256, Scenes::Light::GetGPUDataSize() * static_cast<uint32_t>(scene.lights.size()));
+                uint8_t* pData = resources.lightsSTBPtr + (lightsSize * vk.frameIndex);
+                for (uint32_t lightIndex = 0; lightIndex < lastDirtyLight; lightIndex++)
+                {
+                    memcpy(pData + (lightIndex * Scenes::Light::GetGPUDataSize()), scene.lights[lightIndex].GetGPUData(), Scenes::Light::GetGPUDataSize());
+                }
+
+                // Schedule a copy of the upload buffer slot to the device buffer
+                bufferCopy.srcOffset = lightsSize * vk.frameIndex;
                 bufferCopy.size = Scenes::Light::GetGPUDataSize() * lastDirtyLight;
-                vkCmdCopyBuffer(vk.cmdBuffer[vk.frameIndex], resources.lightsSTBUploadBuffer, resources.lightsSTB, 1, &bufferCopy);
+                vkCmdCopyBuffer(GetCmdBuffer(vk), resources.lightsSTBUploadBuffer, resources.lightsSTB, 1, &bufferCopy);
             }
+
+            // Wait for the copies to complete before shaders read the camera and lights
+            VkMemoryBarrier barrier{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+            vkCmdPipelineBarrier(GetCmdBuffer(vk), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
         }
 
         /**
@@ -3266,6 +3684,7 @@ namespace Graphics
             vk.viewport.height = static_cast<float>(vk.height);
             vk.scissor.extent.width = vk.width;
             vk.scissor.extent.height = vk.height;
+            SetResolutionScale(vk, vk.resolutionScale);
 
             // Wait for the GPU to finish up any work
             VKCHECK(vkDeviceWaitIdle(vk.device));
@@ -3315,6 +3734,19 @@ namespace Graphics
             return true;
         }
 
+        // The command buffer the calling thread records to, set by RecordPasses(). Unset, the frame's command buffer.
+        static thread_local VkCommandBuffer recordingCmdBuffer = nullptr;
+
+        /**
+         * Get the command buffer the calling thread records to: a pass's buffer inside RecordPasses(), the buffer of the
+         * work after the passes once RecordPasses() returns, otherwise the current frame's command buffer.
+         */
+        VkCommandBuffer GetCmdBuffer(Globals& vk)
+        {
+            if (recordingCmdBuffer) return recordingCmdBuffer;
+            return vk.cmdBuffer[vk.frameIndex];
+        }
+
         /**
          * Reset the current frame's command list and begin recording.
          */
@@ -3328,32 +3760,229 @@ namespace Graphics
             beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
             VKCHECK(vkBeginCommandBuffer(vk.cmdBuffer[vk.frameIndex], &beginInfo));
 
+            recordingCmdBuffer = nullptr;
+            vk.frameCmdBuffers.clear();
+
+            // The frame's graphics work waits on the async compute work submitted so far (the previous frame's probe update chain)
+            vk.computeWaitValue = vk.computeToGraphicsValue;
             return true;
         }
 
+        /**
+         * Record the passes on their own command buffers, in parallel on the pass workers, for submission in order.
+         * The work recorded so far is ended ahead of the passes, and the work recorded after them continues on a buffer of its own.
+         * The passes record through GetCmdBuffer() and bind their pipelines and descriptor sets, render passes begin and end within a pass.
+         */
+        bool RecordPasses(Globals& vk, const std::vector<std::function<void()>>& passes)
+        {
+            // Record the passes in order on the frame's command buffer when parallel recording is off. Async
+            // compute submits the frame's command buffers in the middle of its pass (see SubmitComputeCmdList).
+            if (!vk.parallelRecording || vk.DDGIAsyncCompute || passes.size() > MAX_PASS_CMD_LISTS)
+            {
+                for (const std::function<void()>& pass : passes) pass();
+                return true;
+            }
+
+            // End the work recorded so far (constant uploads, TLAS build), it runs first
+            VkCommandBuffer cmdBuffer = GetCmdBuffer(vk);
+            VKCHECK(vkEndCommandBuffer(cmdBuffer));
+            vk.frameCmdBuffers.push_back(cmdBuffer);
+
+            // Reset the pass command pools and begin the pass command buffers
+            VkCommandBufferBeginInfo beginInfo = {};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+            uint32_t numPasses = static_cast<uint32_t>(passes.size());
+            for (uint32_t passIndex = 0; passIndex <= numPasses; passIndex++)
+            {
+                VKCHECK(vkResetCommandPool(vk.device, vk.passCommandPool[vk.frameIndex][passIndex], 0));
+                VKCHECK(vkBeginCommandBuffer(vk.passCmdBuffer[vk.frameIndex][passIndex], &beginInfo));
+            }
+
+            // Record each pass on its own command buffer (the jobs are built on first use, not every frame)
+            if (!vk.passJobs[0])
+            {
+                for (uint32_t passIndex = 0; passIndex < MAX_PASS_CMD_LISTS; passIndex++)
+                {
+                    vk.passJobs[passIndex] = [&vk, passIndex]()
+                    {
+                        recordingCmdBuffer = vk.passCmdBuffer[vk.frameIndex][passIndex];
+                        (*vk.recordingPasses)[passIndex]();
+                        recordingCmdBuffer = nullptr;
+                    };
+                }
+            }
+            vk.recordingPasses = &passes;
+            vk.passWorkers.Run(vk.passJobs, numPasses);
+            vk.recordingPasses = nullptr;
+
+            // End the pass command buffers, in submission order
+            for (uint32_t passIndex = 0; passIndex < numPasses; passIndex++)
+            {
+                VKCHECK(vkEndCommandBuffer(vk.passCmdBuffer[vk.frameIndex][passIndex]));
+                vk.frameCmdBuffers.push_back(vk.passCmdBuffer[vk.frameIndex][passIndex]);
+            }
+
+            // Continue recording the frame on the buffer after the passes
+            recordingCmdBuffer = vk.passCmdBuffer[vk.frameIndex][numPasses];
+            return true;
+        }
+
+        /**
+         * Make the writes of everything recorded so far visible to the work recorded after it (a memory barrier on all stages).
+         */
+        void GlobalBarrier(Globals& vk)
+        {
+            VkMemoryBarrier barrier = {};
+            barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+            vkCmdPipelineBarrier(GetCmdBuffer(vk), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+        }
+
+        /**
+         * Hold the graphics work not yet submitted until the compute work submitted so far is done (see SubmitCmdList).
+         */
+        void WaitForAsyncCompute(Globals& vk)
+        {
+            vk.computeWaitValue = vk.computeToGraphicsValue;
+        }
+
+        /**
+         * Rewrite this frame's camera upload slot with the active camera (late latching).
+         * The copy to the camera constant buffer recorded by Update() reads the slot when the GPU executes it.
+         */
+        void LatchCamera(Globals& vk, Resources& resources, const Scenes::Scene& scene)
+        {
+            uint32_t cameraSize = ALIGN(256, Scenes::Camera::GetGPUDataSize());
+            memcpy(resources.cameraCBPtr + (cameraSize * vk.frameIndex), scene.cameras[scene.activeCamera].GetGPUData(), Scenes::Camera::GetGPUDataSize());
+        }
+
         /**
          * Close and Submit the current frame's command list.
+         * With passes recorded by RecordPasses(), the frame's command buffers are submitted in recording order.
          */
         bool SubmitCmdList(Globals& vk)
         {
             // Close the command buffer
-            VKCHECK(vkEndCommandBuffer(vk.cmdBuffer[vk.frameIndex]));
+            VkCommandBuffer cmdBuffer = GetCmdBuffer(vk);
+            VKCHECK(vkEndCommandBuffer(cmdBuffer));
+            recordingCmdBuffer = nullptr;
+            vk.frameCmdBuffers.push_back(cmdBuffer);
+
+            // Wait for the swapchain image, and the async compute work the frame depends on (the binary semaphore's value is ignored)
+            const VkSemaphore waitSemaphores[] = { vk.imageAcquiredSemaphore[vk.frameIndex], vk.computeToGraphicsSemaphore };
+            const VkPipelineStageFlags waitDstStageMasks[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT };
+            const uint64_t waitValues[] = { 0, vk.computeWaitValue };
+
+            // Signal the present semaphore, and the frame timeline with the frame number
+            const VkSemaphore signalSemaphores[] = { vk.presentSemaphore[vk.frameIndex], vk.frameSemaphore };
+            const uint64_t signalValues[] = { 0, vk.frameNumber };
+
+            VkTimelineSemaphoreSubmitInfo timelineSubmitInfo = {};
+            timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+            timelineSubmitInfo.waitSemaphoreValueCount = (vk.computeWaitValue > 0) ? 2 : 1;
+            timelineSubmitInfo.pWaitSemaphoreValues = waitValues;
+            timelineSubmitInfo.signalSemaphoreValueCount = 2;
+            timelineSubmitInfo.pSignalSemaphoreValues = signalValues;
 
-            const VkPipelineStageFlags waitDstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+            VkSubmitInfo submitInfo = {};
+            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.pNext = &timelineSubmitInfo;
+            submitInfo.waitSemaphoreCount = timelineSubmitInfo.waitSemaphoreValueCount;
+            submitInfo.pWaitSemaphores = waitSemaphores;
+            submitInfo.pWaitDstStageMask = waitDstStageMasks;
+            submitInfo.commandBufferCount = static_cast<uint32_t>(vk.frameCmdBuffers.size());
+            submitInfo.pCommandBuffers = vk.frameCmdBuffers.data();
+            submitInfo.signalSemaphoreCount = 2;
+            submitInfo.pSignalSemaphores = signalSemaphores;
+
+            // Submit the command buffers to the graphics queue
+            VKCHECK(vkQueueSubmit(vk.queue, 1, &submitInfo, VK_NULL_HANDLE));
+            vk.frameCmdBuffers.clear();
+
+            // This frame index's resources are free again once the frame and its async compute work complete, see WaitForPrevGPUFrame()
+            vk.frameSemaphoreValue[vk.frameIndex] = vk.frameNumber;
+            vk.frameComputeValue[vk.frameIndex] = vk.computeToGraphicsValue;
+
+            return true;
+        }
+
+        /**
+         * Reset the current frame's compute command buffer and begin recording.
+         */
+        bool ResetComputeCmdList(Globals& vk)
+        {
+            // The frame timeline covers the compute work of the frame that last used this pool, see WaitForPrevGPUFrame()
+            VKCHECK(vkResetCommandPool(vk.device, vk.computeCommandPool[vk.frameIndex], 0));
+
+            VkCommandBufferBeginInfo beginInfo = {};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            VKCHECK(vkBeginCommandBuffer(vk.computeCmdBuffer[vk.frameIndex], &beginInfo));
+            return true;
+        }
+
+        /**
+         * Submit the graphics work recorded so far, then the current frame's compute command buffer behind it.
+         * Recording continues on the last pass command buffer (passes record serially with async compute), which runs alongside the compute work.
+         */
+        bool SubmitComputeCmdList(Globals& vk)
+        {
+            // Submit the graphics work the compute work depends on
+            VkCommandBuffer cmdBuffer = GetCmdBuffer(vk);
+            VKCHECK(vkEndCommandBuffer(cmdBuffer));
+            vk.frameCmdBuffers.push_back(cmdBuffer);
+
+            const VkPipelineStageFlags waitDstStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+            uint64_t graphicsValue = ++vk.graphicsToComputeValue;
+
+            VkTimelineSemaphoreSubmitInfo timelineSubmitInfo = {};
+            timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+            timelineSubmitInfo.waitSemaphoreValueCount = (vk.computeWaitValue > 0) ? 1 : 0;
+            timelineSubmitInfo.pWaitSemaphoreValues = &vk.computeWaitValue;
+            timelineSubmitInfo.signalSemaphoreValueCount = 1;
+            timelineSubmitInfo.pSignalSemaphoreValues = &graphicsValue;
 
             VkSubmitInfo submitInfo = {};
             submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-            submitInfo.waitSemaphoreCount = 1;
-            submitInfo.pWaitSemaphores = &vk.imageAcquiredSemaphore[vk.frameIndex];
+            submitInfo.pNext = &timelineSubmitInfo;
+            submitInfo.waitSemaphoreCount = timelineSubmitInfo.waitSemaphoreValueCount;
+            submitInfo.pWaitSemaphores = &vk.computeToGraphicsSemaphore;
             submitInfo.pWaitDstStageMask = &waitDstStageMask;
-            submitInfo.commandBufferCount = 1;
-            submitInfo.pCommandBuffers = &vk.cmdBuffer[vk.frameIndex];
+            submitInfo.commandBufferCount = static_cast<uint32_t>(vk.frameCmdBuffers.size());
+            submitInfo.pCommandBuffers = vk.frameCmdBuffers.data();
             submitInfo.signalSemaphoreCount = 1;
-            submitInfo.pSignalSemaphores = &vk.presentSemaphore[vk.frameIndex];
+            submitInfo.pSignalSemaphores = &vk.graphicsToComputeSemaphore;
 
-            // Submit the command buffer to the graphics queue
-            VKCHECK(vkQueueSubmit(vk.queue, 1, &submitInfo, vk.fences[vk.frameIndex]));
+            VKCHECK(vkQueueSubmit(vk.queue, 1, &submitInfo, VK_NULL_HANDLE));
+            vk.frameCmdBuffers.clear();
 
+            // Submit the compute work once the graphics work is done
+            VKCHECK(vkEndCommandBuffer(vk.computeCmdBuffer[vk.frameIndex]));
+            uint64_t computeValue = ++vk.computeToGraphicsValue;
+
+            timelineSubmitInfo.waitSemaphoreValueCount = 1;
+            timelineSubmitInfo.pWaitSemaphoreValues = &graphicsValue;
+            timelineSubmitInfo.pSignalSemaphoreValues = &computeValue;
+
+            submitInfo.waitSemaphoreCount = 1;
+            submitInfo.pWaitSemaphores = &vk.graphicsToComputeSemaphore;
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers = &vk.computeCmdBuffer[vk.frameIndex];
+            submitInfo.pSignalSemaphores = &vk.computeToGraphicsSemaphore;
+
+            VKCHECK(vkQueueSubmit(vk.computeQueue, 1, &submitInfo, VK_NULL_HANDLE));
+
+            // Continue recording the frame, the command buffer submitted above stays pending until the frame completes
+            VkCommandBufferBeginInfo beginInfo = {};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+            VKCHECK(vkResetCommandPool(vk.device, vk.passCommandPool[vk.frameIndex][MAX_PASS_CMD_LISTS], 0));
+            VKCHECK(vkBeginCommandBuffer(vk.passCmdBuffer[vk.frameIndex][MAX_PASS_CMD_LISTS], &beginInfo));
+            recordingCmdBuffer = vk.passCmdBuffer[vk.frameIndex][MAX_PASS_CMD_LISTS];
             return true;
         }
 
@@ -3413,12 +4042,22 @@ namespace Graphics
         }
 
         /**
-         * Wait for the previous frame's graphics commands to complete on the GPU.
+         * Wait for the GPU to complete the frame that last used this frame index's resources (MAX_FRAMES_IN_FLIGHT frames ago).
+         * Present() has advanced the frame index, the frames submitted since keep executing.
          */
         bool WaitForPrevGPUFrame(Globals& vk)
         {
-            VKCHECK(vkWaitForFences(vk.device, 1, &vk.fences[vk.frameIndex], VK_TRUE, UINT64_MAX));
-            VKCHECK(vkResetFences(vk.device, 1, &vk.fences[vk.frameIndex]));
+            // Wait on the frame timeline, and the compute timeline for the frame's async compute work
+            const VkSemaphore semaphores[] = { vk.frameSemaphore, vk.computeToGraphicsSemaphore };
+            const uint64_t values[] = { vk.frameSemaphoreValue[vk.frameIndex], vk.frameComputeValue[vk.frameIndex] };
+
+            VkSemaphoreWaitInfo waitInfo = {};
+            waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+            waitInfo.semaphoreCount = 2;
+            waitInfo.pSemaphores = semaphores;
+            waitInfo.pValues = values;
+
+            VKCHECK(vkWaitSemaphores(vk.device, &waitInfo, UINT64_MAX));
             return true;
         }
 
@@ -3437,6 +4076,9 @@ namespace Graphics
         {
             // Get the next available image from the swapchain
             VKCHECK(vkAcquireNextImageKHR(vk.device, vk.swapChain, UINT64_MAX, vk.imageAcquiredSemaphore[vk.frameIndex], VK_NULL_HANDLE, &vk.imageIndex));
+
+            // Release the previous frame's transient CPU data
+            vk.frameArena.Reset();
             return true;
         }
 
@@ -3446,13 +4088,13 @@ namespace Graphics
     #ifdef GFX_PERF_INSTRUMENTATION
         void BeginFrame(Globals& vk, GlobalResources& resources, Instrumentation::Performance& performance)
         {
-            vkCmdResetQueryPool(vk.cmdBuffer[vk.frameIndex], resources.timestampPool, 0, performance.GetNumTotalGPUQueries());
-            vkCmdWriteTimestamp(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, resources.timestampPool, performance.gpuTimes[0]->GetGPUQueryBeginIndex());
+            vkCmdResetQueryPool(GetCmdBuffer(vk), resources.timestampPool, 0, performance.GetNumTotalGPUQueries());
+            vkCmdWriteTimestamp(GetCmdBuffer(vk), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, resources.timestampPool, performance.gpuTimes[0]->GetGPUQueryBeginIndex());
         }
 
         void EndFrame(Globals& vk, GlobalResources& resources, Instrumentation::Performance& performance)
         {
-            vkCmdWriteTimestamp(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, resources.timestampPool, performance.gpuTimes[0]->GetGPUQueryEndIndex());
+            vkCmdWriteTimestamp(GetCmdBuffer(vk), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, resources.timestampPool, performance.gpuTimes[0]->GetGPUQueryEndIndex());
         }
 
         void ResolveTimestamps(Globals& vk, GlobalResources& resources, Instrumentation::Performance& performance)
@@ -3462,16 +4104,15 @@ namespace Graphics
 
         bool UpdateTimestamps(Globals& vk, GlobalResources& resources, Instrumentation::Performance& performance)
         {
-            std::vector<Timestamp> queries;
-            queries.resize(performance.GetNumActiveGPUQueries());
+            Timestamp* queries = vk.frameArena.Allocate<Timestamp>(performance.GetNumActiveGPUQueries());
 
             // Schedule a copy of the query results to the CPU read-back buffer
-            vkCmdCopyQueryPoolResults(vk.cmdBuffer[vk.frameIndex], resources.timestampPool, 0, performance.GetNumActiveGPUQueries(), resources.timestamps, 0, sizeof(Timestamp), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+            vkCmdCopyQueryPoolResults(GetCmdBuffer(vk), resources.timestampPool, 0, performance.GetNumActiveGPUQueries(), resources.timestamps, 0, sizeof(Timestamp), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
 
             // Copy the (previous frame's) timestamps from the read-back buffer
             uint8_t* pData = nullptr;
             VKCHECK(vkMapMemory(vk.device, resources.timestampsMemory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&pData)));
-            memcpy(queries.data(), pData, sizeof(Timestamp) * performance.GetNumActiveGPUQueries());
+            memcpy(queries, pData, sizeof(Timestamp) * performance.GetNumActiveGPUQueries());
             vkUnmapMemory(vk.device, resources.timestampsMemory);
 
             // Update the GPU performance stats for the active GPU timestamp queries
@@ -3511,7 +4152,7 @@ namespace Graphics
          */
         void Cleanup(Globals& vk, GlobalResources& resources)
         {
-            Cleanup(vk.device, resources);
+            Cleanup(vk.device, vk.memoryPool, resources);
             Cleanup(vk);
         }
 
@@ -3520,7 +4161,7 @@ namespace Graphics
          */
         bool WriteBackBufferToDisk(Globals& vk, std::string directory)
         {
-            return WriteResourceToDisk(vk, directory + "/R-BackBuffer", vk.swapChainImage[vk.frameIndex], vk.width, vk.height, 1, vk.swapChainFormat, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+            return WriteResourceToDisk(vk, directory + "/R-BackBuffer", vk.swapChainImage[vk.imageIndex], vk.width, vk.height, 1, vk.swapChainFormat, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
         }
 
     }
@@ -3557,6 +4198,14 @@ namespace Graphics
         Graphics::Vulkan::Update(gfx, gfxResources, config, scene);
     }
 
+    /**
+     * Rewrite the current frame's camera constants with the latest camera, just before submitting the frame.
+     */
+    void LatchCamera(Globals& gfx, GlobalResources& gfxResources, const Scenes::Scene& scene)
+    {
+        Graphics::Vulkan::LatchCamera(gfx, gfxResources, scene);
+    }
+
     /**
      * Resize the swapchain and open a command buffer for other resize operations.
      */
@@ -3581,6 +4230,22 @@ namespace Graphics
         return Graphics::Vulkan::ToggleFullscreen(gfx);
     }
 
+    /**
+     * Set the resolution scale of DDGI mode's screen-space passes.
+     */
+    void SetResolutionScale(Globals& gfx, float scale)
+    {
+        Graphics::Vulkan::SetResolutionScale(gfx, scale);
+    }
+
+    /**
+     * Get the video memory budget of the process on the device and its current usage, in bytes.
+     */
+    bool GetVideoMemoryInfo(Globals& gfx, uint64_t& budget, uint64_t& usage)
+    {
+        return Graphics::Vulkan::GetVideoMemoryInfo(gfx, budget, usage);
+    }
+
     /**
      * Reset the current frame's command list.
      */
@@ -3597,6 +4262,30 @@ namespace Graphics
         return Graphics::Vulkan::SubmitCmdList(gfx);
     }
 
+    /**
+     * Record the passes on their own command buffers (in parallel), submitted in order by SubmitCmdList().
+     */
+    bool RecordPasses(Globals& gfx, const std::vector<std::function<void()>>& passes)
+    {
+        return Graphics::Vulkan::RecordPasses(gfx, passes);
+    }
+
+    /**
+     * Record a barrier between all the work recorded so far and the work recorded after it.
+     */
+    void GlobalBarrier(Globals& gfx)
+    {
+        Graphics::Vulkan::GlobalBarrier(gfx);
+    }
+
+    /**
+     * Make the rest of the frame's graphics work wait on the async compute work submitted so far.
+     */
+    void WaitForAsyncCompute(Globals& gfx)
+    {
+        Graphics::Vulkan::WaitForAsyncCompute(gfx);
+    }
+
     /**
      * Present the current frame.
      */
@@ -3614,7 +4303,7 @@ namespace Graphics
     }
 
     /**
-     * Wait for the previous frame's graphics commands to complete on the GPU.
+     * Wait for the GPU to complete the frame that last used the next frame's resources.
      */
     bool WaitForPrevGPUFrame(Globals& gfx)
     {
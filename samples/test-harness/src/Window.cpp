@@ -48,6 +48,7 @@ namespace Windows
         glfwInit();
         glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);   // don't need an OpenGL context with D3D12/Vulkan
         glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
+        glfwWindowHint(GLFW_VISIBLE, config.benchmark.headless ? GLFW_FALSE : GLFW_TRUE);  // the headless benchmark presents to a hidden window
 
         // Create the window with GLFW
         window = glfwCreateWindow(config.app.width, config.app.height, config.app.title.c_str(), nullptr, nullptr);
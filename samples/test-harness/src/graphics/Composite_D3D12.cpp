@@ -10,6 +10,10 @@
 
 #include "graphics/Composite.h"
 
+#define EXPOSURE_HISTOGRAM_BINS 128
+#define EXPOSURE_HEADER_SIZE 16
+#define EXPOSURE_GROUP_SIZE 64      // Pixels covered by an exposure thread group in each dimension (16x16 threads, one sample per 4x4 pixels)
+
 namespace Graphics
 {
     namespace D3D12
@@ -21,10 +25,67 @@ namespace Graphics
             // Private Functions
             //----------------------------------------------------------------------------------------------------------
 
+            bool CreateTextures(Globals& d3d, GlobalResources& d3dResources, Resources& resources, std::ofstream& log)
+            {
+                if (!d3d.supportsVariableRateShading) return true;
+
+                // Create the shading rate image (R8_UINT) texture resource, one texel per shading rate tile
+                UINT width = DivRoundUp(static_cast<UINT>(d3d.width), d3d.shadingRateImageTileSize);
+                UINT height = DivRoundUp(static_cast<UINT>(d3d.height), d3d.shadingRateImageTileSize);
+                TextureDesc desc = { width, height, 1, 1, DXGI_FORMAT_R8_UINT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+                CHECK(CreateTexture(d3d, desc, &resources.shadingRateImage), "create composition shading rate image!\n", log);
+            #ifdef GFX_NAME_OBJECTS
+                resources.shadingRateImage->SetName(L"Composite Shading Rate Image");
+            #endif
+
+                // Add the shading rate image UAV to the descriptor heap
+                D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+                uavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
+                uavDesc.Format = desc.format;
+
+                D3D12_CPU_DESCRIPTOR_HANDLE handle;
+                handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_COMPOSITE_SHADING_RATE * d3dResources.srvDescHeapEntrySize);
+                d3d.device->CreateUnorderedAccessView(resources.shadingRateImage, nullptr, &uavDesc, handle);
+
+                return true;
+            }
+
+            /**
+             * Create the automatic exposure buffer (the exposure, then EXPOSURE_HISTOGRAM_BINS histogram bins).
+             * The buffer starts zeroed: an empty histogram and no exposure to adapt from.
+             */
+            bool CreateBuffers(Globals& d3d, GlobalResources& d3dResources, Resources& resources, std::ofstream& log)
+            {
+                UINT size = EXPOSURE_HEADER_SIZE + (EXPOSURE_HISTOGRAM_BINS * sizeof(UINT));
+
+                BufferDesc desc = { size, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+                CHECK(CreateBuffer(d3d, desc, &resources.exposure), "create composition exposure buffer!\n", log);
+            #ifdef GFX_NAME_OBJECTS
+                resources.exposure->SetName(L"Composite Exposure");
+            #endif
+
+                // Add the exposure UAV (RWByteAddressBuffer) to the descriptor heap
+                D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+                uavDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+                uavDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+                uavDesc.Buffer.FirstElement = 0;
+                uavDesc.Buffer.NumElements = size / sizeof(UINT);
+                uavDesc.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_RAW;
+
+                D3D12_CPU_DESCRIPTOR_HANDLE handle;
+                handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_COMPOSITE_EXPOSURE * d3dResources.srvDescHeapEntrySize);
+                d3d.device->CreateUnorderedAccessView(resources.exposure, nullptr, &uavDesc, handle);
+
+                return true;
+            }
+
             bool LoadAndCompileShaders(Globals& d3d, Resources& resources, std::ofstream& log)
             {
                 // Release existing shaders
                 resources.shaders.Release();
+                resources.upscaleShaders.Release();
+                resources.shadingRateCS.Release();
+                resources.exposureCS.Release();
 
                 std::wstring root = std::wstring(d3d.shaderCompiler.root.begin(), d3d.shaderCompiler.root.end());
 
@@ -41,13 +102,55 @@ namespace Graphics
                 resources.shaders.ps.entryPoint = L"PS";
                 resources.shaders.ps.targetProfile = L"ps_6_6";
                 Shaders::AddDefine(resources.shaders.ps, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                Shaders::AddDefine(resources.shaders.ps, L"GBUFFER_VISIBILITY", std::to_wstring(d3d.GBufferVisibility ? 1 : 0));
                 Shaders::AddDefine(resources.shaders.ps, L"RADIANCE_CACHE_CASCADE_COUNT", std::to_wstring(d3d.NumVolume));
                 Shaders::AddDefine(resources.shaders.ps, L"RADIANCE_CACHE_CASCADE_CELL_RADIUS", std::to_wstring(d3d.CascadeCellRadius));
                 Shaders::AddDefine(resources.shaders.ps, L"RADIANCE_CACHE_CASCADE_DISTANCE", std::to_wstring(d3d.CascadeDistance));
+                Shaders::AddDefine(resources.shaders.ps, L"RADIANCE_CACHE_CASCADE_MODE", std::to_wstring(d3d.RadianceCacheCascadeMode));
+                Shaders::AddDefine(resources.shaders.ps, L"RADIANCE_CACHE_HASH_FUNCTION", std::to_wstring(d3d.RadianceCacheHashFunction));
+                Shaders::AddDefine(resources.shaders.ps, L"RADIANCE_CACHE_BRICK_LAYOUT", std::to_wstring(d3d.RadianceCacheBrickLayout ? 1 : 0));
                 Shaders::AddDefine(resources.shaders.ps, L"RADIANCE_CACHE_CELL_COUNT", std::to_wstring(d3d.CacheCount));
                 Shaders::AddDefine(resources.shaders.ps, L"FINAL_GATHER_DOWNSCALE", std::to_wstring(d3d.FinalGatherDownScale));
                 CHECK(Shaders::Compile(d3d.shaderCompiler, resources.shaders.ps), "compile composition pixel shader!\n", log);
 
+                // Load and compile the upscale shaders (dynamic resolution)
+                resources.upscaleShaders.vs.filepath = root + L"shaders/Composite.hlsl";
+                resources.upscaleShaders.vs.entryPoint = L"VS";
+                resources.upscaleShaders.vs.targetProfile = L"vs_6_6";
+                Shaders::AddDefine(resources.upscaleShaders.vs, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                Shaders::AddDefine(resources.upscaleShaders.vs, L"FINAL_GATHER_DOWNSCALE", std::to_wstring(d3d.FinalGatherDownScale));
+                CHECK(Shaders::Compile(d3d.shaderCompiler, resources.upscaleShaders.vs), "compile upscale vertex shader!\n", log);
+
+                resources.upscaleShaders.ps.filepath = root + L"shaders/Composite.hlsl";
+                resources.upscaleShaders.ps.entryPoint = L"UpscalePS";
+                resources.upscaleShaders.ps.targetProfile = L"ps_6_6";
+                Shaders::AddDefine(resources.upscaleShaders.ps, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                Shaders::AddDefine(resources.upscaleShaders.ps, L"FINAL_GATHER_DOWNSCALE", std::to_wstring(d3d.FinalGatherDownScale));
+                CHECK(Shaders::Compile(d3d.shaderCompiler, resources.upscaleShaders.ps), "compile upscale pixel shader!\n", log);
+
+                // Load and compile the automatic exposure compute shader
+                resources.exposureCS.filepath = root + L"shaders/CompositeExposureCS.hlsl";
+                resources.exposureCS.entryPoint = L"CS";
+                resources.exposureCS.targetProfile = L"cs_6_6";
+                Shaders::AddDefine(resources.exposureCS, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                Shaders::AddDefine(resources.exposureCS, L"EXPOSURE_HISTOGRAM_BINS", std::to_wstring(EXPOSURE_HISTOGRAM_BINS));
+                Shaders::AddDefine(resources.exposureCS, L"FINAL_GATHER_DOWNSCALE", std::to_wstring(d3d.FinalGatherDownScale));
+                CHECK(Shaders::Compile(d3d.shaderCompiler, resources.exposureCS), "compile composition exposure compute shader!\n", log);
+
+                if (d3d.supportsVariableRateShading)
+                {
+                    // Load and compile the shading rate image compute shader
+                    D3D12_SHADING_RATE coarseRate = d3d.supportsAdditionalShadingRates ? D3D12_SHADING_RATE_4X4 : D3D12_SHADING_RATE_2X2;
+
+                    resources.shadingRateCS.filepath = root + L"shaders/CompositeShadingRateCS.hlsl";
+                    resources.shadingRateCS.entryPoint = L"CS";
+                    resources.shadingRateCS.targetProfile = L"cs_6_6";
+                    Shaders::AddDefine(resources.shadingRateCS, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                    Shaders::AddDefine(resources.shadingRateCS, L"VRS_TILE_SIZE", std::to_wstring(d3d.shadingRateImageTileSize));
+                    Shaders::AddDefine(resources.shadingRateCS, L"VRS_COARSE_RATE", std::to_wstring(static_cast<UINT>(coarseRate)));
+                    CHECK(Shaders::Compile(d3d.shaderCompiler, resources.shadingRateCS), "compile composition shading rate compute shader!\n", log);
+                }
+
                 return true;
             }
 
@@ -83,7 +186,7 @@ namespace Graphics
 
                 // Create the PSO
                 CHECK(CreateRasterPSO(
-                    d3d.device,
+                    d3d,
                     d3dResources.rootSignature,
                     resources.shaders,
                     desc,
@@ -94,6 +197,47 @@ namespace Graphics
                 resources.pso->SetName(L"Composition PSO");
             #endif
 
+                // Create the upscale PSO (same raster state)
+                SAFE_RELEASE(resources.upscalePSO);
+                CHECK(CreateRasterPSO(
+                    d3d,
+                    d3dResources.rootSignature,
+                    resources.upscaleShaders,
+                    desc,
+                    &resources.upscalePSO),
+                    "create upscale raster PSO!\n", log);
+
+            #ifdef GFX_NAME_OBJECTS
+                resources.upscalePSO->SetName(L"Upscale PSO");
+            #endif
+
+                // Create the automatic exposure compute PSO
+                SAFE_RELEASE(resources.exposurePSO);
+                CHECK(CreateComputePSO(
+                    d3d,
+                    d3dResources.rootSignature,
+                    resources.exposureCS,
+                    &resources.exposurePSO),
+                    "create composition exposure PSO!\n", log);
+            #ifdef GFX_NAME_OBJECTS
+                resources.exposurePSO->SetName(L"Composition Exposure PSO");
+            #endif
+
+                if (d3d.supportsVariableRateShading)
+                {
+                    // Create the shading rate image compute PSO
+                    SAFE_RELEASE(resources.shadingRatePSO);
+                    CHECK(CreateComputePSO(
+                        d3d,
+                        d3dResources.rootSignature,
+                        resources.shadingRateCS,
+                        &resources.shadingRatePSO),
+                        "create composition shading rate PSO!\n", log);
+                #ifdef GFX_NAME_OBJECTS
+                    resources.shadingRatePSO->SetName(L"Composition Shading Rate PSO");
+                #endif
+                }
+
                 return true;
             }
 
@@ -108,6 +252,8 @@ namespace Graphics
             {
                 if(!LoadAndCompileShaders(d3d, resources, log)) return false;
                 if(!CreatePSOs(d3d, d3dResources, resources, log)) return false;
+                if(!CreateTextures(d3d, d3dResources, resources, log)) return false;
+                if(!CreateBuffers(d3d, d3dResources, resources, log)) return false;
 
                 perf.AddStat("Composite", resources.cpuStat, resources.gpuStat);
 
@@ -128,6 +274,21 @@ namespace Graphics
                 return true;
             }
 
+            /**
+             * Resize screen-space buffers.
+             */
+            bool Resize(Globals& d3d, GlobalResources& d3dResources, Resources& resources, std::ofstream& log)
+            {
+                if (!d3d.supportsVariableRateShading) return true;
+
+                SAFE_RELEASE(resources.shadingRateImage);
+                if (!CreateTextures(d3d, d3dResources, resources, log)) return false;
+
+                log << "Composite resize, " << d3d.width << "x" << d3d.height << "\n";
+                std::flush(log);
+                return true;
+            }
+
             /**
              * Update data before execute.
              */
@@ -153,6 +314,10 @@ namespace Graphics
                     {
                         d3dResources.constants.composite.showFlags |= COMPOSITE_FLAG_SHOW_DDGI_INDIRECT_RADIANCE_CACHE;
                     }
+                    if (config.ddgi.showRadianceCacheCoverage && config.app.gpuCounters)
+                    {
+                        d3dResources.constants.composite.showFlags |= COMPOSITE_FLAG_SHOW_DDGI_RADIANCE_CACHE_COVERAGE;
+                    }
                 }
 
                 // Post Process constants
@@ -164,8 +329,19 @@ namespace Graphics
                     if (config.postProcess.dither.enabled) d3dResources.constants.post.useFlags |= POSTPROCESS_FLAG_USE_DITHER;
                     if (config.postProcess.gamma.enabled) d3dResources.constants.post.useFlags |= POSTPROCESS_FLAG_USE_GAMMA;
                     d3dResources.constants.post.exposure = pow(2.f, config.postProcess.exposure.fstops);
+                    d3dResources.constants.post.exposureAdaptation = config.postProcess.exposure.adaptation;
                 }
 
+                // Automatic exposure: the frame's luminance histogram sets the exposure, f-stops compensate it
+                resources.autoExposure = (config.postProcess.enabled && config.postProcess.exposure.enabled && config.postProcess.exposure.automatic);
+                if (resources.autoExposure) d3dResources.constants.post.useFlags |= POSTPROCESS_FLAG_USE_AUTO_EXPOSURE;
+
+                // Dynamic resolution: the render area is upscaled to the back buffer
+                resources.upscale = (d3d.renderWidth != d3d.width) || (d3d.renderHeight != d3d.height);
+
+                // Coarse shading of the sky tiles (requires VRS tier 2). The upscale reads every pixel of the render area, so it shades at full rate.
+                resources.vrs = (d3d.supportsVariableRateShading && config.postProcess.enabled && config.postProcess.vrs.enabled && !resources.upscale);
+
                 CPU_TIMESTAMP_END(resources.cpuStat);
             }
 
@@ -175,7 +351,7 @@ namespace Graphics
             void Execute(Globals& d3d, GlobalResources& d3dResources, Resources& resources)
             {
             #ifdef GFX_PERF_MARKERS
-                PIXBeginEvent(d3d.cmdList[d3d.frameIndex], PIX_COLOR(GFX_PERF_MARKER_BLUE), "Composite");
+                PIXBeginEvent(GetCmdList(d3d), PIX_COLOR(GFX_PERF_MARKER_BLUE), "Composite");
             #endif
                 CPU_TIMESTAMP_BEGIN(resources.cpuStat);
 
@@ -187,61 +363,150 @@ namespace Graphics
                 barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
 
                 // Wait for the transition to complete
-                d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+                GetCmdList(d3d)->ResourceBarrier(1, &barrier);
 
                 // Set the CBV/SRV/UAV and sampler descriptor heaps
                 ID3D12DescriptorHeap* ppHeaps[] = { d3dResources.srvDescHeap, d3dResources.samplerDescHeap };
-                d3d.cmdList[d3d.frameIndex]->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+                GetCmdList(d3d)->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+
+                GPU_TIMESTAMP_BEGIN(resources.gpuStat->GetGPUQueryBeginIndex());
+
+                // Set the compute root signature, constants, and descriptor tables of the compute passes
+                GlobalConstants consts = d3dResources.constants;
+                if (resources.autoExposure || resources.vrs)
+                {
+                    GetCmdList(d3d)->SetComputeRootSignature(d3dResources.rootSignature);
+
+                    UINT offset = 0;
+                    GetCmdList(d3d)->SetComputeRoot32BitConstants(0, AppConsts::GetNum32BitValues(), consts.app.GetData(), offset);
+                    offset += AppConsts::GetAlignedNum32BitValues();
+                    offset += PathTraceConsts::GetAlignedNum32BitValues();
+                    offset += LightingConsts::GetAlignedNum32BitValues();
+                    offset += RTAOConsts::GetAlignedNum32BitValues();
+                    GetCmdList(d3d)->SetComputeRoot32BitConstants(0, CompositeConsts::GetNum32BitValues(), consts.composite.GetData(), offset);
+                    offset += CompositeConsts::GetAlignedNum32BitValues();
+                    GetCmdList(d3d)->SetComputeRoot32BitConstants(0, PostProcessConsts::GetNum32BitValues(), consts.post.GetData(), offset);
+
+                #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
+                    GetCmdList(d3d)->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
+                    GetCmdList(d3d)->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
+                #endif
+                }
+
+                if (resources.autoExposure)
+                {
+                    // Build the frame's luminance histogram and compute the exposure in one dispatch
+                    GetCmdList(d3d)->SetPipelineState(resources.exposurePSO);
+
+                    UINT groupsX = DivRoundUp(static_cast<UINT>(d3d.renderWidth), EXPOSURE_GROUP_SIZE);
+                    UINT groupsY = DivRoundUp(static_cast<UINT>(d3d.renderHeight), EXPOSURE_GROUP_SIZE);
+                    GetCmdList(d3d)->Dispatch(groupsX, groupsY, 1);
+
+                    // Wait for the exposure to be written before the composite reads it
+                    D3D12_RESOURCE_BARRIER uavBarrier = {};
+                    uavBarrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+                    uavBarrier.UAV.pResource = resources.exposure;
+                    GetCmdList(d3d)->ResourceBarrier(1, &uavBarrier);
+                }
+
+                D3D12_RESOURCE_BARRIER shadingRateBarrier = {};
+                if (resources.vrs)
+                {
+                    // Classify the shading rate tiles from the GBuffer's composite flags
+                    GetCmdList(d3d)->SetPipelineState(resources.shadingRatePSO);
+
+                    UINT groupsX = DivRoundUp(static_cast<UINT>(d3d.width), d3d.shadingRateImageTileSize);
+                    UINT groupsY = DivRoundUp(static_cast<UINT>(d3d.height), d3d.shadingRateImageTileSize);
+                    GetCmdList(d3d)->Dispatch(groupsX, groupsY, 1);
+
+                    // Transition the shading rate image to a shading rate source
+                    shadingRateBarrier.Transition.pResource = resources.shadingRateImage;
+                    shadingRateBarrier.Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                    shadingRateBarrier.Transition.StateAfter = D3D12_RESOURCE_STATE_SHADING_RATE_SOURCE;
+                    shadingRateBarrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+
+                    // Wait for the transition to complete
+                    GetCmdList(d3d)->ResourceBarrier(1, &shadingRateBarrier);
+
+                    // The shading rate image overrides the (full) per draw rate
+                    D3D12_SHADING_RATE_COMBINER combiners[D3D12_RS_SET_SHADING_RATE_COMBINER_COUNT] = { D3D12_SHADING_RATE_COMBINER_PASSTHROUGH, D3D12_SHADING_RATE_COMBINER_OVERRIDE };
+                    GetCmdList(d3d)->RSSetShadingRate(D3D12_SHADING_RATE_1X1, combiners);
+                    GetCmdList(d3d)->RSSetShadingRateImage(resources.shadingRateImage);
+                }
 
                 // Set the root signature
-                d3d.cmdList[d3d.frameIndex]->SetGraphicsRootSignature(d3dResources.rootSignature);
+                GetCmdList(d3d)->SetGraphicsRootSignature(d3dResources.rootSignature);
 
                 // Update the root constants
                 UINT offset = 0;
-                GlobalConstants consts = d3dResources.constants;
-                d3d.cmdList[d3d.frameIndex]->SetGraphicsRoot32BitConstants(0, AppConsts::GetNum32BitValues(), consts.app.GetData(), offset);
+                GetCmdList(d3d)->SetGraphicsRoot32BitConstants(0, AppConsts::GetNum32BitValues(), consts.app.GetData(), offset);
                 offset += AppConsts::GetAlignedNum32BitValues();
                 offset += PathTraceConsts::GetAlignedNum32BitValues();
                 offset += LightingConsts::GetAlignedNum32BitValues();
                 offset += RTAOConsts::GetAlignedNum32BitValues();
-                d3d.cmdList[d3d.frameIndex]->SetGraphicsRoot32BitConstants(0, CompositeConsts::GetNum32BitValues(), consts.composite.GetData(), offset);
+                GetCmdList(d3d)->SetGraphicsRoot32BitConstants(0, CompositeConsts::GetNum32BitValues(), consts.composite.GetData(), offset);
                 offset += CompositeConsts::GetAlignedNum32BitValues();
-                d3d.cmdList[d3d.frameIndex]->SetGraphicsRoot32BitConstants(0, PostProcessConsts::GetNum32BitValues(), consts.post.GetData(), offset);
+                GetCmdList(d3d)->SetGraphicsRoot32BitConstants(0, PostProcessConsts::GetNum32BitValues(), consts.post.GetData(), offset);
 
                 // Set the render target
                 D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = d3dResources.rtvDescHeap->GetCPUDescriptorHandleForHeapStart();
                 rtvHandle.ptr += (d3dResources.rtvDescHeapEntrySize * d3d.frameIndex);
-                d3d.cmdList[d3d.frameIndex]->OMSetRenderTargets(1, &rtvHandle, false, nullptr);
+                GetCmdList(d3d)->OMSetRenderTargets(1, &rtvHandle, false, nullptr);
 
                 // Set the root parameter descriptor tables
             #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
-                d3d.cmdList[d3d.frameIndex]->SetGraphicsRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
-                d3d.cmdList[d3d.frameIndex]->SetGraphicsRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
+                GetCmdList(d3d)->SetGraphicsRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
+                GetCmdList(d3d)->SetGraphicsRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
             #endif
 
                 // Set raster state
-                d3d.cmdList[d3d.frameIndex]->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-                d3d.cmdList[d3d.frameIndex]->RSSetViewports(1, &d3d.viewport);
-                d3d.cmdList[d3d.frameIndex]->RSSetScissorRects(1, &d3d.scissor);
+                GetCmdList(d3d)->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+                GetCmdList(d3d)->RSSetViewports(1, &d3d.renderViewport);
+                GetCmdList(d3d)->RSSetScissorRects(1, &d3d.renderScissor);
 
                 // Set the pipeline state object
-                d3d.cmdList[d3d.frameIndex]->SetPipelineState(resources.pso);
+                GetCmdList(d3d)->SetPipelineState(resources.pso);
 
                 // Draw
-                GPU_TIMESTAMP_BEGIN(resources.gpuStat->GetGPUQueryBeginIndex());
-                d3d.cmdList[d3d.frameIndex]->DrawInstanced(3, 1, 0, 0);
+                GetCmdList(d3d)->DrawInstanced(3, 1, 0, 0);
+
+                if (resources.upscale)
+                {
+                    // Wait for the composited render area (in GBufferD), then upscale it to the whole back buffer
+                    D3D12_RESOURCE_BARRIER uavBarrier = {};
+                    uavBarrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+                    uavBarrier.UAV.pResource = d3dResources.rt.GBufferD;
+                    GetCmdList(d3d)->ResourceBarrier(1, &uavBarrier);
+
+                    GetCmdList(d3d)->RSSetViewports(1, &d3d.viewport);
+                    GetCmdList(d3d)->RSSetScissorRects(1, &d3d.scissor);
+                    GetCmdList(d3d)->SetPipelineState(resources.upscalePSO);
+                    GetCmdList(d3d)->DrawInstanced(3, 1, 0, 0);
+                }
                 GPU_TIMESTAMP_END(resources.gpuStat->GetGPUQueryEndIndex());
 
+                if (resources.vrs)
+                {
+                    // Restore full rate shading
+                    GetCmdList(d3d)->RSSetShadingRateImage(nullptr);
+                    GetCmdList(d3d)->RSSetShadingRate(D3D12_SHADING_RATE_1X1, nullptr);
+
+                    // Transition the shading rate image back to an unordered access view
+                    shadingRateBarrier.Transition.StateBefore = D3D12_RESOURCE_STATE_SHADING_RATE_SOURCE;
+                    shadingRateBarrier.Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                    GetCmdList(d3d)->ResourceBarrier(1, &shadingRateBarrier);
+                }
+
                 // Transition the back buffer to present
                 barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
                 barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PRESENT;
 
                 // Wait for the transition to complete
-                d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+                GetCmdList(d3d)->ResourceBarrier(1, &barrier);
 
                 CPU_TIMESTAMP_ENDANDRESOLVE(resources.cpuStat);
             #ifdef GFX_PERF_MARKERS
-                PIXEndEvent(d3d.cmdList[d3d.frameIndex]);
+                PIXEndEvent(GetCmdList(d3d));
             #endif
             }
 
@@ -251,7 +516,15 @@ namespace Graphics
             void Cleanup(Resources& resources)
             {
                 resources.shaders.Release();
+                resources.upscaleShaders.Release();
+                resources.shadingRateCS.Release();
+                resources.exposureCS.Release();
                 SAFE_RELEASE(resources.pso);
+                SAFE_RELEASE(resources.upscalePSO);
+                SAFE_RELEASE(resources.shadingRatePSO);
+                SAFE_RELEASE(resources.shadingRateImage);
+                SAFE_RELEASE(resources.exposurePSO);
+                SAFE_RELEASE(resources.exposure);
             }
 
         } // namespace Graphics::D3D12::Composite
@@ -273,7 +546,7 @@ namespace Graphics
 
         bool Resize(Globals& d3d, GlobalResources& d3dResources, Resources& resources, std::ofstream& log)
         {
-            return true; // nothing to do here in D3D12
+            return Graphics::D3D12::Composite::Resize(d3d, d3dResources, resources, log);
         }
 
         void Update(Globals& d3d, GlobalResources& d3dResources, Resources& resources, const Configs::Config& config)
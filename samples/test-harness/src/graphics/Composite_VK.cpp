@@ -25,6 +25,7 @@ namespace Graphics
             {
                 // Release existing shaders
                 resources.shaders.Release();
+                resources.upscaleShaders.Release();
 
                 std::wstring root = std::wstring(vk.shaderCompiler.root.begin(), vk.shaderCompiler.root.end());
 
@@ -44,6 +45,21 @@ namespace Graphics
                 Shaders::AddDefine(resources.shaders.ps, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS));
                 CHECK(Shaders::Compile(vk.shaderCompiler, resources.shaders.ps), "compile composition pixel shader!\n", log);
 
+                // Load and compile the upscale shaders (dynamic resolution)
+                resources.upscaleShaders.vs.filepath = root + L"shaders/Composite.hlsl";
+                resources.upscaleShaders.vs.entryPoint = L"VS";
+                resources.upscaleShaders.vs.targetProfile = L"vs_6_6";
+                resources.upscaleShaders.vs.arguments = { L"-spirv", L"-D __spirv__", L"-fspv-target-env=vulkan1.2" };
+                Shaders::AddDefine(resources.upscaleShaders.vs, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS));
+                CHECK(Shaders::Compile(vk.shaderCompiler, resources.upscaleShaders.vs), "compile upscale vertex shader!\n", log);
+
+                resources.upscaleShaders.ps.filepath = root + L"shaders/Composite.hlsl";
+                resources.upscaleShaders.ps.entryPoint = L"UpscalePS";
+                resources.upscaleShaders.ps.targetProfile = L"ps_6_6";
+                resources.upscaleShaders.ps.arguments = { L"-spirv", L"-D __spirv__", L"-fspv-target-env=vulkan1.2" };
+                Shaders::AddDefine(resources.upscaleShaders.ps, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS));
+                CHECK(Shaders::Compile(vk.shaderCompiler, resources.upscaleShaders.ps), "compile upscale pixel shader!\n", log);
+
                 return true;
             }
 
@@ -69,10 +85,13 @@ namespace Graphics
             {
                 // Release existing shader modules and pipeline
                 resources.modules.Release(vk.device);
+                resources.upscaleModules.Release(vk.device);
                 vkDestroyPipeline(vk.device, resources.pipeline, nullptr);
+                vkDestroyPipeline(vk.device, resources.upscalePipeline, nullptr);
 
                 // Create the pipeline shader modules
                 CHECK(CreateRasterShaderModules(vk.device, resources.shaders, resources.modules), "create Composition shader modules!\n", log);
+                CHECK(CreateRasterShaderModules(vk.device, resources.upscaleShaders, resources.upscaleModules), "create Upscale shader modules!\n", log);
 
                 // Describe the rasterizer properties
                 RasterDesc desc;
@@ -114,7 +133,7 @@ namespace Graphics
 
                 // Create the pipeline
                 CHECK(CreateRasterPipeline(
-                    vk.device,
+                    vk,
                     vkResources.pipelineLayout,
                     vk.renderPass, resources.shaders,
                     resources.modules,
@@ -124,6 +143,18 @@ namespace Graphics
                 SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.pipeline), "Composition Pipeline", VK_OBJECT_TYPE_PIPELINE);
             #endif
 
+                // Create the upscale pipeline (same raster state)
+                CHECK(CreateRasterPipeline(
+                    vk,
+                    vkResources.pipelineLayout,
+                    vk.renderPass, resources.upscaleShaders,
+                    resources.upscaleModules,
+                    desc,
+                    &resources.upscalePipeline), "create Upscale pipeline!\n", log);
+            #ifdef GFX_NAME_OBJECTS
+                SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.upscalePipeline), "Upscale Pipeline", VK_OBJECT_TYPE_PIPELINE);
+            #endif
+
                 return true;
             }
 
@@ -266,38 +297,57 @@ namespace Graphics
                 // Set the push constants
                 uint32_t offset = 0;
                 GlobalConstants consts = vkResources.constants;
-                vkCmdPushConstants(vk.cmdBuffer[vk.frameIndex], vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, AppConsts::GetSizeInBytes(), consts.app.GetData());
+                vkCmdPushConstants(GetCmdBuffer(vk), vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, AppConsts::GetSizeInBytes(), consts.app.GetData());
                 offset += AppConsts::GetAlignedSizeInBytes();
                 offset += PathTraceConsts::GetAlignedSizeInBytes();
                 offset += LightingConsts::GetAlignedSizeInBytes();
                 offset += RTAOConsts::GetAlignedSizeInBytes();
-                vkCmdPushConstants(vk.cmdBuffer[vk.frameIndex], vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, CompositeConsts::GetSizeInBytes(), consts.composite.GetData());
+                vkCmdPushConstants(GetCmdBuffer(vk), vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, CompositeConsts::GetSizeInBytes(), consts.composite.GetData());
                 offset += CompositeConsts::GetAlignedSizeInBytes();
-                vkCmdPushConstants(vk.cmdBuffer[vk.frameIndex], vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, PostProcessConsts::GetSizeInBytes(), consts.post.GetData());
+                vkCmdPushConstants(GetCmdBuffer(vk), vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, PostProcessConsts::GetSizeInBytes(), consts.post.GetData());
 
                 // Set the pipeline
-                vkCmdBindPipeline(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, resources.pipeline);
+                vkCmdBindPipeline(GetCmdBuffer(vk), VK_PIPELINE_BIND_POINT_GRAPHICS, resources.pipeline);
 
                 // Set the descriptor set
-                vkCmdBindDescriptorSets(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
+                vkCmdBindDescriptorSets(GetCmdBuffer(vk), VK_PIPELINE_BIND_POINT_GRAPHICS, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
 
                 // Set raster state
-                vkCmdSetViewport(vk.cmdBuffer[vk.frameIndex], 0, 1, &vk.viewport);
-                vkCmdSetScissor(vk.cmdBuffer[vk.frameIndex], 0, 1, &vk.scissor);
+                vkCmdSetViewport(GetCmdBuffer(vk), 0, 1, &vk.renderViewport);
+                vkCmdSetScissor(GetCmdBuffer(vk), 0, 1, &vk.renderScissor);
 
                 // Transition the back buffer to a render target (start render pass)
                 GPU_TIMESTAMP_BEGIN(resources.gpuStat->GetGPUQueryBeginIndex());
                 BeginRenderPass(vk);
 
                 // Draw
-                vkCmdDraw(vk.cmdBuffer[vk.frameIndex], 3, 1, 0, 0);
+                vkCmdDraw(GetCmdBuffer(vk), 3, 1, 0, 0);
 
                 // Transition the back buffer to present (end render pass)
-                vkCmdEndRenderPass(vk.cmdBuffer[vk.frameIndex]);
+                vkCmdEndRenderPass(GetCmdBuffer(vk));
+
+                // Dynamic resolution: wait for the composited render area (in GBufferD), then upscale it to the whole back buffer
+                if (vk.renderWidth != vk.width || vk.renderHeight != vk.height)
+                {
+                    VkMemoryBarrier barrier = {};
+                    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+                    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+                    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+                    vkCmdPipelineBarrier(GetCmdBuffer(vk), VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+                    vkCmdBindPipeline(GetCmdBuffer(vk), VK_PIPELINE_BIND_POINT_GRAPHICS, resources.upscalePipeline);
+                    vkCmdSetViewport(GetCmdBuffer(vk), 0, 1, &vk.viewport);
+                    vkCmdSetScissor(GetCmdBuffer(vk), 0, 1, &vk.scissor);
+
+                    // The upscale covers every pixel, so the back buffer contents of the first draw aren't needed
+                    BeginRenderPass(vk);
+                    vkCmdDraw(GetCmdBuffer(vk), 3, 1, 0, 0);
+                    vkCmdEndRenderPass(GetCmdBuffer(vk));
+                }
                 GPU_TIMESTAMP_END(resources.gpuStat->GetGPUQueryEndIndex());
 
             #ifdef GFX_PERF_MARKERS
-                vkCmdEndDebugUtilsLabelEXT(vk.cmdBuffer[vk.frameIndex]);
+                vkCmdEndDebugUtilsLabelEXT(GetCmdBuffer(vk));
             #endif
 
                 CPU_TIMESTAMP_ENDANDRESOLVE(resources.cpuStat);
@@ -309,8 +359,11 @@ namespace Graphics
             void Cleanup(VkDevice& device, Resources& resources)
             {
                 resources.modules.Release(device);
+                resources.upscaleModules.Release(device);
                 resources.shaders.Release();
+                resources.upscaleShaders.Release();
                 vkDestroyPipeline(device, resources.pipeline, nullptr);
+                vkDestroyPipeline(device, resources.upscalePipeline, nullptr);
             }
 
         } // namespace Graphics::Vulkan::Composite
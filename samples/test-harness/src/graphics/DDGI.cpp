@@ -10,6 +10,8 @@
 
 #include "graphics/DDGI.h"
 
+#include <algorithm>
+
 using namespace rtxgi;
 
 namespace Graphics
@@ -88,6 +90,8 @@ namespace Graphics
                     Shaders::AddDefine(shader, L"VOLUME_RESOURCES_SPACE", L"space0");
                     Shaders::AddDefine(shader, L"RWTEX2DARRAY_REGISTER", L"u6");
                     Shaders::AddDefine(shader, L"RWTEX2DARRAY_SPACE", L"space1");
+                    Shaders::AddDefine(shader, L"PROBE_SCHEDULE_REGISTER", L"u5");
+                    Shaders::AddDefine(shader, L"PROBE_SCHEDULE_SPACE", L"space12");
                 #else
                     // Using the RTXGI SDK's root signature (not bindless)
                     Shaders::AddDefine(shader, L"VOLUME_CONSTS_REGISTER", L"t0");
@@ -101,6 +105,8 @@ namespace Graphics
                     Shaders::AddDefine(shader, L"PROBE_VARIABILITY_SPACE", L"space1");
                     Shaders::AddDefine(shader, L"PROBE_VARIABILITY_REGISTER", L"u4");
                     Shaders::AddDefine(shader, L"PROBE_VARIABILITY_AVERAGE_REGISTER", L"u5");
+                    Shaders::AddDefine(shader, L"PROBE_SCHEDULE_REGISTER", L"u6");
+                    Shaders::AddDefine(shader, L"PROBE_SCHEDULE_SPACE", L"space1");
                 #endif
                 }
             #endif
@@ -112,19 +118,84 @@ namespace Graphics
         #endif
         }
 
+        /**
+         * Add the RTXGI_DDGI_SPECIALIZED_* defines (see UnpackDDGIVolumeDescGPU()) of a shader that samples the given volumes,
+         * one for each option all the volumes share. Probe relocation and classification are left out: the UI toggles them on running volumes.
+         * The shader must be compiled again when the volumes' movement type, texture formats, texel counts, or visibility masks change.
+         */
+        void AddSpecializationDefines(Shaders::ShaderProgram& shader, const std::vector<DDGIVolumeDesc>& volumeDescs)
+        {
+            if (volumeDescs.empty()) return;
+
+            const DDGIVolumeDesc& first = volumeDescs[0];
+            bool movementType = true, irradianceFormat = true, irradianceEncoding = true, irradianceMips = true;
+            bool irradianceTexels = true, distanceTexels = true, visibilityMask = true;
+            for (const DDGIVolumeDesc& desc : volumeDescs)
+            {
+                movementType &= (desc.movementType == first.movementType);
+                irradianceFormat &= (desc.probeIrradianceFormat == first.probeIrradianceFormat);
+                irradianceEncoding &= (desc.probeIrradianceEncoding == first.probeIrradianceEncoding);
+                irradianceMips &= (desc.probeIrradianceMipsEnabled == first.probeIrradianceMipsEnabled);
+                irradianceTexels &= (desc.probeNumIrradianceInteriorTexels == first.probeNumIrradianceInteriorTexels);
+                distanceTexels &= (desc.probeNumDistanceInteriorTexels == first.probeNumDistanceInteriorTexels);
+                visibilityMask &= (desc.probeVisibilityMaskEnabled == first.probeVisibilityMaskEnabled);
+            }
+
+            if (movementType) Shaders::AddDefine(shader, L"RTXGI_DDGI_SPECIALIZED_MOVEMENT_TYPE", std::to_wstring(static_cast<uint32_t>(first.movementType)));
+            if (irradianceFormat) Shaders::AddDefine(shader, L"RTXGI_DDGI_SPECIALIZED_IRRADIANCE_FORMAT", std::to_wstring(static_cast<uint32_t>(first.probeIrradianceFormat)));
+            if (irradianceEncoding) Shaders::AddDefine(shader, L"RTXGI_DDGI_SPECIALIZED_IRRADIANCE_ENCODING", std::to_wstring(static_cast<uint32_t>(first.probeIrradianceEncoding)));
+            if (irradianceMips) Shaders::AddDefine(shader, L"RTXGI_DDGI_SPECIALIZED_IRRADIANCE_MIPS", first.probeIrradianceMipsEnabled ? L"1" : L"0");
+            if (irradianceTexels) Shaders::AddDefine(shader, L"RTXGI_DDGI_SPECIALIZED_IRRADIANCE_TEXELS", std::to_wstring(first.probeNumIrradianceInteriorTexels));
+            if (distanceTexels) Shaders::AddDefine(shader, L"RTXGI_DDGI_SPECIALIZED_DISTANCE_TEXELS", std::to_wstring(first.probeNumDistanceInteriorTexels));
+            if (visibilityMask) Shaders::AddDefine(shader, L"RTXGI_DDGI_SPECIALIZED_VISIBILITY_MASK", first.probeVisibilityMaskEnabled ? L"1" : L"0");
+        }
+
+    #if defined(API_D3D12)
+        /**
+         * Switch a probe blending shader to the harness variant that resolves the probe rays from the radiance cache.
+         * See ProbeBlendingRadianceCacheCS.hlsl.
+         */
+        void UseFusedRayResolve(Globals& gfx, Shaders::ShaderProgram& shader)
+        {
+            std::wstring root = std::wstring(gfx.shaderCompiler.root.begin(), gfx.shaderCompiler.root.end());
+            shader.filepath = root + L"shaders/ddgi/ProbeBlendingRadianceCacheCS.hlsl";
+
+            Shaders::AddDefine(shader, L"RTXGI_DDGI_NUM_VOLUMES", std::to_wstring(gfx.NumVolume));
+            Shaders::AddDefine(shader, L"RADIANCE_CACHE_CASCADE_COUNT", std::to_wstring(gfx.NumVolume));
+            Shaders::AddDefine(shader, L"RADIANCE_CACHE_CASCADE_CELL_RADIUS", std::to_wstring(gfx.CascadeCellRadius));
+            Shaders::AddDefine(shader, L"RADIANCE_CACHE_CASCADE_DISTANCE", std::to_wstring(gfx.CascadeDistance));
+            Shaders::AddDefine(shader, L"RADIANCE_CACHE_CASCADE_MODE", std::to_wstring(gfx.RadianceCacheCascadeMode));
+            Shaders::AddDefine(shader, L"RADIANCE_CACHE_HASH_FUNCTION", std::to_wstring(gfx.RadianceCacheHashFunction));
+            Shaders::AddDefine(shader, L"RADIANCE_CACHE_BRICK_LAYOUT", std::to_wstring(gfx.RadianceCacheBrickLayout ? 1 : 0));
+            Shaders::AddDefine(shader, L"RADIANCE_CACHE_CELL_COUNT", std::to_wstring(gfx.CacheCount));
+            Shaders::AddDefine(shader, L"RADIANCE_CACHE_RADIANCE_FORMAT", std::to_wstring(gfx.RadianceCacheRadianceFormat));
+            Shaders::AddDefine(shader, L"PROBE_TRACE_BATCHED", std::to_wstring(gfx.DDGIBatchProbeTrace ? 1 : 0));
+        }
+    #endif
+
+        bool CompileVolumeShader(Globals& gfx, Shaders::ShaderProgram& shader, Shaders::ShaderPermutations* permutations)
+        {
+            if (permutations) return Shaders::Compile(gfx.shaderCompiler, shader, *permutations);
+            return Shaders::Compile(gfx.shaderCompiler, shader);
+        }
+
         /**
          * Loads and compiles RTXGI SDK shaders used by a DDGIVolume.
+         * With permutations, shaders identical to ones compiled for an earlier volume of the batch reuse their bytecode.
          */
         bool CompileDDGIVolumeShaders(
             Globals& gfx,
             const DDGIVolumeDesc& volumeDesc,
             std::vector<Shaders::ShaderProgram>& volumeShaders,
             bool spirv,
-            std::ofstream& log)
+            std::ofstream& log,
+            Shaders::ShaderPermutations* permutations)
         {
             log << "\n\tLoading and compiling shaders for DDGIVolume: \"" << volumeDesc.name << "\"...";
             std::flush(log);
 
+            uint32_t hits = permutations ? permutations->hits : 0;
+
             std::wstring numRays = std::to_wstring(volumeDesc.probeNumRays);
             std::wstring numIrradianceTexels = std::to_wstring(volumeDesc.probeNumIrradianceTexels);
             std::wstring numIrradianceInteriorTexels = std::to_wstring(volumeDesc.probeNumIrradianceInteriorTexels);
@@ -150,18 +221,25 @@ namespace Graphics
                 Shaders::AddDefine(shader, L"RTXGI_DDGI_PROBE_NUM_TEXELS", numIrradianceTexels.c_str());
                 Shaders::AddDefine(shader, L"RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS", numIrradianceInteriorTexels.c_str());
                 Shaders::AddDefine(shader, L"RTXGI_DDGI_BLEND_SHARED_MEMORY", std::to_wstring(RTXGI_DDGI_BLEND_SHARED_MEMORY));
+                Shaders::AddDefine(shader, L"RTXGI_DDGI_BLEND_SHARED_MEMORY_TILED", std::to_wstring(RTXGI_DDGI_BLEND_SHARED_MEMORY_TILED));
             #if RTXGI_DDGI_BLEND_SHARED_MEMORY
                 Shaders::AddDefine(shader, L"RTXGI_DDGI_BLEND_RAYS_PER_PROBE", numRays.c_str());
             #endif
                 Shaders::AddDefine(shader, L"RTXGI_DDGI_BLEND_SCROLL_SHARED_MEMORY", std::to_wstring(volumeDesc.probeBlendingUseScrollSharedMemory));
+                Shaders::AddDefine(shader, L"RTXGI_DDGI_BLEND_BORDER_SHARED_MEMORY", std::to_wstring(RTXGI_DDGI_BLEND_BORDER_SHARED_MEMORY));
+                Shaders::AddDefine(shader, L"RTXGI_DDGI_PROBE_SCHEDULING", spirv ? L"0" : L"1"); // Probe scheduling is D3D12 only
 
             #if !RTXGI_DDGI_RESOURCE_MANAGEMENT && !RTXGI_DDGI_USE_SHADER_CONFIG_FILE && !RTXGI_DDGI_BINDLESS_RESOURCES
                 if (spirv) Shaders::AddDefine(shader, L"OUTPUT_REGISTER", L"2"); // Note: this register differs for irradiance vs. distance
                 else Shaders::AddDefine(shader, L"OUTPUT_REGISTER", L"u1");
             #endif
 
+            #if defined(API_D3D12)
+                if (gfx.DDGIFusedRayResolve && !spirv) UseFusedRayResolve(gfx, shader);
+            #endif
+
                 // Load and compile the shader
-                CHECK(Shaders::Compile(gfx.shaderCompiler, shader), "compile the RTXGI probe irradiance blending compute shader!\n", log);
+                CHECK(CompileVolumeShader(gfx, shader, permutations), "compile the RTXGI probe irradiance blending compute shader!\n", log);
             }
 
             // Probe Blending (distance)
@@ -180,18 +258,25 @@ namespace Graphics
                 Shaders::AddDefine(shader, L"RTXGI_DDGI_PROBE_NUM_TEXELS", numDistanceTexels.c_str());
                 Shaders::AddDefine(shader, L"RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS", numDistanceInteriorTexels.c_str());
                 Shaders::AddDefine(shader, L"RTXGI_DDGI_BLEND_SHARED_MEMORY", std::to_wstring(RTXGI_DDGI_BLEND_SHARED_MEMORY));
+                Shaders::AddDefine(shader, L"RTXGI_DDGI_BLEND_SHARED_MEMORY_TILED", std::to_wstring(RTXGI_DDGI_BLEND_SHARED_MEMORY_TILED));
             #if RTXGI_DDGI_BLEND_SHARED_MEMORY
                 Shaders::AddDefine(shader, L"RTXGI_DDGI_BLEND_RAYS_PER_PROBE", numRays.c_str());
             #endif
                 Shaders::AddDefine(shader, L"RTXGI_DDGI_BLEND_SCROLL_SHARED_MEMORY", std::to_wstring(volumeDesc.probeBlendingUseScrollSharedMemory));
+                Shaders::AddDefine(shader, L"RTXGI_DDGI_BLEND_BORDER_SHARED_MEMORY", std::to_wstring(RTXGI_DDGI_BLEND_BORDER_SHARED_MEMORY));
+                Shaders::AddDefine(shader, L"RTXGI_DDGI_PROBE_SCHEDULING", spirv ? L"0" : L"1"); // Probe scheduling is D3D12 only
 
             #if !RTXGI_DDGI_RESOURCE_MANAGEMENT && !RTXGI_DDGI_USE_SHADER_CONFIG_FILE && !RTXGI_DDGI_BINDLESS_RESOURCES
                 if (spirv) Shaders::AddDefine(shader, L"OUTPUT_REGISTER", L"3"); // Note: this register differs for irradiance vs. distance
                 else Shaders::AddDefine(shader, L"OUTPUT_REGISTER", L"u2");
             #endif
 
+            #if defined(API_D3D12)
+                if (gfx.DDGIFusedRayResolve && !spirv) UseFusedRayResolve(gfx, shader);
+            #endif
+
                 // Load and compile the shader
-                CHECK(Shaders::Compile(gfx.shaderCompiler, shader), "load and compile the RTXGI probe distance blending compute shader!\n", log);
+                CHECK(CompileVolumeShader(gfx, shader, permutations), "load and compile the RTXGI probe distance blending compute shader!\n", log);
             }
 
             // Probe Relocation
@@ -206,7 +291,10 @@ namespace Graphics
                 // Add common shader defines
                 AddCommonShaderDefines(shader, volumeDesc, spirv);
 
-                CHECK(Shaders::Compile(gfx.shaderCompiler, shader), "load and compile the RTXGI probe relocation compute shader!\n", log);
+                // Add shader specific defines
+                Shaders::AddDefine(shader, L"RTXGI_DDGI_FIXED_RAYS_WAVE_OPS", std::to_wstring(volumeDesc.probeFixedRaysUseWaveOps));
+
+                CHECK(CompileVolumeShader(gfx, shader, permutations), "load and compile the RTXGI probe relocation compute shader!\n", log);
 
                 // Reset shader
                 Shaders::ShaderProgram& shader2 = volumeShaders.emplace_back();
@@ -218,7 +306,7 @@ namespace Graphics
                 // Add common shader defines
                 AddCommonShaderDefines(shader2, volumeDesc, spirv);
 
-                CHECK(Shaders::Compile(gfx.shaderCompiler, shader2), "load and compile the RTXGI probe relocation reset compute shader!\n", log);
+                CHECK(CompileVolumeShader(gfx, shader2, permutations), "load and compile the RTXGI probe relocation reset compute shader!\n", log);
             }
 
             // Probe Classification
@@ -233,7 +321,11 @@ namespace Graphics
                 // Add common shader defines
                 AddCommonShaderDefines(shader, volumeDesc, spirv);
 
-                CHECK(Shaders::Compile(gfx.shaderCompiler, shader), "load and compile the RTXGI probe classification compute shader!\n", log);
+                // Add shader specific defines
+                Shaders::AddDefine(shader, L"RTXGI_DDGI_PROBE_SCHEDULING", spirv ? L"0" : L"1"); // Active probe compaction is D3D12 only
+                Shaders::AddDefine(shader, L"RTXGI_DDGI_FIXED_RAYS_WAVE_OPS", std::to_wstring(volumeDesc.probeFixedRaysUseWaveOps));
+
+                CHECK(CompileVolumeShader(gfx, shader, permutations), "load and compile the RTXGI probe classification compute shader!\n", log);
 
                 // Reset shader
                 Shaders::ShaderProgram& shader2 = volumeShaders.emplace_back();
@@ -245,7 +337,10 @@ namespace Graphics
                 // Add common shader defines
                 AddCommonShaderDefines(shader2, volumeDesc, spirv);
 
-                CHECK(Shaders::Compile(gfx.shaderCompiler, shader2), "load and compile the RTXGI probe classification reset compute shader!\n", log);
+                // Add shader specific defines
+                Shaders::AddDefine(shader2, L"RTXGI_DDGI_PROBE_SCHEDULING", spirv ? L"0" : L"1"); // Probe state bits are D3D12 only
+
+                CHECK(CompileVolumeShader(gfx, shader2, permutations), "load and compile the RTXGI probe classification reset compute shader!\n", log);
             }
 
             // Probe variability reduction
@@ -262,7 +357,8 @@ namespace Graphics
                 // Add shader specific defines
                 Shaders::AddDefine(shader, L"RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS", numIrradianceInteriorTexels.c_str());
                 Shaders::AddDefine(shader, L"RTXGI_DDGI_WAVE_LANE_COUNT", waveLaneCount);
-                CHECK(Shaders::Compile(gfx.shaderCompiler, shader), "load and compile the RTXGI reduction compute shader!\n", log);
+                Shaders::AddDefine(shader, L"RTXGI_DDGI_REDUCTION_SINGLE_PASS", spirv ? L"0" : std::to_wstring(volumeDesc.probeVariabilityUseSinglePassReduction)); // Single pass reduction is D3D12 only
+                CHECK(CompileVolumeShader(gfx, shader, permutations), "load and compile the RTXGI reduction compute shader!\n", log);
             }
 
             // Extra reduction passes
@@ -279,14 +375,760 @@ namespace Graphics
                 // Add shader specific defines
                 Shaders::AddDefine(shader, L"RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS", numIrradianceInteriorTexels.c_str());
                 Shaders::AddDefine(shader, L"RTXGI_DDGI_WAVE_LANE_COUNT", waveLaneCount);
-                CHECK(Shaders::Compile(gfx.shaderCompiler, shader), "load and compile the RTXGI extra reduction compute shader!\n", log);
+                CHECK(CompileVolumeShader(gfx, shader, permutations), "load and compile the RTXGI extra reduction compute shader!\n", log);
+            }
+
+            // Probe Scheduling (D3D12 only)
+            if (!spirv)
+            {
+                // Schedule shader
+                Shaders::ShaderProgram& shader = volumeShaders.emplace_back();
+                shader.filepath = root + L"shaders/ddgi/ProbeSchedulingCS.hlsl";
+                shader.entryPoint = L"DDGIProbeSchedulingCS";
+                shader.targetProfile = L"cs_6_6";
+
+                // Add common shader defines
+                AddCommonShaderDefines(shader, volumeDesc, spirv);
+
+                CHECK(CompileVolumeShader(gfx, shader, permutations), "load and compile the RTXGI probe scheduling compute shader!\n", log);
+
+                // Arguments shader
+                Shaders::ShaderProgram& shader2 = volumeShaders.emplace_back();
+                shader2.filepath = root + L"shaders/ddgi/ProbeSchedulingCS.hlsl";
+                shader2.entryPoint = L"DDGIProbeSchedulingArgsCS";
+                shader2.targetProfile = L"cs_6_6";
+
+                // Add common shader defines
+                AddCommonShaderDefines(shader2, volumeDesc, spirv);
+
+                CHECK(CompileVolumeShader(gfx, shader2, permutations), "load and compile the RTXGI probe scheduling arguments compute shader!\n", log);
+
+            #if !RTXGI_DDGI_RESOURCE_MANAGEMENT && RTXGI_DDGI_BINDLESS_RESOURCES
+                // Derivation shader (reads the probes of another volume, so it requires bindless resources)
+                Shaders::ShaderProgram& shader3 = volumeShaders.emplace_back();
+                shader3.filepath = root + L"shaders/ddgi/ProbeDerivationCS.hlsl";
+                shader3.entryPoint = L"DDGIProbeDerivationCS";
+                shader3.targetProfile = L"cs_6_6";
+
+                // Add common shader defines
+                AddCommonShaderDefines(shader3, volumeDesc, spirv);
+
+                // Add shader specific defines
+                Shaders::AddDefine(shader3, L"RTXGI_DDGI_PROBE_NUM_TEXELS", numIrradianceTexels.c_str());
+                Shaders::AddDefine(shader3, L"RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS", numIrradianceInteriorTexels.c_str());
+
+                CHECK(CompileVolumeShader(gfx, shader3, permutations), "load and compile the RTXGI probe derivation compute shader!\n", log);
+            #endif
             }
 
-            log << "done.\n";
+            if (permutations && permutations->hits > hits) log << "done (" << (permutations->hits - hits) << " shaders shared with other volumes).\n";
+            else log << "done.\n";
             std::flush(log);
 
             return true;
         }
 
+        //----------------------------------------------------------------------------------------------------------
+        // DDGIVolume Config Changes
+        //----------------------------------------------------------------------------------------------------------
+
+        void SetDDGIVolumeConstants(DDGIVolumeBase* volume, const Configs::DDGIVolume& volumeConfig)
+        {
+            const Configs::DDGIVolume& c = volumeConfig;
+
+            volume->SetShowProbes(c.showProbes);
+            volume->SetInsertPerfMarkers(c.insertPerfMarkers);
+            volume->SetProbeVisType(c.probeVisType);
+
+            volume->SetOrigin({ c.origin.x, c.origin.y, c.origin.z });
+            volume->SetEulerAngles({ c.eulerAngles.x, c.eulerAngles.y, c.eulerAngles.z });
+            volume->SetProbeSpacing({ c.probeSpacing.x, c.probeSpacing.y, c.probeSpacing.z });
+
+            volume->SetProbeHysteresis(c.probeHysteresis);
+            volume->SetProbeMaxRayDistance(c.probeMaxRayDistance);
+            volume->SetProbeNormalBias(c.probeNormalBias);
+            volume->SetProbeViewBias(c.probeViewBias);
+            volume->SetProbeIrradianceThreshold(c.probeIrradianceThreshold);
+            volume->SetProbeBrightnessThreshold(c.probeBrightnessThreshold);
+
+            // Reset the probe offsets and (re)activate every probe when relocation and classification are off, as the UI does
+            volume->SetProbeRelocationEnabled(c.probeRelocationEnabled);
+            volume->SetMinFrontFaceDistance(c.probeMinFrontfaceDistance);
+            if (!c.probeRelocationEnabled) volume->SetProbeRelocationNeedsReset(true);
+            volume->SetProbeClassificationEnabled(c.probeClassificationEnabled);
+            if (!c.probeClassificationEnabled) volume->SetProbeClassificationNeedsReset(true);
+        #if defined(API_D3D12)
+            volume->SetProbeBlendingActiveOnly(c.probeBlendingActiveOnly);
+        #else
+            // The Vulkan backend doesn't create the probe schedule that active only blending and probe scheduling read
+            volume->SetProbeBlendingActiveOnly(false);
+        #endif
+
+            volume->SetProbeVariabilityEnabled(c.probeVariabilityEnabled);
+            volume->SetProbeConvergenceVariabilityThreshold(c.probeVariabilityThreshold);
+            volume->SetProbeConvergenceFreezeOnGPU(c.probeVariabilityFreezeOnGPU);
+
+        #if defined(API_D3D12)
+            volume->SetProbeSchedulingEnabled(c.probeSchedulingEnabled);
+        #else
+            volume->SetProbeSchedulingEnabled(false);
+        #endif
+            volume->SetProbeSchedulingMaxIntervalLog2(c.probeSchedulingMaxIntervalLog2);
+            volume->SetProbeSchedulingFullRateDistance(c.probeSchedulingFullRateDistance);
+            volume->SetProbeSchedulingVariabilityThreshold(c.probeSchedulingVariabilityThreshold);
+            volume->SetProbeTimeSliceStrideLog2(c.probeTimeSliceStrideLog2);
+            volume->SetProbeDerivationVolumeIndex((c.probeDerivationVolume < 0) ? RTXGI_DDGI_PROBE_DERIVATION_NONE : static_cast<uint32_t>(c.probeDerivationVolume));
+
+            volume->SetProbeEventUpdatesEnabled(c.probeEventUpdatesEnabled);
+            volume->SetProbeEventHysteresis(c.probeEventHysteresis);
+            volume->SetProbeEventRecoveryFrames(c.probeEventRecoveryFrames);
+            volume->SetProbeEventIdleIntervalLog2(c.probeEventIdleIntervalLog2);
+            volume->SetProbeEventIdleVariabilityThreshold(c.probeEventIdleVariabilityThreshold);
+
+            volume->SetProbeAdaptiveRaysEnabled(c.probeAdaptiveRaysEnabled);
+            volume->SetProbeAdaptiveRaysMin(c.probeAdaptiveRaysMin);
+            volume->SetProbeAdaptiveRaysVariabilityThreshold(c.probeAdaptiveRaysVariabilityThreshold);
+
+            volume->SetProbeAdaptiveHysteresisEnabled(c.probeAdaptiveHysteresisEnabled);
+            volume->SetProbeAdaptiveHysteresisMin(c.probeAdaptiveHysteresisMin);
+            volume->SetProbeAdaptiveHysteresisMax(c.probeAdaptiveHysteresisMax);
+            volume->SetProbeAdaptiveHysteresisVariabilityThreshold(c.probeAdaptiveHysteresisVariabilityThreshold);
+
+            // Converged volumes stop updating, update the probes with the new settings
+            volume->ResetProbeConvergence();
+        }
+
+        //----------------------------------------------------------------------------------------------------------
+        // DDGIVolume Memory Budget
+        //----------------------------------------------------------------------------------------------------------
+
+        /**
+         * Fit the requested volumes to ddgi.memoryBudget (and, when adaptive, to the video memory the rest of the process leaves),
+         * writing the planned texel formats, ray counts, and texel counts to the config's volumes and how each volume changed to changes.
+         * Plans again when forced or when the budget moved by more than 10%. Returns true when a new plan was made.
+         */
+        bool PlanMemoryBudget(Globals& gfx, MemoryBudget& memoryBudget, Configs::Config& config, std::vector<Configs::EDDGIVolumeChange>& changes, bool force, std::ofstream& log)
+        {
+            changes.assign(config.ddgi.volumes.size(), Configs::EDDGIVolumeChange::NONE);
+            if (config.ddgi.memoryBudget == 0 || memoryBudget.requested.size() != config.ddgi.volumes.size()) return false;
+
+            uint64_t budget = static_cast<uint64_t>(config.ddgi.memoryBudget) * 1024 * 1024;
+            if (config.ddgi.memoryBudgetAdaptive)
+            {
+                uint64_t deviceBudget = 0, deviceUsage = 0;
+                if (GetVideoMemoryInfo(gfx, deviceBudget, deviceUsage))
+                {
+                    // The device usage includes the volumes of the current plan
+                    uint64_t others = deviceUsage - (std::min)(deviceUsage, memoryBudget.used);
+                    budget = (std::min)(budget, (deviceBudget > others) ? (deviceBudget - others) : 0);
+                }
+            }
+
+            if (!force)
+            {
+                uint64_t delta = (budget > memoryBudget.budget) ? (budget - memoryBudget.budget) : (memoryBudget.budget - budget);
+                if (delta * 10 <= memoryBudget.budget) return false;
+            }
+            memoryBudget.budget = budget;
+
+            // Only the fields that size the probe textures are read
+            std::vector<DDGIVolumeDesc> descs(memoryBudget.requested.size());
+            std::vector<int> priorities(memoryBudget.requested.size());
+            for (size_t volumeIndex = 0; volumeIndex < descs.size(); volumeIndex++)
+            {
+                const Configs::DDGIVolume& volume = memoryBudget.requested[volumeIndex];
+                DDGIVolumeDesc& desc = descs[volumeIndex];
+                desc.probeCounts = { volume.probeCounts.x, volume.probeCounts.y, volume.probeCounts.z };
+                desc.probeNumRays = volume.probeNumRays;
+                desc.probeNumIrradianceTexels = volume.probeNumIrradianceTexels;
+                desc.probeNumIrradianceInteriorTexels = (volume.probeNumIrradianceTexels - 2);
+                desc.probeNumDistanceTexels = volume.probeNumDistanceTexels;
+                desc.probeNumDistanceInteriorTexels = (volume.probeNumDistanceTexels - 2);
+                desc.probeRayDataFormat = volume.textureFormats.rayDataFormat;
+                desc.probeIrradianceFormat = volume.textureFormats.irradianceFormat;
+                desc.probeDistanceFormat = volume.textureFormats.distanceFormat;
+                desc.probeDataFormat = volume.textureFormats.dataFormat;
+                desc.probeVariabilityFormat = volume.textureFormats.variabilityFormat;
+                priorities[volumeIndex] = volume.budgetPriority;
+            }
+
+            if (!FitDDGIVolumesToMemoryBudget(descs.data(), priorities.data(), static_cast<uint32_t>(descs.size()), budget, &memoryBudget.used))
+            {
+                log << "\nWarning: the DDGIVolumes don't fit a memory budget of " << (budget >> 20) << "MB once fully degraded!\n";
+            }
+
+            for (size_t volumeIndex = 0; volumeIndex < descs.size(); volumeIndex++)
+            {
+                const DDGIVolumeDesc& desc = descs[volumeIndex];
+                Configs::DDGIVolume planned = config.ddgi.volumes[volumeIndex];
+                planned.probeNumRays = desc.probeNumRays;
+                planned.probeNumIrradianceTexels = desc.probeNumIrradianceTexels;
+                planned.probeNumDistanceTexels = desc.probeNumDistanceTexels;
+                planned.textureFormats.rayDataFormat = desc.probeRayDataFormat;
+                planned.textureFormats.irradianceFormat = desc.probeIrradianceFormat;
+                planned.textureFormats.distanceFormat = desc.probeDistanceFormat;
+                planned.textureFormats.dataFormat = desc.probeDataFormat;
+                planned.textureFormats.variabilityFormat = desc.probeVariabilityFormat;
+
+                changes[volumeIndex] = Configs::DiffDDGIVolume(config.ddgi.volumes[volumeIndex], planned);
+                config.ddgi.volumes[volumeIndex] = planned;
+            }
+
+            log << "DDGIVolumes planned to use " << (memoryBudget.used >> 20) << "MB of a " << (budget >> 20) << "MB memory budget.\n";
+            std::flush(log);
+            return true;
+        }
+
+        //----------------------------------------------------------------------------------------------------------
+        // GI Cost Controller
+        //----------------------------------------------------------------------------------------------------------
+
+        const uint32_t COST_SETTLE_FRAMES = 30;         // Consecutive frames out of the band before a step is taken or undone
+        const uint32_t COST_HOLD_FRAMES = 60;           // Frames after a step before the stat averages reflect it
+        const uint32_t COST_MIN_PROBE_RAYS = 64;
+
+        static const char* CostKnobNames[COST_KNOB_COUNT] =
+        {
+            "probe updates",
+            "probe rays",
+            "radiance cache ray budget",
+            "radiance cache samples",
+            "indirect resolution"
+        };
+
+        /**
+         * The number of steps the controller can take of a knob.
+         */
+        uint32_t GetCostKnobMaxLevel(const Globals& gfx, const CostController& controller, const Configs::Config& config, ECostKnob knob)
+        {
+            switch (knob)
+            {
+                case COST_KNOB_PROBE_UPDATES: return 2;
+                case COST_KNOB_PROBE_RAYS: return (config.ddgi.memoryBudget > 0) ? 0 : 2;  // The memory budget plans the ray counts
+                case COST_KNOB_RADIANCE_CACHE_SAMPLES: return (controller.baseRadianceCacheSamples > 1.f) ? 2 : 0;
+            #if defined(API_D3D12)
+                case COST_KNOB_RADIANCE_CACHE_BUDGET: return (controller.baseRadianceCacheRayBudget > 0) ? 3 : 0;
+                case COST_KNOB_INDIRECT_SCALE: return (controller.baseIndirectScale == 1) ? 2 : ((controller.baseIndirectScale == 2) ? 1 : 0);
+            #endif
+                default: return 0;
+            }
+        }
+
+        /**
+         * Write the settings of the controller's knob levels to the config and globals.
+         */
+        void ApplyCostKnobs(Globals& gfx, const CostController& controller, Configs::Config& config, std::vector<Configs::EDDGIVolumeChange>& changes, bool& resizeIndirect)
+        {
+            for (size_t volumeIndex = 0; volumeIndex < config.ddgi.volumes.size(); volumeIndex++)
+            {
+                uint32_t updates = controller.levels[COST_KNOB_PROBE_UPDATES];
+                uint32_t rays = controller.levels[COST_KNOB_PROBE_RAYS];
+
+                Configs::DDGIVolume planned = config.ddgi.volumes[volumeIndex];
+                planned.probeNumRays = (std::max)(controller.baseRays[volumeIndex] >> rays, (std::min)(controller.baseRays[volumeIndex], COST_MIN_PROBE_RAYS));
+                planned.probeSchedulingFullRateDistance = (std::max)(controller.baseFullRateDistance[volumeIndex] >> updates, 1);
+                planned.probeTimeSliceStrideLog2 = (std::min)(controller.baseTimeSliceStrideLog2[volumeIndex] + static_cast<int>(updates), RTXGI_DDGI_PROBE_TIME_SLICE_MAX_STRIDE_LOG2);
+
+                changes[volumeIndex] = Configs::DiffDDGIVolume(config.ddgi.volumes[volumeIndex], planned);
+                config.ddgi.volumes[volumeIndex] = planned;
+            }
+
+            // The radiance cache sample count and ray budget are shader defines
+            float samples = (std::max)(controller.baseRadianceCacheSamples / static_cast<float>(1u << controller.levels[COST_KNOB_RADIANCE_CACHE_SAMPLES]), 1.f);
+            if (gfx.RadianceCacheSampleCount != samples)
+            {
+                gfx.RadianceCacheSampleCount = samples;
+                config.ddgi.reload = true;
+            }
+
+        #if defined(API_D3D12)
+            UINT rayBudget = controller.baseRadianceCacheRayBudget >> controller.levels[COST_KNOB_RADIANCE_CACHE_BUDGET];
+            if (gfx.RadianceCacheRayBudget != rayBudget)
+            {
+                gfx.RadianceCacheRayBudget = rayBudget;
+                config.ddgi.reload = true;
+            }
+
+            // The indirect lighting output is resized, the indirect and composite shaders are compiled for the divisor
+            UINT indirectScale = controller.baseIndirectScale << controller.levels[COST_KNOB_INDIRECT_SCALE];
+            if (gfx.FinalGatherDownScale != indirectScale)
+            {
+                gfx.FinalGatherDownScale = indirectScale;
+                config.ddgi.indirectScale = indirectScale;
+                config.ddgi.reload = config.postProcess.reload = true;
+                resizeIndirect = true;
+            }
+        #endif
+        }
+
+        /**
+         * Steer the DDGI GPU time toward ddgi.costBudget, call once a frame. Over the budget's upper band (ddgi.costBudgetHysteresis) for
+         * a while, the next step of a knob of the most expensive DDGI pass is taken. Steps are undone last in first out, once the step's
+         * measured saving fits under the budget's lower band, so a step is not undone just to be taken again. Writes the settings to the
+         * config's volumes and how each volume changed to changes. Returns true when the settings changed.
+         */
+        bool ControlCost(Globals& gfx, CostController& controller, const Resources& resources, Configs::Config& config, std::vector<Configs::EDDGIVolumeChange>& changes, bool& resizeIndirect, std::ofstream& log)
+        {
+            changes.assign(config.ddgi.volumes.size(), Configs::EDDGIVolumeChange::NONE);
+            resizeIndirect = false;
+
+            // Without a budget, restore the settings the controller started from
+            if (config.ddgi.costBudget <= 0.f || !config.ddgi.enabled || resources.gpuStat == nullptr)
+            {
+                if (!controller.active) return false;
+                controller.active = false;
+                controller.steps.clear();
+                for (uint32_t& level : controller.levels) level = 0;
+                if (controller.baseRays.size() != config.ddgi.volumes.size()) return false;
+                ApplyCostKnobs(gfx, controller, config, changes, resizeIndirect);
+                return true;
+            }
+
+            // Start from the current settings (again when the volumes are replaced)
+            if (!controller.active || controller.baseRays.size() != config.ddgi.volumes.size())
+            {
+                controller = CostController();
+                controller.active = true;
+                for (const Configs::DDGIVolume& volume : config.ddgi.volumes)
+                {
+                    controller.baseRays.push_back(volume.probeNumRays);
+                    controller.baseFullRateDistance.push_back(volume.probeSchedulingFullRateDistance);
+                    controller.baseTimeSliceStrideLog2.push_back(volume.probeTimeSliceStrideLog2);
+                }
+                controller.baseRadianceCacheSamples = gfx.RadianceCacheSampleCount;
+            #if defined(API_D3D12)
+                controller.baseRadianceCacheRayBudget = gfx.RadianceCacheRayBudget;
+                controller.baseIndirectScale = gfx.FinalGatherDownScale;
+            #endif
+                controller.holdFrames = COST_HOLD_FRAMES;
+            }
+
+            controller.measured = resources.gpuStat->average;
+            if (controller.holdFrames > 0)
+            {
+                controller.holdFrames--;
+                return false;
+            }
+
+            // The saving of the last step, once the averages reflect it
+            if (!controller.steps.empty() && controller.steps.back().saved <= 0)
+            {
+                controller.steps.back().saved = (std::max)(controller.steps.back().costBefore - controller.measured, 0.01);
+            }
+
+            double upper = config.ddgi.costBudget * (1.f + config.ddgi.costBudgetHysteresis);
+            double lower = config.ddgi.costBudget * (1.f - config.ddgi.costBudgetHysteresis);
+
+            controller.overFrames = (controller.measured > upper) ? (controller.overFrames + 1) : 0;
+            bool restoreFits = !controller.steps.empty() && (controller.measured + controller.steps.back().saved < lower);
+            controller.underFrames = restoreFits ? (controller.underFrames + 1) : 0;
+
+            if (controller.overFrames >= COST_SETTLE_FRAMES)
+            {
+                controller.overFrames = 0;
+
+                // The knobs of each DDGI pass, passes ordered by their GPU time (untimed with async compute, the order stays as listed)
+                struct PassKnobs { double cost; ECostKnob knobs[2]; uint32_t numKnobs; };
+                PassKnobs passes[3] =
+                {
+                    { resources.rtStat->average + resources.blendStat->average + resources.relocateStat->average + resources.classifyStat->average, { COST_KNOB_PROBE_UPDATES, COST_KNOB_PROBE_RAYS }, 2 },
+                    { resources.radianceCacheStat->average, { COST_KNOB_RADIANCE_CACHE_BUDGET, COST_KNOB_RADIANCE_CACHE_SAMPLES }, 2 },
+                    { resources.lightingStat->average, { COST_KNOB_INDIRECT_SCALE, COST_KNOB_INDIRECT_SCALE }, 1 },
+                };
+                std::stable_sort(std::begin(passes), std::end(passes), [](const PassKnobs& a, const PassKnobs& b) { return a.cost > b.cost; });
+
+                for (const PassKnobs& pass : passes)
+                {
+                    for (uint32_t knobIndex = 0; knobIndex < pass.numKnobs; knobIndex++)
+                    {
+                        ECostKnob knob = pass.knobs[knobIndex];
+                        if (controller.levels[knob] >= GetCostKnobMaxLevel(gfx, controller, config, knob)) continue;
+
+                        CostStep step;
+                        step.knob = knob;
+                        step.costBefore = controller.measured;
+                        controller.steps.push_back(step);
+                        controller.levels[knob]++;
+                        ApplyCostKnobs(gfx, controller, config, changes, resizeIndirect);
+                        controller.holdFrames = COST_HOLD_FRAMES;
+
+                        log << "GI cost " << controller.measured << "ms over a " << config.ddgi.costBudget << "ms budget, lowering " << CostKnobNames[knob] << " (step " << controller.levels[knob] << ").\n";
+                        std::flush(log);
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            if (controller.underFrames >= COST_SETTLE_FRAMES)
+            {
+                controller.underFrames = 0;
+
+                CostStep step = controller.steps.back();
+                controller.steps.pop_back();
+                controller.levels[step.knob]--;
+                ApplyCostKnobs(gfx, controller, config, changes, resizeIndirect);
+                controller.holdFrames = COST_HOLD_FRAMES;
+
+                log << "GI cost " << controller.measured << "ms fits a " << config.ddgi.costBudget << "ms budget with " << step.saved << "ms to spare, restoring " << CostKnobNames[step.knob] << ".\n";
+                std::flush(log);
+                return true;
+            }
+
+            return false;
+        }
+
+        //----------------------------------------------------------------------------------------------------------
+        // DDGIVolume Probe Placement
+        //----------------------------------------------------------------------------------------------------------
+
+        // Cells of the occupancy grid along the scene's longest axis
+        const int PLACEMENT_GRID_RESOLUTION = 64;
+
+        // The scene's bounding box divided into cubic cells, marked where geometry passes through them
+        struct PlacementGrid
+        {
+            rtxgi::float3 origin = { 0.f, 0.f, 0.f };  // Minimum corner
+            float cellSize = 0.f;
+            int dims[3] = { 0, 0, 0 };
+            std::vector<uint8_t> cells;
+
+            size_t GetIndex(int x, int y, int z) const { return (static_cast<size_t>(z) * dims[1] + y) * dims[0] + x; }
+        };
+
+        // A box of grid cells, [min, max)
+        struct PlacementBox
+        {
+            int min[3] = { 0, 0, 0 };
+            int max[3] = { 0, 0, 0 };
+            uint32_t occupied = 0;   // Occupied cells in the box
+            bool split = true;       // The box may still be split
+
+            uint32_t GetNumCells() const { return static_cast<uint32_t>((max[0] - min[0]) * (max[1] - min[1]) * (max[2] - min[2])); }
+        };
+
+        /**
+         * Mark the grid cells of a world-space triangle, sampled at half the cell size.
+         */
+        void MarkTriangle(PlacementGrid& grid, const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b, const DirectX::XMFLOAT3& c)
+        {
+            DirectX::XMFLOAT3 ab = { b.x - a.x, b.y - a.y, b.z - a.z };
+            DirectX::XMFLOAT3 ac = { c.x - a.x, c.y - a.y, c.z - a.z };
+            DirectX::XMFLOAT3 bc = { c.x - b.x, c.y - b.y, c.z - b.z };
+            float edge = (std::max)({ sqrtf(ab.x * ab.x + ab.y * ab.y + ab.z * ab.z), sqrtf(ac.x * ac.x + ac.y * ac.y + ac.z * ac.z), sqrtf(bc.x * bc.x + bc.y * bc.y + bc.z * bc.z) });
+            int steps = (std::min)((std::max)(static_cast<int>(ceilf(edge / (grid.cellSize * 0.5f))), 1), 256);
+
+            for (int i = 0; i <= steps; i++)
+            {
+                for (int j = 0; j <= (steps - i); j++)
+                {
+                    float u = static_cast<float>(i) / steps;
+                    float v = static_cast<float>(j) / steps;
+                    float p[3] = { a.x + (ab.x * u) + (ac.x * v), a.y + (ab.y * u) + (ac.y * v), a.z + (ab.z * u) + (ac.z * v) };
+                    const float* origin = &grid.origin.x;
+
+                    int cell[3];
+                    for (int axis = 0; axis < 3; axis++)
+                    {
+                        cell[axis] = (std::min)((std::max)(static_cast<int>(floorf((p[axis] - origin[axis]) / grid.cellSize)), 0), grid.dims[axis] - 1);
+                    }
+                    grid.cells[grid.GetIndex(cell[0], cell[1], cell[2])] = 1;
+                }
+            }
+        }
+
+        /**
+         * Mark the grid cells the scene's mesh instances pass through, then grow the marked cells by one in every direction
+         * so the probes next to the geometry are covered too.
+         */
+        void MarkSceneGeometry(const Scenes::Scene& scene, PlacementGrid& grid)
+        {
+            std::vector<DirectX::XMFLOAT3> positions;
+            for (const Scenes::MeshInstance& instance : scene.instances)
+            {
+                const Scenes::Mesh& mesh = scene.meshes[instance.meshIndex];
+                DirectX::XMMATRIX xform = DirectX::XMLoadFloat3x4(reinterpret_cast<const DirectX::XMFLOAT3X4*>(instance.transform));
+
+                for (const Scenes::MeshPrimitive& mp : mesh.primitives)
+                {
+                    // Packed positions are UNORM16 in the primitive's bounding box (see Scenes::PackVertices())
+                    const rtxgi::float3& min = mp.boundingBox.min;
+                    const rtxgi::float3& max = mp.boundingBox.max;
+                    rtxgi::float3 scale = { (max.x - min.x) / 65535.f, (max.y - min.y) / 65535.f, (max.z - min.z) / 65535.f };
+
+                    size_t numVertices = mp.vertices.empty() ? mp.packedVertices.size() : mp.vertices.size();
+                    positions.resize(numVertices);
+                    for (size_t vertexIndex = 0; vertexIndex < numVertices; vertexIndex++)
+                    {
+                        rtxgi::float3 position;
+                        if (!mp.vertices.empty())
+                        {
+                            position = mp.vertices[vertexIndex].position;
+                        }
+                        else
+                        {
+                            const Graphics::PackedVertex& pv = mp.packedVertices[vertexIndex];
+                            position.x = min.x + (static_cast<float>(pv.data.x & 0xFFFF) * scale.x);
+                            position.y = min.y + (static_cast<float>(pv.data.x >> 16) * scale.y);
+                            position.z = min.z + (static_cast<float>(pv.data.y & 0xFFFF) * scale.z);
+                        }
+                        DirectX::XMVECTOR world = DirectX::XMVector3Transform(DirectX::XMVectorSet(position.x, position.y, position.z, 1.f), xform);
+                        DirectX::XMStoreFloat3(&positions[vertexIndex], world);
+                    }
+
+                    for (size_t index = 0; (index + 2) < mp.indices.size(); index += 3)
+                    {
+                        MarkTriangle(grid, positions[mp.indices[index]], positions[mp.indices[index + 1]], positions[mp.indices[index + 2]]);
+                    }
+                }
+            }
+
+            // Grow the marked cells along each axis in turn (a 3x3x3 neighborhood)
+            std::vector<uint8_t> grown(grid.cells.size());
+            for (int axis = 0; axis < 3; axis++)
+            {
+                for (int z = 0; z < grid.dims[2]; z++)
+                for (int y = 0; y < grid.dims[1]; y++)
+                for (int x = 0; x < grid.dims[0]; x++)
+                {
+                    int cell[3] = { x, y, z };
+                    uint8_t marked = 0;
+                    for (int offset = -1; offset <= 1; offset++)
+                    {
+                        int neighbor[3] = { x, y, z };
+                        neighbor[axis] = cell[axis] + offset;
+                        if (neighbor[axis] < 0 || neighbor[axis] >= grid.dims[axis]) continue;
+                        marked |= grid.cells[grid.GetIndex(neighbor[0], neighbor[1], neighbor[2])];
+                    }
+                    grown[grid.GetIndex(x, y, z)] = marked;
+                }
+                grid.cells.swap(grown);
+            }
+        }
+
+        /**
+         * Shrink a box to the bounds of its occupied cells and count them. The box is empty when none are occupied.
+         */
+        PlacementBox GetOccupiedBounds(const PlacementGrid& grid, const PlacementBox& box)
+        {
+            PlacementBox bounds = box;
+            bounds.occupied = 0;
+            for (int axis = 0; axis < 3; axis++)
+            {
+                bounds.min[axis] = box.max[axis];
+                bounds.max[axis] = box.min[axis];
+            }
+
+            for (int z = box.min[2]; z < box.max[2]; z++)
+            for (int y = box.min[1]; y < box.max[1]; y++)
+            for (int x = box.min[0]; x < box.max[0]; x++)
+            {
+                if (grid.cells[grid.GetIndex(x, y, z)] == 0) continue;
+
+                int cell[3] = { x, y, z };
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    bounds.min[axis] = (std::min)(bounds.min[axis], cell[axis]);
+                    bounds.max[axis] = (std::max)(bounds.max[axis], cell[axis] + 1);
+                }
+                bounds.occupied++;
+            }
+            return bounds;
+        }
+
+        /**
+         * Split the occupied cells into at most maxBoxes boxes. The box with the most empty cells is split in two along its
+         * longest axis, at the plane whose halves' occupied bounds hold the fewest cells, until every box is at least half occupied.
+         */
+        void SplitOccupiedCells(const PlacementGrid& grid, std::vector<PlacementBox>& boxes, uint32_t maxBoxes)
+        {
+            while (boxes.size() < maxBoxes)
+            {
+                size_t boxIndex = boxes.size();
+                uint32_t mostEmpty = 0;
+                for (size_t index = 0; index < boxes.size(); index++)
+                {
+                    const PlacementBox& box = boxes[index];
+                    uint32_t empty = box.GetNumCells() - box.occupied;
+                    if (box.split && (box.occupied * 2) < box.GetNumCells() && empty > mostEmpty)
+                    {
+                        boxIndex = index;
+                        mostEmpty = empty;
+                    }
+                }
+                if (boxIndex == boxes.size()) break;
+
+                PlacementBox box = boxes[boxIndex];
+                int axis = 0;
+                for (int a = 1; a < 3; a++)
+                {
+                    if ((box.max[a] - box.min[a]) > (box.max[axis] - box.min[axis])) axis = a;
+                }
+
+                PlacementBox lower, upper;
+                uint32_t fewestCells = box.GetNumCells();
+                for (int plane = box.min[axis] + 1; plane < box.max[axis]; plane++)
+                {
+                    PlacementBox below = box, above = box;
+                    below.max[axis] = plane;
+                    above.min[axis] = plane;
+                    below = GetOccupiedBounds(grid, below);
+                    above = GetOccupiedBounds(grid, above);
+                    if (below.occupied == 0 || above.occupied == 0) continue;
+
+                    uint32_t cells = below.GetNumCells() + above.GetNumCells();
+                    if (cells < fewestCells)
+                    {
+                        lower = below;
+                        upper = above;
+                        fewestCells = cells;
+                    }
+                }
+
+                // No plane removes empty cells, keep the box
+                if (fewestCells == box.GetNumCells())
+                {
+                    boxes[boxIndex].split = false;
+                    continue;
+                }
+
+                boxes[boxIndex] = lower;
+                boxes.push_back(upper);
+            }
+        }
+
+        /**
+         * Fit a volume of the template's settings to a world-space box, with probes at the given spacing.
+         */
+        Configs::DDGIVolume PlaceVolume(const Configs::DDGIVolume& volumeTemplate, const rtxgi::float3& min, const rtxgi::float3& max, float spacing)
+        {
+            Configs::DDGIVolume volume = volumeTemplate;
+            volume.origin = { (min.x + max.x) * 0.5f, (min.y + max.y) * 0.5f, (min.z + max.z) * 0.5f };
+            volume.eulerAngles = { 0.f, 0.f, 0.f };
+            volume.probeSpacing = { spacing, spacing, spacing };
+            volume.probeCounts.x = (std::max)(static_cast<int>(ceilf((max.x - min.x) / spacing)) + 1, 2);
+            volume.probeCounts.y = (std::max)(static_cast<int>(ceilf((max.y - min.y) / spacing)) + 1, 2);
+            volume.probeCounts.z = (std::max)(static_cast<int>(ceilf((max.z - min.z) / spacing)) + 1, 2);
+            volume.infiniteScrollingEnabled = false;  // The volumes are placed around the geometry, not the camera
+            return volume;
+        }
+
+        /**
+         * Replace the config's volumes with volumes fit to the scene geometry (config ddgi.probePlacement), using the first volume
+         * as the template of their settings. The scene's occupied cells are split into boxes that get a share of the probe budget by
+         * how many cells they occupy, and a coarse volume covering the whole scene gets an eighth of it, so empty space (like the sky
+         * of outdoor scenes) only gets the coarse volume's probes. The volumes are ordered finest first, the coarse volume last.
+         * Writes the placed volumes' config entries next to the scene file. Returns false, leaving the volumes unchanged, on failure.
+         */
+        bool PlaceProbes(Configs::Config& config, const Scenes::Scene& scene, std::ofstream& log)
+        {
+            if (config.ddgi.volumes.empty() || config.ddgi.probePlacementMaxVolumes == 0 || config.ddgi.probePlacementBudget < 16) return false;
+
+            // Build the occupancy grid over the scene's bounding box
+            PlacementGrid grid;
+            rtxgi::float3 extent = { scene.boundingBox.max.x - scene.boundingBox.min.x, scene.boundingBox.max.y - scene.boundingBox.min.y, scene.boundingBox.max.z - scene.boundingBox.min.z };
+            float longest = (std::max)({ extent.x, extent.y, extent.z });
+            if (!(longest > 0.f))
+            {
+                log << "\nWarning: the scene has no geometry to place DDGIVolume probes around!\n";
+                return false;
+            }
+
+            grid.origin = scene.boundingBox.min;
+            grid.cellSize = longest / PLACEMENT_GRID_RESOLUTION;
+            const float* sceneExtent = &extent.x;
+            for (int axis = 0; axis < 3; axis++)
+            {
+                grid.dims[axis] = (std::min)((std::max)(static_cast<int>(ceilf(sceneExtent[axis] / grid.cellSize)), 1), PLACEMENT_GRID_RESOLUTION);
+            }
+            grid.cells.assign(static_cast<size_t>(grid.dims[0]) * grid.dims[1] * grid.dims[2], 0);
+            MarkSceneGeometry(scene, grid);
+
+            // Split the occupied cells into boxes, one volume is left for the coarse volume
+            PlacementBox all;
+            for (int axis = 0; axis < 3; axis++) all.max[axis] = grid.dims[axis];
+            std::vector<PlacementBox> boxes = { GetOccupiedBounds(grid, all) };
+            if (boxes[0].occupied == 0) return false;
+            SplitOccupiedCells(grid, boxes, (std::max)(config.ddgi.probePlacementMaxVolumes, 2u) - 1);
+
+            auto getBoxMin = [&](const PlacementBox& box) -> rtxgi::float3
+            {
+                return { grid.origin.x + (box.min[0] * grid.cellSize), grid.origin.y + (box.min[1] * grid.cellSize), grid.origin.z + (box.min[2] * grid.cellSize) };
+            };
+            auto getBoxMax = [&](const PlacementBox& box) -> rtxgi::float3
+            {
+                return { grid.origin.x + (box.max[0] * grid.cellSize), grid.origin.y + (box.max[1] * grid.cellSize), grid.origin.z + (box.max[2] * grid.cellSize) };
+            };
+            auto getNumProbes = [](const Configs::DDGIVolume& volume)
+            {
+                return static_cast<uint64_t>(volume.probeCounts.x) * volume.probeCounts.y * volume.probeCounts.z;
+            };
+
+            // Share the probe budget: an eighth for the coarse volume, the rest by occupied cells
+            float budget = static_cast<float>(config.ddgi.probePlacementBudget);
+            uint32_t totalOccupied = 0;
+            for (const PlacementBox& box : boxes) totalOccupied += box.occupied;
+
+            float coarseSpacing = (std::max)(cbrtf((extent.x * extent.y * extent.z) / (budget * 0.125f)), config.ddgi.probePlacementMinSpacing);
+            std::vector<float> spacings(boxes.size());
+            for (size_t boxIndex = 0; boxIndex < boxes.size(); boxIndex++)
+            {
+                float boxVolume = static_cast<float>(boxes[boxIndex].GetNumCells()) * grid.cellSize * grid.cellSize * grid.cellSize;
+                float probes = (budget * 0.875f) * boxes[boxIndex].occupied / totalOccupied;
+                spacings[boxIndex] = (std::max)(cbrtf(boxVolume / probes), config.ddgi.probePlacementMinSpacing);
+            }
+
+            // Place the volumes, coarsening the spacings until the probe counts (rounded up to cover the boxes) fit the budget
+            std::vector<Configs::DDGIVolume> volumes;
+            for (int attempt = 0; attempt < 64; attempt++)
+            {
+                volumes.clear();
+                std::vector<size_t> order(boxes.size());
+                for (size_t boxIndex = 0; boxIndex < boxes.size(); boxIndex++) order[boxIndex] = boxIndex;
+                std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return spacings[a] < spacings[b]; });
+
+                uint64_t numProbes = 0;
+                for (size_t boxIndex : order)
+                {
+                    // A box no finer than the coarse volume adds nothing
+                    if (spacings[boxIndex] >= coarseSpacing) continue;
+                    volumes.push_back(PlaceVolume(config.ddgi.volumes[0], getBoxMin(boxes[boxIndex]), getBoxMax(boxes[boxIndex]), spacings[boxIndex]));
+                    numProbes += getNumProbes(volumes.back());
+                }
+                volumes.push_back(PlaceVolume(config.ddgi.volumes[0], scene.boundingBox.min, scene.boundingBox.max, coarseSpacing));
+                numProbes += getNumProbes(volumes.back());
+
+                if (numProbes <= config.ddgi.probePlacementBudget) break;
+                if (attempt == 63) log << "\nWarning: the placed DDGIVolumes use " << numProbes << " probes, over the budget of " << config.ddgi.probePlacementBudget << "!\n";
+                coarseSpacing *= 1.1f;
+                for (float& spacing : spacings) spacing *= 1.1f;
+            }
+
+            for (size_t volumeIndex = 0; volumeIndex < volumes.size(); volumeIndex++)
+            {
+                Configs::DDGIVolume& volume = volumes[volumeIndex];
+                volume.index = static_cast<uint32_t>(volumeIndex);
+                volume.name = config.ddgi.volumes[0].name + "-" + std::to_string(volumeIndex);
+            }
+            config.ddgi.volumes = std::move(volumes);
+
+            // Write the placed volumes' config entries next to the scene file, to copy into a config file
+            std::string sceneName = config.scene.file.substr(0, config.scene.file.find_last_of('.'));
+            std::string filepath = config.app.root + config.scene.path + sceneName + "-ProbePlacement.ini";
+            std::ofstream out(filepath, std::ios::out);
+            if (out.is_open())
+            {
+                out << "# DDGIVolumes placed by ddgi.probePlacement, the other volume settings are the ones of volume 0\n";
+                for (const Configs::DDGIVolume& volume : config.ddgi.volumes) Configs::WriteDDGIVolumePlacement(volume, out);
+                out.close();
+            }
+
+            uint64_t numProbes = 0;
+            for (const Configs::DDGIVolume& volume : config.ddgi.volumes) numProbes += getNumProbes(volume);
+            log << "Placed " << config.ddgi.volumes.size() << " DDGIVolumes with " << numProbes << " probes (" << filepath << ").\n";
+            std::flush(log);
+            return true;
+        }
+
     } // namespace Graphics::DDGI
 }
@@ -80,7 +80,7 @@ namespace Graphics
                     resources.shaderTableUpload->Unmap(0, nullptr);
 
                     // Schedule a copy of the upload buffer to the device buffer
-                    d3d.cmdList[d3d.frameIndex]->CopyBufferRegion(resources.shaderTable, 0, resources.shaderTableUpload, 0, resources.shaderTableSize);
+                    GetCmdList(d3d)->CopyBufferRegion(resources.shaderTable, 0, resources.shaderTableUpload, 0, resources.shaderTableSize);
 
                     // Transition the default heap resource to generic read after the copy is complete
                     D3D12_RESOURCE_BARRIER barrier = {};
@@ -90,7 +90,7 @@ namespace Graphics
                     barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_GENERIC_READ;
                     barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
 
-                    d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+                    GetCmdList(d3d)->ResourceBarrier(1, &barrier);
 
                     return true;
                 }
@@ -100,6 +100,10 @@ namespace Graphics
                     // Clear the instances
                     resources.probeInstances.clear();
 
+                    // Reference the procedural sphere (hit group 1), or LOD 0 of the icosphere LODs (selected on the GPU, see UpdateTLAS)
+                    D3D12_GPU_VIRTUAL_ADDRESS blasAddress = resources.proceduralProbes ? resources.proceduralBlas.as->GetGPUVirtualAddress() : resources.blas.as->GetGPUVirtualAddress();
+                    UINT hitGroupIndex = resources.proceduralProbes ? 1 : 0;
+
                     // Gather the probe instances from volumes
                     UINT16 instanceOffset = 0;
                     for (UINT volumeIndex = 0; volumeIndex < static_cast<UINT>(resources.volumes->size()); volumeIndex++)
@@ -122,7 +126,8 @@ namespace Graphics
                             if(volume->GetProbeVisType() == EDDGIVolumeProbeVisType::Default) desc.InstanceMask = 0x01;
                             else if(volume->GetProbeVisType() == EDDGIVolumeProbeVisType::Hide_Inactive) desc.InstanceMask = 0x02;
 
-                            desc.AccelerationStructure = resources.blas.as->GetGPUVirtualAddress();
+                            desc.AccelerationStructure = blasAddress;
+                            desc.InstanceContributionToHitGroupIndex = hitGroupIndex;
                         #if COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT || COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT_Z_UP
                             desc.Flags = D3D12_RAYTRACING_INSTANCE_FLAG_TRIANGLE_FRONT_COUNTERCLOCKWISE;
                         #endif
@@ -149,7 +154,7 @@ namespace Graphics
                     resources.tlas.instancesUpload->Unmap(0, nullptr);
 
                     // Schedule a copy of the upload buffer to the device buffer
-                    d3d.cmdList[d3d.frameIndex]->CopyBufferRegion(resources.tlas.instances, 0, resources.tlas.instancesUpload, 0, size);
+                    GetCmdList(d3d)->CopyBufferRegion(resources.tlas.instances, 0, resources.tlas.instancesUpload, 0, size);
 
                     // Transition the default heap resource to generic read after the copy is complete
                     D3D12_RESOURCE_BARRIER barrier = {};
@@ -159,7 +164,7 @@ namespace Graphics
                     barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_GENERIC_READ;
                     barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
 
-                    d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+                    GetCmdList(d3d)->ResourceBarrier(1, &barrier);
 
                     return true;
                 }
@@ -167,7 +172,7 @@ namespace Graphics
                 bool UpdateTLAS(Globals& d3d, GlobalResources& d3dResources, Resources& resources, const Configs::Config& config)
                 {
                 #ifdef GFX_PERF_MARKERS
-                    PIXBeginEvent(d3d.cmdList[d3d.frameIndex], PIX_COLOR(GFX_PERF_MARKER_GREEN), "Update DDGI Visualizations TLAS");
+                    PIXBeginEvent(GetCmdList(d3d), PIX_COLOR(GFX_PERF_MARKER_GREEN), "Update DDGI Visualizations TLAS");
                 #endif
 
                     // Update the instances and copy them to the GPU
@@ -185,23 +190,27 @@ namespace Graphics
                     barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
 
                     // Wait for the transition to finish
-                    d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+                    GetCmdList(d3d)->ResourceBarrier(1, &barrier);
 
                     // Set the descriptor heap
                     ID3D12DescriptorHeap* ppHeaps[] = { d3dResources.srvDescHeap, d3dResources.samplerDescHeap };
-                    d3d.cmdList[d3d.frameIndex]->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+                    GetCmdList(d3d)->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
 
                     // Set the root signature
-                    d3d.cmdList[d3d.frameIndex]->SetComputeRootSignature(d3dResources.rootSignature);
+                    GetCmdList(d3d)->SetComputeRootSignature(d3dResources.rootSignature);
 
                     // Set the root parameter descriptor tables
                 #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
-                    d3d.cmdList[d3d.frameIndex]->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
-                    d3d.cmdList[d3d.frameIndex]->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
+                    GetCmdList(d3d)->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
+                    GetCmdList(d3d)->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
                 #endif
 
                     // Set the compute PSO
-                    d3d.cmdList[d3d.frameIndex]->SetPipelineState(resources.updateTlasPSO);
+                    GetCmdList(d3d)->SetPipelineState(resources.updateTlasPSO);
+
+                    // The probe sphere LODs of the instances (see ProbesUpdateCS.hlsl)
+                    UINT numLods = resources.proceduralProbes ? 1 : PROBE_SPHERE_LODS;
+                    UINT lods = (numLods << 16) | ((resources.blasLodStride / 256) << 20);
 
                     UINT instanceOffset = 0;
                     for (UINT volumeIndex = 0; volumeIndex < static_cast<UINT>(resources.volumes->size()); volumeIndex++)
@@ -213,22 +222,22 @@ namespace Graphics
                         if (!volume->GetShowProbes()) continue;
 
                         // Update constants
-                        d3dResources.constants.ddgivis.instanceOffset = instanceOffset;
+                        d3dResources.constants.ddgivis.instanceOffset = instanceOffset | lods;
                         d3dResources.constants.ddgivis.probeRadius = config.ddgi.volumes[volumeIndex].probeRadius;
 
                         // Update the vis root constants
                         UINT offset = GlobalConstants::GetAlignedNum32BitValues() - DDGIVisConsts::GetAlignedNum32BitValues();
-                        d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(0, DDGIVisConsts::GetNum32BitValues(), d3dResources.constants.ddgivis.GetData(), offset);
+                        GetCmdList(d3d)->SetComputeRoot32BitConstants(0, DDGIVisConsts::GetNum32BitValues(), d3dResources.constants.ddgivis.GetData(), offset);
 
                         // Update the DDGIRootConstants
                         DDGIRootConstants ddgiConsts = { volumeIndex, DescriptorHeapOffsets::STB_DDGI_VOLUME_CONSTS, DescriptorHeapOffsets::STB_DDGI_VOLUME_RESOURCE_INDICES };
-                        d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(1, DDGIRootConstants::GetNum32BitValues(), ddgiConsts.GetData(), 0);
+                        GetCmdList(d3d)->SetComputeRoot32BitConstants(1, DDGIRootConstants::GetNum32BitValues(), ddgiConsts.GetData(), 0);
 
                         // Dispatch the compute shader
                         float groupSize = 32.f;
                         UINT numProbes = static_cast<UINT>(volume->GetNumProbes());
                         UINT numGroups = (UINT)ceil((float)numProbes / groupSize);
-                        d3d.cmdList[d3d.frameIndex]->Dispatch(numGroups, 1, 1);
+                        GetCmdList(d3d)->Dispatch(numGroups, 1, 1);
 
                         // Increment the instance offset
                         instanceOffset += resources.volumes->at(volumeIndex)->GetNumProbes();
@@ -239,7 +248,7 @@ namespace Graphics
                     barrier.UAV.pResource = resources.tlas.instances;
 
                     // Wait for the compute passes to finish
-                    d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+                    GetCmdList(d3d)->ResourceBarrier(1, &barrier);
 
                     // Transition the TLAS instances
                     barrier = {};
@@ -250,7 +259,7 @@ namespace Graphics
                     barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
 
                     // Wait for the transition to finish
-                    d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+                    GetCmdList(d3d)->ResourceBarrier(1, &barrier);
 
                     D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAGS buildFlags = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE;
 
@@ -268,22 +277,45 @@ namespace Graphics
                     buildDesc.ScratchAccelerationStructureData = resources.tlas.scratch->GetGPUVirtualAddress();
                     buildDesc.DestAccelerationStructureData = resources.tlas.as->GetGPUVirtualAddress();
 
-                    d3d.cmdList[d3d.frameIndex]->BuildRaytracingAccelerationStructure(&buildDesc, 0, nullptr);
+                    GetCmdList(d3d)->BuildRaytracingAccelerationStructure(&buildDesc, 0, nullptr);
 
                     // Wait for the TLAS build to complete
                     barrier = {};
                     barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
                     barrier.UAV.pResource = resources.tlas.as;
 
-                    d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+                    GetCmdList(d3d)->ResourceBarrier(1, &barrier);
 
                 #ifdef GFX_PERF_MARKERS
-                    PIXEndEvent(d3d.cmdList[d3d.frameIndex]);
+                    PIXEndEvent(GetCmdList(d3d));
                 #endif
 
                     return true;
                 }
 
+                void UpdateProbeDraws(Resources& resources, const Configs::Config& config)
+                {
+                    // Clear the draws
+                    resources.probeDraws.clear();
+
+                    // Gather a draw (of one instance per probe) for each volume
+                    for (UINT volumeIndex = 0; volumeIndex < static_cast<UINT>(resources.volumes->size()); volumeIndex++)
+                    {
+                        // Get the volume
+                        const DDGIVolume* volume = static_cast<DDGIVolume*>(resources.volumes->at(volumeIndex));
+
+                        // Skip this volume if its "Show Probes" flag is disabled
+                        if (!volume->GetShowProbes()) continue;
+
+                        ProbeDraw draw;
+                        draw.volumeIndex = volumeIndex;
+                        draw.numProbes = static_cast<UINT>(volume->GetNumProbes());
+                        draw.probeVisType = static_cast<UINT>(volume->GetProbeVisType());
+                        draw.probeRadius = config.ddgi.volumes[volumeIndex].probeRadius;
+                        resources.probeDraws.push_back(draw);
+                    }
+                }
+
                 // --- Create -----------------------------------------------------------------------------------------
 
                 bool LoadAndCompileShaders(Globals& d3d, Resources& resources, Configs::Config& config, std::ofstream& log)
@@ -292,7 +324,9 @@ namespace Graphics
                     resources.rtShaders.Release();
                     resources.rtShaders2.rgs.Release();
                     resources.textureVisCS.Release();
+                    resources.textureVisCompositeCS.Release();
                     resources.updateTlasCS.Release();
+                    resources.rasterShaders.Release();
 
                     std::wstring root = std::wstring(d3d.shaderCompiler.root.begin(), d3d.shaderCompiler.root.end());
 
@@ -304,6 +338,7 @@ namespace Graphics
                         Shaders::AddDefine(resources.rtShaders.rgs, L"CONSTS_REGISTER", L"b0");   // for DDGIRootConstants, see Direct3D12.cpp::CreateGlobalRootSignature(...)
                         Shaders::AddDefine(resources.rtShaders.rgs, L"CONSTS_SPACE", L"space1");  // for DDGIRootConstants, see Direct3D12.cpp::CreateGlobalRootSignature(...)
                         Shaders::AddDefine(resources.rtShaders.rgs, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                        Shaders::AddDefine(resources.rtShaders.rgs, L"GBUFFER_VISIBILITY", std::to_wstring(d3d.GBufferVisibility ? 1 : 0));
                         Shaders::AddDefine(resources.rtShaders.rgs, L"RTXGI_COORDINATE_SYSTEM", std::to_wstring(RTXGI_COORDINATE_SYSTEM));
                         CHECK(Shaders::Compile(d3d.shaderCompiler, resources.rtShaders.rgs), "compile DDGI Visualizations ray generation shader!\n", log);
 
@@ -314,6 +349,7 @@ namespace Graphics
                         Shaders::AddDefine(resources.rtShaders2.rgs, L"CONSTS_REGISTER", L"b0");   // for DDGIRootConstants, see Direct3D12.cpp::CreateGlobalRootSignature(...)
                         Shaders::AddDefine(resources.rtShaders2.rgs, L"CONSTS_SPACE", L"space1");  // for DDGIRootConstants, see Direct3D12.cpp::CreateGlobalRootSignature(...)
                         Shaders::AddDefine(resources.rtShaders2.rgs, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                        Shaders::AddDefine(resources.rtShaders2.rgs, L"GBUFFER_VISIBILITY", std::to_wstring(d3d.GBufferVisibility ? 1 : 0));
                         Shaders::AddDefine(resources.rtShaders2.rgs, L"RTXGI_COORDINATE_SYSTEM", std::to_wstring(RTXGI_COORDINATE_SYSTEM));
                         CHECK(Shaders::Compile(d3d.shaderCompiler, resources.rtShaders2.rgs), "compile DDGI Visualizations ray generation shader!\n", log);
                     }
@@ -332,9 +368,9 @@ namespace Graphics
                         resources.rtShaders2.miss = resources.rtShaders.miss;
                     }
 
-                    // Add the hit group
+                    // Add the hit groups
                     {
-                        resources.rtShaders.hitGroups.emplace_back();
+                        resources.rtShaders.hitGroups.resize(2);
 
                         Shaders::ShaderRTHitGroup& group = resources.rtShaders.hitGroups[0];
                         group.exportName = L"DDGIVisProbesHitGroup";
@@ -348,6 +384,26 @@ namespace Graphics
                         Shaders::AddDefine(group.chs, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
                         CHECK(Shaders::Compile(d3d.shaderCompiler, group.chs), "compile DDGI Visualizations closest hit shader!\n", log);
 
+                        // Add the procedural sphere hit group (the same closest hit shader, with an intersection shader)
+                        Shaders::ShaderRTHitGroup& proceduralGroup = resources.rtShaders.hitGroups[1];
+                        proceduralGroup.exportName = L"DDGIVisProbesProceduralHitGroup";
+
+                        // Closest hit shader
+                        proceduralGroup.chs.filepath = root + L"shaders/ddgi/visualizations/ProbesCHS.hlsl";
+                        proceduralGroup.chs.entryPoint = L"CHS";
+                        proceduralGroup.chs.exportName = L"DDGIVisProbesProceduralCHS";
+
+                        // Intersection shader
+                        proceduralGroup.is.filepath = root + L"shaders/ddgi/visualizations/ProbesIS.hlsl";
+                        proceduralGroup.is.entryPoint = L"IS";
+                        proceduralGroup.is.exportName = L"DDGIVisProbesIS";
+
+                        // Load and compile
+                        Shaders::AddDefine(proceduralGroup.chs, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                        CHECK(Shaders::Compile(d3d.shaderCompiler, proceduralGroup.chs), "compile DDGI Visualizations closest hit shader!\n", log);
+                        Shaders::AddDefine(proceduralGroup.is, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                        CHECK(Shaders::Compile(d3d.shaderCompiler, proceduralGroup.is), "compile DDGI Visualizations intersection shader!\n", log);
+
                         // Set the payload size
                         resources.rtShaders.payloadSizeInBytes = sizeof(ProbeVisualizationPayload);
 
@@ -356,10 +412,10 @@ namespace Graphics
                         resources.rtShaders2.payloadSizeInBytes = resources.rtShaders.payloadSizeInBytes;
                     }
 
-                    // Load and compile the volume texture shader
+                    // Load and compile the volume texture shaders (drawn to the visualization cache, then copied to GBufferA)
                     {
                         resources.textureVisCS.filepath = root + L"shaders/ddgi/visualizations/VolumeTexturesCS.hlsl";
-                        resources.textureVisCS.entryPoint = L"CS";
+                        resources.textureVisCS.entryPoint = L"DrawCS";
                         resources.textureVisCS.targetProfile = L"cs_6_6";
                         Shaders::AddDefine(resources.textureVisCS, L"CONSTS_REGISTER", L"b0");   // for DDGIRootConstants, see Direct3D12.cpp::CreateGlobalRootSignature(...)
                         Shaders::AddDefine(resources.textureVisCS, L"CONSTS_SPACE", L"space1");  // for DDGIRootConstants, see Direct3D12.cpp::CreateGlobalRootSignature(...)
@@ -368,6 +424,17 @@ namespace Graphics
                         Shaders::AddDefine(resources.textureVisCS, L"THGP_DIM_X", L"8");
                         Shaders::AddDefine(resources.textureVisCS, L"THGP_DIM_Y", L"4");
                         CHECK(Shaders::Compile(d3d.shaderCompiler, resources.textureVisCS), "compile DDGI Visualizations volume textures compute shader!\n", log);
+
+                        resources.textureVisCompositeCS.filepath = root + L"shaders/ddgi/visualizations/VolumeTexturesCS.hlsl";
+                        resources.textureVisCompositeCS.entryPoint = L"CompositeCS";
+                        resources.textureVisCompositeCS.targetProfile = L"cs_6_6";
+                        Shaders::AddDefine(resources.textureVisCompositeCS, L"CONSTS_REGISTER", L"b0");   // for DDGIRootConstants, see Direct3D12.cpp::CreateGlobalRootSignature(...)
+                        Shaders::AddDefine(resources.textureVisCompositeCS, L"CONSTS_SPACE", L"space1");  // for DDGIRootConstants, see Direct3D12.cpp::CreateGlobalRootSignature(...)
+                        Shaders::AddDefine(resources.textureVisCompositeCS, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                        Shaders::AddDefine(resources.textureVisCompositeCS, L"RTXGI_COORDINATE_SYSTEM", std::to_wstring(RTXGI_COORDINATE_SYSTEM));
+                        Shaders::AddDefine(resources.textureVisCompositeCS, L"THGP_DIM_X", L"8");
+                        Shaders::AddDefine(resources.textureVisCompositeCS, L"THGP_DIM_Y", L"4");
+                        CHECK(Shaders::Compile(d3d.shaderCompiler, resources.textureVisCompositeCS), "compile DDGI Visualizations volume textures composite compute shader!\n", log);
                     }
 
                     // Load and compile the TLAS update compute shader
@@ -382,6 +449,30 @@ namespace Graphics
                         CHECK(Shaders::Compile(d3d.shaderCompiler, resources.updateTlasCS), "compile DDGI Visualizations probes update compute shader!\n", log);
                     }
 
+                    // Load and compile the rasterized probes vertex and pixel shaders
+                    if (d3d.supportsRasterizerOrderedViews)
+                    {
+                        resources.rasterShaders.vs.filepath = root + L"shaders/ddgi/visualizations/ProbesRaster.hlsl";
+                        resources.rasterShaders.vs.entryPoint = L"VS";
+                        resources.rasterShaders.vs.targetProfile = L"vs_6_6";
+                        Shaders::AddDefine(resources.rasterShaders.vs, L"CONSTS_REGISTER", L"b0");   // for DDGIRootConstants, see Direct3D12.cpp::CreateGlobalRootSignature(...)
+                        Shaders::AddDefine(resources.rasterShaders.vs, L"CONSTS_SPACE", L"space1");  // for DDGIRootConstants, see Direct3D12.cpp::CreateGlobalRootSignature(...)
+                        Shaders::AddDefine(resources.rasterShaders.vs, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                        Shaders::AddDefine(resources.rasterShaders.vs, L"GBUFFER_VISIBILITY", std::to_wstring(d3d.GBufferVisibility ? 1 : 0));
+                        Shaders::AddDefine(resources.rasterShaders.vs, L"RTXGI_COORDINATE_SYSTEM", std::to_wstring(RTXGI_COORDINATE_SYSTEM));
+                        CHECK(Shaders::Compile(d3d.shaderCompiler, resources.rasterShaders.vs), "compile DDGI Visualizations rasterized probes vertex shader!\n", log);
+
+                        resources.rasterShaders.ps.filepath = root + L"shaders/ddgi/visualizations/ProbesRaster.hlsl";
+                        resources.rasterShaders.ps.entryPoint = L"PS";
+                        resources.rasterShaders.ps.targetProfile = L"ps_6_6";
+                        Shaders::AddDefine(resources.rasterShaders.ps, L"CONSTS_REGISTER", L"b0");   // for DDGIRootConstants, see Direct3D12.cpp::CreateGlobalRootSignature(...)
+                        Shaders::AddDefine(resources.rasterShaders.ps, L"CONSTS_SPACE", L"space1");  // for DDGIRootConstants, see Direct3D12.cpp::CreateGlobalRootSignature(...)
+                        Shaders::AddDefine(resources.rasterShaders.ps, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                        Shaders::AddDefine(resources.rasterShaders.ps, L"GBUFFER_VISIBILITY", std::to_wstring(d3d.GBufferVisibility ? 1 : 0));
+                        Shaders::AddDefine(resources.rasterShaders.ps, L"RTXGI_COORDINATE_SYSTEM", std::to_wstring(RTXGI_COORDINATE_SYSTEM));
+                        CHECK(Shaders::Compile(d3d.shaderCompiler, resources.rasterShaders.ps), "compile DDGI Visualizations rasterized probes pixel shader!\n", log);
+                    }
+
                     return true;
                 }
 
@@ -393,11 +484,13 @@ namespace Graphics
                     SAFE_RELEASE(resources.rtpsoInfo);
                     SAFE_RELEASE(resources.rtpsoInfo2);
                     SAFE_RELEASE(resources.texturesVisPSO);
+                    SAFE_RELEASE(resources.texturesVisCompositePSO);
                     SAFE_RELEASE(resources.updateTlasPSO);
+                    SAFE_RELEASE(resources.rasterPSO);
 
                     // Create the probe visualization RTPSO (default)
                     CHECK(CreateRayTracingPSO(
-                        d3d.device,
+                        d3d,
                         d3dResources.rootSignature,
                         resources.rtShaders,
                         &resources.rtpso,
@@ -410,7 +503,7 @@ namespace Graphics
 
                     // Create the probe visualization RTPSO (alternate)
                     CHECK(CreateRayTracingPSO(
-                        d3d.device,
+                        d3d,
                         d3dResources.rootSignature,
                         resources.rtShaders2,
                         &resources.rtpso2,
@@ -423,7 +516,7 @@ namespace Graphics
 
                     // Create the volume texture visualization PSO
                     CHECK(CreateComputePSO(
-                        d3d.device,
+                        d3d,
                         d3dResources.rootSignature,
                         resources.textureVisCS,
                         &resources.texturesVisPSO),
@@ -433,9 +526,21 @@ namespace Graphics
                     resources.texturesVisPSO->SetName(L"DDGI Volume Texture Visualization PSO");
                 #endif
 
+                    // Create the volume texture visualization composite PSO
+                    CHECK(CreateComputePSO(
+                        d3d,
+                        d3dResources.rootSignature,
+                        resources.textureVisCompositeCS,
+                        &resources.texturesVisCompositePSO),
+                        "create DDGI Volume Texture Visualization Composite PSO!\n", log);
+
+                #ifdef GFX_NAME_OBJECTS
+                    resources.texturesVisCompositePSO->SetName(L"DDGI Volume Texture Visualization Composite PSO");
+                #endif
+
                     // Create the probe update compute PSO
                     CHECK(CreateComputePSO(
-                        d3d.device,
+                        d3d,
                         d3dResources.rootSignature,
                         resources.updateTlasCS,
                         &resources.updateTlasPSO),
@@ -445,6 +550,29 @@ namespace Graphics
                     resources.updateTlasPSO->SetName(L"DDGI Visualization Probe Update PSO");
                 #endif
 
+                    if (d3d.supportsRasterizerOrderedViews)
+                    {
+                        // Describe the rasterized probes pipeline (no vertex input, no render targets: the GBuffer is written through ROVs)
+                        RasterDesc desc = {};
+                        desc.numRenderTargets = 0;
+                        desc.rasterDesc.FillMode = D3D12_FILL_MODE_SOLID;
+                        desc.rasterDesc.CullMode = D3D12_CULL_MODE_NONE;
+                        desc.rasterDesc.DepthClipEnable = TRUE;
+
+                        // Create the rasterized probes PSO
+                        CHECK(CreateRasterPSO(
+                            d3d,
+                            d3dResources.rootSignature,
+                            resources.rasterShaders,
+                            desc,
+                            &resources.rasterPSO),
+                            "create DDGI Visualization Rasterized Probes PSO!\n", log);
+
+                    #ifdef GFX_NAME_OBJECTS
+                        resources.rasterPSO->SetName(L"DDGI Visualization Rasterized Probes PSO");
+                    #endif
+                    }
+
                     return true;
                 }
 
@@ -454,7 +582,8 @@ namespace Graphics
                     //    Entry 0:  Probe Vis Ray Generation Shader (default)
                     //    Entry 1:  Probe Vis Ray Generation Shader (alternate)
                     //    Entry 2:  Probe Vis Miss Shader
-                    //    Entry 3+: Probe Vis HitGroups
+                    //    Entry 3:  Probe Vis HitGroup (icosphere LODs)
+                    //    Entry 4:  Probe Vis HitGroup (procedural spheres)
                     // All shader records in the Shader Table must have the same size, so shader record size will be based on the largest required entry.
                     // The entries must be aligned up to D3D12_RAYTRACING_SHADER_BINDING_TABLE_RECORD_BYTE_ALIGNMENT.
                     // The CHS requires the largest entry:
@@ -496,18 +625,48 @@ namespace Graphics
                     return true;
                 }
 
+                /**
+                 * Create the texture the volume texture visualization is drawn to when its view changes, and copied from every frame.
+                 */
+                bool CreateTextureVisCache(Globals& d3d, GlobalResources& d3dResources, Resources& resources, std::ofstream& log)
+                {
+                    SAFE_RELEASE(resources.textureVisCache);
+
+                    // Create the cache (R16G16B16A16_FLOAT) texture resource, a negative alpha marks pixels without a texel
+                    TextureDesc desc = { static_cast<UINT>(d3d.width), static_cast<UINT>(d3d.height), 1, 1, DXGI_FORMAT_R16G16B16A16_FLOAT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+                    CHECK(CreateTexture(d3d, desc, &resources.textureVisCache), "create DDGI Volume Texture Visualization cache!\n", log);
+                #ifdef GFX_NAME_OBJECTS
+                    resources.textureVisCache->SetName(L"DDGI Volume Texture Visualization Cache");
+                #endif
+
+                    // Add the cache UAV to the descriptor heap
+                    D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+                    uavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
+                    uavDesc.Format = desc.format;
+
+                    D3D12_CPU_DESCRIPTOR_HANDLE handle;
+                    handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_DDGI_TEXTURE_VIS * d3dResources.srvDescHeapEntrySize);
+                    d3d.device->CreateUnorderedAccessView(resources.textureVisCache, nullptr, &uavDesc, handle);
+
+                    resources.textureVisDirty = true;
+                    return true;
+                }
+
                 bool CreateGeometry(Globals& d3d, GlobalResources& d3dResources, Resources& resources, std::ofstream& log)
                 {
-                    // Generate the sphere geometry
-                    Geometry::CreateSphere(30, 30, resources.probe);
+                    // Generate the sphere geometry, a mesh primitive for each LOD
+                    for (UINT lod = 0; lod < PROBE_SPHERE_LODS; lod++)
+                    {
+                        Geometry::CreateIcosphere(lod, resources.probe);
+                    }
 
                     // Create the probe sphere's vertex and index buffers
-                    CHECK(CreateIndexBuffer(d3d, resources.probe, &resources.probeIB, &resources.probeIBUpload, resources.probeIBView), "create probe index buffer!", log);
+                    CHECK(CreateIndexBuffer(d3d, resources.probe, &resources.probeIB, resources.probeIBView), "create probe index buffer!", log);
                 #ifdef GFX_NAME_OBJECTS
                     resources.probeIB->SetName(L"IB: DDGI Probe Sphere");
                 #endif
 
-                    CHECK(CreateVertexBuffer(d3d, resources.probe, &resources.probeVB, &resources.probeVBUpload, resources.probeVBView), "create probe vertex buffer!", log);
+                    CHECK(CreateVertexBuffer(d3d, resources.probe, &resources.probeVB, resources.probeVBView), "create probe vertex buffer!", log);
                 #ifdef GFX_NAME_OBJECTS
                     resources.probeVB->SetName(L"VB: DDGI Probe Sphere");
                 #endif
@@ -530,43 +689,83 @@ namespace Graphics
                     handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::SRV_SPHERE_VERTICES * d3dResources.srvDescHeapEntrySize);
                     d3d.device->CreateShaderResourceView(resources.probeVB, &srvDesc, handle);
 
+                    // Create the procedural sphere's AABB (the bounds of the icospheres)
+                    BufferDesc desc = { sizeof(D3D12_RAYTRACING_AABB), 0, EHeapType::UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE };
+                    CHECK(CreateBuffer(d3d, desc, &resources.probeAABB), "create probe AABB buffer!", log);
+                #ifdef GFX_NAME_OBJECTS
+                    resources.probeAABB->SetName(L"AABB: DDGI Probe Sphere");
+                #endif
+
+                    D3D12_RAYTRACING_AABB* pAABB = nullptr;
+                    D3D12_RANGE readRange = {};
+                    D3DCHECK(resources.probeAABB->Map(0, &readRange, reinterpret_cast<void**>(&pAABB)));
+                    *pAABB = { -0.5f, -0.5f, -0.5f, 0.5f, 0.5f, 0.5f };
+                    resources.probeAABB->Unmap(0, nullptr);
+
                     return true;
                 }
 
                 bool CreateBLAS(Globals& d3d, Resources& resources)
                 {
-                    // Describe the BLAS geometries
-                    D3D12_RAYTRACING_GEOMETRY_DESC geometryDesc = {};
-                    geometryDesc.Type = D3D12_RAYTRACING_GEOMETRY_TYPE_TRIANGLES;
-                    geometryDesc.Triangles.VertexBuffer.StartAddress = resources.probeVB->GetGPUVirtualAddress();
-                    geometryDesc.Triangles.VertexBuffer.StrideInBytes = resources.probeVBView.StrideInBytes;
-                    geometryDesc.Triangles.VertexCount = (resources.probeVBView.SizeInBytes / resources.probeVBView.StrideInBytes);
-                    geometryDesc.Triangles.VertexFormat = DXGI_FORMAT_R32G32B32_FLOAT;
-                    geometryDesc.Triangles.IndexBuffer = resources.probeIB->GetGPUVirtualAddress();
-                    geometryDesc.Triangles.IndexFormat = resources.probeIBView.Format;
-                    geometryDesc.Triangles.IndexCount = (resources.probeIBView.SizeInBytes / sizeof(UINT));
-                    geometryDesc.Flags = D3D12_RAYTRACING_GEOMETRY_FLAG_OPAQUE;
+                    // Describe the BLAS geometries, an icosphere LOD in each BLAS and the procedural sphere's AABB
+                    std::vector<D3D12_RAYTRACING_GEOMETRY_DESC> geometryDescs(PROBE_SPHERE_LODS + 1);
+                    for (UINT lod = 0; lod < PROBE_SPHERE_LODS; lod++)
+                    {
+                        const Scenes::MeshPrimitive& primitive = resources.probe.primitives[lod];
+
+                        D3D12_RAYTRACING_GEOMETRY_DESC& geometryDesc = geometryDescs[lod];
+                        geometryDesc.Type = D3D12_RAYTRACING_GEOMETRY_TYPE_TRIANGLES;
+                        geometryDesc.Triangles.VertexBuffer.StartAddress = resources.probeVB->GetGPUVirtualAddress() + primitive.vertexByteOffset;
+                        geometryDesc.Triangles.VertexBuffer.StrideInBytes = resources.probeVBView.StrideInBytes;
+                        geometryDesc.Triangles.VertexCount = static_cast<UINT>(primitive.vertices.size());
+                        geometryDesc.Triangles.VertexFormat = DXGI_FORMAT_R32G32B32_FLOAT;
+                        geometryDesc.Triangles.IndexBuffer = resources.probeIB->GetGPUVirtualAddress() + primitive.indexByteOffset;
+                        geometryDesc.Triangles.IndexFormat = resources.probeIBView.Format;
+                        geometryDesc.Triangles.IndexCount = static_cast<UINT>(primitive.indices.size());
+                        geometryDesc.Flags = D3D12_RAYTRACING_GEOMETRY_FLAG_OPAQUE;
+                    }
+
+                    D3D12_RAYTRACING_GEOMETRY_DESC& aabbDesc = geometryDescs[PROBE_SPHERE_LODS];
+                    aabbDesc.Type = D3D12_RAYTRACING_GEOMETRY_TYPE_PROCEDURAL_PRIMITIVE_AABBS;
+                    aabbDesc.AABBs.AABBCount = 1;
+                    aabbDesc.AABBs.AABBs.StartAddress = resources.probeAABB->GetGPUVirtualAddress();
+                    aabbDesc.AABBs.AABBs.StrideInBytes = sizeof(D3D12_RAYTRACING_AABB);
+                    aabbDesc.Flags = D3D12_RAYTRACING_GEOMETRY_FLAG_OPAQUE;
 
                     D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAGS buildFlags = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE;
 
                     // Describe the acceleration structure inputs
-                    D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS ASInputs = {};
-                    ASInputs.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL;
-                    ASInputs.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
-                    ASInputs.pGeometryDescs = &geometryDesc;
-                    ASInputs.NumDescs = 1;
-                    ASInputs.Flags = buildFlags;
+                    std::vector<D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS> ASInputs(geometryDescs.size());
+                    std::vector<D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO> asPreBuildInfos(geometryDescs.size());
+                    UINT64 scratchSize = 0;
+                    for (size_t blasIndex = 0; blasIndex < geometryDescs.size(); blasIndex++)
+                    {
+                        ASInputs[blasIndex].Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL;
+                        ASInputs[blasIndex].DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
+                        ASInputs[blasIndex].pGeometryDescs = &geometryDescs[blasIndex];
+                        ASInputs[blasIndex].NumDescs = 1;
+                        ASInputs[blasIndex].Flags = buildFlags;
+
+                        // Get the size requirements for the BLAS buffers
+                        d3d.device->GetRaytracingAccelerationStructurePrebuildInfo(&ASInputs[blasIndex], &asPreBuildInfos[blasIndex]);
+                        asPreBuildInfos[blasIndex].ScratchDataSizeInBytes = ALIGN(D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT, asPreBuildInfos[blasIndex].ScratchDataSizeInBytes);
+                        asPreBuildInfos[blasIndex].ResultDataMaxSizeInBytes = ALIGN(D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT, asPreBuildInfos[blasIndex].ResultDataMaxSizeInBytes);
+                        scratchSize += asPreBuildInfos[blasIndex].ScratchDataSizeInBytes;
+                    }
 
-                    // Get the size requirements for the BLAS buffers
-                    D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO asPreBuildInfo = {};
-                    d3d.device->GetRaytracingAccelerationStructurePrebuildInfo(&ASInputs, &asPreBuildInfo);
-                    asPreBuildInfo.ScratchDataSizeInBytes = ALIGN(D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT, asPreBuildInfo.ScratchDataSizeInBytes);
-                    asPreBuildInfo.ResultDataMaxSizeInBytes = ALIGN(D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT, asPreBuildInfo.ResultDataMaxSizeInBytes);
+                    // The LOD BLAS are the same size apart, the probe update shader offsets the address of LOD 0 by the stride (see ProbesUpdateCS.hlsl)
+                    UINT64 lodStride = 0;
+                    for (UINT lod = 0; lod < PROBE_SPHERE_LODS; lod++)
+                    {
+                        lodStride = (std::max)(lodStride, asPreBuildInfos[lod].ResultDataMaxSizeInBytes);
+                    }
+                    if ((lodStride / 256) > 0xFFF) return false;
+                    resources.blasLodStride = static_cast<UINT>(lodStride);
 
-                    // Create the BLAS scratch buffer
+                    // Create the BLAS scratch buffer, a region for each build (the builds don't wait for each other)
                     BufferDesc blasScratchDesc =
                     {
-                        asPreBuildInfo.ScratchDataSizeInBytes,
+                        scratchSize,
                         D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT,
                         EHeapType::DEFAULT,
                         D3D12_RESOURCE_STATE_COMMON,
@@ -577,10 +776,10 @@ namespace Graphics
                     resources.blas.scratch->SetName(L"BLAS Scratch: DDGI Probe Visualization");
                 #endif
 
-                    // Create the BLAS buffer
+                    // Create the LOD BLAS buffer
                     BufferDesc blasDesc =
                     {
-                        asPreBuildInfo.ResultDataMaxSizeInBytes,
+                        lodStride * PROBE_SPHERE_LODS,
                         D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT,
                         EHeapType::DEFAULT,
                         D3D12_RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE,
@@ -591,20 +790,35 @@ namespace Graphics
                     resources.blas.as->SetName(L"BLAS: DDGI Probe Visualization");
                 #endif
 
-                    // Describe and build the BLAS
-                    D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC buildDesc = {};
-                    buildDesc.Inputs = ASInputs;
-                    buildDesc.ScratchAccelerationStructureData = resources.blas.scratch->GetGPUVirtualAddress();
-                    buildDesc.DestAccelerationStructureData = resources.blas.as->GetGPUVirtualAddress();
+                    // Create the procedural sphere BLAS buffer
+                    blasDesc.size = asPreBuildInfos[PROBE_SPHERE_LODS].ResultDataMaxSizeInBytes;
+                    if (!CreateBuffer(d3d, blasDesc, &resources.proceduralBlas.as)) return false;
+                #ifdef GFX_NAME_OBJECTS
+                    resources.proceduralBlas.as->SetName(L"BLAS: DDGI Probe Visualization (Procedural)");
+                #endif
 
-                    d3d.cmdList[d3d.frameIndex]->BuildRaytracingAccelerationStructure(&buildDesc, 0, nullptr);
+                    // Describe and build the BLAS
+                    D3D12_GPU_VIRTUAL_ADDRESS scratchAddress = resources.blas.scratch->GetGPUVirtualAddress();
+                    for (size_t blasIndex = 0; blasIndex < geometryDescs.size(); blasIndex++)
+                    {
+                        D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC buildDesc = {};
+                        buildDesc.Inputs = ASInputs[blasIndex];
+                        buildDesc.ScratchAccelerationStructureData = scratchAddress;
+                        if (blasIndex < PROBE_SPHERE_LODS) buildDesc.DestAccelerationStructureData = resources.blas.as->GetGPUVirtualAddress() + (blasIndex * lodStride);
+                        else buildDesc.DestAccelerationStructureData = resources.proceduralBlas.as->GetGPUVirtualAddress();
+
+                        GetCmdList(d3d)->BuildRaytracingAccelerationStructure(&buildDesc, 0, nullptr);
+                        scratchAddress += asPreBuildInfos[blasIndex].ScratchDataSizeInBytes;
+                    }
 
-                    // Wait for the BLAS build to complete
-                    D3D12_RESOURCE_BARRIER barrier = {};
-                    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
-                    barrier.UAV.pResource = resources.blas.as;
+                    // Wait for the BLAS builds to complete
+                    D3D12_RESOURCE_BARRIER barriers[2] = {};
+                    barriers[0].Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+                    barriers[0].UAV.pResource = resources.blas.as;
+                    barriers[1].Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+                    barriers[1].UAV.pResource = resources.proceduralBlas.as;
 
-                    d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+                    GetCmdList(d3d)->ResourceBarrier(2, barriers);
 
                     return true;
                 }
@@ -732,6 +946,7 @@ namespace Graphics
                     if (!CreateGeometry(d3d, d3dResources, resources, log)) return false;
                     if (!CreateBLAS(d3d, resources)) return false;
                     if (!CreateTLAS(d3d, d3dResources, resources)) return false;
+                    if (!CreateTextureVisCache(d3d, d3dResources, resources, log)) return false;
 
                     if (!UpdateShaderTable(d3d, d3dResources, resources)) return false;
 
@@ -756,6 +971,9 @@ namespace Graphics
                     if (!CreatePSOs(d3d, d3dResources, resources, log)) return false;
                     if (!UpdateShaderTable(d3d, d3dResources, resources)) return false;
 
+                    // The volumes may have changed
+                    resources.textureVisDirty = true;
+
                     log << "done.\n";
                     log << std::flush;
 
@@ -767,8 +985,7 @@ namespace Graphics
                  */
                 bool Resize(Globals& d3d, GlobalResources& d3dResources, Resources& resources, std::ofstream& log)
                 {
-                    // nothing to do here
-                    return true;
+                    return CreateTextureVisCache(d3d, d3dResources, resources, log);
                 }
 
                 /**
@@ -784,6 +1001,8 @@ namespace Graphics
                     if (config.ddgi.showTextures) resources.flags |= VIS_FLAG_SHOW_TEXTURES;
 
                     resources.enabled = config.ddgi.enabled;
+                    resources.rasterizeProbes = (config.ddgi.rasterizeProbes && d3d.supportsRasterizerOrderedViews);
+                    resources.proceduralProbes = config.ddgi.proceduralProbes;
                     if (resources.enabled)
                     {
                         // Get the currently selected volume
@@ -799,8 +1018,9 @@ namespace Graphics
                             d3dResources.constants.ddgivis.probeRadius = volume.probeRadius;
                             d3dResources.constants.ddgivis.distanceDivisor = volume.probeDistanceDivisor;
 
-                            // Update the TLAS instances and rebuild
-                            UpdateTLAS(d3d, d3dResources, resources, config);
+                            // Gather the probe draws, or update the TLAS instances and rebuild
+                            if (resources.rasterizeProbes) UpdateProbeDraws(resources, config);
+                            else UpdateTLAS(d3d, d3dResources, resources, config);
                         }
 
                         if (resources.flags & VIS_FLAG_SHOW_TEXTURES)
@@ -813,6 +1033,29 @@ namespace Graphics
                             d3dResources.constants.ddgivis.probeDataTextureScale = volume.probeDataScale;
                             d3dResources.constants.ddgivis.probeVariabilityTextureScale = volume.probeVariabilityScale;
                             d3dResources.constants.ddgivis.probeVariabilityTextureThreshold = volume.probeVariabilityThreshold;
+                            d3dResources.constants.ddgivis.textureView = (config.ddgi.textureVisZoom & 0xF) | ((config.ddgi.textureVisPanX & 0x3FFF) << 4) | ((config.ddgi.textureVisPanY & 0x3FFF) << 18);
+
+                            // Redraw the visualization when its volume or view changes
+                            const DDGIVisConsts& consts = d3dResources.constants.ddgivis;
+                            const DDGIVisConsts& drawn = resources.textureVisConsts;
+                            if (resources.textureVisVolume != resources.selectedVolume
+                                || consts.distanceDivisor != drawn.distanceDivisor
+                                || consts.rayDataTextureScale != drawn.rayDataTextureScale
+                                || consts.irradianceTextureScale != drawn.irradianceTextureScale
+                                || consts.distanceTextureScale != drawn.distanceTextureScale
+                                || consts.probeDataTextureScale != drawn.probeDataTextureScale
+                                || consts.probeVariabilityTextureScale != drawn.probeVariabilityTextureScale
+                                || consts.probeVariabilityTextureThreshold != drawn.probeVariabilityTextureThreshold
+                                || consts.textureView != drawn.textureView)
+                            {
+                                resources.textureVisDirty = true;
+                            }
+                            resources.textureVisRefreshFrames = config.ddgi.textureVisRefreshFrames;
+                        }
+                        else
+                        {
+                            // Redraw when the visualization is shown again
+                            resources.textureVisDirty = true;
                         }
                     }
                     CPU_TIMESTAMP_END(resources.cpuStat);
@@ -827,30 +1070,93 @@ namespace Graphics
                     if (resources.enabled)
                     {
                         // Render probes
-                        if (resources.flags & VIS_FLAG_SHOW_PROBES)
+                        if ((resources.flags & VIS_FLAG_SHOW_PROBES) && resources.rasterizeProbes)
+                        {
+                            if (resources.probeDraws.size() > 0)
+                            {
+                            #ifdef GFX_PERF_MARKERS
+                                PIXBeginEvent(GetCmdList(d3d), PIX_COLOR(GFX_PERF_MARKER_GREEN), "Vis: DDGIVolume Probes (Raster)");
+                            #endif
+
+                                // Set the descriptor heaps
+                                ID3D12DescriptorHeap* ppHeaps[] = { d3dResources.srvDescHeap, d3dResources.samplerDescHeap };
+                                GetCmdList(d3d)->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+
+                                // Set the root signature
+                                GetCmdList(d3d)->SetGraphicsRootSignature(d3dResources.rootSignature);
+
+                                // Set the root parameter descriptor tables
+                            #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
+                                GetCmdList(d3d)->SetGraphicsRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
+                                GetCmdList(d3d)->SetGraphicsRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
+                            #endif
+
+                                // Set raster state, the GBuffer is written through ROVs (no render targets)
+                                GetCmdList(d3d)->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+                                GetCmdList(d3d)->RSSetViewports(1, &d3d.renderViewport);
+                                GetCmdList(d3d)->RSSetScissorRects(1, &d3d.renderScissor);
+                                GetCmdList(d3d)->OMSetRenderTargets(0, nullptr, FALSE, nullptr);
+
+                                // Set the pipeline state object
+                                GetCmdList(d3d)->SetPipelineState(resources.rasterPSO);
+
+                                GPU_TIMESTAMP_BEGIN(resources.gpuProbeStat->GetGPUQueryBeginIndex());
+                                GlobalConstants consts = d3dResources.constants;
+                                UINT offset = GlobalConstants::GetAlignedNum32BitValues() - DDGIVisConsts::GetAlignedNum32BitValues();
+                                for (const ProbeDraw& draw : resources.probeDraws)
+                                {
+                                    // Update the vis root constants
+                                    consts.ddgivis.probeRadius = draw.probeRadius;
+                                    consts.ddgivis.probeVisType = draw.probeVisType;
+                                    GetCmdList(d3d)->SetGraphicsRoot32BitConstants(0, DDGIVisConsts::GetNum32BitValues(), consts.ddgivis.GetData(), offset);
+
+                                    // Update the DDGIRootConstants
+                                    DDGIRootConstants ddgiConsts = { draw.volumeIndex, DescriptorHeapOffsets::STB_DDGI_VOLUME_CONSTS, DescriptorHeapOffsets::STB_DDGI_VOLUME_RESOURCE_INDICES };
+                                    GetCmdList(d3d)->SetGraphicsRoot32BitConstants(1, DDGIRootConstants::GetNum32BitValues(), ddgiConsts.GetData(), 0);
+
+                                    // Draw a quad for each probe
+                                    GetCmdList(d3d)->DrawInstanced(4, draw.numProbes, 0, 0);
+                                }
+                                GPU_TIMESTAMP_END(resources.gpuProbeStat->GetGPUQueryEndIndex());
+
+                                D3D12_RESOURCE_BARRIER barriers[2] = {};
+                                barriers[0].Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+                                barriers[0].UAV.pResource = d3dResources.rt.GBufferA;
+                                barriers[1].Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+                                barriers[1].UAV.pResource = d3dResources.rt.GBufferB;
+
+                                // Wait for the draws to complete
+                                GetCmdList(d3d)->ResourceBarrier(2, barriers);
+
+                            #ifdef GFX_PERF_MARKERS
+                                PIXEndEvent(GetCmdList(d3d));
+                            #endif
+                            }
+                        }
+                        else if (resources.flags & VIS_FLAG_SHOW_PROBES)
                         {
                             if (resources.probeInstances.size() > 0)
                             {
                             #ifdef GFX_PERF_MARKERS
-                                PIXBeginEvent(d3d.cmdList[d3d.frameIndex], PIX_COLOR(GFX_PERF_MARKER_GREEN), "Vis: DDGIVolume Probes");
+                                PIXBeginEvent(GetCmdList(d3d), PIX_COLOR(GFX_PERF_MARKER_GREEN), "Vis: DDGIVolume Probes");
                             #endif
 
                                 // Set the descriptor heaps
                                 ID3D12DescriptorHeap* ppHeaps[] = { d3dResources.srvDescHeap, d3dResources.samplerDescHeap };
-                                d3d.cmdList[d3d.frameIndex]->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+                                GetCmdList(d3d)->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
 
                                 // Set the root signature
-                                d3d.cmdList[d3d.frameIndex]->SetComputeRootSignature(d3dResources.rootSignature);
+                                GetCmdList(d3d)->SetComputeRootSignature(d3dResources.rootSignature);
 
                                 // Update the vis root constants
                                 GlobalConstants consts = d3dResources.constants;
                                 UINT offset = GlobalConstants::GetAlignedNum32BitValues() - DDGIVisConsts::GetAlignedNum32BitValues();
-                                d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(0, DDGIVisConsts::GetNum32BitValues(), consts.ddgivis.GetData(), offset);
+                                GetCmdList(d3d)->SetComputeRoot32BitConstants(0, DDGIVisConsts::GetNum32BitValues(), consts.ddgivis.GetData(), offset);
 
                                 // Set the root parameter descriptor tables
                             #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
-                                d3d.cmdList[d3d.frameIndex]->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
-                                d3d.cmdList[d3d.frameIndex]->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
+                                GetCmdList(d3d)->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
+                                GetCmdList(d3d)->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
                             #endif
 
                                 // Describe the shaders and dispatch (EDDGIVolumeProbeVisType::Default)
@@ -867,16 +1173,16 @@ namespace Graphics
                                     desc.HitGroupTable.SizeInBytes = resources.shaderTableHitGroupTableSize;
                                     desc.HitGroupTable.StrideInBytes = resources.shaderTableRecordSize;
 
-                                    desc.Width = d3d.width;
-                                    desc.Height = d3d.height;
+                                    desc.Width = d3d.renderWidth;
+                                    desc.Height = d3d.renderHeight;
                                     desc.Depth = 1;
 
                                     // Set the PSO
-                                    d3d.cmdList[d3d.frameIndex]->SetPipelineState1(resources.rtpso);
+                                    GetCmdList(d3d)->SetPipelineState1(resources.rtpso);
 
                                     // Dispatch rays
                                     GPU_TIMESTAMP_BEGIN(resources.gpuProbeStat->GetGPUQueryBeginIndex());
-                                    d3d.cmdList[d3d.frameIndex]->DispatchRays(&desc);
+                                    GetCmdList(d3d)->DispatchRays(&desc);
                                     GPU_TIMESTAMP_END(resources.gpuProbeStat->GetGPUQueryEndIndex());
 
                                     D3D12_RESOURCE_BARRIER barriers[2] = {};
@@ -886,7 +1192,7 @@ namespace Graphics
                                     barriers[1].UAV.pResource = d3dResources.rt.GBufferB;
 
                                     // Wait for the ray trace to complete
-                                    d3d.cmdList[d3d.frameIndex]->ResourceBarrier(2, barriers);
+                                    GetCmdList(d3d)->ResourceBarrier(2, barriers);
                                 }
 
                                 // Describe the shaders and dispatch (EDDGIVolumeProbeVisType::Hide_Inactive)
@@ -903,16 +1209,16 @@ namespace Graphics
                                     desc.HitGroupTable.SizeInBytes = resources.shaderTableHitGroupTableSize;
                                     desc.HitGroupTable.StrideInBytes = resources.shaderTableRecordSize;
 
-                                    desc.Width = d3d.width;
-                                    desc.Height = d3d.height;
+                                    desc.Width = d3d.renderWidth;
+                                    desc.Height = d3d.renderHeight;
                                     desc.Depth = 1;
 
                                     // Set the PSO
-                                    d3d.cmdList[d3d.frameIndex]->SetPipelineState1(resources.rtpso2);
+                                    GetCmdList(d3d)->SetPipelineState1(resources.rtpso2);
 
                                     // Dispatch rays
                                     GPU_TIMESTAMP_BEGIN(resources.gpuProbeStat->GetGPUQueryBeginIndex());
-                                    d3d.cmdList[d3d.frameIndex]->DispatchRays(&desc);
+                                    GetCmdList(d3d)->DispatchRays(&desc);
                                     GPU_TIMESTAMP_END(resources.gpuProbeStat->GetGPUQueryEndIndex());
 
                                     D3D12_RESOURCE_BARRIER barriers[2] = {};
@@ -922,11 +1228,11 @@ namespace Graphics
                                     barriers[1].UAV.pResource = d3dResources.rt.GBufferB;
 
                                     // Wait for the ray trace to complete
-                                    d3d.cmdList[d3d.frameIndex]->ResourceBarrier(2, barriers);
+                                    GetCmdList(d3d)->ResourceBarrier(2, barriers);
                                 }
 
                             #ifdef GFX_PERF_MARKERS
-                                PIXEndEvent(d3d.cmdList[d3d.frameIndex]);
+                                PIXEndEvent(GetCmdList(d3d));
                             #endif
                             }
                         }
@@ -935,50 +1241,72 @@ namespace Graphics
                         if (resources.flags & VIS_FLAG_SHOW_TEXTURES)
                         {
                         #ifdef GFX_PERF_MARKERS
-                            PIXBeginEvent(d3d.cmdList[d3d.frameIndex], PIX_COLOR(GFX_PERF_MARKER_GREEN), "Vis: DDGIVolume Textures");
+                            PIXBeginEvent(GetCmdList(d3d), PIX_COLOR(GFX_PERF_MARKER_GREEN), "Vis: DDGIVolume Textures");
                         #endif
 
                             // Set the descriptor heaps
                             ID3D12DescriptorHeap* ppHeaps[] = { d3dResources.srvDescHeap, d3dResources.samplerDescHeap };
-                            d3d.cmdList[d3d.frameIndex]->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+                            GetCmdList(d3d)->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
 
                             // Set the root signature
-                            d3d.cmdList[d3d.frameIndex]->SetComputeRootSignature(d3dResources.rootSignature);
+                            GetCmdList(d3d)->SetComputeRootSignature(d3dResources.rootSignature);
 
                             // Update the vis root constants
                             GlobalConstants consts = d3dResources.constants;
                             UINT offset = GlobalConstants::GetAlignedNum32BitValues() - DDGIVisConsts::GetAlignedNum32BitValues();
-                            d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(0, DDGIVisConsts::GetNum32BitValues(), consts.ddgivis.GetData(), offset);
+                            GetCmdList(d3d)->SetComputeRoot32BitConstants(0, DDGIVisConsts::GetNum32BitValues(), consts.ddgivis.GetData(), offset);
 
                             // Update the DDGIRootConstants
                             DDGIRootConstants ddgiConsts = { resources.selectedVolume, DescriptorHeapOffsets::STB_DDGI_VOLUME_CONSTS, DescriptorHeapOffsets::STB_DDGI_VOLUME_RESOURCE_INDICES };
-                            d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(1, DDGIRootConstants::GetNum32BitValues(), ddgiConsts.GetData(), 0);
+                            GetCmdList(d3d)->SetComputeRoot32BitConstants(1, DDGIRootConstants::GetNum32BitValues(), ddgiConsts.GetData(), 0);
 
                             // Set the root parameter descriptor tables
                         #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
-                            d3d.cmdList[d3d.frameIndex]->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
-                            d3d.cmdList[d3d.frameIndex]->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
+                            GetCmdList(d3d)->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
+                            GetCmdList(d3d)->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
                         #endif
 
-                            // Set the PSO
-                            d3d.cmdList[d3d.frameIndex]->SetPipelineState(resources.texturesVisPSO);
-
                             // Dispatch threads
-                            UINT groupsX = DivRoundUp(d3d.width, 8);
-                            UINT groupsY = DivRoundUp(d3d.height, 4);
+                            UINT groupsX = DivRoundUp(d3d.renderWidth, 8);
+                            UINT groupsY = DivRoundUp(d3d.renderHeight, 4);
+
+                            // Redraw the visualization cache when the view changed, or at the refresh rate
+                            resources.textureVisFramesSinceDraw++;
+                            if (resources.textureVisWidth != static_cast<UINT>(d3d.renderWidth) || resources.textureVisHeight != static_cast<UINT>(d3d.renderHeight)) resources.textureVisDirty = true;
+                            if (resources.textureVisRefreshFrames > 0 && resources.textureVisFramesSinceDraw >= resources.textureVisRefreshFrames) resources.textureVisDirty = true;
+
+                            D3D12_RESOURCE_BARRIER barrier = {};
+                            barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
 
                             GPU_TIMESTAMP_BEGIN(resources.gpuTextureStat->GetGPUQueryBeginIndex());
-                            d3d.cmdList[d3d.frameIndex]->Dispatch(groupsX, groupsY, 1);
+                            if (resources.textureVisDirty)
+                            {
+                                GetCmdList(d3d)->SetPipelineState(resources.texturesVisPSO);
+                                GetCmdList(d3d)->Dispatch(groupsX, groupsY, 1);
+
+                                // Wait for the cache to be drawn
+                                barrier.UAV.pResource = resources.textureVisCache;
+                                GetCmdList(d3d)->ResourceBarrier(1, &barrier);
+
+                                resources.textureVisConsts = consts.ddgivis;
+                                resources.textureVisVolume = resources.selectedVolume;
+                                resources.textureVisWidth = static_cast<UINT>(d3d.renderWidth);
+                                resources.textureVisHeight = static_cast<UINT>(d3d.renderHeight);
+                                resources.textureVisFramesSinceDraw = 0;
+                                resources.textureVisDirty = false;
+                            }
+
+                            // Copy the cache to GBufferA
+                            GetCmdList(d3d)->SetPipelineState(resources.texturesVisCompositePSO);
+                            GetCmdList(d3d)->Dispatch(groupsX, groupsY, 1);
                             GPU_TIMESTAMP_END(resources.gpuTextureStat->GetGPUQueryEndIndex());
 
                             // Wait for the compute pass to finish
-                            D3D12_RESOURCE_BARRIER barrier = {};
-                            barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
                             barrier.UAV.pResource = d3dResources.rt.GBufferA;
-                            d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+                            GetCmdList(d3d)->ResourceBarrier(1, &barrier);
 
                         #ifdef GFX_PERF_MARKERS
-                            PIXEndEvent(d3d.cmdList[d3d.frameIndex]);
+                            PIXEndEvent(GetCmdList(d3d));
                         #endif
                         }
 
@@ -992,11 +1320,11 @@ namespace Graphics
                 void Cleanup(Resources& resources)
                 {
                     SAFE_RELEASE(resources.probeVB);
-                    SAFE_RELEASE(resources.probeVBUpload);
                     SAFE_RELEASE(resources.probeIB);
-                    SAFE_RELEASE(resources.probeIBUpload);
+                    SAFE_RELEASE(resources.probeAABB);
 
                     resources.blas.Release();
+                    resources.proceduralBlas.Release();
                     resources.tlas.Release();
 
                     SAFE_RELEASE(resources.shaderTable);
@@ -1010,11 +1338,17 @@ namespace Graphics
                     SAFE_RELEASE(resources.rtpsoInfo2);
 
                     resources.textureVisCS.Release();
+                    resources.textureVisCompositeCS.Release();
                     SAFE_RELEASE(resources.texturesVisPSO);
+                    SAFE_RELEASE(resources.texturesVisCompositePSO);
+                    SAFE_RELEASE(resources.textureVisCache);
 
                     resources.updateTlasCS.Release();
                     SAFE_RELEASE(resources.updateTlasPSO);
 
+                    resources.rasterShaders.Release();
+                    SAFE_RELEASE(resources.rasterPSO);
+
                     resources.shaderTableSize = 0;
                     resources.shaderTableRecordSize = 0;
                     resources.shaderTableMissTableSize = 0;
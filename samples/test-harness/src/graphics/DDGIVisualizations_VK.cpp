@@ -225,7 +225,7 @@ namespace Graphics
 
                     address += resources.shaderTableMissTableSize;
 
-                    // Entry 3: Hit Group (CHS only)
+                    // Entry 3-4: Hit Groups (icosphere LODs, procedural spheres)
                     for (uint32_t hitGroupIndex = 0; hitGroupIndex < static_cast<uint32_t>(resources.rtShaders.hitGroups.size()); hitGroupIndex++)
                     {
                         pData += resources.shaderTableRecordSize;
@@ -236,23 +236,23 @@ namespace Graphics
 
                     // Reset group index for alternate pipeline
                     groupIndex = 0;
-                    address += resources.shaderTableRecordSize;
+                    address += resources.shaderTableHitGroupTableSize;
 
-                    // Entry 4: Ray Generation Shader (Alternate)
+                    // Entry 5: Ray Generation Shader (Alternate)
                     pData += resources.shaderTableRecordSize;
                     memcpy(pData, shaderGroup2Ids[groupIndex++], shaderGroupIdSize);
                     resources.shaderTableRGS2StartAddress = address;
 
                     address += resources.shaderTableRecordSize;
 
-                    // Entry 5: Miss Shader (Alternate)
+                    // Entry 6: Miss Shader (Alternate)
                     pData += resources.shaderTableRecordSize;
                     memcpy(pData, shaderGroup2Ids[groupIndex++], shaderGroupIdSize);
                     resources.shaderTableMissTable2StartAddress = address;
 
                     address += resources.shaderTableMissTableSize;
 
-                    // Entry 6: Hit Group (CHS only)
+                    // Entry 7-8: Hit Groups (Alternate)
                     for (uint32_t hitGroupIndex = 0; hitGroupIndex < static_cast<uint32_t>(resources.rtShaders2.hitGroups.size()); hitGroupIndex++)
                     {
                         pData += resources.shaderTableRecordSize;
@@ -266,7 +266,7 @@ namespace Graphics
                     // Schedule a copy of the shader table from the upload buffer to the device buffer
                     VkBufferCopy bufferCopy = {};
                     bufferCopy.size = resources.shaderTableSize;
-                    vkCmdCopyBuffer(vk.cmdBuffer[vk.frameIndex], resources.shaderTableUpload, resources.shaderTable, 1, &bufferCopy);
+                    vkCmdCopyBuffer(GetCmdBuffer(vk), resources.shaderTableUpload, resources.shaderTable, 1, &bufferCopy);
 
                     return true;
                 }
@@ -276,6 +276,14 @@ namespace Graphics
                     // Clear the instances
                     resources.probeInstances.clear();
 
+                    // Reference the procedural sphere (hit group 1), or LOD 0 of the icosphere LODs (selected on the GPU, see UpdateTLAS)
+                    VkAccelerationStructureDeviceAddressInfoKHR asDeviceAddressInfo = {};
+                    asDeviceAddressInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR;
+                    if (resources.proceduralProbes) asDeviceAddressInfo.accelerationStructure = resources.proceduralBlas.asKHR;
+                    else asDeviceAddressInfo.accelerationStructure = (resources.numBlasLods > 1) ? resources.blasLods.front() : resources.blasLods.back();
+                    VkDeviceAddress blasAddress = vkGetAccelerationStructureDeviceAddressKHR(vk.device, &asDeviceAddressInfo);
+                    uint32_t hitGroupIndex = resources.proceduralProbes ? 1 : 0;
+
                     // Gather the probe instances from volumes
                     uint16_t instanceOffset = 0;
                     for (uint32_t volumeIndex = 0; volumeIndex < static_cast<uint32_t>(resources.volumes->size()); volumeIndex++)
@@ -286,12 +294,6 @@ namespace Graphics
                         // Skip this volume if its "Show Probes" flag is disabled
                         if (!volume->GetShowProbes()) continue;
 
-                        // Get the address of the probe blas
-                        VkAccelerationStructureDeviceAddressInfoKHR asDeviceAddressInfo = {};
-                        asDeviceAddressInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR;
-                        asDeviceAddressInfo.accelerationStructure = resources.blas.asKHR;
-                        VkDeviceAddress blasAddress = vkGetAccelerationStructureDeviceAddressKHR(vk.device, &asDeviceAddressInfo);
-
                         // Add an instance for each probe
                         for (uint32_t probeIndex = 0; probeIndex < static_cast<uint32_t>(volume->GetNumProbes()); probeIndex++)
                         {
@@ -305,7 +307,7 @@ namespace Graphics
                             else if(volume->GetProbeVisType() == EDDGIVolumeProbeVisType::Hide_Inactive) desc.mask = 0x02;
 
                             desc.accelerationStructureReference = blasAddress;
-                            desc.instanceShaderBindingTableRecordOffset = 0;     // A single hit group for all geometry
+                            desc.instanceShaderBindingTableRecordOffset = hitGroupIndex;
                         #if (COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT) || (COORDINATE_SYSTEM == COORDINATE_SYSTEM_LEFT_Z_UP)
                             desc.flags = VK_GEOMETRY_INSTANCE_TRIANGLE_FRONT_COUNTERCLOCKWISE_BIT_KHR;
                         #endif
@@ -333,7 +335,7 @@ namespace Graphics
                     // Schedule a copy of the upload buffer to the device buffer
                     VkBufferCopy bufferCopy = {};
                     bufferCopy.size = size;
-                    vkCmdCopyBuffer(vk.cmdBuffer[vk.frameIndex], resources.tlas.instancesUpload, resources.tlas.instances, 1, &bufferCopy);
+                    vkCmdCopyBuffer(GetCmdBuffer(vk), resources.tlas.instancesUpload, resources.tlas.instances, 1, &bufferCopy);
 
                     return true;
                 }
@@ -351,10 +353,14 @@ namespace Graphics
                     if (resources.probeInstances.size() == 0) return true;
 
                     // Bind the descriptor set
-                    vkCmdBindDescriptorSets(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_COMPUTE, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
+                    vkCmdBindDescriptorSets(GetCmdBuffer(vk), VK_PIPELINE_BIND_POINT_COMPUTE, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
 
                     // Bind the update pipeline
-                    vkCmdBindPipeline(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_COMPUTE, resources.updateTlasPipeline);
+                    vkCmdBindPipeline(GetCmdBuffer(vk), VK_PIPELINE_BIND_POINT_COMPUTE, resources.updateTlasPipeline);
+
+                    // The probe sphere LODs of the instances (see ProbesUpdateCS.hlsl)
+                    uint32_t numLods = resources.proceduralProbes ? 1 : resources.numBlasLods;
+                    uint32_t lods = (numLods << 16) | ((resources.blasLodStride / 256) << 20);
 
                     uint32_t instanceOffset = 0;
                     for (uint32_t volumeIndex = 0; volumeIndex < static_cast<uint32_t>(resources.volumes->size()); volumeIndex++)
@@ -365,22 +371,22 @@ namespace Graphics
                         if (!volume->GetShowProbes()) continue;
 
                         // Update the constants
-                        vkResources.constants.ddgivis.instanceOffset = instanceOffset;
+                        vkResources.constants.ddgivis.instanceOffset = instanceOffset | lods;
                         vkResources.constants.ddgivis.probeRadius = config.ddgi.volumes[volumeIndex].probeRadius;
 
                         // Update the vis push constants
                         uint32_t offset = GlobalConstants::GetAlignedSizeInBytes() - DDGIVisConsts::GetAlignedSizeInBytes();
-                        vkCmdPushConstants(vk.cmdBuffer[vk.frameIndex], vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, DDGIVisConsts::GetSizeInBytes(), vkResources.constants.ddgivis.GetData());
+                        vkCmdPushConstants(GetCmdBuffer(vk), vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, DDGIVisConsts::GetSizeInBytes(), vkResources.constants.ddgivis.GetData());
 
                         // Update the DDGIRootConstants
                         offset = GlobalConstants::GetAlignedSizeInBytes();
-                        vkCmdPushConstants(vk.cmdBuffer[vk.frameIndex], vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, DDGIRootConstants::GetSizeInBytes(), volume->GetPushConstants().GetData());
+                        vkCmdPushConstants(GetCmdBuffer(vk), vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, DDGIRootConstants::GetSizeInBytes(), volume->GetPushConstants().GetData());
 
                         // Dispatch the compute shader
                         float groupSize = 32.f;
                         uint32_t numProbes = static_cast<uint32_t>(volume->GetNumProbes());
                         uint32_t numGroups = (uint32_t)ceil((float)numProbes / groupSize);
-                        vkCmdDispatch(vk.cmdBuffer[vk.frameIndex], numGroups, 1, 1);
+                        vkCmdDispatch(GetCmdBuffer(vk), numGroups, 1, 1);
 
                         // Increment the instance offset
                         instanceOffset += volume->GetNumProbes();
@@ -390,7 +396,7 @@ namespace Graphics
                     VkMemoryBarrier barrier{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
                     barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
                     barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-                    vkCmdPipelineBarrier(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+                    vkCmdPipelineBarrier(GetCmdBuffer(vk), VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
 
                     VkBuildAccelerationStructureFlagBitsKHR buildFlags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
 
@@ -425,17 +431,17 @@ namespace Graphics
                     VkAccelerationStructureBuildRangeInfoKHR buildInfo = { static_cast<UINT>(resources.probeInstances.size()), 0, 0, 0 };
                     buildRangeInfos[0] = &buildInfo;
 
-                    vkCmdBuildAccelerationStructuresKHR(vk.cmdBuffer[vk.frameIndex], 1, &asInputs, buildRangeInfos.data());
+                    vkCmdBuildAccelerationStructuresKHR(GetCmdBuffer(vk), 1, &asInputs, buildRangeInfos.data());
 
                     // Wait for the TLAS build to complete
                     barrier = {};
                     barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
                     barrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
                     barrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
-                    vkCmdPipelineBarrier(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+                    vkCmdPipelineBarrier(GetCmdBuffer(vk), VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, 0, 1, &barrier, 0, nullptr, 0, nullptr);
 
                 #ifdef GFX_PERF_MARKERS
-                    vkCmdEndDebugUtilsLabelEXT(vk.cmdBuffer[vk.frameIndex]);
+                    vkCmdEndDebugUtilsLabelEXT(GetCmdBuffer(vk));
                 #endif
 
                     return true;
@@ -486,9 +492,9 @@ namespace Graphics
                         resources.rtShaders2.miss = resources.rtShaders.miss;
                     }
 
-                    // Add the hit group
+                    // Add the hit groups
                     {
-                        resources.rtShaders.hitGroups.emplace_back();
+                        resources.rtShaders.hitGroups.resize(2);
 
                         Shaders::ShaderRTHitGroup& group = resources.rtShaders.hitGroups[0];
                         group.exportName = L"DDGIVisProbesHitGroup";
@@ -503,6 +509,24 @@ namespace Graphics
                         Shaders::AddDefine(group.chs, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS));
                         CHECK(Shaders::Compile(vk.shaderCompiler, group.chs), "compile DDGI Visualizations closest hit shader!\n", log);
 
+                        // Procedural sphere hit group, the same closest hit shader with the sphere intersection shader
+                        Shaders::ShaderRTHitGroup& proceduralGroup = resources.rtShaders.hitGroups[1];
+                        proceduralGroup.exportName = L"DDGIVisProbesProceduralHitGroup";
+
+                        proceduralGroup.chs.filepath = group.chs.filepath;
+                        proceduralGroup.chs.entryPoint = L"CHS";
+                        proceduralGroup.chs.exportName = L"DDGIVisProbesProceduralCHS";
+                        proceduralGroup.chs.arguments = { L"-spirv", L"-D __spirv__", L"-fspv-target-env=vulkan1.2" };
+                        Shaders::AddDefine(proceduralGroup.chs, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS));
+                        CHECK(Shaders::Compile(vk.shaderCompiler, proceduralGroup.chs), "compile DDGI Visualizations closest hit shader!\n", log);
+
+                        proceduralGroup.is.filepath = root + L"shaders/ddgi/visualizations/ProbesIS.hlsl";
+                        proceduralGroup.is.entryPoint = L"IS";
+                        proceduralGroup.is.exportName = L"DDGIVisProbesIS";
+                        proceduralGroup.is.arguments = { L"-spirv", L"-D __spirv__", L"-fspv-target-env=vulkan1.2" };
+                        Shaders::AddDefine(proceduralGroup.is, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS));
+                        CHECK(Shaders::Compile(vk.shaderCompiler, proceduralGroup.is), "compile DDGI Visualizations intersection shader!\n", log);
+
                         // Set the payload size
                         resources.rtShaders.payloadSizeInBytes = sizeof(ProbeVisualizationPayload);
 
@@ -633,7 +657,7 @@ namespace Graphics
                     {
                         // Create the probe visualization RT pipeline (default)
                         CHECK(CreateRayTracingPipeline(
-                            vk.device,
+                            vk,
                             vkResources.pipelineLayout,
                             resources.rtShaders,
                             resources.rtShadersModule,
@@ -645,7 +669,7 @@ namespace Graphics
 
                         // Create the probe visualization RT pipeline (alternate)
                         CHECK(CreateRayTracingPipeline(
-                            vk.device,
+                            vk,
                             vkResources.pipelineLayout,
                             resources.rtShaders2,
                             resources.rtShadersModule2,
@@ -657,7 +681,7 @@ namespace Graphics
 
                         // Create the volume texture visualization pipeline
                         CHECK(CreateComputePipeline(
-                            vk.device,
+                            vk,
                             vkResources.pipelineLayout,
                             resources.textureVisCS,
                             resources.textureVisModule,
@@ -670,7 +694,7 @@ namespace Graphics
 
                         // Create the probe update pipeline
                         CHECK(CreateComputePipeline(
-                            vk.device,
+                            vk,
                             vkResources.pipelineLayout,
                             resources.updateTlasCS,
                             resources.updateTlasModule,
@@ -690,10 +714,12 @@ namespace Graphics
                     // The Shader Table layout is as follows:
                     //    Entry 0:  Probe Vis Ray Generation Shader (default)
                     //    Entry 2:  Probe Vis Miss Shader
-                    //    Entry 3:  Probe Vis HitGroup (CHS only)
-                    //    Entry 4:  Probe Vis Ray Generation Shader (alternate)
-                    //    Entry 5:  Probe Vis Miss Shader (alternate)
-                    //    Entry 6:  Probe Vis HitGroup (CHS only) (alternate)
+                    //    Entry 3:  Probe Vis HitGroup (icosphere LODs)
+                    //    Entry 4:  Probe Vis HitGroup (procedural spheres)
+                    //    Entry 5:  Probe Vis Ray Generation Shader (alternate)
+                    //    Entry 6:  Probe Vis Miss Shader (alternate)
+                    //    Entry 7:  Probe Vis HitGroup (icosphere LODs) (alternate)
+                    //    Entry 8:  Probe Vis HitGroup (procedural spheres) (alternate)
 
                     // All shader records in the Shader Table must have the same size, so shader record size will be based on the largest required entry.
                     // The entries must be aligned to VkPhysicalDeviceRayTracingPipelinePropertiesKHR::shaderGroupBaseAlignment.
@@ -738,8 +764,11 @@ namespace Graphics
 
                 bool CreateGeometry(Globals& vk, GlobalResources& vkResources, Resources& resources, std::ofstream& log)
                 {
-                    // Generate the sphere geometry
-                    Geometry::CreateSphere(30, 30, resources.probe);
+                    // Generate the sphere geometry, a mesh primitive for each LOD
+                    for (uint32_t lod = 0; lod < PROBE_SPHERE_LODS; lod++)
+                    {
+                        Geometry::CreateIcosphere(lod, resources.probe);
+                    }
 
                     // Create the probe sphere's index buffer
                     CHECK(CreateIndexBuffer(
@@ -752,7 +781,6 @@ namespace Graphics
                         "create probe index buffer!", log);
                 #ifdef GFX_NAME_OBJECTS
                     SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.probeIB), "IB: Probe Sphere, Primitive 0", VK_OBJECT_TYPE_BUFFER);
-                    SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.probeIBMemory), "IB: Probe Sphere, Primitive 0 Memory", VK_OBJECT_TYPE_DEVICE_MEMORY);
                 #endif
 
                     // Create the probe sphere's vertex buffer
@@ -766,89 +794,176 @@ namespace Graphics
                         "create probe vertex buffer!", log);
                 #ifdef GFX_NAME_OBJECTS
                     SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.probeVB), "VB: Probe Sphere, Primitive 0", VK_OBJECT_TYPE_BUFFER);
-                    SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.probeVBMemory), "VB: Probe Sphere, Primitive 0 Memory", VK_OBJECT_TYPE_DEVICE_MEMORY);
                 #endif
 
+                    // Create the procedural sphere's AABB (the bounds of the icospheres)
+                    BufferDesc desc = { sizeof(VkAabbPositionsKHR), VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT };
+                    CHECK(CreateBuffer(vk, desc, &resources.probeAABB, &resources.probeAABBMemory), "create probe AABB buffer!", log);
+                #ifdef GFX_NAME_OBJECTS
+                    SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.probeAABB), "AABB: Probe Sphere", VK_OBJECT_TYPE_BUFFER);
+                    SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.probeAABBMemory), "AABB Memory: Probe Sphere", VK_OBJECT_TYPE_DEVICE_MEMORY);
+                #endif
+
+                    VkAabbPositionsKHR* pAABB = nullptr;
+                    VKCHECK(vkMapMemory(vk.device, resources.probeAABBMemory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&pAABB)));
+                    *pAABB = { -0.5f, -0.5f, -0.5f, 0.5f, 0.5f, 0.5f };
+                    vkUnmapMemory(vk.device, resources.probeAABBMemory);
+
                     return true;
                 }
 
-                bool CreateBLAS(Globals& vk, Resources& resources)
+                bool CreateBLAS(Globals& vk, Resources& resources, std::ofstream& log)
                 {
-                    // Describe the BLAS geometries
-                    VkAccelerationStructureGeometryKHR geometryDesc = {};
-                    geometryDesc.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
-                    geometryDesc.geometryType = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
-                    geometryDesc.geometry.triangles.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
-                    geometryDesc.geometry.triangles.vertexData = VkDeviceOrHostAddressConstKHR{ GetBufferDeviceAddress(vk.device, resources.probeVB) };
-                    geometryDesc.geometry.triangles.vertexStride = sizeof(Vertex);
-                    geometryDesc.geometry.triangles.maxVertex = resources.probe.numVertices;
-                    geometryDesc.geometry.triangles.vertexFormat = VK_FORMAT_R32G32B32_SFLOAT;
-                    geometryDesc.geometry.triangles.indexData = VkDeviceOrHostAddressConstKHR{ GetBufferDeviceAddress(vk.device, resources.probeIB) };
-                    geometryDesc.geometry.triangles.indexType = VK_INDEX_TYPE_UINT32;
-                    geometryDesc.flags = VK_GEOMETRY_OPAQUE_BIT_KHR;
+                    // Describe the BLAS geometries, an icosphere LOD in each BLAS and the procedural sphere's AABB
+                    uint32_t numBlas = PROBE_SPHERE_LODS + 1;
+                    std::vector<VkAccelerationStructureGeometryKHR> geometryDescs(numBlas);
+                    std::vector<uint32_t> primitiveCounts(numBlas);
+                    for (uint32_t lod = 0; lod < PROBE_SPHERE_LODS; lod++)
+                    {
+                        const Scenes::MeshPrimitive& primitive = resources.probe.primitives[lod];
+
+                        VkAccelerationStructureGeometryKHR& geometryDesc = geometryDescs[lod];
+                        geometryDesc.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
+                        geometryDesc.geometryType = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
+                        geometryDesc.geometry.triangles.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
+                        geometryDesc.geometry.triangles.vertexData = VkDeviceOrHostAddressConstKHR{ GetBufferDeviceAddress(vk.device, resources.probeVB) + primitive.vertexByteOffset };
+                        geometryDesc.geometry.triangles.vertexStride = sizeof(Vertex);
+                        geometryDesc.geometry.triangles.maxVertex = static_cast<uint32_t>(primitive.vertices.size());
+                        geometryDesc.geometry.triangles.vertexFormat = VK_FORMAT_R32G32B32_SFLOAT;
+                        geometryDesc.geometry.triangles.indexData = VkDeviceOrHostAddressConstKHR{ GetBufferDeviceAddress(vk.device, resources.probeIB) + primitive.indexByteOffset };
+                        geometryDesc.geometry.triangles.indexType = VK_INDEX_TYPE_UINT32;
+                        geometryDesc.flags = VK_GEOMETRY_OPAQUE_BIT_KHR;
+
+                        primitiveCounts[lod] = static_cast<uint32_t>(primitive.indices.size()) / 3;
+                    }
 
-                    VkBuildAccelerationStructureFlagBitsKHR buildFlags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_BUILD_BIT_KHR;
+                    VkAccelerationStructureGeometryKHR& aabbDesc = geometryDescs[PROBE_SPHERE_LODS];
+                    aabbDesc.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
+                    aabbDesc.geometryType = VK_GEOMETRY_TYPE_AABBS_KHR;
+                    aabbDesc.geometry.aabbs.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_AABBS_DATA_KHR;
+                    aabbDesc.geometry.aabbs.data = VkDeviceOrHostAddressConstKHR{ GetBufferDeviceAddress(vk.device, resources.probeAABB) };
+                    aabbDesc.geometry.aabbs.stride = sizeof(VkAabbPositionsKHR);
+                    aabbDesc.flags = VK_GEOMETRY_OPAQUE_BIT_KHR;
+                    primitiveCounts[PROBE_SPHERE_LODS] = 1;
 
-                    // Describe the bottom level acceleration structure inputs
-                    VkAccelerationStructureBuildGeometryInfoKHR asInputs = {};
-                    asInputs.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
-                    asInputs.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
-                    asInputs.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
-                    asInputs.geometryCount = 1;
-                    asInputs.pGeometries = &geometryDesc;
-                    asInputs.flags = buildFlags;
+                    VkBuildAccelerationStructureFlagBitsKHR buildFlags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_BUILD_BIT_KHR;
 
-                    // Get the size requirements for the BLAS buffer
-                    uint32_t primitiveCount = resources.probe.numIndices / 3;
-                    VkAccelerationStructureBuildSizesInfoKHR asPreBuildInfo = {};
-                    asPreBuildInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
-                    vkGetAccelerationStructureBuildSizesKHR(vk.device, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR, &asInputs, &primitiveCount, &asPreBuildInfo);
+                    // Describe the bottom level acceleration structure inputs and get their size requirements
+                    std::vector<VkAccelerationStructureBuildGeometryInfoKHR> asInputs(numBlas);
+                    std::vector<VkAccelerationStructureBuildSizesInfoKHR> asPreBuildInfos(numBlas);
+                    VkDeviceSize scratchAlignment = vk.deviceASProps.minAccelerationStructureScratchOffsetAlignment;
+                    VkDeviceSize scratchSize = 0;
+                    VkDeviceSize lodStride = 0;
+                    for (uint32_t blasIndex = 0; blasIndex < numBlas; blasIndex++)
+                    {
+                        asInputs[blasIndex].sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
+                        asInputs[blasIndex].type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+                        asInputs[blasIndex].mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+                        asInputs[blasIndex].geometryCount = 1;
+                        asInputs[blasIndex].pGeometries = &geometryDescs[blasIndex];
+                        asInputs[blasIndex].flags = buildFlags;
+
+                        asPreBuildInfos[blasIndex].sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
+                        vkGetAccelerationStructureBuildSizesKHR(vk.device, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR, &asInputs[blasIndex], &primitiveCounts[blasIndex], &asPreBuildInfos[blasIndex]);
+                        asPreBuildInfos[blasIndex].buildScratchSize = ALIGN(scratchAlignment, asPreBuildInfos[blasIndex].buildScratchSize);
+                        scratchSize += asPreBuildInfos[blasIndex].buildScratchSize;
+
+                        if (blasIndex < PROBE_SPHERE_LODS) lodStride = std::max(lodStride, ALIGN(256, asPreBuildInfos[blasIndex].accelerationStructureSize));
+                    }
+                    if ((lodStride / 256) > 0xFFF) return false;
+                    resources.blasLodStride = static_cast<uint32_t>(lodStride);
 
-                    // Create the BLAS scratch buffer, allocate and bind device memory
-                    BufferDesc blasScratchDesc = { asPreBuildInfo.buildScratchSize, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT };
+                    // Create the BLAS scratch buffer, a region for each build (the builds don't wait for each other)
+                    BufferDesc blasScratchDesc = { scratchSize, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT };
                     if (!CreateBuffer(vk, blasScratchDesc, &resources.blas.scratch, &resources.blas.scratchMemory)) return false;
-                    asInputs.scratchData = VkDeviceOrHostAddressKHR{ GetBufferDeviceAddress(vk.device, resources.blas.scratch) };
                 #ifdef GFX_NAME_OBJECTS
-                    SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.blas.scratch), "BLAS Scratch: Probe Sphere, Primitive 0", VK_OBJECT_TYPE_BUFFER);
-                    SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.blas.scratchMemory), "BLAS Scratch Memory: Probe Sphere, Primitive 0", VK_OBJECT_TYPE_DEVICE_MEMORY);
+                    SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.blas.scratch), "BLAS Scratch: Probe Sphere", VK_OBJECT_TYPE_BUFFER);
+                    SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.blas.scratchMemory), "BLAS Scratch Memory: Probe Sphere", VK_OBJECT_TYPE_DEVICE_MEMORY);
                 #endif
 
-                    // Create the BLAS buffer, allocate and bind device memory
-                    BufferDesc blasDesc = { asPreBuildInfo.accelerationStructureSize, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT };
+                    // Create the LOD BLAS buffer, allocate and bind device memory
+                    BufferDesc blasDesc = { lodStride * PROBE_SPHERE_LODS, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT };
                     if (!CreateBuffer(vk, blasDesc, &resources.blas.asBuffer, &resources.blas.asMemory)) return false;
                 #ifdef GFX_NAME_OBJECTS
-                    SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.blas.asBuffer), "BLAS: Probe Sphere, Primitive 0", VK_OBJECT_TYPE_BUFFER);
-                    SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.blas.asMemory), "BLAS Memory: Probe Sphere, Primitive 0", VK_OBJECT_TYPE_DEVICE_MEMORY);
+                    SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.blas.asBuffer), "BLAS: Probe Sphere LODs", VK_OBJECT_TYPE_BUFFER);
+                    SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.blas.asMemory), "BLAS Memory: Probe Sphere LODs", VK_OBJECT_TYPE_DEVICE_MEMORY);
                 #endif
 
-                    // Describe the BLAS acceleration structure
-                    VkAccelerationStructureCreateInfoKHR asCreateInfo = {};
-                    asCreateInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
-                    asCreateInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
-                    asCreateInfo.size = asPreBuildInfo.accelerationStructureSize;
-                    asCreateInfo.buffer = resources.blas.asBuffer;
-
-                    // Create the BLAS acceleration structure
-                    VKCHECK(vkCreateAccelerationStructureKHR(vk.device, &asCreateInfo, nullptr, &resources.blas.asKHR));
+                    // Create the procedural sphere BLAS buffer, allocate and bind device memory
+                    blasDesc.size = asPreBuildInfos[PROBE_SPHERE_LODS].accelerationStructureSize;
+                    if (!CreateBuffer(vk, blasDesc, &resources.proceduralBlas.asBuffer, &resources.proceduralBlas.asMemory)) return false;
                 #ifdef GFX_NAME_OBJECTS
-                    SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.blas.asKHR), "BLAS: Probe Sphere, Primitive 0", VK_OBJECT_TYPE_ACCELERATION_STRUCTURE_KHR);
+                    SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.proceduralBlas.asBuffer), "BLAS: Probe Sphere (Procedural)", VK_OBJECT_TYPE_BUFFER);
+                    SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.proceduralBlas.asMemory), "BLAS Memory: Probe Sphere (Procedural)", VK_OBJECT_TYPE_DEVICE_MEMORY);
                 #endif
 
-                    // Set the location of the final acceleration structure
-                    asInputs.dstAccelerationStructure = resources.blas.asKHR;
+                    // Create the BLAS acceleration structures, the LODs are blasLodStride bytes apart in the LOD BLAS buffer
+                    resources.blasLods.resize(PROBE_SPHERE_LODS);
+                    for (uint32_t blasIndex = 0; blasIndex < numBlas; blasIndex++)
+                    {
+                        VkAccelerationStructureCreateInfoKHR asCreateInfo = {};
+                        asCreateInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
+                        asCreateInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+                        asCreateInfo.size = asPreBuildInfos[blasIndex].accelerationStructureSize;
+
+                        VkAccelerationStructureKHR* as = nullptr;
+                        if (blasIndex < PROBE_SPHERE_LODS)
+                        {
+                            asCreateInfo.buffer = resources.blas.asBuffer;
+                            asCreateInfo.offset = blasIndex * lodStride;
+                            as = &resources.blasLods[blasIndex];
+                        }
+                        else
+                        {
+                            asCreateInfo.buffer = resources.proceduralBlas.asBuffer;
+                            as = &resources.proceduralBlas.asKHR;
+                        }
+                        VKCHECK(vkCreateAccelerationStructureKHR(vk.device, &asCreateInfo, nullptr, as));
+                    #ifdef GFX_NAME_OBJECTS
+                        std::string name = (blasIndex < PROBE_SPHERE_LODS) ? "BLAS: Probe Sphere, LOD " + std::to_string(blasIndex) : "BLAS: Probe Sphere (Procedural)";
+                        SetObjectName(vk.device, reinterpret_cast<uint64_t>(*as), name.c_str(), VK_OBJECT_TYPE_ACCELERATION_STRUCTURE_KHR);
+                    #endif
+                        asInputs[blasIndex].dstAccelerationStructure = *as;
+                    }
+
+                    // The probe update shader offsets the address of LOD 0 by the stride (see ProbesUpdateCS.hlsl),
+                    // the device addresses of acceleration structures aren't required to follow their buffer offsets
+                    resources.numBlasLods = PROBE_SPHERE_LODS;
+                    VkAccelerationStructureDeviceAddressInfoKHR asDeviceAddressInfo = {};
+                    asDeviceAddressInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR;
+                    asDeviceAddressInfo.accelerationStructure = resources.blasLods[0];
+                    VkDeviceAddress lod0Address = vkGetAccelerationStructureDeviceAddressKHR(vk.device, &asDeviceAddressInfo);
+                    for (uint32_t lod = 1; lod < PROBE_SPHERE_LODS; lod++)
+                    {
+                        asDeviceAddressInfo.accelerationStructure = resources.blasLods[lod];
+                        if (vkGetAccelerationStructureDeviceAddressKHR(vk.device, &asDeviceAddressInfo) != (lod0Address + (lod * lodStride)))
+                        {
+                            log << "\nProbe sphere BLAS LOD addresses are not uniformly spaced, using the finest LOD.";
+                            resources.numBlasLods = 1;
+                            break;
+                        }
+                    }
 
                     // Describe and build the BLAS
-                    std::vector<const VkAccelerationStructureBuildRangeInfoKHR*> buildRangeInfos(1);
-                    VkAccelerationStructureBuildRangeInfoKHR buildInfo = { primitiveCount, 0, 0, 0 };
-                    buildRangeInfos[0] = &buildInfo;
+                    std::vector<VkAccelerationStructureBuildRangeInfoKHR> buildInfos(numBlas);
+                    std::vector<const VkAccelerationStructureBuildRangeInfoKHR*> buildRangeInfos(numBlas);
+                    VkDeviceAddress scratchAddress = GetBufferDeviceAddress(vk.device, resources.blas.scratch);
+                    for (uint32_t blasIndex = 0; blasIndex < numBlas; blasIndex++)
+                    {
+                        asInputs[blasIndex].scratchData = VkDeviceOrHostAddressKHR{ scratchAddress };
+                        scratchAddress += asPreBuildInfos[blasIndex].buildScratchSize;
+
+                        buildInfos[blasIndex] = { primitiveCounts[blasIndex], 0, 0, 0 };
+                        buildRangeInfos[blasIndex] = &buildInfos[blasIndex];
+                    }
 
-                    vkCmdBuildAccelerationStructuresKHR(vk.cmdBuffer[vk.frameIndex], 1, &asInputs, buildRangeInfos.data());
+                    vkCmdBuildAccelerationStructuresKHR(GetCmdBuffer(vk), numBlas, asInputs.data(), buildRangeInfos.data());
 
-                    // Wait for the BLAS build to complete
+                    // Wait for the BLAS builds to complete
                     VkMemoryBarrier barrier{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
                     barrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
                     barrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
-                    vkCmdPipelineBarrier(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+                    vkCmdPipelineBarrier(GetCmdBuffer(vk), VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, 0, 1, &barrier, 0, nullptr, 0, nullptr);
 
                     return true;
                 }
@@ -977,7 +1092,7 @@ namespace Graphics
                     if (!CreatePipelines(vk, vkResources, resources, log)) return false;
                     if (!CreateShaderTable(vk, resources, log)) return false;
                     if (!CreateGeometry(vk, vkResources, resources, log)) return false;
-                    if (!CreateBLAS(vk, resources)) return false;
+                    if (!CreateBLAS(vk, resources, log)) return false;
                     if (!CreateTLAS(vk, resources)) return false;
 
                     if (!UpdateShaderTable(vk, vkResources, resources)) return false;
@@ -1036,6 +1151,8 @@ namespace Graphics
                     if (config.ddgi.showProbes) resources.flags |= VIS_FLAG_SHOW_PROBES;
                     if (config.ddgi.showTextures) resources.flags |= VIS_FLAG_SHOW_TEXTURES;
 
+                    resources.proceduralProbes = config.ddgi.proceduralProbes;
+
                     resources.enabled = config.ddgi.enabled;
                     if (resources.enabled)
                     {
@@ -1066,6 +1183,7 @@ namespace Graphics
                             vkResources.constants.ddgivis.probeDataTextureScale = volume.probeDataScale;
                             vkResources.constants.ddgivis.probeVariabilityTextureScale = volume.probeVariabilityScale;
                             vkResources.constants.ddgivis.probeVariabilityTextureThreshold = volume.probeVariabilityThreshold;
+                            vkResources.constants.ddgivis.textureView = (config.ddgi.textureVisZoom & 0xF) | ((config.ddgi.textureVisPanX & 0x3FFF) << 4) | ((config.ddgi.textureVisPanY & 0x3FFF) << 18);
                         }
                     }
                     CPU_TIMESTAMP_END(resources.cpuStat);
@@ -1091,10 +1209,10 @@ namespace Graphics
                                 // Update the vis push constants
                                 GlobalConstants consts = vkResources.constants;
                                 uint32_t offset = GlobalConstants::GetAlignedSizeInBytes() - DDGIVisConsts::GetAlignedSizeInBytes();
-                                vkCmdPushConstants(vk.cmdBuffer[vk.frameIndex], vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, DDGIVisConsts::GetSizeInBytes(), consts.ddgivis.GetData());
+                                vkCmdPushConstants(GetCmdBuffer(vk), vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, DDGIVisConsts::GetSizeInBytes(), consts.ddgivis.GetData());
 
                                 // Bind the descriptor set
-                                vkCmdBindDescriptorSets(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
+                                vkCmdBindDescriptorSets(GetCmdBuffer(vk), VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
 
                                 // Describe the shaders and dispatch (EDDGIVolumeProbeVisType::Default)
                                 {
@@ -1116,26 +1234,26 @@ namespace Graphics
                                     VkStridedDeviceAddressRegionKHR callableRegion = {};
 
                                     // Bind the pipeline
-                                    vkCmdBindPipeline(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, resources.rtPipeline);
+                                    vkCmdBindPipeline(GetCmdBuffer(vk), VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, resources.rtPipeline);
 
                                     // Dispatch rays
                                     GPU_TIMESTAMP_BEGIN(resources.gpuProbeStat->GetGPUQueryBeginIndex());
                                     vkCmdTraceRaysKHR(
-                                        vk.cmdBuffer[vk.frameIndex],
+                                        GetCmdBuffer(vk),
                                         &raygenRegion,
                                         &missRegion,
                                         &hitRegion,
                                         &callableRegion,
-                                        vk.width,
-                                        vk.height,
+                                        vk.renderWidth,
+                                        vk.renderHeight,
                                         1);
                                     GPU_TIMESTAMP_END(resources.gpuProbeStat->GetGPUQueryEndIndex());
 
                                     // Wait for the ray trace to finish
                                     VkImageSubresourceRange range = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
                                     ImageBarrierDesc barrier = { VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 } };
-                                    SetImageMemoryBarrier(vk.cmdBuffer[vk.frameIndex], vkResources.rt.GBufferA, barrier);
-                                    SetImageMemoryBarrier(vk.cmdBuffer[vk.frameIndex], vkResources.rt.GBufferB, barrier);
+                                    SetImageMemoryBarrier(GetCmdBuffer(vk), vkResources.rt.GBufferA, barrier);
+                                    SetImageMemoryBarrier(GetCmdBuffer(vk), vkResources.rt.GBufferB, barrier);
                                 }
 
                                 // Describe the shaders and dispatch (EDDGIVolumeProbeVisType::Hide_Inactive)
@@ -1158,30 +1276,30 @@ namespace Graphics
                                     VkStridedDeviceAddressRegionKHR callableRegion = {};
 
                                     // Bind the pipeline
-                                    vkCmdBindPipeline(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, resources.rtPipeline2);
+                                    vkCmdBindPipeline(GetCmdBuffer(vk), VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, resources.rtPipeline2);
 
                                     // Dispatch rays
                                     GPU_TIMESTAMP_BEGIN(resources.gpuProbeStat->GetGPUQueryBeginIndex());
                                     vkCmdTraceRaysKHR(
-                                        vk.cmdBuffer[vk.frameIndex],
+                                        GetCmdBuffer(vk),
                                         &raygenRegion,
                                         &missRegion,
                                         &hitRegion,
                                         &callableRegion,
-                                        vk.width,
-                                        vk.height,
+                                        vk.renderWidth,
+                                        vk.renderHeight,
                                         1);
                                     GPU_TIMESTAMP_END(resources.gpuProbeStat->GetGPUQueryEndIndex());
 
                                     // Wait for the ray trace to finish
                                     VkImageSubresourceRange range = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
                                     ImageBarrierDesc barrier = { VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 } };
-                                    SetImageMemoryBarrier(vk.cmdBuffer[vk.frameIndex], vkResources.rt.GBufferA, barrier);
-                                    SetImageMemoryBarrier(vk.cmdBuffer[vk.frameIndex], vkResources.rt.GBufferB, barrier);
+                                    SetImageMemoryBarrier(GetCmdBuffer(vk), vkResources.rt.GBufferA, barrier);
+                                    SetImageMemoryBarrier(GetCmdBuffer(vk), vkResources.rt.GBufferB, barrier);
                                 }
 
                             #ifdef GFX_PERF_MARKERS
-                                vkCmdEndDebugUtilsLabelEXT(vk.cmdBuffer[vk.frameIndex]);
+                                vkCmdEndDebugUtilsLabelEXT(GetCmdBuffer(vk));
                             #endif
                             }
                         }
@@ -1196,33 +1314,33 @@ namespace Graphics
                             // Update the vis push constants
                             GlobalConstants consts = vkResources.constants;
                             uint32_t offset = GlobalConstants::GetAlignedSizeInBytes() - DDGIVisConsts::GetAlignedSizeInBytes();
-                            vkCmdPushConstants(vk.cmdBuffer[vk.frameIndex], vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, DDGIVisConsts::GetSizeInBytes(), consts.ddgivis.GetData());
+                            vkCmdPushConstants(GetCmdBuffer(vk), vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, DDGIVisConsts::GetSizeInBytes(), consts.ddgivis.GetData());
 
                             // Update the DDGI push constants
                             DDGIRootConstants pushConsts = { resources.selectedVolume, 0, 0 };
-                            vkCmdPushConstants(vk.cmdBuffer[vk.frameIndex], vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, GlobalConstants::GetAlignedSizeInBytes(), DDGIRootConstants::GetSizeInBytes(), pushConsts.GetData());
+                            vkCmdPushConstants(GetCmdBuffer(vk), vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, GlobalConstants::GetAlignedSizeInBytes(), DDGIRootConstants::GetSizeInBytes(), pushConsts.GetData());
 
                             // Bind the pipeline
-                            vkCmdBindPipeline(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_COMPUTE, resources.textureVisPipeline);
+                            vkCmdBindPipeline(GetCmdBuffer(vk), VK_PIPELINE_BIND_POINT_COMPUTE, resources.textureVisPipeline);
 
                             // Bind the descriptor set
-                            vkCmdBindDescriptorSets(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_COMPUTE, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
+                            vkCmdBindDescriptorSets(GetCmdBuffer(vk), VK_PIPELINE_BIND_POINT_COMPUTE, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
 
                             // Dispatch threads
-                            uint32_t groupsX = DivRoundUp(vk.width, 8);
-                            uint32_t groupsY = DivRoundUp(vk.height, 4);
+                            uint32_t groupsX = DivRoundUp(vk.renderWidth, 8);
+                            uint32_t groupsY = DivRoundUp(vk.renderHeight, 4);
 
                             GPU_TIMESTAMP_BEGIN(resources.gpuTextureStat->GetGPUQueryBeginIndex());
-                            vkCmdDispatch(vk.cmdBuffer[vk.frameIndex], groupsX, groupsY, 1);
+                            vkCmdDispatch(GetCmdBuffer(vk), groupsX, groupsY, 1);
                             GPU_TIMESTAMP_END(resources.gpuTextureStat->GetGPUQueryEndIndex());
 
                             // Wait for the ray trace to finish
                             VkImageSubresourceRange range = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
                             ImageBarrierDesc barrier = { VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 } };
-                            SetImageMemoryBarrier(vk.cmdBuffer[vk.frameIndex], vkResources.rt.GBufferA, barrier);
+                            SetImageMemoryBarrier(GetCmdBuffer(vk), vkResources.rt.GBufferA, barrier);
 
                         #ifdef GFX_PERF_MARKERS
-                            vkCmdEndDebugUtilsLabelEXT(vk.cmdBuffer[vk.frameIndex]);
+                            vkCmdEndDebugUtilsLabelEXT(GetCmdBuffer(vk));
                         #endif
                         }
                     }
@@ -1232,20 +1350,29 @@ namespace Graphics
                 /**
                  * Release resources.
                  */
-                void Cleanup(VkDevice device, Resources& resources)
+                void Cleanup(VkDevice device, rtxgi::vulkan::DDGIMemoryPool* memoryPool, Resources& resources)
                 {
                     // Geometry
-                    vkFreeMemory(device, resources.probeIBMemory, nullptr);
                     vkDestroyBuffer(device, resources.probeIB, nullptr);
-                    vkFreeMemory(device, resources.probeIBUploadMemory, nullptr);
+                    rtxgi::vulkan::FreeDDGIMemory(memoryPool, resources.probeIBMemory);
                     vkDestroyBuffer(device, resources.probeIBUpload, nullptr);
+                    rtxgi::vulkan::FreeDDGIMemory(memoryPool, resources.probeIBUploadMemory);
 
-                    vkFreeMemory(device, resources.probeVBMemory, nullptr);
                     vkDestroyBuffer(device, resources.probeVB, nullptr);
-                    vkFreeMemory(device, resources.probeVBUploadMemory, nullptr);
+                    rtxgi::vulkan::FreeDDGIMemory(memoryPool, resources.probeVBMemory);
                     vkDestroyBuffer(device, resources.probeVBUpload, nullptr);
+                    rtxgi::vulkan::FreeDDGIMemory(memoryPool, resources.probeVBUploadMemory);
 
+                    vkDestroyBuffer(device, resources.probeAABB, nullptr);
+                    vkFreeMemory(device, resources.probeAABBMemory, nullptr);
+
+                    for (VkAccelerationStructureKHR blasLod : resources.blasLods)
+                    {
+                        vkDestroyAccelerationStructureKHR(device, blasLod, nullptr);
+                    }
+                    resources.blasLods.clear();
                     resources.blas.Release(device);
+                    resources.proceduralBlas.Release(device);
                     resources.tlas.Release(device);
 
                     // Shader Table
@@ -1314,7 +1441,7 @@ namespace Graphics
 
         void Cleanup(Globals& vk, Resources& resources)
         {
-            Graphics::Vulkan::DDGI::Visualizations::Cleanup(vk.device, resources);
+            Graphics::Vulkan::DDGI::Visualizations::Cleanup(vk.device, vk.memoryPool, resources);
         }
 
     } // namespace Graphics::DDGIVis
@@ -9,6 +9,9 @@
 */
 
 #include "graphics/DDGI.h"
+#include "Caches.h"
+
+#include <algorithm>
 
 #ifdef GFX_PERF_MARKERS
 #include <pix.h>
@@ -21,6 +24,36 @@ using namespace rtxgi::d3d12;
 #error RTXGI SDK DDGI Managed Mode is not compatible with bindless resources!
 #endif
 
+// Variability readback slots are indexed by the frame index
+#if (RTXGI_DDGI_VARIABILITY_READBACK_BUFFERS < GFX_FRAMES_IN_FLIGHT)
+#error RTXGI_DDGI_VARIABILITY_READBACK_BUFFERS must be at least the number of frames in flight!
+#endif
+
+// Timestamps of the probe update stages. With async compute, the stages are recorded on the compute command list
+// and overlap the rest of the frame, so they are not timed.
+#define DDGI_STAGE_TIMESTAMP_BEGIN(x) if (!d3d.DDGIAsyncCompute) { GPU_TIMESTAMP_BEGIN(x->GetGPUQueryBeginIndex()) }
+#define DDGI_STAGE_TIMESTAMP_END(x) if (!d3d.DDGIAsyncCompute) { GPU_TIMESTAMP_END(x->GetGPUQueryEndIndex()) }
+
+// Pipeline statistics queries of the passes counted with GPU counters (see Globals::GPUCounters), recorded on the pass's command list
+#define DDGI_PIPELINE_STATS_BEGIN(cmdList, pass) if (resources.pipelineStatsHeap) { cmdList->BeginQuery(resources.pipelineStatsHeap, D3D12_QUERY_TYPE_PIPELINE_STATISTICS, Instrumentation::pass); }
+#define DDGI_PIPELINE_STATS_END(cmdList, pass) if (resources.pipelineStatsHeap) { cmdList->EndQuery(resources.pipelineStatsHeap, D3D12_QUERY_TYPE_PIPELINE_STATISTICS, Instrumentation::pass); }
+
+// Irradiance queries evaluated per frame, and the size of the query count that precedes them (see IrradianceQueryCS.hlsl)
+#define IRRADIANCE_QUERY_MAX_COUNT 16384
+#define IRRADIANCE_QUERY_HEADER_SIZE 16
+
+// Probe tiles of a probe delta packet, the size of the ProbeDeltaHeader that precedes them, and the
+// thread groups per row of a probe delta dispatch (see ProbeDeltaCS.hlsl)
+#define PROBE_DELTA_MAX_TILES 4096
+#define PROBE_DELTA_HEADER_SIZE 32
+#define PROBE_DELTA_GROUPS_X 256
+
+// Bytes of radiance cache metadata per slot: checksum, age, shaded frame, volatility, light visibility, probe rays (see SpatialHash.hlsl)
+#define RADIANCE_CACHE_METADATA_STRIDE 32
+
+// Bytes of radiance cache stats per cascade: occupancy, probe ray coverage, coverage histogram (see GPUCounters.hlsl)
+#define RADIANCE_CACHE_STATS_STRIDE 64
+
 namespace Graphics
 {
     namespace D3D12
@@ -110,6 +143,26 @@ namespace Graphics
                     #endif
                     }
 
+                    // Published copies of the probe irradiance, distance, and data textures (sampled through the volume's SRVs)
+                    if (volumeDesc.probeAtlasDoubleBuffered)
+                    {
+                        const EDDGIVolumeTextureType types[3] = { EDDGIVolumeTextureType::Irradiance, EDDGIVolumeTextureType::Distance, EDDGIVolumeTextureType::Data };
+                        const EDDGIVolumeTextureFormat formats[3] = { volumeDesc.probeIrradianceFormat, volumeDesc.probeDistanceFormat, volumeDesc.probeDataFormat };
+                        ID3D12Resource** textures[3] = { &volumeResources.unmanaged.probeIrradiancePublished, &volumeResources.unmanaged.probeDistancePublished, &volumeResources.unmanaged.probeDataPublished };
+                        for (UINT textureIndex = 0; textureIndex < 3; textureIndex++)
+                        {
+                            GetDDGIVolumeTextureDimensions(volumeDesc, types[textureIndex], width, height, arraySize);
+                            format = GetDDGIVolumeTextureFormat(types[textureIndex], formats[textureIndex]);
+
+                            TextureDesc desc = { width, height, arraySize, 1, format, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_FLAG_NONE };
+                            CHECK(CreateTexture(d3d, desc, textures[textureIndex]), "create DDGIVolume published probe texture array!", log);
+                        #ifdef GFX_NAME_OBJECTS
+                            std::wstring name = L"DDGIVolume[" + std::to_wstring(volumeDesc.index) + L"], Published Probe Texture " + std::to_wstring(textureIndex);
+                            (*textures[textureIndex])->SetName(name.c_str());
+                        #endif
+                        }
+                    }
+
                     // Probe variability texture
                     {
                         GetDDGIVolumeTextureDimensions(volumeDesc, EDDGIVolumeTextureType::Variability, width, height, arraySize);
@@ -136,7 +189,7 @@ namespace Graphics
                         std::wstring name = L"DDGIVolume[" + std::to_wstring(volumeDesc.index) + L"], Probe Variability Average";
                         volumeResources.unmanaged.probeVariabilityAverage->SetName(name.c_str());
                     #endif
-                        BufferDesc readbackDesc = { sizeof(float)*2, 0, EHeapType::READBACK, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_FLAG_NONE };
+                        BufferDesc readbackDesc = { RTXGI_DDGI_VARIABILITY_READBACK_SIZE, 0, EHeapType::READBACK, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_FLAG_NONE };
                         CHECK(CreateBuffer(d3d, readbackDesc, &volumeResources.unmanaged.probeVariabilityReadback), "create DDGIVolume Probe variability readback buffer!", log);
                     #ifdef GFX_NAME_OBJECTS
                         name = L"DDGIVolume[" + std::to_wstring(volumeDesc.index) + L"], Probe Variability Readback";
@@ -145,6 +198,39 @@ namespace Graphics
                     }
                 }
 
+                // Create the probe scheduling buffers (also used for the active probe list, the single pass reduction counter, the probe state bits, and the probe visibility masks)
+                if (volumeDesc.probeSchedulingEnabled || volumeDesc.probeBlendingActiveOnly || volumeDesc.probeVariabilityUseSinglePassReduction || volumeDesc.probeStateBitsEnabled || volumeDesc.probeVisibilityMaskEnabled)
+                {
+                    UINT numProbes = (UINT)(volumeDesc.probeCounts.x * volumeDesc.probeCounts.y * volumeDesc.probeCounts.z);
+
+                    BufferDesc desc = { RTXGI_DDGI_PROBE_SCHEDULE_SIZE(numProbes), 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+                    CHECK(CreateBuffer(d3d, desc, &volumeResources.unmanaged.probeSchedule), "create DDGIVolume probe schedule buffer!", log);
+                #ifdef GFX_NAME_OBJECTS
+                    std::wstring name = L"DDGIVolume[" + std::to_wstring(volumeDesc.index) + L"], Probe Schedule";
+                    volumeResources.unmanaged.probeSchedule->SetName(name.c_str());
+                #endif
+
+                    BufferDesc argsDesc = { RTXGI_DDGI_PROBE_SCHEDULE_COUNT_OFFSET, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT, D3D12_RESOURCE_FLAG_NONE };
+                    CHECK(CreateBuffer(d3d, argsDesc, &volumeResources.unmanaged.probeScheduleArgs), "create DDGIVolume probe schedule arguments buffer!", log);
+                #ifdef GFX_NAME_OBJECTS
+                    name = L"DDGIVolume[" + std::to_wstring(volumeDesc.index) + L"], Probe Schedule Arguments";
+                    volumeResources.unmanaged.probeScheduleArgs->SetName(name.c_str());
+                #endif
+
+                    D3D12_INDIRECT_ARGUMENT_DESC argumentDesc = {};
+                    argumentDesc.Type = D3D12_INDIRECT_ARGUMENT_TYPE_DISPATCH;
+
+                    D3D12_COMMAND_SIGNATURE_DESC signatureDesc = {};
+                    signatureDesc.ByteStride = sizeof(D3D12_DISPATCH_ARGUMENTS);
+                    signatureDesc.NumArgumentDescs = 1;
+                    signatureDesc.pArgumentDescs = &argumentDesc;
+                    D3DCHECK(d3d.device->CreateCommandSignature(&signatureDesc, nullptr, IID_PPV_ARGS(&volumeResources.unmanaged.probeScheduleCommandSignature)));
+                #ifdef GFX_NAME_OBJECTS
+                    name = L"DDGIVolume[" + std::to_wstring(volumeDesc.index) + L"], Probe Schedule Command Signature";
+                    volumeResources.unmanaged.probeScheduleCommandSignature->SetName(name.c_str());
+                #endif
+                }
+
                 // Create the resource descriptors
                 {
                     D3D12_CPU_DESCRIPTOR_HANDLE srvHandle, uavHandle;
@@ -192,7 +278,8 @@ namespace Graphics
 
                         srvDesc.Format = uavDesc.Format = rtvDesc.Format = GetDDGIVolumeTextureFormat(EDDGIVolumeTextureType::Irradiance, volumeDesc.probeIrradianceFormat);
                         d3d.device->CreateUnorderedAccessView(volumeResources.unmanaged.probeIrradiance, nullptr, &uavDesc, uavHandle);
-                        d3d.device->CreateShaderResourceView(volumeResources.unmanaged.probeIrradiance, &srvDesc, srvHandle);
+                        ID3D12Resource* published = volumeResources.unmanaged.probeIrradiancePublished;
+                        d3d.device->CreateShaderResourceView(published ? published : volumeResources.unmanaged.probeIrradiance, &srvDesc, srvHandle);
                         d3d.device->CreateRenderTargetView(volumeResources.unmanaged.probeIrradiance, &rtvDesc, volumeResources.unmanaged.probeIrradianceRTV);
                     }
 
@@ -204,7 +291,8 @@ namespace Graphics
 
                         srvDesc.Format = uavDesc.Format = rtvDesc.Format = GetDDGIVolumeTextureFormat(EDDGIVolumeTextureType::Distance, volumeDesc.probeDistanceFormat);
                         d3d.device->CreateUnorderedAccessView(volumeResources.unmanaged.probeDistance, nullptr, &uavDesc, uavHandle);
-                        d3d.device->CreateShaderResourceView(volumeResources.unmanaged.probeDistance, &srvDesc, srvHandle);
+                        ID3D12Resource* published = volumeResources.unmanaged.probeDistancePublished;
+                        d3d.device->CreateShaderResourceView(published ? published : volumeResources.unmanaged.probeDistance, &srvDesc, srvHandle);
                         d3d.device->CreateRenderTargetView(volumeResources.unmanaged.probeDistance, &rtvDesc, volumeResources.unmanaged.probeDistanceRTV);
                     }
 
@@ -215,7 +303,8 @@ namespace Graphics
 
                         srvDesc.Format = uavDesc.Format = GetDDGIVolumeTextureFormat(EDDGIVolumeTextureType::Data, volumeDesc.probeDataFormat);
                         d3d.device->CreateUnorderedAccessView(volumeResources.unmanaged.probeData, nullptr, &uavDesc, uavHandle);
-                        d3d.device->CreateShaderResourceView(volumeResources.unmanaged.probeData, &srvDesc, srvHandle);
+                        ID3D12Resource* published = volumeResources.unmanaged.probeDataPublished;
+                        d3d.device->CreateShaderResourceView(published ? published : volumeResources.unmanaged.probeData, &srvDesc, srvHandle);
                     }
 
                     // Probe variability texture descriptors
@@ -238,6 +327,19 @@ namespace Graphics
                         d3d.device->CreateUnorderedAccessView(volumeResources.unmanaged.probeVariabilityAverage, nullptr, &uavDesc, uavHandle);
                         d3d.device->CreateShaderResourceView(volumeResources.unmanaged.probeVariabilityAverage, &srvDesc, srvHandle);
                     }
+
+                    // Probe schedule buffer descriptor
+                    if (volumeResources.unmanaged.probeSchedule)
+                    {
+                        uavHandle.ptr = heapStart.ptr + (heapDesc.resourceIndices.probeScheduleUAVIndex * heapDesc.entrySize);
+
+                        D3D12_UNORDERED_ACCESS_VIEW_DESC bufferUAVDesc = {};
+                        bufferUAVDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+                        bufferUAVDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+                        bufferUAVDesc.Buffer.NumElements = (UINT)(volumeResources.unmanaged.probeSchedule->GetDesc().Width / sizeof(UINT));
+                        bufferUAVDesc.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_RAW;
+                        d3d.device->CreateUnorderedAccessView(volumeResources.unmanaged.probeSchedule, nullptr, &bufferUAVDesc, uavHandle);
+                    }
                 }
 
                 // Set or create the root signature
@@ -251,6 +353,7 @@ namespace Graphics
                 if (!GetDDGIVolumeRootSignatureDesc(volumeResources.descriptorHeap, signature)) return false;
 
                 D3DCHECK(d3d.device->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&volumeResources.unmanaged.rootSignature)));
+                SetRootSignatureHash(volumeResources.unmanaged.rootSignature, signature->GetBufferPointer(), signature->GetBufferSize());
                 SAFE_RELEASE(signature);
                 #ifdef GFX_NAME_OBJECTS
                     std::wstring name = L"DDGIVolume[" + std::to_wstring(volumeDesc.index) + L"], Root Signature ";
@@ -261,16 +364,11 @@ namespace Graphics
 
                 // Create the pipeline state objects
                 {
-                    D3D12_COMPUTE_PIPELINE_STATE_DESC desc = {};
-                    desc.pRootSignature = volumeResources.unmanaged.rootSignature;
-
                     UINT shaderIndex = 0;
 
                     // Probe Irradiance Blending PSO
                     {
-                        desc.CS.BytecodeLength = shaders[shaderIndex].bytecode->GetBufferSize();
-                        desc.CS.pShaderBytecode = shaders[shaderIndex].bytecode->GetBufferPointer();
-                        D3DCHECK(d3d.device->CreateComputePipelineState(&desc, IID_PPV_ARGS(&volumeResources.unmanaged.probeBlendingIrradiancePSO)));
+                        if (!CreateComputePSO(d3d, volumeResources.unmanaged.rootSignature, shaders[shaderIndex], &volumeResources.unmanaged.probeBlendingIrradiancePSO)) return false;
                     #ifdef GFX_NAME_OBJECTS
                         std::wstring name = L"DDGIVolume[" + std::to_wstring(volumeDesc.index) + L"], Probe Irradiance Blending PSO";
                         volumeResources.unmanaged.probeBlendingIrradiancePSO->SetName(name.c_str());
@@ -280,9 +378,7 @@ namespace Graphics
 
                     // Probe Distance Blending PSO
                     {
-                        desc.CS.BytecodeLength = shaders[shaderIndex].bytecode->GetBufferSize();
-                        desc.CS.pShaderBytecode = shaders[shaderIndex].bytecode->GetBufferPointer();
-                        D3DCHECK(d3d.device->CreateComputePipelineState(&desc, IID_PPV_ARGS(&volumeResources.unmanaged.probeBlendingDistancePSO)));
+                        if (!CreateComputePSO(d3d, volumeResources.unmanaged.rootSignature, shaders[shaderIndex], &volumeResources.unmanaged.probeBlendingDistancePSO)) return false;
                     #ifdef GFX_NAME_OBJECTS
                         std::wstring name = L"DDGIVolume[" + std::to_wstring(volumeDesc.index) + L"], Probe Distance Blending PSO";
                         volumeResources.unmanaged.probeBlendingDistancePSO->SetName(name.c_str());
@@ -292,9 +388,7 @@ namespace Graphics
 
                     // Probe Relocation PSO
                     {
-                        desc.CS.BytecodeLength = shaders[shaderIndex].bytecode->GetBufferSize();
-                        desc.CS.pShaderBytecode = shaders[shaderIndex].bytecode->GetBufferPointer();
-                        D3DCHECK(d3d.device->CreateComputePipelineState(&desc, IID_PPV_ARGS(&volumeResources.unmanaged.probeRelocation.updatePSO)));
+                        if (!CreateComputePSO(d3d, volumeResources.unmanaged.rootSignature, shaders[shaderIndex], &volumeResources.unmanaged.probeRelocation.updatePSO)) return false;
                     #ifdef GFX_NAME_OBJECTS
                         std::wstring name = L"DDGIVolume[" + std::to_wstring(volumeDesc.index) + L"], Probe Relocation PSO";
                         volumeResources.unmanaged.probeRelocation.updatePSO->SetName(name.c_str());
@@ -304,9 +398,7 @@ namespace Graphics
 
                     // Probe Relocation Reset PSO
                     {
-                        desc.CS.BytecodeLength = shaders[shaderIndex].bytecode->GetBufferSize();
-                        desc.CS.pShaderBytecode = shaders[shaderIndex].bytecode->GetBufferPointer();
-                        D3DCHECK(d3d.device->CreateComputePipelineState(&desc, IID_PPV_ARGS(&volumeResources.unmanaged.probeRelocation.resetPSO)));
+                        if (!CreateComputePSO(d3d, volumeResources.unmanaged.rootSignature, shaders[shaderIndex], &volumeResources.unmanaged.probeRelocation.resetPSO)) return false;
                     #ifdef GFX_NAME_OBJECTS
                         std::wstring name = L"DDGIVolume[" + std::to_wstring(volumeDesc.index) + L"], Probe Relocation Reset PSO";
                         volumeResources.unmanaged.probeRelocation.resetPSO->SetName(name.c_str());
@@ -316,9 +408,7 @@ namespace Graphics
 
                     // Probe Classification PSO
                     {
-                        desc.CS.BytecodeLength = shaders[shaderIndex].bytecode->GetBufferSize();
-                        desc.CS.pShaderBytecode = shaders[shaderIndex].bytecode->GetBufferPointer();
-                        D3DCHECK(d3d.device->CreateComputePipelineState(&desc, IID_PPV_ARGS(&volumeResources.unmanaged.probeClassification.updatePSO)));
+                        if (!CreateComputePSO(d3d, volumeResources.unmanaged.rootSignature, shaders[shaderIndex], &volumeResources.unmanaged.probeClassification.updatePSO)) return false;
                     #ifdef GFX_NAME_OBJECTS
                         std::wstring name = L"DDGIVolume[" + std::to_wstring(volumeDesc.index) + L"], Probe Classification PSO";
                         volumeResources.unmanaged.probeClassification.updatePSO->SetName(name.c_str());
@@ -328,9 +418,7 @@ namespace Graphics
 
                     // Probe Classification Reset PSO
                     {
-                        desc.CS.BytecodeLength = shaders[shaderIndex].bytecode->GetBufferSize();
-                        desc.CS.pShaderBytecode = shaders[shaderIndex].bytecode->GetBufferPointer();
-                        D3DCHECK(d3d.device->CreateComputePipelineState(&desc, IID_PPV_ARGS(&volumeResources.unmanaged.probeClassification.resetPSO)));
+                        if (!CreateComputePSO(d3d, volumeResources.unmanaged.rootSignature, shaders[shaderIndex], &volumeResources.unmanaged.probeClassification.resetPSO)) return false;
                     #ifdef GFX_NAME_OBJECTS
                         std::wstring name = L"DDGIVolume[" + std::to_wstring(volumeDesc.index) + L"], Probe Classification Reset PSO";
                         volumeResources.unmanaged.probeClassification.resetPSO->SetName(name.c_str());
@@ -340,9 +428,7 @@ namespace Graphics
 
                     // Probe Variability Reduction PSO
                     {
-                        desc.CS.BytecodeLength = shaders[shaderIndex].bytecode->GetBufferSize();
-                        desc.CS.pShaderBytecode = shaders[shaderIndex].bytecode->GetBufferPointer();
-                        D3DCHECK(d3d.device->CreateComputePipelineState(&desc, IID_PPV_ARGS(&volumeResources.unmanaged.probeVariabilityPSOs.reductionPSO)));
+                        if (!CreateComputePSO(d3d, volumeResources.unmanaged.rootSignature, shaders[shaderIndex], &volumeResources.unmanaged.probeVariabilityPSOs.reductionPSO)) return false;
                     #ifdef GFX_NAME_OBJECTS
                         std::wstring name = L"DDGIVolume[" + std::to_wstring(volumeDesc.index) + L"], Probe Variability Reduction PSO";
                         volumeResources.unmanaged.probeVariabilityPSOs.reductionPSO->SetName(name.c_str());
@@ -353,14 +439,42 @@ namespace Graphics
 
                     // Probe Variability Extra Reduction PSO
                     {
-                        desc.CS.BytecodeLength = shaders[shaderIndex].bytecode->GetBufferSize();
-                        desc.CS.pShaderBytecode = shaders[shaderIndex].bytecode->GetBufferPointer();
-                        D3DCHECK(d3d.device->CreateComputePipelineState(&desc, IID_PPV_ARGS(&volumeResources.unmanaged.probeVariabilityPSOs.extraReductionPSO)));
+                        if (!CreateComputePSO(d3d, volumeResources.unmanaged.rootSignature, shaders[shaderIndex], &volumeResources.unmanaged.probeVariabilityPSOs.extraReductionPSO)) return false;
                     #ifdef GFX_NAME_OBJECTS
                         std::wstring name = L"DDGIVolume[" + std::to_wstring(volumeDesc.index) + L"], Probe Variability Extra Reduction PSO";
                         volumeResources.unmanaged.probeVariabilityPSOs.extraReductionPSO->SetName(name.c_str());
+                    #endif
+                        shaderIndex++;
+                    }
+
+                    // Probe Scheduling PSOs
+                    if (volumeDesc.probeSchedulingEnabled || volumeDesc.probeBlendingActiveOnly)
+                    {
+                        if (!CreateComputePSO(d3d, volumeResources.unmanaged.rootSignature, shaders[shaderIndex], &volumeResources.unmanaged.probeScheduling.schedulePSO)) return false;
+                    #ifdef GFX_NAME_OBJECTS
+                        std::wstring name = L"DDGIVolume[" + std::to_wstring(volumeDesc.index) + L"], Probe Scheduling PSO";
+                        volumeResources.unmanaged.probeScheduling.schedulePSO->SetName(name.c_str());
+                    #endif
+                        shaderIndex++;
+
+                        if (!CreateComputePSO(d3d, volumeResources.unmanaged.rootSignature, shaders[shaderIndex], &volumeResources.unmanaged.probeScheduling.argsPSO)) return false;
+                    #ifdef GFX_NAME_OBJECTS
+                        name = L"DDGIVolume[" + std::to_wstring(volumeDesc.index) + L"], Probe Scheduling Arguments PSO";
+                        volumeResources.unmanaged.probeScheduling.argsPSO->SetName(name.c_str());
+                    #endif
+                    }
+
+                #if RTXGI_DDGI_BINDLESS_RESOURCES
+                    // Probe Derivation PSO, follows the scheduling shaders (see DDGI.cpp::CompileDDGIVolumeShaders())
+                    {
+                        shaderIndex = 10;
+                        if (!CreateComputePSO(d3d, volumeResources.unmanaged.rootSignature, shaders[shaderIndex], &volumeResources.unmanaged.probeScheduling.derivationPSO)) return false;
+                    #ifdef GFX_NAME_OBJECTS
+                        std::wstring name = L"DDGIVolume[" + std::to_wstring(volumeDesc.index) + L"], Probe Derivation PSO";
+                        volumeResources.unmanaged.probeScheduling.derivationPSO->SetName(name.c_str());
                     #endif
                     }
+                #endif
                 }
 
                 log << "done.";
@@ -388,6 +502,15 @@ namespace Graphics
                 if (volume->GetProbeVariability()) volume->GetProbeVariability()->Release();
                 if (volume->GetProbeVariabilityAverage()) volume->GetProbeVariabilityAverage()->Release();
                 if (volume->GetProbeVariabilityReadback()) volume->GetProbeVariabilityReadback()->Release();
+                if (volume->GetProbeAtlasDoubleBuffered())
+                {
+                    volume->GetProbeIrradianceSRV()->Release();
+                    volume->GetProbeDistanceSRV()->Release();
+                    volume->GetProbeDataSRV()->Release();
+                }
+                if (volume->GetProbeSchedule()) volume->GetProbeSchedule()->Release();
+                if (volume->GetProbeScheduleArgs()) volume->GetProbeScheduleArgs()->Release();
+                if (volume->GetProbeScheduleCommandSignature()) volume->GetProbeScheduleCommandSignature()->Release();
 
                 // Release PSOs
                 if (volume->GetProbeBlendingIrradiancePSO()) volume->GetProbeBlendingIrradiancePSO()->Release();
@@ -398,6 +521,9 @@ namespace Graphics
                 if (volume->GetProbeClassificationResetPSO()) volume->GetProbeClassificationResetPSO()->Release();
                 if (volume->GetProbeVariabilityReductionPSO()) volume->GetProbeVariabilityReductionPSO()->Release();
                 if (volume->GetProbeVariabilityExtraReductionPSO()) volume->GetProbeVariabilityExtraReductionPSO()->Release();
+                if (volume->GetProbeSchedulingPSO()) volume->GetProbeSchedulingPSO()->Release();
+                if (volume->GetProbeSchedulingArgsPSO()) volume->GetProbeSchedulingArgsPSO()->Release();
+                if (volume->GetProbeDerivationPSO()) volume->GetProbeDerivationPSO()->Release();
 
                 // Clear pointers
                 volume->Destroy();
@@ -420,6 +546,7 @@ namespace Graphics
 
                 volumeDesc.index = config.index;
                 volumeDesc.rngSeed = config.rngSeed;
+                volumeDesc.probeRayRotationType = config.probeRayRotationLowDiscrepancy ? EDDGIVolumeProbeRayRotationType::LowDiscrepancy : EDDGIVolumeProbeRayRotationType::Random;
                 volumeDesc.origin = { config.origin.x, config.origin.y, config.origin.z };
                 volumeDesc.eulerAngles = { config.eulerAngles.x, config.eulerAngles.y, config.eulerAngles.z, };
                 volumeDesc.probeSpacing = { config.probeSpacing.x, config.probeSpacing.y, config.probeSpacing.z };
@@ -448,7 +575,34 @@ namespace Graphics
                 volumeDesc.probeRelocationEnabled = config.probeRelocationEnabled;
                 volumeDesc.probeMinFrontfaceDistance = config.probeMinFrontfaceDistance;
                 volumeDesc.probeClassificationEnabled = config.probeClassificationEnabled;
+                volumeDesc.probeBlendingActiveOnly = config.probeBlendingActiveOnly;
+                volumeDesc.probeStateBitsEnabled = config.probeClassificationEnabled;
+                volumeDesc.probeVisibilityMaskEnabled = config.probeVisibilityMaskEnabled;
                 volumeDesc.probeVariabilityEnabled = config.probeVariabilityEnabled;
+                volumeDesc.probeVariabilityUseSinglePassReduction = config.probeVariabilityEnabled;
+                volumeDesc.probeSchedulingEnabled = config.probeSchedulingEnabled;
+                volumeDesc.probeAtlasDoubleBuffered = config.probeAtlasDoubleBuffered;
+                volumeDesc.probeSparseTexturesEnabled = config.probeSparseTexturesEnabled;
+                volumeDesc.probeSchedulingMaxIntervalLog2 = config.probeSchedulingMaxIntervalLog2;
+                volumeDesc.probeSchedulingFullRateDistance = config.probeSchedulingFullRateDistance;
+                volumeDesc.probeSchedulingVariabilityThreshold = config.probeSchedulingVariabilityThreshold;
+                volumeDesc.probeTimeSliceStrideLog2 = config.probeTimeSliceStrideLog2;
+                volumeDesc.probeEventUpdatesEnabled = config.probeEventUpdatesEnabled;
+                volumeDesc.probeEventHysteresis = config.probeEventHysteresis;
+                volumeDesc.probeEventRecoveryFrames = config.probeEventRecoveryFrames;
+                volumeDesc.probeEventIdleIntervalLog2 = config.probeEventIdleIntervalLog2;
+                volumeDesc.probeEventIdleVariabilityThreshold = config.probeEventIdleVariabilityThreshold;
+                volumeDesc.probeConvergenceVariabilityThreshold = config.probeVariabilityThreshold;
+                volumeDesc.probeConvergenceFrames = 16;  // Filters out early outliers
+                volumeDesc.probeConvergenceFreezeOnGPU = config.probeVariabilityFreezeOnGPU;
+                volumeDesc.probeAdaptiveRaysEnabled = config.probeAdaptiveRaysEnabled;
+                volumeDesc.probeAdaptiveRaysMin = config.probeAdaptiveRaysMin;
+                volumeDesc.probeAdaptiveRaysVariabilityThreshold = config.probeAdaptiveRaysVariabilityThreshold;
+
+                volumeDesc.probeAdaptiveHysteresisEnabled = config.probeAdaptiveHysteresisEnabled;
+                volumeDesc.probeAdaptiveHysteresisMin = config.probeAdaptiveHysteresisMin;
+                volumeDesc.probeAdaptiveHysteresisMax = config.probeAdaptiveHysteresisMax;
+                volumeDesc.probeAdaptiveHysteresisVariabilityThreshold = config.probeAdaptiveHysteresisVariabilityThreshold;
 
                 if (config.infiniteScrollingEnabled) volumeDesc.movementType = EDDGIVolumeMovementType::Scrolling;
                 else volumeDesc.movementType = EDDGIVolumeMovementType::Default;
@@ -470,9 +624,12 @@ namespace Graphics
             {
                 std::string msg;
 
-                // Load and compile the volume's shaders
-                msg = "failed to compile shaders for DDGIVolume[" + std::to_string(volumeDesc.index) + "] (\"" + volumeDesc.name + "\")!\n";
-                CHECK(Graphics::DDGI::CompileDDGIVolumeShaders(d3d, volumeDesc, volumeShaders, false, log), msg.c_str(), log);
+                // Load and compile the volume's shaders, unless a background reload already compiled them (see ReloadAsync())
+                if (volumeShaders.empty())
+                {
+                    msg = "failed to compile shaders for DDGIVolume[" + std::to_string(volumeDesc.index) + "] (\"" + volumeDesc.name + "\")!\n";
+                    CHECK(Graphics::DDGI::CompileDDGIVolumeShaders(d3d, volumeDesc, volumeShaders, false, log, &resources.volumeShaderPermutations), msg.c_str(), log);
+                }
 
                 // Set the descriptor heap pointer and entry size
                 DDGIVolumeDescriptorHeapDesc& descHeap = volumeResources.descriptorHeap;
@@ -497,6 +654,7 @@ namespace Graphics
                 descHeap.resourceIndices.probeVariabilitySRVIndex = DescriptorHeapOffsets::SRV_DDGI_VOLUME_TEX2DARRAY + (volumeDesc.index * rtxgi::GetDDGIVolumeNumTex2DArrayDescriptors()) + 4;
                 descHeap.resourceIndices.probeVariabilityAverageUAVIndex = DescriptorHeapOffsets::UAV_DDGI_VOLUME_TEX2DARRAY + (volumeDesc.index * rtxgi::GetDDGIVolumeNumTex2DArrayDescriptors()) + 5;
                 descHeap.resourceIndices.probeVariabilityAverageSRVIndex = DescriptorHeapOffsets::SRV_DDGI_VOLUME_TEX2DARRAY + (volumeDesc.index * rtxgi::GetDDGIVolumeNumTex2DArrayDescriptors()) + 5;
+                descHeap.resourceIndices.probeScheduleUAVIndex = DescriptorHeapOffsets::UAV_DDGI_PROBE_SCHEDULE + volumeDesc.index;
 
                 // Set the volume constants structured buffer pointers and size
                 volumeResources.constantsBuffer = resources.volumeConstantsSTB;
@@ -534,6 +692,7 @@ namespace Graphics
                 resourceIndices.probeVariabilitySRVIndex = (volumeDesc.index * rtxgi::GetDDGIVolumeNumTex2DArrayDescriptors()) + 4;
                 resourceIndices.probeVariabilityAverageUAVIndex = (volumeDesc.index * rtxgi::GetDDGIVolumeNumTex2DArrayDescriptors()) + 5;
                 resourceIndices.probeVariabilityAverageSRVIndex = (volumeDesc.index * rtxgi::GetDDGIVolumeNumTex2DArrayDescriptors()) + 5;
+                resourceIndices.probeScheduleUAVIndex = volumeDesc.index;
 
             #if RTXGI_DDGI_RESOURCE_MANAGEMENT
                 // Enable "Managed Mode", the RTXGI SDK creates graphics objects
@@ -542,6 +701,9 @@ namespace Graphics
                 // Pass the D3D device to use for resource creation
                 volumeResources.managed.device = d3d.device;
 
+                // Place the probe textures of all volumes in shared heaps
+                volumeResources.managed.pool = resources.volumePool;
+
                 // Pass compiled shader bytecode
                 assert(volumeShaders.size() >= 2);
                 volumeResources.managed.probeBlendingIrradianceCS = { volumeShaders[0].bytecode->GetBufferPointer(), volumeShaders[0].bytecode->GetBufferSize() };
@@ -555,9 +717,13 @@ namespace Graphics
                 volumeResources.managed.probeClassification.updateCS = { volumeShaders[4].bytecode->GetBufferPointer(), volumeShaders[4].bytecode->GetBufferSize() };
                 volumeResources.managed.probeClassification.resetCS = { volumeShaders[5].bytecode->GetBufferPointer(), volumeShaders[5].bytecode->GetBufferSize() };
 
-                assert(volumeShaders.size() == 8);
+                assert(volumeShaders.size() >= 8);
                 volumeResources.managed.probeVariability.reductionCS = { volumeShaders[6].bytecode->GetBufferPointer(), volumeShaders[6].bytecode->GetBufferSize() };
                 volumeResources.managed.probeVariability.extraReductionCS = { volumeShaders[7].bytecode->GetBufferPointer(), volumeShaders[7].bytecode->GetBufferSize() };
+
+                assert(volumeShaders.size() == 10);
+                volumeResources.managed.probeScheduling.scheduleCS = { volumeShaders[8].bytecode->GetBufferPointer(), volumeShaders[8].bytecode->GetBufferSize() };
+                volumeResources.managed.probeScheduling.argsCS = { volumeShaders[9].bytecode->GetBufferPointer(), volumeShaders[9].bytecode->GetBufferSize() };
             #else
                 // Enable "Unmanaged Mode", the application creates graphics objects
                 volumeResources.unmanaged.enabled = true;
@@ -585,13 +751,15 @@ namespace Graphics
 
             /**
              * Create a DDGIVolume.
+             * When precompiledShaders is set, the volume is created with (and takes ownership of) those shaders instead of compiling its own.
              */
             bool CreateDDGIVolume(
                 Globals& d3d,
                 GlobalResources& d3dResources,
                 Resources& resources,
                 const Configs::DDGIVolume& volumeConfig,
-                std::ofstream& log)
+                std::ofstream& log,
+                std::vector<Shaders::ShaderProgram>* precompiledShaders = nullptr)
             {
                 // Destroy the volume if one already exists at the given index
                 if (volumeConfig.index < static_cast<UINT>(resources.volumes.size()))
@@ -599,33 +767,49 @@ namespace Graphics
                     if (resources.volumes[volumeConfig.index])
                     {
                     #if RTXGI_DDGI_RESOURCE_MANAGEMENT
-                        resources.volumes[volumeConfig.index]->Destroy();
+                        // Keep the volume's textures and pipelines in the pool for a volume of the same size class
+                        DDGIVolume* previous = static_cast<DDGIVolume*>(resources.volumes[volumeConfig.index]);
+                        if (RecycleDDGIVolume(resources.volumePool, previous)) resources.volumes[volumeConfig.index] = nullptr;
+                        else resources.volumes[volumeConfig.index]->Destroy();
                     #else
                         DestroyDDGIVolumeResources(resources, volumeConfig.index);
                     #endif
                         SAFE_DELETE(resources.volumeDescs[volumeConfig.index].name);
                         SAFE_DELETE(resources.volumes[volumeConfig.index]);
-                        resources.numVolumeVariabilitySamples[volumeConfig.index] = 0;
+                        SAFE_RELEASE(resources.bakedIrradiance[volumeConfig.index]);
                     }
                 }
                 else
                 {
                     resources.volumeDescs.emplace_back();
                     resources.volumes.emplace_back();
-                    resources.numVolumeVariabilitySamples.emplace_back();
+                    resources.bakedIrradiance.emplace_back(nullptr);
                 }
 
                 // Describe the DDGIVolume's properties
                 DDGIVolumeDesc& volumeDesc = resources.volumeDescs[volumeConfig.index];
                 GetDDGIVolumeDesc(volumeConfig, volumeDesc);
 
+                // Relocate and classify probes with one wave per probe when a wave holds all of the fixed rays
+                volumeDesc.probeFixedRaysUseWaveOps = (d3d.features.waveLaneCount >= 32);
+
+            #if !RTXGI_DDGI_RESOURCE_MANAGEMENT
+                // The SDK allocates and maps the tiles of sparse probe textures, the application can't provide them
+                CHECK(!volumeDesc.probeSparseTexturesEnabled, "create the DDGIVolume, sparse probe textures require RTXGI_DDGI_RESOURCE_MANAGEMENT!\n", log);
+            #endif
+
                 // Describe the DDGIVolume's resources and shaders
                 DDGIVolumeResources volumeResources;
                 std::vector<Shaders::ShaderProgram> volumeShaders;
+                if (precompiledShaders) volumeShaders.swap(*precompiledShaders);
                 GetDDGIVolumeResources(d3d, d3dResources, resources, volumeDesc, volumeResources, volumeShaders, log);
 
-                // Create a new DDGIVolume
-                DDGIVolume* volume = new DDGIVolume();
+                // Create a new DDGIVolume (or reuse a recycled volume of the same size class)
+                DDGIVolume* volume = nullptr;
+            #if RTXGI_DDGI_RESOURCE_MANAGEMENT
+                volume = AcquireDDGIVolume(resources.volumePool, volumeDesc);
+            #endif
+                if (volume == nullptr) volume = new DDGIVolume();
                 ERTXGIStatus status = volume->Create(volumeDesc, volumeResources);
                 if (status != ERTXGIStatus::OK)
                 {
@@ -647,6 +831,27 @@ namespace Graphics
                 return true;
             }
 
+            /**
+             * Groups the DDGIVolumes into a DDGIClipmap, the volumes are the levels ordered from finest to coarsest.
+             */
+            bool CreateDDGIClipmap(Globals& d3d, Resources& resources, std::ofstream& log)
+            {
+                if (!d3d.DDGIClipmap) return true;
+
+                rtxgi::DDGIClipmapDesc clipmapDesc = {};
+                clipmapDesc.numLevels = static_cast<uint32_t>(resources.volumes.size());
+
+                ERTXGIStatus status = resources.clipmap.Create(clipmapDesc, resources.volumes.data());
+                if (status != ERTXGIStatus::OK)
+                {
+                    log << "\nError: failed to create the DDGIClipmap! The volumes must be scrolling, with equal probe counts, doubling probe spacing, and consecutive indices.";
+                    std::flush(log);
+                    return false;
+                }
+
+                return true;
+            }
+
             /**
              * Creates the RTV descriptor heap for all DDGIVolumes.
              */
@@ -676,8 +881,8 @@ namespace Graphics
                 resources.volumeResourceIndicesSTBSizeInBytes = sizeof(DDGIVolumeResourceIndices) * volumeCount;
                 if (resources.volumeResourceIndicesSTBSizeInBytes == 0) return true; // scenes with no DDGIVolumes are valid
 
-                // Create the DDGIVolume resource indices upload buffer resource (double buffered)
-                BufferDesc desc = { 2 * resources.volumeResourceIndicesSTBSizeInBytes, 0, EHeapType::UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE };
+                // Create the DDGIVolume resource indices upload buffer resource (a copy per frame in flight)
+                BufferDesc desc = { MAX_FRAMES_IN_FLIGHT * resources.volumeResourceIndicesSTBSizeInBytes, 0, EHeapType::UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE };
                 CHECK(CreateBuffer(d3d, desc, &resources.volumeResourceIndicesSTBUpload), "create DDGIVolume resource indices upload structured buffer!\n", log);
             #ifdef GFX_NAME_OBJECTS
                 resources.volumeResourceIndicesSTBUpload->SetName(L"DDGIVolume Resource Indices Upload Structured Buffer");
@@ -706,15 +911,15 @@ namespace Graphics
             }
 
             /**
-             * Creates the DDGIVolume constants structured buffer.
+             * Creates the DDGIVolume constants and bounds structured buffers.
              */
             bool CreateDDGIVolumeConstantsBuffer(Globals& d3d, GlobalResources& d3dResources, Resources& resources, UINT volumeCount, std::ofstream& log)
             {
                 resources.volumeConstantsSTBSizeInBytes = sizeof(DDGIVolumeDescGPUPacked) * volumeCount;
                 if (resources.volumeConstantsSTBSizeInBytes == 0) return true; // scenes with no DDGIVolumes are valid
 
-                // Create the DDGIVolume constants upload buffer resource (double buffered)
-                BufferDesc desc = { 2 * resources.volumeConstantsSTBSizeInBytes, 0, EHeapType::UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE };
+                // Create the DDGIVolume constants upload buffer resource (a copy per frame in flight)
+                BufferDesc desc = { MAX_FRAMES_IN_FLIGHT * resources.volumeConstantsSTBSizeInBytes, 0, EHeapType::UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE };
                 CHECK(CreateBuffer(d3d, desc, &resources.volumeConstantsSTBUpload), "create DDGIVolume constants upload structured buffer!\n", log);
             #ifdef GFX_NAME_OBJECTS
                 resources.volumeConstantsSTBUpload->SetName(L"DDGIVolume Constants Upload Structured Buffer");
@@ -741,20 +946,90 @@ namespace Graphics
                 d3d.device->CreateShaderResourceView(resources.volumeConstantsSTB, &srvDesc, handle);
             #endif
 
+                // Create the DDGIVolume bounds upload buffer resource (a copy per frame in flight), see UploadDDGIVolumeBounds()
+                resources.volumeBoundsSTBSizeInBytes = sizeof(DDGIVolumeBoundsGPU) * volumeCount;
+                desc = { MAX_FRAMES_IN_FLIGHT * resources.volumeBoundsSTBSizeInBytes, 0, EHeapType::UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE };
+                CHECK(CreateBuffer(d3d, desc, &resources.volumeBoundsSTBUpload), "create DDGIVolume bounds upload structured buffer!\n", log);
+            #ifdef GFX_NAME_OBJECTS
+                resources.volumeBoundsSTBUpload->SetName(L"DDGIVolume Bounds Upload Structured Buffer");
+            #endif
+
+                // Create the DDGIVolume bounds device buffer resource
+                desc = { resources.volumeBoundsSTBSizeInBytes, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_FLAG_NONE };
+                CHECK(CreateBuffer(d3d, desc, &resources.volumeBoundsSTB), "create DDGIVolume bounds structured buffer!\n", log);
+            #ifdef GFX_NAME_OBJECTS
+                resources.volumeBoundsSTB->SetName(L"DDGIVolume Bounds Structured Buffer");
+            #endif
+
+                // Add the bounds structured buffer SRV to the descriptor heap
+                D3D12_SHADER_RESOURCE_VIEW_DESC boundsSRVDesc = {};
+                boundsSRVDesc.Format = DXGI_FORMAT_UNKNOWN;
+                boundsSRVDesc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+                boundsSRVDesc.Buffer.NumElements = volumeCount;
+                boundsSRVDesc.Buffer.StructureByteStride = sizeof(DDGIVolumeBoundsGPU);
+                boundsSRVDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+
+                D3D12_CPU_DESCRIPTOR_HANDLE boundsHandle;
+                boundsHandle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::STB_DDGI_VOLUME_BOUNDS * d3dResources.srvDescHeapEntrySize);
+                d3d.device->CreateShaderResourceView(resources.volumeBoundsSTB, &boundsSRVDesc, boundsHandle);
+
                 return true;
             }
 
+            /**
+             * Write the volumes' DDGIVolumeBoundsGPU to this frame's part of the bounds upload buffer and copy them to the device buffer.
+             * Like the volume constants, each volume's bounds are at its index. The blend order (see SortDDGIVolumeBlendOrder()) is
+             * written to the bounds' blendOrder fields.
+             */
+            void UploadDDGIVolumeBounds(Globals& d3d, Resources& resources)
+            {
+                if (resources.volumeBoundsSTBSizeInBytes == 0) return;
+
+                UINT64 offset = static_cast<UINT64>(resources.volumeBoundsSTBSizeInBytes) * d3d.frameIndex;
+
+                UINT8* pData = nullptr;
+                D3D12_RANGE readRange = {};
+                if (FAILED(resources.volumeBoundsSTBUpload->Map(0, &readRange, reinterpret_cast<void**>(&pData)))) return;
+
+                DDGIVolumeBoundsGPU* bounds = reinterpret_cast<DDGIVolumeBoundsGPU*>(pData + offset);
+                for (rtxgi::DDGIVolumeBase* volume : resources.volumes)
+                {
+                    if (volume == nullptr) continue;
+                    bounds[volume->GetIndex()] = GetDDGIVolumeBoundsGPU(volume->GetDescGPU());
+                }
+
+                // The blend order rides along in the bounds, entry i names the volume blended i-th
+                for (UINT orderIndex = 0; orderIndex < static_cast<UINT>(resources.volumeBlendOrder.size()); orderIndex++)
+                {
+                    bounds[orderIndex].blendOrder = resources.volumeBlendOrder[orderIndex];
+                }
+
+                D3D12_RANGE writeRange = { static_cast<SIZE_T>(offset), static_cast<SIZE_T>(offset + resources.volumeBoundsSTBSizeInBytes) };
+                resources.volumeBoundsSTBUpload->Unmap(0, &writeRange);
+
+                GetCmdList(d3d)->CopyBufferRegion(resources.volumeBoundsSTB, 0, resources.volumeBoundsSTBUpload, offset, resources.volumeBoundsSTBSizeInBytes);
+            }
+
             bool CreateCachingBuffers(Globals& d3d, GlobalResources& d3dResources, Resources& resources, UINT cachingCount, const Configs::Config& config, std::ofstream& log)
             {
-                //Create hit caching buffer
-                BufferDesc desc = { sizeof(HitCachingPayload) * cachingCount, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
-                CHECK(CreateBuffer(d3d, desc, &resources.HitCachingResource), "create hit caching buffer!\n", log);
+                // The hit cache, accumulation, and hit map buffers are only used from the probe trace through the probe ray resolve
+                // (the hit map through the probe blending with Globals::DDGIFusedRayResolve, still before the RTAO pass).
+                // They are transient and alias the other passes' transient resources. On the compute queue, the probe update chain
+                // overlaps the graphics passes, so the buffers are in use for the whole frame.
+                ETransientPass lastPass = d3d.DDGIAsyncCompute ? ETransientPass::RTAO : ETransientPass::DDGI_PROBE_RAY_RESOLVE;
+
+                //Create hit caching buffer (written by the probe trace for every slot in the work list, see ProbeTraceCS.hlsl)
+                // The compact HitPackedData layout (HIT_CACHE_COMPACT) is 16 bytes, the C++ struct is the full layout
+                const UINT hitStride = d3d.RadianceCacheCompactHits ? (sizeof(uint32_t) * 4) : sizeof(HitPackedData);
+                BufferDesc desc = { hitStride * cachingCount, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+                CHECK(CreateTransientBuffer(d3d, desc, ETransientPass::DDGI_PROBE_TRACE, lastPass, &resources.HitCachingResource), "create hit caching buffer!\n", log);
             #ifdef GFX_NAME_OBJECTS
                 resources.HitCachingResource->SetName(L"Hit Caching Structured Buffer");
             #endif
 
-                // Create the DDGIVolume constants device buffer resource
-                desc = { sizeof(float3) * cachingCount, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+                // Create the resolved radiance buffer (float3, or one packed uint per entry, see RADIANCE_CACHE_RADIANCE_FORMAT)
+                const UINT radianceStride = (d3d.RadianceCacheRadianceFormat == 0) ? sizeof(float3) : sizeof(uint32_t);
+                desc = { radianceStride * cachingCount, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
                 CHECK(CreateBuffer(d3d, desc, &resources.RadianceCachingResource), "create radiance caching structured buffer!\n", log);
             #ifdef GFX_NAME_OBJECTS
                 resources.RadianceCachingResource->SetName(L"Radiance Caching Structured Buffer");
@@ -768,16 +1043,23 @@ namespace Graphics
 
                 // Create SHaRC-style atomic accumulation buffer (uint4: RGB scaled radiance + sample count)
                 desc = { sizeof(uint4) * cachingCount, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
-                CHECK(CreateBuffer(d3d, desc, &resources.RadianceCacheAccumulationResource), "create radiance cache accumulation buffer!\n", log);
+                CHECK(CreateTransientBuffer(d3d, desc, ETransientPass::DDGI_PROBE_TRACE, lastPass, &resources.RadianceCacheAccumulationResource), "create radiance cache accumulation buffer!\n", log);
 #ifdef GFX_NAME_OBJECTS
                 resources.RadianceCacheAccumulationResource->SetName(L"Radiance Cache Accumulation Buffer (SHaRC-style)");
 #endif
 
-                // Create SHaRC-style metadata buffer (uint2: Checksum + Age for collision detection)
-                desc = { sizeof(uint2) * cachingCount, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+                // Create SHaRC-style metadata buffer (2x uint4: Checksum, Age, Shaded Frame, Volatility, Light Visibility Bits, Refresh Frame, Update Frame, Unused)
+                desc = { RADIANCE_CACHE_METADATA_STRIDE * cachingCount, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
                 CHECK(CreateBuffer(d3d, desc, &resources.RadianceCacheMetadataResource), "create radiance cache metadata buffer!\n", log);
 #ifdef GFX_NAME_OBJECTS
-                resources.RadianceCacheMetadataResource->SetName(L"Radiance Cache Metadata Buffer (SHaRC-style: Checksum+Age)");
+                resources.RadianceCacheMetadataResource->SetName(L"Radiance Cache Metadata Buffer (SHaRC-style: Checksum+Age+Budget)");
+#endif
+
+                // Create the indirect sample reservoir buffer (uint4: direction, hit distance, weight, sample count, see RadianceCacheReservoir.hlsl)
+                desc = { sizeof(uint4) * cachingCount, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+                CHECK(CreateBuffer(d3d, desc, &resources.RadianceCacheReservoirResource), "create radiance cache reservoir buffer!\n", log);
+#ifdef GFX_NAME_OBJECTS
+                resources.RadianceCacheReservoirResource->SetName(L"Radiance Cache Reservoir Buffer");
 #endif
 
                 // Calculate total probe rays across all volumes for ProbeRayHitMap
@@ -792,25 +1074,79 @@ namespace Graphics
                 // Create ProbeRayHitMap buffer (maps ProbeRayIndex -> (HashID, HitDistance) for resolve pass)
                 // Format: uint2 where .x = HashID, .y = asuint(HitDistance)
                 desc = { sizeof(uint32_t) * 2 * resources.TotalProbeRays, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
-                CHECK(CreateBuffer(d3d, desc, &resources.ProbeRayHitMapResource), "create probe ray hit map buffer!\n", log);
+                CHECK(CreateTransientBuffer(d3d, desc, ETransientPass::DDGI_PROBE_TRACE, lastPass, &resources.ProbeRayHitMapResource), "create probe ray hit map buffer!\n", log);
 #ifdef GFX_NAME_OBJECTS
                 resources.ProbeRayHitMapResource->SetName(L"Probe Ray Hit Map Buffer");
 #endif
 
+                // Create the radiance cache work list (slots touched this frame, plus one thread group of padding)
+                desc = { sizeof(uint32_t) * (cachingCount + 64), 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+                CHECK(CreateBuffer(d3d, desc, &resources.RadianceCacheWorkListResource), "create radiance cache work list buffer!\n", log);
+#ifdef GFX_NAME_OBJECTS
+                resources.RadianceCacheWorkListResource->SetName(L"Radiance Cache Work List Buffer");
+#endif
+
+                // Create the radiance cache work list arguments (D3D12_DISPATCH_ARGUMENTS + append counter)
+                desc = { sizeof(uint32_t) * 4, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+                CHECK(CreateBuffer(d3d, desc, &resources.RadianceCacheWorkListArgsResource), "create radiance cache work list arguments buffer!\n", log);
+#ifdef GFX_NAME_OBJECTS
+                resources.RadianceCacheWorkListArgsResource->SetName(L"Radiance Cache Work List Arguments Buffer");
+#endif
+
+                // Create the sorted radiance cache work list (same size as the work list)
+                desc = { sizeof(uint32_t) * (cachingCount + 64), 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+                CHECK(CreateBuffer(d3d, desc, &resources.RadianceCacheSortedWorkListResource), "create radiance cache sorted work list buffer!\n", log);
+#ifdef GFX_NAME_OBJECTS
+                resources.RadianceCacheSortedWorkListResource->SetName(L"Radiance Cache Sorted Work List Buffer");
+#endif
+
+                // Create the radiance cache counting sort bins
+                desc = { sizeof(uint32_t) * d3d.RadianceCacheSortBinCount, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+                CHECK(CreateBuffer(d3d, desc, &resources.RadianceCacheSortBinsResource), "create radiance cache sort bins buffer!\n", log);
+#ifdef GFX_NAME_OBJECTS
+                resources.RadianceCacheSortBinsResource->SetName(L"Radiance Cache Sort Bins Buffer");
+#endif
+
+                // Create the radiance cache update budget (RADIANCE_CACHE_BUDGET_PRIORITY_BUCKETS counts + threshold + quota, see Types.h)
+                desc = { sizeof(uint32_t) * RADIANCE_CACHE_BUDGET_ELEMENTS, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+                CHECK(CreateBuffer(d3d, desc, &resources.RadianceCacheBudgetResource), "create radiance cache budget buffer!\n", log);
+#ifdef GFX_NAME_OBJECTS
+                resources.RadianceCacheBudgetResource->SetName(L"Radiance Cache Budget Buffer");
+#endif
+
+                // Create the light grid (header + per cell light count and list, see LightGrid.hlsl)
+                UINT lightGridSize = 32 + (d3d.LightGridDim * d3d.LightGridDim * d3d.LightGridDim * (1 + d3d.LightGridMaxLightsPerCell) * sizeof(uint32_t));
+                desc = { lightGridSize, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+                CHECK(CreateBuffer(d3d, desc, &resources.LightGridResource), "create light grid buffer!\n", log);
+#ifdef GFX_NAME_OBJECTS
+                resources.LightGridResource->SetName(L"Light Grid Buffer");
+#endif
+
+                // Create the batched probe trace volume table (header + one uint4 per volume, see ProbeTraceBatch.hlsl)
+                resources.ProbeTraceBatchSizeInBytes = sizeof(uint32_t) * 4 * (1 + static_cast<UINT>(config.ddgi.volumes.size()));
+                desc = { MAX_FRAMES_IN_FLIGHT * resources.ProbeTraceBatchSizeInBytes, 0, EHeapType::UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE };
+                CHECK(CreateBuffer(d3d, desc, &resources.ProbeTraceBatchUploadResource), "create probe trace batch upload buffer!\n", log);
+                desc = { resources.ProbeTraceBatchSizeInBytes, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+                CHECK(CreateBuffer(d3d, desc, &resources.ProbeTraceBatchResource), "create probe trace batch buffer!\n", log);
+#ifdef GFX_NAME_OBJECTS
+                resources.ProbeTraceBatchUploadResource->SetName(L"Probe Trace Batch Upload Buffer");
+                resources.ProbeTraceBatchResource->SetName(L"Probe Trace Batch Buffer");
+#endif
+
             #if !RTXGI_DDGI_RESOURCE_MANAGEMENT
                 // Add the constants structured buffer SRV to the descriptor heap
                 D3D12_UNORDERED_ACCESS_VIEW_DESC uavdesc = {};
                 uavdesc.Format = DXGI_FORMAT_UNKNOWN;
                 uavdesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
                 uavdesc.Buffer.NumElements = cachingCount;
-                uavdesc.Buffer.StructureByteStride = sizeof(HitCachingPayload);
+                uavdesc.Buffer.StructureByteStride = hitStride;
                 uavdesc.Buffer.FirstElement = 0;
 
                 D3D12_CPU_DESCRIPTOR_HANDLE handle;
                 handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_HIT_CACHING * d3dResources.srvDescHeapEntrySize);
                 d3d.device->CreateUnorderedAccessView(resources.HitCachingResource, nullptr, &uavdesc, handle);
 
-                uavdesc.Buffer.StructureByteStride = sizeof(float3);
+                uavdesc.Buffer.StructureByteStride = radianceStride;
                 handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_RADIANCE_CACHING * d3dResources.srvDescHeapEntrySize);
                 d3d.device->CreateUnorderedAccessView(resources.RadianceCachingResource, nullptr, &uavdesc, handle);
 
@@ -829,18 +1165,292 @@ namespace Graphics
                 handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_RADIANCE_CACHE_ACCUMULATION * d3dResources.srvDescHeapEntrySize);
                 d3d.device->CreateUnorderedAccessView(resources.RadianceCacheAccumulationResource, nullptr, &rawUavDesc, handle);
 
-                // UAV for SHaRC-style metadata buffer (RWByteAddressBuffer: checksum + age)
-                rawUavDesc.Buffer.NumElements = cachingCount * 2; // 2 uints per entry (checksum + age)
+                // UAV for SHaRC-style metadata buffer (RWByteAddressBuffer: checksum, age, shaded frame, volatility, light visibility)
+                rawUavDesc.Buffer.NumElements = cachingCount * (RADIANCE_CACHE_METADATA_STRIDE / 4);
                 handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_RADIANCE_CACHE_METADATA * d3dResources.srvDescHeapEntrySize);
                 d3d.device->CreateUnorderedAccessView(resources.RadianceCacheMetadataResource, nullptr, &rawUavDesc, handle);
 
+                // UAV for the indirect sample reservoir buffer (RWByteAddressBuffer: direction, hit distance, weight, sample count)
+                handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_RADIANCE_CACHE_RESERVOIRS * d3dResources.srvDescHeapEntrySize);
+                d3d.device->CreateUnorderedAccessView(resources.RadianceCacheReservoirResource, nullptr, &rawUavDesc, handle);
+
                 // UAV for ProbeRayHitMap buffer (RWStructuredBuffer<uint2>)
                 uavdesc.Buffer.NumElements = resources.TotalProbeRays;
                 uavdesc.Buffer.StructureByteStride = sizeof(uint32_t) * 2;  // uint2
                 handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_PROBE_RAY_HIT_MAP * d3dResources.srvDescHeapEntrySize);
                 d3d.device->CreateUnorderedAccessView(resources.ProbeRayHitMapResource, nullptr, &uavdesc, handle);
+
+                // UAV for the radiance cache work list (RWStructuredBuffer<uint>)
+                uavdesc.Buffer.NumElements = cachingCount + 64;
+                uavdesc.Buffer.StructureByteStride = sizeof(uint32_t);
+                handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_RADIANCE_CACHE_WORK_LIST * d3dResources.srvDescHeapEntrySize);
+                d3d.device->CreateUnorderedAccessView(resources.RadianceCacheWorkListResource, nullptr, &uavdesc, handle);
+
+                // UAV for the sorted radiance cache work list (RWStructuredBuffer<uint>)
+                handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_RADIANCE_CACHE_SORTED_WORK_LIST * d3dResources.srvDescHeapEntrySize);
+                d3d.device->CreateUnorderedAccessView(resources.RadianceCacheSortedWorkListResource, nullptr, &uavdesc, handle);
+
+                // UAV for the radiance cache sort bins (RWStructuredBuffer<uint>)
+                uavdesc.Buffer.NumElements = d3d.RadianceCacheSortBinCount;
+                handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_RADIANCE_CACHE_SORT_BINS * d3dResources.srvDescHeapEntrySize);
+                d3d.device->CreateUnorderedAccessView(resources.RadianceCacheSortBinsResource, nullptr, &uavdesc, handle);
+
+                // UAV for the radiance cache work list arguments (RWByteAddressBuffer)
+                rawUavDesc.Buffer.NumElements = 4;
+                handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_RADIANCE_CACHE_WORK_LIST_ARGS * d3dResources.srvDescHeapEntrySize);
+                d3d.device->CreateUnorderedAccessView(resources.RadianceCacheWorkListArgsResource, nullptr, &rawUavDesc, handle);
+
+                // UAV for the radiance cache update budget (RWByteAddressBuffer)
+                rawUavDesc.Buffer.NumElements = RADIANCE_CACHE_BUDGET_ELEMENTS;
+                handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_RADIANCE_CACHE_BUDGET * d3dResources.srvDescHeapEntrySize);
+                d3d.device->CreateUnorderedAccessView(resources.RadianceCacheBudgetResource, nullptr, &rawUavDesc, handle);
+
+                // UAV for the light grid (RWByteAddressBuffer)
+                rawUavDesc.Buffer.NumElements = lightGridSize / sizeof(uint32_t);
+                handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_LIGHT_GRID * d3dResources.srvDescHeapEntrySize);
+                d3d.device->CreateUnorderedAccessView(resources.LightGridResource, nullptr, &rawUavDesc, handle);
+
+                // UAV for the batched probe trace volume table (RWStructuredBuffer<uint4>)
+                uavdesc.Buffer.NumElements = 1 + static_cast<UINT>(config.ddgi.volumes.size());
+                uavdesc.Buffer.StructureByteStride = sizeof(uint32_t) * 4;  // uint4
+                handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_PROBE_TRACE_BATCH * d3dResources.srvDescHeapEntrySize);
+                d3d.device->CreateUnorderedAccessView(resources.ProbeTraceBatchResource, nullptr, &uavdesc, handle);
+            #endif
+
+                return true;
+            }
+
+            /**
+             * Create the GPU counters buffer (a uint per Instrumentation::ECounter, see GPUCounters.hlsl), the radiance cache
+             * stats buffer (RADIANCE_CACHE_STATS_STRIDE bytes per cascade), their readback buffers, and the pipeline statistics query heap of the counted passes.
+             */
+            bool CreateGPUCounters(Globals& d3d, GlobalResources& d3dResources, Resources& resources, std::ofstream& log)
+            {
+                resources.gpuCountersSize = static_cast<UINT>(Instrumentation::COUNTER_COUNT * sizeof(UINT));
+                resources.radianceCacheStatsSize = static_cast<UINT>(d3d.NumVolume * RADIANCE_CACHE_STATS_STRIDE);
+
+                // The pipeline statistics are resolved behind the counters, ResolveQueryData() needs an 8 byte aligned offset
+                resources.pipelineStatsOffset = ALIGN(8, resources.gpuCountersSize);
+                resources.radianceCacheStatsOffset = resources.pipelineStatsOffset + (Instrumentation::PASS_COUNT * sizeof(D3D12_QUERY_DATA_PIPELINE_STATISTICS));
+                UINT readbackSize = resources.radianceCacheStatsOffset + resources.radianceCacheStatsSize;
+
+                // Create the counters buffer
+                BufferDesc desc = { resources.gpuCountersSize, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+                CHECK(CreateBuffer(d3d, desc, &resources.gpuCounters), "create GPU counters buffer!\n", log);
+            #ifdef GFX_NAME_OBJECTS
+                resources.gpuCounters->SetName(L"GPU Counters");
+            #endif
+
+                // Create the radiance cache stats buffer
+                desc = { resources.radianceCacheStatsSize, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+                CHECK(CreateBuffer(d3d, desc, &resources.radianceCacheStats), "create radiance cache stats buffer!\n", log);
+            #ifdef GFX_NAME_OBJECTS
+                resources.radianceCacheStats->SetName(L"Radiance Cache Stats");
+            #endif
+
+                // Create the buffer of zeros that clears the counters and the cache stats
+                UINT clearSize = (std::max)(resources.gpuCountersSize, resources.radianceCacheStatsSize);
+                desc = { clearSize, 0, EHeapType::UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE };
+                CHECK(CreateBuffer(d3d, desc, &resources.gpuCountersClear), "create GPU counters clear buffer!\n", log);
+            #ifdef GFX_NAME_OBJECTS
+                resources.gpuCountersClear->SetName(L"GPU Counters Clear");
+            #endif
+
+                UINT8* pData = nullptr;
+                D3D12_RANGE readRange = {};
+                D3DCHECK(resources.gpuCountersClear->Map(0, &readRange, reinterpret_cast<void**>(&pData)));
+                memset(pData, 0, clearSize);
+                resources.gpuCountersClear->Unmap(0, nullptr);
+
+                // Create the readback buffers
+                desc = { readbackSize, 0, EHeapType::READBACK, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_FLAG_NONE };
+                for (UINT frameIndex = 0; frameIndex < MAX_FRAMES_IN_FLIGHT; frameIndex++)
+                {
+                    CHECK(CreateBuffer(d3d, desc, &resources.gpuCountersReadback[frameIndex]), "create GPU counters readback buffer!\n", log);
+                #ifdef GFX_NAME_OBJECTS
+                    resources.gpuCountersReadback[frameIndex]->SetName(L"GPU Counters Readback");
+                #endif
+                    resources.gpuCountersReadbackFrame[frameIndex] = 0;
+                }
+
+                // Create the pipeline statistics query heap
+                D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
+                queryHeapDesc.Count = Instrumentation::PASS_COUNT;
+                queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_PIPELINE_STATISTICS;
+                D3DCHECK(d3d.device->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&resources.pipelineStatsHeap)));
+
+                // Add the counters UAV (RWByteAddressBuffer) to the descriptor heap
+                D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+                uavDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+                uavDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+                uavDesc.Buffer.FirstElement = 0;
+                uavDesc.Buffer.NumElements = Instrumentation::COUNTER_COUNT;
+                uavDesc.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_RAW;
+
+                D3D12_CPU_DESCRIPTOR_HANDLE handle;
+                handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_GPU_COUNTERS * d3dResources.srvDescHeapEntrySize);
+                d3d.device->CreateUnorderedAccessView(resources.gpuCounters, nullptr, &uavDesc, handle);
+
+                // Add the radiance cache stats UAV (RWByteAddressBuffer) to the descriptor heap
+                uavDesc.Buffer.NumElements = resources.radianceCacheStatsSize / sizeof(UINT);
+                handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_RADIANCE_CACHE_STATS * d3dResources.srvDescHeapEntrySize);
+                d3d.device->CreateUnorderedAccessView(resources.radianceCacheStats, nullptr, &uavDesc, handle);
+
+                // Clear the counters and the cache stats before the first frame
+                D3D12_RESOURCE_BARRIER barriers[2] = {};
+                barriers[0].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+                barriers[0].Transition.pResource = resources.gpuCounters;
+                barriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                barriers[0].Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
+                barriers[0].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+                barriers[1] = barriers[0];
+                barriers[1].Transition.pResource = resources.radianceCacheStats;
+                GetCmdList(d3d)->ResourceBarrier(2, barriers);
+
+                GetCmdList(d3d)->CopyBufferRegion(resources.gpuCounters, 0, resources.gpuCountersClear, 0, resources.gpuCountersSize);
+                GetCmdList(d3d)->CopyBufferRegion(resources.radianceCacheStats, 0, resources.gpuCountersClear, 0, resources.radianceCacheStatsSize);
+
+                for (D3D12_RESOURCE_BARRIER& barrier : barriers)
+                {
+                    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+                    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                }
+                GetCmdList(d3d)->ResourceBarrier(2, barriers);
+
+                return true;
+            }
+
+            /**
+             * Create the irradiance queries buffer (the query count, then IRRADIANCE_QUERY_MAX_COUNT IrradianceQuery entries),
+             * and its upload and readback buffers (one per frame in flight).
+             */
+            bool CreateIrradianceQueries(Globals& d3d, GlobalResources& d3dResources, Resources& resources, std::ofstream& log)
+            {
+                UINT size = IRRADIANCE_QUERY_HEADER_SIZE + (IRRADIANCE_QUERY_MAX_COUNT * sizeof(IrradianceQuery));
+
+                // Create the queries buffer
+                BufferDesc desc = { size, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+                CHECK(CreateBuffer(d3d, desc, &resources.irradianceQueries), "create irradiance queries buffer!\n", log);
+            #ifdef GFX_NAME_OBJECTS
+                resources.irradianceQueries->SetName(L"Irradiance Queries");
+            #endif
+
+                // Create the upload and readback buffers
+                for (UINT frameIndex = 0; frameIndex < MAX_FRAMES_IN_FLIGHT; frameIndex++)
+                {
+                    desc = { size, 0, EHeapType::UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE };
+                    CHECK(CreateBuffer(d3d, desc, &resources.irradianceQueriesUpload[frameIndex]), "create irradiance queries upload buffer!\n", log);
+                #ifdef GFX_NAME_OBJECTS
+                    resources.irradianceQueriesUpload[frameIndex]->SetName(L"Irradiance Queries Upload");
+                #endif
+
+                    desc = { size, 0, EHeapType::READBACK, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_FLAG_NONE };
+                    CHECK(CreateBuffer(d3d, desc, &resources.irradianceQueriesReadback[frameIndex]), "create irradiance queries readback buffer!\n", log);
+                #ifdef GFX_NAME_OBJECTS
+                    resources.irradianceQueriesReadback[frameIndex]->SetName(L"Irradiance Queries Readback");
+                #endif
+                }
+
+                // Add the queries UAV (RWByteAddressBuffer) to the descriptor heap
+                D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+                uavDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+                uavDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+                uavDesc.Buffer.FirstElement = 0;
+                uavDesc.Buffer.NumElements = size / sizeof(UINT);
+                uavDesc.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_RAW;
+
+                D3D12_CPU_DESCRIPTOR_HANDLE handle;
+                handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_IRRADIANCE_QUERIES * d3dResources.srvDescHeapEntrySize);
+                d3d.device->CreateUnorderedAccessView(resources.irradianceQueries, nullptr, &uavDesc, handle);
+
+                // Queue and read back without allocating
+                resources.irradianceQueriesPending.reserve(IRRADIANCE_QUERY_MAX_COUNT);
+                resources.irradianceQueryResults.reserve(IRRADIANCE_QUERY_MAX_COUNT);
+
+                return true;
+            }
+
+            /**
+             * Get the size of a probe tile of a probe delta packet: the probe index, the probe data texel (half4),
+             * then the irradiance (half4) and distance (half2) texels, borders included (see ProbeDeltaCS.hlsl).
+             */
+            UINT GetProbeDeltaTileStride(const DDGIVolumeDesc& desc)
+            {
+                UINT numIrradianceTexels = static_cast<UINT>(desc.probeNumIrradianceInteriorTexels + 2);
+                UINT numDistanceTexels = static_cast<UINT>(desc.probeNumDistanceInteriorTexels + 2);
+                return 12 + (numIrradianceTexels * numIrradianceTexels * 8) + (numDistanceTexels * numDistanceTexels * 4);
+            }
+
+            /**
+             * Create the probe deltas buffer (the header, a packet of at most PROBE_DELTA_MAX_TILES tiles, then the tiles
+             * each volume last exported), and its upload and readback buffers (one per frame in flight, the header and packet).
+             * Note: call after the volumes are created, the tiles of a volume are laid out for its probe and texel counts.
+             */
+            bool CreateProbeDeltas(Globals& d3d, GlobalResources& d3dResources, Resources& resources, std::ofstream& log)
+            {
+                // The packet fits the tiles of any volume, the volumes' last exported tiles follow it
+                UINT64 packetSize = PROBE_DELTA_HEADER_SIZE;
+                UINT64 referenceSize = 0;
+                resources.probeDeltaVolumes.clear();
+                for (DDGIVolumeBase* volumeBase : resources.volumes)
+                {
+                    ProbeDeltaVolume deltaVolume;
+                    if (volumeBase != nullptr)
+                    {
+                        const DDGIVolumeDesc& desc = static_cast<DDGIVolume*>(volumeBase)->GetDesc();
+                        deltaVolume.probeCount = static_cast<UINT>(desc.probeCounts.x * desc.probeCounts.y * desc.probeCounts.z);
+                        deltaVolume.tileStride = GetProbeDeltaTileStride(desc);
+                        deltaVolume.referenceOffset = static_cast<UINT>(referenceSize);
+
+                        UINT64 tiles = std::min<UINT64>(deltaVolume.probeCount, PROBE_DELTA_MAX_TILES);
+                        packetSize = std::max<UINT64>(packetSize, PROBE_DELTA_HEADER_SIZE + (tiles * deltaVolume.tileStride));
+                        referenceSize += static_cast<UINT64>(deltaVolume.probeCount) * deltaVolume.tileStride;
+                    }
+                    resources.probeDeltaVolumes.push_back(deltaVolume);
+                }
+
+                UINT64 size = packetSize + referenceSize;
+                CHECK(size <= UINT_MAX, "create probe deltas buffer, the volumes' probe tiles exceed 4GB!\n", log);
+                for (ProbeDeltaVolume& deltaVolume : resources.probeDeltaVolumes) deltaVolume.referenceOffset += static_cast<UINT>(packetSize);
+                resources.probeDeltaPacketSize = static_cast<UINT>(packetSize);
+
+                // Create the probe deltas buffer, the last exported tiles start zeroed like the volumes' cleared probes
+                BufferDesc desc = { size, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+                CHECK(CreateBuffer(d3d, desc, &resources.probeDeltas), "create probe deltas buffer!\n", log);
+            #ifdef GFX_NAME_OBJECTS
+                resources.probeDeltas->SetName(L"Probe Deltas");
             #endif
 
+                // Create the upload and readback buffers
+                for (UINT frameIndex = 0; frameIndex < MAX_FRAMES_IN_FLIGHT; frameIndex++)
+                {
+                    desc = { packetSize, 0, EHeapType::UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE };
+                    CHECK(CreateBuffer(d3d, desc, &resources.probeDeltasUpload[frameIndex]), "create probe deltas upload buffer!\n", log);
+                #ifdef GFX_NAME_OBJECTS
+                    resources.probeDeltasUpload[frameIndex]->SetName(L"Probe Deltas Upload");
+                #endif
+
+                    desc = { packetSize, 0, EHeapType::READBACK, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_FLAG_NONE };
+                    CHECK(CreateBuffer(d3d, desc, &resources.probeDeltasReadback[frameIndex]), "create probe deltas readback buffer!\n", log);
+                #ifdef GFX_NAME_OBJECTS
+                    resources.probeDeltasReadback[frameIndex]->SetName(L"Probe Deltas Readback");
+                #endif
+                }
+
+                // Add the probe deltas UAV (RWByteAddressBuffer) to the descriptor heap
+                D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+                uavDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+                uavDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+                uavDesc.Buffer.FirstElement = 0;
+                uavDesc.Buffer.NumElements = static_cast<UINT>(size / sizeof(UINT));
+                uavDesc.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_RAW;
+
+                D3D12_CPU_DESCRIPTOR_HANDLE handle;
+                handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_PROBE_DELTAS * d3dResources.srvDescHeapEntrySize);
+                d3d.device->CreateUnorderedAccessView(resources.probeDeltas, nullptr, &uavDesc, handle);
+
+                resources.probeDeltaPacket.reserve(packetSize);
+
                 return true;
             }
 
@@ -848,12 +1458,23 @@ namespace Graphics
             // Private Functions
             //----------------------------------------------------------------------------------------------------------
 
+            /**
+             * Returns true when the indirect lighting gather dispatches over the GBuffer geometry tiles.
+             * Requires each tile to cover a whole number of (downscaled) indirect lighting texels.
+             */
+            bool GatherOverGBufferTiles(const Globals& d3d)
+            {
+                return d3d.GBufferTiles && (GBUFFER_TILE_SIZE % d3d.FinalGatherDownScale) == 0;
+            }
+
             bool CreateTextures(Globals& d3d, GlobalResources& d3dResources, Resources& resources, std::ofstream& log)
             {
                 SAFE_RELEASE(resources.output);
 
-                // Create the output (R16G16B16A16_FLOAT) texture resource
-                TextureDesc desc = { static_cast<uint32_t>(d3d.width), static_cast<uint32_t>(d3d.height), 1, 1, DXGI_FORMAT_R16G16B16A16_FLOAT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+                // Create the output (R16G16B16A16_FLOAT) texture resource, at the (reduced) indirect lighting resolution
+                UINT width = DivRoundUp(d3d.width, d3d.FinalGatherDownScale);
+                UINT height = DivRoundUp(d3d.height, d3d.FinalGatherDownScale);
+                TextureDesc desc = { width, height, 1, 1, DXGI_FORMAT_R16G16B16A16_FLOAT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
                 CHECK(CreateTexture(d3d, desc, &resources.output), "create DDGI output texture resource!\n", log);
             #ifdef GFX_NAME_OBJECTS
                 resources.output->SetName(L"DDGI Output");
@@ -871,14 +1492,40 @@ namespace Graphics
                 return true;
             }
 
-            bool LoadAndCompileShaders(Globals& d3d, Resources& resources, UINT numVolumes, std::ofstream& log)
+            bool LoadAndCompileShaders(Globals& d3d, Resources& resources, const std::vector<Configs::DDGIVolume>& volumes, std::ofstream& log)
             {
+                UINT numVolumes = static_cast<UINT>(volumes.size());
+
+                // The shaders that sample the volumes are specialized for the options the volumes share (see AddSpecializationDefines)
+                std::vector<DDGIVolumeDesc> volumeDescs;
+                if (d3d.DDGISpecializedSampling)
+                {
+                    volumeDescs.resize(volumes.size());
+                    for (size_t volumeIndex = 0; volumeIndex < volumes.size(); volumeIndex++) GetDDGIVolumeDesc(volumes[volumeIndex], volumeDescs[volumeIndex]);
+                }
+
                 // Release existing shaders
                 resources.rtShaders.Release();
                 resources.indirectCS.Release();
                 resources.probeTraceCS.Release();
                 resources.radianceCacheCS.Release();
+                resources.radianceCacheRTShaders.Release();
                 resources.probeRayResolveCS.Release();
+                resources.radianceCacheWorkListArgsCS.Release();
+                resources.radianceCacheSortHistogramCS.Release();
+                resources.radianceCacheSortPrefixSumCS.Release();
+                resources.radianceCacheSortScatterCS.Release();
+                resources.radianceCacheBudgetHistogramCS.Release();
+                resources.radianceCacheBudgetThresholdCS.Release();
+                resources.radianceCacheStatsCS.Release();
+                resources.lightGridBoundsCS.Release();
+                resources.lightGridBuildCS.Release();
+                resources.radianceCacheEvictCS.Release();
+                resources.radianceCacheRehashCS.Release();
+                resources.radianceCacheTrimCS.Release();
+                resources.irradianceQueryCS.Release();
+                resources.probeDeltaExportCS.Release();
+                resources.probeDeltaImportCS.Release();
 
                 std::wstring root = std::wstring(d3d.shaderCompiler.root.begin(), d3d.shaderCompiler.root.end());
 
@@ -892,10 +1539,14 @@ namespace Graphics
                     Shaders::AddDefine(resources.rtShaders.rgs, L"CONSTS_SPACE", L"space1");  // for DDGIRootConstants, see Direct3D12.cpp::CreateGlobalRootSignature(...)
                     Shaders::AddDefine(resources.rtShaders.rgs, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
                     Shaders::AddDefine(resources.rtShaders.rgs, L"RTXGI_COORDINATE_SYSTEM", std::to_wstring(RTXGI_COORDINATE_SYSTEM));
+                    Graphics::DDGI::AddSpecializationDefines(resources.rtShaders.rgs, volumeDescs);
 
                     Shaders::AddDefine(resources.rtShaders.rgs, L"RADIANCE_CACHE_CASCADE_COUNT", std::to_wstring(numVolumes));
                     Shaders::AddDefine(resources.rtShaders.rgs, L"RADIANCE_CACHE_CASCADE_CELL_RADIUS", std::to_wstring(d3d.CascadeCellRadius));
                     Shaders::AddDefine(resources.rtShaders.rgs, L"RADIANCE_CACHE_CASCADE_DISTANCE", std::to_wstring(d3d.CascadeDistance));
+                    Shaders::AddDefine(resources.rtShaders.rgs, L"RADIANCE_CACHE_CASCADE_MODE", std::to_wstring(d3d.RadianceCacheCascadeMode));
+                    Shaders::AddDefine(resources.rtShaders.rgs, L"RADIANCE_CACHE_HASH_FUNCTION", std::to_wstring(d3d.RadianceCacheHashFunction));
+                    Shaders::AddDefine(resources.rtShaders.rgs, L"RADIANCE_CACHE_BRICK_LAYOUT", std::to_wstring(d3d.RadianceCacheBrickLayout ? 1 : 0));
                     Shaders::AddDefine(resources.rtShaders.rgs, L"RADIANCE_CACHE_CELL_COUNT", std::to_wstring(d3d.CacheCount));
                     CHECK(Shaders::Compile(d3d.shaderCompiler, resources.rtShaders.rgs), "compile DDGI probe tracing ray generation shader!\n", log);
                 }
@@ -921,6 +1572,8 @@ namespace Graphics
                     group.chs.entryPoint = L"CHS_GI";
                     group.chs.exportName = L"DDGIProbeTraceCHS";
                     Shaders::AddDefine(group.chs, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                    Shaders::AddDefine(group.chs, L"GI_MATERIALS", std::to_wstring(d3d.GIMaterials ? 1 : 0));
+                    Shaders::AddDefine(group.chs, L"GI_VERTEX_ALBEDO", std::to_wstring(d3d.GIVertexAlbedo ? 1 : 0));
                     CHECK(Shaders::Compile(d3d.shaderCompiler, group.chs), "compile DDGI probe tracing closest hit shader!\n", log);
 
                     // Load and compile the AHS
@@ -944,18 +1597,78 @@ namespace Graphics
                     Shaders::AddDefine(resources.indirectCS, L"CONSTS_REGISTER", L"b0");   // for DDGIRootConstants, see Direct3D12.cpp::CreateGlobalRootSignature(...)
                     Shaders::AddDefine(resources.indirectCS, L"CONSTS_SPACE", L"space1");  // for DDGIRootConstants, see Direct3D12.cpp::CreateGlobalRootSignature(...)
                     Shaders::AddDefine(resources.indirectCS, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                    Shaders::AddDefine(resources.indirectCS, L"GBUFFER_VISIBILITY", std::to_wstring(d3d.GBufferVisibility ? 1 : 0));
                     Shaders::AddDefine(resources.indirectCS, L"RTXGI_COORDINATE_SYSTEM", std::to_wstring(RTXGI_COORDINATE_SYSTEM));
+                    Graphics::DDGI::AddSpecializationDefines(resources.indirectCS, volumeDescs);
                     Shaders::AddDefine(resources.indirectCS, L"RTXGI_DDGI_NUM_VOLUMES", std::to_wstring(numVolumes));
-                    Shaders::AddDefine(resources.indirectCS, L"THGP_DIM_X", L"8");
-                    Shaders::AddDefine(resources.indirectCS, L"THGP_DIM_Y", L"4");
+                    if (GatherOverGBufferTiles(d3d))
+                    {
+                        // One thread group per GBuffer tile, one thread per indirect lighting texel of the tile
+                        std::wstring tileDim = std::to_wstring(GBUFFER_TILE_SIZE / d3d.FinalGatherDownScale);
+                        Shaders::AddDefine(resources.indirectCS, L"GBUFFER_TILES", L"1");
+                        Shaders::AddDefine(resources.indirectCS, L"THGP_DIM_X", tileDim);
+                        Shaders::AddDefine(resources.indirectCS, L"THGP_DIM_Y", tileDim);
+                    }
+                    else
+                    {
+                        Shaders::AddDefine(resources.indirectCS, L"THGP_DIM_X", L"8");
+                        Shaders::AddDefine(resources.indirectCS, L"THGP_DIM_Y", L"4");
+                    }
+                    Shaders::AddDefine(resources.indirectCS, L"DDGI_CLIPMAP", std::to_wstring(d3d.DDGIClipmap ? 1 : 0));
+                    Shaders::AddDefine(resources.indirectCS, L"DDGI_BLEND_VOLUMES", std::to_wstring(d3d.DDGIBlendVolumes ? 1 : 0));
+                    Shaders::AddDefine(resources.indirectCS, L"RTXGI_DDGI_PROBE_STATE_BITS", L"1");
+                    Shaders::AddDefine(resources.indirectCS, L"RTXGI_DDGI_PROBE_VISIBILITY_MASK", L"1");
                     Shaders::AddDefine(resources.indirectCS, L"RADIANCE_CACHE_CASCADE_COUNT", std::to_wstring(numVolumes));
                     Shaders::AddDefine(resources.indirectCS, L"RADIANCE_CACHE_CASCADE_CELL_RADIUS", std::to_wstring(d3d.CascadeCellRadius));
                     Shaders::AddDefine(resources.indirectCS, L"RADIANCE_CACHE_CASCADE_DISTANCE", std::to_wstring(d3d.CascadeDistance));
+                    Shaders::AddDefine(resources.indirectCS, L"RADIANCE_CACHE_CASCADE_MODE", std::to_wstring(d3d.RadianceCacheCascadeMode));
+                    Shaders::AddDefine(resources.indirectCS, L"RADIANCE_CACHE_HASH_FUNCTION", std::to_wstring(d3d.RadianceCacheHashFunction));
+                    Shaders::AddDefine(resources.indirectCS, L"RADIANCE_CACHE_BRICK_LAYOUT", std::to_wstring(d3d.RadianceCacheBrickLayout ? 1 : 0));
                     Shaders::AddDefine(resources.indirectCS, L"RADIANCE_CACHE_CELL_COUNT", std::to_wstring(d3d.CacheCount));
+                    Shaders::AddDefine(resources.indirectCS, L"RADIANCE_CACHE_GATHER", std::to_wstring(d3d.RadianceCacheGather ? 1 : 0));
                     Shaders::AddDefine(resources.indirectCS, L"FINAL_GATHER_DOWNSCALE", std::to_wstring(d3d.FinalGatherDownScale));
                     CHECK(Shaders::Compile(d3d.shaderCompiler, resources.indirectCS), "compile indirect lighting compute shader!\n", log);
                 }
 
+                // Load and compile the irradiance queries compute shader
+                {
+                    std::wstring shaderPath = root + L"shaders/ddgi/IrradianceQueryCS.hlsl";
+                    resources.irradianceQueryCS.filepath = shaderPath.c_str();
+                    resources.irradianceQueryCS.entryPoint = L"CS";
+                    resources.irradianceQueryCS.targetProfile = L"cs_6_6";
+
+                    Shaders::AddDefine(resources.irradianceQueryCS, L"CONSTS_REGISTER", L"b0");   // for DDGIRootConstants, see Direct3D12.cpp::CreateGlobalRootSignature(...)
+                    Shaders::AddDefine(resources.irradianceQueryCS, L"CONSTS_SPACE", L"space1");  // for DDGIRootConstants, see Direct3D12.cpp::CreateGlobalRootSignature(...)
+                    Shaders::AddDefine(resources.irradianceQueryCS, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                    Shaders::AddDefine(resources.irradianceQueryCS, L"RTXGI_COORDINATE_SYSTEM", std::to_wstring(RTXGI_COORDINATE_SYSTEM));
+                    Graphics::DDGI::AddSpecializationDefines(resources.irradianceQueryCS, volumeDescs);
+                    Shaders::AddDefine(resources.irradianceQueryCS, L"RTXGI_DDGI_NUM_VOLUMES", std::to_wstring(numVolumes));
+                    Shaders::AddDefine(resources.irradianceQueryCS, L"RTXGI_DDGI_PROBE_STATE_BITS", L"1");
+                    Shaders::AddDefine(resources.irradianceQueryCS, L"RTXGI_DDGI_PROBE_VISIBILITY_MASK", L"1");
+                    CHECK(Shaders::Compile(d3d.shaderCompiler, resources.irradianceQueryCS), "compile irradiance queries compute shader!\n", log);
+                }
+
+                // Load and compile the probe delta export and import compute shaders
+                {
+                    std::wstring shaderPath = root + L"shaders/ddgi/ProbeDeltaCS.hlsl";
+                    Shaders::ShaderProgram* deltaShaders[] = { &resources.probeDeltaExportCS, &resources.probeDeltaImportCS };
+                    const wchar_t* deltaEntryPoints[] = { L"ExportCS", L"ImportCS" };
+                    for (UINT shaderIndex = 0; shaderIndex < _countof(deltaShaders); shaderIndex++)
+                    {
+                        Shaders::ShaderProgram& shader = *deltaShaders[shaderIndex];
+                        shader.filepath = shaderPath.c_str();
+                        shader.entryPoint = deltaEntryPoints[shaderIndex];
+                        shader.targetProfile = L"cs_6_6";
+
+                        Shaders::AddDefine(shader, L"CONSTS_REGISTER", L"b0");   // for DDGIRootConstants, see Direct3D12.cpp::CreateGlobalRootSignature(...)
+                        Shaders::AddDefine(shader, L"CONSTS_SPACE", L"space1");  // for DDGIRootConstants, see Direct3D12.cpp::CreateGlobalRootSignature(...)
+                        Shaders::AddDefine(shader, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                        Shaders::AddDefine(shader, L"RTXGI_COORDINATE_SYSTEM", std::to_wstring(RTXGI_COORDINATE_SYSTEM));
+                        Graphics::DDGI::AddSpecializationDefines(shader, volumeDescs);
+                        CHECK(Shaders::Compile(d3d.shaderCompiler, shader), "compile probe delta compute shader!\n", log);
+                    }
+                }
+
                 // Load and compile the probe trace compute shader (inline ray tracing)
                 {
                     std::wstring shaderPath = root + L"shaders/ddgi/ProbeTraceCS.hlsl";
@@ -967,34 +1680,110 @@ namespace Graphics
                     Shaders::AddDefine(resources.probeTraceCS, L"CONSTS_SPACE", L"space1");  // for DDGIRootConstants, see Direct3D12.cpp::CreateGlobalRootSignature(...)
                     Shaders::AddDefine(resources.probeTraceCS, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
                     Shaders::AddDefine(resources.probeTraceCS, L"RTXGI_COORDINATE_SYSTEM", std::to_wstring(RTXGI_COORDINATE_SYSTEM));
+                    Graphics::DDGI::AddSpecializationDefines(resources.probeTraceCS, volumeDescs);
                     Shaders::AddDefine(resources.probeTraceCS, L"RTXGI_DDGI_NUM_VOLUMES", std::to_wstring(numVolumes));
 
                     Shaders::AddDefine(resources.probeTraceCS, L"RADIANCE_CACHE_CASCADE_COUNT", std::to_wstring(numVolumes));
                     Shaders::AddDefine(resources.probeTraceCS, L"RADIANCE_CACHE_CASCADE_CELL_RADIUS", std::to_wstring(d3d.CascadeCellRadius));
                     Shaders::AddDefine(resources.probeTraceCS, L"RADIANCE_CACHE_CASCADE_DISTANCE", std::to_wstring(d3d.CascadeDistance));
+                    Shaders::AddDefine(resources.probeTraceCS, L"RADIANCE_CACHE_CASCADE_MODE", std::to_wstring(d3d.RadianceCacheCascadeMode));
+                    Shaders::AddDefine(resources.probeTraceCS, L"RADIANCE_CACHE_HASH_FUNCTION", std::to_wstring(d3d.RadianceCacheHashFunction));
+                    Shaders::AddDefine(resources.probeTraceCS, L"RADIANCE_CACHE_BRICK_LAYOUT", std::to_wstring(d3d.RadianceCacheBrickLayout ? 1 : 0));
                     Shaders::AddDefine(resources.probeTraceCS, L"RADIANCE_CACHE_CELL_COUNT", std::to_wstring(d3d.CacheCount));
+                    Shaders::AddDefine(resources.probeTraceCS, L"RADIANCE_CACHE_RADIANCE_FORMAT", std::to_wstring(d3d.RadianceCacheRadianceFormat));
+                    Shaders::AddDefine(resources.probeTraceCS, L"HIT_CACHE_COMPACT", std::to_wstring(d3d.RadianceCacheCompactHits ? 1 : 0));
+                    Shaders::AddDefine(resources.probeTraceCS, L"PROBE_TRACE_BATCHED", std::to_wstring(d3d.DDGIBatchProbeTrace ? 1 : 0));
+                    Shaders::AddDefine(resources.probeTraceCS, L"GPU_COUNTERS", std::to_wstring(d3d.GPUCounters ? 1 : 0));
                     CHECK(Shaders::Compile(d3d.shaderCompiler, resources.probeTraceCS), "compile probe trace compute shader!\n", log);
                 }
 
-                // Load and compile the radiance cache compute shader (inline ray tracing)
+                // Load and compile the radiance cache shading shaders: compute (inline ray tracing) and ray generation (ray tracing pipeline) backends
                 {
-                    std::wstring shaderPath = root + L"shaders/ddgi/RadianceCacheCS.hlsl";
-                    resources.radianceCacheCS.filepath = shaderPath.c_str();
-                    resources.radianceCacheCS.entryPoint = L"CS";
+                    // Threads per cell of the WaveRaysCS variant, 0 for one thread per cell (see RadianceCacheCS.hlsl)
+                    UINT waveRays = 0;
+                    if (d3d.RadianceCacheWaveRays && !d3d.RadianceCacheReservoirSampling)
+                    {
+                        UINT sampleCount = static_cast<UINT>(d3d.RadianceCacheSampleCount);
+                        bool powerOfTwo = (sampleCount > 0) && ((sampleCount & (sampleCount - 1)) == 0);
+                        if (powerOfTwo && sampleCount <= 16 && static_cast<float>(sampleCount) == d3d.RadianceCacheSampleCount) waveRays = sampleCount;
+                    }
+
+                    resources.radianceCacheCS.filepath = root + L"shaders/ddgi/RadianceCacheCS.hlsl";
+                    resources.radianceCacheCS.entryPoint = (waveRays > 0) ? L"WaveRaysCS" : L"CS";
                     resources.radianceCacheCS.targetProfile = L"cs_6_6";
+                    Shaders::AddDefine(resources.radianceCacheCS, L"RADIANCE_CACHE_WAVE_RAYS", std::to_wstring(waveRays));
+
+                    resources.radianceCacheRTShaders.rgs.filepath = root + L"shaders/ddgi/RadianceCacheRGS.hlsl";
+                    resources.radianceCacheRTShaders.rgs.entryPoint = L"RayGen";
+                    resources.radianceCacheRTShaders.rgs.exportName = L"RadianceCacheRGS";
 
-                    Shaders::AddDefine(resources.radianceCacheCS, L"CONSTS_REGISTER", L"b0");
-                    Shaders::AddDefine(resources.radianceCacheCS, L"CONSTS_SPACE", L"space1");
-                    Shaders::AddDefine(resources.radianceCacheCS, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
-                    Shaders::AddDefine(resources.radianceCacheCS, L"RTXGI_COORDINATE_SYSTEM", std::to_wstring(RTXGI_COORDINATE_SYSTEM));
-                    Shaders::AddDefine(resources.radianceCacheCS, L"RTXGI_DDGI_NUM_VOLUMES", std::to_wstring(numVolumes));
+                    // Both backends shade with RadianceCommon.hlsl, so they take the same defines
+                    Shaders::ShaderProgram* shadingShaders[] = { &resources.radianceCacheCS, &resources.radianceCacheRTShaders.rgs };
+                    for (UINT shaderIndex = 0; shaderIndex < _countof(shadingShaders); shaderIndex++)
+                    {
+                        Shaders::ShaderProgram& shader = *shadingShaders[shaderIndex];
+                        Shaders::AddDefine(shader, L"CONSTS_REGISTER", L"b0");
+                        Shaders::AddDefine(shader, L"CONSTS_SPACE", L"space1");
+                        Shaders::AddDefine(shader, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                        Shaders::AddDefine(shader, L"RTXGI_COORDINATE_SYSTEM", std::to_wstring(RTXGI_COORDINATE_SYSTEM));
+                        Shaders::AddDefine(shader, L"RTXGI_DDGI_NUM_VOLUMES", std::to_wstring(numVolumes));
+                        Graphics::DDGI::AddSpecializationDefines(shader, volumeDescs);
+
+                        Shaders::AddDefine(shader, L"RADIANCE_CACHE_CASCADE_COUNT", std::to_wstring(numVolumes));
+                        Shaders::AddDefine(shader, L"RADIANCE_CACHE_CASCADE_CELL_RADIUS", std::to_wstring(d3d.CascadeCellRadius));
+                        Shaders::AddDefine(shader, L"RADIANCE_CACHE_CASCADE_DISTANCE", std::to_wstring(d3d.CascadeDistance));
+                        Shaders::AddDefine(shader, L"RADIANCE_CACHE_CASCADE_MODE", std::to_wstring(d3d.RadianceCacheCascadeMode));
+                        Shaders::AddDefine(shader, L"RADIANCE_CACHE_HASH_FUNCTION", std::to_wstring(d3d.RadianceCacheHashFunction));
+                        Shaders::AddDefine(shader, L"RADIANCE_CACHE_BRICK_LAYOUT", std::to_wstring(d3d.RadianceCacheBrickLayout ? 1 : 0));
+                        Shaders::AddDefine(shader, L"RADIANCE_CACHE_CELL_COUNT", std::to_wstring(d3d.CacheCount));
+                        Shaders::AddDefine(shader, L"RADIANCE_CACHE_RADIANCE_FORMAT", std::to_wstring(d3d.RadianceCacheRadianceFormat));
+                        Shaders::AddDefine(shader, L"RADIANCE_CACHE_SAMPLE_COUNT", std::to_wstring(d3d.RadianceCacheSampleCount));
+                        Shaders::AddDefine(shader, L"RADIANCE_CACHE_INDIRECT_FROM_PROBES", std::to_wstring(d3d.RadianceCacheIndirectFromProbes ? 1 : 0));
+                        Shaders::AddDefine(shader, L"RADIANCE_CACHE_RESERVOIR", std::to_wstring(d3d.RadianceCacheReservoirSampling ? 1 : 0));
+                        Shaders::AddDefine(shader, L"LIGHT_GRID", std::to_wstring(d3d.RadianceCacheLightGrid ? 1 : 0));
+                        Shaders::AddDefine(shader, L"LIGHT_GRID_STOCHASTIC", std::to_wstring(d3d.RadianceCacheStochasticLights ? 1 : 0));
+                        Shaders::AddDefine(shader, L"EMISSIVE_LIGHTS", std::to_wstring(d3d.RadianceCacheEmissiveLights ? 1 : 0));
+                        Shaders::AddDefine(shader, L"LIGHT_VISIBILITY_CACHE", std::to_wstring(d3d.RadianceCacheLightVisibility ? 1 : 0));
+                        Shaders::AddDefine(shader, L"LIGHT_GRID_DIM", std::to_wstring(d3d.LightGridDim));
+                        Shaders::AddDefine(shader, L"LIGHT_GRID_MAX_LIGHTS_PER_CELL", std::to_wstring(d3d.LightGridMaxLightsPerCell));
+                        Shaders::AddDefine(shader, L"HIT_CACHE_COMPACT", std::to_wstring(d3d.RadianceCacheCompactHits ? 1 : 0));
+                        Shaders::AddDefine(shader, L"RADIANCE_CACHE_SORT_WORK_LIST", std::to_wstring(d3d.RadianceCacheSortHits ? 1 : 0));
+                        Shaders::AddDefine(shader, L"RADIANCE_CACHE_RAY_BUDGET", std::to_wstring(d3d.RadianceCacheRayBudget));
+                        Shaders::AddDefine(shader, L"GI_MATERIALS", std::to_wstring(d3d.GIMaterials ? 1 : 0));
+                        Shaders::AddDefine(shader, L"GI_VERTEX_ALBEDO", std::to_wstring(d3d.GIVertexAlbedo ? 1 : 0));
+                        Shaders::AddDefine(shader, L"GPU_COUNTERS", std::to_wstring(d3d.GPUCounters ? 1 : 0));
+                        Shaders::AddDefine(shader, L"TEXTURE_STREAMING", std::to_wstring((d3d.TextureStreaming && !d3d.DDGIAsyncCompute) ? 1 : 0)); // the feedback buffer is on the graphics queue
+                        CHECK(Shaders::Compile(d3d.shaderCompiler, shader), "compile radiance cache shading shader!\n", log);
+                    }
+                }
+
+                // Load and compile the miss shader and hit group of the radiance cache ray tracing pipeline
+                {
+                    resources.radianceCacheRTShaders.miss.filepath = root + L"shaders/Miss.hlsl";
+                    resources.radianceCacheRTShaders.miss.entryPoint = L"Miss";
+                    resources.radianceCacheRTShaders.miss.exportName = L"RadianceCacheMiss";
+                    Shaders::AddDefine(resources.radianceCacheRTShaders.miss, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                    CHECK(Shaders::Compile(d3d.shaderCompiler, resources.radianceCacheRTShaders.miss), "compile radiance cache miss shader!\n", log);
+
+                    resources.radianceCacheRTShaders.hitGroups.emplace_back();
+
+                    Shaders::ShaderRTHitGroup& group = resources.radianceCacheRTShaders.hitGroups[0];
+                    group.exportName = L"RadianceCacheHitGroup";
+
+                    // The secondary rays only need the hit distance (the radiance comes from the cache)
+                    group.chs.filepath = root + L"shaders/CHS.hlsl";
+                    group.chs.entryPoint = L"CHS_VISIBILITY";
+                    group.chs.exportName = L"RadianceCacheCHS";
+                    Shaders::AddDefine(group.chs, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                    CHECK(Shaders::Compile(d3d.shaderCompiler, group.chs), "compile radiance cache closest hit shader!\n", log);
+
+                    group.ahs.filepath = root + L"shaders/AHS.hlsl";
+                    group.ahs.entryPoint = L"AHS_GI";
+                    group.ahs.exportName = L"RadianceCacheAHS";
+                    Shaders::AddDefine(group.ahs, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                    CHECK(Shaders::Compile(d3d.shaderCompiler, group.ahs), "compile radiance cache any hit shader!\n", log);
 
-                    Shaders::AddDefine(resources.radianceCacheCS, L"RADIANCE_CACHE_CASCADE_COUNT", std::to_wstring(numVolumes));
-                    Shaders::AddDefine(resources.radianceCacheCS, L"RADIANCE_CACHE_CASCADE_CELL_RADIUS", std::to_wstring(d3d.CascadeCellRadius));
-                    Shaders::AddDefine(resources.radianceCacheCS, L"RADIANCE_CACHE_CASCADE_DISTANCE", std::to_wstring(d3d.CascadeDistance));
-                    Shaders::AddDefine(resources.radianceCacheCS, L"RADIANCE_CACHE_CELL_COUNT", std::to_wstring(d3d.CacheCount));
-                    Shaders::AddDefine(resources.radianceCacheCS, L"RADIANCE_CACHE_SAMPLE_COUNT", std::to_wstring(d3d.RadianceCacheSampleCount));
-                    CHECK(Shaders::Compile(d3d.shaderCompiler, resources.radianceCacheCS), "compile radiance cache compute shader!\n", log);
+                    resources.radianceCacheRTShaders.payloadSizeInBytes = sizeof(PackedPayload);
                 }
 
                 // Load and compile the probe ray resolve compute shader
@@ -1008,17 +1797,158 @@ namespace Graphics
                     Shaders::AddDefine(resources.probeRayResolveCS, L"CONSTS_SPACE", L"space1");
                     Shaders::AddDefine(resources.probeRayResolveCS, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
                     Shaders::AddDefine(resources.probeRayResolveCS, L"RTXGI_COORDINATE_SYSTEM", std::to_wstring(RTXGI_COORDINATE_SYSTEM));
+                    Graphics::DDGI::AddSpecializationDefines(resources.probeRayResolveCS, volumeDescs);
                     Shaders::AddDefine(resources.probeRayResolveCS, L"RTXGI_DDGI_NUM_VOLUMES", std::to_wstring(numVolumes));
 
                     Shaders::AddDefine(resources.probeRayResolveCS, L"RADIANCE_CACHE_CASCADE_COUNT", std::to_wstring(numVolumes));
                     Shaders::AddDefine(resources.probeRayResolveCS, L"RADIANCE_CACHE_CASCADE_CELL_RADIUS", std::to_wstring(d3d.CascadeCellRadius));
                     Shaders::AddDefine(resources.probeRayResolveCS, L"RADIANCE_CACHE_CASCADE_DISTANCE", std::to_wstring(d3d.CascadeDistance));
+                    Shaders::AddDefine(resources.probeRayResolveCS, L"RADIANCE_CACHE_CASCADE_MODE", std::to_wstring(d3d.RadianceCacheCascadeMode));
+                    Shaders::AddDefine(resources.probeRayResolveCS, L"RADIANCE_CACHE_HASH_FUNCTION", std::to_wstring(d3d.RadianceCacheHashFunction));
+                    Shaders::AddDefine(resources.probeRayResolveCS, L"RADIANCE_CACHE_BRICK_LAYOUT", std::to_wstring(d3d.RadianceCacheBrickLayout ? 1 : 0));
                     Shaders::AddDefine(resources.probeRayResolveCS, L"RADIANCE_CACHE_CELL_COUNT", std::to_wstring(d3d.CacheCount));
+                    Shaders::AddDefine(resources.probeRayResolveCS, L"RADIANCE_CACHE_RADIANCE_FORMAT", std::to_wstring(d3d.RadianceCacheRadianceFormat));
+                    Shaders::AddDefine(resources.probeRayResolveCS, L"PROBE_TRACE_BATCHED", std::to_wstring(d3d.DDGIBatchProbeTrace ? 1 : 0));
                     CHECK(Shaders::Compile(d3d.shaderCompiler, resources.probeRayResolveCS), "compile probe ray resolve compute shader!\n", log);
                 }
 
-                return true;
-            }
+                // Load and compile the radiance cache work list arguments compute shader
+                {
+                    std::wstring shaderPath = root + L"shaders/ddgi/RadianceCacheWorkListArgsCS.hlsl";
+                    resources.radianceCacheWorkListArgsCS.filepath = shaderPath.c_str();
+                    resources.radianceCacheWorkListArgsCS.entryPoint = L"CS";
+                    resources.radianceCacheWorkListArgsCS.targetProfile = L"cs_6_6";
+
+                    Shaders::AddDefine(resources.radianceCacheWorkListArgsCS, L"CONSTS_REGISTER", L"b0");
+                    Shaders::AddDefine(resources.radianceCacheWorkListArgsCS, L"CONSTS_SPACE", L"space1");
+                    Shaders::AddDefine(resources.radianceCacheWorkListArgsCS, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                    Shaders::AddDefine(resources.radianceCacheWorkListArgsCS, L"RTXGI_COORDINATE_SYSTEM", std::to_wstring(RTXGI_COORDINATE_SYSTEM));
+
+                    Shaders::AddDefine(resources.radianceCacheWorkListArgsCS, L"RADIANCE_CACHE_CASCADE_COUNT", std::to_wstring(numVolumes));
+                    Shaders::AddDefine(resources.radianceCacheWorkListArgsCS, L"RADIANCE_CACHE_CELL_COUNT", std::to_wstring(d3d.CacheCount));
+                    Shaders::AddDefine(resources.radianceCacheWorkListArgsCS, L"RADIANCE_CACHE_SORT_WORK_LIST", std::to_wstring(d3d.RadianceCacheSortHits ? 1 : 0));
+                    Shaders::AddDefine(resources.radianceCacheWorkListArgsCS, L"RADIANCE_CACHE_SORT_BIN_COUNT", std::to_wstring(d3d.RadianceCacheSortBinCount));
+                    Shaders::AddDefine(resources.radianceCacheWorkListArgsCS, L"RADIANCE_CACHE_RAY_BUDGET", std::to_wstring(d3d.RadianceCacheRayBudget));
+                    CHECK(Shaders::Compile(d3d.shaderCompiler, resources.radianceCacheWorkListArgsCS), "compile radiance cache work list arguments compute shader!\n", log);
+                }
+
+                // Load and compile the radiance cache work list sort compute shaders (histogram, prefix sum, scatter)
+                {
+                    std::wstring shaderPath = root + L"shaders/ddgi/RadianceCacheSortCS.hlsl";
+                    Shaders::ShaderProgram* sortShaders[] = { &resources.radianceCacheSortHistogramCS, &resources.radianceCacheSortPrefixSumCS, &resources.radianceCacheSortScatterCS };
+                    const wchar_t* sortEntryPoints[] = { L"HistogramCS", L"PrefixSumCS", L"ScatterCS" };
+                    for (UINT shaderIndex = 0; shaderIndex < _countof(sortShaders); shaderIndex++)
+                    {
+                        Shaders::ShaderProgram& shader = *sortShaders[shaderIndex];
+                        shader.filepath = shaderPath.c_str();
+                        shader.entryPoint = sortEntryPoints[shaderIndex];
+                        shader.targetProfile = L"cs_6_6";
+
+                        Shaders::AddDefine(shader, L"CONSTS_REGISTER", L"b0");
+                        Shaders::AddDefine(shader, L"CONSTS_SPACE", L"space1");
+                        Shaders::AddDefine(shader, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                        Shaders::AddDefine(shader, L"RTXGI_COORDINATE_SYSTEM", std::to_wstring(RTXGI_COORDINATE_SYSTEM));
+
+                        Shaders::AddDefine(shader, L"HIT_CACHE_COMPACT", std::to_wstring(d3d.RadianceCacheCompactHits ? 1 : 0));
+                        Shaders::AddDefine(shader, L"RADIANCE_CACHE_SORT_WORK_LIST", std::to_wstring(d3d.RadianceCacheSortHits ? 1 : 0));
+                        Shaders::AddDefine(shader, L"RADIANCE_CACHE_SORT_BIN_COUNT", std::to_wstring(d3d.RadianceCacheSortBinCount));
+                        CHECK(Shaders::Compile(d3d.shaderCompiler, shader), "compile radiance cache sort compute shader!\n", log);
+                    }
+                }
+
+                // Load and compile the radiance cache update budget compute shaders (priority histogram, threshold)
+                {
+                    std::wstring shaderPath = root + L"shaders/ddgi/RadianceCacheBudgetCS.hlsl";
+                    Shaders::ShaderProgram* budgetShaders[] = { &resources.radianceCacheBudgetHistogramCS, &resources.radianceCacheBudgetThresholdCS };
+                    const wchar_t* budgetEntryPoints[] = { L"PriorityHistogramCS", L"ThresholdCS" };
+                    for (UINT shaderIndex = 0; shaderIndex < _countof(budgetShaders); shaderIndex++)
+                    {
+                        Shaders::ShaderProgram& shader = *budgetShaders[shaderIndex];
+                        shader.filepath = shaderPath.c_str();
+                        shader.entryPoint = budgetEntryPoints[shaderIndex];
+                        shader.targetProfile = L"cs_6_6";
+
+                        Shaders::AddDefine(shader, L"CONSTS_REGISTER", L"b0");
+                        Shaders::AddDefine(shader, L"CONSTS_SPACE", L"space1");
+                        Shaders::AddDefine(shader, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                        Shaders::AddDefine(shader, L"RTXGI_COORDINATE_SYSTEM", std::to_wstring(RTXGI_COORDINATE_SYSTEM));
+
+                        // With reservoir sampling, a shaded slot traces a single secondary ray
+                        const float raysPerSlot = d3d.RadianceCacheReservoirSampling ? 1.f : d3d.RadianceCacheSampleCount;
+                        Shaders::AddDefine(shader, L"RADIANCE_CACHE_SAMPLE_COUNT", std::to_wstring(raysPerSlot));
+                        Shaders::AddDefine(shader, L"RADIANCE_CACHE_RAY_BUDGET", std::to_wstring(d3d.RadianceCacheRayBudget));
+                        CHECK(Shaders::Compile(d3d.shaderCompiler, shader), "compile radiance cache budget compute shader!\n", log);
+                    }
+                }
+
+                // Load and compile the radiance cache stats compute shader
+                {
+                    std::wstring shaderPath = root + L"shaders/ddgi/RadianceCacheStatsCS.hlsl";
+                    resources.radianceCacheStatsCS.filepath = shaderPath.c_str();
+                    resources.radianceCacheStatsCS.entryPoint = L"CS";
+                    resources.radianceCacheStatsCS.targetProfile = L"cs_6_6";
+
+                    Shaders::AddDefine(resources.radianceCacheStatsCS, L"CONSTS_REGISTER", L"b0");
+                    Shaders::AddDefine(resources.radianceCacheStatsCS, L"CONSTS_SPACE", L"space1");
+                    Shaders::AddDefine(resources.radianceCacheStatsCS, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                    Shaders::AddDefine(resources.radianceCacheStatsCS, L"RTXGI_COORDINATE_SYSTEM", std::to_wstring(RTXGI_COORDINATE_SYSTEM));
+
+                    Shaders::AddDefine(resources.radianceCacheStatsCS, L"RADIANCE_CACHE_CASCADE_COUNT", std::to_wstring(numVolumes));
+                    Shaders::AddDefine(resources.radianceCacheStatsCS, L"RADIANCE_CACHE_CELL_COUNT", std::to_wstring(d3d.CacheCount));
+                    Shaders::AddDefine(resources.radianceCacheStatsCS, L"GPU_COUNTERS", std::to_wstring(d3d.GPUCounters ? 1 : 0));
+                    CHECK(Shaders::Compile(d3d.shaderCompiler, resources.radianceCacheStatsCS), "compile radiance cache stats compute shader!\n", log);
+                }
+
+                // Load and compile the radiance cache compaction compute shaders (evict, rehash, trim)
+                {
+                    std::wstring shaderPath = root + L"shaders/ddgi/RadianceCacheCompactCS.hlsl";
+                    Shaders::ShaderProgram* compactShaders[] = { &resources.radianceCacheEvictCS, &resources.radianceCacheRehashCS, &resources.radianceCacheTrimCS };
+                    const wchar_t* compactEntryPoints[] = { L"EvictCS", L"RehashCS", L"TrimCS" };
+                    for (UINT shaderIndex = 0; shaderIndex < _countof(compactShaders); shaderIndex++)
+                    {
+                        Shaders::ShaderProgram& shader = *compactShaders[shaderIndex];
+                        shader.filepath = shaderPath.c_str();
+                        shader.entryPoint = compactEntryPoints[shaderIndex];
+                        shader.targetProfile = L"cs_6_6";
+
+                        Shaders::AddDefine(shader, L"CONSTS_REGISTER", L"b0");
+                        Shaders::AddDefine(shader, L"CONSTS_SPACE", L"space1");
+                        Shaders::AddDefine(shader, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                        Shaders::AddDefine(shader, L"RTXGI_COORDINATE_SYSTEM", std::to_wstring(RTXGI_COORDINATE_SYSTEM));
+
+                        Shaders::AddDefine(shader, L"RADIANCE_CACHE_CASCADE_COUNT", std::to_wstring(numVolumes));
+                        Shaders::AddDefine(shader, L"RADIANCE_CACHE_CELL_COUNT", std::to_wstring(d3d.CacheCount));
+                        Shaders::AddDefine(shader, L"RADIANCE_CACHE_RADIANCE_FORMAT", std::to_wstring(d3d.RadianceCacheRadianceFormat));
+                        Shaders::AddDefine(shader, L"HIT_CACHE_COMPACT", std::to_wstring(d3d.RadianceCacheCompactHits ? 1 : 0));
+                        CHECK(Shaders::Compile(d3d.shaderCompiler, shader), "compile radiance cache compaction compute shader!\n", log);
+                    }
+                }
+
+                // Load and compile the light grid compute shaders (bounds, build)
+                {
+                    std::wstring shaderPath = root + L"shaders/ddgi/LightGridCS.hlsl";
+                    Shaders::ShaderProgram* lightGridShaders[] = { &resources.lightGridBoundsCS, &resources.lightGridBuildCS };
+                    const wchar_t* lightGridEntryPoints[] = { L"BoundsCS", L"BuildCS" };
+                    for (UINT shaderIndex = 0; shaderIndex < _countof(lightGridShaders); shaderIndex++)
+                    {
+                        Shaders::ShaderProgram& shader = *lightGridShaders[shaderIndex];
+                        shader.filepath = shaderPath.c_str();
+                        shader.entryPoint = lightGridEntryPoints[shaderIndex];
+                        shader.targetProfile = L"cs_6_6";
+
+                        Shaders::AddDefine(shader, L"CONSTS_REGISTER", L"b0");
+                        Shaders::AddDefine(shader, L"CONSTS_SPACE", L"space1");
+                        Shaders::AddDefine(shader, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                        Shaders::AddDefine(shader, L"RTXGI_COORDINATE_SYSTEM", std::to_wstring(RTXGI_COORDINATE_SYSTEM));
+
+                        Shaders::AddDefine(shader, L"LIGHT_GRID_DIM", std::to_wstring(d3d.LightGridDim));
+                        Shaders::AddDefine(shader, L"LIGHT_GRID_MAX_LIGHTS_PER_CELL", std::to_wstring(d3d.LightGridMaxLightsPerCell));
+                        CHECK(Shaders::Compile(d3d.shaderCompiler, shader), "compile light grid compute shader!\n", log);
+                    }
+                }
+
+                return true;
+            }
 
             bool CreatePSOs(Globals& d3d, GlobalResources& d3dResources, Resources& resources, std::ofstream& log)
             {
@@ -1027,10 +1957,13 @@ namespace Graphics
                 SAFE_RELEASE(resources.rtpsoInfo);
                 SAFE_RELEASE(resources.indirectPSO);
                 SAFE_RELEASE(resources.probeTracePSO);
+                SAFE_RELEASE(resources.irradianceQueryPSO);
+                SAFE_RELEASE(resources.probeDeltaExportPSO);
+                SAFE_RELEASE(resources.probeDeltaImportPSO);
 
                 // Create the RTPSO
                 CHECK(CreateRayTracingPSO(
-                    d3d.device,
+                    d3d,
                     d3dResources.rootSignature,
                     resources.rtShaders,
                     &resources.rtpso,
@@ -1042,7 +1975,7 @@ namespace Graphics
             #endif
 
                 CHECK(CreateComputePSO(
-                    d3d.device,
+                    d3d,
                     d3dResources.rootSignature,
                     resources.indirectCS,
                     &resources.indirectPSO),
@@ -1052,7 +1985,37 @@ namespace Graphics
             #endif
 
                 CHECK(CreateComputePSO(
-                    d3d.device,
+                    d3d,
+                    d3dResources.rootSignature,
+                    resources.irradianceQueryCS,
+                    &resources.irradianceQueryPSO),
+                    "create irradiance queries PSO!\n", log);
+            #ifdef GFX_NAME_OBJECTS
+                resources.irradianceQueryPSO->SetName(L"Irradiance Queries PSO");
+            #endif
+
+                CHECK(CreateComputePSO(
+                    d3d,
+                    d3dResources.rootSignature,
+                    resources.probeDeltaExportCS,
+                    &resources.probeDeltaExportPSO),
+                    "create probe delta export PSO!\n", log);
+            #ifdef GFX_NAME_OBJECTS
+                resources.probeDeltaExportPSO->SetName(L"Probe Delta Export PSO");
+            #endif
+
+                CHECK(CreateComputePSO(
+                    d3d,
+                    d3dResources.rootSignature,
+                    resources.probeDeltaImportCS,
+                    &resources.probeDeltaImportPSO),
+                    "create probe delta import PSO!\n", log);
+            #ifdef GFX_NAME_OBJECTS
+                resources.probeDeltaImportPSO->SetName(L"Probe Delta Import PSO");
+            #endif
+
+                CHECK(CreateComputePSO(
+                    d3d,
                     d3dResources.rootSignature,
                     resources.probeTraceCS,
                     &resources.probeTracePSO),
@@ -1068,11 +2031,26 @@ namespace Graphics
             {
                 // Release existing PSOs
                 SAFE_RELEASE(resources.radianceCachePSO);
+                SAFE_RELEASE(resources.radianceCacheRTPSO);
+                SAFE_RELEASE(resources.radianceCacheRTPSOInfo);
                 SAFE_RELEASE(resources.probeRayResolvePSO);
+                SAFE_RELEASE(resources.radianceCacheWorkListArgsPSO);
+                SAFE_RELEASE(resources.radianceCacheSortHistogramPSO);
+                SAFE_RELEASE(resources.radianceCacheSortPrefixSumPSO);
+                SAFE_RELEASE(resources.radianceCacheSortScatterPSO);
+                SAFE_RELEASE(resources.radianceCacheBudgetHistogramPSO);
+                SAFE_RELEASE(resources.radianceCacheBudgetThresholdPSO);
+                SAFE_RELEASE(resources.radianceCacheStatsPSO);
+                SAFE_RELEASE(resources.lightGridBoundsPSO);
+                SAFE_RELEASE(resources.lightGridBuildPSO);
+                SAFE_RELEASE(resources.radianceCacheEvictPSO);
+                SAFE_RELEASE(resources.radianceCacheRehashPSO);
+                SAFE_RELEASE(resources.radianceCacheTrimPSO);
+                SAFE_RELEASE(resources.radianceCacheCommandSignature);
 
                 // Create the radiance cache compute PSO (inline ray tracing)
                 CHECK(CreateComputePSO(
-                    d3d.device,
+                    d3d,
                     d3dResources.rootSignature,
                     resources.radianceCacheCS,
                     &resources.radianceCachePSO),
@@ -1082,9 +2060,22 @@ namespace Graphics
                 resources.radianceCachePSO->SetName(L"Radiance Cache PSO");
 #endif
 
+                // Create the radiance cache RTPSO (ray tracing pipeline)
+                CHECK(CreateRayTracingPSO(
+                    d3d,
+                    d3dResources.rootSignature,
+                    resources.radianceCacheRTShaders,
+                    &resources.radianceCacheRTPSO,
+                    &resources.radianceCacheRTPSOInfo),
+                    "create Radiance Cache RTPSO!\n", log);
+
+#ifdef GFX_NAME_OBJECTS
+                resources.radianceCacheRTPSO->SetName(L"Radiance Cache RTPSO");
+#endif
+
                 // Create the probe ray resolve compute PSO
                 CHECK(CreateComputePSO(
-                    d3d.device,
+                    d3d,
                     d3dResources.rootSignature,
                     resources.probeRayResolveCS,
                     &resources.probeRayResolvePSO),
@@ -1094,6 +2085,141 @@ namespace Graphics
                 resources.probeRayResolvePSO->SetName(L"Probe Ray Resolve PSO");
 #endif
 
+                // Create the radiance cache work list arguments compute PSO
+                CHECK(CreateComputePSO(
+                    d3d,
+                    d3dResources.rootSignature,
+                    resources.radianceCacheWorkListArgsCS,
+                    &resources.radianceCacheWorkListArgsPSO),
+                    "create Radiance Cache Work List Arguments PSO!\n", log);
+
+#ifdef GFX_NAME_OBJECTS
+                resources.radianceCacheWorkListArgsPSO->SetName(L"Radiance Cache Work List Arguments PSO");
+#endif
+
+                // Create the radiance cache work list sort compute PSOs
+                CHECK(CreateComputePSO(
+                    d3d,
+                    d3dResources.rootSignature,
+                    resources.radianceCacheSortHistogramCS,
+                    &resources.radianceCacheSortHistogramPSO),
+                    "create Radiance Cache Sort Histogram PSO!\n", log);
+
+                CHECK(CreateComputePSO(
+                    d3d,
+                    d3dResources.rootSignature,
+                    resources.radianceCacheSortPrefixSumCS,
+                    &resources.radianceCacheSortPrefixSumPSO),
+                    "create Radiance Cache Sort Prefix Sum PSO!\n", log);
+
+                CHECK(CreateComputePSO(
+                    d3d,
+                    d3dResources.rootSignature,
+                    resources.radianceCacheSortScatterCS,
+                    &resources.radianceCacheSortScatterPSO),
+                    "create Radiance Cache Sort Scatter PSO!\n", log);
+
+#ifdef GFX_NAME_OBJECTS
+                resources.radianceCacheSortHistogramPSO->SetName(L"Radiance Cache Sort Histogram PSO");
+                resources.radianceCacheSortPrefixSumPSO->SetName(L"Radiance Cache Sort Prefix Sum PSO");
+                resources.radianceCacheSortScatterPSO->SetName(L"Radiance Cache Sort Scatter PSO");
+#endif
+
+                CHECK(CreateComputePSO(
+                    d3d,
+                    d3dResources.rootSignature,
+                    resources.radianceCacheBudgetHistogramCS,
+                    &resources.radianceCacheBudgetHistogramPSO),
+                    "create Radiance Cache Budget Histogram PSO!\n", log);
+
+                CHECK(CreateComputePSO(
+                    d3d,
+                    d3dResources.rootSignature,
+                    resources.radianceCacheBudgetThresholdCS,
+                    &resources.radianceCacheBudgetThresholdPSO),
+                    "create Radiance Cache Budget Threshold PSO!\n", log);
+
+#ifdef GFX_NAME_OBJECTS
+                resources.radianceCacheBudgetHistogramPSO->SetName(L"Radiance Cache Budget Histogram PSO");
+                resources.radianceCacheBudgetThresholdPSO->SetName(L"Radiance Cache Budget Threshold PSO");
+#endif
+
+                // Create the radiance cache stats compute PSO
+                CHECK(CreateComputePSO(
+                    d3d,
+                    d3dResources.rootSignature,
+                    resources.radianceCacheStatsCS,
+                    &resources.radianceCacheStatsPSO),
+                    "create Radiance Cache Stats PSO!\n", log);
+
+#ifdef GFX_NAME_OBJECTS
+                resources.radianceCacheStatsPSO->SetName(L"Radiance Cache Stats PSO");
+#endif
+
+                // Create the radiance cache compaction compute PSOs
+                CHECK(CreateComputePSO(
+                    d3d,
+                    d3dResources.rootSignature,
+                    resources.radianceCacheEvictCS,
+                    &resources.radianceCacheEvictPSO),
+                    "create Radiance Cache Evict PSO!\n", log);
+
+                CHECK(CreateComputePSO(
+                    d3d,
+                    d3dResources.rootSignature,
+                    resources.radianceCacheRehashCS,
+                    &resources.radianceCacheRehashPSO),
+                    "create Radiance Cache Rehash PSO!\n", log);
+
+                CHECK(CreateComputePSO(
+                    d3d,
+                    d3dResources.rootSignature,
+                    resources.radianceCacheTrimCS,
+                    &resources.radianceCacheTrimPSO),
+                    "create Radiance Cache Trim PSO!\n", log);
+
+#ifdef GFX_NAME_OBJECTS
+                resources.radianceCacheEvictPSO->SetName(L"Radiance Cache Evict PSO");
+                resources.radianceCacheRehashPSO->SetName(L"Radiance Cache Rehash PSO");
+                resources.radianceCacheTrimPSO->SetName(L"Radiance Cache Trim PSO");
+#endif
+
+                // Create the light grid compute PSOs
+                CHECK(CreateComputePSO(
+                    d3d,
+                    d3dResources.rootSignature,
+                    resources.lightGridBoundsCS,
+                    &resources.lightGridBoundsPSO),
+                    "create Light Grid Bounds PSO!\n", log);
+
+                CHECK(CreateComputePSO(
+                    d3d,
+                    d3dResources.rootSignature,
+                    resources.lightGridBuildCS,
+                    &resources.lightGridBuildPSO),
+                    "create Light Grid Build PSO!\n", log);
+
+#ifdef GFX_NAME_OBJECTS
+                resources.lightGridBoundsPSO->SetName(L"Light Grid Bounds PSO");
+                resources.lightGridBuildPSO->SetName(L"Light Grid Build PSO");
+#endif
+
+                // Create the command signature for the indirect radiance cache dispatch (also used by the GBuffer tile gather)
+                D3D12_INDIRECT_ARGUMENT_DESC argumentDesc = {};
+                argumentDesc.Type = D3D12_INDIRECT_ARGUMENT_TYPE_DISPATCH;
+
+                D3D12_COMMAND_SIGNATURE_DESC signatureDesc = {};
+                signatureDesc.ByteStride = sizeof(D3D12_DISPATCH_ARGUMENTS);
+                signatureDesc.NumArgumentDescs = 1;
+                signatureDesc.pArgumentDescs = &argumentDesc;
+
+                HRESULT hr = d3d.device->CreateCommandSignature(&signatureDesc, nullptr, IID_PPV_ARGS(&resources.radianceCacheCommandSignature));
+                CHECK(SUCCEEDED(hr), "create Radiance Cache command signature!\n", log);
+
+#ifdef GFX_NAME_OBJECTS
+                resources.radianceCacheCommandSignature->SetName(L"Radiance Cache Command Signature");
+#endif
+
                 return true;
             }
 
@@ -1103,6 +2229,9 @@ namespace Graphics
                 //    Entry 0:  DDGI Ray Generation Shader
                 //    Entry 1:  DDGI Miss Shader
                 //    Entry 2+: DDGI HitGroups
+                //    Entry N:  Radiance Cache Ray Generation Shader
+                //    Entry N+1: Radiance Cache Miss Shader
+                //    Entry N+2+: Radiance Cache HitGroups
                 // All shader records in the Shader Table must have the same size, so shader record size will be based on the largest required entry.
                 // The entries must be aligned up to D3D12_RAYTRACING_SHADER_BINDING_TABLE_RECORD_BYTE_ALIGNMENT.
                 // The CHS requires the largest entry:
@@ -1122,8 +2251,10 @@ namespace Graphics
                 resources.shaderTableRecordSize += 8;              // sampler descriptor table GPUVA
                 resources.shaderTableRecordSize = ALIGN(D3D12_RAYTRACING_SHADER_RECORD_BYTE_ALIGNMENT, resources.shaderTableRecordSize);
 
-                // 2 + numHitGroups shader records in the table
-                resources.shaderTableSize = (2 + static_cast<uint32_t>(resources.rtShaders.hitGroups.size())) * resources.shaderTableRecordSize;
+                // 2 + numHitGroups shader records in the table, for both the DDGI and the radiance cache pipelines
+                uint32_t numRecords = (2 + static_cast<uint32_t>(resources.rtShaders.hitGroups.size()));
+                numRecords += (2 + static_cast<uint32_t>(resources.radianceCacheRTShaders.hitGroups.size()));
+                resources.shaderTableSize = numRecords * resources.shaderTableRecordSize;
                 resources.shaderTableSize = ALIGN(D3D12_RAYTRACING_SHADER_TABLE_BYTE_ALIGNMENT, resources.shaderTableSize);
 
                 // Create the shader table upload buffer resource
@@ -1174,11 +2305,33 @@ namespace Graphics
                 resources.shaderTableHitGroupTableStartAddress = resources.shaderTableMissTableStartAddress + resources.shaderTableMissTableSize;
                 resources.shaderTableHitGroupTableSize = static_cast<uint32_t>(resources.rtShaders.hitGroups.size()) * resources.shaderTableRecordSize;
 
+                // Entry N: Radiance Cache Ray Generation Shader and descriptor heap pointer
+                pData += resources.shaderTableRecordSize;
+                memcpy(pData, resources.radianceCacheRTPSOInfo->GetShaderIdentifier(resources.radianceCacheRTShaders.rgs.exportName.c_str()), shaderIdSize);
+                *reinterpret_cast<D3D12_GPU_DESCRIPTOR_HANDLE*>(pData + shaderIdSize) = d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart();
+                resources.radianceCacheShaderTableRGSStartAddress = resources.shaderTableHitGroupTableStartAddress + resources.shaderTableHitGroupTableSize;
+
+                // Entry N+1: Radiance Cache Miss Shader
+                pData += resources.shaderTableRecordSize;
+                memcpy(pData, resources.radianceCacheRTPSOInfo->GetShaderIdentifier(resources.radianceCacheRTShaders.miss.exportName.c_str()), shaderIdSize);
+                resources.radianceCacheShaderTableMissTableStartAddress = resources.radianceCacheShaderTableRGSStartAddress + resources.shaderTableRecordSize;
+
+                // Entries N+2+: Radiance Cache Hit Groups and descriptor heap pointers
+                for (uint32_t hitGroupIndex = 0; hitGroupIndex < static_cast<uint32_t>(resources.radianceCacheRTShaders.hitGroups.size()); hitGroupIndex++)
+                {
+                    pData += resources.shaderTableRecordSize;
+                    memcpy(pData, resources.radianceCacheRTPSOInfo->GetShaderIdentifier(resources.radianceCacheRTShaders.hitGroups[hitGroupIndex].exportName), shaderIdSize);
+                    *reinterpret_cast<D3D12_GPU_DESCRIPTOR_HANDLE*>(pData + shaderIdSize) = d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart();
+                    *reinterpret_cast<D3D12_GPU_DESCRIPTOR_HANDLE*>(pData + shaderIdSize + 8) = d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart();
+                }
+                resources.radianceCacheShaderTableHitGroupTableStartAddress = resources.radianceCacheShaderTableMissTableStartAddress + resources.shaderTableRecordSize;
+                resources.radianceCacheShaderTableHitGroupTableSize = static_cast<uint32_t>(resources.radianceCacheRTShaders.hitGroups.size()) * resources.shaderTableRecordSize;
+
                 // Unmap
                 resources.shaderTableUpload->Unmap(0, nullptr);
 
                 // Schedule a copy of the upload buffer to the device buffer
-                d3d.cmdList[d3d.frameIndex]->CopyBufferRegion(resources.shaderTable, 0, resources.shaderTableUpload, 0, resources.shaderTableSize);
+                GetCmdList(d3d)->CopyBufferRegion(resources.shaderTable, 0, resources.shaderTableUpload, 0, resources.shaderTableSize);
 
                 // Transition the default heap resource to generic read after the copy is complete
                 D3D12_RESOURCE_BARRIER barrier = {};
@@ -1188,7 +2341,7 @@ namespace Graphics
                 barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_GENERIC_READ;
                 barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
 
-                d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+                GetCmdList(d3d)->ResourceBarrier(1, &barrier);
 
                 return true;
             }
@@ -1197,7 +2350,7 @@ namespace Graphics
              * Clear only the accumulation buffer (called every frame before radiance cache update).
              * This resets sample counting while preserving temporal history in the radiance buffer.
              */
-            void ClearRadianceCacheAccumulation(Globals& d3d, GlobalResources& d3dResources, Resources& resources)
+            void ClearRadianceCacheAccumulation(Globals& d3d, GlobalResources& d3dResources, Resources& resources, ID3D12GraphicsCommandList4* cmdList)
             {
                 D3D12_GPU_DESCRIPTOR_HANDLE GPUHeapStart = d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart();
 
@@ -1207,13 +2360,263 @@ namespace Graphics
                 AccumGPUHandle.ptr = GPUHeapStart.ptr + (DescriptorHeapOffsets::UAV_RADIANCE_CACHE_ACCUMULATION * d3dResources.srvDescHeapEntrySize);
 
                 UINT ClearValueUint[4] = {0, 0, 0, 0};
-                d3d.cmdList[d3d.frameIndex]->ClearUnorderedAccessViewUint(AccumGPUHandle, AccumCPUHandle, resources.RadianceCacheAccumulationResource, ClearValueUint, 0, nullptr);
+                cmdList->ClearUnorderedAccessViewUint(AccumGPUHandle, AccumCPUHandle, resources.RadianceCacheAccumulationResource, ClearValueUint, 0, nullptr);
 
                 // UAV barrier for accumulation buffer
                 D3D12_RESOURCE_BARRIER barrier = {};
                 barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
                 barrier.UAV.pResource = resources.RadianceCacheAccumulationResource;
-                d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+                cmdList->ResourceBarrier(1, &barrier);
+            }
+
+            /**
+             * Free the radiance cache slots that haven't been used for RADIANCE_CACHE_MAX_ENTRY_AGE frames, and move live cells
+             * toward the start of their probe sequences (see RadianceCacheCompactCS.hlsl).
+             * Recorded before the probe trace, so no pass looks up or claims slots while cells move.
+             */
+            void CompactRadianceCache(Globals& d3d, GlobalResources& d3dResources, Resources& resources, ID3D12GraphicsCommandList4* cmdList)
+            {
+            #ifdef GFX_PERF_MARKERS
+                PIXBeginEvent(cmdList, PIX_COLOR(GFX_PERF_MARKER_GREEN), "Radiance Cache Compaction CS");
+            #endif
+
+                // Set the descriptor heaps
+                ID3D12DescriptorHeap* ppHeaps[] = { d3dResources.srvDescHeap, d3dResources.samplerDescHeap };
+                cmdList->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+
+                // Set the root signature
+                cmdList->SetComputeRootSignature(d3dResources.rootSignature);
+
+                // Update the root constants (the frame number ages the slots)
+                GlobalConstants consts = d3dResources.constants;
+                cmdList->SetComputeRoot32BitConstants(0, AppConsts::GetNum32BitValues(), consts.app.GetData(), 0);
+
+                // Set the root parameter descriptor tables
+            #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
+                cmdList->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
+                cmdList->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
+            #endif
+
+                // Every pass reads and writes the slots of the previous pass
+                ID3D12Resource* slotResources[] = {
+                    resources.RadianceCacheMetadataResource,
+                    resources.RadianceCachingResource,
+                    resources.RadianceCacheAccumulationResource,
+                    resources.HitCachingResource,
+                    resources.RadianceCachingVisualizationResource,
+                    resources.RadianceCacheReservoirResource };
+                D3D12_RESOURCE_BARRIER barriers[_countof(slotResources)] = {};
+                for (UINT barrierIndex = 0; barrierIndex < _countof(barriers); barrierIndex++)
+                {
+                    barriers[barrierIndex].Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+                    barriers[barrierIndex].UAV.pResource = slotResources[barrierIndex];
+                }
+
+                // Dispatch one thread per slot in each pass, RadianceCacheCompactCS uses [numthreads(64, 1, 1)]
+                ID3D12PipelineState* passes[] = { resources.radianceCacheEvictPSO, resources.radianceCacheRehashPSO, resources.radianceCacheTrimPSO };
+                cmdList->ResourceBarrier(_countof(barriers), barriers);
+                for (ID3D12PipelineState* pass : passes)
+                {
+                    cmdList->SetPipelineState(pass);
+                    cmdList->Dispatch(DivRoundUp(resources.CascadeCellNum, 64), 1, 1);
+                    cmdList->ResourceBarrier(_countof(barriers), barriers);
+                }
+
+            #ifdef GFX_PERF_MARKERS
+                PIXEndEvent(cmdList);
+            #endif
+            }
+
+            /**
+             * Reduce the radiance cache metadata to the occupied slots, live slots, live slot age, and probe ray coverage of each cascade.
+             * Recorded at the end of the probe update chain, after every pass that claims or touches a slot this frame.
+             */
+            void ReduceRadianceCacheStats(Globals& d3d, GlobalResources& d3dResources, Resources& resources, ID3D12GraphicsCommandList4* cmdList)
+            {
+            #ifdef GFX_PERF_MARKERS
+                PIXBeginEvent(cmdList, PIX_COLOR(GFX_PERF_MARKER_GREEN), "Radiance Cache Stats CS");
+            #endif
+
+                // Wait for the metadata writes of the probe trace and radiance cache passes
+                D3D12_RESOURCE_BARRIER barrier = {};
+                barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+                barrier.UAV.pResource = resources.RadianceCacheMetadataResource;
+                cmdList->ResourceBarrier(1, &barrier);
+
+                // Set the descriptor heaps
+                ID3D12DescriptorHeap* ppHeaps[] = { d3dResources.srvDescHeap, d3dResources.samplerDescHeap };
+                cmdList->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+
+                // Set the root signature
+                cmdList->SetComputeRootSignature(d3dResources.rootSignature);
+
+                // Update the root constants (the frame number ages the slots)
+                GlobalConstants consts = d3dResources.constants;
+                cmdList->SetComputeRoot32BitConstants(0, AppConsts::GetNum32BitValues(), consts.app.GetData(), 0);
+
+                // Set the root parameter descriptor tables
+            #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
+                cmdList->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
+                cmdList->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
+            #endif
+
+                // Dispatch one thread per slot, RadianceCacheStatsCS uses [numthreads(64, 1, 1)]
+                cmdList->SetPipelineState(resources.radianceCacheStatsPSO);
+                cmdList->Dispatch((resources.CascadeCellNum + 63) / 64, 1, 1);
+
+                // Wait for the cache stats before they are copied
+                barrier.UAV.pResource = resources.radianceCacheStats;
+                cmdList->ResourceBarrier(1, &barrier);
+
+            #ifdef GFX_PERF_MARKERS
+                PIXEndEvent(cmdList);
+            #endif
+            }
+
+            /**
+             * Copy this frame's GPU counters, pipeline statistics, and radiance cache stats to the frame's readback buffer,
+             * then clear the counters and cache stats.
+             * Recorded at the end of the probe update chain, on the command list (queue) of the counted passes.
+             */
+            void CopyGPUCounters(Globals& d3d, Resources& resources, ID3D12GraphicsCommandList4* cmdList)
+            {
+                ID3D12Resource* readback = resources.gpuCountersReadback[d3d.frameIndex];
+                cmdList->ResolveQueryData(resources.pipelineStatsHeap, D3D12_QUERY_TYPE_PIPELINE_STATISTICS, 0, Instrumentation::PASS_COUNT, readback, resources.pipelineStatsOffset);
+
+                // Transition the counters and cache stats to copy sources
+                D3D12_RESOURCE_BARRIER barriers[2] = {};
+                barriers[0].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+                barriers[0].Transition.pResource = resources.gpuCounters;
+                barriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                barriers[0].Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
+                barriers[0].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+                barriers[1] = barriers[0];
+                barriers[1].Transition.pResource = resources.radianceCacheStats;
+                cmdList->ResourceBarrier(2, barriers);
+
+                cmdList->CopyBufferRegion(readback, 0, resources.gpuCounters, 0, resources.gpuCountersSize);
+                cmdList->CopyBufferRegion(readback, resources.radianceCacheStatsOffset, resources.radianceCacheStats, 0, resources.radianceCacheStatsSize);
+                resources.gpuCountersReadbackFrame[d3d.frameIndex] = d3d.frameNumber;
+
+                // Clear the counters and cache stats
+                for (D3D12_RESOURCE_BARRIER& barrier : barriers)
+                {
+                    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE;
+                    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
+                }
+                cmdList->ResourceBarrier(2, barriers);
+
+                cmdList->CopyBufferRegion(resources.gpuCounters, 0, resources.gpuCountersClear, 0, resources.gpuCountersSize);
+                cmdList->CopyBufferRegion(resources.radianceCacheStats, 0, resources.gpuCountersClear, 0, resources.radianceCacheStatsSize);
+
+                // Transition the counters and cache stats back to UAVs for the next frame's passes
+                for (D3D12_RESOURCE_BARRIER& barrier : barriers)
+                {
+                    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+                    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                }
+                cmdList->ResourceBarrier(2, barriers);
+            }
+
+            /**
+             * Read back the GPU counters and pipeline statistics a previous use of the frame's readback buffer copied.
+             * The frame's fence waits for the async compute work too (see SubmitCmdList()), so the copy has completed.
+             */
+            void ReadGPUCounters(Globals& d3d, Resources& resources)
+            {
+                UINT counterFrame = resources.gpuCountersReadbackFrame[d3d.frameIndex];
+                if (counterFrame == 0 || resources.counters == nullptr) return;
+
+                UINT8* pData = nullptr;
+                D3D12_RANGE readRange = { 0, resources.radianceCacheStatsOffset + resources.radianceCacheStatsSize };
+                if (FAILED(resources.gpuCountersReadback[d3d.frameIndex]->Map(0, &readRange, reinterpret_cast<void**>(&pData)))) return;
+
+                Instrumentation::Counters& counters = *resources.counters;
+                memcpy(counters.values, pData, resources.gpuCountersSize);
+
+                const D3D12_QUERY_DATA_PIPELINE_STATISTICS* stats = reinterpret_cast<const D3D12_QUERY_DATA_PIPELINE_STATISTICS*>(pData + resources.pipelineStatsOffset);
+                for (UINT pass = 0; pass < Instrumentation::PASS_COUNT; pass++) counters.csInvocations[pass] = stats[pass].CSInvocations;
+
+                counters.cacheCascadeCells = d3d.CacheCount;
+                counters.cacheCascades.resize(resources.radianceCacheStatsSize / RADIANCE_CACHE_STATS_STRIDE);
+                for (size_t cascade = 0; cascade < counters.cacheCascades.size(); cascade++)
+                {
+                    const UINT* stats = reinterpret_cast<const UINT*>(pData + resources.radianceCacheStatsOffset + (cascade * RADIANCE_CACHE_STATS_STRIDE));
+                    Instrumentation::CacheCascadeStats& cascadeStats = counters.cacheCascades[cascade];
+                    cascadeStats.occupied = stats[0];
+                    cascadeStats.live = stats[1];
+                    cascadeStats.ageSum = stats[2];
+                    cascadeStats.stepSum = stats[3];
+                    cascadeStats.probeRays = stats[4];
+                    cascadeStats.coveredCells = stats[5];
+                    memcpy(cascadeStats.coverage, &stats[6], sizeof(cascadeStats.coverage));
+                }
+                counters.frame = counterFrame;
+
+                D3D12_RANGE writeRange = {};
+                resources.gpuCountersReadback[d3d.frameIndex]->Unmap(0, &writeRange);
+            }
+
+            /**
+             * Read back the irradiance queries a previous use of the frame's readback buffer evaluated, and call back their batches.
+             * Like the GPU counters, the frame's fence has waited for the copy.
+             */
+            void ReadIrradianceQueries(Globals& d3d, Resources& resources)
+            {
+                std::vector<IrradianceQueryBatch>& batches = resources.irradianceQueryBatches[d3d.frameIndex];
+                UINT count = batches.back().first + batches.back().count;
+
+                UINT8* pData = nullptr;
+                D3D12_RANGE readRange = { 0, IRRADIANCE_QUERY_HEADER_SIZE + (count * sizeof(IrradianceQuery)) };
+                if (SUCCEEDED(resources.irradianceQueriesReadback[d3d.frameIndex]->Map(0, &readRange, reinterpret_cast<void**>(&pData))))
+                {
+                    // The irradiance and blend weight overwrite each query's position
+                    resources.irradianceQueryResults.resize(count);
+                    const UINT8* pQueries = pData + IRRADIANCE_QUERY_HEADER_SIZE;
+                    for (UINT queryIndex = 0; queryIndex < count; queryIndex++)
+                    {
+                        memcpy(&resources.irradianceQueryResults[queryIndex], pQueries + (queryIndex * sizeof(IrradianceQuery)), sizeof(float4));
+                    }
+
+                    D3D12_RANGE writeRange = {};
+                    resources.irradianceQueriesReadback[d3d.frameIndex]->Unmap(0, &writeRange);
+
+                    for (const IrradianceQueryBatch& batch : batches)
+                    {
+                        if (batch.callback) batch.callback(&resources.irradianceQueryResults[batch.first], batch.count);
+                    }
+                }
+                batches.clear();
+            }
+
+            /**
+             * Read back the probe delta packet a previous use of the frame's readback buffer exported, and call back its export.
+             * Like the irradiance queries, the frame's fence has waited for the copy.
+             */
+            void ReadProbeDeltas(Globals& d3d, Resources& resources)
+            {
+                ProbeDeltaExport& probeDeltaExport = resources.probeDeltaExports[d3d.frameIndex];
+
+                UINT8* pData = nullptr;
+                D3D12_RANGE readRange = { 0, resources.probeDeltaPacketSize };
+                if (SUCCEEDED(resources.probeDeltasReadback[d3d.frameIndex]->Map(0, &readRange, reinterpret_cast<void**>(&pData))))
+                {
+                    // The tile count includes the changed probes that didn't fit the packet
+                    ProbeDeltaHeader header;
+                    memcpy(&header, pData, sizeof(ProbeDeltaHeader));
+                    header.tileCount = std::min(header.tileCount, header.maxTiles);
+
+                    UINT size = PROBE_DELTA_HEADER_SIZE + (header.tileCount * header.tileStride);
+                    resources.probeDeltaPacket.resize(size);
+                    memcpy(resources.probeDeltaPacket.data(), pData, size);
+                    memcpy(resources.probeDeltaPacket.data(), &header, sizeof(ProbeDeltaHeader));
+
+                    D3D12_RANGE writeRange = {};
+                    resources.probeDeltasReadback[d3d.frameIndex]->Unmap(0, &writeRange);
+
+                    probeDeltaExport.callback(resources.probeDeltaPacket.data(), size);
+                }
+                probeDeltaExport.callback = nullptr;
             }
 
             /**
@@ -1224,13 +2627,16 @@ namespace Graphics
             {
                 D3D12_GPU_DESCRIPTOR_HANDLE GPUHeapStart = d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart();
 
+                // The transient buffers may alias another pass's resources, activate them before clearing
+                AliasTransients(d3d, GetCmdList(d3d), ETransientPass::DDGI_PROBE_TRACE);
+
                 // Clear the HitCaching buffer to avoid garbage data
                 D3D12_CPU_DESCRIPTOR_HANDLE HitCacheCPUHandle;
                 HitCacheCPUHandle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_HIT_CACHING * d3dResources.srvDescHeapEntrySize);
                 D3D12_GPU_DESCRIPTOR_HANDLE HitCacheGPUHandle;
                 HitCacheGPUHandle.ptr = GPUHeapStart.ptr + (DescriptorHeapOffsets::UAV_HIT_CACHING * d3dResources.srvDescHeapEntrySize);
                 UINT ZeroClear[4] = {0, 0, 0, 0};
-                d3d.cmdList[d3d.frameIndex]->ClearUnorderedAccessViewUint(HitCacheGPUHandle, HitCacheCPUHandle, resources.HitCachingResource, ZeroClear, 0, nullptr);
+                GetCmdList(d3d)->ClearUnorderedAccessViewUint(HitCacheGPUHandle, HitCacheCPUHandle, resources.HitCachingResource, ZeroClear, 0, nullptr);
 
                 // Clear the radiance buffer (temporal history)
                 D3D12_CPU_DESCRIPTOR_HANDLE CPUHandle;
@@ -1239,7 +2645,7 @@ namespace Graphics
                 GPUHandle.ptr = GPUHeapStart.ptr + (DescriptorHeapOffsets::UAV_RADIANCE_CACHING * d3dResources.srvDescHeapEntrySize);
 
                 float ClearValue[4] = {0.0f, 0.0f, 0.0f, 0.0f};
-                d3d.cmdList[d3d.frameIndex]->ClearUnorderedAccessViewFloat(GPUHandle, CPUHandle, resources.RadianceCachingResource, ClearValue, 0, nullptr);
+                GetCmdList(d3d)->ClearUnorderedAccessViewFloat(GPUHandle, CPUHandle, resources.RadianceCachingResource, ClearValue, 0, nullptr);
 
                 // Clear the metadata buffer (checksum + frame for collision detection)
                 D3D12_CPU_DESCRIPTOR_HANDLE MetaCPUHandle;
@@ -1248,7 +2654,15 @@ namespace Graphics
                 MetaGPUHandle.ptr = GPUHeapStart.ptr + (DescriptorHeapOffsets::UAV_RADIANCE_CACHE_METADATA * d3dResources.srvDescHeapEntrySize);
 
                 UINT ClearValueUint[4] = {0, 0, 0, 0};
-                d3d.cmdList[d3d.frameIndex]->ClearUnorderedAccessViewUint(MetaGPUHandle, MetaCPUHandle, resources.RadianceCacheMetadataResource, ClearValueUint, 0, nullptr);
+                GetCmdList(d3d)->ClearUnorderedAccessViewUint(MetaGPUHandle, MetaCPUHandle, resources.RadianceCacheMetadataResource, ClearValueUint, 0, nullptr);
+
+                // Clear the indirect sample reservoirs (a zero sample count is an empty reservoir)
+                D3D12_CPU_DESCRIPTOR_HANDLE ReservoirCPUHandle;
+                ReservoirCPUHandle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_RADIANCE_CACHE_RESERVOIRS * d3dResources.srvDescHeapEntrySize);
+                D3D12_GPU_DESCRIPTOR_HANDLE ReservoirGPUHandle;
+                ReservoirGPUHandle.ptr = GPUHeapStart.ptr + (DescriptorHeapOffsets::UAV_RADIANCE_CACHE_RESERVOIRS * d3dResources.srvDescHeapEntrySize);
+
+                GetCmdList(d3d)->ClearUnorderedAccessViewUint(ReservoirGPUHandle, ReservoirCPUHandle, resources.RadianceCacheReservoirResource, ClearValueUint, 0, nullptr);
 
                 // Clear the ProbeRayHitMap buffer to INVALID (0xFFFFFFFF)
                 // This ensures rays that aren't traced don't have garbage HashIDs
@@ -1258,50 +2672,62 @@ namespace Graphics
                 HitMapGPUHandle.ptr = GPUHeapStart.ptr + (DescriptorHeapOffsets::UAV_PROBE_RAY_HIT_MAP * d3dResources.srvDescHeapEntrySize);
 
                 UINT InvalidValue[4] = {0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF};
-                d3d.cmdList[d3d.frameIndex]->ClearUnorderedAccessViewUint(HitMapGPUHandle, HitMapCPUHandle, resources.ProbeRayHitMapResource, InvalidValue, 0, nullptr);
+                GetCmdList(d3d)->ClearUnorderedAccessViewUint(HitMapGPUHandle, HitMapCPUHandle, resources.ProbeRayHitMapResource, InvalidValue, 0, nullptr);
 
-                // UAV barrier for metadata and hitmap buffers
-                D3D12_RESOURCE_BARRIER barriers[2] = {};
+                // Clear the work list arguments (drops any slots appended since the last radiance cache update)
+                D3D12_CPU_DESCRIPTOR_HANDLE WorkListArgsCPUHandle;
+                WorkListArgsCPUHandle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_RADIANCE_CACHE_WORK_LIST_ARGS * d3dResources.srvDescHeapEntrySize);
+                D3D12_GPU_DESCRIPTOR_HANDLE WorkListArgsGPUHandle;
+                WorkListArgsGPUHandle.ptr = GPUHeapStart.ptr + (DescriptorHeapOffsets::UAV_RADIANCE_CACHE_WORK_LIST_ARGS * d3dResources.srvDescHeapEntrySize);
+
+                GetCmdList(d3d)->ClearUnorderedAccessViewUint(WorkListArgsGPUHandle, WorkListArgsCPUHandle, resources.RadianceCacheWorkListArgsResource, ClearValueUint, 0, nullptr);
+
+                // UAV barrier for metadata, reservoir, hitmap, and work list arguments buffers
+                D3D12_RESOURCE_BARRIER barriers[4] = {};
                 barriers[0].Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
                 barriers[0].UAV.pResource = resources.RadianceCacheMetadataResource;
                 barriers[1].Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
                 barriers[1].UAV.pResource = resources.ProbeRayHitMapResource;
-                d3d.cmdList[d3d.frameIndex]->ResourceBarrier(2, barriers);
+                barriers[2].Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+                barriers[2].UAV.pResource = resources.RadianceCacheWorkListArgsResource;
+                barriers[3].Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+                barriers[3].UAV.pResource = resources.RadianceCacheReservoirResource;
+                GetCmdList(d3d)->ResourceBarrier(4, barriers);
 
                 // Also clear the accumulation buffer
-                ClearRadianceCacheAccumulation(d3d, d3dResources, resources);
+                ClearRadianceCacheAccumulation(d3d, d3dResources, resources, GetCmdList(d3d));
             }
 
             void RayTraceVolumes(Globals& d3d, GlobalResources& d3dResources, Resources& resources, DDGIVolume* volumes)
             {
             #ifdef GFX_PERF_MARKERS
-                PIXBeginEvent(d3d.cmdList[d3d.frameIndex], PIX_COLOR(GFX_PERF_MARKER_GREEN), "Ray Trace DDGIVolumes");
+                PIXBeginEvent(GetCmdList(d3d), PIX_COLOR(GFX_PERF_MARKER_GREEN), "Ray Trace DDGIVolumes");
             #endif
 
                 // Set the descriptor heaps
                 ID3D12DescriptorHeap* ppHeaps[] = { d3dResources.srvDescHeap, d3dResources.samplerDescHeap };
-                d3d.cmdList[d3d.frameIndex]->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+                GetCmdList(d3d)->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
 
                 // Set the root signature
-                d3d.cmdList[d3d.frameIndex]->SetComputeRootSignature(d3dResources.rootSignature);
+                GetCmdList(d3d)->SetComputeRootSignature(d3dResources.rootSignature);
 
                 // Update the root constants
                 UINT offset = 0;
                 GlobalConstants consts = d3dResources.constants;
-                d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(0, AppConsts::GetNum32BitValues(), consts.app.GetData(), offset);
+                GetCmdList(d3d)->SetComputeRoot32BitConstants(0, AppConsts::GetNum32BitValues(), consts.app.GetData(), offset);
                 offset += AppConsts::GetAlignedNum32BitValues();
-                d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(0, PathTraceConsts::GetNum32BitValues(), consts.pt.GetData(), offset);
+                GetCmdList(d3d)->SetComputeRoot32BitConstants(0, PathTraceConsts::GetNum32BitValues(), consts.pt.GetData(), offset);
                 offset += PathTraceConsts::GetAlignedNum32BitValues();
-                d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(0, LightingConsts::GetNum32BitValues(), consts.lights.GetData(), offset);
+                GetCmdList(d3d)->SetComputeRoot32BitConstants(0, LightingConsts::GetNum32BitValues(), consts.lights.GetData(), offset);
 
                 // Set the root parameter descriptor tables
             #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
-                d3d.cmdList[d3d.frameIndex]->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
-                d3d.cmdList[d3d.frameIndex]->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
+                GetCmdList(d3d)->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
+                GetCmdList(d3d)->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
             #endif
 
                 // Set the RTPSO
-                d3d.cmdList[d3d.frameIndex]->SetPipelineState1(resources.rtpso);
+                GetCmdList(d3d)->SetPipelineState1(resources.rtpso);
 
                 // Describe the shader table
                 D3D12_DISPATCH_RAYS_DESC desc = {};
@@ -1316,77 +2742,134 @@ namespace Graphics
                 desc.HitGroupTable.SizeInBytes = resources.shaderTableHitGroupTableSize;
                 desc.HitGroupTable.StrideInBytes = resources.shaderTableRecordSize;
 
-                // Barriers
-                std::vector<D3D12_RESOURCE_BARRIER> barriers;
-                D3D12_RESOURCE_BARRIER barrier = {};
-                barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
-
-                // Trace probe rays for each volume
+                // Trace probe rays for the volume
                 {
                     // Get the volume
                     const DDGIVolume* volume = volumes;
 
                     // Update the root constants
-                    d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(1, DDGIRootConstants::GetNum32BitValues(), volume->GetRootConstants().GetData(), 0);
+                    GetCmdList(d3d)->SetComputeRoot32BitConstants(1, DDGIRootConstants::GetNum32BitValues(), volume->GetRootConstants().GetData(), 0);
 
                     // Get the ray dispatch dimensions
                     volume->GetRayDispatchDimensions(desc.Width, desc.Height, desc.Depth);
 
                     // Dispatch the rays
-                    d3d.cmdList[d3d.frameIndex]->DispatchRays(&desc);
+                    GetCmdList(d3d)->DispatchRays(&desc);
 
                     // Transition the volume's irradiance, distance, and probe data texture arrays from read-only (non-pixel shader) to read-write (UAV)
-                    volume->TransitionResources(d3d.cmdList[d3d.frameIndex], EDDGIExecutionStage::POST_PROBE_TRACE);
+                    volume->TransitionResources(GetCmdList(d3d), EDDGIExecutionStage::POST_PROBE_TRACE);
 
-                    // Barrier(s)
+                    // Wait for the ray traces to complete
+                    D3D12_RESOURCE_BARRIER barrier = {};
+                    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
                     barrier.UAV.pResource = volume->GetProbeRayData();
-                    barriers.push_back(barrier);
-                }
-
-                // Wait for the ray traces to complete
-                if (!barriers.empty())
-                {
-                    d3d.cmdList[d3d.frameIndex]->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+                    GetCmdList(d3d)->ResourceBarrier(1, &barrier);
                 }
 
             #ifdef GFX_PERF_MARKERS
-                PIXEndEvent(d3d.cmdList[d3d.frameIndex]);
+                PIXEndEvent(GetCmdList(d3d));
             #endif
             }
 
-            void RayTraceVolumeCS(Globals& d3d, GlobalResources& d3dResources, Resources& resources, DDGIVolume* volume)
+            /**
+             * Write the batched probe trace volume table for the volumes updated this frame.
+             * Each volume gets one dispatch row per probe, and a ProbeRayHitMap range of probes * rays.
+             */
+            bool UploadProbeTraceBatch(Globals& d3d, Resources& resources, const std::vector<DDGIVolume*>& volumes)
             {
-                #ifdef GFX_PERF_MARKERS
-                PIXBeginEvent(d3d.cmdList[d3d.frameIndex], PIX_COLOR(GFX_PERF_MARKER_GREEN), "Ray Trace Volume CS");
-            #endif
-
-                // Set the descriptor heaps
-                ID3D12DescriptorHeap* ppHeaps[] = { d3dResources.srvDescHeap, d3dResources.samplerDescHeap };
-                d3d.cmdList[d3d.frameIndex]->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+                resources.ProbeTraceBatchRayGroups = 0;
+                resources.ProbeTraceBatchProbes = 0;
 
-                // Set the root signature
-                d3d.cmdList[d3d.frameIndex]->SetComputeRootSignature(d3dResources.rootSignature);
+                UINT8* pData = nullptr;
+                D3D12_RANGE readRange = {};
+                if (FAILED(resources.ProbeTraceBatchUploadResource->Map(0, &readRange, reinterpret_cast<void**>(&pData)))) return false;
 
-                // Update the global root constants
-                UINT offset = 0;
-                GlobalConstants consts = d3dResources.constants;
-                d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(0, AppConsts::GetNum32BitValues(), consts.app.GetData(), offset);
-                offset += AppConsts::GetAlignedNum32BitValues();
-                d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(0, PathTraceConsts::GetNum32BitValues(), consts.pt.GetData(), offset);
-                offset += PathTraceConsts::GetAlignedNum32BitValues();
-                d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(0, LightingConsts::GetNum32BitValues(), consts.lights.GetData(), offset);
+                UINT64 offset = resources.ProbeTraceBatchSizeInBytes * d3d.frameIndex;
+                uint32_t* pEntries = reinterpret_cast<uint32_t*>(pData + offset);
 
-                // Set DDGIRootConstants for the volume
-                d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(1, DDGIRootConstants::GetNum32BitValues(), volume->GetRootConstants().GetData(), 0);
+                UINT hitMapOffset = 0;
+                for (UINT batchIndex = 0; batchIndex < static_cast<UINT>(volumes.size()); batchIndex++)
+                {
+                    const DDGIVolume* volume = volumes[batchIndex];
+                    int3 probeCounts = volume->GetProbeCounts();
+                    UINT numProbes = probeCounts.x * probeCounts.y * probeCounts.z;
+                    UINT raysPerProbe = volume->GetNumRaysPerProbe();
+
+                    uint32_t* pEntry = pEntries + (4 * (1 + batchIndex));
+                    pEntry[0] = volume->GetIndex();
+                    pEntry[1] = resources.ProbeTraceBatchProbes;
+                    pEntry[2] = hitMapOffset;
+                    pEntry[3] = 0;
+
+                    resources.ProbeTraceBatchRayGroups = (std::max)(resources.ProbeTraceBatchRayGroups, (raysPerProbe + 63) / 64);
+                    resources.ProbeTraceBatchProbes += numProbes;
+                    hitMapOffset += numProbes * raysPerProbe;
+                }
 
-                // Set the root parameter descriptor tables
-            #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
-                d3d.cmdList[d3d.frameIndex]->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
-                d3d.cmdList[d3d.frameIndex]->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
-            #endif
+                // Header: number of batched volumes, number of batched probes
+                pEntries[0] = static_cast<uint32_t>(volumes.size());
+                pEntries[1] = resources.ProbeTraceBatchProbes;
+                pEntries[2] = 0;
+                pEntries[3] = 0;
 
-                // Set the PSO
-                d3d.cmdList[d3d.frameIndex]->SetPipelineState(resources.probeTracePSO);
+                resources.ProbeTraceBatchUploadResource->Unmap(0, nullptr);
+
+                // Copy the table to the device buffer
+                D3D12_RESOURCE_BARRIER barrier = {};
+                barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+                barrier.Transition.pResource = resources.ProbeTraceBatchResource;
+                barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
+                barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+                GetCmdList(d3d)->ResourceBarrier(1, &barrier);
+
+                GetCmdList(d3d)->CopyBufferRegion(resources.ProbeTraceBatchResource, 0, resources.ProbeTraceBatchUploadResource, offset, resources.ProbeTraceBatchSizeInBytes);
+
+                barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+                barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                GetCmdList(d3d)->ResourceBarrier(1, &barrier);
+
+                return true;
+            }
+
+            void RayTraceVolumeCS(Globals& d3d, GlobalResources& d3dResources, Resources& resources, const std::vector<DDGIVolume*>& volumes, ID3D12GraphicsCommandList4* cmdList)
+            {
+                // Every selected volume may be converged (or baked)
+                if (volumes.empty()) return;
+
+                const DDGIVolume* volume = volumes[0];
+
+                #ifdef GFX_PERF_MARKERS
+                PIXBeginEvent(cmdList, PIX_COLOR(GFX_PERF_MARKER_GREEN), "Ray Trace Volume CS");
+            #endif
+
+                // Set the descriptor heaps
+                ID3D12DescriptorHeap* ppHeaps[] = { d3dResources.srvDescHeap, d3dResources.samplerDescHeap };
+                cmdList->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+
+                // Set the root signature
+                cmdList->SetComputeRootSignature(d3dResources.rootSignature);
+
+                // Update the global root constants
+                UINT offset = 0;
+                GlobalConstants consts = d3dResources.constants;
+                cmdList->SetComputeRoot32BitConstants(0, AppConsts::GetNum32BitValues(), consts.app.GetData(), offset);
+                offset += AppConsts::GetAlignedNum32BitValues();
+                cmdList->SetComputeRoot32BitConstants(0, PathTraceConsts::GetNum32BitValues(), consts.pt.GetData(), offset);
+                offset += PathTraceConsts::GetAlignedNum32BitValues();
+                cmdList->SetComputeRoot32BitConstants(0, LightingConsts::GetNum32BitValues(), consts.lights.GetData(), offset);
+
+                // Set DDGIRootConstants for the volume
+                cmdList->SetComputeRoot32BitConstants(1, DDGIRootConstants::GetNum32BitValues(), volume->GetRootConstants().GetData(), 0);
+
+                // Set the root parameter descriptor tables
+            #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
+                cmdList->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
+                cmdList->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
+            #endif
+
+                // Set the PSO
+                cmdList->SetPipelineState(resources.probeTracePSO);
 
                 // Dispatch threads with new pattern: (RayGroupsPerProbe, NumProbes, 1)
                 // This ensures ALL rays per probe are traced (not just 64)
@@ -1394,101 +2877,276 @@ namespace Graphics
                 UINT numProbes = ProbesCount.x * ProbesCount.y * ProbesCount.z;
                 UINT raysPerProbe = volume->GetNumRaysPerProbe();
                 UINT rayGroupsPerProbe = (raysPerProbe + 63) / 64;
-                d3d.cmdList[d3d.frameIndex]->Dispatch(rayGroupsPerProbe, numProbes, 1);
+                if (d3d.DDGIBatchProbeTrace)
+                {
+                    // Trace every batched volume: (MaxRayGroupsPerProbe, TotalProbes, 1), see UploadProbeTraceBatch()
+                    if (resources.ProbeTraceBatchProbes > 0) cmdList->Dispatch(resources.ProbeTraceBatchRayGroups, resources.ProbeTraceBatchProbes, 1);
+                }
+                else if (volume->GetProbeSchedulingEnabled())
+                {
+                    // Trace only the probes scheduled this frame: (RayGroupsPerProbe, NumScheduledProbes, 1), see ScheduleDDGIVolumeProbes()
+                    cmdList->ExecuteIndirect(volume->GetProbeScheduleCommandSignature(), 1, volume->GetProbeScheduleArgs(), RTXGI_DDGI_PROBE_SCHEDULE_TRACE_ARGS_OFFSET, nullptr, 0);
+                }
+                else
+                {
+                    cmdList->Dispatch(rayGroupsPerProbe, numProbes, 1);
+                }
 
-                // Wait for the compute pass to finish - barrier on ProbeRayHitMap and HitCaching
-                D3D12_RESOURCE_BARRIER barriers[2] = {};
+                // Wait for the compute pass to finish - barrier on ProbeRayHitMap, HitCaching, and the work list
+                D3D12_RESOURCE_BARRIER barriers[4] = {};
                 barriers[0].Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
                 barriers[0].UAV.pResource = resources.HitCachingResource;
                 barriers[1].Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
                 barriers[1].UAV.pResource = resources.ProbeRayHitMapResource;
-                d3d.cmdList[d3d.frameIndex]->ResourceBarrier(2, barriers);
+                barriers[2].Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+                barriers[2].UAV.pResource = resources.RadianceCacheWorkListResource;
+                barriers[3].Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+                barriers[3].UAV.pResource = resources.RadianceCacheWorkListArgsResource;
+                cmdList->ResourceBarrier(4, barriers);
 
             #ifdef GFX_PERF_MARKERS
-                PIXEndEvent(d3d.cmdList[d3d.frameIndex]);
+                PIXEndEvent(cmdList);
             #endif
             }
 
-            void RayTraceRadianceCacheCS(Globals& d3d, GlobalResources& d3dResources, Resources& resources)
+            void RayTraceRadianceCacheCS(Globals& d3d, GlobalResources& d3dResources, Resources& resources, ID3D12GraphicsCommandList4* cmdList)
             {
             #ifdef GFX_PERF_MARKERS
-                PIXBeginEvent(d3d.cmdList[d3d.frameIndex], PIX_COLOR(GFX_PERF_MARKER_GREEN), "Ray Trace Radiance Cache CS");
+                PIXBeginEvent(cmdList, PIX_COLOR(GFX_PERF_MARKER_GREEN), "Ray Trace Radiance Cache CS");
             #endif
 
                 // Set the descriptor heaps
                 ID3D12DescriptorHeap* ppHeaps[] = { d3dResources.srvDescHeap, d3dResources.samplerDescHeap };
-                d3d.cmdList[d3d.frameIndex]->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+                cmdList->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
 
                 // Set the root signature
-                d3d.cmdList[d3d.frameIndex]->SetComputeRootSignature(d3dResources.rootSignature);
+                cmdList->SetComputeRootSignature(d3dResources.rootSignature);
 
                 // Update the root constants
                 UINT offset = 0;
                 GlobalConstants consts = d3dResources.constants;
-                d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(0, AppConsts::GetNum32BitValues(), consts.app.GetData(), offset);
+                cmdList->SetComputeRoot32BitConstants(0, AppConsts::GetNum32BitValues(), consts.app.GetData(), offset);
                 offset += AppConsts::GetAlignedNum32BitValues();
-                d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(0, PathTraceConsts::GetNum32BitValues(), consts.pt.GetData(), offset);
+                cmdList->SetComputeRoot32BitConstants(0, PathTraceConsts::GetNum32BitValues(), consts.pt.GetData(), offset);
                 offset += PathTraceConsts::GetAlignedNum32BitValues();
-                d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(0, LightingConsts::GetNum32BitValues(), consts.lights.GetData(), offset);
+                cmdList->SetComputeRoot32BitConstants(0, LightingConsts::GetNum32BitValues(), consts.lights.GetData(), offset);
 
                 // Set the root parameter descriptor tables
             #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
-                d3d.cmdList[d3d.frameIndex]->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
-                d3d.cmdList[d3d.frameIndex]->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
+                cmdList->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
+                cmdList->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
             #endif
 
-                // Set the compute PSO (inline ray tracing)
-                d3d.cmdList[d3d.frameIndex]->SetPipelineState(resources.radianceCachePSO);
+                // Rebuild the world-space light grid the radiance cache shading reads its spot and point lights from
+                if (d3d.RadianceCacheLightGrid)
+                {
+                    DDGI_STAGE_TIMESTAMP_BEGIN(resources.radianceCacheLightGridStat);
+                    D3D12_RESOURCE_BARRIER lightGridBarrier = {};
+                    lightGridBarrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+                    lightGridBarrier.UAV.pResource = resources.LightGridResource;
+
+                    // LightGridCS::BoundsCS is a single group, BuildCS uses [numthreads(4, 4, 4)]
+                    cmdList->SetPipelineState(resources.lightGridBoundsPSO);
+                    cmdList->Dispatch(1, 1, 1);
+                    cmdList->ResourceBarrier(1, &lightGridBarrier);
+
+                    UINT groups = DivRoundUp(d3d.LightGridDim, 4);
+                    cmdList->SetPipelineState(resources.lightGridBuildPSO);
+                    cmdList->Dispatch(groups, groups, groups);
+                    cmdList->ResourceBarrier(1, &lightGridBarrier);
+                    DDGI_STAGE_TIMESTAMP_END(resources.radianceCacheLightGridStat);
+                }
 
-                // Dispatch compute threads for radiance cache
-                // RadianceCacheCS uses [numthreads(64, 1, 1)], so we need CascadeCellNum / 64 groups
-                UINT numGroups = (resources.CascadeCellNum + 63) / 64;
-                d3d.cmdList[d3d.frameIndex]->Dispatch(numGroups, 1, 1);
+                // Build the indirect dispatch arguments from the slots ProbeTraceCS appended to the work list
+                DDGI_STAGE_TIMESTAMP_BEGIN(resources.radianceCacheWorkListStat);
+                cmdList->SetPipelineState(resources.radianceCacheWorkListArgsPSO);
+                cmdList->Dispatch(1, 1, 1);
 
-                // Wait for the compute pass to finish
-                D3D12_RESOURCE_BARRIER barrier = {};
-                barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
-                barrier.UAV.pResource = resources.RadianceCachingResource;
-                d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+                // Wait for the arguments (and work list padding), then transition the arguments for ExecuteIndirect
+                D3D12_RESOURCE_BARRIER barriers[3] = {};
+                barriers[0].Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+                barriers[0].UAV.pResource = resources.RadianceCacheWorkListResource;
+                barriers[1].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+                barriers[1].Transition.pResource = resources.RadianceCacheWorkListArgsResource;
+                barriers[1].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+                barriers[1].Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                barriers[1].Transition.StateAfter = D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT;
+                barriers[2].Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+                barriers[2].UAV.pResource = resources.RadianceCacheSortBinsResource;
+                cmdList->ResourceBarrier(3, barriers);
+                DDGI_STAGE_TIMESTAMP_END(resources.radianceCacheWorkListStat);
+
+                // Rank the listed slots by age and volatility, and pick the ones that fit in this frame's ray budget
+                if (d3d.RadianceCacheRayBudget > 0)
+                {
+                #ifdef GFX_PERF_MARKERS
+                    PIXBeginEvent(cmdList, PIX_COLOR(GFX_PERF_MARKER_GREEN), "Radiance Cache Update Budget");
+                #endif
+                    DDGI_STAGE_TIMESTAMP_BEGIN(resources.radianceCacheBudgetStat);
+                    D3D12_RESOURCE_BARRIER budgetBarrier = {};
+                    budgetBarrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+                    budgetBarrier.UAV.pResource = resources.RadianceCacheBudgetResource;
+                    cmdList->ResourceBarrier(1, &budgetBarrier);
+
+                    cmdList->SetPipelineState(resources.radianceCacheBudgetHistogramPSO);
+                    cmdList->ExecuteIndirect(resources.radianceCacheCommandSignature, 1, resources.RadianceCacheWorkListArgsResource, 0, nullptr, 0);
+                    cmdList->ResourceBarrier(1, &budgetBarrier);
+
+                    cmdList->SetPipelineState(resources.radianceCacheBudgetThresholdPSO);
+                    cmdList->Dispatch(1, 1, 1);
+                    cmdList->ResourceBarrier(1, &budgetBarrier);
+                    DDGI_STAGE_TIMESTAMP_END(resources.radianceCacheBudgetStat);
+                #ifdef GFX_PERF_MARKERS
+                    PIXEndEvent(cmdList);
+                #endif
+                }
+
+                // Order the work list by (InstanceIndex, GeometryIndex) so neighbouring lanes shade the same material
+                if (d3d.RadianceCacheSortHits)
+                {
+                #ifdef GFX_PERF_MARKERS
+                    PIXBeginEvent(cmdList, PIX_COLOR(GFX_PERF_MARKER_GREEN), "Sort Radiance Cache Work List");
+                #endif
+                    DDGI_STAGE_TIMESTAMP_BEGIN(resources.radianceCacheSortStat);
+                    D3D12_RESOURCE_BARRIER sortBarrier = {};
+                    sortBarrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+                    sortBarrier.UAV.pResource = resources.RadianceCacheSortBinsResource;
+
+                    cmdList->SetPipelineState(resources.radianceCacheSortHistogramPSO);
+                    cmdList->ExecuteIndirect(resources.radianceCacheCommandSignature, 1, resources.RadianceCacheWorkListArgsResource, 0, nullptr, 0);
+                    cmdList->ResourceBarrier(1, &sortBarrier);
+
+                    cmdList->SetPipelineState(resources.radianceCacheSortPrefixSumPSO);
+                    cmdList->Dispatch(1, 1, 1);
+                    cmdList->ResourceBarrier(1, &sortBarrier);
+
+                    cmdList->SetPipelineState(resources.radianceCacheSortScatterPSO);
+                    cmdList->ExecuteIndirect(resources.radianceCacheCommandSignature, 1, resources.RadianceCacheWorkListArgsResource, 0, nullptr, 0);
+
+                    sortBarrier.UAV.pResource = resources.RadianceCacheSortedWorkListResource;
+                    cmdList->ResourceBarrier(1, &sortBarrier);
+                    DDGI_STAGE_TIMESTAMP_END(resources.radianceCacheSortStat);
+                #ifdef GFX_PERF_MARKERS
+                    PIXEndEvent(cmdList);
+                #endif
+                }
+
+                DDGI_STAGE_TIMESTAMP_BEGIN(resources.radianceCacheShadeStat);
+                if (resources.radianceCacheInline)
+                {
+                    // Set the compute PSO (inline ray tracing)
+                    cmdList->SetPipelineState(resources.radianceCachePSO);
+
+                    // Dispatch one thread per work list entry, RadianceCacheCS uses [numthreads(64, 1, 1)]
+                    DDGI_PIPELINE_STATS_BEGIN(cmdList, PASS_RADIANCE_CACHE_SHADE);
+                    cmdList->ExecuteIndirect(resources.radianceCacheCommandSignature, 1, resources.RadianceCacheWorkListArgsResource, 0, nullptr, 0);
+                    DDGI_PIPELINE_STATS_END(cmdList, PASS_RADIANCE_CACHE_SHADE);
+
+                    // Wait for the compute pass to finish, and return the arguments to UAV for next frame's appends
+                    barriers[0].UAV.pResource = resources.RadianceCachingResource;
+                    barriers[1].Transition.StateBefore = D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT;
+                    barriers[1].Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                    cmdList->ResourceBarrier(2, barriers);
+                }
+                else
+                {
+                    // DispatchRays takes no indirect arguments: RadianceCacheRGS reads the group count from the
+                    // arguments buffer, so return it to UAV before the dispatch instead of after
+                    barriers[1].Transition.StateBefore = D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT;
+                    barriers[1].Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                    cmdList->ResourceBarrier(1, &barriers[1]);
+
+                    // Describe the shader table (the radiance cache records follow the DDGI records)
+                    D3D12_DISPATCH_RAYS_DESC desc = {};
+                    desc.RayGenerationShaderRecord.StartAddress = resources.radianceCacheShaderTableRGSStartAddress;
+                    desc.RayGenerationShaderRecord.SizeInBytes = resources.shaderTableRecordSize;
+
+                    desc.MissShaderTable.StartAddress = resources.radianceCacheShaderTableMissTableStartAddress;
+                    desc.MissShaderTable.SizeInBytes = resources.shaderTableRecordSize;
+                    desc.MissShaderTable.StrideInBytes = resources.shaderTableRecordSize;
+
+                    desc.HitGroupTable.StartAddress = resources.radianceCacheShaderTableHitGroupTableStartAddress;
+                    desc.HitGroupTable.SizeInBytes = resources.radianceCacheShaderTableHitGroupTableSize;
+                    desc.HitGroupTable.StrideInBytes = resources.shaderTableRecordSize;
+
+                    // One ray generation thread per cache slot, the threads past the work list return early
+                    desc.Width = resources.CascadeCellNum;
+                    desc.Height = 1;
+                    desc.Depth = 1;
+
+                    // Set the RTPSO (ray tracing pipeline)
+                    cmdList->SetPipelineState1(resources.radianceCacheRTPSO);
+
+                    DDGI_PIPELINE_STATS_BEGIN(cmdList, PASS_RADIANCE_CACHE_SHADE);
+                    cmdList->DispatchRays(&desc);
+                    DDGI_PIPELINE_STATS_END(cmdList, PASS_RADIANCE_CACHE_SHADE);
+
+                    // Wait for the ray tracing pass to finish
+                    barriers[0].UAV.pResource = resources.RadianceCachingResource;
+                    cmdList->ResourceBarrier(1, &barriers[0]);
+                }
+                DDGI_STAGE_TIMESTAMP_END(resources.radianceCacheShadeStat);
 
             #ifdef GFX_PERF_MARKERS
-                PIXEndEvent(d3d.cmdList[d3d.frameIndex]);
+                PIXEndEvent(cmdList);
             #endif
             }
 
-            void ProbeRayResolveCS(Globals& d3d, GlobalResources& d3dResources, Resources& resources, DDGIVolume* volume)
+            /**
+             * Makes the volumes' ray data writes visible to the probe blending.
+             */
+            void ProbeRayDataBarriers(Globals& d3d, const std::vector<DDGIVolume*>& volumes, ID3D12GraphicsCommandList4* cmdList)
+            {
+                if (volumes.empty()) return;
+
+                D3D12_RESOURCE_BARRIER* barriers = d3d.frameArena.Allocate<D3D12_RESOURCE_BARRIER>(volumes.size());
+                for (size_t volumeIndex = 0; volumeIndex < volumes.size(); volumeIndex++)
+                {
+                    barriers[volumeIndex] = {};
+                    barriers[volumeIndex].Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+                    barriers[volumeIndex].UAV.pResource = volumes[volumeIndex]->GetProbeRayData();
+                }
+                cmdList->ResourceBarrier(static_cast<UINT>(volumes.size()), barriers);
+            }
+
+            void ProbeRayResolveCS(Globals& d3d, GlobalResources& d3dResources, Resources& resources, const std::vector<DDGIVolume*>& volumes, ID3D12GraphicsCommandList4* cmdList)
             {
+                // Every selected volume may be converged (or baked)
+                if (volumes.empty()) return;
+
+                const DDGIVolume* volume = volumes[0];
+
             #ifdef GFX_PERF_MARKERS
-                PIXBeginEvent(d3d.cmdList[d3d.frameIndex], PIX_COLOR(GFX_PERF_MARKER_GREEN), "Probe Ray Resolve CS");
+                PIXBeginEvent(cmdList, PIX_COLOR(GFX_PERF_MARKER_GREEN), "Probe Ray Resolve CS");
             #endif
 
                 // Set the descriptor heaps
                 ID3D12DescriptorHeap* ppHeaps[] = { d3dResources.srvDescHeap, d3dResources.samplerDescHeap };
-                d3d.cmdList[d3d.frameIndex]->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+                cmdList->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
 
                 // Set the root signature
-                d3d.cmdList[d3d.frameIndex]->SetComputeRootSignature(d3dResources.rootSignature);
+                cmdList->SetComputeRootSignature(d3dResources.rootSignature);
 
                 // Update the root constants
                 UINT offset = 0;
                 GlobalConstants consts = d3dResources.constants;
-                d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(0, AppConsts::GetNum32BitValues(), consts.app.GetData(), offset);
+                cmdList->SetComputeRoot32BitConstants(0, AppConsts::GetNum32BitValues(), consts.app.GetData(), offset);
                 offset += AppConsts::GetAlignedNum32BitValues();
-                d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(0, PathTraceConsts::GetNum32BitValues(), consts.pt.GetData(), offset);
+                cmdList->SetComputeRoot32BitConstants(0, PathTraceConsts::GetNum32BitValues(), consts.pt.GetData(), offset);
                 offset += PathTraceConsts::GetAlignedNum32BitValues();
-                d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(0, LightingConsts::GetNum32BitValues(), consts.lights.GetData(), offset);
+                cmdList->SetComputeRoot32BitConstants(0, LightingConsts::GetNum32BitValues(), consts.lights.GetData(), offset);
 
                 // Set DDGIRootConstants for the volume
-                d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(1, DDGIRootConstants::GetNum32BitValues(), volume->GetRootConstants().GetData(), 0);
+                cmdList->SetComputeRoot32BitConstants(1, DDGIRootConstants::GetNum32BitValues(), volume->GetRootConstants().GetData(), 0);
 
                 // Set the root parameter descriptor tables
             #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
-                d3d.cmdList[d3d.frameIndex]->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
-                d3d.cmdList[d3d.frameIndex]->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
+                cmdList->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
+                cmdList->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
             #endif
 
                 // Set the compute PSO
-                d3d.cmdList[d3d.frameIndex]->SetPipelineState(resources.probeRayResolvePSO);
+                cmdList->SetPipelineState(resources.probeRayResolvePSO);
 
                 // Calculate total probe rays for this volume
                 int3 probeCounts = volume->GetProbeCounts();
@@ -1498,53 +3156,73 @@ namespace Graphics
 
                 // Dispatch compute threads - ProbeRayResolveCS uses [numthreads(64, 1, 1)]
                 UINT numGroups = (totalProbeRays + 63) / 64;
-                d3d.cmdList[d3d.frameIndex]->Dispatch(numGroups, 1, 1);
+                if (d3d.DDGIBatchProbeTrace)
+                {
+                    // Resolve every batched volume, using the same (MaxRayGroupsPerProbe, TotalProbes, 1) dispatch as the trace
+                    if (resources.ProbeTraceBatchProbes > 0) cmdList->Dispatch(resources.ProbeTraceBatchRayGroups, resources.ProbeTraceBatchProbes, 1);
+                }
+                else if (volume->GetProbeSchedulingEnabled())
+                {
+                    // Resolve only the rays of the scheduled probes, using the same (RayGroupsPerProbe, NumScheduledProbes, 1) arguments as the trace
+                    cmdList->ExecuteIndirect(volume->GetProbeScheduleCommandSignature(), 1, volume->GetProbeScheduleArgs(), RTXGI_DDGI_PROBE_SCHEDULE_TRACE_ARGS_OFFSET, nullptr, 0);
+                }
+                else
+                {
+                    cmdList->Dispatch(numGroups, 1, 1);
+                }
 
                 // Wait for the compute pass to finish
-                D3D12_RESOURCE_BARRIER barrier = {};
-                barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
-                barrier.UAV.pResource = volume->GetProbeRayData();
-                d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+                ProbeRayDataBarriers(d3d, volumes, cmdList);
 
             #ifdef GFX_PERF_MARKERS
-                PIXEndEvent(d3d.cmdList[d3d.frameIndex]);
+                PIXEndEvent(cmdList);
             #endif
             }
 
             void GatherIndirectLighting(Globals& d3d, GlobalResources& d3dResources, Resources& resources)
             {
             #ifdef GFX_PERF_MARKERS
-                PIXBeginEvent(d3d.cmdList[d3d.frameIndex], PIX_COLOR(GFX_PERF_MARKER_GREEN), "Indirect Lighting");
+                PIXBeginEvent(GetCmdList(d3d), PIX_COLOR(GFX_PERF_MARKER_GREEN), "Indirect Lighting");
             #endif
 
                 // Transition the selected volume's irradiance, distance, and data texture arrays from read-write (UAV) to read-only (non-pixel shader)
                 // Note: use PRE_GATHER_PS if using the pixel shader (instead of compute) to gather indirect light
+                // Note: double buffered volumes are sampled through their published textures, the update chain transitions their textures
                 for (UINT volumeIndex = 0; volumeIndex < static_cast<UINT>(resources.selectedVolumes.size()); volumeIndex++)
                 {
                     const DDGIVolume* volume = resources.selectedVolumes[volumeIndex];
-                    volume->TransitionResources(d3d.cmdList[d3d.frameIndex], EDDGIExecutionStage::PRE_GATHER_CS);
+                    if (volume->GetProbeAtlasDoubleBuffered()) continue;
+                    volume->TransitionResources(GetCmdList(d3d), EDDGIExecutionStage::PRE_GATHER_CS);
                 }
 
                 // Set the descriptor heaps
                 ID3D12DescriptorHeap* ppHeaps[] = { d3dResources.srvDescHeap, d3dResources.samplerDescHeap };
-                d3d.cmdList[d3d.frameIndex]->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+                GetCmdList(d3d)->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
 
                 // Set the root signature
-                d3d.cmdList[d3d.frameIndex]->SetComputeRootSignature(d3dResources.rootSignature);
+                GetCmdList(d3d)->SetComputeRootSignature(d3dResources.rootSignature);
 
                 // Set the root parameter descriptor tables
             #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
-                d3d.cmdList[d3d.frameIndex]->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
-                d3d.cmdList[d3d.frameIndex]->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
+                GetCmdList(d3d)->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
+                GetCmdList(d3d)->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
             #endif
 
                 // Set the PSO
-                d3d.cmdList[d3d.frameIndex]->SetPipelineState(resources.indirectPSO);
+                GetCmdList(d3d)->SetPipelineState(resources.indirectPSO);
 
                 // Dispatch threads
-                UINT groupsX = DivRoundUp(d3d.width / d3d.FinalGatherDownScale, 8);
-                UINT groupsY = DivRoundUp(d3d.height / d3d.FinalGatherDownScale, 4);
-                d3d.cmdList[d3d.frameIndex]->Dispatch(groupsX, groupsY, 1);
+                if (GatherOverGBufferTiles(d3d))
+                {
+                    // One thread group per GBuffer tile with geometry, see GBuffer::Execute(...)
+                    GetCmdList(d3d)->ExecuteIndirect(resources.radianceCacheCommandSignature, 1, d3dResources.rt.GBufferTileArgs, 0, nullptr, 0);
+                }
+                else
+                {
+                    UINT groupsX = DivRoundUp(DivRoundUp(d3d.renderWidth, d3d.FinalGatherDownScale), 8);
+                    UINT groupsY = DivRoundUp(DivRoundUp(d3d.renderHeight, d3d.FinalGatherDownScale), 4);
+                    GetCmdList(d3d)->Dispatch(groupsX, groupsY, 1);
+                }
 
                 // Note: if using the pixel shader (instead of compute) to gather indirect light, transition
                 // the selected volume's resources to D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE
@@ -1558,107 +3236,1465 @@ namespace Graphics
                 D3D12_RESOURCE_BARRIER barrier = {};
                 barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
                 barrier.UAV.pResource = resources.output;
-                d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+                GetCmdList(d3d)->ResourceBarrier(1, &barrier);
+
+            #ifdef GFX_PERF_MARKERS
+                PIXEndEvent(GetCmdList(d3d));
+            #endif
+            }
+
+            /**
+             * Evaluate the irradiance of the queries queued since the last frame (see QueueIrradianceQueries()) and copy the
+             * results to the frame's readback buffer. Recorded after the gather, with the volume textures still readable.
+             */
+            void EvaluateIrradianceQueries(Globals& d3d, GlobalResources& d3dResources, Resources& resources)
+            {
+                UINT count = static_cast<UINT>(resources.irradianceQueriesPending.size());
+                UINT size = IRRADIANCE_QUERY_HEADER_SIZE + (count * sizeof(IrradianceQuery));
+
+                // Write the query count and the queries to the frame's upload buffer
+                UINT8* pData = nullptr;
+                D3D12_RANGE readRange = {};
+                if (FAILED(resources.irradianceQueriesUpload[d3d.frameIndex]->Map(0, &readRange, reinterpret_cast<void**>(&pData)))) return;
+                memset(pData, 0, IRRADIANCE_QUERY_HEADER_SIZE);
+                memcpy(pData, &count, sizeof(UINT));
+                memcpy(pData + IRRADIANCE_QUERY_HEADER_SIZE, resources.irradianceQueriesPending.data(), count * sizeof(IrradianceQuery));
+                resources.irradianceQueriesUpload[d3d.frameIndex]->Unmap(0, nullptr);
+
+            #ifdef GFX_PERF_MARKERS
+                PIXBeginEvent(GetCmdList(d3d), PIX_COLOR(GFX_PERF_MARKER_GREEN), "Irradiance Queries");
+            #endif
+
+                // Copy the queries to the queries buffer
+                D3D12_RESOURCE_BARRIER barrier = {};
+                barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+                barrier.Transition.pResource = resources.irradianceQueries;
+                barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
+                barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+                GetCmdList(d3d)->ResourceBarrier(1, &barrier);
+
+                GetCmdList(d3d)->CopyBufferRegion(resources.irradianceQueries, 0, resources.irradianceQueriesUpload[d3d.frameIndex], 0, size);
+
+                barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+                barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                GetCmdList(d3d)->ResourceBarrier(1, &barrier);
+
+                // Set the descriptor heaps
+                ID3D12DescriptorHeap* ppHeaps[] = { d3dResources.srvDescHeap, d3dResources.samplerDescHeap };
+                GetCmdList(d3d)->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+
+                // Set the root signature
+                GetCmdList(d3d)->SetComputeRootSignature(d3dResources.rootSignature);
+
+                // Set the root parameter descriptor tables
+            #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
+                GetCmdList(d3d)->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
+                GetCmdList(d3d)->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
+            #endif
+
+                // Set the PSO and dispatch threads, one per query
+                GetCmdList(d3d)->SetPipelineState(resources.irradianceQueryPSO);
+                GetCmdList(d3d)->Dispatch(DivRoundUp(count, 64), 1, 1);
+
+                // Copy the results to the frame's readback buffer
+                barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
+                GetCmdList(d3d)->ResourceBarrier(1, &barrier);
+
+                GetCmdList(d3d)->CopyBufferRegion(resources.irradianceQueriesReadback[d3d.frameIndex], 0, resources.irradianceQueries, 0, size);
+
+                barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE;
+                barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                GetCmdList(d3d)->ResourceBarrier(1, &barrier);
+
+            #ifdef GFX_PERF_MARKERS
+                PIXEndEvent(GetCmdList(d3d));
+            #endif
+
+                // The batches are called back when the frame's readback buffer is reused (the emptied in flight list becomes the pending list)
+                resources.irradianceQueryBatches[d3d.frameIndex].swap(resources.irradianceQueryBatchesPending);
+                resources.irradianceQueriesPending.clear();
+            }
+
+            /**
+             * Copy a probe delta header or packet from the frame's upload buffer to the probe deltas buffer, and set the
+             * descriptor heaps and root signature of the probe delta dispatch.
+             */
+            void UploadProbeDeltas(Globals& d3d, GlobalResources& d3dResources, Resources& resources, UINT size)
+            {
+                D3D12_RESOURCE_BARRIER barrier = {};
+                barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+                barrier.Transition.pResource = resources.probeDeltas;
+                barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
+                barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+                GetCmdList(d3d)->ResourceBarrier(1, &barrier);
+
+                GetCmdList(d3d)->CopyBufferRegion(resources.probeDeltas, 0, resources.probeDeltasUpload[d3d.frameIndex], 0, size);
+
+                barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+                barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                GetCmdList(d3d)->ResourceBarrier(1, &barrier);
+
+                // Set the descriptor heaps
+                ID3D12DescriptorHeap* ppHeaps[] = { d3dResources.srvDescHeap, d3dResources.samplerDescHeap };
+                GetCmdList(d3d)->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+
+                // Set the root signature
+                GetCmdList(d3d)->SetComputeRootSignature(d3dResources.rootSignature);
+
+                // Set the root parameter descriptor tables
+            #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
+                GetCmdList(d3d)->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
+                GetCmdList(d3d)->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
+            #endif
+            }
+
+            /**
+             * Write the tiles of the oldest queued probe delta packet (see QueueProbeDeltaImport()) to its volume's probe textures.
+             * Recorded before the probe updates, with the volume textures between frames (readable).
+             */
+            void ImportProbeDeltas(Globals& d3d, GlobalResources& d3dResources, Resources& resources)
+            {
+                ProbeDeltaImport& probeDeltaImport = resources.probeDeltaImportsPending.front();
+                const ProbeDeltaVolume& deltaVolume = resources.probeDeltaVolumes[probeDeltaImport.volumeIndex];
+                DDGIVolume* volume = static_cast<DDGIVolume*>(resources.volumes[probeDeltaImport.volumeIndex]);
+
+                // The sender's volume index and tile layout are replaced by the volume's own
+                ProbeDeltaHeader header;
+                memcpy(&header, probeDeltaImport.packet.data(), sizeof(ProbeDeltaHeader));
+                header.volumeIndex = volume->GetIndex();
+                header.threshold = 0.f;
+                header.referenceOffset = deltaVolume.referenceOffset;
+                header.probeCount = deltaVolume.probeCount;
+                header.maxTiles = PROBE_DELTA_MAX_TILES;
+                UINT size = static_cast<UINT>(probeDeltaImport.packet.size());
+
+                // Write the packet to the frame's upload buffer
+                UINT8* pData = nullptr;
+                D3D12_RANGE readRange = {};
+                if (SUCCEEDED(resources.probeDeltasUpload[d3d.frameIndex]->Map(0, &readRange, reinterpret_cast<void**>(&pData))))
+                {
+                    memcpy(pData, probeDeltaImport.packet.data(), size);
+                    memcpy(pData, &header, sizeof(ProbeDeltaHeader));
+                    resources.probeDeltasUpload[d3d.frameIndex]->Unmap(0, nullptr);
+
+                #ifdef GFX_PERF_MARKERS
+                    PIXBeginEvent(GetCmdList(d3d), PIX_COLOR(GFX_PERF_MARKER_GREEN), "Probe Delta Import");
+                #endif
+
+                    UploadProbeDeltas(d3d, d3dResources, resources, size);
+
+                    // Transition the probe textures to unordered access
+                    ID3D12Resource* textures[] = { volume->GetProbeIrradiance(), volume->GetProbeDistance(), volume->GetProbeData() };
+                    D3D12_RESOURCE_BARRIER barriers[_countof(textures)] = {};
+                    for (UINT textureIndex = 0; textureIndex < _countof(textures); textureIndex++)
+                    {
+                        barriers[textureIndex].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+                        barriers[textureIndex].Transition.pResource = textures[textureIndex];
+                        barriers[textureIndex].Transition.StateBefore = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+                        barriers[textureIndex].Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                        barriers[textureIndex].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+                    }
+                    GetCmdList(d3d)->ResourceBarrier(_countof(barriers), barriers);
+
+                    // Set the PSO and dispatch thread groups, one per tile
+                    GetCmdList(d3d)->SetPipelineState(resources.probeDeltaImportPSO);
+                    GetCmdList(d3d)->Dispatch(PROBE_DELTA_GROUPS_X, DivRoundUp(header.tileCount, PROBE_DELTA_GROUPS_X), 1);
+
+                    // Transition the probe textures back
+                    for (D3D12_RESOURCE_BARRIER& barrier : barriers) std::swap(barrier.Transition.StateBefore, barrier.Transition.StateAfter);
+                    GetCmdList(d3d)->ResourceBarrier(_countof(barriers), barriers);
+
+                #ifdef GFX_PERF_MARKERS
+                    PIXEndEvent(GetCmdList(d3d));
+                #endif
+                }
+
+                resources.probeDeltaImportsPending.erase(resources.probeDeltaImportsPending.begin());
+            }
+
+            /**
+             * Export the changed probe tiles of the oldest queued probe delta export (see QueueProbeDeltaExport()) and copy the
+             * packet to the frame's readback buffer. Recorded after the gather, with the volume textures still readable.
+             */
+            void ExportProbeDeltas(Globals& d3d, GlobalResources& d3dResources, Resources& resources)
+            {
+                ProbeDeltaExport& probeDeltaExport = resources.probeDeltaExportsPending.front();
+                const ProbeDeltaVolume& deltaVolume = resources.probeDeltaVolumes[probeDeltaExport.volumeIndex];
+                DDGIVolume* volume = static_cast<DDGIVolume*>(resources.volumes[probeDeltaExport.volumeIndex]);
+
+                ProbeDeltaHeader header = {};
+                header.volumeIndex = volume->GetIndex();
+                header.threshold = probeDeltaExport.threshold;
+                header.tileStride = deltaVolume.tileStride;
+                header.referenceOffset = deltaVolume.referenceOffset;
+                header.probeCount = deltaVolume.probeCount;
+                header.maxTiles = PROBE_DELTA_MAX_TILES;
+
+                // Write the header to the frame's upload buffer
+                UINT8* pData = nullptr;
+                D3D12_RANGE readRange = {};
+                if (FAILED(resources.probeDeltasUpload[d3d.frameIndex]->Map(0, &readRange, reinterpret_cast<void**>(&pData)))) return;
+                memcpy(pData, &header, sizeof(ProbeDeltaHeader));
+                resources.probeDeltasUpload[d3d.frameIndex]->Unmap(0, nullptr);
+
+            #ifdef GFX_PERF_MARKERS
+                PIXBeginEvent(GetCmdList(d3d), PIX_COLOR(GFX_PERF_MARKER_GREEN), "Probe Delta Export");
+            #endif
+
+                UploadProbeDeltas(d3d, d3dResources, resources, PROBE_DELTA_HEADER_SIZE);
+
+                // Set the PSO and dispatch thread groups, one per probe
+                GetCmdList(d3d)->SetPipelineState(resources.probeDeltaExportPSO);
+                GetCmdList(d3d)->Dispatch(PROBE_DELTA_GROUPS_X, DivRoundUp(deltaVolume.probeCount, PROBE_DELTA_GROUPS_X), 1);
+
+                // Copy the packet to the frame's readback buffer
+                D3D12_RESOURCE_BARRIER barrier = {};
+                barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+                barrier.Transition.pResource = resources.probeDeltas;
+                barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
+                barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+                GetCmdList(d3d)->ResourceBarrier(1, &barrier);
+
+                GetCmdList(d3d)->CopyBufferRegion(resources.probeDeltasReadback[d3d.frameIndex], 0, resources.probeDeltas, 0, resources.probeDeltaPacketSize);
+
+                barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE;
+                barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                GetCmdList(d3d)->ResourceBarrier(1, &barrier);
 
             #ifdef GFX_PERF_MARKERS
-                PIXEndEvent(d3d.cmdList[d3d.frameIndex]);
+                PIXEndEvent(GetCmdList(d3d));
             #endif
+
+                // Called back when the frame's readback buffer is reused
+                resources.probeDeltaExports[d3d.frameIndex] = std::move(probeDeltaExport);
+                resources.probeDeltaExportsPending.erase(resources.probeDeltaExportsPending.begin());
             }
 
             //----------------------------------------------------------------------------------------------------------
-            // Public Functions
+            // DDGIVolume Probe Cache Functions
             //----------------------------------------------------------------------------------------------------------
 
             /**
-             * Create resources used by the DDGI passes.
+             * Get the path of a DDGIVolume's probe cache file (next to the scene's cache file).
              */
-            bool Initialize(Globals& d3d, GlobalResources& d3dResources, Resources& resources, const Configs::Config& config, Instrumentation::Performance& perf, std::ofstream& log)
+            std::string GetDDGIVolumeCachePath(const Configs::Config& config, const DDGIVolume* volume)
             {
-                // Validate the SDK version
-                assert(RTXGI_VERSION::major == 1);
-                assert(RTXGI_VERSION::minor == 3);
-                assert(RTXGI_VERSION::revision == 7);
-                assert(std::strcmp(RTXGI_VERSION::getVersionString(), "1.3.7") == 0);
+                std::string sceneName = config.scene.file.substr(0, config.scene.file.find_last_of('.'));
+                return config.app.root + config.scene.path + sceneName + "-DDGIVolume[" + volume->GetName() + "].cache";
+            }
 
-                UINT numVolumes = static_cast<UINT>(config.ddgi.volumes.size());
-                d3d.NumVolume = numVolumes;
-                resources.CascadeCellNum = d3d.CacheCount * numVolumes;
+            /**
+             * Get the part of a lighting cache key that changes with the scene, its lights and sky.
+             */
+            uint64_t GetSceneLightingCacheKey(const Configs::Config& config, const Scenes::Scene& scene)
+            {
+                uint64_t key = Caches::Hash(config.scene.path.data(), config.scene.path.size());
+                auto hash = [&key](const void* data, size_t size) { key = Caches::Hash(data, size, key); };
 
-                if (!CreateTextures(d3d, d3dResources, resources, log)) return false;
-                if (!LoadAndCompileShaders(d3d, resources, numVolumes, log)) return false;
-                if (!CreatePSOs(d3d, d3dResources, resources, log)) return false;
-                if (!CreateShaderTable(d3d, d3dResources, resources, log)) return false;
-                if (!UpdateShaderTable(d3d, d3dResources, resources, log)) return false;
+                // Scene
+                hash(config.scene.file.data(), config.scene.file.size());
+                hash(&scene.numTriangles, sizeof(scene.numTriangles));
+                hash(&scene.boundingBox, sizeof(rtxgi::AABB));
+
+                // Lights and sky
+                for (const Scenes::Light& light : scene.lights) hash(&light.data, sizeof(Graphics::Light));
+                hash(&config.scene.skyColor, sizeof(DirectX::XMFLOAT3));
+                hash(&config.scene.skyIntensity, sizeof(float));
+
+                return key;
+            }
+
+            /**
+             * Get the key of a DDGIVolume's probe cache.
+             * The key changes with the scene, its lights and sky, and the volume settings that shape the probe textures.
+             */
+            uint64_t GetDDGIVolumeCacheKey(const Configs::Config& config, const Scenes::Scene& scene, const DDGIVolumeDesc& desc)
+            {
+                uint64_t key = GetSceneLightingCacheKey(config, scene);
+                auto hash = [&key](const void* data, size_t size) { key = Caches::Hash(data, size, key); };
+
+                // Volume
+                hash(&desc.origin, sizeof(float3));
+                hash(&desc.eulerAngles, sizeof(float3));
+                hash(&desc.probeSpacing, sizeof(float3));
+                hash(&desc.probeCounts, sizeof(int3));
+                hash(&desc.probeNumRays, sizeof(int));
+                hash(&desc.probeNumIrradianceTexels, sizeof(int));
+                hash(&desc.probeNumDistanceTexels, sizeof(int));
+                hash(&desc.probeMaxRayDistance, sizeof(float));
+                hash(&desc.probeDistanceExponent, sizeof(float));
+                hash(&desc.probeIrradianceEncodingGamma, sizeof(float));
+                hash(&desc.probeIrradianceFormat, sizeof(EDDGIVolumeTextureFormat));
+                hash(&desc.probeDistanceFormat, sizeof(EDDGIVolumeTextureFormat));
+                hash(&desc.probeDataFormat, sizeof(EDDGIVolumeTextureFormat));
+                hash(&desc.probeVariabilityFormat, sizeof(EDDGIVolumeTextureFormat));
+                hash(&desc.probeRelocationEnabled, sizeof(bool));
+                hash(&desc.probeMinFrontfaceDistance, sizeof(float));
+                hash(&desc.probeClassificationEnabled, sizeof(bool));
+                hash(&desc.probeVariabilityEnabled, sizeof(bool));
+
+                return key;
+            }
+
+            /**
+             * Execute a command list recorded outside of the frame and block until the GPU completes it.
+             */
+            bool ExecuteAndWait(Globals& d3d, ID3D12GraphicsCommandList* commandList)
+            {
+                ID3D12Fence* fence = nullptr;
+                D3DCHECK(d3d.device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence)));
+
+                D3DCHECK(commandList->Close());
+                d3d.cmdQueue->ExecuteCommandLists(1, reinterpret_cast<ID3D12CommandList**>(&commandList));
+                D3DCHECK(d3d.cmdQueue->Signal(fence, 1));
+
+                // Block until the copy is complete
+                while (fence->GetCompletedValue() < 1) SwitchToThread();
+
+                SAFE_RELEASE(fence);
+                return true;
+            }
+
+            /**
+             * Copy the texels of a DDGIVolume texture array from the GPU (tightly packed).
+             */
+            bool ReadDDGIVolumeTexture(Globals& d3d, ID3D12Resource* pResource, D3D12_RESOURCE_STATES state, Caches::DDGIVolumeCacheTexture& texture)
+            {
+                const D3D12_RESOURCE_DESC desc = pResource->GetDesc();
+                const UINT numSubresources = desc.DepthOrArraySize;
+
+                // Get the copy footprints of the array slices
+                std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> footprints(numSubresources);
+                UINT numRows;
+                UINT64 rowSizeInBytes;
+                UINT64 sizeInBytes;
+                d3d.device->GetCopyableFootprints(&desc, 0, numSubresources, 0, footprints.data(), &numRows, &rowSizeInBytes, &sizeInBytes);
+
+                // Create the staging (read-back) buffer
+                ID3D12Resource* staging = nullptr;
+                BufferDesc bufferDesc = { sizeInBytes, 0, EHeapType::READBACK, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_FLAG_NONE };
+                if (!CreateBuffer(d3d, bufferDesc, &staging)) return false;
+
+                // Create a command allocator and command list
+                ID3D12CommandAllocator* commandAlloc = nullptr;
+                D3DCHECK(d3d.device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&commandAlloc)));
+
+                ID3D12GraphicsCommandList* commandList = nullptr;
+                D3DCHECK(d3d.device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAlloc, nullptr, IID_PPV_ARGS(&commandList)));
+
+                // Transition the texture to a copy source
+                D3D12_RESOURCE_BARRIER barrier = {};
+                barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+                barrier.Transition.pResource = pResource;
+                barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+                barrier.Transition.StateBefore = state;
+                barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
+                commandList->ResourceBarrier(1, &barrier);
+
+                // Copy the array slices to the staging buffer
+                for (UINT subresourceIndex = 0; subresourceIndex < numSubresources; subresourceIndex++)
+                {
+                    D3D12_TEXTURE_COPY_LOCATION copySrc = {};
+                    copySrc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+                    copySrc.pResource = pResource;
+                    copySrc.SubresourceIndex = subresourceIndex;
+
+                    D3D12_TEXTURE_COPY_LOCATION copyDest = {};
+                    copyDest.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+                    copyDest.pResource = staging;
+                    copyDest.PlacedFootprint = footprints[subresourceIndex];
+
+                    commandList->CopyTextureRegion(&copyDest, 0, 0, 0, &copySrc, nullptr);
+                }
+
+                // Transition the texture back to its state
+                barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE;
+                barrier.Transition.StateAfter = state;
+                commandList->ResourceBarrier(1, &barrier);
+
+                bool result = ExecuteAndWait(d3d, commandList);
+                if (result)
+                {
+                    // Remove the row pitch padding
+                    texture.format = static_cast<uint32_t>(desc.Format);
+                    texture.width = static_cast<uint32_t>(desc.Width);
+                    texture.height = desc.Height;
+                    texture.arraySize = numSubresources;
+                    texture.rowBytes = static_cast<uint32_t>(rowSizeInBytes);
+                    texture.texels.resize(rowSizeInBytes * numRows * numSubresources);
+
+                    UINT8* pData = nullptr;
+                    D3D12_RANGE readRange = { 0, static_cast<size_t>(sizeInBytes) };
+                    D3DCHECK(staging->Map(0, &readRange, reinterpret_cast<void**>(&pData)));
+                    for (UINT subresourceIndex = 0; subresourceIndex < numSubresources; subresourceIndex++)
+                    {
+                        for (UINT rowIndex = 0; rowIndex < numRows; rowIndex++)
+                        {
+                            const UINT8* src = pData + footprints[subresourceIndex].Offset + (rowIndex * footprints[subresourceIndex].Footprint.RowPitch);
+                            uint8_t* dst = texture.texels.data() + ((subresourceIndex * numRows) + rowIndex) * rowSizeInBytes;
+                            memcpy(dst, src, rowSizeInBytes);
+                        }
+                    }
+                    D3D12_RANGE writeRange = { 0, 0 };
+                    staging->Unmap(0, &writeRange);
+                }
+
+                SAFE_RELEASE(commandList);
+                SAFE_RELEASE(commandAlloc);
+                SAFE_RELEASE(staging);
+
+                return result;
+            }
+
+            /**
+             * Whether cached texels match the format and dimensions of a DDGIVolume texture array.
+             */
+            bool GetDDGIVolumeTextureMatches(Globals& d3d, ID3D12Resource* pResource, const Caches::DDGIVolumeCacheTexture& texture)
+            {
+                const D3D12_RESOURCE_DESC desc = pResource->GetDesc();
+
+                UINT numRows;
+                UINT64 rowSizeInBytes;
+                d3d.device->GetCopyableFootprints(&desc, 0, 1, 0, nullptr, &numRows, &rowSizeInBytes, nullptr);
+
+                return (texture.format == static_cast<uint32_t>(desc.Format))
+                    && (texture.width == static_cast<uint32_t>(desc.Width))
+                    && (texture.height == desc.Height)
+                    && (texture.arraySize == desc.DepthOrArraySize)
+                    && (texture.rowBytes == static_cast<uint32_t>(rowSizeInBytes))
+                    && (texture.texels.size() == (rowSizeInBytes * numRows * desc.DepthOrArraySize));
+            }
+
+            /**
+             * Copy the cached texels of a DDGIVolume texture array to the GPU (see GetDDGIVolumeTextureMatches()).
+             */
+            bool WriteDDGIVolumeTexture(Globals& d3d, ID3D12Resource* pResource, D3D12_RESOURCE_STATES state, const Caches::DDGIVolumeCacheTexture& texture)
+            {
+                const D3D12_RESOURCE_DESC desc = pResource->GetDesc();
+                const UINT numSubresources = desc.DepthOrArraySize;
+
+                // Get the copy footprints of the array slices
+                std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> footprints(numSubresources);
+                UINT numRows;
+                UINT64 rowSizeInBytes;
+                UINT64 sizeInBytes;
+                d3d.device->GetCopyableFootprints(&desc, 0, numSubresources, 0, footprints.data(), &numRows, &rowSizeInBytes, &sizeInBytes);
+
+                // Create the upload buffer and copy the texels to it, adding the row pitch padding
+                ID3D12Resource* upload = nullptr;
+                BufferDesc bufferDesc = { sizeInBytes, 0, EHeapType::UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE };
+                if (!CreateBuffer(d3d, bufferDesc, &upload)) return false;
+
+                UINT8* pData = nullptr;
+                D3D12_RANGE readRange = { 0, 0 };
+                D3DCHECK(upload->Map(0, &readRange, reinterpret_cast<void**>(&pData)));
+                for (UINT subresourceIndex = 0; subresourceIndex < numSubresources; subresourceIndex++)
+                {
+                    for (UINT rowIndex = 0; rowIndex < numRows; rowIndex++)
+                    {
+                        const uint8_t* src = texture.texels.data() + ((subresourceIndex * numRows) + rowIndex) * rowSizeInBytes;
+                        UINT8* dst = pData + footprints[subresourceIndex].Offset + (rowIndex * footprints[subresourceIndex].Footprint.RowPitch);
+                        memcpy(dst, src, rowSizeInBytes);
+                    }
+                }
+                upload->Unmap(0, nullptr);
+
+                // Create a command allocator and command list
+                ID3D12CommandAllocator* commandAlloc = nullptr;
+                D3DCHECK(d3d.device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&commandAlloc)));
+
+                ID3D12GraphicsCommandList* commandList = nullptr;
+                D3DCHECK(d3d.device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAlloc, nullptr, IID_PPV_ARGS(&commandList)));
+
+                // Transition the texture to a copy destination
+                D3D12_RESOURCE_BARRIER barrier = {};
+                barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+                barrier.Transition.pResource = pResource;
+                barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+                barrier.Transition.StateBefore = state;
+                barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
+                commandList->ResourceBarrier(1, &barrier);
+
+                // Copy the array slices from the upload buffer
+                for (UINT subresourceIndex = 0; subresourceIndex < numSubresources; subresourceIndex++)
+                {
+                    D3D12_TEXTURE_COPY_LOCATION copySrc = {};
+                    copySrc.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+                    copySrc.pResource = upload;
+                    copySrc.PlacedFootprint = footprints[subresourceIndex];
+
+                    D3D12_TEXTURE_COPY_LOCATION copyDest = {};
+                    copyDest.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+                    copyDest.pResource = pResource;
+                    copyDest.SubresourceIndex = subresourceIndex;
+
+                    commandList->CopyTextureRegion(&copyDest, 0, 0, 0, &copySrc, nullptr);
+                }
+
+                // Transition the texture back to its state
+                barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+                barrier.Transition.StateAfter = state;
+                commandList->ResourceBarrier(1, &barrier);
+
+                bool result = ExecuteAndWait(d3d, commandList);
+
+                SAFE_RELEASE(commandList);
+                SAFE_RELEASE(commandAlloc);
+                SAFE_RELEASE(upload);
+
+                return result;
+            }
+
+            //----------------------------------------------------------------------------------------------------------
+            // Radiance Cache File Functions
+            //----------------------------------------------------------------------------------------------------------
+
+            /**
+             * Get the path of the scene's radiance cache file (next to the scene's cache file).
+             */
+            std::string GetRadianceCachePath(const Configs::Config& config)
+            {
+                std::string sceneName = config.scene.file.substr(0, config.scene.file.find_last_of('.'));
+                return config.app.root + config.scene.path + sceneName + "-RadianceCache.cache";
+            }
+
+            /**
+             * Get the key of the radiance cache file.
+             * The key changes with the scene, its lights and sky, and the settings that place cells in the hash table or shape their radiance.
+             * Cell keys are hashed from world-space positions (see SpatialHash.hlsl), so the cells don't depend on the camera.
+             */
+            uint64_t GetRadianceCacheKey(Globals& d3d, const Configs::Config& config, const Scenes::Scene& scene, const Resources& resources)
+            {
+                uint64_t key = GetSceneLightingCacheKey(config, scene);
+                auto hash = [&key](const void* data, size_t size) { key = Caches::Hash(data, size, key); };
+
+                hash(&resources.CascadeCellNum, sizeof(UINT));
+                hash(&d3d.CascadeCellRadius, sizeof(float));
+                hash(&d3d.CascadeDistance, sizeof(float));
+                hash(&d3d.RadianceCacheRadianceFormat, sizeof(UINT));
+                hash(&d3d.RadianceCacheCascadeMode, sizeof(UINT));
+                hash(&d3d.RadianceCacheHashFunction, sizeof(UINT));
+                hash(&d3d.RadianceCacheBrickLayout, sizeof(bool));
+                hash(&d3d.RadianceCacheIndirectFromProbes, sizeof(bool));
+
+                return key;
+            }
+
+            /**
+             * Copy the contents of a buffer from the GPU.
+             */
+            bool ReadRadianceCacheBuffer(Globals& d3d, ID3D12Resource* pResource, std::vector<uint8_t>& data)
+            {
+                const UINT64 sizeInBytes = pResource->GetDesc().Width;
+
+                // Create the staging (read-back) buffer
+                ID3D12Resource* staging = nullptr;
+                BufferDesc bufferDesc = { sizeInBytes, 0, EHeapType::READBACK, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_FLAG_NONE };
+                if (!CreateBuffer(d3d, bufferDesc, &staging)) return false;
+
+                // Create a command allocator and command list
+                ID3D12CommandAllocator* commandAlloc = nullptr;
+                D3DCHECK(d3d.device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&commandAlloc)));
+
+                ID3D12GraphicsCommandList* commandList = nullptr;
+                D3DCHECK(d3d.device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAlloc, nullptr, IID_PPV_ARGS(&commandList)));
+
+                // The radiance cache buffers stay in the unordered access state
+                D3D12_RESOURCE_BARRIER barrier = {};
+                barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+                barrier.Transition.pResource = pResource;
+                barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+                barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
+                commandList->ResourceBarrier(1, &barrier);
+
+                commandList->CopyBufferRegion(staging, 0, pResource, 0, sizeInBytes);
+
+                barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE;
+                barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                commandList->ResourceBarrier(1, &barrier);
+
+                bool result = ExecuteAndWait(d3d, commandList);
+                if (result)
+                {
+                    data.resize(sizeInBytes);
+
+                    UINT8* pData = nullptr;
+                    D3D12_RANGE readRange = { 0, static_cast<size_t>(sizeInBytes) };
+                    D3DCHECK(staging->Map(0, &readRange, reinterpret_cast<void**>(&pData)));
+                    memcpy(data.data(), pData, sizeInBytes);
+                    D3D12_RANGE writeRange = { 0, 0 };
+                    staging->Unmap(0, &writeRange);
+                }
+
+                SAFE_RELEASE(commandList);
+                SAFE_RELEASE(commandAlloc);
+                SAFE_RELEASE(staging);
+
+                return result;
+            }
+
+            /**
+             * Copy the contents of a buffer to the GPU (data holds the whole buffer).
+             */
+            bool WriteRadianceCacheBuffer(Globals& d3d, ID3D12Resource* pResource, const std::vector<uint8_t>& data)
+            {
+                const UINT64 sizeInBytes = pResource->GetDesc().Width;
+                if (data.size() != sizeInBytes) return false;
+
+                // Create the upload buffer and copy the data to it
+                ID3D12Resource* upload = nullptr;
+                BufferDesc bufferDesc = { sizeInBytes, 0, EHeapType::UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE };
+                if (!CreateBuffer(d3d, bufferDesc, &upload)) return false;
+
+                UINT8* pData = nullptr;
+                D3D12_RANGE readRange = { 0, 0 };
+                D3DCHECK(upload->Map(0, &readRange, reinterpret_cast<void**>(&pData)));
+                memcpy(pData, data.data(), sizeInBytes);
+                upload->Unmap(0, nullptr);
+
+                // Create a command allocator and command list
+                ID3D12CommandAllocator* commandAlloc = nullptr;
+                D3DCHECK(d3d.device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&commandAlloc)));
+
+                ID3D12GraphicsCommandList* commandList = nullptr;
+                D3DCHECK(d3d.device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAlloc, nullptr, IID_PPV_ARGS(&commandList)));
+
+                D3D12_RESOURCE_BARRIER barrier = {};
+                barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+                barrier.Transition.pResource = pResource;
+                barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+                barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
+                commandList->ResourceBarrier(1, &barrier);
+
+                commandList->CopyBufferRegion(pResource, 0, upload, 0, sizeInBytes);
+
+                barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+                barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                commandList->ResourceBarrier(1, &barrier);
+
+                bool result = ExecuteAndWait(d3d, commandList);
+
+                SAFE_RELEASE(commandList);
+                SAFE_RELEASE(commandAlloc);
+                SAFE_RELEASE(upload);
+
+                return result;
+            }
+
+
+            //----------------------------------------------------------------------------------------------------------
+            // DDGIVolume Baked Irradiance Functions
+            //----------------------------------------------------------------------------------------------------------
+
+            /**
+             * Point the volume's bindless irradiance SRV index at the given Texture2DArray SRV (relative to SRV_TEX2DARRAY_START).
+             */
+            void SetDDGIVolumeIrradianceSRVIndex(DDGIVolume* volume, UINT srvIndex)
+            {
+            #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_DESCRIPTOR_HEAP
+                volume->SetResourceDescriptorHeapIndex(EDDGIVolumeTextureType::Irradiance, EResourceViewType::SRV, DescriptorHeapOffsets::SRV_TEX2DARRAY_START + srvIndex);
+            #else
+                DDGIVolumeResourceIndices resourceIndices = volume->GetResourceIndices();
+                resourceIndices.probeIrradianceSRVIndex = srvIndex;
+                volume->SetResourceIndices(resourceIndices);
+            #endif
+            }
+
+            /**
+             * Compress a converged volume's irradiance to BC6H and point the volume's irradiance SRV at the compressed copy.
+             * The volume is frozen (no longer updated) while baked. Its irradiance texture array is kept, it is what
+             * the probe caches and debug output store, and what the volume returns to when it is unbaked.
+             * Note: requires GPU texture compression, bindless resources, a volume that doesn't scroll, and 4x4 aligned irradiance texture dimensions.
+             */
+            bool BakeDDGIVolumeIrradiance(Globals& d3d, GlobalResources& d3dResources, Resources& resources, UINT volumeIndex)
+            {
+            #if defined(GPU_COMPRESSION) && RTXGI_DDGI_BINDLESS_RESOURCES
+                DDGIVolume* volume = static_cast<DDGIVolume*>(resources.volumes[volumeIndex]);
+
+                // Scrolling volumes move their probes, their irradiance can't be frozen
+                if (volume->GetMovementType() == EDDGIVolumeMovementType::Scrolling) return false;
+
+                // Copy the irradiance from the GPU
+                Caches::DDGIVolumeCacheTexture irradiance;
+                if (!ReadDDGIVolumeTexture(d3d, volume->GetProbeIrradiance(), D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, irradiance)) return false;
+
+                // Compress the array slices (on the GPU, with DirectXTex)
+                Caches::DDGIVolumeCacheTexture compressed;
+                compressed.format = static_cast<uint32_t>(DXGI_FORMAT_BC6H_UF16);
+                compressed.width = irradiance.width;
+                compressed.height = irradiance.height;
+                compressed.arraySize = irradiance.arraySize;
+                compressed.rowBytes = (irradiance.width / 4) * 16;
+
+                size_t sliceBytes = static_cast<size_t>(irradiance.rowBytes) * irradiance.height;
+                for (uint32_t slice = 0; slice < irradiance.arraySize; slice++)
+                {
+                    const uint8_t* texels = irradiance.texels.data() + (slice * sliceBytes);
+                    if (!Textures::CompressBC6H(irradiance.width, irradiance.height, irradiance.format, irradiance.rowBytes, texels, compressed.texels)) return false;
+                }
+
+                // Create the compressed texture array and copy the blocks to it
+                ID3D12Resource* texture = nullptr;
+                TextureDesc desc = { compressed.width, compressed.height, compressed.arraySize, 1, DXGI_FORMAT_BC6H_UF16, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_FLAG_NONE };
+                if (!CreateTexture(d3d, desc, &texture)) return false;
+            #ifdef GFX_NAME_OBJECTS
+                std::wstring name = L"DDGIVolume[" + std::to_wstring(volume->GetIndex()) + L"], Baked Probe Irradiance";
+                texture->SetName(name.c_str());
+            #endif
+
+                if (!GetDDGIVolumeTextureMatches(d3d, texture, compressed) || !WriteDDGIVolumeTexture(d3d, texture, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, compressed))
+                {
+                    SAFE_RELEASE(texture);
+                    return false;
+                }
+
+                // Create the compressed texture array's SRV
+                UINT heapIndex = DescriptorHeapOffsets::SRV_DDGI_VOLUME_BAKED_IRRADIANCE + volume->GetIndex();
+
+                D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+                srvDesc.Format = DXGI_FORMAT_BC6H_UF16;
+                srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2DARRAY;
+                srvDesc.Texture2DArray.ArraySize = compressed.arraySize;
+                srvDesc.Texture2DArray.MipLevels = 1;
+                srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+
+                D3D12_CPU_DESCRIPTOR_HANDLE srvHandle;
+                srvHandle.ptr = d3dResources.srvDescHeapStart.ptr + (heapIndex * d3dResources.srvDescHeapEntrySize);
+                d3d.device->CreateShaderResourceView(texture, &srvDesc, srvHandle);
+
+                // Sample the compressed copy. Frozen volumes aren't selected, so transfer the volume's resource indices now.
+                SetDDGIVolumeIrradianceSRVIndex(volume, heapIndex - DescriptorHeapOffsets::SRV_TEX2DARRAY_START);
+                rtxgi::d3d12::UploadDDGIVolumeResourceIndices(GetCmdList(d3d), d3d.frameIndex, 1, &volume);
+
+                resources.bakedIrradiance[volumeIndex] = texture;
+                return true;
+            #else
+                return false;
+            #endif
+            }
+
+            /**
+             * Point a baked volume's irradiance SRV back at its irradiance texture array and release the BC6H copy.
+             * The volume updates again once it is selected, which also transfers its resource indices.
+             */
+            void UnbakeDDGIVolumeIrradiance(Globals& d3d, Resources& resources, UINT volumeIndex)
+            {
+                if (!resources.bakedIrradiance[volumeIndex]) return;
+
+                DDGIVolume* volume = static_cast<DDGIVolume*>(resources.volumes[volumeIndex]);
+                SetDDGIVolumeIrradianceSRVIndex(volume, (volume->GetIndex() * rtxgi::GetDDGIVolumeNumTex2DArrayDescriptors()) + 1);
+
+                // Frames in flight may still sample the compressed copy
+                Graphics::WaitForGPU(d3d);
+                SAFE_RELEASE(resources.bakedIrradiance[volumeIndex]);
+            }
+
+            //----------------------------------------------------------------------------------------------------------
+            // Public Functions
+            //----------------------------------------------------------------------------------------------------------
+
+            /**
+             * Create resources used by the DDGI passes.
+             */
+            bool Initialize(Globals& d3d, GlobalResources& d3dResources, Resources& resources, const Configs::Config& config, Instrumentation::Performance& perf, std::ofstream& log)
+            {
+                // Validate the SDK version
+                assert(RTXGI_VERSION::major == 1);
+                assert(RTXGI_VERSION::minor == 3);
+                assert(RTXGI_VERSION::revision == 7);
+                assert(std::strcmp(RTXGI_VERSION::getVersionString(), "1.3.7") == 0);
+
+                UINT numVolumes = static_cast<UINT>(config.ddgi.volumes.size());
+                d3d.NumVolume = numVolumes;
+                resources.CascadeCellNum = d3d.CacheCount * numVolumes;
+
+                if (!CreateTextures(d3d, d3dResources, resources, log)) return false;
+                if (!LoadAndCompileShaders(d3d, resources, config.ddgi.volumes, log)) return false;
+                if (!CreatePSOs(d3d, d3dResources, resources, log)) return false;
+                if (!CreateRadianceCachePSOs(d3d, d3dResources, resources, log)) return false;
+                if (!CreateShaderTable(d3d, d3dResources, resources, log)) return false;
+                if (!UpdateShaderTable(d3d, d3dResources, resources, log)) return false;
+
+                // Create the DDGIVolume resource indices structured buffer
+                if (!CreateDDGIVolumeResourceIndicesBuffer(d3d, d3dResources, resources, numVolumes, log)) return false;
+
+                // Create the DDGIVolume constants structured buffer
+                if (!CreateDDGIVolumeConstantsBuffer(d3d, d3dResources, resources, numVolumes, log)) return false;
+
+                // Create the RTV descriptor heap
+                if (!CreateRTVDescriptorHeap(d3d, resources, numVolumes)) return false;
+
+                if (!CreateCachingBuffers(d3d, d3dResources, resources, resources.CascadeCellNum, config, log)) return false;
+
+                // Create the GPU counters and pipeline statistics queries of the probe trace and radiance cache passes
+                perf.counters.enabled = d3d.GPUCounters;
+                resources.counters = &perf.counters;
+                if (d3d.GPUCounters && !CreateGPUCounters(d3d, d3dResources, resources, log)) return false;
+
+                // Create the buffers of the irradiance queries of the CPU
+                if (!CreateIrradianceQueries(d3d, d3dResources, resources, log)) return false;
+
+            #if RTXGI_DDGI_RESOURCE_MANAGEMENT
+                // Create the pool the volume probe textures are placed in.
+                // The volumes are traced together (see RayTraceVolumes()), so their probe ray data can't alias.
+                // Volumes rebuilt at runtime are recycled in the pool and reused by volumes of the same size class.
+                DDGIVolumeResourcePoolDesc poolDesc = {};
+                poolDesc.maxRecycledVolumes = numVolumes;
+                CHECK(CreateDDGIVolumeResourcePool(d3d.device, poolDesc, &resources.volumePool) == ERTXGIStatus::OK, "create the DDGIVolume resource pool!", log);
+            #endif
+
+                // Initialize the DDGIVolumes
+                for (UINT volumeIndex = 0; volumeIndex < numVolumes; volumeIndex++)
+                {
+                    Configs::DDGIVolume volumeConfig = config.ddgi.volumes[volumeIndex];
+                    if (!CreateDDGIVolume(d3d, d3dResources, resources, volumeConfig, log)) return false;
+
+                    // Clear the volume's probes at initialization
+                    DDGIVolume* volume = static_cast<DDGIVolume*>(resources.volumes[volumeIndex]);
+                    volume->ClearProbes(GetCmdList(d3d));
+                    ResetRadianceCache(d3d, d3dResources, resources);
+                }
+                resources.volumeShaderPermutations.Release();
+
+                // Create the buffers of the probe delta packets, laid out for the volumes
+                if (config.ddgi.probeDeltas && !CreateProbeDeltas(d3d, d3dResources, resources, log)) return false;
+
+                if (!CreateDDGIClipmap(d3d, resources, log)) return false;
+
+                // Setup performance stats
+                perf.AddStat("DDGI", resources.cpuStat, resources.gpuStat);
+                resources.radianceCacheCompactStat = perf.AddGPUStat("  Radiance Cache Compaction");
+                resources.rtStat = perf.AddGPUStat("  Probe Trace");
+                resources.radianceCacheStat = perf.AddGPUStat("  Radiance Cache");
+                resources.radianceCacheClearStat = perf.AddGPUStat("    Accumulation Clear");
+                resources.radianceCacheLightGridStat = perf.AddGPUStat("    Light Grid");
+                resources.radianceCacheWorkListStat = perf.AddGPUStat("    Work List");
+                resources.radianceCacheBudgetStat = perf.AddGPUStat("    Update Budget");
+                resources.radianceCacheSortStat = perf.AddGPUStat("    Sort");
+                resources.radianceCacheShadeStat = perf.AddGPUStat("    Shade");
+                resources.resolveStat = perf.AddGPUStat("  Probe Ray Resolve");
+                resources.blendStat = perf.AddGPUStat("  Blend");
+                for (size_t volumeIndex = 0; volumeIndex < resources.volumes.size(); volumeIndex++)
+                {
+                    resources.volumeBlendStats.push_back(perf.AddGPUStat("    " + std::string(resources.volumeDescs[volumeIndex].name)));
+                }
+                resources.relocateStat = perf.AddGPUStat("  Relocate");
+                resources.classifyStat = perf.AddGPUStat("  Classify");
+                resources.lightingStat = perf.AddGPUStat("  Lighting");
+                resources.variabilityStat = perf.AddGPUStat("  Variability");
+
+                return true;
+            }
+
+            /**
+             * Reload and compile shaders, recreate PSOs, and recreate the shader table.
+             */
+            bool Reload(Globals& d3d, GlobalResources& d3dResources, Resources& resources, const Configs::Config& config, std::ofstream& log)
+            {
+                log << "Reloading DDGI shaders...";
+                if (!LoadAndCompileShaders(d3d, resources, config.ddgi.volumes, log)) return false;
+                if (!CreatePSOs(d3d, d3dResources, resources, log)) return false;
+                if (!CreateRadianceCachePSOs(d3d, d3dResources, resources, log)) return false;
+                if (!UpdateShaderTable(d3d, d3dResources, resources, log)) return false;
+
+                // Reinitialize the DDGIVolumes
+                for (UINT volumeIndex = 0; volumeIndex < static_cast<UINT>(resources.volumes.size()); volumeIndex++)
+                {
+                    Configs::DDGIVolume volumeConfig = config.ddgi.volumes[volumeIndex];
+                    if (!CreateDDGIVolume(d3d, d3dResources, resources, volumeConfig, log)) return false;
+
+                #if RTXGI_DDGI_RESOURCE_MANAGEMENT
+                    // Placed probe textures may reuse the memory of the destroyed ones, clear them
+                    DDGIVolume* volume = static_cast<DDGIVolume*>(resources.volumes[volumeIndex]);
+                    volume->ClearProbes(GetCmdList(d3d));
+                #endif
+                }
+                resources.volumeShaderPermutations.Release();
+
+                if (!CreateDDGIClipmap(d3d, resources, log)) return false;
+                log << "done.\n";
+                log << std::flush;
+
+                return true;
+            }
+
+            /**
+             * Release the shaders and PSOs that Reload() recreates.
+             */
+            void ReleaseShadersAndPSOs(Resources& resources)
+            {
+                resources.rtShaders.Release();
+                resources.indirectCS.Release();
+                resources.probeTraceCS.Release();
+                resources.radianceCacheCS.Release();
+                resources.radianceCacheRTShaders.Release();
+                resources.probeRayResolveCS.Release();
+                resources.radianceCacheWorkListArgsCS.Release();
+                resources.radianceCacheSortHistogramCS.Release();
+                resources.radianceCacheSortPrefixSumCS.Release();
+                resources.radianceCacheSortScatterCS.Release();
+                resources.radianceCacheBudgetHistogramCS.Release();
+                resources.radianceCacheBudgetThresholdCS.Release();
+                resources.radianceCacheStatsCS.Release();
+                resources.lightGridBoundsCS.Release();
+                resources.lightGridBuildCS.Release();
+                resources.radianceCacheEvictCS.Release();
+                resources.radianceCacheRehashCS.Release();
+                resources.radianceCacheTrimCS.Release();
+                resources.irradianceQueryCS.Release();
+                resources.probeDeltaExportCS.Release();
+                resources.probeDeltaImportCS.Release();
+
+                SAFE_RELEASE(resources.rtpso);
+                SAFE_RELEASE(resources.rtpsoInfo);
+                SAFE_RELEASE(resources.indirectPSO);
+                SAFE_RELEASE(resources.probeTracePSO);
+                SAFE_RELEASE(resources.radianceCachePSO);
+                SAFE_RELEASE(resources.radianceCacheRTPSO);
+                SAFE_RELEASE(resources.radianceCacheRTPSOInfo);
+                SAFE_RELEASE(resources.probeRayResolvePSO);
+                SAFE_RELEASE(resources.radianceCacheWorkListArgsPSO);
+                SAFE_RELEASE(resources.radianceCacheSortHistogramPSO);
+                SAFE_RELEASE(resources.radianceCacheSortPrefixSumPSO);
+                SAFE_RELEASE(resources.radianceCacheSortScatterPSO);
+                SAFE_RELEASE(resources.radianceCacheBudgetHistogramPSO);
+                SAFE_RELEASE(resources.radianceCacheBudgetThresholdPSO);
+                SAFE_RELEASE(resources.radianceCacheStatsPSO);
+                SAFE_RELEASE(resources.lightGridBoundsPSO);
+                SAFE_RELEASE(resources.lightGridBuildPSO);
+                SAFE_RELEASE(resources.radianceCacheEvictPSO);
+                SAFE_RELEASE(resources.radianceCacheRehashPSO);
+                SAFE_RELEASE(resources.radianceCacheTrimPSO);
+                SAFE_RELEASE(resources.irradianceQueryPSO);
+                SAFE_RELEASE(resources.probeDeltaExportPSO);
+                SAFE_RELEASE(resources.probeDeltaImportPSO);
+                SAFE_RELEASE(resources.radianceCacheCommandSignature);
+            }
+
+            /**
+             * Exchange the shaders and PSOs that Reload() recreates.
+             */
+            void SwapShadersAndPSOs(Resources& a, Resources& b)
+            {
+                std::swap(a.rtShaders, b.rtShaders);
+                std::swap(a.indirectCS, b.indirectCS);
+                std::swap(a.probeTraceCS, b.probeTraceCS);
+                std::swap(a.radianceCacheCS, b.radianceCacheCS);
+                std::swap(a.radianceCacheRTShaders, b.radianceCacheRTShaders);
+                std::swap(a.probeRayResolveCS, b.probeRayResolveCS);
+                std::swap(a.radianceCacheWorkListArgsCS, b.radianceCacheWorkListArgsCS);
+                std::swap(a.radianceCacheSortHistogramCS, b.radianceCacheSortHistogramCS);
+                std::swap(a.radianceCacheSortPrefixSumCS, b.radianceCacheSortPrefixSumCS);
+                std::swap(a.radianceCacheSortScatterCS, b.radianceCacheSortScatterCS);
+                std::swap(a.radianceCacheBudgetHistogramCS, b.radianceCacheBudgetHistogramCS);
+                std::swap(a.radianceCacheBudgetThresholdCS, b.radianceCacheBudgetThresholdCS);
+                std::swap(a.radianceCacheStatsCS, b.radianceCacheStatsCS);
+                std::swap(a.lightGridBoundsCS, b.lightGridBoundsCS);
+                std::swap(a.lightGridBuildCS, b.lightGridBuildCS);
+                std::swap(a.radianceCacheEvictCS, b.radianceCacheEvictCS);
+                std::swap(a.radianceCacheRehashCS, b.radianceCacheRehashCS);
+                std::swap(a.radianceCacheTrimCS, b.radianceCacheTrimCS);
+                std::swap(a.irradianceQueryCS, b.irradianceQueryCS);
+                std::swap(a.probeDeltaExportCS, b.probeDeltaExportCS);
+                std::swap(a.probeDeltaImportCS, b.probeDeltaImportCS);
+
+                std::swap(a.rtpso, b.rtpso);
+                std::swap(a.rtpsoInfo, b.rtpsoInfo);
+                std::swap(a.indirectPSO, b.indirectPSO);
+                std::swap(a.probeTracePSO, b.probeTracePSO);
+                std::swap(a.radianceCachePSO, b.radianceCachePSO);
+                std::swap(a.radianceCacheRTPSO, b.radianceCacheRTPSO);
+                std::swap(a.radianceCacheRTPSOInfo, b.radianceCacheRTPSOInfo);
+                std::swap(a.probeRayResolvePSO, b.probeRayResolvePSO);
+                std::swap(a.radianceCacheWorkListArgsPSO, b.radianceCacheWorkListArgsPSO);
+                std::swap(a.radianceCacheSortHistogramPSO, b.radianceCacheSortHistogramPSO);
+                std::swap(a.radianceCacheSortPrefixSumPSO, b.radianceCacheSortPrefixSumPSO);
+                std::swap(a.radianceCacheSortScatterPSO, b.radianceCacheSortScatterPSO);
+                std::swap(a.radianceCacheBudgetHistogramPSO, b.radianceCacheBudgetHistogramPSO);
+                std::swap(a.radianceCacheBudgetThresholdPSO, b.radianceCacheBudgetThresholdPSO);
+                std::swap(a.radianceCacheStatsPSO, b.radianceCacheStatsPSO);
+                std::swap(a.lightGridBoundsPSO, b.lightGridBoundsPSO);
+                std::swap(a.lightGridBuildPSO, b.lightGridBuildPSO);
+                std::swap(a.radianceCacheEvictPSO, b.radianceCacheEvictPSO);
+                std::swap(a.radianceCacheRehashPSO, b.radianceCacheRehashPSO);
+                std::swap(a.radianceCacheTrimPSO, b.radianceCacheTrimPSO);
+                std::swap(a.irradianceQueryPSO, b.irradianceQueryPSO);
+                std::swap(a.probeDeltaExportPSO, b.probeDeltaExportPSO);
+                std::swap(a.probeDeltaImportPSO, b.probeDeltaImportPSO);
+                std::swap(a.radianceCacheCommandSignature, b.radianceCacheCommandSignature);
+            }
+
+            /**
+             * Compile the shaders, PSOs, and volume shaders of a background reload. Runs on the reload's worker thread,
+             * which has exclusive use of the shader compiler and pipeline cache until the reload is done.
+             */
+            void CompileReload(Globals& d3d, GlobalResources& d3dResources, AsyncReload& reload)
+            {
+                Resources& staging = reload.staging;
+                std::ofstream& log = reload.log;
+
+                log << "Reloading DDGI shaders...";
+                reload.succeeded = LoadAndCompileShaders(d3d, staging, reload.volumes, log)
+                    && CreatePSOs(d3d, d3dResources, staging, log)
+                    && CreateRadianceCachePSOs(d3d, d3dResources, staging, log);
+
+                // Compile the volume shaders too, the volumes are recreated with them when the reload is swapped in
+                for (size_t volumeIndex = 0; reload.succeeded && volumeIndex < reload.volumeShaders.size(); volumeIndex++)
+                {
+                    DDGIVolumeDesc volumeDesc;
+                    GetDDGIVolumeDesc(reload.volumes[volumeIndex], volumeDesc);
+                    volumeDesc.probeFixedRaysUseWaveOps = (d3d.features.waveLaneCount >= 32);
+                    reload.succeeded = Graphics::DDGI::CompileDDGIVolumeShaders(d3d, volumeDesc, reload.volumeShaders[volumeIndex], false, log, &staging.volumeShaderPermutations);
+                    SAFE_DELETE(volumeDesc.name);
+                }
+                staging.volumeShaderPermutations.Release();
+
+                if (reload.succeeded) log << "done.\n";
+                log << std::flush;
+
+                reload.done = true;
+            }
+
+            /**
+             * Wait for the reload's worker thread and release what the reload still owns.
+             */
+            void ReleaseReload(Resources& resources)
+            {
+                AsyncReload* reload = resources.reload;
+                if (!reload) return;
+
+                if (reload->thread.joinable()) reload->thread.join();
+                ReleaseShadersAndPSOs(reload->staging);
+                for (size_t volumeIndex = 0; volumeIndex < reload->volumeShaders.size(); volumeIndex++)
+                {
+                    for (size_t shaderIndex = 0; shaderIndex < reload->volumeShaders[volumeIndex].size(); shaderIndex++)
+                    {
+                        reload->volumeShaders[volumeIndex][shaderIndex].Release();
+                    }
+                }
+                SAFE_DELETE(resources.reload);
+            }
+
+            /**
+             * Start recompiling the shaders and PSOs on a worker thread. The current shaders and PSOs keep rendering
+             * until FinishReload() swaps in the new ones. Does nothing when a reload is already pending.
+             */
+            bool ReloadAsync(Globals& d3d, GlobalResources& d3dResources, Resources& resources, const Configs::Config& config, std::ofstream& log)
+            {
+                if (resources.reload) return true;
+
+                AsyncReload* reload = new AsyncReload();
+                reload->volumes = config.ddgi.volumes;
+                reload->volumeShaders.resize(resources.volumes.size());
+                reload->log.open("log-reload.txt", std::ios::out);
+                if (!reload->log.is_open())
+                {
+                    delete reload;
+                    log << "\nFailed to open log-reload.txt!";
+                    std::flush(log);
+                    return false;
+                }
+
+                log << "Reloading DDGI shaders in the background...\n";
+                std::flush(log);
+
+                resources.reload = reload;
+                reload->thread = std::thread(CompileReload, std::ref(d3d), std::ref(d3dResources), std::ref(*reload));
+                return true;
+            }
+
+            /**
+             * Swap in the shaders and PSOs of a finished background reload and recreate the DDGIVolumes with the recompiled volume shaders.
+             * Call once per frame, after the frame's command list is reset.
+             */
+            Graphics::DDGI::EReloadStatus FinishReload(Globals& d3d, GlobalResources& d3dResources, Resources& resources, const Configs::Config& config, std::ofstream& log)
+            {
+                using Graphics::DDGI::EReloadStatus;
+
+                AsyncReload* reload = resources.reload;
+                if (!reload) return EReloadStatus::NONE;
+                if (!reload->done) return EReloadStatus::PENDING;
+
+                // Append the worker's log to the main log
+                reload->thread.join();
+                reload->log.close();
+                {
+                    std::ifstream workerLog("log-reload.txt");
+                    if (workerLog.is_open() && workerLog.peek() != std::ifstream::traits_type::eof()) log << workerLog.rdbuf();
+                }
+
+                if (!reload->succeeded)
+                {
+                    log << "\nDDGI shader reload failed, the previous shaders are still in use.\n";
+                    std::flush(log);
+                    ReleaseReload(resources);
+                    return EReloadStatus::FAILED;
+                }
+
+                // Wait for the frames in flight that reference the current PSOs, then swap in the new ones
+                if (!Graphics::WaitForGPU(d3d)) return EReloadStatus::SWAP_FAILED;
+                SwapShadersAndPSOs(resources, reload->staging);
+
+                bool succeeded = UpdateShaderTable(d3d, d3dResources, resources, log);
+
+                // Reinitialize the DDGIVolumes
+                for (UINT volumeIndex = 0; succeeded && volumeIndex < static_cast<UINT>(resources.volumes.size()); volumeIndex++)
+                {
+                    succeeded = CreateDDGIVolume(d3d, d3dResources, resources, reload->volumes[volumeIndex], log, &reload->volumeShaders[volumeIndex]);
+
+                #if RTXGI_DDGI_RESOURCE_MANAGEMENT
+                    // Placed probe textures may reuse the memory of the destroyed ones, clear them
+                    if (succeeded) static_cast<DDGIVolume*>(resources.volumes[volumeIndex])->ClearProbes(GetCmdList(d3d));
+                #endif
+                }
+                if (succeeded) succeeded = CreateDDGIClipmap(d3d, resources, log);
+
+                // Release the previous shaders and PSOs, now held by the staging resources
+                ReleaseReload(resources);
+
+                return succeeded ? EReloadStatus::SUCCEEDED : EReloadStatus::SWAP_FAILED;
+            }
+
+        #if RTXGI_DDGI_RESOURCE_MANAGEMENT
+            /**
+             * Create an existing DDGIVolume again in place with a new config. The SDK keeps the probe textures whose size
+             * didn't change (see DDGIVolumeDesc::ShouldAllocateProbes() and the like) and recreates the pipelines from the new volume shaders.
+             */
+            bool RecreateDDGIVolume(Globals& d3d, GlobalResources& d3dResources, Resources& resources, const Configs::DDGIVolume& volumeConfig, std::ofstream& log)
+            {
+                DDGIVolumeDesc volumeDesc;
+                GetDDGIVolumeDesc(volumeConfig, volumeDesc);
+                volumeDesc.probeFixedRaysUseWaveOps = (d3d.features.waveLaneCount >= 32);
+
+                DDGIVolumeResources volumeResources;
+                std::vector<Shaders::ShaderProgram> volumeShaders;
+                bool succeeded = GetDDGIVolumeResources(d3d, d3dResources, resources, volumeDesc, volumeResources, volumeShaders, log);
+
+                DDGIVolume* volume = static_cast<DDGIVolume*>(resources.volumes[volumeConfig.index]);
+                if (succeeded && volume->Create(volumeDesc, volumeResources) != ERTXGIStatus::OK)
+                {
+                    log << "\nError: failed to recreate the DDGIVolume!";
+                    std::flush(log);
+                    succeeded = false;
+                }
+
+                for (size_t shaderIndex = 0; shaderIndex < volumeShaders.size(); shaderIndex++) volumeShaders[shaderIndex].Release();
+
+                // The volume's desc points to the name, which the stored desc owns
+                if (!succeeded)
+                {
+                    SAFE_DELETE(volumeDesc.name);
+                    return false;
+                }
+                SAFE_DELETE(resources.volumeDescs[volumeConfig.index].name);
+                resources.volumeDescs[volumeConfig.index] = volumeDesc;
+                return true;
+            }
+        #endif
+
+            /**
+             * Apply the changes of the volumes' configs (see Configs::ReloadDDGIVolumes()), each at the cheapest level:
+             * constants are set on the running volume, other changes recreate the volume. In managed resource mode the
+             * volume is recreated in place and keeps the probe textures whose size didn't change.
+             */
+            bool ApplyVolumeChanges(Globals& d3d, GlobalResources& d3dResources, Resources& resources, const Configs::Config& config, const std::vector<Configs::EDDGIVolumeChange>& changes, std::ofstream& log)
+            {
+                using Configs::EDDGIVolumeChange;
+
+                // Recreated volumes release resources the frames in flight may still use
+                EDDGIVolumeChange maxChange = EDDGIVolumeChange::NONE;
+                for (EDDGIVolumeChange change : changes) maxChange = (std::max)(maxChange, change);
+                if (maxChange >= EDDGIVolumeChange::SHADERS && !Graphics::WaitForGPU(d3d)) return false;
+
+                for (UINT volumeIndex = 0; volumeIndex < static_cast<UINT>(changes.size()); volumeIndex++)
+                {
+                    EDDGIVolumeChange change = changes[volumeIndex];
+                    if (change == EDDGIVolumeChange::NONE) continue;
+
+                    const Configs::DDGIVolume& volumeConfig = config.ddgi.volumes[volumeIndex];
+                    UnbakeDDGIVolumeIrradiance(d3d, resources, volumeIndex);
+
+                    if (change == EDDGIVolumeChange::CONSTANTS)
+                    {
+                        Graphics::DDGI::SetDDGIVolumeConstants(resources.volumes[volumeIndex], volumeConfig);
+                        continue;
+                    }
+
+                #if RTXGI_DDGI_RESOURCE_MANAGEMENT
+                    if (change == EDDGIVolumeChange::REBUILD)
+                    {
+                        if (!CreateDDGIVolume(d3d, d3dResources, resources, volumeConfig, log)) return false;
+                    }
+                    else
+                    {
+                        if (!RecreateDDGIVolume(d3d, d3dResources, resources, volumeConfig, log)) return false;
+                    }
+
+                    // Placed probe textures may reuse the memory of the destroyed ones, clear them
+                    if (change >= EDDGIVolumeChange::TEXTURES) static_cast<DDGIVolume*>(resources.volumes[volumeIndex])->ClearProbes(GetCmdList(d3d));
+                #else
+                    // The application owns the probe textures in unmanaged resource mode, create the volume again
+                    if (!CreateDDGIVolume(d3d, d3dResources, resources, volumeConfig, log)) return false;
+                #endif
+                }
+                resources.volumeShaderPermutations.Release();
+
+                // The sampling shaders are specialized for the movement type, formats, texel counts, and visibility masks the volumes share
+                if (d3d.DDGISpecializedSampling && maxChange >= EDDGIVolumeChange::TEXTURES)
+                {
+                    if (!LoadAndCompileShaders(d3d, resources, config.ddgi.volumes, log)) return false;
+                    if (!CreatePSOs(d3d, d3dResources, resources, log)) return false;
+                    if (!CreateRadianceCachePSOs(d3d, d3dResources, resources, log)) return false;
+                    if (!UpdateShaderTable(d3d, d3dResources, resources, log)) return false;
+                }
+
+                if (maxChange >= EDDGIVolumeChange::SHADERS) return CreateDDGIClipmap(d3d, resources, log);
+                return true;
+            }
+
+            /**
+             * Resize screen-space buffers and update descriptors.
+             */
+            bool Resize(Globals& d3d, GlobalResources& d3dResources, Resources& resources, std::ofstream& log)
+            {
+                if (!CreateTextures(d3d, d3dResources, resources, log)) return false;
+                log << "DDGI resize, " << d3d.width << "x" << d3d.height << "\n";
+                std::flush(log);
+                return true;
+            }
+
+            /**
+             * Compares the scene's lights and sky with the ones last forwarded to the DDGIVolumes, and forwards the changes
+             * to the volumes' event driven update policies. The sky and directional lights light the whole scene (global light changes),
+             * spot and point lights are small light changes where the light was and where it is now.
+             */
+            void NotifyDDGIVolumeLightChanges(GlobalResources& d3dResources, Resources& resources, const Scenes::Scene& scene)
+            {
+                // The volumes start out updating, there is nothing to forward before the first snapshot
+                if (resources.eventLights.size() != scene.lights.size())
+                {
+                    resources.eventLights.resize(scene.lights.size());
+                    for (size_t lightIndex = 0; lightIndex < scene.lights.size(); lightIndex++) resources.eventLights[lightIndex] = scene.lights[lightIndex].data;
+                    resources.eventSkyRadiance = d3dResources.constants.app.skyRadiance;
+                    return;
+                }
+
+                bool globalLightChange = (memcmp(&resources.eventSkyRadiance, &d3dResources.constants.app.skyRadiance, sizeof(float3)) != 0);
+                resources.eventSkyRadiance = d3dResources.constants.app.skyRadiance;
+
+                for (size_t lightIndex = 0; lightIndex < scene.lights.size(); lightIndex++)
+                {
+                    const Scenes::Light& light = scene.lights[lightIndex];
+                    if (memcmp(&resources.eventLights[lightIndex], &light.data, sizeof(Graphics::Light)) == 0) continue;
+
+                    Graphics::Light previous = resources.eventLights[lightIndex];
+                    resources.eventLights[lightIndex] = light.data;
+
+                    if (light.type == ELightType::DIRECTIONAL)
+                    {
+                        globalLightChange = true;
+                        continue;
+                    }
+
+                    for (DDGIVolumeBase* volume : resources.volumes)
+                    {
+                        volume->OnSmallLightChange(previous.position, previous.radius);
+                        volume->OnSmallLightChange(light.data.position, light.data.radius);
+                    }
+                }
+
+                if (globalLightChange)
+                {
+                    for (DDGIVolumeBase* volume : resources.volumes) volume->OnGlobalLightChange();
+                }
+            }
+
+            /**
+             * Computes the reach of each DDGIVolume's probe rays: the volume's bounds grown by the probe max ray distance and a probe
+             * spacing (relocated probes, and a frame of scrolling, the new masks are written to the TLAS by the next frame's scene update).
+             * When a volume's reach changes, the scene TLAS instances are rewritten with the instance mask bit of each volume they are
+             * within reach of (see GetSceneInstanceDesc()), probe rays skip the other instances.
+             */
+            void UpdateTLASVolumeBounds(Globals& d3d, GlobalResources& d3dResources, Resources& resources, Scenes::Scene& scene)
+            {
+                std::vector<rtxgi::AABB> bounds;
+                if (d3d.DDGIVolumeInstanceMasks)
+                {
+                    for (DDGIVolumeBase* volume : resources.volumes)
+                    {
+                        float3 origin = volume->GetOrigin();
+                        float3 spacing = volume->GetProbeSpacing();
+                        int3 counts = volume->GetProbeCounts();
+                        float3 extent = { spacing.x * (counts.x - 1) * 0.5f, spacing.y * (counts.y - 1) * 0.5f, spacing.z * (counts.z - 1) * 0.5f };
+
+                        // Rotated volumes are bound by their bounding sphere
+                        float3 angles = volume->GetEulerAngles();
+                        if (angles.x != 0.f || angles.y != 0.f || angles.z != 0.f)
+                        {
+                            float radius = sqrtf((extent.x * extent.x) + (extent.y * extent.y) + (extent.z * extent.z));
+                            extent = { radius, radius, radius };
+                        }
+
+                        float reach = volume->GetProbeMaxRayDistance() + (std::max)(spacing.x, (std::max)(spacing.y, spacing.z));
+                        rtxgi::AABB aabb;
+                        aabb.min = { origin.x - extent.x - reach, origin.y - extent.y - reach, origin.z - extent.z - reach };
+                        aabb.max = { origin.x + extent.x + reach, origin.y + extent.y + reach, origin.z + extent.z + reach };
+                        bounds.push_back(aabb);
+                    }
+                }
+
+                if (bounds.size() == d3dResources.tlasVolumeBounds.size()
+                    && (bounds.empty() || memcmp(bounds.data(), d3dResources.tlasVolumeBounds.data(), bounds.size() * sizeof(rtxgi::AABB)) == 0)) return;
 
-                if (!CreateRadianceCachePSOs(d3d, d3dResources, resources, log)) return false;
+                d3dResources.tlasVolumeBounds = bounds;
+                for (Scenes::MeshInstance& instance : scene.instances) instance.dirty = true;
+            }
 
-                // Create the DDGIVolume resource indices structured buffer
-                if (!CreateDDGIVolumeResourceIndicesBuffer(d3d, d3dResources, resources, numVolumes, log)) return false;
+            /**
+             * Updates the selected volumes (probe ray rotations, scrolling) and packs their constants for UploadDDGIVolumeConstants().
+             * DDGIVolumeBase::Update() only touches the volume's own state, so many volumes are updated and packed in batches on worker threads.
+             */
+            void UpdateDDGIVolumes(Resources& resources)
+            {
+                const UINT ParallelVolumeCount = 64;        // Volumes are updated on worker threads from this many
+                const UINT VolumesPerJob = 32;
 
-                // Create the DDGIVolume constants structured buffer
-                if (!CreateDDGIVolumeConstantsBuffer(d3d, d3dResources, resources, numVolumes, log)) return false;
+                UINT numVolumes = static_cast<UINT>(resources.selectedVolumes.size());
+                resources.selectedVolumeDescs.resize(numVolumes);
 
-                // Create the RTV descriptor heap
-                if (!CreateRTVDescriptorHeap(d3d, resources, numVolumes)) return false;
+                const auto updateVolumes = [&resources](UINT first, UINT last)
+                {
+                    for (UINT volumeIndex = first; volumeIndex < last; volumeIndex++)
+                    {
+                        DDGIVolume* volume = resources.selectedVolumes[volumeIndex];
+                        volume->Update();
+                        resources.selectedVolumeDescs[volumeIndex] = volume->GetDescGPUPacked();
+                    }
+                };
 
-                if (!CreateCachingBuffers(d3d, d3dResources, resources, resources.CascadeCellNum, config, log)) return false;
+                if (numVolumes < ParallelVolumeCount)
+                {
+                    updateVolumes(0, numVolumes);
+                    return;
+                }
 
-                // Initialize the DDGIVolumes
-                for (UINT volumeIndex = 0; volumeIndex < numVolumes; volumeIndex++)
+                if (resources.volumeWorkers.GetNumWorkers() == 0) resources.volumeWorkers.Start((std::max)(std::thread::hardware_concurrency(), 2u) - 1);
+
+                resources.volumeUpdateJobs.clear();
+                for (UINT first = 0; first < numVolumes; first += VolumesPerJob)
                 {
-                    Configs::DDGIVolume volumeConfig = config.ddgi.volumes[volumeIndex];
-                    if (!CreateDDGIVolume(d3d, d3dResources, resources, volumeConfig, log)) return false;
+                    UINT last = (std::min)(first + VolumesPerJob, numVolumes);
+                    resources.volumeUpdateJobs.push_back([&updateVolumes, first, last]() { updateVolumes(first, last); });
+                }
+                resources.volumeWorkers.Run(resources.volumeUpdateJobs);
+            }
 
-                    // Clear the volume's probes at initialization
-                    DDGIVolume* volume = static_cast<DDGIVolume*>(resources.volumes[volumeIndex]);
-                    volume->ClearProbes(d3d.cmdList[d3d.frameIndex]);
-                    ResetRadianceCache(d3d, d3dResources, resources);
+            /**
+             * Sorts the volumes in the order sampling shaders blend them: higher budget priority first, then finer probe spacing.
+             * Shaders stop blending once the weights saturate, so where volumes overlap the preferred (denser) probes are
+             * sampled and the coarser volumes behind them are skipped.
+             */
+            void SortDDGIVolumeBlendOrder(Resources& resources, const Configs::Config& config)
+            {
+                std::vector<float> cellSizes(resources.volumes.size(), 0.f);
+                resources.volumeBlendOrder.resize(resources.volumes.size());
+                for (UINT volumeIndex = 0; volumeIndex < static_cast<UINT>(resources.volumes.size()); volumeIndex++)
+                {
+                    resources.volumeBlendOrder[volumeIndex] = volumeIndex;
+                    if (resources.volumes[volumeIndex] == nullptr) continue;
+
+                    float3 spacing = resources.volumes[volumeIndex]->GetProbeSpacing();
+                    cellSizes[volumeIndex] = spacing.x * spacing.y * spacing.z;
                 }
 
-                // Setup performance stats
-                perf.AddStat("DDGI", resources.cpuStat, resources.gpuStat);
-                resources.rtStat = perf.AddGPUStat("  Probe Trace");
-                resources.blendStat = perf.AddGPUStat("  Blend");
-                resources.relocateStat = perf.AddGPUStat("  Relocate");
-                resources.classifyStat = perf.AddGPUStat("  Classify");
-                resources.lightingStat = perf.AddGPUStat("  Lighting");
-                resources.variabilityStat = perf.AddGPUStat("  Variability");
+                // Unloaded volumes go last
+                std::stable_sort(resources.volumeBlendOrder.begin(), resources.volumeBlendOrder.end(), [&](UINT a, UINT b)
+                {
+                    bool loadedA = (resources.volumes[a] != nullptr);
+                    bool loadedB = (resources.volumes[b] != nullptr);
+                    if (loadedA != loadedB) return loadedA;
+
+                    int priorityA = config.ddgi.volumes[a].budgetPriority;
+                    int priorityB = config.ddgi.volumes[b].budgetPriority;
+                    if (priorityA != priorityB) return priorityA > priorityB;
+                    return cellSizes[a] < cellSizes[b];
+                });
+            }
+
+            /**
+             * Queue a batch of irradiance queries, evaluated by the next Execute(). The callback receives the batch's
+             * results MAX_FRAMES_IN_FLIGHT frames later, when the frame's readback buffer is reused (no GPU sync point).
+             * Returns false when the frame's queries would exceed IRRADIANCE_QUERY_MAX_COUNT.
+             */
+            bool QueueIrradianceQueries(Resources& resources, const IrradianceQuery* queries, UINT count, IrradianceQueryCallback callback)
+            {
+                if (resources.irradianceQueries == nullptr || count == 0) return false;
+
+                UINT first = static_cast<UINT>(resources.irradianceQueriesPending.size());
+                if ((first + count) > IRRADIANCE_QUERY_MAX_COUNT) return false;
 
+                resources.irradianceQueriesPending.insert(resources.irradianceQueriesPending.end(), queries, queries + count);
+                resources.irradianceQueryBatchesPending.push_back({ first, count, std::move(callback) });
                 return true;
             }
 
             /**
-             * Reload and compile shaders, recreate PSOs, and recreate the shader table.
+             * Check a volume can exchange probe delta packets: its tiles are laid out in the probe deltas buffer and it
+             * samples the probe textures it updates (scrolling and double buffered volumes don't).
              */
-            bool Reload(Globals& d3d, GlobalResources& d3dResources, Resources& resources, const Configs::Config& config, std::ofstream& log)
+            bool IsProbeDeltaVolume(const Resources& resources, UINT volumeIndex)
             {
-                log << "Reloading DDGI shaders...";
-                if (!LoadAndCompileShaders(d3d, resources, static_cast<UINT>(config.ddgi.volumes.size()), log)) return false;
-                if (!CreatePSOs(d3d, d3dResources, resources, log)) return false;
-                if (!UpdateShaderTable(d3d, d3dResources, resources, log)) return false;
+                if (resources.probeDeltas == nullptr || volumeIndex >= static_cast<UINT>(resources.probeDeltaVolumes.size())) return false;
+                if (volumeIndex >= static_cast<UINT>(resources.volumes.size()) || resources.volumes[volumeIndex] == nullptr) return false;
 
-                if (!CreateRadianceCachePSOs(d3d, d3dResources, resources, log)) return false;
+                const DDGIVolume* volume = static_cast<const DDGIVolume*>(resources.volumes[volumeIndex]);
+                if (volume->GetMovementType() == EDDGIVolumeMovementType::Scrolling || volume->GetProbeAtlasDoubleBuffered()) return false;
 
-                // Reinitialize the DDGIVolumes
-                for (UINT volumeIndex = 0; volumeIndex < static_cast<UINT>(resources.volumes.size()); volumeIndex++)
-                {
-                    Configs::DDGIVolume volumeConfig = config.ddgi.volumes[volumeIndex];
-                    if (!CreateDDGIVolume(d3d, d3dResources, resources, volumeConfig, log)) return false;
-                }
-                log << "done.\n";
-                log << std::flush;
+                // Volumes rebuilt since the buffer was created must keep their probe and texel counts
+                const DDGIVolumeDesc& desc = volume->GetDesc();
+                const ProbeDeltaVolume& deltaVolume = resources.probeDeltaVolumes[volumeIndex];
+                UINT probeCount = static_cast<UINT>(desc.probeCounts.x * desc.probeCounts.y * desc.probeCounts.z);
+                return (probeCount == deltaVolume.probeCount) && (GetProbeDeltaTileStride(desc) == deltaVolume.tileStride);
+            }
+
+            /**
+             * Queue the export of a volume's probe tiles that changed by more than the threshold since its last export
+             * (a negative threshold exports every tile). The packet is passed to the callback MAX_FRAMES_IN_FLIGHT frames later.
+             */
+            bool QueueProbeDeltaExport(Resources& resources, UINT volumeIndex, float threshold, ProbeDeltaCallback callback)
+            {
+                if (!callback || !IsProbeDeltaVolume(resources, volumeIndex)) return false;
 
+                resources.probeDeltaExportsPending.push_back({ volumeIndex, threshold, std::move(callback) });
                 return true;
             }
 
             /**
-             * Resize screen-space buffers and update descriptors.
+             * Queue the import of a probe delta packet (exported by a volume with the same probe and texel counts) into a volume.
              */
-            bool Resize(Globals& d3d, GlobalResources& d3dResources, Resources& resources, std::ofstream& log)
+            bool QueueProbeDeltaImport(Resources& resources, UINT volumeIndex, const uint8_t* packet, UINT size)
             {
-                if (!CreateTextures(d3d, d3dResources, resources, log)) return false;
-                log << "DDGI resize, " << d3d.width << "x" << d3d.height << "\n";
-                std::flush(log);
+                if (packet == nullptr || size < PROBE_DELTA_HEADER_SIZE || !IsProbeDeltaVolume(resources, volumeIndex)) return false;
+
+                ProbeDeltaHeader header;
+                memcpy(&header, packet, sizeof(ProbeDeltaHeader));
+                if (header.tileStride != resources.probeDeltaVolumes[volumeIndex].tileStride) return false;
+
+                UINT tileCount = std::min<UINT>(header.tileCount, PROBE_DELTA_MAX_TILES);
+                UINT64 packetSize = PROBE_DELTA_HEADER_SIZE + (static_cast<UINT64>(tileCount) * header.tileStride);
+                if (size < packetSize || packetSize > resources.probeDeltaPacketSize) return false;
+
+                // The tile count is clamped, tiles beyond it are ignored
+                header.tileCount = tileCount;
+                ProbeDeltaImport probeDeltaImport = { volumeIndex, std::vector<uint8_t>(packet, packet + packetSize) };
+                memcpy(probeDeltaImport.packet.data(), &header, sizeof(ProbeDeltaHeader));
+                resources.probeDeltaImportsPending.push_back(std::move(probeDeltaImport));
                 return true;
             }
 
@@ -1670,26 +4706,35 @@ namespace Graphics
                 CPU_TIMESTAMP_BEGIN(resources.cpuStat);
 
                 resources.enabled = config.ddgi.enabled;
+                resources.radianceCacheInline = config.ddgi.useInlineRayTracing;
                 if (resources.enabled)
                 {
                     // Path Trace constants
                     d3dResources.constants.pt.rayNormalBias = config.pathTrace.rayNormalBias;
                     d3dResources.constants.pt.rayViewBias = config.pathTrace.rayViewBias;
                     d3dResources.constants.pt.samplesPerPixel = config.pathTrace.samplesPerPixel;
-                    d3dResources.constants.pt.SetShaderExecutionReordering(config.ddgi.shaderExecutionReordering);
+                    d3dResources.constants.pt.SetShaderExecutionReordering(config.ddgi.shaderExecutionReordering && d3d.supportsShaderExecutionReordering);
 
                     // Clear the selected volume, if necessary
                     if (config.ddgi.volumes[config.ddgi.selectedVolume].clearProbes)
                     {
+                        UnbakeDDGIVolumeIrradiance(d3d, resources, config.ddgi.selectedVolume);
+
                         DDGIVolume* volume = static_cast<DDGIVolume*>(resources.volumes[config.ddgi.selectedVolume]);
-                        volume->ClearProbes(d3d.cmdList[d3d.frameIndex]);
+                        volume->ClearProbes(GetCmdList(d3d));
 
                         config.ddgi.volumes[config.ddgi.selectedVolume].clearProbes = 0;
-                        resources.numVolumeVariabilitySamples[config.ddgi.selectedVolume] = 0;
+                        volume->ResetProbeConvergence();
 
                         ResetRadianceCache(d3d, d3dResources, resources);
                     }
 
+                    // Forward light changes to the volumes
+                    NotifyDDGIVolumeLightChanges(d3dResources, resources, scene);
+
+                    // Move the clipmap levels together
+                    if (d3d.DDGIClipmap) resources.clipmap.SetAnchor(scene.cameras[scene.activeCamera].data.position);
+
                     // Select the active volumes
                     resources.selectedVolumes.clear();
                     for (UINT volumeIndex = 0; volumeIndex < static_cast<UINT>(resources.volumes.size()); volumeIndex++)
@@ -1701,29 +4746,57 @@ namespace Graphics
                         // Get the volume
                         DDGIVolume* volume = static_cast<DDGIVolume*>(resources.volumes[volumeIndex]);
                         //volume->SetOrigin(Camera.data.position);
-                        volume->SetScrollAnchor(Camera.data.position);
+                        if (!d3d.DDGIClipmap) volume->SetScrollAnchor(Camera.data.position);
+                        volume->SetProbeSchedulingViewOrigin(Camera.data.position);
 
-                        // If the scene's lights, skylight, or geometry have changed *or* the volume moves *or* the probes are reset, reset the variability
-                        if (config.ddgi.volumes[volumeIndex].clearProbeVariability) resources.numVolumeVariabilitySamples[volumeIndex] = 0;
+                        // Read the variability copied when this frame index was last recorded (that frame has completed), the copy doesn't stall
+                        volume->SetProbeConvergenceVariabilityThreshold(config.ddgi.volumes[volumeIndex].probeVariabilityThreshold);
+                        rtxgi::d3d12::ReadbackDDGIVolumeVariability(d3d.frameIndex, 1, volume);
+
+                        // Outer clipmap levels update less often, a level that skips the frame holds its position and probes
+                        if (d3d.DDGIClipmap && !resources.clipmap.GetLevelUpdateNeeded(volumeIndex)) continue;
 
-                        // Don't update volumes whose variability measurement is low enough to be considered converged
-                        // Enforce a minimum of 16 samples to filter out early outliers
-                        const uint32_t MinimumVariabilitySamples = 16;
-                        float volumeAverageVariability = volume->GetVolumeAverageVariability();
-                        bool isConverged = volume->GetProbeVariabilityEnabled()
-                                                && (resources.numVolumeVariabilitySamples[volumeIndex]++ > MinimumVariabilitySamples)
-                                                && (volumeAverageVariability < config.ddgi.volumes[config.ddgi.selectedVolume].probeVariabilityThreshold);
+                        // Volumes with event driven updates idle at a reduced rate when nothing changes (see DDGIVolumeBase::PollUpdateNeeded())
+                        if (volume->GetProbeEventUpdatesEnabled())
+                        {
+                            if (volume->PollUpdateNeeded()) resources.selectedVolumes.push_back(volume);
+                            continue;
+                        }
+
+                        // If the scene's lights, skylight, or geometry have changed *or* the volume moves *or* the probes are reset, reset the variability
+                        if (config.ddgi.volumes[volumeIndex].clearProbeVariability)
+                        {
+                            volume->ResetProbeConvergence();
+                            volume->WakeProbeConvergence();
+                            UnbakeDDGIVolumeIrradiance(d3d, resources, volumeIndex);
+                        }
+
+                        // Baked volumes are frozen
+                        if (resources.bakedIrradiance[volumeIndex]) continue;
+
+                        // Don't update volumes whose variability has stayed low enough to be considered converged (see DDGIVolumeBase::GetProbeConverged())
+                        // Volumes that freeze on the GPU stay selected, their probe schedule skips the trace and blend work instead
+                        bool isConverged = volume->GetProbeConverged();
+
+                        // Bake converged volumes, a volume that can't be baked (see BakeDDGIVolumeIrradiance()) isn't tried again
+                        if (isConverged && config.ddgi.volumes[volumeIndex].probeBakeEnabled)
+                        {
+                            if (!BakeDDGIVolumeIrradiance(d3d, d3dResources, resources, volumeIndex)) config.ddgi.volumes[volumeIndex].probeBakeEnabled = false;
+                        }
 
                         // Add the volume to the list of volumes to update (it hasn't converged)
-                        if (!isConverged) resources.selectedVolumes.push_back(volume);
+                        if (!isConverged || volume->GetProbeConvergenceFreezeOnGPU()) resources.selectedVolumes.push_back(volume);
                     }
+                    if (d3d.DDGIClipmap) resources.clipmap.Update();
+
+                    // Order the volumes for blending, the volumes can move and change spacing
+                    SortDDGIVolumeBlendOrder(resources, config);
 
                     // Update the constants for the selected DDGIVolumes
-                    for (UINT volumeIndex = 0; volumeIndex < static_cast<UINT>(resources.selectedVolumes.size()); volumeIndex++)
-                    {
-                        resources.selectedVolumes[volumeIndex]->Update();
-                    }
+                    UpdateDDGIVolumes(resources);
 
+                    // Set the volumes' TLAS instance mask bits on the instances their probe rays can reach
+                    UpdateTLASVolumeBounds(d3d, d3dResources, resources, scene);
                 }
                 CPU_TIMESTAMP_END(resources.cpuStat);
             }
@@ -1734,7 +4807,7 @@ namespace Graphics
             void Execute(Globals& d3d, GlobalResources& d3dResources, Resources& resources)
             {
             #ifdef GFX_PERF_MARKERS
-                PIXBeginEvent(d3d.cmdList[d3d.frameIndex], PIX_COLOR(GFX_PERF_MARKER_GREEN), "RTXGI: DDGI");
+                PIXBeginEvent(GetCmdList(d3d), PIX_COLOR(GFX_PERF_MARKER_GREEN), "RTXGI: DDGI");
             #endif
                 CPU_TIMESTAMP_BEGIN(resources.cpuStat);
                 GPU_TIMESTAMP_BEGIN(resources.gpuStat->GetGPUQueryBeginIndex());
@@ -1742,91 +4815,240 @@ namespace Graphics
                 {
                     UINT numVolumes = static_cast<UINT>(resources.selectedVolumes.size());
 
+                    // Read back the counters of the frame that last used this frame's resources
+                    if (resources.gpuCounters) ReadGPUCounters(d3d, resources);
+
+                    // Call back the irradiance queries evaluated by the frame that last used this frame's resources
+                    if (!resources.irradianceQueryBatches[d3d.frameIndex].empty()) ReadIrradianceQueries(d3d, resources);
+
+                    // Call back the probe delta packet exported by the frame that last used this frame's resources
+                    if (resources.probeDeltaExports[d3d.frameIndex].callback) ReadProbeDeltas(d3d, resources);
+
                     // Upload volume resource indices and constants
-                    rtxgi::d3d12::UploadDDGIVolumeResourceIndices(d3d.cmdList[d3d.frameIndex], d3d.frameIndex, numVolumes, resources.selectedVolumes.data());
-                    rtxgi::d3d12::UploadDDGIVolumeConstants(d3d.cmdList[d3d.frameIndex], d3d.frameIndex, numVolumes, resources.selectedVolumes.data());
+                    rtxgi::d3d12::UploadDDGIVolumeResourceIndices(GetCmdList(d3d), d3d.frameIndex, numVolumes, resources.selectedVolumes.data());
+                    const DDGIVolumeDescGPUPacked* volumeDescs = (resources.selectedVolumeDescs.size() == numVolumes) ? resources.selectedVolumeDescs.data() : nullptr;
+                    rtxgi::d3d12::UploadDDGIVolumeConstants(GetCmdList(d3d), d3d.frameIndex, numVolumes, resources.selectedVolumes.data(), volumeDescs);
+                    UploadDDGIVolumeBounds(d3d, resources);
+
+                    // Copy the probes of double buffered volumes updated by the previous frame to the textures this frame samples
+                    for (DDGIVolumeBase* volumeBase : resources.volumes)
+                    {
+                        if (volumeBase == nullptr) continue;
+                        DDGIVolume* volume = static_cast<DDGIVolume*>(volumeBase);
+                        rtxgi::d3d12::PublishDDGIVolumeProbes(GetCmdList(d3d), 1, &volume);
+                    }
+
+                #if RTXGI_DDGI_RESOURCE_MANAGEMENT
+                    // Map memory to the sparse probe texture tiles that hold active probes before the probe trace writes them.
+                    // The mappings are updated on the graphics queue, which the probe update chain waits on (see below).
+                    for (DDGIVolumeBase* volumeBase : resources.volumes)
+                    {
+                        if (volumeBase == nullptr || !volumeBase->GetProbeSparseTexturesEnabled()) continue;
+                        DDGIVolume* volume = static_cast<DDGIVolume*>(volumeBase);
+                        rtxgi::d3d12::UpdateDDGIVolumeSparseTiles(d3d.cmdQueue, GetCmdList(d3d), d3d.frameIndex, 1, &volume);
+                    }
+                #endif
+
+                    // Patch a volume's probes with the tiles of a received probe delta packet
+                    if (!resources.probeDeltaImportsPending.empty()) ImportProbeDeltas(d3d, d3dResources, resources);
 
                     static int volumeIndex = 0;
-                    
+
+                    // Volumes whose probes are updated this frame. Without batching, the selected volumes take turns (one per frame).
+                    // With batched probe tracing, a single trace and resolve dispatch covers every selected volume, see UploadProbeTraceBatch().
+                    std::vector<DDGIVolume*>& updateVolumes = resources.updateVolumes;
+                    updateVolumes.clear();
+                    if (d3d.DDGIBatchProbeTrace)
+                    {
+                        updateVolumes = resources.selectedVolumes;
+                        if (!UploadProbeTraceBatch(d3d, resources, updateVolumes)) return;
+                    }
+                    else
+                    {
+                        // The number of selected volumes changes from frame to frame (convergence, clipmap levels)
+                        if (volumeIndex >= static_cast<int>(numVolumes)) volumeIndex = 0;
+                        if (numVolumes > 0) updateVolumes.push_back(resources.selectedVolumes[volumeIndex]);
+                    }
+
+                    // With async compute, the probe update chain is recorded on the compute command list. It starts once the
+                    // graphics work recorded so far (TLAS build, constant uploads, and the gather below) completes, and runs
+                    // alongside the rest of the frame. The gather consumes the probes updated by the previous frame's chain.
+                    // When every selected volume is double buffered, the gather only reads published probes and the chain is
+                    // submitted ahead of it, so the gather runs alongside the probe updates too.
+                    bool submitBeforeGather = d3d.DDGIAsyncCompute;
+                    for (const DDGIVolume* volume : resources.selectedVolumes) submitBeforeGather &= volume->GetProbeAtlasDoubleBuffered();
+
+                    ID3D12GraphicsCommandList4* updateCmdList = GetCmdList(d3d);
+                    if (d3d.DDGIAsyncCompute)
+                    {
+                        if (!ResetComputeCmdList(d3d)) return;
+                        updateCmdList = d3d.computeCmdList[d3d.frameIndex];
+                    }
+
                     // Trace rays from DDGI probes to sample the environment
                     // GPU_TIMESTAMP_BEGIN(resources.rtStat->GetGPUQueryBeginIndex());
                     // RayTraceVolumes(d3d, d3dResources, resources, resources.selectedVolumes[volumeIndex]);
                     // GPU_TIMESTAMP_END(resources.rtStat->GetGPUQueryEndIndex());
 
-                    GPU_TIMESTAMP_BEGIN(resources.rtStat->GetGPUQueryBeginIndex());
-                    RayTraceVolumeCS(d3d, d3dResources, resources, resources.selectedVolumes[volumeIndex]);
-                    GPU_TIMESTAMP_END(resources.rtStat->GetGPUQueryEndIndex());
+                    // Select the probes to update this frame if the feature is enabled
+                    for (DDGIVolume* volume : updateVolumes) rtxgi::d3d12::ScheduleDDGIVolumeProbes(updateCmdList, 1, volume);
+
+                    // Periodically free stale radiance cache slots before the probe trace claims this frame's slots
+                    if (d3d.RadianceCacheCompactionInterval > 0 && (d3d.frameNumber % d3d.RadianceCacheCompactionInterval) == 0)
+                    {
+                        DDGI_STAGE_TIMESTAMP_BEGIN(resources.radianceCacheCompactStat);
+                        CompactRadianceCache(d3d, d3dResources, resources, updateCmdList);
+                        DDGI_STAGE_TIMESTAMP_END(resources.radianceCacheCompactStat);
+                    }
+
+                    // Activate the transient buffers of the probe trace through the probe ray resolve
+                    AliasTransients(d3d, updateCmdList, ETransientPass::DDGI_PROBE_TRACE);
+
+                    DDGI_STAGE_TIMESTAMP_BEGIN(resources.rtStat);
+                    DDGI_PIPELINE_STATS_BEGIN(updateCmdList, PASS_PROBE_TRACE);
+                    RayTraceVolumeCS(d3d, d3dResources, resources, updateVolumes, updateCmdList);
+                    DDGI_PIPELINE_STATS_END(updateCmdList, PASS_PROBE_TRACE);
+                    DDGI_STAGE_TIMESTAMP_END(resources.rtStat);
 
                     // Clear accumulation buffer before radiance cache update (preserves temporal history)
-                    ClearRadianceCacheAccumulation(d3d, d3dResources, resources);
+                    DDGI_STAGE_TIMESTAMP_BEGIN(resources.radianceCacheStat);
+                    DDGI_STAGE_TIMESTAMP_BEGIN(resources.radianceCacheClearStat);
+                    ClearRadianceCacheAccumulation(d3d, d3dResources, resources, updateCmdList);
+                    DDGI_STAGE_TIMESTAMP_END(resources.radianceCacheClearStat);
 
-                    GPU_TIMESTAMP_BEGIN(resources.rtStat->GetGPUQueryBeginIndex());
-                    RayTraceRadianceCacheCS(d3d, d3dResources, resources);
-                    GPU_TIMESTAMP_END(resources.rtStat->GetGPUQueryEndIndex());
+                    RayTraceRadianceCacheCS(d3d, d3dResources, resources, updateCmdList);
+                    DDGI_STAGE_TIMESTAMP_END(resources.radianceCacheStat);
 
                     // Resolve cached radiance to RayData for all probe rays
                     // This scatters the world-space radiance cache to per-ray RayData
-                    ProbeRayResolveCS(d3d, d3dResources, resources, resources.selectedVolumes[volumeIndex]);
+                    // With the fused ray resolve, the probe blending reads the cache itself and only the rays the trace stored to RayData need a barrier
+                    // (the stage stays timed so its queries are always written)
+                    DDGI_STAGE_TIMESTAMP_BEGIN(resources.resolveStat);
+                    DDGI_PIPELINE_STATS_BEGIN(updateCmdList, PASS_PROBE_RAY_RESOLVE);
+                    if (d3d.DDGIFusedRayResolve) ProbeRayDataBarriers(d3d, updateVolumes, updateCmdList);
+                    else ProbeRayResolveCS(d3d, d3dResources, resources, updateVolumes, updateCmdList);
+                    DDGI_PIPELINE_STATS_END(updateCmdList, PASS_PROBE_RAY_RESOLVE);
+                    DDGI_STAGE_TIMESTAMP_END(resources.resolveStat);
+
+                    // The barriers that end each SDK stage are batched across the volumes and flushed once per stage
+                    std::vector<D3D12_RESOURCE_BARRIER>& stageBarriers = resources.stageBarriers;
+                    stageBarriers.clear();
 
                     // Update volume probes
-                    GPU_TIMESTAMP_BEGIN(resources.blendStat->GetGPUQueryBeginIndex());
-                    rtxgi::d3d12::UpdateDDGIVolumeProbes(d3d.cmdList[d3d.frameIndex], numVolumes, resources.selectedVolumes[volumeIndex]);
-                    GPU_TIMESTAMP_END(resources.blendStat->GetGPUQueryEndIndex());
+                    // Note: the SDK blending shaders are compiled per volume (rays per probe, texel counts), so blending stays one dispatch per volume
+                    DDGI_STAGE_TIMESTAMP_BEGIN(resources.blendStat);
+                    for (DDGIVolume* volume : updateVolumes)
+                    {
+                        // Volumes added by a reload have no stat of their own
+                        Instrumentation::Stat* volumeStat = nullptr;
+                        if (volume->GetIndex() < static_cast<uint32_t>(resources.volumeBlendStats.size())) volumeStat = resources.volumeBlendStats[volume->GetIndex()];
+
+                        if (volumeStat) DDGI_STAGE_TIMESTAMP_BEGIN(volumeStat);
+                        rtxgi::d3d12::UpdateDDGIVolumeProbes(updateCmdList, 1, volume, &stageBarriers);
+                        if (volumeStat) DDGI_STAGE_TIMESTAMP_END(volumeStat);
+                    }
+                    FlushBarriers(d3d, updateCmdList, stageBarriers);
+
+                    // Overwrite the blended probes of volumes that derive the probes inside a nested volume from it, if the feature is enabled
+                    for (DDGIVolume* volume : updateVolumes) rtxgi::d3d12::DeriveDDGIVolumeProbes(updateCmdList, 1, volume);
+                    DDGI_STAGE_TIMESTAMP_END(resources.blendStat);
 
                     // Relocate probes if the feature is enabled
-                    GPU_TIMESTAMP_BEGIN(resources.relocateStat->GetGPUQueryBeginIndex());
-                    rtxgi::d3d12::RelocateDDGIVolumeProbes(d3d.cmdList[d3d.frameIndex], numVolumes, resources.selectedVolumes[volumeIndex]);
-                    GPU_TIMESTAMP_END(resources.relocateStat->GetGPUQueryEndIndex());
+                    DDGI_STAGE_TIMESTAMP_BEGIN(resources.relocateStat);
+                    for (DDGIVolume* volume : updateVolumes) rtxgi::d3d12::RelocateDDGIVolumeProbes(updateCmdList, 1, volume, &stageBarriers);
+                    FlushBarriers(d3d, updateCmdList, stageBarriers);
+                    DDGI_STAGE_TIMESTAMP_END(resources.relocateStat);
 
                     // Classify probes if the feature is enabled
-                    GPU_TIMESTAMP_BEGIN(resources.classifyStat->GetGPUQueryBeginIndex());
-                    rtxgi::d3d12::ClassifyDDGIVolumeProbes(d3d.cmdList[d3d.frameIndex], numVolumes, resources.selectedVolumes[volumeIndex]);
-                    GPU_TIMESTAMP_END(resources.classifyStat->GetGPUQueryEndIndex());
+                    DDGI_STAGE_TIMESTAMP_BEGIN(resources.classifyStat);
+                    for (DDGIVolume* volume : updateVolumes) rtxgi::d3d12::ClassifyDDGIVolumeProbes(updateCmdList, 1, volume, &stageBarriers);
+                    FlushBarriers(d3d, updateCmdList, stageBarriers);
+                    DDGI_STAGE_TIMESTAMP_END(resources.classifyStat);
 
                     // Calculate variability
-                    GPU_TIMESTAMP_BEGIN(resources.variabilityStat->GetGPUQueryBeginIndex());
-                    rtxgi::d3d12::CalculateDDGIVolumeVariability(d3d.cmdList[d3d.frameIndex], numVolumes, resources.selectedVolumes[volumeIndex]);
-                    // The readback happens immediately, not recorded on the command list, so will return a value from a previous update
-                    rtxgi::d3d12::ReadbackDDGIVolumeVariability(numVolumes, resources.selectedVolumes[volumeIndex]);
-                    GPU_TIMESTAMP_END(resources.variabilityStat->GetGPUQueryEndIndex());
+                    DDGI_STAGE_TIMESTAMP_BEGIN(resources.variabilityStat);
+                    for (DDGIVolume* volume : updateVolumes)
+                    {
+                        // Copied to this frame index's readback slot, read back in Update() MAX_FRAMES_IN_FLIGHT frames from now
+                        rtxgi::d3d12::CalculateDDGIVolumeVariability(updateCmdList, d3d.frameIndex, 1, volume, &stageBarriers);
+                    }
+                    FlushBarriers(d3d, updateCmdList, stageBarriers);
+                    DDGI_STAGE_TIMESTAMP_END(resources.variabilityStat);
+
+                    // Return the updated probe textures of double buffered volumes to read-only, ready for the next frame's publish
+                    for (DDGIVolume* volume : updateVolumes)
+                    {
+                        if (volume->GetProbeAtlasDoubleBuffered()) volume->TransitionResources(updateCmdList, EDDGIExecutionStage::PRE_GATHER_CS);
+                    }
+
+                    // Reduce the radiance cache occupancy, then copy (and clear) this frame's GPU counters for a later frame's readback
+                    if (resources.gpuCounters)
+                    {
+                        ReduceRadianceCacheStats(d3d, d3dResources, resources, updateCmdList);
+                        CopyGPUCounters(d3d, resources, updateCmdList);
+                    }
+
+                    // Kick off the probe update chain ahead of the gather, it only reads published probes
+                    if (submitBeforeGather)
+                    {
+                    #ifdef GFX_PERF_MARKERS
+                        PIXEndEvent(GetCmdList(d3d));
+                    #endif
+                        if (!SubmitComputeCmdList(d3d)) return;
+                    #ifdef GFX_PERF_MARKERS
+                        PIXBeginEvent(GetCmdList(d3d), PIX_COLOR(GFX_PERF_MARKER_GREEN), "RTXGI: DDGI");
+                    #endif
+                    }
 
                     // Gather indirect lighting in screen-space
                     GPU_TIMESTAMP_BEGIN(resources.lightingStat->GetGPUQueryBeginIndex());
                     GatherIndirectLighting(d3d, d3dResources, resources);
                     GPU_TIMESTAMP_END(resources.lightingStat->GetGPUQueryEndIndex());
 
+                    // Evaluate the irradiance queries of the CPU, read back MAX_FRAMES_IN_FLIGHT frames from now
+                    if (!resources.irradianceQueriesPending.empty()) EvaluateIrradianceQueries(d3d, d3dResources, resources);
+
+                    // Export a volume's changed probe tiles, read back MAX_FRAMES_IN_FLIGHT frames from now
+                    if (!resources.probeDeltaExportsPending.empty()) ExportProbeDeltas(d3d, d3dResources, resources);
+
+                    // Kick off the probe update chain behind the graphics work recorded so far
+                    if (d3d.DDGIAsyncCompute && !submitBeforeGather)
+                    {
+                    #ifdef GFX_PERF_MARKERS
+                        PIXEndEvent(GetCmdList(d3d));
+                    #endif
+                        if (!SubmitComputeCmdList(d3d)) return;
+                    #ifdef GFX_PERF_MARKERS
+                        PIXBeginEvent(GetCmdList(d3d), PIX_COLOR(GFX_PERF_MARKER_GREEN), "RTXGI: DDGI");
+                    #endif
+                    }
+
                     volumeIndex++;
-                    volumeIndex %= numVolumes;
+                    if (numVolumes > 0) volumeIndex %= numVolumes;
                 }
                 GPU_TIMESTAMP_END(resources.gpuStat->GetGPUQueryEndIndex());
                 CPU_TIMESTAMP_ENDANDRESOLVE(resources.cpuStat);
 
             #ifdef GFX_PERF_MARKERS
-                PIXEndEvent(d3d.cmdList[d3d.frameIndex]);
+                PIXEndEvent(GetCmdList(d3d));
             #endif
             }
 
             /**
              * Release resources.
              */
-            void Cleanup(Resources& resources)
+            void Cleanup(Globals& d3d, Resources& resources)
             {
+                // Wait for a pending background reload and discard it
+                ReleaseReload(resources);
+                resources.volumeShaderPermutations.Release();
+                resources.volumeWorkers.Stop();
+
                 SAFE_RELEASE(resources.output);
 
                 SAFE_RELEASE(resources.shaderTable);
                 SAFE_RELEASE(resources.shaderTableUpload);
-                resources.rtShaders.Release();
-                resources.indirectCS.Release();
-                resources.probeTraceCS.Release();
-                resources.radianceCacheCS.Release();
-                resources.probeRayResolveCS.Release();
-
-                SAFE_RELEASE(resources.rtpso);
-                SAFE_RELEASE(resources.rtpsoInfo);
-                SAFE_RELEASE(resources.indirectPSO);
-                SAFE_RELEASE(resources.probeTracePSO);
-                SAFE_RELEASE(resources.radianceCachePSO);
-                SAFE_RELEASE(resources.probeRayResolvePSO);
+                ReleaseShadersAndPSOs(resources);
 
                 resources.shaderTableSize = 0;
                 resources.shaderTableRecordSize = 0;
@@ -1837,6 +5059,11 @@ namespace Graphics
                 resources.shaderTableMissTableStartAddress = 0;
                 resources.shaderTableHitGroupTableStartAddress = 0;
 
+                resources.radianceCacheShaderTableRGSStartAddress = 0;
+                resources.radianceCacheShaderTableMissTableStartAddress = 0;
+                resources.radianceCacheShaderTableHitGroupTableStartAddress = 0;
+                resources.radianceCacheShaderTableHitGroupTableSize = 0;
+
                 SAFE_RELEASE(resources.rtvDescriptorHeap);
                 SAFE_RELEASE(resources.volumeResourceIndicesSTB);
                 SAFE_RELEASE(resources.volumeResourceIndicesSTBUpload);
@@ -1845,16 +5072,63 @@ namespace Graphics
                 SAFE_RELEASE(resources.volumeConstantsSTB);
                 SAFE_RELEASE(resources.volumeConstantsSTBUpload);
                 resources.volumeConstantsSTBSizeInBytes = 0;
+                SAFE_RELEASE(resources.volumeBoundsSTB);
+                SAFE_RELEASE(resources.volumeBoundsSTBUpload);
+                resources.volumeBoundsSTBSizeInBytes = 0;
 
-                SAFE_RELEASE(resources.HitCachingResource);
+                ReleaseTransient(d3d, resources.HitCachingResource);
                 SAFE_RELEASE(resources.RadianceCachingResource);
                 SAFE_RELEASE(resources.RadianceCachingVisualizationResource);
-                SAFE_RELEASE(resources.RadianceCacheAccumulationResource);
+                ReleaseTransient(d3d, resources.RadianceCacheAccumulationResource);
                 SAFE_RELEASE(resources.RadianceCacheMetadataResource);
-                SAFE_RELEASE(resources.ProbeRayHitMapResource);
+                SAFE_RELEASE(resources.RadianceCacheReservoirResource);
+                ReleaseTransient(d3d, resources.ProbeRayHitMapResource);
+                SAFE_RELEASE(resources.RadianceCacheWorkListResource);
+                SAFE_RELEASE(resources.RadianceCacheWorkListArgsResource);
+                SAFE_RELEASE(resources.RadianceCacheSortedWorkListResource);
+                SAFE_RELEASE(resources.RadianceCacheSortBinsResource);
+                SAFE_RELEASE(resources.RadianceCacheBudgetResource);
+                SAFE_RELEASE(resources.LightGridResource);
+                SAFE_RELEASE(resources.ProbeTraceBatchResource);
+                SAFE_RELEASE(resources.ProbeTraceBatchUploadResource);
+                resources.ProbeTraceBatchSizeInBytes = 0;
+
+                SAFE_RELEASE(resources.gpuCounters);
+                SAFE_RELEASE(resources.gpuCountersClear);
+                SAFE_RELEASE(resources.radianceCacheStats);
+                for (UINT frameIndex = 0; frameIndex < MAX_FRAMES_IN_FLIGHT; frameIndex++)
+                {
+                    SAFE_RELEASE(resources.gpuCountersReadback[frameIndex]);
+                    resources.gpuCountersReadbackFrame[frameIndex] = 0;
+                }
+                SAFE_RELEASE(resources.pipelineStatsHeap);
+                resources.counters = nullptr;
+
+                SAFE_RELEASE(resources.irradianceQueries);
+                for (UINT frameIndex = 0; frameIndex < MAX_FRAMES_IN_FLIGHT; frameIndex++)
+                {
+                    SAFE_RELEASE(resources.irradianceQueriesUpload[frameIndex]);
+                    SAFE_RELEASE(resources.irradianceQueriesReadback[frameIndex]);
+                    resources.irradianceQueryBatches[frameIndex].clear();
+                }
+                resources.irradianceQueriesPending.clear();
+                resources.irradianceQueryBatchesPending.clear();
+
+                SAFE_RELEASE(resources.probeDeltas);
+                for (UINT frameIndex = 0; frameIndex < MAX_FRAMES_IN_FLIGHT; frameIndex++)
+                {
+                    SAFE_RELEASE(resources.probeDeltasUpload[frameIndex]);
+                    SAFE_RELEASE(resources.probeDeltasReadback[frameIndex]);
+                    resources.probeDeltaExports[frameIndex] = {};
+                }
+                resources.probeDeltaPacketSize = 0;
+                resources.probeDeltaVolumes.clear();
+                resources.probeDeltaExportsPending.clear();
+                resources.probeDeltaImportsPending.clear();
                 SAFE_RELEASE(resources.probeRayResolvePSO);
 
-                // Release volumes
+                // Release the clipmap and volumes
+                resources.clipmap.Destroy();
                 for (size_t volumeIndex = 0; volumeIndex < resources.volumes.size(); volumeIndex++)
                 {
                 #if !RTXGI_DDGI_RESOURCE_MANAGEMENT
@@ -1863,10 +5137,187 @@ namespace Graphics
                     SAFE_DELETE(resources.volumeDescs[volumeIndex].name);
                     resources.volumes[volumeIndex]->Destroy();
                     SAFE_DELETE(resources.volumes[volumeIndex]);
+                    SAFE_RELEASE(resources.bakedIrradiance[volumeIndex]);
                 }
+            #if RTXGI_DDGI_RESOURCE_MANAGEMENT
+                DestroyDDGIVolumeResourcePool(resources.volumePool);
+            #endif
                 resources.volumeDescs.clear();
                 resources.volumes.clear();
+                resources.bakedIrradiance.clear();
                 resources.selectedVolumes.clear();
+                resources.eventLights.clear();
+                resources.volumeBlendStats.clear();  // the stats are owned (and deleted) by Instrumentation::Performance
+            }
+
+            /**
+             * Load the probe textures of the volumes with a probe cache from their cache files.
+             * A missing or out of date cache leaves the volume's probes cleared, the probes are cached again at shutdown.
+             * Note: call after the volumes are created and cleared on the GPU (after Graphics::PostInitialize()).
+             */
+            bool LoadVolumeCaches(Globals& d3d, GlobalResources& d3dResources, Resources& resources, const Configs::Config& config, const Scenes::Scene& scene, std::ofstream& log)
+            {
+                for (UINT volumeIndex = 0; volumeIndex < static_cast<UINT>(resources.volumes.size()); volumeIndex++)
+                {
+                    if (!config.ddgi.volumes[volumeIndex].probeCacheEnabled) continue;
+
+                    // Scrolling volumes move their probes at runtime, their textures don't belong to a fixed origin
+                    DDGIVolume* volume = static_cast<DDGIVolume*>(resources.volumes[volumeIndex]);
+                    if (volume->GetMovementType() == EDDGIVolumeMovementType::Scrolling) continue;
+
+                    std::string filepath = GetDDGIVolumeCachePath(config, volume);
+                    uint64_t key = GetDDGIVolumeCacheKey(config, scene, volume->GetDesc());
+
+                    Caches::DDGIVolumeCache cache;
+                    if (!Caches::Deserialize(filepath, key, cache, log)) continue;
+
+                    // Validate every texture before writing any of them
+                    if (!GetDDGIVolumeTextureMatches(d3d, volume->GetProbeIrradiance(), cache.irradiance)
+                        || !GetDDGIVolumeTextureMatches(d3d, volume->GetProbeDistance(), cache.distance)
+                        || !GetDDGIVolumeTextureMatches(d3d, volume->GetProbeData(), cache.probeData)
+                        || !GetDDGIVolumeTextureMatches(d3d, volume->GetProbeVariability(), cache.variability))
+                    {
+                        log << "\n\tWarning: DDGIVolume cache file \'" + filepath + "\' does not match the volume's textures";
+                        continue;
+                    }
+
+                    if (!WriteDDGIVolumeTexture(d3d, volume->GetProbeIrradiance(), D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, cache.irradiance)) return false;
+                    if (!WriteDDGIVolumeTexture(d3d, volume->GetProbeDistance(), D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, cache.distance)) return false;
+                    if (!WriteDDGIVolumeTexture(d3d, volume->GetProbeData(), D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, cache.probeData)) return false;
+                    if (!WriteDDGIVolumeTexture(d3d, volume->GetProbeVariability(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, cache.variability)) return false;
+
+                    log << "\n\tLoaded DDGIVolume cache file \'" + filepath + "\'";
+                }
+                return true;
+            }
+
+            /**
+             * Write the probe textures of the volumes with a probe cache to their cache files.
+             * Note: call when the GPU is idle (at shutdown).
+             */
+            bool StoreVolumeCaches(Globals& d3d, GlobalResources& d3dResources, Resources& resources, const Configs::Config& config, const Scenes::Scene& scene, std::ofstream& log)
+            {
+                for (UINT volumeIndex = 0; volumeIndex < static_cast<UINT>(resources.volumes.size()); volumeIndex++)
+                {
+                    if (!config.ddgi.volumes[volumeIndex].probeCacheEnabled) continue;
+
+                    DDGIVolume* volume = static_cast<DDGIVolume*>(resources.volumes[volumeIndex]);
+                    if (volume->GetMovementType() == EDDGIVolumeMovementType::Scrolling) continue;
+
+                    Caches::DDGIVolumeCache cache;
+                    cache.key = GetDDGIVolumeCacheKey(config, scene, volume->GetDesc());
+
+                    if (!ReadDDGIVolumeTexture(d3d, volume->GetProbeIrradiance(), D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, cache.irradiance)) return false;
+                    if (!ReadDDGIVolumeTexture(d3d, volume->GetProbeDistance(), D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, cache.distance)) return false;
+                    if (!ReadDDGIVolumeTexture(d3d, volume->GetProbeData(), D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, cache.probeData)) return false;
+                    if (!ReadDDGIVolumeTexture(d3d, volume->GetProbeVariability(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, cache.variability)) return false;
+
+                    if (!Caches::Serialize(GetDDGIVolumeCachePath(config, volume), cache, log)) return false;
+                }
+                return true;
+            }
+
+            /**
+             * Load the radiance cache cells from the scene's radiance cache file.
+             * A missing or out of date file leaves the radiance cache empty, the cells are stored again at shutdown.
+             * Note: call after the radiance cache is created and reset on the GPU (after Graphics::PostInitialize()).
+             */
+            bool LoadRadianceCache(Globals& d3d, GlobalResources& d3dResources, Resources& resources, const Configs::Config& config, const Scenes::Scene& scene, std::ofstream& log)
+            {
+                if (!config.ddgi.radianceCacheFileEnabled) return true;
+
+                std::string filepath = GetRadianceCachePath(config);
+                uint64_t key = GetRadianceCacheKey(d3d, config, scene, resources);
+
+                Caches::RadianceCacheCells cells;
+                if (!Caches::Deserialize(filepath, key, cells, log)) return true;
+
+                const UINT slotCount = resources.CascadeCellNum;
+                const UINT metadataStride = RADIANCE_CACHE_METADATA_STRIDE;
+                const UINT radianceStride = (d3d.RadianceCacheRadianceFormat == 0) ? sizeof(float3) : sizeof(uint32_t);
+                const UINT historyStride = sizeof(RadianceCacheVisualization);
+                if (cells.slotCount != slotCount || cells.metadataStride != metadataStride || cells.radianceStride != radianceStride || cells.historyStride != historyStride)
+                {
+                    log << "\n\tWarning: radiance cache file \'" + filepath + "\' does not match the radiance cache buffers";
+                    return true;
+                }
+
+                // Put the cells back in their slots, the other slots are empty
+                std::vector<uint8_t> metadata(static_cast<size_t>(metadataStride) * slotCount, 0);
+                std::vector<uint8_t> radiance(static_cast<size_t>(radianceStride) * slotCount, 0);
+                std::vector<uint8_t> history(static_cast<size_t>(historyStride) * slotCount, 0);
+
+                // The metadata frames (last used, last shaded) are from the previous run, restart them at this frame
+                // so the cells aren't evicted as stale. Tombstones (see SpatialHash.hlsl) keep their zero frames.
+                const uint32_t frame = (std::max)(d3d.frameNumber, 1u);
+                for (size_t cellIndex = 0; cellIndex < cells.slots.size(); cellIndex++)
+                {
+                    const uint32_t slot = cells.slots[cellIndex];
+                    if (slot >= slotCount)
+                    {
+                        log << "\n\tWarning: radiance cache file \'" + filepath + "\' is truncated or corrupt";
+                        return true;
+                    }
+
+                    uint32_t* cellMetadata = reinterpret_cast<uint32_t*>(metadata.data() + (static_cast<size_t>(slot) * metadataStride));
+                    memcpy(cellMetadata, cells.metadata.data() + (cellIndex * metadataStride), metadataStride);
+                    memcpy(radiance.data() + (static_cast<size_t>(slot) * radianceStride), cells.radiance.data() + (cellIndex * radianceStride), radianceStride);
+                    memcpy(history.data() + (static_cast<size_t>(slot) * historyStride), cells.history.data() + (cellIndex * historyStride), historyStride);
+
+                    // The light visibility was traced against the previous run's lights, refresh it
+                    cellMetadata[5] = 0;
+                    cellMetadata[6] = 0;
+                    cellMetadata[7] = 0;
+
+                    if (cellMetadata[0] == 0xFFFFFFFF) continue;
+                    cellMetadata[1] = frame;
+                    if (cellMetadata[2] != 0) cellMetadata[2] = frame;
+                }
+
+                if (!WriteRadianceCacheBuffer(d3d, resources.RadianceCacheMetadataResource, metadata)) return false;
+                if (!WriteRadianceCacheBuffer(d3d, resources.RadianceCachingResource, radiance)) return false;
+                if (!WriteRadianceCacheBuffer(d3d, resources.RadianceCachingVisualizationResource, history)) return false;
+
+                log << "\n\tLoaded " << cells.slots.size() << " cells from radiance cache file \'" + filepath + "\'";
+                return true;
+            }
+
+            /**
+             * Write the occupied radiance cache slots to the scene's radiance cache file.
+             * Tombstones are stored too, the probe sequences that run through them still reach the cells after them.
+             * Note: call when the GPU is idle (at shutdown).
+             */
+            bool StoreRadianceCache(Globals& d3d, GlobalResources& d3dResources, Resources& resources, const Configs::Config& config, const Scenes::Scene& scene, std::ofstream& log)
+            {
+                if (!config.ddgi.radianceCacheFileEnabled) return true;
+
+                std::vector<uint8_t> metadata, radiance, history;
+                if (!ReadRadianceCacheBuffer(d3d, resources.RadianceCacheMetadataResource, metadata)) return false;
+                if (!ReadRadianceCacheBuffer(d3d, resources.RadianceCachingResource, radiance)) return false;
+                if (!ReadRadianceCacheBuffer(d3d, resources.RadianceCachingVisualizationResource, history)) return false;
+
+                Caches::RadianceCacheCells cells;
+                cells.key = GetRadianceCacheKey(d3d, config, scene, resources);
+                cells.slotCount = resources.CascadeCellNum;
+                cells.metadataStride = RADIANCE_CACHE_METADATA_STRIDE;
+                cells.radianceStride = (d3d.RadianceCacheRadianceFormat == 0) ? sizeof(float3) : sizeof(uint32_t);
+                cells.historyStride = sizeof(RadianceCacheVisualization);
+
+                for (uint32_t slot = 0; slot < cells.slotCount; slot++)
+                {
+                    const uint8_t* cellMetadata = metadata.data() + (static_cast<size_t>(slot) * cells.metadataStride);
+                    if (*reinterpret_cast<const uint32_t*>(cellMetadata) == 0) continue;
+
+                    const uint8_t* cellRadiance = radiance.data() + (static_cast<size_t>(slot) * cells.radianceStride);
+                    const uint8_t* cellHistory = history.data() + (static_cast<size_t>(slot) * cells.historyStride);
+
+                    cells.slots.push_back(slot);
+                    cells.metadata.insert(cells.metadata.end(), cellMetadata, cellMetadata + cells.metadataStride);
+                    cells.radiance.insert(cells.radiance.end(), cellRadiance, cellRadiance + cells.radianceStride);
+                    cells.history.insert(cells.history.end(), cellHistory, cellHistory + cells.historyStride);
+                }
+
+                return Caches::Serialize(GetRadianceCachePath(config), cells, log);
             }
 
             /**
@@ -1950,6 +5401,21 @@ namespace Graphics
             return Graphics::D3D12::DDGI::Reload(d3d, d3dResources, resources, config, log);
         }
 
+        bool ReloadAsync(Globals& d3d, GlobalResources& d3dResources, Resources& resources, const Configs::Config& config, std::ofstream& log)
+        {
+            return Graphics::D3D12::DDGI::ReloadAsync(d3d, d3dResources, resources, config, log);
+        }
+
+        EReloadStatus FinishReload(Globals& d3d, GlobalResources& d3dResources, Resources& resources, const Configs::Config& config, std::ofstream& log)
+        {
+            return Graphics::D3D12::DDGI::FinishReload(d3d, d3dResources, resources, config, log);
+        }
+
+        bool ApplyVolumeChanges(Globals& d3d, GlobalResources& d3dResources, Resources& resources, const Configs::Config& config, const std::vector<Configs::EDDGIVolumeChange>& changes, std::ofstream& log)
+        {
+            return Graphics::D3D12::DDGI::ApplyVolumeChanges(d3d, d3dResources, resources, config, changes, log);
+        }
+
         bool Resize(Globals& d3d, GlobalResources& d3dResources, Resources& resources, std::ofstream& log)
         {
             return Graphics::D3D12::DDGI::Resize(d3d, d3dResources, resources, log);
@@ -1967,7 +5433,42 @@ namespace Graphics
 
         void Cleanup(Globals& d3d, Resources& resources)
         {
-            Graphics::D3D12::DDGI::Cleanup(resources);
+            Graphics::D3D12::DDGI::Cleanup(d3d, resources);
+        }
+
+        bool QueueIrradianceQueries(Resources& resources, const IrradianceQuery* queries, uint32_t count, std::function<void(const float4* results, uint32_t count)> callback)
+        {
+            return Graphics::D3D12::DDGI::QueueIrradianceQueries(resources, queries, count, std::move(callback));
+        }
+
+        bool QueueProbeDeltaExport(Resources& resources, uint32_t volumeIndex, float threshold, std::function<void(const uint8_t* packet, uint32_t size)> callback)
+        {
+            return Graphics::D3D12::DDGI::QueueProbeDeltaExport(resources, volumeIndex, threshold, std::move(callback));
+        }
+
+        bool QueueProbeDeltaImport(Resources& resources, uint32_t volumeIndex, const uint8_t* packet, uint32_t size)
+        {
+            return Graphics::D3D12::DDGI::QueueProbeDeltaImport(resources, volumeIndex, packet, size);
+        }
+
+        bool LoadVolumeCaches(Globals& d3d, GlobalResources& d3dResources, Resources& resources, const Configs::Config& config, const Scenes::Scene& scene, std::ofstream& log)
+        {
+            return Graphics::D3D12::DDGI::LoadVolumeCaches(d3d, d3dResources, resources, config, scene, log);
+        }
+
+        bool StoreVolumeCaches(Globals& d3d, GlobalResources& d3dResources, Resources& resources, const Configs::Config& config, const Scenes::Scene& scene, std::ofstream& log)
+        {
+            return Graphics::D3D12::DDGI::StoreVolumeCaches(d3d, d3dResources, resources, config, scene, log);
+        }
+
+        bool LoadRadianceCache(Globals& d3d, GlobalResources& d3dResources, Resources& resources, const Configs::Config& config, const Scenes::Scene& scene, std::ofstream& log)
+        {
+            return Graphics::D3D12::DDGI::LoadRadianceCache(d3d, d3dResources, resources, config, scene, log);
+        }
+
+        bool StoreRadianceCache(Globals& d3d, GlobalResources& d3dResources, Resources& resources, const Configs::Config& config, const Scenes::Scene& scene, std::ofstream& log)
+        {
+            return Graphics::D3D12::DDGI::StoreRadianceCache(d3d, d3dResources, resources, config, scene, log);
         }
 
         bool WriteVolumesToDisk(Globals& d3d, GlobalResources& d3dResources, Resources& resources, std::string directory)
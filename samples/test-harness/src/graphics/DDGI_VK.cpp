@@ -19,6 +19,14 @@ using namespace rtxgi::vulkan;
 #error RTXGI SDK DDGI Managed Mode is not compatible with bindless resources!
 #endif
 
+// Timestamps of the probe update stages. With async compute, the stages are recorded on the compute command buffer
+// and overlap the rest of the frame, so they are not timed.
+#define DDGI_STAGE_TIMESTAMP_BEGIN(x) if (!vk.DDGIAsyncCompute) { GPU_TIMESTAMP_BEGIN(x->GetGPUQueryBeginIndex()) }
+#define DDGI_STAGE_TIMESTAMP_END(x) if (!vk.DDGIAsyncCompute) { GPU_TIMESTAMP_END(x->GetGPUQueryEndIndex()) }
+
+// Bytes of radiance cache metadata per slot: checksum, age, shaded frame, volatility, light visibility, probe rays (see SpatialHash.hlsl)
+#define RADIANCE_CACHE_METADATA_STRIDE 32
+
 namespace Graphics
 {
     namespace Vulkan
@@ -297,13 +305,13 @@ namespace Graphics
                         { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, arraySize }
                     };
 
-                    SetImageLayoutBarrier(vk.cmdBuffer[vk.frameIndex], volumeResources.unmanaged.probeRayData, barrier);
-                    SetImageLayoutBarrier(vk.cmdBuffer[vk.frameIndex], volumeResources.unmanaged.probeIrradiance, barrier);
-                    SetImageLayoutBarrier(vk.cmdBuffer[vk.frameIndex], volumeResources.unmanaged.probeDistance, barrier);
-                    SetImageLayoutBarrier(vk.cmdBuffer[vk.frameIndex], volumeResources.unmanaged.probeData, barrier);
-                    SetImageLayoutBarrier(vk.cmdBuffer[vk.frameIndex], volumeResources.unmanaged.probeVariability, barrier);
+                    SetImageLayoutBarrier(GetCmdBuffer(vk), volumeResources.unmanaged.probeRayData, barrier);
+                    SetImageLayoutBarrier(GetCmdBuffer(vk), volumeResources.unmanaged.probeIrradiance, barrier);
+                    SetImageLayoutBarrier(GetCmdBuffer(vk), volumeResources.unmanaged.probeDistance, barrier);
+                    SetImageLayoutBarrier(GetCmdBuffer(vk), volumeResources.unmanaged.probeData, barrier);
+                    SetImageLayoutBarrier(GetCmdBuffer(vk), volumeResources.unmanaged.probeVariability, barrier);
                     barrier.subresourceRange.layerCount = variabilityAverageArraySize;
-                    SetImageLayoutBarrier(vk.cmdBuffer[vk.frameIndex], volumeResources.unmanaged.probeVariabilityAverage, barrier);
+                    SetImageLayoutBarrier(GetCmdBuffer(vk), volumeResources.unmanaged.probeVariabilityAverage, barrier);
                 }
 
                 // Set the pipeline layout and descriptor set
@@ -334,7 +342,7 @@ namespace Graphics
 
                         // Create the pipeline
                         CHECK(CreateComputePipeline(
-                            vk.device,
+                            vk,
                             volumeResources.unmanaged.pipelineLayout,
                             volumeShaders[shaderIndex],
                             volumeResources.unmanaged.probeBlendingIrradianceModule,
@@ -357,7 +365,7 @@ namespace Graphics
 
                         // Create the pipeline
                         CHECK(CreateComputePipeline(
-                            vk.device,
+                            vk,
                             volumeResources.unmanaged.pipelineLayout,
                             volumeShaders[shaderIndex],
                             volumeResources.unmanaged.probeBlendingDistanceModule,
@@ -380,7 +388,7 @@ namespace Graphics
 
                         // Create the pipeline
                         CHECK(CreateComputePipeline(
-                            vk.device,
+                            vk,
                             volumeResources.unmanaged.pipelineLayout,
                             volumeShaders[shaderIndex],
                             volumeResources.unmanaged.probeRelocation.updateModule,
@@ -404,7 +412,7 @@ namespace Graphics
 
                         // Create the pipeline
                         CHECK(CreateComputePipeline(
-                            vk.device,
+                            vk,
                             volumeResources.unmanaged.pipelineLayout,
                             volumeShaders[shaderIndex],
                             volumeResources.unmanaged.probeRelocation.resetModule,
@@ -428,7 +436,7 @@ namespace Graphics
 
                         // Create the pipeline
                         CHECK(CreateComputePipeline(
-                            vk.device,
+                            vk,
                             volumeResources.unmanaged.pipelineLayout,
                             volumeShaders[shaderIndex],
                             volumeResources.unmanaged.probeClassification.updateModule,
@@ -452,7 +460,7 @@ namespace Graphics
 
                         // Create the pipeline
                         CHECK(CreateComputePipeline(
-                            vk.device,
+                            vk,
                             volumeResources.unmanaged.pipelineLayout,
                             volumeShaders[shaderIndex],
                             volumeResources.unmanaged.probeClassification.resetModule,
@@ -476,7 +484,7 @@ namespace Graphics
 
                         // Create the pipeline
                         CHECK(CreateComputePipeline(
-                            vk.device,
+                            vk,
                             volumeResources.unmanaged.pipelineLayout,
                             volumeShaders[shaderIndex],
                             volumeResources.unmanaged.probeVariabilityPipelines.reductionModule,
@@ -500,7 +508,7 @@ namespace Graphics
 
                         // Create the pipeline
                         CHECK(CreateComputePipeline(
-                            vk.device,
+                            vk,
                             volumeResources.unmanaged.pipelineLayout,
                             volumeShaders[shaderIndex],
                             volumeResources.unmanaged.probeVariabilityPipelines.extraReductionModule,
@@ -594,6 +602,7 @@ namespace Graphics
 
                 volumeDesc.index = config.index;
                 volumeDesc.rngSeed = config.rngSeed;
+                volumeDesc.probeRayRotationType = config.probeRayRotationLowDiscrepancy ? EDDGIVolumeProbeRayRotationType::LowDiscrepancy : EDDGIVolumeProbeRayRotationType::Random;
                 volumeDesc.origin = { config.origin.x, config.origin.y, config.origin.z };
                 volumeDesc.eulerAngles = { config.eulerAngles.x, config.eulerAngles.y, config.eulerAngles.z, };
                 volumeDesc.probeSpacing = { config.probeSpacing.x, config.probeSpacing.y, config.probeSpacing.z };
@@ -624,6 +633,12 @@ namespace Graphics
                 volumeDesc.probeClassificationEnabled = config.probeClassificationEnabled;
                 volumeDesc.probeVariabilityEnabled = config.probeVariabilityEnabled;
 
+                volumeDesc.probeAdaptiveHysteresisEnabled = config.probeAdaptiveHysteresisEnabled;
+                volumeDesc.probeAdaptiveHysteresisMin = config.probeAdaptiveHysteresisMin;
+                volumeDesc.probeAdaptiveHysteresisMax = config.probeAdaptiveHysteresisMax;
+                volumeDesc.probeAdaptiveHysteresisVariabilityThreshold = config.probeAdaptiveHysteresisVariabilityThreshold;
+                volumeDesc.probeTimeSliceStrideLog2 = config.probeTimeSliceStrideLog2;
+
                 if (config.infiniteScrollingEnabled) volumeDesc.movementType = EDDGIVolumeMovementType::Scrolling;
                 else volumeDesc.movementType = EDDGIVolumeMovementType::Default;
             }
@@ -646,7 +661,7 @@ namespace Graphics
 
                 // Load and compile the volume's shaders
                 msg = "failed to compile shaders for DDGIVolume[" + std::to_string(volumeDesc.index) + "] (\"" + volumeDesc.name + "\")!\n";
-                CHECK(Graphics::DDGI::CompileDDGIVolumeShaders(vk, volumeDesc, volumeShaders, true, log), msg.c_str(), log);
+                CHECK(Graphics::DDGI::CompileDDGIVolumeShaders(vk, volumeDesc, volumeShaders, true, log, &resources.volumeShaderPermutations), msg.c_str(), log);
 
                 // When using the application's pipeline layout for bindless, pass an offset
                 // to where the DDGIConstants are in the application's push constants block
@@ -694,6 +709,9 @@ namespace Graphics
                 volumeResources.managed.physicalDevice = vk.physicalDevice;
                 volumeResources.managed.descriptorPool = vkResources.descriptorPool;
 
+                // Suballocate the probe texture memory from the memory pool shared with the scene resources
+                volumeResources.managed.memoryPool = vk.memoryPool;
+
                 // Pass compiled shader bytecode
                 assert(volumeShaders.size() >= 2);
                 volumeResources.managed.probeBlendingIrradianceCS = { volumeShaders[0].bytecode->GetBufferPointer(), volumeShaders[0].bytecode->GetBufferSize() };
@@ -758,6 +776,12 @@ namespace Graphics
                 DDGIVolumeDesc& volumeDesc = resources.volumeDescs[volumeConfig.index];
                 GetDDGIVolumeDesc(volumeConfig, volumeDesc);
 
+                // Relocate and classify probes with one wave per probe when a wave holds all of the fixed rays
+                volumeDesc.probeFixedRaysUseWaveOps = (vk.features.waveLaneCount >= 32);
+
+                // Sparse probe textures are D3D12 only, the SDK doesn't implement Vulkan sparse binding
+                CHECK(!volumeConfig.probeSparseTexturesEnabled, "create the DDGIVolume, sparse probe textures are not supported with Vulkan!\n", log);
+
                 // Describe the DDGIVolume's resources and shaders
                 DDGIVolumeResources volumeResources;
                 std::vector<Shaders::ShaderProgram> volumeShaders;
@@ -767,7 +791,7 @@ namespace Graphics
                 DDGIVolume* volume = new DDGIVolume();
 
             #if RTXGI_DDGI_RESOURCE_MANAGEMENT
-                ERTXGIStatus status = volume->Create(vk.cmdBuffer[vk.frameIndex], volumeDesc, volumeResources);
+                ERTXGIStatus status = volume->Create(GetCmdBuffer(vk), volumeDesc, volumeResources);
             #else
                 ERTXGIStatus status = volume->Create(volumeDesc, volumeResources);
             #endif
@@ -798,8 +822,8 @@ namespace Graphics
                 resources.volumeResourceIndicesSTBSizeInBytes = sizeof(DDGIVolumeResourceIndices) * volumeCount;
                 if (resources.volumeResourceIndicesSTBSizeInBytes == 0) return true; // scenes with no DDGIVolumes are valid
 
-                // Create the DDGIVolume resource indices upload buffer resources (double buffered)
-                BufferDesc desc = { 2 * resources.volumeResourceIndicesSTBSizeInBytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT };
+                // Create the DDGIVolume resource indices upload buffer resources (a copy per frame in flight)
+                BufferDesc desc = { MAX_FRAMES_IN_FLIGHT * resources.volumeResourceIndicesSTBSizeInBytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT };
                 CHECK(CreateBuffer(vk, desc, &resources.volumeResourceIndicesSTBUpload, &resources.volumeResourceIndicesSTBUploadMemory), "create DDGIVolume Resource Indices Upload Structured Buffer!\n", log);
             #ifdef GFX_NAME_OBJECTS
                 SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.volumeResourceIndicesSTBUpload), "DDGIVolume Resource Indices Upload Structured Buffer", VK_OBJECT_TYPE_BUFFER);
@@ -827,8 +851,8 @@ namespace Graphics
                 resources.volumeConstantsSTBSizeInBytes = sizeof(DDGIVolumeDescGPUPacked) * volumeCount;
                 if (resources.volumeConstantsSTBSizeInBytes == 0) return true; // scenes with no DDGIVolumes are valid
 
-                // Create the DDGIVolume constants upload buffer resources (double buffered)
-                BufferDesc desc = { 2 * resources.volumeConstantsSTBSizeInBytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT };
+                // Create the DDGIVolume constants upload buffer resources (a copy per frame in flight)
+                BufferDesc desc = { MAX_FRAMES_IN_FLIGHT * resources.volumeConstantsSTBSizeInBytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT };
                 CHECK(CreateBuffer(vk, desc, &resources.volumeConstantsSTBUpload, &resources.volumeConstantsSTBUploadMemory), "create DDGIVolume Constants Upload Structured Buffer!\n", log);
             #ifdef GFX_NAME_OBJECTS
                 SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.volumeConstantsSTBUpload), "DDGIVolume Constants Upload Structured Buffer", VK_OBJECT_TYPE_BUFFER);
@@ -852,6 +876,55 @@ namespace Graphics
             // Private Functions
             //----------------------------------------------------------------------------------------------------------
 
+            /**
+             * Create a device local radiance cache buffer, written by the DDGI compute passes and cleared with vkCmdFillBuffer.
+             */
+            bool CreateCachingBuffer(Globals& vk, VkDeviceSize size, VkBufferUsageFlags usage, const char* name, VkBuffer* buffer, VkDeviceMemory* memory, std::ofstream& log)
+            {
+                BufferDesc desc = { size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT };
+                CHECK(CreateBuffer(vk, desc, buffer, memory), "create " + std::string(name) + "!\n", log);
+            #ifdef GFX_NAME_OBJECTS
+                std::string memoryName = std::string(name) + " Memory";
+                SetObjectName(vk.device, reinterpret_cast<uint64_t>(*buffer), name, VK_OBJECT_TYPE_BUFFER);
+                SetObjectName(vk.device, reinterpret_cast<uint64_t>(*memory), memoryName.c_str(), VK_OBJECT_TYPE_DEVICE_MEMORY);
+            #endif
+                return true;
+            }
+
+            /**
+             * Create the radiance cache buffers (see DDGI_D3D12.cpp::CreateCachingBuffers()).
+             * All cascades share the buffers, each cascade owns CacheCount consecutive slots.
+             */
+            bool CreateCachingBuffers(Globals& vk, Resources& resources, const Configs::Config& config, std::ofstream& log)
+            {
+                VkDeviceSize count = resources.cascadeCellNum;
+
+                // The probe ray hit map has an entry per ray of every volume's probes
+                resources.totalProbeRays = 0;
+                for (const Configs::DDGIVolume& volumeConfig : config.ddgi.volumes)
+                {
+                    uint32_t numProbes = static_cast<uint32_t>(volumeConfig.probeCounts.x * volumeConfig.probeCounts.y * volumeConfig.probeCounts.z);
+                    resources.totalProbeRays += numProbes * volumeConfig.probeNumRays;
+                }
+
+                VkDeviceSize hitSize = vk.RadianceCacheCompactHits ? (sizeof(uint32_t) * 4) : sizeof(HitPackedData);
+                VkDeviceSize radianceSize = (vk.RadianceCacheRadianceFormat == 0) ? sizeof(float) * 3 : 4;
+
+                if (!CreateCachingBuffer(vk, hitSize * count, 0, "Hit Caching", &resources.hitCaching, &resources.hitCachingMemory, log)) return false;
+                if (!CreateCachingBuffer(vk, radianceSize * count, 0, "Radiance Caching", &resources.radianceCaching, &resources.radianceCachingMemory, log)) return false;
+                if (!CreateCachingBuffer(vk, sizeof(RadianceCacheVisualization) * count, 0, "Radiance Caching Visualization", &resources.radianceCachingVisualization, &resources.radianceCachingVisualizationMemory, log)) return false;
+                if (!CreateCachingBuffer(vk, sizeof(uint32_t) * 4 * count, 0, "Radiance Cache Accumulation", &resources.radianceCacheAccumulation, &resources.radianceCacheAccumulationMemory, log)) return false;
+                if (!CreateCachingBuffer(vk, RADIANCE_CACHE_METADATA_STRIDE * count, 0, "Radiance Cache Metadata", &resources.radianceCacheMetadata, &resources.radianceCacheMetadataMemory, log)) return false;
+                if (!CreateCachingBuffer(vk, sizeof(uint32_t) * 4 * count, 0, "Radiance Cache Reservoirs", &resources.radianceCacheReservoirs, &resources.radianceCacheReservoirsMemory, log)) return false;
+                if (!CreateCachingBuffer(vk, 8 * static_cast<VkDeviceSize>((std::max)(resources.totalProbeRays, 1u)), 0, "Probe Ray Hit Map", &resources.probeRayHitMap, &resources.probeRayHitMapMemory, log)) return false;
+
+                // The work list is padded to a whole thread group, the arguments are read by vkCmdDispatchIndirect
+                if (!CreateCachingBuffer(vk, sizeof(uint32_t) * (count + 64), 0, "Radiance Cache Work List", &resources.radianceCacheWorkList, &resources.radianceCacheWorkListMemory, log)) return false;
+                if (!CreateCachingBuffer(vk, sizeof(uint32_t) * 4, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, "Radiance Cache Work List Args", &resources.radianceCacheWorkListArgs, &resources.radianceCacheWorkListArgsMemory, log)) return false;
+
+                return true;
+            }
+
             bool CreateTextures(Globals& vk, GlobalResources& vkResources, Resources& resources, std::ofstream& log)
             {
                 // Release existing output texture
@@ -880,17 +953,58 @@ namespace Graphics
                     VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
                     { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
                 };
-                SetImageLayoutBarrier(vk.cmdBuffer[vk.frameIndex], resources.output, barrier);
+                SetImageLayoutBarrier(GetCmdBuffer(vk), resources.output, barrier);
 
                 return true;
             }
 
+            /**
+             * Set the SPIR-V target and the application's push constants layout of a DDGI compute shader.
+             */
+            void AddComputeShaderDefines(Shaders::ShaderProgram& shader)
+            {
+                shader.targetProfile = L"cs_6_6";
+                shader.arguments = { L"-spirv", L"-D __spirv__", L"-fspv-target-env=vulkan1.2" };
+
+                Shaders::AddDefine(shader, L"RTXGI_PUSH_CONSTS_TYPE", L"2");
+                Shaders::AddDefine(shader, L"RTXGI_PUSH_CONSTS_STRUCT_NAME", L"GlobalConstants");
+                Shaders::AddDefine(shader, L"RTXGI_PUSH_CONSTS_VARIABLE_NAME", L"GlobalConst");
+                Shaders::AddDefine(shader, L"RTXGI_PUSH_CONSTS_FIELD_DDGI_VOLUME_INDEX_NAME", L"ddgi_volumeIndex");
+                Shaders::AddDefine(shader, L"RTXGI_PUSH_CONSTS_FIELD_DDGI_REDUCTION_INPUT_SIZE_X_NAME", L"ddgi_reductionInputSizeX");
+                Shaders::AddDefine(shader, L"RTXGI_PUSH_CONSTS_FIELD_DDGI_REDUCTION_INPUT_SIZE_Y_NAME", L"ddgi_reductionInputSizeY");
+                Shaders::AddDefine(shader, L"RTXGI_PUSH_CONSTS_FIELD_DDGI_REDUCTION_INPUT_SIZE_Z_NAME", L"ddgi_reductionInputSizeZ");
+                Shaders::AddDefine(shader, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS));
+                Shaders::AddDefine(shader, L"RTXGI_COORDINATE_SYSTEM", std::to_wstring(RTXGI_COORDINATE_SYSTEM));
+            }
+
+            /**
+             * Set the radiance cache layout (cascades, spatial hash, slot formats) of a shader that reads or writes the cache.
+             */
+            void AddRadianceCacheDefines(Globals& vk, Shaders::ShaderProgram& shader, UINT numVolumes)
+            {
+                Shaders::AddDefine(shader, L"RADIANCE_CACHE_CASCADE_COUNT", std::to_wstring(numVolumes));
+                Shaders::AddDefine(shader, L"RADIANCE_CACHE_CASCADE_CELL_RADIUS", std::to_wstring(vk.CascadeCellRadius));
+                Shaders::AddDefine(shader, L"RADIANCE_CACHE_CASCADE_DISTANCE", std::to_wstring(vk.CascadeDistance));
+                Shaders::AddDefine(shader, L"RADIANCE_CACHE_CASCADE_MODE", std::to_wstring(vk.RadianceCacheCascadeMode));
+                Shaders::AddDefine(shader, L"RADIANCE_CACHE_HASH_FUNCTION", std::to_wstring(vk.RadianceCacheHashFunction));
+                Shaders::AddDefine(shader, L"RADIANCE_CACHE_BRICK_LAYOUT", std::to_wstring(vk.RadianceCacheBrickLayout ? 1 : 0));
+                Shaders::AddDefine(shader, L"RADIANCE_CACHE_CELL_COUNT", std::to_wstring(vk.CacheCount));
+                Shaders::AddDefine(shader, L"RADIANCE_CACHE_RADIANCE_FORMAT", std::to_wstring(vk.RadianceCacheRadianceFormat));
+                Shaders::AddDefine(shader, L"HIT_CACHE_COMPACT", std::to_wstring(vk.RadianceCacheCompactHits ? 1 : 0));
+            }
+
             bool LoadAndCompileShaders(Globals& vk, Resources& resources, UINT numVolumes, std::ofstream& log)
             {
                 // Release existing shaders
                 resources.rtShaders.Release();
                 resources.indirectCS.Release();
                 resources.probeTraceCS.Release();
+                resources.radianceCacheCS.Release();
+                resources.radianceCacheWorkListArgsCS.Release();
+                resources.probeRayResolveCS.Release();
+                resources.radianceCacheEvictCS.Release();
+                resources.radianceCacheRehashCS.Release();
+                resources.radianceCacheTrimCS.Release();
 
                 std::wstring root = std::wstring(vk.shaderCompiler.root.begin(), vk.shaderCompiler.root.end());
 
@@ -978,21 +1092,96 @@ namespace Graphics
                     std::wstring shaderPath = root + L"shaders/ddgi/ProbeTraceCS.hlsl";
                     resources.probeTraceCS.filepath = shaderPath.c_str();
                     resources.probeTraceCS.entryPoint = L"CS";
-                    resources.probeTraceCS.targetProfile = L"cs_6_6";
-                    resources.probeTraceCS.arguments = { L"-spirv", L"-D __spirv__", L"-fspv-target-env=vulkan1.2" };
-
-                    Shaders::AddDefine(resources.probeTraceCS, L"RTXGI_PUSH_CONSTS_TYPE", L"2");
-                    Shaders::AddDefine(resources.probeTraceCS, L"RTXGI_PUSH_CONSTS_STRUCT_NAME", L"GlobalConstants");
-                    Shaders::AddDefine(resources.probeTraceCS, L"RTXGI_PUSH_CONSTS_VARIABLE_NAME", L"GlobalConst");
-                    Shaders::AddDefine(resources.probeTraceCS, L"RTXGI_PUSH_CONSTS_FIELD_DDGI_VOLUME_INDEX_NAME", L"ddgi_volumeIndex");
-                    Shaders::AddDefine(resources.probeTraceCS, L"RTXGI_PUSH_CONSTS_FIELD_DDGI_REDUCTION_INPUT_SIZE_X_NAME", L"ddgi_reductionInputSizeX");
-                    Shaders::AddDefine(resources.probeTraceCS, L"RTXGI_PUSH_CONSTS_FIELD_DDGI_REDUCTION_INPUT_SIZE_Y_NAME", L"ddgi_reductionInputSizeY");
-                    Shaders::AddDefine(resources.probeTraceCS, L"RTXGI_PUSH_CONSTS_FIELD_DDGI_REDUCTION_INPUT_SIZE_Z_NAME", L"ddgi_reductionInputSizeZ");
-                    Shaders::AddDefine(resources.probeTraceCS, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS));
-                    Shaders::AddDefine(resources.probeTraceCS, L"RTXGI_COORDINATE_SYSTEM", std::to_wstring(RTXGI_COORDINATE_SYSTEM));
+
+                    AddComputeShaderDefines(resources.probeTraceCS);
+                    Shaders::AddDefine(resources.probeTraceCS, L"RTXGI_DDGI_NUM_VOLUMES", std::to_wstring(numVolumes));
+                    AddRadianceCacheDefines(vk, resources.probeTraceCS, numVolumes);
+                    Shaders::AddDefine(resources.probeTraceCS, L"PROBE_TRACE_BATCHED", L"0");
+                    Shaders::AddDefine(resources.probeTraceCS, L"GPU_COUNTERS", L"0");
                     CHECK(Shaders::Compile(vk.shaderCompiler, resources.probeTraceCS), "compile DDGI probe trace inline ray tracing compute shader!\n", log);
                 }
 
+                // Load and compile the radiance cache shading compute shader
+                {
+                    // Threads per cell of the WaveRaysCS variant, 0 for one thread per cell (see RadianceCacheCS.hlsl)
+                    UINT waveRays = 0;
+                    if (vk.RadianceCacheWaveRays && !vk.RadianceCacheReservoirSampling)
+                    {
+                        UINT sampleCount = static_cast<UINT>(vk.RadianceCacheSampleCount);
+                        bool powerOfTwo = (sampleCount > 0) && ((sampleCount & (sampleCount - 1)) == 0);
+                        if (powerOfTwo && sampleCount <= 16 && static_cast<float>(sampleCount) == vk.RadianceCacheSampleCount) waveRays = sampleCount;
+                    }
+
+                    std::wstring shaderPath = root + L"shaders/ddgi/RadianceCacheCS.hlsl";
+                    resources.radianceCacheCS.filepath = shaderPath.c_str();
+                    resources.radianceCacheCS.entryPoint = (waveRays > 0) ? L"WaveRaysCS" : L"CS";
+
+                    AddComputeShaderDefines(resources.radianceCacheCS);
+                    Shaders::AddDefine(resources.radianceCacheCS, L"RTXGI_DDGI_NUM_VOLUMES", std::to_wstring(numVolumes));
+                    AddRadianceCacheDefines(vk, resources.radianceCacheCS, numVolumes);
+                    Shaders::AddDefine(resources.radianceCacheCS, L"RADIANCE_CACHE_WAVE_RAYS", std::to_wstring(waveRays));
+                    Shaders::AddDefine(resources.radianceCacheCS, L"RADIANCE_CACHE_SAMPLE_COUNT", std::to_wstring(vk.RadianceCacheSampleCount));
+                    Shaders::AddDefine(resources.radianceCacheCS, L"RADIANCE_CACHE_RESERVOIR", std::to_wstring(vk.RadianceCacheReservoirSampling ? 1 : 0));
+
+                    // The volume bounds, light grid, emissive lights, GI materials, and GPU counters buffers are D3D12 only (see Descriptors.hlsl)
+                    Shaders::AddDefine(resources.radianceCacheCS, L"RADIANCE_CACHE_INDIRECT_FROM_PROBES", L"0");
+                    Shaders::AddDefine(resources.radianceCacheCS, L"LIGHT_GRID", L"0");
+                    Shaders::AddDefine(resources.radianceCacheCS, L"LIGHT_GRID_STOCHASTIC", L"0");
+                    Shaders::AddDefine(resources.radianceCacheCS, L"EMISSIVE_LIGHTS", L"0");
+                    Shaders::AddDefine(resources.radianceCacheCS, L"LIGHT_VISIBILITY_CACHE", L"0");
+                    Shaders::AddDefine(resources.radianceCacheCS, L"RADIANCE_CACHE_SORT_WORK_LIST", L"0");
+                    Shaders::AddDefine(resources.radianceCacheCS, L"RADIANCE_CACHE_RAY_BUDGET", L"0");
+                    Shaders::AddDefine(resources.radianceCacheCS, L"GI_MATERIALS", L"0");
+                    Shaders::AddDefine(resources.radianceCacheCS, L"GI_VERTEX_ALBEDO", L"0");
+                    Shaders::AddDefine(resources.radianceCacheCS, L"GPU_COUNTERS", L"0");
+                    Shaders::AddDefine(resources.radianceCacheCS, L"TEXTURE_STREAMING", L"0");
+                    CHECK(Shaders::Compile(vk.shaderCompiler, resources.radianceCacheCS), "compile DDGI radiance cache compute shader!\n", log);
+                }
+
+                // Load and compile the radiance cache work list arguments compute shader
+                {
+                    std::wstring shaderPath = root + L"shaders/ddgi/RadianceCacheWorkListArgsCS.hlsl";
+                    resources.radianceCacheWorkListArgsCS.filepath = shaderPath.c_str();
+                    resources.radianceCacheWorkListArgsCS.entryPoint = L"CS";
+
+                    AddComputeShaderDefines(resources.radianceCacheWorkListArgsCS);
+                    Shaders::AddDefine(resources.radianceCacheWorkListArgsCS, L"RADIANCE_CACHE_CASCADE_COUNT", std::to_wstring(numVolumes));
+                    Shaders::AddDefine(resources.radianceCacheWorkListArgsCS, L"RADIANCE_CACHE_CELL_COUNT", std::to_wstring(vk.CacheCount));
+                    Shaders::AddDefine(resources.radianceCacheWorkListArgsCS, L"RADIANCE_CACHE_SORT_WORK_LIST", L"0");
+                    Shaders::AddDefine(resources.radianceCacheWorkListArgsCS, L"RADIANCE_CACHE_RAY_BUDGET", L"0");
+                    CHECK(Shaders::Compile(vk.shaderCompiler, resources.radianceCacheWorkListArgsCS), "compile DDGI radiance cache work list arguments compute shader!\n", log);
+                }
+
+                // Load and compile the probe ray resolve compute shader
+                {
+                    std::wstring shaderPath = root + L"shaders/ddgi/ProbeRayResolveCS.hlsl";
+                    resources.probeRayResolveCS.filepath = shaderPath.c_str();
+                    resources.probeRayResolveCS.entryPoint = L"CS";
+
+                    AddComputeShaderDefines(resources.probeRayResolveCS);
+                    Shaders::AddDefine(resources.probeRayResolveCS, L"RTXGI_DDGI_NUM_VOLUMES", std::to_wstring(numVolumes));
+                    AddRadianceCacheDefines(vk, resources.probeRayResolveCS, numVolumes);
+                    Shaders::AddDefine(resources.probeRayResolveCS, L"PROBE_TRACE_BATCHED", L"0");
+                    CHECK(Shaders::Compile(vk.shaderCompiler, resources.probeRayResolveCS), "compile DDGI probe ray resolve compute shader!\n", log);
+                }
+
+                // Load and compile the radiance cache compaction compute shaders (evict, rehash, trim)
+                {
+                    std::wstring shaderPath = root + L"shaders/ddgi/RadianceCacheCompactCS.hlsl";
+                    Shaders::ShaderProgram* compactShaders[] = { &resources.radianceCacheEvictCS, &resources.radianceCacheRehashCS, &resources.radianceCacheTrimCS };
+                    const wchar_t* compactEntryPoints[] = { L"EvictCS", L"RehashCS", L"TrimCS" };
+                    for (UINT shaderIndex = 0; shaderIndex < _countof(compactShaders); shaderIndex++)
+                    {
+                        Shaders::ShaderProgram& shader = *compactShaders[shaderIndex];
+                        shader.filepath = shaderPath.c_str();
+                        shader.entryPoint = compactEntryPoints[shaderIndex];
+
+                        AddComputeShaderDefines(shader);
+                        AddRadianceCacheDefines(vk, shader, numVolumes);
+                        CHECK(Shaders::Compile(vk.shaderCompiler, shader), "compile DDGI radiance cache compaction compute shader!\n", log);
+                    }
+                }
+
                 return true;
             }
 
@@ -1022,6 +1211,18 @@ namespace Graphics
                 vkDestroyPipeline(vk.device, resources.rtPipeline, nullptr);
                 vkDestroyPipeline(vk.device, resources.indirectPipeline, nullptr);
                 vkDestroyPipeline(vk.device, resources.probeTracePipeline, nullptr);
+                vkDestroyShaderModule(vk.device, resources.radianceCacheModule, nullptr);
+                vkDestroyShaderModule(vk.device, resources.radianceCacheWorkListArgsModule, nullptr);
+                vkDestroyShaderModule(vk.device, resources.probeRayResolveModule, nullptr);
+                vkDestroyShaderModule(vk.device, resources.radianceCacheEvictModule, nullptr);
+                vkDestroyShaderModule(vk.device, resources.radianceCacheRehashModule, nullptr);
+                vkDestroyShaderModule(vk.device, resources.radianceCacheTrimModule, nullptr);
+                vkDestroyPipeline(vk.device, resources.radianceCachePipeline, nullptr);
+                vkDestroyPipeline(vk.device, resources.radianceCacheWorkListArgsPipeline, nullptr);
+                vkDestroyPipeline(vk.device, resources.probeRayResolvePipeline, nullptr);
+                vkDestroyPipeline(vk.device, resources.radianceCacheEvictPipeline, nullptr);
+                vkDestroyPipeline(vk.device, resources.radianceCacheRehashPipeline, nullptr);
+                vkDestroyPipeline(vk.device, resources.radianceCacheTrimPipeline, nullptr);
 
                 // Create the RT pipeline shader modules
                 CHECK(CreateRayTracingShaderModules(vk.device, resources.rtShaders, resources.rtShaderModules), "create DDGI RT shader modules!\n", log);
@@ -1034,7 +1235,7 @@ namespace Graphics
 
                 // Create the RT pipeline
                 CHECK(CreateRayTracingPipeline(
-                    vk.device,
+                    vk,
                     vkResources.pipelineLayout,
                     resources.rtShaders,
                     resources.rtShaderModules,
@@ -1046,7 +1247,7 @@ namespace Graphics
 
                 // Create the indirect lighting pipeline
                 CHECK(CreateComputePipeline(
-                    vk.device,
+                    vk,
                     vkResources.pipelineLayout,
                     resources.indirectCS,
                     resources.indirectShaderModule,
@@ -1057,7 +1258,7 @@ namespace Graphics
 
                 // Create the probe trace compute pipeline for inline ray tracing
                 CHECK(CreateComputePipeline(
-                    vk.device,
+                    vk,
                     vkResources.pipelineLayout,
                     resources.probeTraceCS,
                     resources.probeTraceCSModule,
@@ -1066,6 +1267,26 @@ namespace Graphics
                 SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.probeTracePipeline), "DDGI Probe Trace CS Pipeline", VK_OBJECT_TYPE_PIPELINE);
             #endif
 
+                // Create the radiance cache compute pipelines (shading, work list arguments, probe ray resolve, compaction)
+                struct ComputePass { Shaders::ShaderProgram& shader; VkShaderModule* module; VkPipeline* pipeline; const char* name; };
+                ComputePass radianceCachePasses[] =
+                {
+                    { resources.radianceCacheCS, &resources.radianceCacheModule, &resources.radianceCachePipeline, "DDGI Radiance Cache Pipeline" },
+                    { resources.radianceCacheWorkListArgsCS, &resources.radianceCacheWorkListArgsModule, &resources.radianceCacheWorkListArgsPipeline, "DDGI Radiance Cache Work List Args Pipeline" },
+                    { resources.probeRayResolveCS, &resources.probeRayResolveModule, &resources.probeRayResolvePipeline, "DDGI Probe Ray Resolve Pipeline" },
+                    { resources.radianceCacheEvictCS, &resources.radianceCacheEvictModule, &resources.radianceCacheEvictPipeline, "DDGI Radiance Cache Evict Pipeline" },
+                    { resources.radianceCacheRehashCS, &resources.radianceCacheRehashModule, &resources.radianceCacheRehashPipeline, "DDGI Radiance Cache Rehash Pipeline" },
+                    { resources.radianceCacheTrimCS, &resources.radianceCacheTrimModule, &resources.radianceCacheTrimPipeline, "DDGI Radiance Cache Trim Pipeline" },
+                };
+                for (ComputePass& pass : radianceCachePasses)
+                {
+                    CHECK(CreateShaderModule(vk.device, pass.shader, pass.module), "create " + std::string(pass.name) + " shader module!\n", log);
+                    CHECK(CreateComputePipeline(vk, vkResources.pipelineLayout, pass.shader, *pass.module, pass.pipeline), "create " + std::string(pass.name) + "!\n", log);
+                #ifdef GFX_NAME_OBJECTS
+                    SetObjectName(vk.device, reinterpret_cast<uint64_t>(*pass.pipeline), pass.name, VK_OBJECT_TYPE_PIPELINE);
+                #endif
+                }
+
                 return true;
             }
 
@@ -1161,7 +1382,7 @@ namespace Graphics
                 // Schedule a copy of the shader table from the upload buffer to the device buffer
                 VkBufferCopy bufferCopy = {};
                 bufferCopy.size = resources.shaderTableSize;
-                vkCmdCopyBuffer(vk.cmdBuffer[vk.frameIndex], resources.shaderTableUpload, resources.shaderTable, 1, &bufferCopy);
+                vkCmdCopyBuffer(GetCmdBuffer(vk), resources.shaderTableUpload, resources.shaderTable, 1, &bufferCopy);
 
                 return true;
             }
@@ -1387,41 +1608,228 @@ namespace Graphics
                 descriptor->descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
                 descriptor->pBufferInfo = byteAddressBuffers.data();
 
+                // 14-22: Radiance cache buffers
+                VkDescriptorBufferInfo radianceCacheBuffers[] =
+                {
+                    { resources.hitCaching, 0, VK_WHOLE_SIZE },
+                    { resources.radianceCaching, 0, VK_WHOLE_SIZE },
+                    { resources.radianceCachingVisualization, 0, VK_WHOLE_SIZE },
+                    { resources.radianceCacheAccumulation, 0, VK_WHOLE_SIZE },
+                    { resources.radianceCacheMetadata, 0, VK_WHOLE_SIZE },
+                    { resources.probeRayHitMap, 0, VK_WHOLE_SIZE },
+                    { resources.radianceCacheWorkList, 0, VK_WHOLE_SIZE },
+                    { resources.radianceCacheWorkListArgs, 0, VK_WHOLE_SIZE },
+                    { resources.radianceCacheReservoirs, 0, VK_WHOLE_SIZE },
+                };
+
+                for (uint32_t bufferIndex = 0; bufferIndex < _countof(radianceCacheBuffers); bufferIndex++)
+                {
+                    descriptor = &descriptors.emplace_back();
+                    descriptor->sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                    descriptor->dstSet = resources.descriptorSet;
+                    descriptor->dstBinding = DescriptorLayoutBindings::UAV_HIT_CACHING + bufferIndex;
+                    descriptor->dstArrayElement = 0;
+                    descriptor->descriptorCount = 1;
+                    descriptor->descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                    descriptor->pBufferInfo = &radianceCacheBuffers[bufferIndex];
+                }
+
                 // Update the descriptor set
                 vkUpdateDescriptorSets(vk.device, static_cast<uint32_t>(descriptors.size()), descriptors.data(), 0, nullptr);
 
                 return true;
             }
 
-            void RayTraceVolumes(Globals& vk, GlobalResources& vkResources, Resources& resources)
+            /**
+             * Set the application's push constants (app, path trace, and lighting) of the DDGI passes.
+             */
+            void PushGlobalConstants(GlobalResources& vkResources, VkCommandBuffer cmdBuffer)
             {
-            #ifdef GFX_PERF_MARKERS
-                AddPerfMarker(vk, GFX_PERF_MARKER_GREEN, resources.useInlineRayTracing ? "Trace DDGIVolumes (Inline RT)" : "Ray Trace DDGIVolumes");
-            #endif
-
-                // Update the push constants
                 uint32_t offset = 0;
                 GlobalConstants consts = vkResources.constants;
-                vkCmdPushConstants(vk.cmdBuffer[vk.frameIndex], vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, AppConsts::GetAlignedSizeInBytes(), consts.app.GetData());
+                vkCmdPushConstants(cmdBuffer, vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, AppConsts::GetAlignedSizeInBytes(), consts.app.GetData());
                 offset += AppConsts::GetAlignedSizeInBytes();
-                vkCmdPushConstants(vk.cmdBuffer[vk.frameIndex], vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, PathTraceConsts::GetAlignedSizeInBytes(), consts.pt.GetData());
+                vkCmdPushConstants(cmdBuffer, vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, PathTraceConsts::GetAlignedSizeInBytes(), consts.pt.GetData());
                 offset += PathTraceConsts::GetAlignedSizeInBytes();
-                vkCmdPushConstants(vk.cmdBuffer[vk.frameIndex], vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, LightingConsts::GetAlignedSizeInBytes(), consts.lights.GetData());
+                vkCmdPushConstants(cmdBuffer, vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, LightingConsts::GetAlignedSizeInBytes(), consts.lights.GetData());
+            }
 
-                if (resources.useInlineRayTracing)
-                {
-                    // Use compute shader with inline ray tracing
-                    vkCmdBindDescriptorSets(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_COMPUTE, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
-                    vkCmdBindPipeline(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_COMPUTE, resources.probeTracePipeline);
-                }
-                else
+            /**
+             * Make the radiance cache writes of the previous passes visible to the next passes.
+             * The passes share the cache buffers through the descriptor set, so a global memory barrier stands in for per buffer barriers.
+             */
+            void RadianceCacheBarrier(VkCommandBuffer cmdBuffer, VkPipelineStageFlags srcStages, VkPipelineStageFlags dstStages, VkAccessFlags dstAccess)
+            {
+                VkMemoryBarrier barrier = {};
+                barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+                barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.dstAccessMask = dstAccess;
+                vkCmdPipelineBarrier(cmdBuffer, srcStages, dstStages, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+            }
+
+            /**
+             * Empty the radiance cache: slots, metadata, reservoirs, the probe ray hit map, and the work list count.
+             * Recorded on the graphics command buffer, at initialization and when the probes are cleared.
+             */
+            void ResetRadianceCache(Globals& vk, Resources& resources)
+            {
+                VkCommandBuffer cmdBuffer = GetCmdBuffer(vk);
+
+                RadianceCacheBarrier(cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+                vkCmdFillBuffer(cmdBuffer, resources.hitCaching, 0, VK_WHOLE_SIZE, 0);
+                vkCmdFillBuffer(cmdBuffer, resources.radianceCaching, 0, VK_WHOLE_SIZE, 0);
+                vkCmdFillBuffer(cmdBuffer, resources.radianceCacheAccumulation, 0, VK_WHOLE_SIZE, 0);
+                vkCmdFillBuffer(cmdBuffer, resources.radianceCacheMetadata, 0, VK_WHOLE_SIZE, 0);
+                vkCmdFillBuffer(cmdBuffer, resources.radianceCacheReservoirs, 0, VK_WHOLE_SIZE, 0);
+                vkCmdFillBuffer(cmdBuffer, resources.probeRayHitMap, 0, VK_WHOLE_SIZE, 0xFFFFFFFF);
+                vkCmdFillBuffer(cmdBuffer, resources.radianceCacheWorkListArgs, 0, VK_WHOLE_SIZE, 0);
+                RadianceCacheBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+            }
+
+            /**
+             * Zero the radiance accumulated by the previous frame's shading.
+             */
+            void ClearRadianceCacheAccumulation(Resources& resources, VkCommandBuffer cmdBuffer)
+            {
+                RadianceCacheBarrier(cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+                vkCmdFillBuffer(cmdBuffer, resources.radianceCacheAccumulation, 0, VK_WHOLE_SIZE, 0);
+                RadianceCacheBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+            }
+
+            /**
+             * Free the stale radiance cache slots: evict the slots not used for a while, rehash the survivors
+             * closer to their home slots, and trim the probe sequences left behind (see RadianceCacheCompactCS.hlsl).
+             */
+            void CompactRadianceCache(GlobalResources& vkResources, Resources& resources, VkCommandBuffer cmdBuffer)
+            {
+            #ifdef GFX_PERF_MARKERS
+                AddPerfMarker(cmdBuffer, GFX_PERF_MARKER_GREEN, "Compact Radiance Cache");
+            #endif
+
+                vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
+                PushGlobalConstants(vkResources, cmdBuffer);
+
+                // One thread per slot of every cascade, each pass waits for the previous one
+                uint32_t groupsX = DivRoundUp(resources.cascadeCellNum, 64);
+                VkPipeline passes[] = { resources.radianceCacheEvictPipeline, resources.radianceCacheRehashPipeline, resources.radianceCacheTrimPipeline };
+                for (VkPipeline pipeline : passes)
                 {
-                    // Use traditional ray tracing pipeline
-                    vkCmdBindDescriptorSets(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
-                    vkCmdBindPipeline(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, resources.rtPipeline);
+                    RadianceCacheBarrier(cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+                    vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+                    vkCmdDispatch(cmdBuffer, groupsX, 1, 1);
                 }
 
-                // Describe the shader table (only needed for RT path)
+            #ifdef GFX_PERF_MARKERS
+                vkCmdEndDebugUtilsLabelEXT(cmdBuffer);
+            #endif
+            }
+
+            /**
+             * Trace the probe rays of the volume updated this frame with inline ray tracing. The hits claim radiance cache slots,
+             * the slots that need shading are appended to the work list (see ProbeTraceCS.hlsl).
+             */
+            void RayTraceVolumeCS(GlobalResources& vkResources, Resources& resources, VkCommandBuffer cmdBuffer)
+            {
+                if (resources.updateVolumes.empty()) return;
+                const DDGIVolume* volume = resources.updateVolumes[0];
+
+            #ifdef GFX_PERF_MARKERS
+                AddPerfMarker(cmdBuffer, GFX_PERF_MARKER_GREEN, "Trace DDGIVolume (Inline RT)");
+            #endif
+
+                vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
+                vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, resources.probeTracePipeline);
+                PushGlobalConstants(vkResources, cmdBuffer);
+                vkCmdPushConstants(cmdBuffer, vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, GlobalConstants::GetAlignedSizeInBytes(), DDGIRootConstants::GetSizeInBytes(), volume->GetPushConstants().GetData());
+
+                // Wait for the compaction and the previous frame's passes before claiming slots
+                RadianceCacheBarrier(cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+                // One thread per ray, ProbeTraceCS uses [numthreads(64, 1, 1)] and a row of groups per probe
+                uint32_t groupsX = DivRoundUp(static_cast<uint32_t>(volume->GetNumRaysPerProbe()), 64);
+                vkCmdDispatch(cmdBuffer, groupsX, static_cast<uint32_t>(volume->GetNumProbes()), 1);
+
+                // Wait for the hits and the work list before the shading
+                RadianceCacheBarrier(cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+            #ifdef GFX_PERF_MARKERS
+                vkCmdEndDebugUtilsLabelEXT(cmdBuffer);
+            #endif
+            }
+
+            /**
+             * Shade the radiance cache slots on the work list, one indirect dispatch sized by the work list count on the GPU.
+             */
+            void RayTraceRadianceCacheCS(GlobalResources& vkResources, Resources& resources, VkCommandBuffer cmdBuffer)
+            {
+            #ifdef GFX_PERF_MARKERS
+                AddPerfMarker(cmdBuffer, GFX_PERF_MARKER_GREEN, "Radiance Cache (Inline RT)");
+            #endif
+
+                vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
+                PushGlobalConstants(vkResources, cmdBuffer);
+
+                // Write the dispatch arguments from the work list count
+                vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, resources.radianceCacheWorkListArgsPipeline);
+                vkCmdDispatch(cmdBuffer, 1, 1, 1);
+                RadianceCacheBarrier(cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+                // Shade the work list
+                vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, resources.radianceCachePipeline);
+                vkCmdDispatchIndirect(cmdBuffer, resources.radianceCacheWorkListArgs, 0);
+
+                // Wait for the shaded radiance before the probe ray resolve
+                RadianceCacheBarrier(cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+            #ifdef GFX_PERF_MARKERS
+                vkCmdEndDebugUtilsLabelEXT(cmdBuffer);
+            #endif
+            }
+
+            /**
+             * Write the radiance of each probe ray's cache slot to the volume's probe ray data texture, for the probe blending.
+             */
+            void ProbeRayResolveCS(GlobalResources& vkResources, Resources& resources, VkCommandBuffer cmdBuffer)
+            {
+                if (resources.updateVolumes.empty()) return;
+                const DDGIVolume* volume = resources.updateVolumes[0];
+
+            #ifdef GFX_PERF_MARKERS
+                AddPerfMarker(cmdBuffer, GFX_PERF_MARKER_GREEN, "Probe Ray Resolve");
+            #endif
+
+                vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
+                vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, resources.probeRayResolvePipeline);
+                PushGlobalConstants(vkResources, cmdBuffer);
+                vkCmdPushConstants(cmdBuffer, vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, GlobalConstants::GetAlignedSizeInBytes(), DDGIRootConstants::GetSizeInBytes(), volume->GetPushConstants().GetData());
+
+                // One thread per probe ray
+                uint32_t numRays = static_cast<uint32_t>(volume->GetNumProbes() * volume->GetNumRaysPerProbe());
+                vkCmdDispatch(cmdBuffer, DivRoundUp(numRays, 64), 1, 1);
+
+                // Wait for the ray data before the probe blending
+                ImageBarrierDesc barrier = { VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 } };
+                SetImageMemoryBarrier(cmdBuffer, volume->GetProbeRayData(), barrier);
+
+            #ifdef GFX_PERF_MARKERS
+                vkCmdEndDebugUtilsLabelEXT(cmdBuffer);
+            #endif
+            }
+
+            void RayTraceVolumes(Globals& vk, GlobalResources& vkResources, Resources& resources, VkCommandBuffer cmdBuffer)
+            {
+            #ifdef GFX_PERF_MARKERS
+                AddPerfMarker(cmdBuffer, GFX_PERF_MARKER_GREEN, "Ray Trace DDGIVolumes");
+            #endif
+
+                // Update the push constants
+                PushGlobalConstants(vkResources, cmdBuffer);
+
+                // Bind the descriptor set and pipeline
+                vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
+                vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, resources.rtPipeline);
+
+                // Describe the shader table
                 VkStridedDeviceAddressRegionKHR raygenRegion = {};
                 raygenRegion.deviceAddress = resources.shaderTableRGSStartAddress;
                 raygenRegion.size = resources.shaderTableRecordSize;
@@ -1440,7 +1848,8 @@ namespace Graphics
                 VkStridedDeviceAddressRegionKHR callableRegion = {};
 
                 // Barriers
-                std::vector<VkImageMemoryBarrier> barriers;
+                VkImageMemoryBarrier* barriers = vk.frameArena.Allocate<VkImageMemoryBarrier>(resources.updateVolumes.size());
+                uint32_t numBarriers = 0;
                 VkImageMemoryBarrier barrier = {};
                 barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
                 barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
@@ -1449,64 +1858,50 @@ namespace Graphics
                 barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
 
                 // DDGI push constants offset
-                offset = GlobalConstants::GetAlignedSizeInBytes();
+                uint32_t offset = GlobalConstants::GetAlignedSizeInBytes();
 
                 // Trace probe rays for each volume
-                for (uint32_t volumeIndex = 0; volumeIndex < static_cast<uint32_t>(resources.selectedVolumes.size()); volumeIndex++)
+                for (uint32_t volumeIndex = 0; volumeIndex < static_cast<uint32_t>(resources.updateVolumes.size()); volumeIndex++)
                 {
                     // Get the volume
-                    const DDGIVolume* volume = resources.selectedVolumes[volumeIndex];
+                    const DDGIVolume* volume = resources.updateVolumes[volumeIndex];
 
                     // Update the push constants
-                    vkCmdPushConstants(vk.cmdBuffer[vk.frameIndex], vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, DDGIRootConstants::GetSizeInBytes(), volume->GetPushConstants().GetData());
+                    vkCmdPushConstants(cmdBuffer, vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, DDGIRootConstants::GetSizeInBytes(), volume->GetPushConstants().GetData());
 
+                    // Trace probe rays
                     uint32_t width, height, depth;
                     volume->GetRayDispatchDimensions(width, height, depth);
-
-                    if (resources.useInlineRayTracing)
-                    {
-                        // Dispatch compute shader with inline ray tracing
-                        // For compute shader, we dispatch thread groups to match probe ray count
-                        uint32_t groupsX = DivRoundUp(width, 8u);
-                        uint32_t groupsY = DivRoundUp(height, 8u);
-                        vkCmdDispatch(vk.cmdBuffer[vk.frameIndex], groupsX, groupsY, depth);
-                    }
-                    else
-                    {
-                        // Trace probe rays using traditional ray tracing
-                        vkCmdTraceRaysKHR(
-                            vk.cmdBuffer[vk.frameIndex],
-                            &raygenRegion,
-                            &missRegion,
-                            &hitRegion,
-                            &callableRegion,
-                            width,
-                            height,
-                            depth);
-                    }
+                    vkCmdTraceRaysKHR(
+                        cmdBuffer,
+                        &raygenRegion,
+                        &missRegion,
+                        &hitRegion,
+                        &callableRegion,
+                        width,
+                        height,
+                        depth);
 
                     // Barrier(s)
                     barrier.image = volume->GetProbeRayData();
-                    barriers.push_back(barrier);
+                    barriers[numBarriers++] = barrier;
                 }
 
-                // Wait for the ray traces/compute to complete
-                if (!barriers.empty())
+                // Wait for the ray traces to complete
+                if (numBarriers > 0)
                 {
-                    VkPipelineStageFlags srcStage = resources.useInlineRayTracing ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR;
-                    VkPipelineStageFlags dstStage = resources.useInlineRayTracing ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR;
                     vkCmdPipelineBarrier(
-                        vk.cmdBuffer[vk.frameIndex],
-                        srcStage,
-                        dstStage,
+                        cmdBuffer,
+                        VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR,
+                        VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
                         0,
                         0, nullptr,
                         0, nullptr,
-                        static_cast<uint32_t>(barriers.size()), barriers.data());
+                        numBarriers, barriers);
                 }
 
             #ifdef GFX_PERF_MARKERS
-                vkCmdEndDebugUtilsLabelEXT(vk.cmdBuffer[vk.frameIndex]);
+                vkCmdEndDebugUtilsLabelEXT(cmdBuffer);
             #endif
             }
 
@@ -1517,22 +1912,22 @@ namespace Graphics
             #endif
 
                 // Bind the descriptor set
-                vkCmdBindDescriptorSets(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_COMPUTE, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
+                vkCmdBindDescriptorSets(GetCmdBuffer(vk), VK_PIPELINE_BIND_POINT_COMPUTE, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
 
                 // Bind the compute pipeline and dispatch threads
-                vkCmdBindPipeline(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_COMPUTE, resources.indirectPipeline);
+                vkCmdBindPipeline(GetCmdBuffer(vk), VK_PIPELINE_BIND_POINT_COMPUTE, resources.indirectPipeline);
 
                 // Dispatch threads
-                uint32_t groupsX = DivRoundUp(vk.width, 8);
-                uint32_t groupsY = DivRoundUp(vk.height, 4);
-                vkCmdDispatch(vk.cmdBuffer[vk.frameIndex], groupsX, groupsY, 1);
+                uint32_t groupsX = DivRoundUp(vk.renderWidth, 8);
+                uint32_t groupsY = DivRoundUp(vk.renderHeight, 4);
+                vkCmdDispatch(GetCmdBuffer(vk), groupsX, groupsY, 1);
 
                 // Wait for the compute pass to finish
                 ImageBarrierDesc barrier = { VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 } };
-                SetImageMemoryBarrier(vk.cmdBuffer[vk.frameIndex], resources.output, barrier);
+                SetImageMemoryBarrier(GetCmdBuffer(vk), resources.output, barrier);
 
             #ifdef GFX_PERF_MARKERS
-                vkCmdEndDebugUtilsLabelEXT(vk.cmdBuffer[vk.frameIndex]);
+                vkCmdEndDebugUtilsLabelEXT(GetCmdBuffer(vk));
             #endif
             }
 
@@ -1571,6 +1966,10 @@ namespace Graphics
                 // Create the DDGIVolume constants structured buffer
                 if (!CreateDDGIVolumeConstantsBuffer(vk, vkResources, resources, numVolumes, log)) return false;
 
+                // Create the radiance cache buffers, a cascade per volume
+                resources.cascadeCellNum = vk.CacheCount * numVolumes;
+                if (!CreateCachingBuffers(vk, resources, config, log)) return false;
+
             #ifdef RTXGI_EXPORT_DLL
                 // Initialize the RTXGI SDK's Vulkan extensions when using the dynamic library
                 rtxgi::vulkan::LoadExtensions(vk.device);
@@ -1584,8 +1983,10 @@ namespace Graphics
 
                     // Clear the volume's probes at initialization
                     DDGIVolume* volume = static_cast<DDGIVolume*>(resources.volumes[volumeIndex]);
-                    volume->ClearProbes(vk.cmdBuffer[vk.frameIndex]);
+                    volume->ClearProbes(GetCmdBuffer(vk));
                 }
+                resources.volumeShaderPermutations.Release();
+                ResetRadianceCache(vk, resources);
 
                 // Initialize the shader table and bindless descriptor set
                 if (!UpdateShaderTable(vk, vkResources, resources, log)) return false;
@@ -1598,7 +1999,10 @@ namespace Graphics
 
                 // Setup performance stats
                 perf.AddStat("DDGI", resources.cpuStat, resources.gpuStat);
+                resources.radianceCacheCompactStat = perf.AddGPUStat("  Radiance Cache Compaction");
                 resources.rtStat = perf.AddGPUStat("  Probe Trace");
+                resources.radianceCacheStat = perf.AddGPUStat("  Radiance Cache");
+                resources.resolveStat = perf.AddGPUStat("  Probe Ray Resolve");
                 resources.blendStat = perf.AddGPUStat("  Blend");
                 resources.relocateStat = perf.AddGPUStat("  Relocate");
                 resources.classifyStat = perf.AddGPUStat("  Classify");
@@ -1627,6 +2031,7 @@ namespace Graphics
                     Configs::DDGIVolume volumeConfig = config.ddgi.volumes[volumeIndex];
                     if (!CreateDDGIVolume(vk, vkResources, resources, volumeConfig, log)) return false;
                 }
+                resources.volumeShaderPermutations.Release();
 
                 if (!UpdateShaderTable(vk, vkResources, resources, log)) return false;
                 if (!UpdateDescriptorSets(vk, vkResources, resources, log)) return false;
@@ -1637,6 +2042,38 @@ namespace Graphics
                 return true;
             }
 
+            /**
+             * Apply the changes of the volumes' configs (see Configs::ReloadDDGIVolumes()), each at the cheapest level:
+             * constants are set on the running volume, other changes create the volume again.
+             */
+            bool ApplyVolumeChanges(Globals& vk, GlobalResources& vkResources, Resources& resources, const Configs::Config& config, const std::vector<Configs::EDDGIVolumeChange>& changes, std::ofstream& log)
+            {
+                using Configs::EDDGIVolumeChange;
+
+                EDDGIVolumeChange maxChange = EDDGIVolumeChange::NONE;
+                for (EDDGIVolumeChange change : changes) maxChange = (std::max)(maxChange, change);
+                if (maxChange >= EDDGIVolumeChange::SHADERS) vkDeviceWaitIdle(vk.device);
+
+                for (uint32_t volumeIndex = 0; volumeIndex < static_cast<uint32_t>(changes.size()); volumeIndex++)
+                {
+                    EDDGIVolumeChange change = changes[volumeIndex];
+                    if (change == EDDGIVolumeChange::NONE) continue;
+
+                    const Configs::DDGIVolume& volumeConfig = config.ddgi.volumes[volumeIndex];
+                    if (change == EDDGIVolumeChange::CONSTANTS)
+                    {
+                        Graphics::DDGI::SetDDGIVolumeConstants(resources.volumes[volumeIndex], volumeConfig);
+                        continue;
+                    }
+                    if (!CreateDDGIVolume(vk, vkResources, resources, volumeConfig, log)) return false;
+                }
+                resources.volumeShaderPermutations.Release();
+
+                if (maxChange < EDDGIVolumeChange::SHADERS) return true;
+                if (!UpdateShaderTable(vk, vkResources, resources, log)) return false;
+                return UpdateDescriptorSets(vk, vkResources, resources, log);
+            }
+
             /**
              * Resize screen-space buffers and update descriptor sets.
              */
@@ -1668,7 +2105,8 @@ namespace Graphics
                     if (config.ddgi.volumes[config.ddgi.selectedVolume].clearProbes)
                     {
                         DDGIVolume* volume = static_cast<DDGIVolume*>(resources.volumes[config.ddgi.selectedVolume]);
-                        volume->ClearProbes(vk.cmdBuffer[vk.frameIndex]);
+                        volume->ClearProbes(GetCmdBuffer(vk));
+                        ResetRadianceCache(vk, resources);
 
                         config.ddgi.volumes[config.ddgi.selectedVolume].clearProbes = 0;
                         resources.numVolumeVariabilitySamples[config.ddgi.selectedVolume] = 0;
@@ -1722,46 +2160,114 @@ namespace Graphics
                     UINT numVolumes = static_cast<UINT>(resources.selectedVolumes.size());
 
                     // Upload volume resource indices and constants
-                    rtxgi::vulkan::UploadDDGIVolumeResourceIndices(vk.device, vk.cmdBuffer[vk.frameIndex], vk.frameIndex, numVolumes, resources.selectedVolumes.data());
-                    rtxgi::vulkan::UploadDDGIVolumeConstants(vk.device, vk.cmdBuffer[vk.frameIndex], vk.frameIndex, numVolumes, resources.selectedVolumes.data());
+                    rtxgi::vulkan::UploadDDGIVolumeResourceIndices(vk.device, GetCmdBuffer(vk), vk.frameIndex, numVolumes, resources.selectedVolumes.data());
+                    rtxgi::vulkan::UploadDDGIVolumeConstants(vk.device, GetCmdBuffer(vk), vk.frameIndex, numVolumes, resources.selectedVolumes.data());
+
+                    // With async compute, the probe update chain is recorded on the compute command buffer. It starts once the
+                    // graphics work recorded so far (TLAS build, constant uploads, and the gather below) completes, and runs
+                    // alongside the rest of the frame. The gather consumes the probes updated by the previous frame's chain.
+                    VkCommandBuffer updateCmdBuffer = GetCmdBuffer(vk);
+                    if (vk.DDGIAsyncCompute)
+                    {
+                        if (!ResetComputeCmdList(vk)) return;
+                        updateCmdBuffer = vk.computeCmdBuffer[vk.frameIndex];
+                    }
 
-                    // Trace rays from DDGI probes to sample the environment
-                    GPU_TIMESTAMP_BEGIN(resources.rtStat->GetGPUQueryBeginIndex());
-                    RayTraceVolumes(vk, vkResources, resources);
-                    GPU_TIMESTAMP_END(resources.rtStat->GetGPUQueryEndIndex());
+                    // Select the volumes whose probes are updated this frame. With inline ray tracing, the probe rays are shaded
+                    // through the radiance cache and its hit map holds the rays of one volume, so the selected volumes take turns.
+                    resources.updateVolumes.clear();
+                    if (resources.useInlineRayTracing)
+                    {
+                        if (resources.updateVolumeIndex >= numVolumes) resources.updateVolumeIndex = 0;
+                        if (numVolumes > 0) resources.updateVolumes.push_back(resources.selectedVolumes[resources.updateVolumeIndex++]);
+                    }
+                    else
+                    {
+                        resources.updateVolumes = resources.selectedVolumes;
+                    }
+                    UINT numUpdateVolumes = static_cast<UINT>(resources.updateVolumes.size());
+
+                    if (resources.useInlineRayTracing)
+                    {
+                        // Periodically free the stale radiance cache slots, before the probe trace claims this frame's slots
+                        if (vk.RadianceCacheCompactionInterval > 0 && (vk.frameNumber % vk.RadianceCacheCompactionInterval) == 0)
+                        {
+                            DDGI_STAGE_TIMESTAMP_BEGIN(resources.radianceCacheCompactStat);
+                            CompactRadianceCache(vkResources, resources, updateCmdBuffer);
+                            DDGI_STAGE_TIMESTAMP_END(resources.radianceCacheCompactStat);
+                        }
+
+                        // Trace rays from DDGI probes to sample the environment
+                        DDGI_STAGE_TIMESTAMP_BEGIN(resources.rtStat);
+                        RayTraceVolumeCS(vkResources, resources, updateCmdBuffer);
+                        DDGI_STAGE_TIMESTAMP_END(resources.rtStat);
+                    }
+                    else
+                    {
+                        // Trace rays from DDGI probes to sample the environment
+                        DDGI_STAGE_TIMESTAMP_BEGIN(resources.rtStat);
+                        RayTraceVolumes(vk, vkResources, resources, updateCmdBuffer);
+                        DDGI_STAGE_TIMESTAMP_END(resources.rtStat);
+                    }
+
+                    // Shade the radiance cache slots hit by the probe rays (the stages stay timed so their queries are always written)
+                    DDGI_STAGE_TIMESTAMP_BEGIN(resources.radianceCacheStat);
+                    if (resources.useInlineRayTracing)
+                    {
+                        ClearRadianceCacheAccumulation(resources, updateCmdBuffer);
+                        RayTraceRadianceCacheCS(vkResources, resources, updateCmdBuffer);
+                    }
+                    DDGI_STAGE_TIMESTAMP_END(resources.radianceCacheStat);
+
+                    // Resolve the probe rays' radiance from the cache
+                    DDGI_STAGE_TIMESTAMP_BEGIN(resources.resolveStat);
+                    if (resources.useInlineRayTracing) ProbeRayResolveCS(vkResources, resources, updateCmdBuffer);
+                    DDGI_STAGE_TIMESTAMP_END(resources.resolveStat);
 
                     // Update volume probes
-                    GPU_TIMESTAMP_BEGIN(resources.blendStat->GetGPUQueryBeginIndex());
-                    rtxgi::vulkan::UpdateDDGIVolumeProbes(vk.cmdBuffer[vk.frameIndex], numVolumes, resources.selectedVolumes.data());
-                    GPU_TIMESTAMP_END(resources.blendStat->GetGPUQueryEndIndex());
+                    DDGI_STAGE_TIMESTAMP_BEGIN(resources.blendStat);
+                    rtxgi::vulkan::UpdateDDGIVolumeProbes(updateCmdBuffer, numUpdateVolumes, resources.updateVolumes.data());
+                    DDGI_STAGE_TIMESTAMP_END(resources.blendStat);
 
                     // Relocate probes if the feature is enabled
-                    GPU_TIMESTAMP_BEGIN(resources.relocateStat->GetGPUQueryBeginIndex());
-                    rtxgi::vulkan::RelocateDDGIVolumeProbes(vk.cmdBuffer[vk.frameIndex], numVolumes, resources.selectedVolumes.data());
-                    GPU_TIMESTAMP_END(resources.relocateStat->GetGPUQueryEndIndex());
+                    DDGI_STAGE_TIMESTAMP_BEGIN(resources.relocateStat);
+                    rtxgi::vulkan::RelocateDDGIVolumeProbes(updateCmdBuffer, numUpdateVolumes, resources.updateVolumes.data());
+                    DDGI_STAGE_TIMESTAMP_END(resources.relocateStat);
 
                     // Classify probes if the feature is enabled
-                    GPU_TIMESTAMP_BEGIN(resources.classifyStat->GetGPUQueryBeginIndex());
-                    rtxgi::vulkan::ClassifyDDGIVolumeProbes(vk.cmdBuffer[vk.frameIndex], numVolumes, resources.selectedVolumes.data());
-                    GPU_TIMESTAMP_END(resources.classifyStat->GetGPUQueryEndIndex());
+                    DDGI_STAGE_TIMESTAMP_BEGIN(resources.classifyStat);
+                    rtxgi::vulkan::ClassifyDDGIVolumeProbes(updateCmdBuffer, numUpdateVolumes, resources.updateVolumes.data());
+                    DDGI_STAGE_TIMESTAMP_END(resources.classifyStat);
 
                     // Calculate variability
-                    GPU_TIMESTAMP_BEGIN(resources.variabilityStat->GetGPUQueryBeginIndex());
-                    rtxgi::vulkan::CalculateDDGIVolumeVariability(vk.cmdBuffer[vk.frameIndex], numVolumes, resources.selectedVolumes.data());
+                    DDGI_STAGE_TIMESTAMP_BEGIN(resources.variabilityStat);
+                    rtxgi::vulkan::CalculateDDGIVolumeVariability(updateCmdBuffer, numUpdateVolumes, resources.updateVolumes.data());
                     // The readback happens immediately, not recorded on the command list, so will return a value from a previous update
-                    rtxgi::vulkan::ReadbackDDGIVolumeVariability(vk.device, numVolumes, resources.selectedVolumes.data());
-                    GPU_TIMESTAMP_END(resources.variabilityStat->GetGPUQueryEndIndex());
+                    rtxgi::vulkan::ReadbackDDGIVolumeVariability(vk.device, numUpdateVolumes, resources.updateVolumes.data());
+                    DDGI_STAGE_TIMESTAMP_END(resources.variabilityStat);
 
                     // Render the indirect lighting to screen-space
                     GPU_TIMESTAMP_BEGIN(resources.lightingStat->GetGPUQueryBeginIndex());
                     GatherIndirectLighting(vk, vkResources, resources);
                     GPU_TIMESTAMP_END(resources.lightingStat->GetGPUQueryEndIndex());
+
+                    // Kick off the probe update chain behind the graphics work recorded so far
+                    if (vk.DDGIAsyncCompute)
+                    {
+                    #ifdef GFX_PERF_MARKERS
+                        vkCmdEndDebugUtilsLabelEXT(GetCmdBuffer(vk));
+                    #endif
+                        if (!SubmitComputeCmdList(vk)) return;
+                    #ifdef GFX_PERF_MARKERS
+                        AddPerfMarker(vk, GFX_PERF_MARKER_GREEN, "RTXGI: DDGI");
+                    #endif
+                    }
                 }
                 GPU_TIMESTAMP_END(resources.gpuStat->GetGPUQueryEndIndex());
                 CPU_TIMESTAMP_ENDANDRESOLVE(resources.cpuStat);
 
             #ifdef GFX_PERF_MARKERS
-                vkCmdEndDebugUtilsLabelEXT(vk.cmdBuffer[vk.frameIndex]);
+                vkCmdEndDebugUtilsLabelEXT(GetCmdBuffer(vk));
             #endif
             }
 
@@ -1770,6 +2276,8 @@ namespace Graphics
              */
             void Cleanup(VkDevice device, Resources& resources)
             {
+                resources.volumeShaderPermutations.Release();
+
                 // Textures
                 vkDestroyImage(device, resources.output, nullptr);
                 vkDestroyImageView(device, resources.outputView, nullptr);
@@ -1785,6 +2293,12 @@ namespace Graphics
                 vkDestroyPipeline(device, resources.rtPipeline, nullptr);
                 vkDestroyPipeline(device, resources.indirectPipeline, nullptr);
                 vkDestroyPipeline(device, resources.probeTracePipeline, nullptr);
+                vkDestroyPipeline(device, resources.radianceCachePipeline, nullptr);
+                vkDestroyPipeline(device, resources.radianceCacheWorkListArgsPipeline, nullptr);
+                vkDestroyPipeline(device, resources.probeRayResolvePipeline, nullptr);
+                vkDestroyPipeline(device, resources.radianceCacheEvictPipeline, nullptr);
+                vkDestroyPipeline(device, resources.radianceCacheRehashPipeline, nullptr);
+                vkDestroyPipeline(device, resources.radianceCacheTrimPipeline, nullptr);
 
                 // Shaders
                 resources.rtShaderModules.Release(device);
@@ -1793,6 +2307,18 @@ namespace Graphics
                 resources.indirectCS.Release();
                 vkDestroyShaderModule(device, resources.probeTraceCSModule, nullptr);
                 resources.probeTraceCS.Release();
+                vkDestroyShaderModule(device, resources.radianceCacheModule, nullptr);
+                resources.radianceCacheCS.Release();
+                vkDestroyShaderModule(device, resources.radianceCacheWorkListArgsModule, nullptr);
+                resources.radianceCacheWorkListArgsCS.Release();
+                vkDestroyShaderModule(device, resources.probeRayResolveModule, nullptr);
+                resources.probeRayResolveCS.Release();
+                vkDestroyShaderModule(device, resources.radianceCacheEvictModule, nullptr);
+                resources.radianceCacheEvictCS.Release();
+                vkDestroyShaderModule(device, resources.radianceCacheRehashModule, nullptr);
+                resources.radianceCacheRehashCS.Release();
+                vkDestroyShaderModule(device, resources.radianceCacheTrimModule, nullptr);
+                resources.radianceCacheTrimCS.Release();
 
                 resources.shaderTableSize = 0;
                 resources.shaderTableRecordSize = 0;
@@ -1815,6 +2341,17 @@ namespace Graphics
                 vkDestroyBuffer(device, resources.volumeConstantsSTB, nullptr);
                 vkFreeMemory(device, resources.volumeConstantsSTBMemory, nullptr);
 
+                // Radiance Cache
+                VkBuffer cachingBuffers[] = { resources.hitCaching, resources.radianceCaching, resources.radianceCachingVisualization, resources.radianceCacheAccumulation,
+                    resources.radianceCacheMetadata, resources.probeRayHitMap, resources.radianceCacheWorkList, resources.radianceCacheWorkListArgs, resources.radianceCacheReservoirs };
+                VkDeviceMemory cachingMemory[] = { resources.hitCachingMemory, resources.radianceCachingMemory, resources.radianceCachingVisualizationMemory, resources.radianceCacheAccumulationMemory,
+                    resources.radianceCacheMetadataMemory, resources.probeRayHitMapMemory, resources.radianceCacheWorkListMemory, resources.radianceCacheWorkListArgsMemory, resources.radianceCacheReservoirsMemory };
+                for (uint32_t bufferIndex = 0; bufferIndex < _countof(cachingBuffers); bufferIndex++)
+                {
+                    vkDestroyBuffer(device, cachingBuffers[bufferIndex], nullptr);
+                    vkFreeMemory(device, cachingMemory[bufferIndex], nullptr);
+                }
+
                 // DDGIVolumes layouts and descriptor set
             #if !RTXGI_DDGI_RESOURCE_MANAGEMENT && !RTXGI_DDGI_BINDLESS_RESOURCES
                 vkDestroyPipelineLayout(device, resources.volumePipelineLayout, nullptr);
@@ -1905,6 +2442,22 @@ namespace Graphics
             return Graphics::Vulkan::DDGI::Reload(vk, vkResources, resources, config, log);
         }
 
+        bool ApplyVolumeChanges(Globals& vk, GlobalResources& vkResources, Resources& resources, const Configs::Config& config, const std::vector<Configs::EDDGIVolumeChange>& changes, std::ofstream& log)
+        {
+            return Graphics::Vulkan::DDGI::ApplyVolumeChanges(vk, vkResources, resources, config, changes, log);
+        }
+
+        bool ReloadAsync(Globals& vk, GlobalResources& vkResources, Resources& resources, const Configs::Config& config, std::ofstream& log)
+        {
+            // Vulkan reloads synchronously, FinishReload() reports it as swapped in
+            return Graphics::Vulkan::DDGI::Reload(vk, vkResources, resources, config, log);
+        }
+
+        EReloadStatus FinishReload(Globals& vk, GlobalResources& vkResources, Resources& resources, const Configs::Config& config, std::ofstream& log)
+        {
+            return EReloadStatus::SUCCEEDED;
+        }
+
         bool Resize(Globals& vk, GlobalResources& vkResources, Resources& resources, std::ofstream& log)
         {
             return Graphics::Vulkan::DDGI::Resize(vk, vkResources, resources, log);
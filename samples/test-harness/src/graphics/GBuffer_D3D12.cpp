@@ -26,6 +26,7 @@ namespace Graphics
                 // Release existing shaders
                 resources.shaders.Release();
                 resources.rayTraceCS.Release();
+                resources.tileArgsCS.Release();
 
                 std::wstring root = std::wstring(d3d.shaderCompiler.root.begin(), d3d.shaderCompiler.root.end());
 
@@ -72,10 +73,24 @@ namespace Graphics
                     resources.rayTraceCS.entryPoint = L"CS";
                     resources.rayTraceCS.targetProfile = L"cs_6_6";
                     Shaders::AddDefine(resources.rayTraceCS, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                    Shaders::AddDefine(resources.rayTraceCS, L"GBUFFER_VISIBILITY", std::to_wstring(d3d.GBufferVisibility ? 1 : 0));
+                    Shaders::AddDefine(resources.rayTraceCS, L"TEXTURE_STREAMING", std::to_wstring(d3d.TextureStreaming ? 1 : 0));
+                    Shaders::AddDefine(resources.rayTraceCS, L"GBUFFER_TILES", std::to_wstring(d3d.GBufferTiles ? 1 : 0));
 
                     CHECK(Shaders::Compile(d3d.shaderCompiler, resources.rayTraceCS), "compile gbuffer compute shader!\n", log);
                 }
 
+                if (d3d.GBufferTiles)
+                {
+                    // Load and compile the GBuffer tile dispatch arguments shader
+                    resources.tileArgsCS.filepath = root + L"shaders/GBufferTileArgsCS.hlsl";
+                    resources.tileArgsCS.entryPoint = L"CS";
+                    resources.tileArgsCS.targetProfile = L"cs_6_6";
+                    Shaders::AddDefine(resources.tileArgsCS, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+
+                    CHECK(Shaders::Compile(d3d.shaderCompiler, resources.tileArgsCS), "compile GBuffer tile arguments compute shader!\n", log);
+                }
+
                 return true;
             }
 
@@ -85,10 +100,11 @@ namespace Graphics
                 SAFE_RELEASE(resources.rtpsoInfo);
                 SAFE_RELEASE(resources.rtpso);
                 SAFE_RELEASE(resources.rayTracePSO);
+                SAFE_RELEASE(resources.tileArgsPSO);
 
                 // Create the RTPSO
                 CHECK(CreateRayTracingPSO(
-                    d3d.device,
+                    d3d,
                     d3dResources.rootSignature,
                     resources.shaders,
                     &resources.rtpso,
@@ -100,7 +116,7 @@ namespace Graphics
             #endif
 
                 CHECK(CreateComputePSO(
-                          d3d.device,
+                          d3d,
                           d3dResources.rootSignature,
                           resources.rayTraceCS,
                           &resources.rayTracePSO),
@@ -109,6 +125,19 @@ namespace Graphics
                 resources.rayTracePSO->SetName(L"GBuffer Trace PSO");
 #endif
 
+                if (d3d.GBufferTiles)
+                {
+                    CHECK(CreateComputePSO(
+                              d3d,
+                              d3dResources.rootSignature,
+                              resources.tileArgsCS,
+                              &resources.tileArgsPSO),
+                              "create GBuffer tile arguments PSO!\n", log);
+                #ifdef GFX_NAME_OBJECTS
+                    resources.tileArgsPSO->SetName(L"GBuffer Tile Args PSO");
+                #endif
+                }
+
                 return true;
             }
 
@@ -193,7 +222,7 @@ namespace Graphics
                 resources.shaderTableUpload->Unmap(0, nullptr);
 
                 // Schedule a copy of the upload buffer to the device buffer
-                d3d.cmdList[d3d.frameIndex]->CopyBufferRegion(resources.shaderTable, 0, resources.shaderTableUpload, 0, resources.shaderTableSize);
+                GetCmdList(d3d)->CopyBufferRegion(resources.shaderTable, 0, resources.shaderTableUpload, 0, resources.shaderTableSize);
 
                 // Transition the default heap resource to generic read after the copy is complete
                 D3D12_RESOURCE_BARRIER barrier = {};
@@ -203,7 +232,7 @@ namespace Graphics
                 barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_GENERIC_READ;
                 barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
 
-                d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+                GetCmdList(d3d)->ResourceBarrier(1, &barrier);
 
                 return true;
             }
@@ -249,6 +278,10 @@ namespace Graphics
             {
                 CPU_TIMESTAMP_BEGIN(resources.cpuStat);
 
+                // Select the ray tracing backend (see Benchmark::UpdateBackendSelection).
+                // The visibility buffer, the tile list, and texture streaming feedback are only written by GBufferCS.
+                resources.useInlineRayTracing = config.app.gbufferInlineRayTracing || d3d.GBufferVisibility || d3d.GBufferTiles || d3d.TextureStreaming;
+
                 // Update bias constants
                 d3dResources.constants.pt.rayNormalBias = config.pathTrace.rayNormalBias;
                 d3dResources.constants.pt.rayViewBias = config.pathTrace.rayViewBias;
@@ -262,85 +295,109 @@ namespace Graphics
             void Execute(Globals& d3d, GlobalResources& d3dResources, Resources& resources)
             {
             #ifdef GFX_PERF_MARKERS
-                PIXBeginEvent(d3d.cmdList[d3d.frameIndex], PIX_COLOR(GFX_PERF_MARKER_ORANGE), "GBuffer");
+                PIXBeginEvent(GetCmdList(d3d), PIX_COLOR(GFX_PERF_MARKER_ORANGE), "GBuffer");
             #endif
                 CPU_TIMESTAMP_BEGIN(resources.cpuStat);
 
                 // Set the descriptor heaps
                 ID3D12DescriptorHeap* ppHeaps[] = { d3dResources.srvDescHeap, d3dResources.samplerDescHeap };
-                d3d.cmdList[d3d.frameIndex]->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+                GetCmdList(d3d)->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
 
                 // Set the root signature
-                d3d.cmdList[d3d.frameIndex]->SetComputeRootSignature(d3dResources.rootSignature);
+                GetCmdList(d3d)->SetComputeRootSignature(d3dResources.rootSignature);
 
                 // Update the root constants
                 UINT offset = 0;
                 GlobalConstants consts = d3dResources.constants;
-                d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(0, AppConsts::GetNum32BitValues(), consts.app.GetData(), offset);
+                GetCmdList(d3d)->SetComputeRoot32BitConstants(0, AppConsts::GetNum32BitValues(), consts.app.GetData(), offset);
                 offset += AppConsts::GetAlignedNum32BitValues();
-                d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(0, PathTraceConsts::GetNum32BitValues(), consts.pt.GetData(), offset);
+                GetCmdList(d3d)->SetComputeRoot32BitConstants(0, PathTraceConsts::GetNum32BitValues(), consts.pt.GetData(), offset);
                 offset += PathTraceConsts::GetAlignedNum32BitValues();
-                d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(0, LightingConsts::GetNum32BitValues(), consts.lights.GetData(), offset);
+                GetCmdList(d3d)->SetComputeRoot32BitConstants(0, LightingConsts::GetNum32BitValues(), consts.lights.GetData(), offset);
 
                 // Set the root parameter descriptor tables
             #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
-                d3d.cmdList[d3d.frameIndex]->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
-                d3d.cmdList[d3d.frameIndex]->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
+                GetCmdList(d3d)->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
+                GetCmdList(d3d)->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
             #endif
 
-                // Dispatch rays
-                D3D12_DISPATCH_RAYS_DESC desc = {};
-                desc.RayGenerationShaderRecord.StartAddress = resources.shaderTableRGSStartAddress;
-                desc.RayGenerationShaderRecord.SizeInBytes = resources.shaderTableRecordSize;
-
-                desc.MissShaderTable.StartAddress = resources.shaderTableMissTableStartAddress;
-                desc.MissShaderTable.SizeInBytes = resources.shaderTableMissTableSize;
-                desc.MissShaderTable.StrideInBytes = resources.shaderTableRecordSize;
-
-                desc.HitGroupTable.StartAddress = resources.shaderTableHitGroupTableStartAddress;
-                desc.HitGroupTable.SizeInBytes = resources.shaderTableHitGroupTableSize;
-                desc.HitGroupTable.StrideInBytes = resources.shaderTableRecordSize;
-
-                desc.Width = d3d.width;
-                desc.Height = d3d.height;
-                desc.Depth = 1;
-
-                // {
-                //     // Set the PSO
-                //     d3d.cmdList[d3d.frameIndex]->SetPipelineState1(resources.rtpso);
-                //
-                //     // Dispatch rays
-                //     GPU_TIMESTAMP_BEGIN(resources.gpuStat->GetGPUQueryBeginIndex());
-                //     d3d.cmdList[d3d.frameIndex]->DispatchRays(&desc);
-                //     GPU_TIMESTAMP_END(resources.gpuStat->GetGPUQueryEndIndex());
-                // }
-
+                if (resources.useInlineRayTracing)
+                {
+                    // Dispatch threads, one thread group per GBuffer tile
+                    UINT X = DivRoundUp(d3d.renderWidth, GBUFFER_TILE_SIZE);
+                    UINT Y = DivRoundUp(d3d.renderHeight, GBUFFER_TILE_SIZE);
+                    GetCmdList(d3d)->SetPipelineState(resources.rayTracePSO);
+                    GPU_TIMESTAMP_BEGIN(resources.gpuStat->GetGPUQueryBeginIndex());
+                    GetCmdList(d3d)->Dispatch(X, Y, 1);
+                    GPU_TIMESTAMP_END(resources.gpuStat->GetGPUQueryEndIndex());
+                }
+                else
                 {
-                    UINT X = d3d.width / 8;
-                    UINT Y = d3d.height / 8;
-                    UINT Z = 1;
-                    d3d.cmdList[d3d.frameIndex]->SetPipelineState(resources.rayTracePSO);
+                    // Dispatch rays
+                    D3D12_DISPATCH_RAYS_DESC desc = {};
+                    desc.RayGenerationShaderRecord.StartAddress = resources.shaderTableRGSStartAddress;
+                    desc.RayGenerationShaderRecord.SizeInBytes = resources.shaderTableRecordSize;
+
+                    desc.MissShaderTable.StartAddress = resources.shaderTableMissTableStartAddress;
+                    desc.MissShaderTable.SizeInBytes = resources.shaderTableMissTableSize;
+                    desc.MissShaderTable.StrideInBytes = resources.shaderTableRecordSize;
+
+                    desc.HitGroupTable.StartAddress = resources.shaderTableHitGroupTableStartAddress;
+                    desc.HitGroupTable.SizeInBytes = resources.shaderTableHitGroupTableSize;
+                    desc.HitGroupTable.StrideInBytes = resources.shaderTableRecordSize;
+
+                    desc.Width = d3d.renderWidth;
+                    desc.Height = d3d.renderHeight;
+                    desc.Depth = 1;
+
+                    // Set the PSO
+                    GetCmdList(d3d)->SetPipelineState1(resources.rtpso);
+
                     GPU_TIMESTAMP_BEGIN(resources.gpuStat->GetGPUQueryBeginIndex());
-                    d3d.cmdList[d3d.frameIndex]->Dispatch(X, Y, Z);
+                    GetCmdList(d3d)->DispatchRays(&desc);
                     GPU_TIMESTAMP_END(resources.gpuStat->GetGPUQueryEndIndex());
                 }
 
-                D3D12_RESOURCE_BARRIER barriers[4] = {};
-                barriers[0].Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
-                barriers[0].UAV.pResource = d3dResources.rt.GBufferA;
-                barriers[1].Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
-                barriers[1].UAV.pResource = d3dResources.rt.GBufferB;
-                barriers[2].Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
-                barriers[2].UAV.pResource = d3dResources.rt.GBufferC;
-                barriers[3].Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
-                barriers[3].UAV.pResource = d3dResources.rt.GBufferD;
+                // The GBuffer's consumers wait for the ray trace through the render graph's barriers (see RenderGraph.h)
 
-                // Wait for the ray trace to complete
-                d3d.cmdList[d3d.frameIndex]->ResourceBarrier(4, barriers);
+                if (d3d.GBufferTiles)
+                {
+                    // Wait for the tile list, then write the dispatch arguments (and reset the tile count)
+                    D3D12_RESOURCE_BARRIER barrier = {};
+                    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+                    barrier.UAV.pResource = d3dResources.rt.GBufferTiles;
+                    GetCmdList(d3d)->ResourceBarrier(1, &barrier);
+
+                    GetCmdList(d3d)->SetPipelineState(resources.tileArgsPSO);
+                    GetCmdList(d3d)->Dispatch(1, 1, 1);
+
+                    // The tile list is read as a UAV by the indirect passes, so copy the arguments to a buffer
+                    // that stays in the indirect argument state while those passes execute
+                    D3D12_RESOURCE_BARRIER tileBarriers[2] = {};
+                    tileBarriers[0].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+                    tileBarriers[0].Transition.pResource = d3dResources.rt.GBufferTiles;
+                    tileBarriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                    tileBarriers[0].Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
+                    tileBarriers[0].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+                    tileBarriers[1].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+                    tileBarriers[1].Transition.pResource = d3dResources.rt.GBufferTileArgs;
+                    tileBarriers[1].Transition.StateBefore = D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT;
+                    tileBarriers[1].Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
+                    tileBarriers[1].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+                    GetCmdList(d3d)->ResourceBarrier(2, tileBarriers);
+
+                    GetCmdList(d3d)->CopyBufferRegion(d3dResources.rt.GBufferTileArgs, 0, d3dResources.rt.GBufferTiles, 0, sizeof(D3D12_DISPATCH_ARGUMENTS));
+
+                    tileBarriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE;
+                    tileBarriers[0].Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                    tileBarriers[1].Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+                    tileBarriers[1].Transition.StateAfter = D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT;
+                    GetCmdList(d3d)->ResourceBarrier(2, tileBarriers);
+                }
 
                 CPU_TIMESTAMP_ENDANDRESOLVE(resources.cpuStat);
             #ifdef GFX_PERF_MARKERS
-                PIXEndEvent(d3d.cmdList[d3d.frameIndex]);
+                PIXEndEvent(GetCmdList(d3d));
             #endif
             }
 
@@ -352,6 +409,7 @@ namespace Graphics
                 // Release shaders and shader table
                 resources.shaders.Release();
                 resources.rayTraceCS.Release();
+                resources.tileArgsCS.Release();
                 SAFE_RELEASE(resources.shaderTable);
                 SAFE_RELEASE(resources.shaderTableUpload);
 
@@ -359,6 +417,7 @@ namespace Graphics
                 SAFE_RELEASE(resources.rtpsoInfo);
                 SAFE_RELEASE(resources.rtpso);
                 SAFE_RELEASE(resources.rayTracePSO);
+                SAFE_RELEASE(resources.tileArgsPSO);
             }
 
             /**
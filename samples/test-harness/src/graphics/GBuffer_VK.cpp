@@ -114,7 +114,7 @@ namespace Graphics
 
                 // Create the ray tracing pipeline
                 CHECK(CreateRayTracingPipeline(
-                    vk.device,
+                    vk,
                     vkResources.pipelineLayout,
                     resources.shaders, resources.modules,
                     &resources.pipeline), "create GBuffer pipeline!\n", log);
@@ -123,7 +123,7 @@ namespace Graphics
             #endif
 
                 // Create the compute pipeline for inline ray tracing
-                CHECK(CreateComputePipeline(vk.device, vkResources.pipelineLayout, resources.csShader, resources.csModule, &resources.csPipeline), "create GBuffer CS pipeline!\n", log);
+                CHECK(CreateComputePipeline(vk, vkResources.pipelineLayout, resources.csShader, resources.csModule, &resources.csPipeline), "create GBuffer CS pipeline!\n", log);
             #ifdef GFX_NAME_OBJECTS
                 SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.csPipeline), "GBuffer CS Pipeline", VK_OBJECT_TYPE_PIPELINE);
             #endif
@@ -224,7 +224,7 @@ namespace Graphics
                 // Schedule a copy of the shader table from the upload buffer to the device buffer
                 VkBufferCopy bufferCopy = {};
                 bufferCopy.size = resources.shaderTableSize;
-                vkCmdCopyBuffer(vk.cmdBuffer[vk.frameIndex], resources.shaderTableUpload, resources.shaderTable, 1, &bufferCopy);
+                vkCmdCopyBuffer(GetCmdBuffer(vk), resources.shaderTableUpload, resources.shaderTable, 1, &bufferCopy);
 
                 return true;
             }
@@ -437,8 +437,8 @@ namespace Graphics
             {
                 CPU_TIMESTAMP_BEGIN(resources.cpuStat);
 
-                // Update inline ray tracing mode (follows DDGI setting since GBuffer is used with DDGI)
-                resources.useInlineRayTracing = config.ddgi.useInlineRayTracing;
+                // Select the ray tracing backend (see Benchmark::UpdateBackendSelection)
+                resources.useInlineRayTracing = config.app.gbufferInlineRayTracing;
 
                 // Path Trace constants
                 vkResources.constants.pt.rayNormalBias = config.pathTrace.rayNormalBias;
@@ -460,29 +460,29 @@ namespace Graphics
                 // Set the push constants
                 uint32_t offset = 0;
                 GlobalConstants consts = vkResources.constants;
-                vkCmdPushConstants(vk.cmdBuffer[vk.frameIndex], vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, consts.app.GetSizeInBytes(), consts.app.GetData());
+                vkCmdPushConstants(GetCmdBuffer(vk), vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, consts.app.GetSizeInBytes(), consts.app.GetData());
                 offset += AppConsts::GetAlignedSizeInBytes();
-                vkCmdPushConstants(vk.cmdBuffer[vk.frameIndex], vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, consts.pt.GetSizeInBytes(), consts.pt.GetData());
+                vkCmdPushConstants(GetCmdBuffer(vk), vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, consts.pt.GetSizeInBytes(), consts.pt.GetData());
                 offset += PathTraceConsts::GetAlignedSizeInBytes();
-                vkCmdPushConstants(vk.cmdBuffer[vk.frameIndex], vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, consts.lights.GetSizeInBytes(), consts.lights.GetData());
+                vkCmdPushConstants(GetCmdBuffer(vk), vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, consts.lights.GetSizeInBytes(), consts.lights.GetData());
 
                 GPU_TIMESTAMP_BEGIN(resources.gpuStat->GetGPUQueryBeginIndex());
 
                 if (resources.useInlineRayTracing)
                 {
                     // Use compute shader with inline ray tracing
-                    vkCmdBindPipeline(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_COMPUTE, resources.csPipeline);
-                    vkCmdBindDescriptorSets(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_COMPUTE, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
+                    vkCmdBindPipeline(GetCmdBuffer(vk), VK_PIPELINE_BIND_POINT_COMPUTE, resources.csPipeline);
+                    vkCmdBindDescriptorSets(GetCmdBuffer(vk), VK_PIPELINE_BIND_POINT_COMPUTE, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
 
-                    uint32_t groupsX = DivRoundUp(vk.width, GBUFFER_CS_BLOCK_SIZE);
-                    uint32_t groupsY = DivRoundUp(vk.height, GBUFFER_CS_BLOCK_SIZE);
-                    vkCmdDispatch(vk.cmdBuffer[vk.frameIndex], groupsX, groupsY, 1);
+                    uint32_t groupsX = DivRoundUp(vk.renderWidth, GBUFFER_CS_BLOCK_SIZE);
+                    uint32_t groupsY = DivRoundUp(vk.renderHeight, GBUFFER_CS_BLOCK_SIZE);
+                    vkCmdDispatch(GetCmdBuffer(vk), groupsX, groupsY, 1);
                 }
                 else
                 {
                     // Use traditional ray tracing pipeline
-                    vkCmdBindPipeline(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, resources.pipeline);
-                    vkCmdBindDescriptorSets(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
+                    vkCmdBindPipeline(GetCmdBuffer(vk), VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, resources.pipeline);
+                    vkCmdBindDescriptorSets(GetCmdBuffer(vk), VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
 
                     // Describe the shader table
                     VkStridedDeviceAddressRegionKHR raygenRegion = {};
@@ -503,21 +503,15 @@ namespace Graphics
                     VkStridedDeviceAddressRegionKHR callableRegion = {};
 
                     // Dispatch rays
-                    vkCmdTraceRaysKHR(vk.cmdBuffer[vk.frameIndex], &raygenRegion, &missRegion, &hitRegion, &callableRegion, vk.width, vk.height, 1);
+                    vkCmdTraceRaysKHR(GetCmdBuffer(vk), &raygenRegion, &missRegion, &hitRegion, &callableRegion, vk.renderWidth, vk.renderHeight, 1);
                 }
 
                 GPU_TIMESTAMP_END(resources.gpuStat->GetGPUQueryEndIndex());
 
-                // Wait for the ray trace/compute to complete
-                VkImageSubresourceRange range = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
-                ImageBarrierDesc barrier = { VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 } };
-                SetImageMemoryBarrier(vk.cmdBuffer[vk.frameIndex], vkResources.rt.GBufferA, barrier);
-                SetImageMemoryBarrier(vk.cmdBuffer[vk.frameIndex], vkResources.rt.GBufferB, barrier);
-                SetImageMemoryBarrier(vk.cmdBuffer[vk.frameIndex], vkResources.rt.GBufferC, barrier);
-                SetImageMemoryBarrier(vk.cmdBuffer[vk.frameIndex], vkResources.rt.GBufferD, barrier);
+                // The GBuffer's consumers wait for the ray trace/compute through the render graph's barriers (see RenderGraph.h)
 
             #ifdef GFX_PERF_MARKERS
-                vkCmdEndDebugUtilsLabelEXT(vk.cmdBuffer[vk.frameIndex]);
+                vkCmdEndDebugUtilsLabelEXT(GetCmdBuffer(vk));
             #endif
 
                 CPU_TIMESTAMP_ENDANDRESOLVE(resources.cpuStat);
@@ -10,12 +10,25 @@
 
 #include "graphics/PathTracing.h"
 
+#include <DirectXPackedVector.h>
+
 namespace Graphics
 {
     namespace D3D12
     {
         namespace PathTracing
         {
+            // Wavefront path tracing limits, must match PathTraceWavefrontCS.hlsl
+            const uint32_t PT_WAVEFRONT_MAX_PATHS = 256 * 1024;        // Paths in flight (pixels per chunk)
+            const uint32_t PT_WAVEFRONT_MAX_BOUNCES = 32;
+            const uint32_t PT_WAVEFRONT_SORT_BIN_COUNT = 256;
+            const uint32_t PT_WAVEFRONT_PERSISTENT_GROUPS = 1024;      // Thread groups (of 64) of the persistent kernels
+            const uint32_t PT_WAVEFRONT_COUNTERS_SIZE = sizeof(uint32_t) * ((2 * PT_WAVEFRONT_SORT_BIN_COUNT) + (8 * PT_WAVEFRONT_MAX_BOUNCES));
+
+            // Convergence tiles and buffer layout, must match PathTraceConvergence.hlsl
+            const uint32_t PT_CONVERGENCE_TILE_SIZE = 16;
+            const uint32_t PT_CONVERGENCE_TILE_FLAGS_OFFSET = 16;
+
             //----------------------------------------------------------------------------------------------------------
             // Private Functions
             //----------------------------------------------------------------------------------------------------------
@@ -51,6 +64,114 @@ namespace Graphics
                 handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_PT_ACCUMULATION * d3dResources.srvDescHeapEntrySize);
                 d3d.device->CreateUnorderedAccessView(resources.PTAccumulation, nullptr, &uavDesc, handle);
 
+                // Create the variance (R32G32_FLOAT) texture resource
+                desc.format = DXGI_FORMAT_R32G32_FLOAT;
+                CHECK(CreateTexture(d3d, desc, &resources.PTVariance), "create path tracing variance texture resource!\n", log);
+            #ifdef GFX_NAME_OBJECTS
+                resources.PTVariance->SetName(L"PT Variance");
+            #endif
+
+                // Add the variance texture UAV to the descriptor heap
+                uavDesc.Format = desc.format;
+                handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_PT_VARIANCE * d3dResources.srvDescHeapEntrySize);
+                d3d.device->CreateUnorderedAccessView(resources.PTVariance, nullptr, &uavDesc, handle);
+
+                // Create the convergence buffer (unconverged tile counts + a flag per tile) and its readback buffers
+                resources.numConvergenceTiles = DivRoundUp(d3d.width, PT_CONVERGENCE_TILE_SIZE) * DivRoundUp(d3d.height, PT_CONVERGENCE_TILE_SIZE);
+                UINT convergenceSize = PT_CONVERGENCE_TILE_FLAGS_OFFSET + (resources.numConvergenceTiles * sizeof(uint32_t));
+
+                BufferDesc bufferDesc = { convergenceSize, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+                CHECK(CreateBuffer(d3d, bufferDesc, &resources.PTConvergence), "create path tracing convergence buffer!\n", log);
+            #ifdef GFX_NAME_OBJECTS
+                resources.PTConvergence->SetName(L"PT Convergence");
+            #endif
+
+                bufferDesc = { sizeof(uint32_t), 0, EHeapType::READBACK, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_FLAG_NONE };
+                for (UINT frameIndex = 0; frameIndex < MAX_FRAMES_IN_FLIGHT; frameIndex++)
+                {
+                    CHECK(CreateBuffer(d3d, bufferDesc, &resources.PTConvergenceReadback[frameIndex]), "create path tracing convergence readback buffer!\n", log);
+                #ifdef GFX_NAME_OBJECTS
+                    resources.PTConvergenceReadback[frameIndex]->SetName(L"PT Convergence Readback");
+                #endif
+                    resources.convergenceReadbackFrame[frameIndex] = 0;
+                }
+
+                // Add the convergence buffer UAV (RWByteAddressBuffer) to the descriptor heap
+                D3D12_UNORDERED_ACCESS_VIEW_DESC rawUavDesc = {};
+                rawUavDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+                rawUavDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+                rawUavDesc.Buffer.FirstElement = 0;
+                rawUavDesc.Buffer.NumElements = convergenceSize / sizeof(uint32_t);
+                rawUavDesc.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_RAW;
+                handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_PT_CONVERGENCE * d3dResources.srvDescHeapEntrySize);
+                d3d.device->CreateUnorderedAccessView(resources.PTConvergence, nullptr, &rawUavDesc, handle);
+
+                resources.converged = false;
+                resources.numUnconvergedTiles = resources.numConvergenceTiles;
+
+                return true;
+            }
+
+            bool CreateWavefrontBuffers(Globals& d3d, GlobalResources& d3dResources, Resources& resources, std::ofstream& log)
+            {
+                // The path state is sized for a chunk of paths (not the screen), larger screens are traced in several chunks
+                BufferDesc desc = { sizeof(PathTraceWavefrontPath) * PT_WAVEFRONT_MAX_PATHS, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS };
+                CHECK(CreateBuffer(d3d, desc, &resources.PTWavefrontPaths), "create wavefront path tracing paths buffer!\n", log);
+
+                desc.size = sizeof(PathTraceWavefrontHit) * PT_WAVEFRONT_MAX_PATHS;
+                CHECK(CreateBuffer(d3d, desc, &resources.PTWavefrontHits), "create wavefront path tracing hits buffer!\n", log);
+
+                desc.size = sizeof(PathTraceWavefrontSurface) * PT_WAVEFRONT_MAX_PATHS;
+                CHECK(CreateBuffer(d3d, desc, &resources.PTWavefrontSurfaces), "create wavefront path tracing surfaces buffer!\n", log);
+
+                // Ray queue, hit queue, and sorted hit queue
+                desc.size = sizeof(uint32_t) * 3 * PT_WAVEFRONT_MAX_PATHS;
+                CHECK(CreateBuffer(d3d, desc, &resources.PTWavefrontQueues), "create wavefront path tracing queues buffer!\n", log);
+
+                // Material sort bin counts and offsets, per bounce queue and work counters
+                desc.size = PT_WAVEFRONT_COUNTERS_SIZE;
+                CHECK(CreateBuffer(d3d, desc, &resources.PTWavefrontCounters), "create wavefront path tracing counters buffer!\n", log);
+            #ifdef GFX_NAME_OBJECTS
+                resources.PTWavefrontPaths->SetName(L"PT Wavefront Paths");
+                resources.PTWavefrontHits->SetName(L"PT Wavefront Hits");
+                resources.PTWavefrontSurfaces->SetName(L"PT Wavefront Surfaces");
+                resources.PTWavefrontQueues->SetName(L"PT Wavefront Queues");
+                resources.PTWavefrontCounters->SetName(L"PT Wavefront Counters");
+            #endif
+
+                // Add the structured buffer UAVs to the descriptor heap
+                D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+                uavDesc.Format = DXGI_FORMAT_UNKNOWN;
+                uavDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+                uavDesc.Buffer.FirstElement = 0;
+                uavDesc.Buffer.NumElements = PT_WAVEFRONT_MAX_PATHS;
+                uavDesc.Buffer.StructureByteStride = sizeof(PathTraceWavefrontPath);
+
+                D3D12_CPU_DESCRIPTOR_HANDLE handle;
+                handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_PT_WAVEFRONT_PATHS * d3dResources.srvDescHeapEntrySize);
+                d3d.device->CreateUnorderedAccessView(resources.PTWavefrontPaths, nullptr, &uavDesc, handle);
+
+                uavDesc.Buffer.StructureByteStride = sizeof(PathTraceWavefrontHit);
+                handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_PT_WAVEFRONT_HITS * d3dResources.srvDescHeapEntrySize);
+                d3d.device->CreateUnorderedAccessView(resources.PTWavefrontHits, nullptr, &uavDesc, handle);
+
+                uavDesc.Buffer.StructureByteStride = sizeof(PathTraceWavefrontSurface);
+                handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_PT_WAVEFRONT_SURFACES * d3dResources.srvDescHeapEntrySize);
+                d3d.device->CreateUnorderedAccessView(resources.PTWavefrontSurfaces, nullptr, &uavDesc, handle);
+
+                uavDesc.Buffer.NumElements = 3 * PT_WAVEFRONT_MAX_PATHS;
+                uavDesc.Buffer.StructureByteStride = sizeof(uint32_t);
+                handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_PT_WAVEFRONT_QUEUES * d3dResources.srvDescHeapEntrySize);
+                d3d.device->CreateUnorderedAccessView(resources.PTWavefrontQueues, nullptr, &uavDesc, handle);
+
+                // Add the counters UAV (RWByteAddressBuffer) to the descriptor heap
+                uavDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+                uavDesc.Buffer.NumElements = PT_WAVEFRONT_COUNTERS_SIZE / sizeof(uint32_t);
+                uavDesc.Buffer.StructureByteStride = 0;
+                uavDesc.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_RAW;
+                handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_PT_WAVEFRONT_COUNTERS * d3dResources.srvDescHeapEntrySize);
+                d3d.device->CreateUnorderedAccessView(resources.PTWavefrontCounters, nullptr, &uavDesc, handle);
+
                 return true;
             }
 
@@ -58,6 +179,14 @@ namespace Graphics
             {
                 // Release existing shaders
                 resources.shaders.Release();
+                resources.wavefrontGenerateCS.Release();
+                resources.wavefrontExtendCS.Release();
+                resources.wavefrontSortCS.Release();
+                resources.wavefrontScatterCS.Release();
+                resources.wavefrontShadeCS.Release();
+                resources.wavefrontConnectCS.Release();
+                resources.wavefrontResolveCS.Release();
+                resources.convergenceCS.Release();
 
                 std::wstring root = std::wstring(d3d.shaderCompiler.root.begin(), d3d.shaderCompiler.root.end());
 
@@ -67,6 +196,19 @@ namespace Graphics
                 resources.shaders.rgs.exportName = L"PathTraceRGS";
                 Shaders::AddDefine(resources.shaders.rgs, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
                 Shaders::AddDefine(resources.shaders.rgs, L"GFX_NVAPI", std::to_wstring(GFX_NVAPI));
+                if (d3d.PTRadianceCacheBounce > 0)
+                {
+                    // Paths end in (and update) the DDGI radiance cache, see PathTraceRadianceCache.hlsl
+                    Shaders::AddDefine(resources.shaders.rgs, L"PT_RADIANCE_CACHE_BOUNCE", std::to_wstring(d3d.PTRadianceCacheBounce));
+                    Shaders::AddDefine(resources.shaders.rgs, L"RADIANCE_CACHE_CASCADE_COUNT", std::to_wstring(d3d.NumVolume));
+                    Shaders::AddDefine(resources.shaders.rgs, L"RADIANCE_CACHE_CASCADE_CELL_RADIUS", std::to_wstring(d3d.CascadeCellRadius));
+                    Shaders::AddDefine(resources.shaders.rgs, L"RADIANCE_CACHE_CASCADE_DISTANCE", std::to_wstring(d3d.CascadeDistance));
+                    Shaders::AddDefine(resources.shaders.rgs, L"RADIANCE_CACHE_CASCADE_MODE", std::to_wstring(d3d.RadianceCacheCascadeMode));
+                    Shaders::AddDefine(resources.shaders.rgs, L"RADIANCE_CACHE_HASH_FUNCTION", std::to_wstring(d3d.RadianceCacheHashFunction));
+                    Shaders::AddDefine(resources.shaders.rgs, L"RADIANCE_CACHE_BRICK_LAYOUT", std::to_wstring(d3d.RadianceCacheBrickLayout ? 1 : 0));
+                    Shaders::AddDefine(resources.shaders.rgs, L"RADIANCE_CACHE_CELL_COUNT", std::to_wstring(d3d.CacheCount));
+                    Shaders::AddDefine(resources.shaders.rgs, L"RADIANCE_CACHE_RADIANCE_FORMAT", std::to_wstring(d3d.RadianceCacheRadianceFormat));
+                }
                 CHECK(Shaders::Compile(d3d.shaderCompiler, resources.shaders.rgs), "compile path tracing ray generation shader!\n", log);
 
                 // Load and compile the miss shader
@@ -99,6 +241,38 @@ namespace Graphics
                 // Set the payload size
                 resources.shaders.payloadSizeInBytes = sizeof(PackedPayload);
 
+                // Load and compile the wavefront path tracing compute shaders
+                struct WavefrontShader { Shaders::ShaderProgram* shader; const wchar_t* entryPoint; };
+                WavefrontShader wavefrontShaders[] =
+                {
+                    { &resources.wavefrontGenerateCS, L"GenerateCS" },
+                    { &resources.wavefrontExtendCS, L"ExtendCS" },
+                    { &resources.wavefrontSortCS, L"SortCS" },
+                    { &resources.wavefrontScatterCS, L"ScatterCS" },
+                    { &resources.wavefrontShadeCS, L"ShadeCS" },
+                    { &resources.wavefrontConnectCS, L"ConnectCS" },
+                    { &resources.wavefrontResolveCS, L"ResolveCS" },
+                };
+
+                for (WavefrontShader& wavefrontShader : wavefrontShaders)
+                {
+                    Shaders::ShaderProgram& shader = *wavefrontShader.shader;
+                    shader.filepath = root + L"shaders/PathTraceWavefrontCS.hlsl";
+                    shader.entryPoint = wavefrontShader.entryPoint;
+                    shader.targetProfile = L"cs_6_6";
+                    Shaders::AddDefine(shader, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                    Shaders::AddDefine(shader, L"PT_WAVEFRONT_MAX_PATHS", std::to_wstring(PT_WAVEFRONT_MAX_PATHS));
+                    Shaders::AddDefine(shader, L"PT_WAVEFRONT_MAX_BOUNCES", std::to_wstring(PT_WAVEFRONT_MAX_BOUNCES));
+                    CHECK(Shaders::Compile(d3d.shaderCompiler, shader), "compile wavefront path tracing compute shader!\n", log);
+                }
+
+                // Load and compile the convergence compute shader
+                resources.convergenceCS.filepath = root + L"shaders/PathTraceConvergenceCS.hlsl";
+                resources.convergenceCS.entryPoint = L"CS";
+                resources.convergenceCS.targetProfile = L"cs_6_6";
+                Shaders::AddDefine(resources.convergenceCS, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                CHECK(Shaders::Compile(d3d.shaderCompiler, resources.convergenceCS), "compile path tracing convergence compute shader!\n", log);
+
                 return true;
             }
 
@@ -110,7 +284,7 @@ namespace Graphics
 
                 // Create the RTPSO
                 CHECK(CreateRayTracingPSO(
-                    d3d.device,
+                    d3d,
                     d3dResources.rootSignature,
                     resources.shaders,
                     &resources.rtpso,
@@ -121,6 +295,45 @@ namespace Graphics
                 resources.rtpso->SetName(L"Path Tracing RTPSO");
             #endif
 
+                // Create the wavefront path tracing compute PSOs
+                struct WavefrontPSO { Shaders::ShaderProgram* shader; ID3D12PipelineState** pso; const wchar_t* name; };
+                WavefrontPSO wavefrontPSOs[] =
+                {
+                    { &resources.wavefrontGenerateCS, &resources.wavefrontGeneratePSO, L"PT Wavefront Generate PSO" },
+                    { &resources.wavefrontExtendCS, &resources.wavefrontExtendPSO, L"PT Wavefront Extend PSO" },
+                    { &resources.wavefrontSortCS, &resources.wavefrontSortPSO, L"PT Wavefront Sort PSO" },
+                    { &resources.wavefrontScatterCS, &resources.wavefrontScatterPSO, L"PT Wavefront Scatter PSO" },
+                    { &resources.wavefrontShadeCS, &resources.wavefrontShadePSO, L"PT Wavefront Shade PSO" },
+                    { &resources.wavefrontConnectCS, &resources.wavefrontConnectPSO, L"PT Wavefront Connect PSO" },
+                    { &resources.wavefrontResolveCS, &resources.wavefrontResolvePSO, L"PT Wavefront Resolve PSO" },
+                };
+
+                for (WavefrontPSO& wavefrontPSO : wavefrontPSOs)
+                {
+                    SAFE_RELEASE(*wavefrontPSO.pso);
+                    CHECK(CreateComputePSO(
+                        d3d,
+                        d3dResources.rootSignature,
+                        *wavefrontPSO.shader,
+                        wavefrontPSO.pso),
+                        "create wavefront path tracing PSO!\n", log);
+                #ifdef GFX_NAME_OBJECTS
+                    (*wavefrontPSO.pso)->SetName(wavefrontPSO.name);
+                #endif
+                }
+
+                // Create the convergence compute PSO
+                SAFE_RELEASE(resources.convergencePSO);
+                CHECK(CreateComputePSO(
+                    d3d,
+                    d3dResources.rootSignature,
+                    resources.convergenceCS,
+                    &resources.convergencePSO),
+                    "create path tracing convergence PSO!\n", log);
+            #ifdef GFX_NAME_OBJECTS
+                resources.convergencePSO->SetName(L"PT Convergence PSO");
+            #endif
+
                 return true;
             }
 
@@ -206,7 +419,7 @@ namespace Graphics
                 resources.shaderTableUpload->Unmap(0, nullptr);
 
                 // Schedule a copy of the upload buffer to the device buffer
-                d3d.cmdList[d3d.frameIndex]->CopyBufferRegion(resources.shaderTable, 0, resources.shaderTableUpload, 0, resources.shaderTableSize);
+                GetCmdList(d3d)->CopyBufferRegion(resources.shaderTable, 0, resources.shaderTableUpload, 0, resources.shaderTableSize);
 
                 // Transition the default heap resource to generic read after the copy is complete
                 D3D12_RESOURCE_BARRIER barrier = {};
@@ -216,11 +429,80 @@ namespace Graphics
                 barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_GENERIC_READ;
                 barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
 
-                d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+                GetCmdList(d3d)->ResourceBarrier(1, &barrier);
 
                 return true;
             }
 
+            /**
+             * Record the wavefront path tracing kernels, see PathTraceWavefrontCS.hlsl.
+             * Expects the root signature, root constants, and descriptor tables to be set.
+             */
+            void DispatchWavefront(Globals& d3d, Resources& resources)
+            {
+                ID3D12GraphicsCommandList4* cmdList = GetCmdList(d3d);
+
+                // The wavefront kernels communicate through the queues and counters, wait for each kernel to complete
+                D3D12_RESOURCE_BARRIER barrier = {};
+                barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+                barrier.UAV.pResource = nullptr;
+
+                const UINT bounceOffset = AppConsts::GetAlignedNum32BitValues() + 4;
+                const UINT firstPathOffset = AppConsts::GetAlignedNum32BitValues() + 5;
+                const UINT sampleOffset = AppConsts::GetAlignedNum32BitValues() + 6;
+
+                uint32_t numPixels = static_cast<uint32_t>(d3d.width * d3d.height);
+                for (uint32_t firstPath = 0; firstPath < numPixels; firstPath += PT_WAVEFRONT_MAX_PATHS)
+                {
+                    uint32_t numPaths = (std::min)(PT_WAVEFRONT_MAX_PATHS, numPixels - firstPath);
+                    cmdList->SetComputeRoot32BitConstant(0, firstPath, firstPathOffset);
+
+                    for (uint32_t sampleIndex = 0; sampleIndex < resources.samplesPerPixel; sampleIndex++)
+                    {
+                        // Queue the primary rays
+                        cmdList->SetComputeRoot32BitConstant(0, sampleIndex, sampleOffset);
+                        cmdList->SetComputeRoot32BitConstant(0, 0, bounceOffset);
+                        cmdList->SetPipelineState(resources.wavefrontGeneratePSO);
+                        cmdList->Dispatch(DivRoundUp(numPaths, 64), 1, 1);
+                        cmdList->ResourceBarrier(1, &barrier);
+
+                        for (uint32_t bounceIndex = 0; bounceIndex < resources.numBounces; bounceIndex++)
+                        {
+                            cmdList->SetComputeRoot32BitConstant(0, bounceIndex, bounceOffset);
+
+                            // Trace the queued rays
+                            cmdList->SetPipelineState(resources.wavefrontExtendPSO);
+                            cmdList->Dispatch(PT_WAVEFRONT_PERSISTENT_GROUPS, 1, 1);
+                            cmdList->ResourceBarrier(1, &barrier);
+
+                            // Sort the hits by material
+                            cmdList->SetPipelineState(resources.wavefrontSortPSO);
+                            cmdList->Dispatch(1, 1, 1);
+                            cmdList->ResourceBarrier(1, &barrier);
+
+                            cmdList->SetPipelineState(resources.wavefrontScatterPSO);
+                            cmdList->Dispatch(PT_WAVEFRONT_PERSISTENT_GROUPS, 1, 1);
+                            cmdList->ResourceBarrier(1, &barrier);
+
+                            // Shade the hits and queue the next bounce's rays
+                            cmdList->SetPipelineState(resources.wavefrontShadePSO);
+                            cmdList->Dispatch(PT_WAVEFRONT_PERSISTENT_GROUPS, 1, 1);
+                            cmdList->ResourceBarrier(1, &barrier);
+
+                            // Direct lighting
+                            cmdList->SetPipelineState(resources.wavefrontConnectPSO);
+                            cmdList->Dispatch(PT_WAVEFRONT_PERSISTENT_GROUPS, 1, 1);
+                            cmdList->ResourceBarrier(1, &barrier);
+                        }
+                    }
+
+                    // Accumulate and post process the chunk's pixels
+                    cmdList->SetPipelineState(resources.wavefrontResolvePSO);
+                    cmdList->Dispatch(DivRoundUp(numPaths, 64), 1, 1);
+                    cmdList->ResourceBarrier(1, &barrier);
+                }
+            }
+
             //----------------------------------------------------------------------------------------------------------
             // Public Functions
             //----------------------------------------------------------------------------------------------------------
@@ -231,12 +513,13 @@ namespace Graphics
             bool Initialize(Globals& d3d, GlobalResources& d3dResources, Resources& resources, Instrumentation::Performance& perf, std::ofstream& log)
             {
                 if (!CreateTextures(d3d, d3dResources, resources, log)) return false;
+                if (!CreateWavefrontBuffers(d3d, d3dResources, resources, log)) return false;
                 if (!LoadAndCompileShaders(d3d, resources, log)) return false;
                 if (!CreatePSOs(d3d, d3dResources, resources, log)) return false;
                 if (!CreateShaderTable(d3d, d3dResources, resources, log)) return false;
                 if (!UpdateShaderTable(d3d, d3dResources, resources, log)) return false;
 
-                perf.AddStat("Path Tracing", resources.cpuStat, resources.gpuStat);
+                if (resources.gpuStat == nullptr) perf.AddStat("Path Tracing", resources.cpuStat, resources.gpuStat);
 
                 return true;
             }
@@ -263,6 +546,9 @@ namespace Graphics
             {
                 SAFE_RELEASE(resources.PTOutput);
                 SAFE_RELEASE(resources.PTAccumulation);
+                SAFE_RELEASE(resources.PTVariance);
+                SAFE_RELEASE(resources.PTConvergence);
+                for (UINT frameIndex = 0; frameIndex < MAX_FRAMES_IN_FLIGHT; frameIndex++) SAFE_RELEASE(resources.PTConvergenceReadback[frameIndex]);
 
                 if (!CreateTextures(d3d, d3dResources, resources, log)) return false;
 
@@ -278,14 +564,55 @@ namespace Graphics
             {
                 CPU_TIMESTAMP_BEGIN(resources.cpuStat);
 
+                // Wavefront path tracing (the per bounce counters limit the number of bounces)
+                resources.wavefront = config.pathTrace.wavefront;
+                resources.numBounces = resources.wavefront ? (std::min)(config.pathTrace.numBounces, PT_WAVEFRONT_MAX_BOUNCES) : config.pathTrace.numBounces;
+                resources.samplesPerPixel = config.pathTrace.samplesPerPixel;
+
                 // Path Trace constants
                 d3dResources.constants.pt.rayNormalBias = config.pathTrace.rayNormalBias;
                 d3dResources.constants.pt.rayViewBias = config.pathTrace.rayViewBias;
-                d3dResources.constants.pt.numBounces = config.pathTrace.numBounces;
+                d3dResources.constants.pt.numBounces = resources.numBounces;
                 d3dResources.constants.pt.samplesPerPixel = config.pathTrace.samplesPerPixel;
                 d3dResources.constants.pt.SetAntialiasing(config.pathTrace.antialiasing);
                 d3dResources.constants.pt.SetProgressive(config.pathTrace.progressive);
-                d3dResources.constants.pt.SetShaderExecutionReordering(config.pathTrace.shaderExecutionReordering);
+                d3dResources.constants.pt.SetShaderExecutionReordering(config.pathTrace.shaderExecutionReordering && d3d.supportsShaderExecutionReordering);
+
+                // Convergence (requires progressive accumulation)
+                resources.convergence = (config.pathTrace.convergence && config.pathTrace.progressive);
+                if (resources.convergence)
+                {
+                    if (d3d.frameNumber <= 1)
+                    {
+                        // The accumulation restarts, discard the readbacks of the previous accumulation
+                        resources.converged = false;
+                        resources.numUnconvergedTiles = resources.numConvergenceTiles;
+                        for (UINT frameIndex = 0; frameIndex < MAX_FRAMES_IN_FLIGHT; frameIndex++) resources.convergenceReadbackFrame[frameIndex] = 0;
+                    }
+                    else if (resources.convergenceReadbackFrame[d3d.frameIndex] > 0)
+                    {
+                        // Read back the unconverged tile count (the frame that wrote it has completed on the GPU)
+                        UINT8* pData = nullptr;
+                        D3D12_RANGE readRange = { 0, sizeof(uint32_t) };
+                        if (SUCCEEDED(resources.PTConvergenceReadback[d3d.frameIndex]->Map(0, &readRange, reinterpret_cast<void**>(&pData))))
+                        {
+                            memcpy(&resources.numUnconvergedTiles, pData, sizeof(uint32_t));
+                            D3D12_RANGE writeRange = {};
+                            resources.PTConvergenceReadback[d3d.frameIndex]->Unmap(0, &writeRange);
+                            if (resources.numUnconvergedTiles == 0) resources.converged = true;
+                        }
+                    }
+
+                    uint32_t threshold = DirectX::PackedVector::XMConvertFloatToHalf(config.pathTrace.convergenceThreshold);
+                    d3dResources.constants.pt.convergence = threshold | PT_CONVERGENCE_FLAG_ENABLED;
+                    if (config.pathTrace.convergenceSteering) d3dResources.constants.pt.convergence |= PT_CONVERGENCE_FLAG_STEERING;
+                    if (resources.converged) d3dResources.constants.pt.convergence |= PT_CONVERGENCE_FLAG_STOPPED;
+                }
+                else
+                {
+                    resources.converged = false;
+                    d3dResources.constants.pt.convergence = PT_CONVERGENCE_FLAG_NONE;
+                }
 
                 // Post Process constants
                 d3dResources.constants.post.useFlags = POSTPROCESS_FLAG_USE_NONE;
@@ -307,7 +634,7 @@ namespace Graphics
             void Execute(Globals& d3d, GlobalResources& d3dResources, Resources& resources)
             {
             #ifdef GFX_PERF_MARKERS
-                PIXBeginEvent(d3d.cmdList[d3d.frameIndex], PIX_COLOR(GFX_PERF_MARKER_YELLOW), "Path Tracing");
+                PIXBeginEvent(GetCmdList(d3d), PIX_COLOR(GFX_PERF_MARKER_YELLOW), "Path Tracing");
             #endif
                 CPU_TIMESTAMP_BEGIN(resources.cpuStat);
 
@@ -320,58 +647,96 @@ namespace Graphics
                 barriers[0].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
 
                 // Wait for the transitions to complete
-                d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barriers[0]);
+                GetCmdList(d3d)->ResourceBarrier(1, &barriers[0]);
 
                 // Set the descriptor heaps
                 ID3D12DescriptorHeap* ppHeaps[] = { d3dResources.srvDescHeap, d3dResources.samplerDescHeap };
-                d3d.cmdList[d3d.frameIndex]->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+                GetCmdList(d3d)->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
 
                 // Set the root signature
-                d3d.cmdList[d3d.frameIndex]->SetComputeRootSignature(d3dResources.rootSignature);
+                GetCmdList(d3d)->SetComputeRootSignature(d3dResources.rootSignature);
 
                 // Update the root constants
                 UINT offset = 0;
                 GlobalConstants consts = d3dResources.constants;
-                d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(0, AppConsts::GetNum32BitValues(), consts.app.GetData(), offset);
+                GetCmdList(d3d)->SetComputeRoot32BitConstants(0, AppConsts::GetNum32BitValues(), consts.app.GetData(), offset);
                 offset += AppConsts::GetAlignedNum32BitValues();
-                d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(0, PathTraceConsts::GetNum32BitValues(), consts.pt.GetData(), offset);
+                GetCmdList(d3d)->SetComputeRoot32BitConstants(0, PathTraceConsts::GetNum32BitValues(), consts.pt.GetData(), offset);
                 offset += PathTraceConsts::GetAlignedNum32BitValues();
-                d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(0, LightingConsts::GetNum32BitValues(), consts.lights.GetData(), offset);
+                GetCmdList(d3d)->SetComputeRoot32BitConstants(0, LightingConsts::GetNum32BitValues(), consts.lights.GetData(), offset);
                 offset += LightingConsts::GetAlignedNum32BitValues();
                 offset += RTAOConsts::GetAlignedNum32BitValues();
                 offset += CompositeConsts::GetAlignedNum32BitValues();
-                d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(0, PostProcessConsts::GetNum32BitValues(), consts.post.GetData(), offset);
+                GetCmdList(d3d)->SetComputeRoot32BitConstants(0, PostProcessConsts::GetNum32BitValues(), consts.post.GetData(), offset);
 
                 // Set the root parameter descriptor tables
             #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
-                d3d.cmdList[d3d.frameIndex]->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
-                d3d.cmdList[d3d.frameIndex]->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
+                GetCmdList(d3d)->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
+                GetCmdList(d3d)->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
             #endif
 
-                // Dispatch rays
-                D3D12_DISPATCH_RAYS_DESC desc = {};
-                desc.RayGenerationShaderRecord.StartAddress = resources.shaderTableRGSStartAddress;
-                desc.RayGenerationShaderRecord.SizeInBytes = resources.shaderTableRecordSize;
-
-                desc.MissShaderTable.StartAddress = resources.shaderTableMissTableStartAddress;
-                desc.MissShaderTable.SizeInBytes = resources.shaderTableMissTableSize;
-                desc.MissShaderTable.StrideInBytes = resources.shaderTableRecordSize;
-
-                desc.HitGroupTable.StartAddress = resources.shaderTableHitGroupTableStartAddress;
-                desc.HitGroupTable.SizeInBytes = resources.shaderTableHitGroupTableSize;
-                desc.HitGroupTable.StrideInBytes = resources.shaderTableRecordSize;
-
-                desc.Width = d3d.width;
-                desc.Height = d3d.height;
-                desc.Depth = 1;
-
-                // Set the PSO
-                d3d.cmdList[d3d.frameIndex]->SetPipelineState1(resources.rtpso);
+                if (resources.wavefront)
+                {
+                    GPU_TIMESTAMP_BEGIN(resources.gpuStat->GetGPUQueryBeginIndex());
+                    DispatchWavefront(d3d, resources);
+                    GPU_TIMESTAMP_END(resources.gpuStat->GetGPUQueryEndIndex());
+                }
+                else
+                {
+                    // Dispatch rays
+                    D3D12_DISPATCH_RAYS_DESC desc = {};
+                    desc.RayGenerationShaderRecord.StartAddress = resources.shaderTableRGSStartAddress;
+                    desc.RayGenerationShaderRecord.SizeInBytes = resources.shaderTableRecordSize;
+
+                    desc.MissShaderTable.StartAddress = resources.shaderTableMissTableStartAddress;
+                    desc.MissShaderTable.SizeInBytes = resources.shaderTableMissTableSize;
+                    desc.MissShaderTable.StrideInBytes = resources.shaderTableRecordSize;
+
+                    desc.HitGroupTable.StartAddress = resources.shaderTableHitGroupTableStartAddress;
+                    desc.HitGroupTable.SizeInBytes = resources.shaderTableHitGroupTableSize;
+                    desc.HitGroupTable.StrideInBytes = resources.shaderTableRecordSize;
+
+                    desc.Width = d3d.width;
+                    desc.Height = d3d.height;
+                    desc.Depth = 1;
+
+                    // Set the PSO
+                    GetCmdList(d3d)->SetPipelineState1(resources.rtpso);
+
+                    // Dispatch rays
+                    GPU_TIMESTAMP_BEGIN(resources.gpuStat->GetGPUQueryBeginIndex());
+                    GetCmdList(d3d)->DispatchRays(&desc);
+                    GPU_TIMESTAMP_END(resources.gpuStat->GetGPUQueryEndIndex());
+                }
 
-                // Dispatch rays
-                GPU_TIMESTAMP_BEGIN(resources.gpuStat->GetGPUQueryBeginIndex());
-                d3d.cmdList[d3d.frameIndex]->DispatchRays(&desc);
-                GPU_TIMESTAMP_END(resources.gpuStat->GetGPUQueryEndIndex());
+                if (resources.convergence && !resources.converged)
+                {
+                    // Wait for the accumulation and variance to be written
+                    D3D12_RESOURCE_BARRIER uavBarrier = {};
+                    uavBarrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+                    uavBarrier.UAV.pResource = nullptr;
+                    GetCmdList(d3d)->ResourceBarrier(1, &uavBarrier);
+
+                    // Estimate the convergence of each tile
+                    GetCmdList(d3d)->SetPipelineState(resources.convergencePSO);
+                    GetCmdList(d3d)->Dispatch(DivRoundUp(d3d.width, PT_CONVERGENCE_TILE_SIZE), DivRoundUp(d3d.height, PT_CONVERGENCE_TILE_SIZE), 1);
+
+                    // Copy this frame's unconverged tile count to the frame's readback buffer
+                    D3D12_RESOURCE_BARRIER barrier = {};
+                    barrier.Transition.pResource = resources.PTConvergence;
+                    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
+                    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+                    GetCmdList(d3d)->ResourceBarrier(1, &barrier);
+
+                    UINT64 countOffset = (d3d.frameNumber & 1) * sizeof(uint32_t);
+                    GetCmdList(d3d)->CopyBufferRegion(resources.PTConvergenceReadback[d3d.frameIndex], 0, resources.PTConvergence, countOffset, sizeof(uint32_t));
+                    resources.convergenceReadbackFrame[d3d.frameIndex] = d3d.frameNumber;
+
+                    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE;
+                    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+                    GetCmdList(d3d)->ResourceBarrier(1, &barrier);
+                }
 
                 // Transition the output buffer to a copy source (from UAV)
                 barriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
@@ -384,21 +749,21 @@ namespace Graphics
                 barriers[1].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
 
                 // Wait for the transitions to complete
-                d3d.cmdList[d3d.frameIndex]->ResourceBarrier(2, barriers);
+                GetCmdList(d3d)->ResourceBarrier(2, barriers);
 
                 // Copy the output to the back buffer
-                d3d.cmdList[d3d.frameIndex]->CopyResource(d3d.backBuffer[d3d.frameIndex], resources.PTOutput);
+                GetCmdList(d3d)->CopyResource(d3d.backBuffer[d3d.frameIndex], resources.PTOutput);
 
                 // Transition back buffer to present (from a copy destination)
                 barriers[1].Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
                 barriers[1].Transition.StateAfter = D3D12_RESOURCE_STATE_PRESENT;
 
                 // Wait for the buffer transitions to complete
-                d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barriers[1]);
+                GetCmdList(d3d)->ResourceBarrier(1, &barriers[1]);
 
                 CPU_TIMESTAMP_ENDANDRESOLVE(resources.cpuStat);
             #ifdef GFX_PERF_MARKERS
-                PIXEndEvent(d3d.cmdList[d3d.frameIndex]);
+                PIXEndEvent(GetCmdList(d3d));
             #endif
             }
 
@@ -409,6 +774,9 @@ namespace Graphics
             {
                 SAFE_RELEASE(resources.PTOutput);
                 SAFE_RELEASE(resources.PTAccumulation);
+                SAFE_RELEASE(resources.PTVariance);
+                SAFE_RELEASE(resources.PTConvergence);
+                for (UINT frameIndex = 0; frameIndex < MAX_FRAMES_IN_FLIGHT; frameIndex++) SAFE_RELEASE(resources.PTConvergenceReadback[frameIndex]);
 
                 SAFE_RELEASE(resources.shaderTable);
                 SAFE_RELEASE(resources.shaderTableUpload);
@@ -417,6 +785,31 @@ namespace Graphics
                 SAFE_RELEASE(resources.rtpsoInfo);
                 SAFE_RELEASE(resources.rtpso);
 
+                SAFE_RELEASE(resources.PTWavefrontPaths);
+                SAFE_RELEASE(resources.PTWavefrontHits);
+                SAFE_RELEASE(resources.PTWavefrontSurfaces);
+                SAFE_RELEASE(resources.PTWavefrontQueues);
+                SAFE_RELEASE(resources.PTWavefrontCounters);
+
+                resources.wavefrontGenerateCS.Release();
+                resources.wavefrontExtendCS.Release();
+                resources.wavefrontSortCS.Release();
+                resources.wavefrontScatterCS.Release();
+                resources.wavefrontShadeCS.Release();
+                resources.wavefrontConnectCS.Release();
+                resources.wavefrontResolveCS.Release();
+
+                SAFE_RELEASE(resources.wavefrontGeneratePSO);
+                SAFE_RELEASE(resources.wavefrontExtendPSO);
+                SAFE_RELEASE(resources.wavefrontSortPSO);
+                SAFE_RELEASE(resources.wavefrontScatterPSO);
+                SAFE_RELEASE(resources.wavefrontShadePSO);
+                SAFE_RELEASE(resources.wavefrontConnectPSO);
+                SAFE_RELEASE(resources.wavefrontResolvePSO);
+
+                resources.convergenceCS.Release();
+                SAFE_RELEASE(resources.convergencePSO);
+
                 resources.shaderTableSize = 0;
                 resources.shaderTableRecordSize = 0;
                 resources.shaderTableMissTableSize = 0;
@@ -427,6 +820,18 @@ namespace Graphics
                 resources.shaderTableHitGroupTableStartAddress = 0;
             }
 
+            /**
+             * Compile the shaders into scratch resources and release them, filling the shader cache
+             * ahead of a deferred Initialize. Runs on a worker thread with exclusive use of the shader compiler.
+             */
+            bool Warmup(Globals& d3d, std::ofstream& log)
+            {
+                Resources scratch;
+                bool succeeded = LoadAndCompileShaders(d3d, scratch, log);
+                Cleanup(scratch);
+                return succeeded;
+            }
+
         } // namespace Graphics::D3D12::PathTracing
 
     } // namespace Graphics::D3D12
@@ -464,5 +869,10 @@ namespace Graphics
             Graphics::D3D12::PathTracing::Cleanup(resources);
         }
 
+        bool Warmup(Globals& d3d, std::ofstream& log)
+        {
+            return Graphics::D3D12::PathTracing::Warmup(d3d, log);
+        }
+
     } // namespace Graphics::PathTracing
 }
@@ -50,8 +50,8 @@ namespace Graphics
                     VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
                     { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
                 };
-                SetImageLayoutBarrier(vk.cmdBuffer[vk.frameIndex], resources.PTOutput, barrier);
-                SetImageLayoutBarrier(vk.cmdBuffer[vk.frameIndex], resources.PTAccumulation, barrier);
+                SetImageLayoutBarrier(GetCmdBuffer(vk), resources.PTOutput, barrier);
+                SetImageLayoutBarrier(GetCmdBuffer(vk), resources.PTAccumulation, barrier);
 
                 return true;
             }
@@ -149,13 +149,13 @@ namespace Graphics
                 CHECK(CreateShaderModule(vk.device, resources.csShader, &resources.csModule), "create path tracing CS shader module!\n", log);
 
                 // Create the ray tracing pipeline
-                CHECK(CreateRayTracingPipeline(vk.device, vkResources.pipelineLayout, resources.shaders, resources.modules, &resources.pipeline), "create path tracing pipeline!\n", log);
+                CHECK(CreateRayTracingPipeline(vk, vkResources.pipelineLayout, resources.shaders, resources.modules, &resources.pipeline), "create path tracing pipeline!\n", log);
             #ifdef GFX_NAME_OBJECTS
                 SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.pipeline), "PT RT Pipeline", VK_OBJECT_TYPE_PIPELINE);
             #endif
 
                 // Create the compute pipeline for inline ray tracing
-                CHECK(CreateComputePipeline(vk.device, vkResources.pipelineLayout, resources.csShader, resources.csModule, &resources.csPipeline), "create path tracing CS pipeline!\n", log);
+                CHECK(CreateComputePipeline(vk, vkResources.pipelineLayout, resources.csShader, resources.csModule, &resources.csPipeline), "create path tracing CS pipeline!\n", log);
             #ifdef GFX_NAME_OBJECTS
                 SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.csPipeline), "PT CS Pipeline", VK_OBJECT_TYPE_PIPELINE);
             #endif
@@ -256,7 +256,7 @@ namespace Graphics
                 // Schedule a copy of the shader table from the upload buffer to the device buffer
                 VkBufferCopy bufferCopy = {};
                 bufferCopy.size = resources.shaderTableSize;
-                vkCmdCopyBuffer(vk.cmdBuffer[vk.frameIndex], resources.shaderTableUpload, resources.shaderTable, 1, &bufferCopy);
+                vkCmdCopyBuffer(GetCmdBuffer(vk), resources.shaderTableUpload, resources.shaderTable, 1, &bufferCopy);
 
                 return true;
             }
@@ -427,7 +427,7 @@ namespace Graphics
                 if (!UpdateDescriptorSets(vk, vkResources, resources, log)) return false;
                 if (!UpdateShaderTable(vk, vkResources, resources, log)) return false;
 
-                perf.AddStat("Path Tracing", resources.cpuStat, resources.gpuStat);
+                if (resources.gpuStat == nullptr) perf.AddStat("Path Tracing", resources.cpuStat, resources.gpuStat);
 
                 return true;
             }
@@ -518,33 +518,33 @@ namespace Graphics
                 // Set the push constants
                 uint32_t offset = 0;
                 GlobalConstants consts = vkResources.constants;
-                vkCmdPushConstants(vk.cmdBuffer[vk.frameIndex], vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, AppConsts::GetSizeInBytes(), consts.app.GetData());
+                vkCmdPushConstants(GetCmdBuffer(vk), vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, AppConsts::GetSizeInBytes(), consts.app.GetData());
                 offset += AppConsts::GetAlignedSizeInBytes();
-                vkCmdPushConstants(vk.cmdBuffer[vk.frameIndex], vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, PathTraceConsts::GetSizeInBytes(), consts.pt.GetData());
+                vkCmdPushConstants(GetCmdBuffer(vk), vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, PathTraceConsts::GetSizeInBytes(), consts.pt.GetData());
                 offset += PathTraceConsts::GetAlignedSizeInBytes();
-                vkCmdPushConstants(vk.cmdBuffer[vk.frameIndex], vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, LightingConsts::GetSizeInBytes(), consts.lights.GetData());
+                vkCmdPushConstants(GetCmdBuffer(vk), vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, LightingConsts::GetSizeInBytes(), consts.lights.GetData());
                 offset += LightingConsts::GetAlignedSizeInBytes();
                 offset += RTAOConsts::GetAlignedSizeInBytes();
                 offset += CompositeConsts::GetAlignedSizeInBytes();
-                vkCmdPushConstants(vk.cmdBuffer[vk.frameIndex], vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, PostProcessConsts::GetSizeInBytes(), consts.post.GetData());
+                vkCmdPushConstants(GetCmdBuffer(vk), vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, PostProcessConsts::GetSizeInBytes(), consts.post.GetData());
 
                 GPU_TIMESTAMP_BEGIN(resources.gpuStat->GetGPUQueryBeginIndex());
 
                 if (resources.useInlineRayTracing)
                 {
                     // Use compute shader with inline ray tracing
-                    vkCmdBindPipeline(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_COMPUTE, resources.csPipeline);
-                    vkCmdBindDescriptorSets(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_COMPUTE, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
+                    vkCmdBindPipeline(GetCmdBuffer(vk), VK_PIPELINE_BIND_POINT_COMPUTE, resources.csPipeline);
+                    vkCmdBindDescriptorSets(GetCmdBuffer(vk), VK_PIPELINE_BIND_POINT_COMPUTE, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
 
                     uint32_t groupsX = DivRoundUp(vk.width, PATHTRACE_CS_BLOCK_SIZE);
                     uint32_t groupsY = DivRoundUp(vk.height, PATHTRACE_CS_BLOCK_SIZE);
-                    vkCmdDispatch(vk.cmdBuffer[vk.frameIndex], groupsX, groupsY, 1);
+                    vkCmdDispatch(GetCmdBuffer(vk), groupsX, groupsY, 1);
                 }
                 else
                 {
                     // Use traditional ray tracing pipeline
-                    vkCmdBindPipeline(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, resources.pipeline);
-                    vkCmdBindDescriptorSets(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
+                    vkCmdBindPipeline(GetCmdBuffer(vk), VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, resources.pipeline);
+                    vkCmdBindDescriptorSets(GetCmdBuffer(vk), VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
 
                     // Describe the shader table
                     VkStridedDeviceAddressRegionKHR raygenRegion = {};
@@ -565,7 +565,7 @@ namespace Graphics
                     VkStridedDeviceAddressRegionKHR callableRegion = {};
 
                     // Dispatch rays
-                    vkCmdTraceRaysKHR(vk.cmdBuffer[vk.frameIndex], &raygenRegion, &missRegion, &hitRegion, &callableRegion, vk.width, vk.height, 1);
+                    vkCmdTraceRaysKHR(GetCmdBuffer(vk), &raygenRegion, &missRegion, &hitRegion, &callableRegion, vk.width, vk.height, 1);
                 }
 
                 GPU_TIMESTAMP_END(resources.gpuStat->GetGPUQueryEndIndex());
@@ -579,7 +579,7 @@ namespace Graphics
                     VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
                     { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
                 };
-                SetImageLayoutBarrier(vk.cmdBuffer[vk.frameIndex], resources.PTOutput, barrier);
+                SetImageLayoutBarrier(GetCmdBuffer(vk), resources.PTOutput, barrier);
 
                 // Transition the back buffer layout to transfer destination
                 barrier =
@@ -590,14 +590,14 @@ namespace Graphics
                     VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
                     { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
                 };
-                SetImageLayoutBarrier(vk.cmdBuffer[vk.frameIndex], vk.swapChainImage[vk.frameIndex], barrier);
+                SetImageLayoutBarrier(GetCmdBuffer(vk), vk.swapChainImage[vk.imageIndex], barrier);
 
                 // Copy the output buffer to the back buffer
                 VkImageCopy copyRegion = {};
                 copyRegion.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
                 copyRegion.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
                 copyRegion.extent = { static_cast<uint32_t>(vk.width), static_cast<uint32_t>(vk.height), 1 };
-                vkCmdCopyImage(vk.cmdBuffer[vk.frameIndex], resources.PTOutput, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, vk.swapChainImage[vk.frameIndex], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
+                vkCmdCopyImage(GetCmdBuffer(vk), resources.PTOutput, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, vk.swapChainImage[vk.imageIndex], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
 
                 // Transition the back buffer layout to present
                 barrier =
@@ -608,7 +608,7 @@ namespace Graphics
                     VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
                     { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
                 };
-                SetImageLayoutBarrier(vk.cmdBuffer[vk.frameIndex], vk.swapChainImage[vk.frameIndex], barrier);
+                SetImageLayoutBarrier(GetCmdBuffer(vk), vk.swapChainImage[vk.imageIndex], barrier);
 
                 // Transition output buffer layout to general
                 barrier =
@@ -619,10 +619,10 @@ namespace Graphics
                     VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
                     { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
                 };
-                SetImageLayoutBarrier(vk.cmdBuffer[vk.frameIndex], resources.PTOutput, barrier);
+                SetImageLayoutBarrier(GetCmdBuffer(vk), resources.PTOutput, barrier);
 
             #ifdef GFX_PERF_MARKERS
-                vkCmdEndDebugUtilsLabelEXT(vk.cmdBuffer[vk.frameIndex]);
+                vkCmdEndDebugUtilsLabelEXT(GetCmdBuffer(vk));
             #endif
 
                 CPU_TIMESTAMP_ENDANDRESOLVE(resources.cpuStat);
@@ -663,6 +663,18 @@ namespace Graphics
                 resources.shaderTableHitGroupTableSize = 0;
             }
 
+            /**
+             * Compile the shaders into scratch resources and release them, filling the shader cache
+             * ahead of a deferred Initialize. Runs on a worker thread with exclusive use of the shader compiler.
+             */
+            bool Warmup(Globals& vk, std::ofstream& log)
+            {
+                Resources scratch;
+                bool succeeded = LoadAndCompileShaders(vk, scratch, log);
+                Cleanup(vk.device, scratch);
+                return succeeded;
+            }
+
         } // namespace Graphics::Vulkan::PathTracing
 
     } // namespace Graphics::Vulkan
@@ -700,5 +712,10 @@ namespace Graphics
             Graphics::Vulkan::PathTracing::Cleanup(vk.device, resources);
         }
 
+        bool Warmup(Globals& vk, std::ofstream& log)
+        {
+            return Graphics::Vulkan::PathTracing::Warmup(vk, log);
+        }
+
     } // namespace Graphics::PathTracing
 }
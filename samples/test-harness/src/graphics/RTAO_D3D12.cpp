@@ -40,8 +40,8 @@ namespace Graphics
                 handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_RTAO_OUTPUT * d3dResources.srvDescHeapEntrySize);
                 d3d.device->CreateUnorderedAccessView(resources.RTAOOutput, nullptr, &uavDesc, handle);
 
-                // Create the raw occlusion (R8_UNORM) texture resource
-                CHECK(CreateTexture(d3d, desc, &resources.RTAORaw), "create RTAO raw texture resource!\n", log);
+                // Create the raw occlusion (R8_UNORM) texture resource, only used during the RTAO pass (cleared when activated, see Execute())
+                CHECK(CreateTransientTexture(d3d, desc, ETransientPass::RTAO, ETransientPass::RTAO, &resources.RTAORaw), "create RTAO raw texture resource!\n", log);
             #ifdef GFX_NAME_OBJECTS
                 resources.RTAORaw->SetName(L"RTAO Raw");
             #endif
@@ -50,6 +50,25 @@ namespace Graphics
                 handle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_RTAO_RAW * d3dResources.srvDescHeapEntrySize);
                 d3d.device->CreateUnorderedAccessView(resources.RTAORaw, nullptr, &uavDesc, handle);
 
+                // Create the temporal history (R16G16B16A16_FLOAT) texture resources
+                desc.format = DXGI_FORMAT_R16G16B16A16_FLOAT;
+                uavDesc.Format = desc.format;
+                for (UINT historyIndex = 0; historyIndex < 2; historyIndex++)
+                {
+                    CHECK(CreateTexture(d3d, desc, &resources.RTAOHistory[historyIndex]), "create RTAO history texture resource!\n", log);
+                #ifdef GFX_NAME_OBJECTS
+                    std::wstring name = L"RTAO History " + std::to_wstring(historyIndex);
+                    resources.RTAOHistory[historyIndex]->SetName(name.c_str());
+                #endif
+
+                    // Add the history texture UAV to the descriptor heap
+                    handle.ptr = d3dResources.srvDescHeapStart.ptr + ((DescriptorHeapOffsets::UAV_RTAO_HISTORY + historyIndex) * d3dResources.srvDescHeapEntrySize);
+                    d3d.device->CreateUnorderedAccessView(resources.RTAOHistory[historyIndex], nullptr, &uavDesc, handle);
+                }
+
+                // The new textures have no history
+                resources.historyValid = false;
+
                 return true;
             }
 
@@ -57,7 +76,9 @@ namespace Graphics
             {
                 // Release existing shaders
                 resources.rtShaders.Release();
+                resources.traceCS.Release();
                 resources.filterCS.Release();
+                resources.temporalCS.Release();
 
                 std::wstring root = std::wstring(d3d.shaderCompiler.root.begin(), d3d.shaderCompiler.root.end());
 
@@ -66,6 +87,8 @@ namespace Graphics
                 resources.rtShaders.rgs.entryPoint = L"RayGen";
                 resources.rtShaders.rgs.exportName = L"RTAOTraceRGS";
                 Shaders::AddDefine(resources.rtShaders.rgs, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                Shaders::AddDefine(resources.rtShaders.rgs, L"GBUFFER_VISIBILITY", std::to_wstring(d3d.GBufferVisibility ? 1 : 0));
+                Shaders::AddDefine(resources.rtShaders.rgs, L"GBUFFER_TILES", std::to_wstring(d3d.GBufferTiles ? 1 : 0));
                 CHECK(Shaders::Compile(d3d.shaderCompiler, resources.rtShaders.rgs), "compile RTAO ray generation shader!\n", log);
 
                 // Load and compile the miss shader
@@ -98,6 +121,15 @@ namespace Graphics
                 // Set the payload size
                 resources.rtShaders.payloadSizeInBytes = sizeof(PackedPayload);
 
+                // Load and compile the inline ray tracing trace compute shader
+                resources.traceCS.filepath = root + L"shaders/RTAOTraceCS.hlsl";
+                resources.traceCS.entryPoint = L"CS";
+                resources.traceCS.targetProfile = L"cs_6_6";
+                Shaders::AddDefine(resources.traceCS, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                Shaders::AddDefine(resources.traceCS, L"GBUFFER_VISIBILITY", std::to_wstring(d3d.GBufferVisibility ? 1 : 0));
+                Shaders::AddDefine(resources.traceCS, L"GBUFFER_TILES", std::to_wstring(d3d.GBufferTiles ? 1 : 0));
+                CHECK(Shaders::Compile(d3d.shaderCompiler, resources.traceCS), "compile RTAO trace inline ray tracing compute shader!\n", log);
+
                 // Load and compile the filter compute shader
                 std::wstring blockSize = std::to_wstring(static_cast<int>(RTAO_FILTER_BLOCK_SIZE));
 
@@ -105,9 +137,19 @@ namespace Graphics
                 resources.filterCS.entryPoint = L"CS";
                 resources.filterCS.targetProfile = L"cs_6_6";
                 Shaders::AddDefine(resources.filterCS, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                Shaders::AddDefine(resources.filterCS, L"GBUFFER_VISIBILITY", std::to_wstring(d3d.GBufferVisibility ? 1 : 0));
                 Shaders::AddDefine(resources.filterCS, L"BLOCK_SIZE", blockSize);
                 CHECK(Shaders::Compile(d3d.shaderCompiler, resources.filterCS), "compile RTAO filter compute shader!\n", log);
 
+                // Load and compile the temporal accumulation compute shader
+                resources.temporalCS.filepath = root + L"shaders/RTAOTemporalCS.hlsl";
+                resources.temporalCS.entryPoint = L"CS";
+                resources.temporalCS.targetProfile = L"cs_6_6";
+                Shaders::AddDefine(resources.temporalCS, L"RTXGI_BINDLESS_TYPE", std::to_wstring(RTXGI_BINDLESS_TYPE));
+                Shaders::AddDefine(resources.temporalCS, L"GBUFFER_VISIBILITY", std::to_wstring(d3d.GBufferVisibility ? 1 : 0));
+                Shaders::AddDefine(resources.temporalCS, L"BLOCK_SIZE", blockSize);
+                CHECK(Shaders::Compile(d3d.shaderCompiler, resources.temporalCS), "compile RTAO temporal compute shader!\n", log);
+
                 return true;
             }
 
@@ -116,11 +158,13 @@ namespace Graphics
                 // Release existing PSOs
                 SAFE_RELEASE(resources.rtpso);
                 SAFE_RELEASE(resources.rtpsoInfo);
+                SAFE_RELEASE(resources.tracePSO);
                 SAFE_RELEASE(resources.filterPSO);
+                SAFE_RELEASE(resources.temporalPSO);
 
                 // Create the RTPSO
                 CHECK(CreateRayTracingPSO(
-                    d3d.device,
+                    d3d,
                     d3dResources.rootSignature,
                     resources.rtShaders,
                     &resources.rtpso,
@@ -131,9 +175,19 @@ namespace Graphics
                 resources.rtpso->SetName(L"RTAO RTPSO");
             #endif
 
-                // Create the compute PSO
+                // Create the compute PSOs
                 CHECK(CreateComputePSO(
-                    d3d.device,
+                    d3d,
+                    d3dResources.rootSignature,
+                    resources.traceCS,
+                    &resources.tracePSO),
+                    "create RTAO trace CS PSO!\n", log);
+            #ifdef GFX_NAME_OBJECTS
+                resources.tracePSO->SetName(L"RTAO Trace CS PSO");
+            #endif
+
+                CHECK(CreateComputePSO(
+                    d3d,
                     d3dResources.rootSignature,
                     resources.filterCS,
                     &resources.filterPSO),
@@ -141,6 +195,16 @@ namespace Graphics
             #ifdef GFX_NAME_OBJECTS
                 resources.filterPSO->SetName(L"RTAO Filter PSO");
             #endif
+
+                CHECK(CreateComputePSO(
+                    d3d,
+                    d3dResources.rootSignature,
+                    resources.temporalCS,
+                    &resources.temporalPSO),
+                    "create RTAO temporal PSO!\n", log);
+            #ifdef GFX_NAME_OBJECTS
+                resources.temporalPSO->SetName(L"RTAO Temporal PSO");
+            #endif
                 return true;
             }
 
@@ -187,6 +251,54 @@ namespace Graphics
                 resources.shaderTable->SetName(L"RTAO Shader Table");
             #endif
 
+                if (d3d.GBufferTiles)
+                {
+                    // Release the existing indirect dispatch resources
+                    SAFE_RELEASE(resources.traceArgs);
+                    SAFE_RELEASE(resources.traceArgsUpload);
+                    SAFE_RELEASE(resources.traceCommandSignature);
+                    SAFE_RELEASE(resources.traceCSCommandSignature);
+
+                    // Create the ray dispatch arguments upload buffer and device buffer (written in UpdateShaderTable)
+                    UINT64 argsSize = 2 * sizeof(D3D12_DISPATCH_RAYS_DESC);
+                    desc = { argsSize, 0, EHeapType::UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_FLAG_NONE };
+                    CHECK(CreateBuffer(d3d, desc, &resources.traceArgsUpload), "create RTAO trace arguments upload buffer!", log);
+                #ifdef GFX_NAME_OBJECTS
+                    resources.traceArgsUpload->SetName(L"RTAO Trace Args Upload");
+                #endif
+
+                    desc = { argsSize, 0, EHeapType::DEFAULT, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT, D3D12_RESOURCE_FLAG_NONE };
+                    CHECK(CreateBuffer(d3d, desc, &resources.traceArgs), "create RTAO trace arguments buffer!", log);
+                #ifdef GFX_NAME_OBJECTS
+                    resources.traceArgs->SetName(L"RTAO Trace Args");
+                #endif
+
+                    // Create the command signature for the indirect ray dispatch
+                    D3D12_INDIRECT_ARGUMENT_DESC argumentDesc = {};
+                    argumentDesc.Type = D3D12_INDIRECT_ARGUMENT_TYPE_DISPATCH_RAYS;
+
+                    D3D12_COMMAND_SIGNATURE_DESC signatureDesc = {};
+                    signatureDesc.ByteStride = sizeof(D3D12_DISPATCH_RAYS_DESC);
+                    signatureDesc.NumArgumentDescs = 1;
+                    signatureDesc.pArgumentDescs = &argumentDesc;
+
+                    HRESULT hr = d3d.device->CreateCommandSignature(&signatureDesc, nullptr, IID_PPV_ARGS(&resources.traceCommandSignature));
+                    CHECK(SUCCEEDED(hr), "create RTAO trace command signature!\n", log);
+                #ifdef GFX_NAME_OBJECTS
+                    resources.traceCommandSignature->SetName(L"RTAO Trace Command Signature");
+                #endif
+
+                    // Create the command signature for the indirect dispatch of the inline trace (reads the GBuffer tile arguments)
+                    argumentDesc.Type = D3D12_INDIRECT_ARGUMENT_TYPE_DISPATCH;
+                    signatureDesc.ByteStride = sizeof(D3D12_DISPATCH_ARGUMENTS);
+
+                    hr = d3d.device->CreateCommandSignature(&signatureDesc, nullptr, IID_PPV_ARGS(&resources.traceCSCommandSignature));
+                    CHECK(SUCCEEDED(hr), "create RTAO trace CS command signature!\n", log);
+                #ifdef GFX_NAME_OBJECTS
+                    resources.traceCSCommandSignature->SetName(L"RTAO Trace CS Command Signature");
+                #endif
+                }
+
                 return true;
             }
 
@@ -225,7 +337,7 @@ namespace Graphics
                 resources.shaderTableUpload->Unmap(0, nullptr);
 
                 // Schedule a copy of the upload buffer to the device buffer
-                d3d.cmdList[d3d.frameIndex]->CopyBufferRegion(resources.shaderTable, 0, resources.shaderTableUpload, 0, resources.shaderTableSize);
+                GetCmdList(d3d)->CopyBufferRegion(resources.shaderTable, 0, resources.shaderTableUpload, 0, resources.shaderTableSize);
 
                 // Transition the default heap resource to generic read after the copy is complete
                 D3D12_RESOURCE_BARRIER barrier = {};
@@ -235,7 +347,44 @@ namespace Graphics
                 barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_GENERIC_READ;
                 barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
 
-                d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+                GetCmdList(d3d)->ResourceBarrier(1, &barrier);
+
+                if (d3d.GBufferTiles)
+                {
+                    // Write the ray dispatch arguments over the GBuffer tiles, one row of rays per tile.
+                    // The row count (Height) is copied from the GBuffer tile count every frame, see Execute(...)
+                    D3D12_DISPATCH_RAYS_DESC args[2] = {};
+                    args[0].RayGenerationShaderRecord.StartAddress = resources.shaderTableRGSStartAddress;
+                    args[0].RayGenerationShaderRecord.SizeInBytes = resources.shaderTableRecordSize;
+                    args[0].MissShaderTable.StartAddress = resources.shaderTableMissTableStartAddress;
+                    args[0].MissShaderTable.SizeInBytes = resources.shaderTableMissTableSize;
+                    args[0].MissShaderTable.StrideInBytes = resources.shaderTableRecordSize;
+                    args[0].HitGroupTable.StartAddress = resources.shaderTableHitGroupTableStartAddress;
+                    args[0].HitGroupTable.SizeInBytes = resources.shaderTableHitGroupTableSize;
+                    args[0].HitGroupTable.StrideInBytes = resources.shaderTableRecordSize;
+                    args[0].Width = GBUFFER_TILE_SIZE * GBUFFER_TILE_SIZE;
+                    args[0].Height = 0;
+                    args[0].Depth = 1;
+
+                    // With temporal accumulation, trace the tile's checkerboard pixels
+                    args[1] = args[0];
+                    args[1].Width = (GBUFFER_TILE_SIZE * GBUFFER_TILE_SIZE) / 2;
+
+                    if (FAILED(resources.traceArgsUpload->Map(0, &readRange, reinterpret_cast<void**>(&pData)))) return false;
+                    memcpy(pData, args, sizeof(args));
+                    resources.traceArgsUpload->Unmap(0, nullptr);
+
+                    barrier.Transition.pResource = resources.traceArgs;
+                    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT;
+                    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
+                    GetCmdList(d3d)->ResourceBarrier(1, &barrier);
+
+                    GetCmdList(d3d)->CopyBufferRegion(resources.traceArgs, 0, resources.traceArgsUpload, 0, sizeof(args));
+
+                    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+                    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT;
+                    GetCmdList(d3d)->ResourceBarrier(1, &barrier);
+                }
 
                 return true;
             }
@@ -255,7 +404,7 @@ namespace Graphics
                 if (!CreateShaderTable(d3d, d3dResources, resources, log)) return false;
                 if (!UpdateShaderTable(d3d, d3dResources, resources, log)) return false;
 
-                perf.AddStat("RTAO", resources.cpuStat, resources.gpuStat);
+                if (resources.gpuStat == nullptr) perf.AddStat("RTAO", resources.cpuStat, resources.gpuStat);
 
                 return true;
             }
@@ -281,7 +430,9 @@ namespace Graphics
             bool Resize(Globals& d3d, GlobalResources& d3dResources, Resources& resources, std::ofstream& log)
             {
                 SAFE_RELEASE(resources.RTAOOutput);
-                SAFE_RELEASE(resources.RTAORaw);
+                ReleaseTransient(d3d, resources.RTAORaw);
+                SAFE_RELEASE(resources.RTAOHistory[0]);
+                SAFE_RELEASE(resources.RTAOHistory[1]);
 
                 if (!CreateTextures(d3d, d3dResources, resources, log)) return false;
 
@@ -299,6 +450,7 @@ namespace Graphics
 
                 // RTAO constants
                 resources.enabled = config.rtao.enabled;
+                resources.useInlineRayTracing = config.rtao.useInlineRayTracing;
                 if (resources.enabled)
                 {
                     d3dResources.constants.rtao.rayLength = config.rtao.rayLength;
@@ -307,8 +459,8 @@ namespace Graphics
                     d3dResources.constants.rtao.power = pow(2.f, config.rtao.powerLog);
                     d3dResources.constants.rtao.filterDistanceSigma = config.rtao.filterDistanceSigma;
                     d3dResources.constants.rtao.filterDepthSigma = config.rtao.filterDepthSigma;
-                    d3dResources.constants.rtao.filterBufferWidth = static_cast<uint32_t>(d3d.width);
-                    d3dResources.constants.rtao.filterBufferHeight = static_cast<uint32_t>(d3d.height);
+                    d3dResources.constants.rtao.filterBufferWidth = static_cast<uint32_t>(d3d.renderWidth);
+                    d3dResources.constants.rtao.filterBufferHeight = static_cast<uint32_t>(d3d.renderHeight);
 
                     float distanceKernel[6];
                     for (int i = 0; i < 6; ++i)
@@ -322,6 +474,25 @@ namespace Graphics
                     d3dResources.constants.rtao.filterDistKernel3 = distanceKernel[3];
                     d3dResources.constants.rtao.filterDistKernel4 = distanceKernel[4];
                     d3dResources.constants.rtao.filterDistKernel5 = distanceKernel[5];
+
+                    // Temporal accumulation, the traced checkerboard alternates every frame
+                    resources.temporal = config.rtao.temporal;
+                    if (!resources.temporal) resources.historyValid = false;
+
+                    uint32_t temporalFlags = 0;
+                    if (resources.temporal)
+                    {
+                        temporalFlags |= RTAO_TEMPORAL_FLAG_ENABLED;
+                        if (resources.historyValid) temporalFlags |= RTAO_TEMPORAL_FLAG_HISTORY_VALID;
+                        if (d3d.frameNumber & 1) temporalFlags |= RTAO_TEMPORAL_FLAG_CHECKERBOARD_ODD;
+                        if (resources.historyIndex) temporalFlags |= RTAO_TEMPORAL_FLAG_HISTORY_INDEX;
+                    }
+                    d3dResources.constants.rtao.temporalFlags = temporalFlags;
+                    d3dResources.constants.rtao.temporalMinBlend = 1.f / static_cast<float>((std::max)(config.rtao.temporalMaxHistory, 1u));
+                }
+                else
+                {
+                    resources.historyValid = false;
                 }
 
                 CPU_TIMESTAMP_END(resources.cpuStat);
@@ -333,7 +504,7 @@ namespace Graphics
             void Execute(Globals& d3d, GlobalResources& d3dResources, Resources& resources)
             {
             #ifdef GFX_PERF_MARKERS
-                PIXBeginEvent(d3d.cmdList[d3d.frameIndex], PIX_COLOR(GFX_PERF_MARKER_RED), "RTAO");
+                PIXBeginEvent(GetCmdList(d3d), PIX_COLOR(GFX_PERF_MARKER_RED), "RTAO");
             #endif
                 CPU_TIMESTAMP_BEGIN(resources.cpuStat);
                 GPU_TIMESTAMP_BEGIN(resources.gpuStat->GetGPUQueryBeginIndex());
@@ -342,10 +513,10 @@ namespace Graphics
                 {
                     // Set the descriptor heaps
                     ID3D12DescriptorHeap* ppHeaps[] = { d3dResources.srvDescHeap, d3dResources.samplerDescHeap };
-                    d3d.cmdList[d3d.frameIndex]->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+                    GetCmdList(d3d)->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
 
                     // Set the global root signature
-                    d3d.cmdList[d3d.frameIndex]->SetComputeRootSignature(d3dResources.rootSignature);
+                    GetCmdList(d3d)->SetComputeRootSignature(d3dResources.rootSignature);
 
                     // Update the root constants
                     UINT offset = 0;
@@ -353,14 +524,31 @@ namespace Graphics
                     offset += AppConsts::GetAlignedNum32BitValues();
                     offset += PathTraceConsts::GetAlignedNum32BitValues();
                     offset += LightingConsts::GetAlignedNum32BitValues();
-                    d3d.cmdList[d3d.frameIndex]->SetComputeRoot32BitConstants(0, RTAOConsts::GetNum32BitValues(), consts.rtao.GetData(), offset);
+                    GetCmdList(d3d)->SetComputeRoot32BitConstants(0, RTAOConsts::GetNum32BitValues(), consts.rtao.GetData(), offset);
 
                     // Set the root parameter descriptor tables
                 #if RTXGI_BINDLESS_TYPE == RTXGI_BINDLESS_TYPE_RESOURCE_ARRAYS
-                    d3d.cmdList[d3d.frameIndex]->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
-                    d3d.cmdList[d3d.frameIndex]->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
+                    GetCmdList(d3d)->SetComputeRootDescriptorTable(2, d3dResources.samplerDescHeap->GetGPUDescriptorHandleForHeapStart());
+                    GetCmdList(d3d)->SetComputeRootDescriptorTable(3, d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart());
                 #endif
 
+                    // The raw occlusion is transient: activate it and clear it to unoccluded, the trace skips pixels
+                    // (no primary ray intersection, or not on this frame's checkerboard) that the temporal pass and filter read
+                    AliasTransients(d3d, GetCmdList(d3d), ETransientPass::RTAO);
+
+                    D3D12_CPU_DESCRIPTOR_HANDLE rawCPUHandle;
+                    rawCPUHandle.ptr = d3dResources.srvDescHeapStart.ptr + (DescriptorHeapOffsets::UAV_RTAO_RAW * d3dResources.srvDescHeapEntrySize);
+                    D3D12_GPU_DESCRIPTOR_HANDLE rawGPUHandle = d3dResources.srvDescHeap->GetGPUDescriptorHandleForHeapStart();
+                    rawGPUHandle.ptr += (DescriptorHeapOffsets::UAV_RTAO_RAW * d3dResources.srvDescHeapEntrySize);
+
+                    float unoccluded[4] = { 1.f, 1.f, 1.f, 1.f };
+                    GetCmdList(d3d)->ClearUnorderedAccessViewFloat(rawGPUHandle, rawCPUHandle, resources.RTAORaw, unoccluded, 0, nullptr);
+
+                    D3D12_RESOURCE_BARRIER clearBarrier = {};
+                    clearBarrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+                    clearBarrier.UAV.pResource = resources.RTAORaw;
+                    GetCmdList(d3d)->ResourceBarrier(1, &clearBarrier);
+
                     // Dispatch rays
                     D3D12_DISPATCH_RAYS_DESC desc = {};
                     desc.RayGenerationShaderRecord.StartAddress = resources.shaderTableRGSStartAddress;
@@ -374,60 +562,141 @@ namespace Graphics
                     desc.HitGroupTable.SizeInBytes = resources.shaderTableHitGroupTableSize;
                     desc.HitGroupTable.StrideInBytes = resources.shaderTableRecordSize;
 
-                    desc.Width = d3d.width;
-                    desc.Height = d3d.height;
+                    // With temporal accumulation, trace half of the pixels (a checkerboard) each frame
+                    desc.Width = resources.temporal ? DivRoundUp(d3d.renderWidth, 2) : d3d.renderWidth;
+                    desc.Height = d3d.renderHeight;
                     desc.Depth = 1;
 
-                    // Set the PSO
-                    d3d.cmdList[d3d.frameIndex]->SetPipelineState1(resources.rtpso);
+                    if (resources.useInlineRayTracing)
+                    {
+                        GetCmdList(d3d)->SetPipelineState(resources.tracePSO);
+
+                        if (d3d.GBufferTiles)
+                        {
+                            // One thread group per GBuffer tile with geometry, see GBuffer::Execute(...)
+                            GetCmdList(d3d)->ExecuteIndirect(resources.traceCSCommandSignature, 1, d3dResources.rt.GBufferTileArgs, 0, nullptr, 0);
+                        }
+                        else
+                        {
+                            // Dispatch threads (a GBuffer tile per thread group)
+                            uint32_t traceGroupsX = DivRoundUp(static_cast<uint32_t>(desc.Width), GBUFFER_TILE_SIZE);
+                            uint32_t traceGroupsY = DivRoundUp(d3d.renderHeight, GBUFFER_TILE_SIZE);
+                            GetCmdList(d3d)->Dispatch(traceGroupsX, traceGroupsY, 1);
+                        }
+                    }
+                    else if (d3d.GBufferTiles)
+                    {
+                        // Set the PSO
+                        GetCmdList(d3d)->SetPipelineState1(resources.rtpso);
 
-                    // Dispatch rays
-                    d3d.cmdList[d3d.frameIndex]->DispatchRays(&desc);
+                        // Trace the GBuffer tiles with geometry only: copy the tile count to the row count (Height) of the ray dispatch
+                        UINT64 argsOffset = resources.temporal ? sizeof(D3D12_DISPATCH_RAYS_DESC) : 0;
+
+                        D3D12_RESOURCE_BARRIER argsBarriers[2] = {};
+                        argsBarriers[0].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+                        argsBarriers[0].Transition.pResource = d3dResources.rt.GBufferTileArgs;
+                        argsBarriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT;
+                        argsBarriers[0].Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
+                        argsBarriers[0].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+
+                        argsBarriers[1].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+                        argsBarriers[1].Transition.pResource = resources.traceArgs;
+                        argsBarriers[1].Transition.StateBefore = D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT;
+                        argsBarriers[1].Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
+                        argsBarriers[1].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+
+                        GetCmdList(d3d)->ResourceBarrier(2, argsBarriers);
+                        GetCmdList(d3d)->CopyBufferRegion(resources.traceArgs, argsOffset + offsetof(D3D12_DISPATCH_RAYS_DESC, Height), d3dResources.rt.GBufferTileArgs, 0, sizeof(UINT));
+
+                        argsBarriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE;
+                        argsBarriers[0].Transition.StateAfter = D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT;
+                        argsBarriers[1].Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+                        argsBarriers[1].Transition.StateAfter = D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT;
+
+                        GetCmdList(d3d)->ResourceBarrier(2, argsBarriers);
+
+                        // Dispatch rays
+                        GetCmdList(d3d)->ExecuteIndirect(resources.traceCommandSignature, 1, resources.traceArgs, argsOffset, nullptr, 0);
+                    }
+                    else
+                    {
+                        // Set the PSO
+                        GetCmdList(d3d)->SetPipelineState1(resources.rtpso);
+
+                        // Dispatch rays
+                        GetCmdList(d3d)->DispatchRays(&desc);
+                    }
 
                     D3D12_RESOURCE_BARRIER barrier = {};
                     barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
                     barrier.UAV.pResource = resources.RTAORaw;
 
                     // Wait for the ray trace to complete
-                    d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+                    GetCmdList(d3d)->ResourceBarrier(1, &barrier);
+
+                    uint32_t groupsX = DivRoundUp(d3d.renderWidth, RTAO_FILTER_BLOCK_SIZE);
+                    uint32_t groupsY = DivRoundUp(d3d.renderHeight, RTAO_FILTER_BLOCK_SIZE);
+
+                    // --- Run the temporal accumulation compute shader ------------------
+
+                    if (resources.temporal)
+                    {
+                        GetCmdList(d3d)->SetPipelineState(resources.temporalPSO);
+                        GetCmdList(d3d)->Dispatch(groupsX, groupsY, 1);
+
+                        // Wait for the history to be written
+                        barrier.UAV.pResource = resources.RTAOHistory[resources.historyIndex];
+                        GetCmdList(d3d)->ResourceBarrier(1, &barrier);
+
+                        // Next frame reads this frame's history
+                        resources.historyIndex = 1 - resources.historyIndex;
+                        resources.historyValid = true;
+                    }
 
                     // --- Run the filter compute shader ---------------------------------
 
                     // Set the PSO and dispatch threads
-                    d3d.cmdList[d3d.frameIndex]->SetPipelineState(resources.filterPSO);
-
-                    uint32_t groupsX = DivRoundUp(d3d.width, RTAO_FILTER_BLOCK_SIZE);
-                    uint32_t groupsY = DivRoundUp(d3d.height, RTAO_FILTER_BLOCK_SIZE);
-                    d3d.cmdList[d3d.frameIndex]->Dispatch(groupsX, groupsY, 1);
+                    GetCmdList(d3d)->SetPipelineState(resources.filterPSO);
+                    GetCmdList(d3d)->Dispatch(groupsX, groupsY, 1);
 
                     // Wait for the compute pass to finish
                     barrier.UAV.pResource = resources.RTAOOutput;
-                    d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+                    GetCmdList(d3d)->ResourceBarrier(1, &barrier);
                 }
 
                 GPU_TIMESTAMP_END(resources.gpuStat->GetGPUQueryEndIndex());
                 CPU_TIMESTAMP_ENDANDRESOLVE(resources.cpuStat);
             #ifdef GFX_PERF_MARKERS
-                PIXEndEvent(d3d.cmdList[d3d.frameIndex]);
+                PIXEndEvent(GetCmdList(d3d));
             #endif
             }
 
             /**
              * Release resources.
              */
-            void Cleanup(Resources& resources)
+            void Cleanup(Globals& d3d, Resources& resources)
             {
                 SAFE_RELEASE(resources.RTAOOutput);
-                SAFE_RELEASE(resources.RTAORaw);
+                ReleaseTransient(d3d, resources.RTAORaw);
+                SAFE_RELEASE(resources.RTAOHistory[0]);
+                SAFE_RELEASE(resources.RTAOHistory[1]);
 
                 SAFE_RELEASE(resources.shaderTable);
                 SAFE_RELEASE(resources.shaderTableUpload);
+                SAFE_RELEASE(resources.traceArgs);
+                SAFE_RELEASE(resources.traceArgsUpload);
+                SAFE_RELEASE(resources.traceCommandSignature);
+                SAFE_RELEASE(resources.traceCSCommandSignature);
+                resources.traceCS.Release();
                 resources.filterCS.Release();
+                resources.temporalCS.Release();
                 resources.rtShaders.Release();
 
                 SAFE_RELEASE(resources.rtpso);
                 SAFE_RELEASE(resources.rtpsoInfo);
+                SAFE_RELEASE(resources.tracePSO);
                 SAFE_RELEASE(resources.filterPSO);
+                SAFE_RELEASE(resources.temporalPSO);
 
                 resources.shaderTableSize = 0;
                 resources.shaderTableRecordSize = 0;
@@ -439,6 +708,18 @@ namespace Graphics
                 resources.shaderTableHitGroupTableStartAddress = 0;
             }
 
+            /**
+             * Compile the shaders into scratch resources and release them, filling the shader cache
+             * ahead of a deferred Initialize. Runs on a worker thread with exclusive use of the shader compiler.
+             */
+            bool Warmup(Globals& d3d, std::ofstream& log)
+            {
+                Resources scratch;
+                bool succeeded = LoadAndCompileShaders(d3d, scratch, log);
+                Cleanup(d3d, scratch);
+                return succeeded;
+            }
+
             /**
              * Write the RTAO texture resources to disk.
              */
@@ -484,7 +765,12 @@ namespace Graphics
 
         void Cleanup(Globals& d3d, Resources& resources)
         {
-            Graphics::D3D12::RTAO::Cleanup(resources);
+            Graphics::D3D12::RTAO::Cleanup(d3d, resources);
+        }
+
+        bool Warmup(Globals& d3d, std::ofstream& log)
+        {
+            return Graphics::D3D12::RTAO::Warmup(d3d, log);
         }
 
         bool WriteRTAOBuffersToDisk(Globals& d3d, GlobalResources& d3dResources, Resources& resources, std::string directory)
@@ -54,8 +54,8 @@ namespace Graphics
                     VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
                     { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
                 };
-                SetImageLayoutBarrier(vk.cmdBuffer[vk.frameIndex], resources.RTAOOutput, barrier);
-                SetImageLayoutBarrier(vk.cmdBuffer[vk.frameIndex], resources.RTAORaw, barrier);
+                SetImageLayoutBarrier(GetCmdBuffer(vk), resources.RTAOOutput, barrier);
+                SetImageLayoutBarrier(GetCmdBuffer(vk), resources.RTAORaw, barrier);
 
                 return true;
             }
@@ -167,19 +167,19 @@ namespace Graphics
                 CHECK(CreateShaderModule(vk.device, resources.traceCS, &resources.traceCSModule), "create RTAO Trace CS shader module!\n", log);
 
                 // Create the ray tracing pipeline
-                CHECK(CreateRayTracingPipeline(vk.device, vkResources.pipelineLayout, resources.rtShaders, resources.rtShaderModules, &resources.rtPipeline), "create RTAO RT pipeline!\n", log);
+                CHECK(CreateRayTracingPipeline(vk, vkResources.pipelineLayout, resources.rtShaders, resources.rtShaderModules, &resources.rtPipeline), "create RTAO RT pipeline!\n", log);
             #ifdef GFX_NAME_OBJECTS
                 SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.rtPipeline), "RTAO RT Pipeline", VK_OBJECT_TYPE_PIPELINE);
             #endif
 
                 // Create the filter compute pipeline
-                CHECK(CreateComputePipeline(vk.device, vkResources.pipelineLayout, resources.filterCS, resources.filterCSModule, &resources.filterPipeline), "create RTAO Filter pipeline!\n", log);
+                CHECK(CreateComputePipeline(vk, vkResources.pipelineLayout, resources.filterCS, resources.filterCSModule, &resources.filterPipeline), "create RTAO Filter pipeline!\n", log);
             #ifdef GFX_NAME_OBJECTS
                 SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.filterPipeline), "RTAO Filter Pipeline", VK_OBJECT_TYPE_PIPELINE);
             #endif
 
                 // Create the trace compute pipeline for inline ray tracing
-                CHECK(CreateComputePipeline(vk.device, vkResources.pipelineLayout, resources.traceCS, resources.traceCSModule, &resources.tracePipeline), "create RTAO Trace CS pipeline!\n", log);
+                CHECK(CreateComputePipeline(vk, vkResources.pipelineLayout, resources.traceCS, resources.traceCSModule, &resources.tracePipeline), "create RTAO Trace CS pipeline!\n", log);
             #ifdef GFX_NAME_OBJECTS
                 SetObjectName(vk.device, reinterpret_cast<uint64_t>(resources.tracePipeline), "RTAO Trace CS Pipeline", VK_OBJECT_TYPE_PIPELINE);
             #endif
@@ -281,7 +281,7 @@ namespace Graphics
                 // Schedule a copy of the shader table from the upload buffer to the device buffer
                 VkBufferCopy bufferCopy = {};
                 bufferCopy.size = resources.shaderTableSize;
-                vkCmdCopyBuffer(vk.cmdBuffer[vk.frameIndex], resources.shaderTableUpload, resources.shaderTable, 1, &bufferCopy);
+                vkCmdCopyBuffer(GetCmdBuffer(vk), resources.shaderTableUpload, resources.shaderTable, 1, &bufferCopy);
 
                 return true;
             }
@@ -432,7 +432,7 @@ namespace Graphics
                 if (!UpdateDescriptorSets(vk, vkResources, resources, log)) return false;
                 if (!UpdateShaderTable(vk, vkResources, resources, log)) return false;
 
-                perf.AddStat("RTAO", resources.cpuStat, resources.gpuStat);
+                if (resources.gpuStat == nullptr) perf.AddStat("RTAO", resources.cpuStat, resources.gpuStat);
 
                 return true;
             }
@@ -493,8 +493,8 @@ namespace Graphics
                     vkResources.constants.rtao.power = pow(2.f, config.rtao.powerLog);
                     vkResources.constants.rtao.filterDistanceSigma = config.rtao.filterDistanceSigma;
                     vkResources.constants.rtao.filterDepthSigma = config.rtao.filterDepthSigma;
-                    vkResources.constants.rtao.filterBufferWidth = static_cast<uint32_t>(vk.width);
-                    vkResources.constants.rtao.filterBufferHeight = static_cast<uint32_t>(vk.height);
+                    vkResources.constants.rtao.filterBufferWidth = static_cast<uint32_t>(vk.renderWidth);
+                    vkResources.constants.rtao.filterBufferHeight = static_cast<uint32_t>(vk.renderHeight);
 
                     float distanceKernel[6];
                     for (int i = 0; i < 6; ++i)
@@ -530,25 +530,25 @@ namespace Graphics
                     offset += AppConsts::GetAlignedSizeInBytes();
                     offset += PathTraceConsts::GetAlignedSizeInBytes();
                     offset += LightingConsts::GetAlignedSizeInBytes();
-                    vkCmdPushConstants(vk.cmdBuffer[vk.frameIndex], vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, consts.rtao.GetSizeInBytes(), consts.rtao.GetData());
+                    vkCmdPushConstants(GetCmdBuffer(vk), vkResources.pipelineLayout, VK_SHADER_STAGE_ALL, offset, consts.rtao.GetSizeInBytes(), consts.rtao.GetData());
 
                     GPU_TIMESTAMP_BEGIN(resources.gpuStat->GetGPUQueryBeginIndex());
 
                     if (resources.useInlineRayTracing)
                     {
                         // Use compute shader with inline ray tracing for trace pass
-                        vkCmdBindPipeline(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_COMPUTE, resources.tracePipeline);
-                        vkCmdBindDescriptorSets(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_COMPUTE, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
+                        vkCmdBindPipeline(GetCmdBuffer(vk), VK_PIPELINE_BIND_POINT_COMPUTE, resources.tracePipeline);
+                        vkCmdBindDescriptorSets(GetCmdBuffer(vk), VK_PIPELINE_BIND_POINT_COMPUTE, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
 
-                        uint32_t traceGroupsX = DivRoundUp(vk.width, RTAO_TRACE_BLOCK_SIZE);
-                        uint32_t traceGroupsY = DivRoundUp(vk.height, RTAO_TRACE_BLOCK_SIZE);
-                        vkCmdDispatch(vk.cmdBuffer[vk.frameIndex], traceGroupsX, traceGroupsY, 1);
+                        uint32_t traceGroupsX = DivRoundUp(vk.renderWidth, RTAO_TRACE_BLOCK_SIZE);
+                        uint32_t traceGroupsY = DivRoundUp(vk.renderHeight, RTAO_TRACE_BLOCK_SIZE);
+                        vkCmdDispatch(GetCmdBuffer(vk), traceGroupsX, traceGroupsY, 1);
                     }
                     else
                     {
                         // Use traditional ray tracing pipeline
-                        vkCmdBindPipeline(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, resources.rtPipeline);
-                        vkCmdBindDescriptorSets(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
+                        vkCmdBindPipeline(GetCmdBuffer(vk), VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, resources.rtPipeline);
+                        vkCmdBindDescriptorSets(GetCmdBuffer(vk), VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
 
                         // Describe the shader table
                         VkStridedDeviceAddressRegionKHR raygenRegion = {};
@@ -569,7 +569,7 @@ namespace Graphics
                         VkStridedDeviceAddressRegionKHR callableRegion = {};
 
                         // Dispatch rays
-                        vkCmdTraceRaysKHR(vk.cmdBuffer[vk.frameIndex], &raygenRegion, &missRegion, &hitRegion, &callableRegion, vk.width, vk.height, 1);
+                        vkCmdTraceRaysKHR(GetCmdBuffer(vk), &raygenRegion, &missRegion, &hitRegion, &callableRegion, vk.renderWidth, vk.renderHeight, 1);
                     }
 
                     GPU_TIMESTAMP_END(resources.gpuStat->GetGPUQueryEndIndex());
@@ -577,25 +577,25 @@ namespace Graphics
                     // Wait for the trace pass to finish
                     VkImageSubresourceRange range = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
                     ImageBarrierDesc barrier = { VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 } };
-                    SetImageMemoryBarrier(vk.cmdBuffer[vk.frameIndex], resources.RTAORaw, barrier);
+                    SetImageMemoryBarrier(GetCmdBuffer(vk), resources.RTAORaw, barrier);
 
                     // --- Run the filter compute shader ---------------------------------
 
                     // Bind the compute pipeline and dispatch threads
-                    vkCmdBindPipeline(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_COMPUTE, resources.filterPipeline);
+                    vkCmdBindPipeline(GetCmdBuffer(vk), VK_PIPELINE_BIND_POINT_COMPUTE, resources.filterPipeline);
 
                     // Bind the descriptor set
-                    vkCmdBindDescriptorSets(vk.cmdBuffer[vk.frameIndex], VK_PIPELINE_BIND_POINT_COMPUTE, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
+                    vkCmdBindDescriptorSets(GetCmdBuffer(vk), VK_PIPELINE_BIND_POINT_COMPUTE, vkResources.pipelineLayout, 0, 1, &resources.descriptorSet, 0, nullptr);
 
-                    uint32_t groupsX = DivRoundUp(vk.width, RTAO_FILTER_BLOCK_SIZE);
-                    uint32_t groupsY = DivRoundUp(vk.height, RTAO_FILTER_BLOCK_SIZE);
-                    vkCmdDispatch(vk.cmdBuffer[vk.frameIndex], groupsX, groupsY, 1);
+                    uint32_t groupsX = DivRoundUp(vk.renderWidth, RTAO_FILTER_BLOCK_SIZE);
+                    uint32_t groupsY = DivRoundUp(vk.renderHeight, RTAO_FILTER_BLOCK_SIZE);
+                    vkCmdDispatch(GetCmdBuffer(vk), groupsX, groupsY, 1);
 
                     // Wait for the compute pass to finish
-                    SetImageMemoryBarrier(vk.cmdBuffer[vk.frameIndex], resources.RTAOOutput, barrier);
+                    SetImageMemoryBarrier(GetCmdBuffer(vk), resources.RTAOOutput, barrier);
 
                 #ifdef GFX_PERF_MARKERS
-                    vkCmdEndDebugUtilsLabelEXT(vk.cmdBuffer[vk.frameIndex]);
+                    vkCmdEndDebugUtilsLabelEXT(GetCmdBuffer(vk));
                 #endif
                 }
                 CPU_TIMESTAMP_ENDANDRESOLVE(resources.cpuStat);
@@ -644,6 +644,18 @@ namespace Graphics
                 resources.shaderTableHitGroupTableStartAddress = 0;
             }
 
+            /**
+             * Compile the shaders into scratch resources and release them, filling the shader cache
+             * ahead of a deferred Initialize. Runs on a worker thread with exclusive use of the shader compiler.
+             */
+            bool Warmup(Globals& vk, std::ofstream& log)
+            {
+                Resources scratch;
+                bool succeeded = LoadAndCompileShaders(vk, scratch, log);
+                Cleanup(vk.device, scratch);
+                return succeeded;
+            }
+
             /**
              * Write the RTAO texture resources to disk.
              */
@@ -695,6 +707,11 @@ namespace Graphics
             Graphics::Vulkan::RTAO::Cleanup(vk.device, resources);
         }
 
+        bool Warmup(Globals& vk, std::ofstream& log)
+        {
+            return Graphics::Vulkan::RTAO::Warmup(vk, log);
+        }
+
         bool WriteRTAOBuffersToDisk(Globals& vk, GlobalResources& vkResources, Resources& resources, std::string directory)
         {
             return Graphics::Vulkan::RTAO::WriteRTAOBuffersToDisk(vk, vkResources, resources, directory);
@@ -24,7 +24,6 @@ namespace Graphics
             bool Initialize(Graphics::Globals& d3d, Graphics::GlobalResources& d3dResources, Resources& resources, Instrumentation::Performance& perf, std::ofstream& log)
             {
                 // Setup Dear ImGui context
-                const unsigned int NUM_FRAMES_IN_FLIGHT = 2;
                 IMGUI_CHECKVERSION();
                 ImGui::CreateContext();
                 ImGui::StyleColorsDark();
@@ -39,7 +38,7 @@ namespace Graphics
                 CHECK(ImGui_ImplGlfw_InitForOther(d3d.window, true), "initialize ImGui for GLFW", log);
                 CHECK(ImGui_ImplDX12_Init(
                     d3d.device,
-                    NUM_FRAMES_IN_FLIGHT,
+                    MAX_FRAMES_IN_FLIGHT,
                     DXGI_FORMAT_R8G8B8A8_UNORM,
                     d3dResources.srvDescHeap,
                     CPUHandle,
@@ -61,18 +60,19 @@ namespace Graphics
                 Inputs::Input& input,
                 Scenes::Scene& scene,
                 std::vector<DDGIVolumeBase*>& volumes,
+                const Graphics::DDGI::CostController& costController,
                 const Instrumentation::Performance& perf)
             {
                 CPU_TIMESTAMP_BEGIN(resources.cpuStat);
 
-                if (config.app.showUI)
+                if (Graphics::UI::BeginFrame(d3d, config, perf))
                 {
                     // Start the ImGui frame
                     ImGui_ImplDX12_NewFrame();
                     ImGui_ImplGlfw_NewFrame();
                     ImGui::NewFrame();
 
-                    Graphics::UI::CreateDebugWindow(d3d, config, input, scene, volumes);
+                    Graphics::UI::CreateDebugWindow(d3d, config, input, scene, volumes, costController, perf);
                     Graphics::UI::CreatePerfWindow(d3d, config, perf);
                 }
 
@@ -86,7 +86,7 @@ namespace Graphics
                 if (config.app.showUI)
                 {
                 #ifdef GFX_PERF_MARKERS
-                    PIXBeginEvent(d3d.cmdList[d3d.frameIndex], PIX_COLOR(GFX_PERF_MARKER_GREY), "ImGui");
+                    PIXBeginEvent(GetCmdList(d3d), PIX_COLOR(GFX_PERF_MARKER_GREY), "ImGui");
                 #endif
                     // Transition the back buffer to a render target
                     D3D12_RESOURCE_BARRIER barrier = {};
@@ -96,21 +96,21 @@ namespace Graphics
                     barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
 
                     // Wait for the transition to complete
-                    d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+                    GetCmdList(d3d)->ResourceBarrier(1, &barrier);
 
                     // Set the render target
                     D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle;
                     rtvHandle.ptr = d3dResources.rtvDescHeapStart.ptr + (d3d.frameIndex * d3dResources.rtvDescHeapEntrySize);
-                    d3d.cmdList[d3d.frameIndex]->OMSetRenderTargets(1, &rtvHandle, false, nullptr);
+                    GetCmdList(d3d)->OMSetRenderTargets(1, &rtvHandle, false, nullptr);
 
                     // Set the resources descriptor heap
                     ID3D12DescriptorHeap* ppHeaps[] = { d3dResources.srvDescHeap };
-                    d3d.cmdList[d3d.frameIndex]->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+                    GetCmdList(d3d)->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
 
                     // Render
                     GPU_TIMESTAMP_BEGIN(resources.gpuStat->GetGPUQueryBeginIndex());
-                    ImGui::Render();
-                    ImGui_ImplDX12_RenderDrawData(ImGui::GetDrawData(), d3d.cmdList[d3d.frameIndex]);
+                    if (!Graphics::UI::s_reuseDrawData) ImGui::Render();
+                    ImGui_ImplDX12_RenderDrawData(ImGui::GetDrawData(), GetCmdList(d3d));
                     GPU_TIMESTAMP_END(resources.gpuStat->GetGPUQueryEndIndex());
 
                     // Transition the back buffer back to present
@@ -118,10 +118,10 @@ namespace Graphics
                     barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PRESENT;
 
                     // Wait for the transition to complete
-                    d3d.cmdList[d3d.frameIndex]->ResourceBarrier(1, &barrier);
+                    GetCmdList(d3d)->ResourceBarrier(1, &barrier);
 
                 #ifdef GFX_PERF_MARKERS
-                    PIXEndEvent(d3d.cmdList[d3d.frameIndex]);
+                    PIXEndEvent(GetCmdList(d3d));
                 #endif
                 }
 
@@ -149,9 +149,9 @@ namespace Graphics
             return Graphics::D3D12::UI::Initialize(d3d, d3dResources, resources, perf, log);
         }
 
-        void Update(Globals& d3d, Resources& resources, Configs::Config& config, Inputs::Input& input, Scenes::Scene& scene, std::vector<DDGIVolumeBase*>& volumes, const Instrumentation::Performance& perf)
+        void Update(Globals& d3d, Resources& resources, Configs::Config& config, Inputs::Input& input, Scenes::Scene& scene, std::vector<DDGIVolumeBase*>& volumes, const Graphics::DDGI::CostController& costController, const Instrumentation::Performance& perf)
         {
-            return Graphics::D3D12::UI::Update(d3d, resources, config, input, scene, volumes, perf);
+            return Graphics::D3D12::UI::Update(d3d, resources, config, input, scene, volumes, costController, perf);
         }
 
         void Execute(Globals& d3d, GlobalResources& d3dResources, Resources& resources, const Configs::Config& config)
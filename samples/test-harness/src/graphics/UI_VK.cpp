@@ -28,7 +28,6 @@ namespace Graphics
             bool Initialize(Graphics::Globals& vk, Graphics::GlobalResources& vkResources, Resources& resources, Instrumentation::Performance& perf, std::ofstream& log)
             {
                 // Setup the ImGui context
-                const unsigned int NUM_FRAMES_IN_FLIGHT = 2;
                 IMGUI_CHECKVERSION();
                 ImGui::CreateContext();
                 ImGui::StyleColorsDark();
@@ -45,15 +44,15 @@ namespace Graphics
                 initInfo.Queue = vk.queue;
                 initInfo.PipelineCache = VK_NULL_HANDLE;
                 initInfo.DescriptorPool = vkResources.descriptorPool;
-                initInfo.ImageCount = NUM_FRAMES_IN_FLIGHT;
-                initInfo.MinImageCount = NUM_FRAMES_IN_FLIGHT;
+                initInfo.ImageCount = MAX_FRAMES_IN_FLIGHT;
+                initInfo.MinImageCount = MAX_FRAMES_IN_FLIGHT;
                 initInfo.MSAASamples = VK_SAMPLE_COUNT_1_BIT;
 
                 // Initialize ImGui Vulkan
                 CHECK(ImGui_ImplVulkan_Init(&initInfo, vk.renderPass),"initialize ImGui Vulkan!\n", log);
 
                 // Setup the fonts texture
-                ImGui_ImplVulkan_CreateFontsTexture(vk.cmdBuffer[vk.frameIndex]);
+                ImGui_ImplVulkan_CreateFontsTexture(GetCmdBuffer(vk));
 
                 VKCHECK(vkEndCommandBuffer(vk.cmdBuffer[vk.frameIndex]));
 
@@ -85,18 +84,19 @@ namespace Graphics
                 Inputs::Input& input,
                 Scenes::Scene& scene,
                 std::vector<DDGIVolumeBase*>& volumes,
+                const Graphics::DDGI::CostController& costController,
                 const Instrumentation::Performance& perf)
             {
                 CPU_TIMESTAMP_BEGIN(resources.cpuStat);
 
-                if (config.app.showUI)
+                if (Graphics::UI::BeginFrame(vk, config, perf))
                 {
                     // Start the ImGui frame
                     ImGui_ImplVulkan_NewFrame();
                     ImGui_ImplGlfw_NewFrame();
                     ImGui::NewFrame();
 
-                    Graphics::UI::CreateDebugWindow(vk, config, input, scene, volumes);
+                    Graphics::UI::CreateDebugWindow(vk, config, input, scene, volumes, costController, perf);
                     Graphics::UI::CreatePerfWindow(vk, config, perf);
                 }
 
@@ -119,7 +119,7 @@ namespace Graphics
                     // Describe the render pass
                     VkRenderPassBeginInfo renderPassBeginInfo = {};
                     renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-                    renderPassBeginInfo.framebuffer = vk.frameBuffer[vk.frameIndex];
+                    renderPassBeginInfo.framebuffer = vk.frameBuffer[vk.imageIndex];
                     renderPassBeginInfo.renderArea.extent.width = vk.width;
                     renderPassBeginInfo.renderArea.extent.height = vk.height;
                     renderPassBeginInfo.renderPass = vk.renderPass;
@@ -128,18 +128,18 @@ namespace Graphics
 
                     // Start the render pass
                     GPU_TIMESTAMP_BEGIN(resources.gpuStat->GetGPUQueryBeginIndex());
-                    vkCmdBeginRenderPass(vk.cmdBuffer[vk.frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+                    vkCmdBeginRenderPass(GetCmdBuffer(vk), &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
-                    ImGui::Render();
-                    ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), vk.cmdBuffer[vk.frameIndex]);
+                    if (!Graphics::UI::s_reuseDrawData) ImGui::Render();
+                    ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), GetCmdBuffer(vk));
 
                     // End the render pass
-                    vkCmdEndRenderPass(vk.cmdBuffer[vk.frameIndex]);
+                    vkCmdEndRenderPass(GetCmdBuffer(vk));
                     GPU_TIMESTAMP_END(resources.gpuStat->GetGPUQueryEndIndex());
                 }
 
             #ifdef GFX_PERF_MARKERS
-                vkCmdEndDebugUtilsLabelEXT(vk.cmdBuffer[vk.frameIndex]);
+                vkCmdEndDebugUtilsLabelEXT(GetCmdBuffer(vk));
             #endif
 
                 CPU_TIMESTAMP_ENDANDRESOLVE(resources.cpuStat);
@@ -166,9 +166,9 @@ namespace Graphics
             return Graphics::Vulkan::UI::Initialize(vk, vkResources, resources, perf, log);
         }
 
-        void Update(Globals& vk, Resources& resources, Configs::Config& config, Inputs::Input& input, Scenes::Scene& scene, std::vector<DDGIVolumeBase*>& volumes, const Instrumentation::Performance& perf)
+        void Update(Globals& vk, Resources& resources, Configs::Config& config, Inputs::Input& input, Scenes::Scene& scene, std::vector<DDGIVolumeBase*>& volumes, const Graphics::DDGI::CostController& costController, const Instrumentation::Performance& perf)
         {
-            return Graphics::Vulkan::UI::Update(vk, resources, config, input, scene, volumes, perf);
+            return Graphics::Vulkan::UI::Update(vk, resources, config, input, scene, volumes, costController, perf);
         }
 
         void Execute(Globals& vk, GlobalResources& vkResources, Resources& resources, const Configs::Config& config)
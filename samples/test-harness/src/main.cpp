@@ -9,6 +9,7 @@
 */
 
 #include "Common.h"
+#include "Caches.h"
 #include "Configs.h"
 #include "Scenes.h"
 #include "Inputs.h"
@@ -18,6 +19,11 @@
 #include "Window.h"
 #include "Benchmark.h"
 #include "AppLogger.h"
+#include "ImageCapture.h"
+#include "RenderGraph.h"
+#include "Replay.h"
+#include "DynamicResolution.h"
+#include "ShaderWatch.h"
 
 #include "graphics/PathTracing.h"
 #include "graphics/GBuffer.h"
@@ -26,7 +32,9 @@
 #include "graphics/RTAO.h"
 #include "graphics/Composite.h"
 
+#include <atomic>
 #include <filesystem>
+#include <thread>
 
 #if _WIN32
 extern "C" { __declspec(dllexport) extern const UINT D3D12SDKVersion = 606; }
@@ -38,7 +46,7 @@ void StoreImages(
     Configs::Config& config,
     Graphics::Globals& gfx,
     Graphics::GlobalResources& gfxResources,
-    Graphics::RTAO::Resources& rtao,
+    Graphics::RTAO::Resources* rtao,
     Graphics::DDGI::Resources& ddgi)
 {
     if(config.app.benchmarkRunning) return; // Not allowed while benchmark is running
@@ -53,7 +61,7 @@ void StoreImages(
     else if (event == Inputs::EInputEvent::SAVE_IMAGES)
     {
         Graphics::GBuffer::WriteGBufferToDisk(gfx, gfxResources, config.scene.screenshotPath);
-        Graphics::RTAO::WriteRTAOBuffersToDisk(gfx, gfxResources, rtao, config.scene.screenshotPath);
+        if (rtao) Graphics::RTAO::WriteRTAOBuffersToDisk(gfx, gfxResources, *rtao, config.scene.screenshotPath);
         Graphics::DDGI::WriteVolumesToDisk(gfx, gfxResources, ddgi, config.scene.screenshotPath);
         event = Inputs::EInputEvent::NONE;
     }
@@ -95,8 +103,8 @@ bool DebugCapture(
     switch (g_debugCaptureState)
     {
         case EDebugCaptureState::WAITING:
-            // Wait for the specified number of frames before capturing
-            if (gfx.frameNumber >= config.app.debugCaptureFrameDelay)
+            // Wait for the specified number of frames (or the path tracer to converge) before capturing
+            if (gfx.frameNumber >= config.app.debugCaptureFrameDelay || (config.pathTrace.enabled && config.pathTrace.converged))
             {
                 g_debugCaptureState = EDebugCaptureState::CAPTURE_NORMAL;
             }
@@ -202,8 +210,9 @@ bool DebugCapture(
 
 /**
  * Run the Test Harness.
+ * The headless benchmark (--benchmark) runs once per config file, runIndex selects the config and numRuns returns their count.
  */
-int Run(const std::vector<std::string>& arguments)
+int Run(const std::vector<std::string>& arguments, uint32_t runIndex, uint32_t& numRuns)
 {
     // Initialize the agent-friendly logger
     if (!AppLog::Logger::Instance().Initialize("app_log.txt"))
@@ -213,7 +222,7 @@ int Run(const std::vector<std::string>& arguments)
     LOG_INFO("App", "Application starting...");
 
     std::ofstream log;
-    log.open("log.txt", std::ios::out);
+    log.open("log.txt", (runIndex == 0) ? std::ios::out : (std::ios::out | std::ios::app));
     if (!log.is_open())
     {
         LOG_ERROR("App", "Failed to open log.txt");
@@ -249,6 +258,8 @@ int Run(const std::vector<std::string>& arguments)
     perf.AddGPUStat("Frame");
 
     Benchmark::BenchmarkRun benchmarkRun;
+    Benchmark::BackendSelection backendSelection;
+    Replay::Session replay;
 
     CPU_TIMESTAMP_BEGIN(&startupShutdown);
 
@@ -265,6 +276,15 @@ int Run(const std::vector<std::string>& arguments)
     log << "done.\n";
     LOG_INFO("Init", "Command line parsed successfully");
 
+    // Select the config file of this headless benchmark run
+    numRuns = 1;
+    if (config.benchmark.headless)
+    {
+        numRuns = static_cast<uint32_t>(config.benchmark.configs.size());
+        config.app.filepath = config.benchmark.configs[runIndex];
+        log << "Benchmark run " << (runIndex + 1) << " of " << numRuns << ": " << config.app.filepath << "\n";
+    }
+
     // Load and parse the config file
     log << "Loading config file...";
     LOG_INFO("Init", "Loading config file: " + config.app.filepath);
@@ -277,6 +297,17 @@ int Run(const std::vector<std::string>& arguments)
     log << "done.\n";
     LOG_INFO("Init", "Config loaded successfully");
 
+    // The headless benchmark writes each config's results to its own folder, and doesn't wait for vertical sync
+    if (config.benchmark.headless)
+    {
+        config.scene.screenshotPath += "/" + std::filesystem::path(config.app.filepath).stem().string();
+        config.app.vsync = false;
+        config.app.showUI = false;
+    }
+
+    // File format of the screenshots and intermediate images
+    ImageCapture::SetFormat(static_cast<ImageCapture::EFormat>(config.app.captureFormat), config.app.captureHdr);
+
     // Create a window
     log << "Creating a window...";
     LOG_INFO("Init", "Creating window (" + std::to_string(config.app.width) + "x" + std::to_string(config.app.height) + ")");
@@ -355,15 +386,40 @@ int Run(const std::vector<std::string>& arguments)
     }
     LOG_INFO("Graphics", "Graphics resources initialized");
 
-    // Initialize the graphics workloads
-    LOG_INFO("Graphics", "Initializing PathTracing workload...");
-    CHECK(Graphics::PathTracing::Initialize(gfx, gfxResources, pt, perf, log), "initialize path tracing workload!\n", log);
-    LOG_INFO("Graphics", "PathTracing initialized");
+    // Initialize the graphics workloads. The path tracer and RTAO are initialized on first use in the main loop
+    // instead, their stats are added now to keep the usual order of the stats.
+    bool ptInitialized = false;
+    bool rtaoInitialized = false;
+    if (config.app.renderMode == ERenderMode::PATH_TRACE)
+    {
+        LOG_INFO("Graphics", "Initializing PathTracing workload...");
+        CHECK(Graphics::PathTracing::Initialize(gfx, gfxResources, pt, perf, log), "initialize path tracing workload!\n", log);
+        LOG_INFO("Graphics", "PathTracing initialized");
+        ptInitialized = true;
+    }
+    else
+    {
+        perf.AddStat("Path Tracing", pt.cpuStat, pt.gpuStat);
+    }
 
     LOG_INFO("Graphics", "Initializing GBuffer workload...");
     CHECK(Graphics::GBuffer::Initialize(gfx, gfxResources, gbuffer, perf, log), "initialize gbuffer workload!\n", log);
     LOG_INFO("Graphics", "GBuffer initialized");
 
+    // Replace the DDGIVolumes with volumes fit to the scene geometry (config ddgi.probePlacement)
+    if (config.ddgi.probePlacement) Graphics::DDGI::PlaceProbes(config, scene, log);
+
+    // Record or replay the run (--record, --replay), seeding the DDGIVolumes' random rotations before they are created
+    CHECK(Replay::Start(replay, config, log), "start the replay!\n", log);
+
+    // Fit the DDGIVolumes to the GPU memory budget (config ddgi.memoryBudget) before they are created
+    Graphics::DDGI::MemoryBudget memoryBudget;
+    memoryBudget.requested = config.ddgi.volumes;
+    {
+        std::vector<Configs::EDDGIVolumeChange> changes;
+        Graphics::DDGI::PlanMemoryBudget(gfx, memoryBudget, config, changes, true, log);
+    }
+
     LOG_INFO("Graphics", "Initializing DDGI workload...");
     CHECK(Graphics::DDGI::Initialize(gfx, gfxResources, ddgi, config, perf, log), "initialize dynamic diffuse global illumination workload!\n", log);
     LOG_INFO("Graphics", "DDGI initialized with " + std::to_string(ddgi.volumes.size()) + " volumes");
@@ -372,9 +428,17 @@ int Run(const std::vector<std::string>& arguments)
     CHECK(Graphics::DDGI::Visualizations::Initialize(gfx, gfxResources, ddgi, ddgiVis, perf, config, log), "initialize dynamic diffuse global illumination visualization workload!\n", log);
     LOG_INFO("Graphics", "DDGI Visualizations initialized");
 
-    LOG_INFO("Graphics", "Initializing RTAO workload...");
-    CHECK(Graphics::RTAO::Initialize(gfx, gfxResources, rtao, perf, log), "initialize ray traced ambient occlusion workload!\n", log);
-    LOG_INFO("Graphics", "RTAO initialized");
+    if (config.app.renderMode == ERenderMode::DDGI && config.rtao.enabled)
+    {
+        LOG_INFO("Graphics", "Initializing RTAO workload...");
+        CHECK(Graphics::RTAO::Initialize(gfx, gfxResources, rtao, perf, log), "initialize ray traced ambient occlusion workload!\n", log);
+        LOG_INFO("Graphics", "RTAO initialized");
+        rtaoInitialized = true;
+    }
+    else
+    {
+        perf.AddStat("RTAO", rtao.cpuStat, rtao.gpuStat);
+    }
 
     LOG_INFO("Graphics", "Initializing Composite workload...");
     CHECK(Graphics::Composite::Initialize(gfx, gfxResources, composite, perf, log), "initialize composition workload!\n", log);
@@ -405,11 +469,72 @@ int Run(const std::vector<std::string>& arguments)
     log << "done\n";
     LOG_INFO("Graphics", "Post initialization complete");
 
+    // Load the converged probes of the volumes with a probe cache
+    CHECK(Graphics::DDGI::LoadVolumeCaches(gfx, gfxResources, ddgi, config, scene, log), "load DDGIVolume caches!\n", log);
+
+    // Load the radiance cache cells of the previous run
+    CHECK(Graphics::DDGI::LoadRadianceCache(gfx, gfxResources, ddgi, config, scene, log), "load the radiance cache file!\n", log);
+
     // Add a few more CPU stats
+    Instrumentation::Stat* recordStat = perf.AddCPUStat("Record");
     Instrumentation::Stat* timestampEndStat = perf.AddCPUStat("TimestampEnd");
     Instrumentation::Stat* submitStat = perf.AddCPUStat("Submit");
     Instrumentation::Stat* presentStat = perf.AddCPUStat("Present");
 
+    // Set while DDGI shaders compile in the background (see Graphics::DDGI::ReloadAsync)
+    bool ddgiReloadPending = false;
+
+    // Steers the DDGI GPU time toward config ddgi.costBudget
+    Graphics::DDGI::CostController costController;
+
+    // Modification stamp of the config file, polled when hot reloading its DDGIVolumes
+    uint64_t configStamp = Caches::GetFileStamp(config.app.filepath);
+
+    // Listen for the shaders rebuilt by the shader compiler's watch mode (config shaders.watchPort)
+    ShaderWatch::Listener shaderWatch;
+    bool gbufferReload = false;
+    if (config.shaders.watchPort > 0)
+    {
+        if (ShaderWatch::Open(shaderWatch, config.shaders.watchPort, log)) LOG_INFO("Shaders", "Listening for shader changes on port " + std::to_string(config.shaders.watchPort));
+        else LOG_ERROR("Shaders", "Failed to listen for shader changes on port " + std::to_string(config.shaders.watchPort));
+    }
+
+    // Apply DDGIVolume config changes to the running volumes, and reload the visualizations that reference resized probe textures
+    auto applyVolumeChanges = [&](const std::vector<Configs::EDDGIVolumeChange>& changes) -> bool
+    {
+        if (!Graphics::DDGI::ApplyVolumeChanges(gfx, gfxResources, ddgi, config, changes, log))
+        {
+            LOG_ERROR("Config", "Failed to apply the DDGIVolume changes");
+            return false;
+        }
+
+        Configs::EDDGIVolumeChange maxChange = Configs::EDDGIVolumeChange::NONE;
+        for (Configs::EDDGIVolumeChange change : changes) maxChange = (std::max)(maxChange, change);
+        if (maxChange >= Configs::EDDGIVolumeChange::TEXTURES && !Graphics::DDGI::Visualizations::Reload(gfx, gfxResources, ddgi, ddgiVis, config, log))
+        {
+            LOG_ERROR("Shaders", "Failed to reload DDGI Visualization shaders");
+            return false;
+        }
+        return true;
+    };
+
+    // Compile the shaders of the deferred workloads in the background, their initialization then loads them from the
+    // shader cache. Reloads and deferred initialization wait for it, the worker thread has exclusive use of the shader compiler.
+    std::thread warmup;
+    std::atomic<bool> warmupDone{ false };
+    std::ofstream warmupLog;
+    if (config.shaders.cache && (!ptInitialized || !rtaoInitialized))
+    {
+        warmupLog.open("log-warmup.txt", std::ios::out);
+        warmup = std::thread([&gfx, &warmupLog, &warmupDone, warmPT = !ptInitialized, warmRTAO = !rtaoInitialized]()
+        {
+            if (warmPT && !Graphics::PathTracing::Warmup(gfx, warmupLog)) warmupLog << "Failed to warm up the path tracing shaders\n";
+            if (warmRTAO && !Graphics::RTAO::Warmup(gfx, warmupLog)) warmupLog << "Failed to warm up the RTAO shaders\n";
+            warmupLog << std::flush;
+            warmupDone = true;
+        });
+    }
+
     CPU_TIMESTAMP_END(&startupShutdown);
     log << "Startup complete in " << startupShutdown.elapsed << " milliseconds\n";
 
@@ -417,12 +542,44 @@ int Run(const std::vector<std::string>& arguments)
     std::flush(log);
     LOG_INFO("App", "Entering main loop");
 
+#ifdef GFX_PERF_INSTRUMENTATION
+    // The headless benchmark starts right away, the warm up frames are part of the run
+    if (config.benchmark.headless) Benchmark::StartBenchmark(benchmarkRun, perf, config, gfx);
+
+    // Select the GBuffer and RTAO ray tracing backends (config app.rayTracingBackend), measured over the first frames when not cached
+    Benchmark::StartBackendSelection(backendSelection, config, log);
+#endif
+
+    // The render passes, recorded by Graphics::RecordPasses(). The functions are built once and the frame's list
+    // references them, so selecting the passes of a frame doesn't allocate.
+    const std::function<void()> ptPass = [&]() { Graphics::PathTracing::Execute(gfx, gfxResources, pt); };
+    const std::function<void()> gbufferPass = [&]() { Graphics::GBuffer::Execute(gfx, gfxResources, gbuffer); };
+    const std::function<void()> ddgiPass = [&]() { Graphics::DDGI::Execute(gfx, gfxResources, ddgi); };
+    const std::function<void()> ddgiVisPass = [&]() { Graphics::DDGI::Visualizations::Execute(gfx, gfxResources, ddgiVis); };
+    const std::function<void()> rtaoPass = [&]() { Graphics::RTAO::Execute(gfx, gfxResources, rtao); };
+    const std::function<void()> compositePass = [&]() { Graphics::Composite::Execute(gfx, gfxResources, composite); };
+    const std::function<void()> uiPass = [&]() { Graphics::UI::Execute(gfx, gfxResources, ui, config); };
+    std::vector<std::function<void()>> passes;
+    passes.reserve(MAX_PASS_CMD_LISTS);
+
+    // Render resolution scale of the DDGI passes, adjusted to the GPU frame time (config app.dynamicResolution)
+    DynamicResolution::Controller resolutionController;
+
+    // The frame's render graph: culls the passes nothing reads and records the barriers between the passes
+    RenderGraph::Graph graph;
+    graph.SetBarrierFunction([&](const RenderGraph::Pass& pass)
+    {
+        if (pass.waitForAsync) Graphics::WaitForAsyncCompute(gfx);
+        if (pass.barriers) Graphics::GlobalBarrier(gfx);
+    });
+
     // Main loop
     while(!glfwWindowShouldClose(gfx.window))
     {
         CPU_TIMESTAMP_BEGIN(frameStat);
+        uint64_t frameAllocationStart = Memory::GetAllocationCount();
 
-        // Wait for the previous frame's GPU work to complete
+        // Wait for the GPU to release the next frame's resources (used MAX_FRAMES_IN_FLIGHT frames ago)
         CPU_TIMESTAMP_BEGIN(waitStat);
         if (!Graphics::WaitForPrevGPUFrame(gfx))
         {
@@ -453,12 +610,83 @@ int Run(const std::vector<std::string>& arguments)
     #ifdef GFX_PERF_INSTRUMENTATION
         if (!Graphics::UpdateTimestamps(gfx, gfxResources, perf)) break;
         Graphics::BeginFrame(gfx, gfxResources, perf);
+
+        // Write the trace once the GPU timestamps of its last frame are recorded
+        if (perf.trace.NextFrame())
+        {
+            std::string file = config.scene.screenshotPath + "/trace.json";
+            std::filesystem::create_directories(config.scene.screenshotPath.c_str());
+            if (perf.trace.Write(file)) LOG_INFO("Perf", "Wrote trace capture to " + file);
+            else LOG_ERROR("Perf", "Failed to write trace capture to " + file);
+            perf.trace.events.clear();
+        }
     #endif
         CPU_TIMESTAMP_ENDANDRESOLVE(timestampBeginStat);
 
-        // Reload shaders, recreate PSOs, and update shader tables
+        // Join the shader warm-up thread once it finishes
+        if (warmup.joinable() && warmupDone)
         {
-            if (config.pathTrace.reload)
+            warmup.join();
+            warmupLog.close();
+        }
+
+        // Reload shaders, recreate PSOs, and update shader tables (after the shader warm-up)
+        if (!warmup.joinable())
+        {
+            // Reload the workloads using the shaders rebuilt by the shader compiler's watch mode
+            std::vector<std::string> rebuiltShaders;
+            if (ShaderWatch::Poll(shaderWatch, rebuiltShaders))
+            {
+                for (const std::string& path : rebuiltShaders)
+                {
+                    std::string file = std::filesystem::path(path).filename().string();
+                    LOG_INFO("Shaders", "Shader rebuilt: " + path);
+
+                    if (file.rfind("PathTrace", 0) == 0) config.pathTrace.reload = true;
+                    else if (file.rfind("RTAO", 0) == 0) config.rtao.reload = true;
+                    else if (file.rfind("Composite", 0) == 0) config.postProcess.reload = true;
+                    else if (file.rfind("GBuffer", 0) == 0) gbufferReload = true;
+                    else if (file == "CHS.hlsl" || file == "AHS.hlsl" || file == "Miss.hlsl")
+                    {
+                        // The hit and miss shaders are shared by the ray tracing workloads
+                        config.pathTrace.reload = config.rtao.reload = config.ddgi.reload = gbufferReload = true;
+                    }
+                    else config.ddgi.reload = true;
+                }
+            }
+
+            // Workloads not initialized yet compile the current shaders when they are
+            if (!ptInitialized) config.pathTrace.reload = false;
+            if (!rtaoInitialized) config.rtao.reload = false;
+
+            // Swap in the DDGI shaders and PSOs once the background compile finishes.
+            // Other reloads wait for it, the worker thread has exclusive use of the shader compiler meanwhile.
+            if (ddgiReloadPending)
+            {
+                Graphics::DDGI::EReloadStatus status = Graphics::DDGI::FinishReload(gfx, gfxResources, ddgi, config, log);
+                if (status == Graphics::DDGI::EReloadStatus::SUCCEEDED)
+                {
+                    if (!Graphics::DDGI::Visualizations::Reload(gfx, gfxResources, ddgi, ddgiVis, config, log))
+                    {
+                        LOG_ERROR("Shaders", "Failed to reload DDGI Visualization shaders");
+                        break;
+                    }
+                    ddgiReloadPending = false;
+                    LOG_INFO("Shaders", "DDGI shaders reloaded successfully");
+                }
+                else if (status == Graphics::DDGI::EReloadStatus::FAILED)
+                {
+                    ddgiReloadPending = false;
+                    LOG_ERROR("Shaders", "Failed to reload DDGI shaders, the previous shaders are still in use");
+                }
+                else if (status == Graphics::DDGI::EReloadStatus::SWAP_FAILED)
+                {
+                    LOG_ERROR("Shaders", "Failed to recreate the DDGI volumes with the reloaded shaders");
+                    break;
+                }
+            }
+
+            if (config.pathTrace.reload && !ddgiReloadPending)
             {
                 LOG_INFO("Shaders", "Reloading PathTracing shaders...");
                 if (!Graphics::PathTracing::Reload(gfx, gfxResources, pt, log))
@@ -470,8 +698,22 @@ int Run(const std::vector<std::string>& arguments)
                 LOG_INFO("Shaders", "PathTracing shaders reloaded successfully");
             }
 
-            if (config.ddgi.reload)
+            if (config.ddgi.reload && !ddgiReloadPending && !config.app.benchmarkRunning)
             {
+                LOG_INFO("Shaders", "Reloading DDGI shaders in the background...");
+                if (!Graphics::DDGI::ReloadAsync(gfx, gfxResources, ddgi, config, log))
+                {
+                    LOG_ERROR("Shaders", "Failed to start the DDGI shader reload");
+                    break;
+                }
+
+                // Clear the request now, changes made while the reload is pending request another one
+                config.ddgi.reload = false;
+                ddgiReloadPending = true;
+            }
+            else if (config.ddgi.reload && !ddgiReloadPending)
+            {
+                // Benchmarks reload synchronously, the run starts from the reloaded state
                 LOG_INFO("Shaders", "Reloading DDGI shaders...");
                 if (!Graphics::DDGI::Reload(gfx, gfxResources, ddgi, config, log))
                 {
@@ -487,7 +729,19 @@ int Run(const std::vector<std::string>& arguments)
                 LOG_INFO("Shaders", "DDGI shaders reloaded successfully");
             }
 
-            if (config.rtao.reload)
+            if (gbufferReload && !ddgiReloadPending)
+            {
+                LOG_INFO("Shaders", "Reloading GBuffer shaders...");
+                if (!Graphics::GBuffer::Reload(gfx, gfxResources, gbuffer, log))
+                {
+                    LOG_ERROR("Shaders", "Failed to reload GBuffer shaders");
+                    break;
+                }
+                gbufferReload = false;
+                LOG_INFO("Shaders", "GBuffer shaders reloaded successfully");
+            }
+
+            if (config.rtao.reload && !ddgiReloadPending)
             {
                 LOG_INFO("Shaders", "Reloading RTAO shaders...");
                 if (!Graphics::RTAO::Reload(gfx, gfxResources, rtao, log))
@@ -499,7 +753,7 @@ int Run(const std::vector<std::string>& arguments)
                 LOG_INFO("Shaders", "RTAO shaders reloaded successfully");
             }
 
-            if (config.postProcess.reload)
+            if (config.postProcess.reload && !ddgiReloadPending)
             {
                 LOG_INFO("Shaders", "Reloading Composite shaders...");
                 if (!Graphics::Composite::Reload(gfx, gfxResources, composite, log))
@@ -510,6 +764,66 @@ int Run(const std::vector<std::string>& arguments)
                 config.postProcess.reload = false;
                 LOG_INFO("Shaders", "Composite shaders reloaded successfully");
             }
+
+            // Apply the DDGIVolume changes of a saved config file
+            if (config.app.hotReload && !ddgiReloadPending && !config.app.benchmarkRunning)
+            {
+                uint64_t stamp = Caches::GetFileStamp(config.app.filepath);
+                if (stamp != configStamp)
+                {
+                    configStamp = stamp;
+
+                    std::vector<Configs::DDGIVolume> running = config.ddgi.volumes;
+                    std::vector<Configs::EDDGIVolumeChange> changes;
+                    if (!Configs::ReloadDDGIVolumes(config, changes, log))
+                    {
+                        LOG_ERROR("Config", "Failed to reload the DDGIVolumes of the config file");
+                    }
+                    else
+                    {
+                        // Fit the reloaded volumes to the memory budget, then compare the plan with the running volumes
+                        std::vector<Configs::EDDGIVolumeChange> planned;
+                        memoryBudget.requested = config.ddgi.volumes;
+                        if (Graphics::DDGI::PlanMemoryBudget(gfx, memoryBudget, config, planned, true, log))
+                        {
+                            for (size_t volumeIndex = 0; volumeIndex < changes.size(); volumeIndex++)
+                            {
+                                changes[volumeIndex] = Configs::DiffDDGIVolume(running[volumeIndex], config.ddgi.volumes[volumeIndex]);
+                            }
+                        }
+
+                        if (!applyVolumeChanges(changes)) break;
+                        LOG_INFO("Config", "DDGIVolume changes of the config file applied");
+                    }
+                }
+            }
+
+            // Fit the DDGIVolumes to the video memory budget again when it changes (config ddgi.memoryBudgetAdaptive)
+            if (config.ddgi.memoryBudget > 0 && config.ddgi.memoryBudgetAdaptive && !ddgiReloadPending && !config.app.benchmarkRunning && (gfx.frameNumber % 60) == 0)
+            {
+                std::vector<Configs::EDDGIVolumeChange> changes;
+                if (Graphics::DDGI::PlanMemoryBudget(gfx, memoryBudget, config, changes, false, log))
+                {
+                    if (!applyVolumeChanges(changes)) break;
+                    LOG_INFO("Config", "DDGIVolumes fit to a memory budget of " + std::to_string(memoryBudget.budget >> 20) + "MB");
+                }
+            }
+
+            // Step the DDGI workload down or back up toward the GPU time budget (config ddgi.costBudget)
+            if (!ddgiReloadPending && !config.app.benchmarkRunning)
+            {
+                std::vector<Configs::EDDGIVolumeChange> changes;
+                bool resizeIndirect = false;
+                if (Graphics::DDGI::ControlCost(gfx, costController, ddgi, config, changes, resizeIndirect, log))
+                {
+                    if (!applyVolumeChanges(changes)) break;
+                    if (resizeIndirect)
+                    {
+                        Graphics::WaitForGPU(gfx);
+                        if (!Graphics::DDGI::Resize(gfx, gfxResources, ddgi, log)) break;
+                    }
+                }
+            }
         }
 
         CPU_TIMESTAMP_BEGIN(inputStat);
@@ -526,9 +840,22 @@ int Run(const std::vector<std::string>& arguments)
             input.event = Inputs::EInputEvent::NONE;
         }
 
+    #ifdef GFX_PERF_INSTRUMENTATION
+        // Start a trace capture
+        if (!perf.trace.capturing && input.event == Inputs::EInputEvent::TRACE_CAPTURE)
+        {
+            perf.trace.Start(config.app.traceFrames);
+            input.event = Inputs::EInputEvent::NONE;
+        }
+    #endif
+
         // Handle mouse and keyboard input
         Inputs::PollInputs(gfx.window);
 
+        // Record the frame's inputs, or replace them with the recorded ones. The replay exits once every frame is replayed.
+        Replay::UpdateInputs(replay, input, config, scene);
+        if (replay.finished) break;
+
         // Reset the frame number on camera movement (for path tracer accumulation reset)
         if (input.event == Inputs::EInputEvent::CAMERA_MOVEMENT)
         {
@@ -538,44 +865,115 @@ int Run(const std::vector<std::string>& arguments)
 
         CPU_TIMESTAMP_ENDANDRESOLVE(inputStat);
 
+        // Follow the benchmark's camera spline (the path tracer restarts its accumulation as the camera moves)
+        if (config.app.benchmarkRunning && Benchmark::UpdateBenchmarkCamera(benchmarkRun, config, scene))
+        {
+            if (config.app.renderMode == ERenderMode::PATH_TRACE) gfx.frameNumber = 1;
+        }
+
+        // Initialize the deferred workloads on first use, once the shader warm-up and DDGI reload threads release the shader compiler
+        if (!warmup.joinable() && !ddgiReloadPending)
+        {
+            if (!ptInitialized && config.app.renderMode == ERenderMode::PATH_TRACE)
+            {
+                LOG_INFO("Graphics", "Initializing PathTracing workload...");
+                if (!Graphics::PathTracing::Initialize(gfx, gfxResources, pt, perf, log))
+                {
+                    LOG_ERROR("Graphics", "Failed to initialize the PathTracing workload");
+                    break;
+                }
+                LOG_INFO("Graphics", "PathTracing initialized");
+                ptInitialized = true;
+                gfx.frameNumber = 1;
+            }
+
+            if (!rtaoInitialized && config.app.renderMode == ERenderMode::DDGI && config.rtao.enabled)
+            {
+                LOG_INFO("Graphics", "Initializing RTAO workload...");
+                if (!Graphics::RTAO::Initialize(gfx, gfxResources, rtao, perf, log))
+                {
+                    LOG_ERROR("Graphics", "Failed to initialize the RTAO workload");
+                    break;
+                }
+                LOG_INFO("Graphics", "RTAO initialized");
+                rtaoInitialized = true;
+            }
+        }
+
+        // Scale the render resolution of the DDGI passes to the last GPU frame time. The path tracer accumulates at full resolution.
+        float resolutionScale = 1.f;
+    #ifdef GFX_PERF_INSTRUMENTATION
+        if (config.app.renderMode == ERenderMode::DDGI) resolutionScale = DynamicResolution::Update(resolutionController, config, perf.gpuTimes[0]->elapsed);
+    #endif
+        Graphics::SetResolutionScale(gfx, resolutionScale);
+
         // Update the simulation / constant buffers
         CPU_TIMESTAMP_BEGIN(updateStat);
         Graphics::Update(gfx, gfxResources, config, scene);
         CPU_TIMESTAMP_ENDANDRESOLVE(updateStat);
 
-        if(config.app.renderMode == ERenderMode::PATH_TRACE)
+        // Update the passes on the main thread, in order, and declare the resources they access. Their uploads are recorded ahead of the passes.
+        graph.Reset();
+        uint32_t outputs = RenderGraph::Bit(RenderGraph::BACKBUFFER);
+        if(config.app.renderMode == ERenderMode::PATH_TRACE && ptInitialized)
         {
             Graphics::PathTracing::Update(gfx, gfxResources, pt, config);
-            Graphics::PathTracing::Execute(gfx, gfxResources, pt);
+            graph.AddPass("Path Tracing", ptPass, 0, RenderGraph::Bit(RenderGraph::BACKBUFFER));
         }
         else if(config.app.renderMode == ERenderMode::DDGI)
         {
             // GBuffer
             Graphics::GBuffer::Update(gfx, gfxResources, gbuffer, config);
-            Graphics::GBuffer::Execute(gfx, gfxResources, gbuffer);
+            graph.AddPass("GBuffer", gbufferPass, 0, RenderGraph::Bit(RenderGraph::GBUFFER));
 
-            // RTXGI: DDGI
+            // RTXGI: DDGI (the probe update chain may run on the compute queue, the probes are the next frame's input)
             Graphics::DDGI::Update(gfx, gfxResources, ddgi, config, scene);
-            Graphics::DDGI::Execute(gfx, gfxResources, ddgi);
+            graph.AddPass("DDGI", ddgiPass, RenderGraph::Bit(RenderGraph::GBUFFER) | RenderGraph::Bit(RenderGraph::DDGI_PROBES), RenderGraph::Bit(RenderGraph::DDGI_OUTPUT), RenderGraph::Bit(RenderGraph::DDGI_PROBES));
+            if (config.ddgi.enabled) outputs |= RenderGraph::Bit(RenderGraph::DDGI_PROBES);
 
-            // RTXGI: DDGI Visualizations
+            // RTXGI: DDGI Visualizations (drawn into GBufferA)
             Graphics::DDGI::Visualizations::Update(gfx, gfxResources, ddgiVis, config);
-            Graphics::DDGI::Visualizations::Execute(gfx, gfxResources, ddgiVis);
+            if (config.ddgi.enabled && (config.ddgi.showProbes || config.ddgi.showTextures))
+            {
+                graph.AddPass("DDGI Visualizations", ddgiVisPass, RenderGraph::Bit(RenderGraph::GBUFFER) | RenderGraph::Bit(RenderGraph::DDGI_PROBES), RenderGraph::Bit(RenderGraph::GBUFFER));
+            }
 
             // Ray Traced Ambient Occlusion
-            Graphics::RTAO::Update(gfx, gfxResources, rtao, config);
-            Graphics::RTAO::Execute(gfx, gfxResources, rtao);
+            if (rtaoInitialized)
+            {
+                Graphics::RTAO::Update(gfx, gfxResources, rtao, config);
+                graph.AddPass("RTAO", rtaoPass, RenderGraph::Bit(RenderGraph::GBUFFER), RenderGraph::Bit(RenderGraph::RTAO_OUTPUT));
+            }
 
             // Composite & Post Processing
             Graphics::Composite::Update(gfx, gfxResources, composite, config);
-            Graphics::Composite::Execute(gfx, gfxResources, composite);
+            uint32_t compositeReads = RenderGraph::Bit(RenderGraph::GBUFFER);
+            if (config.ddgi.enabled) compositeReads |= RenderGraph::Bit(RenderGraph::DDGI_OUTPUT);
+            if (config.rtao.enabled) compositeReads |= RenderGraph::Bit(RenderGraph::RTAO_OUTPUT);
+            // With a scaled render resolution, the composited image goes through GBufferD to the upscale
+            uint32_t compositeWrites = RenderGraph::Bit(RenderGraph::BACKBUFFER);
+            if (resolutionScale < 1.f) compositeWrites |= RenderGraph::Bit(RenderGraph::GBUFFER);
+            graph.AddPass("Composite", compositePass, compositeReads, compositeWrites);
         }
 
         // UI
         CPU_TIMESTAMP_BEGIN(perf.cpuTimes[Instrumentation::EStatIndex::UI]);
-        Graphics::UI::Update(gfx, ui, config, input, scene, ddgi.volumes, perf);
-        Graphics::UI::Execute(gfx, gfxResources, ui, config);
+        Graphics::UI::Update(gfx, ui, config, input, scene, ddgi.volumes, costController, perf);
         CPU_TIMESTAMP_ENDANDRESOLVE(perf.cpuTimes[Instrumentation::EStatIndex::UI]);
+        graph.AddPass("UI", uiPass, RenderGraph::Bit(RenderGraph::BACKBUFFER), RenderGraph::Bit(RenderGraph::BACKBUFFER), 0, true);
+
+        graph.Compile(outputs, gfx.DDGIAsyncCompute);
+        graph.GetPasses(passes);
+
+        // Record the passes, each on its own command list in parallel (config app.parallelRecording), submitted in order
+        CPU_TIMESTAMP_BEGIN(recordStat);
+        if (!Graphics::RecordPasses(gfx, passes))
+        {
+            LOG_ERROR("Graphics", "RecordPasses failed");
+            break;
+        }
+        CPU_TIMESTAMP_ENDANDRESOLVE(recordStat);
+        if (config.app.renderMode == ERenderMode::PATH_TRACE) config.pathTrace.converged = pt.converged;
 
         // GPU Timestamps
         CPU_TIMESTAMP_BEGIN(timestampEndStat);
@@ -585,6 +983,14 @@ int Run(const std::vector<std::string>& arguments)
     #endif
         CPU_TIMESTAMP_ENDANDRESOLVE(timestampEndStat);
 
+        // Late latch the camera: process the mouse input that arrived while the frame was recorded and rewrite the frame's camera constants.
+        // GLFW only processes events on the main thread. The path tracer accumulates with the camera it was recorded with, benchmarks follow their spline.
+        if (config.input.lateLatch && config.app.renderMode == ERenderMode::DDGI && !config.app.benchmarkRunning)
+        {
+            glfwPollEvents();
+            Graphics::LatchCamera(gfx, gfxResources, scene);
+        }
+
         // Submit
         CPU_TIMESTAMP_BEGIN(submitStat);
         if (!Graphics::SubmitCmdList(gfx))
@@ -606,6 +1012,8 @@ int Run(const std::vector<std::string>& arguments)
         }
         CPU_TIMESTAMP_ENDANDRESOLVE(presentStat);
         CPU_TIMESTAMP_ENDANDRESOLVE(frameStat); // end of frame
+        perf.frameAllocations = Memory::GetAllocationCount() - frameAllocationStart;
+        Replay::EndFrame(replay, perf);
 
         // Handle window resize events
         if (Windows::GetWindowEvent() == Windows::EWindowEvent::RESIZE)
@@ -622,13 +1030,13 @@ int Run(const std::vector<std::string>& arguments)
             }
 
             // Resize all screen-space buffers
-            if (!Graphics::ResizeBegin(gfx, gfxResources, width, height, log)) break;             // Back buffers and GBuffer textures
-            if (!Graphics::PathTracing::Resize(gfx, gfxResources, pt, log)) break;                // PT Output and Accumulation
-            if (!Graphics::GBuffer::Resize(gfx, gfxResources, gbuffer, log)) break;               // GBuffer
-            if (!Graphics::DDGI::Resize(gfx, gfxResources, ddgi, log)) break;                     // DDGI
-            if (!Graphics::DDGI::Visualizations::Resize(gfx, gfxResources, ddgiVis, log)) break;  // DDGI Visualizations
-            if (!Graphics::RTAO::Resize(gfx, gfxResources, rtao, log)) break;                     // RTAO Raw and Output textures
-            if (!Graphics::Composite::Resize(gfx, gfxResources, composite, log)) break;           // Composite
+            if (!Graphics::ResizeBegin(gfx, gfxResources, width, height, log)) break;                // Back buffers and GBuffer textures
+            if (ptInitialized && !Graphics::PathTracing::Resize(gfx, gfxResources, pt, log)) break;  // PT Output and Accumulation
+            if (!Graphics::GBuffer::Resize(gfx, gfxResources, gbuffer, log)) break;                  // GBuffer
+            if (!Graphics::DDGI::Resize(gfx, gfxResources, ddgi, log)) break;                        // DDGI
+            if (!Graphics::DDGI::Visualizations::Resize(gfx, gfxResources, ddgiVis, log)) break;     // DDGI Visualizations
+            if (rtaoInitialized && !Graphics::RTAO::Resize(gfx, gfxResources, rtao, log)) break;     // RTAO Raw and Output textures
+            if (!Graphics::Composite::Resize(gfx, gfxResources, composite, log)) break;              // Composite
             if (!Graphics::ResizeEnd(gfx)) break;
             Windows::ResetWindowEvent();
         }
@@ -643,7 +1051,14 @@ int Run(const std::vector<std::string>& arguments)
         // Image Capture (user triggered)
         if (input.event == Inputs::EInputEvent::SAVE_IMAGES || input.event == Inputs::EInputEvent::SCREENSHOT)
         {
-            StoreImages(input.event, config, gfx, gfxResources, rtao, ddgi);
+            StoreImages(input.event, config, gfx, gfxResources, rtaoInitialized ? &rtao : nullptr, ddgi);
+        }
+
+        // Image Capture (periodic, D3D12 captures are written on a worker thread without stalling the frame)
+        if (config.app.captureInterval > 0 && (gfx.frameNumber % config.app.captureInterval) == 0)
+        {
+            Inputs::EInputEvent e = Inputs::EInputEvent::SAVE_IMAGES;
+            StoreImages(e, config, gfx, gfxResources, rtaoInitialized ? &rtao : nullptr, ddgi);
         }
 
         // Debug Capture (for Claude Code visual debugging)
@@ -660,17 +1075,33 @@ int Run(const std::vector<std::string>& arguments)
             {
                 // Store intermediate images when the benchmark ends
                 Inputs::EInputEvent e = Inputs::EInputEvent::SCREENSHOT;
-                StoreImages(e, config, gfx, gfxResources, rtao, ddgi);
+                StoreImages(e, config, gfx, gfxResources, rtaoInitialized ? &rtao : nullptr, ddgi);
 
                 e = Inputs::EInputEvent::SAVE_IMAGES;
-                StoreImages(e, config, gfx, gfxResources, rtao, ddgi);
+                StoreImages(e, config, gfx, gfxResources, rtaoInitialized ? &rtao : nullptr, ddgi);
+
+                // The headless benchmark exits once the results are written
+                if (config.benchmark.headless) break;
             }
         }
+        Benchmark::UpdateBackendSelection(backendSelection, perf, config, log);
     #endif
     }
 
     Graphics::WaitForGPU(gfx);
 
+    // Write the replay log, or the comparison of the replayed frames with the recorded ones
+    if (!Replay::Finish(replay, config, log)) log << "\nFailed to finish the replay!";
+
+    // Wait for the shader warm-up, when the app exits before it finishes
+    if (warmup.joinable()) warmup.join();
+
+    // Store the probes of the volumes with a probe cache, for the next run
+    if (!Graphics::DDGI::StoreVolumeCaches(gfx, gfxResources, ddgi, config, scene, log)) log << "\nFailed to store DDGIVolume caches!";
+
+    // Store the radiance cache cells, for the next run
+    if (!Graphics::DDGI::StoreRadianceCache(gfx, gfxResources, ddgi, config, scene, log)) log << "\nFailed to store the radiance cache file!";
+
     CPU_TIMESTAMP_BEGIN(&startupShutdown);
 
     log << "Shutting down and cleaning up...\n";
@@ -678,15 +1109,19 @@ int Run(const std::vector<std::string>& arguments)
 
     perf.Cleanup();
 
+    ShaderWatch::Close(shaderWatch);
     Graphics::UI::Cleanup();
     Graphics::Composite::Cleanup(gfx, composite);
-    Graphics::RTAO::Cleanup(gfx, rtao);
+    if (rtaoInitialized) Graphics::RTAO::Cleanup(gfx, rtao);
     Graphics::DDGI::Visualizations::Cleanup(gfx, ddgiVis);
     Graphics::DDGI::Cleanup(gfx, ddgi);
     Graphics::GBuffer::Cleanup(gfx, gbuffer);
-    Graphics::PathTracing::Cleanup(gfx, pt);
+    if (ptInitialized) Graphics::PathTracing::Cleanup(gfx, pt);
     Graphics::Cleanup(gfx, gfxResources);
 
+    // Release the scene textures kept for texture streaming
+    Scenes::Cleanup(scene);
+
 #ifdef GPU_COMPRESSION
     Textures::Cleanup();
 #endif
@@ -697,13 +1132,19 @@ int Run(const std::vector<std::string>& arguments)
     log << "Shutdown complete in " << startupShutdown.elapsed << " milliseconds\n";
     LOG_INFO("App", "Shutdown complete in " + std::to_string(startupShutdown.elapsed) + " milliseconds");
 
+    // Compare the headless benchmark against its baseline, once the cleanup has written its images to disk
+    bool regressed = false;
+#ifdef GFX_PERF_INSTRUMENTATION
+    if (config.benchmark.headless) regressed = !Benchmark::CompareToBaseline(benchmarkRun, config, log);
+#endif
+
     log << "Done.\n";
     log.close();
 
     LOG_INFO("App", "Application exiting normally");
     AppLog::Logger::Instance().Shutdown();
 
-    return EXIT_SUCCESS;
+    return regressed ? Benchmark::ExitRegression : EXIT_SUCCESS;
 }
 
 /**
@@ -752,8 +1193,25 @@ int main(int argc, char* argv[])
     #pragma message("Platform not supported!")
 #endif
 
-    // Run the application
-    int result = Run(arguments);
+    // Run the application (once per config file with --benchmark)
+    int result = EXIT_SUCCESS;
+    bool regressed = false;
+    uint32_t numRuns = 1;
+    for (uint32_t runIndex = 0; runIndex < numRuns && result == EXIT_SUCCESS; runIndex++)
+    {
+        result = Run(arguments, runIndex, numRuns);
+
+        // A regression fails the headless benchmark after the remaining configs have run
+        if (result == Benchmark::ExitRegression)
+        {
+            regressed = true;
+            result = EXIT_SUCCESS;
+        }
+    }
+    if (regressed && result == EXIT_SUCCESS) result = Benchmark::ExitRegression;
+
+    // The headless benchmark reports errors with its exit code, there is nobody to dismiss a message box
+    if (std::find(arguments.begin(), arguments.end(), "--benchmark") != arguments.end()) return result;
 
     // If an error occurred, spawn a message box
     if (result != EXIT_SUCCESS)
@@ -0,0 +1,649 @@
+/*
+ * SDK kernel benchmark implementation
+ */
+
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace rtxgi;
+
+namespace
+{
+    static char VolumeName[] = "KernelBenchmark";
+
+    const float SkyRadiance[3] = { 0.4f, 0.6f, 1.f };
+
+    /**
+     * Integer hash (lowbias32), used to generate reproducible ray data.
+     */
+    uint32_t Hash(uint32_t x)
+    {
+        x ^= x >> 16;
+        x *= 0x7feb352du;
+        x ^= x >> 15;
+        x *= 0x846ca68bu;
+        x ^= x >> 16;
+        return x;
+    }
+
+    float HashToFloat(uint32_t h)
+    {
+        return (float)(h >> 8) * (1.f / 16777216.f);
+    }
+
+    /**
+     * Get the radiance and hit distance (in probe spacings) of a ray for the given pattern.
+     * Matches the ray data encoding of ProbeTraceRGS/ProbeTraceCS: misses are 1e27 and backface hits are -0.2 * hitT.
+     */
+    void GetRaySample(ERayPattern pattern, uint32_t probeIndex, uint32_t rayIndex, float radiance[3], float& hitT)
+    {
+        switch (pattern)
+        {
+        case ERayPattern::Sky:
+            memcpy(radiance, SkyRadiance, sizeof(SkyRadiance));
+            hitT = 1e27f;
+            break;
+        case ERayPattern::Constant:
+            radiance[0] = radiance[1] = radiance[2] = 0.5f;
+            hitT = 0.5f;
+            break;
+        case ERayPattern::Backface:
+            radiance[0] = radiance[1] = radiance[2] = 0.f;
+            hitT = -0.5f * 0.2f;
+            break;
+        case ERayPattern::Noise:
+        default:
+        {
+            uint32_t h = Hash(probeIndex * 8191u + rayIndex);
+            radiance[0] = HashToFloat(Hash(h));
+            radiance[1] = HashToFloat(Hash(h + 1));
+            radiance[2] = HashToFloat(Hash(h + 2));
+            hitT = 0.1f + 1.9f * HashToFloat(h);
+
+            // One in 16 rays misses, every 8th probe sees backfaces on about half of its rays
+            if ((h & 15) == 0)
+            {
+                memcpy(radiance, SkyRadiance, sizeof(SkyRadiance));
+                hitT = 1e27f;
+            }
+            else if ((probeIndex & 7) == 0 && (h & 16)) hitT = -hitT * 0.2f;
+            break;
+        }
+        }
+    }
+
+    /**
+     * Pack a float3 into a 32-bit unsigned integer, see RTXGIFloat3ToUint() in shaders/Common.hlsl.
+     */
+    uint32_t Float3ToUint(const float v[3])
+    {
+        uint32_t result = 0;
+        for (uint32_t channel = 0; channel < 3; channel++)
+        {
+            float c = (std::min)((std::max)(v[channel], 0.f), 1.f);
+            result |= ((uint32_t)std::floor(c * 1023.f + 0.5f)) << (channel * 10);
+        }
+        return result;
+    }
+
+    bool CreateBuffer(ID3D12Device* device, UINT64 size, D3D12_HEAP_TYPE heapType, D3D12_RESOURCE_STATES state, ID3D12Resource** resource)
+    {
+        D3D12_HEAP_PROPERTIES heapProps = {};
+        heapProps.Type = heapType;
+
+        D3D12_RESOURCE_DESC desc = {};
+        desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+        desc.Width = size;
+        desc.Height = 1;
+        desc.DepthOrArraySize = 1;
+        desc.MipLevels = 1;
+        desc.SampleDesc.Count = 1;
+        desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+        return SUCCEEDED(device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc, state, nullptr, IID_PPV_ARGS(resource)));
+    }
+
+    template<typename T>
+    void SafeRelease(T*& object)
+    {
+        if (object) { object->Release(); object = nullptr; }
+    }
+}
+
+const char* GetKernelName(EKernel kernel)
+{
+    switch (kernel)
+    {
+    case EKernel::ProbeBlending: return "ProbeBlendingCS";
+    case EKernel::ProbeRelocation: return "ProbeRelocationCS";
+    case EKernel::ProbeClassification: return "ProbeClassificationCS";
+    case EKernel::Reduction: return "ReductionCS";
+    default: return "Unknown";
+    }
+}
+
+const char* GetRayPatternName(ERayPattern pattern)
+{
+    switch (pattern)
+    {
+    case ERayPattern::Sky: return "sky";
+    case ERayPattern::Constant: return "constant";
+    case ERayPattern::Noise: return "noise";
+    case ERayPattern::Backface: return "backface";
+    default: return "unknown";
+    }
+}
+
+const char* GetTextureFormatName(EDDGIVolumeTextureFormat format)
+{
+    switch (format)
+    {
+    case EDDGIVolumeTextureFormat::U32: return "U32";
+    case EDDGIVolumeTextureFormat::F16: return "F16";
+    case EDDGIVolumeTextureFormat::F16x2: return "F16x2";
+    case EDDGIVolumeTextureFormat::F16x4: return "F16x4";
+    case EDDGIVolumeTextureFormat::F32: return "F32";
+    case EDDGIVolumeTextureFormat::F32x2: return "F32x2";
+    case EDDGIVolumeTextureFormat::F32x4: return "F32x4";
+    default: return "Unknown";
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------
+// Device
+//----------------------------------------------------------------------------------------------------------
+
+bool Benchmark::Initialize(const std::string& projectRoot, int adapterIndex, bool stableClocks)
+{
+    m_projectRoot = projectRoot;
+
+    if (!m_compiler.Initialize(projectRoot)) return Fail("Failed to load the DXC shader compiler");
+
+    if (FAILED(CreateDXGIFactory2(0, IID_PPV_ARGS(&m_factory)))) return Fail("Failed to create the DXGI factory");
+    if (FAILED(m_factory->EnumAdapters1((UINT)adapterIndex, &m_adapter))) return Fail("Adapter " + std::to_string(adapterIndex) + " not found");
+
+    DXGI_ADAPTER_DESC1 adapterDesc = {};
+    m_adapter->GetDesc1(&adapterDesc);
+    char name[128] = {};
+    WideCharToMultiByte(CP_UTF8, 0, adapterDesc.Description, -1, name, sizeof(name) - 1, nullptr, nullptr);
+    m_adapterName = name;
+
+    if (FAILED(D3D12CreateDevice(m_adapter, D3D_FEATURE_LEVEL_12_0, IID_PPV_ARGS(&m_device)))) return Fail("Failed to create the D3D12 device on " + m_adapterName);
+
+    // The SDK shaders are compiled for Shader Model 6.6
+    D3D12_FEATURE_DATA_SHADER_MODEL shaderModel = { D3D_SHADER_MODEL_6_6 };
+    if (FAILED(m_device->CheckFeatureSupport(D3D12_FEATURE_SHADER_MODEL, &shaderModel, sizeof(shaderModel))) || shaderModel.HighestShaderModel < D3D_SHADER_MODEL_6_6)
+    {
+        return Fail(m_adapterName + " does not support Shader Model 6.6");
+    }
+
+    // The reduction shaders are compiled for the adapter's wave lane count, like the test harness
+    D3D12_FEATURE_DATA_D3D12_OPTIONS1 options1 = {};
+    if (SUCCEEDED(m_device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS1, &options1, sizeof(options1)))) m_waveLaneCount = options1.WaveLaneCountMin;
+
+    // Lock the GPU clocks so runs are comparable (requires Windows developer mode)
+    if (stableClocks && FAILED(m_device->SetStablePowerState(TRUE))) return Fail("Failed to set the stable power state (is developer mode enabled?)");
+
+    D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+    queueDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+    if (FAILED(m_device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_queue)))) return Fail("Failed to create the command queue");
+    if (FAILED(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&m_cmdAlloc)))) return Fail("Failed to create the command allocator");
+    if (FAILED(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, m_cmdAlloc, nullptr, IID_PPV_ARGS(&m_cmdList)))) return Fail("Failed to create the command list");
+    m_cmdList->Close();
+
+    if (FAILED(m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence)))) return Fail("Failed to create the fence");
+    m_fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (m_fenceEvent == nullptr) return Fail("Failed to create the fence event");
+
+    if (FAILED(m_queue->GetTimestampFrequency(&m_timestampFrequency))) return Fail("Failed to get the timestamp frequency");
+
+    return true;
+}
+
+void Benchmark::Cleanup()
+{
+    if (m_queue && m_fence) SubmitAndWait();
+
+    SafeRelease(m_resourceHeap);
+    SafeRelease(m_constantsBuffer);
+    SafeRelease(m_constantsBufferUpload);
+    SafeRelease(m_rayDataUpload);
+    SafeRelease(m_queryReadback);
+    SafeRelease(m_queryHeap);
+    SafeRelease(m_fence);
+    SafeRelease(m_cmdList);
+    SafeRelease(m_cmdAlloc);
+    SafeRelease(m_queue);
+    SafeRelease(m_device);
+    SafeRelease(m_adapter);
+    SafeRelease(m_factory);
+
+    if (m_fenceEvent) { CloseHandle(m_fenceEvent); m_fenceEvent = nullptr; }
+    m_queryCount = 0;
+    m_shaderCache.clear();
+}
+
+bool Benchmark::BeginCommands()
+{
+    if (FAILED(m_cmdAlloc->Reset())) return Fail("Failed to reset the command allocator");
+    if (FAILED(m_cmdList->Reset(m_cmdAlloc, nullptr))) return Fail("Failed to reset the command list");
+    return true;
+}
+
+bool Benchmark::SubmitAndWait()
+{
+    // Close the command list if it is recording (Close() fails on a closed list, which is fine here)
+    if (SUCCEEDED(m_cmdList->Close()))
+    {
+        ID3D12CommandList* lists[] = { m_cmdList };
+        m_queue->ExecuteCommandLists(1, lists);
+    }
+
+    m_fenceValue++;
+    m_queue->Signal(m_fence, m_fenceValue);
+    if (m_fence->GetCompletedValue() < m_fenceValue)
+    {
+        m_fence->SetEventOnCompletion(m_fenceValue, m_fenceEvent);
+        WaitForSingleObject(m_fenceEvent, INFINITE);
+    }
+
+    if (m_device->GetDeviceRemovedReason() != S_OK) return Fail("The D3D12 device was removed");
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------
+// Shaders
+//----------------------------------------------------------------------------------------------------------
+
+const std::vector<uint8_t>* Benchmark::GetShader(const std::string& file, const std::string& entryPoint, const std::vector<std::string>& defines)
+{
+    // The variant key is the file, entry point, and defines (in order)
+    std::string key = file + ":" + entryPoint;
+    for (const std::string& define : defines) key += " " + define;
+
+    auto it = m_shaderCache.find(key);
+    if (it != m_shaderCache.end()) return &it->second;
+
+    std::string shaderRoot = m_projectRoot + "/rtxgi-sdk/shaders/ddgi";
+    CompileResult result = m_compiler.CompileDXIL(shaderRoot + "/" + file, entryPoint, "cs_6_6", defines, { shaderRoot });
+    if (!result.success)
+    {
+        m_error = "Failed to compile " + file + " (" + entryPoint + "): " + result.errorMessage;
+        return nullptr;
+    }
+
+    return &(m_shaderCache[key] = std::move(result.bytecode));
+}
+
+bool Benchmark::CompileShaders(const DDGIVolumeDesc& desc, int sharedMemory, VolumeShaders& shaders)
+{
+    // Managed resource mode with the SDK's root signature (not bindless), see AddCommonShaderDefines() in the test harness
+    const std::vector<std::string> common =
+    {
+        "RTXGI_DDGI_RESOURCE_MANAGEMENT=1",
+        "RTXGI_BINDLESS_TYPE=0",
+        "RTXGI_COORDINATE_SYSTEM=" + std::to_string(RTXGI_COORDINATE_SYSTEM),
+        "RTXGI_DDGI_SHADER_REFLECTION=0",
+        "RTXGI_DDGI_BINDLESS_RESOURCES=0",
+        "RTXGI_DDGI_DEBUG_PROBE_INDEXING=0",
+        "RTXGI_DDGI_DEBUG_OCTAHEDRAL_INDEXING=0",
+        "RTXGI_DDGI_DEBUG_BORDER_COPY_INDEXING=0"
+    };
+
+    auto blending = [&](bool radiance, int numTexels, int numInteriorTexels)
+    {
+        std::vector<std::string> defines = common;
+        defines.push_back("RTXGI_DDGI_BLEND_RADIANCE=" + std::to_string(radiance ? 1 : 0));
+        defines.push_back("RTXGI_DDGI_PROBE_NUM_TEXELS=" + std::to_string(numTexels));
+        defines.push_back("RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS=" + std::to_string(numInteriorTexels));
+        defines.push_back("RTXGI_DDGI_BLEND_SHARED_MEMORY=" + std::to_string(sharedMemory == 1 ? 1 : 0));
+        defines.push_back("RTXGI_DDGI_BLEND_SHARED_MEMORY_TILED=" + std::to_string(sharedMemory == 2 ? 1 : 0));
+        if (sharedMemory == 1) defines.push_back("RTXGI_DDGI_BLEND_RAYS_PER_PROBE=" + std::to_string(desc.probeNumRays));
+        defines.push_back("RTXGI_DDGI_BLEND_SCROLL_SHARED_MEMORY=0");
+        defines.push_back("RTXGI_DDGI_BLEND_BORDER_SHARED_MEMORY=0");
+        defines.push_back("RTXGI_DDGI_PROBE_SCHEDULING=0");
+        return defines;
+    };
+
+    std::vector<std::string> classification = common;
+    classification.push_back("RTXGI_DDGI_PROBE_SCHEDULING=0");
+
+    std::vector<std::string> reduction = common;
+    reduction.push_back("RTXGI_DDGI_PROBE_NUM_INTERIOR_TEXELS=" + std::to_string(desc.probeNumIrradianceInteriorTexels));
+    reduction.push_back("RTXGI_DDGI_WAVE_LANE_COUNT=" + std::to_string(m_waveLaneCount));
+
+    shaders.blendingIrradiance = GetShader("ProbeBlendingCS.hlsl", "DDGIProbeBlendingCS", blending(true, desc.probeNumIrradianceTexels, desc.probeNumIrradianceInteriorTexels));
+    shaders.blendingDistance = GetShader("ProbeBlendingCS.hlsl", "DDGIProbeBlendingCS", blending(false, desc.probeNumDistanceTexels, desc.probeNumDistanceInteriorTexels));
+    shaders.relocation = GetShader("ProbeRelocationCS.hlsl", "DDGIProbeRelocationCS", common);
+    shaders.relocationReset = GetShader("ProbeRelocationCS.hlsl", "DDGIProbeRelocationResetCS", common);
+    shaders.classification = GetShader("ProbeClassificationCS.hlsl", "DDGIProbeClassificationCS", classification);
+    shaders.classificationReset = GetShader("ProbeClassificationCS.hlsl", "DDGIProbeClassificationResetCS", common);
+    shaders.reduction = GetShader("ReductionCS.hlsl", "DDGIReductionCS", reduction);
+    shaders.extraReduction = GetShader("ReductionCS.hlsl", "DDGIExtraReductionCS", reduction);
+
+    return shaders.blendingIrradiance && shaders.blendingDistance && shaders.relocation && shaders.relocationReset
+        && shaders.classification && shaders.classificationReset && shaders.reduction && shaders.extraReduction;
+}
+
+//----------------------------------------------------------------------------------------------------------
+// Volume
+//----------------------------------------------------------------------------------------------------------
+
+bool Benchmark::CreateVolume(const BenchmarkConfig& config, d3d12::DDGIVolume& volume)
+{
+    DDGIVolumeDesc desc;
+    desc.name = VolumeName;
+    desc.index = 0;
+    desc.rngSeed = 1;   // Fixed ray rotation so runs are reproducible
+    desc.origin = { 0.f, 0.f, 0.f };
+    desc.probeSpacing = { 1.f, 1.f, 1.f };
+    desc.probeCounts = config.probeCounts;
+    desc.probeNumRays = config.numRays;
+    desc.probeNumIrradianceTexels = 8;
+    desc.probeNumIrradianceInteriorTexels = 6;
+    desc.probeNumDistanceTexels = 16;
+    desc.probeNumDistanceInteriorTexels = 14;
+    desc.probeRayDataFormat = config.rayDataFormat;
+    desc.probeIrradianceFormat = config.irradianceFormat;
+    desc.probeDistanceFormat = config.distanceFormat;
+    desc.probeDataFormat = EDDGIVolumeTextureFormat::F16x4;
+    desc.probeVariabilityFormat = EDDGIVolumeTextureFormat::F16;
+    desc.probeMinFrontfaceDistance = 0.1f;
+    desc.probeRelocationEnabled = true;
+    desc.probeClassificationEnabled = true;
+    desc.probeVariabilityEnabled = true;
+
+    VolumeShaders shaders;
+    if (!CompileShaders(desc, config.sharedMemory, shaders)) return false;
+
+    // Descriptor heap layout: constants, resource indices, texture UAVs, texture SRVs, probe schedule UAV
+    const UINT numTexDescriptors = (UINT)GetDDGIVolumeNumTex2DArrayDescriptors();
+
+    D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+    heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    heapDesc.NumDescriptors = 2 + (UINT)GetDDGIVolumeNumResourceDescriptors() + 1;
+    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+    if (FAILED(m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_resourceHeap)))) return Fail("Failed to create the descriptor heap");
+
+    const UINT64 constantsSize = sizeof(DDGIVolumeDescGPUPacked);
+    if (!CreateBuffer(m_device, constantsSize, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON, &m_constantsBuffer)) return Fail("Failed to create the constants buffer");
+    if (!CreateBuffer(m_device, constantsSize * 2, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, &m_constantsBufferUpload)) return Fail("Failed to create the constants upload buffer");
+
+    d3d12::DDGIVolumeResources resources = {};
+
+    d3d12::DDGIVolumeDescriptorHeapDesc& descHeap = resources.descriptorHeap;
+    descHeap.resources = m_resourceHeap;
+    descHeap.entrySize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    descHeap.constantsIndex = 0;
+    descHeap.resourceIndicesIndex = 1;
+    descHeap.resourceIndices.rayDataUAVIndex = 2;
+    descHeap.resourceIndices.probeIrradianceUAVIndex = 3;
+    descHeap.resourceIndices.probeDistanceUAVIndex = 4;
+    descHeap.resourceIndices.probeDataUAVIndex = 5;
+    descHeap.resourceIndices.probeVariabilityUAVIndex = 6;
+    descHeap.resourceIndices.probeVariabilityAverageUAVIndex = 7;
+    descHeap.resourceIndices.rayDataSRVIndex = 2 + numTexDescriptors;
+    descHeap.resourceIndices.probeIrradianceSRVIndex = 3 + numTexDescriptors;
+    descHeap.resourceIndices.probeDistanceSRVIndex = 4 + numTexDescriptors;
+    descHeap.resourceIndices.probeDataSRVIndex = 5 + numTexDescriptors;
+    descHeap.resourceIndices.probeVariabilitySRVIndex = 6 + numTexDescriptors;
+    descHeap.resourceIndices.probeVariabilityAverageSRVIndex = 7 + numTexDescriptors;
+    descHeap.resourceIndices.probeScheduleUAVIndex = heapDesc.NumDescriptors - 1;
+
+    resources.bindless.enabled = false;
+    resources.bindless.type = d3d12::EBindlessType::RESOURCE_ARRAYS;
+
+    resources.constantsBuffer = m_constantsBuffer;
+    resources.constantsBufferUpload = m_constantsBufferUpload;
+    resources.constantsBufferSizeInBytes = constantsSize;
+
+    resources.managed.enabled = true;
+    resources.managed.device = m_device;
+    resources.managed.probeBlendingIrradianceCS = { shaders.blendingIrradiance->data(), shaders.blendingIrradiance->size() };
+    resources.managed.probeBlendingDistanceCS = { shaders.blendingDistance->data(), shaders.blendingDistance->size() };
+    resources.managed.probeRelocation.updateCS = { shaders.relocation->data(), shaders.relocation->size() };
+    resources.managed.probeRelocation.resetCS = { shaders.relocationReset->data(), shaders.relocationReset->size() };
+    resources.managed.probeClassification.updateCS = { shaders.classification->data(), shaders.classification->size() };
+    resources.managed.probeClassification.resetCS = { shaders.classificationReset->data(), shaders.classificationReset->size() };
+    resources.managed.probeVariability.reductionCS = { shaders.reduction->data(), shaders.reduction->size() };
+    resources.managed.probeVariability.extraReductionCS = { shaders.extraReduction->data(), shaders.extraReduction->size() };
+
+    ERTXGIStatus status = volume.Create(desc, resources);
+    if (status != ERTXGIStatus::OK) return Fail("Failed to create the DDGIVolume (ERTXGIStatus " + std::to_string((int)status) + ")");
+
+    return true;
+}
+
+bool Benchmark::UploadRayData(const BenchmarkConfig& config, d3d12::DDGIVolume& volume)
+{
+    ID3D12Resource* rayData = volume.GetProbeRayData();
+    D3D12_RESOURCE_DESC texDesc = rayData->GetDesc();
+
+    // One row of the ray data texture per probe, one texel per ray
+    const UINT numSlices = texDesc.DepthOrArraySize;
+    std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> footprints(numSlices);
+    std::vector<UINT> numRows(numSlices);
+    std::vector<UINT64> rowSizes(numSlices);
+    UINT64 totalBytes = 0;
+    m_device->GetCopyableFootprints(&texDesc, 0, numSlices, 0, footprints.data(), numRows.data(), rowSizes.data(), &totalBytes);
+
+    if (!CreateBuffer(m_device, totalBytes, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, &m_rayDataUpload)) return Fail("Failed to create the ray data upload buffer");
+
+    UINT8* pData = nullptr;
+    if (FAILED(m_rayDataUpload->Map(0, nullptr, reinterpret_cast<void**>(&pData)))) return Fail("Failed to map the ray data upload buffer");
+
+    const bool packed = (config.rayDataFormat == EDDGIVolumeTextureFormat::F32x2);
+    for (UINT slice = 0; slice < numSlices; slice++)
+    {
+        for (UINT row = 0; row < numRows[slice]; row++)
+        {
+            UINT8* pRow = pData + footprints[slice].Offset + (UINT64)row * footprints[slice].Footprint.RowPitch;
+            uint32_t probeIndex = (slice * numRows[slice]) + row;
+            for (UINT ray = 0; ray < (UINT)texDesc.Width; ray++)
+            {
+                float radiance[3];
+                float hitT;
+                GetRaySample(config.pattern, probeIndex, ray, radiance, hitT);
+
+                if (packed)
+                {
+                    // F32x2: R = packed radiance (asuint), G = hit distance
+                    uint32_t texel[2] = { Float3ToUint(radiance), 0 };
+                    memcpy(&texel[1], &hitT, sizeof(float));
+                    memcpy(pRow + ray * sizeof(texel), texel, sizeof(texel));
+                }
+                else
+                {
+                    // F32x4: RGB = radiance, A = hit distance
+                    float texel[4] = { radiance[0], radiance[1], radiance[2], hitT };
+                    memcpy(pRow + ray * sizeof(texel), texel, sizeof(texel));
+                }
+            }
+        }
+    }
+    m_rayDataUpload->Unmap(0, nullptr);
+
+    if (!BeginCommands()) return false;
+
+    // The managed ray data texture is created in the UAV state, the probe textures in the shader resource state
+    D3D12_RESOURCE_BARRIER barriers[4] = {};
+    for (D3D12_RESOURCE_BARRIER& barrier : barriers) barrier.Transition.Subresources = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+
+    barriers[0].Transition.pResource = rayData;
+    barriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+    barriers[0].Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
+    m_cmdList->ResourceBarrier(1, barriers);
+
+    for (UINT slice = 0; slice < numSlices; slice++)
+    {
+        D3D12_TEXTURE_COPY_LOCATION dst = {};
+        dst.pResource = rayData;
+        dst.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        dst.SubresourceIndex = slice;
+
+        D3D12_TEXTURE_COPY_LOCATION src = {};
+        src.pResource = m_rayDataUpload;
+        src.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+        src.PlacedFootprint = footprints[slice];
+
+        m_cmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+    }
+
+    // The update functions expect every texture in the UAV state
+    barriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+    barriers[0].Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+
+    ID3D12Resource* probeTextures[3] = { volume.GetProbeIrradiance(), volume.GetProbeDistance(), volume.GetProbeData() };
+    for (UINT i = 0; i < 3; i++)
+    {
+        barriers[i + 1].Transition.pResource = probeTextures[i];
+        barriers[i + 1].Transition.StateBefore = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+        barriers[i + 1].Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+    }
+    m_cmdList->ResourceBarrier(4, barriers);
+
+    // The constants do not change between iterations, upload them once
+    d3d12::DDGIVolume* volumes[] = { &volume };
+    if (d3d12::UploadDDGIVolumeConstants(m_cmdList, 0, 1, volumes) != ERTXGIStatus::OK) return Fail("Failed to upload the DDGIVolume constants");
+
+    if (!SubmitAndWait()) return false;
+
+    SafeRelease(m_rayDataUpload);
+    return true;
+}
+
+bool Benchmark::RecordKernels(d3d12::DDGIVolume& volume, UINT queryOffset)
+{
+    // A global UAV barrier on each side of a kernel keeps the timestamps from overlapping the neighbouring kernels
+    D3D12_RESOURCE_BARRIER barrier = {};
+    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+    barrier.UAV.pResource = nullptr;
+
+    for (UINT kernel = 0; kernel < (UINT)EKernel::Count; kernel++)
+    {
+        m_cmdList->ResourceBarrier(1, &barrier);
+        m_cmdList->EndQuery(m_queryHeap, D3D12_QUERY_TYPE_TIMESTAMP, queryOffset + (kernel * 2));
+
+        ERTXGIStatus status = ERTXGIStatus::OK;
+        switch ((EKernel)kernel)
+        {
+        case EKernel::ProbeBlending: status = d3d12::UpdateDDGIVolumeProbes(m_cmdList, 1, &volume); break;
+        case EKernel::ProbeRelocation: status = d3d12::RelocateDDGIVolumeProbes(m_cmdList, 1, &volume); break;
+        case EKernel::ProbeClassification: status = d3d12::ClassifyDDGIVolumeProbes(m_cmdList, 1, &volume); break;
+        case EKernel::Reduction: status = d3d12::CalculateDDGIVolumeVariability(m_cmdList, 0, 1, &volume); break;
+        default: break;
+        }
+        if (status != ERTXGIStatus::OK) return Fail(std::string(GetKernelName((EKernel)kernel)) + " failed (ERTXGIStatus " + std::to_string((int)status) + ")");
+
+        m_cmdList->ResourceBarrier(1, &barrier);
+        m_cmdList->EndQuery(m_queryHeap, D3D12_QUERY_TYPE_TIMESTAMP, queryOffset + (kernel * 2) + 1);
+    }
+    return true;
+}
+
+void Benchmark::DestroyVolume(d3d12::DDGIVolume& volume)
+{
+    SubmitAndWait();
+    volume.Destroy();
+
+    SafeRelease(m_resourceHeap);
+    SafeRelease(m_constantsBuffer);
+    SafeRelease(m_constantsBufferUpload);
+    SafeRelease(m_rayDataUpload);
+}
+
+//----------------------------------------------------------------------------------------------------------
+// Run
+//----------------------------------------------------------------------------------------------------------
+
+bool Benchmark::Run(const BenchmarkConfig& config, int warmup, int iterations, std::vector<KernelTiming>& timings)
+{
+    timings.clear();
+    iterations = (std::max)(iterations, 1);
+
+    // Two timestamps per kernel per iteration
+    const UINT queriesPerIteration = (UINT)EKernel::Count * 2;
+    const UINT queryCount = queriesPerIteration * (UINT)iterations;
+    if (queryCount > m_queryCount)
+    {
+        SafeRelease(m_queryHeap);
+        SafeRelease(m_queryReadback);
+
+        D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
+        queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+        queryHeapDesc.Count = queryCount;
+        if (FAILED(m_device->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&m_queryHeap)))) return Fail("Failed to create the timestamp query heap");
+        if (!CreateBuffer(m_device, queryCount * sizeof(UINT64), D3D12_HEAP_TYPE_READBACK, D3D12_RESOURCE_STATE_COPY_DEST, &m_queryReadback)) return Fail("Failed to create the timestamp readback buffer");
+        m_queryCount = queryCount;
+    }
+
+    d3d12::DDGIVolume volume;
+    bool result = CreateVolume(config, volume) && UploadRayData(config, volume);
+
+    // Warm up the caches and clocks (the warmup iterations reuse the first iteration's queries)
+    if (result && warmup > 0)
+    {
+        result = BeginCommands();
+        for (int i = 0; result && i < warmup; i++) result = RecordKernels(volume, 0);
+        result = result && SubmitAndWait();
+    }
+
+    // Record every timed iteration in one command list so submission gaps do not land between kernels
+    if (result)
+    {
+        result = BeginCommands();
+        for (UINT i = 0; result && i < (UINT)iterations; i++) result = RecordKernels(volume, i * queriesPerIteration);
+        if (result)
+        {
+            m_cmdList->ResolveQueryData(m_queryHeap, D3D12_QUERY_TYPE_TIMESTAMP, 0, queryCount, m_queryReadback, 0);
+            result = SubmitAndWait();
+        }
+    }
+
+    if (result)
+    {
+        UINT64* pTimestamps = nullptr;
+        D3D12_RANGE readRange = { 0, queryCount * sizeof(UINT64) };
+        if (FAILED(m_queryReadback->Map(0, &readRange, reinterpret_cast<void**>(&pTimestamps)))) result = Fail("Failed to map the timestamp readback buffer");
+        else
+        {
+            const double ticksToMs = 1000.0 / (double)m_timestampFrequency;
+            for (UINT kernel = 0; kernel < (UINT)EKernel::Count; kernel++)
+            {
+                std::vector<double> samples(iterations);
+                for (UINT i = 0; i < (UINT)iterations; i++)
+                {
+                    UINT query = (i * queriesPerIteration) + (kernel * 2);
+                    UINT64 begin = pTimestamps[query];
+                    UINT64 end = pTimestamps[query + 1];
+                    samples[i] = (end > begin) ? (double)(end - begin) * ticksToMs : 0.0;
+                }
+                std::sort(samples.begin(), samples.end());
+
+                KernelTiming timing;
+                timing.kernel = (EKernel)kernel;
+                timing.minMs = samples.front();
+                timing.medianMs = (iterations % 2) ? samples[iterations / 2] : 0.5 * (samples[iterations / 2 - 1] + samples[iterations / 2]);
+
+                double sum = 0.0;
+                for (double sample : samples) sum += sample;
+                timing.meanMs = sum / (double)iterations;
+
+                double variance = 0.0;
+                for (double sample : samples) variance += (sample - timing.meanMs) * (sample - timing.meanMs);
+                timing.stdDevMs = std::sqrt(variance / (double)iterations);
+
+                timings.push_back(timing);
+            }
+
+            D3D12_RANGE writeRange = { 0, 0 };
+            m_queryReadback->Unmap(0, &writeRange);
+        }
+    }
+
+    DestroyVolume(volume);
+    return result;
+}
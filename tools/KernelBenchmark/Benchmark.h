@@ -0,0 +1,132 @@
+/*
+ * SDK kernel benchmark
+ * Times the RTXGI SDK probe update kernels on synthetic DDGIVolumes with D3D12 timestamp queries
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include <d3d12.h>
+#include <dxgi1_6.h>
+
+#include <rtxgi/ddgi/gfx/DDGIVolume_D3D12.h>
+
+#include "Compiler.h"
+
+// The SDK entry points that are timed, in the order the test harness records them
+enum class EKernel
+{
+    ProbeBlending = 0,      // UpdateDDGIVolumeProbes() (irradiance and distance blending)
+    ProbeRelocation,        // RelocateDDGIVolumeProbes()
+    ProbeClassification,    // ClassifyDDGIVolumeProbes()
+    Reduction,              // CalculateDDGIVolumeVariability()
+    Count
+};
+
+// Synthetic probe ray data written to the ray data texture before timing
+enum class ERayPattern
+{
+    Sky = 0,                // Every ray misses
+    Constant,               // Every ray hits a front face at half the probe spacing with the same radiance
+    Noise,                  // Hashed radiance and hit distances, some misses, and backface heavy probes
+    Backface,               // Every ray hits a backface (all probes read as inside geometry)
+    Count
+};
+
+const char* GetKernelName(EKernel kernel);
+const char* GetRayPatternName(ERayPattern pattern);
+const char* GetTextureFormatName(rtxgi::EDDGIVolumeTextureFormat format);
+
+struct BenchmarkConfig
+{
+    rtxgi::int3 probeCounts = { 16, 8, 16 };
+    int numRays = 256;
+    rtxgi::EDDGIVolumeTextureFormat rayDataFormat = rtxgi::EDDGIVolumeTextureFormat::F32x2;
+    rtxgi::EDDGIVolumeTextureFormat irradianceFormat = rtxgi::EDDGIVolumeTextureFormat::U32;
+    rtxgi::EDDGIVolumeTextureFormat distanceFormat = rtxgi::EDDGIVolumeTextureFormat::F16x2;
+    int sharedMemory = 0;           // 0: off, 1: RTXGI_DDGI_BLEND_SHARED_MEMORY, 2: RTXGI_DDGI_BLEND_SHARED_MEMORY_TILED
+    ERayPattern pattern = ERayPattern::Noise;
+};
+
+struct KernelTiming
+{
+    EKernel kernel = EKernel::ProbeBlending;
+    double medianMs = 0.0;
+    double minMs = 0.0;
+    double meanMs = 0.0;
+    double stdDevMs = 0.0;
+};
+
+class Benchmark
+{
+public:
+    Benchmark() = default;
+    ~Benchmark() { Cleanup(); }
+
+    bool Initialize(const std::string& projectRoot, int adapterIndex, bool stableClocks);
+    void Cleanup();
+
+    // Creates a volume for the config, runs the warmup and timed iterations, and returns one timing per kernel
+    bool Run(const BenchmarkConfig& config, int warmup, int iterations, std::vector<KernelTiming>& timings);
+
+    const std::string& GetAdapterName() const { return m_adapterName; }
+    const std::string& GetError() const { return m_error; }
+
+private:
+    struct VolumeShaders
+    {
+        const std::vector<uint8_t>* blendingIrradiance = nullptr;
+        const std::vector<uint8_t>* blendingDistance = nullptr;
+        const std::vector<uint8_t>* relocation = nullptr;
+        const std::vector<uint8_t>* relocationReset = nullptr;
+        const std::vector<uint8_t>* classification = nullptr;
+        const std::vector<uint8_t>* classificationReset = nullptr;
+        const std::vector<uint8_t>* reduction = nullptr;
+        const std::vector<uint8_t>* extraReduction = nullptr;
+    };
+
+    bool Fail(const std::string& message) { m_error = message; return false; }
+
+    const std::vector<uint8_t>* GetShader(const std::string& file, const std::string& entryPoint, const std::vector<std::string>& defines);
+    bool CompileShaders(const rtxgi::DDGIVolumeDesc& desc, int sharedMemory, VolumeShaders& shaders);
+
+    bool CreateVolume(const BenchmarkConfig& config, rtxgi::d3d12::DDGIVolume& volume);
+    bool UploadRayData(const BenchmarkConfig& config, rtxgi::d3d12::DDGIVolume& volume);
+    bool RecordKernels(rtxgi::d3d12::DDGIVolume& volume, UINT queryOffset);
+    void DestroyVolume(rtxgi::d3d12::DDGIVolume& volume);
+
+    bool BeginCommands();
+    bool SubmitAndWait();
+
+    Compiler m_compiler;
+    std::string m_projectRoot;
+    std::map<std::string, std::vector<uint8_t>> m_shaderCache;  // Bytecode by file, entry point, and defines
+
+    IDXGIFactory6* m_factory = nullptr;
+    IDXGIAdapter1* m_adapter = nullptr;
+    ID3D12Device* m_device = nullptr;
+    ID3D12CommandQueue* m_queue = nullptr;
+    ID3D12CommandAllocator* m_cmdAlloc = nullptr;
+    ID3D12GraphicsCommandList* m_cmdList = nullptr;
+    ID3D12Fence* m_fence = nullptr;
+    HANDLE m_fenceEvent = nullptr;
+    UINT64 m_fenceValue = 0;
+
+    ID3D12QueryHeap* m_queryHeap = nullptr;
+    ID3D12Resource* m_queryReadback = nullptr;
+    UINT m_queryCount = 0;
+    UINT64 m_timestampFrequency = 0;
+
+    // Per volume resources
+    ID3D12DescriptorHeap* m_resourceHeap = nullptr;
+    ID3D12Resource* m_constantsBuffer = nullptr;
+    ID3D12Resource* m_constantsBufferUpload = nullptr;
+    ID3D12Resource* m_rayDataUpload = nullptr;
+
+    UINT m_waveLaneCount = 32;
+    std::string m_adapterName;
+    std::string m_error;
+};
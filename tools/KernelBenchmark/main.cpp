@@ -0,0 +1,362 @@
+/*
+ * SDK Kernel Benchmark Tool
+ *
+ * Times the RTXGI SDK probe update kernels (D3D12):
+ * - ProbeBlendingCS (irradiance and distance, as dispatched by UpdateDDGIVolumeProbes)
+ * - ProbeRelocationCS, ProbeClassificationCS, and ReductionCS
+ * on synthetic volumes filled with known ray data patterns, across probe counts,
+ * ray counts, texture formats, and shared memory blending modes.
+ *
+ * Shaders are compiled from rtxgi-sdk/shaders with the SDK in Managed Resource Mode.
+ * Each kernel is bracketed by timestamp queries (and global UAV barriers) and the
+ * timed iterations are recorded in one command list.
+ *
+ * Usage:
+ *   KernelBenchmark [options]
+ *
+ * Options:
+ *   --root <dir>                  Repository root (default: current directory)
+ *   --probes <XxYxZ,...>          Probe counts (default: 8x4x8,16x8x16,32x8x32)
+ *   --rays <n,...>                Rays per probe (default: 128,256,512)
+ *   --ray-formats <f,...>         Ray data formats: F32x2, F32x4 (default: F32x2)
+ *   --irradiance-formats <f,...>  Irradiance formats: U32, F16x4, F32x4 (default: U32)
+ *   --distance-formats <f,...>    Distance formats: F16x2, F32x2 (default: F16x2)
+ *   --shared-memory <0|1|2,...>   0: off, 1: RTXGI_DDGI_BLEND_SHARED_MEMORY, 2: RTXGI_DDGI_BLEND_SHARED_MEMORY_TILED (default: 0,1)
+ *   --patterns <p,...>            Ray data patterns: sky, constant, noise, backface (default: noise)
+ *   --warmup <n>                  Untimed iterations per configuration (default: 16)
+ *   --iterations <n>              Timed iterations per configuration (default: 64)
+ *   --adapter <n>                 DXGI adapter index (default: 0)
+ *   --stable-clocks               Lock the GPU clocks with SetStablePowerState (requires developer mode)
+ *   --csv <path>                  Also write the results to a CSV file
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+#include "Benchmark.h"
+
+// Agility SDK
+extern "C" { __declspec(dllexport) extern const UINT D3D12SDKVersion = 606; }
+extern "C" { __declspec(dllexport) extern const char* D3D12SDKPath = u8".\\D3D12\\"; }
+
+using namespace rtxgi;
+
+struct Options
+{
+    std::string root = ".";
+    std::vector<int3> probeCounts = { { 8, 4, 8 }, { 16, 8, 16 }, { 32, 8, 32 } };
+    std::vector<int> rayCounts = { 128, 256, 512 };
+    std::vector<EDDGIVolumeTextureFormat> rayDataFormats = { EDDGIVolumeTextureFormat::F32x2 };
+    std::vector<EDDGIVolumeTextureFormat> irradianceFormats = { EDDGIVolumeTextureFormat::U32 };
+    std::vector<EDDGIVolumeTextureFormat> distanceFormats = { EDDGIVolumeTextureFormat::F16x2 };
+    std::vector<int> sharedMemory = { 0, 1 };
+    std::vector<ERayPattern> patterns = { ERayPattern::Noise };
+    int warmup = 16;
+    int iterations = 64;
+    int adapter = 0;
+    bool stableClocks = false;
+    std::string csvPath;
+};
+
+std::vector<std::string> Split(const std::string& value)
+{
+    std::vector<std::string> parts;
+    std::stringstream stream(value);
+    std::string part;
+    while (std::getline(stream, part, ',')) if (!part.empty()) parts.push_back(part);
+    return parts;
+}
+
+bool ParseProbeCounts(const std::string& value, std::vector<int3>& counts)
+{
+    counts.clear();
+    for (const std::string& part : Split(value))
+    {
+        int3 count;
+        char x0, x1;
+        std::stringstream stream(part);
+        if (!(stream >> count.x >> x0 >> count.y >> x1 >> count.z) || x0 != 'x' || x1 != 'x') return false;
+        if (count.x <= 0 || count.y <= 0 || count.z <= 0) return false;
+        counts.push_back(count);
+    }
+    return !counts.empty();
+}
+
+bool ParseInts(const std::string& value, std::vector<int>& ints)
+{
+    ints.clear();
+    for (const std::string& part : Split(value))
+    {
+        try { ints.push_back(std::stoi(part)); }
+        catch (...) { return false; }
+    }
+    return !ints.empty();
+}
+
+bool ParseFormats(const std::string& value, std::vector<EDDGIVolumeTextureFormat>& formats)
+{
+    formats.clear();
+    for (const std::string& part : Split(value))
+    {
+        bool found = false;
+        for (int format = 0; format < (int)EDDGIVolumeTextureFormat::Count; format++)
+        {
+            if (part == GetTextureFormatName((EDDGIVolumeTextureFormat)format))
+            {
+                formats.push_back((EDDGIVolumeTextureFormat)format);
+                found = true;
+            }
+        }
+        if (!found) return false;
+    }
+    return !formats.empty();
+}
+
+bool ParsePatterns(const std::string& value, std::vector<ERayPattern>& patterns)
+{
+    patterns.clear();
+    for (const std::string& part : Split(value))
+    {
+        bool found = false;
+        for (int pattern = 0; pattern < (int)ERayPattern::Count; pattern++)
+        {
+            if (part == GetRayPatternName((ERayPattern)pattern))
+            {
+                patterns.push_back((ERayPattern)pattern);
+                found = true;
+            }
+        }
+        if (!found) return false;
+    }
+    return !patterns.empty();
+}
+
+bool ParseArgs(int argc, char* argv[], Options& opts)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool valid = true;
+
+        if (arg == "--root" && i + 1 < argc)
+        {
+            opts.root = argv[++i];
+        }
+        else if (arg == "--probes" && i + 1 < argc)
+        {
+            valid = ParseProbeCounts(argv[++i], opts.probeCounts);
+        }
+        else if (arg == "--rays" && i + 1 < argc)
+        {
+            valid = ParseInts(argv[++i], opts.rayCounts);
+        }
+        else if (arg == "--ray-formats" && i + 1 < argc)
+        {
+            valid = ParseFormats(argv[++i], opts.rayDataFormats);
+        }
+        else if (arg == "--irradiance-formats" && i + 1 < argc)
+        {
+            valid = ParseFormats(argv[++i], opts.irradianceFormats);
+        }
+        else if (arg == "--distance-formats" && i + 1 < argc)
+        {
+            valid = ParseFormats(argv[++i], opts.distanceFormats);
+        }
+        else if (arg == "--shared-memory" && i + 1 < argc)
+        {
+            valid = ParseInts(argv[++i], opts.sharedMemory);
+        }
+        else if (arg == "--patterns" && i + 1 < argc)
+        {
+            valid = ParsePatterns(argv[++i], opts.patterns);
+        }
+        else if (arg == "--warmup" && i + 1 < argc)
+        {
+            opts.warmup = std::atoi(argv[++i]);
+        }
+        else if (arg == "--iterations" && i + 1 < argc)
+        {
+            opts.iterations = std::atoi(argv[++i]);
+        }
+        else if (arg == "--adapter" && i + 1 < argc)
+        {
+            opts.adapter = std::atoi(argv[++i]);
+        }
+        else if (arg == "--stable-clocks")
+        {
+            opts.stableClocks = true;
+        }
+        else if (arg == "--csv" && i + 1 < argc)
+        {
+            opts.csvPath = argv[++i];
+        }
+        else if (arg == "--help" || arg == "-h")
+        {
+            return false;
+        }
+        else
+        {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            return false;
+        }
+
+        if (!valid)
+        {
+            std::cerr << "Invalid value for " << arg << ": " << argv[i] << std::endl;
+            return false;
+        }
+    }
+
+    if (opts.iterations <= 0)
+    {
+        std::cerr << "--iterations must be at least 1" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void PrintUsage()
+{
+    std::cout << "Usage: KernelBenchmark [options]\n"
+              << "\n"
+              << "Options:\n"
+              << "  --root <dir>                  Repository root (default: current directory)\n"
+              << "  --probes <XxYxZ,...>          Probe counts (default: 8x4x8,16x8x16,32x8x32)\n"
+              << "  --rays <n,...>                Rays per probe (default: 128,256,512)\n"
+              << "  --ray-formats <f,...>         Ray data formats: F32x2, F32x4 (default: F32x2)\n"
+              << "  --irradiance-formats <f,...>  Irradiance formats: U32, F16x4, F32x4 (default: U32)\n"
+              << "  --distance-formats <f,...>    Distance formats: F16x2, F32x2 (default: F16x2)\n"
+              << "  --shared-memory <0|1|2,...>   0: off, 1: RTXGI_DDGI_BLEND_SHARED_MEMORY, 2: RTXGI_DDGI_BLEND_SHARED_MEMORY_TILED (default: 0,1)\n"
+              << "  --patterns <p,...>            Ray data patterns: sky, constant, noise, backface (default: noise)\n"
+              << "  --warmup <n>                  Untimed iterations per configuration (default: 16)\n"
+              << "  --iterations <n>              Timed iterations per configuration (default: 64)\n"
+              << "  --adapter <n>                 DXGI adapter index (default: 0)\n"
+              << "  --stable-clocks               Lock the GPU clocks with SetStablePowerState (requires developer mode)\n"
+              << "  --csv <path>                  Also write the results to a CSV file\n";
+}
+
+std::string ProbeCountsToString(const int3& counts)
+{
+    return std::to_string(counts.x) + "x" + std::to_string(counts.y) + "x" + std::to_string(counts.z);
+}
+
+int main(int argc, char* argv[])
+{
+    Options opts;
+    if (!ParseArgs(argc, argv, opts))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    Benchmark benchmark;
+    if (!benchmark.Initialize(std::filesystem::absolute(opts.root).string(), opts.adapter, opts.stableClocks))
+    {
+        std::cerr << "Error: " << benchmark.GetError() << std::endl;
+        return 1;
+    }
+
+    std::ofstream csv;
+    if (!opts.csvPath.empty())
+    {
+        csv.open(opts.csvPath);
+        if (!csv.is_open())
+        {
+            std::cerr << "Error: failed to open " << opts.csvPath << std::endl;
+            return 1;
+        }
+        csv << std::fixed;
+        csv << "kernel,probes,probe_count,rays,ray_format,irradiance_format,distance_format,shared_memory,pattern,median_ms,min_ms,mean_ms,stddev_ms,ns_per_probe\n";
+    }
+
+    std::cout << "Adapter: " << benchmark.GetAdapterName() << "\n";
+    std::cout << "Warmup: " << opts.warmup << ", iterations: " << opts.iterations << (opts.stableClocks ? ", stable clocks" : "") << "\n\n";
+
+    std::cout << std::left
+              << std::setw(22) << "Kernel"
+              << std::setw(11) << "Probes"
+              << std::setw(6) << "Rays"
+              << std::setw(8) << "RayData"
+              << std::setw(8) << "Irrad"
+              << std::setw(8) << "Dist"
+              << std::setw(5) << "SMem"
+              << std::setw(10) << "Pattern"
+              << std::right
+              << std::setw(12) << "Median(ms)"
+              << std::setw(10) << "Min(ms)"
+              << std::setw(10) << "Mean(ms)"
+              << std::setw(10) << "Dev(ms)"
+              << std::setw(10) << "ns/probe"
+              << "\n" << std::string(130, '-') << "\n";
+
+    int failures = 0;
+    std::vector<KernelTiming> timings;
+    for (const int3& probeCounts : opts.probeCounts)
+    for (int numRays : opts.rayCounts)
+    for (EDDGIVolumeTextureFormat rayDataFormat : opts.rayDataFormats)
+    for (EDDGIVolumeTextureFormat irradianceFormat : opts.irradianceFormats)
+    for (EDDGIVolumeTextureFormat distanceFormat : opts.distanceFormats)
+    for (int sharedMemory : opts.sharedMemory)
+    for (ERayPattern pattern : opts.patterns)
+    {
+        BenchmarkConfig config;
+        config.probeCounts = probeCounts;
+        config.numRays = numRays;
+        config.rayDataFormat = rayDataFormat;
+        config.irradianceFormat = irradianceFormat;
+        config.distanceFormat = distanceFormat;
+        config.sharedMemory = sharedMemory;
+        config.pattern = pattern;
+
+        std::string probes = ProbeCountsToString(probeCounts);
+        if (!benchmark.Run(config, opts.warmup, opts.iterations, timings))
+        {
+            std::cerr << "Failed " << probes << ", " << numRays << " rays: " << benchmark.GetError() << std::endl;
+            failures++;
+            continue;
+        }
+
+        const int numProbes = probeCounts.x * probeCounts.y * probeCounts.z;
+        for (const KernelTiming& timing : timings)
+        {
+            double nsPerProbe = (timing.medianMs * 1e6) / (double)numProbes;
+
+            std::cout << std::left
+                      << std::setw(22) << GetKernelName(timing.kernel)
+                      << std::setw(11) << probes
+                      << std::setw(6) << numRays
+                      << std::setw(8) << GetTextureFormatName(rayDataFormat)
+                      << std::setw(8) << GetTextureFormatName(irradianceFormat)
+                      << std::setw(8) << GetTextureFormatName(distanceFormat)
+                      << std::setw(5) << sharedMemory
+                      << std::setw(10) << GetRayPatternName(pattern)
+                      << std::right << std::fixed << std::setprecision(4)
+                      << std::setw(12) << timing.medianMs
+                      << std::setw(10) << timing.minMs
+                      << std::setw(10) << timing.meanMs
+                      << std::setw(10) << timing.stdDevMs
+                      << std::setprecision(1)
+                      << std::setw(10) << nsPerProbe
+                      << "\n";
+
+            if (csv.is_open())
+            {
+                csv << GetKernelName(timing.kernel) << "," << probes << "," << numProbes << "," << numRays << ","
+                    << GetTextureFormatName(rayDataFormat) << "," << GetTextureFormatName(irradianceFormat) << "," << GetTextureFormatName(distanceFormat) << ","
+                    << sharedMemory << "," << GetRayPatternName(pattern) << ","
+                    << std::setprecision(6) << timing.medianMs << "," << timing.minMs << "," << timing.meanMs << "," << timing.stdDevMs << ","
+                    << std::setprecision(2) << nsPerProbe << "\n";
+            }
+        }
+        std::cout << std::flush;
+    }
+
+    if (failures > 0) std::cerr << failures << " configuration(s) failed" << std::endl;
+    return (failures > 0) ? 1 : 0;
+}
@@ -0,0 +1,8 @@
+/*
+ * BinaryStore implementation
+ */
+
+#include "BinaryStore.h"
+
+// Implementation is header-only for simplicity
+// This file exists for build system compatibility
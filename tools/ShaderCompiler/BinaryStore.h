@@ -0,0 +1,112 @@
+/*
+ * Content-addressed shader binary store
+ * Compiled DXIL/SPIR-V keyed by shader hash, compiler version, and profile,
+ * in a directory that can be shared between machines (e.g. a network share)
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <filesystem>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <system_error>
+
+#include "Hash.h"
+
+class BinaryStore
+{
+public:
+    BinaryStore() = default;
+
+    bool Initialize(const std::string& storeDir)
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(storeDir, ec);
+        if (!std::filesystem::is_directory(storeDir, ec))
+        {
+            m_lastError = "Failed to create shader store directory: " + storeDir;
+            return false;
+        }
+
+        m_storeDir = storeDir;
+        return true;
+    }
+
+    bool IsEnabled() const { return !m_storeDir.empty(); }
+
+    // The key covers everything that changes the output: sources, includes, defines, entry point (the shader hash), compiler, and profile
+    std::string GetKey(const std::string& shaderHash, const std::string& compilerVersion, const std::string& profile) const
+    {
+        uint64_t key = Hash::FNV1a(shaderHash);
+        key = Hash::Combine(key, Hash::FNV1a(compilerVersion));
+        key = Hash::Combine(key, Hash::FNV1a(profile));
+        return Hash::ToHexString(key);
+    }
+
+    // Copy a stored binary to outputPath, returns false when the store does not have it
+    bool Fetch(const std::string& key, const std::string& extension, const std::string& outputPath) const
+    {
+        if (!IsEnabled()) return false;
+
+        std::error_code ec;
+        std::filesystem::path source = GetPath(key, extension);
+        if (!std::filesystem::exists(source, ec)) return false;
+
+        std::filesystem::create_directories(std::filesystem::path(outputPath).parent_path(), ec);
+        return std::filesystem::copy_file(source, outputPath, std::filesystem::copy_options::overwrite_existing, ec) && !ec;
+    }
+
+    // Add a binary to the store. Writes go to a temporary file that is renamed into place, so
+    // concurrent writers (threads or machines) and readers never see a partial binary.
+    bool Store(const std::string& key, const std::string& extension, const std::vector<uint8_t>& bytecode) const
+    {
+        if (!IsEnabled()) return false;
+
+        std::error_code ec;
+        std::filesystem::path target = GetPath(key, extension);
+        if (std::filesystem::exists(target, ec)) return true;  // Same key, same binary
+
+        std::filesystem::create_directories(target.parent_path(), ec);
+
+        std::filesystem::path temp = target;
+        temp += "." + GetUniqueSuffix() + ".tmp";
+        {
+            std::ofstream file(temp, std::ios::binary);
+            if (!file.is_open()) return false;
+            file.write(reinterpret_cast<const char*>(bytecode.data()), bytecode.size());
+            if (!file.good()) return false;
+        }
+
+        std::filesystem::rename(temp, target, ec);
+        if (ec)
+        {
+            // Another writer won the race (or the rename is not supported), keep theirs
+            std::filesystem::remove(temp, ec);
+            return std::filesystem::exists(target, ec);
+        }
+        return true;
+    }
+
+    std::string GetLastError() const { return m_lastError; }
+
+private:
+    std::string m_storeDir;
+    std::string m_lastError;
+
+    // Binaries are spread over 256 subdirectories by the first two characters of the key
+    std::filesystem::path GetPath(const std::string& key, const std::string& extension) const
+    {
+        return std::filesystem::path(m_storeDir) / key.substr(0, 2) / (key + "." + extension);
+    }
+
+    std::string GetUniqueSuffix() const
+    {
+        uint64_t value = std::hash<std::thread::id>()(std::this_thread::get_id());
+        value = Hash::Combine(value, (uint64_t)std::chrono::high_resolution_clock::now().time_since_epoch().count());
+        return Hash::ToHexString(value);
+    }
+};
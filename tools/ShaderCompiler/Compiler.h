@@ -142,6 +142,33 @@ public:
         return CompileInternal(sourcePath, entryPoint, profile, defines, includeDirs, true);
     }
 
+    // Disassemble a DXIL binary to its LLVM IR text
+    bool Disassemble(const std::vector<uint8_t>& bytecode, std::string& text)
+    {
+        if (!m_initialized || bytecode.empty()) return false;
+
+        DxcBuffer buffer;
+        buffer.Ptr = bytecode.data();
+        buffer.Size = bytecode.size();
+        buffer.Encoding = 0;
+
+        IDxcResult* result = nullptr;
+        if (FAILED(m_compiler->Disassemble(&buffer, IID_PPV_ARGS(&result))))
+        {
+            return false;
+        }
+
+        IDxcBlobUtf8* disassembly = nullptr;
+        result->GetOutput(DXC_OUT_DISASSEMBLY, IID_PPV_ARGS(&disassembly), nullptr);
+        if (disassembly)
+        {
+            text.assign(disassembly->GetStringPointer(), disassembly->GetStringLength());
+            disassembly->Release();
+        }
+        result->Release();
+        return !text.empty();
+    }
+
     bool SaveBytecode(const std::vector<uint8_t>& bytecode, const std::string& outputPath)
     {
         // Create output directory if needed
@@ -0,0 +1,94 @@
+/*
+ * Test harness notifier implementation
+ */
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+
+#include "HarnessNotifier.h"
+
+bool HarnessNotifier::Initialize(uint16_t port)
+{
+    Cleanup();
+
+#ifdef _WIN32
+    WSADATA data;
+    if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+    {
+        m_lastError = "Failed to initialize Windows sockets";
+        return false;
+    }
+
+    SOCKET s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s == INVALID_SOCKET)
+    {
+        WSACleanup();
+        m_lastError = "Failed to create the notification socket";
+        return false;
+    }
+    m_socket = static_cast<intptr_t>(s);
+#else
+    int s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s < 0)
+    {
+        m_lastError = "Failed to create the notification socket";
+        return false;
+    }
+    m_socket = s;
+#endif
+
+    m_port = port;
+    return true;
+}
+
+bool HarnessNotifier::Send(const std::vector<std::string>& sourcePaths)
+{
+    if (!IsEnabled()) return false;
+
+    std::string message = "ShaderCompiler\n";
+    for (const std::string& path : sourcePaths)
+    {
+        message += path + "\n";
+    }
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(m_port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+#ifdef _WIN32
+    int sent = sendto(static_cast<SOCKET>(m_socket), message.data(), static_cast<int>(message.size()), 0, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+#else
+    ssize_t sent = sendto(static_cast<int>(m_socket), message.data(), message.size(), 0, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+#endif
+    if (sent != static_cast<decltype(sent)>(message.size()))
+    {
+        m_lastError = "Failed to send the notification to port " + std::to_string(m_port);
+        return false;
+    }
+    return true;
+}
+
+void HarnessNotifier::Cleanup()
+{
+    if (m_socket < 0) return;
+
+#ifdef _WIN32
+    closesocket(static_cast<SOCKET>(m_socket));
+    WSACleanup();
+#else
+    close(static_cast<int>(m_socket));
+#endif
+    m_socket = -1;
+    m_port = 0;
+}
@@ -0,0 +1,38 @@
+/*
+ * Test harness notifier for the watch mode
+ * Sends the source paths of the rebuilt shaders to a running test harness as a UDP datagram on the
+ * loopback interface (config shaders.watchPort), the harness reloads the workloads using them.
+ * Nothing listening is not an error, the datagram is dropped.
+ *
+ * Message: "ShaderCompiler\n" followed by one manifest relative source path per line
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class HarnessNotifier
+{
+public:
+    HarnessNotifier() = default;
+    ~HarnessNotifier() { Cleanup(); }
+
+    HarnessNotifier(const HarnessNotifier&) = delete;
+    HarnessNotifier& operator=(const HarnessNotifier&) = delete;
+
+    // Implemented in HarnessNotifier.cpp, the socket headers stay out of the other headers
+    // (on Windows, windows.h included before winsock2.h declares the old sockets API)
+    bool Initialize(uint16_t port);
+    bool Send(const std::vector<std::string>& sourcePaths);
+    void Cleanup();
+
+    bool IsEnabled() const { return m_port != 0; }
+    const std::string& GetLastError() const { return m_lastError; }
+
+private:
+    intptr_t m_socket = -1;
+    uint16_t m_port = 0;
+    std::string m_lastError;
+};
@@ -11,6 +11,8 @@
 #include <fstream>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <functional>
 
 namespace Hash
 {
@@ -77,25 +79,100 @@ namespace Hash
         return combined;
     }
 
+    // The part of a source file one compile target sees. Lines in branches of #ifdef __spirv__, #ifndef __spirv__,
+    // #if defined(__spirv__), and #if !defined(__spirv__) that the target doesn't take are dropped, so edits to
+    // D3D12 only code leave the SPIR-V view unchanged. Other conditionals (and all directive lines) are kept.
+    inline std::string GetTargetSource(const std::string& content, bool spirv)
+    {
+        if (content.find("__spirv__") == std::string::npos)
+        {
+            return content;
+        }
+
+        // One state per open conditional: 1 the target takes the branch, -1 it doesn't (but may take a later one),
+        // -2 it took an earlier branch, 0 unknown (kept)
+        std::vector<int> branches;
+        size_t inactive = 0;
+
+        std::string result;
+        std::istringstream lines(content);
+        std::string line;
+        while (std::getline(lines, line))
+        {
+            size_t start = line.find_first_not_of(" \t");
+            if (start == std::string::npos || line[start] != '#')
+            {
+                if (inactive == 0) result.append(line).append("\n");
+                continue;
+            }
+
+            // Split the directive from its condition, dropping whitespace from the condition
+            size_t nameStart = line.find_first_not_of(" \t", start + 1);
+            size_t nameEnd = (nameStart == std::string::npos) ? std::string::npos : line.find_first_of(" \t(!", nameStart);
+            std::string directive = (nameStart == std::string::npos) ? "" : line.substr(nameStart, nameEnd - nameStart);
+            std::string condition;
+            if (nameEnd != std::string::npos)
+            {
+                for (char c : line.substr(nameEnd))
+                {
+                    if (c != ' ' && c != '\t' && c != '\r') condition += c;
+                }
+                size_t comment = condition.find("//");
+                if (comment != std::string::npos) condition.resize(comment);
+            }
+
+            int state = 0;
+            if (directive == "ifdef" || directive == "ifndef" || directive == "if")
+            {
+                bool isSpirv = (directive == "ifdef" && condition == "__spirv__") || (directive == "if" && (condition == "defined(__spirv__)" || condition == "defined__spirv__"));
+                bool isD3D12 = (directive == "ifndef" && condition == "__spirv__") || (directive == "if" && (condition == "!defined(__spirv__)" || condition == "!defined__spirv__"));
+                if (isSpirv) state = spirv ? 1 : -1;
+                else if (isD3D12) state = spirv ? -1 : 1;
+                branches.push_back(state);
+                if (state < 0) inactive++;
+            }
+            else if (!branches.empty() && (directive == "else" || directive == "elif"))
+            {
+                int& top = branches.back();
+                if (top < 0) inactive--;
+                if (top == 1 || top == -2) top = -2;
+                else if (top == -1) top = (directive == "else") ? 1 : 0;  // An #elif condition is not evaluated
+                if (top < 0) inactive++;
+            }
+            else if (!branches.empty() && directive == "endif")
+            {
+                if (branches.back() < 0) inactive--;
+                branches.pop_back();
+            }
+
+            result.append(line).append("\n");
+        }
+        return result;
+    }
+
+    // Returns the content hash of a file (e.g. memoized by HashCache::GetFileHash)
+    using FileHashFunction = std::function<uint64_t(const std::string&)>;
+
     // Compute hash of shader with all dependencies
     inline std::string ComputeShaderHash(
         const std::string& sourcePath,
         const std::vector<std::string>& includePaths,
         const std::vector<std::string>& defines,
         const std::string& profile,
-        const std::string& entryPoint)
+        const std::string& entryPoint,
+        const FileHashFunction& hashFile = HashFile)
     {
         uint64_t hash = FNV_OFFSET_BASIS;
 
         // Hash source file
-        hash = Combine(hash, HashFile(sourcePath));
+        hash = Combine(hash, hashFile(sourcePath));
 
         // Hash all include files (sorted for determinism)
         std::vector<std::string> sortedIncludes = includePaths;
         std::sort(sortedIncludes.begin(), sortedIncludes.end());
         for (const auto& inc : sortedIncludes)
         {
-            hash = Combine(hash, HashFile(inc));
+            hash = Combine(hash, hashFile(inc));
         }
 
         // Hash defines (sorted)
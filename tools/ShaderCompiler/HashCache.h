@@ -1,6 +1,13 @@
 /*
  * Hash cache for incremental shader compilation
  * Stores shader hashes to detect changes
+ * The entry accessors are thread-safe (the compile threads update entries as shaders finish)
+ *
+ * Also memoizes the direct includes and content hash of every source and header file, keyed by
+ * path and validated by modification time and size, so unchanged files are not re-read between runs.
+ *
+ * The cache is saved in a compact binary format (see CacheHeader), saves append the changed records only.
+ * Caches in the JSON format of earlier versions are still loaded, and ExportJson() writes that format.
  */
 
 #pragma once
@@ -12,6 +19,11 @@
 #include <sstream>
 #include <regex>
 #include <filesystem>
+#include <mutex>
+#include <cstdint>
+#include <cstring>
+
+#include "Hash.h"
 
 struct ShaderCacheEntry
 {
@@ -21,9 +33,28 @@ struct ShaderCacheEntry
     std::vector<std::string> defines;
     std::string outputDxil;
     std::string outputSpirv;
+    std::string spirvHash;                  // Hash of the SPIR-V view of the sources, empty when the SPIR-V output is out of date
+    std::string dxilStats;                  // ShaderStats of the outputs (serialized), empty when unknown
+    std::string spirvStats;
     std::string lastCompiled;
 };
 
+struct FileCacheEntry
+{
+    int64_t mtime = 0;
+    uint64_t size = 0;
+    bool hasIncludes = false;
+    std::vector<std::string> includes;  // Resolved direct includes (absolute paths)
+    std::string hash;                   // Content hash (hex), empty when not computed
+    bool hasSpirvIncludes = false;
+    std::vector<std::string> spirvIncludes;  // Direct includes of the SPIR-V view (see Hash::GetTargetSource)
+    std::string spirvHash;              // Content hash of the SPIR-V view, empty when not computed
+
+    bool verified = false;              // Stamp checked against the file (not saved)
+    bool used = false;                  // Accessed this run (not saved)
+    bool changed = false;               // Modified since the previous run (not saved)
+};
+
 class HashCache
 {
 public:
@@ -34,28 +65,63 @@ public:
         m_compilerVersion = version;
     }
 
+    // Load the binary cache. A JSON cache (the format before the binary one) is read and converted by the next Save(),
+    // either at the given path or next to it (shader_cache.bin -> shader_cache.json).
     bool Load(const std::string& cachePath)
     {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
         m_cachePath = cachePath;
         m_entries.clear();
+        m_files.clear();
+        ResetRecords();
 
-        std::ifstream file(cachePath);
-        if (!file.is_open())
+        std::string content;
+        if (!ReadCacheFile(cachePath, content))
         {
-            return false;  // Cache doesn't exist yet
+            std::string jsonPath = std::filesystem::path(cachePath).replace_extension(".json").string();
+            if (jsonPath == cachePath || !ReadCacheFile(jsonPath, content))
+            {
+                return false;  // Cache doesn't exist yet
+            }
         }
 
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        std::string content = buffer.str();
-        file.close();
+        if (content.compare(0, sizeof(CacheMagic), CacheMagic, sizeof(CacheMagic)) == 0)
+        {
+            if (ParseBinary(content)) return true;
+
+            // Corrupt or from a newer tool, start over
+            m_entries.clear();
+            m_files.clear();
+            ResetRecords();
+            return false;
+        }
 
         return ParseJson(content);
     }
 
+    // Save the binary cache. Only the changed entries and file records are appended to the file, followed by new
+    // record tables and the header; the file is rewritten when it holds more superseded records than live ones.
     bool Save(const std::string& cachePath)
     {
-        std::ofstream file(cachePath);
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        bool appended = (cachePath == m_cachePath) && AppendBinary(cachePath);
+        if (!appended && !WriteBinary(cachePath))
+        {
+            return false;
+        }
+
+        m_cachePath = cachePath;
+        return true;
+    }
+
+    // Write the cache as JSON, for people and tools (the cache itself is saved in the binary format)
+    bool ExportJson(const std::string& jsonPath)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        std::ofstream file(jsonPath);
         if (!file.is_open())
         {
             return false;
@@ -93,6 +159,9 @@ public:
 
             file << "      \"output_dxil\": \"" << EscapePath(entry.outputDxil) << "\",\n";
             file << "      \"output_spirv\": \"" << EscapePath(entry.outputSpirv) << "\",\n";
+            file << "      \"spirv_hash\": \"" << entry.spirvHash << "\",\n";
+            file << "      \"dxil_stats\": \"" << entry.dxilStats << "\",\n";
+            file << "      \"spirv_stats\": \"" << entry.spirvStats << "\",\n";
             file << "      \"last_compiled\": \"" << entry.lastCompiled << "\"\n";
             file << "    }";
 
@@ -100,6 +169,47 @@ public:
             file << "\n";
         }
 
+        file << "  },\n";
+
+        // File records accessed this run (records of files no shader includes anymore are dropped)
+        std::vector<const std::pair<const std::string, FileCacheEntry>*> files;
+        for (const auto& record : m_files)
+        {
+            if (record.second.used) files.push_back(&record);
+        }
+
+        file << "  \"files\": {\n";
+        for (size_t f = 0; f < files.size(); ++f)
+        {
+            const std::string& path = files[f]->first;
+            const FileCacheEntry& entry = files[f]->second;
+
+            file << "    \"" << EscapePath(path) << "\": {\n";
+            file << "      \"mtime\": \"" << entry.mtime << "\",\n";
+            file << "      \"size\": \"" << entry.size << "\",\n";
+            file << "      \"hash\": \"" << entry.hash << "\",\n";
+            file << "      \"has_includes\": \"" << (entry.hasIncludes ? 1 : 0) << "\",\n";
+            file << "      \"includes\": [";
+            for (size_t i = 0; i < entry.includes.size(); ++i)
+            {
+                file << "\"" << EscapePath(entry.includes[i]) << "\"";
+                if (i < entry.includes.size() - 1) file << ", ";
+            }
+            file << "],\n";
+            file << "      \"spirv_hash\": \"" << entry.spirvHash << "\",\n";
+            file << "      \"has_spirv_includes\": \"" << (entry.hasSpirvIncludes ? 1 : 0) << "\",\n";
+            file << "      \"spirv_includes\": [";
+            for (size_t i = 0; i < entry.spirvIncludes.size(); ++i)
+            {
+                file << "\"" << EscapePath(entry.spirvIncludes[i]) << "\"";
+                if (i < entry.spirvIncludes.size() - 1) file << ", ";
+            }
+            file << "]\n";
+            file << "    }";
+
+            if (f + 1 < files.size()) file << ",";
+            file << "\n";
+        }
         file << "  }\n";
         file << "}\n";
 
@@ -109,6 +219,7 @@ public:
 
     bool IsUpToDate(const std::string& shaderName, const std::string& currentHash)
     {
+        std::lock_guard<std::mutex> lock(m_mutex);
         auto it = m_entries.find(shaderName);
         if (it == m_entries.end())
         {
@@ -130,8 +241,21 @@ public:
         return true;
     }
 
+    // Like IsUpToDate(), for the SPIR-V output and the hash of the SPIR-V view of the sources
+    bool IsSpirvUpToDate(const std::string& shaderName, const std::string& currentSpirvHash)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(shaderName);
+        if (it == m_entries.end() || it->second.spirvHash.empty() || it->second.spirvHash != currentSpirvHash)
+        {
+            return false;
+        }
+        return !it->second.outputSpirv.empty() && std::filesystem::exists(it->second.outputSpirv);
+    }
+
     std::string GetCachedHash(const std::string& shaderName)
     {
+        std::lock_guard<std::mutex> lock(m_mutex);
         auto it = m_entries.find(shaderName);
         if (it != m_entries.end())
         {
@@ -140,19 +264,36 @@ public:
         return "";
     }
 
+    // Get the statistics of a shader's previous DXIL (or SPIR-V) output
+    std::string GetCachedStats(const std::string& shaderName, bool spirv)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(shaderName);
+        if (it != m_entries.end())
+        {
+            return spirv ? it->second.spirvStats : it->second.dxilStats;
+        }
+        return "";
+    }
+
     bool HasEntry(const std::string& shaderName)
     {
+        std::lock_guard<std::mutex> lock(m_mutex);
         return m_entries.find(shaderName) != m_entries.end();
     }
 
     void UpdateEntry(const std::string& shaderName, const ShaderCacheEntry& entry)
     {
+        std::lock_guard<std::mutex> lock(m_mutex);
         m_entries[shaderName] = entry;
+        m_entryRecords.erase(shaderName);  // Written by the next save
     }
 
     void RemoveEntry(const std::string& shaderName)
     {
+        std::lock_guard<std::mutex> lock(m_mutex);
         m_entries.erase(shaderName);
+        m_entryRecords.erase(shaderName);
     }
 
     bool CompilerVersionChanged(const std::string& currentVersion)
@@ -160,10 +301,463 @@ public:
         return m_compilerVersion != currentVersion && !m_compilerVersion.empty();
     }
 
+    // Get the memoized direct includes of a file (or of its SPIR-V view), returns false if the file changed or was never parsed
+    bool GetFileIncludes(const std::string& path, std::vector<std::string>& includes, bool spirv = false)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        FileCacheEntry& entry = GetFileEntry(path);
+        if (!(spirv ? entry.hasSpirvIncludes : entry.hasIncludes)) return false;
+
+        includes = spirv ? entry.spirvIncludes : entry.includes;
+        return true;
+    }
+
+    void SetFileIncludes(const std::string& path, const std::vector<std::string>& includes, bool spirv = false)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        FileCacheEntry& entry = GetFileEntry(path);
+        m_fileRecords.erase(path);
+        if (spirv)
+        {
+            entry.spirvIncludes = includes;
+            entry.hasSpirvIncludes = true;
+        }
+        else
+        {
+            entry.includes = includes;
+            entry.hasIncludes = true;
+        }
+    }
+
+    // Get the content hash of a file (or of its SPIR-V view), reading the file only when it changed since the hash was stored
+    uint64_t GetFileHash(const std::string& path, bool spirv = false)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        FileCacheEntry& entry = GetFileEntry(path);
+        std::string& hash = spirv ? entry.spirvHash : entry.hash;
+        if (hash.empty())
+        {
+            hash = Hash::ToHexString(spirv ? Hash::FNV1a(Hash::GetTargetSource(Hash::ReadFile(path), true)) : Hash::HashFile(path));
+            m_fileRecords.erase(path);
+        }
+        return std::stoull(hash, nullptr, 16);
+    }
+
+    // Get the files accessed this run that were modified since the previous run
+    std::vector<std::string> GetChangedFiles()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<std::string> files;
+        for (const auto& record : m_files)
+        {
+            if (record.second.used && record.second.changed) files.push_back(record.first);
+        }
+        return files;
+    }
+
+    // Check the stamps of the file records again on their next access (e.g. before recompiling edited shaders)
+    void RevalidateFiles()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& record : m_files)
+        {
+            record.second.verified = false;
+        }
+    }
+
 private:
+    // Binary cache layout (little-endian):
+    //   CacheHeader
+    //   Records, 8 byte aligned: the compiler version, then shader entries and file records, each starting with its key
+    //   Record tables: {offset, size} of each shader entry, then of each file record, sorted by key (binary searchable)
+    // A save appends the new and changed records and new tables after the previous end, then updates the header.
+    // The records they supersede stay in the file until it is rewritten (when they outweigh the live records).
+    static constexpr char CacheMagic[8] = { 'S', 'H', 'C', 'A', 'C', 'H', 'E', 'B' };
+    static constexpr uint32_t CacheFormatVersion = 1;
+
+    struct CacheHeader
+    {
+        char magic[8];
+        uint32_t formatVersion;
+        uint32_t entryCount;
+        uint32_t fileCount;
+        uint32_t versionSize;           // Compiler version record
+        uint64_t versionOffset;
+        uint64_t entryTableOffset;
+        uint64_t fileTableOffset;
+        uint64_t garbage;               // Bytes of superseded records and tables
+        uint64_t end;                   // End of the last tables, the next save appends here
+    };
+    static_assert(sizeof(CacheHeader) == 64, "The cache header layout is part of the file format");
+
+    struct RecordLocation
+    {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+    };
+
+    struct BinaryWriter
+    {
+        std::string data;
+
+        void U8(uint8_t value) { data.push_back(static_cast<char>(value)); }
+        void U64(uint64_t value) { data.append(reinterpret_cast<const char*>(&value), sizeof(value)); }
+        void String(const std::string& value)
+        {
+            uint32_t size = static_cast<uint32_t>(value.size());
+            data.append(reinterpret_cast<const char*>(&size), sizeof(size));
+            data.append(value);
+        }
+        void Strings(const std::vector<std::string>& values)
+        {
+            U64(values.size());
+            for (const std::string& value : values) String(value);
+        }
+    };
+
+    struct BinaryReader
+    {
+        const char* data = nullptr;
+        uint64_t size = 0;
+        uint64_t position = 0;
+        bool ok = true;
+
+        BinaryReader(const std::string& content, RecordLocation location)
+        {
+            ok = (location.offset <= content.size() && location.size <= content.size() - location.offset);
+            if (ok) data = content.data() + location.offset;
+            if (ok) size = location.size;
+        }
+
+        bool Read(void* value, uint64_t bytes)
+        {
+            ok = ok && (bytes <= size - position);
+            if (ok) std::memcpy(value, data + position, bytes);
+            position += ok ? bytes : 0;
+            return ok;
+        }
+        uint8_t U8() { uint8_t value = 0; Read(&value, sizeof(value)); return value; }
+        uint64_t U64() { uint64_t value = 0; Read(&value, sizeof(value)); return value; }
+        std::string String()
+        {
+            uint32_t length = 0;
+            if (!Read(&length, sizeof(length)) || length > size - position) { ok = false; return ""; }
+            std::string value(data + position, length);
+            position += length;
+            return value;
+        }
+        std::vector<std::string> Strings()
+        {
+            uint64_t count = U64();
+            std::vector<std::string> values;
+            for (uint64_t i = 0; ok && i < count; ++i) values.push_back(String());
+            return values;
+        }
+    };
+
     std::map<std::string, ShaderCacheEntry> m_entries;
+    std::map<std::string, FileCacheEntry> m_files;
     std::string m_cachePath;
     std::string m_compilerVersion;
+    std::mutex m_mutex;
+
+    // Where the records unchanged since the last load or save are in the cache file, the others are written by the next save
+    std::map<std::string, RecordLocation> m_entryRecords;
+    std::map<std::string, RecordLocation> m_fileRecords;
+    RecordLocation m_versionRecord;
+    std::string m_savedCompilerVersion;
+    CacheHeader m_header = {};
+    bool m_hasHeader = false;           // m_header is the header of the file at m_cachePath
+
+    void ResetRecords()
+    {
+        m_entryRecords.clear();
+        m_fileRecords.clear();
+        m_versionRecord = RecordLocation();
+        m_savedCompilerVersion.clear();
+        m_header = {};
+        m_hasHeader = false;
+    }
+
+    static bool ReadCacheFile(const std::string& path, std::string& content)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) return false;
+
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        content = buffer.str();
+        return true;
+    }
+
+    static std::string SerializeEntry(const std::string& name, const ShaderCacheEntry& entry)
+    {
+        BinaryWriter writer;
+        writer.String(name);
+        writer.String(entry.hash);
+        writer.String(entry.sourcePath);
+        writer.Strings(entry.includes);
+        writer.Strings(entry.defines);
+        writer.String(entry.outputDxil);
+        writer.String(entry.outputSpirv);
+        writer.String(entry.spirvHash);
+        writer.String(entry.dxilStats);
+        writer.String(entry.spirvStats);
+        writer.String(entry.lastCompiled);
+        return writer.data;
+    }
+
+    static std::string SerializeFile(const std::string& path, const FileCacheEntry& entry)
+    {
+        BinaryWriter writer;
+        writer.String(path);
+        writer.U64(static_cast<uint64_t>(entry.mtime));
+        writer.U64(entry.size);
+        writer.String(entry.hash);
+        writer.U8(entry.hasIncludes ? 1 : 0);
+        writer.Strings(entry.includes);
+        writer.String(entry.spirvHash);
+        writer.U8(entry.hasSpirvIncludes ? 1 : 0);
+        writer.Strings(entry.spirvIncludes);
+        return writer.data;
+    }
+
+    bool ParseBinary(const std::string& content)
+    {
+        CacheHeader header;
+        if (content.size() < sizeof(header)) return false;
+        std::memcpy(&header, content.data(), sizeof(header));
+        if (header.formatVersion != CacheFormatVersion || header.end > content.size()) return false;
+
+        BinaryReader version(content, { header.versionOffset, header.versionSize });
+        m_compilerVersion = version.String();
+        if (!version.ok) return false;
+
+        m_savedCompilerVersion = m_compilerVersion;
+        m_versionRecord = { header.versionOffset, header.versionSize };
+
+        BinaryReader entryTable(content, { header.entryTableOffset, uint64_t(header.entryCount) * 16 });
+        for (uint32_t i = 0; i < header.entryCount && entryTable.ok; ++i)
+        {
+            RecordLocation location = { entryTable.U64(), entryTable.U64() };
+            BinaryReader reader(content, location);
+
+            std::string name = reader.String();
+            ShaderCacheEntry entry;
+            entry.hash = reader.String();
+            entry.sourcePath = reader.String();
+            entry.includes = reader.Strings();
+            entry.defines = reader.Strings();
+            entry.outputDxil = reader.String();
+            entry.outputSpirv = reader.String();
+            entry.spirvHash = reader.String();
+            entry.dxilStats = reader.String();
+            entry.spirvStats = reader.String();
+            entry.lastCompiled = reader.String();
+            if (!reader.ok) return false;
+
+            m_entries[name] = entry;
+            m_entryRecords[name] = location;
+        }
+
+        BinaryReader fileTable(content, { header.fileTableOffset, uint64_t(header.fileCount) * 16 });
+        for (uint32_t i = 0; i < header.fileCount && fileTable.ok; ++i)
+        {
+            RecordLocation location = { fileTable.U64(), fileTable.U64() };
+            BinaryReader reader(content, location);
+
+            std::string path = reader.String();
+            FileCacheEntry entry;
+            entry.mtime = static_cast<int64_t>(reader.U64());
+            entry.size = reader.U64();
+            entry.hash = reader.String();
+            entry.hasIncludes = (reader.U8() != 0);
+            entry.includes = reader.Strings();
+            entry.spirvHash = reader.String();
+            entry.hasSpirvIncludes = (reader.U8() != 0);
+            entry.spirvIncludes = reader.Strings();
+            if (!reader.ok) return false;
+
+            m_files[path] = entry;
+            m_fileRecords[path] = location;
+        }
+        if (!entryTable.ok || !fileTable.ok) return false;
+
+        m_header = header;
+        m_hasHeader = true;
+        return true;
+    }
+
+    // Serialize the records without a location in the file, and the record tables, to be written at offset.
+    // Returns false when nothing changed since the last save.
+    bool SerializeRecords(uint64_t offset, std::string& data, CacheHeader& header)
+    {
+        bool changed = false;
+        auto place = [&](const std::string& record)
+        {
+            RecordLocation location = { offset + data.size(), record.size() };
+            data += record;
+            data.append((8 - data.size() % 8) % 8, '\0');
+            changed = true;
+            return location;
+        };
+        auto aligned = [](uint64_t size) { return (size + 7) & ~uint64_t(7); };
+
+        if (m_versionRecord.size == 0 || m_savedCompilerVersion != m_compilerVersion)
+        {
+            BinaryWriter writer;
+            writer.String(m_compilerVersion);
+            m_versionRecord = place(writer.data);
+            m_savedCompilerVersion = m_compilerVersion;
+        }
+
+        for (auto it = m_entryRecords.begin(); it != m_entryRecords.end();)
+        {
+            bool removed = (m_entries.count(it->first) == 0);
+            changed |= removed;
+            it = removed ? m_entryRecords.erase(it) : std::next(it);
+        }
+        for (const auto& [name, entry] : m_entries)
+        {
+            if (m_entryRecords.count(name) == 0) m_entryRecords[name] = place(SerializeEntry(name, entry));
+        }
+
+        // File records accessed this run (records of files no shader includes anymore are dropped)
+        for (const auto& [path, entry] : m_files)
+        {
+            if (!entry.used) changed |= (m_fileRecords.erase(path) > 0);
+            else if (m_fileRecords.count(path) == 0) m_fileRecords[path] = place(SerializeFile(path, entry));
+        }
+
+        uint64_t live = sizeof(CacheHeader) + aligned(m_versionRecord.size) + (m_entryRecords.size() + m_fileRecords.size()) * 16;
+        BinaryWriter tables;
+        for (const auto& record : m_entryRecords)
+        {
+            tables.U64(record.second.offset);
+            tables.U64(record.second.size);
+            live += aligned(record.second.size);
+        }
+        for (const auto& record : m_fileRecords)
+        {
+            tables.U64(record.second.offset);
+            tables.U64(record.second.size);
+            live += aligned(record.second.size);
+        }
+
+        std::memcpy(header.magic, CacheMagic, sizeof(CacheMagic));
+        header.formatVersion = CacheFormatVersion;
+        header.entryCount = static_cast<uint32_t>(m_entryRecords.size());
+        header.fileCount = static_cast<uint32_t>(m_fileRecords.size());
+        header.versionOffset = m_versionRecord.offset;
+        header.versionSize = static_cast<uint32_t>(m_versionRecord.size);
+        header.entryTableOffset = offset + data.size();
+        header.fileTableOffset = header.entryTableOffset + m_entryRecords.size() * 16;
+        data += tables.data;
+        header.end = offset + data.size();
+        header.garbage = header.end - live;
+        return changed;
+    }
+
+    // Append the changed records to the cache file loaded or saved before, returns false when it has to be rewritten
+    bool AppendBinary(const std::string& cachePath)
+    {
+        if (!m_hasHeader || m_header.garbage > m_header.end / 2) return false;
+
+        std::fstream file(cachePath, std::ios::in | std::ios::out | std::ios::binary);
+        if (!file.is_open()) return false;
+
+        // Another process saved the cache since
+        CacheHeader current;
+        if (!file.read(reinterpret_cast<char*>(&current), sizeof(current)) || std::memcmp(&current, &m_header, sizeof(current)) != 0) return false;
+
+        std::string data;
+        CacheHeader header = {};
+        if (!SerializeRecords(m_header.end, data, header)) return true;
+
+        file.seekp(static_cast<std::streamoff>(m_header.end));
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        file.flush();
+        if (!file) return false;
+
+        // The header goes last, a save interrupted before it leaves the previous cache intact
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.flush();
+        if (!file) return false;
+
+        m_header = header;
+        return true;
+    }
+
+    // Write a new cache file with every record
+    bool WriteBinary(const std::string& cachePath)
+    {
+        ResetRecords();
+
+        std::string data;
+        CacheHeader header = {};
+        SerializeRecords(sizeof(CacheHeader), data, header);
+
+        std::string tempPath = cachePath + ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) return false;
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(data.data(), static_cast<std::streamsize>(data.size()));
+            if (!file) return false;
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tempPath, cachePath, ec);
+        if (ec)
+        {
+            std::filesystem::remove(tempPath, ec);
+            ResetRecords();
+            return false;
+        }
+
+        m_header = header;
+        m_hasHeader = true;
+        return true;
+    }
+
+    // Get a file's record, resetting it when the file's modification time or size changed (checked once until revalidated)
+    FileCacheEntry& GetFileEntry(const std::string& path)
+    {
+        FileCacheEntry& entry = m_files[path];
+        if (entry.verified) return entry;
+
+        std::error_code ec;
+        int64_t mtime = static_cast<int64_t>(std::filesystem::last_write_time(path, ec).time_since_epoch().count());
+        if (ec) mtime = 0;
+        uint64_t size = static_cast<uint64_t>(std::filesystem::file_size(path, ec));
+        if (ec) size = 0;
+
+        if (entry.mtime != mtime || entry.size != size)
+        {
+            bool recorded = (entry.mtime != 0);
+            entry = FileCacheEntry();
+            entry.mtime = mtime;
+            entry.size = size;
+            entry.changed = recorded;
+            m_fileRecords.erase(path);
+        }
+        entry.verified = true;
+        entry.used = true;
+        return entry;
+    }
+
+    std::string UnescapePath(const std::string& path)
+    {
+        std::string result;
+        for (size_t i = 0; i < path.size(); ++i)
+        {
+            if (path[i] == '\\' && i + 1 < path.size() && path[i + 1] == '\\') ++i;
+            result += path[i];
+        }
+        return result;
+    }
 
     std::string EscapePath(const std::string& path)
     {
@@ -224,6 +818,9 @@ private:
             entry.sourcePath = ExtractStringValue(entryContent, "source");
             entry.outputDxil = ExtractStringValue(entryContent, "output_dxil");
             entry.outputSpirv = ExtractStringValue(entryContent, "output_spirv");
+            entry.spirvHash = ExtractStringValue(entryContent, "spirv_hash");
+            entry.dxilStats = ExtractStringValue(entryContent, "dxil_stats");
+            entry.spirvStats = ExtractStringValue(entryContent, "spirv_stats");
             entry.lastCompiled = ExtractStringValue(entryContent, "last_compiled");
             entry.includes = ExtractStringArray(entryContent, "includes");
             entry.defines = ExtractStringArray(entryContent, "defines");
@@ -231,9 +828,66 @@ private:
             m_entries[shaderName] = entry;
         }
 
+        ParseFiles(json);
         return true;
     }
 
+    void ParseFiles(const std::string& json)
+    {
+        size_t filesStart = json.find("\"files\"");
+        if (filesStart == std::string::npos)
+        {
+            return;  // Caches written before file records were added
+        }
+
+        size_t objStart = json.find('{', filesStart);
+        size_t objEnd = FindMatchingBrace(json, objStart);
+        if (objStart == std::string::npos || objEnd == std::string::npos)
+        {
+            return;
+        }
+
+        std::string filesContent = json.substr(objStart + 1, objEnd - objStart - 1);
+
+        std::regex fileRegex("\"([^\"]+)\"\\s*:\\s*\\{");
+        auto matchBegin = std::sregex_iterator(filesContent.begin(), filesContent.end(), fileRegex);
+        auto matchEnd = std::sregex_iterator();
+
+        for (auto it = matchBegin; it != matchEnd; ++it)
+        {
+            size_t entryStart = it->position() + it->length() - 1;
+            size_t entryEnd = FindMatchingBrace(filesContent, entryStart);
+            if (entryEnd == std::string::npos) continue;
+
+            std::string entryContent = filesContent.substr(entryStart, entryEnd - entryStart + 1);
+
+            FileCacheEntry entry;
+            try
+            {
+                entry.mtime = std::stoll(ExtractStringValue(entryContent, "mtime"));
+                entry.size = std::stoull(ExtractStringValue(entryContent, "size"));
+            }
+            catch (...)
+            {
+                continue;  // Malformed record, the file is parsed again
+            }
+            entry.hash = ExtractStringValue(entryContent, "hash");
+            entry.hasIncludes = (ExtractStringValue(entryContent, "has_includes") == "1");
+            for (const std::string& include : ExtractStringArray(entryContent, "includes"))
+            {
+                entry.includes.push_back(UnescapePath(include));
+            }
+            entry.spirvHash = ExtractStringValue(entryContent, "spirv_hash");
+            entry.hasSpirvIncludes = (ExtractStringValue(entryContent, "has_spirv_includes") == "1");
+            for (const std::string& include : ExtractStringArray(entryContent, "spirv_includes"))
+            {
+                entry.spirvIncludes.push_back(UnescapePath(include));
+            }
+
+            m_files[UnescapePath((*it)[1].str())] = entry;
+        }
+    }
+
     std::string ExtractStringValue(const std::string& json, const std::string& key)
     {
         std::string pattern = "\"" + key + "\"\\s*:\\s*\"([^\"]*)\"";
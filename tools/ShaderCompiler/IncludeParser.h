@@ -1,6 +1,7 @@
 /*
  * Include dependency parser for HLSL shaders
  * Recursively parses #include directives
+ * With a HashCache, the direct includes of each file are memoized across shaders and runs
  */
 
 #pragma once
@@ -13,6 +14,8 @@
 #include <sstream>
 #include <filesystem>
 
+#include "HashCache.h"
+
 namespace fs = std::filesystem;
 
 class IncludeParser
@@ -26,11 +29,19 @@ public:
         m_includeDirs.push_back(dir);
     }
 
+    // [Optional] Memoize the direct includes of each file in the cache
+    void SetCache(HashCache* cache)
+    {
+        m_cache = cache;
+    }
+
     // Parse all #include dependencies recursively
-    std::vector<std::string> ParseDependencies(const std::string& shaderPath)
+    // With spirv, includes in branches the SPIR-V target doesn't take are skipped (see Hash::GetTargetSource)
+    std::vector<std::string> ParseDependencies(const std::string& shaderPath, bool spirv = false)
     {
         m_dependencies.clear();
         m_visited.clear();
+        m_spirv = spirv;
 
         fs::path absPath = fs::absolute(shaderPath);
         ParseRecursive(absPath.string());
@@ -44,6 +55,8 @@ private:
     std::vector<std::string> m_includeDirs;
     std::set<std::string> m_dependencies;
     std::set<std::string> m_visited;
+    HashCache* m_cache = nullptr;
+    bool m_spirv = false;
 
     void ParseRecursive(const std::string& filePath)
     {
@@ -58,19 +71,40 @@ private:
         }
         m_visited.insert(pathStr);
 
+        std::vector<std::string> includes;
+        if (!m_cache || !m_cache->GetFileIncludes(pathStr, includes, m_spirv))
+        {
+            if (!ParseIncludes(normalizedPath, includes))
+            {
+                return;
+            }
+            if (m_cache) m_cache->SetFileIncludes(pathStr, includes, m_spirv);
+        }
+
+        for (const auto& resolvedPath : includes)
+        {
+            m_dependencies.insert(resolvedPath);
+            ParseRecursive(resolvedPath);
+        }
+    }
+
+    // Read a file and resolve its direct includes
+    bool ParseIncludes(const fs::path& normalizedPath, std::vector<std::string>& includes)
+    {
         // Read file content
-        std::ifstream file(pathStr);
+        std::ifstream file(normalizedPath);
         if (!file.is_open())
         {
-            return;
+            return false;
         }
 
         std::string content((std::istreambuf_iterator<char>(file)),
                             std::istreambuf_iterator<char>());
         file.close();
+        if (m_spirv) content = Hash::GetTargetSource(content, true);
 
         // Regex for #include "path" or #include <path>
-        std::regex includeRegex(R"(#\s*include\s*[<"]([^>"]+)[>"])");
+        static const std::regex includeRegex(R"(#\s*include\s*[<"]([^>"]+)[>"])");
 
         auto matchBegin = std::sregex_iterator(content.begin(), content.end(), includeRegex);
         auto matchEnd = std::sregex_iterator();
@@ -86,10 +120,10 @@ private:
 
             if (!resolvedPath.empty() && fs::exists(resolvedPath))
             {
-                m_dependencies.insert(resolvedPath);
-                ParseRecursive(resolvedPath);
+                includes.push_back(resolvedPath);
             }
         }
+        return true;
     }
 
     std::string ResolvePath(const std::string& baseDir, const std::string& includePath)
@@ -28,6 +28,7 @@ enum class LogStatus
     STATUS_SKIP,
     STATUS_RECOMPILE,
     STATUS_NEW,
+    STATUS_FETCH,
     STATUS_WARNING,
     STATUS_ERROR
 };
@@ -44,6 +45,8 @@ struct LogEntry
     std::string oldHash;
     std::string newHash;
     double compileTime = 0.0;
+    std::string stats;                      // Binary statistics of the outputs
+    std::vector<std::string> regressions;   // Statistics that grew since the previous build
 };
 
 class Logger
@@ -71,9 +74,12 @@ public:
         case LogStatus::STATUS_SKIP:     m_skipCount++; break;
         case LogStatus::STATUS_RECOMPILE: m_recompileCount++; break;
         case LogStatus::STATUS_NEW:      m_newCount++; break;
+        case LogStatus::STATUS_FETCH:    m_fetchCount++; break;
         case LogStatus::STATUS_WARNING:  m_warningCount++; break;
         case LogStatus::STATUS_ERROR:    m_errorCount++; break;
         }
+
+        if (!entry.regressions.empty()) m_regressionCount++;
     }
 
     bool WriteToFile(const std::string& path)
@@ -108,8 +114,10 @@ public:
         if (m_okCount > 0) parts.push_back(std::to_string(m_okCount) + " OK");
         if (m_recompileCount > 0) parts.push_back(std::to_string(m_recompileCount) + " RECOMPILE");
         if (m_newCount > 0) parts.push_back(std::to_string(m_newCount) + " NEW");
+        if (m_fetchCount > 0) parts.push_back(std::to_string(m_fetchCount) + " FETCH");
         if (m_warningCount > 0) parts.push_back(std::to_string(m_warningCount) + " WARNING");
         if (m_errorCount > 0) parts.push_back(std::to_string(m_errorCount) + " ERROR");
+        if (m_regressionCount > 0) parts.push_back(std::to_string(m_regressionCount) + " REGRESSED");
 
         for (size_t i = 0; i < parts.size(); ++i)
         {
@@ -140,6 +148,7 @@ public:
         std::cout << "  OK:        " << m_okCount << "\n";
         std::cout << "  RECOMPILE: " << m_recompileCount << "\n";
         std::cout << "  NEW:       " << m_newCount << "\n";
+        std::cout << "  FETCH:     " << m_fetchCount << "\n";
         std::cout << "  WARNING:   " << m_warningCount << "\n";
         std::cout << "  ERROR:     " << m_errorCount << "\n";
     }
@@ -156,8 +165,10 @@ private:
     int m_skipCount = 0;
     int m_recompileCount = 0;
     int m_newCount = 0;
+    int m_fetchCount = 0;
     int m_warningCount = 0;
     int m_errorCount = 0;
+    int m_regressionCount = 0;
 
     std::string GetCurrentDateTime()
     {
@@ -176,6 +187,7 @@ private:
         case LogStatus::STATUS_SKIP:      return "SKIP";
         case LogStatus::STATUS_RECOMPILE: return "RECOMPILE";
         case LogStatus::STATUS_NEW:       return "NEW";
+        case LogStatus::STATUS_FETCH:     return "FETCH";
         case LogStatus::STATUS_WARNING:   return "WARNING";
         case LogStatus::STATUS_ERROR:     return "ERROR";
         default: return "UNKNOWN";
@@ -221,6 +233,13 @@ private:
             file << "     Time: " << std::fixed << std::setprecision(3)
                  << entry.compileTime << "s\n";
         }
+        else if (entry.status == LogStatus::STATUS_FETCH)
+        {
+            file << "     Status: Fetched from the shader store\n";
+            file << "     Key: " << entry.message << "\n";
+            file << "     Hash: " << entry.newHash << "\n";
+            file << "     Output: " << entry.outputPath << "\n";
+        }
         else if (entry.status == LogStatus::STATUS_OK)
         {
             file << "     Output: " << entry.outputPath << "\n";
@@ -238,5 +257,18 @@ private:
         {
             file << "     Error: " << entry.message << "\n";
         }
+
+        if (!entry.stats.empty())
+        {
+            file << "     Stats: " << entry.stats << "\n";
+        }
+        if (!entry.regressions.empty())
+        {
+            file << "     Regressions:\n";
+            for (const auto& regression : entry.regressions)
+            {
+                file << "       - " << regression << "\n";
+            }
+        }
     }
 };
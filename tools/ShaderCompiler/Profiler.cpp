@@ -0,0 +1,8 @@
+/*
+ * Profiler implementation
+ */
+
+#include "Profiler.h"
+
+// Implementation is header-only for simplicity
+// This file exists for build system compatibility
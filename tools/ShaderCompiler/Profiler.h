@@ -0,0 +1,352 @@
+/*
+ * Compile time profiler
+ * Records when and on which thread each compile task ran, then reports the per-shader times,
+ * the critical path of the parallel build, and the compile time attributed to each included header
+ * (as JSON for tools and as a text histogram for people)
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <mutex>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <filesystem>
+
+struct ProfiledTask
+{
+    std::string shaderName;
+    std::string target;                 // "DXIL" or "SPIR-V"
+    unsigned int thread = 0;
+    double start = 0.0;                 // Seconds since the build started
+    double end = 0.0;
+    bool fetched = false;               // Copied from the shared binary store, not compiled
+    std::vector<std::string> includes;  // The includes the target depends on
+
+    double GetDuration() const { return end - start; }
+};
+
+class Profiler
+{
+public:
+    Profiler() = default;
+
+    void Start(unsigned int threadCount, const std::string& projectRoot)
+    {
+        m_start = std::chrono::steady_clock::now();
+        m_threadCount = std::max(1u, threadCount);
+        m_projectRoot = projectRoot;
+    }
+
+    // Seconds since Start()
+    double GetTime() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    }
+
+    // Thread-safe, called by the compile threads as their tasks finish
+    void AddTask(ProfiledTask task)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+
+    // Headers modified since the previous run, marked in the include report
+    void SetChangedFiles(const std::vector<std::string>& files)
+    {
+        m_changedFiles = std::set<std::string>(files.begin(), files.end());
+    }
+
+    void Finish()
+    {
+        m_wallTime = GetTime();
+    }
+
+    bool WriteJson(const std::string& path)
+    {
+        std::ofstream file(path);
+        if (!file.is_open())
+        {
+            return false;
+        }
+
+        Summary summary = GetSummary();
+        std::vector<ShaderTime> shaders = GetShaderTimes();
+        std::vector<IncludeCost> includes = GetIncludeCosts();
+
+        file << std::fixed << std::setprecision(4);
+        file << "{\n";
+        file << "  \"wall_time\": " << m_wallTime << ",\n";
+        file << "  \"compile_time\": " << summary.compileTime << ",\n";
+        file << "  \"threads\": " << m_threadCount << ",\n";
+        file << "  \"efficiency\": " << summary.efficiency << ",\n";
+        file << "  \"lower_bound\": " << summary.lowerBound << ",\n";
+
+        file << "  \"shaders\": [\n";
+        for (size_t i = 0; i < shaders.size(); ++i)
+        {
+            const ShaderTime& shader = shaders[i];
+            file << "    { \"name\": \"" << Escape(shader.name) << "\", \"dxil\": " << shader.dxil
+                 << ", \"spirv\": " << shader.spirv << ", \"total\": " << shader.total << " }";
+            file << ((i + 1 < shaders.size()) ? ",\n" : "\n");
+        }
+        file << "  ],\n";
+
+        file << "  \"tasks\": [\n";
+        for (size_t i = 0; i < m_tasks.size(); ++i)
+        {
+            const ProfiledTask& task = m_tasks[i];
+            file << "    { \"shader\": \"" << Escape(task.shaderName) << "\", \"target\": \"" << task.target
+                 << "\", \"thread\": " << task.thread << ", \"start\": " << task.start << ", \"end\": " << task.end
+                 << ", \"fetched\": " << (task.fetched ? "true" : "false") << " }";
+            file << ((i + 1 < m_tasks.size()) ? ",\n" : "\n");
+        }
+        file << "  ],\n";
+
+        file << "  \"critical_path\": {\n";
+        file << "    \"thread\": " << summary.criticalThread << ",\n";
+        file << "    \"idle_tail\": " << summary.idleTail << ",\n";
+        file << "    \"tasks\": [";
+        for (size_t i = 0; i < summary.criticalPath.size(); ++i)
+        {
+            const ProfiledTask& task = *summary.criticalPath[i];
+            file << "{ \"shader\": \"" << Escape(task.shaderName) << "\", \"target\": \"" << task.target << "\", \"time\": " << task.GetDuration() << " }";
+            if (i + 1 < summary.criticalPath.size()) file << ", ";
+        }
+        file << "]\n";
+        file << "  },\n";
+
+        file << "  \"includes\": [\n";
+        for (size_t i = 0; i < includes.size(); ++i)
+        {
+            const IncludeCost& include = includes[i];
+            file << "    { \"path\": \"" << Escape(include.path) << "\", \"compiles\": " << include.compiles
+                 << ", \"shaders\": " << include.shaders.size() << ", \"total_time\": " << include.totalTime
+                 << ", \"changed\": " << (include.changed ? "true" : "false") << " }";
+            file << ((i + 1 < includes.size()) ? ",\n" : "\n");
+        }
+        file << "  ]\n";
+        file << "}\n";
+
+        file.close();
+        return true;
+    }
+
+    bool WriteText(const std::string& path, size_t maxRows = 25)
+    {
+        std::ofstream file(path);
+        if (!file.is_open())
+        {
+            return false;
+        }
+
+        Summary summary = GetSummary();
+        std::vector<ShaderTime> shaders = GetShaderTimes();
+        std::vector<IncludeCost> includes = GetIncludeCosts();
+
+        file << std::fixed << std::setprecision(3);
+        file << std::string(80, '=') << "\n";
+        file << "Shader Compile Profile\n";
+        file << std::string(80, '=') << "\n";
+        file << "Wall time:    " << m_wallTime << "s on " << m_threadCount << " thread(s)\n";
+        file << "Compile time: " << summary.compileTime << "s (" << m_tasks.size() << " task(s))\n";
+        file << "Efficiency:   " << std::setprecision(1) << (summary.efficiency * 100.0) << "%\n" << std::setprecision(3);
+        file << "Lower bound:  " << summary.lowerBound << "s (the longest task, or the compile time spread over every thread)\n\n";
+
+        // Per shader times
+        file << "Shaders by compile time\n";
+        file << std::string(80, '-') << "\n";
+        double maxShader = shaders.empty() ? 0.0 : shaders.front().total;
+        for (size_t i = 0; i < shaders.size() && i < maxRows; ++i)
+        {
+            const ShaderTime& shader = shaders[i];
+            file << std::left << std::setw(32) << Truncate(shader.name, 32) << std::right
+                 << std::setw(8) << shader.total << "s  " << Bar(shader.total, maxShader) << "\n";
+        }
+        if (shaders.size() > maxRows) file << "  ... " << (shaders.size() - maxRows) << " more\n";
+        file << "\n";
+
+        // Critical path
+        file << "Critical path (thread " << summary.criticalThread << ", finished last)\n";
+        file << std::string(80, '-') << "\n";
+        for (const ProfiledTask* task : summary.criticalPath)
+        {
+            file << "  " << std::setw(8) << task->start << "s  " << std::left << std::setw(40) << Truncate(task->shaderName + " (" + task->target + ")", 40)
+                 << std::right << std::setw(8) << task->GetDuration() << "s\n";
+        }
+        file << "  Other threads idle for up to " << summary.idleTail << "s at the end of the build\n\n";
+
+        // Include attribution
+        file << "Headers by compile time of the shaders that include them (* changed since the previous run)\n";
+        file << std::string(80, '-') << "\n";
+        double maxInclude = includes.empty() ? 0.0 : includes.front().totalTime;
+        for (size_t i = 0; i < includes.size() && i < maxRows; ++i)
+        {
+            const IncludeCost& include = includes[i];
+            file << (include.changed ? "* " : "  ") << std::left << std::setw(40) << Truncate(include.path, 40) << std::right
+                 << std::setw(5) << include.compiles << "x" << std::setw(9) << include.totalTime << "s  " << Bar(include.totalTime, maxInclude, 20) << "\n";
+        }
+        if (includes.size() > maxRows) file << "  ... " << (includes.size() - maxRows) << " more\n";
+        file << std::string(80, '=') << "\n";
+
+        file.close();
+        return true;
+    }
+
+private:
+    struct ShaderTime
+    {
+        std::string name;
+        double dxil = 0.0;
+        double spirv = 0.0;
+        double total = 0.0;
+    };
+
+    struct IncludeCost
+    {
+        std::string path;
+        int compiles = 0;                   // Compiled targets that include the header
+        std::set<std::string> shaders;
+        double totalTime = 0.0;             // Their compile time, the cost of an edit to the header
+        bool changed = false;
+    };
+
+    struct Summary
+    {
+        double compileTime = 0.0;
+        double efficiency = 0.0;            // Compile time over the thread time of the build
+        double lowerBound = 0.0;
+        unsigned int criticalThread = 0;
+        double idleTail = 0.0;              // Time between the first and the last thread running out of tasks
+        std::vector<const ProfiledTask*> criticalPath;
+    };
+
+    std::vector<ProfiledTask> m_tasks;
+    std::set<std::string> m_changedFiles;
+    std::chrono::steady_clock::time_point m_start = std::chrono::steady_clock::now();
+    unsigned int m_threadCount = 1;
+    std::string m_projectRoot;
+    double m_wallTime = 0.0;
+    std::mutex m_mutex;
+
+    Summary GetSummary() const
+    {
+        Summary summary;
+
+        // The tasks don't depend on each other, so the critical path is the task chain of the thread that finished last
+        std::map<unsigned int, double> threadEnd;
+        double longestTask = 0.0;
+        for (const ProfiledTask& task : m_tasks)
+        {
+            if (task.fetched) continue;
+            summary.compileTime += task.GetDuration();
+            longestTask = std::max(longestTask, task.GetDuration());
+        }
+        for (const ProfiledTask& task : m_tasks)
+        {
+            threadEnd[task.thread] = std::max(threadEnd[task.thread], task.end);
+        }
+
+        double lastEnd = -1.0;
+        double firstEnd = 0.0;
+        for (const auto& [thread, end] : threadEnd)
+        {
+            if (end > lastEnd)
+            {
+                lastEnd = end;
+                summary.criticalThread = thread;
+            }
+            firstEnd = (firstEnd == 0.0) ? end : std::min(firstEnd, end);
+        }
+        summary.idleTail = threadEnd.empty() ? 0.0 : (lastEnd - firstEnd);
+
+        for (const ProfiledTask& task : m_tasks)
+        {
+            if (task.thread == summary.criticalThread) summary.criticalPath.push_back(&task);
+        }
+        std::sort(summary.criticalPath.begin(), summary.criticalPath.end(),
+            [](const ProfiledTask* a, const ProfiledTask* b) { return a->start < b->start; });
+
+        summary.lowerBound = std::max(longestTask, summary.compileTime / m_threadCount);
+        if (m_wallTime > 0.0) summary.efficiency = summary.compileTime / (m_wallTime * m_threadCount);
+        return summary;
+    }
+
+    std::vector<ShaderTime> GetShaderTimes() const
+    {
+        std::map<std::string, ShaderTime> times;
+        for (const ProfiledTask& task : m_tasks)
+        {
+            ShaderTime& time = times[task.shaderName];
+            time.name = task.shaderName;
+            if (task.fetched) continue;
+            if (task.target == "SPIR-V") time.spirv += task.GetDuration();
+            else time.dxil += task.GetDuration();
+            time.total += task.GetDuration();
+        }
+
+        std::vector<ShaderTime> result;
+        for (const auto& entry : times) result.push_back(entry.second);
+        std::sort(result.begin(), result.end(), [](const ShaderTime& a, const ShaderTime& b) { return a.total > b.total; });
+        return result;
+    }
+
+    std::vector<IncludeCost> GetIncludeCosts() const
+    {
+        std::map<std::string, IncludeCost> costs;
+        for (const ProfiledTask& task : m_tasks)
+        {
+            if (task.fetched) continue;
+            for (const std::string& include : task.includes)
+            {
+                IncludeCost& cost = costs[include];
+                cost.path = GetDisplayPath(include);
+                cost.compiles++;
+                cost.shaders.insert(task.shaderName);
+                cost.totalTime += task.GetDuration();
+                cost.changed = (m_changedFiles.count(include) > 0);
+            }
+        }
+
+        std::vector<IncludeCost> result;
+        for (const auto& entry : costs) result.push_back(entry.second);
+        std::sort(result.begin(), result.end(), [](const IncludeCost& a, const IncludeCost& b) { return a.totalTime > b.totalTime; });
+        return result;
+    }
+
+    std::string GetDisplayPath(const std::string& path) const
+    {
+        if (m_projectRoot.empty()) return path;
+        std::string relative = std::filesystem::path(path).lexically_relative(m_projectRoot).generic_string();
+        return (relative.empty() || relative.rfind("..", 0) == 0) ? path : relative;
+    }
+
+    static std::string Bar(double value, double maxValue, size_t width = 30)
+    {
+        if (maxValue <= 0.0) return "";
+        size_t length = static_cast<size_t>((value / maxValue) * width + 0.5);
+        return std::string(std::max<size_t>(length, value > 0.0 ? 1 : 0), '#');
+    }
+
+    static std::string Truncate(const std::string& text, size_t width)
+    {
+        if (text.size() <= width) return text;
+        return "..." + text.substr(text.size() - (width - 3));
+    }
+
+    static std::string Escape(const std::string& text)
+    {
+        std::string result;
+        for (char c : text)
+        {
+            if (c == '\\' || c == '"') result += '\\';
+            result += c;
+        }
+        return result;
+    }
+};
@@ -0,0 +1,8 @@
+/*
+ * ShaderStats implementation
+ */
+
+#include "ShaderStats.h"
+
+// Implementation is header-only for simplicity
+// This file exists for build system compatibility
@@ -0,0 +1,320 @@
+/*
+ * Shader binary statistics
+ * Extracts the size, instruction count, groupshared memory, and local array (scratch) memory of compiled shaders,
+ * from the DXIL disassembly or by walking the SPIR-V module, and compares them between builds
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <sstream>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+#include <algorithm>
+
+struct ShaderStats
+{
+    bool valid = false;
+    uint64_t size = 0;                  // Binary size (bytes)
+    uint32_t instructions = 0;          // Instructions in the function bodies
+    uint32_t groupshared = 0;           // Groupshared (workgroup) memory (bytes)
+    uint32_t scratch = 0;               // Local and static arrays (bytes), spilled to scratch memory when they can't stay in registers
+
+    // Flat "key=value;..." form, stored in the cache entries
+    std::string Serialize() const
+    {
+        if (!valid) return "";
+        std::ostringstream ss;
+        ss << "size=" << size << ";instructions=" << instructions << ";groupshared=" << groupshared << ";scratch=" << scratch;
+        return ss.str();
+    }
+
+    static ShaderStats Parse(const std::string& text)
+    {
+        ShaderStats stats;
+        std::stringstream ss(text);
+        std::string field;
+        while (std::getline(ss, field, ';'))
+        {
+            size_t eq = field.find('=');
+            if (eq == std::string::npos) continue;
+
+            std::string key = field.substr(0, eq);
+            uint64_t value = std::strtoull(field.c_str() + eq + 1, nullptr, 10);
+            if (key == "size") stats.size = value;
+            else if (key == "instructions") stats.instructions = static_cast<uint32_t>(value);
+            else if (key == "groupshared") stats.groupshared = static_cast<uint32_t>(value);
+            else if (key == "scratch") stats.scratch = static_cast<uint32_t>(value);
+            else continue;
+            stats.valid = true;
+        }
+        return stats;
+    }
+
+    std::string ToString() const
+    {
+        std::ostringstream ss;
+        ss << size << " bytes, " << instructions << " instructions, " << groupshared << " bytes groupshared, " << scratch << " bytes local arrays";
+        return ss.str();
+    }
+
+    // Describe the changes from the previous build that put occupancy at risk (any growth of the
+    // groupshared or local array memory, and instruction count or size growth past the tolerance)
+    static std::vector<std::string> FindRegressions(const ShaderStats& previous, const ShaderStats& current, const std::string& target, double tolerance = 0.05)
+    {
+        std::vector<std::string> regressions;
+        if (!previous.valid || !current.valid) return regressions;
+
+        auto describe = [&](const char* name, uint64_t before, uint64_t after, const char* unit)
+        {
+            std::ostringstream ss;
+            ss << target << " " << name << " " << before << " -> " << after << unit;
+            if (before > 0) ss << " (+" << static_cast<int>(((double)after / before - 1.0) * 100.0 + 0.5) << "%)";
+            regressions.push_back(ss.str());
+        };
+
+        if (current.groupshared > previous.groupshared) describe("groupshared", previous.groupshared, current.groupshared, " bytes");
+        if (current.scratch > previous.scratch) describe("local arrays", previous.scratch, current.scratch, " bytes");
+        if (current.instructions > previous.instructions * (1.0 + tolerance)) describe("instructions", previous.instructions, current.instructions, "");
+        if (current.size > previous.size * (1.0 + 2.0 * tolerance)) describe("size", previous.size, current.size, " bytes");
+        return regressions;
+    }
+
+    //----------------------------------------------------------------------------------------------------------
+    // DXIL
+    //----------------------------------------------------------------------------------------------------------
+
+    // Statistics of a DXIL binary from its (LLVM IR) disassembly
+    static ShaderStats FromDxilDisassembly(uint64_t binarySize, const std::string& disassembly)
+    {
+        ShaderStats stats;
+        stats.size = binarySize;
+
+        // Named struct types, sized on first use
+        std::map<std::string, std::string> structTypes;
+        std::map<std::string, uint32_t> structSizes;
+
+        std::istringstream lines(disassembly);
+        std::string line;
+        std::vector<std::string> body;
+        bool inFunction = false;
+        while (std::getline(lines, line))
+        {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+
+            if (inFunction)
+            {
+                if (line == "}")
+                {
+                    inFunction = false;
+                    continue;
+                }
+                body.push_back(line);
+                continue;
+            }
+
+            if (line.compare(0, 7, "define ") == 0)
+            {
+                inFunction = true;
+                continue;
+            }
+
+            if (line.size() > 1 && line[0] == '%')
+            {
+                size_t eq = line.find(" = type ");
+                if (eq != std::string::npos) structTypes[line.substr(0, eq)] = line.substr(eq + 8);
+                continue;
+            }
+
+            if (line.size() > 1 && line[0] == '@')
+            {
+                // e.g. @"\01?Shared@@3PAMA" = addrspace(3) global [256 x float] undef, align 4
+                size_t global = line.find(" global ");
+                if (global == std::string::npos) continue;
+
+                std::string type = line.substr(global + 8);
+                uint32_t bytes = GetIRTypeSize(type, structTypes, structSizes);
+                if (line.find("addrspace(3)") != std::string::npos) stats.groupshared += bytes;
+                else if (line.find("internal") != std::string::npos && !type.empty() && type[0] == '[') stats.scratch += bytes;
+            }
+        }
+
+        for (const std::string& instruction : body)
+        {
+            size_t first = instruction.find_first_not_of(' ');
+            if (first == std::string::npos || first == 0 || instruction[first] == ';') continue;  // Blank lines, labels, and comments
+
+            size_t alloca = instruction.find("= alloca ");
+            if (alloca != std::string::npos)
+            {
+                stats.scratch += GetIRTypeSize(instruction.substr(alloca + 9), structTypes, structSizes);
+                continue;
+            }
+            stats.instructions++;
+        }
+
+        stats.valid = true;
+        return stats;
+    }
+
+    //----------------------------------------------------------------------------------------------------------
+    // SPIR-V
+    //----------------------------------------------------------------------------------------------------------
+
+    static ShaderStats FromSpirv(const std::vector<uint8_t>& binary)
+    {
+        ShaderStats stats;
+        stats.size = binary.size();
+
+        const uint32_t SpirvMagic = 0x07230203;
+        if (binary.size() < 20 || (binary.size() % 4) != 0) return stats;
+
+        std::vector<uint32_t> words(binary.size() / 4);
+        memcpy(words.data(), binary.data(), binary.size());
+        if (words[0] != SpirvMagic) return stats;
+
+        enum Op : uint32_t
+        {
+            OpLine = 8, OpTypeBool = 20, OpTypeInt = 21, OpTypeFloat = 22, OpTypeVector = 23, OpTypeMatrix = 24,
+            OpTypeArray = 28, OpTypeStruct = 30, OpTypePointer = 32, OpConstant = 43, OpFunction = 54,
+            OpFunctionParameter = 55, OpFunctionEnd = 56, OpVariable = 59, OpLabel = 248, OpNoLine = 317
+        };
+        enum StorageClass : uint32_t { Workgroup = 4, Private = 6, Function = 7 };
+
+        std::map<uint32_t, uint32_t> typeSizes;         // Type id to size (bytes)
+        std::map<uint32_t, bool> arrayTypes;
+        std::map<uint32_t, uint32_t> pointeeTypes;      // Pointer type id to the pointee type id
+        std::map<uint32_t, uint32_t> constants;         // Integer constant id to value
+
+        bool inFunction = false;
+        for (size_t i = 5; i < words.size();)
+        {
+            uint32_t count = words[i] >> 16;
+            uint32_t opcode = words[i] & 0xFFFF;
+            if (count == 0 || i + count > words.size()) return stats;
+            const uint32_t* operands = &words[i + 1];
+
+            switch (opcode)
+            {
+            case OpTypeBool: typeSizes[operands[0]] = 4; break;
+            case OpTypeInt:
+            case OpTypeFloat: typeSizes[operands[0]] = operands[1] / 8; break;
+            case OpTypeVector:
+            case OpTypeMatrix: typeSizes[operands[0]] = typeSizes[operands[1]] * operands[2]; break;
+            case OpTypeArray:
+                typeSizes[operands[0]] = typeSizes[operands[1]] * constants[operands[2]];
+                arrayTypes[operands[0]] = true;
+                break;
+            case OpTypeStruct:
+            {
+                uint32_t size = 0;
+                for (uint32_t m = 2; m < count; ++m) size += typeSizes[words[i + m]];
+                typeSizes[operands[0]] = size;
+                break;
+            }
+            case OpTypePointer: pointeeTypes[operands[0]] = operands[2]; break;
+            case OpConstant: if (count >= 4) constants[operands[1]] = operands[2]; break;
+            case OpVariable:
+            {
+                uint32_t pointee = pointeeTypes[operands[0]];
+                if (operands[2] == Workgroup) stats.groupshared += typeSizes[pointee];
+                else if ((operands[2] == Function || operands[2] == Private) && arrayTypes[pointee]) stats.scratch += typeSizes[pointee];
+                break;
+            }
+            case OpFunction: inFunction = true; break;
+            case OpFunctionEnd: inFunction = false; break;
+            default: break;
+            }
+
+            if (inFunction && opcode != OpFunction && opcode != OpFunctionParameter && opcode != OpLabel
+                && opcode != OpVariable && opcode != OpLine && opcode != OpNoLine)
+            {
+                stats.instructions++;
+            }
+            i += count;
+        }
+
+        stats.valid = true;
+        return stats;
+    }
+
+private:
+    // Size of an LLVM IR type (e.g. "[64 x <4 x float>]", "%struct.Probe"), scalars are not padded
+    static uint32_t GetIRTypeSize(const std::string& text, const std::map<std::string, std::string>& structTypes, std::map<std::string, uint32_t>& structSizes)
+    {
+        size_t pos = 0;
+        return ParseIRType(text, pos, structTypes, structSizes);
+    }
+
+    static uint32_t ParseIRType(const std::string& text, size_t& pos, const std::map<std::string, std::string>& structTypes, std::map<std::string, uint32_t>& structSizes)
+    {
+        while (pos < text.size() && text[pos] == ' ') pos++;
+        if (pos >= text.size()) return 0;
+
+        char c = text[pos];
+        if (c == '[' || c == '<')
+        {
+            char close = (c == '[') ? ']' : '>';
+            pos++;
+            uint32_t count = static_cast<uint32_t>(std::strtoul(text.c_str() + pos, nullptr, 10));
+            size_t x = text.find(" x ", pos);
+            if (x == std::string::npos) return 0;
+            pos = x + 3;
+            uint32_t element = ParseIRType(text, pos, structTypes, structSizes);
+            size_t end = text.find(close, pos);
+            pos = (end == std::string::npos) ? text.size() : end + 1;
+            return count * element;
+        }
+        if (c == '{')
+        {
+            pos++;
+            uint32_t size = 0;
+            while (pos < text.size() && text[pos] != '}')
+            {
+                size += ParseIRType(text, pos, structTypes, structSizes);
+                while (pos < text.size() && (text[pos] == ' ' || text[pos] == ',')) pos++;
+            }
+            pos++;
+            return size;
+        }
+        if (c == '%')
+        {
+            size_t start = pos++;
+            if (pos < text.size() && text[pos] == '"')
+            {
+                size_t end = text.find('"', pos + 1);
+                pos = (end == std::string::npos) ? text.size() : end + 1;
+            }
+            else
+            {
+                while (pos < text.size() && (isalnum(static_cast<unsigned char>(text[pos])) || text[pos] == '.' || text[pos] == '_')) pos++;
+            }
+
+            std::string name = text.substr(start, pos - start);
+            auto known = structSizes.find(name);
+            if (known != structSizes.end()) return known->second;
+
+            auto definition = structTypes.find(name);
+            if (definition == structTypes.end()) return 0;
+
+            structSizes[name] = 0;  // Guards against recursive types
+            uint32_t size = GetIRTypeSize(definition->second, structTypes, structSizes);
+            structSizes[name] = size;
+            return size;
+        }
+
+        // Scalars
+        size_t start = pos;
+        while (pos < text.size() && isalnum(static_cast<unsigned char>(text[pos]))) pos++;
+        std::string scalar = text.substr(start, pos - start);
+        if (scalar == "half") return 2;
+        if (scalar == "float") return 4;
+        if (scalar == "double") return 8;
+        if (scalar.size() > 1 && scalar[0] == 'i') return std::max(1u, static_cast<uint32_t>(std::strtoul(scalar.c_str() + 1, nullptr, 10)) / 8);
+        return 0;
+    }
+};
@@ -0,0 +1,205 @@
+/*
+ * File watcher for the watch mode
+ * Waits for changes to a set of files: the directories holding them are watched with filesystem
+ * notifications (inotify on Linux, change notifications on Windows, polling elsewhere), and a
+ * notification compares the modification time and size of each file with the previous check
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <chrono>
+#include <thread>
+#include <filesystem>
+#include <system_error>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+class Watcher
+{
+public:
+    Watcher() = default;
+    ~Watcher() { Cleanup(); }
+
+    Watcher(const Watcher&) = delete;
+    Watcher& operator=(const Watcher&) = delete;
+
+    // Normalize a path the way the watcher reports it, so paths from different sources compare equal
+    static std::string NormalizePath(const std::string& path)
+    {
+        std::error_code ec;
+        std::filesystem::path normalized = std::filesystem::weakly_canonical(std::filesystem::absolute(path, ec), ec);
+        if (ec) normalized = std::filesystem::absolute(path, ec).lexically_normal();
+        return normalized.generic_string();
+    }
+
+    // Watch these files (replacing the previous set), their directories are watched for notifications
+    void SetFiles(const std::vector<std::string>& files)
+    {
+        std::map<std::string, FileStamp> stamps;
+        std::set<std::string> directories;
+        for (const std::string& file : files)
+        {
+            std::string path = NormalizePath(file);
+            auto previous = m_files.find(path);
+            stamps[path] = (previous != m_files.end()) ? previous->second : GetStamp(path);
+            directories.insert(std::filesystem::path(path).parent_path().generic_string());
+        }
+        m_files = std::move(stamps);
+
+        if (directories != m_directories)
+        {
+            Cleanup();
+            m_directories = std::move(directories);
+            Watch();
+        }
+    }
+
+    // True when the directories are watched with filesystem notifications, false when polling
+    bool IsNotifying() const { return m_notifying; }
+
+    // Block until watched files change and return them.
+    // A notification waits a moment for the rest of the save (editors often write a file in several steps).
+    std::vector<std::string> WaitForChanges()
+    {
+        while (true)
+        {
+            if (WaitForNotification(m_notifying ? NotifiedCheckInterval : PollInterval))
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(SettleTime));
+                DrainNotifications();
+            }
+
+            std::vector<std::string> changed;
+            for (auto& file : m_files)
+            {
+                FileStamp stamp = GetStamp(file.first);
+                if (stamp.mtime == file.second.mtime && stamp.size == file.second.size) continue;
+
+                file.second = stamp;
+                changed.push_back(file.first);
+            }
+            if (!changed.empty()) return changed;
+        }
+    }
+
+private:
+    struct FileStamp
+    {
+        int64_t mtime = 0;
+        uint64_t size = 0;
+    };
+
+    static constexpr int PollInterval = 250;            // Milliseconds between checks without notifications
+    static constexpr int NotifiedCheckInterval = 2000;  // Milliseconds between checks with notifications (catches missed events)
+    static constexpr int SettleTime = 30;               // Milliseconds to wait after a notification
+
+    std::map<std::string, FileStamp> m_files;
+    std::set<std::string> m_directories;
+    bool m_notifying = false;
+
+#ifdef _WIN32
+    std::vector<HANDLE> m_handles;
+#elif defined(__linux__)
+    int m_inotify = -1;
+#endif
+
+    static FileStamp GetStamp(const std::string& path)
+    {
+        FileStamp stamp;
+        std::error_code ec;
+        auto mtime = std::filesystem::last_write_time(path, ec);
+        if (ec) return stamp;
+
+        stamp.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+        stamp.size = static_cast<uint64_t>(std::filesystem::file_size(path, ec));
+        if (ec) stamp.size = 0;
+        return stamp;
+    }
+
+    // Start the notifications of the watched directories, falls back to polling when they are not available
+    void Watch()
+    {
+#ifdef _WIN32
+        // Change notifications are waited on together, at most MAXIMUM_WAIT_OBJECTS directories
+        m_notifying = (m_directories.size() <= MAXIMUM_WAIT_OBJECTS);
+        for (const std::string& directory : m_directories)
+        {
+            if (!m_notifying) break;
+
+            HANDLE handle = FindFirstChangeNotificationA(directory.c_str(), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE);
+            if (handle == INVALID_HANDLE_VALUE) m_notifying = false;
+            else m_handles.push_back(handle);
+        }
+#elif defined(__linux__)
+        m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        m_notifying = (m_inotify >= 0);
+        for (const std::string& directory : m_directories)
+        {
+            if (!m_notifying) break;
+            if (inotify_add_watch(m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM) < 0) m_notifying = false;
+        }
+#endif
+        if (!m_notifying) Cleanup();
+    }
+
+    // Wait up to timeout milliseconds, returns true when a notification arrived
+    bool WaitForNotification(int timeout)
+    {
+        if (!m_notifying)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeout));
+            return false;
+        }
+
+#ifdef _WIN32
+        DWORD result = WaitForMultipleObjects(static_cast<DWORD>(m_handles.size()), m_handles.data(), FALSE, static_cast<DWORD>(timeout));
+        return (result >= WAIT_OBJECT_0 && result < WAIT_OBJECT_0 + m_handles.size());
+#elif defined(__linux__)
+        pollfd fd = { m_inotify, POLLIN, 0 };
+        return (poll(&fd, 1, timeout) > 0);
+#else
+        return false;
+#endif
+    }
+
+    // Consume the pending notifications, the changed files are found by comparing stamps
+    void DrainNotifications()
+    {
+        if (!m_notifying) return;
+
+#ifdef _WIN32
+        for (HANDLE handle : m_handles)
+        {
+            if (WaitForSingleObject(handle, 0) == WAIT_OBJECT_0) FindNextChangeNotification(handle);
+        }
+#elif defined(__linux__)
+        char buffer[4096];
+        while (read(m_inotify, buffer, sizeof(buffer)) > 0) {}
+#endif
+    }
+
+    void Cleanup()
+    {
+#ifdef _WIN32
+        for (HANDLE handle : m_handles)
+        {
+            FindCloseChangeNotification(handle);
+        }
+        m_handles.clear();
+#elif defined(__linux__)
+        if (m_inotify >= 0) close(m_inotify);
+        m_inotify = -1;
+#endif
+        m_notifying = false;
+    }
+};
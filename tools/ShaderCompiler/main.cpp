@@ -3,7 +3,8 @@
  *
  * Compiles HLSL shaders at build time with:
  * - Hash-based incremental compilation
- * - DXIL (D3D12) and SPIR-V (Vulkan) output
+ * - DXIL (D3D12) and SPIR-V (Vulkan) output, compiled as separate tasks with separate hashes
+ *   (SPIR-V is not recompiled when only D3D12 specific branches changed)
  * - Detailed logging for agent debugging
  *
  * Usage:
@@ -13,10 +14,18 @@
  *   --manifest <path>   Path to shader manifest JSON file
  *   --output <dir>      Output directory for compiled shaders
  *   --log <path>        Path to log file (default: shader_compile.log)
- *   --cache <path>      Path to hash cache file (default: shader_cache.json)
+ *   --cache <path>      Path to hash cache file (default: shader_cache.bin, a shader_cache.json of earlier versions is converted)
+ *   --export-cache <path>  Also write the hash cache as JSON to <path>
  *   --force             Force full rebuild (ignore cache)
  *   --verbose           Verbose output
  *   --dry-run           Show what would be compiled without compiling
+ *   --jobs <n>          Number of compile threads (default: hardware thread count)
+ *   --store <dir>       Shared shader binary store: fetch binaries compiled elsewhere, add new ones
+ *   --profile <path>    Write a compile time profile to <path>.json and <path>.txt
+ *   --watch             Stay running after the build: watch the shader sources and rebuild the affected shaders
+ *                       when they change (the compiler, include graph, and cache stay in memory)
+ *   --notify <port>     With --watch, notify the test harness listening on <port> (config shaders.watchPort)
+ *                       of the rebuilt shaders, it reloads the workloads using them
  */
 
 #include <iostream>
@@ -24,6 +33,13 @@
 #include <vector>
 #include <chrono>
 #include <filesystem>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <sstream>
+#include <deque>
+#include <set>
 
 #include "ShaderManifest.h"
 #include "Compiler.h"
@@ -31,6 +47,11 @@
 #include "HashCache.h"
 #include "IncludeParser.h"
 #include "Hash.h"
+#include "BinaryStore.h"
+#include "Profiler.h"
+#include "ShaderStats.h"
+#include "Watcher.h"
+#include "HarnessNotifier.h"
 
 namespace fs = std::filesystem;
 
@@ -39,10 +60,16 @@ struct Options
     std::string manifestPath;
     std::string outputDir;
     std::string logPath = "shader_compile.log";
-    std::string cachePath = "shader_cache.json";
+    std::string cachePath = "shader_cache.bin";
+    std::string exportCachePath;
     bool force = false;
     bool verbose = false;
     bool dryRun = false;
+    int jobs = 0;  // 0 = hardware thread count
+    std::string storeDir;
+    std::string profilePath;
+    bool watch = false;
+    int notifyPort = 0;  // 0 = don't notify
 };
 
 bool ParseArgs(int argc, char* argv[], Options& opts)
@@ -67,6 +94,10 @@ bool ParseArgs(int argc, char* argv[], Options& opts)
         {
             opts.cachePath = argv[++i];
         }
+        else if (arg == "--export-cache" && i + 1 < argc)
+        {
+            opts.exportCachePath = argv[++i];
+        }
         else if (arg == "--force")
         {
             opts.force = true;
@@ -79,6 +110,26 @@ bool ParseArgs(int argc, char* argv[], Options& opts)
         {
             opts.dryRun = true;
         }
+        else if (arg == "--jobs" && i + 1 < argc)
+        {
+            opts.jobs = std::atoi(argv[++i]);
+        }
+        else if (arg == "--store" && i + 1 < argc)
+        {
+            opts.storeDir = argv[++i];
+        }
+        else if (arg == "--profile" && i + 1 < argc)
+        {
+            opts.profilePath = argv[++i];
+        }
+        else if (arg == "--watch")
+        {
+            opts.watch = true;
+        }
+        else if (arg == "--notify" && i + 1 < argc)
+        {
+            opts.notifyPort = std::atoi(argv[++i]);
+        }
         else if (arg == "--help" || arg == "-h")
         {
             std::cout << "Usage: ShaderCompiler --manifest <path> --output <dir> [options]\n";
@@ -86,10 +137,16 @@ bool ParseArgs(int argc, char* argv[], Options& opts)
             std::cout << "  --manifest <path>   Path to shader manifest JSON file\n";
             std::cout << "  --output <dir>      Output directory for compiled shaders\n";
             std::cout << "  --log <path>        Path to log file (default: shader_compile.log)\n";
-            std::cout << "  --cache <path>      Path to hash cache file (default: shader_cache.json)\n";
+            std::cout << "  --cache <path>      Path to hash cache file (default: shader_cache.bin)\n";
+            std::cout << "  --export-cache <path>  Also write the hash cache as JSON to <path>\n";
             std::cout << "  --force             Force full rebuild (ignore cache)\n";
             std::cout << "  --verbose           Verbose output\n";
             std::cout << "  --dry-run           Show what would be compiled without compiling\n";
+            std::cout << "  --jobs <n>          Number of compile threads (default: hardware thread count)\n";
+            std::cout << "  --store <dir>       Shared shader binary store: fetch binaries compiled elsewhere, add new ones\n";
+            std::cout << "  --profile <path>    Write a compile time profile to <path>.json and <path>.txt\n";
+            std::cout << "  --watch             Stay running, rebuild the affected shaders when their sources change\n";
+            std::cout << "  --notify <port>     With --watch, notify the test harness listening on <port> of the rebuilt shaders\n";
             return false;
         }
     }
@@ -100,11 +157,27 @@ bool ParseArgs(int argc, char* argv[], Options& opts)
         return false;
     }
 
+    if (opts.notifyPort < 0 || opts.notifyPort > 65535 || (opts.notifyPort != 0 && !opts.watch))
+    {
+        std::cerr << "Error: --notify needs --watch and a port number\n";
+        return false;
+    }
+
+    if (opts.watch && opts.dryRun)
+    {
+        std::cerr << "Error: --watch and --dry-run can't be combined\n";
+        return false;
+    }
+
     return true;
 }
 
 std::string GetCurrentDateTime()
 {
+    // std::gmtime() returns a shared buffer, the compile threads take turns
+    static std::mutex timeMutex;
+    std::lock_guard<std::mutex> lock(timeMutex);
+
     auto now = std::chrono::system_clock::now();
     auto time = std::chrono::system_clock::to_time_t(now);
     char buffer[64];
@@ -112,97 +185,362 @@ std::string GetCurrentDateTime()
     return buffer;
 }
 
-int main(int argc, char* argv[])
+// The output of one compile target (DXIL or SPIR-V) of a shader
+struct TargetResult
 {
-    Options opts;
-    if (!ParseArgs(argc, argv, opts))
+    bool success = false;
+    bool fetched = false;               // Copied from the shared binary store
+    std::string storeKey;
+    double compileTime = 0.0;
+    std::string errorMessage;
+    std::string warningMessage;
+    ShaderStats stats;                  // Statistics of the output binary
+    std::string out;                    // Console output (stdout)
+    std::string err;                    // Console output (stderr)
+};
+
+// A shader that needs compiling, found by the (serial) dependency and hash pass
+struct CompileJob
+{
+    size_t slot = 0;                    // Index of the shader in the manifest
+    const ShaderDefinition* shader = nullptr;
+    std::string sourcePath;
+    std::vector<std::string> includes;
+    std::vector<std::string> spirvIncludes;
+    std::string currentHash;
+    std::string cachedHash;
+    std::string currentSpirvHash;       // Hash of the SPIR-V view of the sources, see Hash::GetTargetSource
+    bool compileDxil = false;
+    bool compileSpirv = false;          // The SPIR-V output is out of date (only when the shader generates SPIR-V)
+    bool isNew = false;
+    ShaderStats cachedDxilStats;        // Statistics of the previous build's outputs, to find regressions
+    ShaderStats cachedSpirvStats;
+
+    // The targets compile as separate tasks, the last one to finish writes the shader's result
+    std::atomic<int> pendingTasks{ 0 };
+    TargetResult dxil;
+    TargetResult spirv;
+};
+
+// One compile target of a job, the unit of work of the thread pool
+struct CompileTask
+{
+    CompileJob* job = nullptr;
+    bool spirv = false;
+};
+
+// The result of one manifest shader, written out in manifest order once every earlier shader is done
+struct ShaderResult
+{
+    bool done = false;
+    bool hasEntry = false;
+    LogEntry entry;
+    std::string out;                    // Console output (stdout)
+    std::string err;                    // Console output (stderr)
+    bool compiled = false;
+    bool fetched = false;
+    bool skipped = false;
+    bool error = false;
+};
+
+void UpdateCacheEntry(const CompileJob& job, const std::string& dxilOutput, const std::string& spirvOutput, bool spirvValid, HashCache& cache)
+{
+    const ShaderDefinition& shader = *job.shader;
+
+    ShaderCacheEntry cacheEntry;
+    cacheEntry.hash = job.currentHash;
+    cacheEntry.sourcePath = shader.path;
+    cacheEntry.includes.assign(job.includes.begin(), job.includes.end());
+    cacheEntry.defines = shader.defines;
+    cacheEntry.outputDxil = dxilOutput;
+    cacheEntry.outputSpirv = shader.generateSpirv ? spirvOutput : "";
+    cacheEntry.spirvHash = (shader.generateSpirv && spirvValid) ? job.currentSpirvHash : "";
+    cacheEntry.dxilStats = (job.compileDxil ? job.dxil.stats : job.cachedDxilStats).Serialize();
+    cacheEntry.spirvStats = (shader.generateSpirv && spirvValid) ? (job.compileSpirv ? job.spirv.stats : job.cachedSpirvStats).Serialize() : "";
+    cacheEntry.lastCompiled = GetCurrentDateTime();
+    cache.UpdateEntry(shader.name, cacheEntry);
+}
+
+std::vector<std::string> GetIncludeDirectories(const std::string& shaderDir, const std::string& sourcePath)
+{
+    // Get shader's directory for relative includes
+    fs::path shaderPath(sourcePath);
+    std::string shaderParentDir = shaderPath.parent_path().string();
+    std::string rtxgiDir = shaderDir + "/../../rtxgi-sdk";
+
+    return {
+        shaderDir,
+        shaderDir + "/include",
+        shaderDir + "/shaders",
+        shaderDir + "/shaders/include",
+        shaderDir + "/shaders/ddgi",
+        shaderDir + "/../..",  // For samples/test-harness relative paths
+        shaderDir + "/../../include",  // For Types.h etc
+        shaderDir + "/../../include/graphics",
+        rtxgiDir + "/include",
+        rtxgiDir + "/shaders",
+        rtxgiDir + "/shaders/ddgi",
+        rtxgiDir + "/shaders/ddgi/include",
+        shaderParentDir,
+        shaderParentDir + "/../include",
+        shaderParentDir + "/../../include"
+    };
+}
+
+// Get the statistics of a DXIL or SPIR-V binary
+ShaderStats AnalyzeBinary(Compiler& compiler, const std::vector<uint8_t>& bytecode, bool spirv)
+{
+    if (spirv) return ShaderStats::FromSpirv(bytecode);
+
+    std::string disassembly;
+    if (!compiler.Disassemble(bytecode, disassembly)) return ShaderStats();
+    return ShaderStats::FromDxilDisassembly(bytecode.size(), disassembly);
+}
+
+// Fetch or compile one target of a shader
+void CompileTarget(Compiler& compiler, const CompileJob& job, bool spirv, const Options& opts, const std::string& shaderDir, const BinaryStore& store, TargetResult& result)
+{
+    const ShaderDefinition& shader = *job.shader;
+    std::ostringstream out;
+    std::ostringstream err;
+
+    const char* targetName = spirv ? "SPIR-V" : "DXIL";
+    const char* extension = spirv ? "spv" : "dxil";
+    std::string output = opts.outputDir + "/" + shader.name + "." + extension;
+
+    // Fetch the binary from the shared store when another machine (or run) already compiled it
+    std::string storeKey = store.IsEnabled() ? store.GetKey(spirv ? job.currentSpirvHash : job.currentHash, compiler.GetVersion(), shader.profile) : "";
+    if (store.IsEnabled() && store.Fetch(storeKey, extension, output))
     {
-        return 1;
+        std::string binary = Hash::ReadFile(output);
+        result.success = true;
+        result.fetched = true;
+        result.storeKey = storeKey;
+        result.stats = AnalyzeBinary(compiler, std::vector<uint8_t>(binary.begin(), binary.end()), spirv);
+        return;
     }
 
-    std::cout << "=== Shader Precompiler ===\n";
+    if (opts.verbose)
+    {
+        out << "[COMPILE] " << shader.name << " -> " << targetName << "\n";
+    }
 
-    // Load manifest
-    ShaderManifest manifest;
-    if (!manifest.Load(opts.manifestPath))
+    std::vector<std::string> includeDirs = GetIncludeDirectories(shaderDir, job.sourcePath);
+    auto compileResult = spirv
+        ? compiler.CompileSPIRV(job.sourcePath, shader.entryPoint, shader.profile, shader.defines, includeDirs)
+        : compiler.CompileDXIL(job.sourcePath, shader.entryPoint, shader.profile, shader.defines, includeDirs);
+
+    result.compileTime = compileResult.compileTime;
+    if (!compileResult.success)
     {
-        std::cerr << "Error: Failed to load manifest: " << opts.manifestPath << "\n";
-        return 1;
+        result.errorMessage = compileResult.errorMessage;
     }
+    else if (!compiler.SaveBytecode(compileResult.bytecode, output))
+    {
+        result.errorMessage = std::string("Failed to save ") + targetName;
+    }
+    else
+    {
+        result.success = true;
+        result.warningMessage = compileResult.warningMessage;
+        result.stats = AnalyzeBinary(compiler, compileResult.bytecode, spirv);
 
-    std::cout << "Loaded " << manifest.GetShaders().size() << " shader definitions\n";
+        if (store.IsEnabled() && !store.Store(storeKey, extension, compileResult.bytecode))
+        {
+            err << "[WARNING] " << shader.name << ": Failed to add " << targetName << " to the shader store\n";
+        }
+    }
 
-    // Get project root (manifest is in samples/test-harness, so go up 2 levels)
-    fs::path manifestAbsPath = fs::absolute(opts.manifestPath);
-    std::string projectRoot = manifestAbsPath.parent_path().parent_path().parent_path().string();
+    result.out = out.str();
+    result.err = err.str();
+}
 
-    // Initialize compiler
-    Compiler compiler;
-    if (!opts.dryRun && !compiler.Initialize(projectRoot))
+// Combine the target results of a job into the shader's result and update its cache entry
+void FinishShader(const CompileJob& job, const Options& opts, HashCache& cache, ShaderResult& result)
+{
+    const ShaderDefinition& shader = *job.shader;
+    std::ostringstream out;
+    std::ostringstream err;
+
+    out << job.dxil.out << job.spirv.out;
+    err << job.dxil.err << job.spirv.err;
+
+    std::string dxilOutput = opts.outputDir + "/" + shader.name + ".dxil";
+    std::string spirvOutput = opts.outputDir + "/" + shader.name + ".spv";
+
+    LogEntry& entry = result.entry;
+    entry.shaderName = shader.name;
+    entry.profile = shader.profile;
+    entry.sourcePath = shader.path;
+    result.hasEntry = true;
+
+    if (job.compileDxil && !job.dxil.success)
     {
-        std::cerr << "Error: Failed to initialize compiler: " << compiler.GetLastError() << "\n";
-        return 1;
+        entry.status = LogStatus::STATUS_ERROR;
+        entry.message = job.dxil.errorMessage;
+
+        err << "[ERROR] " << shader.name << ": " << job.dxil.errorMessage << "\n";
+        result.error = true;
+        result.out = out.str();
+        result.err = err.str();
+        return;
     }
 
-    std::string compilerVersion = compiler.GetVersion();
+    if (job.compileSpirv && !job.spirv.success)
+    {
+        err << "[WARNING] " << shader.name << ": SPIR-V compilation failed\n";
+    }
 
-    // Load hash cache
-    HashCache cache;
-    cache.SetCompilerVersion(compilerVersion);
+    // Targets that were up to date stay valid, a failed SPIR-V target is compiled again next run
+    bool spirvValid = !job.compileSpirv || job.spirv.success;
+    UpdateCacheEntry(job, dxilOutput, spirvOutput, spirvValid, cache);
 
-    bool cacheLoaded = cache.Load(opts.cachePath);
-    bool forceRebuild = opts.force;
+    entry.outputPath = dxilOutput;
+    entry.oldHash = job.cachedHash;
+    entry.newHash = job.currentHash;
 
-    if (cacheLoaded && cache.CompilerVersionChanged(compilerVersion))
+    // Report the output statistics, and the ones that grew since the previous build (occupancy risks)
+    std::vector<std::string> targetStats;
+    if (job.compileDxil && job.dxil.stats.valid)
     {
-        std::cout << "Compiler version changed, forcing full rebuild\n";
-        forceRebuild = true;
+        targetStats.push_back("DXIL " + job.dxil.stats.ToString());
+        auto regressions = ShaderStats::FindRegressions(job.cachedDxilStats, job.dxil.stats, "DXIL");
+        entry.regressions.insert(entry.regressions.end(), regressions.begin(), regressions.end());
+    }
+    if (job.compileSpirv && job.spirv.stats.valid)
+    {
+        targetStats.push_back("SPIR-V " + job.spirv.stats.ToString());
+        auto regressions = ShaderStats::FindRegressions(job.cachedSpirvStats, job.spirv.stats, "SPIR-V");
+        entry.regressions.insert(entry.regressions.end(), regressions.begin(), regressions.end());
+    }
+    for (size_t i = 0; i < targetStats.size(); ++i)
+    {
+        entry.stats += (i > 0 ? "; " : "") + targetStats[i];
+    }
+    for (const std::string& regression : entry.regressions)
+    {
+        err << "[WARNING] " << shader.name << ": " << regression << "\n";
+    }
+    if (opts.verbose && !entry.stats.empty())
+    {
+        out << "[STATS] " << shader.name << ": " << entry.stats << "\n";
     }
 
-    // Setup logger
-    Logger logger;
-    logger.SetCompilerVersion(compilerVersion);
-    logger.SetIncrementalMode(!forceRebuild);
+    bool fetched = (!job.compileDxil || job.dxil.fetched) && (!job.compileSpirv || job.spirv.fetched);
+    if (fetched)
+    {
+        entry.status = LogStatus::STATUS_FETCH;
+        entry.message = job.compileDxil ? job.dxil.storeKey : job.spirv.storeKey;
+
+        out << "[FETCH] " << shader.name << "\n";
+        result.fetched = true;
+        result.out = out.str();
+        result.err = err.str();
+        return;
+    }
 
-    // Setup include parser
-    IncludeParser includeParser;
-    std::string shaderDir = manifest.GetBasePath();
-    std::string rtxgiDir = shaderDir + "/../../rtxgi-sdk";  // Relative to test-harness
+    // The targets compile concurrently, the log reports their total compile time
+    double totalTime = job.dxil.compileTime + job.spirv.compileTime;
+    entry.status = job.isNew ? LogStatus::STATUS_NEW : LogStatus::STATUS_RECOMPILE;
+    entry.compileTime = totalTime;
 
-    includeParser.AddIncludeDirectory(shaderDir);
-    includeParser.AddIncludeDirectory(shaderDir + "/include");
-    includeParser.AddIncludeDirectory(shaderDir + "/shaders");
-    includeParser.AddIncludeDirectory(shaderDir + "/shaders/include");
-    includeParser.AddIncludeDirectory(shaderDir + "/shaders/ddgi");
-    includeParser.AddIncludeDirectory(shaderDir + "/../../include");
-    includeParser.AddIncludeDirectory(shaderDir + "/../../include/graphics");
-    includeParser.AddIncludeDirectory(rtxgiDir + "/include");
-    includeParser.AddIncludeDirectory(rtxgiDir + "/shaders");
+    // Name the target that was skipped because only the other target's branches changed
+    std::string skippedTarget;
+    if (!job.compileDxil) skippedTarget = "DXIL up to date";
+    else if (shader.generateSpirv && !job.compileSpirv) skippedTarget = "SPIR-V up to date";
 
-    // Create output directory
-    fs::create_directories(opts.outputDir);
+    if (!job.dxil.warningMessage.empty())
+    {
+        entry.status = LogStatus::STATUS_WARNING;
+        entry.message = job.dxil.warningMessage;
+    }
+    else if (!skippedTarget.empty())
+    {
+        entry.message = skippedTarget;
+    }
+
+    out << "[" << (job.isNew ? "NEW" : "RECOMPILE") << "] " << shader.name << " (";
+    if (!skippedTarget.empty()) out << skippedTarget << ", ";
+    out << std::fixed << std::setprecision(3) << totalTime << "s)\n";
+
+    result.compiled = true;
+    result.out = out.str();
+    result.err = err.str();
+}
+
+// The state of the tool, kept in memory between the builds of the watch mode
+struct BuildContext
+{
+    ShaderManifest manifest;
+    std::string projectRoot;
+    std::string shaderDir;
+    Compiler compiler;
+    std::vector<std::unique_ptr<Compiler>> threadCompilers;     // The compilers of the other compile threads, created when first needed
+    std::string compilerVersion;
+    HashCache cache;
+    IncludeParser includeParser;
+    BinaryStore store;
+    std::vector<std::vector<std::string>> dependencies;         // Per manifest shader: its source and includes (normalized), found by the last build
+};
 
-    // Process each shader
+struct BuildSummary
+{
     int compiled = 0;
+    int fetched = 0;
     int skipped = 0;
     int errors = 0;
+    std::vector<size_t> built;          // The shaders compiled or fetched
+};
 
-    for (const auto& shader : manifest.GetShaders())
+// Build the shaders that are out of date. With affected, shaders not marked are left alone (watch mode rebuilds).
+BuildSummary Build(BuildContext& ctx, const Options& opts, bool forceRebuild, const std::vector<bool>& affected)
+{
+    HashCache& cache = ctx.cache;
+    IncludeParser& includeParser = ctx.includeParser;
+    const BinaryStore& store = ctx.store;
+    const std::string& shaderDir = ctx.shaderDir;
+
+    // Setup logger
+    Logger logger;
+    logger.SetCompilerVersion(ctx.compilerVersion);
+    logger.SetIncrementalMode(!forceRebuild);
+
+    // File content hashes are memoized in the cache (by modification time and size)
+    auto hashFile = [&cache](const std::string& path) { return cache.GetFileHash(path); };
+    auto hashSpirvFile = [&cache](const std::string& path) { return cache.GetFileHash(path, true); };
+
+    // Find the shaders that need compiling: parse the includes and compare hashes (serial, cheap)
+    const auto& shaders = ctx.manifest.GetShaders();
+    std::vector<ShaderResult> results(shaders.size());
+    std::deque<CompileJob> jobs;        // Not a vector, the jobs aren't movable (and the tasks point to them)
+    ctx.dependencies.resize(shaders.size());
+
+    for (size_t slot = 0; slot < shaders.size(); ++slot)
     {
+        const auto& shader = shaders[slot];
+        ShaderResult& result = results[slot];
         std::string sourcePath = shaderDir + "/" + shader.path;
 
-        if (!fs::exists(sourcePath))
+        if (!affected.empty() && !affected[slot])
         {
-            LogEntry entry;
-            entry.status = LogStatus::STATUS_ERROR;
-            entry.shaderName = shader.name;
-            entry.profile = shader.profile;
-            entry.sourcePath = shader.path;
-            entry.message = "Source file not found: " + sourcePath;
-            logger.AddEntry(entry);
+            result.done = true;
+            continue;
+        }
 
-            std::cerr << "[ERROR] " << shader.name << ": Source file not found\n";
-            errors++;
+        if (!fs::exists(sourcePath))
+        {
+            ctx.dependencies[slot] = { Watcher::NormalizePath(sourcePath) };
+
+            result.hasEntry = true;
+            result.entry.status = LogStatus::STATUS_ERROR;
+            result.entry.shaderName = shader.name;
+            result.entry.profile = shader.profile;
+            result.entry.sourcePath = shader.path;
+            result.entry.message = "Source file not found: " + sourcePath;
+
+            result.err = "[ERROR] " + shader.name + ": Source file not found\n";
+            result.error = true;
+            result.done = true;
             continue;
         }
 
@@ -211,179 +549,399 @@ int main(int argc, char* argv[])
 
         // Compute hash
         std::string currentHash = Hash::ComputeShaderHash(
-            sourcePath, includes, shader.defines, shader.profile, shader.entryPoint);
+            sourcePath, includes, shader.defines, shader.profile, shader.entryPoint, hashFile);
 
-        std::string cachedHash = cache.GetCachedHash(shader.name);
+        // The SPIR-V target only depends on the includes and branches it sees,
+        // it is not recompiled when only D3D12 specific code changed
+        std::string currentSpirvHash;
+        std::vector<std::string> spirvIncludes;
+        if (shader.generateSpirv)
+        {
+            spirvIncludes = includeParser.ParseDependencies(sourcePath, true);
+            currentSpirvHash = Hash::ComputeShaderHash(
+                sourcePath, spirvIncludes, shader.defines, shader.profile, shader.entryPoint, hashSpirvFile);
+        }
 
-        // Check if up to date
-        std::string dxilOutput = opts.outputDir + "/" + shader.name + ".dxil";
-        std::string spirvOutput = opts.outputDir + "/" + shader.name + ".spv";
+        // Remember the files the shader depends on, the watch mode rebuilds it when one of them changes
+        std::vector<std::string>& dependencies = ctx.dependencies[slot];
+        dependencies = { Watcher::NormalizePath(sourcePath) };
+        for (const std::string& include : includes) dependencies.push_back(Watcher::NormalizePath(include));
 
-        bool needsCompile = forceRebuild || !cache.IsUpToDate(shader.name, currentHash);
-        bool isNew = !cache.HasEntry(shader.name);
+        // Check if up to date
+        bool compileDxil = forceRebuild || !cache.IsUpToDate(shader.name, currentHash);
+        bool compileSpirv = shader.generateSpirv && (forceRebuild || !cache.IsSpirvUpToDate(shader.name, currentSpirvHash));
 
-        if (!needsCompile)
+        if (!compileDxil && !compileSpirv)
         {
             // Skip - up to date
-            LogEntry entry;
-            entry.status = LogStatus::STATUS_SKIP;
-            entry.shaderName = shader.name;
-            entry.profile = shader.profile;
-            entry.sourcePath = shader.path;
-            entry.newHash = currentHash;
-            logger.AddEntry(entry);
+            result.hasEntry = true;
+            result.entry.status = LogStatus::STATUS_SKIP;
+            result.entry.shaderName = shader.name;
+            result.entry.profile = shader.profile;
+            result.entry.sourcePath = shader.path;
+            result.entry.newHash = currentHash;
 
             if (opts.verbose)
             {
-                std::cout << "[SKIP] " << shader.name << " (up to date)\n";
+                result.out = "[SKIP] " + shader.name + " (up to date)\n";
             }
-            skipped++;
+            result.skipped = true;
+            result.done = true;
             continue;
         }
 
         if (opts.dryRun)
         {
-            std::cout << "[WOULD COMPILE] " << shader.name << "\n";
+            result.out = "[WOULD COMPILE] " + shader.name + (!compileDxil ? " (SPIR-V only)" : (shader.generateSpirv && !compileSpirv) ? " (DXIL only)" : "") + "\n";
+            result.done = true;
             continue;
         }
 
-        // Compile DXIL
+        CompileJob& job = jobs.emplace_back();
+        job.slot = slot;
+        job.shader = &shader;
+        job.sourcePath = sourcePath;
+        job.includes.assign(includes.begin(), includes.end());
+        job.spirvIncludes.assign(spirvIncludes.begin(), spirvIncludes.end());
+        job.currentHash = currentHash;
+        job.cachedHash = cache.GetCachedHash(shader.name);
+        job.currentSpirvHash = currentSpirvHash;
+        job.compileDxil = compileDxil;
+        job.compileSpirv = compileSpirv;
+        job.isNew = !cache.HasEntry(shader.name);
+        job.cachedDxilStats = ShaderStats::Parse(cache.GetCachedStats(shader.name, false));
+        job.cachedSpirvStats = ShaderStats::Parse(cache.GetCachedStats(shader.name, true));
+    }
+
+    // Split the jobs into their targets, so a shader's DXIL and SPIR-V compile concurrently
+    std::vector<CompileTask> tasks;
+    for (CompileJob& job : jobs)
+    {
+        if (job.compileDxil) tasks.push_back({ &job, false });
+        if (job.compileSpirv) tasks.push_back({ &job, true });
+        job.pendingTasks = (job.compileDxil ? 1 : 0) + (job.compileSpirv ? 1 : 0);
+    }
+
+    // Write the results (console and log) in manifest order, as soon as every earlier shader is done
+    BuildSummary summary;
+
+    std::mutex resultsMutex;
+    size_t nextResult = 0;
+    auto flushResults = [&]()
+    {
+        while (nextResult < results.size() && results[nextResult].done)
+        {
+            size_t slot = nextResult++;
+            const ShaderResult& result = results[slot];
+            if (!result.out.empty()) std::cout << result.out << std::flush;
+            if (!result.err.empty()) std::cerr << result.err << std::flush;
+            if (result.hasEntry) logger.AddEntry(result.entry);
+            if (result.compiled) summary.compiled++;
+            if (result.fetched) summary.fetched++;
+            if (result.skipped) summary.skipped++;
+            if (result.error) summary.errors++;
+            if (result.compiled || result.fetched) summary.built.push_back(slot);
+        }
+    };
+    flushResults();
+
+    // Compile on a pool of threads, each with its own DXC compiler instance
+    Profiler profiler;
+    bool profile = !opts.profilePath.empty() && !opts.dryRun;
+    if (!tasks.empty())
+    {
+        unsigned int threadCount = (opts.jobs > 0) ? (unsigned int)opts.jobs : std::thread::hardware_concurrency();
+        threadCount = std::max(1u, std::min(threadCount, (unsigned int)tasks.size()));
+
+        // The compilers are kept for the next build of the watch mode
+        while (ctx.threadCompilers.size() + 1 < threadCount)
+        {
+            auto threadCompiler = std::make_unique<Compiler>();
+            if (!threadCompiler->Initialize(ctx.projectRoot))
+            {
+                std::cerr << "Warning: Failed to initialize compiler: " << threadCompiler->GetLastError() << "\n";
+                break;
+            }
+            ctx.threadCompilers.push_back(std::move(threadCompiler));
+        }
+        threadCount = std::min(threadCount, (unsigned int)ctx.threadCompilers.size() + 1);
+
         if (opts.verbose)
         {
-            std::cout << "[COMPILE] " << shader.name << " -> DXIL\n";
-        }
-
-        // Get shader's directory for relative includes
-        fs::path shaderPath(sourcePath);
-        std::string shaderParentDir = shaderPath.parent_path().string();
-        std::string rtxgiDir = shaderDir + "/../../rtxgi-sdk";
-
-        std::vector<std::string> includeDirs = {
-            shaderDir,
-            shaderDir + "/include",
-            shaderDir + "/shaders",
-            shaderDir + "/shaders/include",
-            shaderDir + "/shaders/ddgi",
-            shaderDir + "/../..",  // For samples/test-harness relative paths
-            shaderDir + "/../../include",  // For Types.h etc
-            shaderDir + "/../../include/graphics",
-            rtxgiDir + "/include",
-            rtxgiDir + "/shaders",
-            rtxgiDir + "/shaders/ddgi",
-            rtxgiDir + "/shaders/ddgi/include",
-            shaderParentDir,
-            shaderParentDir + "/../include",
-            shaderParentDir + "/../../include"
+            std::cout << "Compiling " << jobs.size() << " shader(s) (" << tasks.size() << " target(s)) on " << threadCount << " thread(s)\n";
+        }
+
+        profiler.Start(threadCount, ctx.projectRoot);
+
+        std::atomic<size_t> nextTask{ 0 };
+        auto worker = [&](Compiler& threadCompiler, unsigned int threadIndex)
+        {
+            for (size_t taskIndex = nextTask++; taskIndex < tasks.size(); taskIndex = nextTask++)
+            {
+                CompileJob& job = *tasks[taskIndex].job;
+                bool spirv = tasks[taskIndex].spirv;
+                TargetResult& target = spirv ? job.spirv : job.dxil;
+
+                double start = profiler.GetTime();
+                CompileTarget(threadCompiler, job, spirv, opts, shaderDir, store, target);
+                if (profile)
+                {
+                    ProfiledTask task;
+                    task.shaderName = job.shader->name;
+                    task.target = spirv ? "SPIR-V" : "DXIL";
+                    task.thread = threadIndex;
+                    task.start = start;
+                    task.end = profiler.GetTime();
+                    task.fetched = target.fetched;
+                    task.includes = spirv ? job.spirvIncludes : job.includes;
+                    profiler.AddTask(std::move(task));
+                }
+
+                // The other target of the shader is still compiling
+                if (--job.pendingTasks > 0) continue;
+
+                ShaderResult result;
+                FinishShader(job, opts, cache, result);
+                result.done = true;
+
+                std::lock_guard<std::mutex> lock(resultsMutex);
+                results[job.slot] = std::move(result);
+                flushResults();
+            }
         };
 
-        auto dxilResult = compiler.CompileDXIL(
-            sourcePath, shader.entryPoint, shader.profile, shader.defines, includeDirs);
+        std::vector<std::thread> threads;
+        for (unsigned int i = 1; i < threadCount; ++i)
+        {
+            threads.emplace_back(worker, std::ref(*ctx.threadCompilers[i - 1]), i);
+        }
+        worker(ctx.compiler, 0);  // The main thread works too
 
-        if (!dxilResult.success)
+        for (auto& thread : threads)
         {
-            LogEntry entry;
-            entry.status = LogStatus::STATUS_ERROR;
-            entry.shaderName = shader.name;
-            entry.profile = shader.profile;
-            entry.sourcePath = shader.path;
-            entry.message = dxilResult.errorMessage;
-            logger.AddEntry(entry);
+            thread.join();
+        }
+        profiler.Finish();
+    }
 
-            std::cerr << "[ERROR] " << shader.name << ": " << dxilResult.errorMessage << "\n";
-            errors++;
-            continue;
+    // Write the compile time profile
+    if (profile)
+    {
+        profiler.SetChangedFiles(cache.GetChangedFiles());
+        if (!profiler.WriteJson(opts.profilePath + ".json") || !profiler.WriteText(opts.profilePath + ".txt"))
+        {
+            std::cerr << "Warning: Failed to write the compile profile to " << opts.profilePath << "\n";
         }
+        else
+        {
+            std::cout << "\nProfile written to: " << opts.profilePath << ".json and " << opts.profilePath << ".txt\n";
+        }
+    }
 
-        // Save DXIL
-        if (!compiler.SaveBytecode(dxilResult.bytecode, dxilOutput))
+    // Save cache
+    if (!opts.dryRun)
+    {
+        if (!cache.Save(opts.cachePath))
         {
-            std::cerr << "[ERROR] " << shader.name << ": Failed to save DXIL\n";
-            errors++;
-            continue;
+            std::cerr << "Warning: Failed to save the hash cache to " << opts.cachePath << "\n";
+        }
+        if (!opts.exportCachePath.empty() && !cache.ExportJson(opts.exportCachePath))
+        {
+            std::cerr << "Warning: Failed to export the hash cache to " << opts.exportCachePath << "\n";
+        }
+    }
+
+    // Write log
+    if (!opts.dryRun)
+    {
+        logger.WriteToFile(opts.logPath);
+        std::cout << "\nLog written to: " << opts.logPath << "\n";
+    }
+
+    return summary;
+}
+
+// Watch the shader sources and the manifest, rebuild the shaders depending on the changed files.
+// Runs until the process is stopped, the cache and log are written after each build.
+int Watch(BuildContext& ctx, const Options& opts)
+{
+    HarnessNotifier notifier;
+    if (opts.notifyPort != 0 && !notifier.Initialize((uint16_t)opts.notifyPort))
+    {
+        std::cerr << "Error: " << notifier.GetLastError() << "\n";
+        return 1;
+    }
+
+    Watcher watcher;
+    std::string manifestPath = Watcher::NormalizePath(opts.manifestPath);
+    while (true)
+    {
+        // Watch the files of the last build, new includes are picked up by the rebuild of their shaders
+        std::vector<std::string> files = { manifestPath };
+        for (const auto& dependencies : ctx.dependencies)
+        {
+            files.insert(files.end(), dependencies.begin(), dependencies.end());
         }
+        watcher.SetFiles(files);
 
-        // Compile SPIR-V if requested
-        double totalTime = dxilResult.compileTime;
+        std::cout << "\n[WATCH] Watching " << ctx.manifest.GetShaders().size() << " shader(s)" << (watcher.IsNotifying() ? "" : " (polling)") << ", Ctrl+C to stop\n" << std::flush;
+        std::vector<std::string> changed = watcher.WaitForChanges();
+        auto start = std::chrono::steady_clock::now();
 
-        if (shader.generateSpirv)
+        for (const std::string& file : changed)
         {
-            if (opts.verbose)
-            {
-                std::cout << "[COMPILE] " << shader.name << " -> SPIR-V\n";
-            }
+            std::cout << "[CHANGED] " << file << "\n";
+        }
+        std::set<std::string> changedFiles(changed.begin(), changed.end());
 
-            auto spirvResult = compiler.CompileSPIRV(
-                sourcePath, shader.entryPoint, shader.profile, shader.defines, includeDirs);
+        // The file hashes and includes memoized in the cache are checked again
+        ctx.cache.RevalidateFiles();
 
-            if (spirvResult.success)
+        // Find the affected shaders through the dependencies of the last build, all of them when the manifest changed
+        std::vector<bool> affected(ctx.manifest.GetShaders().size(), false);
+        if (changedFiles.count(manifestPath))
+        {
+            ShaderManifest manifest;
+            if (!manifest.Load(opts.manifestPath))
             {
-                compiler.SaveBytecode(spirvResult.bytecode, spirvOutput);
-                totalTime += spirvResult.compileTime;
+                std::cerr << "Error: Failed to load manifest: " << opts.manifestPath << ", keeping the previous one\n";
+                continue;
             }
-            else
+            ctx.manifest = std::move(manifest);
+            ctx.dependencies.clear();
+            affected.assign(ctx.manifest.GetShaders().size(), true);
+        }
+        else
+        {
+            for (size_t slot = 0; slot < ctx.dependencies.size(); ++slot)
             {
-                std::cerr << "[WARNING] " << shader.name << ": SPIR-V compilation failed\n";
+                for (const std::string& dependency : ctx.dependencies[slot])
+                {
+                    if (changedFiles.count(dependency) == 0) continue;
+                    affected[slot] = true;
+                    break;
+                }
             }
         }
 
-        // Update cache
-        ShaderCacheEntry cacheEntry;
-        cacheEntry.hash = currentHash;
-        cacheEntry.sourcePath = shader.path;
-        cacheEntry.includes.assign(includes.begin(), includes.end());
-        cacheEntry.defines = shader.defines;
-        cacheEntry.outputDxil = dxilOutput;
-        cacheEntry.outputSpirv = shader.generateSpirv ? spirvOutput : "";
-        cacheEntry.lastCompiled = GetCurrentDateTime();
-        cache.UpdateEntry(shader.name, cacheEntry);
+        BuildSummary summary = Build(ctx, opts, false, affected);
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
 
-        // Log entry
-        LogEntry entry;
-        entry.status = isNew ? LogStatus::STATUS_NEW : LogStatus::STATUS_RECOMPILE;
-        entry.shaderName = shader.name;
-        entry.profile = shader.profile;
-        entry.sourcePath = shader.path;
-        entry.outputPath = dxilOutput;
-        entry.oldHash = cachedHash;
-        entry.newHash = currentHash;
-        entry.compileTime = totalTime;
+        std::cout << "[WATCH] Built " << summary.built.size() << " shader(s) in " << std::fixed << std::setprecision(0) << elapsed << "ms";
+        if (summary.errors > 0) std::cout << ", " << summary.errors << " error(s)";
+        std::cout << "\n";
 
-        if (!dxilResult.warningMessage.empty())
+        // Only error free builds reload the harness, its workloads reload all of their shaders
+        if (!notifier.IsEnabled() || summary.built.empty()) continue;
+        if (summary.errors > 0)
         {
-            entry.status = LogStatus::STATUS_WARNING;
-            entry.message = dxilResult.warningMessage;
+            std::cout << "[WATCH] Fix the errors to reload the test harness\n";
+            continue;
         }
 
-        logger.AddEntry(entry);
+        std::vector<std::string> sourcePaths;
+        for (size_t slot : summary.built)
+        {
+            sourcePaths.push_back(ctx.manifest.GetShaders()[slot].path);
+        }
+        if (!notifier.Send(sourcePaths))
+        {
+            std::cerr << "Warning: " << notifier.GetLastError() << "\n";
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options opts;
+    if (!ParseArgs(argc, argv, opts))
+    {
+        return 1;
+    }
 
-        std::cout << "[" << (isNew ? "NEW" : "RECOMPILE") << "] " << shader.name
-                  << " (" << std::fixed << std::setprecision(3) << totalTime << "s)\n";
+    std::cout << "=== Shader Precompiler ===\n";
 
-        compiled++;
+    // Load manifest
+    BuildContext ctx;
+    if (!ctx.manifest.Load(opts.manifestPath))
+    {
+        std::cerr << "Error: Failed to load manifest: " << opts.manifestPath << "\n";
+        return 1;
     }
 
-    // Save cache
-    if (!opts.dryRun)
+    std::cout << "Loaded " << ctx.manifest.GetShaders().size() << " shader definitions\n";
+
+    // Get project root (manifest is in samples/test-harness, so go up 2 levels)
+    fs::path manifestAbsPath = fs::absolute(opts.manifestPath);
+    ctx.projectRoot = manifestAbsPath.parent_path().parent_path().parent_path().string();
+
+    // Initialize compiler
+    if (!opts.dryRun && !ctx.compiler.Initialize(ctx.projectRoot))
     {
-        cache.Save(opts.cachePath);
+        std::cerr << "Error: Failed to initialize compiler: " << ctx.compiler.GetLastError() << "\n";
+        return 1;
     }
 
-    // Write log
-    if (!opts.dryRun)
+    ctx.compilerVersion = ctx.compiler.GetVersion();
+
+    // Load hash cache
+    HashCache& cache = ctx.cache;
+    cache.SetCompilerVersion(ctx.compilerVersion);
+
+    bool cacheLoaded = cache.Load(opts.cachePath);
+    bool forceRebuild = opts.force;
+
+    if (cacheLoaded && cache.CompilerVersionChanged(ctx.compilerVersion))
     {
-        logger.WriteToFile(opts.logPath);
-        std::cout << "\nLog written to: " << opts.logPath << "\n";
+        std::cout << "Compiler version changed, forcing full rebuild\n";
+        forceRebuild = true;
+    }
+
+    // Setup include parser
+    IncludeParser& includeParser = ctx.includeParser;
+    ctx.shaderDir = ctx.manifest.GetBasePath();
+    const std::string& shaderDir = ctx.shaderDir;
+    std::string rtxgiDir = shaderDir + "/../../rtxgi-sdk";  // Relative to test-harness
+
+    includeParser.AddIncludeDirectory(shaderDir);
+    includeParser.AddIncludeDirectory(shaderDir + "/include");
+    includeParser.AddIncludeDirectory(shaderDir + "/shaders");
+    includeParser.AddIncludeDirectory(shaderDir + "/shaders/include");
+    includeParser.AddIncludeDirectory(shaderDir + "/shaders/ddgi");
+    includeParser.AddIncludeDirectory(shaderDir + "/../../include");
+    includeParser.AddIncludeDirectory(shaderDir + "/../../include/graphics");
+    includeParser.AddIncludeDirectory(rtxgiDir + "/include");
+    includeParser.AddIncludeDirectory(rtxgiDir + "/shaders");
+    includeParser.SetCache(&cache);
+
+    // Create output directory
+    fs::create_directories(opts.outputDir);
+
+    // Setup the shared binary store
+    if (!opts.storeDir.empty() && !opts.dryRun && !ctx.store.Initialize(opts.storeDir))
+    {
+        std::cerr << "Error: " << ctx.store.GetLastError() << "\n";
+        return 1;
     }
 
+    BuildSummary summary = Build(ctx, opts, forceRebuild, {});
+
     // Summary
     std::cout << "\n=== Summary ===\n";
-    std::cout << "  Compiled: " << compiled << "\n";
-    std::cout << "  Skipped:  " << skipped << "\n";
-    std::cout << "  Errors:   " << errors << "\n";
+    std::cout << "  Compiled: " << summary.compiled << "\n";
+    if (ctx.store.IsEnabled()) std::cout << "  Fetched:  " << summary.fetched << "\n";
+    std::cout << "  Skipped:  " << summary.skipped << "\n";
+    std::cout << "  Errors:   " << summary.errors << "\n";
+
+    // The watch mode keeps going after errors, they are fixed by editing the sources
+    if (opts.watch)
+    {
+        return Watch(ctx, opts);
+    }
 
-    if (errors > 0)
+    if (summary.errors > 0)
     {
-        std::cerr << "\nBuild FAILED with " << errors << " error(s)\n";
+        std::cerr << "\nBuild FAILED with " << summary.errors << " error(s)\n";
         std::cerr << "See " << opts.logPath << " for details\n";
         return 1;
     }
@@ -28,6 +28,9 @@
 #include "ScenePrivate.h"
 
 #include "RenderGraphUtils.h"
+#include "RHIGPUReadback.h"
+#include "Misc/ScopeExit.h"
+#include "UObject/UObjectIterator.h"
 
 DECLARE_GPU_STAT_NAMED(RTXGI_Update, TEXT("RTXGI Update"));
 DECLARE_GPU_STAT_NAMED(RTXGI_ApplyLighting, TEXT("RTXGI Apply Lighting"));
@@ -45,6 +48,12 @@ static TAutoConsoleVariable<float> CVarLightingPassScale(
 	TEXT("Scale for the lighting pass resolution between 0.25 - 1.0 (value is clamped to this range).\n"),
 	ECVF_RenderThreadSafe | ECVF_Cheat);
 
+static TAutoConsoleVariable<int> CVarLightingPassCheckerboard(
+	TEXT("r.RTXGI.DDGI.LightingPass.Checkerboard"),
+	0,
+	TEXT("If 1, the lighting pass shades half of its pixels each frame in a checkerboard pattern and reconstructs the other half from the previous frame.\n"),
+	ECVF_RenderThreadSafe);
+
 static TAutoConsoleVariable<float> CVarRelativeDistanceThreshold(
 	TEXT("r.RTXGI.DDGI.LightingPass.RelativeDistanceThreshold"),
 	0.01f,
@@ -57,6 +66,69 @@ static TAutoConsoleVariable<float> CVarNormalPower(
 	TEXT("Normal power for geometry test in the lighting upscaler.\n"),
 	ECVF_RenderThreadSafe | ECVF_Cheat);
 
+static TAutoConsoleVariable<int> CVarDDGIQuality(
+	TEXT("r.RTXGI.Quality"),
+	-1,
+	TEXT("Quality level of the DDGI volume updates, scaling the rays per probe and the fraction of probes updated each frame.\n")
+	TEXT(" -1: follow sg.GlobalIlluminationQuality (default)\n")
+	TEXT("  0: low, 1: medium, 2: high, 3: epic (the volume settings), 4: cinematic\n"),
+	ECVF_RenderThreadSafe);
+
+namespace DDGIQuality
+{
+	struct FLevel
+	{
+		float RaysPerProbeScale;    // Scale of the volume's rays per probe, rounded to the nearest supported count
+		float ProbeUpdateFraction;  // Fraction of the probes traced each frame, round robin within the volume
+	};
+
+	static const FLevel c_levels[] =
+	{
+		{ 0.5f, 0.25f },
+		{ 0.5f, 0.5f },
+		{ 0.75f, 0.75f },
+		{ 1.0f, 1.0f },
+		{ 1.5f, 1.0f },
+	};
+
+	static int GetLevel()
+	{
+		int Quality = CVarDDGIQuality.GetValueOnAnyThread();
+		if (Quality < 0)
+		{
+			static const auto CVarGIQuality = IConsoleManager::Get().FindTConsoleVariableDataInt(TEXT("sg.GlobalIlluminationQuality"));
+			Quality = CVarGIQuality ? CVarGIQuality->GetValueOnAnyThread() : 3;
+		}
+		return FMath::Clamp(Quality, 0, int(UE_ARRAY_COUNT(c_levels)) - 1);
+	}
+
+	static EDDGIRaysPerProbe ScaleRaysPerProbe(EDDGIRaysPerProbe RaysPerProbe, float Scale)
+	{
+		int Rays = FMath::RoundToInt(int(RaysPerProbe) * Scale / 144.0f) * 144;
+		return EDDGIRaysPerProbe(FMath::Clamp(Rays, int(EDDGIRaysPerProbe::n144), int(EDDGIRaysPerProbe::n1008)));
+	}
+
+	// The rays per probe and update fraction reach the render thread with the rest of the component data,
+	// so push it again from every volume when the effective quality level changes
+	static void OnConsoleVariablesChanged()
+	{
+		static int LastLevel = -1;
+		int Level = GetLevel();
+		if (Level == LastLevel) return;
+
+		bool bFirstCall = (LastLevel < 0);
+		LastLevel = Level;
+		if (bFirstCall) return;
+
+		for (TObjectIterator<UDDGIVolumeComponent> It; It; ++It)
+		{
+			It->MarkRenderDynamicDataDirty();
+		}
+	}
+
+	static FAutoConsoleVariableSink CVarSink(FConsoleCommandDelegate::CreateStatic(&OnConsoleVariablesChanged));
+}
+
 BEGIN_SHADER_PARAMETER_STRUCT(FVolumeData, )
 	SHADER_PARAMETER_RDG_TEXTURE(Texture2D, ProbeIrradiance)
 	SHADER_PARAMETER_RDG_TEXTURE(Texture2D, ProbeDistance)
@@ -87,16 +159,40 @@ BEGIN_SHADER_PARAMETER_STRUCT(FApplyLightingDeferredShaderParameters, )
 	SHADER_PARAMETER_RDG_TEXTURE(Texture2D, MetallicTexture)
 	SHADER_PARAMETER_RDG_TEXTURE(Texture2D, LightingChannelsTexture)
 	SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, LightingPassUAV)
+	SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, AccumulationUAV)
+	SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, VolumeClusterMasks)
 	SHADER_PARAMETER_SAMPLER(SamplerState, PointClampSampler)
 	SHADER_PARAMETER_SAMPLER(SamplerState, LinearClampSampler)
 	SHADER_PARAMETER(FVector4, ScaledViewSizeAndInvSize)
 	SHADER_PARAMETER(int32, ShouldUsePreExposure)
 	SHADER_PARAMETER(int32, NumVolumes)
-	// Volumes are sorted from densest probes to least dense probes
+	SHADER_PARAMETER(int32, FirstBatch)
+	SHADER_PARAMETER(int32, LastBatch)
+	SHADER_PARAMETER(FIntVector, ClusterGridSize)
+	SHADER_PARAMETER(int32, ClusterTileSize)
+	SHADER_PARAMETER(int32, ClusterMaskOffset)
+	SHADER_PARAMETER(float, ClusterNearDepth)
+	SHADER_PARAMETER(float, ClusterDepthScale)
+	SHADER_PARAMETER(int32, CheckerboardParity)
+	// Volumes of the batch, sorted by lighting priority and then from densest probes to least dense probes
 	SHADER_PARAMETER_STRUCT_ARRAY(FVolumeData, DDGIVolume, [FDDGIVolumeSceneProxy::FComponentData::c_RTXGI_DDGI_MAX_SHADING_VOLUMES])
 	SHADER_PARAMETER_STRUCT_REF(FViewUniformShaderParameters, ViewUniformBuffer)
 END_SHADER_PARAMETER_STRUCT()
 
+BEGIN_SHADER_PARAMETER_STRUCT(FCheckerboardResolveShaderParameters, )
+	SHADER_PARAMETER_RDG_TEXTURE(Texture2D, InputGITexture)
+	SHADER_PARAMETER_RDG_TEXTURE(Texture2D, HistoryGITexture)
+	SHADER_PARAMETER_RDG_TEXTURE(Texture2D, DepthTexture)
+	SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, ResolvedGIOutput)
+	SHADER_PARAMETER_SAMPLER(SamplerState, PointClampSampler)
+	SHADER_PARAMETER_SAMPLER(SamplerState, LinearClampSampler)
+	SHADER_PARAMETER(FVector4, InputViewSizeAndInvSize)
+	SHADER_PARAMETER(uint32, CheckerboardParity)
+	SHADER_PARAMETER(uint32, HistoryValid)
+	SHADER_PARAMETER(float, HistoryPreExposureCorrection)
+	SHADER_PARAMETER_STRUCT_REF(FViewUniformShaderParameters, ViewUniformBuffer)
+END_SHADER_PARAMETER_STRUCT()
+
 BEGIN_SHADER_PARAMETER_STRUCT(FUpscaleLightingShaderParameters, )
 	SHADER_PARAMETER_RDG_TEXTURE(Texture2D, InputGITexture)
 	SHADER_PARAMETER_RDG_TEXTURE(Texture2D, NormalTexture)
@@ -171,7 +267,22 @@ public:
 	}
 };
 
+class FCheckerboardResolveShaderCS : public FGlobalShader
+{
+public:
+	DECLARE_GLOBAL_SHADER(FCheckerboardResolveShaderCS);
+	SHADER_USE_PARAMETER_STRUCT(FCheckerboardResolveShaderCS, FGlobalShader);
+
+	using FParameters = FCheckerboardResolveShaderParameters;
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+};
+
 IMPLEMENT_GLOBAL_SHADER(FApplyLightingDeferredShaderCS, "/Plugin/RTXGI/Private/ApplyLightingDeferred.usf", "MainCS", SF_Compute);
+IMPLEMENT_GLOBAL_SHADER(FCheckerboardResolveShaderCS, "/Plugin/RTXGI/Private/CheckerboardResolve.usf", "MainCS", SF_Compute);
 IMPLEMENT_GLOBAL_SHADER(FUpscaleLightingShaderCS, "/Plugin/RTXGI/Private/UpscaleLighting.usf", "MainCS", SF_Compute);
 
 // Delegate Handles
@@ -181,6 +292,132 @@ FDelegateHandle FDDGIVolumeSceneProxy::RenderDiffuseIndirectLightHandle;
 TSet<FDDGIVolumeSceneProxy*> FDDGIVolumeSceneProxy::AllProxiesReadyForRender_RenderThread;
 TMap<const FSceneInterface*, float> FDDGIVolumeSceneProxy::SceneRoundRobinValue;
 
+// The resolved checkerboard lighting of a view, reprojected by the view's next frame
+struct FCheckerboardHistory
+{
+	TRefCountPtr<IPooledRenderTarget> Texture;
+	uint32 LastFrame = 0;
+	float PreExposure = 1.0f;
+};
+static TMap<uint32, TUniquePtr<FCheckerboardHistory>> CheckerboardHistories;
+
+// Screen tile size (in lighting pass pixels) and the number of depth slices of the volume cluster grid
+static const int32 c_ClusterTileSize = 64;
+static const int32 c_ClusterDepthSlices = 16;
+
+// A froxel grid over the view, each cluster holds a bit mask (per shading batch) of the volumes that overlap it
+struct FVolumeClusterGrid
+{
+	FIntVector Size = FIntVector(1, 1, 1);
+	float NearDepth = 1.0f;
+	float DepthScale = 0.0f;    // Depth slices per unit of log(depth / NearDepth)
+	TArray<uint32> Masks;       // Size.X * Size.Y * Size.Z masks per batch
+};
+
+// Bin the volumes (boxes in [-1, 1] transformed by VolumeToWorld) into screen tiles and exponential depth slices,
+// from their projected screen rectangles and view depth ranges
+static void BuildVolumeClusterGrid(const FViewInfo& View, FIntPoint ViewSize, const TArray<FMatrix>& VolumeToWorld, int32 BatchSize, FVolumeClusterGrid& Grid)
+{
+	int32 NumBatches = FMath::DivideAndRoundUp(VolumeToWorld.Num(), BatchSize);
+
+	// Orthographic views aren't clustered, every volume is relevant to every pixel
+	if (!View.IsPerspectiveProjection())
+	{
+		Grid.Size = FIntVector(1, 1, 1);
+		Grid.Masks.Init(0, NumBatches);
+		for (int32 volumeIndex = 0; volumeIndex < VolumeToWorld.Num(); ++volumeIndex)
+		{
+			Grid.Masks[volumeIndex / BatchSize] |= 1u << (volumeIndex % BatchSize);
+		}
+		return;
+	}
+
+	const FMatrix& ViewMatrix = View.ViewMatrices.GetViewMatrix();
+	const FMatrix& ProjectionMatrix = View.ViewMatrices.GetProjectionMatrix();
+	float NearDepth = FMath::Max(View.NearClippingDistance, 1.0f);
+	float FarDepth = NearDepth * 2.0f;
+
+	struct FVolumeExtent
+	{
+		float MinDepth = FLT_MAX;
+		float MaxDepth = -FLT_MAX;
+		FVector2D MinPixel = FVector2D(FLT_MAX, FLT_MAX);
+		FVector2D MaxPixel = FVector2D(-FLT_MAX, -FLT_MAX);
+	};
+
+	TArray<FVolumeExtent> Extents;
+	for (const FMatrix& Transform : VolumeToWorld)
+	{
+		FVolumeExtent Extent;
+		bool bCrossesNearPlane = false;
+		for (int32 corner = 0; corner < 8; ++corner)
+		{
+			FVector Local((corner & 1) ? 1.0f : -1.0f, (corner & 2) ? 1.0f : -1.0f, (corner & 4) ? 1.0f : -1.0f);
+			FVector ViewPosition = ViewMatrix.TransformPosition(Transform.TransformPosition(Local));
+			Extent.MinDepth = FMath::Min(Extent.MinDepth, ViewPosition.Z);
+			Extent.MaxDepth = FMath::Max(Extent.MaxDepth, ViewPosition.Z);
+			if (ViewPosition.Z < NearDepth)
+			{
+				bCrossesNearPlane = true;
+				continue;
+			}
+
+			FVector4 Clip = ProjectionMatrix.TransformFVector4(FVector4(ViewPosition, 1.0f));
+			FVector2D Pixel((Clip.X / Clip.W * 0.5f + 0.5f) * ViewSize.X, (0.5f - Clip.Y / Clip.W * 0.5f) * ViewSize.Y);
+			Extent.MinPixel = FVector2D(FMath::Min(Extent.MinPixel.X, Pixel.X), FMath::Min(Extent.MinPixel.Y, Pixel.Y));
+			Extent.MaxPixel = FVector2D(FMath::Max(Extent.MaxPixel.X, Pixel.X), FMath::Max(Extent.MaxPixel.Y, Pixel.Y));
+		}
+
+		// A volume that crosses the near plane can cover any part of the screen
+		if (bCrossesNearPlane)
+		{
+			Extent.MinPixel = FVector2D(0.0f, 0.0f);
+			Extent.MaxPixel = FVector2D(ViewSize.X, ViewSize.Y);
+		}
+
+		FarDepth = FMath::Max(FarDepth, Extent.MaxDepth);
+		Extents.Add(Extent);
+	}
+
+	Grid.Size = FIntVector(FMath::DivideAndRoundUp(ViewSize.X, c_ClusterTileSize), FMath::DivideAndRoundUp(ViewSize.Y, c_ClusterTileSize), c_ClusterDepthSlices);
+	Grid.NearDepth = NearDepth;
+	Grid.DepthScale = float(c_ClusterDepthSlices) / FMath::Loge(FarDepth / NearDepth);
+
+	int32 NumClusters = Grid.Size.X * Grid.Size.Y * Grid.Size.Z;
+	Grid.Masks.Init(0, NumClusters * NumBatches);
+
+	auto GetSlice = [&Grid](float Depth)
+	{
+		return FMath::Clamp(FMath::FloorToInt(FMath::Loge(FMath::Max(Depth, Grid.NearDepth) / Grid.NearDepth) * Grid.DepthScale), 0, Grid.Size.Z - 1);
+	};
+
+	for (int32 volumeIndex = 0; volumeIndex < Extents.Num(); ++volumeIndex)
+	{
+		const FVolumeExtent& Extent = Extents[volumeIndex];
+		if (Extent.MaxDepth < NearDepth) continue;
+
+		int32 MinX = FMath::Clamp(FMath::FloorToInt(Extent.MinPixel.X / c_ClusterTileSize), 0, Grid.Size.X - 1);
+		int32 MaxX = FMath::Clamp(FMath::FloorToInt(Extent.MaxPixel.X / c_ClusterTileSize), 0, Grid.Size.X - 1);
+		int32 MinY = FMath::Clamp(FMath::FloorToInt(Extent.MinPixel.Y / c_ClusterTileSize), 0, Grid.Size.Y - 1);
+		int32 MaxY = FMath::Clamp(FMath::FloorToInt(Extent.MaxPixel.Y / c_ClusterTileSize), 0, Grid.Size.Y - 1);
+		int32 MinZ = GetSlice(Extent.MinDepth);
+		int32 MaxZ = GetSlice(Extent.MaxDepth);
+
+		uint32 Bit = 1u << (volumeIndex % BatchSize);
+		uint32* BatchMasks = &Grid.Masks[(volumeIndex / BatchSize) * NumClusters];
+		for (int32 z = MinZ; z <= MaxZ; ++z)
+		{
+			for (int32 y = MinY; y <= MaxY; ++y)
+			{
+				for (int32 x = MinX; x <= MaxX; ++x)
+				{
+					BatchMasks[(z * Grid.Size.Y + y) * Grid.Size.X + x] |= Bit;
+				}
+			}
+		}
+	}
+}
+
 bool FDDGIVolumeSceneProxy::IntersectsViewFrustum(const FViewInfo& View)
 {
 	// Get the volume position and scale
@@ -350,6 +587,15 @@ void FDDGIVolumeSceneProxy::RenderDiffuseIndirectLight_RenderThread(
 		DDGIVolumeUpdate::DDGIUpdatePerFrame_RenderThread(Scene, View, GraphBuilder);
 	}
 
+	// The probe texture copies made for an async compute update only live in this render graph
+	ON_SCOPE_EXIT
+	{
+		for (FDDGIVolumeSceneProxy* volumeProxy : AllProxiesReadyForRender_RenderThread)
+		{
+			volumeProxy->LightingTextures = FLightingTextures();
+		}
+	};
+
 	// Register the GBuffer textures with the render graph
 	FRDGTextureRef GBufferATexture = GraphBuilder.RegisterExternalTexture(Resources.GBufferA);
 	FRDGTextureRef GBufferBTexture = GraphBuilder.RegisterExternalTexture(Resources.GBufferB);
@@ -363,6 +609,13 @@ void FDDGIVolumeSceneProxy::RenderDiffuseIndirectLight_RenderThread(
 	uint32 ScaledViewSizeY = FMath::Max(1, FMath::CeilToInt(View.ViewRect.Size().Y * ScreenScale));
 	FIntPoint ScaledViewSize = FIntPoint(ScaledViewSizeX, ScaledViewSizeY);
 
+	// The checkerboard needs a view with persistent state to alternate the shaded pixels and keep its history
+	bool bCheckerboard = CVarLightingPassCheckerboard.GetValueOnRenderThread() != 0 && View.ViewState != nullptr;
+	int32 checkerboardParity = bCheckerboard ? int32(View.ViewState->GetFrameIndex() & 1) : -1;
+
+	// The lighting pass applies to the scene color directly, unless it is scaled or checkerboarded and then composited by the upscaler
+	bool bSeparateLightingPass = CVarLightingPassScale.GetValueOnRenderThread() < 1.0f || bCheckerboard;
+
 	FRDGTextureDesc RTXGILightingPassOutputDesc = FRDGTextureDesc::Create2D(
 		ScaledViewSize,
 		SceneColorTexture->Desc.Format,
@@ -419,10 +672,7 @@ void FDDGIVolumeSceneProxy::RenderDiffuseIndirectLight_RenderThread(
 		// Early out if no volumes contribute light to the current view
 		if (volumes.Num() == 0) return;
 
-		// TODO: manage in-frustum volumes in a more sophisticated way
-		// Support a large number of volumes by culling volumes based on spatial data, projected view area, and/or other heuristics
-
-		// Sort the in-frustum volumes by user specified priority and probe density
+		// Sort the in-frustum volumes by user specified priority and probe density, the order they blend in
 		Algo::Sort(volumes, [](const FProxyEntry& A, const FProxyEntry& B)
 		{
 			if (A.proxy->ComponentData.LightingPriority < B.proxy->ComponentData.LightingPriority) return true;
@@ -430,19 +680,39 @@ void FDDGIVolumeSceneProxy::RenderDiffuseIndirectLight_RenderThread(
 			return false;
 		});
 
-		// Get the number of relevant in-frustum volumes
-		int32 numVolumes = FMath::Min(volumes.Num(), FDDGIVolumeSceneProxy::FComponentData::c_RTXGI_DDGI_MAX_SHADING_VOLUMES);
+		// Shade the volumes in batches, the blend carries over between batches in an accumulation texture
+		const int32 batchSize = FDDGIVolumeSceneProxy::FComponentData::c_RTXGI_DDGI_MAX_SHADING_VOLUMES;
+		int32 numBatches = FMath::DivideAndRoundUp(volumes.Num(), batchSize);
 
-		// Truncate the in-frustum volumes list to the maximum number of volumes supported
-		volumes.SetNum(numVolumes, true);
-
-		// Sort the final volume list by descending probe density
-		Algo::Sort(volumes, [](const FProxyEntry& A, const FProxyEntry& B)
+		// Bin the volumes into clusters, so pixels only evaluate the volumes that overlap their cluster
+		TArray<FMatrix> volumeToWorld;
+		for (const FProxyEntry& volume : volumes)
 		{
-			return (A.Density > B.Density);
-		});
+			volumeToWorld.Add(FTransform(volume.Rotation, volume.Position, volume.Scale * 100.0f).ToMatrixWithScale());
+		}
+
+		FVolumeClusterGrid clusterGrid;
+		BuildVolumeClusterGrid(View, ScaledViewSize, volumeToWorld, batchSize, clusterGrid);
+		int32 numClusters = clusterGrid.Size.X * clusterGrid.Size.Y * clusterGrid.Size.Z;
 
-		if (CVarLightingPassScale.GetValueOnRenderThread() < 1.0f)
+		FRDGBufferRef clusterMasks = CreateVertexBuffer(
+			GraphBuilder,
+			TEXT("DDGIVolumeClusterMasks"),
+			FRDGBufferDesc::CreateBufferDesc(sizeof(uint32), clusterGrid.Masks.Num()),
+			clusterGrid.Masks.GetData(),
+			clusterGrid.Masks.Num() * clusterGrid.Masks.GetTypeSize());
+		FRDGBufferSRVRef clusterMasksSRV = GraphBuilder.CreateSRV(clusterMasks, PF_R32_UINT);
+
+		// The accumulation texture is only read and written when there is more than one batch
+		FRDGTextureDesc AccumulationDesc = FRDGTextureDesc::Create2D(
+			(numBatches > 1) ? ScaledViewSize : FIntPoint(1, 1),
+			PF_FloatRGBA,
+			FClearValueBinding::Transparent,
+			TexCreate_ShaderResource | TexCreate_UAV
+		);
+		FRDGTextureUAVRef AccumulationUAV = GraphBuilder.CreateUAV(GraphBuilder.CreateTexture(AccumulationDesc, TEXT("RTXGILightingAccumulation")));
+
+		if (bSeparateLightingPass)
 		{
 			AddClearUAVPass(GraphBuilder, LightingPassUAV, FLinearColor::Transparent);
 		}
@@ -465,119 +735,201 @@ void FDDGIVolumeSceneProxy::RenderDiffuseIndirectLight_RenderThread(
 			// Skip this shader permutation if there are no volumes that match its feature set
 			if (!foundAMatch) continue;
 
-			// Get the shader permutation
-			FGlobalShaderMap* GlobalShaderMap = GetGlobalShaderMap(ERHIFeatureLevel::SM5);
-			bool highBitCount = (GetDefault<URTXGIPluginSettings>()->IrradianceBits == EDDGIIrradianceBits::n32);
-			FApplyLightingDeferredShaderCS::FPermutationDomain PermutationVector;
-			PermutationVector.Set<FApplyLightingDeferredShaderCS::FLightingChannelsDim>(Resources.LightingChannelsTexture != nullptr);
-			PermutationVector.Set<FApplyLightingDeferredShaderCS::FEnableRelocation>(enableRelocation);
-			PermutationVector.Set<FApplyLightingDeferredShaderCS::FEnableScrolling>(enableScrolling);
-			PermutationVector.Set<FApplyLightingDeferredShaderCS::FFormatRadiance>(highBitCount);
-			PermutationVector.Set<FApplyLightingDeferredShaderCS::FFormatIrradiance>(highBitCount);
-			TShaderMapRef<FApplyLightingDeferredShaderCS> ComputeShader(GlobalShaderMap, PermutationVector);
-
-			// Set the shader parameters
-			FApplyLightingDeferredShaderParameters DefaultPassParameters;
-			FApplyLightingDeferredShaderParameters* PassParameters = GraphBuilder.AllocParameters<FApplyLightingDeferredShaderParameters>();
-			*PassParameters = DefaultPassParameters;
-			PassParameters->NormalTexture = GBufferATexture;
-			PassParameters->DepthTexture = SceneDepthTexture;
-			PassParameters->BaseColorTexture = GBufferCTexture;
-			PassParameters->MetallicTexture = GBufferBTexture;
-			PassParameters->LightingChannelsTexture = Resources.LightingChannelsTexture;
-			PassParameters->PointClampSampler = TStaticSamplerState<SF_Point, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI();
-			PassParameters->LinearClampSampler = TStaticSamplerState<SF_Trilinear, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI();
-			PassParameters->ShouldUsePreExposure = View.Family->EngineShowFlags.Tonemapper;
-			PassParameters->NumVolumes = numVolumes;
-
-			// Set the shader parameters for the relevant volumes
-			for (int32 volumeIndex = 0; volumeIndex < numVolumes; ++volumeIndex)
+			for (int32 batchIndex = 0; batchIndex < numBatches; ++batchIndex)
 			{
-				FProxyEntry volume = volumes[volumeIndex];
-				const FDDGIVolumeSceneProxy* volumeProxy = volume.proxy;
-
-				// Set the volume textures
-				PassParameters->DDGIVolume[volumeIndex].ProbeIrradiance = GraphBuilder.RegisterExternalTexture(volumeProxy->ProbesIrradiance);
-				PassParameters->DDGIVolume[volumeIndex].ProbeDistance = GraphBuilder.RegisterExternalTexture(volumeProxy->ProbesDistance);
-				PassParameters->DDGIVolume[volumeIndex].ProbeOffsets = RegisterExternalTextureWithFallback(GraphBuilder, volumeProxy->ProbesOffsets, GSystemTextures.BlackDummy);
-				PassParameters->DDGIVolume[volumeIndex].ProbeStates = RegisterExternalTextureWithFallback(GraphBuilder, volumeProxy->ProbesStates, GSystemTextures.BlackDummy);
-
-				// Set the volume parameters
-				PassParameters->DDGIVolume[volumeIndex].Position = volumeProxy->ComponentData.Origin;
-				PassParameters->DDGIVolume[volumeIndex].Rotation = FVector4(volume.Rotation.X, volume.Rotation.Y, volume.Rotation.Z, volume.Rotation.W);
-				PassParameters->DDGIVolume[volumeIndex].Radius = volume.Scale * 100.0f;
-				PassParameters->DDGIVolume[volumeIndex].LightingChannelMask = volume.lightingChannelMask;
-
-				FVector volumeSize = volumeProxy->ComponentData.Transform.GetScale3D() * 200.0f;
-				FVector probeGridSpacing;
-				probeGridSpacing.X = volumeSize.X / float(volumeProxy->ComponentData.ProbeCounts.X);
-				probeGridSpacing.Y = volumeSize.Y / float(volumeProxy->ComponentData.ProbeCounts.Y);
-				probeGridSpacing.Z = volumeSize.Z / float(volumeProxy->ComponentData.ProbeCounts.Z);
-
-				PassParameters->DDGIVolume[volumeIndex].ProbeGridSpacing = probeGridSpacing;
-				PassParameters->DDGIVolume[volumeIndex].ProbeGridCounts = volumeProxy->ComponentData.ProbeCounts;
-				PassParameters->DDGIVolume[volumeIndex].ProbeNumIrradianceTexels = FDDGIVolumeSceneProxy::FComponentData::c_NumTexelsIrradiance;
-				PassParameters->DDGIVolume[volumeIndex].ProbeNumDistanceTexels = FDDGIVolumeSceneProxy::FComponentData::c_NumTexelsDistance;
-				PassParameters->DDGIVolume[volumeIndex].ProbeIrradianceEncodingGamma = volumeProxy->ComponentData.ProbeIrradianceEncodingGamma;
-				PassParameters->DDGIVolume[volumeIndex].NormalBias = volumeProxy->ComponentData.NormalBias;
-				PassParameters->DDGIVolume[volumeIndex].ViewBias = volumeProxy->ComponentData.ViewBias;
-				PassParameters->DDGIVolume[volumeIndex].BlendDistance = volumeProxy->ComponentData.BlendDistance;
-				PassParameters->DDGIVolume[volumeIndex].BlendDistanceBlack = volumeProxy->ComponentData.BlendDistanceBlack;
-				PassParameters->DDGIVolume[volumeIndex].ProbeScrollOffsets = volumeProxy->ComponentData.ProbeScrollOffsets;
-
-				// Only apply lighting if this is the pass it should be applied in
-				// The shader needs data for all of the volumes for blending purposes
-				bool applyLighting = true;
-				applyLighting = applyLighting && (enableRelocation == volumeProxy->ComponentData.EnableProbeRelocation);
-				applyLighting = applyLighting && (enableScrolling == volumeProxy->ComponentData.EnableProbeScrolling);
-				PassParameters->DDGIVolume[volumeIndex].ApplyLighting = applyLighting;
-				PassParameters->DDGIVolume[volumeIndex].IrradianceScalar = volumeProxy->ComponentData.IrradianceScalar;
-
-				// Apply the lighting multiplier to artificially lighten or darken the indirect light from the volume
-				PassParameters->DDGIVolume[volumeIndex].IrradianceScalar /= volumeProxy->ComponentData.LightingMultiplier;
-			}
+				int32 batchStart = batchIndex * batchSize;
+				int32 numVolumes = FMath::Min(volumes.Num() - batchStart, batchSize);
+
+				// Get the shader permutation
+				FGlobalShaderMap* GlobalShaderMap = GetGlobalShaderMap(ERHIFeatureLevel::SM5);
+				bool highBitCount = (GetDefault<URTXGIPluginSettings>()->IrradianceBits == EDDGIIrradianceBits::n32);
+				FApplyLightingDeferredShaderCS::FPermutationDomain PermutationVector;
+				PermutationVector.Set<FApplyLightingDeferredShaderCS::FLightingChannelsDim>(Resources.LightingChannelsTexture != nullptr);
+				PermutationVector.Set<FApplyLightingDeferredShaderCS::FEnableRelocation>(enableRelocation);
+				PermutationVector.Set<FApplyLightingDeferredShaderCS::FEnableScrolling>(enableScrolling);
+				PermutationVector.Set<FApplyLightingDeferredShaderCS::FFormatRadiance>(highBitCount);
+				PermutationVector.Set<FApplyLightingDeferredShaderCS::FFormatIrradiance>(highBitCount);
+				TShaderMapRef<FApplyLightingDeferredShaderCS> ComputeShader(GlobalShaderMap, PermutationVector);
+
+				// Set the shader parameters
+				FApplyLightingDeferredShaderParameters DefaultPassParameters;
+				FApplyLightingDeferredShaderParameters* PassParameters = GraphBuilder.AllocParameters<FApplyLightingDeferredShaderParameters>();
+				*PassParameters = DefaultPassParameters;
+				PassParameters->NormalTexture = GBufferATexture;
+				PassParameters->DepthTexture = SceneDepthTexture;
+				PassParameters->BaseColorTexture = GBufferCTexture;
+				PassParameters->MetallicTexture = GBufferBTexture;
+				PassParameters->LightingChannelsTexture = Resources.LightingChannelsTexture;
+				PassParameters->PointClampSampler = TStaticSamplerState<SF_Point, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI();
+				PassParameters->LinearClampSampler = TStaticSamplerState<SF_Trilinear, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI();
+				PassParameters->ShouldUsePreExposure = View.Family->EngineShowFlags.Tonemapper;
+				PassParameters->NumVolumes = numVolumes;
+				PassParameters->FirstBatch = (batchIndex == 0);
+				PassParameters->LastBatch = (batchIndex == numBatches - 1);
+				PassParameters->AccumulationUAV = AccumulationUAV;
+				PassParameters->VolumeClusterMasks = clusterMasksSRV;
+				PassParameters->ClusterGridSize = clusterGrid.Size;
+				PassParameters->ClusterTileSize = c_ClusterTileSize;
+				PassParameters->ClusterMaskOffset = batchIndex * numClusters;
+				PassParameters->ClusterNearDepth = clusterGrid.NearDepth;
+				PassParameters->ClusterDepthScale = clusterGrid.DepthScale;
+				PassParameters->CheckerboardParity = checkerboardParity;
+
+				// Set the shader parameters for the volumes of the batch
+				for (int32 volumeIndex = 0; volumeIndex < numVolumes; ++volumeIndex)
+				{
+					FProxyEntry volume = volumes[batchStart + volumeIndex];
+					const FDDGIVolumeSceneProxy* volumeProxy = volume.proxy;
+
+					// Set the volume textures, the copies from before the update if it runs on async compute
+					const FLightingTextures& lightingTextures = volumeProxy->LightingTextures;
+					PassParameters->DDGIVolume[volumeIndex].ProbeIrradiance = lightingTextures.Irradiance ? lightingTextures.Irradiance : GraphBuilder.RegisterExternalTexture(volumeProxy->ProbesIrradiance);
+					PassParameters->DDGIVolume[volumeIndex].ProbeDistance = lightingTextures.Distance ? lightingTextures.Distance : GraphBuilder.RegisterExternalTexture(volumeProxy->ProbesDistance);
+					PassParameters->DDGIVolume[volumeIndex].ProbeOffsets = lightingTextures.Offsets ? lightingTextures.Offsets : RegisterExternalTextureWithFallback(GraphBuilder, volumeProxy->ProbesOffsets, GSystemTextures.BlackDummy);
+					PassParameters->DDGIVolume[volumeIndex].ProbeStates = lightingTextures.States ? lightingTextures.States : RegisterExternalTextureWithFallback(GraphBuilder, volumeProxy->ProbesStates, GSystemTextures.BlackDummy);
+
+					// Set the volume parameters
+					PassParameters->DDGIVolume[volumeIndex].Position = volumeProxy->ComponentData.Origin;
+					PassParameters->DDGIVolume[volumeIndex].Rotation = FVector4(volume.Rotation.X, volume.Rotation.Y, volume.Rotation.Z, volume.Rotation.W);
+					PassParameters->DDGIVolume[volumeIndex].Radius = volume.Scale * 100.0f;
+					PassParameters->DDGIVolume[volumeIndex].LightingChannelMask = volume.lightingChannelMask;
+
+					FVector volumeSize = volumeProxy->ComponentData.Transform.GetScale3D() * 200.0f;
+					FVector probeGridSpacing;
+					probeGridSpacing.X = volumeSize.X / float(volumeProxy->ComponentData.ProbeCounts.X);
+					probeGridSpacing.Y = volumeSize.Y / float(volumeProxy->ComponentData.ProbeCounts.Y);
+					probeGridSpacing.Z = volumeSize.Z / float(volumeProxy->ComponentData.ProbeCounts.Z);
+
+					PassParameters->DDGIVolume[volumeIndex].ProbeGridSpacing = probeGridSpacing;
+					PassParameters->DDGIVolume[volumeIndex].ProbeGridCounts = volumeProxy->ComponentData.ProbeCounts;
+					PassParameters->DDGIVolume[volumeIndex].ProbeNumIrradianceTexels = FDDGIVolumeSceneProxy::FComponentData::c_NumTexelsIrradiance;
+					PassParameters->DDGIVolume[volumeIndex].ProbeNumDistanceTexels = FDDGIVolumeSceneProxy::FComponentData::c_NumTexelsDistance;
+					PassParameters->DDGIVolume[volumeIndex].ProbeIrradianceEncodingGamma = volumeProxy->ComponentData.ProbeIrradianceEncodingGamma;
+					PassParameters->DDGIVolume[volumeIndex].NormalBias = volumeProxy->ComponentData.NormalBias;
+					PassParameters->DDGIVolume[volumeIndex].ViewBias = volumeProxy->ComponentData.ViewBias;
+					PassParameters->DDGIVolume[volumeIndex].BlendDistance = volumeProxy->ComponentData.BlendDistance;
+					PassParameters->DDGIVolume[volumeIndex].BlendDistanceBlack = volumeProxy->ComponentData.BlendDistanceBlack;
+					PassParameters->DDGIVolume[volumeIndex].ProbeScrollOffsets = volumeProxy->ComponentData.ProbeScrollOffsets;
+
+					// Only apply lighting if this is the pass it should be applied in
+					// The shader needs data for all of the volumes for blending purposes
+					bool applyLighting = true;
+					applyLighting = applyLighting && (enableRelocation == volumeProxy->ComponentData.EnableProbeRelocation);
+					applyLighting = applyLighting && (enableScrolling == volumeProxy->ComponentData.EnableProbeScrolling);
+					PassParameters->DDGIVolume[volumeIndex].ApplyLighting = applyLighting;
+					PassParameters->DDGIVolume[volumeIndex].IrradianceScalar = volumeProxy->ComponentData.IrradianceScalar;
+
+					// Apply the lighting multiplier to artificially lighten or darken the indirect light from the volume
+					PassParameters->DDGIVolume[volumeIndex].IrradianceScalar /= volumeProxy->ComponentData.LightingMultiplier;
+				}
 
-			// When there are fewer relevant volumes than the maximum supported, set the empty volume texture slots to dummy values
-			for (int32 volumeIndex = numVolumes; volumeIndex < FDDGIVolumeSceneProxy::FComponentData::c_RTXGI_DDGI_MAX_SHADING_VOLUMES; ++volumeIndex)
-			{
-				PassParameters->DDGIVolume[volumeIndex].ProbeIrradiance = GraphBuilder.RegisterExternalTexture(GSystemTextures.BlackDummy);
-				PassParameters->DDGIVolume[volumeIndex].ProbeDistance = GraphBuilder.RegisterExternalTexture(GSystemTextures.BlackDummy);
-				PassParameters->DDGIVolume[volumeIndex].ProbeOffsets = GraphBuilder.RegisterExternalTexture(GSystemTextures.BlackDummy);
-				PassParameters->DDGIVolume[volumeIndex].ProbeStates = GraphBuilder.RegisterExternalTexture(GSystemTextures.BlackDummy);
-			}
+				// When there are fewer relevant volumes than the maximum supported, set the empty volume texture slots to dummy values
+				for (int32 volumeIndex = numVolumes; volumeIndex < FDDGIVolumeSceneProxy::FComponentData::c_RTXGI_DDGI_MAX_SHADING_VOLUMES; ++volumeIndex)
+				{
+					PassParameters->DDGIVolume[volumeIndex].ProbeIrradiance = GraphBuilder.RegisterExternalTexture(GSystemTextures.BlackDummy);
+					PassParameters->DDGIVolume[volumeIndex].ProbeDistance = GraphBuilder.RegisterExternalTexture(GSystemTextures.BlackDummy);
+					PassParameters->DDGIVolume[volumeIndex].ProbeOffsets = GraphBuilder.RegisterExternalTexture(GSystemTextures.BlackDummy);
+					PassParameters->DDGIVolume[volumeIndex].ProbeStates = GraphBuilder.RegisterExternalTexture(GSystemTextures.BlackDummy);
+				}
 
-			if (CVarLightingPassScale.GetValueOnRenderThread() == 1.0f)
-			{
-				PassParameters->LightingPassUAV = GraphBuilder.CreateUAV(SceneColorTexture);
-			}
-			else
-			{
-				PassParameters->LightingPassUAV = LightingPassUAV;
+				if (!bSeparateLightingPass)
+				{
+					PassParameters->LightingPassUAV = GraphBuilder.CreateUAV(SceneColorTexture);
+				}
+				else
+				{
+					PassParameters->LightingPassUAV = LightingPassUAV;
+				}
+
+				PassParameters->ScaledViewSizeAndInvSize = FVector4(ScaledViewSize.X, ScaledViewSize.Y, 1.0f / ScaledViewSize.X, 1.0f / ScaledViewSize.Y);
+				PassParameters->ViewUniformBuffer = View.ViewUniformBuffer;
+
+				// Currently hardcoded as 8
+				const float groupSize = 8.f;
+				uint32 numThreadsX = ScaledViewSizeX;
+				uint32 numThreadsY = ScaledViewSizeY;
+
+				uint32 numGroupsX = (uint32)ceil((float)numThreadsX / groupSize);
+				uint32 numGroupsY = (uint32)ceil((float)numThreadsY / groupSize);
+
+				// Dispatching the Downsampling CS
+				FComputeShaderUtils::AddPass(
+					GraphBuilder,
+					RDG_EVENT_NAME("DDGI Apply Lighting (batch %d)", batchIndex),
+					ComputeShader,
+					PassParameters,
+					FIntVector(numGroupsX, numGroupsY, 1)
+				);
 			}
+		}
+	}
+
+	// Reconstruct the pixels the checkerboard skipped this frame
+	if (bCheckerboard)
+	{
+		RDG_GPU_STAT_SCOPE(GraphBuilder, RTXGI_UpscaleLighting);
+		RDG_EVENT_SCOPE(GraphBuilder, "RTXGI Checkerboard Resolve");
 
-			PassParameters->ScaledViewSizeAndInvSize = FVector4(ScaledViewSize.X, ScaledViewSize.Y, 1.0f / ScaledViewSize.X, 1.0f / ScaledViewSize.Y);
-			PassParameters->ViewUniformBuffer = View.ViewUniformBuffer;
+		TUniquePtr<FCheckerboardHistory>& history = CheckerboardHistories.FindOrAdd(View.ViewState->GetViewKey());
+		if (!history) history = MakeUnique<FCheckerboardHistory>();
 
-			// Currently hardcoded as 8
-			const float groupSize = 8.f;
-			uint32 numThreadsX = ScaledViewSizeX;
-			uint32 numThreadsY = ScaledViewSizeY;
+		// The history is only usable when the view rendered the previous frame at the same lighting pass size
+		bool historyValid =
+			history->Texture.IsValid() &&
+			history->Texture->GetDesc().Extent == ScaledViewSize &&
+			history->LastFrame + 1 == GFrameCounterRenderThread &&
+			!View.bCameraCut &&
+			!View.bPrevTransformsReset;
 
-			uint32 numGroupsX = (uint32)ceil((float)numThreadsX / groupSize);
-			uint32 numGroupsY = (uint32)ceil((float)numThreadsY / groupSize);
+		float preExposure = View.Family->EngineShowFlags.Tonemapper ? View.PreExposure : 1.0f;
 
-			// Dispatching the Downsampling CS
-			FComputeShaderUtils::AddPass(
-				GraphBuilder,
-				RDG_EVENT_NAME("DDGI Apply Lighting"),
-				ComputeShader,
-				PassParameters,
-				FIntVector(numGroupsX, numGroupsY, 1)
-			);
+		FGlobalShaderMap* GlobalShaderMap = GetGlobalShaderMap(ERHIFeatureLevel::SM5);
+		TShaderMapRef<FCheckerboardResolveShaderCS> ComputeShader(GlobalShaderMap);
+
+		FRDGTextureRef ResolvedTex = GraphBuilder.CreateTexture(RTXGILightingPassOutputDesc, TEXT("RTXGILightingPassResolved"));
+
+		FCheckerboardResolveShaderParameters DefaultPassParameters;
+		FCheckerboardResolveShaderParameters* PassParameters = GraphBuilder.AllocParameters<FCheckerboardResolveShaderParameters>();
+		*PassParameters = DefaultPassParameters;
+		PassParameters->InputGITexture = LightingPassTex;
+		PassParameters->HistoryGITexture = historyValid ? GraphBuilder.RegisterExternalTexture(history->Texture) : GraphBuilder.RegisterExternalTexture(GSystemTextures.BlackDummy);
+		PassParameters->DepthTexture = SceneDepthTexture;
+		PassParameters->ResolvedGIOutput = GraphBuilder.CreateUAV(ResolvedTex);
+		PassParameters->PointClampSampler = TStaticSamplerState<SF_Point, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI();
+		PassParameters->LinearClampSampler = TStaticSamplerState<SF_Bilinear, AM_Clamp, AM_Clamp, AM_Clamp>::GetRHI();
+		PassParameters->InputViewSizeAndInvSize = FVector4(ScaledViewSize.X, ScaledViewSize.Y, 1.0f / ScaledViewSize.X, 1.0f / ScaledViewSize.Y);
+		PassParameters->CheckerboardParity = uint32(checkerboardParity);
+		PassParameters->HistoryValid = historyValid;
+		PassParameters->HistoryPreExposureCorrection = historyValid ? preExposure / FMath::Max(history->PreExposure, SMALL_NUMBER) : 1.0f;
+		PassParameters->ViewUniformBuffer = View.ViewUniformBuffer;
+
+		// Currently hardcoded as 8
+		const float groupSize = 8.f;
+		uint32 numGroupsX = (uint32)ceil((float)ScaledViewSizeX / groupSize);
+		uint32 numGroupsY = (uint32)ceil((float)ScaledViewSizeY / groupSize);
+
+		FComputeShaderUtils::AddPass(
+			GraphBuilder,
+			RDG_EVENT_NAME("DDGI Checkerboard Resolve"),
+			ComputeShader,
+			PassParameters,
+			FIntVector(numGroupsX, numGroupsY, 1)
+		);
+
+		// The resolved lighting is the next frame's history, and what gets upscaled
+		GraphBuilder.QueueTextureExtraction(ResolvedTex, &history->Texture);
+		history->LastFrame = GFrameCounterRenderThread;
+		history->PreExposure = preExposure;
+		LightingPassTex = ResolvedTex;
+
+		// Drop the histories of views that stopped rendering
+		for (auto It = CheckerboardHistories.CreateIterator(); It; ++It)
+		{
+			if (It.Value()->LastFrame + 60 < GFrameCounterRenderThread) It.RemoveCurrent();
 		}
 	}
 
-	if (CVarLightingPassScale.GetValueOnRenderThread() < 1.0f)
+	if (bSeparateLightingPass)
 	{
 		RDG_GPU_STAT_SCOPE(GraphBuilder, RTXGI_UpscaleLighting);
 		RDG_EVENT_SCOPE(GraphBuilder, "RTXGI Upscale Lighting");
@@ -647,6 +999,7 @@ struct RTXGI_API FDDGICustomVersion
 		SaveLoadProbeTextures,     // save pixels and width/height
 		SaveLoadProbeTexturesFmt,  // save texel format since the format can change in the project settings
 		SaveLoadProbeDataIsOptional, // Probe data is optionally stored depending on project settings
+		SaveLoadProbeTexturesCompressed, // Probe texels are compressed
 	};
 
 	// The GUID for this custom version number
@@ -658,7 +1011,7 @@ private:
 const FGuid FDDGICustomVersion::GUID(0xc12f0537, 0x7346d9c5, 0x336fbba3, 0x738ab145);
 
 // Register the custom version with core
-FCustomVersionRegistration GRegisterCustomVersion(FDDGICustomVersion::GUID, FDDGICustomVersion::SaveLoadProbeDataIsOptional, TEXT("DDGIVolCompVer"));
+FCustomVersionRegistration GRegisterCustomVersion(FDDGICustomVersion::GUID, FDDGICustomVersion::SaveLoadProbeTexturesCompressed, TEXT("DDGIVolCompVer"));
 
 // Create a CPU accessible GPU texture and copy the provided GPU texture's contents to it
 static FDDGITexturePixels GetTexturePixelsStep1_RenderThread(FRHICommandListImmediate& RHICmdList, FRHITexture* textureGPU)
@@ -696,56 +1049,133 @@ static FDDGITexturePixels GetTexturePixelsStep1_RenderThread(FRHICommandListImme
 	return ret;
 }
 
-// Read the CPU accessible GPU texture data into CPU memory
-static void GetTexturePixelsStep2_RenderThread(FRHICommandListImmediate& RHICmdList, FDDGITexturePixels& texturePixels)
+// Schedule a copy of the GPU texture to CPU memory, without waiting for it
+static void EnqueueTextureReadback_RenderThread(FRHICommandListImmediate& RHICmdList, FRHITexture* textureGPU, FDDGITexturePixels& texturePixels)
 {
-	// Early out if no texture is provided
-	if (!texturePixels.Texture) return;
+	// Early out if a GPU texture is not provided
+	if (!textureGPU) return;
+
+	texturePixels.Desc.Width = textureGPU->GetTexture2D()->GetSizeX();
+	texturePixels.Desc.Height = textureGPU->GetTexture2D()->GetSizeY();
+	texturePixels.Desc.PixelFormat = (int32)textureGPU->GetFormat();
+	texturePixels.Readback = MakeShared<FRHIGPUTextureReadback, ESPMode::ThreadSafe>(TEXT("DDGIGetTexturePixelsSave"));
+
+	RHICmdList.Transition(FRHITransitionInfo(textureGPU, ERHIAccess::SRVMask, ERHIAccess::CopySrc));
+	texturePixels.Readback->EnqueueCopy(RHICmdList, textureGPU);
+	RHICmdList.Transition(FRHITransitionInfo(textureGPU, ERHIAccess::CopySrc, ERHIAccess::SRVMask));
+}
+
+// Read the texture data copied by EnqueueTextureReadback_RenderThread into the texture pixels
+static void ResolveTextureReadback_RenderThread(FRHICommandListImmediate& RHICmdList, FDDGITexturePixels& texturePixels)
+{
+	// Early out if no readback was scheduled
+	if (!texturePixels.Readback) return;
+
+	// Wait for the copy if the GPU hasn't gotten to it yet.
+	// The readbacks of every volume in the package are scheduled in PreSave, so only the first volume serialized waits.
+	if (!texturePixels.Readback->IsReady())
+	{
+		RHICmdList.SubmitCommandsAndFlushGPU();
+		RHICmdList.BlockUntilGPUIdle();
+	}
 
-	// Get a pointer to the CPU memory
-	uint8* mappedTextureMemory = (uint8*)RHILockTexture2D(texturePixels.Texture, 0, RLM_ReadOnly, texturePixels.Desc.Stride, false);
+	void* mappedTextureMemory = nullptr;
+	int32 rowPitchInPixels = 0;
+	texturePixels.Readback->LockTexture(RHICmdList, mappedTextureMemory, rowPitchInPixels);
 
 	// Copy the texture data to CPU memory
-	texturePixels.Pixels.AddZeroed(texturePixels.Desc.Height * texturePixels.Desc.Stride);
-	FMemory::Memcpy(&texturePixels.Pixels[0], mappedTextureMemory, texturePixels.Desc.Height * texturePixels.Desc.Stride);
+	texturePixels.Desc.Stride = rowPitchInPixels * GPixelFormats[texturePixels.Desc.PixelFormat].BlockBytes;
+	texturePixels.Pixels.SetNumUninitialized(texturePixels.Desc.Height * texturePixels.Desc.Stride);
+	FMemory::Memcpy(texturePixels.Pixels.GetData(), mappedTextureMemory, texturePixels.Pixels.Num());
 
-	RHIUnlockTexture2D(texturePixels.Texture, 0, false);
+	texturePixels.Readback->Unlock();
+	texturePixels.Readback.Reset();
 }
 
-static void SaveFDDGITexturePixels(FArchive& Ar, FDDGITexturePixels& texturePixels, bool bSaveFormat)
+static TSharedPtr<FDDGITextureLoadContext, ESPMode::ThreadSafe> BeginProbeTextureReadback(FDDGIVolumeSceneProxy* proxy)
+{
+	TSharedPtr<FDDGITextureLoadContext, ESPMode::ThreadSafe> readback = MakeShared<FDDGITextureLoadContext, ESPMode::ThreadSafe>();
+	ENQUEUE_RENDER_COMMAND(DDGISaveTexReadback)(
+		[readback, proxy](FRHICommandListImmediate& RHICmdList)
+		{
+			EnqueueTextureReadback_RenderThread(RHICmdList, proxy->ProbesIrradiance->GetTargetableRHI(), readback->Irradiance);
+			EnqueueTextureReadback_RenderThread(RHICmdList, proxy->ProbesDistance->GetTargetableRHI(), readback->Distance);
+			EnqueueTextureReadback_RenderThread(RHICmdList, proxy->ProbesOffsets ? proxy->ProbesOffsets->GetTargetableRHI() : nullptr, readback->Offsets);
+			EnqueueTextureReadback_RenderThread(RHICmdList, proxy->ProbesStates ? proxy->ProbesStates->GetTargetableRHI() : nullptr, readback->States);
+		}
+	);
+	return readback;
+}
+
+static void FinishProbeTextureReadback(const TSharedPtr<FDDGITextureLoadContext, ESPMode::ThreadSafe>& readback)
+{
+	ENQUEUE_RENDER_COMMAND(DDGISaveTexResolve)(
+		[readback](FRHICommandListImmediate& RHICmdList)
+		{
+			ResolveTextureReadback_RenderThread(RHICmdList, readback->Irradiance);
+			ResolveTextureReadback_RenderThread(RHICmdList, readback->Distance);
+			ResolveTextureReadback_RenderThread(RHICmdList, readback->Offsets);
+			ResolveTextureReadback_RenderThread(RHICmdList, readback->States);
+		}
+	);
+	FlushRenderingCommands();
+}
+
+static void SerializeFDDGITexels(FArchive& Ar, TArray<uint8>& pixels, bool bCompressed)
+{
+	if (!bCompressed)
+	{
+		Ar << pixels;
+		return;
+	}
+
+	// Offset and state texels are mostly constant and compress well, irradiance and distance less so
+	int32 numBytes = pixels.Num();
+	Ar << numBytes;
+	if (Ar.IsLoading()) pixels.SetNumUninitialized(numBytes);
+	if (numBytes > 0) Ar.SerializeCompressed(pixels.GetData(), numBytes, NAME_Zlib);
+}
+
+static void SaveFDDGITexturePixels(FArchive& Ar, FDDGITexturePixels& texturePixels, bool bSaveFormat, bool bCompressed)
 {
 	check(Ar.IsSaving());
 
 	Ar << texturePixels.Desc.Width;
 	Ar << texturePixels.Desc.Height;
 	Ar << texturePixels.Desc.Stride;
-	Ar << texturePixels.Pixels;
+	SerializeFDDGITexels(Ar, texturePixels.Pixels, bCompressed);
 
 	if (bSaveFormat) Ar << texturePixels.Desc.PixelFormat;
 }
 
-static void LoadFDDGITexturePixels(FArchive& Ar, FDDGITexturePixels& texturePixels, EPixelFormat expectedPixelFormat, bool bLoadFormat)
+// Load the texture data only. This can run on the async loading thread, the texture resource
+// is created on the render thread once a scene proxy takes the data (see CreateLoadedTexture_RenderThread).
+static void LoadFDDGITexturePixels(FArchive& Ar, FDDGITexturePixels& texturePixels, EPixelFormat expectedPixelFormat, bool bLoadFormat, bool bCompressed)
 {
 	check(Ar.IsLoading());
 
-	// Load the texture data
 	Ar << texturePixels.Desc.Width;
 	Ar << texturePixels.Desc.Height;
 	Ar << texturePixels.Desc.Stride;
-	Ar << texturePixels.Pixels;
+	SerializeFDDGITexels(Ar, texturePixels.Pixels, bCompressed);
 
-	if (bLoadFormat)
-	{
-		Ar << texturePixels.Desc.PixelFormat;
+	if (bLoadFormat) Ar << texturePixels.Desc.PixelFormat;
+	else texturePixels.Desc.PixelFormat = expectedPixelFormat;
+}
 
-		// Early out if the loaded pixel format doesn't match our expected format
-		if (texturePixels.Desc.PixelFormat != expectedPixelFormat) return;
-	}
+// Create the texture resource for loaded texture data
+static void CreateLoadedTexture_RenderThread(FDDGITexturePixels& texturePixels, EPixelFormat expectedPixelFormat)
+{
+	// Early out if the texture already exists (kept from a previous scene proxy)
+	if (texturePixels.Texture) return;
+
+	// Early out if the loaded pixel format doesn't match our expected format
+	if (texturePixels.Desc.PixelFormat != expectedPixelFormat) return;
 
 	// Early out if no data was loaded
 	if (texturePixels.Desc.Width == 0 || texturePixels.Desc.Height == 0 || texturePixels.Desc.Stride == 0) return;
+	if (texturePixels.Pixels.Num() != texturePixels.Desc.Height * texturePixels.Desc.Stride) return;
 
-	// Create the texture resource
 	FRHIResourceCreateInfo createInfo(TEXT("DDGITextureLoad"));
 	texturePixels.Texture = RHICreateTexture2D(
 		texturePixels.Desc.Width,
@@ -756,44 +1186,9 @@ static void LoadFDDGITexturePixels(FArchive& Ar, FDDGITexturePixels& texturePixe
 		TexCreate_ShaderResource | TexCreate_Transient,
 		createInfo);
 
-	// Copy the texture's data to the staging buffer
-	ENQUEUE_RENDER_COMMAND(DDGILoadTex)(
-		[&texturePixels](FRHICommandListImmediate& RHICmdList)
-		{
-			if (texturePixels.Pixels.Num() == texturePixels.Desc.Height * texturePixels.Desc.Stride)
-			{
-				uint32 destStride;
-				uint8* mappedTextureMemory = (uint8*)RHILockTexture2D(texturePixels.Texture, 0, RLM_WriteOnly, destStride, false);
-				if (texturePixels.Desc.Stride == destStride)
-				{
-					// Loaded data has the same stride as expected by the runtime
-					// Copy the entire texture at once
-					FMemory::Memcpy(mappedTextureMemory, &texturePixels.Pixels[0], texturePixels.Desc.Height * texturePixels.Desc.Stride);
-				}
-				else
-				{
-					// Loaded data has a different stride than expected by the runtime
-					// Texture data was stored with a different API than what is running now (D3D12->VK, VK->D3D12)
-					// Copy each row of the source data to the texture
-					const uint8* SourceBuffer = &texturePixels.Pixels[0];
-					for (uint32 Row = 0; Row < texturePixels.Desc.Height; ++Row)
-					{
-						FMemory::Memcpy(mappedTextureMemory, SourceBuffer, FMath::Min(texturePixels.Desc.Stride, destStride));
-
-						mappedTextureMemory += destStride;
-						SourceBuffer += texturePixels.Desc.Stride;
-					}
-				}
-				RHIUnlockTexture2D(texturePixels.Texture, 0, false);
-			}
-
-			// Only clear the texels when in a game.
-			// Cooking needs this data to write textures to disk on save, after load, when headless etc.
-		#if !WITH_EDITOR
-			texturePixels.Pixels.Reset();
-		#endif
-		}
-	);
+	// The source pitch may differ from the runtime's when the texture data was stored with a different API (D3D12->VK, VK->D3D12)
+	FUpdateTextureRegion2D region(0, 0, 0, 0, texturePixels.Desc.Width, texturePixels.Desc.Height);
+	RHIUpdateTexture2D(texturePixels.Texture, 0, region, texturePixels.Desc.Stride, texturePixels.Pixels.GetData());
 }
 
 void UDDGIVolumeComponent::Serialize(FArchive& Ar)
@@ -831,34 +1226,21 @@ void UDDGIVolumeComponent::Serialize(FArchive& Ar)
 			if (bProbesSerialized)
 			{
 				FDDGITexturePixels Irradiance, Distance, Offsets, States;
+				bool bCompressed = Ar.CustomVer(FDDGICustomVersion::GUID) >= FDDGICustomVersion::SaveLoadProbeTexturesCompressed;
 
 				// When we are *not* cooking and ray tracing is available, copy the DDGIVolume probe texture resources
 				// to CPU memory otherwise, write out the DDGIVolume texture resources acquired at load time
 				if (!Ar.IsCooking() && IsRayTracingEnabled() && proxy)
 				{
-					// Copy textures to CPU accessible texture resources
-					ENQUEUE_RENDER_COMMAND(DDGISaveTexStep1)(
-						[&Irradiance, &Distance, &Offsets, &States, proxy](FRHICommandListImmediate& RHICmdList)
-						{
-							Irradiance = GetTexturePixelsStep1_RenderThread(RHICmdList, proxy->ProbesIrradiance->GetTargetableRHI());
-							Distance = GetTexturePixelsStep1_RenderThread(RHICmdList, proxy->ProbesDistance->GetTargetableRHI());
-							Offsets = GetTexturePixelsStep1_RenderThread(RHICmdList, proxy->ProbesOffsets ? proxy->ProbesOffsets->GetTargetableRHI() : nullptr);
-							States = GetTexturePixelsStep1_RenderThread(RHICmdList, proxy->ProbesStates ? proxy->ProbesStates->GetTargetableRHI() : nullptr);
-						}
-					);
-					FlushRenderingCommands();
-
-					// Read the GPU texture data to CPU memory
-					ENQUEUE_RENDER_COMMAND(DDGISaveTexStep2)(
-						[&Irradiance, &Distance, &Offsets, &States](FRHICommandListImmediate& RHICmdList)
-						{
-							GetTexturePixelsStep2_RenderThread(RHICmdList, Irradiance);
-							GetTexturePixelsStep2_RenderThread(RHICmdList, Distance);
-							GetTexturePixelsStep2_RenderThread(RHICmdList, Offsets);
-							GetTexturePixelsStep2_RenderThread(RHICmdList, States);
-						}
-					);
-					FlushRenderingCommands();
+					// The readback is usually started in PreSave, but not for other saving archives (duplication, transactions)
+					TSharedPtr<FDDGITextureLoadContext, ESPMode::ThreadSafe> readback = SaveReadback ? SaveReadback : BeginProbeTextureReadback(proxy);
+					SaveReadback.Reset();
+
+					FinishProbeTextureReadback(readback);
+					Irradiance = readback->Irradiance;
+					Distance = readback->Distance;
+					Offsets = readback->Offsets;
+					States = readback->States;
 				}
 				else
 				{
@@ -869,10 +1251,10 @@ void UDDGIVolumeComponent::Serialize(FArchive& Ar)
 				}
 
 				// Write the volume data
-				SaveFDDGITexturePixels(Ar, Irradiance, bSaveFormat);
-				SaveFDDGITexturePixels(Ar, Distance, bSaveFormat);
-				SaveFDDGITexturePixels(Ar, Offsets, bSaveFormat);
-				SaveFDDGITexturePixels(Ar, States, bSaveFormat);
+				SaveFDDGITexturePixels(Ar, Irradiance, bSaveFormat, bCompressed);
+				SaveFDDGITexturePixels(Ar, Distance, bSaveFormat, bCompressed);
+				SaveFDDGITexturePixels(Ar, Offsets, bSaveFormat, bCompressed);
+				SaveFDDGITexturePixels(Ar, States, bSaveFormat, bCompressed);
 			}
 		}
 		else if (Ar.IsLoading())
@@ -887,25 +1269,32 @@ void UDDGIVolumeComponent::Serialize(FArchive& Ar)
 				EDDGIIrradianceBits IrradianceBits = GetDefault<URTXGIPluginSettings>()->IrradianceBits;
 				EDDGIDistanceBits DistanceBits = GetDefault<URTXGIPluginSettings>()->DistanceBits;
 				bool bLoadFormat = Ar.CustomVer(FDDGICustomVersion::GUID) >= FDDGICustomVersion::SaveLoadProbeTexturesFmt;
-
-				// Read the volume texture data in and note that it's ready for load
-				LoadFDDGITexturePixels(Ar, LoadContext.Irradiance, (IrradianceBits == EDDGIIrradianceBits::n32) ? FDDGIVolumeSceneProxy::FComponentData::c_pixelFormatIrradianceHighBitDepth : FDDGIVolumeSceneProxy::FComponentData::c_pixelFormatIrradianceLowBitDepth, bLoadFormat);
-				LoadFDDGITexturePixels(Ar, LoadContext.Distance, (DistanceBits == EDDGIDistanceBits::n32) ? FDDGIVolumeSceneProxy::FComponentData::c_pixelFormatDistanceHighBitDepth : FDDGIVolumeSceneProxy::FComponentData::c_pixelFormatDistanceLowBitDepth, bLoadFormat);
-				LoadFDDGITexturePixels(Ar, LoadContext.Offsets, FDDGIVolumeSceneProxy::FComponentData::c_pixelFormatOffsets, bLoadFormat);
-				LoadFDDGITexturePixels(Ar, LoadContext.States, FDDGIVolumeSceneProxy::FComponentData::c_pixelFormatStates, bLoadFormat);
-
-				bool& ReadyForLoad = LoadContext.ReadyForLoad;
-				ENQUEUE_RENDER_COMMAND(DDGILoadReady)(
-					[&ReadyForLoad](FRHICommandListImmediate& RHICmdList)
-					{
-						ReadyForLoad = true;
-					}
-				);
+				bool bCompressed = Ar.CustomVer(FDDGICustomVersion::GUID) >= FDDGICustomVersion::SaveLoadProbeTexturesCompressed;
+
+				// Read the volume texture data in and note that it's ready for load.
+				// The textures are created and uploaded on the render thread when the scene proxy takes the data.
+				LoadFDDGITexturePixels(Ar, LoadContext.Irradiance, (IrradianceBits == EDDGIIrradianceBits::n32) ? FDDGIVolumeSceneProxy::FComponentData::c_pixelFormatIrradianceHighBitDepth : FDDGIVolumeSceneProxy::FComponentData::c_pixelFormatIrradianceLowBitDepth, bLoadFormat, bCompressed);
+				LoadFDDGITexturePixels(Ar, LoadContext.Distance, (DistanceBits == EDDGIDistanceBits::n32) ? FDDGIVolumeSceneProxy::FComponentData::c_pixelFormatDistanceHighBitDepth : FDDGIVolumeSceneProxy::FComponentData::c_pixelFormatDistanceLowBitDepth, bLoadFormat, bCompressed);
+				LoadFDDGITexturePixels(Ar, LoadContext.Offsets, FDDGIVolumeSceneProxy::FComponentData::c_pixelFormatOffsets, bLoadFormat, bCompressed);
+				LoadFDDGITexturePixels(Ar, LoadContext.States, FDDGIVolumeSceneProxy::FComponentData::c_pixelFormatStates, bLoadFormat, bCompressed);
+				LoadContext.ReadyForLoad = true;
 			}
 		}
 	}
 }
 
+void UDDGIVolumeComponent::PreSave(const class ITargetPlatform* TargetPlatform)
+{
+	Super::PreSave(TargetPlatform);
+
+	// Start copying the probe textures to CPU memory without waiting on the GPU. Every object in the package
+	// is pre-saved before any is serialized, so the copies of all volumes overlap and Serialize only waits once.
+	if (!TargetPlatform && SceneProxy && IsRayTracingEnabled() && GetDefault<URTXGIPluginSettings>()->SerializeProbes)
+	{
+		SaveReadback = BeginProbeTextureReadback(SceneProxy);
+	}
+}
+
 void UDDGIVolumeComponent::UpdateRenderThreadData()
 {
 	// Send command to the rendering thread to update the transform and other parameters
@@ -913,7 +1302,9 @@ void UDDGIVolumeComponent::UpdateRenderThreadData()
 	{
 		// Update the volume component's data
 		FDDGIVolumeSceneProxy::FComponentData ComponentData;
-		ComponentData.RaysPerProbe = RaysPerProbe;
+		const DDGIQuality::FLevel& Quality = DDGIQuality::c_levels[DDGIQuality::GetLevel()];
+		ComponentData.RaysPerProbe = DDGIQuality::ScaleRaysPerProbe(RaysPerProbe, Quality.RaysPerProbeScale);
+		ComponentData.ProbeUpdateFraction = Quality.ProbeUpdateFraction;
 		ComponentData.ProbeMaxRayDistance = ProbeMaxRayDistance;
 		ComponentData.LightingChannels = LightingChannels;
 		ComponentData.ProbeCounts = ProbeCounts;
@@ -1042,7 +1433,13 @@ void UDDGIVolumeComponent::UpdateRenderThreadData()
 		EDDGIIrradianceBits IrradianceBits = GetDefault<URTXGIPluginSettings>()->IrradianceBits;
 		EDDGIDistanceBits DistanceBits = GetDefault<URTXGIPluginSettings>()->DistanceBits;
 
+	#if WITH_EDITOR
 		FDDGITextureLoadContext TextureLoadContext = LoadContext;
+	#else
+		// Only clear the texels when in a game.
+		// Cooking needs this data to write textures to disk on save, after load, when headless etc.
+		FDDGITextureLoadContext TextureLoadContext = LoadContext.ReadyForLoad ? MoveTemp(LoadContext) : FDDGITextureLoadContext();
+	#endif
 		LoadContext.ReadyForLoad = false;
 
 		ENQUEUE_RENDER_COMMAND(UpdateGIVolumeTransformCommand)(
@@ -1050,9 +1447,9 @@ void UDDGIVolumeComponent::UpdateRenderThreadData()
 			{
 				FRDGBuilder GraphBuilder(RHICmdList);
 
+				// The probe ray data is transient, so the rays per probe (scaled by r.RTXGI.Quality) can change without reallocating
 				bool needReallocate =
 					DDGIProxy->ComponentData.ProbeCounts != ComponentData.ProbeCounts ||
-					DDGIProxy->ComponentData.RaysPerProbe != ComponentData.RaysPerProbe ||
 					DDGIProxy->ComponentData.EnableProbeRelocation != ComponentData.EnableProbeRelocation;
 
 				// set the data
@@ -1060,7 +1457,14 @@ void UDDGIVolumeComponent::UpdateRenderThreadData()
 
 				// handle state textures ready to load from serialization
 				if (TextureLoadContext.ReadyForLoad)
-					DDGIProxy->TextureLoadContext = TextureLoadContext;
+				{
+					FDDGITextureLoadContext& ProxyLoadContext = DDGIProxy->TextureLoadContext;
+					ProxyLoadContext = TextureLoadContext;
+					CreateLoadedTexture_RenderThread(ProxyLoadContext.Irradiance, (IrradianceBits == EDDGIIrradianceBits::n32) ? FDDGIVolumeSceneProxy::FComponentData::c_pixelFormatIrradianceHighBitDepth : FDDGIVolumeSceneProxy::FComponentData::c_pixelFormatIrradianceLowBitDepth);
+					CreateLoadedTexture_RenderThread(ProxyLoadContext.Distance, (DistanceBits == EDDGIDistanceBits::n32) ? FDDGIVolumeSceneProxy::FComponentData::c_pixelFormatDistanceHighBitDepth : FDDGIVolumeSceneProxy::FComponentData::c_pixelFormatDistanceLowBitDepth);
+					CreateLoadedTexture_RenderThread(ProxyLoadContext.Offsets, FDDGIVolumeSceneProxy::FComponentData::c_pixelFormatOffsets);
+					CreateLoadedTexture_RenderThread(ProxyLoadContext.States, FDDGIVolumeSceneProxy::FComponentData::c_pixelFormatStates);
+				}
 
 				if (needReallocate)
 				{
@@ -1103,6 +1507,13 @@ void UDDGIVolumeComponent::Shutdown()
 	FGlobalIlluminationExperimentalPluginDelegates::FRenderDiffuseIndirectLight& RDILDelegate = FGlobalIlluminationExperimentalPluginDelegates::RenderDiffuseIndirectLight();
 	check(FDDGIVolumeSceneProxy::RenderDiffuseIndirectLightHandle.IsValid());
 	RDILDelegate.Remove(FDDGIVolumeSceneProxy::RenderDiffuseIndirectLightHandle);
+
+	ENQUEUE_RENDER_COMMAND(DDGIReleaseCheckerboardHistories)(
+		[](FRHICommandListImmediate& RHICmdList)
+		{
+			CheckerboardHistories.Empty();
+		}
+	);
 }
 
 bool UDDGIVolumeComponent::Exec(UWorld* InWorld, const TCHAR* Cmd, FOutputDevice& Ar)
@@ -45,6 +45,63 @@ static TAutoConsoleVariable<int> CVarDDGIProbesTextureVis(
 	ECVF_RenderThreadSafe);
 #endif
 
+static TAutoConsoleVariable<int> CVarDDGIAsyncCompute(
+	TEXT("r.RTXGI.DDGI.AsyncCompute"),
+	0,
+	TEXT("If 1, the probe blending, border update, relocation and classification passes run on the async compute queue (where supported),\n")
+	TEXT("and the lighting pass uses the probe data from before the update, which is a frame old.\n"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int> CVarDDGIProbeBrickCulling(
+	TEXT("r.RTXGI.DDGI.ProbeBrickCulling"),
+	1,
+	TEXT("If 1, the probes are updated in bricks of 4x4x4, and the bricks outside of the view frustum or occluded in the HZB update at a reduced rate.\n"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int> CVarDDGIProbeBrickCullingOffscreenInterval(
+	TEXT("r.RTXGI.DDGI.ProbeBrickCulling.OffscreenInterval"),
+	4,
+	TEXT("With probe brick culling, the probes of off-screen bricks update once every this many sweeps over the volume's probes.\n"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int> CVarDDGIInlineProbeTrace(
+	TEXT("r.RTXGI.DDGI.InlineProbeTrace"),
+	0,
+	TEXT("If 1, and the RHI supports inline ray tracing, the probe rays are traced with ray queries from a compute shader instead of the ray tracing material pipeline.\n")
+	TEXT("The hits aren't shaded with their materials: they take their albedo and normal from the GBuffer where they are visible on screen, and only the directional light is shadowed and applied.\n"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<float> CVarDDGIInlineProbeTraceAlbedo(
+	TEXT("r.RTXGI.DDGI.InlineProbeTrace.Albedo"),
+	0.5f,
+	TEXT("With the inline probe trace, the albedo of the hit surfaces that aren't visible on screen.\n"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int> CVarDDGIRadianceCache(
+	TEXT("r.RTXGI.DDGI.RadianceCache"),
+	0,
+	TEXT("If 1, the radiance of the shaded probe ray hits is cached in a world-space hash shared by all of the volumes of the scene,\n")
+	TEXT("and the probe rays that hit a recently shaded cell reuse its radiance instead of shading the hit again.\n"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<float> CVarDDGIRadianceCacheCellSize(
+	TEXT("r.RTXGI.DDGI.RadianceCache.CellSize"),
+	25.0f,
+	TEXT("The size of the radiance cache cells, in world units.\n"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int> CVarDDGIRadianceCacheMaxAge(
+	TEXT("r.RTXGI.DDGI.RadianceCache.MaxAge"),
+	4,
+	TEXT("The number of frames a cached radiance is reused for before its cell is shaded again.\n"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int> CVarDDGIRadianceCacheSize(
+	TEXT("r.RTXGI.DDGI.RadianceCache.Size"),
+	256 * 1024,
+	TEXT("The number of cells in the radiance cache of each scene (16 bytes each).\n"),
+	ECVF_RenderThreadSafe);
+
 #if RHI_RAYTRACING
 
 static FMatrix ComputeRandomRotation()
@@ -101,8 +158,9 @@ class FRayTracingRTXGIProbeUpdateRGS : public FGlobalShader
 	class FFormatIrradiance : SHADER_PERMUTATION_BOOL("RTXGI_DDGI_FORMAT_IRRADIANCE");
 	class FEnableScrolling : SHADER_PERMUTATION_BOOL("RTXGI_DDGI_INFINITE_SCROLLING_VOLUME");
 	class FSkyLight : SHADER_PERMUTATION_INT("RTXGI_DDGI_SKY_LIGHT_TYPE", 3);
+	class FRadianceCache : SHADER_PERMUTATION_BOOL("RTXGI_DDGI_RADIANCE_CACHE");
 
-	using FPermutationDomain = TShaderPermutationDomain<FEnableTwoSidedGeometryDim, FEnableMaterialsDim, FEnableRelocation, FFormatRadiance, FFormatIrradiance, FEnableScrolling, FSkyLight>;
+	using FPermutationDomain = TShaderPermutationDomain<FEnableTwoSidedGeometryDim, FEnableMaterialsDim, FEnableRelocation, FFormatRadiance, FFormatIrradiance, FEnableScrolling, FSkyLight, FRadianceCache>;
 
 	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
 	{
@@ -135,6 +193,8 @@ class FRayTracingRTXGIProbeUpdateRGS : public FGlobalShader
 		SHADER_PARAMETER(float, DDGIVolume_EmissiveMultiplier)
 		SHADER_PARAMETER(int, DDGIVolume_ProbeIndexStart)
 		SHADER_PARAMETER(int, DDGIVolume_ProbeIndexCount)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, ProbeBrickUpdate)
+		SHADER_PARAMETER(FIntVector, ProbeBrickCounts)
 
 		SHADER_PARAMETER_RDG_UNIFORM_BUFFER(FDDGIVolumeDescGPU, DDGIVolume)
 
@@ -145,6 +205,12 @@ class FRayTracingRTXGIProbeUpdateRGS : public FGlobalShader
 		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, RadianceOutput)
 		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, DebugOutput)  // Per unreal RDG presentation, this is deadstripped if the shader doesn't write to it
 
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RadianceCache)
+		SHADER_PARAMETER(uint32, RadianceCache_NumSlots)
+		SHADER_PARAMETER(float, RadianceCache_CellSize)
+		SHADER_PARAMETER(uint32, RadianceCache_FrameIndex)
+		SHADER_PARAMETER(uint32, RadianceCache_MaxAge)
+
 		// assorted things needed by material resolves, even though some don't make sense outside of screenspace
 		SHADER_PARAMETER_RDG_TEXTURE(Texture2D, SSProfilesTexture)
 		SHADER_PARAMETER_STRUCT_REF(FViewUniformShaderParameters, ViewUniformBuffer)
@@ -154,6 +220,56 @@ class FRayTracingRTXGIProbeUpdateRGS : public FGlobalShader
 
 IMPLEMENT_GLOBAL_SHADER(FRayTracingRTXGIProbeUpdateRGS, "/Plugin/RTXGI/Private/ProbeUpdateRGS.usf", "ProbeUpdateRGS", SF_RayGen);
 
+// Lightweight alternative to FRayTracingRTXGIProbeUpdateRGS that traces the probe rays inline, without the material pipeline
+class FDDGIProbeTraceCS : public FGlobalShader
+{
+	DECLARE_GLOBAL_SHADER(FDDGIProbeTraceCS)
+	SHADER_USE_PARAMETER_STRUCT(FDDGIProbeTraceCS, FGlobalShader)
+
+	class FEnableRelocation : SHADER_PERMUTATION_BOOL("RTXGI_DDGI_PROBE_RELOCATION");
+	class FFormatRadiance : SHADER_PERMUTATION_BOOL("RTXGI_DDGI_FORMAT_RADIANCE");
+	class FFormatIrradiance : SHADER_PERMUTATION_BOOL("RTXGI_DDGI_FORMAT_IRRADIANCE");
+	class FEnableScrolling : SHADER_PERMUTATION_BOOL("RTXGI_DDGI_INFINITE_SCROLLING_VOLUME");
+	class FSkyLight : SHADER_PERMUTATION_INT("RTXGI_DDGI_SKY_LIGHT_TYPE", 3);
+	class FRadianceCache : SHADER_PERMUTATION_BOOL("RTXGI_DDGI_RADIANCE_CACHE");
+
+	using FPermutationDomain = TShaderPermutationDomain<FEnableRelocation, FFormatRadiance, FFormatIrradiance, FEnableScrolling, FSkyLight, FRadianceCache>;
+
+	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+
+		OutEnvironment.SetDefine(TEXT("RTXGI_DDGI_PROBE_CLASSIFICATION"), FDDGIVolumeSceneProxy::FComponentData::c_RTXGI_DDGI_PROBE_CLASSIFICATION ? 1 : 0);
+		OutEnvironment.SetDefine(TEXT("DDGIVolumeUpdateDebug"), 0);
+
+		// Ray queries need shader model 6.5
+		OutEnvironment.CompilerFlags.Add(CFLAG_ForceDXC);
+	}
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		FPermutationDomain PermutationVector(Parameters.PermutationId);
+		if (PermutationVector.Get<FFormatRadiance>() != PermutationVector.Get<FFormatIrradiance>())
+		{
+			return false;
+		}
+
+		return ShouldCompileRayTracingShadersForProject(Parameters.Platform) && IsD3DPlatform(Parameters.Platform, false);
+	}
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER_STRUCT_INCLUDE(FRayTracingRTXGIProbeUpdateRGS::FParameters, ProbeUpdate)
+		SHADER_PARAMETER_RDG_UNIFORM_BUFFER(FSceneTextureUniformParameters, SceneTextures)
+
+		SHADER_PARAMETER(FVector, DirectionalLight_Direction)
+		SHADER_PARAMETER(FVector, DirectionalLight_Color)
+		SHADER_PARAMETER(float, LightweightAlbedo)
+		SHADER_PARAMETER(float, GBufferDepthTolerance)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+IMPLEMENT_GLOBAL_SHADER(FDDGIProbeTraceCS, "/Plugin/RTXGI/Private/ProbeTraceCS.usf", "ProbeTraceCS", SF_Compute);
+
 #if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
 
 class FRayTracingRTXGIProbeViewRGS : public FGlobalShader
@@ -254,6 +370,8 @@ class FDDGIIrradianceBlend : public FGlobalShader
 
 		SHADER_PARAMETER(int, ProbeIndexStart)
 		SHADER_PARAMETER(int, ProbeIndexCount)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, ProbeBrickUpdate)
+		SHADER_PARAMETER(FIntVector, ProbeBrickCounts)
 
 		SHADER_PARAMETER_RDG_UNIFORM_BUFFER(FDDGIVolumeDescGPU, DDGIVolume)
 		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, DDGIVolumeRayDataUAV)
@@ -312,6 +430,8 @@ class FDDGIDistanceBlend : public FGlobalShader
 
 		SHADER_PARAMETER(int, ProbeIndexStart)
 		SHADER_PARAMETER(int, ProbeIndexCount)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, ProbeBrickUpdate)
+		SHADER_PARAMETER(FIntVector, ProbeBrickCounts)
 
 		SHADER_PARAMETER_RDG_UNIFORM_BUFFER(FDDGIVolumeDescGPU, DDGIVolume)
 		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, DDGIVolumeRayDataUAV)
@@ -420,6 +540,8 @@ class FDDGIProbesRelocate : public FGlobalShader
 		SHADER_PARAMETER(float, ProbeDistanceScale)
 		SHADER_PARAMETER(int, ProbeIndexStart)
 		SHADER_PARAMETER(int, ProbeIndexCount)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, ProbeBrickUpdate)
+		SHADER_PARAMETER(FIntVector, ProbeBrickCounts)
 
 		SHADER_PARAMETER_RDG_UNIFORM_BUFFER(FDDGIVolumeDescGPU, DDGIVolume)
 		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, DDGIVolumeRayDataUAV)
@@ -459,6 +581,8 @@ class FDDGIProbesClassify : public FGlobalShader
 	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
 		SHADER_PARAMETER(int, ProbeIndexStart)
 		SHADER_PARAMETER(int, ProbeIndexCount)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, ProbeBrickUpdate)
+		SHADER_PARAMETER(FIntVector, ProbeBrickCounts)
 
 		SHADER_PARAMETER_RDG_UNIFORM_BUFFER(FDDGIVolumeDescGPU, DDGIVolume)
 		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, DDGIVolumeRayDataUAV)
@@ -468,6 +592,34 @@ class FDDGIProbesClassify : public FGlobalShader
 
 IMPLEMENT_GLOBAL_SHADER(FDDGIProbesClassify, "/Plugin/RTXGI/Private/SDK/ddgi/ProbeStateClassifierCS.usf", "DDGIProbeStateClassifierCS", SF_Compute);
 
+class FDDGIProbeBrickCulling : public FGlobalShader
+{
+	DECLARE_GLOBAL_SHADER(FDDGIProbeBrickCulling)
+	SHADER_USE_PARAMETER_STRUCT(FDDGIProbeBrickCulling, FGlobalShader)
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return ShouldCompileRayTracingShadersForProject(Parameters.Platform);
+	}
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+		SHADER_PARAMETER(FIntVector, ProbeBrickCounts)
+		SHADER_PARAMETER(FMatrix, WorldToClip)
+		SHADER_PARAMETER(FMatrix, PrevWorldToClip)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float>, HZBTexture)
+		SHADER_PARAMETER(FVector2D, HZBSize)
+		SHADER_PARAMETER(FVector2D, HZBUvFactor)
+		SHADER_PARAMETER(int, HZBMipCount)
+		SHADER_PARAMETER(int, UseHZB)
+		SHADER_PARAMETER(int, UpdateOffscreen)
+
+		SHADER_PARAMETER_RDG_UNIFORM_BUFFER(FDDGIVolumeDescGPU, DDGIVolume)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, ProbeBrickUpdateUAV)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+IMPLEMENT_GLOBAL_SHADER(FDDGIProbeBrickCulling, "/Plugin/RTXGI/Private/ProbeBrickCullingCS.usf", "DDGIProbeBrickCullingCS", SF_Compute);
+
 #endif // RHI_RAYTRACING
 
 namespace DDGIVolumeUpdate
@@ -477,18 +629,30 @@ namespace DDGIVolumeUpdate
 	FDelegateHandle PrepareRayTracingHandle;
 
 	void DDGIUpdateVolume_RenderThread(const FScene& Scene, const FViewInfo& View, FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy);
+	void DDGIScheduleVolumeUpdates_RenderThread(const FScene& Scene, const FViewInfo& View, FRDGBuilder& GraphBuilder, const TArray<FDDGIVolumeSceneProxy*>& sceneVolumes, float BudgetMs);
+	bool ShouldDynamicUpdate(const FViewInfo& View);
+
+	// Timestamp queries of the scheduled volume updates
+	FRenderQueryPoolRHIRef TimestampQueryPool;
+
+	// The radiance cache of each scene, shared by the scene's volumes (r.RTXGI.DDGI.RadianceCache)
+	TMap<const FSceneInterface*, TRefCountPtr<FRDGPooledBuffer>> SceneRadianceCaches;
 
 #if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
 	void DDGIUpdateVolume_RenderThread_DDGIProbesTextureVis(const FScene& Scene, const FViewInfo& View, FRDGBuilder& GraphBuilder);
 #endif 
 
-	void DDGIUpdateVolume_RenderThread_RTRadiance(const FScene& Scene, const FViewInfo& View, FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy, const FMatrix& ProbeRayRotationTransform, FRDGTextureRef ProbesRadianceTex, FRDGTextureUAVRef ProbesRadianceUAV, bool highBitCount);
-	void DDGIUpdateVolume_RenderThread_IrradianceBlend(const FViewInfo& View, FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy, const FMatrix& ProbeRayRotationTransform, FRDGTextureUAVRef ProbesRadianceUAV, bool highBitCount);
-	void DDGIUpdateVolume_RenderThread_DistanceBlend(const FViewInfo& View, FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy, const FMatrix& ProbeRayRotationTransform, FRDGTextureUAVRef ProbesRadianceUAV, bool highBitCount);
-	void DDGIUpdateVolume_RenderThread_IrradianceBorderUpdate(const FViewInfo& View, FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy);
-	void DDGIUpdateVolume_RenderThread_DistanceBorderUpdate(const FViewInfo& View, FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy);
-	void DDGIUpdateVolume_RenderThread_RelocateProbes(FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy, const FMatrix& ProbeRayRotationTransform, FRDGTextureUAVRef ProbesRadianceUAV, bool highBitCount);
-	void DDGIUpdateVolume_RenderThread_ClassifyProbes(FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy, FRDGTextureUAVRef ProbesRadianceUAV, bool highBitCount);
+	void DDGIUpdateVolume_RenderThread_CopyLightingTextures(FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy);
+	void DDGIUpdateVolume_RenderThread_ProbeUpdateWindow(FDDGIVolumeSceneProxy* VolProxy);
+	FRDGBufferSRVRef DDGIUpdateVolume_RenderThread_ProbeBrickCulling(const FViewInfo& View, FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy);
+	FRDGBufferUAVRef DDGIUpdateVolume_RenderThread_RadianceCache(const FScene& Scene, FRDGBuilder& GraphBuilder, uint32& OutNumSlots);
+	void DDGIUpdateVolume_RenderThread_RTRadiance(const FScene& Scene, const FViewInfo& View, FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy, const FMatrix& ProbeRayRotationTransform, FRDGTextureRef ProbesRadianceTex, FRDGTextureUAVRef ProbesRadianceUAV, FRDGBufferSRVRef ProbeBrickUpdateSRV, bool highBitCount);
+	void DDGIUpdateVolume_RenderThread_IrradianceBlend(const FViewInfo& View, FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy, const FMatrix& ProbeRayRotationTransform, FRDGTextureUAVRef ProbesRadianceUAV, FRDGBufferSRVRef ProbeBrickUpdateSRV, bool highBitCount, ERDGPassFlags PassFlags);
+	void DDGIUpdateVolume_RenderThread_DistanceBlend(const FViewInfo& View, FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy, const FMatrix& ProbeRayRotationTransform, FRDGTextureUAVRef ProbesRadianceUAV, FRDGBufferSRVRef ProbeBrickUpdateSRV, bool highBitCount, ERDGPassFlags PassFlags);
+	void DDGIUpdateVolume_RenderThread_IrradianceBorderUpdate(const FViewInfo& View, FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy, ERDGPassFlags PassFlags);
+	void DDGIUpdateVolume_RenderThread_DistanceBorderUpdate(const FViewInfo& View, FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy, ERDGPassFlags PassFlags);
+	void DDGIUpdateVolume_RenderThread_RelocateProbes(FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy, const FMatrix& ProbeRayRotationTransform, FRDGTextureUAVRef ProbesRadianceUAV, FRDGBufferSRVRef ProbeBrickUpdateSRV, bool highBitCount, ERDGPassFlags PassFlags);
+	void DDGIUpdateVolume_RenderThread_ClassifyProbes(FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy, FRDGTextureUAVRef ProbesRadianceUAV, FRDGBufferSRVRef ProbeBrickUpdateSRV, bool highBitCount, ERDGPassFlags PassFlags);
 
 	void PrepareRayTracingShaders(const FViewInfo& View, TArray<FRHIRayTracingShader*>& OutRayGenShaders);
 #endif // RHI_RAYTRACING
@@ -521,6 +685,9 @@ namespace DDGIVolumeUpdate
 		FGlobalIlluminationExperimentalPluginDelegates::FAnyRayTracingPassEnabled& ARTPEDelegate = FGlobalIlluminationExperimentalPluginDelegates::AnyRayTracingPassEnabled();
 		check(AnyRayTracingPassEnabledHandle.IsValid());
 		ARTPEDelegate.Remove(AnyRayTracingPassEnabledHandle);
+
+		TimestampQueryPool.SafeRelease();
+		SceneRadianceCaches.Empty();
 #endif // RHI_RAYTRACING
 	}
 
@@ -579,10 +746,24 @@ namespace DDGIVolumeUpdate
 
 #if RHI_RAYTRACING
 
+		// Free the radiance cache of a scene that has no volumes left to update
+		if (sceneVolumes.Num() == 0)
+		{
+			SceneRadianceCaches.Remove(&Scene);
+		}
+
 #if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
 		DDGIUpdateVolume_RenderThread_DDGIProbesTextureVis(Scene, View, GraphBuilder);
 #endif
 
+		// Update the volumes that are worth the most within the GPU time budget, if there is one
+		float ProbeUpdateGPUBudgetMs = GetDefault<URTXGIPluginSettings>()->ProbeUpdateGPUBudgetMs;
+		if (ProbeUpdateGPUBudgetMs > 0.0f)
+		{
+			DDGIScheduleVolumeUpdates_RenderThread(Scene, View, GraphBuilder, sceneVolumes, ProbeUpdateGPUBudgetMs);
+			return;
+		}
+
 		// Advance the scene's round robin value by the golden ratio (conjugate) and use that 
 		// as a "random number" to give each volume a fair turn at recieving an update.
 		float& value = FDDGIVolumeSceneProxy::SceneRoundRobinValue.FindOrAdd(&Scene);
@@ -614,7 +795,7 @@ namespace DDGIVolumeUpdate
 
 		for (int i = 0; i < 8; ++i)
 		{
-			for (int j = 0; j < 3; ++j)
+			for (int j = 0; j < 6; ++j)
 			{
 				FRayTracingRTXGIProbeUpdateRGS::FPermutationDomain PermutationVector;
 				PermutationVector.Set<FRayTracingRTXGIProbeUpdateRGS::FEnableTwoSidedGeometryDim>(true);
@@ -623,7 +804,8 @@ namespace DDGIVolumeUpdate
 				PermutationVector.Set<FRayTracingRTXGIProbeUpdateRGS::FFormatRadiance>((i & 2) != 0 ? true : false);
 				PermutationVector.Set<FRayTracingRTXGIProbeUpdateRGS::FFormatIrradiance>((i & 2) != 0 ? true : false);
 				PermutationVector.Set<FRayTracingRTXGIProbeUpdateRGS::FEnableScrolling>((i & 4) != 0 ? true : false);
-				PermutationVector.Set<FRayTracingRTXGIProbeUpdateRGS::FSkyLight>(j);
+				PermutationVector.Set<FRayTracingRTXGIProbeUpdateRGS::FSkyLight>(j % 3);
+				PermutationVector.Set<FRayTracingRTXGIProbeUpdateRGS::FRadianceCache>(j >= 3);
 				TShaderMapRef<FRayTracingRTXGIProbeUpdateRGS> RayGenerationShader(ShaderMap, PermutationVector);
 
 				OutRayGenShaders.Add(RayGenerationShader.GetRayTracingShader());
@@ -669,6 +851,189 @@ namespace DDGIVolumeUpdate
 		return ShouldRenderRayTracingEffect(true) && View.RayTracingScene.RayTracingSceneRHI != nullptr;
 	}
 
+	// Read back the GPU timestamps of the volume's earlier updates and fold them into its cost per ray
+	static void DDGIReadUpdateTimings_RenderThread(FDDGIVolumeSceneProxy* VolProxy)
+	{
+		static const int c_maxPendingTimings = 8;
+
+		FDDGIVolumeSceneProxy::FUpdateSchedule& Schedule = VolProxy->UpdateSchedule;
+		for (int index = 0; index < Schedule.PendingTimings.Num();)
+		{
+			FDDGIVolumeSceneProxy::FUpdateTiming& Timing = Schedule.PendingTimings[index];
+
+			// Timestamp query results are in microseconds
+			uint64 Begin = 0, End = 0;
+			if (!RHIGetRenderQueryResult(Timing.Begin.GetQuery(), Begin, false) || !RHIGetRenderQueryResult(Timing.End.GetQuery(), End, false))
+			{
+				// Drop the oldest timings if the results never arrive (e.g. the GPU was reset)
+				if (Schedule.PendingTimings.Num() > c_maxPendingTimings) Schedule.PendingTimings.RemoveAt(0);
+				else ++index;
+				continue;
+			}
+
+			if (End > Begin && Timing.Rays > 0)
+			{
+				float MsPerRay = float(End - Begin) / 1000.0f / float(Timing.Rays);
+				Schedule.GPUMsPerRay = (Schedule.GPUMsPerRay == 0.0f) ? MsPerRay : FMath::Lerp(Schedule.GPUMsPerRay, MsPerRay, 0.2f);
+			}
+			Schedule.PendingTimings.RemoveAt(index);
+		}
+	}
+
+	// Flag the volume when a light that affects it (or the sky light) changed since the previous frame
+	static void DDGIUpdateLightingChange_RenderThread(const FScene& Scene, FDDGIVolumeSceneProxy* VolProxy)
+	{
+		const FDDGIVolumeSceneProxy::FComponentData& ComponentData = VolProxy->ComponentData;
+		FVector Extent = ComponentData.Transform.GetScale3D() * 100.0f;
+		FBoxSphereBounds Bounds(ComponentData.Origin, Extent, Extent.Size());
+
+		uint32 Hash = 0;
+		for (const FLightSceneInfoCompact& Light : Scene.Lights)
+		{
+			const FLightSceneProxy* LightProxy = Light.LightSceneInfo->Proxy;
+			if (!LightProxy->AffectsBounds(Bounds)) continue;
+
+			Hash = HashCombine(Hash, GetTypeHash(LightProxy->GetColor()));
+			Hash = HashCombine(Hash, GetTypeHash(FVector(LightProxy->GetPosition())));
+			Hash = HashCombine(Hash, GetTypeHash(LightProxy->GetDirection()));
+		}
+		if (Scene.SkyLight)
+		{
+			Hash = HashCombine(Hash, GetTypeHash(Scene.SkyLight->GetEffectiveLightColor()));
+		}
+
+		FDDGIVolumeSceneProxy::FUpdateSchedule& Schedule = VolProxy->UpdateSchedule;
+		Schedule.LightingChange = (Hash != Schedule.LightingHash) ? 1.0f : Schedule.LightingChange * 0.9f;
+		Schedule.LightingHash = Hash;
+	}
+
+	// The probes of a full update of the volume at the current quality level (r.RTXGI.Quality)
+	static int GetProbeUpdateCount(FDDGIVolumeSceneProxy* VolProxy)
+	{
+		int ProbeCount = VolProxy->ComponentData.GetProbeCount();
+		return FMath::Clamp(int(ProbeCount * VolProxy->ComponentData.ProbeUpdateFraction), 1, ProbeCount);
+	}
+
+	// The value of updating the volume this frame: its screen coverage and proximity to the view, raised by recent
+	// lighting changes and by the frames it waited since its last update, and scaled by its update priority
+	static float GetVolumeUpdateBenefit(const FViewInfo& View, FDDGIVolumeSceneProxy* VolProxy)
+	{
+		const FDDGIVolumeSceneProxy::FComponentData& ComponentData = VolProxy->ComponentData;
+		const FDDGIVolumeSceneProxy::FUpdateSchedule& Schedule = VolProxy->UpdateSchedule;
+
+		float Radius = (ComponentData.Transform.GetScale3D() * 100.0f).Size();
+		float Distance = FVector::Dist(View.ViewMatrices.GetViewOrigin(), ComponentData.Origin);
+
+		// Approximate the projected screen area with the volume's bounding sphere (all of the screen from inside the volume)
+		float Coverage = 1.0f;
+		if (Distance > Radius)
+		{
+			float ScreenRadius = Radius * View.ViewMatrices.GetProjectionMatrix().M[0][0] / Distance;
+			Coverage = FMath::Min(1.0f, PI * ScreenRadius * ScreenRadius / 4.0f);
+		}
+
+		// Volumes outside of the view still light reflections and the next camera turn
+		if (!VolProxy->IntersectsViewFrustum(View)) Coverage *= 0.1f;
+
+		float Proximity = Radius / FMath::Max(Radius, Distance);
+		float Urgency = (1.0f + 0.1f * Schedule.FramesSinceUpdate) * (1.0f + 4.0f * Schedule.LightingChange);
+		return ComponentData.UpdatePriority * (0.75f * Coverage + 0.25f * Proximity) * Urgency;
+	}
+
+	static void AddTimestampPass(FRDGBuilder& GraphBuilder, FRHIRenderQuery* Query)
+	{
+		GraphBuilder.AddPass(
+			RDG_EVENT_NAME("DDGI Timestamp"),
+			ERDGPassFlags::NeverCull,
+			[Query](FRHICommandListImmediate& RHICmdList)
+			{
+				RHICmdList.EndRenderQuery(Query);
+			}
+		);
+	}
+
+	void DDGIScheduleVolumeUpdates_RenderThread(const FScene& Scene, const FViewInfo& View, FRDGBuilder& GraphBuilder, const TArray<FDDGIVolumeSceneProxy*>& sceneVolumes, float BudgetMs)
+	{
+		// A guess for volumes that were not measured yet, until any volume is
+		static const float c_defaultGPUMsPerRay = 2e-6f;
+
+		if (!ShouldDynamicUpdate(View) || sceneVolumes.Num() == 0) return;
+
+		if (!TimestampQueryPool.IsValid())
+		{
+			TimestampQueryPool = RHICreateRenderQueryPool(RQT_AbsoluteTime);
+		}
+
+		struct FCandidate
+		{
+			FDDGIVolumeSceneProxy* Proxy;
+			float MsPerRay;
+			float Cost;         // GPU time of a full update (ms)
+			float Value;        // Benefit per ms
+		};
+
+		// Estimate the cost per ray of unmeasured volumes from the measured ones
+		float MeasuredMsPerRay = 0.0f;
+		int MeasuredCount = 0;
+		for (FDDGIVolumeSceneProxy* proxy : sceneVolumes)
+		{
+			DDGIReadUpdateTimings_RenderThread(proxy);
+			DDGIUpdateLightingChange_RenderThread(Scene, proxy);
+			if (proxy->UpdateSchedule.GPUMsPerRay > 0.0f)
+			{
+				MeasuredMsPerRay += proxy->UpdateSchedule.GPUMsPerRay;
+				MeasuredCount++;
+			}
+		}
+		float DefaultMsPerRay = (MeasuredCount > 0) ? (MeasuredMsPerRay / MeasuredCount) : c_defaultGPUMsPerRay;
+
+		TArray<FCandidate> Candidates;
+		for (FDDGIVolumeSceneProxy* proxy : sceneVolumes)
+		{
+			float MsPerRay = (proxy->UpdateSchedule.GPUMsPerRay > 0.0f) ? proxy->UpdateSchedule.GPUMsPerRay : DefaultMsPerRay;
+			float Cost = MsPerRay * GetProbeUpdateCount(proxy) * proxy->ComponentData.GetNumRaysPerProbe();
+			Candidates.Add(FCandidate{ proxy, MsPerRay, Cost, GetVolumeUpdateBenefit(View, proxy) / FMath::Max(Cost, 1e-6f) });
+			proxy->UpdateSchedule.FramesSinceUpdate++;
+		}
+		Candidates.Sort([](const FCandidate& a, const FCandidate& b) { return a.Value > b.Value; });
+
+		// Fill the budget with the volumes worth the most per ms. A volume that doesn't fit updates a subset of its probes
+		// (round robin within the volume), and the best volume always updates so a small budget can't starve every volume.
+		float RemainingMs = BudgetMs;
+		for (int index = 0; index < Candidates.Num() && RemainingMs > 0.0f; ++index)
+		{
+			const FCandidate& Candidate = Candidates[index];
+			FDDGIVolumeSceneProxy* proxy = Candidate.Proxy;
+			int RaysPerProbe = proxy->ComponentData.GetNumRaysPerProbe();
+
+			int ProbeUpdateCount = GetProbeUpdateCount(proxy);
+			int RayBudget = (ProbeUpdateCount < proxy->ComponentData.GetProbeCount()) ? ProbeUpdateCount * RaysPerProbe : 0;
+			if (Candidate.Cost > RemainingMs)
+			{
+				int Probes = int(RemainingMs / (Candidate.MsPerRay * RaysPerProbe));
+				if (Probes < FMath::Max(1, ProbeUpdateCount / 8) && index > 0) continue;
+				RayBudget = FMath::Max(1, Probes) * RaysPerProbe;
+			}
+
+			proxy->UpdateSchedule.RayBudget = RayBudget;
+			proxy->UpdateSchedule.FramesSinceUpdate = 0;
+
+			FDDGIVolumeSceneProxy::FUpdateTiming Timing;
+			Timing.Begin = TimestampQueryPool->AllocateQuery();
+			Timing.End = TimestampQueryPool->AllocateQuery();
+
+			AddTimestampPass(GraphBuilder, Timing.Begin.GetQuery());
+			DDGIUpdateVolume_RenderThread(Scene, View, GraphBuilder, proxy);
+			AddTimestampPass(GraphBuilder, Timing.End.GetQuery());
+
+			Timing.Rays = proxy->ProbeIndexCount * RaysPerProbe;
+			RemainingMs -= Candidate.MsPerRay * Timing.Rays;
+
+			proxy->UpdateSchedule.PendingTimings.Add(MoveTemp(Timing));
+			proxy->UpdateSchedule.RayBudget = -1;
+		}
+	}
+
 	void DDGIUpdateVolume_RenderThread(const FScene& Scene, const FViewInfo& View, FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy)
 	{
 		// Early out if ray tracing is not enabled
@@ -703,20 +1068,33 @@ namespace DDGIVolumeUpdate
 			ProbesRadianceUAV = GraphBuilder.CreateUAV(ProbesRadianceTex);
 		}
 
-		DDGIUpdateVolume_RenderThread_RTRadiance(Scene, View, GraphBuilder, VolProxy, ProbeRayRotationTransform, ProbesRadianceTex, ProbesRadianceUAV, highBitCount);
-		DDGIUpdateVolume_RenderThread_IrradianceBlend(View, GraphBuilder, VolProxy, ProbeRayRotationTransform, ProbesRadianceUAV, highBitCount);
-		DDGIUpdateVolume_RenderThread_DistanceBlend(View, GraphBuilder, VolProxy, ProbeRayRotationTransform, ProbesRadianceUAV, highBitCount);
-		DDGIUpdateVolume_RenderThread_IrradianceBorderUpdate(View, GraphBuilder, VolProxy);
-		DDGIUpdateVolume_RenderThread_DistanceBorderUpdate(View, GraphBuilder, VolProxy);
+		// The probe ray tracing stays on the graphics queue, the passes that consume its results can run on async compute.
+		// The lighting pass then reads a copy of the probe textures from before the update, so it doesn't wait on the
+		// update passes and they can overlap the rest of the frame. RDG fences the update against the copies and the ray tracing.
+		bool bAsyncCompute = CVarDDGIAsyncCompute.GetValueOnRenderThread() != 0 && GSupportsEfficientAsyncCompute;
+		ERDGPassFlags PassFlags = bAsyncCompute ? ERDGPassFlags::AsyncCompute : ERDGPassFlags::Compute;
+		if (bAsyncCompute)
+		{
+			DDGIUpdateVolume_RenderThread_CopyLightingTextures(GraphBuilder, VolProxy);
+		}
+
+		DDGIUpdateVolume_RenderThread_ProbeUpdateWindow(VolProxy);
+		FRDGBufferSRVRef ProbeBrickUpdateSRV = DDGIUpdateVolume_RenderThread_ProbeBrickCulling(View, GraphBuilder, VolProxy);
+
+		DDGIUpdateVolume_RenderThread_RTRadiance(Scene, View, GraphBuilder, VolProxy, ProbeRayRotationTransform, ProbesRadianceTex, ProbesRadianceUAV, ProbeBrickUpdateSRV, highBitCount);
+		DDGIUpdateVolume_RenderThread_IrradianceBlend(View, GraphBuilder, VolProxy, ProbeRayRotationTransform, ProbesRadianceUAV, ProbeBrickUpdateSRV, highBitCount, PassFlags);
+		DDGIUpdateVolume_RenderThread_DistanceBlend(View, GraphBuilder, VolProxy, ProbeRayRotationTransform, ProbesRadianceUAV, ProbeBrickUpdateSRV, highBitCount, PassFlags);
+		DDGIUpdateVolume_RenderThread_IrradianceBorderUpdate(View, GraphBuilder, VolProxy, PassFlags);
+		DDGIUpdateVolume_RenderThread_DistanceBorderUpdate(View, GraphBuilder, VolProxy, PassFlags);
 
 		if (VolProxy->ComponentData.EnableProbeRelocation)
 		{
-			DDGIUpdateVolume_RenderThread_RelocateProbes(GraphBuilder, VolProxy, ProbeRayRotationTransform, ProbesRadianceUAV, highBitCount);
+			DDGIUpdateVolume_RenderThread_RelocateProbes(GraphBuilder, VolProxy, ProbeRayRotationTransform, ProbesRadianceUAV, ProbeBrickUpdateSRV, highBitCount, PassFlags);
 		}
 
 		if (FDDGIVolumeSceneProxy::FComponentData::c_RTXGI_DDGI_PROBE_CLASSIFICATION)
 		{
-			DDGIUpdateVolume_RenderThread_ClassifyProbes(GraphBuilder, VolProxy, ProbesRadianceUAV, highBitCount);
+			DDGIUpdateVolume_RenderThread_ClassifyProbes(GraphBuilder, VolProxy, ProbesRadianceUAV, ProbeBrickUpdateSRV, highBitCount, PassFlags);
 		}
 	}
 
@@ -800,14 +1178,27 @@ namespace DDGIVolumeUpdate
 	}
 #endif //!(UE_BUILD_SHIPPING || UE_BUILD_TEST)
 
-	void DDGIUpdateVolume_RenderThread_RTRadiance(const FScene& Scene, const FViewInfo& View, FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy, const FMatrix& ProbeRayRotationTransform, FRDGTextureRef ProbesRadianceTex, FRDGTextureUAVRef ProbesRadianceUAV, bool highBitCount)
+	void DDGIUpdateVolume_RenderThread_ProbeUpdateWindow(FDDGIVolumeSceneProxy* VolProxy)
 	{
-		// Deal with probe ray budgets, and updating probes in a round robin fashion within the volume
+		// Deal with probe ray budgets, and updating probes in a round robin fashion within the volume.
+		// The GPU time budgeted scheduler sets the budget of its updates itself.
+		// Otherwise the quality level (r.RTXGI.Quality) traces a fraction of the probes, or of the ray budget.
 		int ProbeUpdateRayBudget = GetDefault<URTXGIPluginSettings>()->ProbeUpdateRayBudget;
+		if (VolProxy->UpdateSchedule.RayBudget >= 0)
+		{
+			ProbeUpdateRayBudget = VolProxy->UpdateSchedule.RayBudget;
+		}
+		else if (VolProxy->ComponentData.ProbeUpdateFraction < 1.0f)
+		{
+			int RaysPerProbe = VolProxy->ComponentData.GetNumRaysPerProbe();
+			if (ProbeUpdateRayBudget == 0) ProbeUpdateRayBudget = VolProxy->ComponentData.GetProbeCount() * RaysPerProbe;
+			ProbeUpdateRayBudget = FMath::Max(RaysPerProbe, int(ProbeUpdateRayBudget * VolProxy->ComponentData.ProbeUpdateFraction));
+		}
 		if (ProbeUpdateRayBudget == 0)
 		{
 			VolProxy->ProbeIndexStart = 0;
 			VolProxy->ProbeIndexCount = VolProxy->ComponentData.GetProbeCount();
+			VolProxy->ProbeSweepCount++;
 		}
 		else
 		{
@@ -817,11 +1208,120 @@ namespace DDGIVolumeUpdate
 				ProbeUpdateBudget = 1;
 			if (ProbeUpdateBudget > ProbeCount)
 				ProbeUpdateBudget = ProbeCount;
+			int PreviousIndexStart = VolProxy->ProbeIndexStart;
 			VolProxy->ProbeIndexStart += ProbeUpdateBudget;
 			VolProxy->ProbeIndexStart = VolProxy->ProbeIndexStart % ProbeCount;
+			if (VolProxy->ProbeIndexStart <= PreviousIndexStart) VolProxy->ProbeSweepCount++;
 			VolProxy->ProbeIndexCount = ProbeUpdateBudget;
 		}
+	}
+
+	FRDGBufferSRVRef DDGIUpdateVolume_RenderThread_ProbeBrickCulling(const FViewInfo& View, FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy)
+	{
+		FIntVector ProbeBrickCounts = VolProxy->ComponentData.GetProbeBrickCounts();
+		int NumBricks = ProbeBrickCounts.X * ProbeBrickCounts.Y * ProbeBrickCounts.Z;
+
+		FRDGBufferRef ProbeBrickUpdate = GraphBuilder.CreateBuffer(FRDGBufferDesc::CreateBufferDesc(sizeof(uint32), NumBricks), TEXT("DDGIProbeBrickUpdate"));
+		FRDGBufferUAVRef ProbeBrickUpdateUAV = GraphBuilder.CreateUAV(ProbeBrickUpdate, PF_R32_UINT);
+
+		// Update every brick when culling is off, or for scrolling volumes, which stay centered on what they light
+		int OffscreenInterval = CVarDDGIProbeBrickCullingOffscreenInterval.GetValueOnRenderThread();
+		if (CVarDDGIProbeBrickCulling.GetValueOnRenderThread() == 0 || VolProxy->ComponentData.EnableProbeScrolling || OffscreenInterval <= 1)
+		{
+			AddClearUAVPass(GraphBuilder, ProbeBrickUpdateUAV, 1u);
+			return GraphBuilder.CreateSRV(ProbeBrickUpdate, PF_R32_UINT);
+		}
 
+		FGlobalShaderMap* ShaderMap = GetGlobalShaderMap(ERHIFeatureLevel::SM5);
+		TShaderMapRef<FDDGIProbeBrickCulling> ComputeShader(ShaderMap);
+
+		// calculate grid spacing based on size (scale) and probe count
+		// regarding the *200: the scale is the radius so we need to double it. There is also an implict * 100 of the basic box.
+		FVector volumeSize = VolProxy->ComponentData.Transform.GetScale3D() * 200.0f;
+		FVector probeGridSpacing;
+		probeGridSpacing.X = volumeSize.X / float(VolProxy->ComponentData.ProbeCounts.X);
+		probeGridSpacing.Y = volumeSize.Y / float(VolProxy->ComponentData.ProbeCounts.Y);
+		probeGridSpacing.Z = volumeSize.Z / float(VolProxy->ComponentData.ProbeCounts.Z);
+
+		FDDGIVolumeDescGPU DefaultDDGIVolumeDescGPU;
+		FDDGIVolumeDescGPU* DDGIVolumeDescGPU = GraphBuilder.AllocParameters<FDDGIVolumeDescGPU>();
+		*DDGIVolumeDescGPU = DefaultDDGIVolumeDescGPU;
+		DDGIVolumeDescGPU->origin = VolProxy->ComponentData.Origin;
+		FQuat rotation = VolProxy->ComponentData.Transform.GetRotation();
+		DDGIVolumeDescGPU->rotation = FVector4{ rotation.X, rotation.Y, rotation.Z, rotation.W };
+		DDGIVolumeDescGPU->probeGridSpacing = probeGridSpacing;
+		DDGIVolumeDescGPU->probeGridCounts = VolProxy->ComponentData.ProbeCounts;
+
+		FDDGIProbeBrickCulling::FParameters DefaultPassParameters;
+		FDDGIProbeBrickCulling::FParameters* PassParameters = GraphBuilder.AllocParameters<FDDGIProbeBrickCulling::FParameters>();
+		*PassParameters = DefaultPassParameters;
+
+		PassParameters->DDGIVolume = GraphBuilder.CreateUniformBuffer(DDGIVolumeDescGPU);
+		PassParameters->ProbeBrickCounts = ProbeBrickCounts;
+		PassParameters->WorldToClip = View.ViewMatrices.GetViewProjectionMatrix();
+		PassParameters->PrevWorldToClip = View.PrevViewInfo.ViewMatrices.GetViewProjectionMatrix();
+
+		// Off-screen bricks update once every few sweeps of the round robin over the volume's probes
+		PassParameters->UpdateOffscreen = (VolProxy->ProbeSweepCount % OffscreenInterval) == 0;
+
+		// Occlusion culling against last frame's HZB, which doesn't match the view after a camera cut
+		const TRefCountPtr<IPooledRenderTarget>& HZB = View.PrevViewInfo.HZB;
+		bool bUseHZB = HZB.IsValid() && !View.bCameraCut && !View.bPrevTransformsReset;
+		PassParameters->UseHZB = bUseHZB;
+		PassParameters->HZBTexture = GraphBuilder.RegisterExternalTexture(bUseHZB ? HZB : GSystemTextures.BlackDummy);
+		if (bUseHZB)
+		{
+			const FPooledRenderTargetDesc& HZBDesc = HZB->GetDesc();
+			PassParameters->HZBSize = FVector2D(HZBDesc.Extent);
+			PassParameters->HZBUvFactor = FVector2D(View.ViewRect.Size()) * 0.5f / FVector2D(HZBDesc.Extent);
+			PassParameters->HZBMipCount = HZBDesc.NumMips;
+		}
+
+		PassParameters->ProbeBrickUpdateUAV = ProbeBrickUpdateUAV;
+
+		FComputeShaderUtils::AddPass(
+			GraphBuilder,
+			RDG_EVENT_NAME("DDGI Probe Brick Culling"),
+			ComputeShader,
+			PassParameters,
+			FComputeShaderUtils::GetGroupCount(NumBricks, 64)
+		);
+
+		return GraphBuilder.CreateSRV(ProbeBrickUpdate, PF_R32_UINT);
+	}
+
+	FRDGBufferUAVRef DDGIUpdateVolume_RenderThread_RadianceCache(const FScene& Scene, FRDGBuilder& GraphBuilder, uint32& OutNumSlots)
+	{
+		if (CVarDDGIRadianceCache.GetValueOnRenderThread() == 0)
+		{
+			SceneRadianceCaches.Remove(&Scene);
+			OutNumSlots = 0;
+			return nullptr;
+		}
+
+		// Each slot is 4 uints, see RadianceCacheCommon.ush
+		OutNumSlots = uint32(FMath::Clamp(CVarDDGIRadianceCacheSize.GetValueOnRenderThread(), 1024, 16 * 1024 * 1024));
+		FRDGBufferDesc Desc = FRDGBufferDesc::CreateBufferDesc(sizeof(uint32), 4 * OutNumSlots);
+
+		// The volumes of the scene share the cache across frames, so it's allocated outside of the render graph
+		TRefCountPtr<FRDGPooledBuffer>& PooledCache = SceneRadianceCaches.FindOrAdd(&Scene);
+		bool bAllocated = false;
+		if (!PooledCache.IsValid() || PooledCache->Desc.NumElements != Desc.NumElements)
+		{
+			PooledCache = AllocatePooledBuffer(Desc, TEXT("DDGIRadianceCache"));
+			bAllocated = true;
+		}
+
+		FRDGBufferUAVRef CacheUAV = GraphBuilder.CreateUAV(GraphBuilder.RegisterExternalBuffer(PooledCache), PF_R32_UINT);
+		if (bAllocated)
+		{
+			AddClearUAVPass(GraphBuilder, CacheUAV, 0u);
+		}
+		return CacheUAV;
+	}
+
+	void DDGIUpdateVolume_RenderThread_RTRadiance(const FScene& Scene, const FViewInfo& View, FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy, const FMatrix& ProbeRayRotationTransform, FRDGTextureRef ProbesRadianceTex, FRDGTextureUAVRef ProbesRadianceUAV, FRDGBufferSRVRef ProbeBrickUpdateSRV, bool highBitCount)
+	{
 		const auto FeatureLevel = GMaxRHIFeatureLevel;
 		auto ShaderMap = GetGlobalShaderMap(FeatureLevel);
 
@@ -833,6 +1333,10 @@ namespace DDGIVolumeUpdate
 		PermutationVector.Set<FRayTracingRTXGIProbeUpdateRGS::FFormatIrradiance>(highBitCount);
 		PermutationVector.Set<FRayTracingRTXGIProbeUpdateRGS::FEnableScrolling>(VolProxy->ComponentData.EnableProbeScrolling);
 		PermutationVector.Set<FRayTracingRTXGIProbeUpdateRGS::FSkyLight>(int(VolProxy->ComponentData.SkyLightTypeOnRayMiss));
+
+		uint32 RadianceCacheNumSlots = 0;
+		FRDGBufferUAVRef RadianceCacheUAV = DDGIUpdateVolume_RenderThread_RadianceCache(Scene, GraphBuilder, RadianceCacheNumSlots);
+		PermutationVector.Set<FRayTracingRTXGIProbeUpdateRGS::FRadianceCache>(RadianceCacheUAV != nullptr);
 		TShaderMapRef<FRayTracingRTXGIProbeUpdateRGS> RayGenerationShader(ShaderMap, PermutationVector);
 
 		FRayTracingRTXGIProbeUpdateRGS::FParameters DefaultPassParameters;
@@ -844,6 +1348,12 @@ namespace DDGIVolumeUpdate
 		PassParameters->RadianceOutput = ProbesRadianceUAV;
 		PassParameters->FrameRandomSeed = GFrameNumber;
 
+		PassParameters->RadianceCache = RadianceCacheUAV;
+		PassParameters->RadianceCache_NumSlots = RadianceCacheNumSlots;
+		PassParameters->RadianceCache_CellSize = FMath::Max(CVarDDGIRadianceCacheCellSize.GetValueOnRenderThread(), 1.0f);
+		PassParameters->RadianceCache_FrameIndex = GFrameNumber;
+		PassParameters->RadianceCache_MaxAge = uint32(FMath::Max(CVarDDGIRadianceCacheMaxAge.GetValueOnRenderThread(), 0));
+
 		// skylight parameters
 		if (Scene.SkyLight && Scene.SkyLight->ProcessedTexture)
 		{
@@ -871,6 +1381,8 @@ namespace DDGIVolumeUpdate
 			PassParameters->DDGIVolume_EmissiveMultiplier = VolProxy->ComponentData.EmissiveMultiplier;
 			PassParameters->DDGIVolume_ProbeIndexStart = VolProxy->ProbeIndexStart;
 			PassParameters->DDGIVolume_ProbeIndexCount = VolProxy->ProbeIndexCount;
+			PassParameters->ProbeBrickUpdate = ProbeBrickUpdateSRV;
+			PassParameters->ProbeBrickCounts = VolProxy->ComponentData.GetProbeBrickCounts();
 
 			// calculate grid spacing based on size (scale) and probe count
 			// regarding the *200: the scale is the radius so we need to double it. There is also an implict * 100 of the basic box.
@@ -915,6 +1427,46 @@ namespace DDGIVolumeUpdate
 
 		FIntPoint DispatchSize = ProbesRadianceTex->Desc.Extent;
 
+		// Trace the probe rays inline from a compute shader, skipping the material hit shaders and the ray traced lights
+		if (CVarDDGIInlineProbeTrace.GetValueOnRenderThread() != 0 && GRHISupportsInlineRayTracing)
+		{
+			FDDGIProbeTraceCS::FPermutationDomain PermutationVectorCS;
+			PermutationVectorCS.Set<FDDGIProbeTraceCS::FEnableRelocation>(VolProxy->ComponentData.EnableProbeRelocation);
+			PermutationVectorCS.Set<FDDGIProbeTraceCS::FFormatRadiance>(highBitCount);
+			PermutationVectorCS.Set<FDDGIProbeTraceCS::FFormatIrradiance>(highBitCount);
+			PermutationVectorCS.Set<FDDGIProbeTraceCS::FEnableScrolling>(VolProxy->ComponentData.EnableProbeScrolling);
+			PermutationVectorCS.Set<FDDGIProbeTraceCS::FSkyLight>(int(VolProxy->ComponentData.SkyLightTypeOnRayMiss));
+			PermutationVectorCS.Set<FDDGIProbeTraceCS::FRadianceCache>(RadianceCacheUAV != nullptr);
+			TShaderMapRef<FDDGIProbeTraceCS> ComputeShader(ShaderMap, PermutationVectorCS);
+
+			FDDGIProbeTraceCS::FParameters* TraceParameters = GraphBuilder.AllocParameters<FDDGIProbeTraceCS::FParameters>();
+			TraceParameters->ProbeUpdate = *PassParameters;
+			TraceParameters->SceneTextures = CreateSceneTextureUniformBuffer(GraphBuilder, View.FeatureLevel);
+
+			// Light directions point away from the light
+			if (Scene.SimpleDirectionalLight && Scene.SimpleDirectionalLight->Proxy)
+			{
+				TraceParameters->DirectionalLight_Direction = -Scene.SimpleDirectionalLight->Proxy->GetDirection();
+				TraceParameters->DirectionalLight_Color = FVector(Scene.SimpleDirectionalLight->Proxy->GetColor());
+			}
+			else
+			{
+				TraceParameters->DirectionalLight_Direction = FVector(0.0f, 0.0f, 1.0f);
+				TraceParameters->DirectionalLight_Color = FVector(0.0f);
+			}
+			TraceParameters->LightweightAlbedo = FMath::Clamp(CVarDDGIInlineProbeTraceAlbedo.GetValueOnRenderThread(), 0.0f, 1.0f);
+			TraceParameters->GBufferDepthTolerance = 0.02f;
+
+			FComputeShaderUtils::AddPass(
+				GraphBuilder,
+				RDG_EVENT_NAME("DDGI Inline Probe Trace %dx%d", DispatchSize.X, DispatchSize.Y),
+				ComputeShader,
+				TraceParameters,
+				FComputeShaderUtils::GetGroupCount(DispatchSize, FIntPoint(64, 1))
+			);
+			return;
+		}
+
 		GraphBuilder.AddPass(
 			RDG_EVENT_NAME("DDGI RTRadiance %dx%d", DispatchSize.X, DispatchSize.Y),
 			PassParameters,
@@ -930,7 +1482,26 @@ namespace DDGIVolumeUpdate
 		);
 	}
 
-	void DDGIUpdateVolume_RenderThread_IrradianceBlend(const FViewInfo& View, FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy, const FMatrix& ProbeRayRotationTransform, FRDGTextureUAVRef ProbesRadianceUAV, bool highBitCount)
+	void DDGIUpdateVolume_RenderThread_CopyLightingTextures(FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy)
+	{
+		auto CopyTexture = [&GraphBuilder](const TRefCountPtr<IPooledRenderTarget>& ProbesTexture, const TCHAR* Name) -> FRDGTextureRef
+		{
+			if (!ProbesTexture) return nullptr;
+
+			FRDGTextureRef Source = GraphBuilder.RegisterExternalTexture(ProbesTexture);
+			FRDGTextureRef Copy = GraphBuilder.CreateTexture(Source->Desc, Name);
+			AddCopyTexturePass(GraphBuilder, Source, Copy, FRHICopyTextureInfo{});
+			return Copy;
+		};
+
+		FDDGIVolumeSceneProxy::FLightingTextures& LightingTextures = VolProxy->LightingTextures;
+		LightingTextures.Irradiance = CopyTexture(VolProxy->ProbesIrradiance, TEXT("DDGIIrradianceLighting"));
+		LightingTextures.Distance = CopyTexture(VolProxy->ProbesDistance, TEXT("DDGIDistanceLighting"));
+		LightingTextures.Offsets = CopyTexture(VolProxy->ProbesOffsets, TEXT("DDGIOffsetsLighting"));
+		LightingTextures.States = CopyTexture(VolProxy->ProbesStates, TEXT("DDGIStatesLighting"));
+	}
+
+	void DDGIUpdateVolume_RenderThread_IrradianceBlend(const FViewInfo& View, FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy, const FMatrix& ProbeRayRotationTransform, FRDGTextureUAVRef ProbesRadianceUAV, FRDGBufferSRVRef ProbeBrickUpdateSRV, bool highBitCount, ERDGPassFlags PassFlags)
 	{
 		FGlobalShaderMap* ShaderMap = GetGlobalShaderMap(ERHIFeatureLevel::SM5);
 		FDDGIIrradianceBlend::FPermutationDomain PermutationVector;
@@ -970,6 +1541,8 @@ namespace DDGIVolumeUpdate
 
 		PassParameters->ProbeIndexStart = VolProxy->ProbeIndexStart;
 		PassParameters->ProbeIndexCount = VolProxy->ProbeIndexCount;
+		PassParameters->ProbeBrickUpdate = ProbeBrickUpdateSRV;
+		PassParameters->ProbeBrickCounts = VolProxy->ComponentData.GetProbeBrickCounts();
 
 		PassParameters->DDGIVolume = GraphBuilder.CreateUniformBuffer(DDGIVolumeDescGPU);
 
@@ -992,13 +1565,14 @@ namespace DDGIVolumeUpdate
 		FComputeShaderUtils::AddPass(
 			GraphBuilder,
 			RDG_EVENT_NAME("DDGI Radiance Blend"),
+			PassFlags,
 			ComputeShader,
 			PassParameters,
 			FIntVector(ProbeCount2D.X, ProbeCount2D.Y, 1)
 		);
 	}
 
-	void DDGIUpdateVolume_RenderThread_DistanceBlend(const FViewInfo& View, FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy, const FMatrix& ProbeRayRotationTransform, FRDGTextureUAVRef ProbesRadianceUAV, bool highBitCount)
+	void DDGIUpdateVolume_RenderThread_DistanceBlend(const FViewInfo& View, FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy, const FMatrix& ProbeRayRotationTransform, FRDGTextureUAVRef ProbesRadianceUAV, FRDGBufferSRVRef ProbeBrickUpdateSRV, bool highBitCount, ERDGPassFlags PassFlags)
 	{
 		FGlobalShaderMap* ShaderMap = GetGlobalShaderMap(ERHIFeatureLevel::SM5);
 		FDDGIDistanceBlend::FPermutationDomain PermutationVector;
@@ -1037,6 +1611,8 @@ namespace DDGIVolumeUpdate
 
 		PassParameters->ProbeIndexStart = VolProxy->ProbeIndexStart;
 		PassParameters->ProbeIndexCount = VolProxy->ProbeIndexCount;
+		PassParameters->ProbeBrickUpdate = ProbeBrickUpdateSRV;
+		PassParameters->ProbeBrickCounts = VolProxy->ComponentData.GetProbeBrickCounts();
 
 		PassParameters->DDGIVolume = GraphBuilder.CreateUniformBuffer(DDGIVolumeDescGPU);
 
@@ -1059,13 +1635,14 @@ namespace DDGIVolumeUpdate
 		FComputeShaderUtils::AddPass(
 			GraphBuilder,
 			RDG_EVENT_NAME("DDGI Distance Blend"),
+			PassFlags,
 			ComputeShader,
 			PassParameters,
 			FIntVector(ProbeCount2D.X, ProbeCount2D.Y, 1)
 		);
 	}
 
-	void DDGIUpdateVolume_RenderThread_IrradianceBorderUpdate(const FViewInfo& View, FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy)
+	void DDGIUpdateVolume_RenderThread_IrradianceBorderUpdate(const FViewInfo& View, FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy, ERDGPassFlags PassFlags)
 	{
 		float groupSize = 8.0f;
 		FIntPoint ProbeCount2D = VolProxy->ComponentData.Get2DProbeCount();
@@ -1091,6 +1668,7 @@ namespace DDGIVolumeUpdate
 			FComputeShaderUtils::AddPass(
 				GraphBuilder,
 				RDG_EVENT_NAME("DDGI Irradiance Border Update Row"),
+				PassFlags,
 				ComputeShader,
 				PassParameters,
 				FIntVector(numGroupsX, numGroupsY, 1)
@@ -1118,6 +1696,7 @@ namespace DDGIVolumeUpdate
 			FComputeShaderUtils::AddPass(
 				GraphBuilder,
 				RDG_EVENT_NAME("DDGI Irradiance Border Update Column"),
+				PassFlags,
 				ComputeShader,
 				PassParameters,
 				FIntVector(numGroupsX, numGroupsY, 1)
@@ -1125,7 +1704,7 @@ namespace DDGIVolumeUpdate
 		}
 	}
 
-	void DDGIUpdateVolume_RenderThread_DistanceBorderUpdate(const FViewInfo& View, FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy)
+	void DDGIUpdateVolume_RenderThread_DistanceBorderUpdate(const FViewInfo& View, FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy, ERDGPassFlags PassFlags)
 	{
 		float groupSize = 8.0f;
 		FIntPoint ProbeCount2D = VolProxy->ComponentData.Get2DProbeCount();
@@ -1151,6 +1730,7 @@ namespace DDGIVolumeUpdate
 			FComputeShaderUtils::AddPass(
 				GraphBuilder,
 				RDG_EVENT_NAME("DDGI Distance Border Update Row"),
+				PassFlags,
 				ComputeShader,
 				PassParameters,
 				FIntVector(numGroupsX, numGroupsY, 1)
@@ -1178,6 +1758,7 @@ namespace DDGIVolumeUpdate
 			FComputeShaderUtils::AddPass(
 				GraphBuilder,
 				RDG_EVENT_NAME("DDGI Distance Border Update Column"),
+				PassFlags,
 				ComputeShader,
 				PassParameters,
 				FIntVector(numGroupsX, numGroupsY, 1)
@@ -1185,7 +1766,7 @@ namespace DDGIVolumeUpdate
 		}
 	}
 
-	void DDGIUpdateVolume_RenderThread_RelocateProbes(FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy, const FMatrix& ProbeRayRotationTransform, FRDGTextureUAVRef ProbesRadianceUAV, bool highBitCount)
+	void DDGIUpdateVolume_RenderThread_RelocateProbes(FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy, const FMatrix& ProbeRayRotationTransform, FRDGTextureUAVRef ProbesRadianceUAV, FRDGBufferSRVRef ProbeBrickUpdateSRV, bool highBitCount, ERDGPassFlags PassFlags)
 	{
 		FDDGIProbesRelocate::FPermutationDomain PermutationVector;
 		PermutationVector.Set<FDDGIProbesRelocate::FFormatRadiance>(highBitCount);
@@ -1222,6 +1803,8 @@ namespace DDGIVolumeUpdate
 
 		PassParameters->ProbeIndexStart = VolProxy->ProbeIndexStart;
 		PassParameters->ProbeIndexCount = VolProxy->ProbeIndexCount;
+		PassParameters->ProbeBrickUpdate = ProbeBrickUpdateSRV;
+		PassParameters->ProbeBrickCounts = VolProxy->ComponentData.GetProbeBrickCounts();
 
 		PassParameters->DDGIVolume = GraphBuilder.CreateUniformBuffer(DDGIVolumeDescGPU);
 
@@ -1242,13 +1825,14 @@ namespace DDGIVolumeUpdate
 		FComputeShaderUtils::AddPass(
 			GraphBuilder,
 			RDG_EVENT_NAME("DDGI Probe Relocation"),
+			PassFlags,
 			ComputeShader,
 			PassParameters,
 			FIntVector(numGroupsX, numGroupsY, 1)
 		);
 	}
 
-	void DDGIUpdateVolume_RenderThread_ClassifyProbes(FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy, FRDGTextureUAVRef ProbesRadianceUAV, bool highBitCount)
+	void DDGIUpdateVolume_RenderThread_ClassifyProbes(FRDGBuilder& GraphBuilder, FDDGIVolumeSceneProxy* VolProxy, FRDGTextureUAVRef ProbesRadianceUAV, FRDGBufferSRVRef ProbeBrickUpdateSRV, bool highBitCount, ERDGPassFlags PassFlags)
 	{
 		// get the permuted shader
 		FDDGIProbesClassify::FPermutationDomain PermutationVector;
@@ -1283,6 +1867,8 @@ namespace DDGIVolumeUpdate
 
 		PassParameters->ProbeIndexStart = VolProxy->ProbeIndexStart;
 		PassParameters->ProbeIndexCount = VolProxy->ProbeIndexCount;
+		PassParameters->ProbeBrickUpdate = ProbeBrickUpdateSRV;
+		PassParameters->ProbeBrickCounts = VolProxy->ComponentData.GetProbeBrickCounts();
 
 		PassParameters->DDGIVolume = GraphBuilder.CreateUniformBuffer(DDGIVolumeDescGPU);
 
@@ -1304,6 +1890,7 @@ namespace DDGIVolumeUpdate
 		FComputeShaderUtils::AddPass(
 			GraphBuilder,
 			RDG_EVENT_NAME("DDGI Probe Classification"),
+			PassFlags,
 			ComputeShader,
 			PassParameters,
 			FIntVector(numGroupsX, numGroupsY, 1)
@@ -16,6 +16,7 @@
 #include "ShaderParameterStruct.h"
 #include "ShaderParameterUtils.h"
 #include "SystemTextures.h"
+#include "RenderGraphUtils.h"
 
 // UE4 private interfaces
 #include "PostProcess/SceneRenderTargets.h"
@@ -27,6 +28,21 @@
 
 DECLARE_GPU_STAT_NAMED(RTXGI_Visualizations, TEXT("RTXGI Visualizations"));
 
+static TAutoConsoleVariable<float> CVarProbesVisualizationMaxDistance(
+	TEXT("r.RTXGI.DDGI.ProbesVisualization.MaxDistance"),
+	0.0f,
+	TEXT("Probes further than this distance from the camera are not drawn by the probe visualization. 0 draws the probes at any distance.\n"),
+	ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int> CVarProbesVisualizationShowInactive(
+	TEXT("r.RTXGI.DDGI.ProbesVisualization.ShowInactive"),
+	1,
+	TEXT("If 0, the probe visualization doesn't draw the probes that classification made inactive.\n"),
+	ECVF_RenderThreadSafe);
+
+// Probes with a smaller screen radius (in pixels) are drawn with the coarse sphere
+static const float c_probeLODScreenRadius = 8.0f;
+
 BEGIN_SHADER_PARAMETER_STRUCT(FVolumeVisualizeShaderParameters, )
 	SHADER_PARAMETER_RDG_TEXTURE(Texture2D, ProbeIrradianceTexture)
 	SHADER_PARAMETER_RDG_TEXTURE(Texture2D, ProbeDistanceTexture)
@@ -49,9 +65,59 @@ BEGIN_SHADER_PARAMETER_STRUCT(FVolumeVisualizeShaderParameters, )
 	SHADER_PARAMETER(int32, ShouldUsePreExposure)
 	SHADER_PARAMETER(FIntVector, VolumeProbeScrollOffsets)
 	SHADER_PARAMETER(float, IrradianceScalar)
+	SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, ProbeInstances)
+	SHADER_PARAMETER(uint32, InstanceListOffset)
+	RDG_BUFFER_ACCESS(DrawArgs, ERHIAccess::IndirectArgs)
 	RENDER_TARGET_BINDING_SLOTS()
 END_SHADER_PARAMETER_STRUCT()
 
+BEGIN_SHADER_PARAMETER_STRUCT(FVolumeVisualizeCullShaderParameters, )
+	SHADER_PARAMETER_RDG_TEXTURE(Texture2D, ProbeOffsets)
+	SHADER_PARAMETER_RDG_TEXTURE(Texture2D<uint>, ProbeStates)
+	SHADER_PARAMETER(float, ProbeRadius)
+	SHADER_PARAMETER(FVector, VolumePosition)
+	SHADER_PARAMETER(FVector4, VolumeRotation)
+	SHADER_PARAMETER(FVector, VolumeProbeGridSpacing)
+	SHADER_PARAMETER(FIntVector, VolumeProbeGridCounts)
+	SHADER_PARAMETER(FIntVector, VolumeProbeScrollOffsets)
+	SHADER_PARAMETER(FVector, CameraPosition)
+	SHADER_PARAMETER_ARRAY(FVector4, FrustumPlanes, [6])
+	SHADER_PARAMETER(int, NumFrustumPlanes)
+	SHADER_PARAMETER(float, MaxDistance)
+	SHADER_PARAMETER(float, LODScreenRadius)
+	SHADER_PARAMETER(float, ScreenRadiusScale)
+	SHADER_PARAMETER(int, ShowInactive)
+	SHADER_PARAMETER(uint32, NearIndexCount)
+	SHADER_PARAMETER(uint32, FarIndexCount)
+	SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RWProbeInstances)
+	SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RWDrawArgs)
+END_SHADER_PARAMETER_STRUCT()
+
+class FVolumeVisualizeCullShaderCS : public FGlobalShader
+{
+public:
+	DECLARE_GLOBAL_SHADER(FVolumeVisualizeCullShaderCS);
+	SHADER_USE_PARAMETER_STRUCT(FVolumeVisualizeCullShaderCS, FGlobalShader);
+
+	using FParameters = FVolumeVisualizeCullShaderParameters;
+
+	class FEnableRelocation : SHADER_PERMUTATION_BOOL("RTXGI_DDGI_PROBE_RELOCATION");
+	class FEnableScrolling : SHADER_PERMUTATION_BOOL("RTXGI_DDGI_INFINITE_SCROLLING_VOLUME");
+
+	using FPermutationDomain = TShaderPermutationDomain<FEnableRelocation, FEnableScrolling>;
+
+	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("RTXGI_DDGI_PROBE_CLASSIFICATION"), FDDGIVolumeSceneProxy::FComponentData::c_RTXGI_DDGI_PROBE_CLASSIFICATION ? 1 : 0);
+	}
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+};
+
 class FVolumeVisualizeShaderVS : public FGlobalShader
 {
 public:
@@ -112,6 +178,7 @@ public:
 
 IMPLEMENT_GLOBAL_SHADER(FVolumeVisualizeShaderVS, "/Plugin/RTXGI/Private/VisualizeDDGIProbes.usf", "VisualizeDDGIProbesVS", SF_Vertex);
 IMPLEMENT_GLOBAL_SHADER(FVolumeVisualizeShaderPS, "/Plugin/RTXGI/Private/VisualizeDDGIProbes.usf", "VisualizeDDGIProbesPS", SF_Pixel);
+IMPLEMENT_GLOBAL_SHADER(FVolumeVisualizeCullShaderCS, "/Plugin/RTXGI/Private/VisualizeDDGIProbes.usf", "VisualizeDDGIProbesCullCS", SF_Compute);
 
 /**
 * Probe sphere vertex buffer. Defines a sphere of unit size.
@@ -281,6 +348,8 @@ public:
 TGlobalResource<FVisualizeDDGIProbesVertexDeclaration> GVisualizeDDGIProbesVertexDeclaration;
 TGlobalResource<TDDGIProbeSphereVertexBuffer<36, 24, FVector4>> GDDGIProbeSphereVertexBuffer;
 TGlobalResource<TDDGIProbeSphereIndexBuffer<36, 24>> GDDGIProbeSphereIndexBuffer;
+TGlobalResource<TDDGIProbeSphereVertexBuffer<12, 8, FVector4>> GDDGIProbeCoarseSphereVertexBuffer;
+TGlobalResource<TDDGIProbeSphereIndexBuffer<12, 8>> GDDGIProbeCoarseSphereIndexBuffer;
 
 void FDDGIVolumeSceneProxy::RenderDiffuseIndirectVisualizations_RenderThread(
 	const FScene& Scene,
@@ -318,6 +387,69 @@ void FDDGIVolumeSceneProxy::RenderDiffuseIndirectVisualizations_RenderThread(
 		// Skip this volume if it doesn't intersect the view frustum
 		if (!proxy->IntersectsViewFrustum(View)) continue;
 
+		FGlobalShaderMap* GlobalShaderMap = GetGlobalShaderMap(ERHIFeatureLevel::SM5);
+
+		FVector volumeSize = proxy->ComponentData.Transform.GetScale3D() * 200.0f;
+		FVector probeGridSpacing;
+		probeGridSpacing.X = volumeSize.X / float(proxy->ComponentData.ProbeCounts.X);
+		probeGridSpacing.Y = volumeSize.Y / float(proxy->ComponentData.ProbeCounts.Y);
+		probeGridSpacing.Z = volumeSize.Z / float(proxy->ComponentData.ProbeCounts.Z);
+		FQuat rotation = proxy->ComponentData.Transform.GetRotation();
+
+		FRDGTextureRef ProbeOffsetsTexture = RegisterExternalTextureWithFallback(GraphBuilder, proxy->ProbesOffsets, GSystemTextures.BlackDummy);
+		FRDGTextureRef ProbeStatesTexture = RegisterExternalTextureWithFallback(GraphBuilder, proxy->ProbesStates, GSystemTextures.BlackDummy);
+
+		// Cull the probes on the GPU against the view frustum, the max distance and their state, and pick the sphere
+		// detail from their screen size, so the draws only process the probes that show
+		uint32 NumProbes = uint32(proxy->ComponentData.GetProbeCount());
+		FRDGBufferRef ProbeInstances = GraphBuilder.CreateBuffer(FRDGBufferDesc::CreateBufferDesc(sizeof(uint32), 2 * NumProbes), TEXT("DDGIVisualizeProbeInstances"));
+		FRDGBufferRef DrawArgs = GraphBuilder.CreateBuffer(FRDGBufferDesc::CreateIndirectDesc(10), TEXT("DDGIVisualizeProbeDrawArgs"));
+		{
+			FRDGBufferUAVRef DrawArgsUAV = GraphBuilder.CreateUAV(DrawArgs, PF_R32_UINT);
+			AddClearUAVPass(GraphBuilder, DrawArgsUAV, 0u);
+
+			FVolumeVisualizeCullShaderCS::FPermutationDomain PermutationVectorCS;
+			PermutationVectorCS.Set<FVolumeVisualizeCullShaderCS::FEnableRelocation>(proxy->ComponentData.EnableProbeRelocation);
+			PermutationVectorCS.Set<FVolumeVisualizeCullShaderCS::FEnableScrolling>(proxy->ComponentData.EnableProbeScrolling);
+			TShaderMapRef<FVolumeVisualizeCullShaderCS> ComputeShader(GlobalShaderMap, PermutationVectorCS);
+
+			FVolumeVisualizeCullShaderParameters* CullParameters = GraphBuilder.AllocParameters<FVolumeVisualizeCullShaderParameters>();
+			CullParameters->ProbeOffsets = ProbeOffsetsTexture;
+			CullParameters->ProbeStates = ProbeStatesTexture;
+			CullParameters->ProbeRadius = probeRadius;
+			CullParameters->VolumePosition = proxy->ComponentData.Origin;
+			CullParameters->VolumeRotation = FVector4{ rotation.X, rotation.Y, rotation.Z, rotation.W };
+			CullParameters->VolumeProbeGridSpacing = probeGridSpacing;
+			CullParameters->VolumeProbeGridCounts = proxy->ComponentData.ProbeCounts;
+			CullParameters->VolumeProbeScrollOffsets = proxy->ComponentData.ProbeScrollOffsets;
+			CullParameters->CameraPosition = View.ViewLocation;
+
+			const TArray<FPlane, TInlineAllocator<6>>& Planes = View.ViewFrustum.Planes;
+			CullParameters->NumFrustumPlanes = FMath::Min(Planes.Num(), 6);
+			for (int PlaneIndex = 0; PlaneIndex < CullParameters->NumFrustumPlanes; PlaneIndex++)
+			{
+				CullParameters->FrustumPlanes[PlaneIndex] = FVector4(Planes[PlaneIndex], Planes[PlaneIndex].W);
+			}
+
+			CullParameters->MaxDistance = CVarProbesVisualizationMaxDistance.GetValueOnRenderThread();
+			CullParameters->LODScreenRadius = c_probeLODScreenRadius;
+			CullParameters->ScreenRadiusScale = View.ViewMatrices.GetProjectionMatrix().M[0][0] * ViewRect.Width() * 0.5f;
+			CullParameters->ShowInactive = CVarProbesVisualizationShowInactive.GetValueOnRenderThread();
+			CullParameters->NearIndexCount = GDDGIProbeSphereIndexBuffer.GetIndexCount();
+			CullParameters->FarIndexCount = GDDGIProbeCoarseSphereIndexBuffer.GetIndexCount();
+			CullParameters->RWProbeInstances = GraphBuilder.CreateUAV(ProbeInstances, PF_R32_UINT);
+			CullParameters->RWDrawArgs = DrawArgsUAV;
+
+			FComputeShaderUtils::AddPass(
+				GraphBuilder,
+				RDG_EVENT_NAME("DDGI Visualize Probes Culling"),
+				ComputeShader,
+				CullParameters,
+				FComputeShaderUtils::GetGroupCount(int32(NumProbes), 64)
+			);
+		}
+		FRDGBufferSRVRef ProbeInstancesSRV = GraphBuilder.CreateSRV(ProbeInstances, PF_R32_UINT);
+
 		// Get the shader permutation
 		FVolumeVisualizeShaderVS::FPermutationDomain PermutationVectorVS;
 		PermutationVectorVS.Set<FVolumeVisualizeShaderVS::FEnableRelocation>(proxy->ComponentData.EnableProbeRelocation);
@@ -330,7 +462,6 @@ void FDDGIVolumeSceneProxy::RenderDiffuseIndirectVisualizations_RenderThread(
 		PermutationVectorPS.Set<FVolumeVisualizeShaderPS::FFormatRadiance>(highBitCount);
 		PermutationVectorPS.Set<FVolumeVisualizeShaderPS::FFormatIrradiance>(highBitCount);
 
-		FGlobalShaderMap* GlobalShaderMap = GetGlobalShaderMap(ERHIFeatureLevel::SM5);
 		TShaderMapRef<FVolumeVisualizeShaderVS> VertexShader(GlobalShaderMap, PermutationVectorVS);
 		TShaderMapRef<FVolumeVisualizeShaderPS> PixelShader(GlobalShaderMap, PermutationVectorPS);
 
@@ -341,8 +472,8 @@ void FDDGIVolumeSceneProxy::RenderDiffuseIndirectVisualizations_RenderThread(
 
 		PassParameters->ProbeIrradianceTexture = GraphBuilder.RegisterExternalTexture(proxy->ProbesIrradiance);
 		PassParameters->ProbeDistanceTexture = GraphBuilder.RegisterExternalTexture(proxy->ProbesDistance);
-		PassParameters->ProbeOffsets = RegisterExternalTextureWithFallback(GraphBuilder, proxy->ProbesOffsets, GSystemTextures.BlackDummy);
-		PassParameters->ProbeStates = RegisterExternalTextureWithFallback(GraphBuilder, proxy->ProbesStates, GSystemTextures.BlackDummy);
+		PassParameters->ProbeOffsets = ProbeOffsetsTexture;
+		PassParameters->ProbeStates = ProbeStatesTexture;
 		PassParameters->ProbeRadius = probeRadius;
 		PassParameters->DepthScale = depthScale;
 		PassParameters->WorldToClip = View.ViewMatrices.GetViewProjectionMatrix();
@@ -359,14 +490,7 @@ void FDDGIVolumeSceneProxy::RenderDiffuseIndirectVisualizations_RenderThread(
 		PassParameters->VolumeProbeIrradianceEncodingGamma = proxy->ComponentData.ProbeIrradianceEncodingGamma;
 
 		PassParameters->VolumePosition = proxy->ComponentData.Origin;
-		FQuat rotation = proxy->ComponentData.Transform.GetRotation();
 		PassParameters->VolumeRotation = FVector4{ rotation.X, rotation.Y, rotation.Z, rotation.W };
-
-		FVector volumeSize = proxy->ComponentData.Transform.GetScale3D() * 200.0f;
-		FVector probeGridSpacing;
-		probeGridSpacing.X = volumeSize.X / float(proxy->ComponentData.ProbeCounts.X);
-		probeGridSpacing.Y = volumeSize.Y / float(proxy->ComponentData.ProbeCounts.Y);
-		probeGridSpacing.Z = volumeSize.Z / float(proxy->ComponentData.ProbeCounts.Z);
 		PassParameters->VolumeProbeGridSpacing = probeGridSpacing;
 
 		PassParameters->VolumeProbeGridCounts = proxy->ComponentData.ProbeCounts;
@@ -377,36 +501,55 @@ void FDDGIVolumeSceneProxy::RenderDiffuseIndirectVisualizations_RenderThread(
 		PassParameters->RenderTargets[0] = FRenderTargetBinding(SceneColorTexture, ERenderTargetLoadAction::ELoad);
 		PassParameters->RenderTargets.DepthStencil = FDepthStencilBinding(SceneDepthTexture, ERenderTargetLoadAction::ELoad, ERenderTargetLoadAction::ENoAction, FExclusiveDepthStencil::DepthWrite_StencilNop);
 
-		uint32 NumInstances = uint32(proxy->ComponentData.ProbeCounts.X * proxy->ComponentData.ProbeCounts.Y * proxy->ComponentData.ProbeCounts.Z);
+		PassParameters->ProbeInstances = ProbeInstancesSRV;
+		PassParameters->DrawArgs = DrawArgs;
 
-		GraphBuilder.AddPass(
-			Forward<FRDGEventName>(RDG_EVENT_NAME("DDGI Visualize Probes")),
-			PassParameters,
-			ERDGPassFlags::Raster,
-			[PassParameters, GlobalShaderMap, VertexShader, PixelShader, ViewRect, NumInstances](FRHICommandList& RHICmdList)
+		// Draw the near probes with the detailed sphere and the others with the coarse sphere, from the culled instance lists
+		for (int LOD = 0; LOD < 2; LOD++)
+		{
+			FVolumeVisualizeShaderParameters* LODPassParameters = PassParameters;
+			if (LOD > 0)
 			{
-				RHICmdList.SetViewport(ViewRect.Min.X, ViewRect.Min.Y, 0.0f, ViewRect.Max.X, ViewRect.Max.Y, 1.0f);
+				LODPassParameters = GraphBuilder.AllocParameters<FVolumeVisualizeShaderParameters>();
+				*LODPassParameters = *PassParameters;
+				LODPassParameters->RenderTargets[0].SetLoadAction(ERenderTargetLoadAction::ELoad);
+			}
+			LODPassParameters->InstanceListOffset = (LOD == 0) ? 0 : NumProbes;
 
-				FGraphicsPipelineStateInitializer GraphicsPSOInit;
-				RHICmdList.ApplyCachedRenderTargets(GraphicsPSOInit);
+			FRHIVertexBuffer* SphereVertexBuffer = (LOD == 0) ? GDDGIProbeSphereVertexBuffer.VertexBufferRHI.GetReference() : GDDGIProbeCoarseSphereVertexBuffer.VertexBufferRHI.GetReference();
+			FRHIIndexBuffer* SphereIndexBuffer = (LOD == 0) ? GDDGIProbeSphereIndexBuffer.IndexBufferRHI.GetReference() : GDDGIProbeCoarseSphereIndexBuffer.IndexBufferRHI.GetReference();
+			uint32 DrawArgsOffset = (LOD == 0) ? 0 : 5 * sizeof(uint32);
 
-				GraphicsPSOInit.RasterizerState = TStaticRasterizerState<FM_Solid, CM_CW>::GetRHI();
-				GraphicsPSOInit.DepthStencilState = TStaticDepthStencilState<true, CF_DepthNearOrEqual>::GetRHI();
-				GraphicsPSOInit.BlendState = TStaticBlendStateWriteMask<CW_RGB, CW_RGBA>::GetRHI();
+			GraphBuilder.AddPass(
+				Forward<FRDGEventName>(RDG_EVENT_NAME("DDGI Visualize Probes (LOD %d)", LOD)),
+				LODPassParameters,
+				ERDGPassFlags::Raster,
+				[LODPassParameters, VertexShader, PixelShader, ViewRect, SphereVertexBuffer, SphereIndexBuffer, DrawArgsOffset](FRHICommandList& RHICmdList)
+				{
+					RHICmdList.SetViewport(ViewRect.Min.X, ViewRect.Min.Y, 0.0f, ViewRect.Max.X, ViewRect.Max.Y, 1.0f);
 
-				GraphicsPSOInit.BoundShaderState.VertexDeclarationRHI = GVisualizeDDGIProbesVertexDeclaration.VertexDeclarationRHI;
-				GraphicsPSOInit.BoundShaderState.VertexShaderRHI = VertexShader.GetVertexShader();
-				GraphicsPSOInit.BoundShaderState.PixelShaderRHI = PixelShader.GetPixelShader();
-				GraphicsPSOInit.PrimitiveType = PT_TriangleList;
-				SetGraphicsPipelineState(RHICmdList, GraphicsPSOInit);
+					FGraphicsPipelineStateInitializer GraphicsPSOInit;
+					RHICmdList.ApplyCachedRenderTargets(GraphicsPSOInit);
 
-				SetShaderParameters(RHICmdList, VertexShader, VertexShader.GetVertexShader(), *PassParameters);
-				SetShaderParameters(RHICmdList, PixelShader, PixelShader.GetPixelShader(), *PassParameters);
+					GraphicsPSOInit.RasterizerState = TStaticRasterizerState<FM_Solid, CM_CW>::GetRHI();
+					GraphicsPSOInit.DepthStencilState = TStaticDepthStencilState<true, CF_DepthNearOrEqual>::GetRHI();
+					GraphicsPSOInit.BlendState = TStaticBlendStateWriteMask<CW_RGB, CW_RGBA>::GetRHI();
 
-				RHICmdList.SetStreamSource(0, GDDGIProbeSphereVertexBuffer.VertexBufferRHI, 0);
-				RHICmdList.DrawIndexedPrimitive(GDDGIProbeSphereIndexBuffer.IndexBufferRHI, 0, 0, GDDGIProbeSphereVertexBuffer.GetVertexCount(), 0, GDDGIProbeSphereIndexBuffer.GetIndexCount() / 3, NumInstances);
-			}
-		);
+					GraphicsPSOInit.BoundShaderState.VertexDeclarationRHI = GVisualizeDDGIProbesVertexDeclaration.VertexDeclarationRHI;
+					GraphicsPSOInit.BoundShaderState.VertexShaderRHI = VertexShader.GetVertexShader();
+					GraphicsPSOInit.BoundShaderState.PixelShaderRHI = PixelShader.GetPixelShader();
+					GraphicsPSOInit.PrimitiveType = PT_TriangleList;
+					SetGraphicsPipelineState(RHICmdList, GraphicsPSOInit);
+
+					SetShaderParameters(RHICmdList, VertexShader, VertexShader.GetVertexShader(), *LODPassParameters);
+					SetShaderParameters(RHICmdList, PixelShader, PixelShader.GetPixelShader(), *LODPassParameters);
+
+					LODPassParameters->DrawArgs->MarkResourceAsUsed();
+					RHICmdList.SetStreamSource(0, SphereVertexBuffer, 0);
+					RHICmdList.DrawIndexedPrimitiveIndirect(SphereIndexBuffer, LODPassParameters->DrawArgs->GetIndirectRHICallBuffer(), DrawArgsOffset);
+				}
+			);
+		}
 	}
 }
 #else
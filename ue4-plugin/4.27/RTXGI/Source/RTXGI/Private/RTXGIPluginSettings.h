@@ -83,6 +83,15 @@ public:
 	UPROPERTY(config, EditAnywhere, Category = DDGI, meta = (ClampMin = "0"))
 	int ProbeUpdateRayBudget = 0;
 
+	/** The GPU time in milliseconds DDGI is allowed to spend per frame updating volumes. When non-zero, it replaces the
+	* round robin: each frame, volumes are picked by their benefit (screen coverage, distance, recent lighting changes and
+	* frames since their last update, scaled by the update priority) over their cost (probes x rays x the measured GPU time
+	* per ray) until the budget is spent, so several volumes can update in one frame and the last one may update a subset
+	* of its probes. A budget of 0 keeps the weighted round robin of one volume per frame.
+	*/
+	UPROPERTY(config, EditAnywhere, Category = DDGI, meta = (ClampMin = "0"))
+	float ProbeUpdateGPUBudgetMs = 0.0f;
+
 	/** Probes visualization mode for all volumes.	*/
 	UPROPERTY(config, EditAnywhere, Category = DDGI)
 	EDDGIProbesVisulizationMode ProbesVisualization = EDDGIProbesVisulizationMode::irrad;
@@ -22,7 +22,9 @@
 #include "DDGIVolumeComponent.generated.h"
 
 class FRDGBuilder;
+class FRDGTexture;
 class FRHICommandListImmediate;
+class FRHIGPUTextureReadback;
 class FScene;
 class FSceneInterface;
 class FSceneRenderTargets;
@@ -64,6 +66,7 @@ struct FDDGITexturePixels
 	} Desc;
 	TArray<uint8> Pixels;
 	FTexture2DRHIRef Texture;
+	TSharedPtr<FRHIGPUTextureReadback, ESPMode::ThreadSafe> Readback; // Copy of the probe texture in flight to CPU memory, when saving
 };
 
 struct FDDGITextureLoadContext
@@ -124,7 +127,8 @@ public:
 		// A shared location cpp side for operational defines
 		static const bool c_RTXGI_DDGI_PROBE_CLASSIFICATION = true;
 
-		// It considers this many volumes that pass frustum culling when sampling GI for the scene.
+		// The lighting pass shades this many volumes per dispatch. The volumes that pass frustum culling are shaded in batches
+		// of this size, and each pixel only evaluates the volumes of its cluster (see BuildVolumeClusterGrid()).
 		static const int c_RTXGI_DDGI_MAX_SHADING_VOLUMES = 12;
 
 		static const EPixelFormat c_pixelFormatRadianceLowBitDepth = EPixelFormat::PF_G32R32F;
@@ -145,6 +149,10 @@ public:
 		static const uint32 c_NumTexelsIrradiance = 6;
 		static const uint32 c_NumTexelsDistance = 14;
 
+		// The probes are culled for updates in bricks of this many probes on each axis.
+		// This needs to match DDGI_PROBE_BRICK_SIZE in ProbeBrickCommon.ush
+		static const int c_ProbeBrickSize = 4;
+
 		uint32 GetNumRaysPerProbe() const
 		{
 			switch (RaysPerProbe)
@@ -162,6 +170,7 @@ public:
 		}
 
 		EDDGIRaysPerProbe RaysPerProbe = EDDGIRaysPerProbe::n144;
+		float ProbeUpdateFraction = 1.0f; // Fraction of the probes traced each update, from r.RTXGI.Quality
 		float ProbeMaxRayDistance = 1000.0f;
 		FTransform Transform = FTransform::Identity;
 		FVector Origin = FVector(0);
@@ -204,6 +213,15 @@ public:
 		{
 			return ProbeCounts.X * ProbeCounts.Y * ProbeCounts.Z;
 		}
+
+		FIntVector GetProbeBrickCounts() const
+		{
+			return FIntVector(
+				FMath::DivideAndRoundUp(ProbeCounts.X, c_ProbeBrickSize),
+				FMath::DivideAndRoundUp(ProbeCounts.Y, c_ProbeBrickSize),
+				FMath::DivideAndRoundUp(ProbeCounts.Z, c_ProbeBrickSize)
+			);
+		}
 	};
 	FComponentData ComponentData;
 	FDDGITextureLoadContext TextureLoadContext;
@@ -219,6 +237,40 @@ public:
 	int ProbeIndexStart = 0;
 	int ProbeIndexCount = 0;
 
+	// Complete round robin passes over the probes, paces the updates of off-screen probe bricks
+	uint32 ProbeSweepCount = 0;
+
+	// A pair of GPU timestamps around one of the volume's updates, read back a few frames later
+	struct FUpdateTiming
+	{
+		FRHIPooledRenderQuery Begin;
+		FRHIPooledRenderQuery End;
+		int Rays = 0;
+	};
+
+	// State of the GPU time budgeted update scheduler (see URTXGIPluginSettings::ProbeUpdateGPUBudgetMs)
+	struct FUpdateSchedule
+	{
+		float GPUMsPerRay = 0.0f;       // Measured GPU time of the update per probe ray (moving average), 0 until measured
+		float LightingChange = 0.0f;    // Set to 1 when the lights affecting the volume change, decays each frame
+		uint32 LightingHash = 0;
+		uint32 FramesSinceUpdate = 0;
+		int RayBudget = -1;             // Rays of the scheduled update, 0 to update every probe, -1 to use ProbeUpdateRayBudget
+		TArray<FUpdateTiming> PendingTimings;
+	};
+	FUpdateSchedule UpdateSchedule;
+
+	// Copies of the probe textures from before this frame's update, read by the lighting pass when the update runs on
+	// async compute (r.RTXGI.DDGI.AsyncCompute). Only valid in the render graph of the frame's RenderDiffuseIndirectLight_RenderThread.
+	struct FLightingTextures
+	{
+		FRDGTexture* Irradiance = nullptr;
+		FRDGTexture* Distance = nullptr;
+		FRDGTexture* Offsets = nullptr;
+		FRDGTexture* States = nullptr;
+	};
+	FLightingTextures LightingTextures;
+
 	static TSet<FDDGIVolumeSceneProxy*> AllProxiesReadyForRender_RenderThread;
 	static TMap<const FSceneInterface*, float> SceneRoundRobinValue;
 
@@ -254,6 +306,7 @@ protected:
 	void InitializeComponent() override final;
 
 	void Serialize(FArchive& Ar) override final;
+	void PreSave(const class ITargetPlatform* TargetPlatform) override final;
 
 	//~ Begin UActorComponent Interface
 	virtual bool ShouldCreateRenderState() const override { return true; }
@@ -427,4 +480,7 @@ public:
 	// When loading a volume we get data for it's textures but don't have a scene proxy yet.
 	// This is where that data is stored until the scene proxy is ready to take it.
 	FDDGITextureLoadContext LoadContext;
+
+	// Probe texture readbacks started in PreSave and written out by the following Serialize
+	TSharedPtr<FDDGITextureLoadContext, ESPMode::ThreadSafe> SaveReadback;
 };